@@ -37,6 +37,7 @@ load(
     _xls_dslx_ir_macro = "xls_dslx_ir_macro",
     _xls_ir_cc_library_macro = "xls_ir_cc_library_macro",
     _xls_ir_opt_ir_macro = "xls_ir_opt_ir_macro",
+    _xls_opt_ir_filegroup = "xls_opt_ir_filegroup",
 )
 load(
     "//xls/build_rules:xls_ir_rules.bzl",
@@ -92,6 +93,7 @@ xls_dslx_ir = _xls_dslx_ir_macro
 
 # TODO (vmirian) 1-10-2022 Do not expose xls_ir_opt_ir to user.
 xls_ir_opt_ir = _xls_ir_opt_ir_macro
+xls_opt_ir_filegroup = _xls_opt_ir_filegroup
 xls_ir_verilog = _xls_ir_verilog_build_and_test
 xls_benchmark_verilog = _xls_benchmark_verilog
 xls_dslx_opt_ir = _xls_dslx_opt_ir_macro
@@ -263,6 +263,7 @@ def xls_ir_verilog_impl(ctx, src):
         "ram_configurations",
         "gate_recvs",
         "array_index_bounds_checking",
+        "codegen_threads",
         "inline_procs",
         "fdo_iteration_number",
         "fdo_delay_driven_path_number",
@@ -273,6 +274,8 @@ def xls_ir_verilog_impl(ctx, src):
         "fdo_yosys_path",
         "fdo_sta_path",
         "fdo_synthesis_libraries",
+        "fdo_synthesis_jobs",
+        "fdo_synthesis_cache_dir",
     )
 
     SCHEDULING_FLAGS = (
@@ -287,6 +290,9 @@ def xls_ir_verilog_impl(ctx, src):
         "io_constraints",
         "receives_first_sends_last",
         "mutual_exclusion_z3_rlimit",
+        "schedule_cache_dir",
+        "sdc_solver",
+        "schedule_partition_size",
     )
 
     is_args_valid(codegen_args, CODEGEN_FLAGS + SCHEDULING_FLAGS)
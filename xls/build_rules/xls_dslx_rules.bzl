@@ -107,6 +107,9 @@ def _get_dslx_test_cmdline(ctx, src, append_cmd_line_args = True):
         "disable_warnings",
         "max_ticks",
         "format_preference",
+        "test_threads",
+        "jit_test_procs",
+        "proc_threads",
     )
 
     dslx_test_args = dict(_dslx_test_args)
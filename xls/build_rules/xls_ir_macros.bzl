@@ -202,7 +202,8 @@ def xls_ir_cc_library_macro(
         name,
         src,
         top = None,
-        namespaces = ""):
+        namespaces = "",
+        tops = []):
     """Invokes the AOT compiles the input IR into a cc_library.
 
     Example:
@@ -230,11 +231,16 @@ def xls_ir_cc_library_macro(
       top: The entry point in the IR file of interest.
       namespaces: A comma-separated list of namespaces into which the
                   generated code should go.
+      tops: If non-empty, the IR functions to compile into a single bundle
+            with a shared object file, dispatch table and layouts. The
+            generated header contains a wrapper for each function and a
+            GetAotBundle() accessor for dispatch by name.
     """
     string_type_check("name", name)
     string_type_check("src", src)
     string_type_check("top", top, True)
     string_type_check("namespaces", namespaces)
+    list_type_check("tops", tops)
 
     header_file = name + ".h"
     object_file = name + ".o"
@@ -247,6 +253,7 @@ def xls_ir_cc_library_macro(
         src = src,
         top = top,
         namespaces = namespaces,
+        tops = tops,
     )
 
     native.cc_library(
@@ -268,3 +275,40 @@ def xls_ir_cc_library_macro(
             "//xls/jit:type_layout",
         ],
     )
+
+def xls_opt_ir_filegroup(name, **kwargs):
+    """A macro that instantiates a filegroup of every optimized IR file of the package.
+
+    The filegroup holds the 'opt_ir_file' output of every rule instantiated
+    before the macro in the BUILD file, so the macro must be called after all
+    the rules generating optimized IR files, typically at the end of the file.
+
+    Example:
+
+        ```
+        xls_opt_ir_filegroup(
+            name = "opt_ir_files",
+        )
+        ```
+
+    Args:
+      name: The name of the filegroup.
+      **kwargs: Keyword arguments of the filegroup. Named arguments.
+    """
+
+    # Type check input
+    string_type_check("name", name)
+
+    srcs = {}
+    for rule in native.existing_rules().values():
+        opt_ir_file = rule.get("opt_ir_file")
+        if not opt_ir_file:
+            continue
+
+        # Outputs are reported as labels; they always belong to this package.
+        srcs[":" + str(opt_ir_file).split(":")[-1]] = None
+    native.filegroup(
+        name = name,
+        srcs = sorted(srcs.keys()),
+        **kwargs
+    )
@@ -131,6 +131,7 @@ def _convert_to_ir(ctx, src):
         "emit_fail_as_assert",
         "warnings_as_errors",
         "disable_warnings",
+        "share_instantiations",
     )
 
     # With runs outside a monorepo, the execution root for the workspace of
@@ -211,7 +212,13 @@ def _optimize_ir(ctx, src):
         "skip_passes",
         "opt_level",
         "convert_array_index_to_select",
+        "function_parallelism",
         "inline_procs",
+        "output_binary_ir",
+        "pass_profile",
+        "pass_profile_json",
+        "compile_time_budget",
+        "opt_cache_dir",
         "top",
     )
 
@@ -290,6 +297,7 @@ def get_ir_equivalence_test_cmd(
     )
     IR_EQUIVALENCE_FLAGS = (
         "timeout",
+        "simulation_samples",
     )
 
     ir_equivalence_args = dict(ctx.attr.ir_equivalence_args)
@@ -341,6 +349,7 @@ def get_eval_ir_test_cmd(ctx, src, append_cmd_line_args = True):
         "input",
         "input_file",
         "random_inputs",
+        "threads",
         "expected",
         "expected_file",
         "optimize_ir",
@@ -1095,6 +1104,8 @@ def _xls_ir_cc_library_impl(ctx):
     aot_compiler_args.add("-header_include_path", header_file.short_path)
     if ctx.attr.namespaces:
         aot_compiler_args.add("-namespaces", ctx.attr.namespaces)
+    if ctx.attr.tops:
+        aot_compiler_args.add("-tops", ",".join(ctx.attr.tops))
 
     aot_compiler_tool = get_executable_from(
         get_xls_toolchain_info(ctx).aot_compiler_tool,
@@ -1183,6 +1194,11 @@ xls_ir_cc_library = rule(
                 doc = "Comma-separated list of nested namespaces in which to " +
                       "place the generated function.",
             ),
+            "tops": attr.string_list(
+                doc = "Names of the IR functions to compile into a single " +
+                      "bundle sharing one object file and dispatch table. " +
+                      "If empty, only the package top is compiled.",
+            ),
             "_clang_format": attr.label(
                 executable = True,
                 allow_files = True,
@@ -42,6 +42,7 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/trace.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/node.h"
@@ -1954,21 +1955,20 @@ class CloneNodesIntoBlockHandler {
   }
 
   // Add pipeline registers. A register is needed for each node which is
-  // scheduled at or before this cycle and has a use after this cycle.
-  absl::Status AddNextPipelineStage(const PipelineSchedule& schedule,
+  // scheduled at or before this cycle and has a use after this cycle; these
+  // are given by `live_out_nodes` (see GetLiveOutNodesByStage).
+  absl::Status AddNextPipelineStage(absl::Span<Node* const> live_out_nodes,
                                     int64_t stage) {
-    for (Node* function_base_node : function_base_->nodes()) {
-      if (schedule.IsLiveOutOfCycle(function_base_node, stage)) {
-        Node* node = node_map_.at(function_base_node);
+    for (Node* function_base_node : live_out_nodes) {
+      Node* node = node_map_.at(function_base_node);
 
-        XLS_ASSIGN_OR_RETURN(
-            Node * node_after_stage,
-            CreatePipelineRegistersForNode(
-                PipelineSignalName(node->GetName(), stage), node,
-                result_.pipeline_registers.at(stage), block_));
+      XLS_ASSIGN_OR_RETURN(
+          Node * node_after_stage,
+          CreatePipelineRegistersForNode(
+              PipelineSignalName(node->GetName(), stage), node,
+              result_.pipeline_registers.at(stage), block_));
 
-        node_map_[function_base_node] = node_after_stage;
-      }
+      node_map_[function_base_node] = node_after_stage;
     }
 
     return absl::OkStatus();
@@ -2442,6 +2442,43 @@ class CloneNodesIntoBlockHandler {
   absl::flat_hash_map<Node*, Node*> node_map_;
 };
 
+// Returns the nodes which are live out of each stage of the schedule (as
+// defined by PipelineSchedule::IsLiveOutOfCycle), indexed by stage. Each bucket
+// is in the order of FunctionBase::nodes(). Every node is visited once and
+// appended to the bucket of each stage it is live out of, so the cost is
+// linear in the size of the graph and the number of pipeline registers rather
+// than proportional to the number of stages times the number of nodes.
+static std::vector<std::vector<Node*>> GetLiveOutNodesByStage(
+    const PipelineSchedule& schedule) {
+  FunctionBase* function_base = schedule.function_base();
+  const int64_t last_stage = schedule.length() - 1;
+  std::vector<std::vector<Node*>> live_out_nodes(
+      std::max(last_stage, int64_t{0}));
+  for (Node* node : function_base->nodes()) {
+    // The latest stage in which the value of the node is used.
+    int64_t last_use_stage = schedule.cycle(node);
+    if (function_base->IsFunction() &&
+        node == function_base->AsFunctionOrDie()->return_value()) {
+      last_use_stage = last_stage;
+    }
+    for (Node* user : node->users()) {
+      last_use_stage = std::max(last_use_stage, schedule.cycle(user));
+    }
+    if (function_base->IsProc()) {
+      Proc* proc = function_base->AsProcOrDie();
+      for (int64_t index : proc->GetNextStateIndices(node)) {
+        last_use_stage = std::max(last_use_stage,
+                                  schedule.cycle(proc->GetStateParam(index)));
+      }
+    }
+    for (int64_t stage = schedule.cycle(node);
+         stage < std::min(last_use_stage, last_stage); ++stage) {
+      live_out_nodes[stage].push_back(node);
+    }
+  }
+  return live_out_nodes;
+}
+
 // Adds the nodes in the given schedule to the block. Pipeline registers are
 // inserted between stages and returned as a vector indexed by cycle. The block
 // should be empty prior to calling this function.
@@ -2451,11 +2488,16 @@ static absl::StatusOr<StreamingIOPipeline> CloneNodesIntoPipelinedBlock(
   FunctionBase* function_base = schedule.function_base();
   XLS_RET_CHECK(function_base->IsProc() || function_base->IsFunction());
 
+  std::vector<std::vector<Node*>> live_out_nodes =
+      GetLiveOutNodesByStage(schedule);
   CloneNodesIntoBlockHandler cloner(function_base, schedule.length(), options,
                                     block);
   for (int64_t stage = 0; stage < schedule.length(); ++stage) {
     XLS_RET_CHECK_OK(cloner.CloneNodes(schedule.nodes_in_cycle(stage), stage));
-    XLS_RET_CHECK_OK(cloner.AddNextPipelineStage(schedule, stage));
+    if (stage < live_out_nodes.size()) {
+      XLS_RET_CHECK_OK(
+          cloner.AddNextPipelineStage(live_out_nodes[stage], stage));
+    }
   }
 
   XLS_RET_CHECK_OK(cloner.AddOutputPortsIfFunction());
@@ -2861,6 +2903,7 @@ absl::StatusOr<CodegenPassUnit> ProcToPipelinedBlock(
 absl::StatusOr<CodegenPassUnit> FunctionBaseToPipelinedBlock(
     const PipelineSchedule& schedule, const CodegenOptions& options,
     FunctionBase* f) {
+  ScopedTrace trace("FunctionBaseToPipelinedBlock", "codegen");
   if (f->IsFunction()) {
     return FunctionToPipelinedBlock(schedule, options, f->AsFunctionOrDie());
   }
@@ -15,15 +15,24 @@
 #include "xls/codegen/block_generator.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <deque>
+#include <memory>
 #include <optional>
+#include <ostream>
+#include <sstream>
 #include <string>
 #include <string_view>
+#include <thread>  // NOLINT
 #include <variant>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/codegen/block_conversion.h"
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/flattening.h"
@@ -36,10 +45,13 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/common/trace.h"
 #include "xls/ir/block.h"
 #include "xls/ir/instantiation.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
 #include "xls/ir/source_location.h"
 
 namespace xls {
@@ -307,6 +319,8 @@ class BlockGenerator {
 
   // Generates and returns the Verilog text for the underlying block.
   absl::Status Emit() {
+    node_exprs_.reserve(block_->node_count());
+    DecideAssignments();
     XLS_RETURN_IF_ERROR(EmitInputPorts());
     // TODO(meheff): 2021/11/04 Emit instantiations in pipeline stages if
     // possible.
@@ -374,13 +388,39 @@ class BlockGenerator {
     return absl::OkStatus();
   }
 
+  // Decides, once for the whole block, which nodes are emitted as named
+  // assignments rather than inline expressions. Whether a node feeds an
+  // operand which must be a named reference is found in a single pass over
+  // all operands, so the cost is linear in the number of edges rather than in
+  // the operand counts of every user of every node.
+  void DecideAssignments() {
+    absl::flat_hash_set<Node*> named_reference_operands;
+    for (Node* node : block_->nodes()) {
+      for (int64_t i = 0; i < node->operand_count(); ++i) {
+        if (OperandMustBeNamedReference(node, i)) {
+          named_reference_operands.insert(node->operand(i));
+        }
+      }
+    }
+    for (Node* node : block_->nodes()) {
+      if (ShouldEmitAsAssignment(node, named_reference_operands)) {
+        assignment_nodes_.insert(node);
+      }
+    }
+  }
+
   // If the node has an assigned name then don't emit as an inline expression.
   // This ensures the name appears in the generated Verilog.
-  bool EmitAsAssignment(Node* const n) {
+  bool ShouldEmitAsAssignment(
+      Node* const n,
+      const absl::flat_hash_set<Node*>& named_reference_operands) {
     if (n->HasAssignedName() ||
         (n->users().size() > 1 && !ShouldInlineExpressionIntoMultipleUses(n)) ||
         n->function_base()->HasImplicitUse(n) ||
-        !mb_.CanEmitAsInlineExpression(n) || options_.separate_lines()) {
+        named_reference_operands.contains(n) ||
+        !mb_.CanEmitAsInlineExpression(
+            n, /*users_of_expression=*/absl::Span<Node* const>()) ||
+        options_.separate_lines()) {
       return true;
     }
     // Emit operands of RegisterWrite's as assignments rather than inline
@@ -393,6 +433,10 @@ class BlockGenerator {
     return false;
   }
 
+  bool EmitAsAssignment(Node* const n) {
+    return assignment_nodes_.contains(n);
+  }
+
   // Name of the node if it gets emitted as a separate assignment.
   std::string NodeAssignmentName(Node* const node,
                                  std::optional<int64_t> stage) {
@@ -756,6 +800,9 @@ class BlockGenerator {
   // Map from Node* to the Verilog expression representing its value.
   absl::flat_hash_map<Node*, NodeRepresentation> node_exprs_;
 
+  // Nodes emitted as named assignments; see DecideAssignments.
+  absl::flat_hash_set<Node*> assignment_nodes_;
+
   // Map from xls::Register* to the ModuleBuilder register abstraction
   // representing the underlying Verilog register.
   absl::flat_hash_map<xls::Register*, ModuleBuilder::Register> mb_registers_;
@@ -799,11 +846,53 @@ absl::StatusOr<std::vector<Block*>> GatherInstantiatedBlocks(Block* top) {
   return blocks;
 }
 
+// The module generated for a block, held until the modules are written in
+// order.
+struct GeneratedBlock {
+  std::optional<VerilogFile> file;
+  LineInfo line_info;
+  // The emitted text of `file`, if it was emitted by a worker thread.
+  std::optional<std::string> text;
+  absl::Status status;
+};
+
+// Adds the mappings from IR source lines to the Verilog lines recorded in
+// `line_info` to `verilog_line_map`. The Verilog lines are offset by
+// `line_offset`.
+absl::Status AddLineMappings(const LineInfo& line_info, int64_t line_offset,
+                             Package* package,
+                             VerilogLineMap* verilog_line_map) {
+  for (const auto& [vast_node, partial_spans] : line_info.Spans()) {
+    std::optional<std::vector<LineSpan>> spans =
+        line_info.LookupNode(vast_node);
+    if (!spans.has_value()) {
+      return absl::InternalError("Unbalanced calls to LineInfo::{Start, End}");
+    }
+    for (const LineSpan& span : spans.value()) {
+      SourceInfo info = vast_node->loc();
+      for (const SourceLocation& loc : info.locations) {
+        int64_t line = static_cast<int32_t>(loc.lineno());
+        VerilogLineMapping* mapping = verilog_line_map->add_mapping();
+        mapping->set_source_file(
+            package->GetFilename(loc.fileno()).value_or(""));
+        mapping->mutable_source_span()->set_line_start(line);
+        mapping->mutable_source_span()->set_line_end(line);
+        mapping->set_verilog_file("");  // to be updated later on
+        mapping->mutable_verilog_span()->set_line_start(line_offset +
+                                                        span.StartLine());
+        mapping->mutable_verilog_span()->set_line_end(line_offset +
+                                                      span.EndLine());
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
-absl::StatusOr<std::string> GenerateVerilog(Block* top,
-                                            const CodegenOptions& options,
-                                            VerilogLineMap* verilog_line_map) {
+absl::Status GenerateVerilogToStream(Block* top, const CodegenOptions& options,
+                                     std::ostream& os,
+                                     VerilogLineMap* verilog_line_map) {
   XLS_VLOG(2) << absl::StreamFormat(
       "Generating Verilog for packge with with top level block `%s`:",
       top->name());
@@ -811,43 +900,74 @@ absl::StatusOr<std::string> GenerateVerilog(Block* top,
 
   XLS_ASSIGN_OR_RETURN(std::vector<Block*> blocks,
                        GatherInstantiatedBlocks(top));
-  VerilogFile file(options.use_system_verilog() ? FileType::kSystemVerilog
-                                                : FileType::kVerilog);
-  for (Block* block : blocks) {
-    XLS_RETURN_IF_ERROR(BlockGenerator::Generate(block, &file, options));
-    if (block != blocks.back()) {
-      file.Add(file.Make<BlankLine>(SourceInfo()));
-      file.Add(file.Make<BlankLine>(SourceInfo()));
+
+  // Each block is generated into its own file so that blocks can be generated
+  // concurrently. Generation only reads the IR of the blocks.
+  int64_t thread_count = options.codegen_threads();
+  if (thread_count <= 0) {
+    thread_count = std::max<int64_t>(std::thread::hardware_concurrency(), 1);
+  }
+  thread_count = std::clamp<int64_t>(thread_count, 1, blocks.size());
+  std::vector<GeneratedBlock> generated(blocks.size());
+  std::atomic<int64_t> next_block = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_block++; i < blocks.size(); i = next_block++) {
+      GeneratedBlock& block = generated[i];
+      block.file.emplace(options.use_system_verilog() ? FileType::kSystemVerilog
+                                                      : FileType::kVerilog);
+      block.status = BlockGenerator::Generate(blocks[i], &*block.file, options);
+      // With a single thread the text is emitted straight to `os` below
+      // rather than held in memory.
+      if (block.status.ok() && thread_count > 1) {
+        block.text = block.file->Emit(&block.line_info);
+      }
     }
+  };
+  if (thread_count == 1) {
+    worker();
+  } else {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t i = 0; i < thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    // Threads are joined on destruction.
   }
 
-  LineInfo line_info;
-  std::string text = file.Emit(&line_info);
-  if (verilog_line_map != nullptr) {
-    for (const auto& [vast_node, partial_spans] : line_info.Spans()) {
-      std::optional<std::vector<LineSpan>> spans =
-          line_info.LookupNode(vast_node);
-      if (!spans.has_value()) {
-        return absl::InternalError(
-            "Unbalanced calls to LineInfo::{Start, End}");
-      }
-      for (const LineSpan& span : spans.value()) {
-        SourceInfo info = vast_node->loc();
-        for (const SourceLocation& loc : info.locations) {
-          int64_t line = static_cast<int32_t>(loc.lineno());
-          VerilogLineMapping* mapping = verilog_line_map->add_mapping();
-          mapping->set_source_file(
-              top->package()->GetFilename(loc.fileno()).value_or(""));
-          mapping->mutable_source_span()->set_line_start(line);
-          mapping->mutable_source_span()->set_line_end(line);
-          mapping->set_verilog_file("");  // to be updated later on
-          mapping->mutable_verilog_span()->set_line_start(span.StartLine());
-          mapping->mutable_verilog_span()->set_line_end(span.EndLine());
-        }
-      }
+  // Write the modules in the order of `blocks` separated by two blank lines,
+  // which is the same text as a single file holding every module.
+  int64_t line_offset = 0;
+  for (int64_t i = 0; i < blocks.size(); ++i) {
+    GeneratedBlock& block = generated[i];
+    XLS_RETURN_IF_ERROR(block.status);
+    if (i != 0) {
+      os << "\n\n";
+      line_offset += 2;
+    }
+    if (block.text.has_value()) {
+      os << *block.text;
+    } else {
+      block.file->EmitToStream(os, &block.line_info);
     }
+    if (verilog_line_map != nullptr) {
+      XLS_RETURN_IF_ERROR(AddLineMappings(block.line_info, line_offset,
+                                          top->package(), verilog_line_map));
+    }
+    line_offset += block.line_info.current_line_number();
   }
 
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::string> GenerateVerilog(Block* top,
+                                            const CodegenOptions& options,
+                                            VerilogLineMap* verilog_line_map) {
+  ScopedTrace trace("GenerateVerilog", "codegen");
+  std::ostringstream os;
+  XLS_RETURN_IF_ERROR(
+      GenerateVerilogToStream(top, options, os, verilog_line_map));
+  std::string text = os.str();
+
   XLS_VLOG(2) << "Verilog output:";
   XLS_VLOG_LINES(2, text);
 
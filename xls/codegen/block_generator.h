@@ -15,8 +15,10 @@
 #ifndef XLS_CODEGEN_BLOCK_GENERATOR_H_
 #define XLS_CODEGEN_BLOCK_GENERATOR_H_
 
+#include <ostream>
 #include <string>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/verilog_line_map.pb.h"
@@ -32,6 +34,13 @@ absl::StatusOr<std::string> GenerateVerilog(
     Block* top, const CodegenOptions& options,
     VerilogLineMap* verilog_line_map = nullptr);
 
+// As GenerateVerilog but writes the text to `os` as it is generated instead of
+// returning it, so the text of large designs is never held in memory as a
+// whole. If an error is returned, `os` may hold partial output.
+absl::Status GenerateVerilogToStream(
+    Block* top, const CodegenOptions& options, std::ostream& os,
+    VerilogLineMap* verilog_line_map = nullptr);
+
 }  // namespace verilog
 }  // namespace xls
 
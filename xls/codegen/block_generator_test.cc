@@ -14,10 +14,15 @@
 
 #include "xls/codegen/block_generator.h"
 
+#include <cstdint>
+#include <string>
+
+#include "absl/strings/str_cat.h"
 #include "xls/codegen/block_conversion.h"
 #include "xls/codegen/codegen_pass.h"
 #include "xls/codegen/op_override_impls.h"
 #include "xls/codegen/signature_generator.h"
+#include "xls/codegen/verilog_line_map.pb.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/matchers.h"
 #include "xls/delay_model/delay_estimator.h"
@@ -971,6 +976,44 @@ TEST_P(BlockGeneratorTest, DiamondDependencyInstantiations) {
   XLS_ASSERT_OK(tb.Run());
 }
 
+TEST_P(BlockGeneratorTest, InstantiatedBlocksGeneratedConcurrently) {
+  Package package(TestBaseName());
+  Type* u32 = package.GetBitsType(32);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Block * sub_block,
+                           MakeSubtractBlock("subtractor", &package));
+  BlockBuilder bb("my_block", &package);
+  BValue j = bb.InputPort("j", u32);
+  BValue k = bb.InputPort("k", u32);
+  for (int64_t i = 0; i < 4; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Block * delegator,
+        MakeDelegatingBlock(absl::StrCat("delegator", i), sub_block, &package));
+    XLS_ASSERT_OK_AND_ASSIGN(xls::Instantiation * instantiation,
+                             bb.block()->AddBlockInstantiation(
+                                 absl::StrCat("deleg", i), delegator));
+    bb.InstantiationInput(instantiation, "x", j);
+    bb.InstantiationInput(instantiation, "y", k);
+    bb.OutputPort(absl::StrCat("z", i),
+                  bb.InstantiationOutput(instantiation, "z"));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  VerilogLineMap serial_line_map;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string serial_verilog,
+      GenerateVerilog(block, codegen_options(), &serial_line_map));
+  for (int64_t threads : {0, 2, 8}) {
+    VerilogLineMap line_map;
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::string verilog,
+        GenerateVerilog(block, codegen_options().codegen_threads(threads),
+                        &line_map));
+    EXPECT_EQ(verilog, serial_verilog);
+    EXPECT_EQ(line_map.mapping_size(), serial_line_map.mapping_size());
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(BlockGeneratorTestInstantiation, BlockGeneratorTest,
                          testing::ValuesIn(kDefaultSimulationTargets),
                          ParameterizedTestName<BlockGeneratorTest>);
@@ -15,6 +15,7 @@
 #ifndef XLS_CODEGEN_CODEGEN_OPTIONS_H_
 #define XLS_CODEGEN_CODEGEN_OPTIONS_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -224,6 +225,16 @@ class CodegenOptions {
   CodegenOptions& gate_recvs(bool value);
   bool gate_recvs() const { return gate_recvs_; }
 
+  // Number of threads used to generate Verilog for the top block and the blocks
+  // it instantiates. Each block is generated and emitted into its own module
+  // text and the modules are written in a fixed order, so the output does not
+  // depend on the number of threads. If zero, one thread per hardware thread
+  // is used.
+  //
+  // Default is 1.
+  CodegenOptions& codegen_threads(int64_t value);
+  int64_t codegen_threads() const { return codegen_threads_; }
+
   // List of channels to rewrite for RAMs.
   CodegenOptions& ram_configurations(
       absl::Span<const std::unique_ptr<RamConfiguration>> ram_configurations);
@@ -254,6 +265,7 @@ class CodegenOptions {
   std::string streaming_channel_valid_suffix_ = "_vld";
   bool array_index_bounds_checking_ = true;
   bool gate_recvs_ = true;
+  int64_t codegen_threads_ = 1;
   std::vector<std::unique_ptr<RamConfiguration>> ram_configurations_;
 };
 
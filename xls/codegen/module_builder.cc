@@ -357,7 +357,7 @@ LogicRef* ModuleBuilder::DeclareVariable(std::string_view name, Type* type) {
         file_->UnpackedArrayType(NestedElementWidth(array_type),
                                  NestedArrayBounds(array_type), SourceInfo());
   } else {
-    data_type = file_->BitVectorType(type->GetFlatBitCount(), SourceInfo());
+    data_type = WireDataType(type->GetFlatBitCount());
   }
   return module_->AddWire(SanitizeIdentifier(name), data_type, SourceInfo(),
                           declaration_section());
@@ -365,11 +365,18 @@ LogicRef* ModuleBuilder::DeclareVariable(std::string_view name, Type* type) {
 
 LogicRef* ModuleBuilder::DeclareVariable(std::string_view name,
                                          int64_t bit_count) {
-  return module_->AddWire(SanitizeIdentifier(name),
-                          file_->BitVectorType(bit_count, SourceInfo()),
+  return module_->AddWire(SanitizeIdentifier(name), WireDataType(bit_count),
                           SourceInfo(), declaration_section());
 }
 
+DataType* ModuleBuilder::WireDataType(int64_t bit_count) {
+  auto [it, inserted] = wire_data_types_.try_emplace(bit_count, nullptr);
+  if (inserted) {
+    it->second = file_->BitVectorType(bit_count, SourceInfo());
+  }
+  return it->second;
+}
+
 bool ModuleBuilder::CanEmitAsInlineExpression(
     Node* node, std::optional<absl::Span<Node* const>> users_of_expression) {
   if (node->GetType()->IsArray()) {
@@ -240,6 +240,9 @@ class ModuleBuilder {
   VerilogFile* file() const { return file_; }
 
  private:
+  // Returns the (shared) data type of a declared wire of `bit_count` bits.
+  DataType* WireDataType(int64_t bit_count);
+
   // Assigns 'rhs' to 'lhs'. Depending upon the type this may require multiple
   // assignment statements (e.g., for array assignments in Verilog). The
   // function add_assignment should add a single assignment
@@ -348,6 +351,11 @@ class ModuleBuilder {
   absl::flat_hash_map<std::string, VerilogFunction*> node_functions_;
 
   std::optional<BddQueryEngine> query_engine_;
+
+  // Data types of declared wires, indexed by bit count. Data types are
+  // immutable so one is shared by all wires of a width rather than allocating
+  // a new type (and width literal) per declaration.
+  absl::flat_hash_map<int64_t, DataType*> wire_data_types_;
 };
 
 }  // namespace verilog
@@ -15,19 +15,26 @@
 #include "xls/codegen/vast.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <optional>
+#include <ostream>
+#include <sstream>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <variant>
 #include <vector>
 
+#include "absl/functional/function_ref.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_replace.h"
+#include "absl/strings/str_split.h"
 #include "absl/types/variant.h"
 #include "xls/common/indent.h"
 #include "xls/common/logging/logging.h"
@@ -160,6 +167,25 @@ std::string Include::Emit(LineInfo* line_info) const {
   return absl::StrFormat("`include \"%s\"", path_);
 }
 
+// Size of the blocks from which VerilogFile allocates its nodes. Nodes larger
+// than this get a block of their own.
+constexpr int64_t kArenaBlockSize = 64 * 1024;
+
+void* VerilogFile::Allocate(size_t size, size_t alignment) {
+  XLS_CHECK_LE(alignment, alignof(std::max_align_t));
+  const int64_t align = static_cast<int64_t>(alignment);
+  const int64_t bytes = static_cast<int64_t>(size);
+  int64_t offset = (arena_block_offset_ + align - 1) & ~(align - 1);
+  if (arena_blocks_.empty() || offset + bytes > kArenaBlockSize) {
+    const int64_t block_size = std::max(kArenaBlockSize, bytes);
+    arena_blocks_.push_back(std::unique_ptr<char[]>(new char[block_size]));
+    arena_memory_account_.Add(block_size);
+    offset = 0;
+  }
+  arena_block_offset_ = offset + bytes;
+  return arena_blocks_.back().get() + offset;
+}
+
 DataType* VerilogFile::BitVectorTypeNoScalar(int64_t bit_count,
                                              const SourceInfo& loc,
                                              bool is_signed) {
@@ -216,21 +242,22 @@ DataType* VerilogFile::UnpackedArrayType(int64_t element_bit_count,
 }
 
 std::string VerilogFile::Emit(LineInfo* line_info) const {
-  auto file_member_str = [=](const FileMember& member) -> std::string {
-    return absl::visit(
-        Visitor{[=](Include* m) -> std::string { return m->Emit(line_info); },
-                [=](Module* m) -> std::string { return m->Emit(line_info); },
-                [=](BlankLine* m) -> std::string { return m->Emit(line_info); },
-                [=](Comment* m) -> std::string { return m->Emit(line_info); }},
-        member);
-  };
+  std::ostringstream os;
+  EmitToStream(os, line_info);
+  return os.str();
+}
 
-  std::string out;
+void VerilogFile::EmitToStream(std::ostream& os, LineInfo* line_info) const {
   for (const FileMember& member : members_) {
-    absl::StrAppend(&out, file_member_str(member), "\n");
+    absl::visit(
+        Visitor{[&](Include* m) { os << m->Emit(line_info); },
+                [&](Module* m) { m->EmitToStream(os, line_info); },
+                [&](BlankLine* m) { os << m->Emit(line_info); },
+                [&](Comment* m) { os << m->Emit(line_info); }},
+        member);
+    os << "\n";
     LineInfoIncrease(line_info, 1);
   }
-  return out;
 }
 
 LocalParamItemRef* LocalParam::AddItem(std::string_view name,
@@ -576,22 +603,40 @@ std::string EmitModuleMember(LineInfo* line_info, const ModuleMember& member) {
 }  // namespace
 
 std::string ModuleSection::Emit(LineInfo* line_info) const {
+  std::string result;
+  bool first = true;
+  EmitMembers(line_info, [&](std::string_view text) {
+    absl::StrAppend(&result, first ? "" : "\n", text);
+    first = false;
+  });
+  return result;
+}
+
+int64_t ModuleSection::EmitMembers(
+    LineInfo* line_info,
+    absl::FunctionRef<void(std::string_view)> write_member) const {
   LineInfoStart(line_info, this);
-  std::vector<std::string> elements;
+  int64_t member_count = 0;
   for (const ModuleMember& member : members_) {
-    if (std::holds_alternative<ModuleSection*>(member)) {
-      if (std::get<ModuleSection*>(member)->members_.empty()) {
+    if (ModuleSection* const* section = std::get_if<ModuleSection*>(&member)) {
+      if ((*section)->members_.empty()) {
         continue;
       }
+      if ((*section)->EmitMembers(line_info, write_member) == 0) {
+        // A section holding only empty sections still occupies a line.
+        write_member("");
+      }
+    } else {
+      write_member(EmitModuleMember(line_info, member));
     }
-    elements.push_back(EmitModuleMember(line_info, member));
+    ++member_count;
     LineInfoIncrease(line_info, 1);
   }
-  if (!elements.empty()) {
+  if (member_count > 0) {
     LineInfoIncrease(line_info, -1);
   }
   LineInfoEnd(line_info, this);
-  return absl::StrJoin(elements, "\n");
+  return member_count;
 }
 
 std::string ContinuousAssignment::Emit(LineInfo* line_info) const {
@@ -684,29 +729,50 @@ std::string SystemFunctionCall::Emit(LineInfo* line_info) const {
 }
 
 std::string Module::Emit(LineInfo* line_info) const {
+  std::ostringstream os;
+  EmitToStream(os, line_info);
+  return os.str();
+}
+
+void Module::EmitToStream(std::ostream& os, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::string result = absl::StrCat("module ", name_);
+  os << "module " << name_;
   if (ports_.empty()) {
-    absl::StrAppend(&result, ";\n");
+    os << ";\n";
     LineInfoIncrease(line_info, 1);
   } else {
-    absl::StrAppend(&result, "(\n  ");
+    os << "(\n  ";
     LineInfoIncrease(line_info, 1);
-    absl::StrAppend(
-        &result,
-        absl::StrJoin(ports_, ",\n  ", [=](std::string* out, const Port& port) {
-          absl::StrAppendFormat(out, "%s %s", ToString(port.direction),
-                                port.wire->EmitNoSemi(line_info));
-          LineInfoIncrease(line_info, 1);
-        }));
-    absl::StrAppend(&result, "\n);\n");
+    for (int64_t i = 0; i < ports_.size(); ++i) {
+      if (i != 0) {
+        os << ",\n  ";
+      }
+      os << ToString(ports_[i].direction) << " "
+         << ports_[i].wire->EmitNoSemi(line_info);
+      LineInfoIncrease(line_info, 1);
+    }
+    os << "\n);\n";
     LineInfoIncrease(line_info, 1);
   }
-  absl::StrAppend(&result, Indent(top_.Emit(line_info)), "\n");
+  // Produces the same text as Indent(top_.Emit(line_info)): empty lines are
+  // not indented and leading empty lines are dropped.
+  const std::string indent(kDefaultIndentSpaces, ' ');
+  bool wrote_line = false;
+  top_.EmitMembers(line_info, [&](std::string_view text) {
+    for (std::string_view line : absl::StrSplit(text, '\n')) {
+      if (wrote_line) {
+        os << "\n";
+      }
+      if (!line.empty()) {
+        os << indent << line;
+        wrote_line = true;
+      }
+    }
+  });
+  os << "\n";
   LineInfoIncrease(line_info, 1);
-  absl::StrAppend(&result, "endmodule");
+  os << "endmodule";
   LineInfoEnd(line_info, this);
-  return result;
 }
 
 std::string Literal::Emit(LineInfo* line_info) const {
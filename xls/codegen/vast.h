@@ -18,7 +18,10 @@
 #ifndef XLS_CODEGEN_VAST_H_
 #define XLS_CODEGEN_VAST_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <new>
 #include <optional>
 #include <ostream>
 #include <string>
@@ -28,10 +31,12 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/codegen/module_signature.pb.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/memory_accounting.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/format_preference.h"
 #include "xls/ir/source_location.h"
@@ -127,6 +132,9 @@ class LineInfo {
   // sequence of calls that does not include negative numbers.
   void Increase(int64_t delta);
 
+  // Returns the current line number, i.e., the number of lines emitted so far.
+  int64_t current_line_number() const { return current_line_number_; }
+
   // Returns the underlying relation between nodes and spans.
   const absl::flat_hash_map<const VastNode*, PartialLineSpans>& Spans() const {
     return spans_;
@@ -1491,6 +1499,16 @@ class ModuleSection : public VastNode {
   std::string Emit(LineInfo* line_info) const override;
 
  private:
+  friend class Module;
+
+  // Passes the text of each member to `write_member` in order, updating
+  // `line_info` as Emit does. The members of nested sections are passed one at
+  // a time, as if the nested section were flattened into this one. Returns the
+  // number of members passed.
+  int64_t EmitMembers(
+      LineInfo* line_info,
+      absl::FunctionRef<void(std::string_view)> write_member) const;
+
   std::vector<ModuleMember> members_;
 };
 
@@ -1553,6 +1571,9 @@ class Module : public VastNode {
 
   std::string Emit(LineInfo* line_info) const override;
 
+  // Writes the same text as Emit to `os`, one module member at a time.
+  void EmitToStream(std::ostream& os, LineInfo* line_info) const;
+
  private:
   // Add the given Def as a port on the module.
   LogicRef* AddPortDef(Direction direction, Def* def, const SourceInfo& loc);
@@ -1597,17 +1618,24 @@ class VerilogFile {
     return member;
   }
 
+  // Constructs a node owned by this file. Nodes are carved out of large
+  // arena blocks rather than allocated individually, which keeps the per-node
+  // overhead low when generating very large modules.
   template <typename T, typename... Args>
   T* Make(const SourceInfo& loc, Args&&... args) {
-    std::unique_ptr<T> value =
-        std::make_unique<T>(std::forward<Args>(args)..., this, loc);
-    T* ptr = value.get();
-    nodes_.push_back(std::move(value));
+    T* ptr = new (Allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)..., this, loc);
+    nodes_.push_back(std::unique_ptr<VastNode, NodeDestroyer>(ptr));
     return ptr;
   }
 
   std::string Emit(LineInfo* line_info = nullptr) const;
 
+  // Writes the same text as Emit to `os` incrementally, so the text of the
+  // whole file is never held in memory. Modules are written one member at a
+  // time; `line_info` is updated exactly as by Emit.
+  void EmitToStream(std::ostream& os, LineInfo* line_info = nullptr) const;
+
   verilog::Slice* Slice(IndexableExpression* subject, Expression* hi,
                         Expression* lo, const SourceInfo& loc) {
     return Make<verilog::Slice>(loc, subject, hi, lo);
@@ -1849,9 +1877,23 @@ class VerilogFile {
                : Literal(SBits(value, 64), loc);
   }
 
+  // Runs the destructor of an arena-allocated node without freeing its
+  // memory, which is owned by `arena_blocks_`.
+  struct NodeDestroyer {
+    void operator()(VastNode* node) const { node->~VastNode(); }
+  };
+
+  // Returns `size` bytes of arena memory aligned to `alignment`.
+  void* Allocate(size_t size, size_t alignment);
+
   FileType file_type_;
   std::vector<FileMember> members_;
-  std::vector<std::unique_ptr<VastNode>> nodes_;
+  // Declared before `nodes_` so the nodes are destroyed before the memory
+  // holding them is released.
+  std::vector<std::unique_ptr<char[]>> arena_blocks_;
+  int64_t arena_block_offset_ = 0;
+  MemoryAccount arena_memory_account_{MemoryTag::kVast};
+  std::vector<std::unique_ptr<VastNode, NodeDestroyer>> nodes_;
 };
 
 template <typename T, typename... Args>
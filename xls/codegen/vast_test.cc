@@ -14,6 +14,7 @@
 
 #include "xls/codegen/vast.h"
 
+#include <sstream>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -1239,6 +1240,53 @@ endmodule)");
             std::vector<LineSpan>{LineSpan(7, 7)});
 }
 
+TEST_P(VastTest, EmitToStreamMatchesEmit) {
+  VerilogFile f(GetFileType());
+  f.Add(f.Make<Comment>(SourceInfo(), "header"));
+  Module* module = f.AddModule("my_module", SourceInfo());
+  // Leading blank lines in the module body are dropped by the indentation.
+  module->Add<BlankLine>(SourceInfo());
+  LogicRef* a =
+      module->AddInput("a", f.BitVectorType(8, SourceInfo()), SourceInfo());
+  LogicRef* out =
+      module->AddOutput("out", f.BitVectorType(8, SourceInfo()), SourceInfo());
+  ModuleSection* section = module->Add<ModuleSection>(SourceInfo());
+  section->Add<Comment>(SourceInfo(), "line 1\nline 2");
+  section->Add<ModuleSection>(SourceInfo())->Add<ModuleSection>(SourceInfo());
+  module->Add<BlankLine>(SourceInfo());
+  module->Add<ContinuousAssignment>(SourceInfo(), out, a);
+  f.Add(f.Make<BlankLine>(SourceInfo()));
+  f.AddModule("empty_module", SourceInfo());
+
+  LineInfo line_info;
+  std::string text = f.Emit(&line_info);
+  EXPECT_EQ(text, R"(// header
+module my_module(
+  input wire [7:0] a,
+  output wire [7:0] out
+);
+  // line 1
+  // line 2
+
+
+  assign out = a;
+endmodule
+
+module empty_module;
+
+endmodule
+)");
+
+  LineInfo stream_line_info;
+  std::ostringstream os;
+  f.EmitToStream(os, &stream_line_info);
+  EXPECT_EQ(os.str(), text);
+  EXPECT_EQ(stream_line_info.LookupNode(module),
+            line_info.LookupNode(module));
+  EXPECT_EQ(stream_line_info.LookupNode(section),
+            line_info.LookupNode(section));
+}
+
 TEST_P(VastTest, VerilogFunction) {
   VerilogFile f(GetFileType());
   Module* m = f.AddModule("top", SourceInfo());
@@ -1470,6 +1518,26 @@ endmodule)");
             std::vector<LineSpan>{LineSpan(9, 9)});
 }
 
+// Builds enough nodes to span many arena blocks of the file.
+TEST_P(VastTest, ManyNodes) {
+  constexpr int64_t kWireCount = 10000;
+  VerilogFile f(GetFileType());
+  Module* m = f.AddModule("top", SourceInfo());
+  Expression* sum =
+      m->AddInput("a", f.BitVectorType(8, SourceInfo()), SourceInfo());
+  for (int64_t i = 0; i < kWireCount; ++i) {
+    LogicRef* wire = m->AddWire(absl::StrCat("w", i),
+                                f.BitVectorType(8, SourceInfo()), SourceInfo());
+    m->Add<ContinuousAssignment>(
+        SourceInfo(), wire, f.Add(sum, f.Literal(i % 256, 8, SourceInfo()),
+                                  SourceInfo()));
+    sum = wire;
+  }
+  std::string text = f.Emit();
+  EXPECT_THAT(text, HasSubstr("assign w0 = a + 8'h00;"));
+  EXPECT_THAT(text, HasSubstr("assign w9999 = w9998 + 8'h0f;"));
+}
+
 INSTANTIATE_TEST_SUITE_P(VastTestInstantiation, VastTest,
                          testing::Values(false, true),
                          [](const testing::TestParamInfo<bool>& info) {
@@ -0,0 +1,130 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/file/content_addressed_cache.h"
+
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "openssl/sha.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls {
+
+CacheKeyBuilder::CacheKeyBuilder(std::string_view format_version) {
+  SHA256_Init(&ctx_);
+  Add(format_version);
+}
+
+void CacheKeyBuilder::Add(std::string_view s) {
+  uint64_t size = s.size();
+  SHA256_Update(&ctx_, &size, sizeof(size));
+  SHA256_Update(&ctx_, s.data(), s.size());
+}
+
+std::string CacheKeyBuilder::Finish() {
+  uint8_t digest[SHA256_DIGEST_LENGTH];
+  SHA256_Final(digest, &ctx_);
+  return absl::BytesToHexString(std::string_view(
+      reinterpret_cast<const char*>(digest), SHA256_DIGEST_LENGTH));
+}
+
+namespace {
+
+absl::StatusOr<std::string> ComputeExecutableFingerprint() {
+  XLS_ASSIGN_OR_RETURN(std::filesystem::path path, GetSelfExecutablePath());
+  std::error_code ec;
+  uintmax_t size = std::filesystem::file_size(path, ec);
+  std::filesystem::file_time_type mtime;
+  if (!ec) {
+    mtime = std::filesystem::last_write_time(path, ec);
+  }
+  if (ec) {
+    return absl::InternalError(absl::StrFormat(
+        "Failed to stat %s: %s", path.string(), ec.message()));
+  }
+  return absl::StrCat(path.string(), ":", size, ":",
+                      mtime.time_since_epoch().count());
+}
+
+}  // namespace
+
+absl::StatusOr<std::string> ExecutableFingerprint() {
+  static const absl::StatusOr<std::string>* fingerprint =
+      new absl::StatusOr<std::string>(ComputeExecutableFingerprint());
+  return *fingerprint;
+}
+
+ContentAddressedCache::ContentAddressedCache(std::filesystem::path directory,
+                                             std::string suffix)
+    : directory_(std::move(directory)), suffix_(std::move(suffix)) {}
+
+std::filesystem::path ContentAddressedCache::EntryPath(
+    std::string_view key) const {
+  return directory_ / absl::StrCat(key, suffix_);
+}
+
+absl::StatusOr<std::optional<std::string>> ContentAddressedCache::Lookup(
+    std::string_view key) const {
+  std::filesystem::path path = EntryPath(key);
+  if (!FileExists(path).ok()) {
+    return std::nullopt;
+  }
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+  return contents;
+}
+
+absl::Status ContentAddressedCache::Insert(std::string_view key,
+                                           std::string_view contents) const {
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(directory_));
+  std::filesystem::path path = EntryPath(key);
+  // The process id and sequence number make the temporary file unique to this
+  // call across processes and threads.
+  static std::atomic<int64_t> next_temp_id = 0;
+  std::filesystem::path temp_path = path;
+  temp_path += absl::StrFormat(".tmp.%d.%d", getpid(), next_temp_id++);
+  absl::Status status = SetFileContents(temp_path, contents);
+  if (status.ok()) {
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    if (!ec) {
+      return absl::OkStatus();
+    }
+    status = absl::InternalError(
+        absl::StrFormat("Failed to rename %s to %s: %s", temp_path.string(),
+                        path.string(), ec.message()));
+  }
+  // Best effort; the original error is more useful than one from removing the
+  // file.
+  std::error_code ec;
+  std::filesystem::remove(temp_path, ec);
+  return status;
+}
+
+}  // namespace xls
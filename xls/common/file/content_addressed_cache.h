@@ -0,0 +1,94 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_FILE_CONTENT_ADDRESSED_CACHE_H_
+#define XLS_COMMON_FILE_CONTENT_ADDRESSED_CACHE_H_
+
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "openssl/sha.h"
+
+namespace xls {
+
+// Incrementally computes the key of a cache entry: the hex SHA-256 digest of a
+// sequence of strings. Each string is prefixed with its length so distinct
+// sequences have distinct encodings.
+class CacheKeyBuilder {
+ public:
+  // `format_version` is the first string of the sequence. It should be bumped
+  // whenever the format of the cached values or the composition of the keys
+  // changes, so stale entries are not reused.
+  explicit CacheKeyBuilder(std::string_view format_version);
+
+  void Add(std::string_view s);
+
+  template <typename T>
+  void Add(const std::optional<T>& value) {
+    Add(value.has_value() ? absl::StrCat("some:", *value) : "none");
+  }
+
+  // Returns the key. The builder must not be used afterwards.
+  std::string Finish();
+
+ private:
+  SHA256_CTX ctx_;
+};
+
+// Returns a string identifying the build of the running executable, derived
+// from the path, size and modification time of its file. Keys of values which
+// the executable computes should include it, so that a rebuilt tool, whose
+// results may differ, does not reuse entries of an older build. Computed once
+// per process.
+absl::StatusOr<std::string> ExecutableFingerprint();
+
+// An on-disk cache of values addressed by keys which cover everything the
+// values depend on (see CacheKeyBuilder), so entries never need to be
+// invalidated; stale entries may simply be deleted. Each entry is a file in
+// the cache directory named after its key. Safe to use from multiple threads
+// and processes at once.
+class ContentAddressedCache {
+ public:
+  // Entries are stored in `directory`, which is created on the first insert,
+  // in files named `<key><suffix>`.
+  ContentAddressedCache(std::filesystem::path directory, std::string suffix);
+
+  const std::filesystem::path& directory() const { return directory_; }
+
+  // Returns the path of the file holding the entry for `key`.
+  std::filesystem::path EntryPath(std::string_view key) const;
+
+  // Returns the contents of the entry for `key`, or std::nullopt if there is
+  // none.
+  absl::StatusOr<std::optional<std::string>> Lookup(std::string_view key) const;
+
+  // Sets the contents of the entry for `key`, replacing any existing entry.
+  // The entry is written to a temporary file unique to the call and renamed
+  // so concurrent readers never observe a partially written entry. The
+  // temporary file is removed if the insert fails.
+  absl::Status Insert(std::string_view key, std::string_view contents) const;
+
+ private:
+  std::filesystem::path directory_;
+  std::string suffix_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_FILE_CONTENT_ADDRESSED_CACHE_H_
@@ -0,0 +1,127 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/file/content_addressed_cache.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/thread.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::Optional;
+using ::testing::StartsWith;
+
+std::vector<std::filesystem::path> ListDirectory(
+    const std::filesystem::path& directory) {
+  std::vector<std::filesystem::path> paths;
+  for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+    paths.push_back(entry.path());
+  }
+  return paths;
+}
+
+TEST(CacheKeyBuilderTest, KeysDependOnVersionAndSequence) {
+  auto key = [](std::string_view version, std::vector<std::string> strings) {
+    CacheKeyBuilder builder(version);
+    for (const std::string& s : strings) {
+      builder.Add(s);
+    }
+    return builder.Finish();
+  };
+  EXPECT_EQ(key("v1", {"a", "b"}), key("v1", {"a", "b"}));
+  EXPECT_EQ(key("v1", {"a"}).size(), 64);
+  EXPECT_NE(key("v1", {"a", "b"}), key("v2", {"a", "b"}));
+  // Length prefixes keep the boundaries between strings significant.
+  EXPECT_NE(key("v1", {"a", "b"}), key("v1", {"ab"}));
+  EXPECT_NE(key("v1", {"a", "b"}), key("v1", {"a", "b", ""}));
+
+  CacheKeyBuilder none("v1");
+  none.Add(std::optional<int64_t>());
+  CacheKeyBuilder zero("v1");
+  zero.Add(std::optional<int64_t>(0));
+  EXPECT_NE(none.Finish(), zero.Finish());
+}
+
+TEST(ExecutableFingerprintTest, IdentifiesRunningExecutable) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::string fingerprint, ExecutableFingerprint());
+  XLS_ASSERT_OK_AND_ASSIGN(std::filesystem::path path,
+                           GetSelfExecutablePath());
+  EXPECT_THAT(fingerprint, StartsWith(path.string()));
+  EXPECT_THAT(ExecutableFingerprint(), IsOkAndHolds(fingerprint));
+}
+
+TEST(ContentAddressedCacheTest, LookupAndInsert) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  ContentAddressedCache cache(temp_dir.path() / "cache", ".txt");
+  EXPECT_EQ(cache.EntryPath("abc"), temp_dir.path() / "cache" / "abc.txt");
+  EXPECT_THAT(cache.Lookup("abc"), IsOkAndHolds(std::nullopt));
+
+  XLS_ASSERT_OK(cache.Insert("abc", "contents"));
+  EXPECT_THAT(cache.Lookup("abc"),
+              IsOkAndHolds(Optional(std::string("contents"))));
+  XLS_ASSERT_OK(cache.Insert("abc", "replaced"));
+  EXPECT_THAT(cache.Lookup("abc"),
+              IsOkAndHolds(Optional(std::string("replaced"))));
+  EXPECT_EQ(ListDirectory(cache.directory()).size(), 1);
+}
+
+TEST(ContentAddressedCacheTest, ConcurrentInserts) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  ContentAddressedCache cache(temp_dir.path(), ".txt");
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 0; i < 8; ++i) {
+    threads.push_back(std::make_unique<Thread>([&cache, i]() {
+      for (int64_t j = 0; j < 50; ++j) {
+        XLS_EXPECT_OK(cache.Insert("key", absl::StrCat("value ", i)));
+      }
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  // Every insert wrote a whole entry and no temporary file is left behind.
+  XLS_ASSERT_OK_AND_ASSIGN(std::optional<std::string> contents,
+                           cache.Lookup("key"));
+  ASSERT_TRUE(contents.has_value());
+  EXPECT_THAT(*contents, StartsWith("value "));
+  EXPECT_EQ(ListDirectory(temp_dir.path()).size(), 1);
+}
+
+TEST(ContentAddressedCacheTest, FailedInsertRemovesTemporaryFile) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  ContentAddressedCache cache(temp_dir.path(), ".txt");
+  // A non-empty directory in place of the entry makes the rename fail.
+  XLS_ASSERT_OK(RecursivelyCreateDir(cache.EntryPath("key") / "child"));
+  EXPECT_FALSE(cache.Insert("key", "contents").ok());
+  EXPECT_EQ(ListDirectory(temp_dir.path()).size(), 1);
+}
+
+}  // namespace
+}  // namespace xls
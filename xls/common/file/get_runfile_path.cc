@@ -42,21 +42,6 @@ static Runfiles* runfiles;
 #include <sys/syslimits.h>
 #endif  /* __APPLE__ */
 
-absl::StatusOr<std::filesystem::path> GetSelfExecutablePath() {
-#if __linux__
-  return GetRealPath("/proc/self/exe");
-#elif __APPLE__
-  char path[PATH_MAX+1];
-  uint32_t size = PATH_MAX;
-  if (_NSGetExecutablePath(path, &size) == 0) {
-    return std::filesystem::path(path);
-  }
-  return absl::InvalidArgumentError("Self path could not fit into buffer");
-#else
-#error "Unknown platform"
-#endif
-}
-
 absl::StatusOr<Runfiles*> GetRunfiles(
     std::optional<std::string_view> argv0 = std::nullopt) {
   absl::MutexLock lock(&mutex);
@@ -82,6 +67,21 @@ absl::StatusOr<Runfiles*> GetRunfiles(
 
 }  // namespace
 
+absl::StatusOr<std::filesystem::path> GetSelfExecutablePath() {
+#if __linux__
+  return GetRealPath("/proc/self/exe");
+#elif __APPLE__
+  char path[PATH_MAX+1];
+  uint32_t size = PATH_MAX;
+  if (_NSGetExecutablePath(path, &size) == 0) {
+    return std::filesystem::path(path);
+  }
+  return absl::InvalidArgumentError("Self path could not fit into buffer");
+#else
+#error "Unknown platform"
+#endif
+}
+
 absl::StatusOr<std::filesystem::path> GetXlsRunfilePath(
     const std::filesystem::path& path) {
   XLS_ASSIGN_OR_RETURN(Runfiles * runfiles, GetRunfiles());
@@ -32,6 +32,9 @@ namespace xls {
 absl::StatusOr<std::filesystem::path> GetXlsRunfilePath(
     const std::filesystem::path& path);
 
+// Returns the path of the running executable, with symbolic links resolved.
+absl::StatusOr<std::filesystem::path> GetSelfExecutablePath();
+
 // Called by InitXls; don't call this directly. Sets up global state for the
 // other functions in this file.
 absl::Status InitRunfilesDir(const std::string& argv0);
@@ -0,0 +1,96 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/file/memory_mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>  // NOLINT
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/file_descriptor.h"
+#include "xls/common/status/error_code_to_status.h"
+#include "xls/common/status/status_builder.h"
+
+namespace xls {
+namespace {
+
+absl::Status ErrnoToStatusWithFilename(int errno_value, std::string_view action,
+                                       const std::filesystem::path& path) {
+  xabsl::StatusBuilder builder = ErrnoToStatus(errno_value);
+  builder << "Failed to " << action << " " << path.string();
+  return std::move(builder);
+}
+
+}  // namespace
+
+/*static*/ absl::StatusOr<MemoryMappedFile> MemoryMappedFile::Open(
+    const std::filesystem::path& path) {
+  FileDescriptor fd(open(path.c_str(), O_RDONLY));
+  if (fd.get() == -1) {
+    return ErrnoToStatusWithFilename(errno, "open", path);
+  }
+  struct stat st;
+  if (fstat(fd.get(), &st) == -1) {
+    return ErrnoToStatusWithFilename(errno, "stat", path);
+  }
+  size_t size = static_cast<size_t>(st.st_size);
+  if (size == 0) {
+    return MemoryMappedFile(nullptr, 0);
+  }
+  // The mapping stays valid after the file descriptor is closed.
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+  if (data == MAP_FAILED) {
+    return ErrnoToStatusWithFilename(errno, "map", path);
+  }
+  // Files are typically scanned front to back; let the OS read ahead.
+  (void)madvise(data, size, MADV_SEQUENTIAL);
+  return MemoryMappedFile(data, size);
+}
+
+MemoryMappedFile::~MemoryMappedFile() { Unmap(); }
+
+MemoryMappedFile::MemoryMappedFile(MemoryMappedFile&& other)
+    : data_(other.data_), size_(other.size_) {
+  other.data_ = nullptr;
+  other.size_ = 0;
+}
+
+MemoryMappedFile& MemoryMappedFile::operator=(MemoryMappedFile&& other) {
+  if (this != &other) {
+    Unmap();
+    data_ = other.data_;
+    size_ = other.size_;
+    other.data_ = nullptr;
+    other.size_ = 0;
+  }
+  return *this;
+}
+
+void MemoryMappedFile::Unmap() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+    data_ = nullptr;
+    size_ = 0;
+  }
+}
+
+}  // namespace xls
@@ -0,0 +1,60 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_FILE_MEMORY_MAPPED_FILE_H_
+#define XLS_COMMON_FILE_MEMORY_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <filesystem>  // NOLINT
+#include <string_view>
+
+#include "absl/status/statusor.h"
+
+namespace xls {
+
+// RAII wrapper for a read-only memory mapping of a whole file. The contents
+// are paged in by the OS as they are accessed, so a large file can be scanned
+// front to back without first being copied into memory (as GetFileContents
+// does). The file must not be modified while it is mapped.
+class MemoryMappedFile {
+ public:
+  static absl::StatusOr<MemoryMappedFile> Open(
+      const std::filesystem::path& path);
+
+  ~MemoryMappedFile();
+
+  MemoryMappedFile(const MemoryMappedFile&) = delete;
+  MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+  MemoryMappedFile(MemoryMappedFile&& other);
+  MemoryMappedFile& operator=(MemoryMappedFile&& other);
+
+  // The contents of the file; valid for the lifetime of this object.
+  std::string_view contents() const {
+    return std::string_view(static_cast<const char*>(data_), size_);
+  }
+
+ private:
+  MemoryMappedFile(void* data, size_t size) : data_(data), size_(size) {}
+
+  void Unmap();
+
+  // Null if the file is empty, as empty files cannot be mapped.
+  void* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_FILE_MEMORY_MAPPED_FILE_H_
@@ -21,6 +21,7 @@
 #include "absl/flags/usage.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/trace.h"
 
 namespace xls {
 
@@ -32,6 +33,7 @@ std::vector<std::string_view> InitXls(std::string_view usage, int argc,
   std::vector<char*> arguments(argv, argv + argc);
   std::vector<char*> remaining = absl::ParseCommandLine(argc, argv);
   XLS_CHECK_GE(argc, 1);
+  InitTracingFromFlags();
 
   return std::vector<std::string_view>(remaining.begin() + 1, remaining.end());
 }
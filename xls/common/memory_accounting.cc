@@ -0,0 +1,231 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/memory_accounting.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/const_init.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/file/filesystem.h"
+
+namespace xls {
+namespace {
+
+std::atomic<bool> accounting_enabled = false;
+
+struct TagCounters {
+  std::atomic<int64_t> live_bytes = 0;
+  std::atomic<int64_t> peak_live_bytes = 0;
+  std::atomic<int64_t> allocated_bytes = 0;
+  std::atomic<int64_t> allocation_count = 0;
+};
+
+std::array<TagCounters, kMemoryTagCount>& GetTagCounters() {
+  static auto* counters = new std::array<TagCounters, kMemoryTagCount>();
+  return *counters;
+}
+
+TagCounters& GetTagCounters(MemoryTag tag) {
+  return GetTagCounters()[static_cast<int64_t>(tag)];
+}
+
+struct RegionStats {
+  int64_t run_count = 0;
+  std::array<int64_t, kMemoryTagCount> allocated_bytes = {};
+  std::array<int64_t, kMemoryTagCount> live_bytes_change = {};
+};
+
+ABSL_CONST_INIT absl::Mutex regions_mutex(absl::kConstInit);
+
+// Completed regions in the order in which a region of each name first
+// completed.
+std::vector<std::pair<std::string, RegionStats>>& GetRegions()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(regions_mutex) {
+  static auto* regions = new std::vector<std::pair<std::string, RegionStats>>();
+  return *regions;
+}
+
+}  // namespace
+
+std::string_view MemoryTagName(MemoryTag tag) {
+  switch (tag) {
+    case MemoryTag::kIrNodes:
+      return "ir_nodes";
+    case MemoryTag::kQueryEngine:
+      return "query_engine";
+    case MemoryTag::kBddNodes:
+      return "bdd_nodes";
+    case MemoryTag::kJitBuffers:
+      return "jit_buffers";
+    case MemoryTag::kVast:
+      return "vast";
+    case MemoryTag::kDslxAst:
+      return "dslx_ast";
+  }
+  return "unknown";
+}
+
+void EnableMemoryAccounting() {
+  accounting_enabled.store(true, std::memory_order_relaxed);
+}
+
+bool MemoryAccountingEnabled() {
+  return accounting_enabled.load(std::memory_order_relaxed);
+}
+
+MemoryTagStats GetMemoryTagStats(MemoryTag tag) {
+  const TagCounters& counters = GetTagCounters(tag);
+  return MemoryTagStats{
+      .live_bytes = counters.live_bytes.load(std::memory_order_relaxed),
+      .peak_live_bytes =
+          counters.peak_live_bytes.load(std::memory_order_relaxed),
+      .allocated_bytes =
+          counters.allocated_bytes.load(std::memory_order_relaxed),
+      .allocation_count =
+          counters.allocation_count.load(std::memory_order_relaxed),
+  };
+}
+
+void RecordAllocation(MemoryTag tag, int64_t bytes) {
+  if (!MemoryAccountingEnabled() || bytes == 0) {
+    return;
+  }
+  TagCounters& counters = GetTagCounters(tag);
+  counters.allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+  counters.allocation_count.fetch_add(1, std::memory_order_relaxed);
+  int64_t live =
+      counters.live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  int64_t peak = counters.peak_live_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !counters.peak_live_bytes.compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+}
+
+void RecordRelease(MemoryTag tag, int64_t bytes) {
+  if (bytes == 0) {
+    return;
+  }
+  GetTagCounters(tag).live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+MemoryAccount& MemoryAccount::operator=(const MemoryAccount& other) {
+  if (this != &other) {
+    Remove(bytes_);
+    tag_ = other.tag_;
+    Add(other.bytes_);
+  }
+  return *this;
+}
+
+MemoryAccount& MemoryAccount::operator=(MemoryAccount&& other) {
+  if (this != &other) {
+    Remove(bytes_);
+    tag_ = other.tag_;
+    bytes_ = std::exchange(other.bytes_, 0);
+  }
+  return *this;
+}
+
+void MemoryAccount::Remove(int64_t bytes) {
+  bytes = std::min(bytes, bytes_);
+  bytes_ -= bytes;
+  RecordRelease(tag_, bytes);
+}
+
+void MemoryAccount::Set(int64_t bytes) {
+  if (bytes > bytes_) {
+    Add(bytes - bytes_);
+  } else {
+    Remove(bytes_ - bytes);
+  }
+}
+
+ScopedMemoryRegion::ScopedMemoryRegion(std::string_view name)
+    : name_(name) {
+  for (int64_t i = 0; i < kMemoryTagCount; ++i) {
+    MemoryTagStats stats = GetMemoryTagStats(static_cast<MemoryTag>(i));
+    allocated_bytes_at_start_[i] = stats.allocated_bytes;
+    live_bytes_at_start_[i] = stats.live_bytes;
+  }
+}
+
+ScopedMemoryRegion::~ScopedMemoryRegion() {
+  absl::MutexLock lock(&regions_mutex);
+  std::vector<std::pair<std::string, RegionStats>>& regions = GetRegions();
+  auto it = std::find_if(regions.begin(), regions.end(),
+                         [&](const auto& region) {
+                           return region.first == name_;
+                         });
+  if (it == regions.end()) {
+    regions.push_back({name_, RegionStats()});
+    it = regions.end() - 1;
+  }
+  RegionStats& region = it->second;
+  ++region.run_count;
+  for (int64_t i = 0; i < kMemoryTagCount; ++i) {
+    MemoryTagStats stats = GetMemoryTagStats(static_cast<MemoryTag>(i));
+    region.allocated_bytes[i] +=
+        stats.allocated_bytes - allocated_bytes_at_start_[i];
+    region.live_bytes_change[i] += stats.live_bytes - live_bytes_at_start_[i];
+  }
+}
+
+std::string MemoryAccountingReport() {
+  std::string report = absl::StrFormat(
+      "Memory accounting (bytes):\n%-14s %14s %14s %14s %12s\n", "subsystem",
+      "live", "peak", "allocated", "allocations");
+  for (int64_t i = 0; i < kMemoryTagCount; ++i) {
+    MemoryTag tag = static_cast<MemoryTag>(i);
+    MemoryTagStats stats = GetMemoryTagStats(tag);
+    absl::StrAppendFormat(&report, "%-14s %14d %14d %14d %12d\n",
+                          MemoryTagName(tag), stats.live_bytes,
+                          stats.peak_live_bytes, stats.allocated_bytes,
+                          stats.allocation_count);
+  }
+  absl::MutexLock lock(&regions_mutex);
+  for (const auto& [name, region] : GetRegions()) {
+    absl::StrAppendFormat(&report, "\nRegion %s (%d run%s):\n%-14s %14s %14s\n",
+                          name, region.run_count,
+                          region.run_count == 1 ? "" : "s", "subsystem",
+                          "allocated", "live change");
+    for (int64_t i = 0; i < kMemoryTagCount; ++i) {
+      absl::StrAppendFormat(&report, "%-14s %14d %+14d\n",
+                            MemoryTagName(static_cast<MemoryTag>(i)),
+                            region.allocated_bytes[i],
+                            region.live_bytes_change[i]);
+    }
+  }
+  return report;
+}
+
+absl::Status WriteMemoryAccountingReport(std::string_view path) {
+  if (path == "-") {
+    std::cerr << MemoryAccountingReport();
+    return absl::OkStatus();
+  }
+  return SetFileContents(path, MemoryAccountingReport());
+}
+
+}  // namespace xls
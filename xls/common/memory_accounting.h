@@ -0,0 +1,140 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_MEMORY_ACCOUNTING_H_
+#define XLS_COMMON_MEMORY_ACCOUNTING_H_
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "absl/status/status.h"
+
+namespace xls {
+
+// Optional attribution of memory use to the major XLS data structures. The
+// accounting is approximate: it counts the storage those structures allocate
+// in bulk (nodes, arena blocks and buffers), not every heap allocation.
+//
+// Accounting is off by default, in which case each update costs one relaxed
+// atomic load. It should be enabled at startup, before the accounted data
+// structures are created; memory allocated while it is disabled is never
+// attributed.
+
+// The subsystems whose memory is accounted.
+enum class MemoryTag : int8_t {
+  kIrNodes,      // Node objects of IR functions, procs and blocks.
+  kQueryEngine,  // Per-node values held by query engines.
+  kBddNodes,     // Node storage of binary decision diagrams.
+  kJitBuffers,   // Argument, result, state and temporary buffers of the JIT.
+  kVast,         // Arena blocks holding VAST (Verilog AST) nodes.
+  kDslxAst,      // Arena blocks holding DSLX AST nodes.
+};
+inline constexpr int64_t kMemoryTagCount = 6;
+
+// Returns a short snake_case name of `tag`, e.g. "ir_nodes".
+std::string_view MemoryTagName(MemoryTag tag);
+
+void EnableMemoryAccounting();
+bool MemoryAccountingEnabled();
+
+struct MemoryTagStats {
+  // Bytes currently attributed to the tag.
+  int64_t live_bytes = 0;
+  // High-water mark of `live_bytes`.
+  int64_t peak_live_bytes = 0;
+  // Total bytes ever attributed to the tag, and in how many allocations.
+  int64_t allocated_bytes = 0;
+  int64_t allocation_count = 0;
+};
+
+MemoryTagStats GetMemoryTagStats(MemoryTag tag);
+
+// Attributes `bytes` newly allocated or released by the subsystem `tag`.
+// Allocations are ignored while accounting is disabled. Prefer MemoryAccount,
+// which keeps allocations and releases balanced.
+void RecordAllocation(MemoryTag tag, int64_t bytes);
+void RecordRelease(MemoryTag tag, int64_t bytes);
+
+// The memory attributed to a tag on behalf of one object, typically a member
+// of the object owning the storage. Whatever is still accounted is released
+// when the account is destroyed. Copies account the same number of bytes as
+// the original; moves transfer the bytes.
+class MemoryAccount {
+ public:
+  explicit MemoryAccount(MemoryTag tag) : tag_(tag) {}
+  ~MemoryAccount() { Remove(bytes_); }
+
+  MemoryAccount(const MemoryAccount& other) : tag_(other.tag_) {
+    Add(other.bytes_);
+  }
+  MemoryAccount& operator=(const MemoryAccount& other);
+  MemoryAccount(MemoryAccount&& other)
+      : tag_(other.tag_), bytes_(other.bytes_) {
+    other.bytes_ = 0;
+  }
+  MemoryAccount& operator=(MemoryAccount&& other);
+
+  // Adds `bytes` to the account. Does nothing while accounting is disabled.
+  void Add(int64_t bytes) {
+    if (MemoryAccountingEnabled()) {
+      bytes_ += bytes;
+      RecordAllocation(tag_, bytes);
+    }
+  }
+
+  // Removes `bytes`, at most the bytes currently accounted.
+  void Remove(int64_t bytes);
+
+  // Adds or removes bytes so that the account holds `bytes`. Useful for
+  // containers whose capacity is re-measured after updates.
+  void Set(int64_t bytes);
+
+  int64_t bytes() const { return bytes_; }
+
+ private:
+  MemoryTag tag_;
+  int64_t bytes_ = 0;
+};
+
+// Records the memory attributed to each tag between construction and
+// destruction under `name`, e.g. "opt" or "codegen". Regions may nest and
+// overlap; each sees all attributions made while it is live, from any thread.
+// Regions of the same name accumulate.
+class ScopedMemoryRegion {
+ public:
+  explicit ScopedMemoryRegion(std::string_view name);
+  ~ScopedMemoryRegion();
+
+  ScopedMemoryRegion(const ScopedMemoryRegion&) = delete;
+  ScopedMemoryRegion& operator=(const ScopedMemoryRegion&) = delete;
+
+ private:
+  std::string name_;
+  std::array<int64_t, kMemoryTagCount> allocated_bytes_at_start_;
+  std::array<int64_t, kMemoryTagCount> live_bytes_at_start_;
+};
+
+// Returns a table of the statistics of every tag followed by, for each
+// completed memory region, the bytes allocated and the change in live bytes of
+// each tag within it.
+std::string MemoryAccountingReport();
+
+// Writes MemoryAccountingReport() to `path`, or to stderr if `path` is "-".
+absl::Status WriteMemoryAccountingReport(std::string_view path);
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_MEMORY_ACCOUNTING_H_
@@ -0,0 +1,85 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/memory_accounting.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace xls {
+namespace {
+
+using ::testing::HasSubstr;
+
+// Accounting is process-wide and cannot be disabled once enabled, so the tests
+// only check changes relative to the stats at their start.
+class MemoryAccountingTest : public ::testing::Test {
+ protected:
+  void SetUp() override { EnableMemoryAccounting(); }
+};
+
+TEST_F(MemoryAccountingTest, AccountTracksLiveAndPeakBytes) {
+  MemoryTagStats before = GetMemoryTagStats(MemoryTag::kBddNodes);
+  {
+    MemoryAccount account(MemoryTag::kBddNodes);
+    account.Add(1000);
+    account.Add(500);
+    account.Remove(700);
+    EXPECT_EQ(account.bytes(), 800);
+    MemoryTagStats during = GetMemoryTagStats(MemoryTag::kBddNodes);
+    EXPECT_EQ(during.live_bytes - before.live_bytes, 800);
+    EXPECT_GE(during.peak_live_bytes, before.live_bytes + 1500);
+    EXPECT_EQ(during.allocated_bytes - before.allocated_bytes, 1500);
+    EXPECT_EQ(during.allocation_count - before.allocation_count, 2);
+  }
+  // Destroying the account releases what it still held.
+  EXPECT_EQ(GetMemoryTagStats(MemoryTag::kBddNodes).live_bytes,
+            before.live_bytes);
+}
+
+TEST_F(MemoryAccountingTest, CopyAndMove) {
+  MemoryTagStats before = GetMemoryTagStats(MemoryTag::kVast);
+  MemoryAccount account(MemoryTag::kVast);
+  account.Set(256);
+  {
+    MemoryAccount copy = account;
+    EXPECT_EQ(copy.bytes(), 256);
+    EXPECT_EQ(GetMemoryTagStats(MemoryTag::kVast).live_bytes,
+              before.live_bytes + 512);
+  }
+  MemoryAccount moved = std::move(account);
+  EXPECT_EQ(moved.bytes(), 256);
+  EXPECT_EQ(GetMemoryTagStats(MemoryTag::kVast).live_bytes,
+            before.live_bytes + 256);
+  moved.Set(0);
+  EXPECT_EQ(GetMemoryTagStats(MemoryTag::kVast).live_bytes, before.live_bytes);
+}
+
+TEST_F(MemoryAccountingTest, RegionsAccumulateByName) {
+  MemoryAccount account(MemoryTag::kDslxAst);
+  for (int64_t i = 0; i < 2; ++i) {
+    ScopedMemoryRegion region("parse");
+    account.Add(100);
+  }
+  std::string report = MemoryAccountingReport();
+  EXPECT_THAT(report, HasSubstr("Region parse (2 runs):"));
+  EXPECT_THAT(report, HasSubstr("dslx_ast"));
+}
+
+}  // namespace
+}  // namespace xls
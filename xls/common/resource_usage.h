@@ -0,0 +1,28 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_RESOURCE_USAGE_H_
+#define XLS_COMMON_RESOURCE_USAGE_H_
+
+#include <cstdint>
+
+namespace xls {
+
+// Returns the high-water mark of the resident set size of the process in
+// bytes, or zero if it cannot be determined. The value never decreases.
+int64_t PeakRssBytes();
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_RESOURCE_USAGE_H_
@@ -0,0 +1,33 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/resource_usage.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace xls {
+namespace {
+
+TEST(ResourceUsageTest, PeakRssIsMonotone) {
+  int64_t before = PeakRssBytes();
+  EXPECT_GT(before, 0);
+  std::vector<char> buffer(int64_t{64} << 20, 1);
+  EXPECT_GE(PeakRssBytes(), before);
+}
+
+}  // namespace
+}  // namespace xls
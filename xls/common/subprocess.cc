@@ -26,13 +26,19 @@
 #include <cstring>
 #include <ctime>
 #include <filesystem>  // NOLINT
+#include <functional>
+#include <future>  // NOLINT(build/c++11)
+#include <memory>
 #include <optional>
 #include <ostream>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/fixed_array.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -58,9 +64,15 @@ struct Pipe {
   // Opens a Unix pipe with a C++ friendly interface.
   static absl::StatusOr<Pipe> Open() {
     int descriptors[2];
+#ifdef __linux__
+    // Atomically close-on-exec, so that subprocesses forked concurrently
+    // from other threads don't inherit the pipe and keep it open.
+    if (pipe2(descriptors, O_CLOEXEC) != 0) {
+#else
     if (pipe(descriptors) != 0 ||
         fcntl(descriptors[0], F_SETFD, FD_CLOEXEC) != 0||
         fcntl(descriptors[1], F_SETFD, FD_CLOEXEC) != 0) {
+#endif
       return absl::InternalError(
           absl::StrCat("Failed to initialize pipe:", Strerror(errno)));
     }
@@ -99,9 +111,12 @@ void PrepareAndExecInChildProcess(const std::vector<const char*>& argv_pointers,
 //
 // The 'result' vector is populated with all the data that was read in from the
 // fd's regardless to the status that is returned. Non-OK status will still
-// populate what it can into 'result'.
-absl::Status ReadFileDescriptors(absl::Span<FileDescriptor*> fds,
-                                 std::vector<std::string>& result) {
+// populate what it can into 'result'. Data from a fd with a non-empty sink is
+// passed to the sink instead.
+absl::Status ReadFileDescriptors(
+    absl::Span<FileDescriptor*> fds,
+    absl::Span<const std::function<void(std::string_view)>> sinks,
+    std::vector<std::string>& result) {
   absl::FixedArray<char> buffer(4096);
   result.resize(fds.size());
   std::vector<pollfd> poll_list;
@@ -145,7 +160,11 @@ absl::Status ReadFileDescriptors(absl::Span<FileDescriptor*> fds,
           // All data is read.
           close_fd_by_index(i);
         } else if (bytes > 0) {
-          result[i].append(buffer.data(), bytes);
+          if (sinks[i]) {
+            sinks[i](std::string_view(buffer.data(), bytes));
+          } else {
+            result[i].append(buffer.data(), bytes);
+          }
         } else if (errno != EINTR) {
           close_fd_by_index(i);
         }
@@ -171,10 +190,64 @@ absl::StatusOr<int> WaitForPid(pid_t pid) {
 
 }  // namespace
 
-absl::StatusOr<SubprocessResult> InvokeSubprocess(
-    absl::Span<const std::string> argv,
-    std::optional<std::filesystem::path> cwd,
-    std::optional<absl::Duration> optional_timeout) {
+// State shared by a subprocess and those who may kill it.
+struct SubprocessControl {
+  // Sends SIGKILL to the subprocess if it is running.
+  void Signal() {
+    absl::MutexLock lock(&mu);
+    if (pid > 0 && kill(pid, SIGKILL) == 0) {
+      XLS_VLOG(1) << "Killed " << pid;
+    }
+  }
+
+  // Kills the subprocess, or keeps it from starting.
+  void Kill() {
+    killed = true;
+    Signal();
+    if (absl::Mutex* mu = runner_mu.load(); mu != nullptr) {
+      // Wakes the subprocess if it waits for the runner.
+      absl::MutexLock lock(mu);
+    }
+  }
+
+  // Waits for the subprocess to exit. It is only reaped once `pid` is
+  // cleared, so that its pid cannot be reused by the time it is signaled.
+  absl::StatusOr<int> Wait() {
+    pid_t waited_pid;
+    {
+      absl::MutexLock lock(&mu);
+      waited_pid = pid;
+    }
+    siginfo_t info;
+    while (waitid(P_PID, waited_pid, &info, WEXITED | WNOWAIT) == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return absl::InternalError(
+          absl::StrCat("waitid failed: ", Strerror(errno)));
+    }
+    {
+      absl::MutexLock lock(&mu);
+      pid = -1;
+    }
+    return WaitForPid(waited_pid);
+  }
+
+  absl::Mutex mu;
+  // The running subprocess, or -1.
+  pid_t pid ABSL_GUARDED_BY(mu) = -1;
+  std::atomic<bool> killed = false;
+  // The mutex of the runner the subprocess waits for, if any.
+  std::atomic<absl::Mutex*> runner_mu = nullptr;
+};
+
+namespace {
+
+absl::StatusOr<SubprocessResult> RunSubprocess(
+    absl::Span<const std::string> argv, const SubprocessOptions& options,
+    SubprocessControl& control) {
+  const std::optional<std::filesystem::path>& cwd = options.cwd;
+  const std::optional<absl::Duration>& optional_timeout = options.timeout;
   if (argv.empty()) {
     return absl::InvalidArgumentError("Cannot invoke empty argv list.");
   }
@@ -195,6 +268,10 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
   XLS_ASSIGN_OR_RETURN(auto stdout_pipe, Pipe::Open());
   XLS_ASSIGN_OR_RETURN(auto stderr_pipe, Pipe::Open());
 
+  if (control.killed) {
+    return absl::CancelledError(
+        absl::StrCat("Subprocess ", bin_name, " killed before it started"));
+  }
   pid_t pid = fork();
   if (pid == -1) {
     return absl::InternalError(
@@ -204,6 +281,14 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
     PrepareAndExecInChildProcess(argv_pointers, cwd, stdout_pipe, stderr_pipe);
   }
   // This is the parent process.
+  {
+    absl::MutexLock lock(&control.mu);
+    control.pid = pid;
+  }
+  if (control.killed) {
+    // Killed while forking.
+    control.Signal();
+  }
   stdout_pipe.entrance.Close();
   stderr_pipe.entrance.Close();
 
@@ -220,8 +305,8 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
   std::optional<xls::Thread> watchdog_thread;
   if (optional_timeout.has_value() &&
       *optional_timeout > absl::ZeroDuration()) {
-    auto watchdog = [pid, timeout = optional_timeout.value(), &watchdog_mutex,
-                     &release_watchdog, &timeout_expired]() {
+    auto watchdog = [&control, timeout = optional_timeout.value(),
+                     &watchdog_mutex, &release_watchdog, &timeout_expired]() {
       absl::MutexLock lock(&watchdog_mutex);
       auto condition_lambda = [](void* release_val) {
         return *static_cast<bool*>(release_val);
@@ -231,9 +316,7 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
               timeout)) {
         // Timeout has lapsed, try to kill the subprocess.
         timeout_expired.store(true);
-        if (kill(pid, SIGKILL) == 0) {
-          XLS_VLOG(1) << "Watchdog killed " << pid;
-        }
+        control.Signal();
       }
     };
     watchdog_thread.emplace(watchdog);
@@ -241,8 +324,10 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
 
   // Read from the output streams of the subprocess.
   FileDescriptor* fds[] = {&stdout_pipe.exit, &stderr_pipe.exit};
+  std::function<void(std::string_view)> sinks[] = {options.stdout_sink,
+                                                   options.stderr_sink};
   std::vector<std::string> output_strings;
-  absl::Status read_status = ReadFileDescriptors(fds, output_strings);
+  absl::Status read_status = ReadFileDescriptors(fds, sinks, output_strings);
   if (!read_status.ok()) {
     XLS_VLOG(1) << "ReadFileDescriptors non-ok status: " << read_status;
   }
@@ -252,7 +337,7 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
   XLS_VLOG_LINES(2, absl::StrCat(bin_name, " stdout:\n ", stdout_output));
   XLS_VLOG_LINES(2, absl::StrCat(bin_name, " stderr:\n ", stderr_output));
 
-  XLS_ASSIGN_OR_RETURN(int wait_status, WaitForPid(pid));
+  XLS_ASSIGN_OR_RETURN(int wait_status, control.Wait());
 
   if (watchdog_thread != std::nullopt) {
     absl::MutexLock lock(&watchdog_mutex);
@@ -266,6 +351,84 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
                           .timeout_expired = timeout_expired.load()};
 }
 
+}  // namespace
+
+absl::StatusOr<SubprocessResult> InvokeSubprocess(
+    absl::Span<const std::string> argv,
+    std::optional<std::filesystem::path> cwd,
+    std::optional<absl::Duration> optional_timeout) {
+  SubprocessControl control;
+  return RunSubprocess(
+      argv, SubprocessOptions{.cwd = cwd, .timeout = optional_timeout},
+      control);
+}
+
+AsyncSubprocess::AsyncSubprocess(
+    std::function<absl::StatusOr<SubprocessResult>(SubprocessControl&)> run)
+    : control_(std::make_shared<SubprocessControl>()) {
+  auto promise =
+      std::make_shared<std::promise<absl::StatusOr<SubprocessResult>>>();
+  result_ = promise->get_future().share();
+  thread_ = std::make_unique<Thread>(
+      [promise, control = control_, run = std::move(run)]() {
+        promise->set_value(run(*control));
+      });
+}
+
+AsyncSubprocess::~AsyncSubprocess() = default;
+
+void AsyncSubprocess::Kill() { control_->Kill(); }
+
+std::unique_ptr<AsyncSubprocess> InvokeSubprocessAsync(
+    std::vector<std::string> argv, SubprocessOptions options) {
+  return absl::WrapUnique(new AsyncSubprocess(
+      [argv = std::move(argv), options = std::move(options)](
+          SubprocessControl& control) {
+        return RunSubprocess(argv, options, control);
+      }));
+}
+
+SubprocessRunner::SubprocessRunner(int64_t max_concurrency)
+    : max_concurrency_(max_concurrency) {
+  XLS_CHECK_GT(max_concurrency, 0);
+}
+
+bool SubprocessRunner::Acquire(SubprocessControl& control) {
+  control.runner_mu = &mu_;
+  absl::MutexLock lock(&mu_);
+  auto ready = [&]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return running_ < max_concurrency_ || control.killed;
+  };
+  mu_.Await(absl::Condition(&ready));
+  if (control.killed) {
+    return false;
+  }
+  ++running_;
+  return true;
+}
+
+void SubprocessRunner::Release() {
+  absl::MutexLock lock(&mu_);
+  --running_;
+}
+
+std::unique_ptr<AsyncSubprocess> SubprocessRunner::Run(
+    std::vector<std::string> argv, SubprocessOptions options) {
+  auto subprocess = absl::WrapUnique(new AsyncSubprocess(
+      [this, argv = std::move(argv), options = std::move(options)](
+          SubprocessControl& control) -> absl::StatusOr<SubprocessResult> {
+        if (!Acquire(control)) {
+          return absl::CancelledError(
+              "Subprocess killed before it started");
+        }
+        absl::StatusOr<SubprocessResult> result =
+            RunSubprocess(argv, options, control);
+        Release();
+        return result;
+      }));
+  return subprocess;
+}
+
 absl::StatusOr<std::pair<std::string, std::string>> SubprocessResultToStrings(
     absl::StatusOr<SubprocessResult> result) {
   if (result.ok()) {
@@ -15,14 +15,22 @@
 #ifndef XLS_COMMON_SUBPROCESS_H_
 #define XLS_COMMON_SUBPROCESS_H_
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
+#include <functional>
+#include <future>  // NOLINT(build/c++11)
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 
@@ -97,5 +105,81 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
     std::optional<std::filesystem::path> cwd = std::nullopt,
     std::optional<absl::Duration> optional_timeout = std::nullopt);
 
+// Options for subprocesses run in the background.
+struct SubprocessOptions {
+  std::optional<std::filesystem::path> cwd;
+
+  // Subprocesses that run beyond the timeout are killed.
+  std::optional<absl::Duration> timeout;
+
+  // If set, output on the stream is passed to the sink in chunks as it is
+  // read, on the thread waiting for the subprocess, rather than collected in
+  // the result.
+  std::function<void(std::string_view)> stdout_sink;
+  std::function<void(std::string_view)> stderr_sink;
+};
+
+class Thread;
+struct SubprocessControl;
+
+// A subprocess run in the background by InvokeSubprocessAsync or a
+// SubprocessRunner.
+class AsyncSubprocess {
+ public:
+  // Waits for the subprocess to exit.
+  ~AsyncSubprocess();
+
+  AsyncSubprocess(const AsyncSubprocess&) = delete;
+  AsyncSubprocess& operator=(const AsyncSubprocess&) = delete;
+
+  // Kills the subprocess. One still waiting for a runner never starts, and
+  // its result is a kCancelled error.
+  void Kill();
+
+  // The result, ready once the subprocess has exited, as InvokeSubprocess
+  // would return it.
+  std::shared_future<absl::StatusOr<SubprocessResult>> result() const {
+    return result_;
+  }
+
+ private:
+  friend std::unique_ptr<AsyncSubprocess> InvokeSubprocessAsync(
+      std::vector<std::string> argv, SubprocessOptions options);
+  friend class SubprocessRunner;
+
+  // Runs `run` on a thread of its own.
+  explicit AsyncSubprocess(
+      std::function<absl::StatusOr<SubprocessResult>(SubprocessControl&)>
+          run);
+
+  std::shared_ptr<SubprocessControl> control_;
+  std::shared_future<absl::StatusOr<SubprocessResult>> result_;
+  // Last, so it is joined before the rest is destroyed.
+  std::unique_ptr<Thread> thread_;
+};
+
+// Invokes a subprocess with the given argv in the background.
+std::unique_ptr<AsyncSubprocess> InvokeSubprocessAsync(
+    std::vector<std::string> argv, SubprocessOptions options = {});
+
+// Runs subprocesses in the background, at most `max_concurrency` at once;
+// further subprocesses wait to start. Must outlive the subprocesses it runs.
+class SubprocessRunner {
+ public:
+  explicit SubprocessRunner(int64_t max_concurrency);
+
+  std::unique_ptr<AsyncSubprocess> Run(std::vector<std::string> argv,
+                                       SubprocessOptions options = {});
+
+ private:
+  // Waits for a free slot; false if the subprocess was killed meanwhile.
+  bool Acquire(SubprocessControl& control);
+  void Release();
+
+  const int64_t max_concurrency_;
+  absl::Mutex mu_;
+  int64_t running_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
 }  // namespace xls
 #endif  // XLS_COMMON_SUBPROCESS_H_
@@ -14,13 +14,18 @@
 
 #include "xls/common/subprocess.h"
 
+#include <chrono>  // NOLINT(build/c++11)
+#include <future>  // NOLINT(build/c++11)
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/notification.h"
 #include "absl/time/time.h"
 #include "xls/common/status/matchers.h"
 
@@ -178,5 +183,98 @@ TEST(SubprocessTest, ResultsUnpackToStringPair) {
               StatusIs(absl::StatusCode::kInternal, HasSubstr("bad arg")));
 }
 
+TEST(SubprocessTest, AsyncWorks) {
+  std::unique_ptr<AsyncSubprocess> subprocess = InvokeSubprocessAsync(
+      {"/bin/bash", "-c", "echo -n hey && echo -n hello >&2 && exit 3"});
+
+  EXPECT_THAT(subprocess->result().get(),
+              IsOkAndHolds(FieldsAre(
+                  /*stdout=*/"hey",
+                  /*stderr=*/"hello",
+                  /*exit_status=*/3,
+                  /*normal_termination=*/true,
+                  /*timeout_expired=*/false)));
+}
+
+TEST(SubprocessTest, AsyncStreamsToSinks) {
+  std::string streamed;
+  std::unique_ptr<AsyncSubprocess> subprocess = InvokeSubprocessAsync(
+      {"/bin/bash", "-c", "/usr/bin/env seq 10000 && echo hello >&2"},
+      SubprocessOptions{.stdout_sink = [&](std::string_view chunk) {
+        streamed.append(chunk);
+      }});
+
+  absl::StatusOr<SubprocessResult> result = subprocess->result().get();
+  XLS_ASSERT_OK(result);
+  EXPECT_EQ(result->stdout, "");
+  EXPECT_EQ(result->stderr, "hello\n");
+  EXPECT_THAT(streamed, HasSubstr("\n10000\n"));
+}
+
+TEST(SubprocessTest, AsyncKillWorks) {
+  absl::Notification started;
+  std::unique_ptr<AsyncSubprocess> subprocess = InvokeSubprocessAsync(
+      {"/bin/bash", "-c", "echo started && sleep 10"},
+      SubprocessOptions{.stdout_sink = [&](std::string_view) {
+        if (!started.HasBeenNotified()) {
+          started.Notify();
+        }
+      }});
+  started.WaitForNotification();
+  subprocess->Kill();
+
+  EXPECT_THAT(subprocess->result().get(),
+              IsOkAndHolds(FieldsAre(
+                  /*stdout=*/"",
+                  /*stderr=*/"",
+                  /*exit_status=*/_,
+                  /*normal_termination=*/false,
+                  /*timeout_expired=*/false)));
+}
+
+TEST(SubprocessTest, AsyncTimeoutWorks) {
+  std::unique_ptr<AsyncSubprocess> subprocess = InvokeSubprocessAsync(
+      {"/bin/bash", "-c", "sleep 10"},
+      SubprocessOptions{.timeout = absl::Milliseconds(50)});
+
+  EXPECT_THAT(subprocess->result().get(),
+              IsOkAndHolds(FieldsAre(
+                  /*stdout=*/"",
+                  /*stderr=*/"",
+                  /*exit_status=*/_,
+                  /*normal_termination=*/false,
+                  /*timeout_expired=*/true)));
+}
+
+TEST(SubprocessTest, RunnerLimitsConcurrency) {
+  SubprocessRunner runner(/*max_concurrency=*/1);
+  std::unique_ptr<AsyncSubprocess> first =
+      runner.Run({"/bin/bash", "-c", "sleep 10"});
+  std::unique_ptr<AsyncSubprocess> second =
+      runner.Run({"/bin/bash", "-c", "echo -n hey"});
+  std::unique_ptr<AsyncSubprocess> third =
+      runner.Run({"/bin/bash", "-c", "echo -n hello"});
+
+  // The second and third wait for the first to finish.
+  EXPECT_EQ(second->result().wait_for(std::chrono::milliseconds(100)),
+            std::future_status::timeout);
+  third->Kill();
+  first->Kill();
+
+  EXPECT_THAT(second->result().get(),
+              IsOkAndHolds(FieldsAre(
+                  /*stdout=*/"hey",
+                  /*stderr=*/"",
+                  /*exit_status=*/0,
+                  /*normal_termination=*/true,
+                  /*timeout_expired=*/false)));
+  EXPECT_THAT(third->result().get(),
+              StatusIs(absl::StatusCode::kCancelled));
+  EXPECT_THAT(first->result().get(),
+              IsOkAndHolds(FieldsAre(_, _, _,
+                                     /*normal_termination=*/false,
+                                     /*timeout_expired=*/false)));
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,215 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/thread.h"
+
+ABSL_FLAG(int64_t, xls_threads, 0,
+          "Number of threads for parallel work within XLS. Zero or less uses "
+          "the number of hardware threads.");
+
+namespace xls {
+namespace {
+
+// The pool and worker index of the current thread, if it is a worker.
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local int64_t current_worker = -1;
+
+}  // namespace
+
+int64_t DefaultThreadCount() {
+  int64_t flag = absl::GetFlag(FLAGS_xls_threads);
+  if (flag > 0) {
+    return flag;
+  }
+  return std::max<int64_t>(1, std::thread::hardware_concurrency());
+}
+
+ThreadPool::ThreadPool(int64_t thread_count) {
+  if (thread_count <= 0) {
+    thread_count = DefaultThreadCount();
+  }
+  workers_.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  threads_.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    threads_.push_back(std::make_unique<Thread>([this, i] { WorkerLoop(i); }));
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    absl::MutexLock lock(&mu_);
+    stopping_ = true;
+  }
+  for (std::unique_ptr<Thread>& thread : threads_) {
+    thread->Join();
+  }
+}
+
+void ThreadPool::Schedule(std::function<void()> task) {
+  int64_t index;
+  if (current_pool == this) {
+    index = current_worker;
+  } else {
+    absl::MutexLock lock(&mu_);
+    index = next_worker_;
+    next_worker_ = (next_worker_ + 1) % workers_.size();
+  }
+  {
+    Worker& worker = *workers_[index];
+    absl::MutexLock lock(&worker.mu);
+    worker.tasks.push_back(std::move(task));
+  }
+  absl::MutexLock lock(&mu_);
+  ++pending_;
+}
+
+std::function<void()> ThreadPool::TakeTask(int64_t index) {
+  while (true) {
+    for (int64_t i = 0; i < workers_.size(); ++i) {
+      Worker& worker = *workers_[(index + i) % workers_.size()];
+      absl::MutexLock lock(&worker.mu);
+      if (worker.tasks.empty()) {
+        continue;
+      }
+      std::function<void()> task;
+      if (i == 0) {
+        task = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+      } else {
+        task = std::move(worker.tasks.front());
+        worker.tasks.pop_front();
+      }
+      return task;
+    }
+    std::this_thread::yield();
+  }
+}
+
+void ThreadPool::WorkerLoop(int64_t index) {
+  current_pool = this;
+  current_worker = index;
+  while (true) {
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.Await(absl::Condition(
+          +[](ThreadPool* pool) ABSL_EXCLUSIVE_LOCKS_REQUIRED(pool->mu_) {
+            return pool->pending_ > 0 || pool->stopping_;
+          },
+          this));
+      if (pending_ == 0) {
+        return;
+      }
+      --pending_;
+    }
+    TakeTask(index)();
+  }
+}
+
+void ThreadPool::ParallelFor(int64_t begin, int64_t end,
+                             const std::function<void(int64_t)>& fn) {
+  ParallelForWithStatus(begin, end, [&](int64_t i) {
+    fn(i);
+    return absl::OkStatus();
+  }).IgnoreError();
+}
+
+absl::Status ThreadPool::ParallelForWithStatus(
+    int64_t begin, int64_t end,
+    const std::function<absl::Status(int64_t)>& fn) {
+  if (begin >= end) {
+    return absl::OkStatus();
+  }
+
+  // Helpers scheduled on the workers may start after the loop is done, so
+  // the state is shared with them, and they only call fn while the caller
+  // waits for them.
+  struct State {
+    const std::function<absl::Status(int64_t)>* fn;
+    int64_t end;
+    std::atomic<int64_t> next;
+    std::atomic<bool> cancelled = false;
+
+    absl::Mutex mu;
+    bool closed ABSL_GUARDED_BY(mu) = false;
+    int64_t active ABSL_GUARDED_BY(mu) = 0;
+    absl::Status status ABSL_GUARDED_BY(mu);
+
+    void Run() {
+      for (int64_t i = next++; i < end && !cancelled; i = next++) {
+        absl::Status result = (*fn)(i);
+        if (!result.ok()) {
+          absl::MutexLock lock(&mu);
+          if (status.ok()) {
+            status = std::move(result);
+          }
+          cancelled = true;
+        }
+      }
+    }
+  };
+  auto state = std::make_shared<State>();
+  state->fn = &fn;
+  state->end = end;
+  state->next = begin;
+
+  int64_t helper_count = std::min<int64_t>(thread_count(), end - begin - 1);
+  for (int64_t i = 0; i < helper_count; ++i) {
+    Schedule([state] {
+      {
+        absl::MutexLock lock(&state->mu);
+        if (state->closed) {
+          return;
+        }
+        ++state->active;
+      }
+      state->Run();
+      absl::MutexLock lock(&state->mu);
+      --state->active;
+    });
+  }
+
+  state->Run();
+
+  absl::MutexLock lock(&state->mu);
+  state->closed = true;
+  state->mu.Await(absl::Condition(
+      +[](State* state) ABSL_EXCLUSIVE_LOCKS_REQUIRED(state->mu) {
+        return state->active == 0;
+      },
+      state.get()));
+  return state->status;
+}
+
+ThreadPool& DefaultThreadPool() {
+  static ThreadPool* pool = new ThreadPool(DefaultThreadCount());
+  return *pool;
+}
+
+}  // namespace xls
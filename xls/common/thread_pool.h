@@ -0,0 +1,118 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_THREAD_POOL_H_
+#define XLS_COMMON_THREAD_POOL_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>  // NOLINT(build/c++11)
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/flags/declare.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/thread.h"
+
+ABSL_DECLARE_FLAG(int64_t, xls_threads);
+
+namespace xls {
+
+// Returns --xls_threads if positive, otherwise the number of hardware
+// threads.
+int64_t DefaultThreadCount();
+
+// A fixed set of worker threads which share work by stealing.
+//
+// Each worker owns a deque of tasks. Tasks scheduled by a worker go to the
+// back of its own deque, and it runs them last-in first-out; tasks scheduled
+// by other threads are spread over the workers round-robin. A worker whose
+// deque is empty steals from the front of the others.
+//
+// Waiting on a future from within a task can deadlock once every worker is
+// waiting; nest parallelism with ParallelFor, whose caller runs iterations
+// itself rather than waiting for workers.
+class ThreadPool {
+ public:
+  // A thread_count of zero or less means DefaultThreadCount().
+  explicit ThreadPool(int64_t thread_count = 0);
+
+  // Runs all tasks already scheduled, then joins the workers.
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  int64_t thread_count() const { return threads_.size(); }
+
+  void Schedule(std::function<void()> task);
+
+  // Schedules f and returns a future for its result.
+  template <typename F>
+  std::future<std::invoke_result_t<F>> Submit(F f) {
+    using R = std::invoke_result_t<F>;
+    auto task = std::make_shared<std::packaged_task<R()>>(std::move(f));
+    std::future<R> future = task->get_future();
+    Schedule([task]() { (*task)(); });
+    return future;
+  }
+
+  // Calls fn(i) for each i in [begin, end) from the calling thread and the
+  // workers, and returns once all the calls have returned.
+  void ParallelFor(int64_t begin, int64_t end,
+                   const std::function<void(int64_t)>& fn);
+
+  // As ParallelFor, but the first error cancels the calls not yet started
+  // and is returned.
+  absl::Status ParallelForWithStatus(
+      int64_t begin, int64_t end,
+      const std::function<absl::Status(int64_t)>& fn);
+
+ private:
+  struct Worker {
+    absl::Mutex mu;
+    std::deque<std::function<void()>> tasks ABSL_GUARDED_BY(mu);
+  };
+
+  void WorkerLoop(int64_t index);
+
+  // Takes a task from the back of worker `index`, or else from the front of
+  // another worker. Only called holding a claim on a pending task, so one is
+  // eventually found.
+  std::function<void()> TakeTask(int64_t index);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  absl::Mutex mu_;
+  // Tasks scheduled and not yet claimed by a worker.
+  int64_t pending_ ABSL_GUARDED_BY(mu_) = 0;
+  bool stopping_ ABSL_GUARDED_BY(mu_) = false;
+  int64_t next_worker_ ABSL_GUARDED_BY(mu_) = 0;
+
+  std::vector<std::unique_ptr<Thread>> threads_;
+};
+
+// Returns a process-wide pool of DefaultThreadCount() threads, created on
+// first use, so that subsystems running in parallel share the cores rather
+// than oversubscribe them.
+ThreadPool& DefaultThreadPool();
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_THREAD_POOL_H_
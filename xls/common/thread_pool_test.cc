@@ -0,0 +1,99 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/thread_pool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <future>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+
+namespace xls {
+namespace {
+
+TEST(ThreadPoolTest, SubmitReturnsFutures) {
+  ThreadPool pool(4);
+  EXPECT_EQ(pool.thread_count(), 4);
+  std::vector<std::future<int64_t>> futures;
+  for (int64_t i = 0; i < 100; ++i) {
+    futures.push_back(pool.Submit([i] { return i * i; }));
+  }
+  for (int64_t i = 0; i < 100; ++i) {
+    EXPECT_EQ(futures[i].get(), i * i);
+  }
+}
+
+TEST(ThreadPoolTest, DestructorRunsScheduledTasks) {
+  std::atomic<int64_t> count = 0;
+  {
+    ThreadPool pool(2);
+    for (int64_t i = 0; i < 1000; ++i) {
+      pool.Schedule([&count] { ++count; });
+    }
+  }
+  EXPECT_EQ(count, 1000);
+}
+
+TEST(ThreadPoolTest, ParallelForVisitsEachIndexOnce) {
+  ThreadPool pool(3);
+  std::vector<std::atomic<int64_t>> visits(1000);
+  pool.ParallelFor(0, visits.size(), [&](int64_t i) { ++visits[i]; });
+  for (const std::atomic<int64_t>& v : visits) {
+    EXPECT_EQ(v, 1);
+  }
+  pool.ParallelFor(5, 5, [&](int64_t i) { ++visits[i]; });
+}
+
+TEST(ThreadPoolTest, NestedParallelForOnOneThread) {
+  // The callers run iterations themselves, so nesting cannot deadlock even
+  // when the only worker is busy.
+  ThreadPool pool(1);
+  std::atomic<int64_t> sum = 0;
+  pool.ParallelFor(0, 10, [&](int64_t i) {
+    pool.ParallelFor(0, 10, [&](int64_t j) { sum += i * 10 + j; });
+  });
+  EXPECT_EQ(sum, 99 * 100 / 2);
+}
+
+TEST(ThreadPoolTest, ParallelForWithStatusCancelsOnError) {
+  ThreadPool pool(2);
+  std::atomic<int64_t> calls = 0;
+  absl::Status status =
+      pool.ParallelForWithStatus(0, 100000, [&](int64_t i) -> absl::Status {
+        ++calls;
+        if (i == 0) {
+          return absl::InternalError("failed");
+        }
+        return absl::OkStatus();
+      });
+  EXPECT_EQ(status, absl::InternalError("failed"));
+  EXPECT_LT(calls, 100000);
+
+  EXPECT_TRUE(pool.ParallelForWithStatus(0, 10, [](int64_t) {
+                    return absl::OkStatus();
+                  }).ok());
+}
+
+TEST(ThreadPoolTest, DefaultThreadPool) {
+  EXPECT_GE(DefaultThreadCount(), 1);
+  EXPECT_EQ(DefaultThreadPool().thread_count(), DefaultThreadCount());
+  EXPECT_EQ(DefaultThreadPool().Submit([] { return 7; }).get(), 7);
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,161 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/trace.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>  // NOLINT
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/logging/logging.h"
+
+ABSL_FLAG(std::string, xls_trace_file, "",
+          "If set, records where time goes (e.g. in each compiler pass) and "
+          "writes it to this file in the Chrome trace event format on exit, "
+          "for chrome://tracing or https://ui.perfetto.dev.");
+
+namespace xls {
+namespace trace_internal {
+
+std::atomic<bool> tracing_enabled = false;
+
+}  // namespace trace_internal
+
+namespace {
+
+struct TraceEvent {
+  std::string name;
+  std::string_view category;
+  absl::Time start;
+  absl::Time end;
+  int64_t thread_id;
+};
+
+struct TraceLog {
+  absl::Mutex mu;
+  absl::Time origin ABSL_GUARDED_BY(mu);
+  std::vector<TraceEvent> events ABSL_GUARDED_BY(mu);
+};
+
+TraceLog& GetTraceLog() {
+  static TraceLog* log = new TraceLog;
+  return *log;
+}
+
+// Small sequential thread ids, which trace viewers display more readably
+// than system ones.
+int64_t CurrentThreadId() {
+  static std::atomic<int64_t> next_id = 1;
+  thread_local int64_t id = next_id++;
+  return id;
+}
+
+void AppendJsonString(std::string_view s, std::string& out) {
+  out.push_back('"');
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      out.push_back('\\');
+      out.push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      absl::StrAppendFormat(&out, "\\u%04x", c);
+    } else {
+      out.push_back(c);
+    }
+  }
+  out.push_back('"');
+}
+
+void WriteTraceFileAtExit() {
+  absl::Status status = WriteTraceFile(absl::GetFlag(FLAGS_xls_trace_file));
+  if (!status.ok()) {
+    XLS_LOG(ERROR) << "Failed to write trace: " << status;
+  }
+}
+
+}  // namespace
+
+namespace trace_internal {
+
+void RecordEvent(std::string name, std::string_view category,
+                 absl::Time start, absl::Time end) {
+  int64_t thread_id = CurrentThreadId();
+  TraceLog& log = GetTraceLog();
+  absl::MutexLock lock(&log.mu);
+  log.events.push_back(TraceEvent{.name = std::move(name),
+                                  .category = category,
+                                  .start = start,
+                                  .end = end,
+                                  .thread_id = thread_id});
+}
+
+}  // namespace trace_internal
+
+void StartTracing() {
+  TraceLog& log = GetTraceLog();
+  {
+    absl::MutexLock lock(&log.mu);
+    log.events.clear();
+    log.origin = absl::Now();
+  }
+  trace_internal::tracing_enabled = true;
+}
+
+void StopTracing() { trace_internal::tracing_enabled = false; }
+
+std::string TraceEventsToJson() {
+  TraceLog& log = GetTraceLog();
+  absl::MutexLock lock(&log.mu);
+  std::string json = "{\"traceEvents\":[";
+  for (int64_t i = 0; i < log.events.size(); ++i) {
+    const TraceEvent& event = log.events[i];
+    absl::StrAppend(&json, i == 0 ? "\n" : ",\n", "{\"name\":");
+    AppendJsonString(event.name, json);
+    absl::StrAppend(&json, ",\"cat\":");
+    AppendJsonString(event.category, json);
+    absl::StrAppendFormat(
+        &json, ",\"ph\":\"X\",\"ts\":%d,\"dur\":%d,\"pid\":1,\"tid\":%d}",
+        absl::ToInt64Microseconds(event.start - log.origin),
+        absl::ToInt64Microseconds(event.end - event.start), event.thread_id);
+  }
+  absl::StrAppend(&json, "\n],\"displayTimeUnit\":\"ms\"}\n");
+  return json;
+}
+
+absl::Status WriteTraceFile(const std::filesystem::path& path) {
+  return SetFileContents(path, TraceEventsToJson());
+}
+
+void InitTracingFromFlags() {
+  if (absl::GetFlag(FLAGS_xls_trace_file).empty()) {
+    return;
+  }
+  StartTracing();
+  std::atexit(WriteTraceFileAtExit);
+}
+
+}  // namespace xls
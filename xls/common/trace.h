@@ -0,0 +1,100 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_TRACE_H_
+#define XLS_COMMON_TRACE_H_
+
+#include <atomic>
+#include <filesystem>  // NOLINT
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/flags/declare.h"
+#include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+ABSL_DECLARE_FLAG(std::string, xls_trace_file);
+
+// Scoped tracing of where time goes, e.g. across the compile flow, recorded
+// as Chrome trace events which chrome://tracing and https://ui.perfetto.dev
+// display as a timeline per thread.
+//
+// Ex:
+//   absl::Status Foo() {
+//     ScopedTrace trace("Foo");
+//     ...
+//   }
+
+namespace xls {
+namespace trace_internal {
+
+extern std::atomic<bool> tracing_enabled;
+
+void RecordEvent(std::string name, std::string_view category,
+                 absl::Time start, absl::Time end);
+
+}  // namespace trace_internal
+
+inline bool TracingEnabled() {
+  return trace_internal::tracing_enabled.load(std::memory_order_relaxed);
+}
+
+// Starts recording trace events, discarding any recorded before.
+void StartTracing();
+
+void StopTracing();
+
+// Returns the events recorded so far in the Chrome trace event JSON format.
+std::string TraceEventsToJson();
+
+absl::Status WriteTraceFile(const std::filesystem::path& path);
+
+// Starts tracing if --xls_trace_file is set, and writes the trace to it when
+// the process exits. Called by InitXls.
+void InitTracingFromFlags();
+
+// Records the time from construction to destruction as an event, if tracing
+// is enabled on construction. Otherwise it only costs checking that it is
+// not, so traces may be left in code that runs often. `category` must outlive
+// the trace, e.g. be a literal.
+class ScopedTrace {
+ public:
+  explicit ScopedTrace(std::string_view name, std::string_view category = "xls")
+      : category_(category) {
+    if (TracingEnabled()) {
+      name_ = name;
+      start_ = absl::Now();
+    }
+  }
+  ~ScopedTrace() {
+    if (start_ != absl::InfinitePast()) {
+      trace_internal::RecordEvent(std::move(name_), category_, start_,
+                                  absl::Now());
+    }
+  }
+
+  ScopedTrace(const ScopedTrace&) = delete;
+  ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+ private:
+  std::string name_;
+  std::string_view category_;
+  absl::Time start_ = absl::InfinitePast();
+};
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_TRACE_H_
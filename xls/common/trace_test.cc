@@ -0,0 +1,62 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/trace.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/thread.h"
+
+namespace xls {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+TEST(TraceTest, DisabledRecordsNothing) {
+  StartTracing();
+  StopTracing();
+  EXPECT_FALSE(TracingEnabled());
+  { ScopedTrace trace("disabled"); }
+  EXPECT_THAT(TraceEventsToJson(), Not(HasSubstr("disabled")));
+}
+
+TEST(TraceTest, RecordsNestedEvents) {
+  StartTracing();
+  {
+    ScopedTrace outer("outer");
+    ScopedTrace inner("in\"ner", "category");
+  }
+  StopTracing();
+  std::string json = TraceEventsToJson();
+  EXPECT_THAT(json, HasSubstr(R"({"name":"outer","cat":"xls","ph":"X")"));
+  EXPECT_THAT(json, HasSubstr(R"({"name":"in\"ner","cat":"category")"));
+  EXPECT_THAT(json, HasSubstr(R"("tid":1})"));
+}
+
+TEST(TraceTest, RecordsThreadsSeparately) {
+  StartTracing();
+  { ScopedTrace trace("main"); }
+  Thread thread([] { ScopedTrace trace("other"); });
+  thread.Join();
+  StopTracing();
+  std::string json = TraceEventsToJson();
+  EXPECT_THAT(json, HasSubstr(R"("tid":1})"));
+  EXPECT_THAT(json, HasSubstr(R"("tid":2})"));
+}
+
+}  // namespace
+}  // namespace xls
@@ -69,6 +69,22 @@ struct has_member_to_string {
 template <typename T>
 inline constexpr bool has_member_to_string_v = has_member_to_string<T>::value;
 
+// Helper to determine whether a GetNodeCount member exists.
+template <typename T>
+struct has_member_get_node_count {
+ private:
+  template <typename C>
+  static YesType Test(decltype(&C::GetNodeCount));
+  template <typename C>
+  static NoType Test(...);
+
+ public:
+  static constexpr bool value = sizeof(Test<T>(0)) == sizeof(YesType);
+};
+template <typename T>
+inline constexpr bool has_member_get_node_count_v =
+    has_member_get_node_count<T>::value;
+
 // Helper to determine if a Subject Type is a type defined within a
 // std::variant.
 template <typename...>
@@ -14,14 +14,114 @@
 
 #include "xls/contrib/integrator/integration_algorithms/basic_integration_algorithm.h"
 
+#include <algorithm>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "xls/ir/node_iterator.h"
+#include "xls/ir/op.h"
 
 namespace xls {
 
+/* static */ std::string BasicIntegrationAlgorithm::CandidateKey(
+    const Node* node) {
+  // Mirrors Node::IsDefinitelyEqualTo.
+  std::string key =
+      absl::StrCat(OpToString(node->op()), " ", node->GetType()->ToString());
+  for (const Node* operand : node->operands()) {
+    absl::StrAppend(&key, " ", operand->GetType()->ToString());
+  }
+  return key;
+}
+
+void BasicIntegrationAlgorithm::AddCandidate(Node* node) {
+  std::string key = CandidateKey(node);
+  candidates_[key].push_back(node);
+  candidate_keys_[node] = std::move(key);
+}
+
+void BasicIntegrationAlgorithm::RemoveCandidate(Node* node) {
+  auto key_itr = candidate_keys_.find(node);
+  if (key_itr == candidate_keys_.end()) {
+    return;
+  }
+  std::vector<Node*>& nodes = candidates_.at(key_itr->second);
+  nodes.erase(std::find(nodes.begin(), nodes.end(), node));
+  candidate_keys_.erase(key_itr);
+  InvalidateCandidate(node);
+}
+
+void BasicIntegrationAlgorithm::InvalidateCandidate(Node* candidate) {
+  for (auto& [node, costs] : costs_) {
+    costs.erase(candidate);
+  }
+}
+
+absl::StatusOr<std::optional<int64_t>> BasicIntegrationAlgorithm::GetCost(
+    Node* node, Node* candidate) {
+  absl::flat_hash_map<Node*, std::optional<int64_t>>& costs = costs_[node];
+  auto cost_itr = costs.find(candidate);
+  if (cost_itr != costs.end()) {
+    return cost_itr->second;
+  }
+  std::optional<int64_t> cost;
+  if (candidate == node) {
+    XLS_ASSIGN_OR_RETURN(float insert_cost,
+                         integration_function_->GetInsertNodeCost(node));
+    cost = static_cast<int64_t>(insert_cost);
+  } else {
+    XLS_ASSIGN_OR_RETURN(
+        cost, integration_function_->GetMergeNodesCost(node, candidate));
+  }
+  costs[candidate] = cost;
+  return cost;
+}
+
+absl::Status BasicIntegrationAlgorithm::UpdateAfterMove(
+    const BasicIntegrationMove& move, absl::Span<Node* const> new_nodes) {
+  costs_.erase(move.node);
+  if (move.merge_node != nullptr) {
+    // The merged integration node has been replaced and removed.
+    RemoveCandidate(move.merge_node);
+  }
+  for (Node* new_node : new_nodes) {
+    // The node may reuse the memory of a removed node.
+    InvalidateCandidate(new_node);
+    if (integration_function_->IsMappingTarget(new_node) &&
+        !candidate_keys_.contains(new_node)) {
+      AddCandidate(new_node);
+    }
+
+    // The operands of the users of the new node have changed, as have those
+    // of the users of any muxes rebuilt for its operands, and so have the
+    // integrated operands of the users of the nodes mapped to it.
+    for (Node* user : new_node->users()) {
+      InvalidateCandidate(user);
+    }
+    for (Node* operand : new_node->operands()) {
+      if (!integration_function_->IsMappingTarget(operand)) {
+        for (Node* user : operand->users()) {
+          InvalidateCandidate(user);
+        }
+      }
+    }
+    XLS_ASSIGN_OR_RETURN(
+        const absl::flat_hash_set<const Node*>* originals,
+        integration_function_->GetNodesMappedToNode(new_node));
+    for (const Node* original : *originals) {
+      for (Node* user : original->users()) {
+        costs_.erase(user);
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
 void BasicIntegrationAlgorithm::EnqueueNodeIfReady(Node* node) {
   if (!queued_nodes_.contains(node) &&
       integration_function_->AllOperandsHaveMapping(node)) {
@@ -33,6 +133,11 @@ void BasicIntegrationAlgorithm::EnqueueNodeIfReady(Node* node) {
 absl::Status BasicIntegrationAlgorithm::Initialize() {
   // Make integration function.
   XLS_ASSIGN_OR_RETURN(integration_function_, NewIntegrationFunction());
+  for (Node* node : integration_function_->function()->nodes()) {
+    if (integration_function_->IsMappingTarget(node)) {
+      AddCandidate(node);
+    }
+  }
 
   // ID initial nodes with all operands ready.
   for (const Function* func : source_functions_) {
@@ -52,30 +157,32 @@ BasicIntegrationAlgorithm::Run() {
     for (auto node_itr = ready_nodes_.begin(); node_itr != ready_nodes_.end();
          ++node_itr) {
       // Check insertion cost.
-      XLS_ASSIGN_OR_RETURN(int64_t insert_cost,
-                           integration_function_->GetInsertNodeCost(*node_itr));
-      if (!move.has_value() || insert_cost < move.value().cost) {
-        move = MakeInsertMove(node_itr, insert_cost);
+      XLS_ASSIGN_OR_RETURN(std::optional<int64_t> insert_cost,
+                           GetCost(*node_itr, *node_itr));
+      XLS_RET_CHECK(insert_cost.has_value());
+      if (!move.has_value() || insert_cost.value() < move.value().cost) {
+        move = MakeInsertMove(node_itr, insert_cost.value());
       }
 
-      // Check merge cost.
-      for (Node* internal_node : integration_function_->function()->nodes()) {
-        // TODO(jbaileyhandle): Relax this requirement so that
-        // it only applies to integration-generated muxes.
-        if (!integration_function_->IsMappingTarget(internal_node)) {
-          continue;
-        }
-
+      // Check merge cost against the integration nodes which may be equal.
+      // TODO(jbaileyhandle): Relax the requirement that candidates are mapping
+      // targets so that it only applies to integration-generated muxes.
+      if (OpIsSideEffecting((*node_itr)->op())) {
+        continue;
+      }
+      auto candidates_itr = candidates_.find(CandidateKey(*node_itr));
+      if (candidates_itr == candidates_.end()) {
+        continue;
+      }
+      for (Node* internal_node : candidates_itr->second) {
         // Check if mergeable
-        XLS_ASSIGN_OR_RETURN(
-            std::optional<int64_t> merge_cost,
-            integration_function_->GetMergeNodesCost(*node_itr, internal_node));
+        XLS_ASSIGN_OR_RETURN(std::optional<int64_t> merge_cost,
+                             GetCost(*node_itr, internal_node));
         if (!merge_cost.has_value()) {
           continue;
         }
 
         // Check if lowest cost.
-        XLS_RET_CHECK(move.has_value());
         if (merge_cost < move.value().cost) {
           move = MakeMergeMove(node_itr, internal_node, merge_cost.value());
         }
@@ -84,8 +191,10 @@ BasicIntegrationAlgorithm::Run() {
 
     // Execute lowest-cost move.
     XLS_RET_CHECK(move.has_value());
-    XLS_RETURN_IF_ERROR(
-        ExecuteMove(integration_function_.get(), move.value()).status());
+    XLS_ASSIGN_OR_RETURN(
+        std::vector<Node*> new_nodes,
+        ExecuteMove(integration_function_.get(), move.value()));
+    XLS_RETURN_IF_ERROR(UpdateAfterMove(move.value(), new_nodes));
 
     // Update ready_nodes_.
     ready_nodes_.erase(move.value().node_itr);
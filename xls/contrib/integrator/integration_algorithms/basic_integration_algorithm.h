@@ -18,7 +18,12 @@
 
 #include <list>
 #include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "xls/contrib/integrator/integration_algorithms/integration_algorithm.h"
 
 namespace xls {
@@ -28,6 +33,11 @@ namespace xls {
 // At each step, adds the eligible node for which the cost of adding it to
 // the function (either by inserting or merging with any integeration function
 // node) is the lowest.
+//
+// Only nodes which are definitely equal (same op and types) can be merged, so
+// the integration function nodes are indexed by those properties and each
+// ready node is only costed against the nodes with the same key. Costs are
+// cached and only recomputed for the nodes touched by each move.
 class BasicIntegrationAlgorithm
     : public IntegrationAlgorithm<BasicIntegrationAlgorithm> {
  public:
@@ -85,6 +95,27 @@ class BasicIntegrationAlgorithm
   // and node has not already been queued for processing.
   void EnqueueNodeIfReady(Node* node);
 
+  // Returns the key under which 'node' is indexed as a merge candidate. Nodes
+  // with different keys are never definitely equal and so cannot be merged.
+  static std::string CandidateKey(const Node* node);
+
+  // Add / remove an integration function node to / from 'candidates_'.
+  void AddCandidate(Node* node);
+  void RemoveCandidate(Node* node);
+
+  // Returns the cost of merging the ready node 'node' with the integration
+  // function node 'candidate', or of inserting 'node' if 'candidate' is
+  // 'node'. Returns nullopt if they cannot be merged. Cached in 'costs_'.
+  absl::StatusOr<std::optional<int64_t>> GetCost(Node* node, Node* candidate);
+
+  // Update 'candidates_' and drop the cached costs that may have changed
+  // after 'move' added 'new_nodes' to the integration function.
+  absl::Status UpdateAfterMove(const BasicIntegrationMove& move,
+                               absl::Span<Node* const> new_nodes);
+
+  // Forget the cached costs of merging any ready node with 'candidate'.
+  void InvalidateCandidate(Node* candidate);
+
   // Track nodes for which all operands are already mapped and
   // are ready to be added to the integration_function_
   std::list<Node*> ready_nodes_;
@@ -92,6 +123,16 @@ class BasicIntegrationAlgorithm
   // Track all nodes that have ever been inserted into 'ready_nodes_'.
   absl::flat_hash_set<Node*> queued_nodes_;
 
+  // Integration function nodes which are mapping targets, by CandidateKey, in
+  // the order they were added to the function.
+  absl::flat_hash_map<std::string, std::vector<Node*>> candidates_;
+  absl::flat_hash_map<Node*, std::string> candidate_keys_;
+
+  // Cached results of GetCost, by ready node and then candidate.
+  absl::flat_hash_map<Node*,
+                      absl::flat_hash_map<Node*, std::optional<int64_t>>>
+      costs_;
+
   // Function combining the source functions.
   std::unique_ptr<IntegrationFunction> integration_function_;
 };
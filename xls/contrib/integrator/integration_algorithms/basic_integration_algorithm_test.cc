@@ -14,11 +14,18 @@
 
 #include "xls/contrib/integrator/integration_algorithms/basic_integration_algorithm.h"
 
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/statusor.h"
 #include "xls/common/status/matchers.h"
 #include "xls/contrib/integrator/integration_builder.h"
 #include "xls/contrib/integrator/ir_integrator.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/ir_test_base.h"
@@ -412,5 +419,45 @@ TEST_F(BasicIntegrationAlgorithmTest, BasicIntegrationLiterals) {
                  m::Literal(UBits(2, 2)))));
 }
 
+TEST_F(BasicIntegrationAlgorithmTest, BasicIntegrationManyNodes) {
+  // Functions of mixed ops and widths, so that each node only has some of the
+  // integration function nodes as merge candidates.
+  auto p = CreatePackage();
+  auto build = [&](std::string_view name,
+                   int64_t offset) -> absl::StatusOr<Function*> {
+    FunctionBuilder fb(name, p.get());
+    std::vector<BValue> values = {fb.Param("x", p->GetBitsType(8)),
+                                  fb.Param("y", p->GetBitsType(8))};
+    for (int64_t i = 0; i < 60; ++i) {
+      BValue a = values[(i + offset) % values.size()];
+      BValue b = values[(3 * i + 1) % values.size()];
+      switch ((i + offset) % 3) {
+        case 0:
+          values.push_back(fb.Add(a, b));
+          break;
+        case 1:
+          values.push_back(fb.Xor(a, b));
+          break;
+        default:
+          values.push_back(fb.BitSlice(fb.UMul(a, b, 16), 4, 8));
+          break;
+      }
+    }
+    return fb.BuildWithReturnValue(values.back());
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func_a, build("func_a", 0));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func_b, build("func_b", 1));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IntegrationBuilder> builder,
+      IntegrationBuilder::Build(
+          {func_a, func_b},
+          IntegrationOptions().algorithm(
+              IntegrationOptions::Algorithm::kBasicIntegrationAlgorithm)));
+  Function* function = builder->integrated_function()->function();
+  XLS_EXPECT_OK(VerifyFunction(function));
+  EXPECT_THAT(function->return_value(), m::Tuple(m::BitSlice(), m::Add()));
+}
+
 }  // namespace
 }  // namespace xls
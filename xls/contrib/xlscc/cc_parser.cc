@@ -434,6 +434,8 @@ absl::Status CCParser::VisitFunction(const clang::FunctionDecl* funcdecl) {
     return absl::OkStatus();
   }
 
+  functions_by_name_[fname].push_back(funcdecl);
+
   XLS_ASSIGN_OR_RETURN(
       Pragma pragma,
       FindPragmaForLoc(GetPresumedLoc(*funcdecl), /*ignore_label=*/true));
@@ -664,8 +666,31 @@ absl::StatusOr<std::string> CCParser::GetEntryFunctionName() const {
 
 absl::Status CCParser::SelectTop(std::string_view top_function_name,
                                  std::string_view top_class_name) {
+  if (libtool_thread_ == nullptr) {
+    top_function_name_ = top_function_name;
+    top_class_name_ = top_class_name;
+    return absl::OkStatus();
+  }
+
+  // Already scanned, so select from the existing AST
+  if (!top_class_name.empty() && top_class_name != top_class_name_) {
+    return absl::FailedPreconditionError(absl::StrFormat(
+        "Top class %s must be selected before scanning", top_class_name));
+  }
+  auto found = functions_by_name_.find(top_function_name);
+  if (found == functions_by_name_.end()) {
+    return absl::NotFoundError(
+        absl::StrFormat("No top function named %s found", top_function_name));
+  }
+  const std::vector<const clang::FunctionDecl*>& definitions = found->second;
+  if (definitions.size() > 1) {
+    return absl::AlreadyExistsError(absl::StrFormat(
+        "Two top functions defined by name, at %s, previously at %s",
+        LocString(GetLoc(*definitions[1])),
+        LocString(GetLoc(*definitions[0]))));
+  }
   top_function_name_ = top_function_name;
-  top_class_name_ = top_class_name;
+  top_function_ = definitions.front();
   return absl::OkStatus();
 }
 
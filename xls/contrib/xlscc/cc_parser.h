@@ -20,6 +20,7 @@
 #include <string>
 #include <string_view>
 #include <tuple>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -104,6 +105,10 @@ class CCParser {
   // Either this must be called before ScanFile, or a #pragma hls_top
   // must be present in the file(s) being scanned, in order for
   // GetTopFunction() to return a valid pointer
+  //
+  // May also be called after ScanFile to select another function from the
+  // same AST, so that several tops can be translated from a single parse.
+  // The top class can only be selected before ScanFile.
   absl::Status SelectTop(std::string_view top_function_name,
                          std::string_view top_class_name = "");
 
@@ -167,8 +172,13 @@ class CCParser {
   absl::flat_hash_map<PragmaLoc, Pragma> hls_pragmas_;
   absl::flat_hash_set<std::string> files_scanned_for_pragmas_;
 
+  // Definitions of the functions which can be selected as top after the scan,
+  // by name
+  absl::flat_hash_map<std::string, std::vector<const clang::FunctionDecl*>>
+      functions_by_name_;
+
   const clang::FunctionDecl* top_function_ = nullptr;
-  std::string_view top_function_name_ = "";
+  std::string top_function_name_ = "";
   std::string_view top_class_name_ = "";
   const clang::VarDecl* xlscc_on_reset_ = nullptr;
 
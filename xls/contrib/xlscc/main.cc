@@ -16,12 +16,18 @@
 // front-end. It accepts as input a C/C++ file and produces as textual output
 // the equivalent XLS intermediate representation (IR).
 
+#include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <streambuf>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -29,6 +35,7 @@
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
+#include "absl/types/span.h"
 #include "clang/include/clang/AST/Decl.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
@@ -36,9 +43,15 @@
 #include "xls/common/logging/log_flags.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/contrib/xlscc/cc_parser.h"
 #include "xls/contrib/xlscc/hls_block.pb.h"
 #include "xls/contrib/xlscc/metadata_output.pb.h"
 #include "xls/contrib/xlscc/translator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
 
 const char kUsage[] = R"(
 Generates XLS IR from a given C++ file, or generates Verilog in the special
@@ -64,7 +77,13 @@ ABSL_FLAG(std::string, block_from_class, "",
           "Specifies the name of a top class from which to generate the "
           "HLSBlock. This class must contain the top method. ");
 
-ABSL_FLAG(std::string, top, "", "Top function name");
+ABSL_FLAG(std::string, top, "",
+          "Top function name. A comma-separated list of names translates each "
+          "of the functions into one package whose top is the first.");
+
+ABSL_FLAG(int64_t, translation_threads, 1,
+          "Number of threads translating the functions given by --top. Each "
+          "thread beyond the first parses the source again.");
 
 ABSL_FLAG(std::string, package, "", "Package name to generate");
 
@@ -106,6 +125,57 @@ ABSL_FLAG(std::string, io_op_token_ordering, "none",
 
 namespace xlscc {
 
+// Translates each of top_names, selected from the source already scanned by
+// parser, into a package of its own. A fresh Translator per top shares
+// nothing but the parser, so that a function translated as a callee of one
+// top may be translated again as another top.
+static absl::Status TranslateTops(
+    const std::function<std::unique_ptr<Translator>(
+        std::shared_ptr<CCParser>)>& make_translator,
+    std::shared_ptr<CCParser> parser, absl::Span<const std::string> top_names,
+    std::string_view package_name,
+    std::vector<std::unique_ptr<xls::Package>>& packages) {
+  for (const std::string& top_name : top_names) {
+    XLS_RETURN_IF_ERROR(parser->SelectTop(top_name));
+    std::unique_ptr<Translator> translator = make_translator(parser);
+    auto package = std::make_unique<xls::Package>(package_name);
+    XLS_RETURN_IF_ERROR(
+        translator->GenerateIR_Top_Function(package.get(), {}).status());
+    translator->AddSourceInfoToPackage(*package);
+    packages.push_back(std::move(package));
+  }
+  return absl::OkStatus();
+}
+
+// Adds the functions of other to package. Source locations are renumbered to
+// the files of package first, as separate parses may number files
+// differently.
+static absl::Status MergePackage(xls::Package& package, xls::Package& other,
+                                 std::string_view top_name) {
+  for (xls::FunctionBase* function_base : other.GetFunctionBases()) {
+    for (xls::Node* node : function_base->nodes()) {
+      xls::SourceInfo loc = node->loc();
+      for (xls::SourceLocation& location : loc.locations) {
+        std::optional<std::string> filename =
+            other.GetFilename(location.fileno());
+        if (filename.has_value()) {
+          location = xls::SourceLocation(package.GetOrCreateFileno(*filename),
+                                         location.lineno(), location.colno());
+        }
+      }
+      node->SetLoc(loc);
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(xls::Package::PackageMergeResult result,
+                       package.AddPackage(&other));
+  if (result.name_updates.contains(top_name)) {
+    return absl::AlreadyExistsError(absl::StrFormat(
+        "Top function %s collides with another function in the package",
+        top_name));
+  }
+  return absl::OkStatus();
+}
+
 static absl::Status Run(std::string_view cpp_path) {
   // Warnings should print by default
   absl::SetFlag(&FLAGS_logtostderr, true);
@@ -129,6 +199,14 @@ static absl::Status Run(std::string_view cpp_path) {
                                absl::GetFlag(FLAGS_z3_rlimit),
                                io_op_token_ordering);
 
+  auto make_translator = [&](std::shared_ptr<CCParser> parser) {
+    return std::make_unique<xlscc::Translator>(
+        absl::GetFlag(FLAGS_error_on_init_interval),
+        absl::GetFlag(FLAGS_max_unroll_iters),
+        absl::GetFlag(FLAGS_warn_unroll_iters), absl::GetFlag(FLAGS_z3_rlimit),
+        io_op_token_ordering, std::move(parser));
+  };
+
   const std::string block_pb_name = absl::GetFlag(FLAGS_block_pb);
 
   const std::string block_from_class_name =
@@ -149,11 +227,17 @@ static absl::Status Run(std::string_view cpp_path) {
     }
   }
 
-  const std::string top_function_name = absl::GetFlag(FLAGS_top);
+  const std::vector<std::string> top_function_names =
+      absl::StrSplit(absl::GetFlag(FLAGS_top), ',', absl::SkipEmpty());
 
-  if (!top_function_name.empty()) {
-    XLS_RETURN_IF_ERROR(
-        translator.SelectTop(top_function_name, block_from_class_name));
+  if (top_function_names.size() > 1 && !block_pb_name.empty()) {
+    return absl::InvalidArgumentError(
+        "Only one --top may be specified when generating a block");
+  }
+
+  if (!top_function_names.empty()) {
+    XLS_RETURN_IF_ERROR(translator.SelectTop(top_function_names.front(),
+                                             block_from_class_name));
   }
 
   std::vector<std::string> clang_argvs;
@@ -183,13 +267,9 @@ static absl::Status Run(std::string_view cpp_path) {
     clang_argv.push_back(i);
   }
 
-  std::cerr << "Parsing file '" << cpp_path << "' with clang..." << std::endl;
-  XLS_RETURN_IF_ERROR(translator.ScanFile(
-      cpp_path, clang_argv.empty()
-                    ? absl::Span<std::string_view>()
-                    : absl::MakeSpan(&clang_argv[0], clang_argv.size())));
-
-  XLS_ASSIGN_OR_RETURN(std::string top_name, translator.GetEntryFunctionName());
+  absl::Span<std::string_view> clang_argv_span =
+      clang_argv.empty() ? absl::Span<std::string_view>()
+                         : absl::MakeSpan(&clang_argv[0], clang_argv.size());
 
   std::string package_name = absl::GetFlag(FLAGS_package);
 
@@ -197,6 +277,56 @@ static absl::Status Run(std::string_view cpp_path) {
     package_name = "my_package";
   }
 
+  // Tops after the first are split into contiguous chunks, one per worker
+  // thread, each of which parses the source for itself. With a single
+  // thread they are instead translated from the parse of the first top.
+  const int64_t further_top_count =
+      std::max<int64_t>(0, static_cast<int64_t>(top_function_names.size()) - 1);
+  const int64_t worker_count =
+      absl::GetFlag(FLAGS_translation_threads) > 1
+          ? std::min<int64_t>(absl::GetFlag(FLAGS_translation_threads) - 1,
+                              further_top_count)
+          : 0;
+  std::vector<std::vector<std::unique_ptr<xls::Package>>> worker_packages(
+      worker_count);
+  std::vector<absl::Status> worker_statuses(worker_count);
+  std::vector<std::unique_ptr<xls::Thread>> workers;
+  for (int64_t w = 0; w < worker_count; ++w) {
+    absl::Span<const std::string> chunk =
+        absl::MakeConstSpan(top_function_names)
+            .subspan(1 + w * further_top_count / worker_count,
+                     (w + 1) * further_top_count / worker_count -
+                         w * further_top_count / worker_count);
+    workers.push_back(std::make_unique<xls::Thread>([&, w, chunk] {
+      auto parser = std::make_shared<CCParser>();
+      absl::Status& status = worker_statuses[w];
+      status = parser->SelectTop(chunk.front());
+      if (status.ok()) {
+        status = parser->ScanFile(cpp_path, clang_argv_span);
+      }
+      if (status.ok()) {
+        status = TranslateTops(make_translator, parser, chunk, package_name,
+                               worker_packages[w]);
+      }
+    }));
+  }
+  auto join_workers = [&]() -> absl::Status {
+    for (std::unique_ptr<xls::Thread>& worker : workers) {
+      worker->Join();
+    }
+    workers.clear();
+    for (const absl::Status& status : worker_statuses) {
+      XLS_RETURN_IF_ERROR(status);
+    }
+    return absl::OkStatus();
+  };
+
+  std::cerr << "Parsing file '" << cpp_path << "' with clang..." << std::endl;
+  // Early returns join the workers on destroying them
+  XLS_RETURN_IF_ERROR(translator.ScanFile(cpp_path, clang_argv_span));
+
+  XLS_ASSIGN_OR_RETURN(std::string top_name, translator.GetEntryFunctionName());
+
   std::filesystem::path output_file(absl::GetFlag(FLAGS_out));
 
   std::filesystem::path output_absolute = output_file;
@@ -219,12 +349,36 @@ static absl::Status Run(std::string_view cpp_path) {
   if (block_pb_name.empty()) {
     absl::flat_hash_map<const clang::NamedDecl*, ChannelBundle>
         top_channel_injections = {};
-    XLS_RETURN_IF_ERROR(
+    absl::Status top_status =
         translator.GenerateIR_Top_Function(&package, top_channel_injections)
-            .status());
+            .status();
+    absl::Status workers_status = join_workers();
+    XLS_RETURN_IF_ERROR(top_status);
+    XLS_RETURN_IF_ERROR(workers_status);
+
+    std::vector<std::unique_ptr<xls::Package>> further_packages;
+    if (worker_count == 0 && further_top_count > 0) {
+      XLS_RETURN_IF_ERROR(TranslateTops(
+          make_translator, translator.parser(),
+          absl::MakeConstSpan(top_function_names).subspan(1), package_name,
+          further_packages));
+      // Metadata is generated for the package top
+      XLS_RETURN_IF_ERROR(translator.SelectTop(top_name));
+    }
+    for (std::vector<std::unique_ptr<xls::Package>>& packages :
+         worker_packages) {
+      for (std::unique_ptr<xls::Package>& further_package : packages) {
+        further_packages.push_back(std::move(further_package));
+      }
+    }
+
+    translator.AddSourceInfoToPackage(package);
+    for (int64_t i = 0; i < further_packages.size(); ++i) {
+      XLS_RETURN_IF_ERROR(MergePackage(package, *further_packages[i],
+                                       top_function_names[i + 1]));
+    }
     // TODO(seanhaskell): Simplify IR
     XLS_RETURN_IF_ERROR(package.SetTopByName(top_name));
-    translator.AddSourceInfoToPackage(package);
     XLS_RETURN_IF_ERROR(write_to_output(absl::StrCat(package.DumpIr(), "\n")));
   } else {
     xls::Proc* proc = nullptr;
@@ -31,6 +31,9 @@
 #include "xls/contrib/xlscc/xlscc_logging.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function_builder.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
 
@@ -48,6 +51,42 @@ double doubletime() {
   return tv.tv_sec + static_cast<double>(tv.tv_usec) / 1000000.0;
 }
 
+// Returns true if `node` depends only on literals. The result for `node` and
+// everything it depends on is memoized in `constant_nodes`, so that repeated
+// queries on the growing IR of an unrolled loop visit each node once.
+bool IsConstantNode(xls::Node* node,
+                    absl::flat_hash_map<xls::Node*, bool>& constant_nodes) {
+  // Iterative post-order walk, as unrolled loops make for very deep IR.
+  std::vector<std::pair<xls::Node*, bool>> stack = {{node, false}};
+  while (!stack.empty()) {
+    auto [top, operands_visited] = stack.back();
+    stack.pop_back();
+    if (constant_nodes.contains(top)) {
+      continue;
+    }
+    if (top->op() == xls::Op::kParam || top->op() == xls::Op::kInvoke ||
+        xls::OpIsSideEffecting(top->op())) {
+      constant_nodes[top] = false;
+      continue;
+    }
+    if (!operands_visited) {
+      stack.push_back({top, true});
+      for (xls::Node* operand : top->operands()) {
+        if (!constant_nodes.contains(operand)) {
+          stack.push_back({operand, false});
+        }
+      }
+      continue;
+    }
+    bool is_constant = true;
+    for (xls::Node* operand : top->operands()) {
+      is_constant = is_constant && constant_nodes.at(operand);
+    }
+    constant_nodes[top] = is_constant;
+  }
+  return constant_nodes.at(node);
+}
+
 }  // namespace
 
 namespace xlscc {
@@ -174,6 +213,7 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
     Z3_context ctx_;
     Z3_solver solver_;
   };
+  SolverDeref solver_deref(z3_translator_parent->ctx(), solver);
 
   // Generate the declaration within a private context
   PushContextGuard for_init_guard(*this, loc);
@@ -192,6 +232,9 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
 
   double slowest_iter = 0;
 
+  // Memoizes IsConstantNode() across iterations.
+  absl::flat_hash_map<xls::Node*, bool> constant_nodes;
+
   for (int64_t nIters = 0;; ++nIters) {
     const bool first_iter = nIters == 0;
     const bool always_this_iter = always_first_iter && first_iter;
@@ -250,6 +293,11 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
     if (inc != nullptr) {
       XLS_RETURN_IF_ERROR(GenerateIR_Stmt(inc, ctx));
     }
+
+    // Simplify before the next iteration, so that the IR it builds on (and
+    // so the work done per iteration) does not grow with the iteration count.
+    XLS_RETURN_IF_ERROR(FoldConstantVariables(constant_nodes, loc));
+
     // Print slow unrolling warning
     const double iter_end = doubletime();
     const double iter_seconds = iter_end - iter_start;
@@ -265,6 +313,30 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
   return absl::OkStatus();
 }
 
+absl::Status Translator::FoldConstantVariables(
+    absl::flat_hash_map<xls::Node*, bool>& constant_nodes,
+    const xls::SourceInfo& loc) {
+  if (context().sf == nullptr) {
+    return absl::OkStatus();
+  }
+  for (const clang::NamedDecl* name :
+       context().sf->DeterministicKeyNames(context().variables)) {
+    const CValue cval = context().variables.at(name);
+    xls::BValue rvalue = cval.rvalue();
+    if (!rvalue.valid() || cval.lvalue() != nullptr ||
+        rvalue.node()->Is<xls::Literal>() ||
+        !IsConstantNode(rvalue.node(), constant_nodes)) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(xls::Value value,
+                         EvaluateBVal(rvalue, loc, /*do_check=*/false));
+    xls::BValue literal = context().fb->Literal(value, rvalue.node()->loc());
+    constant_nodes[literal.node()] = true;
+    context().variables[name] = CValue(literal, cval.type());
+  }
+  return absl::OkStatus();
+}
+
 bool Translator::LValueContainsOnlyChannels(std::shared_ptr<LValue> lvalue) {
   if (lvalue == nullptr) {
     return true;
@@ -149,7 +149,7 @@ bool Translator::IOChannelInCurrentFunction(IOChannel* to_find,
 Translator::Translator(bool error_on_init_interval, int64_t max_unroll_iters,
                        int64_t warn_unroll_iters, int64_t z3_rlimit,
                        IOOpOrdering op_ordering,
-                       std::unique_ptr<CCParser> existing_parser)
+                       std::shared_ptr<CCParser> existing_parser)
     : max_unroll_iters_(max_unroll_iters),
       warn_unroll_iters_(warn_unroll_iters),
       z3_rlimit_(z3_rlimit),
@@ -159,7 +159,7 @@ Translator::Translator(bool error_on_init_interval, int64_t max_unroll_iters,
   if (existing_parser != nullptr) {
     parser_ = std::move(existing_parser);
   } else {
-    parser_ = std::make_unique<CCParser>();
+    parser_ = std::make_shared<CCParser>();
   }
 }
 
@@ -183,8 +183,8 @@ absl::Status Translator::PopContext(const xls::SourceInfo& loc) {
   const bool propagate_break_up = context().propagate_break_up;
   const bool propagate_continue_up = context().propagate_continue_up;
 
-  // Copy updated variables
-  TranslationContext popped = context();
+  // Take the popped context to propagate its updated variables
+  TranslationContext popped = std::move(context());
   context_stack_.pop_front();
 
   XLSCC_CHECK(!context_stack_.empty(), loc);
@@ -254,8 +254,14 @@ absl::Status Translator::PropagateVariables(const TranslationContext& from,
   if (from.sf == nullptr) {
     return absl::OkStatus();
   }
-  for (const clang::NamedDecl* name :
-       from.sf->DeterministicKeyNames(from.variables)) {
+  // Variables whose entries are still shared with `to`, such as those left
+  // untouched since `from` was pushed, are unchanged and skipped.
+  std::vector<const clang::NamedDecl*> names;
+  from.variables.ForEachKeyNotSharedWith(
+      to.variables,
+      [&names](const clang::NamedDecl* name) { names.push_back(name); });
+  from.sf->SortNamesDeterministically(names);
+  for (const clang::NamedDecl* name : names) {
     if (to.variables.contains(name)) {
       if (to.variables.at(name) != from.variables.at(name)) {
         XLS_ASSIGN_OR_RETURN(CValue prepared,
@@ -264,7 +270,7 @@ absl::Status Translator::PropagateVariables(const TranslationContext& from,
                                  from.relative_condition, loc));
 
         // Don't use Assign(), it uses context()
-        to.variables.at(name) = prepared;
+        to.variables[name] = prepared;
       }
     } else if (to.sf->static_values.contains(name) ||
                from.propagate_declarations) {
@@ -1724,14 +1730,14 @@ absl::Status Translator::Assign(const clang::NamedDecl* lvalue,
 
   // TODO(seanhaskell): Remove special 'this' handling
   if (!type_contains_lval || force_no_lvalue_assign) {
-    context().variables.at(lvalue) = CValue(rvalue.rvalue(), rvalue.type());
+    context().variables[lvalue] = CValue(rvalue.rvalue(), rvalue.type());
   } else {
     XLSCC_CHECK(rvalue.lvalue() != nullptr, loc);
     XLSCC_CHECK(!rvalue.lvalue()->is_null(), loc);
 
     XLS_RETURN_IF_ERROR(ValidateLValue(rvalue.lvalue(), loc));
 
-    context().variables.at(lvalue) = rvalue;
+    context().variables[lvalue] = rvalue;
   }
 
   return absl::OkStatus();
@@ -5259,6 +5265,12 @@ absl::StatusOr<bool> Translator::BitMustBe(bool assert_value, xls::BValue& bval,
 
   XLS_RETURN_IF_ERROR(ShortCircuitBVal(bval, loc));
 
+  // Constant conditions, as in most unrolled loops, need no solver.
+  if (bval.node()->Is<xls::Literal>()) {
+    return bval.node()->As<xls::Literal>()->value().IsAllOnes() ==
+           assert_value;
+  }
+
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<xls::solvers::z3::IrTranslator> z3_translator,
       xls::solvers::z3::IrTranslator::CreateAndTranslate(
@@ -46,6 +46,7 @@
 #include "xls/contrib/xlscc/cc_parser.h"
 #include "xls/contrib/xlscc/hls_block.pb.h"
 #include "xls/contrib/xlscc/metadata_output.pb.h"
+#include "xls/data_structures/persistent_hash_map.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/caret.h"
 #include "xls/ir/channel.h"
@@ -766,7 +767,7 @@ struct PipelinedLoopSubProc {
 
   std::vector<const clang::NamedDecl*> vars_to_save_between_iters;
   GeneratedFunction* enclosing_func = nullptr;
-  absl::flat_hash_map<const clang::NamedDecl*, CValue> outer_variables;
+  xls::PersistentHashMap<const clang::NamedDecl*, CValue> outer_variables;
   absl::flat_hash_map<const clang::NamedDecl*, uint64_t> variable_field_indices;
   uint64_t total_context_values;
   uint64_t extra_return_count;
@@ -829,10 +830,9 @@ struct GeneratedFunction {
   // duplicated
   absl::flat_hash_map<IOChannel*, IOChannel*> callee_generated_channels_added;
 
-  template <typename ValueType>
+  template <typename MapType>
   std::vector<const clang::NamedDecl*> DeterministicKeyNames(
-      const absl::flat_hash_map<const clang::NamedDecl*, ValueType>& map)
-      const {
+      const MapType& map) const {
     std::vector<const clang::NamedDecl*> ret;
     for (const auto& [name, _] : map) {
       ret.push_back(name);
@@ -976,7 +976,9 @@ struct TranslationContext {
   GeneratedFunction* sf = nullptr;
 
   // "this" uses the key of the clang::NamedDecl* of the method
-  absl::flat_hash_map<const clang::NamedDecl*, CValue> variables;
+  // Contexts are copied on entering every scope, loop iteration and call, so
+  // the variables are kept in a map whose copies share structure.
+  xls::PersistentHashMap<const clang::NamedDecl*, CValue> variables;
 
   const clang::NamedDecl* override_this_decl_ = nullptr;
 
@@ -1063,13 +1065,18 @@ class Translator {
 
  public:
   // Make unrolling configurable from main
+  // existing_parser may be shared with other Translators, which must not use
+  // it concurrently, so that several tops can be translated from one parse
+  // without sharing any translation state.
   explicit Translator(
       bool error_on_init_interval = false, int64_t max_unroll_iters = 1000,
       int64_t warn_unroll_iters = 100, int64_t z3_rlimit = -1,
       IOOpOrdering op_ordering = IOOpOrdering::kNone,
-      std::unique_ptr<CCParser> existing_parser = std::unique_ptr<CCParser>());
+      std::shared_ptr<CCParser> existing_parser = nullptr);
   ~Translator();
 
+  std::shared_ptr<CCParser> parser() const { return parser_; }
+
   // This function uses Clang to parse a source file and then walks its
   //  AST to discover global constructs. It will also scan the file
   //  and includes, recursively, for #pragma statements.
@@ -1678,6 +1685,12 @@ class Translator {
                                        const clang::Stmt* body,
                                        clang::ASTContext& ctx,
                                        const xls::SourceInfo& loc);
+  // Replaces the rvalues of variables in the current context that depend only
+  // on literals with literals. `constant_nodes` memoizes which nodes are
+  // constant across calls.
+  absl::Status FoldConstantVariables(
+      absl::flat_hash_map<xls::Node*, bool>& constant_nodes,
+      const xls::SourceInfo& loc);
   // init, cond, and inc can be nullptr
   absl::Status GenerateIR_PipelinedLoop(
       bool always_first_iter, const clang::Stmt* init,
@@ -1975,7 +1988,7 @@ class Translator {
   void FillLocationRangeProto(const clang::SourceRange& range,
                               xlscc_metadata::SourceLocationRange* range_out);
 
-  std::unique_ptr<CCParser> parser_;
+  std::shared_ptr<CCParser> parser_;
 
   // Uses context's last_intrinsic_call
   // Returns nullptr if no applicable intrinsic call is found
@@ -77,6 +77,48 @@ TEST_F(CCParserTest, TopNotFound) {
               xls::status_testing::StatusIs(absl::StatusCode::kNotFound));
 }
 
+TEST_F(CCParserTest, SelectTopAfterScan) {
+  xlscc::CCParser parser;
+
+  const std::string cpp_src = R"(
+    int foo(int a) {
+      return a + 1;
+    }
+    int bar(int a) {
+      return a + 2;
+    }
+    int qux(int a) {
+      return a + 4;
+    }
+    namespace n {
+    int bar(int a) {
+      return a + 3;
+    }
+    }  // namespace n
+  )";
+
+  XLS_ASSERT_OK(
+      ScanTempFileWithContent(cpp_src, {}, &parser, /*top_name=*/"foo"));
+  XLS_ASSERT_OK_AND_ASSIGN(const auto* foo_ptr, parser.GetTopFunction());
+  EXPECT_EQ(foo_ptr->getNameAsString(), "foo");
+
+  // Selects from the same AST without parsing again
+  XLS_ASSERT_OK(parser.SelectTop("qux"));
+  XLS_ASSERT_OK_AND_ASSIGN(const auto* qux_ptr, parser.GetTopFunction());
+  EXPECT_EQ(qux_ptr->getNameAsString(), "qux");
+  XLS_ASSERT_OK(parser.SelectTop("foo"));
+  XLS_ASSERT_OK_AND_ASSIGN(const auto* top_ptr, parser.GetTopFunction());
+  EXPECT_EQ(top_ptr, foo_ptr);
+
+  EXPECT_THAT(parser.SelectTop("bar"),
+              xls::status_testing::StatusIs(absl::StatusCode::kAlreadyExists));
+  EXPECT_THAT(parser.SelectTop("baz"),
+              xls::status_testing::StatusIs(absl::StatusCode::kNotFound));
+  EXPECT_THAT(
+      parser.SelectTop("foo", "SomeClass"),
+      xls::status_testing::StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
 TEST_F(CCParserTest, SourceMeta) {
   xlscc::CCParser parser;
 
@@ -1292,6 +1292,22 @@ TEST_F(TranslatorLogicTest, ForUnroll) {
   Run({{"a", 11}, {"b", 20}}, 611, content);
 }
 
+TEST_F(TranslatorLogicTest, ForUnrollManyIterations) {
+  const std::string content = R"(
+      long long my_package(long long a, long long b) {
+        int j = 0;
+        #pragma hls_unroll yes
+        for(int i=0;i<200;++i) {
+          j += i & 3;
+          if(j > 250) {
+            a += b;
+          }
+        }
+        return a + j;
+      })";
+  Run({{"a", 11}, {"b", 20}}, 971, content);
+}
+
 TEST_F(TranslatorLogicTest, ForUnrollLabel) {
   const std::string content = R"(
       long long my_package(long long a, long long b) {
@@ -28,6 +28,20 @@ int my_function(int a, int b){
 }
 """
 
+MULTI_TOP_CPP_SRC = """
+int add(int a, int b){
+	return a+b;
+}
+
+int add3(int a, int b, int c){
+	return add(add(a, b), c);
+}
+
+int twice(int a){
+	return add(a, a);
+}
+"""
+
 BLOCK_CPP_SRC = """
 #include "/xls_builtin.h"
 
@@ -69,6 +83,20 @@ class XlsccMainTest(absltest.TestCase):
 
     subprocess.check_call([XLSCC_MAIN_PATH, cpp_file.full_path])
 
+  def test_gen_ir_multiple_tops(self):
+    cpp_file = self.create_tempfile(
+        file_path="src.cc", content=MULTI_TOP_CPP_SRC)
+
+    # add is translated both as a callee and as a top
+    for threads in ["1", "3"]:
+      ir = subprocess.check_output([
+          XLSCC_MAIN_PATH, cpp_file.full_path, "--top=add3,twice,add",
+          "--translation_threads=" + threads
+      ]).decode("utf-8")
+      self.assertIn("top fn add3(", ir)
+      self.assertIn("fn twice(", ir)
+      self.assertIn("fn add(", ir)
+
   def test_gen_ir_block(self):
     cpp_file = self.create_tempfile(file_path="src.cc", content=BLOCK_CPP_SRC)
 
@@ -15,62 +15,118 @@
 #include "xls/data_structures/binary_decision_diagram.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 
+#include "absl/hash/hash.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/logging/vlog_is_on.h"
 
 namespace xls {
+namespace {
 
-BinaryDecisionDiagram::BinaryDecisionDiagram() {
-  // Leaf node 0.
-  nodes_.push_back(BddNode(BddVariable(-1), BddNodeIndex(-1), BddNodeIndex(-1),
-                           /*p=*/1));
-  // Leaf node 1.
+// Bounds on the number of entries of the computed table. Between the bounds
+// the table is grown to have at least as many entries as there are nodes.
+constexpr int64_t kMinComputedTableSize = int64_t{1} << 12;
+constexpr int64_t kMaxComputedTableSize = int64_t{1} << 20;
+
+// The minimum node count at which ShouldGarbageCollect returns true.
+constexpr int64_t kMinGcThreshold = int64_t{1} << 16;
+
+}  // namespace
+
+BinaryDecisionDiagram::BinaryDecisionDiagram()
+    : gc_threshold_(kMinGcThreshold) {
+  // The terminal node. An uncomplemented reference to it is zero, a
+  // complemented reference is one.
   nodes_.push_back(BddNode(BddVariable(-1), BddNodeIndex(-1), BddNodeIndex(-1),
                            /*p=*/1));
+  computed_table_.resize(kMinComputedTableSize);
 }
 
 BddNodeIndex BinaryDecisionDiagram::GetOrCreateNode(BddVariable var,
                                                     BddNodeIndex high,
                                                     BddNodeIndex low) {
+  if (low == high) {
+    return low;
+  }
+  // Only the high child may be complemented. Otherwise, create the node for
+  // the inverse function and return a complemented reference to it.
+  if (IsComplemented(low)) {
+    return Not(GetOrCreateNode(var, Not(high), Not(low)));
+  }
   NodeKey key = std::make_tuple(var, high, low);
   auto it = node_map_.find(key);
   if (it != node_map_.end()) {
     return it->second;
   }
-  if (low == high) {
-    return low;
-  }
   // Compute the number of paths that the new node will have to the terminal
   // nodes 0 and 1. Use int64s to avoid overflowing and saturate at INT32_MAX.
   int32_t paths = std::min(
       static_cast<int64_t>(GetNode(low).path_count) + GetNode(high).path_count,
       static_cast<int64_t>(std::numeric_limits<int32_t>::max()));
-  nodes_.emplace_back(var, high, low, paths);
-  BddNodeIndex node_index = BddNodeIndex(nodes_.size() - 1);
+  int32_t slot;
+  if (free_nodes_.empty()) {
+    XLS_CHECK_LT(nodes_.size(), int64_t{1} << 30) << "Too many BDD nodes";
+    slot = nodes_.size();
+    const size_t capacity = nodes_.capacity();
+    nodes_.emplace_back(var, high, low, paths);
+    if (nodes_.capacity() != capacity) {
+      node_memory_account_.Set(nodes_.capacity() * sizeof(BddNode));
+    }
+  } else {
+    slot = free_nodes_.back();
+    free_nodes_.pop_back();
+    nodes_[slot] = BddNode(var, high, low, paths);
+  }
+  BddNodeIndex node_index = BddNodeIndex(slot << 1);
   node_map_[key] = node_index;
+  if (size() > computed_table_.size() &&
+      computed_table_.size() < kMaxComputedTableSize) {
+    ResizeComputedTable(2 * computed_table_.size());
+  }
   return node_index;
 }
 
+int64_t BinaryDecisionDiagram::ComputedTableSlot(BddNodeIndex cond,
+                                                 BddNodeIndex if_true,
+                                                 BddNodeIndex if_false) const {
+  return absl::HashOf(cond.value(), if_true.value(), if_false.value()) &
+         (computed_table_.size() - 1);
+}
+
+void BinaryDecisionDiagram::ResizeComputedTable(int64_t size) {
+  std::vector<ComputedEntry> old_table(size);
+  std::swap(old_table, computed_table_);
+  for (const ComputedEntry& entry : old_table) {
+    if (entry.cond != BddNodeIndex(-1)) {
+      computed_table_[ComputedTableSlot(entry.cond, entry.if_true,
+                                        entry.if_false)] = entry;
+    }
+  }
+}
+
 BddNodeIndex BinaryDecisionDiagram::Restrict(BddNodeIndex expr, BddVariable var,
                                              bool value) {
-  if (expr == zero() || expr == one()) {
+  if (IsTerminal(expr)) {
     return expr;
   }
 
   const BddNode& node = GetNode(expr);
   XLS_CHECK_LE(var, node.variable);
   if (node.variable == var) {
-    return value ? node.high : node.low;
+    return value ? High(expr) : Low(expr);
   }
   return expr;
 }
@@ -78,36 +134,72 @@ BddNodeIndex BinaryDecisionDiagram::Restrict(BddNodeIndex expr, BddVariable var,
 BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
                                                BddNodeIndex if_true,
                                                BddNodeIndex if_false) {
+  // Within each branch the value of the condition is known.
+  if (if_true == cond) {
+    if_true = one();
+  } else if (if_true == Not(cond)) {
+    if_true = zero();
+  }
+  if (if_false == cond) {
+    if_false = zero();
+  } else if (if_false == Not(cond)) {
+    if_false = one();
+  }
   if (cond == one()) {
     return if_true;
   }
   if (cond == zero()) {
     return if_false;
   }
+  if (if_true == if_false) {
+    return if_true;
+  }
   if (if_true == one() && if_false == zero()) {
     return cond;
   }
-  if (if_true == if_false) {
-    return if_true;
+  if (if_true == zero() && if_false == one()) {
+    return Not(cond);
   }
-  auto key = std::make_tuple(cond, if_true, if_false);
-  auto it = ite_map_.find(key);
-  if (it != ite_map_.end()) {
-    return it->second;
+
+  // Normalize the expression so that equivalent expressions share an entry in
+  // the computed table: the condition and the if-true value are made
+  // uncomplemented using the identities
+  //
+  //   ite(!c, t, f) = ite(c, f, t)
+  //   ite(c, !t, !f) = !ite(c, t, f)
+  //
+  if (IsComplemented(cond)) {
+    cond = Not(cond);
+    std::swap(if_true, if_false);
+  }
+  bool complement_result = IsComplemented(if_true);
+  if (complement_result) {
+    if_true = Not(if_true);
+    if_false = Not(if_false);
+  }
+  auto maybe_complement = [&](BddNodeIndex expr) {
+    return complement_result ? Not(expr) : expr;
+  };
+
+  const ComputedEntry& entry =
+      computed_table_[ComputedTableSlot(cond, if_true, if_false)];
+  if (entry.cond == cond && entry.if_true == if_true &&
+      entry.if_false == if_false) {
+    return maybe_complement(entry.result);
   }
 
-  // The expression is non-trivial and has not been computed before. Recursively
-  // decompose the expression by peeling away the first variable and performing
-  // a Shannon decomposition.
+  // The expression is non-trivial and has not been computed recently.
+  // Recursively decompose the expression by peeling away the first variable
+  // and performing a Shannon decomposition.
 
   // First, find the lowest-index variable amongst all expressions. In all paths
   // through the BDD the variable indices are strictly increasing.
   BddVariable min_var = GetNode(cond).variable;
   // Only non-leaf nodes (not zero or one) have associated variables.
-  if (if_true != zero() && if_true != one()) {
+  if (!IsTerminal(if_true)) {
     min_var = std::min(min_var, GetNode(if_true).variable);
   }
-  if (if_false != zero() && if_false != one()) {
+  if (!IsTerminal(if_false)) {
     min_var = std::min(min_var, GetNode(if_false).variable);
   }
 
@@ -123,33 +215,94 @@ BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
                                            Restrict(if_true, min_var, false),
                                            Restrict(if_false, min_var, false));
 
-  if (true_cofactor == false_cofactor) {
-    ite_map_[key] = true_cofactor;
-    return true_cofactor;
-  }
   BddNodeIndex expr = GetOrCreateNode(min_var, true_cofactor, false_cofactor);
-  ite_map_[key] = expr;
-  return expr;
+  // The recursive calls may have resized the computed table so recompute the
+  // slot.
+  computed_table_[ComputedTableSlot(cond, if_true, if_false)] = ComputedEntry{
+      .cond = cond, .if_true = if_true, .if_false = if_false, .result = expr};
+  return maybe_complement(expr);
 }
 
 BddNodeIndex BinaryDecisionDiagram::NewVariable() {
   BddVariable var = next_var_;
   ++next_var_;
-  return GetOrCreateNode(var, one(), zero());
-}
-
-BddNodeIndex BinaryDecisionDiagram::Not(BddNodeIndex expr) {
-  return IfThenElse(expr, zero(), one());
+  BddNodeIndex base_node = GetOrCreateNode(var, one(), zero());
+  variable_base_nodes_.push_back(base_node);
+  return base_node;
 }
 
 BddNodeIndex BinaryDecisionDiagram::Or(BddNodeIndex a, BddNodeIndex b) {
+  // Order the operands so that both orders share a computed table entry.
+  if (b < a) {
+    std::swap(a, b);
+  }
   return IfThenElse(a, one(), b);
 }
 
 BddNodeIndex BinaryDecisionDiagram::And(BddNodeIndex a, BddNodeIndex b) {
+  if (b < a) {
+    std::swap(a, b);
+  }
   return IfThenElse(a, b, zero());
 }
 
+int64_t BinaryDecisionDiagram::GarbageCollect(
+    absl::Span<const BddNodeIndex> roots) {
+  // Mark all nodes reachable from the roots and the variables.
+  std::vector<bool> live(nodes_.size(), false);
+  live[0] = true;
+  std::vector<int32_t> worklist;
+  auto mark = [&](BddNodeIndex expr) {
+    int32_t slot = expr.value() >> 1;
+    if (!live[slot]) {
+      live[slot] = true;
+      worklist.push_back(slot);
+    }
+  };
+  for (BddNodeIndex root : roots) {
+    mark(root);
+  }
+  for (BddNodeIndex base_node : variable_base_nodes_) {
+    mark(base_node);
+  }
+  while (!worklist.empty()) {
+    const BddNode& node = nodes_[worklist.back()];
+    worklist.pop_back();
+    mark(node.high);
+    mark(node.low);
+  }
+
+  // Sweep the unmarked nodes. Slots which are already free have a zero path
+  // count.
+  int64_t freed_count = 0;
+  for (int32_t slot = 1; slot < nodes_.size(); ++slot) {
+    BddNode& node = nodes_[slot];
+    if (live[slot] || node.path_count == 0) {
+      continue;
+    }
+    node_map_.erase(std::make_tuple(node.variable, node.high, node.low));
+    node = BddNode();
+    free_nodes_.push_back(slot);
+    ++freed_count;
+  }
+
+  // Drop computed table entries which refer to freed nodes.
+  auto is_live = [&](BddNodeIndex expr) { return live[expr.value() >> 1]; };
+  for (ComputedEntry& entry : computed_table_) {
+    if (entry.cond != BddNodeIndex(-1) &&
+        !(is_live(entry.cond) && is_live(entry.if_true) &&
+          is_live(entry.if_false) && is_live(entry.result))) {
+      entry = ComputedEntry();
+    }
+  }
+
+  gc_threshold_ = std::max(kMinGcThreshold, 2 * size());
+  XLS_VLOG(2) << absl::StreamFormat(
+      "BDD garbage collection freed %d nodes, %d nodes live", freed_count,
+      size());
+  return freed_count;
+}
+
 absl::StatusOr<bool> BinaryDecisionDiagram::Evaluate(
     BddNodeIndex expr,
     const absl::flat_hash_map<BddNodeIndex, bool>& variable_values) const {
@@ -168,15 +321,14 @@ absl::StatusOr<bool> BinaryDecisionDiagram::Evaluate(
                   << variable_values.at(node);
     }
   }
-  while (result != zero() && result != one()) {
+  while (!IsTerminal(result)) {
     BddNodeIndex var_node = GetVariableBaseNode(GetNode(result).variable);
     if (!variable_values.contains(var_node)) {
       return absl::InvalidArgumentError(
           absl::StrFormat("Missing value for BDD variable %d (node index %d)",
                           GetNode(result).variable.value(), var_node.value()));
     }
-    result = variable_values.at(var_node) ? GetNode(result).high
-                                          : GetNode(result).low;
+    result = variable_values.at(var_node) ? High(result) : Low(result);
   }
   XLS_VLOG(2) << "  result = " << (result == one() ? true : false);
   return result == one();
@@ -207,11 +359,11 @@ void BinaryDecisionDiagram::ToStringDnfHelper(BddNodeIndex expr,
     return;
   }
 
-  const BddNode& node = GetNode(expr);
-  terms->push_back(absl::StrCat("x", node.variable.value()));
-  ToStringDnfHelper(node.high, minterms_to_emit, terms, str);
-  terms->back() = absl::StrCat("!x", node.variable.value());
-  ToStringDnfHelper(node.low, minterms_to_emit, terms, str);
+  BddVariable variable = GetNode(expr).variable;
+  terms->push_back(absl::StrCat("x", variable.value()));
+  ToStringDnfHelper(High(expr), minterms_to_emit, terms, str);
+  terms->back() = absl::StrCat("!x", variable.value());
+  ToStringDnfHelper(Low(expr), minterms_to_emit, terms, str);
   terms->pop_back();
 }
 
@@ -22,6 +22,8 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/memory_accounting.h"
 #include "xls/common/strong_int.h"
 
 namespace xls {
@@ -34,15 +36,28 @@ namespace xls {
 //   K.S. Brace, R.L. Rudell, and R.E. Bryant,
 //   "Efficient Implementation of a BDD package"
 //   https://ieeexplore.ieee.org/document/114826
+//
+// As described there, edges may be complemented: an expression is a reference
+// to a node plus a bit indicating whether the node's function is inverted. An
+// expression and its inverse thus share all nodes, which halves the node count
+// for many functions and makes Not a constant-time operation. To keep the
+// representation canonical the low child of a node is never complemented, and
+// there is a single terminal node whose uncomplemented value is zero.
+//
+// Nodes are not reference counted. Instead, nodes no longer referenced by any
+// expression of interest can be reclaimed with GarbageCollect.
 
 // For efficiency variables and nodes are referred to by indices into vector
-// data members in the BDD.
+// data members in the BDD. A BddNodeIndex refers to an expression: the upper
+// bits hold the index of the node and the lowest bit is set if the node's
+// function is complemented.
 XLS_DEFINE_STRONG_INT_TYPE(BddVariable, int32_t);
 XLS_DEFINE_STRONG_INT_TYPE(BddNodeIndex, int32_t);
 
 // A node in the BDD. The node is associated with a single variable and has
 // children corresponding to when the variable is true (high) and when it is
-// false (low).
+// false (low). The children are the cofactors of the node's uncomplemented
+// function; the low child is never complemented.
 struct BddNode {
   BddNode() : variable(0), high(0), low(0), path_count(0) {}
   BddNode(BddVariable v, BddNodeIndex h, BddNodeIndex l, int32_t p)
@@ -54,7 +69,8 @@ struct BddNode {
 
   // Number of paths from this node to the terminal nodes 0 and 1. Used to limit
   // the growth of the BDD by halting evaluation if the number of paths gets too
-  // large. Saturates at INT32_MAX.
+  // large. Saturates at INT32_MAX. Complementing an expression does not change
+  // its path count.
   int32_t path_count;
 };
 
@@ -68,8 +84,10 @@ class BinaryDecisionDiagram {
   // variable's value.
   BddNodeIndex NewVariable();
 
-  // Returns the inverse of the given expression.
-  BddNodeIndex Not(BddNodeIndex expr);
+  // Returns the inverse of the given expression. Never creates nodes.
+  BddNodeIndex Not(BddNodeIndex expr) const {
+    return BddNodeIndex(expr.value() ^ 1);
+  }
 
   // Returns the OR/AND of the given expressions.
   BddNodeIndex And(BddNodeIndex a, BddNodeIndex b);
@@ -87,13 +105,23 @@ class BinaryDecisionDiagram {
       BddNodeIndex expr,
       const absl::flat_hash_map<BddNodeIndex, bool>& variable_values) const;
 
-  // Returns the BDD node with the given index.
+  // Returns the BDD node referred to by the given expression. The node's
+  // children are relative to the uncomplemented expression.
   const BddNode& GetNode(BddNodeIndex node_index) const {
-    return nodes_.at(node_index.value());
+    return nodes_.at(node_index.value() >> 1);
+  }
+
+  // Returns true if the given expression is the complement of its node.
+  static bool IsComplemented(BddNodeIndex expr) {
+    return (expr.value() & 1) != 0;
   }
 
-  // Returns the number of nodes in the graph.
-  int64_t size() const { return nodes_.size(); }
+  // Returns the number of live nodes in the graph, including the terminal.
+  int64_t size() const { return nodes_.size() - free_nodes_.size(); }
+
+  // Returns all node slots in the graph. Slots freed by GarbageCollect and not
+  // yet reused have a path count of zero.
+  absl::Span<const BddNode> nodes() const { return nodes_; }
 
   // Returns the number of variables in the graph.
   int64_t variable_count() const { return next_var_.value(); }
@@ -112,9 +140,22 @@ class BinaryDecisionDiagram {
   // variable. The expression of a base node is exactly equal to the value of
   // the variable.
   bool IsVariableBaseNode(BddNodeIndex expr) const {
-    return GetNode(expr).high == one() && GetNode(expr).low == zero();
+    return !IsComplemented(expr) && GetNode(expr).high == one() &&
+           GetNode(expr).low == zero();
   }
 
+  // Frees all nodes which are not reachable from the given expressions or from
+  // the base nodes of the variables, and returns the number of nodes freed.
+  // Freed nodes are reused by later operations so any expression not passed in
+  // `roots` must not be used afterwards. Live expressions keep their indices.
+  int64_t GarbageCollect(absl::Span<const BddNodeIndex> roots);
+
+  // Returns true if enough nodes have been created since the last garbage
+  // collection that another collection is likely worthwhile. The threshold
+  // grows with the number of nodes surviving each collection so the cost of
+  // collecting under this policy is amortized over the nodes created.
+  bool ShouldGarbageCollect() const { return size() >= gc_threshold_; }
+
  private:
   // Helper for constructing a DNF string respresentation.
   void ToStringDnfHelper(BddNodeIndex expr, int64_t* minterms_to_emit,
@@ -122,10 +163,23 @@ class BinaryDecisionDiagram {
                          std::string* str) const;
 
   // Get the node corresponding to the given variable with the given low/high
-  // children. Creates it if it does not exist.
+  // children. Creates it if it does not exist. The returned expression may be
+  // complemented to keep the low child of the node uncomplemented.
   BddNodeIndex GetOrCreateNode(BddVariable var, BddNodeIndex high,
                                BddNodeIndex low);
 
+  // Returns true if the expression is the constant zero or one.
+  static bool IsTerminal(BddNodeIndex expr) { return expr.value() <= 1; }
+
+  // Returns the high or low child of the given expression, accounting for a
+  // complemented edge.
+  BddNodeIndex High(BddNodeIndex expr) const {
+    return BddNodeIndex(GetNode(expr).high.value() ^ (expr.value() & 1));
+  }
+  BddNodeIndex Low(BddNodeIndex expr) const {
+    return BddNodeIndex(GetNode(expr).low.value() ^ (expr.value() & 1));
+  }
+
   // Returns the node equal to given expression with the given variable
   // set to the given value.
   BddNodeIndex Restrict(BddNodeIndex expr, BddVariable var, bool value);
@@ -136,27 +190,53 @@ class BinaryDecisionDiagram {
 
   // Returns the node corresponding to the value of the given variable.
   BddNodeIndex GetVariableBaseNode(BddVariable variable) const {
-    return node_map_.at({variable, one(), zero()});
+    return variable_base_nodes_.at(variable.value());
   }
 
+  // Returns the slot of the computed table for the given if-then-else
+  // expression.
+  int64_t ComputedTableSlot(BddNodeIndex cond, BddNodeIndex if_true,
+                            BddNodeIndex if_false) const;
+
+  // Resizes the computed table to the given power of two, keeping as many of
+  // its entries as possible.
+  void ResizeComputedTable(int64_t size);
+
   // The numeric id to use for the next created variable. Increments with each
   // call to NewVariable which
   BddVariable next_var_ = BddVariable(0);
 
-  // The vector of all the nodes in the BDD.
+  // The vector of all the nodes in the BDD. Slot 0 is the terminal node.
   std::vector<BddNode> nodes_;
+  // The capacity of `nodes_` attributed to MemoryTag::kBddNodes.
+  MemoryAccount node_memory_account_{MemoryTag::kBddNodes};
+
+  // Indices of the slots in `nodes_` freed by garbage collection.
+  std::vector<int32_t> free_nodes_;
+
+  // The base node of each variable, indexed by variable.
+  std::vector<BddNodeIndex> variable_base_nodes_;
 
-  // A map from BDD node content (variable id, high child, low child) to the
-  // index of the respective node. This map is used to ensure that no duplicate
-  // nodes are created.
+  // The unique table: a map from BDD node content (variable id, high child,
+  // low child) to the index of the respective node. This map is used to ensure
+  // that no duplicate nodes are created.
   using NodeKey = std::tuple<BddVariable, BddNodeIndex, BddNodeIndex>;
   absl::flat_hash_map<NodeKey, BddNodeIndex> node_map_;
 
-  // A map from if-then-else expression to the node corresponding to that
-  // expression. The key elements are (condition, if-true, if-false). This map
-  // enables fast lookup for expressions.
-  using IteKey = std::tuple<BddNodeIndex, BddNodeIndex, BddNodeIndex>;
-  absl::flat_hash_map<IteKey, BddNodeIndex> ite_map_;
+  // The computed table: a direct-mapped cache from normalized if-then-else
+  // expressions (condition, if-true, if-false) to their results. Unlike a map
+  // of all expressions ever computed its size is bounded; a collision simply
+  // evicts the older entry.
+  struct ComputedEntry {
+    BddNodeIndex cond = BddNodeIndex(-1);
+    BddNodeIndex if_true;
+    BddNodeIndex if_false;
+    BddNodeIndex result;
+  };
+  std::vector<ComputedEntry> computed_table_;
+
+  // The node count at which ShouldGarbageCollect starts returning true.
+  int64_t gc_threshold_;
 };
 
 }  // namespace xls
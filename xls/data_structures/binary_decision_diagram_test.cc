@@ -14,6 +14,7 @@
 
 #include "xls/data_structures/binary_decision_diagram.h"
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -154,6 +155,76 @@ TEST(BinaryDecisionDiagramTest, AndOrIdentities) {
   EXPECT_EQ(bdd.And(var1, var2), bdd.Not(bdd.Or(bdd.Not(var1), bdd.Not(var2))));
 }
 
+TEST(BinaryDecisionDiagramTest, ComplementEdges) {
+  BinaryDecisionDiagram bdd;
+  BddNodeIndex x = bdd.NewVariable();
+  BddNodeIndex y = bdd.NewVariable();
+
+  // Inversion never creates nodes.
+  int64_t before_size = bdd.size();
+  EXPECT_EQ(bdd.Not(bdd.Not(x)), x);
+  BddNodeIndex x_and_y = bdd.And(x, y);
+  EXPECT_EQ(bdd.size(), before_size + 1);
+  BddNodeIndex nand = bdd.Not(x_and_y);
+  EXPECT_EQ(bdd.size(), before_size + 1);
+  EXPECT_EQ(bdd.GetNode(nand).variable, bdd.GetNode(x_and_y).variable);
+  EXPECT_EQ(bdd.path_count(nand), bdd.path_count(x_and_y));
+  EXPECT_FALSE(bdd.IsVariableBaseNode(bdd.Not(x)));
+
+  // An expression and its inverse share nodes so by De Morgan's law the OR of
+  // the inverted variables is free once the AND exists.
+  EXPECT_EQ(bdd.Or(bdd.Not(x), bdd.Not(y)), nand);
+  EXPECT_EQ(bdd.size(), before_size + 1);
+
+  EXPECT_THAT(bdd.Evaluate(nand, {{x, true}, {y, true}}), IsOkAndHolds(false));
+  EXPECT_THAT(bdd.Evaluate(nand, {{x, true}, {y, false}}), IsOkAndHolds(true));
+  EXPECT_EQ(bdd.ToStringDnf(nand), "x0.!x1 + !x0");
+}
+
+TEST(BinaryDecisionDiagramTest, GarbageCollect) {
+  BinaryDecisionDiagram bdd;
+  std::vector<BddNodeIndex> vars;
+  for (int64_t i = 0; i < 8; ++i) {
+    vars.push_back(bdd.NewVariable());
+  }
+  auto build_sum_of_products = [&]() {
+    BddNodeIndex result = bdd.zero();
+    for (int64_t i = 0; i < 8; i += 2) {
+      result = bdd.Or(result, bdd.And(vars[i], vars[i + 1]));
+    }
+    return result;
+  };
+  BddNodeIndex keep = bdd.Or(vars[0], bdd.Not(vars[7]));
+  build_sum_of_products();
+  int64_t size_with_garbage = bdd.size();
+
+  EXPECT_GT(bdd.GarbageCollect({keep}), 0);
+  EXPECT_LT(bdd.size(), size_with_garbage);
+  // Nothing else is freed by a second collection.
+  EXPECT_EQ(bdd.GarbageCollect({keep}), 0);
+
+  // The kept expression and the variables remain valid.
+  EXPECT_THAT(bdd.Evaluate(keep, {{vars[0], false}, {vars[7], false}}),
+              IsOkAndHolds(true));
+  EXPECT_THAT(bdd.Evaluate(keep, {{vars[0], false}, {vars[7], true}}),
+              IsOkAndHolds(false));
+  for (BddNodeIndex var : vars) {
+    EXPECT_TRUE(bdd.IsVariableBaseNode(var));
+  }
+
+  // Freed nodes are reused when the collected expression is rebuilt.
+  BddNodeIndex rebuilt = build_sum_of_products();
+  EXPECT_EQ(bdd.size(), size_with_garbage);
+  EXPECT_EQ(bdd.nodes().size(), size_with_garbage);
+  absl::flat_hash_map<BddNodeIndex, bool> values;
+  for (int64_t i = 0; i < 8; ++i) {
+    values[vars[i]] = i == 4 || i == 5;
+  }
+  EXPECT_THAT(bdd.Evaluate(rebuilt, values), IsOkAndHolds(true));
+  values[vars[5]] = false;
+  EXPECT_THAT(bdd.Evaluate(rebuilt, values), IsOkAndHolds(false));
+}
+
 TEST(BinaryDecisionDiagramTest, TwoWayOr) {
   BinaryDecisionDiagram bdd;
   BddNodeIndex var1 = bdd.NewVariable();
@@ -0,0 +1,185 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/graph_coloring.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/container/btree_set.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
+
+namespace xls {
+
+CsrGraph CsrGraph::FromEdges(
+    int64_t vertex_count,
+    absl::Span<const std::pair<int64_t, int64_t>> edges) {
+  CsrGraph graph;
+  std::vector<int64_t>& offsets = graph.offsets;
+  std::vector<int64_t>& neighbors = graph.neighbors;
+
+  offsets.assign(vertex_count + 1, 0);
+  for (const auto& [a, b] : edges) {
+    XLS_CHECK(a >= 0 && a < vertex_count && b >= 0 && b < vertex_count);
+    if (a != b) {
+      ++offsets[a + 1];
+      ++offsets[b + 1];
+    }
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  neighbors.resize(offsets.back());
+  std::vector<int64_t> next(offsets.begin(), offsets.end() - 1);
+  for (const auto& [a, b] : edges) {
+    if (a != b) {
+      neighbors[next[a]++] = b;
+      neighbors[next[b]++] = a;
+    }
+  }
+
+  // Sort each vertex's neighbors and compact away the duplicates.
+  int64_t written = 0;
+  int64_t begin = 0;
+  for (int64_t vertex = 0; vertex < vertex_count; ++vertex) {
+    int64_t end = offsets[vertex + 1];
+    std::sort(neighbors.begin() + begin, neighbors.begin() + end);
+    auto unique_end =
+        std::unique(neighbors.begin() + begin, neighbors.begin() + end);
+    offsets[vertex] = written;
+    written = std::copy(neighbors.begin() + begin, unique_end,
+                        neighbors.begin() + written) -
+              neighbors.begin();
+    begin = end;
+  }
+  offsets[vertex_count] = written;
+  neighbors.resize(written);
+
+  return graph;
+}
+
+namespace {
+
+// Recolors the vertices greedily, visiting the color classes in the given
+// order. Since each class is independent, it takes at most one color beyond
+// those used by the classes before it, so no colors are added.
+std::vector<int64_t> RecolorGreedily(
+    const CsrGraph& graph, const std::vector<std::vector<int64_t>>& classes,
+    absl::Span<const int64_t> class_order) {
+  std::vector<int64_t> colors(graph.vertex_count(), -1);
+  // forbidden[c] == v when color c is used by a neighbor of vertex v.
+  std::vector<int64_t> forbidden(classes.size() + 1, -1);
+  for (int64_t class_index : class_order) {
+    for (int64_t vertex : classes[class_index]) {
+      for (int64_t neighbor : graph.Neighbors(vertex)) {
+        if (colors[neighbor] >= 0) {
+          forbidden[colors[neighbor]] = vertex;
+        }
+      }
+      int64_t color = 0;
+      while (forbidden[color] == vertex) {
+        ++color;
+      }
+      colors[vertex] = color;
+    }
+  }
+  return colors;
+}
+
+}  // namespace
+
+std::vector<int64_t> DsaturColoring(const CsrGraph& graph,
+                                    int64_t recoloring_passes) {
+  const int64_t vertex_count = graph.vertex_count();
+  std::vector<int64_t> colors(vertex_count, -1);
+
+  // The distinct colors of the colored neighbors of each uncolored vertex,
+  // whose count is its saturation.
+  std::vector<absl::flat_hash_set<int64_t>> neighbor_colors(vertex_count);
+  std::vector<int64_t> uncolored_degree(vertex_count);
+
+  // Uncolored vertices keyed by (saturation, uncolored degree, -index), so
+  // the last is the next to color.
+  using Key = std::tuple<int64_t, int64_t, int64_t>;
+  auto key = [&](int64_t vertex) -> Key {
+    return {static_cast<int64_t>(neighbor_colors[vertex].size()),
+            uncolored_degree[vertex], -vertex};
+  };
+  absl::btree_set<Key> queue;
+  for (int64_t vertex = 0; vertex < vertex_count; ++vertex) {
+    uncolored_degree[vertex] = graph.Neighbors(vertex).size();
+    queue.insert(key(vertex));
+  }
+
+  int64_t color_count = 0;
+  while (!queue.empty()) {
+    int64_t vertex = -std::get<2>(*queue.rbegin());
+    queue.erase(std::prev(queue.end()));
+
+    int64_t color = 0;
+    while (neighbor_colors[vertex].contains(color)) {
+      ++color;
+    }
+    colors[vertex] = color;
+    color_count = std::max(color_count, color + 1);
+    absl::flat_hash_set<int64_t>().swap(neighbor_colors[vertex]);
+
+    for (int64_t neighbor : graph.Neighbors(vertex)) {
+      if (colors[neighbor] >= 0) {
+        continue;
+      }
+      queue.erase(key(neighbor));
+      --uncolored_degree[neighbor];
+      neighbor_colors[neighbor].insert(color);
+      queue.insert(key(neighbor));
+    }
+  }
+
+  // Iterated greedy, alternating between visiting the color classes largest
+  // first and in reverse order, as suggested by Culberson.
+  for (int64_t pass = 0; pass < recoloring_passes; ++pass) {
+    std::vector<std::vector<int64_t>> classes(color_count);
+    for (int64_t vertex = 0; vertex < vertex_count; ++vertex) {
+      classes[colors[vertex]].push_back(vertex);
+    }
+    std::vector<int64_t> class_order(color_count);
+    std::iota(class_order.begin(), class_order.end(), 0);
+    if (pass % 2 == 0) {
+      std::stable_sort(class_order.begin(), class_order.end(),
+                       [&](int64_t a, int64_t b) {
+                         return classes[a].size() > classes[b].size();
+                       });
+    } else {
+      std::reverse(class_order.begin(), class_order.end());
+    }
+    colors = RecolorGreedily(graph, classes, class_order);
+
+    int64_t new_color_count = 0;
+    for (int64_t color : colors) {
+      new_color_count = std::max(new_color_count, color + 1);
+    }
+    XLS_CHECK_LE(new_color_count, color_count);
+    color_count = new_color_count;
+  }
+
+  return colors;
+}
+
+}  // namespace xls
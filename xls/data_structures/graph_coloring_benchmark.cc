@@ -0,0 +1,83 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares RecursiveLargestFirstColoring with DsaturColoring on random
+// graphs with an average degree of 16. The number of colors used is
+// reported as the "colors" counter.
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "include/benchmark/benchmark.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "xls/data_structures/graph_coloring.h"
+
+namespace xls {
+namespace {
+
+constexpr int64_t kAverageDegree = 16;
+
+std::vector<std::pair<int64_t, int64_t>> RandomEdges(int64_t vertex_count) {
+  std::mt19937_64 rng;
+  std::uniform_int_distribution<int64_t> vertex(0, vertex_count - 1);
+  std::vector<std::pair<int64_t, int64_t>> edges;
+  for (int64_t i = 0; i < vertex_count * kAverageDegree / 2; ++i) {
+    edges.push_back({vertex(rng), vertex(rng)});
+  }
+  return edges;
+}
+
+void BM_RecursiveLargestFirst(benchmark::State& state) {
+  CsrGraph graph =
+      CsrGraph::FromEdges(state.range(0), RandomEdges(state.range(0)));
+  absl::flat_hash_set<int64_t> vertices;
+  absl::flat_hash_map<int64_t, absl::flat_hash_set<int64_t>> neighborhoods;
+  for (int64_t v = 0; v < graph.vertex_count(); ++v) {
+    vertices.insert(v);
+    neighborhoods[v].insert(graph.Neighbors(v).begin(),
+                            graph.Neighbors(v).end());
+  }
+  int64_t color_count = 0;
+  for (auto _ : state) {
+    color_count = RecursiveLargestFirstColoring<int64_t>(
+                      vertices,
+                      [&](const int64_t& v) { return neighborhoods.at(v); })
+                      .size();
+  }
+  state.counters["colors"] = color_count;
+}
+
+void BM_Dsatur(benchmark::State& state) {
+  CsrGraph graph =
+      CsrGraph::FromEdges(state.range(0), RandomEdges(state.range(0)));
+  int64_t color_count = 0;
+  for (auto _ : state) {
+    color_count = 0;
+    for (int64_t color : DsaturColoring(graph, state.range(1))) {
+      color_count = std::max(color_count, color + 1);
+    }
+  }
+  state.counters["colors"] = color_count;
+}
+
+BENCHMARK(BM_RecursiveLargestFirst)->Arg(100)->Arg(300)->Arg(1000);
+BENCHMARK(BM_Dsatur)
+    ->ArgsProduct({{100, 300, 1000, 10'000, 100'000}, {0, 10, 100}});
+
+}  // namespace
+}  // namespace xls
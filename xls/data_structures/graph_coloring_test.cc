@@ -14,7 +14,11 @@
 
 #include "xls/data_structures/graph_coloring.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -64,6 +68,25 @@ std::vector<absl::flat_hash_set<V>> Z3FromMap(
   });
 }
 
+std::vector<absl::flat_hash_set<V>> DsaturFromMap(
+    const absl::flat_hash_map<V, absl::flat_hash_set<V>>& neighborhood) {
+  absl::flat_hash_map<V, absl::flat_hash_set<V>> symmetric_neighborhood;
+  absl::flat_hash_set<V> nodes;
+  for (const auto& [node, neighbors] : neighborhood) {
+    for (const auto& neighbor : neighbors) {
+      nodes.insert(node);
+      nodes.insert(neighbor);
+      symmetric_neighborhood[node].insert(neighbor);
+      symmetric_neighborhood[neighbor].insert(node);
+    }
+  }
+
+  return DsaturColoring<V>(nodes,
+                           [&](const V& node) -> absl::flat_hash_set<V> {
+                             return symmetric_neighborhood.at(node);
+                           });
+}
+
 bool IsValidColoring(
     const absl::flat_hash_map<V, absl::flat_hash_set<V>>& neighborhood,
     const std::vector<absl::flat_hash_set<V>>& coloring) {
@@ -98,6 +121,8 @@ TEST(GraphColoringTest, Bipartite) {
   EXPECT_TRUE(IsValidColoring(graph, RLFFromMap(graph)));
   EXPECT_LE(Z3FromMap(graph).size(), 2);
   EXPECT_TRUE(IsValidColoring(graph, Z3FromMap(graph)));
+  EXPECT_LE(DsaturFromMap(graph).size(), 2);
+  EXPECT_TRUE(IsValidColoring(graph, DsaturFromMap(graph)));
 }
 
 TEST(GraphColoringTest, Cycle) {
@@ -111,9 +136,12 @@ TEST(GraphColoringTest, Cycle) {
   EXPECT_TRUE(IsValidColoring(graph, RLFFromMap(graph)));
   EXPECT_EQ(Z3FromMap(graph).size(), 3);
   EXPECT_TRUE(IsValidColoring(graph, Z3FromMap(graph)));
+  EXPECT_EQ(DsaturFromMap(graph).size(), 3);
+  EXPECT_TRUE(IsValidColoring(graph, DsaturFromMap(graph)));
   graph.erase("e");
   graph["d"].erase("e");
   graph["d"].insert("a");
+  EXPECT_EQ(DsaturFromMap(graph).size(), 2);
   EXPECT_EQ(RLFFromMap(graph).size(), 2);
   EXPECT_TRUE(IsValidColoring(graph, RLFFromMap(graph)));
   EXPECT_EQ(Z3FromMap(graph).size(), 2);
@@ -134,6 +162,7 @@ TEST(GraphColoringTest, Wheel) {
   graph["center"].insert("e");
   EXPECT_EQ(RLFFromMap(graph).size(), 4);
   EXPECT_TRUE(IsValidColoring(graph, RLFFromMap(graph)));
+  EXPECT_EQ(DsaturFromMap(graph).size(), 4);
   graph.erase("e");
   graph["d"].erase("e");
   graph["d"].insert("a");
@@ -144,5 +173,44 @@ TEST(GraphColoringTest, Wheel) {
   EXPECT_TRUE(IsValidColoring(graph, Z3FromMap(graph)));
 }
 
+TEST(GraphColoringTest, CsrGraphFromEdges) {
+  CsrGraph graph =
+      CsrGraph::FromEdges(4, {{0, 2}, {2, 0}, {1, 1}, {0, 1}, {0, 2}});
+  EXPECT_EQ(graph.vertex_count(), 4);
+  EXPECT_THAT(graph.Neighbors(0), testing::ElementsAre(1, 2));
+  EXPECT_THAT(graph.Neighbors(1), testing::ElementsAre(0));
+  EXPECT_THAT(graph.Neighbors(2), testing::ElementsAre(0));
+  EXPECT_THAT(graph.Neighbors(3), testing::IsEmpty());
+}
+
+TEST(GraphColoringTest, DsaturLargeRandomGraph) {
+  const int64_t kVertexCount = 20'000;
+  std::mt19937_64 rng;
+  std::uniform_int_distribution<int64_t> vertex(0, kVertexCount - 1);
+  std::vector<std::pair<int64_t, int64_t>> edges;
+  for (int64_t i = 0; i < 8 * kVertexCount; ++i) {
+    edges.push_back({vertex(rng), vertex(rng)});
+  }
+  CsrGraph graph = CsrGraph::FromEdges(kVertexCount, edges);
+
+  int64_t previous_color_count = kVertexCount + 1;
+  for (int64_t passes : {0, 1, 10}) {
+    std::vector<int64_t> colors = DsaturColoring(graph, passes);
+    ASSERT_EQ(colors.size(), kVertexCount);
+    int64_t color_count = 0;
+    for (int64_t v = 0; v < kVertexCount; ++v) {
+      color_count = std::max(color_count, colors[v] + 1);
+      for (int64_t neighbor : graph.Neighbors(v)) {
+        ASSERT_NE(colors[v], colors[neighbor]) << v << " " << neighbor;
+      }
+    }
+    // An average degree of 16 needs far fewer colors than vertices, and
+    // recoloring never makes it worse.
+    EXPECT_LT(color_count, 17);
+    EXPECT_LE(color_count, previous_color_count);
+    previous_color_count = color_count;
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -22,6 +22,7 @@
 
 #include "absl/base/casts.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/numeric/bits.h"
 #include "absl/types/span.h"
 #include "xls/common/bits_util.h"
 #include "xls/common/endian.h"
@@ -161,8 +162,18 @@ class InlineBitmap {
                        bool value = true) {
     XLS_DCHECK_GE(lower_index, 0);
     XLS_DCHECK_LE(upper_index, bit_count());
-    for (int64_t index = lower_index; index < upper_index; ++index) {
-      Set(index, value);
+    if (lower_index >= upper_index) {
+      return;
+    }
+    int64_t last_wordno = (upper_index - 1) / kWordBits;
+    for (int64_t wordno = lower_index / kWordBits; wordno <= last_wordno;
+         ++wordno) {
+      uint64_t mask = RangeMaskForWord(wordno, lower_index, upper_index);
+      if (value) {
+        data_[wordno] |= mask;
+      } else {
+        data_[wordno] &= ~mask;
+      }
     }
   }
   // Sets all the values of the bitmap to false.
@@ -180,6 +191,19 @@ class InlineBitmap {
     return data_[wordno];
   }
 
+  // Sets the 64-bit word that backs a group of 64 bits. Bits of the last word
+  // beyond the end of the bitmap are masked off.
+  void SetWord(int64_t wordno, uint64_t value) {
+    XLS_DCHECK_LT(wordno, word_count());
+    data_[wordno] = value;
+    if (wordno == word_count() - 1) {
+      MaskLastWord();
+    }
+  }
+
+  // Returns the number of 64-bit words that back the bitmap.
+  int64_t word_count() const { return data_.size(); }
+
   // Sets a byte in the data underlying the bitmap.
   //
   // Setting byte i as {b_7, b_6, b_5, ..., b_0} sets the bit at i*8 to b_0, the
@@ -254,6 +278,30 @@ class InlineBitmap {
     return 0;
   }
 
+  // Returns true if bits [lower_index, upper_index) of this bitmap and `other`
+  // are equal.
+  bool RangeEquals(const InlineBitmap& other, int64_t lower_index,
+                   int64_t upper_index) const {
+    XLS_DCHECK_GE(lower_index, 0);
+    XLS_DCHECK_LE(upper_index, bit_count());
+    XLS_DCHECK_LE(upper_index, other.bit_count());
+    if (lower_index >= upper_index) {
+      return true;
+    }
+    int64_t last_wordno = (upper_index - 1) / kWordBits;
+    for (int64_t wordno = lower_index / kWordBits; wordno <= last_wordno;
+         ++wordno) {
+      uint64_t mask = RangeMaskForWord(wordno, lower_index, upper_index);
+      if (((data_[wordno] ^ other.data_[wordno]) & mask) != 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // The bulk operations below work a word at a time, in loops simple enough
+  // for the compiler to vectorize.
+
   // Sets this bitmap to the union of this bitmap and `other`.
   void Union(const InlineBitmap& other) {
     XLS_CHECK_EQ(bit_count(), other.bit_count());
@@ -262,6 +310,92 @@ class InlineBitmap {
     }
   }
 
+  // Sets this bitmap to the intersection of this bitmap and `other`.
+  void Intersect(const InlineBitmap& other) {
+    XLS_CHECK_EQ(bit_count(), other.bit_count());
+    for (int64_t i = 0; i < data_.size(); ++i) {
+      data_[i] &= other.data_[i];
+    }
+  }
+
+  // Sets this bitmap to the symmetric difference (exclusive or) of this
+  // bitmap and `other`.
+  void SymmetricDifference(const InlineBitmap& other) {
+    XLS_CHECK_EQ(bit_count(), other.bit_count());
+    for (int64_t i = 0; i < data_.size(); ++i) {
+      data_[i] ^= other.data_[i];
+    }
+  }
+
+  // Inverts every bit of this bitmap.
+  void Complement() {
+    for (int64_t i = 0; i < data_.size(); ++i) {
+      data_[i] = ~data_[i];
+    }
+    MaskLastWord();
+  }
+
+  // Returns the number of set bits.
+  int64_t PopCount() const {
+    int64_t count = 0;
+    for (int64_t wordno = 0; wordno < word_count(); ++wordno) {
+      count += absl::popcount(data_[wordno] & MaskForWord(wordno));
+    }
+    return count;
+  }
+
+  // Returns the number of consecutive zero (or one) bits starting from the
+  // highest index.
+  int64_t CountLeadingZeros() const { return CountLeading(/*flip=*/0); }
+  int64_t CountLeadingOnes() const { return CountLeading(/*flip=*/~0ULL); }
+
+  // Returns the number of consecutive zero (or one) bits starting from index
+  // zero.
+  int64_t CountTrailingZeros() const { return CountTrailing(/*flip=*/0); }
+  int64_t CountTrailingOnes() const { return CountTrailing(/*flip=*/~0ULL); }
+
+  // Moves every bit `amount` positions towards the highest index, shifting in
+  // zeros; bits moved past the highest index are dropped.
+  void ShiftLeft(int64_t amount) {
+    XLS_DCHECK_GE(amount, 0);
+    if (amount >= bit_count()) {
+      SetAllBitsToFalse();
+      return;
+    }
+    const int64_t word_shift = amount / kWordBits;
+    const int64_t bit_shift = amount % kWordBits;
+    for (int64_t i = word_count() - 1; i >= 0; --i) {
+      const int64_t from = i - word_shift;
+      uint64_t word = from >= 0 ? data_[from] << bit_shift : 0;
+      if (bit_shift != 0 && from >= 1) {
+        word |= data_[from - 1] >> (kWordBits - bit_shift);
+      }
+      data_[i] = word;
+    }
+    MaskLastWord();
+  }
+
+  // Moves every bit `amount` positions towards index zero, shifting in zeros;
+  // bits moved past index zero are dropped.
+  void ShiftRight(int64_t amount) {
+    XLS_DCHECK_GE(amount, 0);
+    if (amount >= bit_count()) {
+      SetAllBitsToFalse();
+      return;
+    }
+    MaskLastWord();
+    const int64_t word_shift = amount / kWordBits;
+    const int64_t bit_shift = amount % kWordBits;
+    for (int64_t i = 0; i < word_count(); ++i) {
+      const int64_t from = i + word_shift;
+      uint64_t word = from < word_count() ? data_[from] >> bit_shift : 0;
+      if (bit_shift != 0 && from + 1 < word_count()) {
+        word |= data_[from + 1] << (kWordBits - bit_shift);
+      }
+      data_[i] = word;
+    }
+  }
+
   int64_t byte_count() const { return CeilOfRatio(bit_count_, int64_t{8}); }
 
   template <typename H>
@@ -274,7 +408,6 @@ class InlineBitmap {
 
   static constexpr int64_t kWordBits = 64;
   static constexpr int64_t kWordBytes = 8;
-  int64_t word_count() const { return data_.size(); }
 
   void MaskLastWord() {
     if (word_count() == 0) {
@@ -285,6 +418,46 @@ class InlineBitmap {
     data_[last_wordno] &= mask;
   }
 
+  // Creates a mask for the bits of word "wordno" in the range
+  // [lower_index, upper_index), which must overlap the word.
+  static uint64_t RangeMaskForWord(int64_t wordno, int64_t lower_index,
+                                   int64_t upper_index) {
+    uint64_t mask = Mask(kWordBits);
+    if (wordno == lower_index / kWordBits) {
+      mask &= Mask(kWordBits) << (lower_index % kWordBits);
+    }
+    if (wordno == (upper_index - 1) / kWordBits) {
+      mask &= Mask((upper_index - 1) % kWordBits + 1);
+    }
+    return mask;
+  }
+
+  // Counts the bits from the highest index which are zero after xor-ing with
+  // "flip".
+  int64_t CountLeading(uint64_t flip) const {
+    for (int64_t wordno = word_count() - 1; wordno >= 0; --wordno) {
+      uint64_t mask = MaskForWord(wordno);
+      uint64_t word = (data_[wordno] ^ flip) & mask;
+      if (word != 0) {
+        int64_t highest_set = wordno * kWordBits + kWordBits - 1 -
+                              absl::countl_zero(word);
+        return bit_count() - 1 - highest_set;
+      }
+    }
+    return bit_count();
+  }
+
+  // Counts the bits from index zero which are zero after xor-ing with "flip".
+  int64_t CountTrailing(uint64_t flip) const {
+    for (int64_t wordno = 0; wordno < word_count(); ++wordno) {
+      uint64_t word = (data_[wordno] ^ flip) & MaskForWord(wordno);
+      if (word != 0) {
+        return wordno * kWordBits + absl::countr_zero(word);
+      }
+    }
+    return bit_count();
+  }
+
   // Creates a mask for the valid bits in word "wordno".
   uint64_t MaskForWord(int64_t wordno) const {
     int64_t remainder = bit_count_ % kWordBits;
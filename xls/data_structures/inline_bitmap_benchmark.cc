@@ -0,0 +1,121 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks for the word-wise InlineBitmap operations across widths
+// from a single bit to 64K bits.
+
+#include <cstdint>
+#include <random>
+
+#include "include/benchmark/benchmark.h"
+#include "xls/data_structures/inline_bitmap.h"
+
+namespace xls {
+namespace {
+
+InlineBitmap RandomBitmap(int64_t bit_count, std::mt19937_64& rng) {
+  InlineBitmap bitmap(bit_count);
+  for (int64_t i = 0; i < bitmap.word_count(); ++i) {
+    bitmap.SetWord(i, rng());
+  }
+  return bitmap;
+}
+
+template <typename OpFn>
+void BM_BinaryOp(benchmark::State& state, OpFn op) {
+  std::mt19937_64 rng;
+  InlineBitmap lhs = RandomBitmap(state.range(0), rng);
+  InlineBitmap rhs = RandomBitmap(state.range(0), rng);
+  for (auto _ : state) {
+    op(lhs, rhs);
+    benchmark::DoNotOptimize(lhs);
+  }
+}
+
+template <typename OpFn>
+void BM_UnaryOp(benchmark::State& state, OpFn op) {
+  std::mt19937_64 rng;
+  InlineBitmap bitmap = RandomBitmap(state.range(0), rng);
+  for (auto _ : state) {
+    op(bitmap);
+    benchmark::DoNotOptimize(bitmap);
+  }
+}
+
+template <typename OpFn>
+void BM_Query(benchmark::State& state, OpFn op) {
+  // A single set bit in the middle, so scans from either end stop halfway.
+  InlineBitmap bitmap(state.range(0));
+  bitmap.Set(state.range(0) / 2);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(op(bitmap));
+  }
+}
+
+void BM_RangeEquals(benchmark::State& state) {
+  std::mt19937_64 rng;
+  InlineBitmap lhs = RandomBitmap(state.range(0), rng);
+  InlineBitmap rhs = lhs;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        lhs.RangeEquals(rhs, state.range(0) / 4, state.range(0)));
+  }
+}
+
+#define XLS_INLINE_BITMAP_BENCHMARK(kind, name, op)                       \
+  BENCHMARK_CAPTURE(BM_##kind, name, op)                                  \
+      ->Arg(1)                                                            \
+      ->Arg(64)                                                           \
+      ->Arg(65)                                                           \
+      ->Arg(256)                                                          \
+      ->Arg(1024)                                                         \
+      ->Arg(4096)                                                         \
+      ->Arg(65536)
+
+XLS_INLINE_BITMAP_BENCHMARK(BinaryOp, Union,
+                            [](InlineBitmap& lhs, const InlineBitmap& rhs) {
+                              lhs.Union(rhs);
+                            });
+XLS_INLINE_BITMAP_BENCHMARK(BinaryOp, Intersect,
+                            [](InlineBitmap& lhs, const InlineBitmap& rhs) {
+                              lhs.Intersect(rhs);
+                            });
+XLS_INLINE_BITMAP_BENCHMARK(BinaryOp, SymmetricDifference,
+                            [](InlineBitmap& lhs, const InlineBitmap& rhs) {
+                              lhs.SymmetricDifference(rhs);
+                            });
+XLS_INLINE_BITMAP_BENCHMARK(UnaryOp, Complement,
+                            [](InlineBitmap& bitmap) { bitmap.Complement(); });
+XLS_INLINE_BITMAP_BENCHMARK(UnaryOp, ShiftLeft, [](InlineBitmap& bitmap) {
+  bitmap.ShiftLeft(bitmap.bit_count() / 3);
+});
+XLS_INLINE_BITMAP_BENCHMARK(UnaryOp, ShiftRight, [](InlineBitmap& bitmap) {
+  bitmap.ShiftRight(bitmap.bit_count() / 3);
+});
+XLS_INLINE_BITMAP_BENCHMARK(Query, PopCount,
+                            [](const InlineBitmap& bitmap) {
+                              return bitmap.PopCount();
+                            });
+XLS_INLINE_BITMAP_BENCHMARK(Query, CountLeadingZeros,
+                            [](const InlineBitmap& bitmap) {
+                              return bitmap.CountLeadingZeros();
+                            });
+XLS_INLINE_BITMAP_BENCHMARK(Query, CountTrailingZeros,
+                            [](const InlineBitmap& bitmap) {
+                              return bitmap.CountTrailingZeros();
+                            });
+BENCHMARK(BM_RangeEquals)->Arg(1)->Arg(64)->Arg(1024)->Arg(65536);
+
+}  // namespace
+}  // namespace xls
@@ -14,8 +14,10 @@
 
 #include "xls/data_structures/inline_bitmap.h"
 
+#include <cstdint>
 #include <ios>
 #include <limits>
+#include <random>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -95,6 +97,18 @@ TEST(InlineBitmapTest, SetRange) {
   EXPECT_TRUE(b.IsAllZeroes());
 }
 
+TEST(InlineBitmapTest, SetRangeAcrossWords) {
+  InlineBitmap b(/*bit_count=*/200, /*fill=*/true);
+  b.SetRange(60, 130, false);
+  for (int64_t i = 0; i < 200; ++i) {
+    EXPECT_EQ(b.Get(i), i < 60 || i >= 130) << i;
+  }
+  b.SetRange(64, 128);
+  EXPECT_EQ(b.PopCount(), 200 - 4 - 2);
+  b.SetRange(0, 200);
+  EXPECT_TRUE(b.IsAllOnes());
+}
+
 TEST(InlineBitmapTest, SetAllBitsToFalse) {
   InlineBitmap b(/*bit_count=*/3);
   EXPECT_TRUE(b.IsAllZeroes());
@@ -253,6 +267,18 @@ TEST(InlineBitmapTest, GetSetBytesAndWords) {
   }
 }
 
+TEST(InlineBitmapTest, SetWord) {
+  InlineBitmap b(/*bit_count=*/70);
+  EXPECT_EQ(b.word_count(), 2);
+  b.SetWord(0, 0x123456789abcdef0);
+  // Only the low 6 bits of the last word are in range.
+  b.SetWord(1, 0xffff);
+  EXPECT_EQ(b.GetWord(0), 0x123456789abcdef0);
+  EXPECT_EQ(b.GetWord(1), 0x3f);
+  EXPECT_TRUE(b.Get(69));
+  EXPECT_FALSE(b.Get(0));
+}
+
 TEST(InlineBitmapTest, FromToBytes) {
   {
     InlineBitmap b = InlineBitmap::FromBytes(0, absl::Span<const uint8_t>());
@@ -415,6 +441,118 @@ TEST(InlineBitmapTest, Union) {
   }
 }
 
+InlineBitmap RandomBitmap(int64_t bit_count, std::mt19937_64& rng) {
+  InlineBitmap result(bit_count);
+  for (int64_t i = 0; i < result.word_count(); ++i) {
+    result.SetWord(i, rng());
+  }
+  return result;
+}
+
+// The widths the word-wise operations are checked against bit-wise
+// references at, around the word boundaries.
+const int64_t kTestWidths[] = {0, 1, 2, 63, 64, 65, 127, 128, 129, 200};
+
+TEST(InlineBitmapTest, BitwiseOperations) {
+  std::mt19937_64 rng;
+  for (int64_t width : kTestWidths) {
+    InlineBitmap a = RandomBitmap(width, rng);
+    InlineBitmap b = RandomBitmap(width, rng);
+    InlineBitmap a_and_b = a;
+    a_and_b.Intersect(b);
+    InlineBitmap a_or_b = a;
+    a_or_b.Union(b);
+    InlineBitmap a_xor_b = a;
+    a_xor_b.SymmetricDifference(b);
+    InlineBitmap not_a = a;
+    not_a.Complement();
+    int64_t pop_count = 0;
+    for (int64_t i = 0; i < width; ++i) {
+      EXPECT_EQ(a_and_b.Get(i), a.Get(i) && b.Get(i)) << width << " " << i;
+      EXPECT_EQ(a_or_b.Get(i), a.Get(i) || b.Get(i)) << width << " " << i;
+      EXPECT_EQ(a_xor_b.Get(i), a.Get(i) != b.Get(i)) << width << " " << i;
+      EXPECT_EQ(not_a.Get(i), !a.Get(i)) << width << " " << i;
+      pop_count += a.Get(i) ? 1 : 0;
+    }
+    EXPECT_EQ(a.PopCount(), pop_count) << width;
+    EXPECT_EQ(not_a.PopCount(), width - pop_count) << width;
+    // Complement must not set the bits past the end.
+    InlineBitmap all_ones(width, /*fill=*/true);
+    EXPECT_EQ(InlineBitmap(width).PopCount(), 0);
+    EXPECT_EQ(all_ones.PopCount(), width);
+    all_ones.Complement();
+    EXPECT_TRUE(all_ones.IsAllZeroes());
+  }
+}
+
+TEST(InlineBitmapTest, LeadingAndTrailingCounts) {
+  for (int64_t width : kTestWidths) {
+    InlineBitmap zeros(width);
+    InlineBitmap ones(width, /*fill=*/true);
+    EXPECT_EQ(zeros.CountLeadingZeros(), width);
+    EXPECT_EQ(zeros.CountTrailingZeros(), width);
+    EXPECT_EQ(zeros.CountLeadingOnes(), 0);
+    EXPECT_EQ(ones.CountLeadingOnes(), width);
+    EXPECT_EQ(ones.CountTrailingOnes(), width);
+    EXPECT_EQ(ones.CountTrailingZeros(), 0);
+    for (int64_t i = 0; i < width; ++i) {
+      InlineBitmap one_hot(width);
+      one_hot.Set(i);
+      EXPECT_EQ(one_hot.CountLeadingZeros(), width - 1 - i) << width;
+      EXPECT_EQ(one_hot.CountTrailingZeros(), i) << width;
+      InlineBitmap one_cold(width, /*fill=*/true);
+      one_cold.Set(i, false);
+      EXPECT_EQ(one_cold.CountLeadingOnes(), width - 1 - i) << width;
+      EXPECT_EQ(one_cold.CountTrailingOnes(), i) << width;
+    }
+  }
+}
+
+TEST(InlineBitmapTest, Shifts) {
+  std::mt19937_64 rng;
+  for (int64_t width : kTestWidths) {
+    InlineBitmap bitmap = RandomBitmap(width, rng);
+    for (int64_t amount : {int64_t{0}, int64_t{1}, int64_t{5}, int64_t{63},
+                           int64_t{64}, int64_t{65}, int64_t{130}, width}) {
+      InlineBitmap left = bitmap;
+      left.ShiftLeft(amount);
+      InlineBitmap right = bitmap;
+      right.ShiftRight(amount);
+      for (int64_t i = 0; i < width; ++i) {
+        EXPECT_EQ(left.Get(i), i >= amount && bitmap.Get(i - amount))
+            << width << " << " << amount << " @ " << i;
+        EXPECT_EQ(right.Get(i), i + amount < width && bitmap.Get(i + amount))
+            << width << " >> " << amount << " @ " << i;
+      }
+      // Bits shifted past the end must not reappear.
+      EXPECT_LE(left.PopCount(), bitmap.PopCount());
+    }
+  }
+}
+
+TEST(InlineBitmapTest, RangeEquals) {
+  std::mt19937_64 rng;
+  InlineBitmap a = RandomBitmap(200, rng);
+  InlineBitmap b = a;
+  b.Set(70, !a.Get(70));
+  b.Set(150, !a.Get(150));
+  EXPECT_TRUE(a.RangeEquals(b, 0, 70));
+  EXPECT_FALSE(a.RangeEquals(b, 0, 71));
+  EXPECT_TRUE(a.RangeEquals(b, 71, 150));
+  EXPECT_FALSE(a.RangeEquals(b, 70, 150));
+  EXPECT_TRUE(a.RangeEquals(b, 151, 200));
+  EXPECT_TRUE(a.RangeEquals(b, 70, 70));
+  EXPECT_TRUE(a.RangeEquals(a, 0, 200));
+
+  // Bitmaps of different widths compare within both.
+  InlineBitmap narrow(80);
+  for (int64_t i = 0; i < 80; ++i) {
+    narrow.Set(i, a.Get(i));
+  }
+  EXPECT_TRUE(a.RangeEquals(narrow, 0, 80));
+  EXPECT_FALSE(b.RangeEquals(narrow, 60, 80));
+}
+
 }  // namespace
 
 // Note: tests below this point are friended, so cannot live in the anonymous
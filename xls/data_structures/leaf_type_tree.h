@@ -15,10 +15,14 @@
 #ifndef XLS_DATA_STRUCTURES_LEAF_TYPE_TREE_H_
 #define XLS_DATA_STRUCTURES_LEAF_TYPE_TREE_H_
 
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -31,8 +35,15 @@ namespace xls {
 
 // A container which stores values of an arbitrary type T, one value for each
 // leaf element (Bits value) of a potentially-recursive XLS type. Values are
-// stored in a flat vector which provides fast iteration, but indexing through
-// tuple types is O(#elements in tuple).
+// stored in a flat vector which provides fast iteration. Indexing uses the leaf
+// offsets of tuple types so is O(depth of the index).
+//
+// Trees with more than one leaf hold their values in a buffer which is shared
+// copy-on-write between copies of the tree and subtrees created with
+// CopySubtree, so copying a tree or extracting a subtree is constant time. The
+// buffer is copied the first time a shared tree is accessed mutably. Because of
+// this, spans and references returned by the mutable accessors must not be used
+// after the tree has been copied.
 //
 // Example usage where T is an int64_t:
 //
@@ -63,13 +74,11 @@ class LeafTypeTree {
   LeafTypeTree(const LeafTypeTree<T>& other) = default;
   LeafTypeTree& operator=(const LeafTypeTree<T>& other) = default;
 
-  explicit LeafTypeTree(Type* type)
-      : type_(type), elements_(type->leaf_count()) {
-    MakeLeafTypes(type);
+  explicit LeafTypeTree(Type* type) : type_(type) {
+    SetStorage(Storage(type->leaf_count()));
   }
-  LeafTypeTree(Type* type, const T& init_value)
-      : type_(type), elements_(type->leaf_count(), init_value) {
-    MakeLeafTypes(type);
+  LeafTypeTree(Type* type, const T& init_value) : type_(type) {
+    SetStorage(Storage(type->leaf_count(), init_value));
   }
 
   // Constructor for tuples/arrays where members are provided as a span.
@@ -91,36 +100,36 @@ class LeafTypeTree {
       XLS_LOG(FATAL) << "Invalid constructor for bits types";
     }
 
-    MakeLeafTypes(type);
-    for (int64_t i = 0; i < init_values.size(); ++i) {
-      for (int64_t j = 0; j < init_values[i].size(); ++j) {
-        const T& leaf = init_values[i].elements()[j];
-        elements_.push_back(leaf);
-      }
+    Storage elements;
+    elements.reserve(type->leaf_count());
+    for (const LeafTypeTree<T>& init_value : init_values) {
+      elements.insert(elements.end(), init_value.elements().begin(),
+                      init_value.elements().end());
     }
+    SetStorage(std::move(elements));
   }
 
-  LeafTypeTree(Type* type, absl::Span<const T> elements)
-      : type_(type), elements_(elements.begin(), elements.end()) {
-    MakeLeafTypes(type_);
-    XLS_CHECK_EQ(leaf_types_.size(), elements_.size());
+  LeafTypeTree(Type* type, absl::Span<const T> elements) : type_(type) {
+    XLS_CHECK_EQ(type->leaf_count(), elements.size());
+    SetStorage(Storage(elements.begin(), elements.end()));
   }
 
   // Constructor which avoids copying by moving elements one-by-one.
   LeafTypeTree(Type* type, absl::Span<T> elements) : type_(type) {
-    MakeLeafTypes(type_);
-    XLS_CHECK_EQ(leaf_types_.size(), elements.size());
-    elements_.reserve(elements.size());
+    XLS_CHECK_EQ(type->leaf_count(), elements.size());
+    Storage moved_elements;
+    moved_elements.reserve(elements.size());
     for (T& element : elements) {
-      elements_.push_back(std::move(element));
+      moved_elements.push_back(std::move(element));
     }
+    SetStorage(std::move(moved_elements));
   }
 
   Type* type() const { return type_; }
 
   // Returns the number of values in the container (equivalently number of
   // leaves of the type).
-  int64_t size() const { return elements_.size(); }
+  int64_t size() const { return type_ == nullptr ? 0 : type_->leaf_count(); }
 
   // Returns the element at the given Type index.  The Type index defines a
   // recursive traversal through the object's XLS type. The Type index must
@@ -129,58 +138,86 @@ class LeafTypeTree {
     std::pair<Type*, int64_t> type_offset = GetSubtypeAndOffset(type_, index);
     // The index must refer to a leaf node (bits or token type).
     XLS_CHECK(IsLeafType(type_offset.first));
-    return elements_[type_offset.second];
+    return elements()[type_offset.second];
   }
   const T& Get(absl::Span<int64_t const> index) const {
-    return const_cast<LeafTypeTree*>(this)->Get(index);
+    std::pair<Type*, int64_t> type_offset = GetSubtypeAndOffset(type_, index);
+    XLS_CHECK(IsLeafType(type_offset.first));
+    return elements()[type_offset.second];
   }
 
   // Sets the element at the given Type index to the given value.
   void Set(absl::Span<int64_t const> index, const T& value) {
-    std::pair<Type*, int64_t> type_offset = GetSubtypeAndOffset(type_, index);
-    // The index must refer to a leaf node (bits or token type).
-    XLS_CHECK(IsLeafType(type_offset.first));
-    elements_[type_offset.second] = value;
+    Get(index) = value;
   }
 
   // Returns the values stored in this container.
-  absl::Span<T> elements() { return absl::Span<T>(elements_); }
+  absl::Span<T> elements() {
+    if (shared_ == nullptr) {
+      return absl::Span<T>(elements_);
+    }
+    if (shared_.use_count() > 1) {
+      // Copy-on-write: take a private copy of the leaves before handing out
+      // mutable access.
+      absl::Span<T const> leaves = std::as_const(*this).elements();
+      shared_ = std::make_shared<Storage>(leaves.begin(), leaves.end());
+      offset_ = 0;
+    }
+    return absl::Span<T>(shared_->data() + offset_, size());
+  }
   absl::Span<T const> elements() const {
-    return absl::Span<T const>(elements_);
+    if (shared_ == nullptr) {
+      return absl::Span<T const>(elements_);
+    }
+    return absl::Span<T const>(shared_->data() + offset_, size());
   }
 
   // Returns the values corresponding to the subtree rooted at the given index.
   absl::Span<T> GetSubelements(absl::Span<const int64_t> index) {
     std::pair<Type*, int64_t> type_offset = GetSubtypeAndOffset(type_, index);
-    return type_offset.first->leaf_count() == 0
-               ? absl::Span<T>()
-               : absl::Span<T>(&elements_[type_offset.second],
-                               type_offset.first->leaf_count());
+    return elements().subspan(type_offset.second,
+                              type_offset.first->leaf_count());
   }
   absl::Span<T const> GetSubelements(absl::Span<const int64_t> index) const {
     std::pair<Type*, int64_t> type_offset = GetSubtypeAndOffset(type_, index);
-    return type_offset.first->leaf_count() == 0
-               ? absl::Span<const T>()
-               : absl::Span<const T>(&elements_[type_offset.second],
-                                     type_offset.first->leaf_count());
+    return elements().subspan(type_offset.second,
+                              type_offset.first->leaf_count());
   }
 
   // Returns the types of each leaf in the XLS type of this object. The order of
-  // these types corresponds to the order of elements().
-  absl::Span<Type* const> leaf_types() const { return leaf_types_; }
+  // these types corresponds to the order of elements(). The types are computed
+  // on first use and shared between copies of the tree.
+  absl::Span<Type* const> leaf_types() const {
+    if (type_ == nullptr) {
+      return {};
+    }
+    if (IsLeafType(type_)) {
+      return absl::Span<Type* const>(&type_, 1);
+    }
+    if (leaf_types_ == nullptr) {
+      auto leaf_types = std::make_shared<std::vector<Type*>>();
+      leaf_types->reserve(size());
+      MakeLeafTypes(type_, *leaf_types);
+      leaf_types_ = std::move(leaf_types);
+    }
+    return *leaf_types_;
+  }
 
-  // Copies and returns the subtree rooted at the given type index as a
-  // LeafTypeTree.
+  // Returns the subtree rooted at the given type index as a LeafTypeTree. The
+  // returned tree shares the leaves of this tree until either is modified.
   LeafTypeTree<T> CopySubtree(absl::Span<const int64_t> index) const {
     std::pair<Type*, int64_t> type_offset = GetSubtypeAndOffset(type_, index);
-    // To avoid indexing into an empty vector, handle the empty elements()
-    // case specially.
+    if (shared_ != nullptr && type_offset.first->leaf_count() > 1) {
+      LeafTypeTree<T> subtree;
+      subtree.type_ = type_offset.first;
+      subtree.shared_ = shared_;
+      subtree.offset_ = offset_ + type_offset.second;
+      return subtree;
+    }
     return LeafTypeTree<T>(
         type_offset.first,
-        type_offset.first->leaf_count() == 0
-            ? absl::Span<const T>()
-            : absl::Span<const T>(&elements_[type_offset.second],
-                                  type_offset.first->leaf_count()));
+        elements().subspan(type_offset.second,
+                           type_offset.first->leaf_count()));
   }
 
   // Produce a new `LeafTypeTree` from this one `LeafTypeTree` with a different
@@ -219,11 +256,7 @@ class LeafTypeTree {
     if (!lhs.type_->IsEqualTo(rhs.type_)) {
       return false;
     }
-    XLS_CHECK_EQ(lhs.leaf_types_.size(), rhs.leaf_types_.size());
-    for (int64_t i = 0; i < lhs.leaf_types_.size(); ++i) {
-      XLS_CHECK(lhs.leaf_types_[i]->IsEqualTo(rhs.leaf_types_[i]));
-    }
-    return lhs.elements_ == rhs.elements_;
+    return absl::c_equal(lhs.elements(), rhs.elements());
   }
 
   template <typename H>
@@ -239,17 +272,16 @@ class LeafTypeTree {
           f) {
     std::vector<int64_t> type_index;
     int64_t linear_index = 0;
-    return ForEachHelper(type_, f, linear_index, type_index);
+    return ForEachHelper(type_, f, elements(), linear_index, type_index);
   }
 
   // Const overload of ForEach.
   absl::Status ForEach(
       const std::function<absl::Status(Type*, const T&,
                                        absl::Span<const int64_t>)>& f) const {
-    return const_cast<LeafTypeTree<T>*>(this)->ForEach(
-        [&](Type* type, T& data, absl::Span<const int64_t> index) {
-          return f(type, data, index);
-        });
+    std::vector<int64_t> type_index;
+    int64_t linear_index = 0;
+    return ForEachHelper(type_, f, elements(), linear_index, type_index);
   }
 
   // Returns the stringified elements of the LeafTypeTree in a structured
@@ -290,8 +322,20 @@ class LeafTypeTree {
   }
 
  private:
+  using Storage = absl::InlinedVector<T, 1>;
+
   static bool IsLeafType(Type* t) { return t->IsBits() || t->IsToken(); }
 
+  // Sets the leaves of the tree. Trees with at most one leaf store it inline,
+  // larger trees use a shareable buffer.
+  void SetStorage(Storage elements) {
+    if (elements.size() <= 1) {
+      elements_ = std::move(elements);
+    } else {
+      shared_ = std::make_shared<Storage>(std::move(elements));
+    }
+  }
+
   std::string ToStringHelper(const std::function<std::string(const T&)>& f,
                              Type* subtype, bool multiline, int64_t indent,
                              int64_t& linear_index) const {
@@ -335,21 +379,21 @@ class LeafTypeTree {
     return f(elements().at(linear_index++));
   }
 
-  // Creates the vector of leaf types.
-  void MakeLeafTypes(Type* t) {
+  // Appends the leaf types of `t` to `leaf_types`.
+  static void MakeLeafTypes(Type* t, std::vector<Type*>& leaf_types) {
     if (IsLeafType(t)) {
-      leaf_types_.push_back(t);
+      leaf_types.push_back(t);
       return;
     }
     if (t->IsArray()) {
       for (int64_t i = 0; i < t->AsArrayOrDie()->size(); ++i) {
-        MakeLeafTypes(t->AsArrayOrDie()->element_type());
+        MakeLeafTypes(t->AsArrayOrDie()->element_type(), leaf_types);
       }
       return;
     }
     XLS_CHECK(t->IsTuple());
     for (int64_t i = 0; i < t->AsTupleOrDie()->size(); ++i) {
-      MakeLeafTypes(t->AsTupleOrDie()->element_type(i));
+      MakeLeafTypes(t->AsTupleOrDie()->element_type(i), leaf_types);
     }
   }
 
@@ -372,25 +416,25 @@ class LeafTypeTree {
     XLS_CHECK(t->IsTuple());
     TupleType* tuple_type = t->AsTupleOrDie();
     XLS_CHECK_LT(index[0], tuple_type->size());
-    int64_t element_offset = 0;
-    for (int64_t i = 0; i < index[0]; ++i) {
-      element_offset += tuple_type->element_type(i)->leaf_count();
-    }
     return GetSubtypeAndOffset(tuple_type->element_type(index[0]),
-                               index.subspan(1), offset + element_offset);
+                               index.subspan(1),
+                               offset + tuple_type->leaf_offset(index[0]));
   }
 
-  absl::Status ForEachHelper(
+  // `E` is either `T` or `const T`.
+  template <typename E>
+  static absl::Status ForEachHelper(
       Type* subtype,
-      const std::function<absl::Status(Type*, T&, absl::Span<const int64_t>)>&
+      const std::function<absl::Status(Type*, E&, absl::Span<const int64_t>)>&
           f,
-      int64_t& linear_index, std::vector<int64_t>& type_index) {
+      absl::Span<E> elements, int64_t& linear_index,
+      std::vector<int64_t>& type_index) {
     if (subtype->IsArray()) {
       for (int64_t i = 0; i < subtype->AsArrayOrDie()->size(); ++i) {
         type_index.push_back(i);
         XLS_RETURN_IF_ERROR(
             ForEachHelper(subtype->AsArrayOrDie()->element_type(), f,
-                          linear_index, type_index));
+                          elements, linear_index, type_index));
         type_index.pop_back();
       }
       return absl::OkStatus();
@@ -400,17 +444,23 @@ class LeafTypeTree {
         type_index.push_back(i);
         XLS_RETURN_IF_ERROR(
             ForEachHelper(subtype->AsTupleOrDie()->element_type(i), f,
-                          linear_index, type_index));
+                          elements, linear_index, type_index));
         type_index.pop_back();
       }
       return absl::OkStatus();
     }
-    return f(subtype, elements_[linear_index++], type_index);
+    return f(subtype, elements[linear_index++], type_index);
   }
 
   Type* type_;
-  absl::InlinedVector<T, 1> elements_;
-  absl::InlinedVector<Type*, 1> leaf_types_;
+  // Leaves of trees with at most one leaf.
+  Storage elements_;
+  // Buffer holding the leaves of larger trees starting at `offset_`. The buffer
+  // may be shared with copies of the tree and with (or be owned by) the tree
+  // from which this one was created by CopySubtree.
+  std::shared_ptr<Storage> shared_;
+  int64_t offset_ = 0;
+  mutable std::shared_ptr<const std::vector<Type*>> leaf_types_;
 };
 
 }  // namespace xls
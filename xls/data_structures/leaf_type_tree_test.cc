@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -254,6 +255,44 @@ TEST_F(LeafTypeTreeTest, NestedArrayType) {
   EXPECT_THAT(subtree.elements(), ElementsAre(42, 0));
 }
 
+TEST_F(LeafTypeTreeTest, CopyOnWrite) {
+  LeafTypeTree<int64_t> tree(AsType("(bits[1], (bits[2], bits[3])[2])"));
+  tree.Set({0}, 1);
+  tree.Set({1, 0, 0}, 2);
+  tree.Set({1, 0, 1}, 3);
+  tree.Set({1, 1, 0}, 4);
+  tree.Set({1, 1, 1}, 5);
+
+  // Copies and subtrees share the leaves of the original tree until one of
+  // them is modified.
+  LeafTypeTree<int64_t> copy = tree;
+  LeafTypeTree<int64_t> subtree = tree.CopySubtree({1});
+  LeafTypeTree<int64_t> nested_subtree = subtree.CopySubtree({1});
+  EXPECT_EQ(std::as_const(copy).elements().data(),
+            std::as_const(tree).elements().data());
+  EXPECT_EQ(std::as_const(subtree).elements().data(),
+            std::as_const(tree).elements().data() + 1);
+  EXPECT_EQ(std::as_const(nested_subtree).elements().data(),
+            std::as_const(tree).elements().data() + 3);
+  EXPECT_THAT(AsStrings(nested_subtree.leaf_types()),
+              ElementsAre("bits[2]", "bits[3]"));
+
+  copy.Set({1, 1, 0}, 42);
+  EXPECT_THAT(copy.elements(), ElementsAre(1, 2, 3, 42, 5));
+  EXPECT_THAT(tree.elements(), ElementsAre(1, 2, 3, 4, 5));
+  EXPECT_THAT(subtree.elements(), ElementsAre(2, 3, 4, 5));
+
+  subtree.Set({0, 1}, 77);
+  EXPECT_THAT(subtree.elements(), ElementsAre(2, 77, 4, 5));
+  EXPECT_THAT(tree.elements(), ElementsAre(1, 2, 3, 4, 5));
+
+  tree.Set({1, 1, 1}, 123);
+  EXPECT_THAT(tree.elements(), ElementsAre(1, 2, 3, 4, 123));
+  EXPECT_THAT(nested_subtree.elements(), ElementsAre(4, 5));
+  EXPECT_EQ(nested_subtree, tree.CopySubtree({1, 0}).Map<int64_t>(
+                                [](int64_t x) { return x + 2; }));
+}
+
 TEST_F(LeafTypeTreeTest, EmptyTuple) {
   LeafTypeTree<int64_t> tree(AsType("()"));
   EXPECT_EQ(tree.size(), 0);
@@ -0,0 +1,223 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/maximum_clique.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/numeric/bits.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
+#include "xls/data_structures/inline_bitmap.h"
+
+namespace xls {
+namespace {
+
+// The search checks the clock once every this many search nodes.
+constexpr int64_t kTimeCheckInterval = 1024;
+
+int64_t IntersectionCount(const InlineBitmap& a, const InlineBitmap& b) {
+  int64_t count = 0;
+  for (int64_t i = 0; i < a.word_count(); ++i) {
+    count += absl::popcount(a.GetWord(i) & b.GetWord(i));
+  }
+  return count;
+}
+
+std::vector<int64_t> GreedyClique(absl::Span<const InlineBitmap> adjacency) {
+  InlineBitmap candidates(adjacency.size(), /*fill=*/true);
+  std::vector<int64_t> clique;
+  while (!candidates.IsAllZeroes()) {
+    int64_t best_vertex = -1;
+    int64_t best_degree = -1;
+    for (int64_t w = 0; w < candidates.word_count(); ++w) {
+      for (uint64_t word = candidates.GetWord(w); word != 0;
+           word &= word - 1) {
+        int64_t vertex = w * 64 + absl::countr_zero(word);
+        int64_t degree = IntersectionCount(candidates, adjacency[vertex]);
+        if (degree > best_degree) {
+          best_vertex = vertex;
+          best_degree = degree;
+        }
+      }
+    }
+    clique.push_back(best_vertex);
+    candidates.Intersect(adjacency[best_vertex]);
+  }
+  return clique;
+}
+
+class CliqueSearch {
+ public:
+  CliqueSearch(absl::Span<const InlineBitmap> adjacency,
+               const MaximumCliqueOptions& options)
+      : adjacency_(adjacency), options_(options) {
+    if (options.time_budget.has_value()) {
+      deadline_ = absl::Now() + *options.time_budget;
+    }
+  }
+
+  // Searches for a clique larger than `initial_clique`.
+  void Run(std::vector<int64_t> initial_clique) {
+    best_ = std::move(initial_clique);
+    Expand(InlineBitmap(adjacency_.size(), /*fill=*/true));
+  }
+
+  const std::vector<int64_t>& best() const { return best_; }
+  bool exhausted() const { return exhausted_; }
+  int64_t nodes_expanded() const { return nodes_expanded_; }
+
+ private:
+  bool OutOfBudget() {
+    if (exhausted_) {
+      return true;
+    }
+    if (options_.node_budget.has_value() &&
+        nodes_expanded_ >= *options_.node_budget) {
+      exhausted_ = true;
+    } else if (deadline_.has_value() &&
+               nodes_expanded_ % kTimeCheckInterval == 0 &&
+               absl::Now() >= *deadline_) {
+      exhausted_ = true;
+    }
+    return exhausted_;
+  }
+
+  // Greedily colors `candidates`, lowest index first, into independent sets.
+  // Appends the candidates to `vertices` in order of non-decreasing color
+  // and the (1-based) color of each to `colors`.
+  void ColorSort(const InlineBitmap& candidates, std::vector<int64_t>& vertices,
+                 std::vector<int64_t>& colors) const {
+    InlineBitmap uncolored = candidates;
+    for (int64_t color = 1; !uncolored.IsAllZeroes(); ++color) {
+      InlineBitmap available = uncolored;
+      for (int64_t w = 0; w < available.word_count(); ++w) {
+        while (available.GetWord(w) != 0) {
+          int64_t vertex = w * 64 + absl::countr_zero(available.GetWord(w));
+          vertices.push_back(vertex);
+          colors.push_back(color);
+          uncolored.Set(vertex, false);
+          available.Set(vertex, false);
+          // Words below `w` are already empty.
+          const InlineBitmap& neighbors = adjacency_[vertex];
+          for (int64_t x = w; x < available.word_count(); ++x) {
+            available.SetWord(x, available.GetWord(x) & ~neighbors.GetWord(x));
+          }
+        }
+      }
+    }
+  }
+
+  void Expand(InlineBitmap candidates) {
+    if (OutOfBudget()) {
+      return;
+    }
+    ++nodes_expanded_;
+    std::vector<int64_t> vertices;
+    std::vector<int64_t> colors;
+    ColorSort(candidates, vertices, colors);
+    for (int64_t i = static_cast<int64_t>(vertices.size()) - 1; i >= 0; --i) {
+      // The candidates up to `i` can be covered by `colors[i]` independent
+      // sets, so they extend the current clique by at most that much.
+      if (current_.size() + colors[i] <= best_.size()) {
+        return;
+      }
+      int64_t vertex = vertices[i];
+      current_.push_back(vertex);
+      InlineBitmap next = candidates;
+      next.Intersect(adjacency_[vertex]);
+      if (next.IsAllZeroes()) {
+        if (current_.size() > best_.size()) {
+          best_ = current_;
+        }
+      } else {
+        Expand(std::move(next));
+      }
+      current_.pop_back();
+      candidates.Set(vertex, false);
+      if (exhausted_) {
+        return;
+      }
+    }
+  }
+
+  absl::Span<const InlineBitmap> adjacency_;
+  const MaximumCliqueOptions& options_;
+  std::optional<absl::Time> deadline_;
+
+  std::vector<int64_t> current_;
+  std::vector<int64_t> best_;
+  bool exhausted_ = false;
+  int64_t nodes_expanded_ = 0;
+};
+
+}  // namespace
+
+MaximumCliqueResult DenseMaximumClique(absl::Span<const InlineBitmap> adjacency,
+                                       const MaximumCliqueOptions& options) {
+  const int64_t vertex_count = adjacency.size();
+  for (int64_t v = 0; v < vertex_count; ++v) {
+    XLS_CHECK_EQ(adjacency[v].bit_count(), vertex_count);
+    XLS_CHECK(!adjacency[v].Get(v)) << "Self-loop on vertex " << v;
+  }
+
+  // Renumber the vertices in order of non-increasing degree. The coloring
+  // visits low indices first, and coloring high-degree vertices first gives
+  // fewer colors and so tighter bounds.
+  std::vector<int64_t> order(vertex_count);
+  std::iota(order.begin(), order.end(), 0);
+  std::vector<int64_t> degree(vertex_count);
+  for (int64_t v = 0; v < vertex_count; ++v) {
+    degree[v] = adjacency[v].PopCount();
+  }
+  std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+    return degree[a] > degree[b];
+  });
+  std::vector<InlineBitmap> renumbered(vertex_count,
+                                      InlineBitmap(vertex_count));
+  for (int64_t i = 0; i < vertex_count; ++i) {
+    for (int64_t j = 0; j < vertex_count; ++j) {
+      if (adjacency[order[i]].Get(order[j])) {
+        renumbered[i].Set(j);
+      }
+    }
+  }
+
+  MaximumCliqueResult result;
+  std::vector<int64_t> clique = GreedyClique(renumbered);
+  if (options.greedy) {
+    result.is_maximum = vertex_count == 0;
+  } else {
+    CliqueSearch search(renumbered, options);
+    search.Run(std::move(clique));
+    clique = search.best();
+    result.is_maximum = !search.exhausted();
+    result.nodes_expanded = search.nodes_expanded();
+  }
+
+  for (int64_t v : clique) {
+    result.clique.push_back(order[v]);
+  }
+  std::sort(result.clique.begin(), result.clique.end());
+  return result;
+}
+
+}  // namespace xls
@@ -15,23 +15,27 @@
 #ifndef XLS_DATA_STRUCTURES_MAXIMUM_CLIQUE_H_
 #define XLS_DATA_STRUCTURES_MAXIMUM_CLIQUE_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "absl/container/btree_map.h"
 #include "absl/container/btree_set.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/log_message.h"
 #include "xls/common/logging/logging.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "ortools/linear_solver/linear_solver.h"
 
 namespace xls {
 
 // Compute the maximum clique in the given graph. This supports graphs of up to
-// around 100 nodes. More cleverness will be needed if we want to support bigger
-// graphs than that.
+// around 100 nodes; see `DenseMaximumClique` below for larger graphs.
 template <typename V, typename Compare = std::less<V>>
 absl::StatusOr<absl::btree_set<V, Compare>> MaximumClique(
     const absl::btree_set<V, Compare>& vertices,
@@ -95,6 +99,42 @@ absl::StatusOr<absl::btree_set<V, Compare>> MaximumClique(
   return result;
 }
 
+struct MaximumCliqueOptions {
+  // If true, skip the search and return the clique built greedily by
+  // repeatedly adding the candidate with the most neighbors among the
+  // remaining candidates.
+  bool greedy = false;
+
+  // Limits on the branch-and-bound search. Once either is exhausted the best
+  // clique found so far is returned.
+  std::optional<int64_t> node_budget;
+  std::optional<absl::Duration> time_budget;
+};
+
+struct MaximumCliqueResult {
+  // The vertices of the clique in increasing order.
+  std::vector<int64_t> clique;
+
+  // Whether the search ran to completion, so `clique` is a maximum clique.
+  bool is_maximum = false;
+
+  // The number of branch-and-bound search nodes expanded.
+  int64_t nodes_expanded = 0;
+};
+
+// Computes a maximum clique of the undirected graph whose vertex `i` has the
+// neighbors set in `adjacency[i]`. The adjacency must be symmetric and
+// irreflexive, and every bitmap must have `adjacency.size()` bits.
+//
+// This is a bitset branch-and-bound search in the style of Tomita's MCQ and
+// San Segundo's BBMC: candidates are greedily colored at every search node and
+// a branch is pruned once the current clique plus the number of colors left
+// cannot beat the best clique found. The greedy clique seeds the search, so a
+// clique at least that large is returned even if the budget is exhausted.
+MaximumCliqueResult DenseMaximumClique(
+    absl::Span<const InlineBitmap> adjacency,
+    const MaximumCliqueOptions& options = MaximumCliqueOptions());
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_MAXIMUM_CLIQUE_H_
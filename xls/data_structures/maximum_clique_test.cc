@@ -14,7 +14,9 @@
 
 #include "xls/data_structures/maximum_clique.h"
 
+#include <cstdint>
 #include <functional>
+#include <optional>
 #include <random>
 #include <string>
 #include <vector>
@@ -23,6 +25,9 @@
 #include "gtest/gtest.h"
 #include "absl/container/btree_map.h"
 #include "absl/container/btree_set.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 namespace {
@@ -156,5 +161,132 @@ TEST(MaximumCliqueTest, Big) {
   EXPECT_TRUE(IsValidClique(graph, clique));
 }
 
+std::vector<InlineBitmap> RandomGraph(int64_t vertex_count, double density,
+                                      int64_t seed) {
+  std::vector<InlineBitmap> adjacency(vertex_count,
+                                      InlineBitmap(vertex_count));
+  std::mt19937_64 gen(seed);
+  std::bernoulli_distribution coin(density);
+  for (int64_t x = 0; x < vertex_count; ++x) {
+    for (int64_t y = x + 1; y < vertex_count; ++y) {
+      if (coin(gen)) {
+        adjacency[x].Set(y);
+        adjacency[y].Set(x);
+      }
+    }
+  }
+  return adjacency;
+}
+
+bool IsValidDenseClique(absl::Span<const InlineBitmap> adjacency,
+                        absl::Span<const int64_t> clique) {
+  for (int64_t x : clique) {
+    for (int64_t y : clique) {
+      if (x != y && !adjacency[x].Get(y)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int64_t BruteForceCliqueSize(absl::Span<const InlineBitmap> adjacency) {
+  int64_t best = 0;
+  for (uint64_t subset = 0; subset < (uint64_t{1} << adjacency.size());
+       ++subset) {
+    std::vector<int64_t> vertices;
+    for (int64_t v = 0; v < adjacency.size(); ++v) {
+      if ((subset >> v) & 1) {
+        vertices.push_back(v);
+      }
+    }
+    if (vertices.size() > best && IsValidDenseClique(adjacency, vertices)) {
+      best = vertices.size();
+    }
+  }
+  return best;
+}
+
+TEST(DenseMaximumCliqueTest, Empty) {
+  MaximumCliqueResult result = DenseMaximumClique({});
+  EXPECT_TRUE(result.clique.empty());
+  EXPECT_TRUE(result.is_maximum);
+}
+
+TEST(DenseMaximumCliqueTest, ConnectedUnionOfCG4AndCG3) {
+  // a, b, c, d = 0..3 and x, y, z = 4..6, as in the test above.
+  std::vector<InlineBitmap> adjacency(7, InlineBitmap(7));
+  auto add_edge = [&](int64_t x, int64_t y) {
+    adjacency[x].Set(y);
+    adjacency[y].Set(x);
+  };
+  add_edge(0, 1);
+  add_edge(0, 2);
+  add_edge(0, 3);
+  add_edge(1, 2);
+  add_edge(1, 3);
+  add_edge(2, 3);
+  add_edge(4, 5);
+  add_edge(4, 6);
+  add_edge(5, 6);
+  add_edge(0, 4);
+  add_edge(1, 5);
+  add_edge(2, 6);
+  MaximumCliqueResult result = DenseMaximumClique(adjacency);
+  EXPECT_THAT(result.clique, testing::ElementsAre(0, 1, 2, 3));
+  EXPECT_TRUE(result.is_maximum);
+}
+
+TEST(DenseMaximumCliqueTest, MatchesBruteForce) {
+  for (int64_t seed = 0; seed < 8; ++seed) {
+    std::vector<InlineBitmap> adjacency =
+        RandomGraph(/*vertex_count=*/14, /*density=*/0.6, seed);
+    MaximumCliqueResult result = DenseMaximumClique(adjacency);
+    EXPECT_TRUE(result.is_maximum);
+    EXPECT_TRUE(IsValidDenseClique(adjacency, result.clique));
+    EXPECT_EQ(result.clique.size(), BruteForceCliqueSize(adjacency))
+        << "seed " << seed;
+  }
+}
+
+TEST(DenseMaximumCliqueTest, Large) {
+  std::vector<InlineBitmap> adjacency =
+      RandomGraph(/*vertex_count=*/300, /*density=*/0.5, /*seed=*/0);
+  MaximumCliqueResult result = DenseMaximumClique(adjacency);
+  EXPECT_TRUE(result.is_maximum);
+  EXPECT_TRUE(IsValidDenseClique(adjacency, result.clique));
+
+  MaximumCliqueOptions greedy_options;
+  greedy_options.greedy = true;
+  MaximumCliqueResult greedy = DenseMaximumClique(adjacency, greedy_options);
+  EXPECT_FALSE(greedy.is_maximum);
+  EXPECT_EQ(greedy.nodes_expanded, 0);
+  EXPECT_TRUE(IsValidDenseClique(adjacency, greedy.clique));
+  EXPECT_LE(greedy.clique.size(), result.clique.size());
+}
+
+TEST(DenseMaximumCliqueTest, BudgetReturnsBestCliqueFound) {
+  std::vector<InlineBitmap> adjacency =
+      RandomGraph(/*vertex_count=*/200, /*density=*/0.9, /*seed=*/1);
+  MaximumCliqueOptions greedy_options;
+  greedy_options.greedy = true;
+  MaximumCliqueResult greedy = DenseMaximumClique(adjacency, greedy_options);
+
+  MaximumCliqueOptions options;
+  options.node_budget = 100;
+  MaximumCliqueResult result = DenseMaximumClique(adjacency, options);
+  EXPECT_FALSE(result.is_maximum);
+  EXPECT_EQ(result.nodes_expanded, 100);
+  EXPECT_TRUE(IsValidDenseClique(adjacency, result.clique));
+  EXPECT_GE(result.clique.size(), greedy.clique.size());
+
+  options.node_budget = std::nullopt;
+  options.time_budget = absl::ZeroDuration();
+  result = DenseMaximumClique(adjacency, options);
+  EXPECT_FALSE(result.is_maximum);
+  EXPECT_TRUE(IsValidDenseClique(adjacency, result.clique));
+  EXPECT_GE(result.clique.size(), greedy.clique.size());
+}
+
 }  // namespace
 }  // namespace xls
@@ -15,6 +15,7 @@
 #include "xls/data_structures/min_cut.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <deque>
 #include <limits>
 #include <set>
@@ -22,7 +23,8 @@
 #include <utility>
 #include <vector>
 
-#include "absl/container/flat_hash_set.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/numeric/int128.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -272,9 +274,235 @@ int64_t AugmentFlow(const Graph& graph, NodeId source, NodeId sink,
   return 0;
 }
 
-}  // namespace
+// Computes a maximum flow with the push-relabel method. The residual graph is
+// stored in compressed sparse row form: the arcs extending from node v are at
+// indices [first_arc_[v], first_arc_[v + 1]) of the arc arrays. Each edge of
+// the original graph has a forward arc and a backward arc.
+class PushRelabelMaxFlow {
+ public:
+  PushRelabelMaxFlow(const Graph& graph, NodeId source, NodeId sink)
+      : node_count_(graph.node_count()),
+        source_(int64_t{source}),
+        sink_(int64_t{sink}),
+        first_arc_(node_count_ + 1, 0),
+        arc_head_(2 * graph.edge_count()),
+        arc_reverse_(2 * graph.edge_count()),
+        arc_capacity_(2 * graph.edge_count()) {
+    for (EdgeId edge_id = EdgeId{0}; edge_id <= graph.max_edge_id();
+         ++edge_id) {
+      const Edge& edge = graph.edge(edge_id);
+      ++first_arc_[int64_t{edge.from} + 1];
+      ++first_arc_[int64_t{edge.to} + 1];
+    }
+    for (int64_t v = 0; v < node_count_; ++v) {
+      first_arc_[v + 1] += first_arc_[v];
+    }
+    std::vector<int64_t> next_arc(first_arc_.begin(), first_arc_.end() - 1);
+    for (EdgeId edge_id = EdgeId{0}; edge_id <= graph.max_edge_id();
+         ++edge_id) {
+      const Edge& edge = graph.edge(edge_id);
+      int64_t forward = next_arc[int64_t{edge.from}]++;
+      int64_t backward = next_arc[int64_t{edge.to}]++;
+      arc_head_[forward] = int64_t{edge.to};
+      arc_head_[backward] = int64_t{edge.from};
+      arc_reverse_[forward] = backward;
+      arc_reverse_[backward] = forward;
+      arc_capacity_[forward] = edge.weight;
+      arc_capacity_[backward] = 0;
+    }
+  }
+
+  // Computes a maximum flow. Excess flow which cannot reach the sink is
+  // returned to the source so that upon return the preflow is a flow.
+  void Run() {
+    label_.assign(node_count_, 0);
+    label_[source_] = node_count_;
+    label_count_.assign(2 * node_count_ + 1, 0);
+    current_arc_.assign(first_arc_.begin(), first_arc_.end() - 1);
+    excess_.assign(node_count_, 0);
+    for (int64_t arc = first_arc_[source_]; arc < first_arc_[source_ + 1];
+         ++arc) {
+      if (arc_capacity_[arc] > 0) {
+        Push(arc, source_, arc_capacity_[arc]);
+      }
+    }
+    GlobalRelabel();
+    while (!active_.empty()) {
+      int32_t node = active_.front();
+      active_.pop_front();
+      Discharge(node);
+    }
+  }
+
+  // Returns whether each node is reachable from the source in the residual
+  // graph. Indexed by NodeId.
+  std::vector<bool> ReachableFromSource() const {
+    std::vector<bool> reachable(node_count_, false);
+    std::vector<int32_t> frontier = {source_};
+    reachable[source_] = true;
+    while (!frontier.empty()) {
+      int32_t node = frontier.back();
+      frontier.pop_back();
+      for (int64_t arc = first_arc_[node]; arc < first_arc_[node + 1]; ++arc) {
+        if (arc_capacity_[arc] > 0 && !reachable[arc_head_[arc]]) {
+          reachable[arc_head_[arc]] = true;
+          frontier.push_back(arc_head_[arc]);
+        }
+      }
+    }
+    return reachable;
+  }
+
+ private:
+  // Labels are in [0, 2 * node_count_]. Nodes with a label of at least
+  // node_count_ cannot reach the sink in the residual graph, and a label of
+  // 2 * node_count_ means the node can reach neither the sink nor the source.
+  int32_t unreachable_label() const { return 2 * node_count_; }
+
+  // Pushes `amount` units of flow along `arc` which extends from `node`.
+  void Push(int64_t arc, int32_t node, int64_t amount) {
+    int32_t head = arc_head_[arc];
+    // The capacities of an arc and its reverse always sum to the weight of the
+    // original edge so they cannot overflow. Excesses are wider because the
+    // flow into a node may exceed the range of int64_t when edges have
+    // "infinite" weight.
+    arc_capacity_[arc] -= amount;
+    arc_capacity_[arc_reverse_[arc]] += amount;
+    if (head != source_ && head != sink_ && excess_[head] == 0) {
+      active_.push_back(head);
+    }
+    excess_[head] += amount;
+    excess_[node] -= amount;
+  }
+
+  // Pushes the excess of `node` along admissible arcs, relabeling the node
+  // whenever none remain, until the node has no excess.
+  void Discharge(int32_t node) {
+    while (excess_[node] > 0) {
+      int64_t arc = current_arc_[node];
+      if (arc == first_arc_[node + 1]) {
+        Relabel(node);
+        continue;
+      }
+      if (arc_capacity_[arc] > 0 &&
+          label_[node] == label_[arc_head_[arc]] + 1) {
+        int64_t amount = excess_[node] < arc_capacity_[arc]
+                             ? static_cast<int64_t>(excess_[node])
+                             : arc_capacity_[arc];
+        Push(arc, node, amount);
+      } else {
+        ++current_arc_[node];
+      }
+    }
+  }
+
+  // Sets the label of `node` to one more than the lowest label of its
+  // residual neighbors.
+  void Relabel(int32_t node) {
+    int32_t old_label = label_[node];
+    int32_t new_label = unreachable_label();
+    int64_t new_arc = first_arc_[node + 1];
+    for (int64_t arc = first_arc_[node]; arc < first_arc_[node + 1]; ++arc) {
+      if (arc_capacity_[arc] > 0 && label_[arc_head_[arc]] + 1 < new_label) {
+        new_label = label_[arc_head_[arc]] + 1;
+        new_arc = arc;
+      }
+    }
+    XLS_CHECK_LT(new_label, unreachable_label());
+    SetLabel(node, new_label);
+    current_arc_[node] = new_arc;
+    work_since_global_relabel_ +=
+        kRelabelWork + first_arc_[node + 1] - first_arc_[node];
+
+    if (old_label < node_count_ && label_count_[old_label] == 0) {
+      Gap(old_label);
+    }
+    if (work_since_global_relabel_ >
+        node_count_ + static_cast<int64_t>(arc_head_.size())) {
+      GlobalRelabel();
+    }
+  }
+
+  // Handles the case where no node has label `gap`. Nodes labeled above the
+  // gap can no longer reach the sink so they are lifted above the source.
+  void Gap(int32_t gap) {
+    for (int32_t node = 0; node < node_count_; ++node) {
+      if (label_[node] > gap && label_[node] < node_count_) {
+        SetLabel(node, node_count_ + 1);
+        current_arc_[node] = first_arc_[node];
+      }
+    }
+  }
+
+  // Sets each label to the exact distance to the sink in the residual graph
+  // or, for nodes which cannot reach the sink, the distance to the source plus
+  // node_count_.
+  void GlobalRelabel() {
+    work_since_global_relabel_ = 0;
+    label_.assign(node_count_, unreachable_label());
+    std::vector<int32_t> queue;
+    queue.reserve(node_count_);
+    auto bfs = [&](int32_t root, int32_t root_label) {
+      label_[root] = root_label;
+      int64_t begin = queue.size();
+      queue.push_back(root);
+      for (int64_t i = begin; i < queue.size(); ++i) {
+        int32_t node = queue[i];
+        for (int64_t arc = first_arc_[node]; arc < first_arc_[node + 1];
+             ++arc) {
+          int32_t tail = arc_head_[arc];
+          if (label_[tail] == unreachable_label() && tail != source_ &&
+              arc_capacity_[arc_reverse_[arc]] > 0) {
+            label_[tail] = label_[node] + 1;
+            queue.push_back(tail);
+          }
+        }
+      }
+    };
+    bfs(sink_, 0);
+    bfs(source_, node_count_);
+    std::fill(label_count_.begin(), label_count_.end(), 0);
+    for (int32_t node = 0; node < node_count_; ++node) {
+      ++label_count_[label_[node]];
+      current_arc_[node] = first_arc_[node];
+    }
+  }
+
+  void SetLabel(int32_t node, int32_t label) {
+    --label_count_[label_[node]];
+    label_[node] = label;
+    ++label_count_[label];
+  }
+
+  // The work attributed to a relabel in addition to scanning the arcs of the
+  // node. Used to decide when to perform a global relabel.
+  static constexpr int64_t kRelabelWork = 12;
+
+  int32_t node_count_;
+  int32_t source_;
+  int32_t sink_;
+
+  std::vector<int64_t> first_arc_;
+  std::vector<int32_t> arc_head_;
+  std::vector<int64_t> arc_reverse_;
+  std::vector<int64_t> arc_capacity_;
+
+  std::vector<int32_t> label_;
+  // The number of nodes with each label. Indexed by label.
+  std::vector<int32_t> label_count_;
+  // The next arc to consider pushing flow along for each node.
+  std::vector<int64_t> current_arc_;
+  std::vector<absl::int128> excess_;
+  // Nodes other than the source and sink with positive excess.
+  std::deque<int32_t> active_;
+  int64_t work_since_global_relabel_ = 0;
+};
 
-GraphCut MinCutBetweenNodes(const Graph& graph, NodeId source, NodeId sink) {
+// Computes a maximum flow via augmenting paths and returns the nodes reachable
+// from the source in the resulting residual graph. Indexed by NodeId.
+std::vector<bool> AugmentingPathReachableFromSource(const Graph& graph,
+                                                    NodeId source,
+                                                    NodeId sink) {
   // This loop is the core of the Ford-Fulkerson method. Starting with zero flow
   // on all edges, flow is increased along a path from source to sink with
   // residual capacity (called an augmenting path). When no further augmenting
@@ -286,34 +514,54 @@ GraphCut MinCutBetweenNodes(const Graph& graph, NodeId source, NodeId sink) {
 
   // Once a maximum flow is found, walk the residual graph from the source. All
   // reachable nodes form one partition.
-  absl::flat_hash_set<NodeId> reachable_from_source;
+  std::vector<bool> reachable_from_source(graph.node_count(), false);
   std::deque<NodeId> frontier = {source};
-  reachable_from_source.insert(source);
+  reachable_from_source[int64_t{source}] = true;
   while (!frontier.empty()) {
     NodeId node = frontier.front();
     frontier.pop_front();
     for (EdgeId successor_edge_id : residual_graph.successors(node)) {
       const ResidualEdge& edge = residual_graph.edge(successor_edge_id);
-      if (edge.capacity > 0 && !reachable_from_source.contains(edge.to)) {
-        reachable_from_source.insert(edge.to);
+      if (edge.capacity > 0 && !reachable_from_source[int64_t{edge.to}]) {
+        reachable_from_source[int64_t{edge.to}] = true;
         frontier.push_back(edge.to);
       }
     }
   }
-  XLS_CHECK(!reachable_from_source.contains(sink));
+  return reachable_from_source;
+}
+
+}  // namespace
+
+GraphCut MinCutBetweenNodes(const Graph& graph, NodeId source, NodeId sink,
+                            MaxFlowAlgorithm algorithm) {
+  std::vector<bool> reachable_from_source;
+  switch (algorithm) {
+    case MaxFlowAlgorithm::kAugmentingPath:
+      reachable_from_source =
+          AugmentingPathReachableFromSource(graph, source, sink);
+      break;
+    case MaxFlowAlgorithm::kPushRelabel: {
+      PushRelabelMaxFlow max_flow(graph, source, sink);
+      max_flow.Run();
+      reachable_from_source = max_flow.ReachableFromSource();
+      break;
+    }
+  }
+  XLS_CHECK(!reachable_from_source[int64_t{sink}]);
 
   GraphCut min_cut;
   min_cut.weight = 0;
   for (NodeId node_id = NodeId(0); node_id <= graph.max_node_id(); ++node_id) {
-    if (reachable_from_source.contains(node_id)) {
+    if (reachable_from_source[int64_t{node_id}]) {
       min_cut.source_partition.push_back(node_id);
     } else {
       min_cut.sink_partition.push_back(node_id);
     }
     for (EdgeId edge_id : graph.successors(node_id)) {
       const Edge& edge = graph.edge(edge_id);
-      if (reachable_from_source.contains(edge.from) &&
-          !reachable_from_source.contains(edge.to)) {
+      if (reachable_from_source[int64_t{edge.from}] &&
+          !reachable_from_source[int64_t{edge.to}]) {
         min_cut.weight += edge.weight;
       }
     }
@@ -15,6 +15,7 @@
 #ifndef XLS_DATA_STRUCTURES_MIN_CUT_H_
 #define XLS_DATA_STRUCTURES_MIN_CUT_H_
 
+#include <cstdint>
 #include <string>
 #include <utility>
 #include <vector>
@@ -95,12 +96,29 @@ struct GraphCut {
   std::string ToString(const Graph& graph) const;
 };
 
+// The algorithm used to compute the maximum flow from which a min cut is
+// derived. Both algorithms produce the same cut.
+enum class MaxFlowAlgorithm {
+  // The Ford-Fulkerson method using Dinic's algorithm to find shortest
+  // augmenting paths. This results in a worst case run time of O(V^2 * E).
+  kAugmentingPath,
+
+  // The Goldberg-Tarjan push-relabel method with FIFO selection of active
+  // nodes, and the gap and global relabeling heuristics. The residual graph is
+  // stored in compressed sparse row form. Worst case run time is O(V^3), and
+  // in practice it is much faster than kAugmentingPath on large graphs.
+  kPushRelabel,
+};
+
 // Computes a minimum cut of the given graph where source and sink are in
 // different partitions. The cut is returned as a partitioning of the nodes of
-// the graph into two sets of nodes on either side of the cut. The min cut is
-// found via the Ford-Fulkerson method using Dinic's algorithm. This results in
-// a worst case run time of O(V^2 * E).
-GraphCut MinCutBetweenNodes(const Graph& graph, NodeId source, NodeId sink);
+// the graph into two sets of nodes on either side of the cut. The source
+// partition is the set of nodes reachable from the source in the residual
+// graph of a maximum flow, which is the smallest source partition of any
+// minimum cut.
+GraphCut MinCutBetweenNodes(
+    const Graph& graph, NodeId source, NodeId sink,
+    MaxFlowAlgorithm algorithm = MaxFlowAlgorithm::kAugmentingPath);
 
 }  // namespace min_cut
 }  // namespace xls
@@ -14,10 +14,12 @@
 
 #include "xls/data_structures/min_cut.h"
 
+#include <cstdint>
 #include <limits>
 #include <random>
 #include <vector>
 
+#include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_set.h"
@@ -280,6 +282,55 @@ TEST(MinCutTest, LargeDirectedGraphs) {
   }
 }
 
+TEST(MinCutTest, PushRelabelMatchesAugmentingPath) {
+  // The source partition is the set of nodes reachable from the source in the
+  // residual graph of a maximum flow, which is the same for every maximum flow,
+  // so both algorithms should produce identical cuts.
+  for (bool acyclic : {false, true}) {
+    for (int64_t layer_count = 5; layer_count < 40; layer_count += 5) {
+      for (int64_t nodes_in_layer = 5; nodes_in_layer < 40;
+           nodes_in_layer += 5) {
+        NodeId source;
+        NodeId sink;
+        Graph graph = MakeLargeGraph(acyclic, &source, &sink, layer_count,
+                                     nodes_in_layer);
+        GraphCut expected = MinCutBetweenNodes(
+            graph, source, sink, MaxFlowAlgorithm::kAugmentingPath);
+        GraphCut min_cut = MinCutBetweenNodes(graph, source, sink,
+                                              MaxFlowAlgorithm::kPushRelabel);
+        EXPECT_EQ(min_cut.weight, expected.weight);
+        EXPECT_EQ(min_cut.source_partition, expected.source_partition);
+        EXPECT_EQ(min_cut.sink_partition, expected.sink_partition);
+      }
+    }
+  }
+}
+
+TEST(MinCutTest, PushRelabelWithMaxWeightEdges) {
+  // Both the source and the sink have several edges of maximum weight so the
+  // total excess pushed from the source exceeds the range of int64_t.
+  Graph graph;
+  auto source = graph.AddNode("source");
+  auto a = graph.AddNode("a");
+  auto b = graph.AddNode("b");
+  auto c = graph.AddNode("c");
+  auto sink = graph.AddNode("sink");
+  graph.AddEdge(source, a, std::numeric_limits<int64_t>::max());
+  graph.AddEdge(source, b, std::numeric_limits<int64_t>::max());
+  graph.AddEdge(source, c, std::numeric_limits<int64_t>::max());
+  graph.AddEdge(a, c, 3);
+  graph.AddEdge(b, c, 4);
+  graph.AddEdge(c, a, std::numeric_limits<int64_t>::max());
+  graph.AddEdge(a, sink, 5);
+  graph.AddEdge(c, sink, 2);
+
+  GraphCut min_cut =
+      MinCutBetweenNodes(graph, source, sink, MaxFlowAlgorithm::kPushRelabel);
+  EXPECT_EQ(min_cut.weight, 7);
+  EXPECT_THAT(min_cut.source_partition, UnorderedElementsAre(source, a, b, c));
+  EXPECT_THAT(min_cut.sink_partition, UnorderedElementsAre(sink));
+}
+
 TEST(MinCutTest, MaxFlowToMinCutTraversalTest) {
   // Test a fix for b/155115565 where the residual graph was not properly
   // traversed to identify the partitions after max flow was computed.
@@ -308,6 +359,10 @@ TEST(MinCutTest, MaxFlowToMinCutTraversalTest) {
 
   GraphCut min_cut = MinCutBetweenNodes(graph, source, sink);
   EXPECT_EQ(min_cut.weight, 11);
+  EXPECT_EQ(
+      MinCutBetweenNodes(graph, source, sink, MaxFlowAlgorithm::kPushRelabel)
+          .weight,
+      11);
 }
 
 TEST(MinCutTest, ResidualGraphTraversalTest) {
@@ -357,7 +412,29 @@ TEST(MinCutTest, ResidualGraphTraversalTest) {
 
   GraphCut min_cut = MinCutBetweenNodes(graph, source, sink);
   EXPECT_EQ(min_cut.weight, 2);
+  EXPECT_EQ(
+      MinCutBetweenNodes(graph, source, sink, MaxFlowAlgorithm::kPushRelabel)
+          .weight,
+      2);
+}
+
+void BM_MinCut(benchmark::State& state, MaxFlowAlgorithm algorithm) {
+  NodeId source;
+  NodeId sink;
+  Graph graph = MakeLargeGraph(/*acyclic=*/true, &source, &sink,
+                               /*layer_count=*/state.range(0),
+                               /*nodes_in_layer=*/state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        MinCutBetweenNodes(graph, source, sink, algorithm));
+  }
 }
+BENCHMARK_CAPTURE(BM_MinCut, AugmentingPath, MaxFlowAlgorithm::kAugmentingPath)
+    ->RangeMultiplier(2)
+    ->Range(8, 128);
+BENCHMARK_CAPTURE(BM_MinCut, PushRelabel, MaxFlowAlgorithm::kPushRelabel)
+    ->RangeMultiplier(2)
+    ->Range(8, 128);
 
 }  // namespace
 }  // namespace min_cut
@@ -0,0 +1,389 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DATA_STRUCTURES_PERSISTENT_HASH_MAP_H_
+#define XLS_DATA_STRUCTURES_PERSISTENT_HASH_MAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/hash/hash.h"
+#include "absl/numeric/bits.h"
+#include "xls/common/logging/logging.h"
+
+namespace xls {
+
+// A hash map whose copies share structure: copying a map is O(1), and
+// modifying a copy costs time and memory proportional to the modification
+// rather than to the size of the map, as only the path from the root to the
+// modified entry is copied (a hash array mapped trie).
+//
+// This suits maps which are copied often and modified little between copies,
+// such as the state of a scope copied on entering each nested scope.
+//
+// The interface follows that of absl::flat_hash_map where it can. Values are
+// modified only through operator[] and erase(), as handing out mutable
+// references to entries requires copying their path whether or not they are
+// written. Iteration order is unspecified. Copies of a map may not be used
+// concurrently from different threads.
+template <typename K, typename V, typename Hash = absl::Hash<K>,
+          typename Eq = std::equal_to<K>>
+class PersistentHashMap {
+ private:
+  struct Node;
+
+ public:
+  using key_type = K;
+  using mapped_type = V;
+  using value_type = std::pair<K, V>;
+
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = PersistentHashMap::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    const_iterator() = default;
+
+    reference operator*() const {
+      const Frame& frame = frames_.back();
+      return frame.node->entries[frame.entry];
+    }
+    pointer operator->() const { return &**this; }
+
+    const_iterator& operator++() {
+      ++frames_.back().entry;
+      Settle();
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator result = *this;
+      ++*this;
+      return result;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      if (frames_.empty() || other.frames_.empty()) {
+        return frames_.empty() == other.frames_.empty();
+      }
+      return &**this == &*other;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    friend class PersistentHashMap;
+
+    // A node being visited: its entries are visited from `entry` on, followed
+    // by its children from `child` on.
+    struct Frame {
+      const Node* node;
+      size_t entry;
+      size_t child;
+    };
+
+    // Moves to the next entry at or after the current position.
+    void Settle() {
+      while (!frames_.empty()) {
+        Frame& frame = frames_.back();
+        if (frame.entry < frame.node->entries.size()) {
+          return;
+        }
+        if (frame.child < frame.node->children.size()) {
+          const Node* child = frame.node->children[frame.child++].get();
+          frames_.push_back(Frame{child, 0, 0});
+          continue;
+        }
+        frames_.pop_back();
+      }
+    }
+
+    std::vector<Frame> frames_;
+  };
+  using iterator = const_iterator;
+
+  PersistentHashMap() = default;
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  void clear() {
+    root_.reset();
+    size_ = 0;
+  }
+
+  const_iterator begin() const {
+    const_iterator it;
+    if (root_ != nullptr) {
+      it.frames_.push_back({root_.get(), 0, 0});
+      it.Settle();
+    }
+    return it;
+  }
+  const_iterator end() const { return const_iterator(); }
+
+  const_iterator find(const K& key) const {
+    const_iterator it;
+    const uint64_t hash = Hash()(key);
+    const Node* node = root_.get();
+    for (int64_t depth = 0; node != nullptr; ++depth) {
+      if (IsCollisionDepth(depth)) {
+        for (size_t i = 0; i < node->entries.size(); ++i) {
+          if (Eq()(node->entries[i].first, key)) {
+            it.frames_.push_back({node, i, 0});
+            return it;
+          }
+        }
+        return end();
+      }
+      const int64_t slot = Slot(hash, depth);
+      if (HasSlot(node->entry_bitmap, slot)) {
+        const size_t index = Index(node->entry_bitmap, slot);
+        if (!Eq()(node->entries[index].first, key)) {
+          return end();
+        }
+        it.frames_.push_back({node, index, 0});
+        return it;
+      }
+      if (!HasSlot(node->child_bitmap, slot)) {
+        return end();
+      }
+      // The entries of this node precede its children in iteration order.
+      const size_t index = Index(node->child_bitmap, slot);
+      it.frames_.push_back({node, node->entries.size(), index + 1});
+      node = node->children[index].get();
+    }
+    return end();
+  }
+
+  bool contains(const K& key) const { return find(key) != end(); }
+  size_t count(const K& key) const { return contains(key) ? 1 : 0; }
+
+  const V& at(const K& key) const {
+    const_iterator it = find(key);
+    XLS_CHECK(it != end()) << "PersistentHashMap::at: key not found";
+    return it->second;
+  }
+
+  // Returns the value of `key`, inserting a default-constructed value if
+  // there is none. The reference is valid until the map is next modified or
+  // copied.
+  V& operator[](const K& key) { return FindOrInsert(key).first->second; }
+
+  std::pair<const_iterator, bool> insert_or_assign(const K& key, V value) {
+    auto [entry, inserted] = FindOrInsert(key);
+    entry->second = std::move(value);
+    return {find(key), inserted};
+  }
+
+  size_t erase(const K& key) {
+    if (!contains(key)) {
+      return 0;
+    }
+    Erase(root_, /*depth=*/0, Hash()(key), key);
+    --size_;
+    return 1;
+  }
+
+  // Calls `f(key)` for each key of this map whose entry is not shared with
+  // `other`, which includes the keys absent from `other` and those which may
+  // map to different values in it. Subtrees shared by both maps, such as
+  // those neither map has modified since one was copied from the other, are
+  // skipped without being visited, so the cost is proportional to the
+  // modifications rather than to the size of the maps. Keys whose values were
+  // written may be reported even if the values compare equal. Keys are
+  // visited in an unspecified order.
+  template <typename F>
+  void ForEachKeyNotSharedWith(const PersistentHashMap& other, F f) const {
+    Diff(root_.get(), other.root_.get(), /*depth=*/0, f);
+  }
+
+ private:
+  // A node holds, for each 5-bit slot of the hash of its keys at its depth,
+  // either a single entry or a child with the entries sharing the slot. Nodes
+  // below the depth at which the hash is exhausted hold a list of entries
+  // whose hashes collide.
+  struct Node {
+    uint32_t entry_bitmap = 0;
+    uint32_t child_bitmap = 0;
+    // In slot order.
+    std::vector<value_type> entries;
+    std::vector<std::shared_ptr<Node>> children;
+  };
+
+  static constexpr int64_t kBitsPerLevel = 5;
+
+  static bool IsCollisionDepth(int64_t depth) {
+    return depth * kBitsPerLevel >= 64;
+  }
+  static int64_t Slot(uint64_t hash, int64_t depth) {
+    return (hash >> (depth * kBitsPerLevel)) & ((1 << kBitsPerLevel) - 1);
+  }
+  static bool HasSlot(uint32_t bitmap, int64_t slot) {
+    return (bitmap & (uint32_t{1} << slot)) != 0;
+  }
+  // Returns the index in a node's vector of the element in `slot`.
+  static size_t Index(uint32_t bitmap, int64_t slot) {
+    return absl::popcount(bitmap & ((uint32_t{1} << slot) - 1));
+  }
+
+  // Returns `node` for modification, copying it first if it is shared.
+  static Node* MakeUnique(std::shared_ptr<Node>& node) {
+    if (node == nullptr) {
+      node = std::make_shared<Node>();
+    } else if (node.use_count() != 1) {
+      node = std::make_shared<Node>(*node);
+    }
+    return node.get();
+  }
+
+  // Returns the entry of `key`, inserting one with a default-constructed value
+  // if there is none, and whether it was inserted.
+  std::pair<value_type*, bool> FindOrInsert(const K& key) {
+    const uint64_t hash = Hash()(key);
+    std::shared_ptr<Node>* current = &root_;
+    for (int64_t depth = 0;; ++depth) {
+      Node* node = MakeUnique(*current);
+      if (IsCollisionDepth(depth)) {
+        for (value_type& entry : node->entries) {
+          if (Eq()(entry.first, key)) {
+            return {&entry, false};
+          }
+        }
+        node->entries.push_back(value_type(key, V()));
+        ++size_;
+        return {&node->entries.back(), true};
+      }
+      const int64_t slot = Slot(hash, depth);
+      if (HasSlot(node->entry_bitmap, slot)) {
+        const size_t index = Index(node->entry_bitmap, slot);
+        if (Eq()(node->entries[index].first, key)) {
+          return {&node->entries[index], false};
+        }
+        // Move the entry occupying the slot down into a new child, in which
+        // the key is then inserted.
+        auto child = std::make_shared<Node>();
+        if (IsCollisionDepth(depth + 1)) {
+          child->entries.push_back(std::move(node->entries[index]));
+        } else {
+          const int64_t child_slot =
+              Slot(Hash()(node->entries[index].first), depth + 1);
+          child->entry_bitmap = uint32_t{1} << child_slot;
+          child->entries.push_back(std::move(node->entries[index]));
+        }
+        node->entries.erase(node->entries.begin() + index);
+        node->entry_bitmap &= ~(uint32_t{1} << slot);
+        const size_t child_index = Index(node->child_bitmap, slot);
+        node->children.insert(node->children.begin() + child_index,
+                              std::move(child));
+        node->child_bitmap |= uint32_t{1} << slot;
+        current = &node->children[child_index];
+        continue;
+      }
+      if (HasSlot(node->child_bitmap, slot)) {
+        current = &node->children[Index(node->child_bitmap, slot)];
+        continue;
+      }
+      const size_t index = Index(node->entry_bitmap, slot);
+      node->entry_bitmap |= uint32_t{1} << slot;
+      auto it = node->entries.insert(node->entries.begin() + index,
+                                     value_type(key, V()));
+      ++size_;
+      return {&*it, true};
+    }
+  }
+
+  // Erases `key`, which must be present, from the subtree of `node`. Children
+  // left empty are removed.
+  static void Erase(std::shared_ptr<Node>& current, int64_t depth,
+                    uint64_t hash, const K& key) {
+    Node* node = MakeUnique(current);
+    if (IsCollisionDepth(depth)) {
+      for (auto it = node->entries.begin(); it != node->entries.end(); ++it) {
+        if (Eq()(it->first, key)) {
+          node->entries.erase(it);
+          return;
+        }
+      }
+      XLS_LOG(FATAL) << "PersistentHashMap::Erase: key not found";
+    }
+    const int64_t slot = Slot(hash, depth);
+    if (HasSlot(node->entry_bitmap, slot)) {
+      node->entries.erase(node->entries.begin() +
+                          Index(node->entry_bitmap, slot));
+      node->entry_bitmap &= ~(uint32_t{1} << slot);
+      return;
+    }
+    XLS_CHECK(HasSlot(node->child_bitmap, slot));
+    const size_t index = Index(node->child_bitmap, slot);
+    std::shared_ptr<Node>& child = node->children[index];
+    Erase(child, depth + 1, hash, key);
+    if (child->entries.empty() && child->children.empty()) {
+      node->children.erase(node->children.begin() + index);
+      node->child_bitmap &= ~(uint32_t{1} << slot);
+    }
+  }
+
+  template <typename F>
+  static void ForEachKeyIn(const Node* node, F& f) {
+    for (const value_type& entry : node->entries) {
+      f(entry.first);
+    }
+    for (const std::shared_ptr<Node>& child : node->children) {
+      ForEachKeyIn(child.get(), f);
+    }
+  }
+
+  template <typename F>
+  static void Diff(const Node* node, const Node* other, int64_t depth, F& f) {
+    if (node == other || node == nullptr) {
+      return;
+    }
+    if (other == nullptr || IsCollisionDepth(depth)) {
+      ForEachKeyIn(node, f);
+      return;
+    }
+    // Entries are held by value, so whether they differ is left to the
+    // caller.
+    for (const value_type& entry : node->entries) {
+      f(entry.first);
+    }
+    for (int64_t slot = 0; slot < (1 << kBitsPerLevel); ++slot) {
+      if (!HasSlot(node->child_bitmap, slot)) {
+        continue;
+      }
+      const Node* child =
+          node->children[Index(node->child_bitmap, slot)].get();
+      const Node* other_child =
+          HasSlot(other->child_bitmap, slot)
+              ? other->children[Index(other->child_bitmap, slot)].get()
+              : nullptr;
+      Diff(child, other_child, depth + 1, f);
+    }
+  }
+
+  std::shared_ptr<Node> root_;
+  size_t size_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_DATA_STRUCTURES_PERSISTENT_HASH_MAP_H_
@@ -0,0 +1,193 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/persistent_hash_map.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <random>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+
+namespace xls {
+namespace {
+
+using ::testing::IsSupersetOf;
+using ::testing::UnorderedElementsAre;
+
+// Maps every key to the same hash, so that all keys collide.
+struct CollidingHash {
+  size_t operator()(int64_t) const { return 42; }
+};
+
+template <typename Map>
+absl::flat_hash_map<int64_t, int64_t> Contents(const Map& map) {
+  absl::flat_hash_map<int64_t, int64_t> contents;
+  for (const auto& [key, value] : map) {
+    EXPECT_TRUE(contents.insert({key, value}).second) << key;
+  }
+  return contents;
+}
+
+template <typename Map>
+void CheckMatchesReference(
+    const Map& map, const absl::flat_hash_map<int64_t, int64_t>& reference) {
+  EXPECT_EQ(map.size(), reference.size());
+  EXPECT_EQ(std::distance(map.begin(), map.end()), reference.size());
+  EXPECT_EQ(Contents(map), reference);
+  for (const auto& [key, value] : reference) {
+    ASSERT_TRUE(map.contains(key)) << key;
+    EXPECT_EQ(map.at(key), value);
+    EXPECT_EQ(map.find(key)->second, value);
+  }
+}
+
+TEST(PersistentHashMapTest, BasicUsage) {
+  PersistentHashMap<int64_t, int64_t> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.begin(), map.end());
+  EXPECT_FALSE(map.contains(1));
+
+  map[1] = 10;
+  map[2] = 20;
+  EXPECT_TRUE(map.insert_or_assign(3, 30).second);
+  EXPECT_FALSE(map.insert_or_assign(3, 31).second);
+  EXPECT_EQ(map.size(), 3);
+  EXPECT_EQ(map.at(3), 31);
+  EXPECT_EQ(map.find(4), map.end());
+
+  EXPECT_EQ(map.erase(2), 1);
+  EXPECT_EQ(map.erase(2), 0);
+  EXPECT_EQ(map.count(2), 0);
+  EXPECT_THAT(Contents(map), UnorderedElementsAre(std::pair(1, 10),
+                                                  std::pair(3, 31)));
+}
+
+TEST(PersistentHashMapTest, CopiesAreIndependent) {
+  PersistentHashMap<int64_t, int64_t> original;
+  for (int64_t i = 0; i < 1000; ++i) {
+    original[i] = i;
+  }
+  PersistentHashMap<int64_t, int64_t> copy = original;
+  copy[5] = -5;
+  copy[1000] = 1000;
+  copy.erase(7);
+
+  EXPECT_EQ(original.size(), 1000);
+  EXPECT_EQ(original.at(5), 5);
+  EXPECT_FALSE(original.contains(1000));
+  EXPECT_TRUE(original.contains(7));
+
+  EXPECT_EQ(copy.size(), 1000);
+  EXPECT_EQ(copy.at(5), -5);
+  EXPECT_EQ(copy.at(1000), 1000);
+  EXPECT_FALSE(copy.contains(7));
+}
+
+TEST(PersistentHashMapTest, IteratingFromFindVisitsRemainingEntries) {
+  PersistentHashMap<int64_t, int64_t> map;
+  for (int64_t i = 0; i < 500; ++i) {
+    map[i] = i;
+  }
+  absl::flat_hash_set<int64_t> visited;
+  for (auto it = map.begin(); it != map.end(); ++it) {
+    // Iterating from `find` of a key continues where iterating from the
+    // beginning would.
+    auto found = map.find(it->first);
+    EXPECT_EQ(found, it);
+    EXPECT_EQ(std::next(found), std::next(it));
+    EXPECT_TRUE(visited.insert(it->first).second);
+  }
+  EXPECT_EQ(visited.size(), 500);
+}
+
+TEST(PersistentHashMapTest, CollidingHashes) {
+  PersistentHashMap<int64_t, int64_t, CollidingHash> map;
+  absl::flat_hash_map<int64_t, int64_t> reference;
+  for (int64_t i = 0; i < 20; ++i) {
+    map[i] = i * i;
+    reference[i] = i * i;
+  }
+  PersistentHashMap<int64_t, int64_t, CollidingHash> copy = map;
+  for (int64_t i = 0; i < 20; i += 3) {
+    map.erase(i);
+    reference.erase(i);
+  }
+  CheckMatchesReference(map, reference);
+  EXPECT_EQ(copy.size(), 20);
+}
+
+TEST(PersistentHashMapTest, RandomOperationsMatchReference) {
+  std::mt19937_64 rng(0);
+  std::uniform_int_distribution<int64_t> key_dist(0, 2000);
+  PersistentHashMap<int64_t, int64_t> map;
+  absl::flat_hash_map<int64_t, int64_t> reference;
+  // Snapshots must be unaffected by later modifications.
+  std::vector<std::pair<PersistentHashMap<int64_t, int64_t>,
+                        absl::flat_hash_map<int64_t, int64_t>>>
+      snapshots;
+  for (int64_t i = 0; i < 10000; ++i) {
+    int64_t key = key_dist(rng);
+    if (rng() % 3 == 0) {
+      EXPECT_EQ(map.erase(key), reference.erase(key));
+    } else {
+      map[key] = i;
+      reference[key] = i;
+    }
+    if (i % 1000 == 0) {
+      snapshots.push_back({map, reference});
+    }
+  }
+  CheckMatchesReference(map, reference);
+  for (const auto& [snapshot, snapshot_reference] : snapshots) {
+    CheckMatchesReference(snapshot, snapshot_reference);
+  }
+}
+
+TEST(PersistentHashMapTest, ForEachKeyNotSharedWithSkipsSharedEntries) {
+  PersistentHashMap<int64_t, int64_t> original;
+  for (int64_t i = 0; i < 10000; ++i) {
+    original[i] = i;
+  }
+  PersistentHashMap<int64_t, int64_t> copy = original;
+  copy[3] = -3;
+  copy[5000] = -5000;
+  copy[20000] = 20000;
+  copy.erase(7);
+
+  absl::flat_hash_set<int64_t> keys;
+  copy.ForEachKeyNotSharedWith(original,
+                               [&](int64_t key) { keys.insert(key); });
+  EXPECT_THAT(keys, IsSupersetOf({3, 5000, 20000}));
+  EXPECT_FALSE(keys.contains(7));
+  // Only the entries of the copied paths are visited.
+  EXPECT_LT(keys.size(), 200);
+
+  keys.clear();
+  original.ForEachKeyNotSharedWith(original,
+                                   [&](int64_t key) { keys.insert(key); });
+  EXPECT_TRUE(keys.empty());
+
+  keys.clear();
+  original.ForEachKeyNotSharedWith(PersistentHashMap<int64_t, int64_t>(),
+                                   [&](int64_t key) { keys.insert(key); });
+  EXPECT_EQ(keys.size(), 10000);
+}
+
+}  // namespace
+}  // namespace xls
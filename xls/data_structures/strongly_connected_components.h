@@ -15,14 +15,99 @@
 #ifndef XLS_DATA_STRUCTURES_STRONGLY_CONNECTED_COMPONENTS_H_
 #define XLS_DATA_STRUCTURES_STRONGLY_CONNECTED_COMPONENTS_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <stack>
+#include <utility>
 #include <vector>
 
 #include "absl/container/btree_map.h"
 #include "absl/container/btree_set.h"
+#include "absl/types/span.h"
 
 namespace xls {
 
+// Graphs with more vertices than this are handled by
+// DenseStronglyConnectedComponents.
+inline constexpr int64_t kDenseStronglyConnectedComponentsThreshold = 1024;
+
+// Computes the strongly connected components of a graph whose vertices are
+// the integers [0, successors.size()), where successors[v] lists the
+// out-neighbors of v, using an iterative form of Tarjan's algorithm (so
+// deep graphs do not overflow the call stack).
+//
+// Components are returned in reverse topological order: every edge leaving
+// a component leads to one earlier in the result.  Vertices of a component
+// are in the order they are popped off of the Tarjan stack.
+inline std::vector<std::vector<int64_t>> DenseStronglyConnectedComponents(
+    absl::Span<const std::vector<int64_t>> successors) {
+  constexpr int64_t kUnvisited = -1;
+  const int64_t vertex_count = successors.size();
+
+  int64_t index = 0;
+  std::vector<int64_t> stack;
+  std::vector<std::vector<int64_t>> result;
+  std::vector<int64_t> indexes(vertex_count, kUnvisited);
+  std::vector<int64_t> low_links(vertex_count, 0);
+  std::vector<bool> on_stack(vertex_count, false);
+
+  // The vertices being visited, each with the position of the next
+  // successor to visit; this replaces the recursion of strong_connect in
+  // StronglyConnectedComponents.
+  std::vector<std::pair<int64_t, int64_t>> call_stack;
+
+  auto visit = [&](int64_t vertex) {
+    indexes[vertex] = index;
+    low_links[vertex] = index;
+    ++index;
+    stack.push_back(vertex);
+    on_stack[vertex] = true;
+    call_stack.push_back({vertex, 0});
+  };
+
+  for (int64_t root = 0; root < vertex_count; ++root) {
+    if (indexes[root] != kUnvisited) {
+      continue;
+    }
+    visit(root);
+    while (!call_stack.empty()) {
+      int64_t vertex = call_stack.back().first;
+      int64_t position = call_stack.back().second;
+      if (position < successors[vertex].size()) {
+        ++call_stack.back().second;
+        int64_t neighbor = successors[vertex][position];
+        if (indexes[neighbor] == kUnvisited) {
+          visit(neighbor);
+        } else if (on_stack[neighbor]) {
+          low_links[vertex] = std::min(low_links[vertex], indexes[neighbor]);
+        }
+        continue;
+      }
+
+      if (low_links[vertex] == indexes[vertex]) {
+        std::vector<int64_t> scc;
+        int64_t v;
+        do {
+          v = stack.back();
+          stack.pop_back();
+          on_stack[v] = false;
+          scc.push_back(v);
+        } while (v != vertex);
+        result.push_back(std::move(scc));
+      }
+
+      call_stack.pop_back();
+      if (!call_stack.empty()) {
+        int64_t parent = call_stack.back().first;
+        low_links[parent] = std::min(low_links[parent], low_links[vertex]);
+      }
+    }
+  }
+
+  return result;
+}
+
 // Computes the strongly connected components of a graph using Tarjan's strongly
 // connected components algorithm.
 //
@@ -45,6 +130,37 @@ std::vector<absl::btree_set<V>> StronglyConnectedComponents(
     }
   }
 
+  if (vertices.size() > kDenseStronglyConnectedComponentsThreshold) {
+    // Number the vertices in order, so that the components found are the
+    // same as below.
+    std::vector<V> ordered_vertices(vertices.begin(), vertices.end());
+    absl::btree_map<V, int64_t> vertex_to_index;
+    for (int64_t i = 0; i < ordered_vertices.size(); ++i) {
+      vertex_to_index.insert({ordered_vertices[i], i});
+    }
+    std::vector<std::vector<int64_t>> successors(ordered_vertices.size());
+    for (const auto& [source, targets] : graph) {
+      if (targets.empty()) {
+        continue;
+      }
+      std::vector<int64_t>& source_successors =
+          successors[vertex_to_index.at(source)];
+      for (const V& target : targets) {
+        source_successors.push_back(vertex_to_index.at(target));
+      }
+    }
+
+    std::vector<absl::btree_set<V>> result;
+    for (const std::vector<int64_t>& scc :
+         DenseStronglyConnectedComponents(successors)) {
+      absl::btree_set<V>& vertex_scc = result.emplace_back();
+      for (int64_t i : scc) {
+        vertex_scc.insert(ordered_vertices[i]);
+      }
+    }
+    return result;
+  }
+
   int64_t index = 0;
   std::stack<V, std::vector<V>> stack;
   std::vector<absl::btree_set<V>> result;
@@ -14,6 +14,7 @@
 
 #include "xls/data_structures/strongly_connected_components.h"
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -23,6 +24,8 @@
 namespace xls {
 namespace {
 
+using ::testing::ElementsAre;
+
 using V = std::string;
 
 absl::btree_set<V> FlattenSCCs(const std::vector<absl::btree_set<V>>& sccs) {
@@ -143,5 +146,36 @@ TEST(StronglyConnectedComponentsTest, Tree) {
   EXPECT_EQ(FlattenSCCs(sccs).size(), GraphSize(graph));
 }
 
+TEST(StronglyConnectedComponentsTest, Dense) {
+  // {0 <-> 1} -> 2 -> {3 -> 4 -> 5 -> 3}, and 6 alone.
+  std::vector<std::vector<int64_t>> successors = {{1}, {0, 2}, {3}, {4},
+                                                  {5}, {3},    {}};
+  std::vector<std::vector<int64_t>> sccs =
+      DenseStronglyConnectedComponents(successors);
+  // Components are in reverse topological order.
+  EXPECT_THAT(sccs, ElementsAre(ElementsAre(5, 4, 3), ElementsAre(2),
+                                ElementsAre(1, 0), ElementsAre(6)));
+}
+
+TEST(StronglyConnectedComponentsTest, LongChainAndCycle) {
+  // Deep enough to be handled by DenseStronglyConnectedComponents, which
+  // must not recurse per vertex.
+  const int64_t kLength = 100'000;
+  absl::btree_map<int64_t, absl::btree_set<int64_t>> chain;
+  for (int64_t i = 0; i + 1 < kLength; ++i) {
+    chain[i].insert(i + 1);
+  }
+  std::vector<absl::btree_set<int64_t>> sccs =
+      StronglyConnectedComponents<int64_t>(chain);
+  ASSERT_EQ(sccs.size(), kLength);
+  EXPECT_THAT(sccs.front(), ElementsAre(kLength - 1));
+  EXPECT_THAT(sccs.back(), ElementsAre(0));
+
+  chain[kLength - 1].insert(0);
+  sccs = StronglyConnectedComponents<int64_t>(chain);
+  ASSERT_EQ(sccs.size(), 1);
+  EXPECT_EQ(sccs.front().size(), kLength);
+}
+
 }  // namespace
 }  // namespace xls
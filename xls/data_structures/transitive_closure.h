@@ -15,17 +15,83 @@
 #ifndef XLS_DATA_STRUCTURES_TRANSITIVE_CLOSURE_H_
 #define XLS_DATA_STRUCTURES_TRANSITIVE_CLOSURE_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/numeric/bits.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/log_message.h"
 #include "xls/common/logging/logging.h"
+#include "xls/data_structures/inline_bitmap.h"
+#include "xls/data_structures/strongly_connected_components.h"
 
 namespace xls {
 
 template <typename V>
 using HashRelation = absl::flat_hash_map<V, absl::flat_hash_set<V>>;
 
+// Relations over more elements than this are closed by
+// DenseTransitiveClosure.
+inline constexpr int64_t kDenseTransitiveClosureThreshold = 64;
+
+// Computes the transitive closure of the edge relation of a graph whose
+// vertices are the integers [0, successors.size()), where successors[v]
+// lists the out-neighbors of v.  Returns, for each vertex, the bitmap of the
+// vertices reachable from it by a path of one or more edges.
+//
+// Each strongly connected component is visited once, in reverse topological
+// order, and its row is the word-wise union of the rows of the components it
+// has edges to, so the cost is O(V + E * V / 64) rather than O(V^3).
+inline std::vector<InlineBitmap> DenseTransitiveClosure(
+    absl::Span<const std::vector<int64_t>> successors) {
+  const int64_t vertex_count = successors.size();
+  std::vector<std::vector<int64_t>> sccs =
+      DenseStronglyConnectedComponents(successors);
+
+  std::vector<int64_t> vertex_to_scc(vertex_count);
+  for (int64_t i = 0; i < sccs.size(); ++i) {
+    for (int64_t vertex : sccs[i]) {
+      vertex_to_scc[vertex] = i;
+    }
+  }
+
+  // Every edge leaving a component leads to an earlier one, whose row is
+  // therefore complete.
+  std::vector<InlineBitmap> scc_rows;
+  scc_rows.reserve(sccs.size());
+  for (int64_t i = 0; i < sccs.size(); ++i) {
+    InlineBitmap& row = scc_rows.emplace_back(vertex_count);
+    bool is_cycle = sccs[i].size() > 1;
+    for (int64_t vertex : sccs[i]) {
+      for (int64_t successor : successors[vertex]) {
+        row.Set(successor);
+        if (vertex_to_scc[successor] != i) {
+          row.Union(scc_rows[vertex_to_scc[successor]]);
+        } else {
+          is_cycle = true;
+        }
+      }
+    }
+    // The vertices of a cycle reach each other, and themselves.
+    if (is_cycle) {
+      for (int64_t vertex : sccs[i]) {
+        row.Set(vertex);
+      }
+    }
+  }
+
+  std::vector<InlineBitmap> closure;
+  closure.reserve(vertex_count);
+  for (int64_t vertex = 0; vertex < vertex_count; ++vertex) {
+    closure.push_back(scc_rows[vertex_to_scc[vertex]]);
+  }
+  return closure;
+}
+
 // Compute the transitive closure of a relation.
 template <typename V>
 HashRelation<V> TransitiveClosure(const HashRelation<V>& relation) {
@@ -53,6 +119,33 @@ HashRelation<V> TransitiveClosure(const HashRelation<V>& relation) {
     node_to_index[ordered_nodes[i]] = i;
   }
 
+  if (n > kDenseTransitiveClosureThreshold) {
+    std::vector<std::vector<int64_t>> successors(n);
+    for (const auto& [node, children] : relation) {
+      std::vector<int64_t>& node_successors =
+          successors[node_to_index.at(node)];
+      for (const auto& child : children) {
+        node_successors.push_back(node_to_index.at(child));
+      }
+    }
+
+    std::vector<InlineBitmap> closure = DenseTransitiveClosure(successors);
+    Rel result;
+    for (int64_t i = 0; i < n; ++i) {
+      if (closure[i].IsAllZeroes()) {
+        continue;
+      }
+      absl::flat_hash_set<V>& children = result[ordered_nodes[i]];
+      for (int64_t word = 0; word < closure[i].word_count(); ++word) {
+        for (uint64_t bits = closure[i].GetWord(word); bits != 0;
+             bits &= bits - 1) {
+          children.insert(ordered_nodes[word * 64 + absl::countr_zero(bits)]);
+        }
+      }
+    }
+    return result;
+  }
+
   // Warshall's algorithm; https://cs.winona.edu/lin/cs440/ch08-2.pdf
 
   auto get = [&](const HashRelation<int64_t>& rel, int64_t i,
@@ -14,7 +14,9 @@
 
 #include "xls/data_structures/transitive_closure.h"
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -24,6 +26,7 @@
 namespace xls {
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::UnorderedElementsAre;
 
 using V = std::string;
@@ -43,5 +46,67 @@ TEST(TransitiveClosureTest, Simple) {
   EXPECT_FALSE(tc.contains("qux"));
 }
 
+TEST(TransitiveClosureTest, Dense) {
+  // 0 -> 1 -> {2 <-> 3} -> 4, and 5 -> 5.
+  std::vector<std::vector<int64_t>> successors = {{1}, {2}, {3}, {2, 4},
+                                                  {},  {5}};
+  std::vector<InlineBitmap> closure = DenseTransitiveClosure(successors);
+  auto reachable = [&](int64_t vertex) {
+    std::vector<int64_t> result;
+    for (int64_t i = 0; i < successors.size(); ++i) {
+      if (closure[vertex].Get(i)) {
+        result.push_back(i);
+      }
+    }
+    return result;
+  };
+  EXPECT_THAT(reachable(0), ElementsAre(1, 2, 3, 4));
+  EXPECT_THAT(reachable(1), ElementsAre(2, 3, 4));
+  EXPECT_THAT(reachable(2), ElementsAre(2, 3, 4));
+  EXPECT_THAT(reachable(3), ElementsAre(2, 3, 4));
+  EXPECT_THAT(reachable(4), ElementsAre());
+  EXPECT_THAT(reachable(5), ElementsAre(5));
+}
+
+TEST(TransitiveClosureTest, LargeRelationMatchesSearch) {
+  // A relation large enough to be closed by DenseTransitiveClosure, with
+  // chains, cycles and a self-edge.
+  const int64_t kNodeCount = 3 * kDenseTransitiveClosureThreshold;
+  HashRelation<int64_t> rel;
+  for (int64_t i = 0; i + 1 < kNodeCount; ++i) {
+    if (i % 7 != 6) {
+      rel[i].insert(i + 1);
+    }
+    if (i % 11 == 0) {
+      rel[i].insert((i * 37) % kNodeCount);
+    }
+  }
+  rel[kNodeCount - 1].insert(kNodeCount - 1);
+
+  HashRelation<int64_t> tc = TransitiveClosure<int64_t>(rel);
+  for (int64_t node = 0; node < kNodeCount; ++node) {
+    absl::flat_hash_set<int64_t> expected;
+    std::vector<int64_t> worklist = {node};
+    while (!worklist.empty()) {
+      int64_t current = worklist.back();
+      worklist.pop_back();
+      if (!rel.contains(current)) {
+        continue;
+      }
+      for (int64_t child : rel.at(current)) {
+        if (expected.insert(child).second) {
+          worklist.push_back(child);
+        }
+      }
+    }
+    if (expected.empty()) {
+      EXPECT_FALSE(tc.contains(node)) << node;
+    } else {
+      ASSERT_TRUE(tc.contains(node)) << node;
+      EXPECT_EQ(tc.at(node), expected) << node;
+    }
+  }
+}
+
 }  // namespace
 }  // namespace xls
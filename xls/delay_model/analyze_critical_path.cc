@@ -14,14 +14,23 @@
 
 #include "xls/delay_model/analyze_critical_path.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
+#include <queue>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/function.h"
@@ -112,6 +121,246 @@ absl::StatusOr<std::vector<CriticalPathEntry>> AnalyzeCriticalPath(
   return std::move(critical_path);
 }
 
+/* static */ absl::StatusOr<std::unique_ptr<IncrementalTimingAnalysis>>
+IncrementalTimingAnalysis::Create(FunctionBase* f,
+                                  const DelayEstimator& delay_estimator) {
+  auto analysis = absl::WrapUnique(
+      new IncrementalTimingAnalysis(f, delay_estimator));
+  std::vector<Node*> topo_sort = TopoSort(f).AsVector();
+  for (Node* node : topo_sort) {
+    NodeEntry& entry = analysis->entries_[node];
+    XLS_ASSIGN_OR_RETURN(entry.delay,
+                         delay_estimator.GetOperationDelayInPs(node));
+    entry.operands.assign(node->operands().begin(), node->operands().end());
+    int64_t max_operand_arrival = 0;
+    for (Node* operand : node->operands()) {
+      const NodeEntry& operand_entry = analysis->entries_.at(operand);
+      max_operand_arrival =
+          std::max(max_operand_arrival, operand_entry.arrival);
+      entry.level = std::max(entry.level, operand_entry.level + 1);
+    }
+    entry.arrival = max_operand_arrival + entry.delay;
+    analysis->arrivals_.insert(entry.arrival);
+  }
+  for (auto it = topo_sort.rbegin(); it != topo_sort.rend(); ++it) {
+    NodeEntry& entry = analysis->entries_.at(*it);
+    for (Node* user : (*it)->users()) {
+      const NodeEntry& user_entry = analysis->entries_.at(user);
+      entry.tail = std::max(entry.tail, user_entry.delay + user_entry.tail);
+    }
+  }
+  return std::move(analysis);
+}
+
+void IncrementalTimingAnalysis::SetArrival(NodeEntry& entry, int64_t arrival) {
+  arrivals_.erase(arrivals_.find(entry.arrival));
+  entry.arrival = arrival;
+  arrivals_.insert(arrival);
+}
+
+void IncrementalTimingAnalysis::RaiseUserLevels(Node* node) {
+  std::vector<Node*> worklist = {node};
+  while (!worklist.empty()) {
+    Node* n = worklist.back();
+    worklist.pop_back();
+    int64_t level = entries_.at(n).level;
+    for (Node* user : n->users()) {
+      auto it = entries_.find(user);
+      if (it != entries_.end() && it->second.level <= level) {
+        it->second.level = level + 1;
+        worklist.push_back(user);
+      }
+    }
+  }
+}
+
+void IncrementalTimingAnalysis::UpdateArrivals(absl::Span<Node* const> roots) {
+  // Visit nodes in increasing level order so that a node is visited after all
+  // of its operands are up to date. The arrival time of a root is always
+  // recomputed; other nodes are visited only if an operand's arrival changed.
+  auto later = [&](Node* a, Node* b) {
+    return entries_.at(a).level > entries_.at(b).level;
+  };
+  std::priority_queue<Node*, std::vector<Node*>, decltype(later)> worklist(
+      later);
+  absl::flat_hash_set<Node*> queued;
+  for (Node* root : roots) {
+    if (queued.insert(root).second) {
+      worklist.push(root);
+    }
+  }
+  while (!worklist.empty()) {
+    Node* node = worklist.top();
+    worklist.pop();
+    queued.erase(node);
+    NodeEntry& entry = entries_.at(node);
+    int64_t max_operand_arrival = 0;
+    for (Node* operand : node->operands()) {
+      max_operand_arrival =
+          std::max(max_operand_arrival, entries_.at(operand).arrival);
+    }
+    int64_t arrival = max_operand_arrival + entry.delay;
+    if (arrival == entry.arrival) {
+      continue;
+    }
+    SetArrival(entry, arrival);
+    for (Node* user : node->users()) {
+      if (entries_.contains(user) && queued.insert(user).second) {
+        worklist.push(user);
+      }
+    }
+  }
+}
+
+void IncrementalTimingAnalysis::UpdateTails(absl::Span<Node* const> roots) {
+  // Visit nodes in decreasing level order so that a node is visited after all
+  // of its users are up to date.
+  auto earlier = [&](Node* a, Node* b) {
+    return entries_.at(a).level < entries_.at(b).level;
+  };
+  std::priority_queue<Node*, std::vector<Node*>, decltype(earlier)> worklist(
+      earlier);
+  absl::flat_hash_set<Node*> queued;
+  for (Node* root : roots) {
+    if (entries_.contains(root) && queued.insert(root).second) {
+      worklist.push(root);
+    }
+  }
+  while (!worklist.empty()) {
+    Node* node = worklist.top();
+    worklist.pop();
+    queued.erase(node);
+    NodeEntry& entry = entries_.at(node);
+    int64_t tail = 0;
+    for (Node* user : node->users()) {
+      auto it = entries_.find(user);
+      if (it != entries_.end()) {
+        tail = std::max(tail, it->second.delay + it->second.tail);
+      }
+    }
+    if (tail == entry.tail) {
+      continue;
+    }
+    entry.tail = tail;
+    for (Node* operand : node->operands()) {
+      if (entries_.contains(operand) && queued.insert(operand).second) {
+        worklist.push(operand);
+      }
+    }
+  }
+}
+
+void IncrementalTimingAnalysis::SetNodeDelay(Node* node, int64_t delay_ps) {
+  NodeEntry& entry = entries_.at(node);
+  if (entry.delay == delay_ps) {
+    return;
+  }
+  entry.delay = delay_ps;
+  UpdateArrivals({node});
+  UpdateTails(node->operands());
+}
+
+absl::Status IncrementalTimingAnalysis::NodeChanged(Node* node) {
+  XLS_RET_CHECK_EQ(node->function_base(), f_);
+  XLS_ASSIGN_OR_RETURN(int64_t delay,
+                       delay_estimator_->GetOperationDelayInPs(node));
+  auto [it, inserted] = entries_.try_emplace(node);
+  NodeEntry& entry = it->second;
+  if (inserted) {
+    arrivals_.insert(entry.arrival);
+  }
+  entry.delay = delay;
+  std::vector<Node*> tail_roots = std::move(entry.operands);
+  entry.operands.assign(node->operands().begin(), node->operands().end());
+  tail_roots.insert(tail_roots.end(), node->operands().begin(),
+                    node->operands().end());
+  tail_roots.push_back(node);
+
+  entry.level = 0;
+  for (Node* operand : node->operands()) {
+    XLS_RET_CHECK(entries_.contains(operand))
+        << "Operand " << operand->GetName() << " of " << node->GetName()
+        << " is not in the analysis";
+    entry.level = std::max(entry.level, entries_.at(operand).level + 1);
+  }
+  RaiseUserLevels(node);
+
+  UpdateArrivals({node});
+  UpdateTails(tail_roots);
+  return absl::OkStatus();
+}
+
+void IncrementalTimingAnalysis::NodeRemoved(Node* node) {
+  XLS_CHECK(node->users().empty()) << node->GetName();
+  auto it = entries_.find(node);
+  XLS_CHECK(it != entries_.end()) << node->GetName();
+  std::vector<Node*> operands = std::move(it->second.operands);
+  arrivals_.erase(arrivals_.find(it->second.arrival));
+  entries_.erase(it);
+  UpdateTails(operands);
+}
+
+std::vector<std::vector<CriticalPathEntry>>
+IncrementalTimingAnalysis::WorstPaths(int64_t k) const {
+  // Paths are grown backwards from their last node in a best-first search.
+  // The delay of the longest path ending with a partial path is the arrival
+  // time of its first node plus the delay of the rest of the partial path, so
+  // complete paths are found in order of decreasing delay.
+  struct PartialPath {
+    Node* node;
+    // The delay of the nodes after `node` in the path.
+    int64_t suffix_delay;
+    // The index of the partial path starting with the node after `node`, or
+    // -1 if `node` is the last node.
+    int64_t next;
+  };
+  std::vector<PartialPath> partial_paths;
+  // Pairs of the delay of the longest completion and the index of a partial
+  // path.
+  std::priority_queue<std::pair<int64_t, int64_t>> worklist;
+  auto add_partial_path = [&](Node* node, int64_t suffix_delay, int64_t next) {
+    worklist.push({entries_.at(node).arrival + suffix_delay,
+                   -static_cast<int64_t>(partial_paths.size())});
+    partial_paths.push_back(PartialPath{node, suffix_delay, next});
+  };
+  for (Node* node : f_->nodes()) {
+    if (entries_.contains(node) && node->users().empty()) {
+      add_partial_path(node, 0, -1);
+    }
+  }
+
+  std::vector<std::vector<CriticalPathEntry>> paths;
+  while (!worklist.empty() && static_cast<int64_t>(paths.size()) < k) {
+    int64_t index = -worklist.top().second;
+    worklist.pop();
+    PartialPath partial_path = partial_paths[index];
+    int64_t delay = entries_.at(partial_path.node).delay;
+    absl::flat_hash_set<Node*> operands;
+    for (Node* operand : partial_path.node->operands()) {
+      if (operands.insert(operand).second) {
+        add_partial_path(operand, partial_path.suffix_delay + delay, index);
+      }
+    }
+    if (!operands.empty()) {
+      continue;
+    }
+
+    std::vector<CriticalPathEntry> path;
+    int64_t path_delay = 0;
+    for (int64_t i = index; i != -1; i = partial_paths[i].next) {
+      Node* node = partial_paths[i].node;
+      path_delay += entries_.at(node).delay;
+      path.push_back(CriticalPathEntry{.node = node,
+                                       .node_delay_ps = entries_.at(node).delay,
+                                       .path_delay_ps = path_delay,
+                                       .delayed_by_cycle_boundary = false});
+    }
+    std::reverse(path.begin(), path.end());
+    paths.push_back(std::move(path));
+  }
+  return paths;
+}
+
 std::string CriticalPathToString(
     absl::Span<const CriticalPathEntry> critical_path,
     std::optional<std::function<std::string(Node*)>> extra_info) {
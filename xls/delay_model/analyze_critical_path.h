@@ -17,11 +17,16 @@
 
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
+#include <set>
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
@@ -60,6 +65,105 @@ absl::StatusOr<std::vector<CriticalPathEntry>> AnalyzeCriticalPath(
     FunctionBase* f, std::optional<int64_t> clock_period_ps,
     const DelayEstimator& delay_estimator);
 
+// Incrementally maintained timing of the combinational paths through a function
+// or proc, ignoring cycle boundaries. Paths start at nodes without operands and
+// end at nodes without users. For each node the analysis maintains
+//
+//   * the arrival time: the delay of the longest path ending at the output of
+//     the node, including the delay of the node itself, and
+//
+//   * the tail delay: the delay of the longest path from the output of the
+//     node to the end of a path, not including the delay of the node.
+//
+// The required time and slack of a node follow from these and the critical
+// path delay. After the delay of a node is changed, or the graph is changed,
+// only the arrival times of the fan-out cone and the tail delays of the fan-in
+// cone of the changed node are recomputed.
+class IncrementalTimingAnalysis {
+ public:
+  // Computes the timing of every node of `f`. `delay_estimator` must outlive
+  // the analysis.
+  static absl::StatusOr<std::unique_ptr<IncrementalTimingAnalysis>> Create(
+      FunctionBase* f, const DelayEstimator& delay_estimator);
+
+  int64_t node_delay_ps(Node* node) const { return entries_.at(node).delay; }
+  int64_t arrival_ps(Node* node) const { return entries_.at(node).arrival; }
+  int64_t tail_ps(Node* node) const { return entries_.at(node).tail; }
+
+  // Returns the latest time at which the output of `node` can be produced
+  // without lengthening the critical path.
+  int64_t required_ps(Node* node) const {
+    return critical_path_delay_ps() - tail_ps(node);
+  }
+  int64_t slack_ps(Node* node) const {
+    return required_ps(node) - arrival_ps(node);
+  }
+
+  // Returns the delay of the longest path through the function.
+  int64_t critical_path_delay_ps() const {
+    return arrivals_.empty() ? 0 : *arrivals_.rbegin();
+  }
+
+  // Sets the delay of `node` (e.g., to a delay measured by synthesis) and
+  // updates the timing of the affected nodes. The delay is kept until the node
+  // is next passed to NodeChanged.
+  void SetNodeDelay(Node* node, int64_t delay_ps);
+
+  // Updates the timing after `node` was added to the function or its operands
+  // were changed. The delay of the node is re-estimated. The operands of `node`
+  // must already be in the analysis, so when several nodes change they should
+  // be passed in topological order (e.g., a new node before the users of a
+  // ReplaceUsesWith call).
+  absl::Status NodeChanged(Node* node);
+
+  // Updates the timing before `node`, which must have no users, is removed
+  // from the function.
+  void NodeRemoved(Node* node);
+
+  // Returns up to `k` distinct paths with the greatest delay, in order of
+  // decreasing delay. As with AnalyzeCriticalPath, the last node of each path
+  // is at the front of its vector.
+  std::vector<std::vector<CriticalPathEntry>> WorstPaths(int64_t k) const;
+
+ private:
+  struct NodeEntry {
+    int64_t delay = 0;
+    int64_t arrival = 0;
+    int64_t tail = 0;
+    // A topological rank: greater than the level of every operand. Levels
+    // order the propagation of updates so that each node is recomputed at
+    // most once per update.
+    int64_t level = 0;
+    // The operands of the node when its timing was last updated. Used to
+    // update the tail delays of former operands when the operands change.
+    std::vector<Node*> operands;
+  };
+
+  IncrementalTimingAnalysis(FunctionBase* f,
+                            const DelayEstimator& delay_estimator)
+      : f_(f), delay_estimator_(&delay_estimator) {}
+
+  // Recomputes the arrival times of `roots` and of every node in their fan-out
+  // cone whose arrival time may have changed as a result.
+  void UpdateArrivals(absl::Span<Node* const> roots);
+
+  // Recomputes the tail delays of `roots` and of every node in their fan-in
+  // cone whose tail delay may have changed as a result.
+  void UpdateTails(absl::Span<Node* const> roots);
+
+  void SetArrival(NodeEntry& entry, int64_t arrival);
+
+  // Raises the levels of the transitive users of `node` as needed to keep
+  // each level greater than the levels of the node's operands.
+  void RaiseUserLevels(Node* node);
+
+  FunctionBase* f_;
+  const DelayEstimator* delay_estimator_;
+  absl::flat_hash_map<Node*, NodeEntry> entries_;
+  // The arrival times of all nodes, for computing the critical path delay.
+  std::multiset<int64_t> arrivals_;
+};
+
 // Returns a string representation of the critical-path. Includes delay
 // information for each node as well as cumulative delay.
 //
@@ -14,6 +14,10 @@
 
 #include "xls/delay_model/analyze_critical_path.h"
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
@@ -25,7 +29,10 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
 
 namespace xls {
@@ -36,6 +43,42 @@ class AnalyzeCriticalPathTest : public IrTestBase {
   const DelayEstimator* delay_estimator_ = GetDelayEstimator("unit").value();
 };
 
+// A delay estimator with distinct delays for a few ops so paths through a
+// graph have distinct delays.
+class OpDelayEstimator : public DelayEstimator {
+ public:
+  OpDelayEstimator() : DelayEstimator("op") {}
+
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override {
+    switch (node->op()) {
+      case Op::kNeg:
+        return 3;
+      case Op::kReverse:
+        return 1;
+      case Op::kAdd:
+        return 2;
+      default:
+        return 0;
+    }
+  }
+};
+
+// Expects the timing maintained by `analysis` to match that of an analysis of
+// `f` computed from scratch.
+void ExpectMatchesFreshAnalysis(const IncrementalTimingAnalysis& analysis,
+                                FunctionBase* f,
+                                const DelayEstimator& delay_estimator) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IncrementalTimingAnalysis> fresh,
+      IncrementalTimingAnalysis::Create(f, delay_estimator));
+  EXPECT_EQ(analysis.critical_path_delay_ps(), fresh->critical_path_delay_ps());
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(analysis.arrival_ps(node), fresh->arrival_ps(node))
+        << node->GetName();
+    EXPECT_EQ(analysis.tail_ps(node), fresh->tail_ps(node)) << node->GetName();
+  }
+}
+
 TEST_F(AnalyzeCriticalPathTest, TrivialFunction) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
@@ -151,5 +194,144 @@ TEST_F(AnalyzeCriticalPathTest, ProcWithSendReceive) {
   EXPECT_EQ(cp[5].node, proc->TokenParam());
 }
 
+TEST_F(AnalyzeCriticalPathTest, IncrementalTimingMatchesCriticalPath) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  auto neg_x = fb.Negate(x);
+  auto rev_neg_x = fb.Reverse(neg_x);
+  auto neg_y = fb.Negate(y);
+  fb.Add(rev_neg_x, neg_y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  OpDelayEstimator delay_estimator;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<CriticalPathEntry> cp,
+      AnalyzeCriticalPath(f, /*clock_period_ps=*/std::nullopt,
+                          delay_estimator));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IncrementalTimingAnalysis> analysis,
+      IncrementalTimingAnalysis::Create(f, delay_estimator));
+  EXPECT_EQ(analysis->critical_path_delay_ps(), cp.front().path_delay_ps);
+  EXPECT_EQ(analysis->critical_path_delay_ps(), 6);
+
+  EXPECT_EQ(analysis->arrival_ps(neg_x.node()), 3);
+  EXPECT_EQ(analysis->tail_ps(neg_x.node()), 3);
+  EXPECT_EQ(analysis->slack_ps(neg_x.node()), 0);
+  EXPECT_EQ(analysis->arrival_ps(neg_y.node()), 3);
+  EXPECT_EQ(analysis->tail_ps(neg_y.node()), 2);
+  EXPECT_EQ(analysis->required_ps(neg_y.node()), 4);
+  EXPECT_EQ(analysis->slack_ps(neg_y.node()), 1);
+}
+
+TEST_F(AnalyzeCriticalPathTest, IncrementalTimingWorstPaths) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  auto a = fb.Negate(x);
+  auto b = fb.Reverse(x);
+  auto c = fb.Add(a, b);
+  auto d = fb.Negate(y);
+  auto e = fb.Add(c, d);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  OpDelayEstimator delay_estimator;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IncrementalTimingAnalysis> analysis,
+      IncrementalTimingAnalysis::Create(f, delay_estimator));
+  std::vector<std::vector<CriticalPathEntry>> paths = analysis->WorstPaths(10);
+  // x -> a -> c -> e, x -> b -> c -> e and y -> d -> e.
+  ASSERT_EQ(paths.size(), 3);
+  ASSERT_EQ(paths[0].size(), 4);
+  EXPECT_EQ(paths[0][0].node, e.node());
+  EXPECT_EQ(paths[0][0].path_delay_ps, 7);
+  EXPECT_EQ(paths[0][1].node, c.node());
+  EXPECT_EQ(paths[0][1].path_delay_ps, 5);
+  EXPECT_EQ(paths[0][2].node, a.node());
+  EXPECT_EQ(paths[0][2].path_delay_ps, 3);
+  EXPECT_EQ(paths[0][3].node, x.node());
+  EXPECT_EQ(paths[0][3].path_delay_ps, 0);
+  EXPECT_EQ(paths[1][0].path_delay_ps, 5);
+  EXPECT_EQ(paths[2][0].path_delay_ps, 5);
+
+  EXPECT_EQ(analysis->WorstPaths(1).size(), 1);
+  EXPECT_TRUE(analysis->WorstPaths(0).empty());
+}
+
+TEST_F(AnalyzeCriticalPathTest, IncrementalTimingSetNodeDelay) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  auto neg_x = fb.Negate(x);
+  auto neg_y = fb.Negate(y);
+  auto sum = fb.Add(neg_x, neg_y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  OpDelayEstimator delay_estimator;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IncrementalTimingAnalysis> analysis,
+      IncrementalTimingAnalysis::Create(f, delay_estimator));
+  EXPECT_EQ(analysis->critical_path_delay_ps(), 5);
+
+  analysis->SetNodeDelay(neg_y.node(), 10);
+  EXPECT_EQ(analysis->node_delay_ps(neg_y.node()), 10);
+  EXPECT_EQ(analysis->arrival_ps(sum.node()), 12);
+  EXPECT_EQ(analysis->critical_path_delay_ps(), 12);
+  EXPECT_EQ(analysis->slack_ps(neg_x.node()), 7);
+  EXPECT_EQ(analysis->slack_ps(neg_y.node()), 0);
+
+  analysis->SetNodeDelay(neg_y.node(), 1);
+  EXPECT_EQ(analysis->critical_path_delay_ps(), 5);
+  EXPECT_EQ(analysis->slack_ps(neg_x.node()), 0);
+  EXPECT_EQ(analysis->slack_ps(neg_y.node()), 2);
+}
+
+TEST_F(AnalyzeCriticalPathTest, IncrementalTimingGraphChanges) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  auto rev_x = fb.Reverse(x);
+  auto neg_y = fb.Negate(y);
+  auto sum = fb.Add(rev_x, neg_y);
+  fb.Reverse(sum);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  OpDelayEstimator delay_estimator;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IncrementalTimingAnalysis> analysis,
+      IncrementalTimingAnalysis::Create(f, delay_estimator));
+  EXPECT_EQ(analysis->critical_path_delay_ps(), 6);
+
+  // Insert a negate between rev_x and the add.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * neg_rev_x,
+      f->MakeNode<UnOp>(SourceInfo(), rev_x.node(), Op::kNeg));
+  XLS_ASSERT_OK(analysis->NodeChanged(neg_rev_x));
+  XLS_ASSERT_OK(sum.node()->ReplaceOperandNumber(0, neg_rev_x));
+  XLS_ASSERT_OK(analysis->NodeChanged(sum.node()));
+  EXPECT_EQ(analysis->critical_path_delay_ps(), 7);
+  ExpectMatchesFreshAnalysis(*analysis, f, delay_estimator);
+
+  // Bypass neg_y and remove it.
+  XLS_ASSERT_OK(sum.node()->ReplaceOperandNumber(1, y.node()));
+  XLS_ASSERT_OK(analysis->NodeChanged(sum.node()));
+  analysis->NodeRemoved(neg_y.node());
+  XLS_ASSERT_OK(f->RemoveNode(neg_y.node()));
+  EXPECT_EQ(analysis->critical_path_delay_ps(), 7);
+  ExpectMatchesFreshAnalysis(*analysis, f, delay_estimator);
+
+  // Bypass the inserted negate and remove it.
+  XLS_ASSERT_OK(sum.node()->ReplaceOperandNumber(0, rev_x.node()));
+  XLS_ASSERT_OK(analysis->NodeChanged(sum.node()));
+  analysis->NodeRemoved(neg_rev_x);
+  XLS_ASSERT_OK(f->RemoveNode(neg_rev_x));
+  EXPECT_EQ(analysis->critical_path_delay_ps(), 4);
+  ExpectMatchesFreshAnalysis(*analysis, f, delay_estimator);
+}
+
 }  // namespace
 }  // namespace xls
@@ -65,6 +65,7 @@ def delay_model(
             "//xls/common:module_initializer",
             "//xls/common/logging",
             "@com_google_absl//absl/status:statusor",
+            "@com_google_absl//absl/types:span",
             "//xls/delay_model:delay_estimator",
             "//xls/ir",
         ],
@@ -24,19 +24,35 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/function.h"
 #include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 #include "xls/netlist/cell_library.h"
 #include "xls/netlist/logical_effort.h"
 
 namespace xls {
 
+absl::StatusOr<std::vector<int64_t>> DelayEstimator::GetOperationDelaysInPs(
+    absl::Span<Node* const> nodes) const {
+  std::vector<int64_t> delays;
+  delays.reserve(nodes.size());
+  for (Node* node : nodes) {
+    XLS_ASSIGN_OR_RETURN(int64_t delay, GetOperationDelayInPs(node));
+    delays.push_back(delay);
+  }
+  return delays;
+}
+
 DelayEstimatorManager& GetDelayEstimatorManagerSingleton() {
   static DelayEstimatorManager* manager = new DelayEstimatorManager;
   return *manager;
@@ -202,17 +218,85 @@ CachingDelayEstimator::CachingDelayEstimator(std::string_view name,
                                              const DelayEstimator& cached)
     : DelayEstimator(name), cached_(cached) {}
 
+/* static */ CachingDelayEstimator::NodeSignature
+CachingDelayEstimator::GetSignature(Node* node) {
+  NodeSignature signature{.op = node->op(),
+                          .type = node->GetType(),
+                          .attribute_hash = node->AttributeHash(),
+                          .callee = nullptr,
+                          .node = node};
+  // Operands are few in the common case, where a linear search for an earlier
+  // occurrence is cheaper than a map.
+  constexpr int64_t kMaxLinearSearchOperands = 8;
+  absl::flat_hash_map<Node*, int64_t> first_operand_index;
+  if (node->operand_count() > kMaxLinearSearchOperands) {
+    first_operand_index.reserve(node->operand_count());
+  }
+  for (int64_t i = 0; i < node->operand_count(); ++i) {
+    Node* operand = node->operand(i);
+    signature.operand_types.push_back(operand->GetType());
+    signature.literal_operands.push_back(operand->Is<Literal>());
+    if (node->operand_count() > kMaxLinearSearchOperands) {
+      signature.operand_aliases.push_back(
+          first_operand_index.try_emplace(operand, i).first->second);
+    } else {
+      int64_t j = 0;
+      while (node->operand(j) != operand) {
+        ++j;
+      }
+      signature.operand_aliases.push_back(j);
+    }
+  }
+  // Function-valued attributes are not covered by the attribute hash.
+  switch (node->op()) {
+    case Op::kCountedFor:
+      signature.callee = node->As<CountedFor>()->body();
+      break;
+    case Op::kDynamicCountedFor:
+      signature.callee = node->As<DynamicCountedFor>()->body();
+      break;
+    case Op::kInvoke:
+      signature.callee = node->As<Invoke>()->to_apply();
+      break;
+    case Op::kMap:
+      signature.callee = node->As<Map>()->to_apply();
+      break;
+    default:
+      break;
+  }
+  return signature;
+}
+
 absl::StatusOr<int64_t> CachingDelayEstimator::GetOperationDelayInPs(
     Node* node) const {
-  if (ContainsNodeDelay(node)) {
-    return GetNodeDelay(node);
+  NodeSignature signature = GetSignature(node);
+  Shard& shard = shards_[absl::HashOf(signature) % kShardCount];
+  {
+    absl::ReaderMutexLock lock(&shard.mutex);
+    auto it = shard.delays.find(signature);
+    if (it != shard.delays.end()) {
+      return it->second;
+    }
   }
 
+  // The lock is not held while estimating so that other lookups in the shard
+  // can proceed. Concurrent misses of one signature may each estimate the
+  // delay; they produce the same value.
   XLS_ASSIGN_OR_RETURN(int64_t delay, cached_.GetOperationDelayInPs(node));
-  AddNodeDelay(node, delay);
+  absl::WriterMutexLock lock(&shard.mutex);
+  shard.delays.emplace(std::move(signature), delay);
   return delay;
 }
 
+int64_t CachingDelayEstimator::size() const {
+  int64_t size = 0;
+  for (Shard& shard : shards_) {
+    absl::ReaderMutexLock lock(&shard.mutex);
+    size += shard.delays.size();
+  }
+  return size;
+}
+
 /* static */ absl::StatusOr<int64_t> DelayEstimator::GetLogicalEffortDelayInPs(
     Node* node, int64_t tau_in_ps) {
   XLS_ASSIGN_OR_RETURN(int64_t delay_in_tau, GetLogicalEffortDelayInTau(node));
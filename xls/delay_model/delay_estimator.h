@@ -15,6 +15,7 @@
 #ifndef XLS_DELAY_MODEL_DELAY_ESTIMATOR_H_
 #define XLS_DELAY_MODEL_DELAY_ESTIMATOR_H_
 
+#include <array>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -25,12 +26,15 @@
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
-#include "xls/common/test_macros.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/ir/type.h"
 
 namespace xls {
 
@@ -45,6 +49,12 @@ class DelayEstimator {
   // Returns the estimated delay of the given node in picoseconds.
   virtual absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const = 0;
 
+  // Returns the estimated delays of the given nodes in picoseconds, e.g. of
+  // all the nodes of a function. Estimators may override this to avoid
+  // dispatching through GetOperationDelayInPs for each node.
+  virtual absl::StatusOr<std::vector<int64_t>> GetOperationDelaysInPs(
+      absl::Span<Node* const> nodes) const;
+
   // Compute the delay of the given node using logical effort estimation. Only
   // relatively simple operations (kAnd, kOr, etc) are supported using this
   // method.
@@ -90,6 +100,21 @@ class FirstMatchDelayEstimator : public DelayEstimator {
 
 // Cache the delay of an underlying delay estimator. This class is safe for
 // concurrent access.
+//
+// Delays are keyed by the structure of a node rather than its identity: its
+// op, its result and operand types, which of its operands are literals or the
+// same node (delay models specialize on both, e.g. add(x, x) or a multiply by
+// a literal), its op-specific attributes and, for ops which call a function,
+// the callee. Structurally identical nodes, such as the same operation in
+// different functions of a package or in a clone of a function, share a cache
+// entry, so the underlying estimator must estimate the same delay for them.
+// Attributes are compared with Node::HasEqualAttributes against the node
+// which created the entry rather than by hash alone. Types are compared by
+// identity so nodes of different packages do not share entries. The cache
+// must not outlive the nodes it is queried with.
+//
+// The cache is split into shards, each with its own lock, so that concurrent
+// lookups rarely contend.
 class CachingDelayEstimator : public DelayEstimator {
  public:
   CachingDelayEstimator(std::string_view name, const DelayEstimator& cached);
@@ -98,28 +123,53 @@ class CachingDelayEstimator : public DelayEstimator {
 
   absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override;
 
- private:
-  bool ContainsNodeDelay(Node* node) const {
-    absl::ReaderMutexLock lock(&cache_mutex_);
-    return cache_.contains(node);
-  }
-
-  int64_t GetNodeDelay(Node* node) const {
-    absl::ReaderMutexLock lock(&cache_mutex_);
-    return cache_.at(node);
-  }
+  // Returns the number of distinct node signatures with a cached delay.
+  int64_t size() const;
 
-  void AddNodeDelay(Node* node, int64_t delay) const {
-    absl::WriterMutexLock lock(&cache_mutex_);
-    cache_.emplace(node, delay);
-  }
-
-  XLS_FRIEND_TEST(DelayEstimatorTest, CachingDelayEstimator);
+ private:
+  // The structure of a node which determines its delay.
+  struct NodeSignature {
+    Op op;
+    Type* type;
+    absl::InlinedVector<Type*, 2> operand_types;
+    // For each operand, the index of the first operand which is the same node.
+    absl::InlinedVector<int64_t, 2> operand_aliases;
+    // For each operand, whether it is a literal.
+    absl::InlinedVector<bool, 2> literal_operands;
+    uint64_t attribute_hash;
+    FunctionBase* callee;
+    // The node the signature was built from, against which attributes are
+    // compared. Not hashed: `attribute_hash` stands in for it.
+    Node* node;
+
+    bool operator==(const NodeSignature& other) const {
+      return op == other.op && type == other.type &&
+             operand_types == other.operand_types &&
+             operand_aliases == other.operand_aliases &&
+             literal_operands == other.literal_operands &&
+             attribute_hash == other.attribute_hash && callee == other.callee &&
+             node->HasEqualAttributes(other.node);
+    }
+
+    template <typename H>
+    friend H AbslHashValue(H h, const NodeSignature& s) {
+      return H::combine(std::move(h), s.op, s.type, s.operand_types,
+                        s.operand_aliases, s.literal_operands,
+                        s.attribute_hash, s.callee);
+    }
+  };
+
+  struct Shard {
+    absl::Mutex mutex;
+    absl::flat_hash_map<NodeSignature, int64_t> delays ABSL_GUARDED_BY(mutex);
+  };
+
+  static constexpr int64_t kShardCount = 16;
+
+  static NodeSignature GetSignature(Node* node);
 
   const DelayEstimator& cached_;
-  mutable absl::Mutex cache_mutex_;
-  mutable absl::flat_hash_map<Node*, int64_t> cache_
-      ABSL_GUARDED_BY(cache_mutex_);
+  mutable std::array<Shard, kShardCount> shards_;
 };
 
 enum class DelayEstimatorPrecedence {
@@ -14,6 +14,7 @@
 
 #include "xls/delay_model/delay_estimator.h"
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string_view>
@@ -24,10 +25,13 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
+#include "xls/ir/type.h"
 
 namespace xls {
 
@@ -131,23 +135,168 @@ TEST_F(DelayEstimatorTest, DecoratingDelayEstimator) {
               IsOkAndHolds(42));
 }
 
+TEST_F(DelayEstimatorTest, GetOperationDelaysInPs) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue sum = fb.Add(x, y);
+  XLS_ASSERT_OK(fb.BuildWithReturnValue(fb.Not(sum)).status());
+
+  // The delay is zero for parameters and one otherwise.
+  FakeDelayEstimator one(1, "one");
+  DecoratingDelayEstimator estimator(
+      "decorating", one, [](Node* n, int64_t original) -> int64_t {
+        return n->Is<Param>() ? 0 : original;
+      });
+  EXPECT_THAT(estimator.GetOperationDelaysInPs({x.node(), sum.node()}),
+              IsOkAndHolds(ElementsAre(0, 1)));
+  EXPECT_THAT(estimator.GetOperationDelaysInPs({}),
+              IsOkAndHolds(ElementsAre()));
+}
+
+// A delay estimator which counts the delays it estimates. The delay of a node
+// depends only on its structure.
+class CountingDelayEstimator : public DelayEstimator {
+ public:
+  CountingDelayEstimator() : DelayEstimator("counting") {}
+
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override {
+    ++count_;
+    return node->GetType()->GetFlatBitCount() + node->operand_count();
+  }
+
+  int64_t count() const { return count_; }
+
+ private:
+  mutable std::atomic<int64_t> count_ = 0;
+};
+
 TEST_F(DelayEstimatorTest, CachingDelayEstimator) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
   BValue x = fb.Param("x", p->GetBitsType(1));
   BValue node = fb.Xor({x, x});
   XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(node));
-  DelayEstimatorManager manager;
-  XLS_ASSERT_OK(manager.RegisterDelayEstimator(
-      std::make_unique<FakeDelayEstimator>(1, "one"),
-      DelayEstimatorPrecedence::kLow));
-  XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * one,
-                           manager.GetDelayEstimator("one"));
-  CachingDelayEstimator caching("caching", *one);
+  CountingDelayEstimator counting;
+  CachingDelayEstimator caching("caching", counting);
   EXPECT_THAT(caching.GetOperationDelayInPs(f->return_value()),
-              IsOkAndHolds(1));
-  EXPECT_THAT(caching.ContainsNodeDelay(f->return_value()), true);
-  EXPECT_THAT(caching.GetNodeDelay(f->return_value()), 1);
+              IsOkAndHolds(3));
+  EXPECT_THAT(caching.GetOperationDelayInPs(f->return_value()),
+              IsOkAndHolds(3));
+  EXPECT_EQ(counting.count(), 1);
+  EXPECT_EQ(caching.size(), 1);
+}
+
+TEST_F(DelayEstimatorTest, CachingDelayEstimatorSharesStructurallyEqualNodes) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue x_plus_y = fb.Add(x, y);
+  BValue y_plus_x = fb.Add(y, x);
+  BValue wide_add = fb.Add(fb.ZeroExtend(x, 16), fb.ZeroExtend(y, 16));
+  BValue low_slice = fb.BitSlice(x, /*start=*/0, /*width=*/4);
+  BValue high_slice = fb.BitSlice(x, /*start=*/4, /*width=*/4);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * f,
+      fb.BuildWithReturnValue(fb.Tuple(
+          {x_plus_y, y_plus_x, wide_add, low_slice, high_slice})));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * clone, f->Clone("clone"));
+
+  CountingDelayEstimator counting;
+  CachingDelayEstimator caching("caching", counting);
+  EXPECT_THAT(caching.GetOperationDelayInPs(x_plus_y.node()),
+              IsOkAndHolds(10));
+  EXPECT_THAT(caching.GetOperationDelayInPs(y_plus_x.node()),
+              IsOkAndHolds(10));
+  EXPECT_EQ(counting.count(), 1);
+  EXPECT_THAT(caching.GetOperationDelayInPs(wide_add.node()),
+              IsOkAndHolds(18));
+  EXPECT_EQ(counting.count(), 2);
+
+  // Slices with different attributes have different entries.
+  EXPECT_THAT(caching.GetOperationDelayInPs(low_slice.node()),
+              IsOkAndHolds(5));
+  EXPECT_THAT(caching.GetOperationDelayInPs(high_slice.node()),
+              IsOkAndHolds(5));
+  EXPECT_EQ(counting.count(), 4);
+
+  // Every node of the clone hits the entry of its original.
+  for (Node* node : f->nodes()) {
+    XLS_ASSERT_OK(caching.GetOperationDelayInPs(node).status());
+  }
+  int64_t count = counting.count();
+  EXPECT_EQ(caching.size(), count);
+  for (Node* node : clone->nodes()) {
+    XLS_ASSERT_OK_AND_ASSIGN(int64_t delay,
+                             caching.GetOperationDelayInPs(node));
+    EXPECT_EQ(delay,
+              node->GetType()->GetFlatBitCount() + node->operand_count());
+  }
+  EXPECT_EQ(counting.count(), count);
+}
+
+TEST_F(DelayEstimatorTest, CachingDelayEstimatorDistinguishesOperandKinds) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue literal = fb.Literal(UBits(3, 8));
+  BValue x_plus_y = fb.Add(x, y);
+  BValue x_plus_x = fb.Add(x, x);
+  BValue y_plus_y = fb.Add(y, y);
+  BValue x_times_y = fb.UMul(x, y);
+  BValue x_times_literal = fb.UMul(x, literal);
+  XLS_ASSERT_OK(fb.BuildWithReturnValue(
+                    fb.Tuple({x_plus_y, x_plus_x, y_plus_y, x_times_y,
+                              x_times_literal}))
+                    .status());
+
+  // Delay models specialize on identical and literal operands, so those nodes
+  // get their own entries.
+  CountingDelayEstimator counting;
+  CachingDelayEstimator caching("caching", counting);
+  XLS_ASSERT_OK(caching.GetOperationDelayInPs(x_plus_y.node()).status());
+  XLS_ASSERT_OK(caching.GetOperationDelayInPs(x_plus_x.node()).status());
+  EXPECT_EQ(counting.count(), 2);
+  XLS_ASSERT_OK(caching.GetOperationDelayInPs(y_plus_y.node()).status());
+  EXPECT_EQ(counting.count(), 2);
+  XLS_ASSERT_OK(caching.GetOperationDelayInPs(x_times_y.node()).status());
+  XLS_ASSERT_OK(
+      caching.GetOperationDelayInPs(x_times_literal.node()).status());
+  EXPECT_EQ(counting.count(), 4);
+  EXPECT_EQ(caching.size(), 4);
+}
+
+TEST_F(DelayEstimatorTest, CachingDelayEstimatorConcurrentAccess) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(64));
+  BValue value = x;
+  for (int64_t width = 63; width > 0; --width) {
+    value = fb.Add(fb.BitSlice(value, /*start=*/0, /*width=*/width),
+                   fb.BitSlice(x, /*start=*/0, /*width=*/width));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(value));
+
+  CountingDelayEstimator counting;
+  CachingDelayEstimator caching("caching", counting);
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 0; i < 8; ++i) {
+    threads.push_back(std::make_unique<Thread>([&]() {
+      for (Node* node : f->nodes()) {
+        absl::StatusOr<int64_t> delay = caching.GetOperationDelayInPs(node);
+        EXPECT_THAT(delay, IsOkAndHolds(node->GetType()->GetFlatBitCount() +
+                                        node->operand_count()));
+      }
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  EXPECT_LE(caching.size(), f->node_count());
+  EXPECT_GE(counting.count(), caching.size());
 }
 
 // A Delay Estimator that can only handle one kind of operation.
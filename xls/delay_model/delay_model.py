@@ -533,14 +533,41 @@ class BoundingBoxEstimator(Estimator):
       )
 
   def cpp_delay_code(self, node_identifier: str) -> str:
+    # The delay factors are computed once up front rather than for each data
+    # point.
     lines = []
-    for raw_data_point in self.raw_data_points:
-      test_expr_terms = []
-      for i, x_value in enumerate(raw_data_point.delay_factors):
-        test_expr_terms.append('%s <= %d' % (_delay_factor_cpp_expression(
-            self.delay_factors[i], node_identifier), x_value))
-      lines.append('if (%s) { return %d; }' %
-                   (' && '.join(test_expr_terms), raw_data_point.delay_ps))
+    for i, factor in enumerate(self.delay_factors):
+      lines.append('const int64_t factor_%d = %s;' %
+                   (i, _delay_factor_cpp_expression(factor, node_identifier)))
+    if len(self.delay_factors) == 1:
+      # With a single factor the box containing a value is found by a binary
+      # search of the distinct data point values: for a value in the bucket
+      # (thresholds[i - 1], thresholds[i]] the first data point containing it
+      # is the first one whose value is at least thresholds[i].
+      thresholds = sorted(
+          set(dp.delay_factors[0] for dp in self.raw_data_points))
+      delays = [
+          next(dp.delay_ps
+               for dp in self.raw_data_points
+               if dp.delay_factors[0] >= threshold)
+          for threshold in thresholds
+      ]
+      lines.append('static constexpr int64_t kThresholds[] = {%s};' %
+                   ', '.join('%d' % t for t in thresholds))
+      lines.append('static constexpr int64_t kDelays[] = {%s};' %
+                   ', '.join('%d' % d for d in delays))
+      lines.append('const int64_t* bucket = std::lower_bound('
+                   'std::begin(kThresholds), std::end(kThresholds), '
+                   'factor_0);')
+      lines.append('if (bucket != std::end(kThresholds)) {'
+                   ' return kDelays[bucket - std::begin(kThresholds)]; }')
+    else:
+      for raw_data_point in self.raw_data_points:
+        test_expr_terms = []
+        for i, x_value in enumerate(raw_data_point.delay_factors):
+          test_expr_terms.append('factor_%d <= %d' % (i, x_value))
+        lines.append('if (%s) { return %d; }' %
+                     (' && '.join(test_expr_terms), raw_data_point.delay_ps))
     lines.append(
         'return absl::UnimplementedError('
         '"Unhandled node for delay estimation: " '
@@ -112,20 +112,19 @@ class DelayModelTest(absltest.TestCase):
                 'op: "kBar" bit_count: 64 operands { bit_count: 64 }')), 1234)
     self.assertEqualIgnoringWhitespace(
         bar.cpp_delay_code('node'), """
-          if (node->GetType()->GetFlatBitCount() <= 3 &&
-              node->operand(0)->GetType()->GetFlatBitCount() <= 7) {
+          const int64_t factor_0 = node->GetType()->GetFlatBitCount();
+          const int64_t factor_1 =
+              node->operand(0)->GetType()->GetFlatBitCount();
+          if (factor_0 <= 3 && factor_1 <= 7) {
             return 23;
           }
-          if (node->GetType()->GetFlatBitCount() <= 12 &&
-              node->operand(0)->GetType()->GetFlatBitCount() <= 42) {
+          if (factor_0 <= 12 && factor_1 <= 42) {
             return 100;
           }
-          if (node->GetType()->GetFlatBitCount() <= 32 &&
-              node->operand(0)->GetType()->GetFlatBitCount() <= 10) {
+          if (factor_0 <= 32 && factor_1 <= 10) {
             return 122;
           }
-          if (node->GetType()->GetFlatBitCount() <= 64 &&
-              node->operand(0)->GetType()->GetFlatBitCount() <= 64) {
+          if (factor_0 <= 64 && factor_1 <= 64) {
             return 1234;
           }
           return absl::UnimplementedError(
@@ -138,6 +137,37 @@ class DelayModelTest(absltest.TestCase):
               'op: "kBar" bit_count: 65 operands { bit_count: 64 }'))
     self.assertIn('Operation outside bounding box', str(e.exception))
 
+  def test_one_factor_bounding_box_estimator(self):
+    data_points_str = [
+        'operation { op: "kBar" bit_count: 8 } delay: 30 delay_offset: 0',
+        'operation { op: "kBar" bit_count: 32 } delay: 50 delay_offset: 0',
+        'operation { op: "kBar" bit_count: 16 } delay: 40 delay_offset: 0',
+        'operation { op: "kBar" bit_count: 64 } delay: 70 delay_offset: 0',
+    ]
+    result_bit_count = delay_model_pb2.DelayFactor()
+    result_bit_count.source = delay_model_pb2.DelayFactor.Source.RESULT_BIT_COUNT
+    bar = delay_model.BoundingBoxEstimator(
+        'kBar', (result_bit_count,),
+        tuple(_parse_data_point(s) for s in data_points_str))
+    # Data points are matched in order, so a 12-bit operation falls in the box
+    # of the 32-bit data point which precedes the 16-bit one.
+    self.assertEqual(
+        bar.operation_delay(_parse_operation('op: "kBar" bit_count: 12')), 50)
+    self.assertEqualIgnoringWhitespace(
+        bar.cpp_delay_code('node'), """
+          const int64_t factor_0 = node->GetType()->GetFlatBitCount();
+          static constexpr int64_t kThresholds[] = {8, 16, 32, 64};
+          static constexpr int64_t kDelays[] = {30, 50, 50, 70};
+          const int64_t* bucket = std::lower_bound(
+              std::begin(kThresholds), std::end(kThresholds), factor_0);
+          if (bucket != std::end(kThresholds)) {
+            return kDelays[bucket - std::begin(kThresholds)];
+          }
+          return absl::UnimplementedError(
+              "Unhandled node for delay estimation: " +
+              node->ToStringWithOperandTypes());
+        """)
+
   def test_one_factor_regression_estimator(self):
     data_points_str = [
         'operation { op: "kFoo" bit_count: 2 } delay: 210 delay_offset: 10',
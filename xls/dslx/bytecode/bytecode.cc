@@ -35,7 +35,9 @@
 #include "absl/strings/str_split.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
+#include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/interp_value.h"
 #include "xls/ir/bits_ops.h"
@@ -717,8 +719,20 @@ absl::StatusOr<std::vector<Bytecode>> BytecodesFromString(
 absl::StatusOr<std::unique_ptr<BytecodeFunction>> BytecodeFunction::Create(
     const Module* owner, const Function* source_fn, const TypeInfo* type_info,
     std::vector<Bytecode> bytecodes) {
-  return absl::WrapUnique(
+  auto bf = absl::WrapUnique(
       new BytecodeFunction(owner, source_fn, type_info, std::move(bytecodes)));
+  absl::StatusOr<std::vector<bool>> last_use_loads =
+      ComputeLastUseLoads(bf->bytecodes_);
+  if (last_use_loads.ok()) {
+    bf->last_use_loads_ = *std::move(last_use_loads);
+  } else {
+    // Malformed bytecode is reported when it is executed; until then just
+    // assume every slot is live so every load copies.
+    XLS_VLOG(3) << "Could not analyze slot liveness: "
+                << last_use_loads.status();
+    bf->last_use_loads_.assign(bf->bytecodes_.size(), false);
+  }
+  return bf;
 }
 
 BytecodeFunction::BytecodeFunction(const Module* owner,
@@ -730,6 +744,125 @@ BytecodeFunction::BytecodeFunction(const Module* owner,
       type_info_(type_info),
       bytecodes_(std::move(bytecodes)) {}
 
+// Adds the slots referenced (whether loaded or stored) by `item` to `slots`.
+static absl::Status CollectMatchArmSlots(const Bytecode::MatchArmItem& item,
+                                         std::vector<int64_t>* slots) {
+  using Kind = Bytecode::MatchArmItem::Kind;
+  if (item.kind() == Kind::kLoad || item.kind() == Kind::kStore) {
+    XLS_ASSIGN_OR_RETURN(Bytecode::SlotIndex slot, item.slot_index());
+    slots->push_back(slot.value());
+  } else if (item.kind() == Kind::kTuple) {
+    XLS_ASSIGN_OR_RETURN(std::vector<Bytecode::MatchArmItem> elements,
+                         item.tuple_elements());
+    for (const Bytecode::MatchArmItem& element : elements) {
+      XLS_RETURN_IF_ERROR(CollectMatchArmSlots(element, slots));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<bool>> ComputeLastUseLoads(
+    absl::Span<const Bytecode> bytecodes) {
+  const int64_t size = bytecodes.size();
+
+  // Gather, for each bytecode, its successors and the slots it reads ("gen")
+  // and overwrites ("kill"). Stores inside match arms only happen if the arm
+  // matches, so (conservatively) those slots are treated as read.
+  std::vector<std::vector<int64_t>> successors(size);
+  std::vector<std::vector<int64_t>> gen(size);
+  std::vector<std::optional<int64_t>> kill(size);
+  int64_t slot_count = 0;
+  for (int64_t pc = 0; pc < size; ++pc) {
+    const Bytecode& bytecode = bytecodes[pc];
+    switch (bytecode.op()) {
+      case Bytecode::Op::kJumpRel: {
+        XLS_ASSIGN_OR_RETURN(Bytecode::JumpTarget target,
+                             bytecode.jump_target());
+        successors[pc].push_back(pc + target.value());
+        break;
+      }
+      case Bytecode::Op::kJumpRelIf: {
+        XLS_ASSIGN_OR_RETURN(Bytecode::JumpTarget target,
+                             bytecode.jump_target());
+        successors[pc] = {pc + 1, pc + target.value()};
+        break;
+      }
+      case Bytecode::Op::kLoad: {
+        XLS_ASSIGN_OR_RETURN(Bytecode::SlotIndex slot, bytecode.slot_index());
+        gen[pc].push_back(slot.value());
+        successors[pc].push_back(pc + 1);
+        break;
+      }
+      case Bytecode::Op::kStore: {
+        XLS_ASSIGN_OR_RETURN(Bytecode::SlotIndex slot, bytecode.slot_index());
+        kill[pc] = slot.value();
+        successors[pc].push_back(pc + 1);
+        break;
+      }
+      case Bytecode::Op::kMatchArm: {
+        XLS_ASSIGN_OR_RETURN(const Bytecode::MatchArmItem* item,
+                             bytecode.match_arm_item());
+        XLS_RETURN_IF_ERROR(CollectMatchArmSlots(*item, &gen[pc]));
+        successors[pc].push_back(pc + 1);
+        break;
+      }
+      default:
+        successors[pc].push_back(pc + 1);
+        break;
+    }
+    for (int64_t slot : gen[pc]) {
+      slot_count = std::max(slot_count, slot + 1);
+    }
+    if (kill[pc].has_value()) {
+      slot_count = std::max(slot_count, *kill[pc] + 1);
+    }
+  }
+
+  // Iterate the backwards dataflow to a fixed point; visiting in reverse order
+  // means straight-line code converges in a single pass.
+  std::vector<std::vector<bool>> live_in(size,
+                                         std::vector<bool>(slot_count, false));
+  std::vector<std::vector<bool>> live_out(size,
+                                          std::vector<bool>(slot_count, false));
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (int64_t pc = size - 1; pc >= 0; --pc) {
+      std::vector<bool> out(slot_count, false);
+      for (int64_t successor : successors[pc]) {
+        if (successor < 0 || successor >= size) {
+          continue;
+        }
+        for (int64_t slot = 0; slot < slot_count; ++slot) {
+          if (live_in[successor][slot]) {
+            out[slot] = true;
+          }
+        }
+      }
+      std::vector<bool> in = out;
+      if (kill[pc].has_value()) {
+        in[*kill[pc]] = false;
+      }
+      for (int64_t slot : gen[pc]) {
+        in[slot] = true;
+      }
+      if (in != live_in[pc]) {
+        live_in[pc] = std::move(in);
+        changed = true;
+      }
+      live_out[pc] = std::move(out);
+    }
+  }
+
+  std::vector<bool> last_use_loads(size, false);
+  for (int64_t pc = 0; pc < size; ++pc) {
+    if (bytecodes[pc].op() == Bytecode::Op::kLoad) {
+      last_use_loads[pc] = !live_out[pc][gen[pc].front()];
+    }
+  }
+  return last_use_loads;
+}
+
 std::vector<Bytecode> BytecodeFunction::CloneBytecodes() const {
   // Create a modifiable copy of the bytecodes.
   std::vector<Bytecode> bytecodes;
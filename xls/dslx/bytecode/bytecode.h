@@ -407,6 +407,12 @@ class Bytecode {
 
 std::string OpToString(Bytecode::Op op);
 
+// Returns, for each bytecode, whether it is a load of a slot which is not read
+// again before it is next stored to or the function returns, as determined by
+// a backwards liveness analysis of the slots.
+absl::StatusOr<std::vector<bool>> ComputeLastUseLoads(
+    absl::Span<const Bytecode> bytecodes);
+
 // Holds all the bytecode implementing a function along with useful metadata.
 class BytecodeFunction {
  public:
@@ -428,6 +434,11 @@ class BytecodeFunction {
   // Creates and returns a [caller-owned] copy of the internal bytecodes.
   std::vector<Bytecode> CloneBytecodes() const;
 
+  // Returns true if the bytecode at `pc` is a load of a slot which is not read
+  // again before it is next stored to or the function returns, in which case
+  // the interpreter may move the value out of the slot instead of copying it.
+  bool IsLastUseLoad(int64_t pc) const { return last_use_loads_[pc]; }
+
  private:
   BytecodeFunction(const Module* owner, const Function* source_fn,
                    const TypeInfo* type_info, std::vector<Bytecode> bytecode);
@@ -436,6 +447,7 @@ class BytecodeFunction {
   const Function* source_fn_;
   const TypeInfo* type_info_;
   std::vector<Bytecode> bytecodes_;
+  std::vector<bool> last_use_loads_;
 };
 
 // Converts the given sequence of bytecodes to a more human-readable string,
@@ -20,6 +20,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/dslx/bytecode/bytecode_emitter.h"
 
 namespace xls::dslx {
@@ -30,15 +31,29 @@ BytecodeCache::BytecodeCache(ImportData* import_data)
 absl::StatusOr<BytecodeFunction*> BytecodeCache::GetOrCreateBytecodeFunction(
     const Function* f, const TypeInfo* type_info,
     const std::optional<ParametricEnv>& caller_bindings) {
-  Key key = std::make_tuple(f, type_info, caller_bindings);
-  if (!cache_.contains(key)) {
-    XLS_ASSIGN_OR_RETURN(
-        std::unique_ptr<BytecodeFunction> bf,
-        BytecodeEmitter::Emit(import_data_, type_info, f, caller_bindings));
-    cache_.emplace(key, std::move(bf));
+  // The emitter treats absent and empty bindings identically, so canonicalize
+  // them to a single key: callers pass empty bindings for non-parametric
+  // callees while top-level entry points pass none.
+  std::optional<ParametricEnv> canonical_bindings = caller_bindings;
+  if (canonical_bindings.has_value() && canonical_bindings->empty()) {
+    canonical_bindings = std::nullopt;
+  }
+  Key key = std::make_tuple(f, type_info, std::move(canonical_bindings));
+  // Emission doesn't consult the cache, so holding the lock throughout is
+  // safe and keeps concurrent callers from emitting the same function twice.
+  absl::MutexLock lock(&mutex_);
+  auto it = cache_.find(key);
+  if (it == cache_.end()) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<BytecodeFunction> bf,
+                         BytecodeEmitter::Emit(import_data_, type_info, f,
+                                               std::get<2>(key),
+                                               BytecodeEmitterOptions{
+                                                   .optimize = true,
+                                               }));
+    it = cache_.emplace(std::move(key), std::move(bf)).first;
   }
 
-  return cache_.at(key).get();
+  return it->second.get();
 }
 
 }  // namespace xls::dslx
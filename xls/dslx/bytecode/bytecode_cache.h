@@ -14,12 +14,15 @@
 #ifndef XLS_DSLX_BYTECODE_BYTECODE_CACHE_H_
 #define XLS_DSLX_BYTECODE_BYTECODE_CACHE_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <tuple>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/dslx/bytecode/bytecode.h"
 #include "xls/dslx/bytecode/bytecode_cache_interface.h"
 #include "xls/dslx/frontend/ast.h"
@@ -28,6 +31,12 @@
 
 namespace xls::dslx {
 
+// Memoizes the bytecode emitted for each (function, type info, bindings)
+// combination. A single cache is meant to be shared by everything evaluated
+// against one ImportData (e.g. all the tests in a module), since the type info
+// pointers in the keys are only meaningful within it.
+//
+// Thread-safe, as the procs of a network may run on several threads.
 class BytecodeCache : public BytecodeCacheInterface {
  public:
   explicit BytecodeCache(ImportData* import_data);
@@ -35,12 +44,20 @@ class BytecodeCache : public BytecodeCacheInterface {
       const Function* f, const TypeInfo* type_info,
       const std::optional<ParametricEnv>& caller_bindings) override;
 
+  // Returns the number of functions emitted (i.e., cache misses) so far.
+  int64_t size() const {
+    absl::MutexLock lock(&mutex_);
+    return cache_.size();
+  }
+
  private:
   using Key = std::tuple<const Function*, const TypeInfo*,
                          std::optional<ParametricEnv>>;
 
   ImportData* import_data_;
-  absl::flat_hash_map<Key, std::unique_ptr<BytecodeFunction>> cache_;
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<Key, std::unique_ptr<BytecodeFunction>> cache_
+      ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace xls::dslx
@@ -0,0 +1,74 @@
+// Copyright 2021 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/bytecode/bytecode_cache.h"
+
+#include <optional>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/type_system/parametric_env.h"
+
+namespace xls::dslx {
+namespace {
+
+TEST(BytecodeCacheTest, ReusesEmittedFunctions) {
+  constexpr std::string_view kProgram = R"(
+fn f(x: u32) -> u32 { x + u32:1 }
+
+fn g(x: u32) -> u32 { f(x) * u32:2 }
+)";
+
+  ImportData import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheck(kProgram, "test.x", "test", &import_data));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           tm.module->GetMemberOrError<Function>("f"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * g,
+                           tm.module->GetMemberOrError<Function>("g"));
+
+  BytecodeCache cache(&import_data);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      BytecodeFunction * f_bf,
+      cache.GetOrCreateBytecodeFunction(f, tm.type_info, std::nullopt));
+  EXPECT_EQ(cache.size(), 1);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      BytecodeFunction * f_bf_again,
+      cache.GetOrCreateBytecodeFunction(f, tm.type_info, std::nullopt));
+  EXPECT_EQ(f_bf, f_bf_again);
+  EXPECT_EQ(cache.size(), 1);
+
+  // Empty bindings are equivalent to no bindings.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      BytecodeFunction * f_bf_empty_env,
+      cache.GetOrCreateBytecodeFunction(f, tm.type_info, ParametricEnv()));
+  EXPECT_EQ(f_bf, f_bf_empty_env);
+  EXPECT_EQ(cache.size(), 1);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      BytecodeFunction * g_bf,
+      cache.GetOrCreateBytecodeFunction(g, tm.type_info, std::nullopt));
+  EXPECT_NE(f_bf, g_bf);
+  EXPECT_EQ(cache.size(), 2);
+}
+
+}  // namespace
+}  // namespace xls::dslx
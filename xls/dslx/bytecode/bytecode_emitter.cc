@@ -38,6 +38,7 @@
 #include "xls/common/symbolized_stacktrace.h"
 #include "xls/common/visitor.h"
 #include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/bytecode/bytecode_optimizer.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/frontend/ast_utils.h"
 #include "xls/dslx/interp_value.h"
@@ -152,6 +153,10 @@ BytecodeEmitter::EmitProcNext(
   XLS_RETURN_IF_ERROR(emitter.Init(f));
   XLS_RETURN_IF_ERROR(f->body()->AcceptExpr(&emitter));
 
+  if (options.optimize) {
+    XLS_ASSIGN_OR_RETURN(emitter.bytecode_,
+                         OptimizeBytecodes(std::move(emitter.bytecode_)));
+  }
   return BytecodeFunction::Create(f->owner(), f, type_info,
                                   std::move(emitter.bytecode_));
 }
@@ -37,6 +37,10 @@ namespace xls::dslx {
 struct BytecodeEmitterOptions {
   // The format preference to use when one is not otherwise specified.
   FormatPreference format_preference;
+
+  // Whether to run the bytecode optimizer over emitted functions; see
+  // OptimizeBytecodes(). Expressions are emitted as-is.
+  bool optimize = false;
 };
 
 // Translates a DSLX expression tree into a linear sequence of bytecodes.
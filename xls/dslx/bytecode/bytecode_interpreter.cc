@@ -22,20 +22,24 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <variant>
 #include <vector>
 
+#include "absl/hash/hash.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/dslx/bytecode/builtins.h"
 #include "xls/dslx/bytecode/bytecode.h"
 #include "xls/dslx/bytecode/bytecode_cache_interface.h"
@@ -58,6 +62,16 @@
 namespace xls::dslx {
 namespace {
 
+// Returns the mutex guarding `channel`. Channels are shared between the procs
+// of a network, which may run on several threads (see ProcNetworkRunner); a
+// fixed set of mutexes is shared by all channels so that InterpValue channels
+// can stay plain deques.
+absl::Mutex& ChannelMutex(const InterpValue::Channel* channel) {
+  static constexpr int64_t kMutexCount = 64;
+  static auto* mutexes = new absl::Mutex[kMutexCount];
+  return mutexes[absl::Hash<const void*>()(channel) % kMutexCount];
+}
+
 // Returns the given InterpValue formatted using the given format descriptor (if
 // it is not null).
 absl::StatusOr<std::string> ToStringMaybeFormatted(
@@ -121,6 +135,7 @@ BytecodeInterpreter::CreateUnique(ImportData* import_data, BytecodeFunction* bf,
 
 absl::Status BytecodeInterpreter::Run(bool* progress_made) {
   blocked_channel_name_ = std::nullopt;
+  blocked_channel_ = nullptr;
   while (!frames_.empty()) {
     Frame* frame = &frames_.back();
     while (frame->pc() < frame->bf()->bytecodes().size()) {
@@ -791,12 +806,20 @@ absl::Status BytecodeInterpreter::EvalLiteral(const Bytecode& bytecode) {
 
 absl::Status BytecodeInterpreter::EvalLoad(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(Bytecode::SlotIndex slot, bytecode.slot_index());
-  if (frames_.back().slots().size() <= slot.value()) {
+  Frame& frame = frames_.back();
+  if (frame.slots().size() <= slot.value()) {
     return absl::InternalError(absl::StrFormat(
         "Attempted to access local data in slot %d, which is out of range.",
         slot.value()));
   }
-  stack_.Push(frames_.back().slots().at(slot.value()));
+  InterpValue& value = frame.slots().at(slot.value());
+  if (frame.bf()->IsLastUseLoad(frame.pc())) {
+    // The slot is dead after this load, so steal its value (leaving the same
+    // placeholder as Frame::StoreSlot) rather than copying it.
+    stack_.Push(std::exchange(value, InterpValue::MakeToken()));
+  } else {
+    stack_.Push(value);
+  }
   return absl::OkStatus();
 }
 
@@ -989,19 +1012,26 @@ absl::Status BytecodeInterpreter::EvalRecvNonBlocking(
 
   XLS_ASSIGN_OR_RETURN(const Bytecode::ChannelData* channel_data,
                        bytecode.channel_data());
-  if (condition.IsTrue() && !channel->empty()) {
+  std::optional<InterpValue> value;
+  if (condition.IsTrue()) {
+    absl::MutexLock lock(&ChannelMutex(channel.get()));
+    if (!channel->empty()) {
+      value = std::move(channel->front());
+      channel->pop_front();
+    }
+  }
+  if (value.has_value()) {
     if (options_.trace_channels() && options_.trace_hook() != nullptr) {
-      XLS_ASSIGN_OR_RETURN(std::string formatted_data,
-                           ToStringMaybeFormatted(
-                               channel->front(), channel_data->value_fmt_desc(),
-                               kChannelTraceIndentation));
+      XLS_ASSIGN_OR_RETURN(
+          std::string formatted_data,
+          ToStringMaybeFormatted(*value, channel_data->value_fmt_desc(),
+                                 kChannelTraceIndentation));
       options_.trace_hook()(
           absl::StrFormat("Received data on channel `%s`:\n%s",
                           channel_data->channel_name(), formatted_data));
     }
     stack_.Push(InterpValue::MakeTuple(
-        {token, channel->front(), InterpValue::MakeBool(true)}));
-    channel->pop_front();
+        {token, *std::move(value), InterpValue::MakeBool(true)}));
   } else {
     stack_.Push(InterpValue::MakeTuple(
         {token, default_value, InterpValue::MakeBool(false)}));
@@ -1019,28 +1049,36 @@ absl::Status BytecodeInterpreter::EvalRecv(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(const Bytecode::ChannelData* channel_data,
                        bytecode.channel_data());
   if (condition.IsTrue()) {
-    if (channel->empty()) {
+    std::optional<InterpValue> value;
+    {
+      absl::MutexLock lock(&ChannelMutex(channel.get()));
+      if (!channel->empty()) {
+        value = std::move(channel->front());
+        channel->pop_front();
+      }
+    }
+    if (!value.has_value()) {
       // Restore the stack!
       stack_.Push(channel_value);
       stack_.Push(condition);
       stack_.Push(default_value);
       blocked_channel_name_ = channel_data->channel_name();
+      blocked_channel_ = std::move(channel);
       return absl::UnavailableError("Channel is empty.");
     }
 
     XLS_ASSIGN_OR_RETURN(InterpValue token, Pop());
 
     if (options_.trace_channels() && options_.trace_hook() != nullptr) {
-      XLS_ASSIGN_OR_RETURN(std::string formatted_data,
-                           ToStringMaybeFormatted(
-                               channel->front(), channel_data->value_fmt_desc(),
-                               kChannelTraceIndentation));
+      XLS_ASSIGN_OR_RETURN(
+          std::string formatted_data,
+          ToStringMaybeFormatted(*value, channel_data->value_fmt_desc(),
+                                 kChannelTraceIndentation));
       options_.trace_hook()(
           absl::StrFormat("Received data on channel `%s`:\n%s",
                           channel_data->channel_name(), formatted_data));
     }
-    stack_.Push(InterpValue::MakeTuple({token, channel->front()}));
-    channel->pop_front();
+    stack_.Push(InterpValue::MakeTuple({token, *std::move(value)}));
   } else {
     XLS_ASSIGN_OR_RETURN(InterpValue token, Pop());
     stack_.Push(InterpValue::MakeTuple({token, default_value}));
@@ -1067,6 +1105,7 @@ absl::Status BytecodeInterpreter::EvalSend(const Bytecode& bytecode) {
                                             channel_data->channel_name(),
                                             formatted_data));
     }
+    absl::MutexLock lock(&ChannelMutex(channel.get()));
     channel->push_back(payload);
   }
   stack_.Push(token);
@@ -1150,7 +1189,7 @@ absl::Status BytecodeInterpreter::EvalStore(const Bytecode& bytecode) {
   }
 
   XLS_ASSIGN_OR_RETURN(InterpValue value, Pop());
-  frames_.back().StoreSlot(slot, value);
+  frames_.back().StoreSlot(slot, std::move(value));
   return absl::OkStatus();
 }
 
@@ -1523,8 +1562,10 @@ absl::Status ProcConfigBytecodeInterpreter::EvalSpawn(
       std::unique_ptr<BytecodeFunction> config_bf,
       BytecodeEmitter::Emit(
           import_data, type_info, proc->config(), caller_bindings,
-          BytecodeEmitterOptions{.format_preference =
-                                     options.format_preference()}));
+          BytecodeEmitterOptions{
+              .format_preference = options.format_preference(),
+              .optimize = true,
+          }));
 
   ProcConfigBytecodeInterpreter cbi(import_data, proc_instances, options);
   XLS_RETURN_IF_ERROR(cbi.InitFrame(config_bf.get(), config_args, type_info));
@@ -1572,8 +1613,10 @@ absl::Status ProcConfigBytecodeInterpreter::EvalSpawn(
       std::unique_ptr<BytecodeFunction> next_bf,
       BytecodeEmitter::EmitProcNext(
           import_data, type_info, proc->next(), caller_bindings, member_defs,
-          BytecodeEmitterOptions{.format_preference =
-                                     options.format_preference()}));
+          BytecodeEmitterOptions{
+              .format_preference = options.format_preference(),
+              .optimize = true,
+          }));
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<BytecodeInterpreter> next_interpreter,
       CreateUnique(import_data, next_bf.get(), full_next_args, options));
@@ -1613,10 +1656,100 @@ absl::StatusOr<ProcRunResult> ProcInstance::Run() {
     return ProcRunResult{
         .execution_state = ProcExecutionState::kBlockedOnReceive,
         .blocked_channel_name = interpreter_->blocked_channel_name(),
+        .blocked_channel = interpreter_->blocked_channel_,
         .progress_made = progress_made};
   }
 
   return result_status;
 }
 
+BytecodeInterpreterOptions SerializeHooks(BytecodeInterpreterOptions options) {
+  auto mutex = std::make_shared<absl::Mutex>();
+  if (options.post_fn_eval_hook() != nullptr) {
+    options.post_fn_eval_hook(
+        [mutex, hook = options.post_fn_eval_hook()](
+            const Function* f, absl::Span<const InterpValue> args,
+            const ParametricEnv* env, const InterpValue& got) {
+          absl::MutexLock lock(mutex.get());
+          return hook(f, args, env, got);
+        });
+  }
+  if (options.trace_hook() != nullptr) {
+    options.trace_hook(
+        [mutex, hook = options.trace_hook()](std::string_view entry) {
+          absl::MutexLock lock(mutex.get());
+          hook(entry);
+        });
+  }
+  if (options.rollover_hook() != nullptr) {
+    options.rollover_hook(
+        [mutex, hook = options.rollover_hook()](const Span& span) {
+          absl::MutexLock lock(mutex.get());
+          hook(span);
+        });
+  }
+  return options;
+}
+
+ProcNetworkRunner::ProcNetworkRunner(std::vector<ProcInstance>* proc_instances,
+                                     const BytecodeInterpreterOptions& options)
+    : proc_instances_(proc_instances),
+      results_(proc_instances->size(),
+               ProcRunResult{.execution_state = ProcExecutionState::kCompleted,
+                             .progress_made = false}) {
+  int64_t thread_count =
+      std::min<int64_t>(options.proc_threads(), proc_instances->size());
+  if (thread_count > 1) {
+    // The thread calling Tick() runs procs too.
+    thread_pool_ = std::make_unique<ThreadPool>(thread_count - 1);
+  }
+}
+
+ProcNetworkRunner::~ProcNetworkRunner() = default;
+
+absl::Status ProcNetworkRunner::Tick() {
+  // Channels are only read here between rounds, while no proc is running.
+  std::vector<int64_t> runnable;
+  runnable.reserve(proc_instances_->size());
+  for (int64_t i = 0; i < proc_instances_->size(); ++i) {
+    const ProcRunResult& result = results_[i];
+    if (result.execution_state == ProcExecutionState::kBlockedOnReceive &&
+        result.blocked_channel != nullptr && result.blocked_channel->empty()) {
+      results_[i].progress_made = false;
+      continue;
+    }
+    runnable.push_back(i);
+  }
+
+  auto run = [&](int64_t i) -> absl::Status {
+    int64_t index = runnable[i];
+    XLS_ASSIGN_OR_RETURN(results_[index], (*proc_instances_)[index].Run());
+    return absl::OkStatus();
+  };
+  if (thread_pool_ == nullptr) {
+    for (int64_t i = 0; i < runnable.size(); ++i) {
+      XLS_RETURN_IF_ERROR(run(i));
+    }
+  } else {
+    XLS_RETURN_IF_ERROR(
+        thread_pool_->ParallelForWithStatus(0, runnable.size(), run));
+  }
+
+  bool progress_made = false;
+  std::vector<std::string> blocked_channels;
+  for (const ProcRunResult& result : results_) {
+    if (result.execution_state == ProcExecutionState::kBlockedOnReceive) {
+      XLS_RET_CHECK(result.blocked_channel_name.has_value());
+      blocked_channels.push_back(result.blocked_channel_name.value());
+    }
+    progress_made |= result.progress_made;
+  }
+  if (!progress_made) {
+    return absl::DeadlineExceededError(
+        absl::StrFormat("Procs are deadlocked. Blocked channels: %s",
+                        absl::StrJoin(blocked_channels, ", ")));
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace xls::dslx
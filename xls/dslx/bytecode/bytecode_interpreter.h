@@ -27,12 +27,14 @@
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/common/logging/log_lines.h"
+#include "xls/common/thread_pool.h"
 #include "xls/dslx/bytecode/bytecode.h"
 #include "xls/dslx/bytecode/bytecode_interpreter_options.h"
 #include "xls/dslx/bytecode/frame.h"
 #include "xls/dslx/bytecode/interpreter_stack.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/import_data.h"
+#include "xls/dslx/interp_value.h"
 #include "xls/dslx/type_system/parametric_env.h"
 
 namespace xls::dslx {
@@ -196,6 +198,7 @@ class BytecodeInterpreter {
   // separate continuation data structure which encapsulates the entire
   // execution state including this value.
   std::optional<std::string> blocked_channel_name_;
+  std::shared_ptr<InterpValue::Channel> blocked_channel_;
 };
 
 // Specialization of BytecodeInterpreter for executing Proc `config` functions.
@@ -256,6 +259,9 @@ struct ProcRunResult {
   // channel.
   std::optional<std::string> blocked_channel_name;
 
+  // If tick state is kBlockedOnReceive this field holds the blocked channel.
+  std::shared_ptr<InterpValue::Channel> blocked_channel;
+
   // Whether any progress was made (at least one instruction was executed).
   bool progress_made;
 };
@@ -285,6 +291,36 @@ class ProcInstance {
   const TypeInfo* type_info_;
 };
 
+// Returns `options` with its hooks wrapped so that they are never called
+// concurrently, for running the procs of a network on several threads.
+BytecodeInterpreterOptions SerializeHooks(BytecodeInterpreterOptions options);
+
+// Ticks the instances of a proc network, on options.proc_threads() threads.
+//
+// Procs are run in rounds, each running every proc instance once. An instance
+// blocked on a receive is parked: it is not run again until the channel it is
+// blocked on has data. The threads steal work from each other, so a few slow
+// procs don't hold up the rest of a round. The channels, the bytecode cache
+// and (when wrapped with SerializeHooks()) the hooks of the interpreter
+// options are thread-safe; the instances must not share any other state.
+class ProcNetworkRunner {
+ public:
+  ProcNetworkRunner(std::vector<ProcInstance>* proc_instances,
+                    const BytecodeInterpreterOptions& options);
+  ~ProcNetworkRunner();
+
+  // Runs a round. Returns a DeadlineExceeded error naming the blocked channels
+  // if no proc instance made progress, i.e., the procs are deadlocked.
+  absl::Status Tick();
+
+ private:
+  std::vector<ProcInstance>* proc_instances_;
+  // Only created for more than one thread.
+  std::unique_ptr<ThreadPool> thread_pool_;
+  // The result of the last run of each proc instance.
+  std::vector<ProcRunResult> results_;
+};
+
 }  // namespace xls::dslx
 
 #endif  // XLS_DSLX_BYTECODE_BYTECODE_INTERPRETER_H_
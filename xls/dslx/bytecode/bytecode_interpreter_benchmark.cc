@@ -0,0 +1,156 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "include/benchmark/benchmark.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/bytecode/bytecode_cache.h"
+#include "xls/dslx/bytecode/bytecode_emitter.h"
+#include "xls/dslx/bytecode/bytecode_interpreter.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/type_system/parametric_env.h"
+
+namespace xls::dslx {
+namespace {
+
+// Measures the bytecode interpreter running `main` in `program`, which takes
+// no arguments.
+void RunBenchmark(benchmark::State& state, std::string_view program) {
+  ImportData import_data(CreateImportDataForTest());
+  TypecheckedModule tm =
+      ParseAndTypecheck(program, "bench.x", "bench", &import_data).value();
+  Function* f = tm.module->GetMemberOrError<Function>("main").value();
+  std::unique_ptr<BytecodeFunction> bf =
+      BytecodeEmitter::Emit(&import_data, tm.type_info, f, ParametricEnv())
+          .value();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        BytecodeInterpreter::Interpret(&import_data, bf.get(), {}).value());
+  }
+}
+
+// Scalar arithmetic in a loop: dominated by dispatch and stack traffic.
+void BM_ScalarLoop(benchmark::State& state) {
+  RunBenchmark(state, absl::StrFormat(R"(
+fn main() -> u32 {
+  for (i, acc): (u32, u32) in range(u32:0, u32:%d) {
+    acc + i * u32:3
+  }(u32:0)
+})",
+                                      state.range(0)));
+}
+BENCHMARK(BM_ScalarLoop)->Range(16, 1024);
+
+// A loop carrying an aggregate which is loaded (and updated) each iteration:
+// dominated by copies of the aggregate.
+void BM_ArrayUpdateLoop(benchmark::State& state) {
+  RunBenchmark(state, absl::StrFormat(R"(
+fn main() -> u32[%d] {
+  for (i, acc): (u32, u32[%d]) in range(u32:0, u32:%d) {
+    update(acc, i, acc[i] + i)
+  }(u32[%d]:[0, ...])
+})",
+                                      state.range(0), state.range(0),
+                                      state.range(0), state.range(0)));
+}
+BENCHMARK(BM_ArrayUpdateLoop)->Range(16, 1024);
+
+// Calls of a small function: dominated by frame setup and argument passing.
+void BM_CallLoop(benchmark::State& state) {
+  RunBenchmark(state, absl::StrFormat(R"(
+fn f(x: u32, y: u32) -> u32 { x ^ (y << u32:1) }
+
+fn main() -> u32 {
+  for (i, acc): (u32, u32) in range(u32:0, u32:%d) {
+    f(acc, i)
+  }(u32:0)
+})",
+                                      state.range(0)));
+}
+BENCHMARK(BM_CallLoop)->Range(16, 1024);
+
+// Building and destructuring tuples.
+void BM_TupleLoop(benchmark::State& state) {
+  RunBenchmark(state, absl::StrFormat(R"(
+fn main() -> (u32, u64, u8) {
+  for (i, (a, b, c)): (u32, (u32, u64, u8)) in range(u32:0, u32:%d) {
+    (a + i, b + (i as u64), c ^ (i as u8))
+  }((u32:0, u64:0, u8:0))
+})",
+                                      state.range(0)));
+}
+BENCHMARK(BM_TupleLoop)->Range(16, 1024);
+
+// Calls of `state.range(0)` distinct instantiations of a parametric function,
+// so run time is dominated by emitting the callees' bytecode. With
+// `shared_cache` the emitted bytecode is reused across iterations (as the test
+// runner does across the tests of a module); otherwise every iteration starts
+// from an empty cache.
+void RunParametricCallBenchmark(benchmark::State& state, bool shared_cache) {
+  std::vector<std::string> terms;
+  for (int64_t i = 1; i <= state.range(0); ++i) {
+    terms.push_back(absl::StrFormat("(widen(uN[%d]:1) as u32)", i));
+  }
+  std::string program = absl::StrFormat(R"(
+fn widen<N: u32, M: u32 = {N + u32:1}>(x: uN[N]) -> uN[M] {
+  (x as uN[M]) << u32:1
+}
+
+fn main() -> u32 {
+  %s
+})",
+                                        absl::StrJoin(terms, " + "));
+
+  ImportData import_data(CreateImportDataForTest());
+  TypecheckedModule tm =
+      ParseAndTypecheck(program, "bench.x", "bench", &import_data).value();
+  Function* f = tm.module->GetMemberOrError<Function>("main").value();
+  std::unique_ptr<BytecodeFunction> bf =
+      BytecodeEmitter::Emit(&import_data, tm.type_info, f, ParametricEnv())
+          .value();
+  for (auto _ : state) {
+    if (!shared_cache) {
+      import_data.SetBytecodeCache(
+          std::make_unique<BytecodeCache>(&import_data));
+    }
+    benchmark::DoNotOptimize(
+        BytecodeInterpreter::Interpret(&import_data, bf.get(), {}).value());
+  }
+}
+
+void BM_ParametricCallsFreshCache(benchmark::State& state) {
+  RunParametricCallBenchmark(state, /*shared_cache=*/false);
+}
+BENCHMARK(BM_ParametricCallsFreshCache)->Range(4, 32);
+
+void BM_ParametricCallsSharedCache(benchmark::State& state) {
+  RunParametricCallBenchmark(state, /*shared_cache=*/true);
+}
+BENCHMARK(BM_ParametricCallsSharedCache)->Range(4, 32);
+
+}  // namespace
+}  // namespace xls::dslx
+
+BENCHMARK_MAIN();
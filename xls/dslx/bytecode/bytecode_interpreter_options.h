@@ -80,6 +80,15 @@ class BytecodeInterpreterOptions {
   }
   std::optional<int64_t> max_ticks() const { return max_ticks_; }
 
+  // The number of threads on which ProcNetworkRunner runs the instances of a
+  // proc network. With more than one, the hooks above may be called from any
+  // of them (see SerializeHooks()).
+  BytecodeInterpreterOptions& proc_threads(int64_t value) {
+    proc_threads_ = value;
+    return *this;
+  }
+  int64_t proc_threads() const { return proc_threads_; }
+
   void set_validate_final_stack_depth(bool enabled) {
     validate_final_stack_depth_ = enabled;
   }
@@ -102,6 +111,7 @@ class BytecodeInterpreterOptions {
   RolloverHook rollover_hook_ = nullptr;
   bool trace_channels_ = false;
   std::optional<int64_t> max_ticks_;
+  int64_t proc_threads_ = 1;
   bool validate_final_stack_depth_ = true;
   FormatPreference format_preference_ = FormatPreference::kDefault;
 };
@@ -133,6 +133,40 @@ TEST(BytecodeInterpreterTest, DupEmptyStack) {
                ::testing::HasSubstr("!stack_.empty()")));
 }
 
+// Loads of a slot which is dead afterwards move the value out of the slot;
+// other loads (including ones whose slot is read around a loop backedge) copy.
+TEST(BytecodeInterpreterTest, LastUseLoads) {
+  std::vector<Bytecode> bytecodes;
+  bytecodes.emplace_back(kFakeSpan, Bytecode::Op::kLiteral,
+                         InterpValue::MakeU32(21));
+  bytecodes.emplace_back(kFakeSpan, Bytecode::Op::kStore,
+                         Bytecode::SlotIndex(0));
+  bytecodes.emplace_back(kFakeSpan, Bytecode::Op::kJumpDest);
+  bytecodes.emplace_back(kFakeSpan, Bytecode::Op::kLoad,
+                         Bytecode::SlotIndex(0));
+  bytecodes.emplace_back(kFakeSpan, Bytecode::Op::kPop);
+  bytecodes.emplace_back(kFakeSpan, Bytecode::Op::kLiteral,
+                         InterpValue::MakeBool(false));
+  bytecodes.emplace_back(kFakeSpan, Bytecode::Op::kJumpRelIf,
+                         Bytecode::JumpTarget(-4));
+  bytecodes.emplace_back(kFakeSpan, Bytecode::Op::kLoad,
+                         Bytecode::SlotIndex(0));
+  bytecodes.emplace_back(kFakeSpan, Bytecode::Op::kLoad,
+                         Bytecode::SlotIndex(0));
+  bytecodes.emplace_back(kFakeSpan, Bytecode::Op::kUAdd);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto bfunc,
+      BytecodeFunction::Create(/*owner=*/nullptr, /*source_fn=*/nullptr,
+                               /*type_info=*/nullptr, std::move(bytecodes)));
+  EXPECT_FALSE(bfunc->IsLastUseLoad(3));
+  EXPECT_FALSE(bfunc->IsLastUseLoad(7));
+  EXPECT_TRUE(bfunc->IsLastUseLoad(8));
+  XLS_ASSERT_OK_AND_ASSIGN(InterpValue result, BytecodeInterpreter::Interpret(
+                                                   /*import_data=*/nullptr,
+                                                   bfunc.get(), {}));
+  EXPECT_EQ(result, InterpValue::MakeU32(42));
+}
+
 TEST(BytecodeInterpreterTest, TraceBitsValueDefaultFormat) {
   constexpr std::string_view kProgram = R"(
 fn main() -> () {
@@ -0,0 +1,329 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "xls/dslx/bytecode/bytecode_optimizer.h"
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/interp_value.h"
+
+namespace xls::dslx {
+namespace {
+
+using Op = Bytecode::Op;
+
+bool IsJump(const Bytecode& bytecode) {
+  return bytecode.op() == Op::kJumpRel || bytecode.op() == Op::kJumpRelIf;
+}
+
+// Returns the absolute target of the jump at `pc`, or nullopt if it is not a
+// valid jump target: the end of the function or a jump destination.
+std::optional<int64_t> GetTarget(absl::Span<const Bytecode> bytecodes,
+                                 int64_t pc) {
+  absl::StatusOr<Bytecode::JumpTarget> rel = bytecodes[pc].jump_target();
+  if (!rel.ok()) {
+    return std::nullopt;
+  }
+  const int64_t size = bytecodes.size();
+  int64_t target = pc + rel->value();
+  if (target == size) {
+    return target;
+  }
+  if (target < 0 || target > size ||
+      bytecodes[target].op() != Op::kJumpDest) {
+    return std::nullopt;
+  }
+  return target;
+}
+
+// Retargets jumps to a jump destination immediately followed by an
+// unconditional jump to the destination of the latter. Returns whether
+// anything changed.
+bool ThreadJumps(std::vector<Bytecode>& bytecodes) {
+  const int64_t size = bytecodes.size();
+  bool changed = false;
+  for (int64_t pc = 0; pc < size; ++pc) {
+    if (!IsJump(bytecodes[pc])) {
+      continue;
+    }
+    std::optional<int64_t> target = GetTarget(bytecodes, pc);
+    if (!target.has_value()) {
+      continue;
+    }
+    int64_t final_target = *target;
+    absl::flat_hash_set<int64_t> visited = {final_target};
+    while (final_target + 1 < size &&
+           bytecodes[final_target + 1].op() == Op::kJumpRel) {
+      std::optional<int64_t> next_target =
+          GetTarget(bytecodes, final_target + 1);
+      if (!next_target.has_value()) {
+        break;
+      }
+      if (!visited.insert(*next_target).second) {
+        // A cycle of jumps, i.e. an infinite loop; leave it alone.
+        final_target = *target;
+        break;
+      }
+      final_target = *next_target;
+    }
+    if (final_target != *target) {
+      bytecodes[pc] =
+          Bytecode(bytecodes[pc].source_span(), bytecodes[pc].op(),
+                   Bytecode::JumpTarget(final_target - pc));
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+// Folds `op` applied to the given literals; returns nullopt if the operation
+// is not foldable or fails (so that it fails at runtime as before).
+std::optional<InterpValue> FoldUnop(Op op, const InterpValue& operand) {
+  absl::StatusOr<InterpValue> result;
+  switch (op) {
+    case Op::kInvert:
+      result = operand.BitwiseNegate();
+      break;
+    case Op::kNegate:
+      result = operand.ArithmeticNegate();
+      break;
+    default:
+      return std::nullopt;
+  }
+  if (!result.ok()) {
+    return std::nullopt;
+  }
+  return *std::move(result);
+}
+
+std::optional<InterpValue> FoldBinop(Op op, const InterpValue& lhs,
+                                     const InterpValue& rhs) {
+  absl::StatusOr<InterpValue> result;
+  switch (op) {
+    case Op::kAnd:
+      result = lhs.BitwiseAnd(rhs);
+      break;
+    case Op::kOr:
+      result = lhs.BitwiseOr(rhs);
+      break;
+    case Op::kXor:
+      result = lhs.BitwiseXor(rhs);
+      break;
+    case Op::kConcat:
+      result = lhs.Concat(rhs);
+      break;
+    case Op::kEq:
+      result = InterpValue::MakeBool(lhs.Eq(rhs));
+      break;
+    case Op::kNe:
+      result = InterpValue::MakeBool(lhs.Ne(rhs));
+      break;
+    case Op::kLt:
+      result = lhs.Lt(rhs);
+      break;
+    case Op::kLe:
+      result = lhs.Le(rhs);
+      break;
+    case Op::kGt:
+      result = lhs.Gt(rhs);
+      break;
+    case Op::kGe:
+      result = lhs.Ge(rhs);
+      break;
+    case Op::kShl:
+      result = lhs.Shl(rhs);
+      break;
+    case Op::kShr:
+      if (!lhs.IsBits() && !lhs.IsEnum()) {
+        return std::nullopt;
+      }
+      result = lhs.IsSigned() ? lhs.Shra(rhs) : lhs.Shrl(rhs);
+      break;
+    case Op::kDiv:
+      result = lhs.FloorDiv(rhs);
+      break;
+    case Op::kMod:
+      result = lhs.FloorMod(rhs);
+      break;
+    default:
+      // Notably add, sub and mul are not folded: the interpreter reports their
+      // overflows to the rollover hook.
+      return std::nullopt;
+  }
+  if (!result.ok()) {
+    return std::nullopt;
+  }
+  return *std::move(result);
+}
+
+// Applies the peephole rewrites to the end of `out`, which has just had a
+// bytecode appended. `orig_pc` holds the index in the input of each element of
+// `out`.
+void Peephole(std::vector<Bytecode>& out, std::vector<int64_t>& orig_pc,
+              const std::vector<bool>& last_use) {
+  auto pop_back = [&](int64_t count) {
+    out.erase(out.end() - count, out.end());
+    orig_pc.erase(orig_pc.end() - count, orig_pc.end());
+  };
+  while (out.size() >= 2) {
+    const Bytecode& last = out[out.size() - 1];
+    const Bytecode& prev = out[out.size() - 2];
+
+    // A value which is pushed and immediately popped.
+    if (last.op() == Op::kPop &&
+        (prev.op() == Op::kLiteral || prev.op() == Op::kLoad ||
+         prev.op() == Op::kDup)) {
+      pop_back(2);
+      continue;
+    }
+
+    // A value which is stored and then loaded for the last time.
+    if (prev.op() == Op::kStore && last.op() == Op::kLoad &&
+        last_use[orig_pc.back()]) {
+      absl::StatusOr<Bytecode::SlotIndex> stored = prev.slot_index();
+      absl::StatusOr<Bytecode::SlotIndex> loaded = last.slot_index();
+      if (stored.ok() && loaded.ok() && *stored == *loaded) {
+        pop_back(2);
+        continue;
+      }
+    }
+
+    if (prev.op() == Op::kLiteral) {
+      if (std::optional<InterpValue> folded =
+              FoldUnop(last.op(), prev.value_data().value())) {
+        Bytecode literal =
+            Bytecode::MakeLiteral(last.source_span(), *std::move(folded));
+        int64_t pc = orig_pc.back();
+        pop_back(2);
+        out.push_back(std::move(literal));
+        orig_pc.push_back(pc);
+        continue;
+      }
+    }
+
+    if (out.size() >= 3 && prev.op() == Op::kLiteral &&
+        out[out.size() - 3].op() == Op::kLiteral) {
+      if (std::optional<InterpValue> folded =
+              FoldBinop(last.op(), out[out.size() - 3].value_data().value(),
+                        prev.value_data().value())) {
+        Bytecode literal =
+            Bytecode::MakeLiteral(last.source_span(), *std::move(folded));
+        int64_t pc = orig_pc.back();
+        pop_back(3);
+        out.push_back(std::move(literal));
+        orig_pc.push_back(pc);
+        continue;
+      }
+    }
+    break;
+  }
+}
+
+// Removes unreachable code, unreferenced jump destinations and jumps to the
+// next bytecode, and applies the peephole rewrites. Consumes `bytecodes`
+// unless it cannot be analyzed, in which case nullopt is returned.
+std::optional<std::vector<Bytecode>> Simplify(
+    std::vector<Bytecode>& bytecodes) {
+  const int64_t size = bytecodes.size();
+  std::vector<std::optional<int64_t>> targets(size);
+  std::vector<bool> is_target(size + 1, false);
+  for (int64_t pc = 0; pc < size; ++pc) {
+    if (!IsJump(bytecodes[pc])) {
+      continue;
+    }
+    targets[pc] = GetTarget(bytecodes, pc);
+    if (!targets[pc].has_value()) {
+      return std::nullopt;
+    }
+    is_target[*targets[pc]] = true;
+  }
+  absl::StatusOr<std::vector<bool>> last_use = ComputeLastUseLoads(bytecodes);
+  if (!last_use.ok()) {
+    last_use = std::vector<bool>(size, false);
+  }
+
+  std::vector<Bytecode> out;
+  out.reserve(size);
+  std::vector<int64_t> orig_pc;
+  orig_pc.reserve(size);
+  // The index in `out` of each input bytecode (or of the bytecode after it if
+  // it was removed), for retargeting the jumps.
+  std::vector<int64_t> new_pc(size + 1);
+  // (index in `out`, absolute target in the input) of each jump.
+  std::vector<std::pair<int64_t, int64_t>> jumps;
+  bool reachable = true;
+  for (int64_t pc = 0; pc < size; ++pc) {
+    new_pc[pc] = out.size();
+    Bytecode& bytecode = bytecodes[pc];
+    if (bytecode.op() == Op::kJumpDest) {
+      if (!is_target[pc]) {
+        continue;
+      }
+      reachable = true;
+    }
+    if (!reachable) {
+      continue;
+    }
+    if (IsJump(bytecode)) {
+      if (bytecode.op() == Op::kJumpRel) {
+        reachable = false;
+        if (*targets[pc] == pc + 1) {
+          continue;
+        }
+      }
+      jumps.push_back({static_cast<int64_t>(out.size()), *targets[pc]});
+      out.push_back(std::move(bytecode));
+      orig_pc.push_back(pc);
+      continue;
+    }
+    out.push_back(std::move(bytecode));
+    orig_pc.push_back(pc);
+    Peephole(out, orig_pc, *last_use);
+  }
+  new_pc[size] = out.size();
+
+  for (const auto& [jump_pc, target] : jumps) {
+    out[jump_pc] =
+        Bytecode(out[jump_pc].source_span(), out[jump_pc].op(),
+                 Bytecode::JumpTarget(new_pc[target] - jump_pc));
+  }
+  return out;
+}
+
+}  // namespace
+
+absl::StatusOr<std::vector<Bytecode>> OptimizeBytecodes(
+    std::vector<Bytecode> bytecodes) {
+  while (true) {
+    bool changed = ThreadJumps(bytecodes);
+    const int64_t size = bytecodes.size();
+    std::optional<std::vector<Bytecode>> simplified = Simplify(bytecodes);
+    if (!simplified.has_value()) {
+      return bytecodes;
+    }
+    changed |= simplified->size() != size;
+    bytecodes = *std::move(simplified);
+    if (!changed) {
+      return bytecodes;
+    }
+  }
+}
+
+}  // namespace xls::dslx
@@ -0,0 +1,47 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef XLS_DSLX_BYTECODE_BYTECODE_OPTIMIZER_H_
+#define XLS_DSLX_BYTECODE_BYTECODE_OPTIMIZER_H_
+
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "xls/dslx/bytecode/bytecode.h"
+
+namespace xls::dslx {
+
+// Rewrites the bytecode of a function (as emitted by the BytecodeEmitter) into
+// fewer, cheaper bytecodes with the same results, failures and traces. Until
+// nothing changes, this:
+//  * threads jumps: a jump to an unconditional jump goes straight to that
+//    jump's destination, and an unconditional jump to the next bytecode is
+//    removed;
+//  * removes unreachable code and jump destinations no jump refers to;
+//  * folds operations on literals into literals, for operations whose
+//    interpretation cannot fail or observe the interpreter options (e.g. the
+//    rollover hook of add, sub and mul);
+//  * removes values which are pushed (by a literal, load or dup) and then
+//    immediately popped;
+//  * replaces a store to a slot followed by its last load with nothing, leaving
+//    the value on the stack.
+//
+// Bytecode which cannot be analyzed (e.g. has jumps which do not land on jump
+// destinations) is returned unchanged, so that it fails when executed as
+// before.
+absl::StatusOr<std::vector<Bytecode>> OptimizeBytecodes(
+    std::vector<Bytecode> bytecodes);
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_BYTECODE_BYTECODE_OPTIMIZER_H_
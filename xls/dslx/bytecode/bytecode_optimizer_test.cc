@@ -0,0 +1,134 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/bytecode/bytecode_optimizer.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/frontend/pos.h"
+#include "xls/dslx/interp_value.h"
+
+namespace xls::dslx {
+namespace {
+
+using Op = Bytecode::Op;
+using JumpTarget = Bytecode::JumpTarget;
+using SlotIndex = Bytecode::SlotIndex;
+
+Bytecode Literal(int64_t value) {
+  return Bytecode::MakeLiteral(Span::Fake(), InterpValue::MakeU32(value));
+}
+
+Bytecode MakeOp(Op op) { return Bytecode(Span::Fake(), op); }
+
+TEST(BytecodeOptimizerTest, FoldsLiterals) {
+  std::vector<Bytecode> bytecodes;
+  bytecodes.push_back(Literal(0b1100));
+  bytecodes.push_back(Literal(0b1010));
+  bytecodes.push_back(MakeOp(Op::kAnd));
+  bytecodes.push_back(Literal(0b1000));
+  bytecodes.push_back(MakeOp(Op::kEq));
+  bytecodes.push_back(MakeOp(Op::kInvert));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Bytecode> optimized,
+                           OptimizeBytecodes(std::move(bytecodes)));
+  EXPECT_EQ(BytecodesToString(optimized, /*source_locs=*/false),
+            "000 literal u1:0");
+}
+
+TEST(BytecodeOptimizerTest, DoesNotFoldArithmetic) {
+  // The interpreter reports the overflow of adds to the rollover hook.
+  std::vector<Bytecode> bytecodes;
+  bytecodes.push_back(Literal(0xffffffff));
+  bytecodes.push_back(Literal(1));
+  bytecodes.push_back(MakeOp(Op::kAdd));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Bytecode> optimized,
+                           OptimizeBytecodes(std::move(bytecodes)));
+  EXPECT_EQ(BytecodesToString(optimized, /*source_locs=*/false),
+            R"(000 literal u32:4294967295
+001 literal u32:1
+002 add)");
+}
+
+TEST(BytecodeOptimizerTest, RemovesDeadPushesAndStores) {
+  std::vector<Bytecode> bytecodes;
+  bytecodes.push_back(Bytecode::MakeLoad(Span::Fake(), SlotIndex(0)));
+  bytecodes.push_back(Literal(1));
+  bytecodes.push_back(Bytecode::MakePop(Span::Fake()));
+  bytecodes.push_back(Bytecode::MakeStore(Span::Fake(), SlotIndex(1)));
+  bytecodes.push_back(Bytecode::MakeLoad(Span::Fake(), SlotIndex(1)));
+  bytecodes.push_back(Bytecode::MakeStore(Span::Fake(), SlotIndex(2)));
+  bytecodes.push_back(Bytecode::MakeLoad(Span::Fake(), SlotIndex(2)));
+  bytecodes.push_back(Bytecode::MakeLoad(Span::Fake(), SlotIndex(2)));
+  bytecodes.push_back(MakeOp(Op::kXor));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Bytecode> optimized,
+                           OptimizeBytecodes(std::move(bytecodes)));
+  // Slot 1 is not loaded again, but slot 2 is.
+  EXPECT_EQ(BytecodesToString(optimized, /*source_locs=*/false),
+            R"(000 load 0
+001 store 2
+002 load 2
+003 load 2
+004 xor)");
+}
+
+TEST(BytecodeOptimizerTest, ThreadsJumpsAndRemovesDeadCode) {
+  std::vector<Bytecode> bytecodes;
+  bytecodes.push_back(Bytecode::MakeLoad(Span::Fake(), SlotIndex(0)));
+  bytecodes.push_back(Bytecode::MakeJumpRelIf(Span::Fake(), JumpTarget(3)));
+  bytecodes.push_back(Literal(1));
+  bytecodes.push_back(Bytecode::MakeJumpRel(Span::Fake(), JumpTarget(3)));
+  bytecodes.push_back(Bytecode::MakeJumpDest(Span::Fake()));
+  bytecodes.push_back(Literal(0));
+  bytecodes.push_back(Bytecode::MakeJumpDest(Span::Fake()));
+  bytecodes.push_back(Bytecode::MakeJumpRel(Span::Fake(), JumpTarget(3)));
+  bytecodes.push_back(Literal(2));
+  bytecodes.push_back(Bytecode::MakePop(Span::Fake()));
+  bytecodes.push_back(Bytecode::MakeJumpDest(Span::Fake()));
+  bytecodes.push_back(Literal(4));
+  bytecodes.push_back(MakeOp(Op::kAnd));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Bytecode> optimized,
+                           OptimizeBytecodes(std::move(bytecodes)));
+  EXPECT_EQ(BytecodesToString(optimized, /*source_locs=*/false),
+            R"(000 load 0
+001 jump_rel_if +3
+002 literal u32:1
+003 jump_rel +3
+004 jump_dest
+005 literal u32:0
+006 jump_dest
+007 literal u32:4
+008 and)");
+}
+
+TEST(BytecodeOptimizerTest, LeavesInvalidJumpsAlone) {
+  std::vector<Bytecode> bytecodes;
+  bytecodes.push_back(Bytecode::MakeJumpRel(Span::Fake(), JumpTarget(2)));
+  bytecodes.push_back(Literal(1));
+  bytecodes.push_back(Literal(2));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Bytecode> optimized,
+                           OptimizeBytecodes(std::move(bytecodes)));
+  EXPECT_EQ(BytecodesToString(optimized, /*source_locs=*/false),
+            R"(000 jump_rel +2
+001 literal u32:1
+002 literal u32:2)");
+}
+
+}  // namespace
+}  // namespace xls::dslx
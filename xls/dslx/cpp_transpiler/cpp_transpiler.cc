@@ -14,6 +14,7 @@
 
 #include "xls/dslx/cpp_transpiler/cpp_transpiler.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
@@ -43,7 +44,14 @@
 #include "xls/dslx/bytecode/bytecode_emitter.h"
 #include "xls/dslx/bytecode/bytecode_interpreter.h"
 #include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/ir_convert/ir_conversion_utils.h"
+#include "xls/dslx/type_system/concrete_type.h"
+#include "xls/dslx/type_system/parametric_env.h"
 #include "xls/dslx/type_system/typecheck.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls::dslx {
 namespace {
@@ -53,6 +61,11 @@ struct TranspileData {
   Module* module;
   TypeInfo* type_info;
   ImportData* import_data;
+
+  // Only set when emitting JIT-layout-compatible types: the runtime computing
+  // the native layouts and the package holding the IR types they are of.
+  JitRuntime* jit_runtime = nullptr;
+  Package* ir_package = nullptr;
 };
 
 absl::StatusOr<InterpValue> InterpretExpr(
@@ -106,10 +119,13 @@ absl::StatusOr<Sources> TranspileColonRef(const TranspileData& xpile_data,
   return absl::UnimplementedError("TranspileColonRef not yet implemented.");
 }
 
+absl::StatusOr<std::string> BuiltinBitCountToString(int64_t bit_count,
+                                                    bool signedness);
+
 absl::StatusOr<Sources> TranspileEnumDef(const TranspileData& xpile_data,
                                          const EnumDef* enum_def) {
   constexpr std::string_view kTemplate =
-      "enum class %s {\n%s\n};\nconstexpr int64_t k%sNumElements = %d;";
+      "enum class %s%s {\n%s\n};\nconstexpr int64_t k%sNumElements = %d;";
   constexpr std::string_view kMemberTemplate = "  %s = %s,";
 
   std::vector<std::string> members;
@@ -147,10 +163,31 @@ absl::StatusOr<Sources> TranspileEnumDef(const TranspileData& xpile_data,
     members.push_back(absl::StrFormat(kMemberTemplate, identifier, val_str));
   }
 
+  // The JIT holds enum values in the smallest containing integer type, so the
+  // enum's underlying type must be that too (rather than the default int).
+  std::string underlying_type;
+  if (xpile_data.jit_runtime != nullptr) {
+    XLS_ASSIGN_OR_RETURN(
+        std::optional<BuiltinType> as_builtin_type,
+        GetAsBuiltinType(xpile_data.module, xpile_data.type_info,
+                         xpile_data.import_data, enum_def->type_annotation()));
+    XLS_RET_CHECK(as_builtin_type.has_value());
+    XLS_ASSIGN_OR_RETURN(bool is_signed,
+                         GetBuiltinTypeSignedness(as_builtin_type.value()));
+    XLS_ASSIGN_OR_RETURN(int64_t bit_count,
+                         GetBuiltinTypeBitCount(as_builtin_type.value()));
+    // Enums can't have a bool underlying type, so widen single bits to a byte.
+    XLS_ASSIGN_OR_RETURN(
+        std::string type_str,
+        BuiltinBitCountToString(std::max<int64_t>(bit_count, 8), is_signed));
+    underlying_type = absl::StrCat(" : ", type_str);
+  }
+
   std::string camelized_id = CheckedCamelize(enum_def->identifier());
   return Sources{
-      absl::StrFormat(kTemplate, camelized_id, absl::StrJoin(members, "\n"),
-                      camelized_id, members.size()),
+      absl::StrFormat(kTemplate, camelized_id, underlying_type,
+                      absl::StrJoin(members, "\n"), camelized_id,
+                      members.size()),
       ""};
 }
 
@@ -554,6 +591,42 @@ absl::StatusOr<std::optional<int64_t>> GetFieldWidth(
   return std::nullopt;
 }
 
+// Generates static_asserts that the size and member offsets of the emitted
+// struct match the JIT's native layout of the struct's IR type.
+absl::StatusOr<std::string> GenerateJitLayoutAsserts(
+    const TranspileData& xpile_data, const StructDef* struct_def) {
+  std::optional<ConcreteType*> meta_type =
+      xpile_data.type_info->GetItem(struct_def->name_def());
+  XLS_RET_CHECK(meta_type.has_value());
+  const auto* struct_meta_type = dynamic_cast<const MetaType*>(*meta_type);
+  XLS_RET_CHECK(struct_meta_type != nullptr);
+  XLS_ASSIGN_OR_RETURN(xls::Type * ir_type,
+                       TypeToIr(xpile_data.ir_package,
+                                *struct_meta_type->wrapped(), ParametricEnv()));
+  TypeLayout layout = xpile_data.jit_runtime->CreateTypeLayout(ir_type);
+  TupleType* tuple_type = ir_type->AsTupleOrDie();
+
+  std::string name = CheckedCamelize(struct_def->identifier());
+  std::vector<std::string> asserts;
+  asserts.push_back(absl::StrFormat(
+      "static_assert(sizeof(%s) == %d,\n"
+      "              \"%s must have the JIT's native layout\");",
+      name, layout.size(), name));
+  for (int64_t i = 0; i < tuple_type->size(); ++i) {
+    // Members without leaves (e.g., empty tuples) have no meaningful offset.
+    if (tuple_type->element_type(i)->leaf_count() == 0) {
+      continue;
+    }
+    int64_t offset = layout.elements()[tuple_type->leaf_offset(i)].offset;
+    asserts.push_back(absl::StrFormat(
+        "static_assert(offsetof(%s, %s) == %d,\n"
+        "              \"%s::%s must have the JIT's native layout\");",
+        name, struct_def->members()[i].first->identifier(), offset, name,
+        struct_def->members()[i].first->identifier()));
+  }
+  return absl::StrJoin(asserts, "\n");
+}
+
 // Should performance become an issue, optimizing struct layouts by reordering
 // (packing?) struct members could be considered.
 absl::StatusOr<std::string> TranspileStructDefHeader(
@@ -600,9 +673,15 @@ $1$2
   if (!width_block.empty()) {
     width_block = "\n\n" + width_block;
   }
-  return absl::Substitute(kStructTemplate,
-                          CheckedCamelize(struct_def->identifier()),
-                          absl::StrJoin(member_decls, "\n"), width_block);
+  std::string result = absl::Substitute(
+      kStructTemplate, CheckedCamelize(struct_def->identifier()),
+      absl::StrJoin(member_decls, "\n"), width_block);
+  if (xpile_data.jit_runtime != nullptr) {
+    XLS_ASSIGN_OR_RETURN(std::string asserts,
+                         GenerateJitLayoutAsserts(xpile_data, struct_def));
+    absl::StrAppend(&result, "\n", asserts);
+  }
+  return result;
 }
 
 absl::StatusOr<std::string> GenerateStructFromValue(
@@ -729,12 +808,13 @@ absl::StatusOr<Sources> TranspileSingleToCpp(
 
 absl::StatusOr<Sources> TranspileToCpp(Module* module, ImportData* import_data,
                                        std::string_view output_header_path,
-                                       std::string_view namespaces) {
+                                       std::string_view namespaces,
+                                       bool jit_layout_compatible) {
   constexpr std::string_view kHeaderTemplate =
       R"(// AUTOMATICALLY GENERATED FILE FROM `xls/dslx/cpp_transpiler`. DO NOT EDIT!
 #ifndef $0
 #define $0
-#include <cstdint>
+$4#include <cstdint>
 #include <ostream>
 
 #include "absl/status/statusor.h"
@@ -761,6 +841,13 @@ $2$1$3
   struct TranspileData xpile_data {
     module, type_info, import_data
   };
+  std::unique_ptr<JitRuntime> jit_runtime;
+  Package ir_package("cpp_transpiler");
+  if (jit_layout_compatible) {
+    XLS_ASSIGN_OR_RETURN(jit_runtime, JitRuntime::Create());
+    xpile_data.jit_runtime = jit_runtime.get();
+    xpile_data.ir_package = &ir_package;
+  }
 
   std::vector<std::string> header;
   std::vector<std::string> body;
@@ -794,7 +881,8 @@ $2$1$3
   return Sources{
       absl::Substitute(kHeaderTemplate, header_guard,
                        absl::StrJoin(header, "\n\n"), namespace_begin,
-                       namespace_end),
+                       namespace_end,
+                       jit_layout_compatible ? "#include <cstddef>\n" : ""),
       absl::StrFormat(kSourceTemplate, output_header_path, namespace_begin,
                       absl::StrJoin(body, "\n\n"), namespace_end)};
 }
@@ -48,9 +48,19 @@ struct Sources {
   std::string body;
 };
 
+// If `jit_layout_compatible` is true, the emitted types have the same memory
+// layout as the native layout of the corresponding IR types in the JIT (see
+// xls/jit/type_layout.h): enums use the smallest containing integer type as
+// their underlying type and each struct is followed by static_asserts on its
+// size and member offsets. A struct instance may then be passed directly as
+// the buffer of an argument or result of a JIT-compiled function (e.g. with
+// FunctionJit::RunWithViews), provided that the bits of each field beyond its
+// DSLX width are zero -- note this means negative values of signed fields
+// narrower than their C++ type must be masked.
 absl::StatusOr<Sources> TranspileToCpp(Module* module, ImportData* import_data,
                                        std::string_view output_header_path,
-                                       std::string_view namespaces = "");
+                                       std::string_view namespaces = "",
+                                       bool jit_layout_compatible = false);
 
 }  // namespace xls::dslx
 
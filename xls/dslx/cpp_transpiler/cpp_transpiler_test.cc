@@ -28,6 +28,7 @@
 namespace xls::dslx {
 
 using testing::HasSubstr;
+using testing::Not;
 using xls::status_testing::StatusIs;
 
 namespace {
@@ -369,6 +370,62 @@ std::ostream& operator<<(std::ostream& os, const MyStruct& data) {
   ASSERT_EQ(result.body, kExpectedBody);
 }
 
+TEST(CppTranspilerTest, JitLayoutCompatibleStruct) {
+  constexpr std::string_view kModule = R"(
+enum MyEnum : u2 {
+  A = 0,
+  B = 1,
+}
+
+struct Inner {
+  a: u8,
+  b: u32,
+}
+
+struct MyStruct {
+  x: u15,
+  e: MyEnum,
+  inner: Inner,
+  w: s63,
+  v: u1,
+})";
+
+  auto import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule module,
+      ParseAndTypecheck(kModule, "fake_path", "MyModule", &import_data));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto result,
+      TranspileToCpp(module.module, &import_data, "fake_path.h",
+                     /*namespaces=*/"", /*jit_layout_compatible=*/true));
+  EXPECT_THAT(result.header, HasSubstr("#include <cstddef>\n"));
+  EXPECT_THAT(result.header, HasSubstr("enum class MyEnum : uint8_t {"));
+  EXPECT_THAT(result.header, HasSubstr(R"(static_assert(sizeof(Inner) == 8,
+              "Inner must have the JIT's native layout");
+static_assert(offsetof(Inner, a) == 0,
+              "Inner::a must have the JIT's native layout");
+static_assert(offsetof(Inner, b) == 4,
+              "Inner::b must have the JIT's native layout");)"));
+  EXPECT_THAT(result.header, HasSubstr(R"(static_assert(sizeof(MyStruct) == 32,
+              "MyStruct must have the JIT's native layout");
+static_assert(offsetof(MyStruct, x) == 0,
+              "MyStruct::x must have the JIT's native layout");
+static_assert(offsetof(MyStruct, e) == 2,
+              "MyStruct::e must have the JIT's native layout");
+static_assert(offsetof(MyStruct, inner) == 4,
+              "MyStruct::inner must have the JIT's native layout");
+static_assert(offsetof(MyStruct, w) == 16,
+              "MyStruct::w must have the JIT's native layout");
+static_assert(offsetof(MyStruct, v) == 24,
+              "MyStruct::v must have the JIT's native layout");)"));
+
+  // Without the option the enum keeps its default underlying type.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      result, TranspileToCpp(module.module, &import_data, "fake_path.h"));
+  EXPECT_THAT(result.header, HasSubstr("enum class MyEnum {"));
+  EXPECT_THAT(result.header, Not(HasSubstr("static_assert")));
+}
+
 TEST(CppTranspilerTest, BasicArray) {
   constexpr std::string_view kModule = R"(
 struct MyStruct {
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <climits>
+#include <cstddef>
 #include <cstdint>
 #include <deque>
 #include <memory>
@@ -815,13 +816,36 @@ std::string ChannelDecl::ToStringInternal() const {
 
 Module::~Module() {
   XLS_VLOG(3) << "Destroying module \"" << name_ << "\" @ " << this;
+  for (auto it = nodes_.rbegin(); it != nodes_.rend(); ++it) {
+    (*it)->~AstNode();
+  }
+}
+
+void* Module::AllocateNode(size_t size, size_t alignment) {
+  // Large enough to hold many nodes, small enough not to waste much memory
+  // for small modules.
+  constexpr size_t kArenaBlockSize = 64 * 1024;
+  if (arena_next_ == nullptr ||
+      std::align(alignment, size, arena_next_, arena_remaining_) == nullptr) {
+    size_t block_size = std::max(kArenaBlockSize, size + alignment);
+    arena_blocks_.push_back(std::unique_ptr<char[]>(new char[block_size]));
+    arena_memory_account_.Add(block_size);
+    arena_next_ = arena_blocks_.back().get();
+    arena_remaining_ = block_size;
+    XLS_CHECK(std::align(alignment, size, arena_next_, arena_remaining_) !=
+              nullptr);
+  }
+  void* result = arena_next_;
+  arena_next_ = static_cast<char*>(arena_next_) + size;
+  arena_remaining_ -= size;
+  return result;
 }
 
 const AstNode* Module::FindNode(AstNodeKind kind, const Span& target) const {
   for (const auto& node : nodes_) {
     if (node->kind() == kind && node->GetSpan().has_value() &&
         node->GetSpan().value() == target) {
-      return node.get();
+      return node;
     }
   }
   return nullptr;
@@ -831,7 +855,7 @@ std::vector<const AstNode*> Module::FindIntercepting(const Pos& target) const {
   std::vector<const AstNode*> found;
   for (const auto& node : nodes_) {
     if (node->GetSpan().has_value() && node->GetSpan()->Contains(target)) {
-      found.push_back(node.get());
+      found.push_back(node);
     }
   }
   return found;
@@ -16,10 +16,12 @@
 #define XLS_DSLX_FRONTEND_AST_H_
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <filesystem>  // NOLINT
 #include <functional>
 #include <memory>
+#include <new>
 #include <optional>
 #include <ostream>
 #include <string>
@@ -44,6 +46,7 @@
 #include "absl/types/span.h"
 #include "xls/common/casts.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/memory_accounting.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dslx/channel_direction.h"
 #include "xls/dslx/frontend/ast_node.h"  // IWYU pragma: export
@@ -3204,14 +3207,16 @@ class Module : public AstNode {
  private:
   template <typename T, typename... Args>
   T* MakeInternal(Args&&... args) {
-    std::unique_ptr<T> node =
-        std::make_unique<T>(this, std::forward<Args>(args)...);
-    T* ptr = node.get();
+    T* ptr = new (AllocateNode(sizeof(T), alignof(T)))
+        T(this, std::forward<Args>(args)...);
     ptr->SetParentage();
-    nodes_.push_back(std::move(node));
+    nodes_.push_back(ptr);
     return ptr;
   }
 
+  // Returns uninitialized storage for an AST node from the arena blocks.
+  void* AllocateNode(size_t size, size_t alignment);
+
   // Returns all of the elements of top_ that have the given variant type T.
   template <typename T>
   std::vector<T*> GetTopWithT() const {
@@ -3245,7 +3250,15 @@ class Module : public AstNode {
   const std::optional<std::filesystem::path> fs_path_;
 
   std::vector<ModuleMember> top_;  // Top-level members of this module.
-  std::vector<std::unique_ptr<AstNode>> nodes_;  // Lifetime-owned AST nodes.
+
+  // Lifetime-owned AST nodes, in order of construction. The nodes are
+  // constructed in large arena blocks rather than allocated individually and
+  // are destroyed (in reverse order) by the module's destructor.
+  std::vector<AstNode*> nodes_;
+  std::vector<std::unique_ptr<char[]>> arena_blocks_;
+  void* arena_next_ = nullptr;  // Free space in the last arena block.
+  size_t arena_remaining_ = 0;
+  MemoryAccount arena_memory_account_{MemoryTag::kDslxAst};
 
   // Map of top-level module member name to the member itself.
   absl::flat_hash_map<std::string, ModuleMember> top_by_name_;
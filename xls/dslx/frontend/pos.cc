@@ -15,15 +15,79 @@
 #include "xls/dslx/frontend/pos.h"
 
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <string_view>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/logging/logging.h"
 #include "re2/re2.h"
 
 namespace xls::dslx {
+namespace {
+
+class FilenameTable {
+ public:
+  FilenameTable() { filenames_.push_back(std::make_unique<std::string>()); }
+
+  Fileno GetFileno(std::string_view filename) {
+    {
+      absl::ReaderMutexLock lock(&mutex_);
+      auto it = filenos_.find(filename);
+      if (it != filenos_.end()) {
+        return it->second;
+      }
+    }
+    absl::MutexLock lock(&mutex_);
+    auto it = filenos_.find(filename);
+    if (it != filenos_.end()) {
+      return it->second;
+    }
+    Fileno fileno = static_cast<Fileno>(filenames_.size());
+    filenames_.push_back(std::make_unique<std::string>(filename));
+    // Key the map by the table's copy, which outlives the caller's.
+    filenos_.emplace(*filenames_.back(), fileno);
+    return fileno;
+  }
+
+  const std::string& GetFilename(Fileno fileno) {
+    absl::ReaderMutexLock lock(&mutex_);
+    XLS_CHECK_LT(fileno, filenames_.size());
+    return *filenames_[fileno];
+  }
+
+ private:
+  absl::Mutex mutex_;
+  // The strings are individually allocated so references to them remain
+  // valid as the table grows.
+  std::vector<std::unique_ptr<std::string>> filenames_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string_view, Fileno> filenos_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+FilenameTable& GetFilenameTable() {
+  static auto* table = new FilenameTable();
+  return *table;
+}
+
+}  // namespace
+
+Fileno GetFileno(std::string_view filename) {
+  if (filename.empty()) {
+    return 0;
+  }
+  return GetFilenameTable().GetFileno(filename);
+}
+
+const std::string& GetFilename(Fileno fileno) {
+  return GetFilenameTable().GetFilename(fileno);
+}
 
 /* static */ absl::StatusOr<Span> Span::FromString(std::string_view s) {
   std::string filename;
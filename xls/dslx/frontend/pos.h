@@ -28,28 +28,47 @@
 
 namespace xls::dslx {
 
+// Identifies a filename in the process-wide filename table, so that positions
+// need not each carry a copy of their filename. Zero is the empty filename.
+using Fileno = int32_t;
+
+// Returns the number of `filename` in the filename table, adding it on first
+// use. Entries are never removed, so a number (and the string it refers to)
+// remains valid for the lifetime of the process.
+Fileno GetFileno(std::string_view filename);
+
+// Returns the filename with the given number in the filename table.
+const std::string& GetFilename(Fileno fileno);
+
 // Represents a position in the text (file, line, column).
 class Pos {
  public:
   static absl::StatusOr<Pos> FromString(std::string_view s);
 
-  Pos() : lineno_(0), colno_(0) {}
-  Pos(std::string filename, int64_t lineno, int64_t colno)
-      : filename_(std::move(filename)), lineno_(lineno), colno_(colno) {}
+  Pos() : fileno_(0), lineno_(0), colno_(0) {}
+  Pos(std::string_view filename, int64_t lineno, int64_t colno)
+      : Pos(GetFileno(filename), lineno, colno) {}
+  Pos(Fileno fileno, int64_t lineno, int64_t colno)
+      : fileno_(fileno),
+        lineno_(static_cast<int32_t>(lineno)),
+        colno_(static_cast<int32_t>(colno)) {
+    XLS_DCHECK_EQ(lineno_, lineno);
+    XLS_DCHECK_EQ(colno_, colno);
+  }
 
   std::string ToString() const {
-    return absl::StrFormat("%s:%d:%d", filename_, lineno_ + 1, colno_ + 1);
+    return absl::StrFormat("%s:%d:%d", filename(), lineno_ + 1, colno_ + 1);
   }
   std::string ToStringNoFile() const {
     return absl::StrFormat("%d:%d", lineno_ + 1, colno_ + 1);
   }
 
   std::string ToRepr() const {
-    return absl::StrFormat("Pos(\"%s\", %d, %d)", filename_, lineno_, colno_);
+    return absl::StrFormat("Pos(\"%s\", %d, %d)", filename(), lineno_, colno_);
   }
 
   bool operator<(const Pos& other) const {
-    XLS_CHECK_EQ(filename_, other.filename_);
+    CheckSameFile(other);
     if (lineno_ < other.lineno_) {
       return true;
     }
@@ -62,7 +81,7 @@ class Pos {
     return false;
   }
   bool operator==(const Pos& other) const {
-    XLS_CHECK_EQ(filename_, other.filename_);
+    CheckSameFile(other);
     return lineno_ == other.lineno_ && colno_ == other.colno_;
   }
   bool operator!=(const Pos& other) const { return !(*this == other); }
@@ -71,16 +90,22 @@ class Pos {
   }
   bool operator>=(const Pos& other) const { return !((*this) < other); }
 
-  const std::string& filename() const { return filename_; }
+  const std::string& filename() const { return GetFilename(fileno_); }
+  Fileno fileno() const { return fileno_; }
   int64_t lineno() const { return lineno_; }
   int64_t colno() const { return colno_; }
 
-  Pos BumpCol() const { return Pos(filename_, lineno_, colno_ + 1); }
+  Pos BumpCol() const { return Pos(fileno_, lineno_, colno_ + 1); }
 
  private:
-  std::string filename_;
-  int64_t lineno_;
-  int64_t colno_;
+  void CheckSameFile(const Pos& other) const {
+    XLS_CHECK_EQ(fileno_, other.fileno_)
+        << filename() << " vs " << other.filename();
+  }
+
+  Fileno fileno_;
+  int32_t lineno_;
+  int32_t colno_;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const Pos& pos) {
@@ -96,7 +121,8 @@ class Span {
 
   Span(Pos start, Pos limit)
       : start_(std::move(start)), limit_(std::move(limit)) {
-    XLS_CHECK_EQ(start_.filename(), limit_.filename());
+    XLS_CHECK_EQ(start_.fileno(), limit_.fileno())
+        << start_.filename() << " vs " << limit_.filename();
     XLS_CHECK_LE(start_, limit_);
   }
   Span() = default;
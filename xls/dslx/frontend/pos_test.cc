@@ -39,5 +39,20 @@ TEST(PosTest, PosLt) {
   EXPECT_GE(Pos(kFakeFile, 0, 0), Pos(kFakeFile, 0, 0));
 }
 
+TEST(PosTest, FilenamesAreInterned) {
+  std::string filename = "/my/bar.x";
+  Pos a(filename, 1, 2);
+  filename = "/my/baz.x";
+  Pos b(filename, 1, 2);
+  Pos c("/my/bar.x", 3, 4);
+  EXPECT_EQ(a.filename(), "/my/bar.x");
+  EXPECT_EQ(b.filename(), "/my/baz.x");
+  EXPECT_EQ(a.fileno(), c.fileno());
+  EXPECT_NE(a.fileno(), b.fileno());
+  EXPECT_EQ(&a.filename(), &c.filename());
+  EXPECT_EQ(Pos().filename(), "");
+  EXPECT_EQ(Pos(a.fileno(), 5, 6).ToString(), "/my/bar.x:6:7");
+}
+
 }  // namespace
 }  // namespace xls::dslx
@@ -15,6 +15,7 @@
 #include "xls/dslx/frontend/scanner.h"
 
 #include <cctype>
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <string>
@@ -68,25 +69,59 @@ bool Scanner::TryDropChar(char target) {
   return false;
 }
 
-absl::StatusOr<Token> Scanner::PopComment(const Pos& start_pos) {
-  std::string chars;
-  while (!AtCharEof()) {
-    char c = PopChar();
-    chars.append(1, c);
-    if (c == '\n') {
-      break;
+static bool IsWhitespace(char c) {
+  switch (c) {
+    case ' ':
+    case '\r':
+    case '\n':
+    case '\t':
+    case '\xa0':
+      return true;
+    default:
+      return false;
+  }
+}
+
+void Scanner::DropWhitespace() {
+  // Whitespace runs (e.g. indentation) are walked directly over the text,
+  // avoiding the per-character bounds checks of PopChar().
+  for (; index_ < text_.size() && IsWhitespace(text_[index_]); ++index_) {
+    if (text_[index_] == '\n') {
+      lineno_ += 1;
+      colno_ = 0;
+    } else {
+      colno_ += 1;
     }
   }
-  return Token(TokenKind::kComment, Span(start_pos, GetPos()), chars);
+}
+
+void Scanner::DropThroughEndOfLine() {
+  // Comments can be long, so find the newline with a (vectorized) string
+  // search rather than popping characters one at a time.
+  size_t newline = text_.find('\n', index_);
+  if (newline == std::string::npos) {
+    colno_ += text_.size() - index_;
+    index_ = text_.size();
+    return;
+  }
+  index_ = newline + 1;
+  lineno_ += 1;
+  colno_ = 0;
+}
+
+absl::StatusOr<Token> Scanner::PopComment(const Pos& start_pos) {
+  int64_t start = index_;
+  DropThroughEndOfLine();
+  return Token(TokenKind::kComment, Span(start_pos, GetPos()),
+               text_.substr(start, index_ - start));
 }
 
 absl::StatusOr<Token> Scanner::PopWhitespace(const Pos& start_pos) {
   XLS_CHECK(AtWhitespace());
-  std::string chars;
-  while (!AtCharEof() && AtWhitespace()) {
-    chars.append(1, PopChar());
-  }
-  return Token(TokenKind::kWhitespace, Span(start_pos, GetPos()), chars);
+  int64_t start = index_;
+  DropWhitespace();
+  return Token(TokenKind::kWhitespace, Span(start_pos, GetPos()),
+               text_.substr(start, index_ - start));
 }
 
 // This is too simple to need to return absl::Status. Just never call it
@@ -355,30 +390,15 @@ absl::StatusOr<Token> Scanner::ScanNumber(char startc, const Pos& start_pos) {
   return Token(TokenKind::kNumber, Span(start_pos, GetPos()), s);
 }
 
-bool Scanner::AtWhitespace() const {
-  switch (PeekChar()) {
-    case ' ':
-    case '\r':
-    case '\n':
-    case '\t':
-    case '\xa0':
-      return true;
-    default:
-      return false;
-  }
-}
+bool Scanner::AtWhitespace() const { return IsWhitespace(PeekChar()); }
 
 void Scanner::DropCommentsAndLeadingWhitespace() {
   while (!AtCharEof()) {
     if (AtWhitespace()) {
-      DropChar();
+      DropWhitespace();
     } else if (PeekChar() == '/' && PeekChar2OrNull() == '/') {
       DropChar(2);  // Get rid of leading "//"
-      while (!AtCharEof()) {
-        if (PopChar() == '\n') {
-          break;
-        }
-      }
+      DropThroughEndOfLine();
     } else {
       break;
     }
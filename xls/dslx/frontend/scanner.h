@@ -55,6 +55,7 @@ class Scanner {
   Scanner(std::string filename, std::string text,
           bool include_whitespace_and_comments = false)
       : filename_(std::move(filename)),
+        fileno_(GetFileno(filename_)),
         text_(std::move(text)),
         include_whitespace_and_comments_(include_whitespace_and_comments) {}
 
@@ -65,7 +66,7 @@ class Scanner {
   // TODO(leary): 2020-09-08 Attempt to privatize this, ideally consumers would
   // only care about the positions of tokens, not of the scanner itself.
   Pos GetPos() const {
-    return Pos(filename_, lineno_, colno_);
+    return Pos(fileno_, lineno_, colno_);
   }
 
   // Pops a token from the current position in the character stream, or returns
@@ -125,18 +126,24 @@ class Scanner {
   absl::StatusOr<Token> ScanChar(const Pos& start_pos);
 
   // Scans from the current position until ftake returns false or EOF is
-  // reached.
-  std::string ScanWhile(std::string s, const std::function<bool(char)>& ftake) {
-    while (!AtCharEof()) {
-      char peek = PeekChar();
-      if (!ftake(peek)) {
-        break;
-      }
-      s.append(1, PopChar());
+  // reached, and returns the scanned characters appended to `s`.
+  //
+  // The run is sliced out of the text in one go rather than popped a character
+  // at a time, so ftake must not accept newlines (which would require updating
+  // the line number).
+  template <typename F>
+  std::string ScanWhile(std::string s, F ftake) {
+    int64_t start = index_;
+    while (index_ < text_.size() && ftake(text_[index_])) {
+      XLS_DCHECK_NE(text_[index_], '\n');
+      ++index_;
     }
+    colno_ += index_ - start;
+    s.append(text_, start, index_ - start);
     return s;
   }
-  std::string ScanWhile(char c, const std::function<bool(char)>& ftake) {
+  template <typename F>
+  std::string ScanWhile(char c, F ftake) {
     return ScanWhile(std::string(1, c), ftake);
   }
 
@@ -160,6 +167,13 @@ class Scanner {
   // whitespace character.
   bool AtWhitespace() const;
 
+  // Drops the whitespace characters from the current position.
+  void DropWhitespace();
+
+  // Drops the characters from the current position up to and including the
+  // next newline, or to the end of the character stream if there is none.
+  void DropThroughEndOfLine();
+
   // Returns whether the input character stream has been exhausted.
   bool AtCharEof() const {
     XLS_CHECK_LE(index_, text_.size());
@@ -234,6 +248,7 @@ class Scanner {
   absl::StatusOr<std::string> ProcessNextStringChar();
 
   std::string filename_;
+  Fileno fileno_;  // Of filename_, looked up once for all positions.
   std::string text_;
   bool include_whitespace_and_comments_;
   int64_t index_ = 0;
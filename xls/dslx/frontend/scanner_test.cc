@@ -248,6 +248,21 @@ TEST(ScannerTest, WhitespaceAndCommentsMode) {
   EXPECT_EQ(tokens[4].kind(), TokenKind::kComment);
 }
 
+TEST(ScannerTest, PositionsAfterWhitespaceAndComments) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Token> tokens, ToTokens(R"(  foo // a
+    // b
+
+bar_baz 0x1f // trailing)"));
+  ASSERT_EQ(tokens.size(), 3);
+  EXPECT_EQ(tokens[0].span(),
+            Span(Pos("fake_file.x", 0, 2), Pos("fake_file.x", 0, 5)));
+  EXPECT_EQ(tokens[1].span(),
+            Span(Pos("fake_file.x", 3, 0), Pos("fake_file.x", 3, 7)));
+  EXPECT_EQ(tokens[2].span(),
+            Span(Pos("fake_file.x", 3, 8), Pos("fake_file.x", 3, 12)));
+  EXPECT_TRUE(tokens[2].IsNumber("0x1f"));
+}
+
 TEST(ScannerTest, PopSeveral) {
   Scanner s("fake_file.x", "[!](-)");
   std::vector<TokenKind> expected = {
@@ -16,6 +16,7 @@
 
 #include <filesystem>  // NOLINT
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -29,6 +30,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/dslx/errors.h"
@@ -43,6 +45,7 @@ namespace xls::dslx {
 }
 
 absl::StatusOr<ModuleInfo*> ImportData::Get(const ImportTokens& subject) {
+  absl::MutexLock lock(modules_mutex_.get());
   auto it = modules_.find(subject);
   if (it == modules_.end()) {
     return absl::NotFoundError("Module information was not found for import " +
@@ -54,6 +57,7 @@ absl::StatusOr<ModuleInfo*> ImportData::Get(const ImportTokens& subject) {
 absl::StatusOr<ModuleInfo*> ImportData::Put(
     const ImportTokens& subject, std::unique_ptr<ModuleInfo> module_info) {
   auto* pmodule_info = module_info.get();
+  absl::MutexLock lock(modules_mutex_.get());
   auto [it, inserted] = modules_.emplace(subject, std::move(module_info));
   if (!inserted) {
     return absl::InvalidArgumentError(
@@ -63,6 +67,34 @@ absl::StatusOr<ModuleInfo*> ImportData::Put(
   return pmodule_info;
 }
 
+bool ImportData::PutPrefetched(const ImportTokens& subject,
+                               ParsedModule parsed) {
+  absl::MutexLock lock(modules_mutex_.get());
+  if (modules_.contains(subject)) {
+    return false;
+  }
+  return prefetched_.emplace(subject, std::move(parsed)).second;
+}
+
+std::optional<ParsedModule> ImportData::TakePrefetched(
+    const ImportTokens& subject) {
+  absl::MutexLock lock(modules_mutex_.get());
+  auto it = prefetched_.find(subject);
+  if (it == prefetched_.end()) {
+    return std::nullopt;
+  }
+  ParsedModule parsed = std::move(it->second);
+  prefetched_.erase(it);
+  return parsed;
+}
+
+const ParsedModule* ImportData::GetPrefetched(
+    const ImportTokens& subject) const {
+  absl::MutexLock lock(modules_mutex_.get());
+  auto it = prefetched_.find(subject);
+  return it == prefetched_.end() ? nullptr : &it->second;
+}
+
 absl::StatusOr<TypeInfo*> ImportData::GetRootTypeInfoForNode(
     const AstNode* node) {
   XLS_RET_CHECK(node != nullptr);
@@ -132,6 +164,7 @@ absl::StatusOr<const StructDef*> ImportData::FindStructDef(
 }
 
 absl::StatusOr<const Module*> ImportData::FindModule(const Span& span) const {
+  absl::MutexLock lock(modules_mutex_.get());
   auto it = path_to_module_info_.find(span.filename());
   if (it == path_to_module_info_.end()) {
     std::vector<std::string> paths;
@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -27,6 +28,7 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/dslx/bytecode/bytecode_cache_interface.h"
 #include "xls/dslx/frontend/ast.h"
@@ -101,15 +103,27 @@ class ImportTokens {
   std::vector<std::string> pieces_;
 };
 
+// A module which has been located and parsed ahead of being imported (see
+// PrefetchImports in import_routines.h) but not yet typechecked.
+struct ParsedModule {
+  std::unique_ptr<Module> module;
+  std::filesystem::path path;
+};
+
 // Wrapper around a {subject: module_info} mapping that modules can be imported
 // into.
 // Use the routines in create_import_data.h to instantiate an object.
+//
+// Registration and lookup of modules (Contains, Get, Put and the prefetched
+// module routines) are thread-safe; the remaining state is only used by the
+// (single-threaded) typechecker and interpreter.
 class ImportData {
  public:
   // All instantiations of ImportData should pass a stdlib_path as below.
   ImportData() = delete;
 
   bool Contains(const ImportTokens& target) const {
+    absl::MutexLock lock(modules_mutex_.get());
     return modules_.find(target) != modules_.end();
   }
 
@@ -130,6 +144,17 @@ class ImportData {
   absl::StatusOr<ModuleInfo*> Put(const ImportTokens& subject,
                                   std::unique_ptr<ModuleInfo> module_info);
 
+  // Notes a parsed (but not yet typechecked) module for `subject`. Returns
+  // false, dropping `parsed`, if the subject is already imported or prefetched.
+  bool PutPrefetched(const ImportTokens& subject, ParsedModule parsed);
+
+  // Removes and returns the prefetched module for `subject`, if any.
+  std::optional<ParsedModule> TakePrefetched(const ImportTokens& subject);
+
+  // Returns the prefetched module for `subject` without removing it, or nullptr
+  // if there is none. The result is invalidated by TakePrefetched.
+  const ParsedModule* GetPrefetched(const ImportTokens& subject) const;
+
   TypeInfoOwner& type_info_owner() { return type_info_owner_; }
 
   // Helper that gets the "root" type information for the module of the given
@@ -221,8 +246,12 @@ class ImportData {
   // module is not available.
   absl::StatusOr<const Module*> FindModule(const Span& span) const;
 
+  // Guards modules_, path_to_module_info_ and prefetched_. Held by pointer so
+  // that ImportData remains movable.
+  std::unique_ptr<absl::Mutex> modules_mutex_ = std::make_unique<absl::Mutex>();
   absl::flat_hash_map<ImportTokens, std::unique_ptr<ModuleInfo>> modules_;
   absl::flat_hash_map<std::string, ModuleInfo*> path_to_module_info_;
+  absl::flat_hash_map<ImportTokens, ParsedModule> prefetched_;
   absl::flat_hash_map<Module*, std::unique_ptr<InterpBindings>>
       top_level_bindings_;
   absl::flat_hash_set<Module*> top_level_bindings_done_;
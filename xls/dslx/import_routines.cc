@@ -14,14 +14,20 @@
 
 #include "xls/dslx/import_routines.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <deque>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <thread>  // NOLINT
 #include <utility>
+#include <variant>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/cleanup/cleanup.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
@@ -29,11 +35,15 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/config/xls_config.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/frontend/parser.h"
 #include "xls/dslx/frontend/scanner.h"
 #include "xls/dslx/import_data.h"
@@ -136,6 +146,53 @@ static absl::StatusOr<std::filesystem::path> FindExistingPath(
                       GetCurrentDirectory().value(), stdlib_path));
 }
 
+namespace {
+
+// Work list of imports for PrefetchImports to locate and parse. Each subject is
+// claimed by the first worker to see it, so every module is parsed at most
+// once even when it is reachable along many paths through the import DAG.
+struct PrefetchWorkList {
+  absl::Mutex mutex;
+  std::deque<std::pair<ImportTokens, Span>> work ABSL_GUARDED_BY(mutex);
+  absl::flat_hash_set<ImportTokens> claimed ABSL_GUARDED_BY(mutex);
+  // Number of subjects popped from `work` whose processing is not finished.
+  int64_t in_progress ABSL_GUARDED_BY(mutex) = 0;
+
+  // Adds the not-yet-seen imports of `module` to the work list.
+  void EnqueueImports(const Module& module, const ImportData* import_data) {
+    absl::MutexLock lock(&mutex);
+    for (const ModuleMember& member : module.top()) {
+      if (std::holds_alternative<Import*>(member)) {
+        Import* import = std::get<Import*>(member);
+        ImportTokens subject(import->subject());
+        if (!import_data->Contains(subject) && claimed.insert(subject).second) {
+          work.emplace_back(std::move(subject), import->span());
+        }
+      }
+    }
+  }
+
+  // True if there is work to do or if no more work can be produced.
+  bool HasWorkOrIsDone() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+    return !work.empty() || in_progress == 0;
+  }
+};
+
+}  // namespace
+
+// Reads and parses the module for `subject` found at `path`.
+static absl::StatusOr<std::unique_ptr<Module>> ParseImport(
+    const ImportTokens& subject, const std::filesystem::path& path) {
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+
+  std::string fully_qualified_name = subject.ToString();
+  XLS_VLOG(3) << "Parsing " << fully_qualified_name << ": start";
+
+  Scanner scanner(path, contents);
+  Parser parser(/*module_name=*/fully_qualified_name, &scanner);
+  return parser.ParseModule();
+}
+
 absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
                                      const ImportTokens& subject,
                                      ImportData* import_data,
@@ -148,29 +205,92 @@ absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
 
   XLS_VLOG(3) << "DoImport (uncached) subject: " << subject.ToString();
 
-  XLS_ASSIGN_OR_RETURN(
-      std::filesystem::path found_path,
-      FindExistingPath(subject, import_data->stdlib_path(),
-                       import_data->additional_search_paths(), import_span));
+  std::optional<ParsedModule> parsed = import_data->TakePrefetched(subject);
+  if (parsed.has_value()) {
+    XLS_VLOG(3) << "Using prefetched module for " << subject.ToString();
+  } else {
+    XLS_ASSIGN_OR_RETURN(
+        std::filesystem::path found_path,
+        FindExistingPath(subject, import_data->stdlib_path(),
+                         import_data->additional_search_paths(), import_span));
+    parsed = ParsedModule{nullptr, std::move(found_path)};
+  }
 
-  XLS_RETURN_IF_ERROR(import_data->AddToImporterStack(import_span, found_path));
+  XLS_RETURN_IF_ERROR(
+      import_data->AddToImporterStack(import_span, parsed->path));
   auto clenaup = absl::MakeCleanup(
       [&] { XLS_CHECK_OK(import_data->PopFromImporterStack(import_span)); });
 
-  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(found_path));
-
-  absl::Span<std::string const> pieces = subject.pieces();
-  std::string fully_qualified_name = absl::StrJoin(pieces, ".");
-  XLS_VLOG(3) << "Parsing and typechecking " << fully_qualified_name
-              << ": start";
+  if (parsed->module == nullptr) {
+    XLS_ASSIGN_OR_RETURN(parsed->module, ParseImport(subject, parsed->path));
+  }
 
-  Scanner scanner(found_path, contents);
-  Parser parser(/*module_name=*/fully_qualified_name, &scanner);
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Module> module, parser.ParseModule());
-  XLS_ASSIGN_OR_RETURN(TypeInfo * type_info, ftypecheck(module.get()));
+  XLS_VLOG(3) << "Typechecking " << subject.ToString() << ": start";
+  XLS_ASSIGN_OR_RETURN(TypeInfo * type_info, ftypecheck(parsed->module.get()));
   return import_data->Put(
-      subject, std::make_unique<ModuleInfo>(std::move(module), type_info,
-                                            std::move(found_path)));
+      subject,
+      std::make_unique<ModuleInfo>(std::move(parsed->module), type_info,
+                                   std::move(parsed->path)));
+}
+
+void PrefetchImports(const Module& module, ImportData* import_data,
+                     int64_t max_threads) {
+  if (max_threads <= 0) {
+    max_threads = std::max<int64_t>(1, std::thread::hardware_concurrency());
+  }
+
+  PrefetchWorkList work_list;
+  work_list.EnqueueImports(module, import_data);
+  {
+    absl::MutexLock lock(&work_list.mutex);
+    if (work_list.work.empty()) {
+      return;
+    }
+  }
+
+  // Failures are dropped here; DoImport redoes the work for any subject that
+  // was not prefetched and reports the error in the usual order.
+  auto worker = [&]() {
+    while (true) {
+      std::optional<std::pair<ImportTokens, Span>> item;
+      {
+        absl::MutexLock lock(&work_list.mutex);
+        work_list.mutex.Await(
+            absl::Condition(&work_list, &PrefetchWorkList::HasWorkOrIsDone));
+        if (work_list.work.empty()) {
+          return;
+        }
+        item = std::move(work_list.work.front());
+        work_list.work.pop_front();
+        ++work_list.in_progress;
+      }
+      const auto& [subject, import_span] = *item;
+      absl::StatusOr<std::filesystem::path> found_path = FindExistingPath(
+          subject, import_data->stdlib_path(),
+          import_data->additional_search_paths(), import_span);
+      absl::StatusOr<std::unique_ptr<Module>> parsed =
+          found_path.ok()
+              ? ParseImport(subject, *found_path)
+              : absl::StatusOr<std::unique_ptr<Module>>(found_path.status());
+      if (parsed.ok()) {
+        work_list.EnqueueImports(**parsed, import_data);
+        import_data->PutPrefetched(
+            subject, ParsedModule{*std::move(parsed), *std::move(found_path)});
+      } else {
+        XLS_VLOG(3) << "Failed to prefetch " << subject.ToString() << ": "
+                    << parsed.status();
+      }
+      absl::MutexLock lock(&work_list.mutex);
+      --work_list.in_progress;
+    }
+  };
+
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(max_threads);
+  for (int64_t i = 0; i < max_threads; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  // Threads are joined on destruction.
 }
 
 }  // namespace xls::dslx
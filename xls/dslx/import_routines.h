@@ -15,6 +15,7 @@
 #ifndef XLS_DSLX_IMPORT_ROUTINES_H_
 #define XLS_DSLX_IMPORT_ROUTINES_H_
 
+#include <cstdint>
 #include <functional>
 
 #include "absl/status/statusor.h"
@@ -49,6 +50,17 @@ absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
                                      ImportData* import_data,
                                      const Span& import_span);
 
+// Locates and parses the modules transitively imported by `module` which are
+// not yet in `import_data`, on up to `max_threads` threads (or one per hardware
+// thread if `max_threads` is not positive). Parsed modules are stashed in
+// `import_data` so that subsequent DoImport calls only need to typecheck them;
+// typechecking itself remains serial as it walks the import DAG depth-first.
+//
+// Errors are not reported here: a module which fails to be located or parsed
+// is simply not prefetched, and DoImport reports the failure as usual.
+void PrefetchImports(const Module& module, ImportData* import_data,
+                     int64_t max_threads = 0);
+
 }  // namespace xls::dslx
 
 #endif  // XLS_DSLX_IMPORT_ROUTINES_H_
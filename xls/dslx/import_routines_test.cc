@@ -0,0 +1,123 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/import_routines.h"
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/warning_kind.h"
+
+namespace xls::dslx {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+constexpr std::string_view kTopText = R"(
+import a
+import b
+
+fn main(x: u32) -> u32 { a::f(x) + b::g(x) }
+)";
+
+// Writes a diamond-shaped import DAG (top -> {a, b} -> c) to `dir`, omitting
+// the bottom module if `with_bottom` is false.
+absl::Status WriteDiamond(const std::filesystem::path& dir,
+                          bool with_bottom = true) {
+  XLS_RETURN_IF_ERROR(SetFileContents(dir / "a.x", R"(
+import c
+pub fn f(x: u32) -> u32 { c::h(x) + u32:1 }
+)"));
+  XLS_RETURN_IF_ERROR(SetFileContents(dir / "b.x", R"(
+import c
+pub fn g(x: u32) -> u32 { c::h(x) + u32:2 }
+)"));
+  if (!with_bottom) {
+    return absl::OkStatus();
+  }
+  return SetFileContents(dir / "c.x", "pub fn h(x: u32) -> u32 { x }\n");
+}
+
+TEST(ImportRoutinesTest, PrefetchParsesImportDag) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK(WriteDiamond(temp_dir.path()));
+  std::vector<std::filesystem::path> search_paths = {temp_dir.path()};
+  ImportData import_data =
+      CreateImportData(kDefaultDslxStdlibPath, search_paths, kAllWarningsSet);
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Module> module,
+                           ParseModule(kTopText, "top.x", "top"));
+  PrefetchImports(*module, &import_data, /*max_threads=*/4);
+
+  // Every module in the DAG was parsed exactly once; none are typechecked.
+  for (const char* name : {"a", "b", "c"}) {
+    ImportTokens subject({name});
+    EXPECT_FALSE(import_data.Contains(subject));
+    std::optional<ParsedModule> parsed = import_data.TakePrefetched(subject);
+    ASSERT_TRUE(parsed.has_value()) << name;
+    EXPECT_EQ(parsed->module->name(), name);
+    EXPECT_EQ(parsed->path, temp_dir.path() / absl::StrCat(name, ".x"));
+    EXPECT_FALSE(import_data.TakePrefetched(subject).has_value());
+  }
+}
+
+TEST(ImportRoutinesTest, TypecheckWithPrefetchedImports) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK(WriteDiamond(temp_dir.path()));
+  std::vector<std::filesystem::path> search_paths = {temp_dir.path()};
+  ImportData import_data =
+      CreateImportData(kDefaultDslxStdlibPath, search_paths, kAllWarningsSet);
+
+  XLS_ASSERT_OK(
+      ParseAndTypecheck(kTopText, "top.x", "top", &import_data).status());
+  for (const char* name : {"a", "b", "c"}) {
+    ImportTokens subject({name});
+    EXPECT_TRUE(import_data.Contains(subject)) << name;
+    EXPECT_FALSE(import_data.TakePrefetched(subject).has_value()) << name;
+  }
+}
+
+TEST(ImportRoutinesTest, MissingImportIsReportedByTypecheck) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK(WriteDiamond(temp_dir.path(), /*with_bottom=*/false));
+  std::vector<std::filesystem::path> search_paths = {temp_dir.path()};
+  ImportData import_data =
+      CreateImportData(kDefaultDslxStdlibPath, search_paths, kAllWarningsSet);
+
+  EXPECT_THAT(
+      ParseAndTypecheck(kTopText, "top.x", "top", &import_data).status(),
+      StatusIs(absl::StatusCode::kNotFound,
+               HasSubstr("Could not find DSLX file for import")));
+}
+
+}  // namespace
+}  // namespace xls::dslx
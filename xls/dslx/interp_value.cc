@@ -85,6 +85,18 @@ std::string TagToString(InterpValueTag tag) {
                          static_cast<int64_t>(tag));
 }
 
+InterpValue::Elements::Elements(std::vector<InterpValue> values) {
+  if (values.empty()) {
+    // Empty tuples (unit values) are common; share a single empty vector.
+    static const auto* kEmpty =
+        new std::shared_ptr<const std::vector<InterpValue>>(
+            std::make_shared<const std::vector<InterpValue>>());
+    values_ = *kEmpty;
+    return;
+  }
+  values_ = std::make_shared<const std::vector<InterpValue>>(std::move(values));
+}
+
 /* static */ InterpValue InterpValue::MakeTuple(
     std::vector<InterpValue> members) {
   return InterpValue{InterpValueTag::kTuple, std::move(members)};
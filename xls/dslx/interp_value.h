@@ -353,13 +353,13 @@ class InterpValue {
   InterpValueTag tag() const { return tag_; }
 
   absl::StatusOr<const std::vector<InterpValue>*> GetValues() const {
-    if (!std::holds_alternative<std::vector<InterpValue>>(payload_)) {
+    if (!std::holds_alternative<Elements>(payload_)) {
       return absl::InvalidArgumentError("Value does not hold element values");
     }
-    return &std::get<std::vector<InterpValue>>(payload_);
+    return &std::get<Elements>(payload_).values();
   }
   const std::vector<InterpValue>& GetValuesOrDie() const {
-    return std::get<std::vector<InterpValue>>(payload_);
+    return std::get<Elements>(payload_).values();
   }
   absl::StatusOr<const FnData*> GetFunction() const {
     if (!std::holds_alternative<FnData>(payload_)) {
@@ -401,7 +401,7 @@ class InterpValue {
   }
 
   bool HasValues() const {
-    return std::holds_alternative<std::vector<InterpValue>>(payload_);
+    return std::holds_alternative<Elements>(payload_);
   }
 
   bool IsToken() const { return tag_ == InterpValueTag::kToken; }
@@ -454,14 +454,29 @@ class InterpValue {
   absl::StatusOr<std::string> ToEnumString(
       const EnumFormatDescriptor& fmt_desc) const;
 
+  // Immutable element storage for tuples and arrays, shared between copies so
+  // that copying an aggregate value (as the bytecode interpreter does for
+  // loads, dups and the members of new tuples and arrays) only copies a
+  // reference rather than every element. Operations which produce a modified
+  // aggregate build a new vector.
+  class Elements {
+   public:
+    Elements(std::vector<InterpValue> values);  // NOLINT: converts implicitly.
+
+    const std::vector<InterpValue>& values() const { return *values_; }
+
+   private:
+    std::shared_ptr<const std::vector<InterpValue>> values_;
+  };
+
   // Note: currently InterpValues are not scoped to a lifetime, so we use a
   // shared_ptr for referring to token data for identity purposes.
   //
   // TODO(leary): 2020-02-10 When all Python bindings are eliminated we can more
   // easily make an interpreter scoped lifetime that InterpValues can live in.
-  using Payload =
-      std::variant<Bits, EnumData, std::vector<InterpValue>, FnData,
-                   std::shared_ptr<TokenData>, std::shared_ptr<Channel>>;
+  using Payload = std::variant<Bits, EnumData, Elements, FnData,
+                               std::shared_ptr<TokenData>,
+                               std::shared_ptr<Channel>>;
 
   InterpValue(InterpValueTag tag, Payload payload)
       : tag_(tag), payload_(std::move(payload)) {}
@@ -244,5 +244,27 @@ TEST(InterpValueTest, FormatNestedStructViaDescriptor) {
 })");
 }
 
+TEST(InterpValueTest, CopiesShareElements) {
+  XLS_ASSERT_OK_AND_ASSIGN(InterpValue array,
+                           InterpValue::MakeArray({InterpValue::MakeU32(1),
+                                                   InterpValue::MakeU32(2)}));
+  InterpValue copy = array;
+  EXPECT_EQ(&array.GetValuesOrDie(), &copy.GetValuesOrDie());
+
+  // Updating a copy leaves the original unchanged.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpValue updated,
+      copy.Update(InterpValue::MakeU32(0), InterpValue::MakeU32(42)));
+  EXPECT_TRUE(updated.Eq(InterpValue::MakeArray({InterpValue::MakeU32(42),
+                                                 InterpValue::MakeU32(2)})
+                             .value()));
+  EXPECT_TRUE(array.Eq(copy));
+  EXPECT_EQ(array.GetValuesOrDie()[0].GetBitValueUnsigned().value(), 1);
+
+  // Unit values share a single allocation.
+  EXPECT_EQ(&InterpValue::MakeUnit().GetValuesOrDie(),
+            &InterpValue::MakeTuple({}).GetValuesOrDie());
+}
+
 }  // namespace
 }  // namespace xls::dslx
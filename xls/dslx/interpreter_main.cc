@@ -69,6 +69,16 @@ ABSL_FLAG(bool, trace_channels, false,
 ABSL_FLAG(int64_t, max_ticks, 100000,
           "If non-zero, the maximum number of ticks to execute on any proc. If "
           "exceeded an error is returned.");
+ABSL_FLAG(int64_t, test_threads, 1,
+          "Number of threads on which to run unit tests and quickcheck samples "
+          "concurrently; test output is buffered and printed in test order.");
+ABSL_FLAG(bool, jit_test_procs, false,
+          "If true, test procs are converted to IR and run on the JIT proc "
+          "runtime rather than the DSLX bytecode interpreter.");
+ABSL_FLAG(int64_t, proc_threads, 1,
+          "Number of threads on which to run the procs of a test proc network; "
+          "trace messages of different procs may then interleave "
+          "differently.");
 // LINT.ThenChange(//xls/build_rules/xls_dslx_rules.bzl)
 
 namespace xls::dslx {
@@ -119,7 +129,13 @@ absl::StatusOr<TestResult> RealMain(std::string_view entry_module_path,
                                  .warnings_as_errors = warnings_as_errors,
                                  .warnings = warnings,
                                  .trace_channels = trace_channels,
-                                 .max_ticks = max_ticks};
+                                 .max_ticks = max_ticks,
+                                 .test_threads =
+                                     absl::GetFlag(FLAGS_test_threads),
+                                 .jit_test_procs =
+                                     absl::GetFlag(FLAGS_jit_test_procs),
+                                 .proc_threads =
+                                     absl::GetFlag(FLAGS_proc_threads)};
   XLS_ASSIGN_OR_RETURN(
       TestResult test_result,
       ParseAndTest(program, module_name, entry_module_path, options));
@@ -41,6 +41,12 @@ struct ConvertOptions {
   //
   // Note that this is only used in IR conversion routines that do typechecking.
   WarningKindSet enabled_warnings = kAllWarningsSet;
+
+  // Whether a parametric instantiation whose IR comes out identical to an
+  // earlier instantiation of the same function (e.g. because it only differs
+  // in parametrics the body does not depend on) should call that function
+  // instead of being emitted as a separate IR function.
+  bool share_instantiations = false;
 };
 
 }  // namespace xls::dslx
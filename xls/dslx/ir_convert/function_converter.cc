@@ -1426,6 +1426,15 @@ absl::StatusOr<BValue> FunctionConverter::DefMapWithBuiltin(
   });
 }
 
+absl::StatusOr<xls::Function*> FunctionConverter::GetConvertedFunction(
+    std::string_view mangled_name) {
+  auto it = package_data_.shared_instantiations.find(mangled_name);
+  if (it != package_data_.shared_instantiations.end()) {
+    return it->second;
+  }
+  return package()->GetFunction(mangled_name);
+}
+
 absl::StatusOr<BValue> FunctionConverter::HandleMap(const Invocation* node) {
   for (Expr* arg : node->args().subspan(0, node->args().size() - 1)) {
     XLS_RETURN_IF_ERROR(Visit(arg));
@@ -1468,7 +1477,7 @@ absl::StatusOr<BValue> FunctionConverter::HandleMap(const Invocation* node) {
                      free_set, node_parametric_env.value()));
   XLS_VLOG(5) << "Getting function with mangled name: " << mangled_name
               << " from package: " << package()->name();
-  XLS_ASSIGN_OR_RETURN(xls::Function * f, package()->GetFunction(mangled_name));
+  XLS_ASSIGN_OR_RETURN(xls::Function * f, GetConvertedFunction(mangled_name));
   return Def(node, [&](const SourceInfo& loc) -> BValue {
     return function_builder_->Map(arg, f, loc);
   });
@@ -1722,9 +1731,9 @@ absl::Status FunctionConverter::HandleInvocation(const Invocation* node) {
     return values;
   };
 
-  if (package()->HasFunctionWithName(called_name)) {
-    XLS_ASSIGN_OR_RETURN(xls::Function * f,
-                         package()->GetFunction(called_name));
+  if (package()->HasFunctionWithName(called_name) ||
+      package_data_.shared_instantiations.contains(called_name)) {
+    XLS_ASSIGN_OR_RETURN(xls::Function * f, GetConvertedFunction(called_name));
     XLS_ASSIGN_OR_RETURN(std::vector<BValue> args, accept_args());
     return HandleUdfInvocation(node, f, std::move(args));
   }
@@ -2197,6 +2206,23 @@ absl::Status FunctionConverter::HandleFunction(
   XLS_VLOG(5) << "Built function: " << f->name();
   XLS_RETURN_IF_ERROR(VerifyFunction(f));
 
+  // Note: foreign function data is not compared by IsDefinitelyEqualTo, so
+  // instantiations carrying it are never shared.
+  if (options_.share_instantiations && node->IsParametric() && !is_top_ &&
+      !f->ForeignFunctionData().has_value()) {
+    std::vector<xls::Function*>& instantiations =
+        package_data_.instantiations[node];
+    for (xls::Function* instantiation : instantiations) {
+      if (f->IsDefinitelyEqualTo(instantiation)) {
+        XLS_VLOG(3) << "Instantiation " << f->name() << " shares "
+                    << instantiation->name();
+        package_data_.shared_instantiations[mangled_name] = instantiation;
+        return package()->RemoveFunction(f);
+      }
+    }
+    instantiations.push_back(f);
+  }
+
   // If it's a public fallible function, or it's the entry function for the
   // package, we make a wrapper so that the external world (e.g. JIT, verilog
   // module) doesn't need to take implicit token arguments.
@@ -82,6 +82,13 @@ struct PackageData {
   Package* package;
   absl::flat_hash_map<xls::FunctionBase*, dslx::Function*> ir_to_dslx;
   absl::flat_hash_set<xls::Function*> wrappers;
+  // IR functions converted from each parametric DSLX function, see
+  // ConvertOptions::share_instantiations.
+  absl::flat_hash_map<dslx::Function*, std::vector<xls::Function*>>
+      instantiations;
+  // Mangled names of instantiations which were not emitted because their IR
+  // was identical to that of the function they map to.
+  absl::flat_hash_map<std::string, xls::Function*> shared_instantiations;
 };
 
 // A function that creates/returns a predicate value -- since this is used
@@ -355,6 +362,11 @@ class FunctionConverter {
   //   The XLS (IR) Value containing the result.
   absl::StatusOr<Value> EvaluateConstFunction(const Invocation* node);
 
+  // Returns the IR function converted under the given mangled name, or the
+  // function it shares if the instantiation was not emitted.
+  absl::StatusOr<xls::Function*> GetConvertedFunction(
+      std::string_view mangled_name);
+
   absl::StatusOr<BValue> HandleMap(const Invocation* node);
 
   absl::StatusOr<BValue> HandleFail(const Invocation* node);
@@ -43,6 +43,7 @@
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/trace.h"
 #include "xls/dslx/command_line_utils.h"
 #include "xls/dslx/constexpr_evaluator.h"
 #include "xls/dslx/create_import_data.h"
@@ -314,6 +315,7 @@ absl::Status ConvertCallGraph(absl::Span<const ConversionRecord> order,
 absl::Status ConvertModuleIntoPackage(Module* module, ImportData* import_data,
                                       const ConvertOptions& options,
                                       Package* package) {
+  ScopedTrace trace("ConvertModuleIntoPackage", "dslx");
   XLS_ASSIGN_OR_RETURN(TypeInfo * root_type_info,
                        import_data->GetRootTypeInfo(module));
   XLS_ASSIGN_OR_RETURN(std::vector<ConversionRecord> order,
@@ -377,6 +379,14 @@ absl::Status ConvertOneFunctionIntoPackage(Module* module,
         module, proc_or.value(), import_data, parametric_env, options, package);
   }
 
+  absl::StatusOr<TestProc*> test_proc_or =
+      module->GetTestProc(entry_function_name);
+  if (test_proc_or.ok()) {
+    return ConvertOneFunctionIntoPackageInternal(
+        module, test_proc_or.value()->proc(), import_data, parametric_env,
+        options, package);
+  }
+
   return absl::InvalidArgumentError(
       absl::StrFormat("Entry \"%s\" is not present in "
                       "DSLX module %s as a Function or a Proc.",
@@ -62,7 +62,9 @@ absl::StatusOr<std::string> ConvertModule(Module* module,
 //
 // Args:
 //   module: Module we're converting a function within.
-//   entry_function_name: Entry function used as the root for conversion.
+//   entry_function_name: Entry function used as the root for conversion. This
+//     may also name a proc or a test proc, in which case its network is
+//     converted with the proc as top.
 //   import_data: The import data for typechecking, etc.
 //   parametric_env: Parametric bindings to use during conversion, if this
 //     function is parametric.
@@ -59,6 +59,9 @@ ABSL_FLAG(std::string, disable_warnings, "",
           "recommended, but can be used in exceptional circumstances");
 ABSL_FLAG(bool, warnings_as_errors, true,
           "Whether to fail early, as an error, if warnings are detected");
+ABSL_FLAG(bool, share_instantiations, false,
+          "If true, parametric instantiations which convert to identical IR "
+          "share a single IR function.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
 
 namespace xls::dslx {
@@ -95,6 +98,7 @@ absl::Status RealMain(absl::Span<const std::string_view> paths,
       .verify_ir = verify_ir,
       .warnings_as_errors = warnings_as_errors,
       .enabled_warnings = enabled_warnings,
+      .share_instantiations = absl::GetFlag(FLAGS_share_instantiations),
   };
 
   // The following checks are performed inside ConvertFilesToPackage(), but we
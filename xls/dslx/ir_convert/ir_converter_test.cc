@@ -20,15 +20,19 @@
 
 #include "xls/dslx/ir_convert/ir_converter.h"
 
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
 #include "xls/common/golden_files.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/matchers.h"
@@ -551,6 +555,39 @@ fn main(x: u8) -> u8 {
   ExpectIr(converted, TestName());
 }
 
+TEST(IrConverterTest, ShareIdenticalParametricInstantiations) {
+  const char* program =
+      R"(
+fn id<N: u32, UNUSED: u32>(x: bits[N]) -> bits[N] { x }
+
+fn add<N: u32>(x: u8) -> u8 { x + (N as u8) }
+
+fn main(x: u8) -> u8 {
+  id<u32:8, u32:1>(x) + id<u32:8, u32:2>(x) + add<u32:1>(x) + add<u32:2>(x)
+}
+)";
+  auto count_functions = [](std::string_view ir, std::string_view prefix) {
+    std::vector<std::string_view> pieces =
+        absl::StrSplit(ir, absl::StrCat("fn ", prefix));
+    return static_cast<int64_t>(pieces.size()) - 1;
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string unshared,
+      ConvertModuleForTest(program, ConvertOptions{.emit_positions = false}));
+  EXPECT_EQ(count_functions(unshared, "__test_module__id__"), 2);
+  EXPECT_EQ(count_functions(unshared, "__test_module__add__"), 2);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string shared,
+      ConvertModuleForTest(program,
+                           ConvertOptions{.emit_positions = false,
+                                          .share_instantiations = true}));
+  // The instantiations of `id` only differ in a parametric the body does not
+  // use, while those of `add` differ in a literal.
+  EXPECT_EQ(count_functions(shared, "__test_module__id__"), 1);
+  EXPECT_EQ(count_functions(shared, "__test_module__add__"), 2);
+}
+
 TEST(IrConverterTest, MatchUnderLet) {
   const char* program =
       R"(
@@ -15,13 +15,15 @@
 // Very simple language server for dslx that
 //  - keeps track of open files and updates them whenever they are
 //    changed in the editor (hidden under the hood).
-//  - On every change, attempts to parse and send back diagnostics
-//    on errors/warnings.
+//  - Once changes settle (no input for --debounce_ms), attempts to parse
+//    and send back diagnostics on errors/warnings.
 //
 // Heavily commented below as this serves as a sample.
 
+#include <poll.h>
 #include <unistd.h>
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <iostream>
 #include <ostream>
@@ -30,7 +32,9 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/btree_set.h"
 #include "absl/flags/flag.h"
+#include "absl/time/time.h"
 #include "external/verible/common/lsp/json-rpc-dispatcher.h"
 #include "external/verible/common/lsp/lsp-protocol.h"
 #include "external/verible/common/lsp/lsp-text-buffer.h"
@@ -39,6 +43,8 @@
 #include "xls/common/init_xls.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
 #include "xls/dslx/lsp/language_server_adapter.h"
+#include "xls/dslx/lsp/lsp_type_utils.h"
+#include "xls/dslx/lsp/workspace_symbol_index.h"
 
 ABSL_FLAG(std::string, stdlib_path, xls::kDefaultDslxStdlibPath,
           "Path to DSLX standard library files.");
@@ -48,6 +54,16 @@ ABSL_FLAG(std::string, dslx_path,
           getenv(kDslxPath) != nullptr ? getenv(kDslxPath) : "",
           "Additional paths to search for modules (colon delimited).");
 
+ABSL_FLAG(int64_t, debounce_ms, 50,
+          "Milliseconds without further input after a buffer change before "
+          "the buffer is reparsed and diagnostics are published. Edits which "
+          "arrive within this window supersede the pending parse.");
+
+ABSL_FLAG(bool, index_workspace, true,
+          "Index the DSLX files under the --dslx_path directories on a "
+          "background thread to answer cross-file definition, reference and "
+          "workspace symbol queries.");
+
 namespace xls::dslx {
 namespace {
 
@@ -72,6 +88,8 @@ InitializeResult InitializeServer(const nlohmann::json& params) {
       {"linkSupport", true},
   };
   capabilities["documentRangeFormattingProvider"] = true;
+  capabilities["referencesProvider"] = true;
+  capabilities["workspaceSymbolProvider"] = true;
   return InitializeResult{
       .capabilities = std::move(capabilities),
       .serverInfo =
@@ -98,6 +116,14 @@ void TextChangeHandler(const std::string& file_uri,
   dispatcher.SendNotification("textDocument/publishDiagnostics", params);
 }
 
+// Returns true if there is input to read on stdin within `timeout`. Errors
+// count as pending input so that the subsequent read surfaces them.
+bool InputPendingWithin(absl::Duration timeout) {
+  pollfd fd{.fd = STDIN_FILENO, .events = POLLIN, .revents = 0};
+  int timeout_ms = static_cast<int>(absl::ToInt64Milliseconds(timeout));
+  return poll(&fd, /*nfds=*/1, timeout_ms) != 0;
+}
+
 absl::Status RealMain() {
   const std::string stdlib_path = absl::GetFlag(FLAGS_stdlib_path);
   const std::string dslx_path = absl::GetFlag(FLAGS_dslx_path);
@@ -111,6 +137,15 @@ absl::Status RealMain() {
 
   // Adapter that interfaces between dslx parsing and LSP
   LanguageServerAdapter language_server_adapter(stdlib_path, dslx_paths);
+  if (absl::GetFlag(FLAGS_index_workspace)) {
+    std::vector<fs::path> index_roots;
+    for (const fs::path& path : dslx_paths) {
+      if (!path.empty()) {
+        index_roots.push_back(path);
+      }
+    }
+    language_server_adapter.StartWorkspaceIndexing(std::move(index_roots));
+  }
 
   // The dispatcher receives json rpc requests
   // (https://www.jsonrpc.org/specification) which are passed in
@@ -153,19 +188,31 @@ absl::Status RealMain() {
   BufferCollection buffers(&dispatcher);
 
   // The text buffer collection can call a callback whenever there is a change.
-  // We're using this to hook up our parser that then can send diagnostic
-  // messages back.
+  // Rather than parsing on every keystroke we only note which buffers changed;
+  // they are parsed (and diagnostics sent back) once the editor has been quiet
+  // for the debounce interval, or when a request needs an up-to-date parse.
+  absl::btree_set<std::string> dirty_uris;
   buffers.SetChangeListener(
       [&](const std::string& uri, const EditTextBuffer* buffer) {
         if (buffer == nullptr) {
+          dirty_uris.erase(uri);
           return;  // buffer got deleted. No interest.
         }
-        TextChangeHandler(uri, *buffer, dispatcher, language_server_adapter);
+        dirty_uris.insert(uri);
       });
+  auto flush_dirty_uri = [&](const std::string& uri) {
+    if (dirty_uris.erase(uri) == 0) {
+      return;
+    }
+    if (const EditTextBuffer* buffer = buffers.findBufferByUri(uri)) {
+      TextChangeHandler(uri, *buffer, dispatcher, language_server_adapter);
+    }
+  };
 
   dispatcher.AddRequestHandler(
       "textDocument/documentSymbol",
       [&](const verible::lsp::DocumentSymbolParams& params) {
+        flush_dirty_uri(params.textDocument.uri);
         return language_server_adapter.GenerateDocumentSymbols(
             params.textDocument.uri);
       });
@@ -173,13 +220,39 @@ absl::Status RealMain() {
   dispatcher.AddRequestHandler(
       "textDocument/definition",
       [&](const verible::lsp::DefinitionParams& params) {
+        flush_dirty_uri(params.textDocument.uri);
         return language_server_adapter.FindDefinitions(params.textDocument.uri,
                                                        params.position);
       });
 
+  dispatcher.AddRequestHandler(
+      "textDocument/references",
+      [&](const verible::lsp::ReferenceParams& params) {
+        flush_dirty_uri(params.textDocument.uri);
+        return language_server_adapter.FindReferences(params.textDocument.uri,
+                                                      params.position);
+      });
+
+  dispatcher.AddRequestHandler(
+      "workspace/symbol", [&](const nlohmann::json& params) {
+        nlohmann::json result = nlohmann::json::array();
+        for (const IndexedSymbol& symbol :
+             language_server_adapter.FindWorkspaceSymbols(
+                 params.value("query", ""))) {
+          verible::lsp::Location location =
+              ConvertSpanToLspLocation(symbol.name_span);
+          location.uri = ConvertFilenameToUri(symbol.name_span.filename());
+          result.push_back({{"name", symbol.name},
+                            {"kind", symbol.kind},
+                            {"location", location}});
+        }
+        return result;
+      });
+
   dispatcher.AddRequestHandler(
       "textDocument/rangeFormatting",
       [&](const verible::lsp::DocumentFormattingParams& params) {
+        flush_dirty_uri(params.textDocument.uri);
         auto text_edits_or = language_server_adapter.FormatRange(
             params.textDocument.uri, params.range);
         if (text_edits_or.ok()) {
@@ -191,8 +264,13 @@ absl::Status RealMain() {
       });
 
   // Main loop. Feeding the stream-splitter that then calls the dispatcher.
+  const absl::Duration debounce =
+      absl::Milliseconds(absl::GetFlag(FLAGS_debounce_ms));
   absl::Status status = absl::OkStatus();
   while (status.ok() && !shutdown_requested) {
+    while (!dirty_uris.empty() && !InputPendingWithin(debounce)) {
+      flush_dirty_uri(*dirty_uris.begin());
+    }
     status = stream_splitter.PullFrom([](char* buf, int size) -> int {  //
       return static_cast<int>(read(STDIN_FILENO, buf, size));
     });
@@ -15,16 +15,22 @@
 #include "xls/dslx/lsp/language_server_adapter.h"
 
 #include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <system_error>  // NOLINT
 #include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
 #include "external/verible/common/lsp/lsp-protocol.h"
+#include "xls/common/file/filesystem.h"
 #include "xls/common/indent.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/extract_module_name.h"
 #include "xls/dslx/frontend/ast.h"
@@ -34,6 +40,7 @@
 #include "xls/dslx/lsp/document_symbols.h"
 #include "xls/dslx/lsp/find_definition.h"
 #include "xls/dslx/lsp/lsp_type_utils.h"
+#include "xls/dslx/lsp/workspace_symbol_index.h"
 #include "xls/dslx/parse_and_typecheck.h"
 #include "xls/dslx/warning_collector.h"
 #include "xls/dslx/warning_kind.h"
@@ -78,11 +85,76 @@ LanguageServerAdapter::LanguageServerAdapter(
     const std::vector<std::filesystem::path>& dslx_paths)
     : stdlib_(stdlib),
       dslx_paths_(dslx_paths),
+      index_(std::make_unique<WorkspaceSymbolIndex>()),
       last_parse_data_(absl::FailedPreconditionError(
           "No DSLX file has been parsed yet by the Language Server.")) {}
 
+LanguageServerAdapter::~LanguageServerAdapter() {
+  if (indexing_thread_ != nullptr) {
+    cancel_indexing_.store(true);
+    indexing_thread_->Join();
+  }
+}
+
+void LanguageServerAdapter::StartWorkspaceIndexing(
+    std::vector<std::filesystem::path> roots) {
+  XLS_CHECK(indexing_thread_ == nullptr)
+      << "Workspace indexing was already started";
+  indexing_thread_ = std::make_unique<Thread>(
+      [this, roots = std::move(roots)] { IndexWorkspace(roots); });
+}
+
+void LanguageServerAdapter::IndexWorkspace(
+    const std::vector<std::filesystem::path>& roots) {
+  namespace fs = std::filesystem;
+  const absl::Time start = absl::Now();
+  // A single ImportData is shared by the whole pass so each module imported by
+  // several files is typechecked once.
+  ImportData import_data =
+      CreateImportData(stdlib_, dslx_paths_, kAllWarningsSet);
+  for (const fs::path& root : roots) {
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(
+             root, fs::directory_options::skip_permission_denied, ec);
+         !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+      if (cancel_indexing_.load()) {
+        return;
+      }
+      if (!it->is_regular_file() || it->path().extension() != ".x") {
+        continue;
+      }
+      const std::string path = it->path().string();
+      if (index_->ContainsFile(path)) {
+        continue;
+      }
+      absl::StatusOr<std::string> module_name = ExtractModuleName(path);
+      absl::StatusOr<std::string> contents = GetFileContents(it->path());
+      if (!module_name.ok() || !contents.ok()) {
+        continue;
+      }
+      absl::StatusOr<TypecheckedModule> typechecked_module =
+          ParseAndTypecheck(*contents, path, *module_name, &import_data);
+      if (!typechecked_module.ok()) {
+        XLS_VLOG(1) << "Not indexing " << path << ": "
+                    << typechecked_module.status();
+        continue;
+      }
+      index_->IndexModuleAndImports(*typechecked_module->module, import_data,
+                                    /*replace_existing=*/false);
+    }
+  }
+  LspLog() << "Indexed " << index_->file_count() << " DSLX files in "
+           << absl::Now() - start << "\n";
+}
+
 absl::Status LanguageServerAdapter::Update(std::string_view file_uri,
                                            std::string_view dslx_code) {
+  if (file_uri == last_update_uri_ && dslx_code == last_update_contents_) {
+    return last_parse_data_.status();
+  }
+  last_update_uri_ = std::string{file_uri};
+  last_update_contents_ = std::string{dslx_code};
+
   // TODO(hzeller): remember per file_uri for more sophisticated features.
   ImportData import_data =
       CreateImportData(stdlib_, dslx_paths_, kAllWarningsSet);
@@ -93,6 +165,7 @@ absl::Status LanguageServerAdapter::Update(std::string_view file_uri,
   if (!module_name_or.ok()) {
     LspLog() << "Could not determine module name from file URI: " << file_uri
              << " status: " << module_name_or.status() << "\n";
+    last_update_uri_.clear();
     return absl::OkStatus();
   }
 
@@ -105,6 +178,7 @@ absl::Status LanguageServerAdapter::Update(std::string_view file_uri,
   }
 
   if (typechecked_module_or.ok()) {
+    index_->IndexModuleAndImports(*typechecked_module_or->module, import_data);
     last_parse_data_.emplace(LastParseData{
         std::move(import_data), std::move(typechecked_module_or).value(),
         std::filesystem::path{file_uri}, std::move(contents)});
@@ -152,7 +226,32 @@ std::vector<verible::lsp::Location> LanguageServerAdapter::FindDefinitions(
       return {location};
     }
   }
-  return {};
+  std::vector<verible::lsp::Location> result;
+  for (const IndexedSymbol& symbol : index_->FindDefinitions(pos)) {
+    verible::lsp::Location location =
+        ConvertSpanToLspLocation(symbol.name_span);
+    location.uri = ConvertFilenameToUri(symbol.name_span.filename());
+    result.push_back(std::move(location));
+  }
+  return result;
+}
+
+std::vector<verible::lsp::Location> LanguageServerAdapter::FindReferences(
+    std::string_view uri, const verible::lsp::Position& position) const {
+  const Pos pos = ConvertLspPositionToPos(uri, position);
+  XLS_VLOG(1) << "FindReferences; uri: " << uri << " pos: " << pos;
+  std::vector<verible::lsp::Location> result;
+  for (const Span& span : index_->FindReferences(pos)) {
+    verible::lsp::Location location = ConvertSpanToLspLocation(span);
+    location.uri = ConvertFilenameToUri(span.filename());
+    result.push_back(std::move(location));
+  }
+  return result;
+}
+
+std::vector<IndexedSymbol> LanguageServerAdapter::FindWorkspaceSymbols(
+    std::string_view query) const {
+  return index_->FindSymbols(query);
 }
 
 absl::StatusOr<std::vector<verible::lsp::TextEdit>>
@@ -15,14 +15,18 @@
 #ifndef XLS_DSLX_LSP_LANGAUGE_SERVER_ADAPTER_H_
 #define XLS_DSLX_LSP_LANGAUGE_SERVER_ADAPTER_H_
 
+#include <atomic>
 #include <filesystem>  // NOLINT
 #include <iostream>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <string_view>
 #include <vector>
 
 #include "external/verible/common/lsp/lsp-protocol.h"
+#include "xls/common/thread.h"
+#include "xls/dslx/lsp/workspace_symbol_index.h"
 #include "xls/dslx/parse_and_typecheck.h"
 
 namespace xls::dslx {
@@ -39,8 +43,19 @@ class LanguageServerAdapter {
  public:
   LanguageServerAdapter(std::string_view stdlib,
                         const std::vector<std::filesystem::path>& dslx_paths);
-
-  // Note: this is parsing is triggered for every keystroke. Fine for now.
+  ~LanguageServerAdapter();
+
+  // Starts indexing the DSLX files (`*.x`) under the `roots` directories into
+  // the workspace symbol index on a background thread, so that queries about
+  // files which were not opened are answered from the index. Files already
+  // indexed, e.g. as imports of an updated file, are skipped. May be called at
+  // most once.
+  void StartWorkspaceIndexing(std::vector<std::filesystem::path> roots);
+
+  // Parses and typechecks `dslx_code` as the contents of `file_uri`. Callers
+  // are expected to debounce edits (see dslx_ls.cc), but an update with the
+  // same uri and contents as the previous one is a no-op that returns the
+  // previous status.
   absl::Status Update(std::string_view file_uri, std::string_view dslx_code);
 
   // Generate LSP diagnostics for the last file update.
@@ -52,18 +67,38 @@ class LanguageServerAdapter {
 
   // Note: the return type is slightly unintuitive, but the latest LSP protocol
   // supports multiple defining locations for a single reference.
+  //
+  // Definitions in the file are found from its last successful parse, others
+  // (e.g. of a `module::member` reference) from the workspace symbol index.
   std::vector<verible::lsp::Location> FindDefinitions(
       std::string_view uri, const verible::lsp::Position& position) const;
 
+  // Returns the locations throughout the indexed workspace of the references
+  // to the top-level symbol defined or referenced at `position`.
+  std::vector<verible::lsp::Location> FindReferences(
+      std::string_view uri, const verible::lsp::Position& position) const;
+
+  // Returns the indexed top-level symbols whose names contain `query`.
+  std::vector<IndexedSymbol> FindWorkspaceSymbols(std::string_view query) const;
+
+  const WorkspaceSymbolIndex& index() const { return *index_; }
+
   // Implements the functionality for:
   // https://microsoft.github.io/language-server-protocol/specifications/lsp/3.17/specification/#textDocument_rangeFormatting
   absl::StatusOr<std::vector<verible::lsp::TextEdit>> FormatRange(
       std::string_view uri, const verible::lsp::Range& range) const;
 
  private:
+  // Body of the background indexing thread.
+  void IndexWorkspace(const std::vector<std::filesystem::path>& roots);
+
   const std::string stdlib_;
   const std::vector<std::filesystem::path> dslx_paths_;
 
+  std::unique_ptr<WorkspaceSymbolIndex> index_;
+  std::atomic<bool> cancel_indexing_ = false;
+  std::unique_ptr<Thread> indexing_thread_;
+
   struct LastParseData {
     ImportData import_data;
     TypecheckedModule typechecked_module;
@@ -74,6 +109,11 @@ class LanguageServerAdapter {
   };
 
   absl::StatusOr<LastParseData> last_parse_data_;
+
+  // The arguments of the last call to Update, kept regardless of whether it
+  // succeeded so that unchanged contents are not reparsed.
+  std::string last_update_uri_;
+  std::string last_update_contents_;
 };
 
 }  // namespace xls::dslx
@@ -14,10 +14,14 @@
 
 #include "xls/dslx/lsp/language_server_adapter.h"
 
+#include <string>
 #include <string_view>
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/status/matchers.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
 
@@ -45,6 +49,24 @@ TEST(LanguageServerAdapterTest, TestSingleFunctionModule) {
   ASSERT_EQ(symbols.size(), 1);
 }
 
+TEST(LanguageServerAdapterTest, UnchangedUpdateKeepsLastResult) {
+  LanguageServerAdapter adapter(kDefaultDslxStdlibPath, {"."});
+  constexpr std::string_view kUri = "memfile://test.x";
+  constexpr std::string_view kBroken = "fn f() {";
+  EXPECT_FALSE(adapter.Update(kUri, kBroken).ok());
+  EXPECT_FALSE(adapter.Update(kUri, kBroken).ok());
+  EXPECT_EQ(adapter.GenerateParseDiagnostics(kUri).size(), 1);
+
+  XLS_ASSERT_OK(adapter.Update(kUri, "fn f() { () }"));
+  XLS_ASSERT_OK(adapter.Update(kUri, "fn f() { () }"));
+  EXPECT_EQ(adapter.GenerateParseDiagnostics(kUri).size(), 0);
+  EXPECT_EQ(adapter.GenerateDocumentSymbols(kUri).size(), 1);
+
+  // A different document with the same contents is parsed on its own.
+  XLS_ASSERT_OK(adapter.Update("memfile://other.x", "fn f() { () }"));
+  EXPECT_EQ(adapter.GenerateDocumentSymbols("memfile://other.x").size(), 1);
+}
+
 TEST(LanguageServerAdapterTest, TestFindDefinitionsFunctionRef) {
   LanguageServerAdapter adapter(kDefaultDslxStdlibPath, {"."});
   constexpr std::string_view kUri = "memfile://test.x";
@@ -83,6 +105,31 @@ fn f() -> T { () }
   EXPECT_TRUE(definition_location.range.end == want_end);
 }
 
+TEST(LanguageServerAdapterTest, TestFindDefinitionsAcrossFiles) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK(SetFileContents(temp_dir.path() / "lib.x",
+                                "pub fn double(x: u32) -> u32 { x + x }\n"));
+  LanguageServerAdapter adapter(kDefaultDslxStdlibPath, {temp_dir.path()});
+  const std::string uri =
+      absl::StrCat("file://", (temp_dir.path() / "main.x").string());
+  XLS_ASSERT_OK(adapter.Update(uri, R"(import lib
+fn main(x: u32) -> u32 { lib::double(x) }
+)"));
+
+  // The position of `double` in `lib::double`.
+  verible::lsp::Position position{1, 30};
+  std::vector<verible::lsp::Location> definition_locations =
+      adapter.FindDefinitions(uri, position);
+  ASSERT_EQ(definition_locations.size(), 1);
+  EXPECT_EQ(definition_locations.at(0).uri,
+            absl::StrCat("file://", (temp_dir.path() / "lib.x").string()));
+  const auto want_start = verible::lsp::Position{0, 7};
+  EXPECT_TRUE(definition_locations.at(0).range.start == want_start);
+
+  EXPECT_EQ(adapter.FindReferences(uri, position).size(), 1);
+  EXPECT_EQ(adapter.FindWorkspaceSymbols("dou").size(), 1);
+}
+
 // After we parse an invalid file the language server can still get requests,
 // check that works reasonably.
 TEST(LanguageServerAdapterTest, TestCallAfterInvalidParse) {
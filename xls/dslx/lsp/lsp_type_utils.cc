@@ -14,7 +14,13 @@
 
 #include "xls/dslx/lsp/lsp_type_utils.h"
 
+#include <filesystem>  // NOLINT
+#include <string>
 #include <string_view>
+#include <system_error>  // NOLINT
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 
 namespace xls::dslx {
 
@@ -31,6 +37,18 @@ verible::lsp::Location ConvertSpanToLspLocation(const Span& span) {
   return verible::lsp::Location{.range = ConvertSpanToLspRange(span)};
 }
 
+std::string ConvertFilenameToUri(std::string_view filename) {
+  if (absl::StrContains(filename, "://")) {
+    return std::string{filename};
+  }
+  std::error_code ec;
+  std::filesystem::path path = std::filesystem::absolute(filename, ec);
+  if (ec) {
+    return absl::StrCat("file://", filename);
+  }
+  return absl::StrCat("file://", path.lexically_normal().string());
+}
+
 Pos ConvertLspPositionToPos(std::string_view file_uri,
                             const verible::lsp::Position& position) {
   return Pos(std::string{file_uri}, position.line, position.character);
@@ -17,6 +17,7 @@
 #ifndef XLS_DSLX_LSP_LSP_TYPE_UTILS_H_
 #define XLS_DSLX_LSP_LSP_TYPE_UTILS_H_
 
+#include <string>
 #include <string_view>
 
 #include "external/verible/common/lsp/lsp-protocol.h"
@@ -27,6 +28,11 @@ namespace xls::dslx {
 verible::lsp::Range ConvertSpanToLspRange(const Span& span);
 verible::lsp::Location ConvertSpanToLspLocation(const Span& span);
 
+// Returns the URI of the file named by a DSLX span: filenames which are
+// already URIs (e.g. of documents parsed from the editor's buffers) are
+// returned verbatim, paths become absolute `file://` URIs.
+std::string ConvertFilenameToUri(std::string_view filename);
+
 // Note: DSLX positions have filenames included in them, whereas LSP positions
 // do not -- we need the LSP adapter to handle filename resolution from URIs to
 // handle this in a uniform way, so we assume this will only be used in
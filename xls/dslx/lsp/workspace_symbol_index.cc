@@ -0,0 +1,338 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/lsp/workspace_symbol_index.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/variant.h"
+#include "external/verible/common/lsp/lsp-protocol-enums.h"
+#include "xls/common/visitor.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/frontend/pos.h"
+#include "xls/dslx/import_data.h"
+
+namespace xls::dslx {
+namespace {
+
+// Returns whether `pos` is within `span`. Unlike Span::Contains this compares
+// only lines and columns, as the same file may be known by different names.
+bool SpanContains(const Span& span, const Pos& pos) {
+  auto line_col = [](const Pos& p) {
+    return std::make_pair(p.lineno(), p.colno());
+  };
+  return line_col(span.start()) <= line_col(pos) &&
+         line_col(pos) < line_col(span.limit());
+}
+
+// The name definition and symbol kind of a top-level definition.
+struct Definition {
+  const NameDef* name_def;
+  verible::lsp::SymbolKind kind;
+};
+
+// Returns the definition made by `member`, or std::nullopt for tests, imports
+// and assertions, which define nothing to refer to.
+std::optional<Definition> GetDefinition(const ModuleMember& member) {
+  return absl::visit(
+      Visitor{
+          [](Function* f) -> std::optional<Definition> {
+            return Definition{f->name_def(), verible::lsp::SymbolKind::kMethod};
+          },
+          [](Proc* p) -> std::optional<Definition> {
+            return Definition{p->name_def(), verible::lsp::SymbolKind::kClass};
+          },
+          [](TypeAlias* t) -> std::optional<Definition> {
+            return Definition{t->name_def(),
+                              verible::lsp::SymbolKind::kTypeParameter};
+          },
+          [](StructDef* s) -> std::optional<Definition> {
+            return Definition{s->name_def(), verible::lsp::SymbolKind::kStruct};
+          },
+          [](ConstantDef* c) -> std::optional<Definition> {
+            return Definition{c->name_def(),
+                              verible::lsp::SymbolKind::kConstant};
+          },
+          [](EnumDef* e) -> std::optional<Definition> {
+            return Definition{e->name_def(), verible::lsp::SymbolKind::kEnum};
+          },
+          [](auto*) -> std::optional<Definition> { return std::nullopt; },
+      },
+      member);
+}
+
+// Returns the module imported by `import`, or nullptr if `import_data` does not
+// hold it.
+Module* GetImportedModule(const Import& import, ImportData& import_data) {
+  absl::StatusOr<ModuleInfo*> info =
+      import_data.Get(ImportTokens(import.subject()));
+  return info.ok() ? &(*info)->module() : nullptr;
+}
+
+// Collects the references of a module to top-level definitions.
+class ReferenceCollector {
+ public:
+  struct Target {
+    std::string file;
+    std::string name;
+  };
+
+  ReferenceCollector(const Module& module, ImportData& import_data)
+      : import_data_(import_data) {
+    file_ = NormalizeIndexedFilename(module.fs_path()->string());
+    for (const ModuleMember& member : module.top()) {
+      if (std::optional<Definition> definition = GetDefinition(member)) {
+        local_definitions_.insert(definition->name_def);
+      }
+    }
+  }
+
+  void Collect(const AstNode* node) {
+    if (auto* name_ref = dynamic_cast<const NameRef*>(node)) {
+      AddLocal(name_ref->span(), name_ref->name_def());
+    } else if (auto* type_ref = dynamic_cast<const TypeRef*>(node)) {
+      // The children of a TypeRef are not traversed, so a reference to a type
+      // of another module is resolved here.
+      if (auto* colon_ref =
+              std::get_if<ColonRef*>(&type_ref->type_definition())) {
+        AddImported(type_ref->span(), **colon_ref);
+      } else {
+        AddLocal(type_ref->span(),
+                 TypeDefinitionGetNameDef(type_ref->type_definition()));
+      }
+    } else if (auto* colon_ref = dynamic_cast<const ColonRef*>(node)) {
+      AddImported(colon_ref->span(), *colon_ref);
+    }
+    for (const AstNode* child : node->GetChildren(/*want_types=*/true)) {
+      Collect(child);
+    }
+  }
+
+  std::vector<std::pair<Span, Target>> TakeReferences() {
+    return std::move(references_);
+  }
+
+ private:
+  void AddLocal(const Span& span, const AnyNameDef& any_name_def) {
+    auto* name_def = std::get_if<const NameDef*>(&any_name_def);
+    if (name_def != nullptr && local_definitions_.contains(*name_def)) {
+      references_.push_back(
+          {span, Target{.file = file_, .name = (*name_def)->identifier()}});
+    }
+  }
+
+  void AddImported(const Span& span, const ColonRef& colon_ref) {
+    std::optional<Import*> import = colon_ref.ResolveImportSubject();
+    if (!import.has_value()) {
+      return;
+    }
+    Module* imported = GetImportedModule(**import, import_data_);
+    if (imported == nullptr || !imported->fs_path().has_value()) {
+      return;
+    }
+    references_.push_back(
+        {span,
+         Target{.file = NormalizeIndexedFilename(imported->fs_path()->string()),
+                .name = colon_ref.attr()}});
+  }
+
+  ImportData& import_data_;
+  std::string file_;
+  absl::flat_hash_set<const NameDef*> local_definitions_;
+  std::vector<std::pair<Span, Target>> references_;
+};
+
+}  // namespace
+
+std::string NormalizeIndexedFilename(std::string_view filename) {
+  constexpr std::string_view kFileScheme = "file://";
+  if (absl::StartsWith(filename, kFileScheme)) {
+    filename.remove_prefix(kFileScheme.size());
+  } else if (absl::StrContains(filename, "://")) {
+    return std::string{filename};
+  }
+  std::error_code ec;
+  std::filesystem::path path = std::filesystem::absolute(filename, ec);
+  if (ec) {
+    return std::string{filename};
+  }
+  return path.lexically_normal().string();
+}
+
+bool WorkspaceSymbolIndex::IndexModule(const Module& module,
+                                       ImportData& import_data,
+                                       bool replace_existing) {
+  if (!module.fs_path().has_value()) {
+    return false;
+  }
+  std::string file = NormalizeIndexedFilename(module.fs_path()->string());
+  if (!replace_existing && ContainsFile(file)) {
+    return false;
+  }
+
+  // The module is walked without holding the lock.
+  FileEntry entry;
+  for (const ModuleMember& member : module.top()) {
+    if (std::optional<Definition> definition = GetDefinition(member)) {
+      entry.definitions.push_back(IndexedSymbol{
+          .name = definition->name_def->identifier(),
+          .kind = definition->kind,
+          .name_span = definition->name_def->span(),
+          .span = ToAstNode(member)->GetSpan().value(),
+      });
+    }
+  }
+  ReferenceCollector collector(module, import_data);
+  collector.Collect(&module);
+  for (auto& [span, target] : collector.TakeReferences()) {
+    entry.references.push_back(Reference{.span = span,
+                                         .target_file = std::move(target.file),
+                                         .name = std::move(target.name)});
+  }
+
+  absl::MutexLock lock(&mutex_);
+  if (!replace_existing && files_.contains(file)) {
+    return false;
+  }
+  files_[file] = std::move(entry);
+  return true;
+}
+
+void WorkspaceSymbolIndex::IndexModuleAndImports(const Module& module,
+                                                 ImportData& import_data,
+                                                 bool replace_existing) {
+  IndexModule(module, import_data, replace_existing);
+  absl::flat_hash_set<const Module*> visited = {&module};
+  std::vector<const Module*> worklist = {&module};
+  while (!worklist.empty()) {
+    const Module* importer = worklist.back();
+    worklist.pop_back();
+    for (const ModuleMember& member : importer->top()) {
+      auto* import = std::get_if<Import*>(&member);
+      if (import == nullptr) {
+        continue;
+      }
+      Module* imported = GetImportedModule(**import, import_data);
+      if (imported == nullptr || !visited.insert(imported).second) {
+        continue;
+      }
+      IndexModule(*imported, import_data, /*replace_existing=*/false);
+      worklist.push_back(imported);
+    }
+  }
+}
+
+void WorkspaceSymbolIndex::RemoveFile(std::string_view filename) {
+  absl::MutexLock lock(&mutex_);
+  files_.erase(NormalizeIndexedFilename(filename));
+}
+
+bool WorkspaceSymbolIndex::ContainsFile(std::string_view filename) const {
+  absl::ReaderMutexLock lock(&mutex_);
+  return files_.contains(NormalizeIndexedFilename(filename));
+}
+
+int64_t WorkspaceSymbolIndex::file_count() const {
+  absl::ReaderMutexLock lock(&mutex_);
+  return files_.size();
+}
+
+std::pair<std::string, std::string> WorkspaceSymbolIndex::SymbolAt(
+    const Pos& pos) const {
+  std::string file = NormalizeIndexedFilename(pos.filename());
+  auto it = files_.find(file);
+  if (it == files_.end()) {
+    return {};
+  }
+  for (const Reference& reference : it->second.references) {
+    if (SpanContains(reference.span, pos)) {
+      return {reference.target_file, reference.name};
+    }
+  }
+  for (const IndexedSymbol& symbol : it->second.definitions) {
+    if (SpanContains(symbol.name_span, pos)) {
+      return {file, symbol.name};
+    }
+  }
+  return {};
+}
+
+std::vector<IndexedSymbol> WorkspaceSymbolIndex::FindDefinitions(
+    const Pos& pos) const {
+  absl::ReaderMutexLock lock(&mutex_);
+  auto [file, name] = SymbolAt(pos);
+  auto it = files_.find(file);
+  if (name.empty() || it == files_.end()) {
+    return {};
+  }
+  std::vector<IndexedSymbol> result;
+  for (const IndexedSymbol& symbol : it->second.definitions) {
+    if (symbol.name == name) {
+      result.push_back(symbol);
+    }
+  }
+  return result;
+}
+
+std::vector<Span> WorkspaceSymbolIndex::FindReferences(const Pos& pos) const {
+  absl::ReaderMutexLock lock(&mutex_);
+  auto [file, name] = SymbolAt(pos);
+  if (name.empty()) {
+    return {};
+  }
+  std::vector<Span> result;
+  for (const auto& [_, entry] : files_) {
+    for (const Reference& reference : entry.references) {
+      if (reference.name == name && reference.target_file == file) {
+        result.push_back(reference.span);
+      }
+    }
+  }
+  return result;
+}
+
+std::vector<IndexedSymbol> WorkspaceSymbolIndex::FindSymbols(
+    std::string_view query) const {
+  std::vector<IndexedSymbol> result;
+  {
+    absl::ReaderMutexLock lock(&mutex_);
+    for (const auto& [_, entry] : files_) {
+      for (const IndexedSymbol& symbol : entry.definitions) {
+        if (absl::StrContains(symbol.name, query)) {
+          result.push_back(symbol);
+        }
+      }
+    }
+  }
+  std::sort(result.begin(), result.end(),
+            [](const IndexedSymbol& a, const IndexedSymbol& b) {
+              return a.name < b.name;
+            });
+  return result;
+}
+
+}  // namespace xls::dslx
@@ -0,0 +1,113 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_LSP_WORKSPACE_SYMBOL_INDEX_H_
+#define XLS_DSLX_LSP_WORKSPACE_SYMBOL_INDEX_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "external/verible/common/lsp/lsp-protocol-enums.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/frontend/pos.h"
+#include "xls/dslx/import_data.h"
+
+namespace xls::dslx {
+
+// A symbol defined at the top level of a DSLX module.
+struct IndexedSymbol {
+  std::string name;
+  verible::lsp::SymbolKind kind;
+  // The span of the name in the definition, and of the whole definition.
+  Span name_span;
+  Span span;
+};
+
+// Returns the canonical form of a filename or URI under which the index keeps
+// a file: `file://` URIs and relative paths become absolute paths, so that a
+// module seen both as an import and as an open document has a single entry.
+// Other URIs (e.g. of in-memory documents) are returned verbatim.
+std::string NormalizeIndexedFilename(std::string_view filename);
+
+// An index of the top-level symbols of the DSLX modules of a workspace and of
+// the references to them, which answers language server queries spanning
+// modules without parsing them. Files are indexed individually from their
+// typechecked modules, so the index is updated incrementally as files change.
+//
+// Thread-safe: the index may be populated on a background thread while
+// queries are served.
+class WorkspaceSymbolIndex {
+ public:
+  // Indexes the definitions of `module` and its references to them and to the
+  // definitions of imported modules, which are resolved through
+  // `import_data`. Replaces a previous entry of the module's file unless
+  // `replace_existing` is false, in which case an indexed file is left as is.
+  // Returns whether the module was indexed.
+  bool IndexModule(const Module& module, ImportData& import_data,
+                   bool replace_existing = true);
+
+  // Indexes `module` as above, followed by the modules it imports directly or
+  // transitively. Imported modules are indexed only if their files are not
+  // indexed yet, so the contents of a file being edited, which is indexed as
+  // the main module of its updates, take precedence over those on disk.
+  void IndexModuleAndImports(const Module& module, ImportData& import_data,
+                             bool replace_existing = true);
+
+  void RemoveFile(std::string_view filename);
+  bool ContainsFile(std::string_view filename) const;
+  int64_t file_count() const;
+
+  // Returns the definitions of the symbol referenced at `pos`. Only references
+  // to top-level definitions are indexed.
+  std::vector<IndexedSymbol> FindDefinitions(const Pos& pos) const;
+
+  // Returns the spans of the references throughout the workspace to the symbol
+  // defined or referenced at `pos`.
+  std::vector<Span> FindReferences(const Pos& pos) const;
+
+  // Returns the symbols whose names contain `query`, ordered by name.
+  std::vector<IndexedSymbol> FindSymbols(std::string_view query) const;
+
+ private:
+  // A reference to the symbol `name` defined in the file `target_file`
+  // (normalized).
+  struct Reference {
+    Span span;
+    std::string target_file;
+    std::string name;
+  };
+
+  struct FileEntry {
+    std::vector<IndexedSymbol> definitions;
+    std::vector<Reference> references;
+  };
+
+  // Returns the symbol defined or referenced at `pos` as a (normalized file,
+  // name) pair, or an empty name if there is none.
+  std::pair<std::string, std::string> SymbolAt(const Pos& pos) const
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_);
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, FileEntry> files_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_LSP_WORKSPACE_SYMBOL_INDEX_H_
@@ -0,0 +1,163 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/lsp/workspace_symbol_index.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/frontend/pos.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/warning_kind.h"
+
+namespace xls::dslx {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+
+// Returns the position of the first occurrence of `needle` in `text`.
+Pos PosOf(std::string_view filename, std::string_view text,
+          std::string_view needle) {
+  size_t offset = text.find(needle);
+  XLS_CHECK_NE(offset, std::string_view::npos) << needle;
+  std::string_view before = text.substr(0, offset);
+  int64_t lineno = std::count(before.begin(), before.end(), '\n');
+  size_t line_start = before.rfind('\n');
+  int64_t colno = line_start == std::string_view::npos
+                      ? offset
+                      : offset - line_start - 1;
+  return Pos(filename, lineno, colno);
+}
+
+std::vector<std::string> Names(const std::vector<IndexedSymbol>& symbols) {
+  std::vector<std::string> names;
+  for (const IndexedSymbol& symbol : symbols) {
+    names.push_back(symbol.name);
+  }
+  return names;
+}
+
+constexpr std::string_view kLocalText = R"(const K = u32:2;
+fn f(x: u32) -> u32 { x * K }
+fn main() -> u32 { f(u32:1) + f(K) }
+)";
+
+TEST(WorkspaceSymbolIndexTest, LocalDefinitionsAndReferences) {
+  ImportData import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheck(kLocalText, "test.x", "test", &import_data));
+  WorkspaceSymbolIndex index;
+  EXPECT_TRUE(index.IndexModule(*tm.module, import_data));
+  EXPECT_TRUE(index.ContainsFile("test.x"));
+
+  std::vector<IndexedSymbol> definitions =
+      index.FindDefinitions(PosOf("test.x", kLocalText, "f(u32:1)"));
+  ASSERT_THAT(definitions, SizeIs(1));
+  EXPECT_EQ(definitions[0].name, "f");
+  EXPECT_EQ(definitions[0].name_span.start(), Pos("test.x", 1, 3));
+
+  // References are found from the definition and from a reference.
+  EXPECT_THAT(index.FindReferences(Pos("test.x", 1, 3)), SizeIs(2));
+  EXPECT_THAT(index.FindReferences(PosOf("test.x", kLocalText, "K)")),
+              SizeIs(2));
+  // Locals are not indexed.
+  EXPECT_THAT(index.FindDefinitions(PosOf("test.x", kLocalText, "x *")),
+              IsEmpty());
+
+  EXPECT_THAT(Names(index.FindSymbols("")), ElementsAre("K", "f", "main"));
+  EXPECT_THAT(Names(index.FindSymbols("ma")), ElementsAre("main"));
+}
+
+TEST(WorkspaceSymbolIndexTest, ReferencesAcrossModules) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  constexpr std::string_view kLibText =
+      "pub fn double(x: u32) -> u32 { x + x }\n";
+  XLS_ASSERT_OK(SetFileContents(temp_dir.path() / "lib.x", kLibText));
+  constexpr std::string_view kMainText = R"(import lib
+
+fn twice(x: u32) -> u32 { lib::double(x) }
+fn main(x: u32) -> u32 { twice(x) + lib::double(x) }
+)";
+  const std::string main_path = (temp_dir.path() / "main.x").string();
+  const std::string lib_path = (temp_dir.path() / "lib.x").string();
+  std::vector<std::filesystem::path> search_paths = {temp_dir.path()};
+  ImportData import_data =
+      CreateImportData(kDefaultDslxStdlibPath, search_paths, kAllWarningsSet);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheck(kMainText, main_path, "main", &import_data));
+
+  WorkspaceSymbolIndex index;
+  index.IndexModuleAndImports(*tm.module, import_data);
+  EXPECT_EQ(index.file_count(), 2);
+  EXPECT_TRUE(index.ContainsFile(lib_path));
+  EXPECT_TRUE(index.ContainsFile(absl::StrCat("file://", lib_path)));
+
+  std::vector<IndexedSymbol> definitions =
+      index.FindDefinitions(PosOf(main_path, kMainText, "lib::double"));
+  ASSERT_THAT(definitions, SizeIs(1));
+  EXPECT_EQ(definitions[0].name, "double");
+  EXPECT_EQ(NormalizeIndexedFilename(definitions[0].name_span.filename()),
+            NormalizeIndexedFilename(lib_path));
+
+  // Both uses in the main module refer to the definition in the library.
+  EXPECT_THAT(index.FindReferences(PosOf(lib_path, kLibText, "double")),
+              SizeIs(2));
+
+  // Removing the main module removes its references.
+  index.RemoveFile(main_path);
+  EXPECT_EQ(index.file_count(), 1);
+  EXPECT_THAT(index.FindReferences(PosOf(lib_path, kLibText, "double")),
+              IsEmpty());
+}
+
+TEST(WorkspaceSymbolIndexTest, ReindexingReplacesEntries) {
+  ImportData import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule first,
+      ParseAndTypecheck("fn a() { () }", "test.x", "test", &import_data));
+  WorkspaceSymbolIndex index;
+  EXPECT_TRUE(index.IndexModule(*first.module, import_data));
+
+  ImportData new_import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule second,
+      ParseAndTypecheck("fn b() { () }", "test.x", "test", &new_import_data));
+  EXPECT_FALSE(index.IndexModule(*second.module, new_import_data,
+                                 /*replace_existing=*/false));
+  EXPECT_THAT(Names(index.FindSymbols("")), ElementsAre("a"));
+  EXPECT_TRUE(index.IndexModule(*second.module, new_import_data));
+  EXPECT_THAT(Names(index.FindSymbols("")), ElementsAre("b"));
+}
+
+}  // namespace
+}  // namespace xls::dslx
@@ -26,8 +26,10 @@
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/trace.h"
 #include "xls/dslx/frontend/parser.h"
 #include "xls/dslx/frontend/scanner.h"
+#include "xls/dslx/import_routines.h"
 #include "xls/dslx/type_system/typecheck.h"
 #include "xls/dslx/warning_collector.h"
 
@@ -36,6 +38,7 @@ namespace xls::dslx {
 absl::StatusOr<TypecheckedModule> ParseAndTypecheck(
     std::string_view text, std::string_view path,
     std::string_view module_name, ImportData* import_data) {
+  ScopedTrace trace("ParseAndTypecheck", "dslx");
   XLS_RET_CHECK(import_data != nullptr);
 
   // The outermost import doesn't have a real import statement associated with
@@ -76,6 +79,10 @@ absl::StatusOr<TypecheckedModule> TypecheckModule(
 
   std::string_view module_name = module->name();
 
+  // Parse the import DAG concurrently up front; CheckModule then only has to
+  // typecheck each imported module as it reaches it.
+  PrefetchImports(*module, import_data);
+
   WarningCollector warnings(import_data->enabled_warnings());
   XLS_ASSIGN_OR_RETURN(TypeInfo * type_info,
                        CheckModule(module.get(), import_data, &warnings));
@@ -52,6 +52,11 @@ class RunComparator : public AbstractRunComparator {
       std::string_view ir_name, xls::Function* ir_function,
       absl::Span<const xls::Value> ir_args) override;
 
+  // The fork has its own (initially empty) JIT cache.
+  std::unique_ptr<AbstractRunComparator> Fork() const override {
+    return std::make_unique<RunComparator>(mode_);
+  }
+
   // Returns the cached or newly-compiled jit function for ir_name.  ir_name has
   // already been mangled (see MangleDslxName) so it should be unique in the
   // program and is used as the cache key.
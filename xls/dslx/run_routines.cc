@@ -16,13 +16,17 @@
 
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <ctime>
 #include <functional>
 #include <iostream>
 #include <memory>
 #include <optional>
+#include <ostream>
 #include <random>
+#include <sstream>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -34,7 +38,9 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/bytecode/bytecode_cache.h"
 #include "xls/dslx/bytecode/bytecode_emitter.h"
 #include "xls/dslx/bytecode/bytecode_interpreter.h"
@@ -47,7 +53,13 @@
 #include "xls/dslx/ir_convert/ir_converter.h"
 #include "xls/dslx/mangle.h"
 #include "xls/dslx/parse_and_typecheck.h"
+#include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/random_value.h"
+#include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_proc_runtime.h"
 
 namespace xls::dslx {
 namespace {
@@ -56,17 +68,27 @@ namespace {
 constexpr int kUnitSpaces = 7;
 constexpr int kQuickcheckSpaces = 15;
 
+// Installs a bytecode cache on `import_data` unless it already has one. The
+// cache is shared by all the tests run against `import_data` so functions (and
+// parametric instantiations) called from several tests are emitted once.
+void EnsureBytecodeCache(ImportData* import_data) {
+  if (import_data->bytecode_cache() == nullptr) {
+    import_data->SetBytecodeCache(std::make_unique<BytecodeCache>(import_data));
+  }
+}
+
 absl::Status RunTestFunction(ImportData* import_data, TypeInfo* type_info,
                              Module* module, TestFunction* tf,
                              const BytecodeInterpreterOptions& options) {
-  auto cache = std::make_unique<BytecodeCache>(import_data);
-  import_data->SetBytecodeCache(std::move(cache));
+  EnsureBytecodeCache(import_data);
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<BytecodeFunction> bf,
       BytecodeEmitter::Emit(
           import_data, type_info, tf->fn(), std::nullopt,
-          BytecodeEmitterOptions{.format_preference =
-                                     options.format_preference()}));
+          BytecodeEmitterOptions{
+              .format_preference = options.format_preference(),
+              .optimize = true,
+          }));
   return BytecodeInterpreter::Interpret(import_data, bf.get(), /*params=*/{},
                                         options)
       .status();
@@ -75,8 +97,7 @@ absl::Status RunTestFunction(ImportData* import_data, TypeInfo* type_info,
 absl::Status RunTestProc(ImportData* import_data, TypeInfo* type_info,
                          Module* module, TestProc* tp,
                          const BytecodeInterpreterOptions& options) {
-  auto cache = std::make_unique<BytecodeCache>(import_data);
-  import_data->SetBytecodeCache(std::move(cache));
+  EnsureBytecodeCache(import_data);
 
   XLS_ASSIGN_OR_RETURN(TypeInfo * ti,
                        type_info->GetTopLevelProcTypeInfo(tp->proc()));
@@ -84,48 +105,121 @@ absl::Status RunTestProc(ImportData* import_data, TypeInfo* type_info,
   std::vector<ProcInstance> proc_instances;
   XLS_ASSIGN_OR_RETURN(InterpValue terminator,
                        ti->GetConstExpr(tp->proc()->config()->params()[0]));
+  BytecodeInterpreterOptions network_options =
+      options.proc_threads() > 1 ? SerializeHooks(options) : options;
   XLS_RETURN_IF_ERROR(ProcConfigBytecodeInterpreter::InitializeProcNetwork(
-      import_data, ti, tp->proc(), terminator, &proc_instances, options));
+      import_data, ti, tp->proc(), terminator, &proc_instances,
+      network_options));
 
   std::shared_ptr<InterpValue::Channel> term_chan =
       terminator.GetChannelOrDie();
+  ProcNetworkRunner runner(&proc_instances, network_options);
   int64_t tick_count = 0;
   while (term_chan->empty()) {
-    bool progress_made = false;
     if (options.max_ticks().has_value() &&
         tick_count > options.max_ticks().value()) {
       return absl::DeadlineExceededError(
           absl::StrFormat("Exceeded limit of %d proc ticks before terminating",
                           options.max_ticks().value()));
     }
+    XLS_RETURN_IF_ERROR(runner.Tick());
+    ++tick_count;
+  }
 
-    std::vector<std::string> blocked_channels;
-    for (auto& p : proc_instances) {
-      XLS_ASSIGN_OR_RETURN(ProcRunResult run_result, p.Run());
-      if (run_result.execution_state == ProcExecutionState::kBlockedOnReceive) {
-        XLS_RET_CHECK(run_result.blocked_channel_name.has_value());
-        blocked_channels.push_back(run_result.blocked_channel_name.value());
-      }
-      progress_made |= run_result.progress_made;
-    }
+  InterpValue ret_val = term_chan->front();
+  XLS_RET_CHECK(ret_val.IsBool());
+  if (!ret_val.IsTrue()) {
+    return FailureErrorStatus(
+        tp->proc()->span(), "Proc reported failure upon exit.");
+  }
+  return absl::OkStatus();
+}
+
+// Converts the network of the test proc `tp` to IR and runs it on the JIT proc
+// runtime until the test proc sends on its terminator channel. Mirrors
+// RunTestProc: failed assertions and a false terminator value are reported as
+// failures and trace messages are passed to the options' trace hook.
+absl::Status RunTestProcOnJit(ImportData* import_data, Module* module,
+                              TestProc* tp,
+                              const BytecodeInterpreterOptions& options,
+                              ConvertOptions convert_options) {
+  // Assertions are how fail!() reports failure from the IR.
+  convert_options.emit_fail_as_assert = true;
+  Package package(module->name());
+  XLS_RETURN_IF_ERROR(ConvertOneFunctionIntoPackage(
+      module, tp->proc()->identifier(), import_data,
+      /*parametric_env=*/nullptr, convert_options, &package));
+
+  // The terminator is the test proc's only config parameter, which conversion
+  // turns into a send-only channel of the package.
+  XLS_ASSIGN_OR_RETURN(
+      Channel * terminator,
+      package.GetChannel(absl::StrCat(
+          package.name(), "__",
+          tp->proc()->config()->params()[0]->identifier())));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> runtime,
+                       CreateJitSerialProcRuntime(&package));
+  ChannelQueue& term_queue = runtime->queue_manager().GetQueue(terminator);
 
-    if (!progress_made) {
+  int64_t tick_count = 0;
+  while (term_queue.IsEmpty()) {
+    if (options.max_ticks().has_value() &&
+        tick_count > options.max_ticks().value()) {
       return absl::DeadlineExceededError(
-          absl::StrFormat("Procs are deadlocked. Blocked channels: %s",
-                          absl::StrJoin(blocked_channels, ", ")));
+          absl::StrFormat("Exceeded limit of %d proc ticks before terminating",
+                          options.max_ticks().value()));
+    }
+    XLS_RETURN_IF_ERROR(runtime->Tick());
+    for (const std::unique_ptr<Proc>& proc : package.procs()) {
+      const InterpreterEvents& events =
+          runtime->GetInterpreterEvents(proc.get());
+      if (options.trace_hook() != nullptr) {
+        for (const std::string& msg : events.trace_msgs) {
+          options.trace_hook()(msg);
+        }
+      }
+      if (!events.assert_msgs.empty()) {
+        return FailureErrorStatus(tp->proc()->span(),
+                                  events.assert_msgs.front());
+      }
     }
+    runtime->ClearInterpreterEvents();
     ++tick_count;
   }
 
-  InterpValue ret_val = term_chan->front();
-  XLS_RET_CHECK(ret_val.IsBool());
-  if (!ret_val.IsTrue()) {
+  std::optional<Value> ret_val = term_queue.Read();
+  XLS_RET_CHECK(ret_val.has_value());
+  XLS_RET_CHECK(ret_val->IsBits() && ret_val->bits().bit_count() == 1);
+  if (!ret_val->bits().IsOne()) {
     return FailureErrorStatus(
         tp->proc()->span(), "Proc reported failure upon exit.");
   }
   return absl::OkStatus();
 }
 
+// Runs the test function or test proc named `test_name` in the module `tm`.
+// Test procs run on the JIT if `jit_test_procs` is set, converted with
+// `convert_options`.
+absl::Status RunUnitTest(ImportData* import_data, const TypecheckedModule& tm,
+                         std::string_view test_name,
+                         const BytecodeInterpreterOptions& options,
+                         bool jit_test_procs,
+                         const ConvertOptions& convert_options) {
+  std::optional<ModuleMember*> member =
+      tm.module->FindMemberWithName(test_name);
+  XLS_RET_CHECK(member.has_value()) << "No test named " << test_name;
+  if (std::holds_alternative<TestFunction*>(*member.value())) {
+    XLS_ASSIGN_OR_RETURN(TestFunction * tf, tm.module->GetTest(test_name));
+    return RunTestFunction(import_data, tm.type_info, tm.module, tf, options);
+  }
+  XLS_ASSIGN_OR_RETURN(TestProc * tp, tm.module->GetTestProc(test_name));
+  if (jit_test_procs) {
+    return RunTestProcOnJit(import_data, tm.module, tp, options,
+                            convert_options);
+  }
+  return RunTestProc(import_data, tm.type_info, tm.module, tp, options);
+}
+
 }  // namespace
 
 static bool TestMatchesFilter(std::string_view test_name,
@@ -137,9 +231,91 @@ static bool TestMatchesFilter(std::string_view test_name,
   return test_name == *test_filter;
 }
 
+// Evaluates the quickcheck samples on the given comparators concurrently, one
+// thread per comparator. The arguments are drawn from the same random sequence
+// as in the sequential case and samples are claimed in order, so evaluation can
+// stop at the first falsifying sample with the same results as sequential
+// evaluation. Each comparator JIT-compiles `xls_function` itself; compilation
+// only reads the function (its cached topological order is filled under a
+// lock), so the comparators may compile it concurrently.
+static absl::StatusOr<QuickCheckResults> DoShardedQuickCheck(
+    xls::Function* xls_function, std::string_view ir_name,
+    absl::Span<AbstractRunComparator* const> run_comparators, int64_t seed,
+    int64_t num_tests) {
+  QuickCheckResults results;
+  std::minstd_rand rng_engine(seed);
+  results.arg_sets.reserve(num_tests);
+  for (int64_t i = 0; i < num_tests; ++i) {
+    results.arg_sets.push_back(
+        RandomFunctionArguments(xls_function, &rng_engine));
+  }
+  results.results.resize(num_tests);
+
+  std::atomic<int64_t> next_sample = 0;
+  // Index of the first falsifying sample found so far (num_tests if none), or
+  // -1 once any sample fails to evaluate.
+  std::atomic<int64_t> first_falsified = num_tests;
+  absl::Mutex mutex;
+  absl::Status status;
+  auto evaluate_samples = [&](AbstractRunComparator* run_comparator) {
+    for (int64_t i = next_sample++; i < first_falsified.load();
+         i = next_sample++) {
+      absl::StatusOr<Value> result =
+          DropInterpreterEvents(run_comparator->RunIrFunction(
+              ir_name, xls_function, results.arg_sets[i]));
+      if (!result.ok()) {
+        absl::MutexLock lock(&mutex);
+        status.Update(result.status());
+        first_falsified.store(-1);
+        return;
+      }
+      results.results[i] = *std::move(result);
+      if (results.results[i].IsAllZeros()) {
+        int64_t current = first_falsified.load();
+        while (i < current &&
+               !first_falsified.compare_exchange_weak(current, i)) {
+        }
+      }
+    }
+  };
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (AbstractRunComparator* run_comparator : run_comparators) {
+      threads.push_back(std::make_unique<Thread>(
+          [&, run_comparator] { evaluate_samples(run_comparator); }));
+    }
+  }
+  XLS_RETURN_IF_ERROR(status);
+
+  int64_t sample_count = first_falsified.load() == num_tests
+                             ? num_tests
+                             : first_falsified.load() + 1;
+  results.arg_sets.resize(sample_count);
+  results.results.resize(sample_count);
+  return results;
+}
+
 absl::StatusOr<QuickCheckResults> DoQuickCheck(
     xls::Function* xls_function, std::string_view ir_name,
-    AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests) {
+    AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests,
+    int64_t num_threads) {
+  if (num_threads > 1 && num_tests > 1) {
+    std::vector<std::unique_ptr<AbstractRunComparator>> forks;
+    std::vector<AbstractRunComparator*> run_comparators = {run_comparator};
+    for (int64_t i = 1; i < std::min(num_threads, num_tests); ++i) {
+      std::unique_ptr<AbstractRunComparator> fork = run_comparator->Fork();
+      if (fork == nullptr) {
+        break;
+      }
+      run_comparators.push_back(fork.get());
+      forks.push_back(std::move(fork));
+    }
+    if (run_comparators.size() > 1) {
+      return DoShardedQuickCheck(xls_function, ir_name, run_comparators, seed,
+                                 num_tests);
+    }
+  }
+
   QuickCheckResults results;
   std::minstd_rand rng_engine(seed);
 
@@ -166,7 +342,8 @@ absl::StatusOr<QuickCheckResults> DoQuickCheck(
 
 static absl::Status RunQuickCheck(AbstractRunComparator* run_comparator,
                                   Package* ir_package, QuickCheck* quickcheck,
-                                  TypeInfo* type_info, int64_t seed) {
+                                  TypeInfo* type_info, int64_t seed,
+                                  int64_t num_threads) {
   Function* fn = quickcheck->f();
   XLS_ASSIGN_OR_RETURN(std::string ir_name,
                        MangleDslxName(fn->owner()->name(), fn->identifier(),
@@ -178,7 +355,7 @@ static absl::Status RunQuickCheck(AbstractRunComparator* run_comparator,
   XLS_ASSIGN_OR_RETURN(
       QuickCheckResults qc_results,
       DoQuickCheck(ir_function, std::move(ir_name), run_comparator, seed,
-                   quickcheck->test_count()));
+                   quickcheck->test_count(), num_threads));
   const auto& [arg_sets, results] = qc_results;
   XLS_ASSIGN_OR_RETURN(Bits last_result, results.back().GetBitsWithStatus());
   if (!last_result.IsZero()) {
@@ -209,13 +386,39 @@ static absl::Status RunQuickCheck(AbstractRunComparator* run_comparator,
                       results.size(), dslx_argset_str));
 }
 
+// Prints the failure of the test or quickcheck `test_name` with `status` to
+// `out`.
+static void PrintTestFailure(const absl::Status& status,
+                             std::string_view test_name, bool is_quickcheck,
+                             std::ostream& out) {
+  XLS_VLOG(1) << "Handling error; status: " << status
+              << " test_name: " << test_name;
+  absl::StatusOr<PositionalErrorData> data_or = GetPositionalErrorData(status);
+  std::string suffix;
+  if (data_or.ok()) {
+    const auto& data = data_or.value();
+    XLS_CHECK_OK(PrintPositionalError(
+        data.span, data.GetMessageWithType(), out,
+        /*get_file_contents=*/nullptr, PositionalErrorColor::kErrorColor));
+  } else {
+    // If we can't extract positional data we log the error and put the error
+    // status into the "failed" prompted.
+    XLS_LOG(ERROR) << "Internal error: " << status;
+    suffix = absl::StrCat(": internal error: ", status.ToString());
+  }
+  std::string spaces((is_quickcheck ? kQuickcheckSpaces : kUnitSpaces), ' ');
+  out << absl::StreamFormat("[ %sFAILED ] %s%s", spaces, test_name, suffix)
+      << "\n";
+}
+
 using HandleError = const std::function<void(
     const absl::Status&, std::string_view test_name, bool is_quickcheck)>;
 
 static absl::Status RunQuickChecksIfJitEnabled(
     Module* entry_module, TypeInfo* type_info,
     AbstractRunComparator* run_comparator, Package* ir_package,
-    std::optional<int64_t> seed, const HandleError& handle_error) {
+    std::optional<int64_t> seed, int64_t num_threads,
+    const HandleError& handle_error) {
   if (run_comparator == nullptr) {
     std::cerr << "[ SKIPPING QUICKCHECKS  ] (JIT is disabled)"
               << "\n";
@@ -233,8 +436,8 @@ static absl::Status RunQuickChecksIfJitEnabled(
     const std::string& test_name = quickcheck->identifier();
     std::cerr << "[ RUN QUICKCHECK        ] " << test_name
               << " count: " << quickcheck->test_count() << "\n";
-    absl::Status status =
-        RunQuickCheck(run_comparator, ir_package, quickcheck, type_info, *seed);
+    absl::Status status = RunQuickCheck(run_comparator, ir_package, quickcheck,
+                                        type_info, *seed, num_threads);
     if (!status.ok()) {
       handle_error(status, test_name, /*is_quickcheck=*/true);
     } else {
@@ -258,26 +461,7 @@ absl::StatusOr<TestResult> ParseAndTest(std::string_view program,
 
   auto handle_error = [&](const absl::Status& status,
                           std::string_view test_name, bool is_quickcheck) {
-    XLS_VLOG(1) << "Handling error; status: " << status
-                << " test_name: " << test_name;
-    absl::StatusOr<PositionalErrorData> data_or =
-        GetPositionalErrorData(status);
-    std::string suffix;
-    if (data_or.ok()) {
-      const auto& data = data_or.value();
-      XLS_CHECK_OK(PrintPositionalError(
-          data.span, data.GetMessageWithType(), std::cerr,
-          /*get_file_contents=*/nullptr, PositionalErrorColor::kErrorColor));
-    } else {
-      // If we can't extract positional data we log the error and put the error
-      // status into the "failed" prompted.
-      XLS_LOG(ERROR) << "Internal error: " << status;
-      suffix = absl::StrCat(": internal error: ", status.ToString());
-    }
-    std::string spaces((is_quickcheck ? kQuickcheckSpaces : kUnitSpaces), ' ');
-    std::cerr << absl::StreamFormat("[ %sFAILED ] %s%s", spaces, test_name,
-                                    suffix)
-              << "\n";
+    PrintTestFailure(status, test_name, is_quickcheck, std::cerr);
     failed += 1;
   };
 
@@ -312,10 +496,10 @@ absl::StatusOr<TestResult> ParseAndTest(std::string_view program,
 
   Module* entry_module = tm_or.value().module;
 
-  // If JIT comparisons are "on", we register a post-evaluation hook to compare
-  // with the interpreter.
+  // If JIT comparisons are "on", we convert the module to IR so a
+  // post-evaluation hook (see `run_unit_test`) can compare with the
+  // interpreter.
   std::unique_ptr<Package> ir_package;
-  PostFnEvalHook post_fn_eval_hook;
   if (options.run_comparator != nullptr) {
     absl::StatusOr<std::unique_ptr<Package>> ir_package_or =
         ConvertModuleToPackage(entry_module, &import_data,
@@ -327,53 +511,136 @@ absl::StatusOr<TestResult> ParseAndTest(std::string_view program,
       return ir_package_or.status();
     }
     ir_package = std::move(ir_package_or).value();
-    post_fn_eval_hook = [&ir_package, &import_data, &options](
-                            const Function* f,
-                            absl::Span<const InterpValue> args,
-                            const ParametricEnv* parametric_env,
-                            const InterpValue& got) -> absl::Status {
-      std::optional<bool> requires_implicit_token =
-          import_data.GetRootTypeInfoForNode(f)
-              .value()
-              ->GetRequiresImplicitToken(f);
-      XLS_RET_CHECK(requires_implicit_token.has_value());
-      return options.run_comparator->RunComparison(ir_package.get(),
-                                                   *requires_implicit_token, f,
-                                                   args, parametric_env, got);
-    };
   }
 
-  // Run unit tests.
+  std::vector<std::string> test_names;
   for (const std::string& test_name : entry_module->GetTestNames()) {
     if (!TestMatchesFilter(test_name, options.test_filter)) {
       skipped += 1;
       continue;
     }
+    test_names.push_back(test_name);
+  }
 
-    ran += 1;
-    std::cerr << "[ RUN UNITTEST  ] " << test_name << std::endl;
-    absl::Status status;
-    ModuleMember* member = entry_module->FindMemberWithName(test_name).value();
+  // Runs the unit test `test_name` of `tm` (owned by `import_data`), comparing
+  // function results using `run_comparator` if given. Writes the test output to
+  // `out` and returns whether the test passed.
+  auto run_unit_test = [&](ImportData* import_data,
+                           const TypecheckedModule& tm,
+                           AbstractRunComparator* run_comparator,
+                           std::string_view test_name, std::ostream& out) {
+    out << "[ RUN UNITTEST  ] " << test_name << std::endl;
+    PostFnEvalHook post_fn_eval_hook;
+    if (run_comparator != nullptr) {
+      post_fn_eval_hook = [&ir_package, import_data, run_comparator](
+                              const Function* f,
+                              absl::Span<const InterpValue> args,
+                              const ParametricEnv* parametric_env,
+                              const InterpValue& got) -> absl::Status {
+        std::optional<bool> requires_implicit_token =
+            import_data->GetRootTypeInfoForNode(f)
+                .value()
+                ->GetRequiresImplicitToken(f);
+        XLS_RET_CHECK(requires_implicit_token.has_value());
+        return run_comparator->RunComparison(ir_package.get(),
+                                             *requires_implicit_token, f, args,
+                                             parametric_env, got);
+      };
+    }
     BytecodeInterpreterOptions interpreter_options;
     interpreter_options.post_fn_eval_hook(post_fn_eval_hook)
         .trace_hook(InfoLoggingTraceHook)
         .trace_channels(options.trace_channels)
         .max_ticks(options.max_ticks)
+        .proc_threads(options.proc_threads)
         .format_preference(options.format_preference);
-    if (std::holds_alternative<TestFunction*>(*member)) {
-      XLS_ASSIGN_OR_RETURN(TestFunction * tf, entry_module->GetTest(test_name));
-      status = RunTestFunction(&import_data, tm_or.value().type_info,
-                               entry_module, tf, interpreter_options);
-    } else {
-      XLS_ASSIGN_OR_RETURN(TestProc * tp, entry_module->GetTestProc(test_name));
-      status = RunTestProc(&import_data, tm_or.value().type_info, entry_module,
-                           tp, interpreter_options);
+    absl::Status status =
+        RunUnitTest(import_data, tm, test_name, interpreter_options,
+                    options.jit_test_procs, options.convert_options);
+    if (!status.ok()) {
+      PrintTestFailure(status, test_name, /*is_quickcheck=*/false, out);
+      return false;
     }
+    out << "[            OK ]" << std::endl;
+    return true;
+  };
 
-    if (status.ok()) {
-      std::cerr << "[            OK ]" << std::endl;
-    } else {
-      handle_error(status, test_name, /*is_quickcheck=*/false);
+  // Run unit tests.
+  int64_t thread_count =
+      std::min<int64_t>(options.test_threads, test_names.size());
+  std::vector<std::unique_ptr<AbstractRunComparator>> forks;
+  if (thread_count > 1 && options.run_comparator != nullptr) {
+    for (int64_t i = 1; i < thread_count; ++i) {
+      std::unique_ptr<AbstractRunComparator> fork =
+          options.run_comparator->Fork();
+      if (fork == nullptr) {
+        break;
+      }
+      forks.push_back(std::move(fork));
+    }
+    thread_count = forks.size() + 1;
+  }
+  if (thread_count <= 1) {
+    for (const std::string& test_name : test_names) {
+      ran += 1;
+      if (!run_unit_test(&import_data, tm_or.value(), options.run_comparator,
+                         test_name, std::cerr)) {
+        failed += 1;
+      }
+    }
+  } else {
+    // Tests share no state, so each thread runs tests against its own import
+    // data (and so its own copy of the module); the first thread reuses the
+    // already typechecked one. The IR package is shared: each comparator
+    // compiles the functions it checks itself, which only reads them. Output
+    // is buffered per test.
+    struct UnitTestOutcome {
+      std::string output;
+      bool passed = false;
+    };
+    std::vector<UnitTestOutcome> outcomes(test_names.size());
+    std::atomic<int64_t> next_test = 0;
+    absl::Mutex mutex;
+    absl::Status status;
+    auto run_unit_tests = [&](ImportData* import_data,
+                              const TypecheckedModule& tm,
+                              AbstractRunComparator* run_comparator) {
+      for (int64_t i = next_test++; i < test_names.size(); i = next_test++) {
+        std::ostringstream out;
+        outcomes[i].passed =
+            run_unit_test(import_data, tm, run_comparator, test_names[i], out);
+        outcomes[i].output = std::move(out).str();
+      }
+    };
+    {
+      std::vector<std::unique_ptr<Thread>> threads;
+      threads.push_back(std::make_unique<Thread>([&] {
+        run_unit_tests(&import_data, tm_or.value(), options.run_comparator);
+      }));
+      for (int64_t i = 1; i < thread_count; ++i) {
+        AbstractRunComparator* run_comparator =
+            forks.empty() ? nullptr : forks[i - 1].get();
+        threads.push_back(std::make_unique<Thread>([&, run_comparator] {
+          ImportData thread_import_data = CreateImportData(
+              options.stdlib_path, options.dslx_paths, options.warnings);
+          absl::StatusOr<TypecheckedModule> tm = ParseAndTypecheck(
+              program, filename, module_name, &thread_import_data);
+          if (!tm.ok()) {
+            absl::MutexLock lock(&mutex);
+            status.Update(tm.status());
+            return;
+          }
+          run_unit_tests(&thread_import_data, *tm, run_comparator);
+        }));
+      }
+    }
+    XLS_RETURN_IF_ERROR(status);
+    for (int64_t i = 0; i < test_names.size(); ++i) {
+      std::cerr << outcomes[i].output;
+      ran += 1;
+      if (!outcomes[i].passed) {
+        failed += 1;
+      }
     }
   }
 
@@ -386,7 +653,7 @@ absl::StatusOr<TestResult> ParseAndTest(std::string_view program,
   if (!entry_module->GetQuickChecks().empty()) {
     XLS_RETURN_IF_ERROR(RunQuickChecksIfJitEnabled(
         entry_module, tm_or.value().type_info, options.run_comparator,
-        ir_package.get(), options.seed, handle_error));
+        ir_package.get(), options.seed, options.test_threads, handle_error));
   }
 
   return failed == 0 ? TestResult::kAllPassed : TestResult::kSomeFailed;
@@ -20,6 +20,7 @@
 
 #include <cstdint>
 #include <filesystem>  // NOLINT
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -67,6 +68,14 @@ class AbstractRunComparator {
   virtual absl::StatusOr<InterpreterResult<xls::Value>> RunIrFunction(
       std::string_view ir_name, xls::Function* ir_function,
       absl::Span<const xls::Value> ir_args) = 0;
+
+  // Returns a new comparator with the same configuration which may be used on
+  // another thread concurrently with this one (e.g. one with its own JIT
+  // instances), or nullptr if the comparator cannot be forked. Tests and
+  // quickchecks are only run concurrently if the comparator can be forked.
+  virtual std::unique_ptr<AbstractRunComparator> Fork() const {
+    return nullptr;
+  }
 };
 
 // Optional arguments to ParseAndTest (that have sensible defaults).
@@ -82,6 +91,14 @@ class AbstractRunComparator {
 //   warnings_as_errors: Whether warnings should be reported as errors (i.e.
 //    cause the run routine to report failure when a warning is encountered).
 //   warnings: Set of warnings to enable for reporting.
+//   test_threads: Number of threads on which to run unit tests and quickcheck
+//    samples concurrently. Each thread typechecks its own copy of the module,
+//    and the output of each test is buffered and printed in test order.
+//   jit_test_procs: Whether test procs are converted to IR and run on the JIT
+//    proc runtime instead of the bytecode interpreter. Much faster for tests
+//    which tick many times; `trace_channels` is not supported in this mode.
+//   proc_threads: Number of threads on which to run the procs of a test proc
+//    network with the bytecode interpreter; see ProcNetworkRunner.
 struct ParseAndTestOptions {
   std::string stdlib_path = xls::kDefaultDslxStdlibPath;
   absl::Span<const std::filesystem::path> dslx_paths = {};
@@ -95,6 +112,9 @@ struct ParseAndTestOptions {
   WarningKindSet warnings = kAllWarningsSet;
   bool trace_channels = false;
   std::optional<int64_t> max_ticks;
+  int64_t test_threads = 1;
+  bool jit_test_procs = false;
+  int64_t proc_threads = 1;
 };
 
 enum class TestResult : uint8_t {
@@ -132,9 +152,14 @@ struct QuickCheckResults {
 // xls_function is a predicate we're trying to find evidence to falsify, so if
 // this finds an example that falsifies the predicate, we early-return (i.e. the
 // length of the returned vectors may be < 1000).
+//
+// If num_threads > 1 and run_comparator can be forked, the samples are
+// evaluated concurrently by that many comparators (and so JIT instances). The
+// samples and results are the same as when evaluating sequentially.
 absl::StatusOr<QuickCheckResults> DoQuickCheck(
     xls::Function* xls_function, std::string_view ir_name,
-    AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests);
+    AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests,
+    int64_t num_threads = 1);
 
 }  // namespace xls::dslx
 
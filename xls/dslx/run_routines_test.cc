@@ -24,6 +24,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_replace.h"
 #include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
 #include "xls/dslx/run_comparator.h"
@@ -261,6 +262,67 @@ TEST(QuickcheckTest, Seeding) {
   EXPECT_EQ(results1, results2);
 }
 
+// Evaluating the samples on several threads gives the same argsets and results
+// as evaluating them sequentially, including stopping at the first falsifying
+// example.
+TEST(QuickcheckTest, ShardedMatchesSequential) {
+  Package package("sometimes_false");
+  std::string ir_text = R"(
+  fn gt_one(x: bits[8]) -> bits[1] {
+    literal.2: bits[8] = literal(value=1)
+    ret ugt.3: bits[1] = ugt(x, literal.2)
+  }
+  )";
+  int64_t num_tests = 1000;
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  for (int64_t seed : {0, 12345}) {
+    RunComparator jit_comparator(CompareMode::kJit);
+    XLS_ASSERT_OK_AND_ASSIGN(
+        auto sequential,
+        DoQuickCheck(function, kFakeIrName, &jit_comparator, seed, num_tests));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        auto sharded,
+        DoQuickCheck(function, kFakeIrName, &jit_comparator, seed, num_tests,
+                     /*num_threads=*/4));
+    EXPECT_EQ(sequential.arg_sets, sharded.arg_sets);
+    EXPECT_EQ(sequential.results, sharded.results);
+  }
+}
+
+TEST(RunRoutinesTest, ConcurrentUnitTests) {
+  constexpr std::string_view kProgram = R"(
+fn double(x: u32) -> u32 { x + x }
+
+#[test]
+fn test_zero() { assert_eq(double(u32:0), u32:0) }
+
+#[test]
+fn test_one() { assert_eq(double(u32:1), u32:2) }
+
+#[test]
+fn test_two() { assert_eq(double(u32:2), u32:4) }
+
+#[test]
+fn test_wrong() { assert_eq(double(u32:3), u32:7) }
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto temp_file,
+                           TempFile::CreateWithContent(kProgram, "_test.x"));
+  constexpr const char* kModuleName = "test";
+  RunComparator jit_comparator(CompareMode::kJit);
+  ParseAndTestOptions options;
+  options.run_comparator = &jit_comparator;
+  options.test_threads = 3;
+  EXPECT_THAT(ParseAndTest(kProgram, kModuleName,
+                           std::string(temp_file.path()), options),
+              status_testing::IsOkAndHolds(TestResult::kSomeFailed));
+
+  options.test_filter = "test_two";
+  EXPECT_THAT(ParseAndTest(kProgram, kModuleName,
+                           std::string(temp_file.path()), options),
+              status_testing::IsOkAndHolds(TestResult::kAllPassed));
+}
+
 TEST(BytecodeInterpreterTest, DeadlockedProc) {
   // Test proc never sends to the subproc, so network is deadlocked.
   constexpr std::string_view kProgram = R"(
@@ -310,6 +372,102 @@ proc tester_proc {
       << result.status();
 }
 
+TEST(BytecodeInterpreterTest, ProcNetworkOnSeveralThreads) {
+  constexpr std::string_view kProgram = R"(
+proc incrementer {
+  in_ch: chan<u32> in;
+  out_ch: chan<u32> out;
+
+  init { () }
+
+  config(in_ch: chan<u32> in,
+         out_ch: chan<u32> out) {
+    (in_ch, out_ch)
+  }
+  next(tok: token, _: ()) {
+    let (tok, i) = recv(tok, in_ch);
+    let tok = send(tok, out_ch, i + u32:1);
+  }
+}
+
+#[test_proc]
+proc tester_proc {
+  data_out: chan<u32> out;
+  data_in: chan<u32> in;
+  terminator: chan<bool> out;
+
+  init { u32:0 }
+
+  config(terminator: chan<bool> out) {
+    let (a_out, a_in) = chan<u32>;
+    let (b_out, b_in) = chan<u32>;
+    let (c_out, c_in) = chan<u32>;
+    let (d_out, d_in) = chan<u32>;
+    spawn incrementer(a_in, b_out);
+    spawn incrementer(b_in, c_out);
+    spawn incrementer(c_in, d_out);
+    (a_out, d_in, terminator)
+  }
+
+  next(tok: token, i: u32) {
+    let tok = send(tok, data_out, i);
+    let (tok, result) = recv(tok, data_in);
+    assert_eq(result, i + u32:3);
+    let tok = send_if(tok, terminator, i == u32:20, true);
+    i + u32:1
+  }
+})";
+  ParseAndTestOptions options;
+  options.proc_threads = 4;
+  EXPECT_THAT(ParseAndTest(kProgram, "test_module", "test.x", options),
+              status_testing::IsOkAndHolds(TestResult::kAllPassed));
+}
+
+TEST(BytecodeInterpreterTest, DeadlockedProcOnSeveralThreads) {
+  constexpr std::string_view kProgram = R"(
+proc incrementer {
+  in_ch: chan<u32> in;
+  out_ch: chan<u32> out;
+
+  init { () }
+
+  config(in_ch: chan<u32> in,
+         out_ch: chan<u32> out) {
+    (in_ch, out_ch)
+  }
+  next(tok: token, _: ()) {
+    let (tok, i) = recv(tok, in_ch);
+    let tok = send(tok, out_ch, i + u32:1);
+  }
+}
+
+#[test_proc]
+proc tester_proc {
+  data_out: chan<u32> out;
+  data_in: chan<u32> in;
+  terminator: chan<bool> out;
+
+  init { () }
+
+  config(terminator: chan<bool> out) {
+    let (input_out, input_in) = chan<u32>;
+    let (output_out, output_in) = chan<u32>;
+    spawn incrementer(input_in, output_out);
+    (input_out, output_in, terminator)
+  }
+
+  next(tok: token, state: ()) {
+    let (tok, _result) = recv(tok, data_in);
+    let tok = send(tok, terminator, true);
+ }
+})";
+  ParseAndTestOptions options;
+  options.max_ticks = 100;
+  options.proc_threads = 2;
+  EXPECT_THAT(ParseAndTest(kProgram, "test_module", "test.x", options),
+              status_testing::IsOkAndHolds(TestResult::kSomeFailed));
+}
+
 TEST(BytecodeInterpreterTest, TooManyTicks) {
   // Test proc never receives and spins forever.
   constexpr std::string_view kProgram = R"(
@@ -358,4 +516,73 @@ proc tester_proc {
       << result.status();
 }
 
+// Test proc which sends a value through an incrementer and reports whether the
+// result is the expected one.
+constexpr std::string_view kIncrementerTestProc = R"(
+proc incrementer {
+  in_ch: chan<u32> in;
+  out_ch: chan<u32> out;
+
+  init { () }
+
+  config(in_ch: chan<u32> in,
+         out_ch: chan<u32> out) {
+    (in_ch, out_ch)
+  }
+  next(tok: token, _: ()) {
+    let (tok, i) = recv(tok, in_ch);
+    let tok = send(tok, out_ch, i + u32:1);
+  }
+}
+
+#[test_proc]
+proc tester_proc {
+  data_out: chan<u32> out;
+  data_in: chan<u32> in;
+  terminator: chan<bool> out;
+
+  init { () }
+
+  config(terminator: chan<bool> out) {
+    let (input_out, input_in) = chan<u32>;
+    let (output_out, output_in) = chan<u32>;
+    spawn incrementer(input_in, output_out);
+    (input_out, output_in, terminator)
+  }
+
+  next(tok: token, state: ()) {
+    let tok = send(tok, data_out, u32:42);
+    let (tok, result) = recv(tok, data_in);
+    let tok = send(tok, terminator, result == u32:EXPECTED);
+ }
+})";
+
+TEST(RunRoutinesTest, JitTestProc) {
+  ParseAndTestOptions options;
+  options.max_ticks = 100;
+  options.jit_test_procs = true;
+  std::string passing =
+      absl::StrReplaceAll(kIncrementerTestProc, {{"EXPECTED", "43"}});
+  EXPECT_THAT(ParseAndTest(passing, "test_module", "test.x", options),
+              status_testing::IsOkAndHolds(TestResult::kAllPassed));
+
+  std::string failing =
+      absl::StrReplaceAll(kIncrementerTestProc, {{"EXPECTED", "42"}});
+  EXPECT_THAT(ParseAndTest(failing, "test_module", "test.x", options),
+              status_testing::IsOkAndHolds(TestResult::kSomeFailed));
+}
+
+TEST(RunRoutinesTest, JitTestProcFailedAssertion) {
+  std::string program = absl::StrReplaceAll(
+      kIncrementerTestProc,
+      {{"let tok = send(tok, terminator",
+        "assert_eq(result, u32:0);\n    let tok = send(tok, terminator"},
+       {"EXPECTED", "43"}});
+  ParseAndTestOptions options;
+  options.max_ticks = 100;
+  options.jit_test_procs = true;
+  EXPECT_THAT(ParseAndTest(program, "test_module", "test.x", options),
+              status_testing::IsOkAndHolds(TestResult::kSomeFailed));
+}
+
 }  // namespace xls::dslx
@@ -0,0 +1,130 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/type_system/concrete_type_interner.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <typeinfo>
+#include <vector>
+
+#include "absl/hash/hash.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/type_system/concrete_type.h"
+
+namespace xls::dslx {
+namespace {
+
+// Accumulates the hash of a type. Nominal types (structs and enums) hash their
+// definitions by identity, as operator== compares them.
+class HashVisitor : public ConcreteTypeVisitor {
+ public:
+  size_t hash() const { return hash_; }
+
+  absl::Status HandleEnum(const EnumType& t) override {
+    Mix(&t.nominal_type(), t.is_signed());
+    MixDim(t.size());
+    return absl::OkStatus();
+  }
+  absl::Status HandleBits(const BitsType& t) override {
+    Mix(t.is_signed());
+    MixDim(t.size());
+    return absl::OkStatus();
+  }
+  absl::Status HandleFunction(const FunctionType& t) override {
+    Mix(t.params().size());
+    for (const std::unique_ptr<ConcreteType>& param : t.params()) {
+      XLS_RETURN_IF_ERROR(Visit(*param));
+    }
+    return Visit(t.return_type());
+  }
+  absl::Status HandleChannel(const ChannelType& t) override {
+    Mix(static_cast<int64_t>(t.direction()));
+    return Visit(t.payload_type());
+  }
+  absl::Status HandleToken(const TokenType& t) override {
+    return absl::OkStatus();
+  }
+  absl::Status HandleStruct(const StructType& t) override {
+    Mix(&t.nominal_type(), t.members().size());
+    for (const std::unique_ptr<ConcreteType>& member : t.members()) {
+      XLS_RETURN_IF_ERROR(Visit(*member));
+    }
+    return absl::OkStatus();
+  }
+  absl::Status HandleTuple(const TupleType& t) override {
+    Mix(t.members().size());
+    for (const std::unique_ptr<ConcreteType>& member : t.members()) {
+      XLS_RETURN_IF_ERROR(Visit(*member));
+    }
+    return absl::OkStatus();
+  }
+  absl::Status HandleArray(const ArrayType& t) override {
+    MixDim(t.size());
+    return Visit(t.element_type());
+  }
+  absl::Status HandleMeta(const MetaType& t) override {
+    return Visit(*t.wrapped());
+  }
+
+  absl::Status Visit(const ConcreteType& t) {
+    // Types of different classes are never equal.
+    Mix(typeid(t).hash_code());
+    return t.Accept(*this);
+  }
+
+ private:
+  template <typename... T>
+  void Mix(const T&... values) {
+    hash_ = absl::HashOf(hash_, values...);
+  }
+
+  void MixDim(const ConcreteTypeDim& dim) {
+    if (dim.IsParametric()) {
+      Mix(dim.parametric().ToString());
+      return;
+    }
+    absl::StatusOr<int64_t> value = dim.GetAsInt64();
+    Mix(value.ok() ? *value : int64_t{0});
+  }
+
+  size_t hash_ = 0;
+};
+
+}  // namespace
+
+size_t HashConcreteType(const ConcreteType& type) {
+  HashVisitor visitor;
+  // The visitor never fails.
+  visitor.Visit(type).IgnoreError();
+  return visitor.hash();
+}
+
+const ConcreteType& ConcreteTypeInterner::Intern(const ConcreteType& type) {
+  std::vector<std::unique_ptr<ConcreteType>>& bucket =
+      buckets_[HashConcreteType(type)];
+  for (const std::unique_ptr<ConcreteType>& interned : bucket) {
+    if (*interned == type) {
+      return *interned;
+    }
+  }
+  bucket.push_back(type.CloneToUnique());
+  ++size_;
+  return *bucket.back();
+}
+
+}  // namespace xls::dslx
@@ -0,0 +1,54 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_TYPE_SYSTEM_CONCRETE_TYPE_INTERNER_H_
+#define XLS_DSLX_TYPE_SYSTEM_CONCRETE_TYPE_INTERNER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "xls/dslx/type_system/concrete_type.h"
+
+namespace xls::dslx {
+
+// Returns a hash of the structure of `type`, consistent with
+// ConcreteType::operator==: equal types have equal hashes.
+size_t HashConcreteType(const ConcreteType& type);
+
+// Hash-consing table of concrete types: holds a single immutable instance of
+// each distinct (per ConcreteType::operator==) type interned into it, so that
+// interned types are compared by identity and stored once no matter how many
+// AST nodes have them.
+class ConcreteTypeInterner {
+ public:
+  // Returns the instance equal to `type`, adding a clone of `type` if there
+  // is none yet. The result lives as long as the interner.
+  const ConcreteType& Intern(const ConcreteType& type);
+
+  // Returns the number of distinct types interned.
+  int64_t size() const { return size_; }
+
+ private:
+  // Interned types by HashConcreteType().
+  absl::flat_hash_map<size_t, std::vector<std::unique_ptr<ConcreteType>>>
+      buckets_;
+  int64_t size_ = 0;
+};
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_TYPE_SYSTEM_CONCRETE_TYPE_INTERNER_H_
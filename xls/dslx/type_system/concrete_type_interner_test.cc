@@ -0,0 +1,71 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/type_system/concrete_type_interner.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xls/dslx/type_system/concrete_type.h"
+
+namespace xls::dslx {
+namespace {
+
+TEST(ConcreteTypeInternerTest, EqualTypesAreInternedOnce) {
+  ConcreteTypeInterner interner;
+  const ConcreteType& u32 = interner.Intern(BitsType(false, 32));
+  EXPECT_EQ(&u32, &interner.Intern(BitsType(false, 32)));
+  EXPECT_EQ(u32, BitsType(false, 32));
+
+  ArrayType array(std::make_unique<BitsType>(false, 8),
+                  ConcreteTypeDim::CreateU32(4));
+  const ConcreteType& interned_array = interner.Intern(array);
+  EXPECT_EQ(&interned_array, &interner.Intern(*array.CloneToUnique()));
+  EXPECT_NE(&interned_array, &array);
+  EXPECT_EQ(interner.size(), 2);
+}
+
+TEST(ConcreteTypeInternerTest, DifferentTypesAreDistinct) {
+  ConcreteTypeInterner interner;
+  const ConcreteType& u32 = interner.Intern(BitsType(false, 32));
+  const ConcreteType& s32 = interner.Intern(BitsType(true, 32));
+  const ConcreteType& u8 = interner.Intern(BitsType(false, 8));
+  EXPECT_NE(&u32, &s32);
+  EXPECT_NE(&u32, &u8);
+
+  std::vector<std::unique_ptr<ConcreteType>> members;
+  members.push_back(BitsType::MakeU8());
+  members.push_back(BitsType::MakeU1());
+  TupleType tuple(std::move(members));
+  const ConcreteType& interned_tuple = interner.Intern(tuple);
+  EXPECT_EQ(&interned_tuple, &interner.Intern(tuple));
+  EXPECT_NE(&interned_tuple, &interner.Intern(TupleType({})));
+
+  ArrayType u8_array(BitsType::MakeU8(), ConcreteTypeDim::CreateU32(2));
+  ArrayType u8_array_3(BitsType::MakeU8(), ConcreteTypeDim::CreateU32(3));
+  EXPECT_NE(&interner.Intern(u8_array), &interner.Intern(u8_array_3));
+  EXPECT_EQ(interner.size(), 7);
+}
+
+TEST(ConcreteTypeInternerTest, HashIsConsistentWithEquality) {
+  ArrayType lhs(BitsType::MakeU8(), ConcreteTypeDim::CreateU32(2));
+  ArrayType rhs(BitsType::MakeU8(), ConcreteTypeDim::CreateU32(2));
+  EXPECT_EQ(HashConcreteType(lhs), HashConcreteType(rhs));
+  EXPECT_NE(HashConcreteType(lhs), HashConcreteType(BitsType(false, 8)));
+}
+
+}  // namespace
+}  // namespace xls::dslx
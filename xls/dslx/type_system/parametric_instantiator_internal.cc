@@ -15,6 +15,7 @@
 #include "xls/dslx/type_system/parametric_instantiator_internal.h"
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -83,6 +84,14 @@ absl::StatusOr<InterpValue> InterpretExpr(DeduceCtx* ctx, Expr* expr,
     ctx = new_ctx_holder.get();
   }
 
+  // The same derived parametrics tend to be computed with the same bindings at
+  // many call sites, so evaluations are memoized.
+  if (std::optional<InterpValue> memoized =
+          ctx->type_info()->GetParametricExprValue(expr, parametric_env);
+      memoized.has_value()) {
+    return *std::move(memoized);
+  }
+
   absl::flat_hash_map<std::string, InterpValue> env;
   XLS_ASSIGN_OR_RETURN(env,
                        MakeConstexprEnv(ctx->import_data(), ctx->type_info(),
@@ -106,6 +115,7 @@ absl::StatusOr<InterpValue> InterpretExpr(DeduceCtx* ctx, Expr* expr,
                          "constexpr evaluation detected rollover in operation");
   }
 
+  ctx->type_info()->NoteParametricExprValue(expr, parametric_env, value);
   return value;
 }
 
@@ -50,7 +50,8 @@ std::string InvocationData::ToString() const {
 
 absl::StatusOr<TypeInfo*> TypeInfoOwner::New(Module* module, TypeInfo* parent) {
   // Note: private constructor so not using make_unique.
-  type_infos_.push_back(absl::WrapUnique(new TypeInfo(module, parent)));
+  type_infos_.push_back(
+      absl::WrapUnique(new TypeInfo(module, parent, interner_.get())));
   TypeInfo* result = type_infos_.back().get();
   if (parent == nullptr) {
     // Check we only have a single nullptr-parent TypeInfo for a given module.
@@ -169,7 +170,8 @@ std::optional<ConcreteType*> TypeInfo::GetItem(const AstNode* key) const {
       << " key: " << key->ToString();
   auto it = dict_.find(key);
   if (it != dict_.end()) {
-    return it->second.get();
+    // Interned types are shared, but ConcreteType has no mutators.
+    return const_cast<ConcreteType*>(it->second);
   }
   if (parent_ != nullptr) {
     return parent_->GetItem(key);
@@ -237,6 +239,27 @@ void TypeInfo::NoteRequiresImplicitToken(const Function* f, bool is_required) {
   root->requires_implicit_token_.emplace(f, is_required);
 }
 
+void TypeInfo::NoteParametricExprValue(const Expr* expr,
+                                       const ParametricEnv& env,
+                                       InterpValue value) {
+  XLS_CHECK_EQ(expr->owner(), module_)
+      << expr->owner()->name() << " vs " << module_->name();
+  GetRoot()->parametric_expr_values_.insert_or_assign(
+      std::make_pair(expr, env), std::move(value));
+}
+
+std::optional<InterpValue> TypeInfo::GetParametricExprValue(
+    const Expr* expr, const ParametricEnv& env) const {
+  XLS_CHECK_EQ(expr->owner(), module_)
+      << expr->owner()->name() << " vs " << module_->name();
+  const TypeInfo* root = GetRoot();
+  auto it = root->parametric_expr_values_.find(std::make_pair(expr, env));
+  if (it == root->parametric_expr_values_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
 std::optional<TypeInfo*> TypeInfo::GetInvocationTypeInfo(
     const Invocation* invocation, const ParametricEnv& caller) const {
   XLS_CHECK_EQ(invocation->owner(), module_)
@@ -405,8 +428,9 @@ std::optional<TypeInfo*> TypeInfo::GetImportedTypeInfo(Module* m) {
   return std::nullopt;
 }
 
-TypeInfo::TypeInfo(Module* module, TypeInfo* parent)
-    : module_(module), parent_(parent) {
+TypeInfo::TypeInfo(Module* module, TypeInfo* parent,
+                   ConcreteTypeInterner* interner)
+    : module_(module), interner_(interner), parent_(parent) {
   XLS_VLOG(6) << "Created type info for module \"" << module_->name() << "\" @ "
               << this << " parent " << parent << " root " << GetRoot();
 }
@@ -21,6 +21,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -30,6 +31,7 @@
 #include "xls/dslx/interp_value.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/type_system/concrete_type.h"
+#include "xls/dslx/type_system/concrete_type_interner.h"
 #include "xls/dslx/type_system/parametric_env.h"
 
 namespace xls::dslx {
@@ -96,6 +98,12 @@ class TypeInfoOwner {
   // module.
   absl::flat_hash_map<const Module*, TypeInfo*> module_to_root_;
 
+  // Interns the types of all the owned type information objects, so that each
+  // distinct type is stored once. Heap allocated so that the TypeInfos'
+  // pointers to it remain valid when the owner is moved.
+  std::unique_ptr<ConcreteTypeInterner> interner_ =
+      std::make_unique<ConcreteTypeInterner>();
+
   // Owned type information objects -- TypeInfoOwner is the lifetime owner for
   // these.
   std::vector<std::unique_ptr<TypeInfo>> type_infos_;
@@ -168,7 +176,7 @@ class TypeInfo {
   // Sets the type associated with the given AST node.
   void SetItem(const AstNode* key, const ConcreteType& value) {
     XLS_CHECK_EQ(key->owner(), module_);
-    dict_[key] = value.CloneToUnique();
+    dict_[key] = &interner_->Intern(value);
   }
 
   // Attempts to resolve AST node 'key' in the node-to-type dictionary.
@@ -241,6 +249,17 @@ class TypeInfo {
   std::optional<InterpValue> GetConstExprOption(
       const AstNode* const_expr) const;
 
+  // Notes the value that the parametric expression `expr` (e.g. the default
+  // expression `{clog2(N)}` of a derived parametric) evaluates to when the
+  // parametrics it may refer to are bound as in `env`. The value depends only
+  // on `expr` and `env`, so these notes live in the root of the tree and are
+  // shared by every instantiation (i.e. call site) which sees the same
+  // bindings.
+  void NoteParametricExprValue(const Expr* expr, const ParametricEnv& env,
+                               InterpValue value);
+  std::optional<InterpValue> GetParametricExprValue(
+      const Expr* expr, const ParametricEnv& env) const;
+
   // Retrieves a string that shows the module associated with this type info and
   // which imported modules are present, suitable for debugging.
   std::string GetImportsDebugString() const;
@@ -252,8 +271,8 @@ class TypeInfo {
 
   // Returns a reference to the underlying mapping that associates an AST node
   // with its deduced type.
-  const absl::flat_hash_map<const AstNode*, std::unique_ptr<ConcreteType>>&
-  dict() const {
+  const absl::flat_hash_map<const AstNode*, const ConcreteType*>& dict()
+      const {
     return dict_;
   }
 
@@ -266,7 +285,8 @@ class TypeInfo {
   //  parent: Type information that should be queried from the same scope (i.e.
   //    if an AST node is not resolved in the local member maps, the lookup is
   //    then performed in the parent, and so on transitively).
-  explicit TypeInfo(Module* module, TypeInfo* parent = nullptr);
+  //  interner: Interns the types of the AST nodes; must outlive this object.
+  TypeInfo(Module* module, TypeInfo* parent, ConcreteTypeInterner* interner);
 
   // Traverses to the 'root' (AKA 'most parent') TypeInfo. This is a place to
   // stash context-free information (e.g. that is found in a parametric
@@ -284,12 +304,16 @@ class TypeInfo {
   }
 
   Module* module_;
-  absl::flat_hash_map<const AstNode*, std::unique_ptr<ConcreteType>> dict_;
+  ConcreteTypeInterner* interner_;
+  // Interned types of the AST nodes.
+  absl::flat_hash_map<const AstNode*, const ConcreteType*> dict_;
   absl::flat_hash_map<Import*, ImportedInfo> imports_;
   absl::flat_hash_map<const Invocation*, InvocationData> invocations_;
   absl::flat_hash_map<Slice*, SliceData> slices_;
   absl::flat_hash_map<const AstNode*, std::optional<InterpValue>> const_exprs_;
   absl::flat_hash_map<const Function*, bool> requires_implicit_token_;
+  absl::flat_hash_map<std::pair<const Expr*, ParametricEnv>, InterpValue>
+      parametric_expr_values_;
 
   // Maps a Proc to the TypeInfo used for its top-level typechecking.
   absl::flat_hash_map<const Proc*, TypeInfo*> top_level_proc_type_info_;
@@ -15,10 +15,16 @@
 #include "xls/dslx/type_system/type_info.h"
 
 #include <optional>
+#include <string>
 
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/matchers.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/frontend/pos.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/dslx/type_system/parametric_env.h"
 
 namespace xls::dslx {
 namespace {
@@ -30,5 +36,28 @@ TEST(TypeInfoTest, Instantiate) {
   EXPECT_EQ(type_info->parent(), nullptr);
 }
 
+TEST(TypeInfoTest, ParametricExprValuesAreSharedWithRoot) {
+  Module module("test", /*fs_path=*/std::nullopt);
+  Number* expr =
+      module.Make<Number>(Span::Fake(), "7", NumberKind::kOther, nullptr);
+  TypeInfoOwner owner;
+  XLS_ASSERT_OK_AND_ASSIGN(TypeInfo * root, owner.New(&module));
+  XLS_ASSERT_OK_AND_ASSIGN(TypeInfo * child, owner.New(&module, root));
+  XLS_ASSERT_OK_AND_ASSIGN(TypeInfo * other_child, owner.New(&module, root));
+
+  ParametricEnv env(absl::flat_hash_map<std::string, InterpValue>{
+      {"N", InterpValue::MakeU32(8)}});
+  ParametricEnv other_env(absl::flat_hash_map<std::string, InterpValue>{
+      {"N", InterpValue::MakeU32(16)}});
+  EXPECT_EQ(child->GetParametricExprValue(expr, env), std::nullopt);
+
+  child->NoteParametricExprValue(expr, env, InterpValue::MakeU32(3));
+  EXPECT_EQ(root->GetParametricExprValue(expr, env), InterpValue::MakeU32(3));
+  EXPECT_EQ(other_child->GetParametricExprValue(expr, env),
+            InterpValue::MakeU32(3));
+  EXPECT_EQ(other_child->GetParametricExprValue(expr, other_env),
+            std::nullopt);
+}
+
 }  // namespace
 }  // namespace xls::dslx
@@ -0,0 +1,111 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/type_system/typecheck_cache.h"
+
+#include <deque>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+
+#include "absl/container/btree_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/type_system/type_info.pb.h"
+
+namespace xls::dslx {
+namespace {
+
+// Bumped whenever the format of the cached type information or the composition
+// of the keys changes.
+constexpr std::string_view kCacheFormatVersion = "xls-typecheck-cache-v1";
+
+}  // namespace
+
+absl::StatusOr<std::optional<TypeInfoProto>> TypecheckCache::Lookup(
+    std::string_view key) const {
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> contents, cache_.Lookup(key));
+  if (!contents.has_value()) {
+    return std::nullopt;
+  }
+  TypeInfoProto type_info;
+  if (!type_info.ParseFromString(*contents)) {
+    return absl::DataLossError(
+        absl::StrFormat("Failed to parse cached type information %s",
+                        cache_.EntryPath(key).string()));
+  }
+  return type_info;
+}
+
+absl::Status TypecheckCache::Insert(std::string_view key,
+                                    const TypeInfoProto& type_info) const {
+  return cache_.Insert(key, type_info.SerializeAsString());
+}
+
+absl::StatusOr<std::string> TypecheckCacheKey(const Module& module,
+                                              std::string_view text,
+                                              ImportData* import_data) {
+  CacheKeyBuilder builder(kCacheFormatVersion);
+  builder.Add(module.name());
+  builder.Add(text);
+
+  // Collect the transitive imports, ordered by name so the key does not depend
+  // on the order in which they are discovered.
+  absl::btree_map<std::string, std::filesystem::path> imports;
+  std::deque<const Module*> worklist = {&module};
+  while (!worklist.empty()) {
+    const Module* importer = worklist.front();
+    worklist.pop_front();
+    for (const ModuleMember& member : importer->top()) {
+      if (!std::holds_alternative<Import*>(member)) {
+        continue;
+      }
+      ImportTokens subject(std::get<Import*>(member)->subject());
+      if (imports.contains(subject.ToString())) {
+        continue;
+      }
+      if (import_data->Contains(subject)) {
+        XLS_ASSIGN_OR_RETURN(ModuleInfo * info, import_data->Get(subject));
+        imports[subject.ToString()] = info->path();
+        worklist.push_back(&info->module());
+      } else if (const ParsedModule* parsed =
+                     import_data->GetPrefetched(subject)) {
+        imports[subject.ToString()] = parsed->path;
+        worklist.push_back(parsed->module.get());
+      } else {
+        return absl::NotFoundError(absl::StrFormat(
+            "Import %s of module %s has not been resolved", subject.ToString(),
+            importer->name()));
+      }
+    }
+  }
+
+  for (const auto& [name, path] : imports) {
+    XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+    builder.Add(name);
+    builder.Add(path.string());
+    builder.Add(contents);
+  }
+  return builder.Finish();
+}
+
+}  // namespace xls::dslx
@@ -0,0 +1,80 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_TYPE_SYSTEM_TYPECHECK_CACHE_H_
+#define XLS_DSLX_TYPE_SYSTEM_TYPECHECK_CACHE_H_
+
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/type_system/type_info.pb.h"
+
+namespace xls::dslx {
+
+// An on-disk cache of the type information deduced for DSLX modules, used by
+// typecheck_main to avoid retypechecking modules which (along with everything
+// they import) are unchanged since a previous run. Each entry is a file in the
+// cache directory named after its key and holding a binary TypeInfoProto. Keys
+// are hex SHA-256 digests (see TypecheckCacheKey), so entries never need to be
+// invalidated; stale entries may simply be deleted.
+//
+// Only typecheck_main, whose output is the TypeInfoProto itself, uses the
+// cache. TypeInfoProto records the type of each node but not constexpr values,
+// parametric invocation data, imports or implicit-token state, and there is
+// no deserializer to a TypeInfo, so tools which need the in-memory TypeInfo
+// (interpreter_main, ir_converter_main, the DSLX test rules) still typecheck.
+class TypecheckCache {
+ public:
+  explicit TypecheckCache(std::filesystem::path directory)
+      : cache_(std::move(directory), ".type_info.pb") {}
+
+  const std::filesystem::path& directory() const { return cache_.directory(); }
+
+  // Returns the type information cached under `key`, or std::nullopt if there
+  // is none.
+  absl::StatusOr<std::optional<TypeInfoProto>> Lookup(
+      std::string_view key) const;
+
+  // Caches `type_info` under `key`, replacing any existing entry (see
+  // ContentAddressedCache::Insert).
+  absl::Status Insert(std::string_view key,
+                      const TypeInfoProto& type_info) const;
+
+ private:
+  ContentAddressedCache cache_;
+};
+
+// Returns the cache key of the type information of `module`, which was parsed
+// from `text`. The key covers the name and text of `module` and the name, path
+// and contents of every module it transitively imports.
+//
+// The transitive imports of `module` must already be imported into
+// `import_data` or prefetched (see PrefetchImports); a NotFound error is
+// returned if any is neither, e.g. because it does not exist. In that case the
+// module should just be typechecked, which reports the problem properly.
+absl::StatusOr<std::string> TypecheckCacheKey(const Module& module,
+                                              std::string_view text,
+                                              ImportData* import_data);
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_TYPE_SYSTEM_TYPECHECK_CACHE_H_
@@ -0,0 +1,113 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/type_system/typecheck_cache.h"
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/import_routines.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/type_system/type_info.pb.h"
+#include "xls/dslx/warning_kind.h"
+
+namespace xls::dslx {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::Not;
+
+constexpr std::string_view kTopText = R"(
+import a
+
+fn main(x: u32) -> u32 { a::f(x) }
+)";
+
+// Computes the cache key of kTopText with modules imported from `dir`.
+absl::StatusOr<std::string> GetKey(const std::filesystem::path& dir,
+                                   std::string_view text = kTopText) {
+  std::vector<std::filesystem::path> search_paths = {dir};
+  ImportData import_data =
+      CreateImportData(kDefaultDslxStdlibPath, search_paths, kAllWarningsSet);
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Module> module,
+                       ParseModule(text, "top.x", "top"));
+  PrefetchImports(*module, &import_data);
+  return TypecheckCacheKey(*module, text, &import_data);
+}
+
+TEST(TypecheckCacheTest, KeyCoversTransitiveImports) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK(SetFileContents(temp_dir.path() / "a.x", R"(
+import b
+pub fn f(x: u32) -> u32 { b::g(x) }
+)"));
+  XLS_ASSERT_OK(SetFileContents(temp_dir.path() / "b.x",
+                                "pub fn g(x: u32) -> u32 { x }\n"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string key, GetKey(temp_dir.path()));
+  EXPECT_THAT(GetKey(temp_dir.path()), IsOkAndHolds(key));
+
+  // Changing the module itself changes the key.
+  EXPECT_THAT(GetKey(temp_dir.path(), absl::StrCat(kTopText, "\n")),
+              IsOkAndHolds(Not(key)));
+
+  // As does changing a module it imports indirectly.
+  XLS_ASSERT_OK(SetFileContents(temp_dir.path() / "b.x",
+                                "pub fn g(x: u32) -> u32 { x + u32:1 }\n"));
+  EXPECT_THAT(GetKey(temp_dir.path()), IsOkAndHolds(Not(key)));
+
+  // No key can be computed if an import cannot be resolved.
+  XLS_ASSERT_OK(SetFileContents(temp_dir.path() / "a.x", R"(
+import missing
+pub fn f(x: u32) -> u32 { x }
+)"));
+  EXPECT_THAT(GetKey(temp_dir.path()),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(TypecheckCacheTest, LookupAndInsert) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  TypecheckCache cache(temp_dir.path() / "cache");
+  EXPECT_THAT(cache.Lookup("key"), IsOkAndHolds(std::nullopt));
+
+  TypeInfoProto type_info;
+  type_info.add_nodes()->set_kind(AST_NODE_KIND_NUMBER);
+  XLS_ASSERT_OK(cache.Insert("key", type_info));
+  XLS_ASSERT_OK_AND_ASSIGN(std::optional<TypeInfoProto> cached,
+                           cache.Lookup("key"));
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_EQ(cached->SerializeAsString(), type_info.SerializeAsString());
+  EXPECT_THAT(cache.Lookup("other_key"), IsOkAndHolds(std::nullopt));
+}
+
+}  // namespace
+}  // namespace xls::dslx
@@ -15,9 +15,11 @@
 #include <cstdlib>
 #include <filesystem>  // NOLINT
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/flags/flag.h"
@@ -29,12 +31,18 @@
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/dslx/command_line_utils.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/import_data.h"
+#include "xls/dslx/import_routines.h"
 #include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/type_system/type_info.pb.h"
 #include "xls/dslx/type_system/type_info_to_proto.h"
+#include "xls/dslx/type_system/typecheck_cache.h"
 #include "xls/dslx/warning_kind.h"
 
 ABSL_FLAG(std::string, dslx_path, "",
@@ -44,6 +52,12 @@ ABSL_FLAG(std::string, dslx_stdlib_path, xls::kDefaultDslxStdlibPath,
 ABSL_FLAG(std::string, output_path, "",
           "Path to dump the type information to as a protobin -- if not "
           "provided textual proto is given on stdout.");
+ABSL_FLAG(std::string, cache_dir, "",
+          "Directory of a cache of type information keyed on the contents of "
+          "the module and its transitive imports. If the module and its "
+          "imports are unchanged since a previous run, the cached type "
+          "information is emitted without typechecking. Only used with "
+          "--output_path.");
 
 namespace xls::dslx {
 namespace {
@@ -53,15 +67,56 @@ Parses and typechecks the specified module and emits the type information that
 was deduced.
 )";
 
+// Returns the key of the module in `input_contents` in the typecheck cache, or
+// std::nullopt if none can be computed (e.g. because the module fails to parse,
+// which typechecking then reports).
+std::optional<std::string> GetCacheKey(std::string_view input_contents,
+                                       const std::filesystem::path& input_path,
+                                       std::string_view module_name,
+                                       ImportData* import_data) {
+  absl::StatusOr<std::unique_ptr<Module>> module =
+      ParseModule(input_contents, input_path.c_str(), module_name);
+  if (!module.ok()) {
+    return std::nullopt;
+  }
+  PrefetchImports(**module, import_data);
+  absl::StatusOr<std::string> key =
+      TypecheckCacheKey(**module, input_contents, import_data);
+  if (!key.ok()) {
+    XLS_VLOG(1) << "Not using the typecheck cache: " << key.status();
+    return std::nullopt;
+  }
+  return *std::move(key);
+}
+
 absl::Status RealMain(absl::Span<const std::filesystem::path> dslx_paths,
                       const std::filesystem::path& dslx_stdlib_path,
                       const std::filesystem::path& input_path,
-                      std::optional<std::filesystem::path> output_path) {
+                      std::optional<std::filesystem::path> output_path,
+                      std::optional<std::filesystem::path> cache_dir) {
   ImportData import_data(CreateImportData(
       dslx_stdlib_path,
       /*additional_search_paths=*/dslx_paths, kAllWarningsSet));
   XLS_ASSIGN_OR_RETURN(std::string input_contents, GetFileContents(input_path));
   XLS_ASSIGN_OR_RETURN(std::string module_name, PathToName(input_path.c_str()));
+
+  std::optional<TypecheckCache> cache;
+  std::optional<std::string> cache_key;
+  if (cache_dir.has_value() && output_path.has_value()) {
+    cache.emplace(*cache_dir);
+    cache_key =
+        GetCacheKey(input_contents, input_path, module_name, &import_data);
+    if (cache_key.has_value()) {
+      XLS_ASSIGN_OR_RETURN(std::optional<TypeInfoProto> cached,
+                           cache->Lookup(*cache_key));
+      if (cached.has_value()) {
+        XLS_VLOG(1) << "Using cached type information for " << module_name;
+        return SetFileContents(output_path->c_str(),
+                               cached->SerializeAsString());
+      }
+    }
+  }
+
   absl::StatusOr<TypecheckedModule> tm_or = ParseAndTypecheck(
       input_contents, input_path.c_str(), module_name, &import_data);
   if (!tm_or.ok()) {
@@ -75,6 +130,9 @@ absl::Status RealMain(absl::Span<const std::filesystem::path> dslx_paths,
   if (output_path.has_value()) {
     std::string output;
     XLS_QCHECK(tip.SerializeToString(&output));
+    if (cache_key.has_value()) {
+      XLS_RETURN_IF_ERROR(cache->Insert(*cache_key, tip));
+    }
     return SetFileContents(output_path->c_str(), output);
   }
   XLS_ASSIGN_OR_RETURN(std::string humanized, ToHumanString(tip, import_data));
@@ -108,8 +166,13 @@ int main(int argc, char* argv[]) {
     dslx_paths.push_back(std::filesystem::path(path));
   }
 
+  std::optional<std::filesystem::path> cache_dir;
+  if (std::string flag = absl::GetFlag(FLAGS_cache_dir); !flag.empty()) {
+    cache_dir = flag;
+  }
+
   std::filesystem::path dslx_stdlib_path(absl::GetFlag(FLAGS_dslx_stdlib_path));
 
-  return xls::ExitStatus(xls::dslx::RealMain(dslx_paths, dslx_stdlib_path,
-                                             input_path, output_path));
+  return xls::ExitStatus(xls::dslx::RealMain(
+      dslx_paths, dslx_stdlib_path, input_path, output_path, cache_dir));
 }
@@ -15,6 +15,7 @@
 #include "xls/fdo/extract_nodes.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -23,6 +24,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "xls/codegen/block_conversion.h"
 #include "xls/codegen/block_generator.h"
 #include "xls/codegen/codegen_options.h"
@@ -43,7 +45,7 @@ namespace xls {
 
 absl::StatusOr<std::string> ExtractNodesAndGetVerilog(
     const absl::flat_hash_set<Node*>& nodes, std::string_view top_module_name,
-    bool flop_inputs_outputs, bool return_all_liveouts) {
+    bool flop_inputs_outputs, bool return_all_liveouts, bool canonical_names) {
   XLS_RET_CHECK(!nodes.empty());
   FunctionBase* f = (*nodes.begin())->function_base();
   XLS_RET_CHECK(std::all_of(nodes.begin(), nodes.end(), [&](Node* node) {
@@ -71,6 +73,17 @@ absl::StatusOr<std::string> ExtractNodesAndGetVerilog(
   auto tmp_package = std::make_unique<xls::Package>(top_module_name);
   auto tmp_f = std::make_unique<Function>(top_module_name, tmp_package.get());
 
+  // Live-ins and sends/receives become parameters of the temporary function.
+  // With canonical names they are named by the order in which they are
+  // created.
+  int64_t param_count = 0;
+  auto param_name = [&](Node* node) -> std::string {
+    if (canonical_names) {
+      return absl::StrCat("in", param_count++);
+    }
+    return node->GetName();
+  };
+
   absl::flat_hash_map<Node*, Node*> node_map;
   std::vector<Node*> live_out;
   for (Node* node : topo_sorted_nodes) {
@@ -86,7 +99,7 @@ absl::StatusOr<std::string> ExtractNodesAndGetVerilog(
             Type * operand_type,
             tmp_package->MapTypeFromOtherPackage(operand->GetType()));
         Node* new_param = tmp_f->AddNode(std::make_unique<Param>(
-            operand->loc(), operand->GetName(), operand_type, tmp_f.get()));
+            operand->loc(), param_name(operand), operand_type, tmp_f.get()));
         node_map[operand] = new_param;
         new_operands.push_back(new_param);
       }
@@ -98,10 +111,14 @@ absl::StatusOr<std::string> ExtractNodesAndGetVerilog(
           Type * node_type,
           tmp_package->MapTypeFromOtherPackage(node->GetType()));
       new_node = tmp_f->AddNode(std::make_unique<xls::Param>(
-          node->loc(), node->GetName(), node_type, tmp_f.get()));
+          node->loc(), param_name(node), node_type, tmp_f.get()));
     } else {
       XLS_ASSIGN_OR_RETURN(new_node,
                            node->CloneInNewFunction(new_operands, tmp_f.get()));
+      if (canonical_names) {
+        // Fall back to a name derived from the id in the temporary package.
+        new_node->ClearName();
+      }
     }
     // Collect the live-out of the set of nodes.
     node_map[node] = new_node;
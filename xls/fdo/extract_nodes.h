@@ -26,9 +26,13 @@ namespace xls {
 
 // Extract the given set of nodes from a function and return the verilog text of
 // them. Flip-flops can be inserted to the live-ins and live-outs optionally.
+// If canonical_names is set, the names of the nodes in the function are not
+// used in the verilog text, so that structurally identical sets of nodes (e.g.,
+// from different versions of a design) produce the same text.
 absl::StatusOr<std::string> ExtractNodesAndGetVerilog(
     const absl::flat_hash_set<Node*>& nodes, std::string_view top_module_name,
-    bool flop_inputs_outputs = false, bool return_all_liveouts = false);
+    bool flop_inputs_outputs = false, bool return_all_liveouts = false,
+    bool canonical_names = false);
 
 }  // namespace xls
 
@@ -169,5 +169,52 @@ endmodule
   EXPECT_EQ(all_liveouts_verilog_text, expected_all_liveouts_verilog_text);
 }
 
+TEST_F(ExtractNodesTest, ExtractionWithCanonicalNames) {
+  std::string ir_text = R"(
+package p
+
+fn main(i0: bits[3], i1: bits[3]) -> bits[3] {
+  add.1: bits[3] = add(i0, i1)
+  ret sub.2: bits[3] = sub(add.1, i1)
+}
+
+fn renamed(a: bits[3], b: bits[3]) -> bits[3] {
+  sum: bits[3] = add(a, b)
+  ret difference: bits[3] = sub(sum, b)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * main, package->GetFunction("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * renamed,
+                           package->GetFunction("renamed"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string verilog_text,
+      ExtractNodesAndGetVerilog({FindNode("sub.2", main)}, "test",
+                                /*flop_inputs_outputs=*/false,
+                                /*return_all_liveouts=*/false,
+                                /*canonical_names=*/true));
+  std::string expected_verilog_text = R"(module test(
+  input wire [2:0] in0,
+  input wire [2:0] in1,
+  output wire [2:0] out
+);
+  wire [2:0] sub_6;
+  assign sub_6 = in0 - in1;
+  assign out = sub_6;
+endmodule
+)";
+  EXPECT_EQ(verilog_text, expected_verilog_text);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string renamed_verilog_text,
+      ExtractNodesAndGetVerilog({FindNode("difference", renamed)}, "test",
+                                /*flop_inputs_outputs=*/false,
+                                /*return_all_liveouts=*/false,
+                                /*canonical_names=*/true));
+  EXPECT_EQ(renamed_verilog_text, expected_verilog_text);
+}
+
 }  // namespace
 }  // namespace xls
@@ -14,15 +14,32 @@
 
 #include "xls/fdo/synthesizer.h"
 
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <memory>
 #include <string>
 #include <string_view>
+#include <system_error>  // NOLINT
+#include <thread>        // NOLINT
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "openssl/sha.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/thread.h"
 #include "xls/fdo/extract_nodes.h"
@@ -31,28 +48,64 @@
 
 namespace xls {
 namespace synthesis {
+namespace {
+
+// Bumped whenever the format of the cache entries or the composition of the
+// keys changes.
+constexpr std::string_view kCacheFormatVersion = "xls-synthesis-cache-v1";
+
+// Returns the hex SHA-256 digest of a sequence of strings. Each string is
+// prefixed with its length so distinct sequences have distinct encodings.
+std::string Sha256Digest(absl::Span<const std::string_view> strings) {
+  SHA256_CTX ctx;
+  SHA256_Init(&ctx);
+  for (std::string_view s : strings) {
+    uint64_t size = s.size();
+    SHA256_Update(&ctx, &size, sizeof(size));
+    SHA256_Update(&ctx, s.data(), s.size());
+  }
+  uint8_t digest[SHA256_DIGEST_LENGTH];
+  SHA256_Final(digest, &ctx);
+  return absl::BytesToHexString(std::string_view(
+      reinterpret_cast<const char *>(digest), SHA256_DIGEST_LENGTH));
+}
+
+}  // namespace
+
+Synthesizer::Synthesizer(std::string_view name)
+    : name_(name),
+      max_concurrency_(
+          std::max<int64_t>(1, std::thread::hardware_concurrency())) {}
 
 absl::StatusOr<std::vector<int64_t>>
 Synthesizer::SynthesizeNodesConcurrentlyAndGetDelays(
     absl::Span<const absl::flat_hash_set<Node *>> nodes_list) const {
-  // Launches multi-threading delay estimation.
-  std::vector<absl::StatusOr<int64_t>> results;
-  std::vector<std::unique_ptr<Thread>> threads;
-  results.reserve(nodes_list.size());
-  absl::StatusOr<int64_t> init_val = 0;
-  for (const absl::flat_hash_set<Node *> &nodes : nodes_list) {
-    results.push_back(init_val);
-    absl::StatusOr<int64_t> &dest = results.back();
-    // TODO(hanchenye): 2023-08-14 Use a thread pool structure that we can
-    // schedule on.
-    threads.push_back(std::make_unique<Thread>(
-        [&]() { dest = SynthesizeNodesAndGetDelay(nodes); }));
+  if (nodes_list.empty()) {
+    return std::vector<int64_t>();
   }
+  std::vector<absl::StatusOr<int64_t>> results(nodes_list.size());
 
-  // Records the estimated delays.
-  for (auto &t : threads) {
-    t->Join();
+  // Launches a bounded pool of workers which synthesize the sets of nodes in
+  // turn. Each synthesis typically runs external tools in a subprocess, so
+  // running too many at once only thrashes the machine.
+  std::atomic<int64_t> next_index = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_index++; i < nodes_list.size(); i = next_index++) {
+      results[i] = SynthesizeNodesAndGetDelay(nodes_list[i]);
+    }
+  };
+  {
+    int64_t thread_count =
+        std::clamp<int64_t>(max_concurrency_, 1, nodes_list.size());
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t i = 0; i < thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    // Threads are joined on destruction.
   }
+
+  // Records the estimated delays.
   std::vector<int64_t> delay_list;
   delay_list.reserve(results.size());
   for (absl::StatusOr<int64_t> result : results) {
@@ -85,5 +138,79 @@ absl::StatusOr<int64_t> YosysSynthesizer::SynthesizeNodesAndGetDelay(
   return nodes_delay;
 }
 
+CachingSynthesizer::CachingSynthesizer(
+    std::unique_ptr<Synthesizer> synthesizer,
+    std::filesystem::path cache_directory, std::string_view cache_context)
+    : Synthesizer(synthesizer->name()),
+      synthesizer_(std::move(synthesizer)),
+      cache_directory_(std::move(cache_directory)),
+      context_digest_(Sha256Digest(
+          {kCacheFormatVersion, synthesizer_->name(), cache_context})) {}
+
+std::string CachingSynthesizer::CacheKey(
+    std::string_view verilog_text, std::string_view top_module_name) const {
+  return Sha256Digest({context_digest_, top_module_name, verilog_text});
+}
+
+std::filesystem::path CachingSynthesizer::EntryPath(
+    std::string_view key) const {
+  return cache_directory_ / absl::StrCat(key, ".delay");
+}
+
+absl::StatusOr<int64_t> CachingSynthesizer::SynthesizeVerilogAndGetDelay(
+    std::string_view verilog_text, std::string_view top_module_name) const {
+  std::string key = CacheKey(verilog_text, top_module_name);
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = delays_.find(key);
+    if (it != delays_.end()) {
+      return it->second;
+    }
+  }
+
+  int64_t delay;
+  std::filesystem::path path = EntryPath(key);
+  if (FileExists(path).ok()) {
+    XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+    if (!absl::SimpleAtoi(contents, &delay)) {
+      return absl::DataLossError(absl::StrFormat(
+          "Failed to parse cached synthesis delay %s", path.string()));
+    }
+    XLS_VLOG(2) << "Synthesis cache hit: " << path;
+  } else {
+    XLS_ASSIGN_OR_RETURN(delay, synthesizer_->SynthesizeVerilogAndGetDelay(
+                                    verilog_text, top_module_name));
+    // Write to a temporary file and rename it so concurrent readers, including
+    // other processes, never observe a partially written entry.
+    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(cache_directory_));
+    std::filesystem::path temp_path = path;
+    static std::atomic<int64_t> next_temp_id = 0;
+    temp_path += absl::StrFormat(".tmp.%d.%d", getpid(), next_temp_id++);
+    XLS_RETURN_IF_ERROR(SetFileContents(temp_path, absl::StrCat(delay)));
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+      return absl::InternalError(
+          absl::StrFormat("Failed to rename %s to %s: %s", temp_path.string(),
+                          path.string(), ec.message()));
+    }
+  }
+
+  absl::MutexLock lock(&mutex_);
+  delays_[key] = delay;
+  return delay;
+}
+
+absl::StatusOr<int64_t> CachingSynthesizer::SynthesizeNodesAndGetDelay(
+    const absl::flat_hash_set<Node *> &nodes) const {
+  std::string top_name = "tmp_module";
+  XLS_ASSIGN_OR_RETURN(
+      std::string verilog_text,
+      ExtractNodesAndGetVerilog(nodes, top_name, /*flop_inputs_outputs=*/true,
+                                /*return_all_liveouts=*/false,
+                                /*canonical_names=*/true));
+  return SynthesizeVerilogAndGetDelay(verilog_text, top_name);
+}
+
 }  // namespace synthesis
 }  // namespace xls
@@ -16,12 +16,17 @@
 #define XLS_FDO_SYNTHESIZERS_H_
 
 #include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/ir/node.h"
 #include "xls/synthesis/yosys/yosys_synthesis_service.h"
@@ -32,11 +37,16 @@ namespace synthesis {
 // An abstract class of a synthesis service.
 class Synthesizer {
  public:
-  explicit Synthesizer(std::string_view name) : name_(name) {}
+  explicit Synthesizer(std::string_view name);
   virtual ~Synthesizer() = default;
 
   const std::string &name() const { return name_; }
 
+  // The maximum number of sets of nodes synthesized at once by
+  // "SynthesizeNodesConcurrentlyAndGetDelays". Defaults to the number of CPUs.
+  int64_t max_concurrency() const { return max_concurrency_; }
+  void set_max_concurrency(int64_t value) { max_concurrency_ = value; }
+
   // Synthesizes the given Verilog module with a synthesis tool and return its
   // overall delay.
   virtual absl::StatusOr<int64_t> SynthesizeVerilogAndGetDelay(
@@ -51,7 +61,8 @@ class Synthesizer {
       const absl::flat_hash_set<Node *> &nodes) const = 0;
 
   // Launches "SynthesizeNodesAndGetDelay" concurrently for each set of nodes
-  // listed in "nodes_list" and get their delays.
+  // listed in "nodes_list" and get their delays. At most "max_concurrency"
+  // sets are synthesized at once.
   absl::StatusOr<std::vector<int64_t>> SynthesizeNodesConcurrentlyAndGetDelays(
       absl::Span<const absl::flat_hash_set<Node *>> nodes_list) const;
 
@@ -59,6 +70,8 @@ class Synthesizer {
   // Records the name of the concreate synthesizer, e.g., yosys, for management
   // and debugging purpose.
   std::string name_;
+
+  int64_t max_concurrency_;
 };
 
 // A derived Synthesizer class for Yosys-OpenSTA-based synthesis and static
@@ -88,6 +101,47 @@ class YosysSynthesizer : public Synthesizer {
   YosysSynthesisServiceImpl service_;
 };
 
+// A Synthesizer which caches the delays reported by another synthesizer, in
+// memory and in files in a cache directory. The cache persists across runs, so
+// FDO iterations and later runs on the same or an edited design (and the delay
+// manager refined from their results) skip the synthesis of nodes which were
+// synthesized before.
+//
+// Sets of nodes are extracted into Verilog with canonical names, as
+// YosysSynthesizer does with the original names, and are keyed by the Verilog
+// text. Structurally identical sets of nodes, such as the same cut in two
+// versions of a design, therefore share an entry.
+class CachingSynthesizer : public Synthesizer {
+ public:
+  // "cache_context" identifies the configuration of "synthesizer" which
+  // affects the delays it reports, e.g., the cell library; entries are only
+  // shared between synthesizers with the same name and context.
+  CachingSynthesizer(std::unique_ptr<Synthesizer> synthesizer,
+                     std::filesystem::path cache_directory,
+                     std::string_view cache_context);
+
+  absl::StatusOr<int64_t> SynthesizeVerilogAndGetDelay(
+      std::string_view verilog_text,
+      std::string_view top_module_name) const override;
+
+  absl::StatusOr<int64_t> SynthesizeNodesAndGetDelay(
+      const absl::flat_hash_set<Node *> &nodes) const override;
+
+ private:
+  std::string CacheKey(std::string_view verilog_text,
+                       std::string_view top_module_name) const;
+  std::filesystem::path EntryPath(std::string_view key) const;
+
+  std::unique_ptr<Synthesizer> synthesizer_;
+  std::filesystem::path cache_directory_;
+  // SHA-256 digest of the name of the synthesizer and the cache context.
+  std::string context_digest_;
+
+  mutable absl::Mutex mutex_;
+  mutable absl::flat_hash_map<std::string, int64_t> delays_
+      ABSL_GUARDED_BY(mutex_);
+};
+
 }  // namespace synthesis
 }  // namespace xls
 
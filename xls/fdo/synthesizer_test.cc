@@ -0,0 +1,171 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fdo/synthesizer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+namespace synthesis {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::ElementsAre;
+
+// A synthesizer which reports the length of the Verilog text as its delay and
+// counts how often it is invoked.
+class FakeSynthesizer : public Synthesizer {
+ public:
+  explicit FakeSynthesizer(std::atomic<int64_t>* synthesis_count)
+      : Synthesizer("fake"), synthesis_count_(synthesis_count) {}
+
+  absl::StatusOr<int64_t> SynthesizeVerilogAndGetDelay(
+      std::string_view verilog_text,
+      std::string_view top_module_name) const override {
+    ++*synthesis_count_;
+    return verilog_text.size();
+  }
+
+  absl::StatusOr<int64_t> SynthesizeNodesAndGetDelay(
+      const absl::flat_hash_set<Node*>& nodes) const override {
+    int64_t running = ++running_;
+    int64_t peak = peak_running_.load();
+    while (running > peak &&
+           !peak_running_.compare_exchange_weak(peak, running)) {
+    }
+    absl::SleepFor(absl::Milliseconds(10));
+    --running_;
+    ++*synthesis_count_;
+    return nodes.size();
+  }
+
+  int64_t peak_running() const { return peak_running_.load(); }
+
+ private:
+  std::atomic<int64_t>* synthesis_count_;
+  mutable std::atomic<int64_t> running_ = 0;
+  mutable std::atomic<int64_t> peak_running_ = 0;
+};
+
+class SynthesizerTest : public IrTestBase {};
+
+TEST_F(SynthesizerTest, ConcurrentSynthesisIsBounded) {
+  std::string ir_text = R"(
+package p
+
+fn main(i0: bits[3], i1: bits[3]) -> bits[3] {
+  add.1: bits[3] = add(i0, i1)
+  ret sub.2: bits[3] = sub(add.1, i1)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetFunction("main"));
+  Node* add = FindNode("add.1", f);
+  Node* sub = FindNode("sub.2", f);
+
+  std::atomic<int64_t> synthesis_count = 0;
+  FakeSynthesizer synthesizer(&synthesis_count);
+  synthesizer.set_max_concurrency(2);
+  std::vector<absl::flat_hash_set<Node*>> nodes_list;
+  for (int64_t i = 0; i < 8; ++i) {
+    nodes_list.push_back(i % 2 == 0 ? absl::flat_hash_set<Node*>{add}
+                                    : absl::flat_hash_set<Node*>{add, sub});
+  }
+  EXPECT_THAT(synthesizer.SynthesizeNodesConcurrentlyAndGetDelays(nodes_list),
+              IsOkAndHolds(ElementsAre(1, 2, 1, 2, 1, 2, 1, 2)));
+  EXPECT_EQ(synthesis_count.load(), 8);
+  EXPECT_LE(synthesizer.peak_running(), 2);
+
+  EXPECT_THAT(synthesizer.SynthesizeNodesConcurrentlyAndGetDelays({}),
+              IsOkAndHolds(ElementsAre()));
+}
+
+TEST_F(SynthesizerTest, CachingSynthesizerReusesDelays) {
+  std::string ir_text = R"(
+package p
+
+fn main(i0: bits[3], i1: bits[3]) -> bits[3] {
+  add.1: bits[3] = add(i0, i1)
+  ret sub.2: bits[3] = sub(add.1, i1)
+}
+
+fn renamed(a: bits[3], b: bits[3]) -> bits[3] {
+  sum: bits[3] = add(a, b)
+  ret difference: bits[3] = sub(sum, b)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * main, package->GetFunction("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * renamed,
+                           package->GetFunction("renamed"));
+  absl::flat_hash_set<Node*> main_nodes = {FindNode("add.1", main),
+                                           FindNode("sub.2", main)};
+  absl::flat_hash_set<Node*> renamed_nodes = {FindNode("sum", renamed),
+                                              FindNode("difference", renamed)};
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+
+  std::atomic<int64_t> synthesis_count = 0;
+  CachingSynthesizer synthesizer(
+      std::make_unique<FakeSynthesizer>(&synthesis_count), temp_dir.path(),
+      "library");
+  XLS_ASSERT_OK_AND_ASSIGN(int64_t delay,
+                           synthesizer.SynthesizeNodesAndGetDelay(main_nodes));
+  EXPECT_EQ(synthesis_count.load(), 1);
+  EXPECT_THAT(synthesizer.SynthesizeNodesAndGetDelay(main_nodes),
+              IsOkAndHolds(delay));
+  EXPECT_EQ(synthesis_count.load(), 1);
+
+  // Structurally identical nodes share the entry.
+  EXPECT_THAT(synthesizer.SynthesizeNodesAndGetDelay(renamed_nodes),
+              IsOkAndHolds(delay));
+  EXPECT_EQ(synthesis_count.load(), 1);
+
+  // The entry persists in the cache directory.
+  CachingSynthesizer warm_synthesizer(
+      std::make_unique<FakeSynthesizer>(&synthesis_count), temp_dir.path(),
+      "library");
+  EXPECT_THAT(warm_synthesizer.SynthesizeNodesAndGetDelay(main_nodes),
+              IsOkAndHolds(delay));
+  EXPECT_EQ(synthesis_count.load(), 1);
+
+  // Entries are not shared with a different cache context.
+  CachingSynthesizer other_synthesizer(
+      std::make_unique<FakeSynthesizer>(&synthesis_count), temp_dir.path(),
+      "other_library");
+  EXPECT_THAT(other_synthesizer.SynthesizeNodesAndGetDelay(main_nodes),
+              IsOkAndHolds(delay));
+  EXPECT_EQ(synthesis_count.load(), 2);
+}
+
+}  // namespace
+}  // namespace synthesis
+}  // namespace xls
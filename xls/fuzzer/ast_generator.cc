@@ -2317,28 +2317,188 @@ int OpProbability(OpChoice op) {
   XLS_LOG(FATAL) << "Invalid op choice: " << static_cast<int64_t>(op);
 }
 
-std::discrete_distribution<int>& GetOpDistribution(bool generate_proc) {
-  auto dist = [&](bool generate_proc) {
-    static const std::set<int> proc_ops = {int{kChannelOp}, int{kJoinOp}};
-    std::vector<int> tmp;
-    tmp.reserve(int{kEndSentinel});
-    for (int i = 0; i < int{kEndSentinel}; ++i) {
-      // When not generating a proc, do not generate proc operations by setting
-      // its probability to zero.
-      if (!generate_proc && proc_ops.find(i) != proc_ops.end()) {
-        tmp.push_back(0);
-        continue;
-      }
-      tmp.push_back(OpProbability(static_cast<OpChoice>(i)));
+// Returns the names of the IR ops which generating the given kind of
+// expression typically produces.
+absl::Span<const std::string_view> OpIrOps(OpChoice op) {
+  switch (op) {
+    case kArray: {
+      static constexpr std::string_view kOps[] = {"array"};
+      return kOps;
     }
-    return std::discrete_distribution<int>(tmp.begin(), tmp.end());
-  };
-  static std::discrete_distribution<int> func_dist = dist(false);
-  static std::discrete_distribution<int> proc_dist = dist(true);
-  if (generate_proc) {
-    return proc_dist;
+    case kArrayIndex: {
+      static constexpr std::string_view kOps[] = {"array_index"};
+      return kOps;
+    }
+    case kArrayUpdate: {
+      static constexpr std::string_view kOps[] = {"array_update"};
+      return kOps;
+    }
+    case kArraySlice: {
+      static constexpr std::string_view kOps[] = {"array_slice"};
+      return kOps;
+    }
+    case kBinop: {
+      static constexpr std::string_view kOps[] = {
+          "add", "sub", "umul", "smul", "and", "or", "xor", "udiv", "sdiv"};
+      return kOps;
+    }
+    case kBitSlice: {
+      static constexpr std::string_view kOps[] = {"bit_slice",
+                                                  "dynamic_bit_slice"};
+      return kOps;
+    }
+    case kBitSliceUpdate: {
+      static constexpr std::string_view kOps[] = {"bit_slice_update"};
+      return kOps;
+    }
+    case kBitwiseReduction: {
+      static constexpr std::string_view kOps[] = {"and_reduce", "or_reduce",
+                                                  "xor_reduce"};
+      return kOps;
+    }
+    case kChannelOp: {
+      static constexpr std::string_view kOps[] = {"send", "receive"};
+      return kOps;
+    }
+    case kCompareOp: {
+      static constexpr std::string_view kOps[] = {
+          "eq", "ne", "ult", "ule", "ugt", "uge", "slt", "sle", "sgt", "sge"};
+      return kOps;
+    }
+    case kCompareArrayOp:
+    case kCompareTupleOp: {
+      static constexpr std::string_view kOps[] = {"eq", "ne"};
+      return kOps;
+    }
+    case kMatchOp: {
+      static constexpr std::string_view kOps[] = {"sel", "priority_sel"};
+      return kOps;
+    }
+    case kConcat: {
+      static constexpr std::string_view kOps[] = {"concat"};
+      return kOps;
+    }
+    case kCountedFor: {
+      static constexpr std::string_view kOps[] = {"counted_for"};
+      return kOps;
+    }
+    case kGate: {
+      static constexpr std::string_view kOps[] = {"gate"};
+      return kOps;
+    }
+    case kInvoke: {
+      static constexpr std::string_view kOps[] = {"invoke"};
+      return kOps;
+    }
+    case kJoinOp: {
+      static constexpr std::string_view kOps[] = {"after_all"};
+      return kOps;
+    }
+    case kMap: {
+      static constexpr std::string_view kOps[] = {"map"};
+      return kOps;
+    }
+    case kOneHotSelectBuiltin: {
+      static constexpr std::string_view kOps[] = {"one_hot_sel"};
+      return kOps;
+    }
+    case kPartialProduct: {
+      static constexpr std::string_view kOps[] = {"umulp", "smulp"};
+      return kOps;
+    }
+    case kPrioritySelectBuiltin: {
+      static constexpr std::string_view kOps[] = {"priority_sel"};
+      return kOps;
+    }
+    case kSignExtendBuiltin: {
+      static constexpr std::string_view kOps[] = {"sign_ext"};
+      return kOps;
+    }
+    case kShiftOp: {
+      static constexpr std::string_view kOps[] = {"shll", "shrl", "shra"};
+      return kOps;
+    }
+    case kTupleOrIndex: {
+      static constexpr std::string_view kOps[] = {"tuple", "tuple_index"};
+      return kOps;
+    }
+    case kUnop: {
+      static constexpr std::string_view kOps[] = {"not", "neg"};
+      return kOps;
+    }
+    case kUnopBuiltin: {
+      static constexpr std::string_view kOps[] = {"reverse", "one_hot",
+                                                  "encode"};
+      return kOps;
+    }
+    // Literals are produced by nearly every expression and logical ops and
+    // bits-array casts produce ops shared with other kinds, so these are not
+    // reweighted.
+    case kCastToBitsArray:
+    case kLogical:
+    case kNumber:
+    case kEndSentinel:
+      return {};
+  }
+  XLS_LOG(FATAL) << "Invalid op choice: " << static_cast<int64_t>(op);
+}
+
+// Returns the factor by which to scale the probability of generating each kind
+// of expression given the counts of IR ops seen so far. Kinds producing ops
+// seen less often than average are made up to 4x more likely, and those
+// producing ops seen more often up to 4x less likely.
+std::vector<double> OpCoverageWeights(
+    const absl::flat_hash_map<std::string, int64_t>& ir_op_counts) {
+  std::vector<double> weights(int{kEndSentinel}, 1.0);
+  if (ir_op_counts.empty()) {
+    return weights;
+  }
+  std::vector<std::optional<double>> op_counts(int{kEndSentinel});
+  double total = 0.0;
+  int64_t counted = 0;
+  for (int i = 0; i < int{kEndSentinel}; ++i) {
+    absl::Span<const std::string_view> ir_ops =
+        OpIrOps(static_cast<OpChoice>(i));
+    if (ir_ops.empty()) {
+      continue;
+    }
+    double sum = 0.0;
+    for (std::string_view ir_op : ir_ops) {
+      auto it = ir_op_counts.find(ir_op);
+      sum += it == ir_op_counts.end() ? 0.0 : static_cast<double>(it->second);
+    }
+    op_counts[i] = sum / static_cast<double>(ir_ops.size());
+    total += *op_counts[i];
+    ++counted;
+  }
+  double mean = total / static_cast<double>(counted);
+  for (int i = 0; i < int{kEndSentinel}; ++i) {
+    if (op_counts[i].has_value()) {
+      weights[i] =
+          std::clamp(std::sqrt((mean + 1.0) / (*op_counts[i] + 1.0)), 0.25,
+                     4.0);
+    }
+  }
+  return weights;
+}
+
+std::discrete_distribution<int> MakeOpDistribution(
+    bool generate_proc,
+    const absl::flat_hash_map<std::string, int64_t>& ir_op_counts) {
+  static const std::set<int> proc_ops = {int{kChannelOp}, int{kJoinOp}};
+  std::vector<double> weights = OpCoverageWeights(ir_op_counts);
+  std::vector<double> tmp;
+  tmp.reserve(int{kEndSentinel});
+  for (int i = 0; i < int{kEndSentinel}; ++i) {
+    // When not generating a proc, do not generate proc operations by setting
+    // its probability to zero.
+    if (!generate_proc && proc_ops.find(i) != proc_ops.end()) {
+      tmp.push_back(0);
+      continue;
+    }
+    tmp.push_back(OpProbability(static_cast<OpChoice>(i)) * weights[i]);
   }
-  return func_dist;
+  return std::discrete_distribution<int>(tmp.begin(), tmp.end());
 }
 
 }  // namespace
@@ -2358,7 +2518,9 @@ absl::StatusOr<TypedExpr> AstGenerator::GenerateExpr(int64_t expr_size,
   while (true) {
     absl::StatusOr<TypedExpr> generated;
 
-    int choice = GetOpDistribution(ctx->is_generating_proc)(value_gen_->rng());
+    int choice = ctx->is_generating_proc
+                     ? proc_op_distribution_(value_gen_->rng())
+                     : function_op_distribution_(value_gen_->rng());
     switch (static_cast<OpChoice>(choice)) {
       case kArray:
         generated = GenerateArray(ctx);
@@ -2885,6 +3047,10 @@ AstGenerator::AstGenerator(AstGeneratorOptions options,
     : value_gen_(XLS_DIE_IF_NULL(value_gen)),
       options_(options),
       fake_pos_("<fake>", 0, 0),
-      fake_span_(fake_pos_, fake_pos_) {}
+      fake_span_(fake_pos_, fake_pos_),
+      function_op_distribution_(
+          MakeOpDistribution(/*generate_proc=*/false, options_.ir_op_counts)),
+      proc_op_distribution_(
+          MakeOpDistribution(/*generate_proc=*/true, options_.ir_op_counts)) {}
 
 }  // namespace xls::dslx
@@ -123,6 +123,12 @@ struct AstGeneratorOptions {
   // include an empty tuple). Its value is only meaningful when generate_proc is
   // `true`.
   bool emit_stateless_proc = false;
+
+  // Number of occurrences of each IR op (keyed by op name, e.g. "add") in the
+  // IR of the samples generated so far. When non-empty, generation is biased
+  // toward the kinds of expressions which produce rarely seen ops and away
+  // from those which produce commonly seen ones.
+  absl::flat_hash_map<std::string, int64_t> ir_op_counts;
 };
 
 // Type that generates a random module for use in fuzz testing; i.e.
@@ -707,6 +713,11 @@ class AstGenerator {
 
   absl::btree_set<BinopKind> binops_;
 
+  // Distributions of the kinds of expressions generated in functions and in
+  // procs respectively (see `AstGeneratorOptions::ir_op_counts`).
+  std::discrete_distribution<int> function_op_distribution_;
+  std::discrete_distribution<int> proc_op_distribution_;
+
   std::unique_ptr<Module> module_;
 
   int64_t next_name_index_ = 0;
@@ -173,6 +173,44 @@ TEST(AstGeneratorTest, GeneratesValidProcsWithRandomState) {
   }
 }
 
+// Tests that IR op counts bias generation toward expressions producing rarely
+// seen ops, and that the generated functions remain valid.
+TEST(AstGeneratorTest, OpCountsBiasGeneration) {
+  auto count_for_loops =
+      [](const AstGeneratorOptions& options) -> absl::StatusOr<int64_t> {
+    ValueGenerator value_gen(std::mt19937_64{0});
+    int64_t for_loops = 0;
+    for (int64_t i = 0; i < 32; ++i) {
+      AstGenerator g(options, &value_gen);
+      std::string module_name = absl::StrFormat("sample_%d", i);
+      XLS_ASSIGN_OR_RETURN(AnnotatedModule module,
+                           g.Generate("main", module_name));
+      std::string text = module.module->ToString();
+      XLS_RETURN_IF_ERROR(ParseAndTypecheck<Function>(text, module_name));
+      for (size_t pos = text.find("for ("); pos != std::string::npos;
+           pos = text.find("for (", pos + 1)) {
+        ++for_loops;
+      }
+    }
+    return for_loops;
+  };
+
+  AstGeneratorOptions options;
+  XLS_ASSERT_OK_AND_ASSIGN(int64_t baseline_for_loops,
+                           count_for_loops(options));
+
+  // Every op commonly seen except for counted_for.
+  for (std::string_view op :
+       {"add", "sub", "and", "or", "xor", "not", "neg", "concat", "bit_slice",
+        "tuple", "tuple_index", "array", "array_index", "eq", "ne", "ult",
+        "sel", "priority_sel", "shll", "shrl", "shra", "sign_ext", "map",
+        "invoke"}) {
+    options.ir_op_counts[std::string(op)] = 1000;
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(int64_t biased_for_loops, count_for_loops(options));
+  EXPECT_GT(biased_for_loops, baseline_for_loops);
+}
+
 // Helper function that is used in a TEST_P so we can shard the work.
 static void TestRepeatable(uint64_t seed) {
   AstGeneratorOptions options;
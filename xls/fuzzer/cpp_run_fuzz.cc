@@ -57,7 +57,8 @@ absl::Status WriteToFile(const std::filesystem::path& dir_path,
 absl::StatusOr<std::optional<std::filesystem::path>> MinimizeIr(
     const Sample& smp, std::filesystem::path run_dir,
     std::optional<std::string> inject_jit_result,
-    std::optional<absl::Duration> timeout) {
+    std::optional<absl::Duration> timeout,
+    std::optional<std::filesystem::path> stage_cache_dir) {
   XLS_VLOG(3) << "MinimizeIr; run_dir: " << run_dir;
   if (!std::filesystem::exists(run_dir / "sample.ir")) {
     XLS_VLOG(3) << "sample.ir file did not exist within: " << run_dir;
@@ -79,6 +80,12 @@ absl::StatusOr<std::optional<std::filesystem::path>> MinimizeIr(
         std::string{sample_runner_main_path}, "--logtostderr",
         "--options_file=ir_minimizer.options.pbtxt", "--args_file=args.txt",
         "--input_file=$1"};
+    if (stage_cache_dir.has_value()) {
+      // Candidates which only differ in ways optimization removes share the
+      // downstream stages.
+      args.push_back(
+          absl::StrCat("--stage_cache_dir=", stage_cache_dir->string()));
+    }
     XLS_RETURN_IF_ERROR(
         WriteToFile(run_dir, "ir_minimizer_test.sh",
                     absl::StrCat("#!/bin/sh\n! ", absl::StrJoin(args, " ")),
@@ -36,6 +36,8 @@ namespace xls {
 //   run_dir: The run directory the sample was run in.
 //   inject_jit_result: For testing only. Value to produce as the JIT result.
 //   timeout: Timeout for running the minimizer.
+//   stage_cache_dir: Directory in which the sample runner memoizes the results
+//     of the stages of the pipelines run by the minimizer.
 //
 // Returns:
 //   The path to the minimized IR file (created in the `run_dir`), or nullopt if
@@ -43,7 +45,8 @@ namespace xls {
 absl::StatusOr<std::optional<std::filesystem::path>> MinimizeIr(
     const Sample& smp, std::filesystem::path run_dir,
     std::optional<std::string> inject_jit_result,
-    std::optional<absl::Duration> timeout);
+    std::optional<absl::Duration> timeout,
+    std::optional<std::filesystem::path> stage_cache_dir = std::nullopt);
 
 }  // namespace xls
 
@@ -15,14 +15,30 @@
 #include "xls/fuzzer/cpp_sample_runner.h"
 
 #include <algorithm>
+#include <filesystem>  // NOLINT
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/interp_value_helpers.h"
+#include "xls/dslx/ir_convert/ir_converter.h"
+#include "xls/dslx/warning_kind.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/tools/opt.h"
 
 namespace xls {
 namespace {
@@ -118,4 +134,59 @@ absl::Status CompareResultsFunction(
   return absl::OkStatus();
 }
 
+absl::StatusOr<std::string> ConvertDslxSampleToIr(
+    const std::filesystem::path& path, std::optional<std::string_view> top,
+    bool warnings_as_errors) {
+  const dslx::ConvertOptions convert_options = {
+      .emit_positions = true,
+      .emit_fail_as_assert = true,
+      .verify_ir = true,
+      .warnings_as_errors = warnings_as_errors,
+      .enabled_warnings = dslx::kAllWarningsSet,
+  };
+  std::string path_str = path.string();
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<Package> package,
+      dslx::ConvertFilesToPackage({std::string_view(path_str)},
+                                  kDefaultDslxStdlibPath,
+                                  /*dslx_paths=*/{}, convert_options, top));
+  return package->DumpIr();
+}
+
+absl::StatusOr<std::string> OptimizeSampleIr(std::string_view ir_text) {
+  return tools::OptimizeIrForTop(ir_text, tools::OptOptions{});
+}
+
+absl::StatusOr<std::vector<dslx::InterpValue>> EvaluateIrFunction(
+    std::string_view ir_text, const ArgsBatch& args_batch, bool use_jit) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text));
+  XLS_ASSIGN_OR_RETURN(Function * f, package->GetTopAsFunction());
+  std::unique_ptr<FunctionJit> jit;
+  if (use_jit) {
+    XLS_ASSIGN_OR_RETURN(jit, FunctionJit::Create(f));
+  }
+  std::vector<dslx::InterpValue> results;
+  results.reserve(args_batch.size());
+  for (const std::vector<dslx::InterpValue>& interp_args : args_batch) {
+    std::vector<Value> args;
+    args.reserve(interp_args.size());
+    for (const dslx::InterpValue& interp_arg : interp_args) {
+      XLS_ASSIGN_OR_RETURN(Value arg, interp_arg.ConvertToIr());
+      args.push_back(std::move(arg));
+    }
+    Value result;
+    if (jit != nullptr) {
+      XLS_ASSIGN_OR_RETURN(result, DropInterpreterEvents(jit->Run(args)));
+    } else {
+      XLS_ASSIGN_OR_RETURN(result,
+                           DropInterpreterEvents(InterpretFunction(f, args)));
+    }
+    XLS_ASSIGN_OR_RETURN(dslx::InterpValue interp_result,
+                         dslx::ValueToInterpValue(result));
+    results.push_back(std::move(interp_result));
+  }
+  return results;
+}
+
 }  // namespace xls
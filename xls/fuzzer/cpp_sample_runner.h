@@ -15,12 +15,15 @@
 #ifndef XLS_FUZZER_CPP_SAMPLE_RUNNER_H_
 #define XLS_FUZZER_CPP_SAMPLE_RUNNER_H_
 
+#include <filesystem>  // NOLINT
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "xls/dslx/interp_value.h"
 
 namespace xls {
@@ -43,6 +46,24 @@ absl::Status CompareResultsFunction(
         results,
     const ArgsBatch* maybe_args_batch);
 
+// The following are in-process equivalents of the tools the sample runner
+// otherwise invokes as subprocesses, used by its `in_process` mode.
+
+// Converts the DSLX module at `path` to IR text as ir_converter_main does with
+// the given --top and --warnings_as_errors flags.
+absl::StatusOr<std::string> ConvertDslxSampleToIr(
+    const std::filesystem::path& path, std::optional<std::string_view> top,
+    bool warnings_as_errors);
+
+// Optimizes the given IR text for its top as opt_main does with default flags.
+absl::StatusOr<std::string> OptimizeSampleIr(std::string_view ir_text);
+
+// Evaluates the top function of the given IR text on each element of
+// `args_batch` with the JIT or the IR interpreter, as eval_ir_main does. The
+// results are unsigned, like those parsed from eval_ir_main's output.
+absl::StatusOr<std::vector<dslx::InterpValue>> EvaluateIrFunction(
+    std::string_view ir_text, const ArgsBatch& args_batch, bool use_jit);
+
 }  // namespace xls
 
 #endif  // XLS_FUZZER_CPP_SAMPLE_RUNNER_H_
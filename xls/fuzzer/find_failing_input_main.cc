@@ -12,13 +12,22 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <string>
 #include <string_view>
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
@@ -26,6 +35,8 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
@@ -37,7 +48,9 @@
 const char kUsage[] = R"(
 Runs an IR function with a set of inputs through both the JIT and the
 interpreter. Prints the first input which results in a mismatch between the JIT
-and the interpreter. Returns a non-zer error code otherwise. Usage:
+and the interpreter. Returns a non-zer error code otherwise. The inputs are
+checked in batches, each batch being run through the JIT with a single call,
+with the batches spread over --threads threads. Usage:
 
     find_failing_input_main --input-file=INPUT_FILE IR_FILE
 )";
@@ -50,6 +63,11 @@ ABSL_FLAG(
     std::string, test_only_inject_jit_result, "",
     "Test-only flag for injecting the result produced by the JIT. Used to "
     "force mismatches between JIT and interpreter for testing purposed.");
+ABSL_FLAG(int64_t, threads, 0,
+          "Number of threads to check inputs on; defaults to the number of "
+          "hardware threads.");
+ABSL_FLAG(int64_t, batch_size, 1024,
+          "Number of inputs run through the JIT with a single call.");
 
 namespace xls {
 namespace {
@@ -74,26 +92,89 @@ absl::Status RealMain(std::string_view ir_path,
     inputs.push_back(args);
   }
 
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
-                       FunctionJit::Create(f));
-  for (const std::vector<Value>& args : inputs) {
-    InterpreterResult<Value> jit_result;
-    if (absl::GetFlag(FLAGS_test_only_inject_jit_result).empty()) {
-      XLS_ASSIGN_OR_RETURN(jit_result, jit->Run(args));
-    } else {
-      XLS_ASSIGN_OR_RETURN(jit_result.value,
-                           Parser::ParseTypedValue(absl::GetFlag(
-                               FLAGS_test_only_inject_jit_result)));
+  const int64_t batch_size = std::max<int64_t>(absl::GetFlag(FLAGS_batch_size),
+                                               1);
+  const int64_t batch_count = (inputs.size() + batch_size - 1) / batch_size;
+  int64_t thread_count = absl::GetFlag(FLAGS_threads);
+  if (thread_count <= 0) {
+    thread_count = std::thread::hardware_concurrency();
+  }
+  thread_count = std::max<int64_t>(std::min(thread_count, batch_count), 1);
+
+  // FunctionJit is not thread-safe so each thread gets its own.
+  std::vector<std::unique_ptr<FunctionJit>> jits;
+  for (int64_t i = 0; i < thread_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<FunctionJit> jit,
+        FunctionJit::Create(f, /*opt_level=*/3, /*profile=*/nullptr,
+                            /*build_batched_wrapper=*/true));
+    jits.push_back(std::move(jit));
+  }
+
+  // Batches are claimed in order and the index of the first mismatching input
+  // found so far is tracked, so that the input reported is the first one in
+  // the file regardless of the number of threads.
+  std::atomic<int64_t> next_batch = 0;
+  std::atomic<int64_t> first_mismatch = std::numeric_limits<int64_t>::max();
+  absl::Mutex status_mutex;
+  absl::Status status;
+  auto check_batches = [&](FunctionJit* jit) -> absl::Status {
+    for (int64_t batch = next_batch++; batch < batch_count;
+         batch = next_batch++) {
+      const int64_t start = batch * batch_size;
+      if (start > first_mismatch.load()) {
+        return absl::OkStatus();
+      }
+      absl::Span<const std::vector<Value>> batch_inputs =
+          absl::MakeConstSpan(inputs).subspan(start, batch_size);
+      std::vector<Value> jit_results;
+      if (absl::GetFlag(FLAGS_test_only_inject_jit_result).empty()) {
+        XLS_ASSIGN_OR_RETURN(InterpreterResult<std::vector<Value>> results,
+                             jit->RunBatch(batch_inputs));
+        jit_results = std::move(results.value);
+      } else {
+        XLS_ASSIGN_OR_RETURN(Value injected,
+                             Parser::ParseTypedValue(absl::GetFlag(
+                                 FLAGS_test_only_inject_jit_result)));
+        jit_results.assign(batch_inputs.size(), injected);
+      }
+      for (int64_t i = 0; i < batch_inputs.size(); ++i) {
+        // TODO(https://github.com/google/xls/issues/506): 2021-10-12 Also
+        // compare events once the JIT fully supports events (and we have
+        // decided how to handle event mismatches).
+        XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> interpreter_result,
+                             InterpretFunction(f, batch_inputs[i]));
+        if (jit_results[i] != interpreter_result.value) {
+          int64_t index = start + i;
+          int64_t current = first_mismatch.load();
+          while (index < current &&
+                 !first_mismatch.compare_exchange_weak(current, index)) {
+          }
+          return absl::OkStatus();
+        }
+      }
     }
-    // TODO(https://github.com/google/xls/issues/506): 2021-10-12 Also compare
-    // events once the JIT fully supports events (and we have decided how to
-    // handle event mismatches).
-    XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> interpreter_result,
-                         InterpretFunction(f, args));
-    if (jit_result.value != interpreter_result.value) {
-      std::cout << absl::StrJoin(args, "; ", ValueFormatterHex);
-      return absl::OkStatus();
+    return absl::OkStatus();
+  };
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (std::unique_ptr<FunctionJit>& jit : jits) {
+      threads.push_back(std::make_unique<Thread>([&, jit = jit.get()]() {
+        absl::Status thread_status = check_batches(jit);
+        absl::MutexLock lock(&status_mutex);
+        status.Update(thread_status);
+      }));
     }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+  XLS_RETURN_IF_ERROR(status);
+
+  if (first_mismatch.load() < inputs.size()) {
+    std::cout << absl::StrJoin(inputs[first_mismatch.load()], "; ",
+                               ValueFormatterHex);
+    return absl::OkStatus();
   }
   return absl::InvalidArgumentError(
       "No input found which results in a mismatch between the JIT and "
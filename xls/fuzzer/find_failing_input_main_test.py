@@ -73,6 +73,22 @@ class EvalMainTest(test_base.TestCase):
                                      stderr=subprocess.PIPE)
     self.assertEqual(result.decode('utf-8'), 'bits[32]:0x42; bits[32]:0x123')
 
+  def test_first_failure_found_with_many_batches(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    # With the injected JIT result of zero, the inputs summing to zero are the
+    # ones which do not mismatch.
+    lines = ['bits[32]:0x0; bits[32]:0x0'] * 37
+    lines.append('bits[32]:0x7; bits[32]:0x8')
+    lines.extend(['bits[32]:0x0; bits[32]:0x0'] * 5)
+    lines.append('bits[32]:0x1; bits[32]:0x2')
+    input_file = self.create_tempfile(content='\n'.join(lines))
+    result = subprocess.check_output([
+        FIND_FAILING_INPUT_MAIN, '--input_file=' + input_file.full_path,
+        '--batch_size=4', '--threads=3',
+        '--test_only_inject_jit_result=bits[32]:0x0', ir_file.full_path
+    ])
+    self.assertEqual(result.decode('utf-8'), 'bits[32]:0x7; bits[32]:0x8')
+
 
 if __name__ == '__main__':
   test_base.main()
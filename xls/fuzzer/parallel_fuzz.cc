@@ -0,0 +1,440 @@
+// Copyright 2021 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/parallel_fuzz.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "google/protobuf/repeated_ptr_field.h"
+#include "openssl/sha.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/subprocess.h"
+#include "xls/common/thread.h"
+#include "xls/fuzzer/cpp_run_fuzz.h"
+#include "xls/fuzzer/sample_generator.h"
+#include "xls/fuzzer/sample_summary.pb.h"
+#include "xls/fuzzer/summarize_ir.h"
+#include "xls/fuzzer/value_generator.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+// Number of completed samples between appends of the buffered summaries to the
+// summary file.
+constexpr int64_t kSummaryFlushInterval = 25;
+
+// Number of completed samples between progress messages.
+constexpr int64_t kProgressInterval = 16;
+
+absl::StatusOr<std::filesystem::path> GetSampleRunnerMainPath() {
+  return GetXlsRunfilePath("xls/fuzzer/sample_runner_main");
+}
+
+// Result of running a single sample.
+struct SampleOutcome {
+  // Error message if the sample failed.
+  std::optional<std::string> error;
+  bool is_timeout = false;
+};
+
+// Writes the sample's input files, and a script run.sh to rerun it, into
+// `run_dir` and runs it there with sample_runner_main, memoizing the results of
+// its stages in `stage_cache_dir` if given.
+absl::StatusOr<SampleOutcome> RunSample(
+    const Sample& smp, const std::filesystem::path& run_dir,
+    const std::filesystem::path& sample_runner_main_path,
+    const std::optional<std::filesystem::path>& stage_cache_dir) {
+  XLS_RETURN_IF_ERROR(SetFileContents(run_dir / "sample.x", smp.input_text()));
+  XLS_RETURN_IF_ERROR(
+      SetFileContents(run_dir / "options.pbtxt", smp.options().ToPbtxt()));
+  XLS_RETURN_IF_ERROR(SetFileContents(run_dir / "args.txt",
+                                      ArgsBatchToText(smp.args_batch())));
+  std::vector<std::string> args = {
+      sample_runner_main_path.string(), "--logtostderr",
+      "--input_file=sample.x", "--options_file=options.pbtxt",
+      "--args_file=args.txt"};
+  if (!smp.ir_channel_names().empty()) {
+    XLS_RETURN_IF_ERROR(
+        SetFileContents(run_dir / "ir_channel_names.txt",
+                        IrChannelNamesToText(smp.ir_channel_names())));
+    args.push_back("--ir_channel_names_file=ir_channel_names.txt");
+  }
+  args.push_back(run_dir.string());
+  std::filesystem::path run_script = run_dir / "run.sh";
+  XLS_RETURN_IF_ERROR(SetFileContents(
+      run_script, absl::StrCat("#!/bin/sh\n\n", absl::StrJoin(args, " "),
+                               "\n")));
+  std::filesystem::permissions(run_script, std::filesystem::perms::owner_exec,
+                               std::filesystem::perm_options::add);
+
+  // The cache only lives as long as the run, so it is not part of run.sh.
+  if (stage_cache_dir.has_value()) {
+    args.insert(args.end() - 1,
+                absl::StrCat("--stage_cache_dir=", stage_cache_dir->string()));
+  }
+  XLS_ASSIGN_OR_RETURN(SubprocessResult result,
+                       InvokeSubprocess(args, /*cwd=*/run_dir));
+  SampleOutcome outcome;
+  if (result.normal_termination && result.exit_status == 0) {
+    return outcome;
+  }
+  // The sample runner records the reason for the failure in exception.txt;
+  // fall back to its stderr if it died before it could do so.
+  std::filesystem::path exception_path = run_dir / "exception.txt";
+  if (std::filesystem::exists(exception_path)) {
+    XLS_ASSIGN_OR_RETURN(outcome.error, GetFileContents(exception_path));
+  } else {
+    outcome.error = absl::StrCat("sample_runner_main failed with exit status ",
+                                 result.exit_status, ":\n", result.stderr);
+  }
+  outcome.is_timeout = absl::StrContains(*outcome.error, "timed out");
+  return outcome;
+}
+
+absl::Status SummarizeIrFile(
+    const std::filesystem::path& path,
+    google::protobuf::RepeatedPtrField<fuzzer::NodeProto>* nodes) {
+  if (!std::filesystem::exists(path)) {
+    return absl::OkStatus();
+  }
+  XLS_ASSIGN_OR_RETURN(std::string ir, GetFileContents(path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir, path.string()));
+  SummarizePackage(package.get(), nodes);
+  return absl::OkStatus();
+}
+
+// Returns the first eight hex digits of the SHA-256 digest of `text`, as used
+// by run_fuzz.py to name crasher directories.
+std::string ShortDigest(std::string_view text) {
+  uint8_t digest[SHA256_DIGEST_LENGTH];
+  SHA256(reinterpret_cast<const uint8_t*>(text.data()), text.size(), digest);
+  return absl::BytesToHexString(
+             std::string_view(reinterpret_cast<const char*>(digest), 4));
+}
+
+// State shared by the worker threads of a ParallelGenerateAndRunSamples call.
+class Orchestrator {
+ public:
+  Orchestrator(const ParallelFuzzOptions& options, uint64_t seed,
+               std::filesystem::path sample_runner_main_path,
+               std::optional<std::filesystem::path> stage_cache_dir)
+      : options_(options),
+        seed_(seed),
+        sample_runner_main_path_(std::move(sample_runner_main_path)),
+        stage_cache_dir_(std::move(stage_cache_dir)),
+        start_(absl::Now()) {}
+
+  // Runs samples until there are none left to claim or an error occurs.
+  void RunWorker(int64_t worker_number) {
+    XLS_LOG(INFO) << "--- Started worker " << worker_number;
+    while (std::optional<int64_t> sample_index = ClaimSample()) {
+      absl::Status status = RunOneSample(*sample_index);
+      if (!status.ok()) {
+        XLS_LOG(ERROR) << "--- Worker " << worker_number
+                       << " failed running sample " << *sample_index << ": "
+                       << status;
+        absl::MutexLock lock(&mutex_);
+        status_.Update(status);
+        stopped_ = true;
+      }
+    }
+    XLS_LOG(INFO) << "--- Worker " << worker_number << " finished";
+  }
+
+  // Writes out any buffered summaries and returns the result of the run.
+  absl::StatusOr<ParallelFuzzResult> Finish() {
+    absl::MutexLock lock(&mutex_);
+    status_.Update(FlushSummaries());
+    XLS_RETURN_IF_ERROR(status_);
+    absl::Duration elapsed = absl::Now() - start_;
+    XLS_LOG(INFO) << absl::StreamFormat(
+        "--- Ran %d samples in %s (%.2f samples/s); %d crashers with %d "
+        "distinct signatures",
+        result_.sample_count, absl::FormatDuration(elapsed),
+        result_.sample_count / absl::ToDoubleSeconds(elapsed),
+        result_.crasher_count, result_.crash_signatures.size());
+    return result_;
+  }
+
+ private:
+  // Returns the index of the next sample to run, or std::nullopt if the run
+  // is over.
+  std::optional<int64_t> ClaimSample() {
+    {
+      absl::MutexLock lock(&mutex_);
+      if (stopped_) {
+        return std::nullopt;
+      }
+    }
+    if (options_.duration.has_value() &&
+        absl::Now() - start_ >= *options_.duration) {
+      return std::nullopt;
+    }
+    int64_t sample_index = next_sample_.fetch_add(1);
+    if (options_.sample_count.has_value() &&
+        sample_index >= *options_.sample_count) {
+      return std::nullopt;
+    }
+    return sample_index;
+  }
+
+  absl::Status RunOneSample(int64_t sample_index) {
+    absl::Time generate_start = absl::Now();
+    ValueGenerator value_gen(std::mt19937_64(SampleSeed(seed_, sample_index)));
+    XLS_ASSIGN_OR_RETURN(
+        Sample smp, GenerateSample(options_.ast_generator_options,
+                                   options_.sample_options, &value_gen));
+    absl::Duration generate_duration = absl::Now() - generate_start;
+
+    std::optional<TempDirectory> temp_dir;
+    std::filesystem::path run_dir;
+    if (options_.top_run_dir.has_value()) {
+      run_dir = *options_.top_run_dir / absl::StrCat("sample", sample_index);
+      XLS_RETURN_IF_ERROR(RecursivelyCreateDir(run_dir));
+    } else {
+      XLS_ASSIGN_OR_RETURN(temp_dir, TempDirectory::Create());
+      run_dir = temp_dir->path();
+    }
+
+    XLS_ASSIGN_OR_RETURN(SampleOutcome outcome,
+                         RunSample(smp, run_dir, sample_runner_main_path_,
+                                   stage_cache_dir_));
+    if (options_.force_failure && !outcome.error.has_value()) {
+      outcome.error = "Forced sample failure.";
+    }
+
+    fuzzer::SampleSummaryProto summary;
+    if (!outcome.error.has_value() && options_.summary_path.has_value()) {
+      fuzzer::SampleTimingProto* timing = summary.mutable_timing();
+      timing->set_generate_sample_ns(
+          absl::ToInt64Nanoseconds(generate_duration));
+      timing->set_total_ns(absl::ToInt64Nanoseconds(absl::Now() -
+                                                    generate_start));
+      XLS_RETURN_IF_ERROR(SummarizeIrFile(run_dir / "sample.ir",
+                                          summary.mutable_unoptimized_nodes()));
+      XLS_RETURN_IF_ERROR(SummarizeIrFile(run_dir / "sample.opt.ir",
+                                          summary.mutable_optimized_nodes()));
+    }
+
+    bool save_crasher = false;
+    {
+      absl::MutexLock lock(&mutex_);
+      ++result_.sample_count;
+      if (outcome.error.has_value()) {
+        ++result_.crasher_count;
+        int64_t& count =
+            result_.crash_signatures[CrashSignature(*outcome.error)];
+        save_crasher = ++count == 1 && options_.crasher_dir.has_value();
+        XLS_LOG(ERROR) << "--- Sample " << sample_index << " failed ("
+                       << (count == 1 ? "new signature" : "known signature")
+                       << "): " << *outcome.error;
+      } else if (options_.summary_path.has_value()) {
+        *pending_summaries_.add_samples() = std::move(summary);
+        if (pending_summaries_.samples_size() >= kSummaryFlushInterval) {
+          XLS_RETURN_IF_ERROR(FlushSummaries());
+        }
+      }
+      if (result_.sample_count % kProgressInterval == 0) {
+        absl::Duration elapsed = absl::Now() - start_;
+        XLS_LOG(INFO) << absl::StreamFormat(
+            "--- %d samples, %.2f samples/s, %d crashers, running for %s",
+            result_.sample_count,
+            result_.sample_count / absl::ToDoubleSeconds(elapsed),
+            result_.crasher_count, absl::FormatDuration(elapsed));
+      }
+    }
+
+    if (save_crasher) {
+      XLS_RETURN_IF_ERROR(SaveCrasher(smp, run_dir, *outcome.error,
+                                      outcome.is_timeout));
+    }
+    return absl::OkStatus();
+  }
+
+  // Copies the run directory of a failing sample into a new directory of the
+  // crasher directory along with a crasher file, and tries to minimize its IR.
+  absl::Status SaveCrasher(const Sample& smp,
+                           const std::filesystem::path& run_dir,
+                           std::string_view error, bool is_timeout) {
+    std::string digest = ShortDigest(smp.input_text());
+    std::filesystem::path sample_crasher_dir = *options_.crasher_dir / digest;
+    XLS_LOG(INFO) << "Saving crasher to " << sample_crasher_dir;
+    std::error_code ec;
+    std::filesystem::copy(run_dir, sample_crasher_dir,
+                          std::filesystem::copy_options::recursive |
+                              std::filesystem::copy_options::overwrite_existing,
+                          ec);
+    if (ec) {
+      return absl::InternalError(absl::StrFormat(
+          "Failed to copy %s to %s: %s", run_dir.string(),
+          sample_crasher_dir.string(), ec.message()));
+    }
+    XLS_RETURN_IF_ERROR(
+        SetFileContents(sample_crasher_dir / "exception.txt", error));
+    XLS_RETURN_IF_ERROR(SetFileContents(
+        sample_crasher_dir /
+            absl::StrFormat("crasher_%s_%s.x",
+                            absl::FormatTime("%Y-%m-%d", absl::Now(),
+                                             absl::LocalTimeZone()),
+                            digest.substr(0, 4)),
+        smp.ToCrasher(error)));
+    if (is_timeout) {
+      return absl::OkStatus();
+    }
+    std::optional<absl::Duration> timeout;
+    if (smp.options().timeout_seconds().has_value()) {
+      timeout = absl::Seconds(*smp.options().timeout_seconds());
+    }
+    XLS_ASSIGN_OR_RETURN(
+        std::optional<std::filesystem::path> minimized,
+        MinimizeIr(smp, sample_crasher_dir, /*inject_jit_result=*/std::nullopt,
+                   timeout, stage_cache_dir_));
+    XLS_LOG(INFO) << "IR minimization of " << sample_crasher_dir
+                  << (minimized.has_value() ? " succeeded" : " failed");
+    return absl::OkStatus();
+  }
+
+  // Appends the buffered summaries to the summary file. As the file holds a
+  // concatenation of serialized SampleSummariesProtos, which is itself a valid
+  // SampleSummariesProto, it can be read at any time during the run.
+  absl::Status FlushSummaries() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    if (pending_summaries_.samples_size() == 0) {
+      return absl::OkStatus();
+    }
+    XLS_RETURN_IF_ERROR(AppendStringToFile(
+        *options_.summary_path, pending_summaries_.SerializeAsString()));
+    pending_summaries_.Clear();
+    return absl::OkStatus();
+  }
+
+  const ParallelFuzzOptions& options_;
+  const uint64_t seed_;
+  const std::filesystem::path sample_runner_main_path_;
+  const std::optional<std::filesystem::path> stage_cache_dir_;
+  const absl::Time start_;
+
+  // Index of the next sample to be claimed by a worker.
+  std::atomic<int64_t> next_sample_ = 0;
+
+  absl::Mutex mutex_;
+  bool stopped_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+  ParallelFuzzResult result_ ABSL_GUARDED_BY(mutex_);
+  fuzzer::SampleSummariesProto pending_summaries_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace
+
+std::string CrashSignature(std::string_view error_message) {
+  std::string_view first_line;
+  for (std::string_view line : absl::StrSplit(error_message, '\n')) {
+    line = absl::StripAsciiWhitespace(line);
+    if (!line.empty()) {
+      first_line = line;
+      break;
+    }
+  }
+  std::string signature;
+  for (int64_t i = 0; i < first_line.size(); ++i) {
+    if (!absl::ascii_isdigit(first_line[i])) {
+      signature.push_back(first_line[i]);
+      continue;
+    }
+    signature.push_back('N');
+    while (i + 1 < first_line.size() &&
+           absl::ascii_isdigit(first_line[i + 1])) {
+      ++i;
+    }
+  }
+  return signature;
+}
+
+uint64_t SampleSeed(uint64_t seed, int64_t sample_index) {
+  // The SplitMix64 mixing function, so that consecutive sample indices give
+  // unrelated generator states.
+  uint64_t z =
+      seed + (static_cast<uint64_t>(sample_index) + 1) * 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+absl::StatusOr<ParallelFuzzResult> ParallelGenerateAndRunSamples(
+    const ParallelFuzzOptions& options) {
+  XLS_ASSIGN_OR_RETURN(std::filesystem::path sample_runner_main_path,
+                       GetSampleRunnerMainPath());
+  uint64_t seed;
+  if (options.seed.has_value()) {
+    seed = *options.seed;
+  } else {
+    seed = std::random_device()();
+    XLS_LOG(INFO) << absl::StreamFormat(
+        "--- NOTE: Chose a nondeterministic seed for value generation: %#x",
+        seed);
+  }
+
+  // Removed when the run is over.
+  std::optional<TempDirectory> stage_cache_dir;
+  if (options.memoize_stages) {
+    XLS_ASSIGN_OR_RETURN(stage_cache_dir, TempDirectory::Create());
+  }
+  Orchestrator orchestrator(
+      options, seed, std::move(sample_runner_main_path),
+      stage_cache_dir.has_value()
+          ? std::make_optional(stage_cache_dir->path())
+          : std::nullopt);
+  {
+    std::vector<std::unique_ptr<Thread>> workers;
+    for (int64_t i = 0; i < std::max<int64_t>(options.worker_count, 1); ++i) {
+      workers.push_back(std::make_unique<Thread>(
+          [&orchestrator, i]() { orchestrator.RunWorker(i); }));
+    }
+    for (std::unique_ptr<Thread>& worker : workers) {
+      worker->Join();
+    }
+  }
+  return orchestrator.Finish();
+}
+
+}  // namespace xls
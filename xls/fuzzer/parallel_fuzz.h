@@ -0,0 +1,115 @@
+// Copyright 2021 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_PARALLEL_FUZZ_H_
+#define XLS_FUZZER_PARALLEL_FUZZ_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "xls/fuzzer/ast_generator.h"
+#include "xls/fuzzer/sample.h"
+
+namespace xls {
+
+// Options for ParallelGenerateAndRunSamples. See member comments for details.
+struct ParallelFuzzOptions {
+  // How to generate and how to run each sample.
+  dslx::AstGeneratorOptions ast_generator_options;
+  SampleOptions sample_options;
+
+  // Number of worker threads, each running one sample at a time.
+  int64_t worker_count = 1;
+
+  // Seed from which the seed of each sample is derived (see SampleSeed). If
+  // not given, a nondeterministic seed is chosen and logged.
+  std::optional<uint64_t> seed;
+
+  // Total number of samples to run. If not given the number of samples is
+  // unbounded unless limited by `duration`.
+  std::optional<int64_t> sample_count;
+
+  // Total duration to run the fuzzer for.
+  std::optional<absl::Duration> duration;
+
+  // If given, sample number N is run in the directory `top_run_dir/sampleN`,
+  // which is kept afterwards. Otherwise each sample is run in a temporary
+  // directory.
+  std::optional<std::filesystem::path> top_run_dir;
+
+  // If given, the first failing sample with each distinct crash signature (see
+  // CrashSignature) is saved into a subdirectory of this directory and its IR
+  // is minimized.
+  std::optional<std::filesystem::path> crasher_dir;
+
+  // If given, a SampleSummaryProto for each successful sample is appended to
+  // this file, in the format written by summarize_ir_main.
+  std::optional<std::filesystem::path> summary_path;
+
+  // If true, then every sample run is considered a failure. Useful for testing
+  // failure paths.
+  bool force_failure = false;
+
+  // If true, the results of the sample pipeline stages (IR conversion,
+  // optimization, evaluation, codegen and simulation) are memoized in a
+  // directory shared by all workers and the minimization of crashers for the
+  // duration of the run, so that a stage whose inputs and options are
+  // identical to an earlier one is not rerun.
+  bool memoize_stages = true;
+};
+
+struct ParallelFuzzResult {
+  // Number of samples run.
+  int64_t sample_count = 0;
+
+  // Number of failing samples, and the number of failing samples with each
+  // crash signature.
+  int64_t crasher_count = 0;
+  absl::flat_hash_map<std::string, int64_t> crash_signatures;
+};
+
+// Returns the signature under which failures with the given error message (as
+// written by the sample runner into exception.txt) are deduplicated: the first
+// line of the message with each run of digits replaced by "N", so that
+// failures which differ only in values, widths or node ids are considered the
+// same.
+std::string CrashSignature(std::string_view error_message);
+
+// Returns the seed of the value generator used to generate sample number
+// `sample_index`. It depends only on `seed` and the index, so a run with a
+// given seed generates the same samples regardless of the number of workers
+// or of which worker runs which sample.
+uint64_t SampleSeed(uint64_t seed, int64_t sample_index);
+
+// Generates and runs fuzzer samples on `options.worker_count` threads, each
+// sample being run by sample_runner_main. Workers claim the next sample to run
+// from a shared counter as they become free, so the load is balanced however
+// long individual samples take. Summaries and crashers are written by the
+// orchestrator as samples complete, so a run which is interrupted keeps the
+// results of all completed samples.
+//
+// Returns an error only if fuzzing itself could not proceed (e.g. a file
+// could not be written); failing samples are reported in the result.
+absl::StatusOr<ParallelFuzzResult> ParallelGenerateAndRunSamples(
+    const ParallelFuzzOptions& options);
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_PARALLEL_FUZZ_H_
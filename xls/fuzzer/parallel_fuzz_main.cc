@@ -0,0 +1,193 @@
+// Copyright 2021 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/time.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/fuzzer/ast_generator.h"
+#include "xls/fuzzer/parallel_fuzz.h"
+#include "xls/fuzzer/sample.h"
+
+const char kUsage[] = R"(
+Multi-threaded fuzz driver: generates samples and runs them with
+sample_runner_main on a pool of worker threads, collecting crash samples into a
+directory of the user's choosing. Takes the same flags as run_fuzz_multiprocess;
+failing samples are deduplicated by crash signature so that only the first
+sample failing in a given way is saved and minimized.
+
+Example:
+
+  parallel_fuzz_main --crash_path=/tmp/crashers --duration=1h
+)";
+
+ABSL_FLAG(absl::Duration, duration, absl::InfiniteDuration(),
+          "Duration to run the sample generator for.");
+ABSL_FLAG(int64_t, calls_per_sample, 128, "Arguments to generate per sample.");
+ABSL_FLAG(std::string, crash_path, "", "Path at which to place crash data.");
+ABSL_FLAG(bool, codegen, false, "Run code generation.");
+ABSL_FLAG(bool, emit_loops, true, "Emit loops in generator.");
+ABSL_FLAG(bool, force_failure, false,
+          "Forces the samples to fail. Can be used to test failure code "
+          "paths.");
+ABSL_FLAG(bool, generate_proc, false, "Generate a proc sample.");
+ABSL_FLAG(int64_t, max_width_aggregate_types, 1024,
+          "The maximum width of aggregate types (tuples and arrays) in the "
+          "generated samples.");
+ABSL_FLAG(int64_t, max_width_bits_types, 64,
+          "The maximum width of bits types in the generated samples.");
+ABSL_FLAG(bool, memoize_stages, true,
+          "Memoize the results of the sample pipeline stages across the "
+          "samples of the run, so that stages with identical inputs (e.g. "
+          "samples which optimize to the same IR) are not rerun.");
+ABSL_FLAG(int64_t, proc_ticks, 100,
+          "Number ticks to execute the generated procs.");
+ABSL_FLAG(int64_t, sample_count, 0,
+          "Number of samples to generate; if zero the number is unbounded "
+          "unless limited by --duration.");
+ABSL_FLAG(std::string, save_temps_path, "",
+          "Path of directory in which to save temporary files. These temporary "
+          "files include DSLX, IR, and arguments. A separate numerically-named "
+          "subdirectory is created for each sample.");
+ABSL_FLAG(int64_t, seed, -1,
+          "Seed value for generation; if negative a nondeterministic seed is "
+          "used. Given a seed, the samples generated do not depend on "
+          "--worker_count.");
+ABSL_FLAG(bool, simulate, false, "Run Verilog simulation.");
+ABSL_FLAG(std::string, simulator, "",
+          "Verilog simulator to use. For example: \"iverilog\".");
+ABSL_FLAG(std::string, summary_path, "",
+          "Directory in which to write the sample summary information. This "
+          "records information about each generated sample including which XLS "
+          "op types and widths. Information is written in Protobuf format to "
+          "the file summary.binarypb, which is appended to as samples "
+          "complete.");
+ABSL_FLAG(int64_t, timeout_seconds, 0,
+          "The timeout value in seconds for each subcommand invocation. If "
+          "zero there is no timeout.");
+ABSL_FLAG(bool, use_llvm_jit, true,
+          "Use LLVM JIT to evaluate IR. The interpreter is still invoked at "
+          "least once on the IR even with this option enabled, but this option "
+          "can be used to disable the JIT entirely.");
+ABSL_FLAG(bool, use_system_verilog, true,
+          "If true, emit SystemVerilog during codegen otherwise emit Verilog.");
+ABSL_FLAG(int64_t, worker_count, 0,
+          "Number of worker threads to use for execution; defaults to the "
+          "number of hardware threads.");
+
+namespace xls {
+namespace {
+
+absl::Status RealMain() {
+  if (absl::GetFlag(FLAGS_simulate) && !absl::GetFlag(FLAGS_codegen)) {
+    return absl::InvalidArgumentError(
+        "Must specify --codegen when --simulate is given.");
+  }
+  if (absl::GetFlag(FLAGS_crash_path).empty()) {
+    return absl::InvalidArgumentError("Must specify --crash_path.");
+  }
+
+  bool generate_proc = absl::GetFlag(FLAGS_generate_proc);
+  ParallelFuzzOptions options;
+  options.ast_generator_options.emit_gate = !absl::GetFlag(FLAGS_codegen);
+  options.ast_generator_options.emit_loops = absl::GetFlag(FLAGS_emit_loops);
+  options.ast_generator_options.max_width_bits_types =
+      absl::GetFlag(FLAGS_max_width_bits_types);
+  options.ast_generator_options.max_width_aggregate_types =
+      absl::GetFlag(FLAGS_max_width_aggregate_types);
+  options.ast_generator_options.generate_proc = generate_proc;
+
+  SampleOptions& sample_options = options.sample_options;
+  sample_options.set_calls_per_sample(
+      generate_proc ? 0 : absl::GetFlag(FLAGS_calls_per_sample));
+  sample_options.set_codegen(absl::GetFlag(FLAGS_codegen));
+  sample_options.set_convert_to_ir(true);
+  sample_options.set_input_is_dslx(true);
+  sample_options.set_ir_converter_args(
+      std::vector<std::string>{"--top=main"});
+  sample_options.set_optimize_ir(true);
+  sample_options.set_proc_ticks(generate_proc ? absl::GetFlag(FLAGS_proc_ticks)
+                                              : 0);
+  sample_options.set_simulate(absl::GetFlag(FLAGS_simulate));
+  if (!absl::GetFlag(FLAGS_simulator).empty()) {
+    sample_options.set_simulator(absl::GetFlag(FLAGS_simulator));
+  }
+  if (absl::GetFlag(FLAGS_timeout_seconds) > 0) {
+    sample_options.set_timeout_seconds(absl::GetFlag(FLAGS_timeout_seconds));
+  }
+  sample_options.set_use_jit(absl::GetFlag(FLAGS_use_llvm_jit));
+  sample_options.set_use_system_verilog(
+      absl::GetFlag(FLAGS_use_system_verilog));
+
+  options.worker_count = absl::GetFlag(FLAGS_worker_count);
+  if (options.worker_count <= 0) {
+    options.worker_count = std::thread::hardware_concurrency();
+  }
+  if (absl::GetFlag(FLAGS_seed) >= 0) {
+    options.seed = absl::GetFlag(FLAGS_seed);
+  }
+  if (absl::GetFlag(FLAGS_sample_count) > 0) {
+    options.sample_count = absl::GetFlag(FLAGS_sample_count);
+  }
+  if (absl::GetFlag(FLAGS_duration) != absl::InfiniteDuration()) {
+    options.duration = absl::GetFlag(FLAGS_duration);
+  }
+  if (!absl::GetFlag(FLAGS_save_temps_path).empty()) {
+    options.top_run_dir = absl::GetFlag(FLAGS_save_temps_path);
+  }
+  options.crasher_dir = absl::GetFlag(FLAGS_crash_path);
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(*options.crasher_dir));
+  if (!absl::GetFlag(FLAGS_summary_path).empty()) {
+    std::filesystem::path summary_dir = absl::GetFlag(FLAGS_summary_path);
+    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(summary_dir));
+    options.summary_path = summary_dir / "summary.binarypb";
+  }
+  options.force_failure = absl::GetFlag(FLAGS_force_failure);
+  options.memoize_stages = absl::GetFlag(FLAGS_memoize_stages);
+
+  XLS_ASSIGN_OR_RETURN(ParallelFuzzResult result,
+                       ParallelGenerateAndRunSamples(options));
+  for (const auto& [signature, count] : result.crash_signatures) {
+    std::cout << absl::StreamFormat("%6d  %s\n", count, signature);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+
+  if (!positional_arguments.empty()) {
+    XLS_LOG(QFATAL) << "Usage:\n" << kUsage;
+  }
+
+  return xls::ExitStatus(xls::RealMain());
+}
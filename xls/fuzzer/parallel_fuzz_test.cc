@@ -0,0 +1,141 @@
+// Copyright 2021 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/parallel_fuzz.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/fuzzer/sample_summary.pb.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+ParallelFuzzOptions SmallOptions() {
+  ParallelFuzzOptions options;
+  options.sample_options.set_input_is_dslx(true);
+  options.sample_options.set_convert_to_ir(true);
+  options.sample_options.set_optimize_ir(true);
+  options.sample_options.set_ir_converter_args(
+      std::vector<std::string>{"--top=main"});
+  options.sample_options.set_calls_per_sample(3);
+  options.seed = 42;
+  return options;
+}
+
+TEST(ParallelFuzzTest, CrashSignature) {
+  EXPECT_EQ(CrashSignature("Result miscompare for sample 3:\nargs: bits[8]:0x2a"
+                           "\n(run dir: /tmp/run_fuzz_123)"),
+            "Result miscompare for sample N:");
+  EXPECT_EQ(CrashSignature("\n  bits[32] vs bits[17]\n"),
+            "bits[N] vs bits[N]");
+  EXPECT_EQ(CrashSignature(""), "");
+}
+
+TEST(ParallelFuzzTest, SampleSeedDependsOnSeedAndIndex) {
+  EXPECT_EQ(SampleSeed(42, 7), SampleSeed(42, 7));
+  EXPECT_NE(SampleSeed(42, 7), SampleSeed(42, 8));
+  EXPECT_NE(SampleSeed(42, 7), SampleSeed(43, 7));
+}
+
+TEST(ParallelFuzzTest, RunsSamplesAndWritesSummaries) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  ParallelFuzzOptions options = SmallOptions();
+  options.worker_count = 2;
+  options.sample_count = 4;
+  options.top_run_dir = temp_dir.path() / "samples";
+  options.summary_path = temp_dir.path() / "summary.binarypb";
+  XLS_ASSERT_OK_AND_ASSIGN(ParallelFuzzResult result,
+                           ParallelGenerateAndRunSamples(options));
+  EXPECT_EQ(result.sample_count, 4);
+  EXPECT_EQ(result.crasher_count, 0);
+
+  for (int64_t i = 0; i < 4; ++i) {
+    std::filesystem::path run_dir =
+        *options.top_run_dir / absl::StrCat("sample", i);
+    EXPECT_TRUE(std::filesystem::exists(run_dir / "sample.x"));
+    EXPECT_TRUE(std::filesystem::exists(run_dir / "sample.opt.ir"));
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string contents,
+                           GetFileContents(*options.summary_path));
+  fuzzer::SampleSummariesProto summaries;
+  ASSERT_TRUE(summaries.ParseFromString(contents));
+  ASSERT_EQ(summaries.samples_size(), 4);
+  for (const fuzzer::SampleSummaryProto& summary : summaries.samples()) {
+    EXPECT_GT(summary.unoptimized_nodes_size(), 0);
+    EXPECT_GT(summary.timing().total_ns(), 0);
+  }
+}
+
+TEST(ParallelFuzzTest, SameSeedGeneratesSameSamples) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  ParallelFuzzOptions options = SmallOptions();
+  options.sample_count = 2;
+  options.worker_count = 1;
+  options.top_run_dir = temp_dir.path() / "one_worker";
+  XLS_ASSERT_OK(ParallelGenerateAndRunSamples(options).status());
+  options.worker_count = 2;
+  options.top_run_dir = temp_dir.path() / "two_workers";
+  XLS_ASSERT_OK(ParallelGenerateAndRunSamples(options).status());
+
+  for (const char* sample : {"sample0", "sample1"}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::string one_worker,
+        GetFileContents(temp_dir.path() / "one_worker" / sample / "sample.x"));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::string two_workers,
+        GetFileContents(temp_dir.path() / "two_workers" / sample / "sample.x"));
+    EXPECT_EQ(one_worker, two_workers);
+  }
+}
+
+TEST(ParallelFuzzTest, DeduplicatesCrashers) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  ParallelFuzzOptions options = SmallOptions();
+  options.worker_count = 3;
+  options.sample_count = 5;
+  options.crasher_dir = temp_dir.path();
+  options.force_failure = true;
+  XLS_ASSERT_OK_AND_ASSIGN(ParallelFuzzResult result,
+                           ParallelGenerateAndRunSamples(options));
+  EXPECT_EQ(result.sample_count, 5);
+  EXPECT_EQ(result.crasher_count, 5);
+  EXPECT_THAT(result.crash_signatures,
+              ElementsAre(Pair("Forced sample failure.", 5)));
+
+  // All the failures have the same signature so only the first is saved.
+  int64_t crasher_dirs = 0;
+  for (const auto& entry :
+       std::filesystem::directory_iterator(temp_dir.path())) {
+    EXPECT_TRUE(entry.is_directory());
+    EXPECT_TRUE(std::filesystem::exists(entry.path() / "exception.txt"));
+    ++crasher_dirs;
+  }
+  EXPECT_EQ(crasher_dirs, 1);
+}
+
+}  // namespace
+}  // namespace xls
@@ -23,6 +23,7 @@
 #include "pybind11/functional.h"
 #include "pybind11/pybind11.h"
 #include "pybind11/stl.h"
+#include "pybind11_abseil/absl_casters.h"
 #include "pybind11_abseil/statusor_caster.h"
 #include "xls/common/status/import_status_module.h"
 #include "xls/common/status/status_macros.h"
@@ -79,6 +80,7 @@ PYBIND11_MODULE(cpp_ast_generator, m) {
            py::arg("emit_gate") = std::nullopt,
            py::arg("generate_proc") = std::nullopt,
            py::arg("emit_stateless_proc") = std::nullopt)
+      .def_readwrite("ir_op_counts", &AstGeneratorOptions::ir_op_counts)
       // Pickling is required by the multiprocess fuzzer which pickles options
       // to send to the separate worker process.
       .def(py::pickle(
@@ -86,7 +88,7 @@ PYBIND11_MODULE(cpp_ast_generator, m) {
             return py::make_tuple(o.emit_signed_types, o.max_width_bits_types,
                                   o.max_width_aggregate_types, o.emit_loops,
                                   o.emit_gate, o.generate_proc,
-                                  o.emit_stateless_proc);
+                                  o.emit_stateless_proc, o.ir_op_counts);
           },
           [](py::tuple t) {
             return AstGeneratorOptions{
@@ -96,7 +98,9 @@ PYBIND11_MODULE(cpp_ast_generator, m) {
                 .emit_loops = t[3].cast<bool>(),
                 .emit_gate = t[4].cast<bool>(),
                 .generate_proc = t[5].cast<bool>(),
-                .emit_stateless_proc = t[6].cast<bool>()};
+                .emit_stateless_proc = t[6].cast<bool>(),
+                .ir_op_counts =
+                    t[7].cast<absl::flat_hash_map<std::string, int64_t>>()};
           }));
 
   m.def(
@@ -16,6 +16,7 @@
 
 #include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -50,6 +51,18 @@ PYBIND11_MODULE(cpp_sample_runner, m) {
             maybe_args_batch.has_value() ? &maybe_args_batch.value() : nullptr);
       },
       py::arg("results"), py::arg("args_batch") = std::nullopt);
+
+  m.def(
+      "convert_dslx_to_ir",
+      [](std::string_view path, std::optional<std::string_view> top,
+         bool warnings_as_errors) -> absl::StatusOr<std::string> {
+        return ConvertDslxSampleToIr(path, top, warnings_as_errors);
+      },
+      py::arg("path"), py::arg("top") = std::nullopt,
+      py::arg("warnings_as_errors") = true);
+  m.def("optimize_ir", &OptimizeSampleIr, py::arg("ir_text"));
+  m.def("evaluate_ir_function", &EvaluateIrFunction, py::arg("ir_text"),
+        py::arg("args_batch"), py::arg("use_jit"));
 }
 
 }  // namespace xls
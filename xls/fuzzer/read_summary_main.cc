@@ -12,12 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <string_view>
+#include <thread>  // NOLINT
 #include <vector>
 
-#include "absl/container/flat_hash_map.h"
+#include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
@@ -28,6 +30,7 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/fuzzer/sample_summary.pb.h"
+#include "xls/fuzzer/summary_aggregator.h"
 #include "xls/ir/op.h"
 
 const char kUsage[] = R"(
@@ -44,113 +47,44 @@ Example invocations:
 Show summary of a set of files emitted by the fuzzer:
 
   read_summary_main /tmp/summaries/summary_*.binarypb
+
+The summaries are aggregated as they are read, one file per thread at a time.
+Large sets of files may be aggregated in shards by separate invocations, each
+writing a partial aggregate, which are then merged:
+
+  read_summary_main --shard_count=2 --shard_index=0 \
+    --output_partial_aggregate=/tmp/partial_0.binarypb \
+    /tmp/summaries/summary_*.binarypb
+  read_summary_main --shard_count=2 --shard_index=1 \
+    --output_partial_aggregate=/tmp/partial_1.binarypb \
+    /tmp/summaries/summary_*.binarypb
+  read_summary_main \
+    --partial_aggregates=/tmp/partial_0.binarypb,/tmp/partial_1.binarypb
 )";
 
+ABSL_FLAG(int64_t, threads, 0,
+          "Number of threads reading summary files. If zero, the number of "
+          "hardware threads is used.");
+ABSL_FLAG(int64_t, shard_count, 1,
+          "Number of shards the summary files are divided into. Only the "
+          "files of the shard given by --shard_index are read.");
+ABSL_FLAG(int64_t, shard_index, 0,
+          "Index of the shard of the summary files to read: the files whose "
+          "position in the argument list modulo --shard_count is this index.");
+ABSL_FLAG(std::string, output_partial_aggregate, "",
+          "If specified, writes the aggregate statistics as a binary "
+          "fuzzer::SummaryAggregateProto to this file instead of printing "
+          "them, to be merged with others using --partial_aggregates.");
+ABSL_FLAG(std::vector<std::string>, partial_aggregates,
+          std::vector<std::string>(),
+          "Comma-separated list of files written by "
+          "--output_partial_aggregate to merge into the aggregate.");
+
 namespace xls {
 namespace {
 
-// Aggregate info about a particular IR op (e.g., 'array_updage').
-struct OpInfo {
-  // Count of the number of instances of this op.
-  int64_t samples = 0;
-
-  // Count of operations by type ("bits", "array", or "tuple").
-  absl::flat_hash_map<std::string, int64_t> by_type;
-
-  // Count of operations wider than 64 bits.
-  int64_t wider_than_64bits = 0;
-
-  // Count of operations for which the operands are different widths.
-  int64_t mixed_width = 0;
-
-  // Count of operations with different arities.
-  int64_t nullary = 0;
-  int64_t unary = 0;
-  int64_t binary = 0;
-  int64_t manyary = 0;
-};
-
-// Aggregate information about a set of generated samples.
-struct SampleInfo {
-  int64_t samples = 0;
-  int64_t node_count = 0;
-  absl::flat_hash_map<std::string, OpInfo> per_op_info;
-};
-
-// Aggregate data about all the information in the summary file.
-struct SummaryInfo {
-  SampleInfo unoptimized_info;
-  SampleInfo optimized_info;
-  // The breakdown of total time spent in the fuzzer for the various operations
-  // (e.g, generating the same, optimizing, JIT time, etc)..
-  fuzzer::SampleTimingProto total_timing;
-  // The maximum time spent on a single same for the various fuzzer operations.
-  fuzzer::SampleTimingProto max_timing;
-};
-
-// Aggregates the summary data in 'summary' into 'info'.
-void AggregateSummary(const fuzzer::SampleSummaryProto& summary,
-                      SummaryInfo* info) {
-  for (bool optimized : {false, true}) {
-    SampleInfo& sample_info =
-        optimized ? info->optimized_info : info->unoptimized_info;
-    const auto& nodes =
-        optimized ? summary.optimized_nodes() : summary.unoptimized_nodes();
-    sample_info.samples++;
-    for (const fuzzer::NodeProto& node_proto : nodes) {
-      sample_info.node_count++;
-      OpInfo& op_info = sample_info.per_op_info[node_proto.op()];
-      op_info.samples++;
-      op_info.by_type[node_proto.type()]++;
-      if (node_proto.width() > 64) {
-        op_info.wider_than_64bits++;
-      }
-      switch (node_proto.operands_size()) {
-        case 0:
-          op_info.nullary++;
-          break;
-        case 1:
-          op_info.unary++;
-          break;
-        case 2:
-          op_info.binary++;
-          break;
-        default:
-          op_info.manyary++;
-          break;
-      }
-      for (const fuzzer::NodeProto& operand : node_proto.operands()) {
-        if (operand.width() != node_proto.operands(0).width()) {
-          op_info.mixed_width++;
-          break;
-        }
-      }
-    }
-  }
-
-  // Aggregate timing info including total and maximum times.
-#define AGGREGATE_FIELD(F)                                                     \
-  {                                                                            \
-    info->total_timing.set_##F(info->total_timing.F() + summary.timing().F()); \
-    info->max_timing.set_##F(                                                  \
-        std::max(info->max_timing.F(), summary.timing().F()));                 \
-  }
-  AGGREGATE_FIELD(total_ns);
-  AGGREGATE_FIELD(generate_sample_ns);
-  AGGREGATE_FIELD(interpret_dslx_ns);
-  AGGREGATE_FIELD(convert_ir_ns);
-  AGGREGATE_FIELD(unoptimized_interpret_ir_ns);
-  AGGREGATE_FIELD(unoptimized_jit_ns);
-  AGGREGATE_FIELD(optimize_ns);
-  AGGREGATE_FIELD(optimized_interpret_ir_ns);
-  AGGREGATE_FIELD(optimized_jit_ns);
-  AGGREGATE_FIELD(codegen_ns);
-  AGGREGATE_FIELD(simulate_ns);
-#undef AGGREGATE_FIELD
-}
-
 // Print the timing info contained in 'info' to stdout.
-void DumpTimingInfo(const SummaryInfo& info) {
+void DumpTimingInfo(const SummaryAggregator& info) {
   // Converts nanoseconds to seconds.
   auto us_to_sec = [](int64_t nanoseconds) {
     return static_cast<float>(nanoseconds) / 1e9;
@@ -167,32 +101,32 @@ void DumpTimingInfo(const SummaryInfo& info) {
   };
 
   std::cout << absl::StreamFormat("Samples (unoptimized): %d\n",
-                                  info.unoptimized_info.samples);
+                                  info.unoptimized().samples);
   std::cout << absl::StreamFormat(
       "Mean size (unoptimized): %.1f nodes\n",
-      mean(info.unoptimized_info.node_count, info.unoptimized_info.samples));
+      mean(info.unoptimized().node_count, info.unoptimized().samples));
 
   std::cout << absl::StreamFormat("Samples (optimized): %d\n",
-                                  info.optimized_info.samples);
+                                  info.optimized().samples);
   std::cout << absl::StreamFormat(
       "Mean size (optimized): %.1f nodes\n",
-      mean(info.optimized_info.node_count, info.optimized_info.samples));
+      mean(info.optimized().node_count, info.optimized().samples));
 
   std::cout << absl::StreamFormat("Total time: %0.3fs\n",
-                                  us_to_sec(info.total_timing.total_ns()));
+                                  us_to_sec(info.total_timing().total_ns()));
   std::cout << absl::StreamFormat(
-      "Mean time:   %0.3fs\n", us_to_sec(mean(info.total_timing.total_ns(),
-                                              info.unoptimized_info.samples)));
+      "Mean time:   %0.3fs\n", us_to_sec(mean(info.total_timing().total_ns(),
+                                              info.unoptimized().samples)));
   std::cout << absl::StreamFormat("Max time:   %0.3fs\n",
-                                  us_to_sec(info.max_timing.total_ns()));
+                                  us_to_sec(info.max_timing().total_ns()));
   std::cout << "\nBreakdown:\n";
-#define PRINT_ROW(F)                                                         \
-  std::cout << absl::StreamFormat(                                           \
-      "%-30s %10.3fs (%4.1f%%), mean %5.3fs, max %6.3fs\n", #F,              \
-      us_to_sec(info.total_timing.F()),                                      \
-      percent(info.total_timing.F(), info.total_timing.total_ns()),          \
-      us_to_sec(mean(info.total_timing.F(), info.unoptimized_info.samples)), \
-      us_to_sec(info.max_timing.F()));
+#define PRINT_ROW(F)                                                           \
+  std::cout << absl::StreamFormat(                                             \
+      "%-30s %10.3fs (%4.1f%%), mean %5.3fs, max %6.3fs\n", #F,                \
+      us_to_sec(info.total_timing().F()),                                      \
+      percent(info.total_timing().F(), info.total_timing().total_ns()),        \
+      us_to_sec(mean(info.total_timing().F(), info.unoptimized().samples)),    \
+      us_to_sec(info.max_timing().F()));
   PRINT_ROW(generate_sample_ns);
   PRINT_ROW(interpret_dslx_ns);
   PRINT_ROW(convert_ir_ns);
@@ -208,7 +142,7 @@ void DumpTimingInfo(const SummaryInfo& info) {
 
 // Dumps aggregate information about the generated samples described in 'info'
 // to stdout.
-void DumpSampleInfo(const SampleInfo& info) {
+void DumpSampleInfo(const SampleStats& info) {
   auto fmt = [&](const std::string& s, bool first_col = false) {
     if (first_col) {
       return absl::StrFormat("%-20s", s);
@@ -226,14 +160,13 @@ void DumpSampleInfo(const SampleInfo& info) {
   std::cout << "\n" << std::string(20 + 13 * (fields.size() - 1), '-') << "\n";
   for (Op op : AllOps()) {
     std::string op_str = OpToString(op);
-    OpInfo op_info = info.per_op_info.contains(op_str)
-                         ? info.per_op_info.at(op_str)
-                         : OpInfo{0};
+    OpStats op_info = info.per_op.contains(op_str) ? info.per_op.at(op_str)
+                                                   : OpStats{0};
     std::cout << fmt(op_str, /*first_col=*/true);
-    std::cout << fmt_num(op_info.samples);
-    std::cout << fmt_num(op_info.by_type["bits"]);
-    std::cout << fmt_num(op_info.by_type["tuple"]);
-    std::cout << fmt_num(op_info.by_type["array"]);
+    std::cout << fmt_num(op_info.count);
+    std::cout << fmt_num(op_info.count_by_type["bits"]);
+    std::cout << fmt_num(op_info.count_by_type["tuple"]);
+    std::cout << fmt_num(op_info.count_by_type["array"]);
     std::cout << fmt_num(op_info.wider_than_64bits);
     std::cout << fmt_num(op_info.mixed_width);
     std::cout << fmt_num(op_info.nullary);
@@ -245,26 +178,41 @@ void DumpSampleInfo(const SampleInfo& info) {
 }
 
 absl::Status RealMain(absl::Span<const std::string_view> input_paths) {
-  SummaryInfo summary_info;
-  for (const std::string_view input_path : input_paths) {
-    XLS_ASSIGN_OR_RETURN(std::string summary_data, GetFileContents(input_path));
-    fuzzer::SampleSummariesProto summaries;
-    if (!summaries.ParseFromString(summary_data)) {
-      return absl::InvalidArgumentError(
-          "Failed to parse summary protobuf file.");
-    }
-    for (const fuzzer::SampleSummaryProto& summary : summaries.samples()) {
-      AggregateSummary(summary, &summary_info);
-    }
+  const int64_t shard_count = absl::GetFlag(FLAGS_shard_count);
+  const int64_t shard_index = absl::GetFlag(FLAGS_shard_index);
+  if (shard_count < 1 || shard_index < 0 || shard_index >= shard_count) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid shard %d of %d.", shard_index, shard_count));
+  }
+  std::vector<std::string> shard_paths;
+  for (int64_t i = shard_index; i < input_paths.size(); i += shard_count) {
+    shard_paths.push_back(std::string{input_paths[i]});
+  }
+  int64_t thread_count = absl::GetFlag(FLAGS_threads);
+  if (thread_count <= 0) {
+    thread_count = std::thread::hardware_concurrency();
+  }
+  XLS_ASSIGN_OR_RETURN(SummaryAggregator summary_info,
+                       AggregateSummaryFiles(shard_paths, thread_count));
+  for (const std::string& partial_path :
+       absl::GetFlag(FLAGS_partial_aggregates)) {
+    fuzzer::SummaryAggregateProto partial;
+    XLS_RETURN_IF_ERROR(ParseProtobinFile(partial_path, &partial));
+    summary_info.Merge(SummaryAggregator::FromProto(partial));
+  }
+
+  const std::string output_path = absl::GetFlag(FLAGS_output_partial_aggregate);
+  if (!output_path.empty()) {
+    return SetProtobinFile(output_path, summary_info.ToProto());
   }
 
   std::cout << "Before optimizations:\n";
   std::cout << "--------------------\n";
-  DumpSampleInfo(summary_info.unoptimized_info);
+  DumpSampleInfo(summary_info.unoptimized());
 
   std::cout << "\nAfter optimizations\n";
   std::cout << "-------------------\n";
-  DumpSampleInfo(summary_info.optimized_info);
+  DumpSampleInfo(summary_info.optimized());
 
   std::cout << "\nTiming\n";
   std::cout << "------\n";
@@ -279,7 +227,8 @@ int main(int argc, char** argv) {
   std::vector<std::string_view> positional_arguments =
       xls::InitXls(kUsage, argc, argv);
 
-  if (positional_arguments.empty()) {
+  if (positional_arguments.empty() &&
+      absl::GetFlag(FLAGS_partial_aggregates).empty()) {
     XLS_LOG(QFATAL) << absl::StreamFormat(
         "Expected invocation: %s [SUMMARY_FILE...]", argv[0]);
   }
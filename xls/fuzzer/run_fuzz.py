@@ -13,13 +13,15 @@
 # limitations under the License.
 """Fuzzer generate-and-compare loop."""
 
+import collections
 import datetime
 import hashlib
 import os
+import re
 import stat
 import subprocess
 import time
-from typing import Text, Optional
+from typing import Dict, Text, Optional
 
 from absl import logging
 
@@ -51,6 +53,17 @@ def _write_to_file(dir_path: Text,
     os.chmod(path, st.st_mode | stat.S_IXUSR)
 
 
+# Matches the op of each node definition in IR text, e.g. "add" in
+# "  add.3: bits[8] = add(x, y, id=3)".
+_IR_NODE_OP_RE = re.compile(r'^\s*(?:ret\s+)?[\w.]+: [^=]*= ([a-z_]+)\(',
+                            re.MULTILINE)
+
+
+def ir_op_histogram(ir_text: Text) -> Dict[str, int]:
+  """Returns the number of nodes of each op (by name) in the given IR text."""
+  return dict(collections.Counter(_IR_NODE_OP_RE.findall(ir_text)))
+
+
 def _write_ir_summaries(run_dir: str,
                         timing: sample_summary_pb2.SampleTimingProto,
                         summary_path: str):
@@ -81,7 +94,8 @@ def _write_ir_summaries(run_dir: str,
 def run_sample(smp: sample.Sample,
                run_dir: Text,
                summary_file: Optional[Text] = None,
-               generate_sample_ns: Optional[int] = None):
+               generate_sample_ns: Optional[int] = None,
+               in_process: bool = False):
   """Runs the given sample in the given directory.
 
   Args:
@@ -91,6 +105,8 @@ def run_sample(smp: sample.Sample,
     summary_file: The (optional) file to append sample summary.
     generate_sample_ns: The (optional) time in nanoseconds to generate the
       sample. Recorded in the summary file, if given.
+    in_process: Whether to run the sample with the sample runner's in-process
+      mode (see sample_runner.SampleRunner).
 
   Raises:
     sample_runner.SampleError: on any non-zero status from the sample runner.
@@ -126,7 +142,7 @@ def run_sample(smp: sample.Sample,
       executable=True)
   logging.vlog(1, 'Starting to run sample')
   logging.vlog(2, smp.input_text)
-  runner = sample_runner.SampleRunner(run_dir)
+  runner = sample_runner.SampleRunner(run_dir, in_process=in_process)
   runner.run_from_files(
       'sample.x', 'options.pbtxt', args_filename, ir_channel_names_filename
   )
@@ -173,7 +189,8 @@ def generate_sample_and_run(
     run_dir: str,
     crasher_dir: Optional[str] = None,
     summary_file: Optional[str] = None,
-    force_failure: bool = False) -> sample.Sample:
+    force_failure: bool = False,
+    in_process: bool = False) -> sample.Sample:
   """Generates and runs a fuzzing sample."""
   with sample_runner.Timer() as t:
     smp = ast_generator.generate_sample(ast_generator_options, sample_options,
@@ -183,7 +200,8 @@ def generate_sample_and_run(
         smp,
         run_dir,
         summary_file=summary_file,
-        generate_sample_ns=t.elapsed_ns)
+        generate_sample_ns=t.elapsed_ns,
+        in_process=in_process)
     if force_failure:
       raise sample_runner.SampleError('Forced sample failure.')
   except sample_runner.SampleError as e:
@@ -15,6 +15,7 @@
 
 """Multi-process fuzz driver library."""
 
+import collections
 import dataclasses
 import datetime
 import itertools
@@ -48,6 +49,8 @@ class WorkerConfig:
   sample_count: Optional[int]
   duration: Optional[datetime.timedelta]
   force_failure: bool
+  in_process: bool
+  coverage_guided: bool
 
 
 def _do_worker_task(config: WorkerConfig):
@@ -82,6 +85,10 @@ def _do_worker_task(config: WorkerConfig):
     # generate different samples.
     rng = ast_generator.ValueGenerator(config.seed + config.worker_number)
 
+  # Counts of the IR ops in the samples run so far, fed back to the AST
+  # generator when generation is coverage guided.
+  ir_op_counts = collections.Counter()
+
   i = 0  # Silence pylint warning.
   for i in itertools.count():
     if config.sample_count is not None and i == config.sample_count:
@@ -105,7 +112,8 @@ def _do_worker_task(config: WorkerConfig):
           run_dir,
           crasher_dir=config.crasher_dir,
           summary_file=summary_temp_file,
-          force_failure=config.force_failure)
+          force_failure=config.force_failure,
+          in_process=config.in_process)
     except sample_runner.SampleError:
       termcolor.cprint(
           '--- Worker {} noted crasher #{} for sample number {}'.format(
@@ -113,6 +121,14 @@ def _do_worker_task(config: WorkerConfig):
           color='red')
       crashers += 1
 
+    if config.coverage_guided:
+      ir_path = os.path.join(run_dir, 'sample.ir')
+      if os.path.exists(ir_path):
+        with open(ir_path, 'r') as f:
+          ir_op_counts.update(run_fuzz.ir_op_histogram(f.read()))
+      if i % 16 == 15:
+        config.ast_generator_options.ir_op_counts = dict(ir_op_counts)
+
     if summary_file and i % 25 == 0:
       # Append the local temporary summary file to the actual, potentially
       # remote one, and delete the temporary file.
@@ -166,7 +182,9 @@ def parallel_generate_and_run_samples(
     summary_dir: Optional[str] = None,
     sample_count: Optional[int] = None,
     duration: Optional[datetime.timedelta] = None,
-    force_failure: bool = False):
+    force_failure: bool = False,
+    in_process: bool = False,
+    coverage_guided: bool = False):
   """Generate and run fuzzer samples on multiple processes.
 
   Args:
@@ -186,6 +204,10 @@ def parallel_generate_and_run_samples(
     duration: The total duration to run the fuzzer for.
     force_failure: If true, then every sample run is considered a failure.
       Useful for testing failure paths.
+    in_process: Whether to run samples with the sample runner's in-process
+      mode (see sample_runner.SampleRunner).
+    coverage_guided: Whether each worker biases sample generation toward the
+      IR ops it has seen least often so far.
   """
   workers = []
   for i in range(worker_count):
@@ -201,7 +223,9 @@ def parallel_generate_and_run_samples(
         duration=duration,
         crasher_dir=crasher_dir,
         summary_dir=summary_dir,
-        force_failure=force_failure)
+        force_failure=force_failure,
+        in_process=in_process,
+        coverage_guided=coverage_guided)
     worker = multiprocess.Process(target=target, args=(config,))
     worker.start()
     workers.append(worker)
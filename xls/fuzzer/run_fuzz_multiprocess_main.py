@@ -35,6 +35,10 @@ _DURATION = flags.DEFINE_string('duration', None,
                                 'Duration to run the sample generator for.')
 _CALLS_PER_SAMPLE = flags.DEFINE_integer('calls_per_sample', 128,
                                          'Arguments to generate per sample.')
+_COVERAGE_GUIDED = flags.DEFINE_boolean(
+    'coverage_guided', False,
+    'Bias sample generation toward the kinds of expressions which produce the '
+    'IR ops seen least often in previous samples.')
 _CRASH_PATH = flags.DEFINE_string('crash_path', None,
                                   'Path at which to place crash data.')
 _CODEGEN = flags.DEFINE_boolean('codegen', False, 'Run code generation.')
@@ -45,6 +49,11 @@ _FORCE_FAILURE = flags.DEFINE_bool(
     'Forces the samples to fail. Can be used to test failure code paths.')
 _GENERATE_PROC = flags.DEFINE_boolean(
     'generate_proc', default=False, help='Generate a proc sample.')
+_IN_PROCESS = flags.DEFINE_boolean(
+    'in_process', False,
+    'Convert, evaluate and optimize function samples with library calls in a '
+    'forked process rather than by invoking the XLS tools as subprocesses. '
+    'With this option the timeout applies to each sample as a whole.')
 _MAX_WIDTH_AGGREGATE_TYPES = flags.DEFINE_integer(
     'max_width_aggregate_types', 1024,
     'The maximum width of aggregate types (tuples and arrays) in the generated '
@@ -147,6 +156,8 @@ def main(argv):
       sample_count=_SAMPLE_COUNT.value,
       duration=duration,
       force_failure=_FORCE_FAILURE.value,
+      in_process=_IN_PROCESS.value,
+      coverage_guided=_COVERAGE_GUIDED.value,
   )
 
 
@@ -113,6 +113,29 @@ class RunFuzzTest(parameterized.TestCase):
         crasher_dir=self._crasher_dir)
     self.assertNotEqual(sample0, sample1)
 
+  def test_ir_op_histogram(self):
+    ir_text = """package p
+
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  add.3: bits[8] = add(x, y, id=3)
+  add.4: bits[8] = add(add.3, y, id=4)
+  ret literal.5: bits[8] = literal(value=1, id=5)
+}
+"""
+    self.assertEqual(
+        run_fuzz.ir_op_histogram(ir_text), {'add': 2, 'literal': 1})
+
+  def test_coverage_guided_options_generate_samples(self):
+    rng = ast_generator.ValueGenerator(42)
+    ast_options = self._get_ast_options()
+    ast_options.ir_op_counts = {'add': 100, 'counted_for': 0}
+    run_fuzz.generate_sample_and_run(
+        rng,
+        ast_options,
+        self._get_sample_options(),
+        run_dir=self._create_tempdir(),
+        crasher_dir=self._crasher_dir)
+
   @parameterized.named_parameters(*tuple(
       dict(testcase_name='seed_{}'.format(x), seed=x) for x in range(30)))
   # 2023-08-16: We chose 30 here because the next seed currently fails with a
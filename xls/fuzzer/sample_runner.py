@@ -15,8 +15,13 @@
 
 """Library for operating on a generated code sample in the fuzzer."""
 
+import hashlib
 import os
+import pickle
+import select
+import signal
 import subprocess
+import tempfile
 import time
 from typing import Tuple, Optional, Dict, Sequence, List
 
@@ -151,10 +156,30 @@ class SampleRunner:
   The runner operates in a single directory supplied at construction time and
   records all state, command invocations, and outputs to that directory to
   enable easier debugging and replay.
+
+  By default each step is performed by invoking the corresponding XLS tool as a
+  subprocess. In `in_process` mode the DSLX conversion, IR evaluation and IR
+  optimization steps of function samples are instead performed by library
+  calls, avoiding the process startup cost of each tool. To isolate the fuzzer
+  from crashes in these calls, the sample is then run in a forked child process
+  and the sample timeout (if any) applies to the whole sample rather than to
+  each step.
+
+  If a stage cache directory is given, the successful results of the steps
+  performed by subprocesses are memoized in it, keyed by the command line and
+  the contents of the files it names. Many samples converge to the same IR
+  after optimization and minimization reruns near-identical pipelines, so
+  runners which share the directory (e.g. the workers of a fuzzing session)
+  skip the redundant downstream steps. Failing steps are never memoized.
   """
 
-  def __init__(self, run_dir: str):
+  def __init__(self,
+               run_dir: str,
+               in_process: bool = False,
+               cache_dir: Optional[str] = None):
     self._run_dir = run_dir
+    self._in_process = in_process
+    self._cache_dir = cache_dir
     self.timing = sample_summary_pb2.SampleTimingProto()
 
   def run(self, smp: sample.Sample):
@@ -209,6 +234,90 @@ class SampleRunner:
     Raises:
       SampleError: If an error was encountered.
     """
+    if self._in_process:
+      self._run_from_files_in_child(input_filename, options_filename,
+                                    args_filename, ir_channel_names_filename)
+    else:
+      self._run_from_files(input_filename, options_filename, args_filename,
+                           ir_channel_names_filename)
+
+  def _run_from_files_in_child(self, input_filename: str,
+                               options_filename: str, args_filename: str,
+                               ir_channel_names_filename: str):
+    """Runs _run_from_files in a forked child process.
+
+    Crashes and timeouts of the child are raised as SampleErrors. The timing
+    of the sample is copied back from the child.
+
+    Args:
+      input_filename: The filename of the sample code.
+      options_filename: The filename of the serialized SampleOptions.
+      args_filename: The optional filename of the serialized ArgsBatch.
+      ir_channel_names_filename: The optional filename of the serialized IR
+        channel names.
+
+    Raises:
+      SampleError: If an error was encountered.
+    """
+    options = sample.SampleOptions.from_pbtxt(self._read_file(options_filename))
+    read_fd, write_fd = os.pipe()
+    pid = os.fork()
+    if pid == 0:
+      os.close(read_fd)
+      error = None
+      try:
+        self._run_from_files(input_filename, options_filename, args_filename,
+                             ir_channel_names_filename)
+      except SampleError as e:
+        error = (str(e), e.is_timeout)
+      except Exception as e:  # pylint: disable=broad-except
+        error = (str(e), False)
+      with os.fdopen(write_fd, 'wb') as f:
+        pickle.dump((self.timing.SerializeToString(), error), f)
+      # Skip interpreter teardown, which belongs to the parent.
+      os._exit(0)  # pylint: disable=protected-access
+
+    os.close(write_fd)
+    deadline = (None if options.timeout_seconds is None else
+                time.time() + options.timeout_seconds)
+    payload = b''
+    try:
+      while True:
+        timeout = None if deadline is None else max(deadline - time.time(), 0)
+        ready, _, _ = select.select([read_fd], [], [], timeout)
+        if not ready:
+          os.kill(pid, signal.SIGKILL)
+          os.waitpid(pid, 0)
+          msg = 'Sample timed out after {}s\n(run dir: {})'.format(
+              options.timeout_seconds, self._run_dir)
+          self._write_file('exception.txt', msg)
+          raise SampleError(msg, is_timeout=True)
+        chunk = os.read(read_fd, 1 << 16)
+        if not chunk:
+          break
+        payload += chunk
+    finally:
+      os.close(read_fd)
+    _, status = os.waitpid(pid, 0)
+    if not payload:
+      if os.WIFSIGNALED(status):
+        cause = 'was killed by signal {}'.format(os.WTERMSIG(status))
+      else:
+        cause = 'exited with status {}'.format(os.WEXITSTATUS(status))
+      msg = 'Sample runner process {} without a result\n(run dir: {})'.format(
+          cause, self._run_dir)
+      logging.error('%s', msg)
+      self._write_file('exception.txt', msg)
+      raise SampleError(msg)
+
+    timing, error = pickle.loads(payload)
+    self.timing.ParseFromString(timing)
+    if error is not None:
+      raise SampleError(error[0], is_timeout=error[1])
+
+  def _run_from_files(self, input_filename: str, options_filename: str,
+                      args_filename: str, ir_channel_names_filename: str):
+    """Implementation of run_from_files in the current process."""
     logging.vlog(1, 'Running sample in directory %s', self._run_dir)
     logging.vlog(1, 'Reading sample files.')
     options = sample.SampleOptions.from_pbtxt(self._read_file(options_filename))
@@ -469,14 +578,49 @@ class SampleRunner:
 
     self._compare_results_proc(results)
 
-  def _run_command(self, desc: str, args: Sequence[str],
-                   options: sample.SampleOptions) -> str:
-    """Runs the given commands.
+  def _stage_cache_key(self, args: Sequence[str],
+                       output_files: Sequence[str]) -> str:
+    """Returns the key under which the result of the command is memoized.
+
+    The key covers the command line and the contents of every input file in
+    the run directory named by an argument (either the argument itself or the
+    value of a --flag=value argument). The tool binary is identified by its
+    path.
+
+    Args:
+      args: The command line arguments.
+      output_files: Names of the files the command writes, which are not
+        inputs even if they exist from an earlier run.
+    """
+    h = hashlib.sha256()
+    for i, arg in enumerate(args):
+      h.update(arg.encode('utf-8') + b'\0')
+      filename = arg.split('=', 1)[-1]
+      if i == 0 or filename in output_files:
+        continue
+      path = os.path.join(self._run_dir, filename)
+      if os.path.isfile(path):
+        with open(path, 'rb') as f:
+          h.update(hashlib.sha256(f.read()).digest())
+    return h.hexdigest()
+
+  def _use_stage_cache(self) -> bool:
+    # The directory may be gone if this is a replay of an earlier session.
+    return self._cache_dir is not None and os.path.isdir(self._cache_dir)
+
+  def _run_command(self,
+                   desc: str,
+                   args: Sequence[str],
+                   options: sample.SampleOptions,
+                   output_files: Sequence[str] = ()) -> str:
+    """Runs the given commands, or replays its memoized result.
 
     Args:
       desc: Textual description of what the command is doing. Emitted to stdout.
       args: The command line arguments.
       options: The sample options.
+      output_files: Names of the files the command writes into the run
+        directory, which are memoized along with its stdout.
 
     Returns:
       Stdout of the command.
@@ -485,6 +629,44 @@ class SampleRunner:
       subprocess.CalledProcessError: If subprocess returns non-zero code.
       subprocess.TimeoutExpired: If subprocess call times out.
     """
+    entry_dir = None
+    if self._use_stage_cache():
+      entry_dir = os.path.join(self._cache_dir,
+                               self._stage_cache_key(args, output_files))
+      if os.path.isdir(entry_dir):
+        logging.vlog(1, '%s: reusing memoized result %s', desc, entry_dir)
+        for filename in output_files:
+          with open(os.path.join(entry_dir, filename), 'rb') as f:
+            content = f.read()
+          with open(os.path.join(self._run_dir, filename), 'wb') as f:
+            f.write(content)
+        with open(os.path.join(entry_dir, 'stdout'), 'r') as f:
+          return f.read()
+
+    stdout = self._run_subprocess(desc, args, options)
+
+    if entry_dir is not None:
+      # Entries are published by renaming a complete directory so that
+      # concurrent runners never see a partial one.
+      tmp_dir = tempfile.mkdtemp(dir=self._cache_dir)
+      with open(os.path.join(tmp_dir, 'stdout'), 'w') as f:
+        f.write(stdout)
+      for filename in output_files:
+        with open(os.path.join(self._run_dir, filename), 'rb') as src:
+          with open(os.path.join(tmp_dir, filename), 'wb') as dst:
+            dst.write(src.read())
+      try:
+        os.rename(tmp_dir, entry_dir)
+      except OSError:
+        # Another runner memoized the same result first.
+        for filename in os.listdir(tmp_dir):
+          os.remove(os.path.join(tmp_dir, filename))
+        os.rmdir(tmp_dir)
+    return stdout
+
+  def _run_subprocess(self, desc: str, args: Sequence[str],
+                      options: sample.SampleOptions) -> str:
+    """Runs the given commands in a subprocess and returns its stdout."""
     # Print the command line with the runfiles directory prefix elided to reduce
     # clutter.
     if logging.get_verbosity() > 0:
@@ -657,6 +839,17 @@ class SampleRunner:
                             options: sample.SampleOptions) -> Tuple[Value, ...]:
     """Evaluate the IR file with a function as the top and returns the result Values.
     """
+    if self._in_process:
+      desc = 'JIT' if use_jit else 'interpreter'
+      logging.vlog(1, 'Evaluating IR file in-process (%s): %s', desc,
+                   ir_filename)
+      args_batch = sample.parse_args_batch(self._read_file(args_filename))
+      results = cpp_sample_runner.evaluate_ir_function(
+          self._read_file(ir_filename), args_batch, use_jit)
+      self._write_file(ir_filename + '.results',
+                       '\n'.join(r.to_ir_str() for r in results) + '\n')
+      return tuple(results)
+
     results_text = self._run_command(
         'Evaluating IR file ({}): {}'.format(
             'JIT' if use_jit else 'interpreter', ir_filename),
@@ -690,6 +883,10 @@ class SampleRunner:
                            options: sample.SampleOptions) -> str:
     """Converts the DSLX file to an IR file with a function as the top whose filename is returned.
     """
+    ir_text = self._dslx_to_ir_in_process(dslx_filename, options)
+    if ir_text is not None:
+      return self._write_file('sample.ir', ir_text)
+
     args = [IR_CONVERTER_MAIN_PATH]
     if options.ir_converter_args:
       args.extend(options.ir_converter_args)
@@ -703,6 +900,10 @@ class SampleRunner:
                        options: sample.SampleOptions) -> str:
     """Converts the DSLX file to an IR file with a proc as the top whose filename is returned.
     """
+    ir_text = self._dslx_to_ir_in_process(dslx_filename, options)
+    if ir_text is not None:
+      return self._write_file('sample.ir', ir_text)
+
     args = [IR_CONVERTER_MAIN_PATH]
     if options.ir_converter_args:
       args.extend(options.ir_converter_args)
@@ -712,9 +913,44 @@ class SampleRunner:
     logging.vlog(3, 'Unoptimized IR:\n%s', ir_text)
     return self._write_file('sample.ir', ir_text)
 
+  def _dslx_to_ir_in_process(self, dslx_filename: str,
+                             options: sample.SampleOptions) -> Optional[str]:
+    """Converts the DSLX file to IR text in-process.
+
+    Args:
+      dslx_filename: The filename of the DSLX sample.
+      options: The sample options.
+
+    Returns:
+      The IR text, or None if not running in-process or if the sample's
+      ir_converter_args are not supported in-process (only --top is).
+    """
+    if not self._in_process:
+      return None
+    top = None
+    for arg in options.ir_converter_args or []:
+      if not arg.startswith('--top='):
+        return None
+      top = arg[len('--top='):]
+    logging.vlog(1, 'Converting DSLX to IR in-process')
+    ir_text = cpp_sample_runner.convert_dslx_to_ir(
+        os.path.join(self._run_dir, dslx_filename),
+        top=top,
+        # As in the subprocess case, warnings are only errors when no
+        # converter arguments are given.
+        warnings_as_errors=not options.ir_converter_args)
+    logging.vlog(3, 'Unoptimized IR:\n%s', ir_text)
+    return ir_text
+
   def _optimize_ir(self, ir_filename: str,
                    options: sample.SampleOptions) -> str:
     """Optimizes the IR file and returns the resulting filename."""
+    if self._in_process:
+      logging.vlog(1, 'Optimizing IR in-process')
+      opt_ir_text = cpp_sample_runner.optimize_ir(self._read_file(ir_filename))
+      logging.vlog(3, 'Optimized IR:\n%s', opt_ir_text)
+      return self._write_file('sample.opt.ir', opt_ir_text)
+
     opt_ir_text = self._run_command('Optimizing IR',
                                     (IR_OPT_MAIN_PATH, ir_filename), options)
     logging.vlog(3, 'Optimized IR:\n%s', opt_ir_text)
@@ -729,7 +965,11 @@ class SampleRunner:
     ]
     args.extend(codegen_args)
     args.append(ir_filename)
-    verilog_text = self._run_command('Generating Verilog', args, options)
+    verilog_text = self._run_command(
+        'Generating Verilog',
+        args,
+        options,
+        output_files=('module_sig.textproto',))
     logging.vlog(3, 'Verilog:\n%s', verilog_text)
     return self._write_file(
         'sample.sv' if options.use_system_verilog else 'sample.v', verilog_text)
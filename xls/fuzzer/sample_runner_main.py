@@ -46,6 +46,10 @@ _ARGS_FILE = flags.DEFINE_string(
 _IR_CHANNEL_NAMES_FILE = flags.DEFINE_string(
     'ir_channel_names_file', None,
     'Optional ir names of input channels for a proc.')
+_STAGE_CACHE_DIR = flags.DEFINE_string(
+    'stage_cache_dir', None,
+    'Optional directory in which the results of the sample pipeline stages '
+    'are memoized; may be shared by concurrent runners.')
 
 
 def maybe_copy_file(file_path: Text, dir_path: Text) -> Text:
@@ -65,7 +69,8 @@ def maybe_copy_file(file_path: Text, dir_path: Text) -> Text:
 
 def run(run_dir: Text):
   """Runs the sample in the given run directory."""
-  runner = sample_runner.SampleRunner(run_dir)
+  runner = sample_runner.SampleRunner(
+      run_dir, cache_dir=_STAGE_CACHE_DIR.value)
   input_filename = maybe_copy_file(_INPUT_FILE.value, run_dir)
   options_filename = maybe_copy_file(_OPTIONS_FILE.value, run_dir)
   args_filename = None
@@ -399,6 +399,83 @@ class SampleRunnerTest(test_base.TestCase):
     self.assertIn('Result miscompare for sample 0', str(e.exception))
     self.assertIn('evaluated opt IR (JIT)', str(e.exception))
 
+  def test_in_process_interpret_opt_ir(self):
+    sample_dir = self._make_sample_dir()
+    runner = sample_runner.SampleRunner(sample_dir, in_process=True)
+    dslx_text = 'fn main(x: u8, y: u8) -> u8 { x + y }'
+    runner.run(
+        sample.Sample(
+            dslx_text,
+            sample.SampleOptions(
+                input_is_dslx=True,
+                ir_converter_args=['--top=main'],
+            ), [[
+                interp_value_from_ir_string('bits[8]:42'),
+                interp_value_from_ir_string('bits[8]:100')
+            ]]))
+    self.assertIn('package sample', _read_file(sample_dir, 'sample.ir'))
+    self.assertIn('package sample', _read_file(sample_dir, 'sample.opt.ir'))
+    self.assertSequenceEqual(
+        _split_nonempty_lines(sample_dir, 'sample.ir.results'),
+        ['bits[8]:0x8e'])
+    self.assertSequenceEqual(
+        _split_nonempty_lines(sample_dir, 'sample.opt.ir.results'),
+        ['bits[8]:0x8e'])
+    # The timing is copied back from the child process.
+    self.assertGreater(runner.timing.optimize_ns, 0)
+
+  def test_in_process_interpret_opt_ir_miscompare(self):
+    sample_dir = self._make_sample_dir()
+    runner = sample_runner.SampleRunner(sample_dir, in_process=True)
+    dslx_text = 'fn main(x: u8, y: u8) -> u8 { x + y }'
+    results = [
+        (interp_value_from_ir_string('bits[8]:100'),),  # correct result
+        (interp_value_from_ir_string('bits[8]:100'),),  # correct result
+        (interp_value_from_ir_string('bits[8]:0'),),  # incorrect result
+        (interp_value_from_ir_string('bits[8]:100'),),  # correct result
+    ]
+
+    def result_gen(*_):
+      return results.pop(0)
+
+    runner._evaluate_ir_function = result_gen
+    with self.assertRaises(sample_runner.SampleError) as e:
+      runner.run(
+          sample.Sample(
+              dslx_text,
+              sample.SampleOptions(
+                  input_is_dslx=True,
+                  ir_converter_args=['--top=main'],
+              ), [[
+                  interp_value_from_ir_string('bits[8]:40'),
+                  interp_value_from_ir_string('bits[8]:60')
+              ]]))
+    self.assertIn('Result miscompare for sample 0', str(e.exception))
+    self.assertIn('evaluated opt IR (JIT)', str(e.exception))
+
+  def test_in_process_crash(self):
+    sample_dir = self._make_sample_dir()
+    runner = sample_runner.SampleRunner(sample_dir, in_process=True)
+    dslx_text = 'fn main(x: u8, y: u8) -> u8 { x + y }'
+
+    def crash(*_):
+      os.abort()
+
+    runner._optimize_ir = crash
+    with self.assertRaises(sample_runner.SampleError) as e:
+      runner.run(
+          sample.Sample(
+              dslx_text,
+              sample.SampleOptions(
+                  input_is_dslx=True,
+                  ir_converter_args=['--top=main'],
+              ), [[
+                  interp_value_from_ir_string('bits[8]:40'),
+                  interp_value_from_ir_string('bits[8]:60')
+              ]]))
+    self.assertIn('killed by signal', str(e.exception))
+    self.assertIn('killed by signal', _read_file(sample_dir, 'exception.txt'))
+
   def test_codegen_combinational(self):
     sample_dir = self._make_sample_dir()
     runner = sample_runner.SampleRunner(sample_dir)
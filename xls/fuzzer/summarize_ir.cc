@@ -0,0 +1,61 @@
+// Copyright 2021 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/summarize_ir.h"
+
+#include <string>
+
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/ir/type.h"
+
+namespace xls {
+namespace {
+
+std::string TypeToString(Type* type) {
+  if (type->IsBits()) {
+    return "bits";
+  }
+  if (type->IsArray()) {
+    return "array";
+  }
+  if (type->IsTuple()) {
+    return "tuple";
+  }
+  return "other";
+}
+
+}  // namespace
+
+void SummarizePackage(
+    Package* package,
+    google::protobuf::RepeatedPtrField<fuzzer::NodeProto>* nodes) {
+  for (const FunctionBase* fb : package->GetFunctionBases()) {
+    for (Node* node : fb->nodes()) {
+      fuzzer::NodeProto* node_proto = nodes->Add();
+      node_proto->set_op(OpToString(node->op()));
+      node_proto->set_type(TypeToString(node->GetType()));
+      node_proto->set_width(node->GetType()->GetFlatBitCount());
+      for (Node* operand : node->operands()) {
+        fuzzer::NodeProto* operand_proto = node_proto->add_operands();
+        operand_proto->set_op(OpToString(operand->op()));
+        operand_proto->set_type(TypeToString(operand->GetType()));
+        operand_proto->set_width(operand->GetType()->GetFlatBitCount());
+      }
+    }
+  }
+}
+
+}  // namespace xls
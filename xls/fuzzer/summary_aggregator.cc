@@ -0,0 +1,299 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/summary_aggregator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/fuzzer/sample_summary.pb.h"
+
+namespace xls {
+namespace {
+
+// Adds the nodes of one sample to `stats`.
+void AddNodes(
+    const google::protobuf::RepeatedPtrField<fuzzer::NodeProto>& nodes,
+    SampleStats& stats) {
+  stats.samples++;
+  for (const fuzzer::NodeProto& node_proto : nodes) {
+    stats.node_count++;
+    OpStats& op_stats = stats.per_op[node_proto.op()];
+    op_stats.count++;
+    op_stats.count_by_type[node_proto.type()]++;
+    if (node_proto.width() > 64) {
+      op_stats.wider_than_64bits++;
+    }
+    switch (node_proto.operands_size()) {
+      case 0:
+        op_stats.nullary++;
+        break;
+      case 1:
+        op_stats.unary++;
+        break;
+      case 2:
+        op_stats.binary++;
+        break;
+      default:
+        op_stats.manyary++;
+        break;
+    }
+    for (const fuzzer::NodeProto& operand : node_proto.operands()) {
+      if (operand.width() != node_proto.operands(0).width()) {
+        op_stats.mixed_width++;
+        break;
+      }
+    }
+  }
+}
+
+// Adds `total` to `total_timing` and takes the maximum of `max` and
+// `max_timing`, field by field.
+void MergeTiming(const fuzzer::SampleTimingProto& total,
+                 const fuzzer::SampleTimingProto& max,
+                 fuzzer::SampleTimingProto& total_timing,
+                 fuzzer::SampleTimingProto& max_timing) {
+#define MERGE_FIELD(F)                                                         \
+  {                                                                            \
+    total_timing.set_##F(total_timing.F() + total.F());                        \
+    max_timing.set_##F(std::max(max_timing.F(), max.F()));                     \
+  }
+  MERGE_FIELD(total_ns);
+  MERGE_FIELD(generate_sample_ns);
+  MERGE_FIELD(interpret_dslx_ns);
+  MERGE_FIELD(convert_ir_ns);
+  MERGE_FIELD(unoptimized_interpret_ir_ns);
+  MERGE_FIELD(unoptimized_jit_ns);
+  MERGE_FIELD(optimize_ns);
+  MERGE_FIELD(optimized_interpret_ir_ns);
+  MERGE_FIELD(optimized_jit_ns);
+  MERGE_FIELD(codegen_ns);
+  MERGE_FIELD(simulate_ns);
+#undef MERGE_FIELD
+}
+
+fuzzer::SampleStatsProto SampleStatsToProto(const SampleStats& stats) {
+  fuzzer::SampleStatsProto proto;
+  proto.set_samples(stats.samples);
+  proto.set_node_count(stats.node_count);
+  std::vector<std::string> ops;
+  for (const auto& [op, _] : stats.per_op) {
+    ops.push_back(op);
+  }
+  std::sort(ops.begin(), ops.end());
+  for (const std::string& op : ops) {
+    const OpStats& op_stats = stats.per_op.at(op);
+    fuzzer::OpStatsProto* op_proto = proto.add_ops();
+    op_proto->set_op(op);
+    op_proto->set_count(op_stats.count);
+    for (const auto& [type, count] : op_stats.count_by_type) {
+      (*op_proto->mutable_count_by_type())[type] = count;
+    }
+    op_proto->set_wider_than_64bits(op_stats.wider_than_64bits);
+    op_proto->set_mixed_width(op_stats.mixed_width);
+    op_proto->set_nullary(op_stats.nullary);
+    op_proto->set_unary(op_stats.unary);
+    op_proto->set_binary(op_stats.binary);
+    op_proto->set_manyary(op_stats.manyary);
+  }
+  return proto;
+}
+
+SampleStats SampleStatsFromProto(const fuzzer::SampleStatsProto& proto) {
+  SampleStats stats;
+  stats.samples = proto.samples();
+  stats.node_count = proto.node_count();
+  for (const fuzzer::OpStatsProto& op_proto : proto.ops()) {
+    OpStats op_stats;
+    op_stats.count = op_proto.count();
+    for (const auto& [type, count] : op_proto.count_by_type()) {
+      op_stats.count_by_type[type] = count;
+    }
+    op_stats.wider_than_64bits = op_proto.wider_than_64bits();
+    op_stats.mixed_width = op_proto.mixed_width();
+    op_stats.nullary = op_proto.nullary();
+    op_stats.unary = op_proto.unary();
+    op_stats.binary = op_proto.binary();
+    op_stats.manyary = op_proto.manyary();
+    stats.per_op[op_proto.op()].Merge(op_stats);
+  }
+  return stats;
+}
+
+}  // namespace
+
+void OpStats::Merge(const OpStats& other) {
+  count += other.count;
+  for (const auto& [type, type_count] : other.count_by_type) {
+    count_by_type[type] += type_count;
+  }
+  wider_than_64bits += other.wider_than_64bits;
+  mixed_width += other.mixed_width;
+  nullary += other.nullary;
+  unary += other.unary;
+  binary += other.binary;
+  manyary += other.manyary;
+}
+
+void SampleStats::Merge(const SampleStats& other) {
+  samples += other.samples;
+  node_count += other.node_count;
+  for (const auto& [op, op_stats] : other.per_op) {
+    per_op[op].Merge(op_stats);
+  }
+}
+
+SummaryAggregator SummaryAggregator::FromProto(
+    const fuzzer::SummaryAggregateProto& proto) {
+  SummaryAggregator aggregator;
+  aggregator.unoptimized_ = SampleStatsFromProto(proto.unoptimized());
+  aggregator.optimized_ = SampleStatsFromProto(proto.optimized());
+  aggregator.total_timing_ = proto.total_timing();
+  aggregator.max_timing_ = proto.max_timing();
+  return aggregator;
+}
+
+void SummaryAggregator::AddSample(const fuzzer::SampleSummaryProto& summary) {
+  AddNodes(summary.unoptimized_nodes(), unoptimized_);
+  AddNodes(summary.optimized_nodes(), optimized_);
+  MergeTiming(summary.timing(), summary.timing(), total_timing_, max_timing_);
+}
+
+absl::Status SummaryAggregator::AddSummaryFile(
+    const std::filesystem::path& path) {
+  return ForEachSampleSummary(
+      path, [this](const fuzzer::SampleSummaryProto& summary) {
+        AddSample(summary);
+        return absl::OkStatus();
+      });
+}
+
+void SummaryAggregator::Merge(const SummaryAggregator& other) {
+  unoptimized_.Merge(other.unoptimized_);
+  optimized_.Merge(other.optimized_);
+  MergeTiming(other.total_timing_, other.max_timing_, total_timing_,
+              max_timing_);
+}
+
+fuzzer::SummaryAggregateProto SummaryAggregator::ToProto() const {
+  fuzzer::SummaryAggregateProto proto;
+  *proto.mutable_unoptimized() = SampleStatsToProto(unoptimized_);
+  *proto.mutable_optimized() = SampleStatsToProto(optimized_);
+  *proto.mutable_total_timing() = total_timing_;
+  *proto.mutable_max_timing() = max_timing_;
+  return proto;
+}
+
+absl::Status ForEachSampleSummary(
+    const std::filesystem::path& path,
+    const std::function<absl::Status(const fuzzer::SampleSummaryProto&)>&
+        fn) {
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream.is_open()) {
+    return absl::NotFoundError(
+        absl::StrFormat("Unable to open %s.", path.string()));
+  }
+  auto malformed = [&]() {
+    return absl::DataLossError(absl::StrFormat(
+        "Malformed or truncated summary file %s.", path.string()));
+  };
+  // The file is a sequence of `samples` fields of SampleSummariesProto, each
+  // of which is read as a length-delimited SampleSummaryProto.
+  constexpr uint32_t kSamplesTag =
+      (fuzzer::SampleSummariesProto::kSamplesFieldNumber << 3) |
+      /*length-delimited wire type=*/2;
+  google::protobuf::io::IstreamInputStream input(&stream);
+  fuzzer::SampleSummaryProto summary;
+  while (true) {
+    // Check for the end of the file between summaries.
+    const void* data;
+    int size = 0;
+    while (size == 0) {
+      if (!input.Next(&data, &size)) {
+        return absl::OkStatus();
+      }
+    }
+    input.BackUp(size);
+
+    // A stream is created per summary, which avoids the limit of a coded
+    // stream on the total number of bytes read. Its destructor returns the
+    // data it read ahead to `input`.
+    google::protobuf::io::CodedInputStream coded(&input);
+    uint32_t length;
+    if (coded.ReadTag() != kSamplesTag || !coded.ReadVarint32(&length)) {
+      return malformed();
+    }
+    google::protobuf::io::CodedInputStream::Limit limit =
+        coded.PushLimit(static_cast<int>(length));
+    summary.Clear();
+    if (!summary.MergeFromCodedStream(&coded) ||
+        !coded.ConsumedEntireMessage()) {
+      return malformed();
+    }
+    coded.PopLimit(limit);
+    XLS_RETURN_IF_ERROR(fn(summary));
+  }
+}
+
+absl::StatusOr<SummaryAggregator> AggregateSummaryFiles(
+    absl::Span<const std::string> paths, int64_t thread_count) {
+  thread_count = std::clamp<int64_t>(thread_count, 1,
+                                     std::max<int64_t>(paths.size(), 1));
+  std::vector<SummaryAggregator> partials(thread_count);
+  std::vector<absl::Status> statuses(thread_count);
+  // Files are claimed one at a time, so threads finishing small files early
+  // go on to the remaining ones.
+  std::atomic<int64_t> next_path = 0;
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t i = 0; i < thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>([&, i]() {
+        for (int64_t p = next_path++; p < paths.size(); p = next_path++) {
+          statuses[i] = partials[i].AddSummaryFile(paths[p]);
+          if (!statuses[i].ok()) {
+            return;
+          }
+        }
+      }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  SummaryAggregator result;
+  for (const SummaryAggregator& partial : partials) {
+    result.Merge(partial);
+  }
+  return result;
+}
+
+}  // namespace xls
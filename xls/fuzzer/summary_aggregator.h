@@ -0,0 +1,121 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_SUMMARY_AGGREGATOR_H_
+#define XLS_FUZZER_SUMMARY_AGGREGATOR_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <functional>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/fuzzer/sample_summary.pb.h"
+
+namespace xls {
+
+// Aggregate info about a particular IR op (e.g., 'array_update').
+struct OpStats {
+  // Count of the number of instances of this op.
+  int64_t count = 0;
+
+  // Count of operations by type ("bits", "array", or "tuple").
+  absl::flat_hash_map<std::string, int64_t> count_by_type;
+
+  // Count of operations wider than 64 bits.
+  int64_t wider_than_64bits = 0;
+
+  // Count of operations for which the operands are different widths.
+  int64_t mixed_width = 0;
+
+  // Count of operations with different arities.
+  int64_t nullary = 0;
+  int64_t unary = 0;
+  int64_t binary = 0;
+  int64_t manyary = 0;
+
+  void Merge(const OpStats& other);
+};
+
+// Aggregate information about a set of samples, before or after
+// optimizations.
+struct SampleStats {
+  int64_t samples = 0;
+  int64_t node_count = 0;
+  // Indexed by op name.
+  absl::flat_hash_map<std::string, OpStats> per_op;
+
+  void Merge(const SampleStats& other);
+};
+
+// Computes aggregate statistics of the sample summaries emitted by the fuzzer
+// incrementally, one summary at a time, so that memory use is independent of
+// the number of summaries. Aggregators of disjoint sets of summaries can be
+// merged, and converted to and from protos to merge the partial aggregates of
+// shards of the summaries computed by different processes.
+class SummaryAggregator {
+ public:
+  static SummaryAggregator FromProto(
+      const fuzzer::SummaryAggregateProto& proto);
+
+  // Adds `summary` to the aggregate.
+  void AddSample(const fuzzer::SampleSummaryProto& summary);
+
+  // Adds the summaries in the file at `path` to the aggregate. See
+  // ForEachSampleSummary.
+  absl::Status AddSummaryFile(const std::filesystem::path& path);
+
+  // Adds the samples aggregated by `other`.
+  void Merge(const SummaryAggregator& other);
+
+  fuzzer::SummaryAggregateProto ToProto() const;
+
+  const SampleStats& unoptimized() const { return unoptimized_; }
+  const SampleStats& optimized() const { return optimized_; }
+  // The total time spent in the fuzzer for the various operations (e.g.,
+  // generating the sample, optimizing, JIT time, etc).
+  const fuzzer::SampleTimingProto& total_timing() const {
+    return total_timing_;
+  }
+  // The maximum time spent on a single sample for the various operations.
+  const fuzzer::SampleTimingProto& max_timing() const { return max_timing_; }
+
+ private:
+  SampleStats unoptimized_;
+  SampleStats optimized_;
+  fuzzer::SampleTimingProto total_timing_;
+  fuzzer::SampleTimingProto max_timing_;
+};
+
+// Calls `fn` on each sample summary in the file at `path`, which holds a
+// serialized fuzzer::SampleSummariesProto (or several concatenated, as
+// appended by summarize_ir_main). The summaries are parsed one at a time
+// rather than parsing the whole file at once.
+absl::Status ForEachSampleSummary(
+    const std::filesystem::path& path,
+    const std::function<absl::Status(const fuzzer::SampleSummaryProto&)>& fn);
+
+// Aggregates the summaries in the files at `paths` on up to `thread_count`
+// threads. Each thread aggregates whole files into a partial aggregate, and
+// the partial aggregates are merged, so the result does not depend on the
+// number of threads.
+absl::StatusOr<SummaryAggregator> AggregateSummaryFiles(
+    absl::Span<const std::string> paths, int64_t thread_count);
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_SUMMARY_AGGREGATOR_H_
@@ -0,0 +1,198 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/summary_aggregator.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "google/protobuf/util/message_differencer.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/fuzzer/sample_summary.pb.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+
+// Returns a summary of a sample with `add_count` binary add nodes, one unary
+// neg node wider than 64 bits and the given total time.
+fuzzer::SampleSummaryProto MakeSummary(int64_t add_count, int64_t total_ns) {
+  fuzzer::SampleSummaryProto summary;
+  for (int64_t i = 0; i < add_count; ++i) {
+    fuzzer::NodeProto* add = summary.add_unoptimized_nodes();
+    add->set_op("add");
+    add->set_type("bits");
+    add->set_width(32);
+    add->add_operands()->set_width(32);
+    add->add_operands()->set_width(i == 0 ? 16 : 32);
+  }
+  fuzzer::NodeProto* neg = summary.add_optimized_nodes();
+  neg->set_op("neg");
+  neg->set_type("bits");
+  neg->set_width(128);
+  neg->add_operands()->set_width(128);
+  summary.mutable_timing()->set_total_ns(total_ns);
+  summary.mutable_timing()->set_optimize_ns(total_ns / 2);
+  return summary;
+}
+
+// Appends a SampleSummariesProto holding `summaries` to the file at `path`,
+// as summarize_ir_main does.
+absl::Status AppendSummaries(
+    const std::filesystem::path& path,
+    const std::vector<fuzzer::SampleSummaryProto>& summaries) {
+  fuzzer::SampleSummariesProto proto;
+  for (const fuzzer::SampleSummaryProto& summary : summaries) {
+    *proto.add_samples() = summary;
+  }
+  return AppendStringToFile(path, proto.SerializeAsString());
+}
+
+bool ProtosEqual(const google::protobuf::Message& a,
+                 const google::protobuf::Message& b) {
+  return google::protobuf::util::MessageDifferencer::Equals(a, b);
+}
+
+TEST(SummaryAggregatorTest, AddSample) {
+  SummaryAggregator aggregator;
+  aggregator.AddSample(MakeSummary(/*add_count=*/3, /*total_ns=*/100));
+  aggregator.AddSample(MakeSummary(/*add_count=*/1, /*total_ns=*/300));
+
+  EXPECT_EQ(aggregator.unoptimized().samples, 2);
+  EXPECT_EQ(aggregator.unoptimized().node_count, 4);
+  const OpStats& add = aggregator.unoptimized().per_op.at("add");
+  EXPECT_EQ(add.count, 4);
+  EXPECT_EQ(add.count_by_type.at("bits"), 4);
+  EXPECT_EQ(add.binary, 4);
+  EXPECT_EQ(add.mixed_width, 2);
+  EXPECT_EQ(add.wider_than_64bits, 0);
+
+  EXPECT_EQ(aggregator.optimized().samples, 2);
+  const OpStats& neg = aggregator.optimized().per_op.at("neg");
+  EXPECT_EQ(neg.unary, 2);
+  EXPECT_EQ(neg.wider_than_64bits, 2);
+
+  EXPECT_EQ(aggregator.total_timing().total_ns(), 400);
+  EXPECT_EQ(aggregator.total_timing().optimize_ns(), 200);
+  EXPECT_EQ(aggregator.max_timing().total_ns(), 300);
+  EXPECT_EQ(aggregator.max_timing().optimize_ns(), 150);
+}
+
+TEST(SummaryAggregatorTest, ForEachSampleSummaryReadsAppendedSummaries) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  const std::filesystem::path path = temp_dir.path() / "summary.binarypb";
+  XLS_ASSERT_OK(
+      AppendSummaries(path, {MakeSummary(1, 10), MakeSummary(2, 20)}));
+  XLS_ASSERT_OK(AppendSummaries(path, {MakeSummary(3, 30)}));
+
+  std::vector<int64_t> total_ns;
+  XLS_ASSERT_OK(ForEachSampleSummary(
+      path, [&](const fuzzer::SampleSummaryProto& summary) {
+        total_ns.push_back(summary.timing().total_ns());
+        return absl::OkStatus();
+      }));
+  EXPECT_THAT(total_ns, ElementsAre(10, 20, 30));
+
+  // Errors returned by the callback end the iteration.
+  int64_t calls = 0;
+  EXPECT_THAT(ForEachSampleSummary(path,
+                                   [&](const fuzzer::SampleSummaryProto&) {
+                                     ++calls;
+                                     return absl::InternalError("stop");
+                                   }),
+              StatusIs(absl::StatusCode::kInternal));
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(SummaryAggregatorTest, ForEachSampleSummaryErrors) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  auto ignore = [](const fuzzer::SampleSummaryProto&) {
+    return absl::OkStatus();
+  };
+  EXPECT_THAT(ForEachSampleSummary(temp_dir.path() / "missing", ignore),
+              StatusIs(absl::StatusCode::kNotFound));
+
+  const std::filesystem::path empty_path = temp_dir.path() / "empty";
+  XLS_ASSERT_OK(SetFileContents(empty_path, ""));
+  XLS_EXPECT_OK(ForEachSampleSummary(empty_path, ignore));
+
+  fuzzer::SampleSummariesProto summaries;
+  *summaries.add_samples() = MakeSummary(5, 10);
+  std::string data = summaries.SerializeAsString();
+  const std::filesystem::path truncated_path = temp_dir.path() / "truncated";
+  XLS_ASSERT_OK(
+      SetFileContents(truncated_path, data.substr(0, data.size() - 3)));
+  EXPECT_THAT(ForEachSampleSummary(truncated_path, ignore),
+              StatusIs(absl::StatusCode::kDataLoss));
+}
+
+TEST(SummaryAggregatorTest, ShardedAggregationMatchesSequential) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::vector<std::string> paths;
+  SummaryAggregator expected;
+  for (int64_t file = 0; file < 7; ++file) {
+    std::vector<fuzzer::SampleSummaryProto> summaries;
+    for (int64_t i = 0; i <= file; ++i) {
+      summaries.push_back(MakeSummary(i + 1, 10 * file + i));
+      expected.AddSample(summaries.back());
+    }
+    std::filesystem::path path =
+        temp_dir.path() / absl::StrCat("summary_", file, ".binarypb");
+    XLS_ASSERT_OK(AppendSummaries(path, summaries));
+    paths.push_back(path.string());
+  }
+
+  for (int64_t thread_count : {1, 3, 16}) {
+    XLS_ASSERT_OK_AND_ASSIGN(SummaryAggregator aggregator,
+                             AggregateSummaryFiles(paths, thread_count));
+    EXPECT_TRUE(ProtosEqual(aggregator.ToProto(), expected.ToProto()))
+        << thread_count;
+  }
+
+  // Partial aggregates of shards of the files merge into the aggregate of
+  // all of them.
+  SummaryAggregator merged;
+  for (int64_t shard = 0; shard < 2; ++shard) {
+    std::vector<std::string> shard_paths;
+    for (int64_t i = shard; i < paths.size(); i += 2) {
+      shard_paths.push_back(paths[i]);
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(SummaryAggregator partial,
+                             AggregateSummaryFiles(shard_paths, 2));
+    merged.Merge(SummaryAggregator::FromProto(partial.ToProto()));
+  }
+  EXPECT_TRUE(ProtosEqual(merged.ToProto(), expected.ToProto()));
+  EXPECT_EQ(merged.unoptimized().samples, 28);
+  EXPECT_EQ(merged.max_timing().total_ns(), 66);
+}
+
+TEST(SummaryAggregatorTest, AggregateSummaryFilesReportsErrors) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  EXPECT_THAT(
+      AggregateSummaryFiles({(temp_dir.path() / "missing").string()}, 4),
+      StatusIs(absl::StatusCode::kNotFound));
+}
+
+}  // namespace
+}  // namespace xls
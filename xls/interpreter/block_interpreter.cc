@@ -14,21 +14,30 @@
 
 #include "xls/interpreter/block_interpreter.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/codegen/module_signature.pb.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/events.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_helpers.h"
 
@@ -42,6 +51,20 @@ class BlockInterpreter : public IrInterpreter {
                    const absl::flat_hash_map<std::string, Value>& reg_state)
       : IrInterpreter(/*args=*/{}), inputs_(inputs), reg_state_(reg_state) {}
 
+  // Constructor which evaluates into an existing map of node values. Used by
+  // IncrementalBlockEvaluator to retain values across cycles.
+  BlockInterpreter(const absl::flat_hash_map<std::string, Value>& inputs,
+                   const absl::flat_hash_map<std::string, Value>& reg_state,
+                   absl::flat_hash_map<Node*, Value>* node_values,
+                   InterpreterEvents* events)
+      : IrInterpreter(node_values, events),
+        inputs_(inputs),
+        reg_state_(reg_state) {}
+
+  // Removes the previously evaluated value for `node` so it may be evaluated
+  // again.
+  void ClearResult(Node* node) { NodeValuesMap().erase(node); }
+
   absl::Status HandleInputPort(InputPort* input_port) override {
     auto port_iter = inputs_.find(input_port->GetName());
     if (port_iter == inputs_.end()) {
@@ -106,10 +129,10 @@ class BlockInterpreter : public IrInterpreter {
 
  private:
   // Values fed to the input ports.
-  const absl::flat_hash_map<std::string, Value> inputs_;
+  const absl::flat_hash_map<std::string, Value>& inputs_;
 
   // The state of the registers in this iteration.
-  const absl::flat_hash_map<std::string, Value> reg_state_;
+  const absl::flat_hash_map<std::string, Value>& reg_state_;
 
   // The next state for the registers.
   absl::flat_hash_map<std::string, Value> next_reg_state_;
@@ -130,18 +153,15 @@ bool IsResetAsserted(absl::flat_hash_map<std::string, Value>& inputs,
   return false;
 }
 
-}  // namespace
-
-absl::StatusOr<BlockRunResult> BlockRun(
+// Verifies each input corresponds to an input port and each register value
+// corresponds to a register, given the names of the input ports and
+// registers of the block. The reverse checks are performed when evaluating
+// input ports and register reads.
+absl::Status VerifyBlockRunArgumentNames(
     const absl::flat_hash_map<std::string, Value>& inputs,
-    const absl::flat_hash_map<std::string, Value>& reg_state, Block* block) {
-  // Verify each input corresponds to an input port. The reverse check (each
-  // input port has a corresponding value in `inputs`) is checked in
-  // HandleInputPort.
-  absl::flat_hash_set<std::string> input_port_names;
-  for (InputPort* port : block->GetInputPorts()) {
-    input_port_names.insert(port->GetName());
-  }
+    const absl::flat_hash_map<std::string, Value>& reg_state,
+    const absl::flat_hash_set<std::string>& input_port_names,
+    const absl::flat_hash_set<std::string>& reg_names) {
   for (const auto& [name, value] : inputs) {
     // Empty tuples don't have data
     if (value.GetFlatBitCount() == 0) {
@@ -152,20 +172,50 @@ absl::StatusOr<BlockRunResult> BlockRun(
           absl::StrFormat("Block has no input port '%s'", name));
     }
   }
-
-  // Verify each register value corresponds to a register. The reverse check
-  // (each register has a corresponding value in `reg_state`) is checked in
-  // HandleRegisterRead.
-  absl::flat_hash_set<std::string> reg_names;
-  for (Register* reg : block->GetRegisters()) {
-    reg_names.insert(reg->name());
-  }
   for (const auto& [name, value] : reg_state) {
     if (!reg_names.contains(name)) {
       return absl::InvalidArgumentError(
           absl::StrFormat("Block has no register '%s'", name));
     }
   }
+  return absl::OkStatus();
+}
+
+absl::flat_hash_set<std::string> InputPortNames(Block* block) {
+  absl::flat_hash_set<std::string> names;
+  for (InputPort* port : block->GetInputPorts()) {
+    names.insert(port->GetName());
+  }
+  return names;
+}
+
+absl::flat_hash_set<std::string> RegisterNames(Block* block) {
+  absl::flat_hash_set<std::string> names;
+  for (Register* reg : block->GetRegisters()) {
+    names.insert(reg->name());
+  }
+  return names;
+}
+
+absl::Status VerifyBlockRunArguments(
+    const absl::flat_hash_map<std::string, Value>& inputs,
+    const absl::flat_hash_map<std::string, Value>& reg_state, Block* block) {
+  return VerifyBlockRunArgumentNames(inputs, reg_state, InputPortNames(block),
+                                     RegisterNames(block));
+}
+
+// Returns true if `node` produces interpreter events and so must be evaluated
+// every cycle.
+bool ProducesEvents(Node* node) {
+  return node->Is<Trace>() || node->Is<Assert>() || node->Is<Cover>();
+}
+
+}  // namespace
+
+absl::StatusOr<BlockRunResult> BlockRun(
+    const absl::flat_hash_map<std::string, Value>& inputs,
+    const absl::flat_hash_map<std::string, Value>& reg_state, Block* block) {
+  XLS_RETURN_IF_ERROR(VerifyBlockRunArguments(inputs, reg_state, block));
 
   BlockInterpreter interpreter(inputs, reg_state);
   XLS_RETURN_IF_ERROR(block->Accept(&interpreter));
@@ -181,6 +231,112 @@ absl::StatusOr<BlockRunResult> BlockRun(
   return result;
 }
 
+IncrementalBlockEvaluator::IncrementalBlockEvaluator(Block* block)
+    : block_(block),
+      input_port_names_(InputPortNames(block)),
+      register_names_(RegisterNames(block)) {
+  absl::flat_hash_map<Node*, int64_t> node_indices;
+  for (Node* node : TopoSort(block)) {
+    int64_t index = topo_sorted_nodes_.size();
+    node_indices[node] = index;
+    topo_sorted_nodes_.push_back(node);
+    if (node->Is<InputPort>()) {
+      sources_.push_back(Source{.index = index,
+                                .name = node->GetName(),
+                                .is_input_port = true});
+    } else if (node->Is<RegisterRead>()) {
+      sources_.push_back(
+          Source{.index = index,
+                 .name = node->As<RegisterRead>()->GetRegister()->name(),
+                 .is_input_port = false});
+    } else if (node->Is<RegisterWrite>() || ProducesEvents(node)) {
+      always_evaluated_.push_back(index);
+    }
+  }
+  users_.resize(topo_sorted_nodes_.size());
+  for (int64_t i = 0; i < topo_sorted_nodes_.size(); ++i) {
+    for (Node* user : topo_sorted_nodes_[i]->users()) {
+      users_[i].push_back(node_indices.at(user));
+    }
+  }
+  is_dirty_.resize(topo_sorted_nodes_.size(), false);
+}
+
+void IncrementalBlockEvaluator::Reset() {
+  initialized_ = false;
+  node_values_.clear();
+}
+
+absl::StatusOr<BlockRunResult> IncrementalBlockEvaluator::RunCycle(
+    const absl::flat_hash_map<std::string, Value>& inputs,
+    const absl::flat_hash_map<std::string, Value>& reg_state) {
+  XLS_RETURN_IF_ERROR(VerifyBlockRunArgumentNames(
+      inputs, reg_state, input_port_names_, register_names_));
+
+  // A node is dirty if it is an input port or register read whose value
+  // differs from its retained value, or if it uses a dirty node. On the first
+  // cycle every node is dirty.
+  dirty_indices_.clear();
+  auto mark_dirty = [&](int64_t index) {
+    if (!is_dirty_[index]) {
+      is_dirty_[index] = true;
+      dirty_indices_.push_back(index);
+    }
+  };
+  if (!initialized_) {
+    for (int64_t i = 0; i < topo_sorted_nodes_.size(); ++i) {
+      mark_dirty(i);
+    }
+  } else {
+    for (int64_t index : always_evaluated_) {
+      mark_dirty(index);
+    }
+    for (const Source& source : sources_) {
+      const absl::flat_hash_map<std::string, Value>& values =
+          source.is_input_port ? inputs : reg_state;
+      auto iter = values.find(source.name);
+      if (iter == values.end() ||
+          iter->second != node_values_.at(topo_sorted_nodes_[source.index])) {
+        mark_dirty(source.index);
+      }
+    }
+    // Mark the transitive fanout. `dirty_indices_` grows as nodes are marked.
+    for (int64_t i = 0; i < dirty_indices_.size(); ++i) {
+      for (int64_t user : users_[dirty_indices_[i]]) {
+        mark_dirty(user);
+      }
+    }
+  }
+  // Indices are positions in topological order.
+  std::sort(dirty_indices_.begin(), dirty_indices_.end());
+  for (int64_t index : dirty_indices_) {
+    is_dirty_[index] = false;
+  }
+
+  // If evaluation fails the retained values are inconsistent so start over
+  // on the next cycle.
+  initialized_ = false;
+  InterpreterEvents events;
+  BlockInterpreter interpreter(inputs, reg_state, &node_values_, &events);
+  for (int64_t index : dirty_indices_) {
+    Node* node = topo_sorted_nodes_[index];
+    interpreter.ClearResult(node);
+    XLS_RETURN_IF_ERROR(node->VisitSingleNode(&interpreter));
+  }
+  initialized_ = true;
+  last_evaluated_node_count_ = dirty_indices_.size();
+
+  BlockRunResult result;
+  for (Node* port : block_->GetOutputPorts()) {
+    result.outputs[port->GetName()] = node_values_.at(port->operand(0));
+  }
+  // Register writes are evaluated every cycle, so the complete next state is
+  // moved out of the interpreter rather than retained and copied.
+  result.reg_state = std::move(interpreter.MoveRegState());
+  result.interpreter_events = std::move(events);
+  return result;
+}
+
 // Convert a uint64_t to a Value suitable for node's type.
 static absl::StatusOr<Value> ConvertInputUint64ToValue(uint64_t input,
                                                        const InputPort* port,
@@ -502,10 +658,11 @@ ChannelSink::GetOutputCycleSequenceAsUint64() const {
   return ret;
 }
 
-absl::StatusOr<BlockIOResults> InterpretChannelizedSequentialBlock(
+absl::StatusOr<BlockIOResults> RunChannelizedSequentialBlock(
     Block* block, absl::Span<ChannelSource> channel_sources,
     absl::Span<ChannelSink> channel_sinks,
     absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
+    const BlockCycleEvaluator& evaluate_cycle,
     std::optional<verilog::ResetProto> reset, int64_t seed) {
   std::minstd_rand random_engine;
   random_engine.seed(seed);
@@ -543,7 +700,7 @@ absl::StatusOr<BlockIOResults> InterpretChannelizedSequentialBlock(
 
     // Block results
     XLS_ASSIGN_OR_RETURN(BlockRunResult result,
-                         BlockRun(input_set, reg_state, block));
+                         evaluate_cycle(input_set, reg_state));
 
     // Sources get ready
     for (ChannelSource& src : channel_sources) {
@@ -572,10 +729,11 @@ absl::StatusOr<BlockIOResults> InterpretChannelizedSequentialBlock(
 }
 
 absl::StatusOr<BlockIOResultsAsUint64>
-InterpretChannelizedSequentialBlockWithUint64(
+RunChannelizedSequentialBlockWithUint64(
     Block* block, absl::Span<ChannelSource> channel_sources,
     absl::Span<ChannelSink> channel_sinks,
     absl::Span<const absl::flat_hash_map<std::string, uint64_t>> inputs,
+    const BlockCycleEvaluator& evaluate_cycle,
     std::optional<verilog::ResetProto> reset, int64_t seed) {
   std::vector<absl::flat_hash_map<std::string, Value>> input_values;
   for (const absl::flat_hash_map<std::string, uint64_t>& input_set : inputs) {
@@ -593,8 +751,8 @@ InterpretChannelizedSequentialBlockWithUint64(
 
   XLS_ASSIGN_OR_RETURN(
       BlockIOResults block_io_result,
-      InterpretChannelizedSequentialBlock(block, channel_sources, channel_sinks,
-                                          input_values, reset, seed));
+      RunChannelizedSequentialBlock(block, channel_sources, channel_sinks,
+                                    input_values, evaluate_cycle, reset, seed));
 
   BlockIOResultsAsUint64 block_io_result_as_uint64;
 
@@ -616,4 +774,116 @@ InterpretChannelizedSequentialBlockWithUint64(
   return block_io_result_as_uint64;
 }
 
+// Returns a cycle evaluator backed by its own IncrementalBlockEvaluator. The
+// returned evaluator must not be used concurrently.
+static BlockCycleEvaluator MakeIncrementalCycleEvaluator(Block* block) {
+  auto evaluator = std::make_shared<IncrementalBlockEvaluator>(block);
+  return [evaluator](const absl::flat_hash_map<std::string, Value>& inputs,
+                     const absl::flat_hash_map<std::string, Value>& reg_state) {
+    return evaluator->RunCycle(inputs, reg_state);
+  };
+}
+
+absl::StatusOr<BlockIOResults> InterpretChannelizedSequentialBlock(
+    Block* block, absl::Span<ChannelSource> channel_sources,
+    absl::Span<ChannelSink> channel_sinks,
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
+    std::optional<verilog::ResetProto> reset, int64_t seed) {
+  return RunChannelizedSequentialBlock(
+      block, channel_sources, channel_sinks, inputs,
+      MakeIncrementalCycleEvaluator(block), reset, seed);
+}
+
+absl::StatusOr<BlockIOResultsAsUint64>
+InterpretChannelizedSequentialBlockWithUint64(
+    Block* block, absl::Span<ChannelSource> channel_sources,
+    absl::Span<ChannelSink> channel_sinks,
+    absl::Span<const absl::flat_hash_map<std::string, uint64_t>> inputs,
+    std::optional<verilog::ResetProto> reset, int64_t seed) {
+  return RunChannelizedSequentialBlockWithUint64(
+      block, channel_sources, channel_sinks, inputs,
+      MakeIncrementalCycleEvaluator(block), reset, seed);
+}
+
+absl::StatusOr<std::vector<BlockIOResults>> RunChannelizedSequentialBlocks(
+    Block* block, absl::Span<BlockStimulus> stimuli,
+    const BlockCycleEvaluatorFactory& evaluator_factory,
+    std::optional<int64_t> thread_count) {
+  int64_t num_threads;
+  if (thread_count.has_value()) {
+    XLS_RET_CHECK_GT(thread_count.value(), 0);
+    num_threads = thread_count.value();
+  } else {
+    num_threads = static_cast<int64_t>(std::thread::hardware_concurrency());
+  }
+  num_threads = std::clamp(num_threads, int64_t{1},
+                           std::max(static_cast<int64_t>(stimuli.size()),
+                                    int64_t{1}));
+
+  std::vector<absl::StatusOr<BlockIOResults>> results(
+      stimuli.size(), absl::UnknownError("Stimulus was not simulated"));
+  // The evaluators are created on this thread before any worker starts, so
+  // creating one (which sorts or compiles the block) never overlaps with
+  // another or with a simulation.
+  std::vector<absl::StatusOr<BlockCycleEvaluator>> evaluators;
+  evaluators.reserve(num_threads);
+  for (int64_t i = 0; i < num_threads; ++i) {
+    evaluators.push_back(evaluator_factory());
+  }
+  std::atomic<int64_t> next_stimulus = 0;
+  auto worker = [&](const absl::StatusOr<BlockCycleEvaluator>& evaluator) {
+    // Each stimulus is claimed by exactly one worker, so results are written
+    // without synchronization.
+    for (int64_t i = next_stimulus.fetch_add(1); i < stimuli.size();
+         i = next_stimulus.fetch_add(1)) {
+      if (!evaluator.ok()) {
+        results[i] = evaluator.status();
+        continue;
+      }
+      BlockStimulus& stimulus = stimuli[i];
+      results[i] = RunChannelizedSequentialBlock(
+          block, absl::MakeSpan(stimulus.channel_sources),
+          absl::MakeSpan(stimulus.channel_sinks), stimulus.inputs, *evaluator,
+          stimulus.reset, stimulus.seed);
+    }
+  };
+
+  if (num_threads == 1) {
+    worker(evaluators.front());
+  } else {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(num_threads);
+    for (int64_t i = 0; i < num_threads; ++i) {
+      threads.push_back(
+          std::make_unique<Thread>([&, i]() { worker(evaluators[i]); }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+
+  std::vector<BlockIOResults> block_io_results;
+  block_io_results.reserve(results.size());
+  for (absl::StatusOr<BlockIOResults>& result : results) {
+    XLS_RETURN_IF_ERROR(result.status());
+    block_io_results.push_back(std::move(result).value());
+  }
+  return block_io_results;
+}
+
+absl::StatusOr<std::vector<BlockIOResults>>
+InterpretChannelizedSequentialBlocks(
+    Block* block, absl::Span<BlockStimulus> stimuli,
+    std::optional<int64_t> thread_count) {
+  // Each worker has its own evaluator, which is shared by the stimuli it
+  // simulates. Values retained from another stimulus are only compared
+  // against, so they do not affect the results.
+  return RunChannelizedSequentialBlocks(
+      block, stimuli,
+      [block]() -> absl::StatusOr<BlockCycleEvaluator> {
+        return MakeIncrementalCycleEvaluator(block);
+      },
+      thread_count);
+}
+
 }  // namespace xls
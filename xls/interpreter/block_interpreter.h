@@ -15,6 +15,8 @@
 #ifndef XLS_INTERPRETER_BLOCK_INTERPRETER_H_
 #define XLS_INTERPRETER_BLOCK_INTERPRETER_H_
 
+#include <cstdint>
+#include <functional>
 #include <optional>
 #include <random>
 #include <string>
@@ -22,6 +24,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
@@ -46,6 +49,65 @@ absl::StatusOr<BlockRunResult> BlockRun(
     const absl::flat_hash_map<std::string, Value>& inputs,
     const absl::flat_hash_map<std::string, Value>& reg_state, Block* block);
 
+// Evaluates a block cycle by cycle like BlockRun but retains the value of
+// every node between cycles. Each cycle only the transitive fanout of the
+// input ports and registers whose values changed since the previous cycle is
+// re-evaluated, as in an event-driven simulator. Trace, assert and cover nodes
+// are re-evaluated every cycle so the produced events match BlockRun, as are
+// register writes so the next register state need not be retained.
+class IncrementalBlockEvaluator {
+ public:
+  explicit IncrementalBlockEvaluator(Block* block);
+
+  // Runs a single cycle of the block. Arguments and results are as in
+  // BlockRun.
+  absl::StatusOr<BlockRunResult> RunCycle(
+      const absl::flat_hash_map<std::string, Value>& inputs,
+      const absl::flat_hash_map<std::string, Value>& reg_state);
+
+  // Forgets all retained values so the next cycle evaluates every node.
+  void Reset();
+
+  // Returns the number of nodes evaluated in the most recent cycle.
+  int64_t last_evaluated_node_count() const {
+    return last_evaluated_node_count_;
+  }
+
+  Block* block() const { return block_; }
+
+ private:
+  // An input port or register read, whose value is compared against its
+  // retained value each cycle.
+  struct Source {
+    // Position of the node in `topo_sorted_nodes_`.
+    int64_t index;
+    // Name of the input port or of the register read.
+    std::string name;
+    bool is_input_port;
+  };
+
+  Block* block_;
+  absl::flat_hash_set<std::string> input_port_names_;
+  absl::flat_hash_set<std::string> register_names_;
+
+  // Nodes are identified by their position in `topo_sorted_nodes_`.
+  std::vector<Node*> topo_sorted_nodes_;
+  std::vector<std::vector<int64_t>> users_;
+  std::vector<Source> sources_;
+  // Register writes and nodes producing events, evaluated every cycle.
+  std::vector<int64_t> always_evaluated_;
+
+  // Whether `node_values_` holds the values of the previous cycle.
+  bool initialized_ = false;
+  absl::flat_hash_map<Node*, Value> node_values_;
+
+  // The dirty nodes of the current cycle. Kept between cycles to avoid
+  // reallocation; `is_dirty_` is all false outside of RunCycle.
+  std::vector<bool> is_dirty_;
+  std::vector<int64_t> dirty_indices_;
+  int64_t last_evaluated_node_count_ = 0;
+};
+
 // Runs the interpreter on a combinational block. `inputs` must contain a
 // value for each input port in the block. The returned map contains a value
 // for each output port of the block.
@@ -259,6 +321,67 @@ InterpretChannelizedSequentialBlockWithUint64(
     absl::Span<const absl::flat_hash_map<std::string, uint64_t>> inputs,
     std::optional<verilog::ResetProto> reset = std::nullopt, int64_t seed = 0);
 
+// Function which evaluates a single cycle of a block given the values on the
+// input ports and the current register state. BlockRun is the interpreter
+// implementation.
+using BlockCycleEvaluator = std::function<absl::StatusOr<BlockRunResult>(
+    const absl::flat_hash_map<std::string, Value>& inputs,
+    const absl::flat_hash_map<std::string, Value>& reg_state)>;
+
+// Simulates the block cycle by cycle driving the ports of the given channel
+// sources and sinks, evaluating each cycle with `evaluate_cycle`. Registers
+// start with zero values. The Interpret* functions above call these with
+// IncrementalBlockEvaluators.
+absl::StatusOr<BlockIOResults> RunChannelizedSequentialBlock(
+    Block* block, absl::Span<ChannelSource> channel_sources,
+    absl::Span<ChannelSink> channel_sinks,
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
+    const BlockCycleEvaluator& evaluate_cycle,
+    std::optional<verilog::ResetProto> reset = std::nullopt, int64_t seed = 0);
+
+absl::StatusOr<BlockIOResultsAsUint64>
+RunChannelizedSequentialBlockWithUint64(
+    Block* block, absl::Span<ChannelSource> channel_sources,
+    absl::Span<ChannelSink> channel_sinks,
+    absl::Span<const absl::flat_hash_map<std::string, uint64_t>> inputs,
+    const BlockCycleEvaluator& evaluate_cycle,
+    std::optional<verilog::ResetProto> reset = std::nullopt, int64_t seed = 0);
+
+// One independent stimulus of a block: the arguments of a single
+// RunChannelizedSequentialBlock call other than the block and the evaluator.
+struct BlockStimulus {
+  std::vector<ChannelSource> channel_sources;
+  std::vector<ChannelSink> channel_sinks;
+  std::vector<absl::flat_hash_map<std::string, Value>> inputs;
+  std::optional<verilog::ResetProto> reset;
+  int64_t seed = 0;
+};
+
+// Returns a new cycle evaluator. RunChannelizedSequentialBlocks calls it once
+// per worker thread, on the calling thread, before starting any worker; the
+// evaluators it returns must be safe to use concurrently with each other.
+using BlockCycleEvaluatorFactory =
+    std::function<absl::StatusOr<BlockCycleEvaluator>()>;
+
+// Simulates the block once for each of the independent `stimuli`, as
+// RunChannelizedSequentialBlock would, distributing the simulations over
+// `thread_count` worker threads. If `thread_count` is not given, the number of
+// hardware threads (capped at the number of stimuli) is used. The channel
+// sources and sinks of each stimulus are updated as by a sequential
+// simulation. Returns the results in the order of `stimuli`, or the error of
+// the first stimulus (in that order) whose simulation failed.
+absl::StatusOr<std::vector<BlockIOResults>> RunChannelizedSequentialBlocks(
+    Block* block, absl::Span<BlockStimulus> stimuli,
+    const BlockCycleEvaluatorFactory& evaluator_factory,
+    std::optional<int64_t> thread_count = std::nullopt);
+
+// Interprets the block on each of the independent `stimuli` concurrently. The
+// block must not be modified while this runs.
+absl::StatusOr<std::vector<BlockIOResults>>
+InterpretChannelizedSequentialBlocks(
+    Block* block, absl::Span<BlockStimulus> stimuli,
+    std::optional<int64_t> thread_count = std::nullopt);
+
 }  // namespace xls
 
 #endif  // XLS_INTERPRETER_BLOCK_INTERPRETER_H_
@@ -14,8 +14,10 @@
 
 #include "xls/interpreter/block_interpreter.h"
 
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -24,6 +26,7 @@
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/block.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/format_preference.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
@@ -668,5 +671,207 @@ TEST_F(BlockInterpreterTest, InterpreterEventsCaptured) {
   EXPECT_THAT(result.interpreter_events.assert_msgs, ElementsAre("foo"));
 }
 
+TEST_F(BlockInterpreterTest, IncrementalEvaluationMatchesBlockRun) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue y = b.InputPort("y", package->GetBitsType(32));
+  BValue en = b.InputPort("en", package->GetBitsType(1));
+
+  // A two-stage pipeline fed by `x` and an accumulator of `y` which is only
+  // loaded when `en` is set.
+  BValue x_d = b.InsertRegister("x_d", b.Not(x));
+  BValue x_dd = b.InsertRegister("x_dd", b.Add(x_d, x_d));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Register * acc_reg,
+      b.block()->AddRegister("acc", package->GetBitsType(32)));
+  BValue acc = b.RegisterRead(acc_reg);
+  b.RegisterWrite(acc_reg, b.Add(acc, y), /*load_enable=*/en);
+  b.OutputPort("x_out", x_dd);
+  b.OutputPort("acc_out", acc);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  struct Cycle {
+    uint64_t x;
+    uint64_t y;
+    uint64_t en;
+  };
+  std::vector<Cycle> cycles = {{1, 2, 1},  {1, 2, 1},  {1, 2, 0}, {1, 2, 0},
+                               {1, 2, 0},  {5, 2, 0},  {5, 2, 0}, {5, 2, 0},
+                               {5, 9, 1},  {6, 9, 0},  {6, 9, 0}, {6, 9, 0},
+                               {6, 9, 0}};
+
+  absl::flat_hash_map<std::string, Value> reg_state;
+  for (Register* reg : block->GetRegisters()) {
+    reg_state[reg->name()] = Value(UBits(0, 32));
+  }
+  absl::flat_hash_map<std::string, Value> incremental_reg_state = reg_state;
+  IncrementalBlockEvaluator evaluator(block);
+  std::vector<int64_t> evaluated_node_counts;
+  for (const Cycle& cycle : cycles) {
+    absl::flat_hash_map<std::string, Value> inputs = {
+        {"x", Value(UBits(cycle.x, 32))},
+        {"y", Value(UBits(cycle.y, 32))},
+        {"en", Value(UBits(cycle.en, 1))}};
+    XLS_ASSERT_OK_AND_ASSIGN(BlockRunResult expected,
+                             BlockRun(inputs, reg_state, block));
+    XLS_ASSERT_OK_AND_ASSIGN(BlockRunResult actual,
+                             evaluator.RunCycle(inputs, incremental_reg_state));
+    EXPECT_EQ(actual.outputs, expected.outputs);
+    EXPECT_EQ(actual.reg_state, expected.reg_state);
+    reg_state = std::move(expected.reg_state);
+    incremental_reg_state = std::move(actual.reg_state);
+    evaluated_node_counts.push_back(evaluator.last_evaluated_node_count());
+  }
+
+  // The first cycle evaluates everything. Once the inputs are unchanged and
+  // the pipeline and accumulator settle only the three register writes,
+  // which are evaluated every cycle, need to be evaluated.
+  EXPECT_EQ(evaluated_node_counts.front(), block->node_count());
+  EXPECT_EQ(evaluated_node_counts[3], 3);
+  EXPECT_EQ(evaluated_node_counts[4], 3);
+  EXPECT_GT(evaluated_node_counts[5], 3);
+  EXPECT_EQ(evaluated_node_counts[12], 3);
+  for (int64_t count : evaluated_node_counts) {
+    EXPECT_LE(count, block->node_count());
+  }
+}
+
+TEST_F(BlockInterpreterTest, IncrementalEvaluationCapturesEventsEveryCycle) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue tkn = b.Literal(Value::Token());
+  b.Trace(tkn, b.Literal(Value(UBits(1, 1))), {x},
+          {"x is ", FormatPreference::kDefault});
+  b.OutputPort("y", x);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  IncrementalBlockEvaluator evaluator(block);
+  for (int64_t i = 0; i < 3; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        BlockRunResult result,
+        evaluator.RunCycle({{"x", Value(UBits(7, 32))}}, {}));
+    EXPECT_THAT(result.interpreter_events.trace_msgs, ElementsAre("x is 7"));
+    EXPECT_THAT(result.outputs,
+                UnorderedElementsAre(Pair("y", Value(UBits(7, 32)))));
+  }
+}
+
+TEST_F(BlockInterpreterTest, IncrementalEvaluationMissingInput) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  b.OutputPort("y", b.Not(b.InputPort("x", package->GetBitsType(8))));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  IncrementalBlockEvaluator evaluator(block);
+  XLS_ASSERT_OK(evaluator.RunCycle({{"x", Value(UBits(1, 8))}}, {}).status());
+  EXPECT_THAT(evaluator.RunCycle({}, {}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Missing input for port 'x'")));
+  // A failed cycle forces a full evaluation of the next one.
+  XLS_ASSERT_OK_AND_ASSIGN(BlockRunResult result,
+                           evaluator.RunCycle({{"x", Value(UBits(1, 8))}}, {}));
+  EXPECT_EQ(evaluator.last_evaluated_node_count(), block->node_count());
+  EXPECT_THAT(result.outputs,
+              UnorderedElementsAre(Pair("y", Value(UBits(0xfe, 8)))));
+}
+
+TEST_F(BlockInterpreterTest, ParallelStimuliMatchSequentialSimulation) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Register * reg,
+      b.block()->AddRegister("accum", package->GetBitsType(32)));
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue x_vld = b.InputPort("x_vld", package->GetBitsType(1));
+  BValue out_rdy = b.InputPort("out_rdy", package->GetBitsType(1));
+  BValue accum = b.RegisterRead(reg);
+  BValue next_accum =
+      b.Select(b.And(x_vld, out_rdy), {accum, b.Add(x, accum)});
+  b.RegisterWrite(reg, next_accum);
+  b.OutputPort("x_rdy", out_rdy);
+  b.OutputPort("out", next_accum);
+  b.OutputPort("out_vld", x_vld);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  auto make_stimulus = [&](int64_t i) -> absl::StatusOr<BlockStimulus> {
+    BlockStimulus stimulus;
+    stimulus.channel_sources.push_back(
+        ChannelSource("x", "x_vld", "x_rdy", 0.5, block));
+    std::vector<uint64_t> data;
+    for (int64_t j = 0; j <= i; ++j) {
+      data.push_back(i + j);
+    }
+    XLS_RETURN_IF_ERROR(stimulus.channel_sources[0].SetDataSequence(data));
+    stimulus.channel_sinks.push_back(
+        ChannelSink("out", "out_vld", "out_rdy", 0.5, block));
+    stimulus.inputs.resize(50);
+    stimulus.seed = i;
+    return stimulus;
+  };
+
+  constexpr int64_t kStimulusCount = 16;
+  std::vector<BlockStimulus> stimuli;
+  for (int64_t i = 0; i < kStimulusCount; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(BlockStimulus stimulus, make_stimulus(i));
+    stimuli.push_back(std::move(stimulus));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<BlockIOResults> results,
+      InterpretChannelizedSequentialBlocks(block, absl::MakeSpan(stimuli),
+                                           /*thread_count=*/4));
+  ASSERT_EQ(results.size(), kStimulusCount);
+
+  for (int64_t i = 0; i < kStimulusCount; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(BlockStimulus expected, make_stimulus(i));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        BlockIOResults expected_results,
+        InterpretChannelizedSequentialBlock(
+            block, absl::MakeSpan(expected.channel_sources),
+            absl::MakeSpan(expected.channel_sinks), expected.inputs,
+            expected.reset, expected.seed));
+    EXPECT_EQ(results[i].inputs, expected_results.inputs);
+    EXPECT_EQ(results[i].outputs, expected_results.outputs);
+    EXPECT_EQ(stimuli[i].channel_sinks[0].GetOutputSequence(),
+              expected.channel_sinks[0].GetOutputSequence());
+  }
+}
+
+TEST_F(BlockInterpreterTest, ParallelStimuliReturnFirstError) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  b.OutputPort("y", b.Not(b.InputPort("x", package->GetBitsType(8))));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  std::vector<BlockStimulus> stimuli(4);
+  for (int64_t i = 0; i < stimuli.size(); ++i) {
+    stimuli[i].inputs.push_back({{"x", Value(UBits(i, 8))}});
+  }
+  // Stimuli 1 and 3 fail; the error of stimulus 1 is returned.
+  stimuli[1].inputs[0].clear();
+  stimuli[3].inputs[0]["z"] = Value(UBits(0, 8));
+  EXPECT_THAT(
+      InterpretChannelizedSequentialBlocks(block, absl::MakeSpan(stimuli),
+                                           /*thread_count=*/2),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("Missing input for port 'x'")));
+
+  stimuli[1].inputs[0] = {{"x", Value(UBits(1, 8))}};
+  stimuli[3].inputs[0].erase("z");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<BlockIOResults> results,
+      InterpretChannelizedSequentialBlocks(block, absl::MakeSpan(stimuli)));
+  ASSERT_EQ(results.size(), stimuli.size());
+  for (int64_t i = 0; i < results.size(); ++i) {
+    EXPECT_THAT(results[i].outputs,
+                ElementsAre(UnorderedElementsAre(
+                    Pair("y", Value(UBits(~i & 0xff, 8))))));
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -15,23 +15,75 @@
 #include "xls/interpreter/channel_queue.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <optional>
+#include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value_helpers.h"
 
 namespace xls {
 
+void ValueRingBuffer::Reserve(int64_t capacity) {
+  if (capacity <= elements_.size()) {
+    return;
+  }
+  std::vector<Value> elements(capacity);
+  for (int64_t i = 0; i < size_; ++i) {
+    elements[i] = std::move(elements_[(head_ + i) % elements_.size()]);
+  }
+  elements_ = std::move(elements);
+  head_ = 0;
+}
+
+void ValueRingBuffer::PushBack(Value value) {
+  if (size_ == elements_.size()) {
+    Reserve(std::max<int64_t>(8, 2 * elements_.size()));
+  }
+  elements_[(head_ + size_) % elements_.size()] = std::move(value);
+  ++size_;
+}
+
+Value ValueRingBuffer::PopFront() {
+  XLS_CHECK(!empty());
+  // Leave an empty value behind so the storage of large values is released.
+  Value value = std::exchange(elements_[head_], Value());
+  head_ = (head_ + 1) % elements_.size();
+  --size_;
+  return value;
+}
+
+void ValueRingBuffer::Clear() {
+  for (int64_t i = 0; i < size_; ++i) {
+    elements_[(head_ + i) % elements_.size()] = Value();
+  }
+  head_ = 0;
+  size_ = 0;
+}
+
+ChannelQueue::ChannelQueue(Channel* channel, std::optional<int64_t> capacity)
+    : channel_(channel),
+      capacity_(channel->kind() == ChannelKind::kStreaming ? capacity
+                                                           : std::nullopt) {
+  if (capacity_.has_value()) {
+    XLS_CHECK_GT(*capacity_, 0) << absl::StreamFormat(
+        "Capacity of channel %s must be positive", channel->name());
+    queue_.Reserve(*capacity_);
+  }
+}
+
 absl::Status ChannelQueue::AttachGenerator(GeneratorFn generator) {
   absl::MutexLock lock(&mutex_);
-  if (generator_.has_value()) {
+  if (HasGeneratorInternal()) {
     return absl::InternalError("ChannelQueue already has a generator attached");
   }
   if (channel_->kind() == ChannelKind::kSingleValue) {
@@ -41,14 +93,74 @@ absl::Status ChannelQueue::AttachGenerator(GeneratorFn generator) {
                         channel()->name()));
   }
   generator_ = std::move(generator);
+  // Readers blocked on the empty queue may now receive generated values.
+  NotifyWrite();
   return absl::OkStatus();
 }
 
-absl::Status ChannelQueue::Write(const Value& value) {
+absl::Status ChannelQueue::AttachBatchGenerator(BatchGeneratorFn generator,
+                                                int64_t batch_size) {
+  absl::MutexLock lock(&mutex_);
+  if (HasGeneratorInternal()) {
+    return absl::InternalError("ChannelQueue already has a generator attached");
+  }
+  if (channel_->kind() == ChannelKind::kSingleValue) {
+    return absl::InternalError(
+        absl::StrFormat("ChannelQueues for single-value channels cannot have a "
+                        "generator. Channel: %s",
+                        channel()->name()));
+  }
+  if (batch_size <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Generator batch size must be positive, got %d",
+                        batch_size));
+  }
+  batch_generator_ = std::move(generator);
+  generator_batch_size_ = batch_size;
+  // Readers blocked on the empty queue may now receive generated values.
+  NotifyWrite();
+  return absl::OkStatus();
+}
+
+void ChannelQueue::CallGenerator() {
+  if (generator_.has_value()) {
+    if (IsFullInternal()) {
+      return;
+    }
+    // Write/ReadInternal are virtual and may have other side-effects so rather
+    // than directly returning the generated value, write then read it.
+    std::optional<Value> generated_value = (*generator_)();
+    if (generated_value.has_value()) {
+      WriteInternal(std::move(generated_value.value()));
+    }
+    return;
+  }
+  if (!batch_generator_.has_value()) {
+    return;
+  }
+  if (next_generated_value_ == generated_values_.size()) {
+    if (GetSizeInternal() > 0) {
+      return;
+    }
+    generated_values_.clear();
+    next_generated_value_ = 0;
+    int64_t max_count = generator_batch_size_;
+    if (capacity_.has_value()) {
+      max_count = std::min(max_count, *capacity_);
+    }
+    (*batch_generator_)(max_count, &generated_values_);
+  }
+  while (next_generated_value_ < generated_values_.size() &&
+         !IsFullInternal()) {
+    WriteInternal(std::move(generated_values_[next_generated_value_++]));
+  }
+}
+
+absl::Status ChannelQueue::Write(Value&& value) {
   XLS_VLOG(4) << absl::StreamFormat("Writing value to channel %s: { %s }",
                                     channel_->name(), value.ToString());
   absl::MutexLock lock(&mutex_);
-  if (generator_.has_value()) {
+  if (HasGeneratorInternal()) {
     return absl::InternalError(
         "Cannot write to ChannelQueue because it has a generator function.");
   }
@@ -57,37 +169,36 @@ absl::Status ChannelQueue::Write(const Value& value) {
         "Channel %s expects values to have type %s, got: %s", channel_->name(),
         channel_->type()->ToString(), value.ToString()));
   }
+  if (IsFullInternal()) {
+    return absl::ResourceExhaustedError(
+        absl::StrFormat("Channel %s is full (capacity %d)", channel_->name(),
+                        capacity_.value()));
+  }
 
-  WriteInternal(value);
+  WriteInternal(std::move(value));
   XLS_VLOG(4) << absl::StreamFormat("Channel now has %d elements",
                                     queue_.size());
+  NotifyWrite();
   return absl::OkStatus();
 }
 
-void ChannelQueue::WriteInternal(const Value& value) {
+void ChannelQueue::WriteInternal(Value value) {
   if (channel()->kind() == ChannelKind::kSingleValue) {
     if (queue_.empty()) {
-      queue_.push_back(value);
+      queue_.PushBack(std::move(value));
     } else {
-      queue_.front() = value;
+      queue_.Front() = std::move(value);
     }
     return;
   }
 
   XLS_CHECK_EQ(channel()->kind(), ChannelKind::kStreaming);
-  queue_.push_back(value);
+  queue_.PushBack(std::move(value));
 }
 
 std::optional<Value> ChannelQueue::Read() {
   absl::MutexLock lock(&mutex_);
-  if (generator_.has_value()) {
-    // Write/ReadInternal are virtual and may have other side-effects so rather
-    // than directly returning the generated value, write then read it.
-    std::optional<Value> generated_value = (*generator_)();
-    if (generated_value.has_value()) {
-      WriteInternal(generated_value.value());
-    }
-  }
+  RunGenerator();
   std::optional<Value> value = ReadInternal();
   XLS_VLOG(4) << absl::StreamFormat(
       "Reading data from channel %s: %s", channel_->name(),
@@ -103,11 +214,10 @@ std::optional<Value> ChannelQueue::ReadInternal() {
   if (queue_.empty()) {
     return std::nullopt;
   }
-  Value value = queue_.front();
-  if (channel()->kind() != ChannelKind::kSingleValue) {
-    queue_.pop_front();
+  if (channel()->kind() == ChannelKind::kSingleValue) {
+    return queue_.Front();
   }
-  return std::move(value);
+  return queue_.PopFront();
 }
 
 /* static */
@@ -144,6 +254,29 @@ ChannelQueueManager::Create(std::vector<std::unique_ptr<ChannelQueue>>&& queues,
 /* static */
 absl::StatusOr<std::unique_ptr<ChannelQueueManager>>
 ChannelQueueManager::Create(Package* package) {
+  return Create(package, /*channel_capacities=*/{});
+}
+
+/* static */
+absl::StatusOr<std::unique_ptr<ChannelQueueManager>>
+ChannelQueueManager::Create(
+    Package* package,
+    const absl::flat_hash_map<std::string, int64_t>& channel_capacities) {
+  for (const auto& [name, capacity] : channel_capacities) {
+    XLS_ASSIGN_OR_RETURN(Channel * channel, package->GetChannel(name));
+    if (channel->kind() != ChannelKind::kStreaming) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Capacity can only be set for streaming channels, `%s` is not "
+          "streaming",
+          name));
+    }
+    if (capacity <= 0) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Capacity of channel `%s` must be positive, got %d", name,
+          capacity));
+    }
+  }
+
   std::vector<std::unique_ptr<ChannelQueue>> queues;
 
   // Create a queue per channel in the package.
@@ -153,7 +286,12 @@ ChannelQueueManager::Create(Package* package) {
       return absl::UnimplementedError(
           "Only streaming and single-value channels are supported.");
     }
-    queues.push_back(std::make_unique<ChannelQueue>(channel));
+    std::optional<int64_t> capacity;
+    if (auto it = channel_capacities.find(channel->name());
+        it != channel_capacities.end()) {
+      capacity = it->second;
+    }
+    queues.push_back(std::make_unique<ChannelQueue>(channel, capacity));
   }
 
   return absl::WrapUnique(new ChannelQueueManager(package, std::move(queues)));
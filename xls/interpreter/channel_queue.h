@@ -15,14 +15,19 @@
 #ifndef XLS_INTERPRETER_CHANNEL_QUEUE_H_
 #define XLS_INTERPRETER_CHANNEL_QUEUE_H_
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <deque>
 #include <functional>
 #include <memory>
 #include <optional>
+#include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/ir/channel.h"
@@ -31,12 +36,41 @@
 
 namespace xls {
 
+// A FIFO of Values stored contiguously in a circular buffer which doubles in
+// size when full. Used as the backing store of ChannelQueue.
+class ValueRingBuffer {
+ public:
+  int64_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // Ensures space for at least `capacity` elements without reallocation.
+  void Reserve(int64_t capacity);
+
+  void PushBack(Value value);
+  Value& Front() { return elements_[head_]; }
+  const Value& Front() const { return elements_[head_]; }
+
+  // Removes and returns the oldest element. The buffer must not be empty.
+  Value PopFront();
+
+  void Clear();
+
+ private:
+  std::vector<Value> elements_;
+  int64_t head_ = 0;
+  int64_t size_ = 0;
+};
+
 // Abstract base class for queues which represent channels during IR
 // interpretation. During interpretation of a network of procs each channel is
 // backed by exactly one ChannelQueue. ChannelQueues are thread-safe.
 class ChannelQueue {
  public:
-  explicit ChannelQueue(Channel* channel) : channel_(channel) {}
+  // If `capacity` is given the queue holds at most that many elements and
+  // writes to a full queue fail. This models the depth of a FIFO. Capacity
+  // only applies to streaming channels.
+  explicit ChannelQueue(Channel* channel,
+                        std::optional<int64_t> capacity = std::nullopt);
 
   // Channel queues should not be copyable. There should be no reason to as
   // there is a one-to-one correspondence between channels (which are not
@@ -58,8 +92,19 @@ class ChannelQueue {
   // Returns whether the channel queue is empty.
   bool IsEmpty() const { return GetSize() == 0; }
 
-  // Writes the given value on to the channel.
-  absl::Status Write(const Value& value);
+  // Returns the maximum number of elements the queue may hold, if bounded.
+  std::optional<int64_t> capacity() const { return capacity_; }
+
+  // Returns whether the queue is bounded and holds `capacity()` elements.
+  bool IsFull() const {
+    absl::MutexLock lock(&mutex_);
+    return IsFullInternal();
+  }
+
+  // Writes the given value on to the channel. Returns a ResourceExhausted
+  // error if the queue is full.
+  absl::Status Write(const Value& value) { return Write(Value(value)); }
+  absl::Status Write(Value&& value);
 
   // Reads and returns a value from the channel. Returns an std::nullopt if
   // the channel is empty.
@@ -71,21 +116,106 @@ class ChannelQueue {
   using GeneratorFn = std::function<std::optional<Value>()>;
   absl::Status AttachGenerator(GeneratorFn generator);
 
+  // Attaches a function which generates values for the channel in batches.
+  // When a read finds the queue empty the generator is called to append up to
+  // `batch_size` values to `values`; appending nothing means no value is
+  // available. This amortizes the per-read call of `AttachGenerator` when
+  // feeding large stimulus sets. At most one generator of either kind may be
+  // attached, and writing to the queue afterwards returns an error.
+  using BatchGeneratorFn =
+      std::function<void(int64_t max_count, std::vector<Value>* values)>;
+  absl::Status AttachBatchGenerator(BatchGeneratorFn generator,
+                                    int64_t batch_size = 1024);
+
+  // Returns whether a generator is attached to the queue.
+  bool HasGenerator() const {
+    absl::MutexLock lock(&mutex_);
+    return HasGeneratorInternal();
+  }
+
+  // Sets a function which is called after each write to the queue (including
+  // raw writes to JIT queues) and when a generator is attached. Used by proc
+  // runtimes to wake procs blocked on receiving from the channel. The callback
+  // is called with the queue's mutex held so it must not access the queue.
+  using WriteCallback = std::function<void()>;
+  void SetWriteCallback(WriteCallback callback) {
+    absl::MutexLock lock(&mutex_);
+    write_callback_ = std::move(callback);
+    has_write_callback_.store(write_callback_ != nullptr,
+                              std::memory_order_release);
+  }
+
  protected:
+  // Calls the write callback, if any.
+  void NotifyWrite() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    if (write_callback_) {
+      write_callback_();
+    }
+  }
+  // As NotifyWrite but acquires `mutex_`. Used by raw writes of JIT queues
+  // which otherwise do not hold the lock. The lock is only taken if a callback
+  // is set.
+  void NotifyWriteWithLock() ABSL_LOCKS_EXCLUDED(mutex_) {
+    if (has_write_callback_.load(std::memory_order_acquire)) {
+      absl::MutexLock lock(&mutex_);
+      NotifyWrite();
+    }
+  }
+
   mutable absl::Mutex mutex_;
 
   virtual int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_);
-  virtual void WriteInternal(const Value& value)
-      ABSL_SHARED_LOCKS_REQUIRED(mutex_);
+  virtual void WriteInternal(Value value) ABSL_SHARED_LOCKS_REQUIRED(mutex_);
   virtual std::optional<Value> ReadInternal()
       ABSL_SHARED_LOCKS_REQUIRED(mutex_);
+  bool IsFullInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+    return capacity_.has_value() && GetSizeInternal() >= *capacity_;
+  }
+  bool HasGeneratorInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+    return generator_.has_value() || batch_generator_.has_value();
+  }
+
+  // Calls the attached generator, if any, and writes the generated values to
+  // the queue without exceeding its capacity. Called before each read.
+  void RunGenerator() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    if (HasGeneratorInternal()) {
+      CallGenerator();
+    }
+  }
+  // As RunGenerator but acquires `mutex_`. Used by raw reads of JIT queues
+  // which otherwise do not hold the lock. The lock is only taken if a
+  // generator is attached.
+  void RunGeneratorWithLock() ABSL_LOCKS_EXCLUDED(mutex_) {
+    // Generators are attached before the queue is read so checking for one
+    // without the lock is safe (see ABSL_GUARDED_BY_FIXME below).
+    if (generator_.has_value() || batch_generator_.has_value()) {
+      absl::MutexLock lock(&mutex_);
+      CallGenerator();
+    }
+  }
+  void CallGenerator() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   Channel* channel_;
+  std::optional<int64_t> capacity_;
 
-  std::deque<Value> queue_ ABSL_GUARDED_BY(mutex_);
+  ValueRingBuffer queue_ ABSL_GUARDED_BY(mutex_);
   // The ThreadUnsafeJitChannelQueue reads this value without a lock.
   // TODO(meheff): 2022/09/27 Fix this, potentially by obviating the need for
   // the thread-unsafe version of the queue.
   std::optional<GeneratorFn> generator_ ABSL_GUARDED_BY_FIXME(mutex_);
+  std::optional<BatchGeneratorFn> batch_generator_
+      ABSL_GUARDED_BY_FIXME(mutex_);
+  int64_t generator_batch_size_ = 0;
+  // Values returned by the batch generator. Values at and after
+  // `next_generated_value_` did not fit in the queue and are written by later
+  // reads. Kept between batches to reuse its storage.
+  std::vector<Value> generated_values_ ABSL_GUARDED_BY(mutex_);
+  int64_t next_generated_value_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  WriteCallback write_callback_ ABSL_GUARDED_BY(mutex_);
+  // Whether `write_callback_` is set. Read without the lock by
+  // NotifyWriteWithLock.
+  std::atomic<bool> has_write_callback_ = false;
 };
 
 // A functor which returns a sequence of Values when called. Maybe be attached
@@ -108,6 +238,31 @@ class FixedValueGenerator {
   std::deque<Value> values_;
 };
 
+// A batch generator which returns a fixed sequence of Values. The values are
+// moved into the queue rather than copied. May be attached to a ChannelQueue
+// with AttachBatchGenerator.
+class FixedValueBatchGenerator {
+ public:
+  explicit FixedValueBatchGenerator(std::vector<Value> values)
+      : state_(std::make_shared<State>(State{.values = std::move(values)})) {}
+
+  void operator()(int64_t max_count, std::vector<Value>* values) {
+    int64_t end = std::min(state_->next + max_count,
+                           static_cast<int64_t>(state_->values.size()));
+    for (; state_->next < end; ++state_->next) {
+      values->push_back(std::move(state_->values[state_->next]));
+    }
+  }
+
+ private:
+  // Shared so copies of the generator made by std::function are cheap.
+  struct State {
+    std::vector<Value> values;
+    int64_t next = 0;
+  };
+  std::shared_ptr<State> state_;
+};
+
 // An abstraction holding a collection of channel queues for interpreting the
 // procs within a single package. Essentially a map of channel queues with some
 // convenience methods.
@@ -119,6 +274,12 @@ class ChannelQueueManager {
   static absl::StatusOr<std::unique_ptr<ChannelQueueManager>> Create(
       Package* package);
 
+  // Creates a queue manager where the queues of the channels named in
+  // `channel_capacities` are bounded to the given number of elements.
+  static absl::StatusOr<std::unique_ptr<ChannelQueueManager>> Create(
+      Package* package,
+      const absl::flat_hash_map<std::string, int64_t>& channel_capacities);
+
   static absl::StatusOr<std::unique_ptr<ChannelQueueManager>> Create(
       std::vector<std::unique_ptr<ChannelQueue>>&& queues, Package* package);
 
@@ -14,15 +14,20 @@
 
 #include "xls/interpreter/channel_queue.h"
 
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
 #include "xls/interpreter/channel_queue_test_base.h"
+#include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/package.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 namespace {
@@ -37,6 +42,86 @@ INSTANTIATE_TEST_SUITE_P(
       return std::make_unique<ChannelQueue>(channel);
     })));
 
+TEST(ValueRingBufferTest, WrapAroundAndGrow) {
+  ValueRingBuffer buffer;
+  EXPECT_TRUE(buffer.empty());
+  buffer.Reserve(3);
+  int64_t next_in = 0;
+  int64_t next_out = 0;
+  // Interleave pushes and pops so the head wraps around the storage several
+  // times, then push enough to force growth while wrapped.
+  for (int64_t i = 0; i < 10; ++i) {
+    buffer.PushBack(Value(UBits(next_in++, 32)));
+    buffer.PushBack(Value(UBits(next_in++, 32)));
+    EXPECT_EQ(buffer.PopFront(), Value(UBits(next_out++, 32)));
+    EXPECT_EQ(buffer.PopFront(), Value(UBits(next_out++, 32)));
+  }
+  buffer.PushBack(Value(UBits(next_in++, 32)));
+  EXPECT_EQ(buffer.PopFront(), Value(UBits(next_out++, 32)));
+  for (int64_t i = 0; i < 20; ++i) {
+    buffer.PushBack(Value(UBits(next_in++, 32)));
+  }
+  EXPECT_EQ(buffer.size(), 20);
+  EXPECT_EQ(buffer.Front(), Value(UBits(next_out, 32)));
+  while (!buffer.empty()) {
+    EXPECT_EQ(buffer.PopFront(), Value(UBits(next_out++, 32)));
+  }
+  EXPECT_EQ(next_out, next_in);
+}
+
+TEST(BoundedChannelQueueTest, WriteToFullQueue) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("a", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  ChannelQueue queue(channel, /*capacity=*/2);
+  EXPECT_EQ(queue.capacity(), 2);
+  EXPECT_FALSE(queue.IsFull());
+
+  XLS_ASSERT_OK(queue.Write(Value(UBits(1, 32))));
+  Value value(UBits(2, 32));
+  XLS_ASSERT_OK(queue.Write(std::move(value)));
+  EXPECT_TRUE(queue.IsFull());
+  EXPECT_THAT(queue.Write(Value(UBits(3, 32))),
+              StatusIs(absl::StatusCode::kResourceExhausted,
+                       HasSubstr("Channel a is full (capacity 2)")));
+
+  EXPECT_EQ(queue.Read(), Value(UBits(1, 32)));
+  EXPECT_FALSE(queue.IsFull());
+  XLS_ASSERT_OK(queue.Write(Value(UBits(3, 32))));
+  EXPECT_EQ(queue.Read(), Value(UBits(2, 32)));
+  EXPECT_EQ(queue.Read(), Value(UBits(3, 32)));
+  EXPECT_EQ(queue.Read(), std::nullopt);
+}
+
+TEST(BoundedChannelQueueTest, GeneratorsRespectCapacity) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("a", ChannelOps::kReceiveOnly,
+                                     package.GetBitsType(32)));
+  ChannelQueue queue(channel, /*capacity=*/2);
+  std::vector<int64_t> max_counts;
+  int64_t next_value = 0;
+  // Ignores `max_count` and always generates three values.
+  XLS_ASSERT_OK(queue.AttachBatchGenerator(
+      [&](int64_t max_count, std::vector<Value>* values) {
+        max_counts.push_back(max_count);
+        for (int64_t i = 0; i < 3; ++i) {
+          values->push_back(Value(UBits(next_value++, 32)));
+        }
+      },
+      /*batch_size=*/8));
+
+  // Values which do not fit in the queue are written by later reads.
+  for (int64_t i = 0; i < 6; ++i) {
+    EXPECT_EQ(queue.Read(), Value(UBits(i, 32)));
+    EXPECT_LE(queue.GetSize(), 2);
+  }
+  EXPECT_EQ(max_counts, std::vector<int64_t>({2, 2}));
+}
+
 // Separate tests for queue managers.
 class ChannelQueueManagerTest : public IrTestBase {};
 
@@ -141,5 +226,36 @@ TEST_F(ChannelQueueManagerTest, ChannelQueueManagerErrorConditions) {
   }
 }
 
+TEST_F(ChannelQueueManagerTest, ChannelQueueManagerWithCapacities) {
+  Package package(TestName());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel_a,
+      package.CreateStreamingChannel("a", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel_b,
+      package.CreateStreamingChannel("b", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK(package
+                    .CreateSingleValueChannel("c", ChannelOps::kSendReceive,
+                                              package.GetBitsType(32))
+                    .status());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ChannelQueueManager> manager,
+      ChannelQueueManager::Create(&package, {{"a", 4}}));
+  EXPECT_EQ(manager->GetQueue(channel_a).capacity(), 4);
+  EXPECT_EQ(manager->GetQueue(channel_b).capacity(), std::nullopt);
+
+  EXPECT_THAT(ChannelQueueManager::Create(&package, {{"c", 4}}).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("only be set for streaming channels")));
+  EXPECT_THAT(ChannelQueueManager::Create(&package, {{"a", 0}}).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("must be positive")));
+  EXPECT_THAT(ChannelQueueManager::Create(&package, {{"d", 1}}).status(),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
 }  // namespace
 }  // namespace xls
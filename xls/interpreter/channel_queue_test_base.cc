@@ -14,6 +14,11 @@
 
 #include "xls/interpreter/channel_queue_test_base.h"
 
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
@@ -159,6 +164,45 @@ TEST_P(ChannelQueueTestBase, EmptyGenerator) {
   EXPECT_EQ(queue->Read(), std::nullopt);
 }
 
+TEST_P(ChannelQueueTestBase, BatchGenerator) {
+  Package package(TestName());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kReceiveOnly,
+                                     package.GetBitsType(32)));
+  auto queue = GetParam().CreateQueue(channel);
+  std::vector<Value> values;
+  for (int64_t i = 0; i < 10; ++i) {
+    values.push_back(Value(UBits(i, 32)));
+  }
+  int64_t call_count = 0;
+  FixedValueBatchGenerator generator(std::move(values));
+  XLS_ASSERT_OK(queue->AttachBatchGenerator(
+      [&](int64_t max_count, std::vector<Value>* batch) {
+        ++call_count;
+        generator(max_count, batch);
+      },
+      /*batch_size=*/4));
+  EXPECT_TRUE(queue->HasGenerator());
+
+  // The generator is only called when the queue is empty and fills it with up
+  // to four values at a time.
+  for (int64_t i = 0; i < 10; ++i) {
+    EXPECT_THAT(queue->Read(), Optional(Value(UBits(i, 32))));
+  }
+  EXPECT_EQ(call_count, 3);
+  EXPECT_EQ(queue->Read(), std::nullopt);
+
+  EXPECT_THAT(queue->AttachGenerator(
+                  []() -> std::optional<Value> { return std::nullopt; }),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("already has a generator attached")));
+  EXPECT_THAT(queue->Write(Value(UBits(22, 32))),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Cannot write to ChannelQueue because it has "
+                                 "a generator function")));
+}
+
 TEST_P(ChannelQueueTestBase, ChannelWithEmptyTuple) {
   Package package(TestName());
   XLS_ASSERT_OK_AND_ASSIGN(
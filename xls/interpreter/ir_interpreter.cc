@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
 #include <variant>
@@ -32,6 +33,7 @@
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/dfs_visitor.h"
+#include "xls/ir/foreign_function_model.h"
 #include "xls/ir/function.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/nodes.h"
@@ -554,6 +556,14 @@ absl::Status IrInterpreter::HandleInvoke(Invoke* invoke) {
   for (int64_t i = 0; i < to_apply->params().size(); ++i) {
     args.push_back(ResolveAsValue(invoke->operand(i)));
   }
+  if (to_apply->ForeignFunctionData().has_value()) {
+    std::shared_ptr<const ForeignFunctionModel> model =
+        GetForeignFunctionModelRegistry().Find(to_apply->name());
+    if (model != nullptr && model->evaluate) {
+      XLS_ASSIGN_OR_RETURN(Value result, model->evaluate(args));
+      return SetValueResult(invoke, std::move(result));
+    }
+  }
   XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> result,
                        InterpretFunction(to_apply, args));
   XLS_RETURN_IF_ERROR(AddInterpreterEvents(result.events));
@@ -817,12 +827,31 @@ absl::Status IrInterpreter::VerifyAllBitsTypes(Node* node) {
   return absl::OkStatus();
 }
 
+NodeValueSlots::NodeValueSlots(FunctionBase* function_base)
+    : values_(function_base->node_count()) {
+  int64_t max_id = -1;
+  for (Node* node : function_base->nodes()) {
+    max_id = std::max(max_id, node->id());
+  }
+  slot_by_id_.resize(max_id + 1, -1);
+  int64_t slot = 0;
+  for (Node* node : function_base->nodes()) {
+    slot_by_id_[node->id()] = slot++;
+  }
+}
+
+void NodeValueSlots::Clear() {
+  for (Value& value : values_) {
+    value = Value();
+  }
+}
+
 const Bits& IrInterpreter::ResolveAsBits(Node* node) {
-  return NodeValuesMap().at(node).bits();
+  return ResolveAsValue(node).bits();
 }
 
 bool IrInterpreter::ResolveAsBool(Node* node) {
-  const Bits& bits = NodeValuesMap().at(node).bits();
+  const Bits& bits = ResolveAsValue(node).bits();
   XLS_CHECK_EQ(bits.bit_count(), 1);
   return bits.IsAllOnes();
 }
@@ -856,7 +885,7 @@ absl::Status IrInterpreter::SetBitsResult(Node* node, const Bits& result) {
 absl::Status IrInterpreter::SetValueResult(Node* node, Value result) {
   if (XLS_VLOG_IS_ON(4) &&
       std::all_of(node->operands().begin(), node->operands().end(),
-                  [this](Node* o) { return NodeValuesMap().contains(o); })) {
+                  [this](Node* o) { return HasResult(o); })) {
     XLS_VLOG(4) << absl::StreamFormat("%s operands:", node->GetName());
     for (int64_t i = 0; i < node->operand_count(); ++i) {
       XLS_VLOG(4) << absl::StreamFormat(
@@ -867,13 +896,17 @@ absl::Status IrInterpreter::SetValueResult(Node* node, Value result) {
   XLS_VLOG(3) << absl::StreamFormat("Result of %s: %s", node->ToString(),
                                     result.ToString());
 
-  XLS_RET_CHECK(!NodeValuesMap().contains(node));
+  XLS_RET_CHECK(!HasResult(node));
   if (!ValueConformsToType(result, node->GetType())) {
     return absl::InternalError(absl::StrFormat(
         "Expected value %s to match type %s of node %s", result.ToString(),
         node->GetType()->ToString(), node->GetName()));
   }
-  NodeValuesMap()[node] = std::move(result);
+  if (node_value_slots_ != nullptr) {
+    node_value_slots_->Set(node, std::move(result));
+  } else {
+    NodeValuesMap()[node] = std::move(result);
+  }
   return absl::OkStatus();
 }
 
@@ -15,18 +15,54 @@
 #ifndef XLS_INTERPRETER_IR_INTERPRETER_H_
 #define XLS_INTERPRETER_IR_INTERPRETER_H_
 
+#include <cstdint>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/events.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 
+// Dense storage for the values of the nodes of a FunctionBase, an alternative
+// to a map from Node* to Value for callers which evaluate the same nodes
+// repeatedly (e.g., the ticks of a proc). The storage is allocated once and
+// reused across evaluations, and a lookup is an array access indexed by node
+// id. A slot holding an invalid (default-constructed) Value has no result.
+class NodeValueSlots {
+ public:
+  explicit NodeValueSlots(FunctionBase* function_base);
+
+  bool HasValue(Node* node) const {
+    return values_[Slot(node)].kind() != ValueKind::kInvalid;
+  }
+  const Value& Get(Node* node) const { return values_[Slot(node)]; }
+  Value& Get(Node* node) { return values_[Slot(node)]; }
+  void Set(Node* node, Value value) { values_[Slot(node)] = std::move(value); }
+
+  // Removes all values, retaining the storage.
+  void Clear();
+
+ private:
+  int64_t Slot(Node* node) const {
+    XLS_DCHECK_LT(node->id(), slot_by_id_.size());
+    XLS_DCHECK_GE(slot_by_id_[node->id()], 0) << node->GetName();
+    return slot_by_id_[node->id()];
+  }
+
+  // Slot of each node indexed by node id, or -1 for nodes without a slot.
+  std::vector<int64_t> slot_by_id_;
+  std::vector<Value> values_;
+};
+
 // Evaluates the given node using the given operand values and returns the
 // result.
 absl::StatusOr<Value> InterpretNode(Node* node,
@@ -44,6 +80,12 @@ class IrInterpreter : public DfsVisitor {
                 InterpreterEvents* events)
       : node_values_ptr_(node_values), events_ptr_(events) {}
 
+  // Constructor which stores node values in the given slots rather than a map.
+  IrInterpreter(NodeValueSlots* node_value_slots, InterpreterEvents* events)
+      : node_values_ptr_(nullptr),
+        node_value_slots_(node_value_slots),
+        events_ptr_(events) {}
+
   // Sets the evaluated value for 'node' to the given Value. 'value' must be
   // passed in by value (ha!) because a use case is passing in a previously
   // evaluated value and inserting a into flat_hash_map (done below) invalidates
@@ -52,6 +94,9 @@ class IrInterpreter : public DfsVisitor {
 
   // Returns the previously evaluated value of 'node' as a Value.
   const Value& ResolveAsValue(Node* node) const {
+    if (node_value_slots_ != nullptr) {
+      return node_value_slots_->Get(node);
+    }
     return NodeValuesMap().at(node);
   }
 
@@ -65,7 +110,12 @@ class IrInterpreter : public DfsVisitor {
   absl::Status AddInterpreterEvents(const InterpreterEvents& events);
 
   // Returns true if a value has been set for the result of the given node.
-  bool HasResult(Node* node) const { return NodeValuesMap().contains(node); }
+  bool HasResult(Node* node) const {
+    if (node_value_slots_ != nullptr) {
+      return node_value_slots_->HasValue(node);
+    }
+    return NodeValuesMap().contains(node);
+  }
 
   absl::Status HandleAdd(BinOp* add) override;
   absl::Status HandleAfterAll(AfterAll* after_all) override;
@@ -196,6 +246,9 @@ class IrInterpreter : public DfsVisitor {
   absl::flat_hash_map<Node*, Value>* node_values_ptr_;
   absl::flat_hash_map<Node*, Value> node_values_;
 
+  // If non-null, node values are held in these slots instead of a map.
+  NodeValueSlots* node_value_slots_ = nullptr;
+
   // Events observed while interpreting (currently only trace messages). To
   // support continuations, an existing events object can either be passed in at
   // construction time (`events_ptr_` is not null), or a fresh events object is
@@ -0,0 +1,402 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/linear_function_interpreter.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/ir_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value_helpers.h"
+
+namespace xls {
+namespace {
+
+using Operands = absl::Span<const Value* const>;
+using KernelFn = absl::Status (*)(Node*, Operands, Value&);
+
+// Returns the given bits value as a uint64_t value. If the value exceeds
+// upper_limit, then upper_limit is returned.
+uint64_t BitsToBoundedUint64(const Bits& bits, uint64_t upper_limit) {
+  if (Bits::MinBitCountUnsigned(upper_limit) <= bits.bit_count() &&
+      bits_ops::UGreaterThan(bits, UBits(upper_limit, bits.bit_count()))) {
+    return upper_limit;
+  }
+  return bits.ToUint64().value();
+}
+
+Value BoolValue(bool value) { return Value(UBits(value ? 1 : 0, 1)); }
+
+template <Bits (*F)(const Bits&, const Bits&)>
+absl::Status BinaryBitsKernel(Node* node, Operands operands, Value& result) {
+  result = Value(F(operands[0]->bits(), operands[1]->bits()));
+  return absl::OkStatus();
+}
+
+template <Bits (*F)(absl::Span<const Bits>)>
+absl::Status NaryBitsKernel(Node* node, Operands operands, Value& result) {
+  std::vector<Bits> bits;
+  bits.reserve(operands.size());
+  for (const Value* operand : operands) {
+    bits.push_back(operand->bits());
+  }
+  result = Value(F(bits));
+  return absl::OkStatus();
+}
+
+template <Bits (*F)(const Bits&)>
+absl::Status UnaryBitsKernel(Node* node, Operands operands, Value& result) {
+  result = Value(F(operands[0]->bits()));
+  return absl::OkStatus();
+}
+
+template <bool (*F)(const Bits&, const Bits&)>
+absl::Status CompareKernel(Node* node, Operands operands, Value& result) {
+  result = BoolValue(F(operands[0]->bits(), operands[1]->bits()));
+  return absl::OkStatus();
+}
+
+template <Bits (*F)(const Bits&, int64_t)>
+absl::Status ShiftKernel(Node* node, Operands operands, Value& result) {
+  const Bits& input = operands[0]->bits();
+  int64_t shift_amount =
+      BitsToBoundedUint64(operands[1]->bits(), input.bit_count());
+  result = Value(F(input, shift_amount));
+  return absl::OkStatus();
+}
+
+absl::Status EqKernel(Node* node, Operands operands, Value& result) {
+  result = BoolValue(*operands[0] == *operands[1]);
+  return absl::OkStatus();
+}
+
+absl::Status NeKernel(Node* node, Operands operands, Value& result) {
+  result = BoolValue(*operands[0] != *operands[1]);
+  return absl::OkStatus();
+}
+
+absl::Status IdentityKernel(Node* node, Operands operands, Value& result) {
+  result = *operands[0];
+  return absl::OkStatus();
+}
+
+absl::Status TokenKernel(Node* node, Operands operands, Value& result) {
+  result = Value::Token();
+  return absl::OkStatus();
+}
+
+absl::Status ConcatKernel(Node* node, Operands operands, Value& result) {
+  std::vector<Bits> bits;
+  bits.reserve(operands.size());
+  for (const Value* operand : operands) {
+    bits.push_back(operand->bits());
+  }
+  result = Value(bits_ops::Concat(bits));
+  return absl::OkStatus();
+}
+
+absl::Status BitSliceKernel(Node* node, Operands operands, Value& result) {
+  BitSlice* bit_slice = node->As<BitSlice>();
+  result =
+      Value(operands[0]->bits().Slice(bit_slice->start(), bit_slice->width()));
+  return absl::OkStatus();
+}
+
+absl::Status ZeroExtendKernel(Node* node, Operands operands, Value& result) {
+  result = Value(bits_ops::ZeroExtend(operands[0]->bits(),
+                                      node->As<ExtendOp>()->new_bit_count()));
+  return absl::OkStatus();
+}
+
+absl::Status SignExtendKernel(Node* node, Operands operands, Value& result) {
+  result = Value(bits_ops::SignExtend(operands[0]->bits(),
+                                      node->As<ExtendOp>()->new_bit_count()));
+  return absl::OkStatus();
+}
+
+template <Bits (*F)(const Bits&, const Bits&), Bits (*Extend)(const Bits&,
+                                                             int64_t)>
+absl::Status MulKernel(Node* node, Operands operands, Value& result) {
+  const int64_t mul_width = node->BitCountOrDie();
+  Bits product = F(operands[0]->bits(), operands[1]->bits());
+  if (product.bit_count() > mul_width) {
+    product = product.Slice(0, mul_width);
+  } else if (product.bit_count() < mul_width) {
+    product = Extend(product, mul_width);
+  }
+  result = Value(std::move(product));
+  return absl::OkStatus();
+}
+
+// Select operands are the selector followed by the cases and the optional
+// default value.
+absl::Status SelKernel(Node* node, Operands operands, Value& result) {
+  Select* sel = node->As<Select>();
+  const Bits& selector = operands[0]->bits();
+  int64_t case_count = sel->cases().size();
+  uint64_t index = BitsToBoundedUint64(selector, case_count);
+  if (index >= case_count) {
+    XLS_RET_CHECK(sel->default_value().has_value());
+    result = *operands.back();
+    return absl::OkStatus();
+  }
+  result = *operands[1 + index];
+  return absl::OkStatus();
+}
+
+absl::Status TupleKernel(Node* node, Operands operands, Value& result) {
+  std::vector<Value> elements;
+  elements.reserve(operands.size());
+  for (const Value* operand : operands) {
+    elements.push_back(*operand);
+  }
+  result = Value::Tuple(elements);
+  return absl::OkStatus();
+}
+
+absl::Status TupleIndexKernel(Node* node, Operands operands, Value& result) {
+  result = operands[0]->element(node->As<TupleIndex>()->index());
+  return absl::OkStatus();
+}
+
+absl::Status GateKernel(Node* node, Operands operands, Value& result) {
+  if (operands[0]->bits().IsOne()) {
+    result = *operands[1];
+  } else {
+    result = ZeroOfType(node->GetType());
+  }
+  return absl::OkStatus();
+}
+
+bool AllBitsTyped(Node* node) {
+  if (!node->GetType()->IsBits()) {
+    return false;
+  }
+  for (Node* operand : node->operands()) {
+    if (!operand->GetType()->IsBits()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the specialized kernel for `node` or nullptr if the node should be
+// evaluated by the IrInterpreter.
+KernelFn GetKernel(Node* node) {
+  switch (node->op()) {
+    case Op::kEq:
+      return EqKernel;
+    case Op::kNe:
+      return NeKernel;
+    case Op::kIdentity:
+      return IdentityKernel;
+    case Op::kAfterAll:
+    case Op::kMinDelay:
+      return TokenKernel;
+    case Op::kTuple:
+      return TupleKernel;
+    case Op::kTupleIndex:
+      return TupleIndexKernel;
+    case Op::kSel:
+      return SelKernel;
+    case Op::kGate:
+      return GateKernel;
+    default:
+      break;
+  }
+  // The remaining kernels only handle bits-typed values.
+  if (!AllBitsTyped(node)) {
+    return nullptr;
+  }
+  switch (node->op()) {
+    case Op::kAdd:
+      return BinaryBitsKernel<bits_ops::Add>;
+    case Op::kSub:
+      return BinaryBitsKernel<bits_ops::Sub>;
+    case Op::kAnd:
+      return NaryBitsKernel<bits_ops::NaryAnd>;
+    case Op::kOr:
+      return NaryBitsKernel<bits_ops::NaryOr>;
+    case Op::kXor:
+      return NaryBitsKernel<bits_ops::NaryXor>;
+    case Op::kNand:
+      return NaryBitsKernel<bits_ops::NaryNand>;
+    case Op::kNor:
+      return NaryBitsKernel<bits_ops::NaryNor>;
+    case Op::kNot:
+      return UnaryBitsKernel<bits_ops::Not>;
+    case Op::kNeg:
+      return UnaryBitsKernel<bits_ops::Negate>;
+    case Op::kAndReduce:
+      return UnaryBitsKernel<bits_ops::AndReduce>;
+    case Op::kOrReduce:
+      return UnaryBitsKernel<bits_ops::OrReduce>;
+    case Op::kXorReduce:
+      return UnaryBitsKernel<bits_ops::XorReduce>;
+    case Op::kULt:
+      return CompareKernel<bits_ops::ULessThan>;
+    case Op::kULe:
+      return CompareKernel<bits_ops::ULessThanOrEqual>;
+    case Op::kUGt:
+      return CompareKernel<bits_ops::UGreaterThan>;
+    case Op::kUGe:
+      return CompareKernel<bits_ops::UGreaterThanOrEqual>;
+    case Op::kSLt:
+      return CompareKernel<bits_ops::SLessThan>;
+    case Op::kSLe:
+      return CompareKernel<bits_ops::SLessThanOrEqual>;
+    case Op::kSGt:
+      return CompareKernel<bits_ops::SGreaterThan>;
+    case Op::kSGe:
+      return CompareKernel<bits_ops::SGreaterThanOrEqual>;
+    case Op::kShll:
+      return ShiftKernel<bits_ops::ShiftLeftLogical>;
+    case Op::kShrl:
+      return ShiftKernel<bits_ops::ShiftRightLogical>;
+    case Op::kShra:
+      return ShiftKernel<bits_ops::ShiftRightArith>;
+    case Op::kUMul:
+      return MulKernel<bits_ops::UMul, bits_ops::ZeroExtend>;
+    case Op::kSMul:
+      return MulKernel<bits_ops::SMul, bits_ops::SignExtend>;
+    case Op::kConcat:
+      return ConcatKernel;
+    case Op::kBitSlice:
+      return BitSliceKernel;
+    case Op::kZeroExt:
+      return ZeroExtendKernel;
+    case Op::kSignExt:
+      return SignExtendKernel;
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<LinearFunctionInterpreter>>
+LinearFunctionInterpreter::Create(Function* function) {
+  auto interpreter =
+      absl::WrapUnique(new LinearFunctionInterpreter(function));
+
+  // Assign a dense slot index to every node in topological order.
+  absl::flat_hash_map<Node*, int64_t> slot_indices;
+  std::vector<Node*> nodes;
+  for (Node* node : TopoSort(function)) {
+    slot_indices[node] = nodes.size();
+    nodes.push_back(node);
+  }
+  // The slot vector is sized once here; instructions hold pointers into it.
+  interpreter->slots_.resize(nodes.size());
+  std::vector<Value>& slots = interpreter->slots_;
+
+  interpreter->param_slots_.resize(function->params().size());
+  for (Node* node : nodes) {
+    int64_t slot = slot_indices.at(node);
+    if (node->Is<Param>()) {
+      XLS_ASSIGN_OR_RETURN(int64_t index,
+                           function->GetParamIndex(node->As<Param>()));
+      interpreter->param_slots_[index] = slot;
+      continue;
+    }
+    if (node->Is<Literal>()) {
+      slots[slot] = node->As<Literal>()->value();
+      continue;
+    }
+    Instruction instruction{.node = node,
+                            .kernel = GetKernel(node),
+                            .operands = {},
+                            .result = &slots[slot]};
+    instruction.operands.reserve(node->operand_count());
+    for (Node* operand : node->operands()) {
+      instruction.operands.push_back(&slots[slot_indices.at(operand)]);
+    }
+    interpreter->instructions_.push_back(std::move(instruction));
+  }
+  interpreter->return_slot_ = slot_indices.at(function->return_value());
+  XLS_VLOG(3) << absl::StreamFormat(
+      "Lowered function %s to %d instructions over %d slots", function->name(),
+      interpreter->instructions_.size(), slots.size());
+  return interpreter;
+}
+
+absl::Status LinearFunctionInterpreter::RunFallback(
+    const Instruction& instruction, InterpreterEvents& events) {
+  Node* node = instruction.node;
+  fallback_values_.clear();
+  IrInterpreter visitor(&fallback_values_, &events);
+  for (int64_t i = 0; i < node->operand_count(); ++i) {
+    // Operands may be duplicated so check to see if the operand value has
+    // already been set.
+    if (!visitor.HasResult(node->operand(i))) {
+      XLS_RETURN_IF_ERROR(
+          visitor.SetValueResult(node->operand(i), *instruction.operands[i]));
+    }
+  }
+  XLS_RETURN_IF_ERROR(node->VisitSingleNode(&visitor));
+  auto it = fallback_values_.find(node);
+  // Nodes such as cover do not produce a value.
+  if (it != fallback_values_.end()) {
+    *instruction.result = std::move(it->second);
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<InterpreterResult<Value>> LinearFunctionInterpreter::Run(
+    absl::Span<const Value> args) {
+  if (args.size() != function_->params().size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Function %s wants %d arguments, got %d.", function_->name(),
+        function_->params().size(), args.size()));
+  }
+  for (int64_t argno = 0; argno < args.size(); ++argno) {
+    Type* param_type = function_->param(argno)->GetType();
+    if (!ValueConformsToType(args[argno], param_type)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Got argument %s for parameter %d which is not of type %s",
+          args[argno].ToString(), argno, param_type->ToString()));
+    }
+    slots_[param_slots_[argno]] = args[argno];
+  }
+
+  InterpreterEvents events;
+  for (const Instruction& instruction : instructions_) {
+    if (instruction.kernel != nullptr) {
+      XLS_RETURN_IF_ERROR(instruction.kernel(
+          instruction.node, instruction.operands, *instruction.result));
+    } else {
+      XLS_RETURN_IF_ERROR(RunFallback(instruction, events));
+    }
+  }
+  return InterpreterResult<Value>{slots_[return_slot_], std::move(events)};
+}
+
+}  // namespace xls
@@ -0,0 +1,109 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_LINEAR_FUNCTION_INTERPRETER_H_
+#define XLS_INTERPRETER_LINEAR_FUNCTION_INTERPRETER_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/node.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// A precompiled form of the IR interpreter for repeated evaluation of a
+// function. At construction time the function is lowered into a flat,
+// topologically ordered array of instructions where each node is assigned a
+// dense slot index. Evaluation then walks the instruction array writing
+// results into a preallocated vector of Values, avoiding the per-node hash map
+// lookups and visitor dispatch of IrInterpreter.
+//
+// Common bits-typed operations are evaluated by specialized kernels. All other
+// operations fall back to evaluating the single node with an IrInterpreter so
+// results and events are identical to InterpretFunction.
+//
+// Run() reuses internal storage so a single instance must not be run
+// concurrently from multiple threads.
+class LinearFunctionInterpreter {
+ public:
+  LinearFunctionInterpreter(const LinearFunctionInterpreter&) = delete;
+  LinearFunctionInterpreter& operator=(const LinearFunctionInterpreter&) =
+      delete;
+
+  static absl::StatusOr<std::unique_ptr<LinearFunctionInterpreter>> Create(
+      Function* function);
+
+  // Evaluates the function with the given positional arguments. Returns both
+  // the result value and any events that happened while running.
+  absl::StatusOr<InterpreterResult<Value>> Run(absl::Span<const Value> args);
+
+  Function* function() const { return function_; }
+
+  // Returns the number of instructions evaluated per Run() call. Params and
+  // literals are not included as their slots are filled before evaluation.
+  int64_t instruction_count() const { return instructions_.size(); }
+
+  // Returns the number of value slots (one per node in the function).
+  int64_t slot_count() const { return slots_.size(); }
+
+ private:
+  // Evaluates `node` given pointers to its operand values, writing the value
+  // of `node` to `result`.
+  using Kernel = absl::Status (*)(Node* node,
+                                  absl::Span<const Value* const> operands,
+                                  Value& result);
+
+  struct Instruction {
+    Node* node;
+    // Null if the node has no specialized kernel and is evaluated with an
+    // IrInterpreter instead.
+    Kernel kernel;
+    // Pointers into `slots_` which is never resized after construction.
+    std::vector<const Value*> operands;
+    Value* result;
+  };
+
+  explicit LinearFunctionInterpreter(Function* function)
+      : function_(function) {}
+
+  // Evaluates `instruction.node` with an IrInterpreter.
+  absl::Status RunFallback(const Instruction& instruction,
+                           InterpreterEvents& events);
+
+  Function* function_;
+  std::vector<Instruction> instructions_;
+
+  // Slot indices of the function parameters in parameter order.
+  std::vector<int64_t> param_slots_;
+  int64_t return_slot_ = 0;
+
+  // Value storage indexed by slot. Literal slots are filled once at
+  // construction time and never overwritten.
+  std::vector<Value> slots_;
+
+  // Scratch map used when evaluating nodes without a specialized kernel.
+  absl::flat_hash_map<Node*, Value> fallback_values_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_LINEAR_FUNCTION_INTERPRETER_H_
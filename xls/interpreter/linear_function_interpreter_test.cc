@@ -0,0 +1,130 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/linear_function_interpreter.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/ir_evaluator_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/keyword_args.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using testing::ElementsAre;
+using testing::HasSubstr;
+
+absl::StatusOr<InterpreterResult<Value>> RunLinear(
+    Function* function, absl::Span<const Value> args) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<LinearFunctionInterpreter> interpreter,
+                       LinearFunctionInterpreter::Create(function));
+  return interpreter->Run(args);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    LinearFunctionInterpreterTest, IrEvaluatorTestBase,
+    testing::Values(IrEvaluatorTestParam(
+        [](Function* function, absl::Span<const Value> args) {
+          return RunLinear(function, args);
+        },
+        [](Function* function,
+           const absl::flat_hash_map<std::string, Value>& kwargs)
+            -> absl::StatusOr<InterpreterResult<Value>> {
+          XLS_ASSIGN_OR_RETURN(std::vector<Value> args,
+                               KeywordArgsToPositional(*function, kwargs));
+          return RunLinear(function, args);
+        })));
+
+class LinearFunctionInterpreterOnlyTest : public IrTestBase {};
+
+TEST_F(LinearFunctionInterpreterOnlyTest, RepeatedRunsMatchInterpreter) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue sum = fb.Add(x, y);
+  BValue lt = fb.ULt(x, y);
+  BValue shifted = fb.Shll(sum, fb.Literal(UBits(3, 8)));
+  fb.Tuple({fb.Select(lt, shifted, sum), fb.UMul(x, y, /*result_width=*/64),
+            fb.Reverse(x)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<LinearFunctionInterpreter> linear,
+                           LinearFunctionInterpreter::Create(f));
+  EXPECT_EQ(linear->slot_count(), f->node_count());
+  // Params and the literal are not instructions.
+  EXPECT_EQ(linear->instruction_count(), f->node_count() - 3);
+
+  for (int64_t i = 0; i < 100; ++i) {
+    std::vector<Value> args = {Value(UBits(i * 7919, 32)),
+                               Value(UBits(1000 - i * 13, 32))};
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected,
+                             InterpretFunction(f, args));
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> actual,
+                             linear->Run(args));
+    EXPECT_EQ(actual.value, expected.value);
+  }
+}
+
+TEST_F(LinearFunctionInterpreterOnlyTest, EventsAreNotCarriedAcrossRuns) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(1));
+  fb.Trace(fb.AfterAll({}), x, {x}, "x is {}");
+  fb.Assert(fb.AfterAll({}), x, "x is false");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(x));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<LinearFunctionInterpreter> linear,
+                           LinearFunctionInterpreter::Create(f));
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result,
+                           linear->Run({Value(UBits(1, 1))}));
+  EXPECT_THAT(result.events.trace_msgs, ElementsAre("x is 1"));
+  EXPECT_TRUE(result.events.assert_msgs.empty());
+
+  XLS_ASSERT_OK_AND_ASSIGN(result, linear->Run({Value(UBits(0, 1))}));
+  EXPECT_TRUE(result.events.trace_msgs.empty());
+  EXPECT_THAT(result.events.assert_msgs, ElementsAre("x is false"));
+}
+
+TEST_F(LinearFunctionInterpreterOnlyTest, WrongArguments) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Not(fb.Param("x", p->GetBitsType(8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<LinearFunctionInterpreter> linear,
+                           LinearFunctionInterpreter::Create(f));
+  EXPECT_THAT(linear->Run({}), StatusIs(absl::StatusCode::kInvalidArgument,
+                                        HasSubstr("wants 1 arguments")));
+  EXPECT_THAT(linear->Run({Value(UBits(0, 4))}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("not of type bits[8]")));
+}
+
+}  // namespace
+}  // namespace xls
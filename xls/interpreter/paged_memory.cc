@@ -0,0 +1,159 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/paged_memory.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+
+namespace xls {
+
+/* static */ absl::StatusOr<PagedMemory> PagedMemory::Create(
+    std::string name, int64_t element_count, int64_t element_size,
+    absl::Span<const uint8_t> fill_element, const Options& options) {
+  if (element_count < 0 || element_size <= 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Memory %s must have a non-negative element count and a positive "
+        "element size, got %d elements of %d bytes",
+        name, element_count, element_size));
+  }
+  if (fill_element.size() != element_size) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Fill element of memory %s is %d bytes, expected %d", name,
+        fill_element.size(), element_size));
+  }
+  return PagedMemory(std::move(name), element_count, element_size,
+                     fill_element, options);
+}
+
+/* static */ absl::StatusOr<PagedMemory> PagedMemory::CreateForBits(
+    std::string name, int64_t element_count, const Bits& fill_element,
+    const Options& options) {
+  std::vector<uint8_t> fill_bytes(
+      std::max(int64_t{1}, CeilOfRatio(fill_element.bit_count(), int64_t{8})));
+  fill_element.ToBytes(absl::MakeSpan(fill_bytes));
+  XLS_ASSIGN_OR_RETURN(PagedMemory memory,
+                       Create(std::move(name), element_count,
+                              fill_bytes.size(), fill_bytes, options));
+  memory.element_bit_count_ = fill_element.bit_count();
+  return memory;
+}
+
+PagedMemory::PagedMemory(std::string name, int64_t element_count,
+                         int64_t element_size,
+                         absl::Span<const uint8_t> fill_element,
+                         const Options& options)
+    : name_(std::move(name)),
+      element_count_(element_count),
+      element_size_(element_size),
+      element_bit_count_(element_size * 8),
+      fill_element_(fill_element.begin(), fill_element.end()),
+      default_fill_(options.default_fill),
+      page_element_count_(
+          std::max(int64_t{1}, options.page_byte_size / element_size)) {}
+
+absl::Status PagedMemory::CheckAccess(int64_t address, int64_t size,
+                                      std::string_view kind) const {
+  if (address < 0 || address >= element_count_) {
+    return absl::OutOfRangeError(absl::StrFormat(
+        "Memory %s %s out of range at %d", name_, kind, address));
+  }
+  if (size != element_size_) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Memory %s %s at %d of %d bytes, expected %d", name_,
+                        kind, address, size, element_size_));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status PagedMemory::Read(int64_t address,
+                               absl::Span<uint8_t> element) const {
+  XLS_RETURN_IF_ERROR(CheckAccess(address, element.size(), "read"));
+  int64_t offset = address % page_element_count_;
+  auto it = pages_.find(address / page_element_count_);
+  if (it != pages_.end() &&
+      (it->second.written.empty() || it->second.written[offset])) {
+    std::memcpy(element.data(), it->second.data.get() + offset * element_size_,
+                element_size_);
+    return absl::OkStatus();
+  }
+  if (default_fill_ == DefaultFill::kError) {
+    return absl::FailedPreconditionError(absl::StrFormat(
+        "Memory %s read of unwritten address %d", name_, address));
+  }
+  std::memcpy(element.data(), fill_element_.data(), element_size_);
+  return absl::OkStatus();
+}
+
+absl::Status PagedMemory::Write(int64_t address,
+                                absl::Span<const uint8_t> element) {
+  XLS_RETURN_IF_ERROR(CheckAccess(address, element.size(), "write"));
+  int64_t offset = address % page_element_count_;
+  Page& page = pages_[address / page_element_count_];
+  if (page.data == nullptr) {
+    page.data = std::make_unique<uint8_t[]>(page_element_count_ *
+                                            element_size_);
+    if (default_fill_ == DefaultFill::kError) {
+      page.written.resize(page_element_count_, false);
+    } else {
+      for (int64_t i = 0; i < page_element_count_; ++i) {
+        std::memcpy(page.data.get() + i * element_size_, fill_element_.data(),
+                    element_size_);
+      }
+    }
+  }
+  std::memcpy(page.data.get() + offset * element_size_, element.data(),
+              element_size_);
+  if (!page.written.empty()) {
+    page.written[offset] = true;
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<Bits> PagedMemory::ReadBits(int64_t address) const {
+  std::vector<uint8_t> bytes(element_size_);
+  XLS_RETURN_IF_ERROR(Read(address, absl::MakeSpan(bytes)));
+  // Zero-width elements still occupy a byte.
+  return Bits::FromBytes(
+      absl::MakeConstSpan(bytes).first(
+          CeilOfRatio(element_bit_count_, int64_t{8})),
+      element_bit_count_);
+}
+
+absl::Status PagedMemory::WriteBits(int64_t address, const Bits& bits) {
+  if (bits.bit_count() != element_bit_count_) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Memory %s write at %d of %d bits, expected %d", name_, address,
+        bits.bit_count(), element_bit_count_));
+  }
+  std::vector<uint8_t> bytes(element_size_);
+  bits.ToBytes(absl::MakeSpan(bytes));
+  return Write(address, bytes);
+}
+
+}  // namespace xls
@@ -0,0 +1,114 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_PAGED_MEMORY_H_
+#define XLS_INTERPRETER_PAGED_MEMORY_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/bits.h"
+
+namespace xls {
+
+// What reading an address which has never been written returns.
+enum class DefaultFill {
+  // The fill element given on construction.
+  kFillElement,
+  // An error, to catch reads of uninitialized memory.
+  kError,
+};
+
+// A sparse model of a memory of `element_count` elements of `element_size`
+// bytes each, e.g. a RAM of a simulated design. Elements are stored in the
+// native layout of the JIT (little-endian, see jit/type_layout.h) in pages
+// which are allocated on the first write to them, so memories with huge
+// address spaces which are accessed sparsely cost only the pages touched.
+//
+// Not thread-safe.
+class PagedMemory {
+ public:
+  struct Options {
+    DefaultFill default_fill = DefaultFill::kFillElement;
+    // Size of a page. Rounded down to a whole number of elements (at least
+    // one).
+    int64_t page_byte_size = 64 * 1024;
+  };
+
+  // `fill_element` must be `element_size` bytes.
+  static absl::StatusOr<PagedMemory> Create(
+      std::string name, int64_t element_count, int64_t element_size,
+      absl::Span<const uint8_t> fill_element, const Options& options);
+
+  // Creates a memory of elements of `fill_element.bit_count()` bits in the
+  // native layout of bits types, for use with ReadBits and WriteBits.
+  static absl::StatusOr<PagedMemory> CreateForBits(std::string name,
+                                                   int64_t element_count,
+                                                   const Bits& fill_element,
+                                                   const Options& options);
+
+  PagedMemory(PagedMemory&&) = default;
+  PagedMemory& operator=(PagedMemory&&) = default;
+
+  // Copies the element at `address` into `element`, which must be
+  // element_size() bytes.
+  absl::Status Read(int64_t address, absl::Span<uint8_t> element) const;
+  absl::Status Write(int64_t address, absl::Span<const uint8_t> element);
+
+  // Reads and writes elements of bits type. `bits` must have
+  // element_bit_count() bits.
+  absl::StatusOr<Bits> ReadBits(int64_t address) const;
+  absl::Status WriteBits(int64_t address, const Bits& bits);
+
+  const std::string& name() const { return name_; }
+  int64_t element_count() const { return element_count_; }
+  int64_t element_size() const { return element_size_; }
+  // The bit count of the elements of memories created by CreateForBits.
+  int64_t element_bit_count() const { return element_bit_count_; }
+  int64_t allocated_page_count() const { return pages_.size(); }
+
+ private:
+  struct Page {
+    std::unique_ptr<uint8_t[]> data;
+    // Which elements of the page have been written. Only tracked for
+    // DefaultFill::kError.
+    std::vector<bool> written;
+  };
+
+  PagedMemory(std::string name, int64_t element_count, int64_t element_size,
+              absl::Span<const uint8_t> fill_element, const Options& options);
+
+  absl::Status CheckAccess(int64_t address, int64_t size,
+                           std::string_view kind) const;
+
+  std::string name_;
+  int64_t element_count_;
+  int64_t element_size_;
+  int64_t element_bit_count_;
+  std::vector<uint8_t> fill_element_;
+  DefaultFill default_fill_;
+  int64_t page_element_count_;
+  absl::flat_hash_map<int64_t, Page> pages_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_PAGED_MEMORY_H_
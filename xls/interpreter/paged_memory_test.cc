@@ -0,0 +1,102 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/paged_memory.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+TEST(PagedMemoryTest, HugeSparseMemory) {
+  // 2^40 elements of 37 bits; only the pages written are allocated.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PagedMemory memory,
+      PagedMemory::CreateForBits("mem", int64_t{1} << 40, UBits(42, 37),
+                                 PagedMemory::Options()));
+  EXPECT_EQ(memory.element_size(), 5);
+  EXPECT_EQ(memory.allocated_page_count(), 0);
+  EXPECT_THAT(memory.ReadBits(12345), IsOkAndHolds(UBits(42, 37)));
+
+  XLS_ASSERT_OK(memory.WriteBits(3, UBits(7, 37)));
+  XLS_ASSERT_OK(memory.WriteBits((int64_t{1} << 40) - 1, UBits(8, 37)));
+  EXPECT_EQ(memory.allocated_page_count(), 2);
+  EXPECT_THAT(memory.ReadBits(3), IsOkAndHolds(UBits(7, 37)));
+  EXPECT_THAT(memory.ReadBits(4), IsOkAndHolds(UBits(42, 37)));
+  EXPECT_THAT(memory.ReadBits((int64_t{1} << 40) - 1),
+              IsOkAndHolds(UBits(8, 37)));
+
+  EXPECT_THAT(memory.ReadBits(int64_t{1} << 40),
+              StatusIs(absl::StatusCode::kOutOfRange));
+  EXPECT_THAT(memory.WriteBits(-1, UBits(0, 37)),
+              StatusIs(absl::StatusCode::kOutOfRange));
+  EXPECT_THAT(memory.WriteBits(0, UBits(0, 32)),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(PagedMemoryTest, NativeLayout) {
+  PagedMemory::Options options;
+  options.page_byte_size = 8;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PagedMemory memory,
+      PagedMemory::Create("mem", 100, 2, std::vector<uint8_t>{0xab, 0xcd},
+                          options));
+  XLS_ASSERT_OK(memory.Write(9, std::vector<uint8_t>{1, 2}));
+  EXPECT_EQ(memory.allocated_page_count(), 1);
+
+  std::vector<uint8_t> element(2);
+  XLS_ASSERT_OK(memory.Read(9, absl::MakeSpan(element)));
+  EXPECT_THAT(element, ElementsAre(1, 2));
+  // Other elements of the same page hold the fill element.
+  XLS_ASSERT_OK(memory.Read(8, absl::MakeSpan(element)));
+  EXPECT_THAT(element, ElementsAre(0xab, 0xcd));
+  XLS_ASSERT_OK(memory.Read(50, absl::MakeSpan(element)));
+  EXPECT_THAT(element, ElementsAre(0xab, 0xcd));
+
+  std::vector<uint8_t> short_element(1);
+  EXPECT_THAT(memory.Read(9, absl::MakeSpan(short_element)),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(PagedMemoryTest, ErrorOnUnwrittenRead) {
+  PagedMemory::Options options;
+  options.default_fill = DefaultFill::kError;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PagedMemory memory,
+      PagedMemory::CreateForBits("mem", 1024, UBits(0, 8), options));
+  EXPECT_THAT(memory.ReadBits(5),
+              StatusIs(absl::StatusCode::kFailedPrecondition,
+                       HasSubstr("unwritten address 5")));
+  XLS_ASSERT_OK(memory.WriteBits(5, UBits(3, 8)));
+  EXPECT_THAT(memory.ReadBits(5), IsOkAndHolds(UBits(3, 8)));
+  // Neighbors in the now allocated page are still unwritten.
+  EXPECT_THAT(memory.ReadBits(6),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,237 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/parallel_proc_runtime.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls {
+
+/* static */
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+ParallelProcRuntime::Create(
+    Package* package, std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+    std::unique_ptr<ChannelQueueManager>&& queue_manager,
+    std::optional<int64_t> thread_count) {
+  // Verify there exists exactly one evaluator per proc in the package.
+  absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>> evaluator_map;
+  for (std::unique_ptr<ProcEvaluator>& evaluator : evaluators) {
+    Proc* proc = evaluator->proc();
+    auto [it, inserted] = evaluator_map.insert({proc, std::move(evaluator)});
+    XLS_RET_CHECK(inserted) << absl::StreamFormat(
+        "More than one evaluator given for proc `%s`", proc->name());
+  }
+  for (const std::unique_ptr<Proc>& proc : package->procs()) {
+    XLS_RET_CHECK(evaluator_map.contains(proc.get()))
+        << absl::StreamFormat("No evaluator given for proc `%s`", proc->name());
+  }
+  XLS_RET_CHECK_EQ(evaluator_map.size(), package->procs().size())
+      << "More evaluators than procs given.";
+
+  int64_t num_threads;
+  if (thread_count.has_value()) {
+    XLS_RET_CHECK_GT(thread_count.value(), 0);
+    num_threads = thread_count.value();
+  } else {
+    num_threads = std::clamp(
+        static_cast<int64_t>(std::thread::hardware_concurrency()), int64_t{1},
+        std::max(static_cast<int64_t>(package->procs().size()), int64_t{1}));
+  }
+  return absl::WrapUnique(new ParallelProcRuntime(
+      package, std::move(evaluator_map), std::move(queue_manager),
+      num_threads));
+}
+
+ParallelProcRuntime::ParallelProcRuntime(
+    Package* package,
+    absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>>&& evaluators,
+    std::unique_ptr<ChannelQueueManager>&& queue_manager, int64_t thread_count)
+    : ProcRuntime(package, std::move(evaluators), std::move(queue_manager)) {
+  for (int64_t i = 0; i < thread_count; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  for (int64_t i = 0; i < thread_count; ++i) {
+    workers_[i]->thread =
+        std::make_unique<Thread>([this, i]() { WorkerLoop(i); });
+  }
+}
+
+ParallelProcRuntime::~ParallelProcRuntime() {
+  {
+    absl::MutexLock lock(&mutex_);
+    shutdown_ = true;
+  }
+  for (std::unique_ptr<Worker>& worker : workers_) {
+    worker->thread->Join();
+  }
+}
+
+void ParallelProcRuntime::PushReadyProc(int64_t worker_index, Proc* proc) {
+  Worker& worker = *workers_[worker_index];
+  {
+    absl::MutexLock lock(&worker.mutex);
+    worker.ready_procs.push_back(proc);
+  }
+  ++ready_proc_count_;
+  ++active_proc_count_;
+}
+
+Proc* ParallelProcRuntime::PopOrStealReadyProc(int64_t worker_index) {
+  // A proc has been reserved so one is guaranteed to be found, though another
+  // worker may take the proc from a deque before it is reached in which case
+  // the scan is repeated.
+  while (true) {
+    {
+      Worker& worker = *workers_[worker_index];
+      absl::MutexLock lock(&worker.mutex);
+      if (!worker.ready_procs.empty()) {
+        Proc* proc = worker.ready_procs.back();
+        worker.ready_procs.pop_back();
+        return proc;
+      }
+    }
+    for (int64_t i = 1; i < workers_.size(); ++i) {
+      Worker& victim = *workers_[(worker_index + i) % workers_.size()];
+      absl::MutexLock lock(&victim.mutex);
+      if (!victim.ready_procs.empty()) {
+        Proc* proc = victim.ready_procs.front();
+        victim.ready_procs.pop_front();
+        return proc;
+      }
+    }
+  }
+}
+
+absl::Status ParallelProcRuntime::RunProc(int64_t worker_index, Proc* proc) {
+  EvaluatorContext& context = evaluator_contexts_.at(proc);
+  while (true) {
+    XLS_VLOG(3) << absl::StreamFormat("Ticking proc `%s` on worker %d",
+                                      proc->name(), worker_index);
+    XLS_ASSIGN_OR_RETURN(TickResult tick_result,
+                         context.evaluator->Tick(*context.continuation));
+    XLS_VLOG(3) << "Tick result: " << tick_result;
+
+    absl::MutexLock lock(&mutex_);
+    if (profile_ != nullptr) {
+      profile_->RecordTick(proc, tick_result);
+    }
+    progress_made_ |= tick_result.progress_made;
+    progress_made_on_io_procs_ |=
+        (tick_result.progress_made && context.evaluator->ProcHasIoOperations());
+    if (tick_result.execution_state == TickExecutionState::kSentOnChannel) {
+      Channel* channel = tick_result.channel.value();
+      auto it = blocked_procs_.find(channel);
+      if (it != blocked_procs_.end()) {
+        XLS_VLOG(3) << absl::StreamFormat(
+            "Unblocking proc `%s` and adding to ready list",
+            it->second->name());
+        PushReadyProc(worker_index, it->second);
+        blocked_procs_.erase(it);
+      }
+      // This proc is not blocked so keep running it on this worker.
+      continue;
+    }
+    if (tick_result.execution_state == TickExecutionState::kBlockedOnReceive) {
+      Channel* channel = tick_result.channel.value();
+      // The sender may have written to the channel after this proc found it
+      // empty but before the proc was recorded as blocked. Senders wake blocked
+      // procs while holding `mutex_` so checking the queue here cannot miss a
+      // send.
+      if (!queue_manager_->GetQueue(channel).IsEmpty()) {
+        PushReadyProc(worker_index, proc);
+        return absl::OkStatus();
+      }
+      XLS_VLOG(3) << absl::StreamFormat(
+          "Proc `%s` is now blocked on channel `%s`", proc->name(),
+          channel->ToString());
+      blocked_procs_[channel] = proc;
+    }
+    return absl::OkStatus();
+  }
+}
+
+void ParallelProcRuntime::WorkerLoop(int64_t worker_index) {
+  while (true) {
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(absl::Condition(
+          +[](ParallelProcRuntime* runtime)
+               ABSL_EXCLUSIVE_LOCKS_REQUIRED(runtime->mutex_) {
+                 return runtime->shutdown_ || runtime->ready_proc_count_ > 0;
+               },
+          this));
+      if (shutdown_) {
+        return;
+      }
+      --ready_proc_count_;
+    }
+    Proc* proc = PopOrStealReadyProc(worker_index);
+    absl::Status status = RunProc(worker_index, proc);
+    absl::MutexLock lock(&mutex_);
+    if (!status.ok() && tick_status_.ok()) {
+      tick_status_ = status;
+    }
+    --active_proc_count_;
+  }
+}
+
+absl::StatusOr<ParallelProcRuntime::NetworkTickResult>
+ParallelProcRuntime::TickInternal() {
+  XLS_VLOG(3) << absl::StreamFormat("TickInternal on package %s",
+                                    package_->name());
+  absl::MutexLock lock(&mutex_);
+  blocked_procs_.clear();
+  progress_made_ = false;
+  progress_made_on_io_procs_ = false;
+  tick_status_ = absl::OkStatus();
+
+  // Distribute all procs across the workers.
+  int64_t worker_index = 0;
+  for (const std::unique_ptr<Proc>& proc : package_->procs()) {
+    XLS_VLOG(3) << absl::StreamFormat("Proc `%s` added to ready list",
+                                      proc->name());
+    PushReadyProc(worker_index, proc.get());
+    worker_index = (worker_index + 1) % workers_.size();
+  }
+
+  mutex_.Await(absl::Condition(
+      +[](int64_t* active_proc_count) { return *active_proc_count == 0; },
+      &active_proc_count_));
+  XLS_RETURN_IF_ERROR(tick_status_);
+
+  std::vector<Channel*> blocked_channels;
+  for (auto [channel, proc] : blocked_procs_) {
+    blocked_channels.push_back(channel);
+  }
+  std::sort(blocked_channels.begin(), blocked_channels.end(),
+            [](Channel* a, Channel* b) { return a->id() < b->id(); });
+  return NetworkTickResult{
+      .progress_made = progress_made_,
+      .progress_made_on_io_procs = progress_made_on_io_procs_,
+      .blocked_channels = blocked_channels,
+  };
+}
+
+}  // namespace xls
@@ -0,0 +1,119 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_PARALLEL_PROC_RUNTIME_H_
+#define XLS_INTERPRETER_PARALLEL_PROC_RUNTIME_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// A proc runtime which ticks the procs in the network concurrently on a pool
+// of worker threads. Each worker owns a deque of ready procs and steals from
+// the other workers when its own deque is empty. Procs blocked on a receive are
+// parked until a proc sends on the channel they are waiting on.
+//
+// A network tick has the same semantics as SerialProcRuntime: every proc runs
+// until it completes an iteration or blocks on a receive which no proc unblocks
+// before the tick ends. Deadlock and progress detection are therefore the same
+// as for the serial runtime. The order in which procs interleave within a tick
+// is not deterministic so networks whose results depend on that order (e.g.,
+// those using non-blocking receives on internal channels) may behave
+// differently from run to run.
+//
+// Channel queues must be safe to access from multiple threads.
+class ParallelProcRuntime : public ProcRuntime {
+ public:
+  // Creates and returns a parallel runtime for the given package using
+  // `thread_count` worker threads. If `thread_count` is not given, the number
+  // of hardware threads (capped at the number of procs) is used.
+  static absl::StatusOr<std::unique_ptr<ParallelProcRuntime>> Create(
+      Package* package,
+      std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+      std::unique_ptr<ChannelQueueManager>&& queue_manager,
+      std::optional<int64_t> thread_count = std::nullopt);
+
+  ~ParallelProcRuntime() override;
+
+  int64_t thread_count() const { return workers_.size(); }
+
+ private:
+  ParallelProcRuntime(
+      Package* package,
+      absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>>&& evaluators,
+      std::unique_ptr<ChannelQueueManager>&& queue_manager,
+      int64_t thread_count);
+
+  absl::StatusOr<NetworkTickResult> TickInternal() override;
+
+  struct Worker {
+    absl::Mutex mutex;
+    std::deque<Proc*> ready_procs ABSL_GUARDED_BY(mutex);
+    std::unique_ptr<Thread> thread;
+  };
+
+  // Main loop of each worker thread.
+  void WorkerLoop(int64_t worker_index);
+
+  // Adds the given proc to the ready deque of the given worker. `mutex_` must
+  // be held.
+  void PushReadyProc(int64_t worker_index, Proc* proc)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Removes and returns a ready proc, preferring the most recently added proc
+  // of the given worker and otherwise stealing the oldest proc of another
+  // worker. A ready proc must have been reserved by decrementing
+  // `ready_proc_count_`.
+  Proc* PopOrStealReadyProc(int64_t worker_index);
+
+  // Ticks the given proc until it completes or blocks. Procs unblocked by sends
+  // of this proc are added to the ready deque of the given worker.
+  absl::Status RunProc(int64_t worker_index, Proc* proc);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  absl::Mutex mutex_;
+  // Number of procs in the ready deques which have not yet been reserved by a
+  // worker.
+  int64_t ready_proc_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Number of procs which are ready or running in the current tick. The tick
+  // is finished when this reaches zero.
+  int64_t active_proc_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Procs blocked on a receive and the channels they are blocked on.
+  absl::flat_hash_map<Channel*, Proc*> blocked_procs_ ABSL_GUARDED_BY(mutex_);
+  bool progress_made_ ABSL_GUARDED_BY(mutex_) = false;
+  bool progress_made_on_io_procs_ ABSL_GUARDED_BY(mutex_) = false;
+  // The first error encountered by any worker during the current tick.
+  absl::Status tick_status_ ABSL_GUARDED_BY(mutex_);
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_PARALLEL_PROC_RUNTIME_H_
@@ -0,0 +1,107 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/parallel_proc_runtime.h"
+
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/proc_runtime_test_base.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/package.h"
+#include "xls/jit/jit_proc_runtime.h"
+
+namespace xls {
+namespace {
+
+// Instantiate and run all the tests in proc_runtime_test_base.cc using the
+// parallel runtime with JIT-compiled procs.
+INSTANTIATE_TEST_SUITE_P(
+    ParallelProcRuntimeTest, ProcRuntimeTestBase,
+    testing::Values(
+        ProcRuntimeTestParam(
+            "jit_single_thread",
+            [](Package* package) -> std::unique_ptr<ProcRuntime> {
+              return CreateJitParallelProcRuntime(package,
+                                                  /*thread_count=*/1)
+                  .value();
+            }),
+        ProcRuntimeTestParam(
+            "jit_multi_thread",
+            [](Package* package) -> std::unique_ptr<ProcRuntime> {
+              return CreateJitParallelProcRuntime(package,
+                                                  /*thread_count=*/4)
+                  .value();
+            })),
+    [](const testing::TestParamInfo<ProcRuntimeTestBase::ParamType>& info) {
+      return info.param.name();
+    });
+
+// A long pipeline of procs each adding one to the value passed through it.
+TEST(ParallelProcRuntimeTest, Pipeline) {
+  constexpr int64_t kStages = 16;
+  Package package("pipeline");
+  std::vector<Channel*> channels;
+  for (int64_t i = 0; i <= kStages; ++i) {
+    ChannelOps ops = ChannelOps::kSendReceive;
+    if (i == 0) {
+      ops = ChannelOps::kReceiveOnly;
+    } else if (i == kStages) {
+      ops = ChannelOps::kSendOnly;
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Channel * channel,
+        package.CreateStreamingChannel(absl::StrFormat("ch%d", i), ops,
+                                       package.GetBitsType(32)));
+    channels.push_back(channel);
+  }
+  for (int64_t i = 0; i < kStages; ++i) {
+    ProcBuilder pb(absl::StrFormat("stage%d", i), /*token_name=*/"tok",
+                   &package);
+    BValue recv = pb.Receive(channels[i], pb.GetTokenParam());
+    BValue data = pb.Add(pb.TupleIndex(recv, 1), pb.Literal(UBits(1, 32)));
+    BValue send = pb.Send(channels[i + 1], pb.TupleIndex(recv, 0), data);
+    XLS_ASSERT_OK(pb.Build(send, {}).status());
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ParallelProcRuntime> runtime,
+      CreateJitParallelProcRuntime(&package, /*thread_count=*/4));
+  EXPECT_EQ(runtime->thread_count(), 4);
+
+  ChannelQueue& input_queue = runtime->queue_manager().GetQueue(channels[0]);
+  ChannelQueue& output_queue =
+      runtime->queue_manager().GetQueue(channels[kStages]);
+  constexpr int64_t kCount = 100;
+  for (int64_t i = 0; i < kCount; ++i) {
+    XLS_ASSERT_OK(input_queue.Write(Value(UBits(i, 32))));
+  }
+  XLS_ASSERT_OK(
+      runtime->TickUntilOutput({{channels[kStages], kCount}}).status());
+  for (int64_t i = 0; i < kCount; ++i) {
+    EXPECT_EQ(output_queue.Read(), Value(UBits(i + kStages, 32)));
+  }
+
+  // With no more input every stage is blocked.
+  EXPECT_THAT(runtime->Tick(),
+              status_testing::StatusIs(absl::StatusCode::kInternal,
+                                       testing::HasSubstr("deadlocked")));
+}
+
+}  // namespace
+}  // namespace xls
@@ -14,10 +14,15 @@
 
 #include "xls/interpreter/proc_evaluator.h"
 
+#include <cstdint>
+#include <optional>
 #include <ostream>
 #include <string>
 
+#include "absl/status/statusor.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
 
 namespace xls {
 
@@ -44,6 +49,8 @@ std::string ToString(TickExecutionState state) {
       return "kCompleted";
     case TickExecutionState::kBlockedOnReceive:
       return "kBlockedOnReceive";
+    case TickExecutionState::kBlockedOnSend:
+      return "kBlockedOnSend";
     case TickExecutionState::kSentOnChannel:
       return "kSentOnChannel";
   }
@@ -70,4 +77,28 @@ ProcEvaluator::ProcEvaluator(Proc* proc) : proc_(proc) {
   }
 }
 
+absl::StatusOr<MultiTickResult> ProcEvaluator::RunTicks(
+    ProcContinuation& continuation, int64_t max_ticks) const {
+  XLS_RET_CHECK_GE(max_ticks, 0);
+  MultiTickResult result{
+      .ticks_completed = 0,
+      .tick_result =
+          TickResult{.execution_state = TickExecutionState::kCompleted,
+                     .channel = std::nullopt,
+                     .progress_made = false}};
+  while (result.ticks_completed < max_ticks) {
+    XLS_ASSIGN_OR_RETURN(TickResult tick_result, Tick(continuation));
+    result.tick_result.progress_made |= tick_result.progress_made;
+    if (tick_result.execution_state == TickExecutionState::kCompleted) {
+      ++result.ticks_completed;
+    } else if (tick_result.execution_state !=
+               TickExecutionState::kSentOnChannel) {
+      result.tick_result.execution_state = tick_result.execution_state;
+      result.tick_result.channel = tick_result.channel;
+      break;
+    }
+  }
+  return result;
+}
+
 }  // namespace xls
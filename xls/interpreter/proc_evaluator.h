@@ -15,6 +15,7 @@
 #ifndef XLS_INTERPRETER_PROC_EVALUATOR_H_
 #define XLS_INTERPRETER_PROC_EVALUATOR_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <ostream>
@@ -57,6 +58,9 @@ enum class TickExecutionState {
   kCompleted,
   // The proc tick was blocked on a blocking receive.
   kBlockedOnReceive,
+  // The proc tick was blocked on a send to a bounded channel queue which is
+  // full. Execution resumes at the send.
+  kBlockedOnSend,
   // The proc tick exited early because it sent data a channel. The proc is not
   // blocked and execution can resume.
   kSentOnChannel,
@@ -68,8 +72,8 @@ std::string ToString(TickExecutionState state);
 struct TickResult {
   TickExecutionState execution_state;
 
-  // If tick state is kBlockedOnReceive or kSentOnChannel then this field holds
-  // the respective channel.
+  // If tick state is kBlockedOnReceive, kBlockedOnSend or kSentOnChannel then
+  // this field holds the respective channel.
   std::optional<Channel*> channel;
 
   // Whether any progress was made (at least one instruction was executed).
@@ -84,6 +88,16 @@ struct TickResult {
 std::ostream& operator<<(std::ostream& os, TickExecutionState state);
 std::ostream& operator<<(std::ostream& os, const TickResult& result);
 
+// Result of running multiple ticks with ProcEvaluator::RunTicks.
+struct MultiTickResult {
+  // The number of ticks which completed.
+  int64_t ticks_completed;
+  // The state in which execution stopped: either kCompleted if all of the
+  // requested ticks completed or the state in which the last, incomplete tick
+  // stopped (e.g., kBlockedOnReceive).
+  TickResult tick_result;
+};
+
 // Abstract base class for evaluators of procs (e.g., interpreter or JIT).
 class ProcEvaluator {
  public:
@@ -103,6 +117,19 @@ class ProcEvaluator {
   virtual absl::StatusOr<TickResult> Tick(
       ProcContinuation& continuation) const = 0;
 
+  // Runs up to `max_ticks` complete ticks of the proc from the given
+  // continuation, continuing past sends, until a tick stops for another reason
+  // (e.g., blocked on a receive). `tick_result.progress_made` is true if any
+  // of the ticks made progress. The default implementation calls Tick
+  // repeatedly.
+  virtual absl::StatusOr<MultiTickResult> RunTicks(
+      ProcContinuation& continuation, int64_t max_ticks) const;
+
+  // Returns true if RunTicks runs the ticks without returning control to the
+  // caller in between (e.g., in a single call into jitted code) so it is
+  // cheaper than calling Tick repeatedly.
+  virtual bool SupportsMultiTick() const { return false; }
+
   Proc* proc() const { return proc_; }
 
   // Returns true if the proc has any send or receive nodes.
@@ -14,6 +14,8 @@
 
 #include "xls/interpreter/proc_interpreter.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -39,12 +41,11 @@ class ProcIrInterpreter : public IrInterpreter {
   //     tick of the proc. Used for continuations.
   //   events: events object to record events in (e.g, traces).
   //   queue_manager: manager for channel queues.
-  ProcIrInterpreter(absl::Span<const Value> state,
-                    absl::flat_hash_map<Node*, Value>* node_values,
+  ProcIrInterpreter(std::vector<Value>* state, NodeValueSlots* node_values,
                     InterpreterEvents* events,
                     ChannelQueueManager* queue_manager)
       : IrInterpreter(node_values, events),
-        state_(state.begin(), state.end()),
+        state_(state),
         queue_manager_(queue_manager) {}
 
   absl::Status HandleReceive(Receive* receive) override {
@@ -90,10 +91,16 @@ class ProcIrInterpreter : public IrInterpreter {
         return SetValueResult(send, Value::Token());
       }
     }
+    if (queue->IsFull()) {
+      // Record the channel this send instruction is blocked on and exit.
+      blocked_channel_ = queue->channel();
+      blocked_on_send_ = true;
+      return absl::OkStatus();
+    }
     // Indicate that data is sent on this channel.
     sent_channel_ = queue->channel();
 
-    XLS_RETURN_IF_ERROR(queue->Write(ResolveAsValue(send->data())));
+    XLS_RETURN_IF_ERROR(queue->Write(Value(ResolveAsValue(send->data()))));
 
     // The result of a send is simply a token.
     return SetValueResult(send, Value::Token());
@@ -105,32 +112,38 @@ class ProcIrInterpreter : public IrInterpreter {
     if (index == 0) {
       return SetValueResult(param, Value::Token());
     }
-    // Params from 1 on are state.
-    return SetValueResult(param, state_[index - 1]);
+    // Params from 1 on are state. The state value is not needed again in this
+    // tick so move it into the param.
+    return SetValueResult(param, std::move((*state_)[index - 1]));
   }
 
   // Executes a single node and return whether the node is blocked on a channel
-  // (for receive nodes) or whether data was sent on a channel (for send nodes).
+  // (for receive nodes and sends to full queues) or whether data was sent on a
+  // channel (for send nodes).
   struct NodeResult {
     std::optional<Channel*> blocked_channel;
+    bool blocked_on_send;
     std::optional<Channel*> sent_channel;
   };
   absl::StatusOr<NodeResult> ExecuteNode(Node* node) {
     // Send/Receive handlers might set these values so clear them before hand.
     blocked_channel_ = std::nullopt;
+    blocked_on_send_ = false;
     sent_channel_ = std::nullopt;
     XLS_RETURN_IF_ERROR(node->VisitSingleNode(this));
     return NodeResult{.blocked_channel = blocked_channel_,
+                      .blocked_on_send = blocked_on_send_,
                       .sent_channel = sent_channel_};
   }
 
  private:
-  std::vector<Value> state_;
+  std::vector<Value>* state_;
   ChannelQueueManager* queue_manager_;
 
   // Ephemeral values set by the send/receive handlers indicating the channel
   // execution is blocked on or the channel on which data was sent.
   std::optional<Channel*> blocked_channel_;
+  bool blocked_on_send_ = false;
   std::optional<Channel*> sent_channel_;
 };
 
@@ -139,7 +152,26 @@ class ProcIrInterpreter : public IrInterpreter {
 ProcInterpreter::ProcInterpreter(Proc* proc, ChannelQueueManager* queue_manager)
     : ProcEvaluator(proc),
       queue_manager_(queue_manager),
-      execution_order_(TopoSort(proc).AsVector()) {}
+      execution_order_(TopoSort(proc).AsVector()) {
+  absl::Span<Node* const> next_state = proc->NextState();
+  move_next_state_.resize(next_state.size());
+  for (int64_t i = 0; i < next_state.size(); ++i) {
+    move_next_state_[i] =
+        std::find(next_state.begin() + i + 1, next_state.end(),
+                  next_state[i]) == next_state.end();
+  }
+}
+
+std::vector<Value> ProcInterpreterContinuation::GetState() const {
+  std::vector<Value> state = state_;
+  for (int64_t i = 0; i < state.size(); ++i) {
+    if (state[i].kind() == ValueKind::kInvalid) {
+      // The value has been moved into the state param.
+      state[i] = node_values_.Get(proc_->GetStateParam(i));
+    }
+  }
+  return state;
+}
 
 std::unique_ptr<ProcContinuation> ProcInterpreter::NewContinuation() const {
   return std::make_unique<ProcInterpreterContinuation>(proc());
@@ -153,8 +185,9 @@ absl::StatusOr<TickResult> ProcInterpreter::Tick(
                                      "of type ProcInterpreterContinuation";
   std::vector<Channel*> sent_channels;
 
-  ProcIrInterpreter ir_interpreter(cont->GetState(), &cont->GetNodeValues(),
-                                   &cont->GetEvents(), queue_manager_);
+  ProcIrInterpreter ir_interpreter(&cont->GetMutableState(),
+                                   &cont->GetNodeValues(), &cont->GetEvents(),
+                                   queue_manager_);
 
   // Resume execution at the node indicated in the continuation
   // (NodeExecutionIndex).
@@ -177,26 +210,35 @@ absl::StatusOr<TickResult> ProcInterpreter::Tick(
     }
     if (result.blocked_channel.has_value()) {
       // Early exit: proc is blocked at a receive node waiting for data on a
-      // channel. Execution should resume at the send.
+      // channel or at a send node waiting for space in a full queue.
+      // Execution should resume at the blocked node.
       cont->SetNodeExecutionIndex(i);
       // Raise a status error if interpreter events indicate failure such as a
       // failed assert.
       XLS_RETURN_IF_ERROR(InterpreterEventsToStatus(cont->GetEvents()));
       return TickResult{
-          .execution_state = TickExecutionState::kBlockedOnReceive,
+          .execution_state = result.blocked_on_send
+                                 ? TickExecutionState::kBlockedOnSend
+                                 : TickExecutionState::kBlockedOnReceive,
           .channel = result.blocked_channel.value(),
           .progress_made = cont->GetNodeExecutionIndex() != starting_index};
     }
   }
 
   // Proc completed execution of the Tick. Set the next proc state in the
-  // continuation.
-  std::vector<Value> next_state;
-  next_state.reserve(proc()->GetStateElementCount());
-  for (Node* next_node : proc()->NextState()) {
-    next_state.push_back(ir_interpreter.ResolveAsValue(next_node));
+  // continuation. The node values are discarded afterwards so they are moved
+  // rather than copied where possible.
+  std::vector<Value>& state = cont->GetMutableState();
+  NodeValueSlots& node_values = cont->GetNodeValues();
+  absl::Span<Node* const> next_state = proc()->NextState();
+  for (int64_t i = 0; i < next_state.size(); ++i) {
+    if (move_next_state_[i]) {
+      state[i] = std::move(node_values.Get(next_state[i]));
+    } else {
+      state[i] = node_values.Get(next_state[i]);
+    }
   }
-  cont->NextTick(std::move(next_state));
+  cont->NextTick();
 
   // Raise a status error if interpreter events indicate failure such as a
   // failed assert.
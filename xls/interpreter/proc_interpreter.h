@@ -24,6 +24,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/ir_interpreter.h"
 #include "xls/interpreter/proc_evaluator.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/events.h"
@@ -32,29 +33,33 @@
 
 namespace xls {
 
-// A continuation used by the ProcInterpreter.
+// A continuation used by the ProcInterpreter. Node values are held in slots
+// which are allocated once and reused across ticks. State values are moved,
+// not copied, into the state params as they execute and back from the next
+// state nodes when the tick completes.
 class ProcInterpreterContinuation : public ProcContinuation {
  public:
   // Construct a new continuation. Execution the proc begins with the state set
   // to its initial values with no proc nodes yet executed.
   explicit ProcInterpreterContinuation(Proc* proc)
-      : node_index_(0),
-        state_(proc->InitValues().begin(), proc->InitValues().end()) {}
+      : proc_(proc),
+        node_index_(0),
+        state_(proc->InitValues().begin(), proc->InitValues().end()),
+        node_values_(proc) {}
 
   ~ProcInterpreterContinuation() override = default;
 
-  std::vector<Value> GetState() const override { return state_; }
+  std::vector<Value> GetState() const override;
   const InterpreterEvents& GetEvents() const override { return events_; }
   InterpreterEvents& GetEvents() override { return events_; }
   void ClearEvents() override { events_.Clear(); }
   bool AtStartOfTick() const override { return node_index_ == 0; }
 
   // Resets the continuation so it will start executing at the beginning of the
-  // proc with the given state values.
-  void NextTick(std::vector<Value>&& next_state) {
+  // proc. The next state values must have been written to `GetMutableState`.
+  void NextTick() {
     node_index_ = 0;
-    state_ = next_state;
-    node_values_.clear();
+    node_values_.Clear();
   }
 
   // Gets/sets the index of the node to be executed next. This index refers to a
@@ -62,18 +67,21 @@ class ProcInterpreterContinuation : public ProcContinuation {
   int64_t GetNodeExecutionIndex() const { return node_index_; }
   void SetNodeExecutionIndex(int64_t index) { node_index_ = index; }
 
-  // Returns the map of node values computed in the tick so far.
-  absl::flat_hash_map<Node*, Value>& GetNodeValues() { return node_values_; }
-  const absl::flat_hash_map<Node*, Value>& GetNodeValues() const {
-    return node_values_;
-  }
+  // Returns the state values of the tick. An element is invalid once it has
+  // been moved into its state param.
+  std::vector<Value>& GetMutableState() { return state_; }
+
+  // Returns the node values computed in the tick so far.
+  NodeValueSlots& GetNodeValues() { return node_values_; }
+  const NodeValueSlots& GetNodeValues() const { return node_values_; }
 
  private:
+  Proc* proc_;
   int64_t node_index_;
   std::vector<Value> state_;
 
   InterpreterEvents events_;
-  absl::flat_hash_map<Node*, Value> node_values_;
+  NodeValueSlots node_values_;
 };
 
 // A interpreter for an individual proc. Incrementally executes Procs a single
@@ -97,6 +105,11 @@ class ProcInterpreter : public ProcEvaluator {
   // A topological sort of the nodes of the proc which determines the execution
   // order of the proc.
   std::vector<Node*> execution_order_;
+
+  // Whether the value of each next state node may be moved into the state when
+  // the tick completes, i.e. whether it is the last use of the node in the
+  // next state.
+  std::vector<bool> move_next_state_;
 };
 
 }  // namespace xls
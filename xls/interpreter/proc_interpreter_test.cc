@@ -14,17 +14,25 @@
 
 #include "xls/interpreter/proc_interpreter.h"
 
+#include <cstdint>
+#include <memory>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/proc_evaluator.h"
 #include "xls/interpreter/proc_evaluator_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/ir_test_base.h"
 #include "xls/ir/proc.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 namespace {
 
+using ::testing::ElementsAre;
+
 // Instantiate and run all the tests in proc_evaluator_test_base.cc.
 INSTANTIATE_TEST_SUITE_P(
     ProcInterpreterTest, ProcEvaluatorTestBase,
@@ -37,5 +45,52 @@ INSTANTIATE_TEST_SUITE_P(
           return ChannelQueueManager::Create(package).value();
         })));
 
+class ProcInterpreterContinuationTest : public IrTestBase {};
+
+TEST_F(ProcInterpreterContinuationTest, StateAcrossBlockingReceive) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           ParsePackage(R"(
+package test
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="")
+
+proc accumulate(tkn: token, a: bits[32], b: bits[32], init={1, 2}) {
+  rcv: (token, bits[32]) = receive(tkn, channel_id=0)
+  rcv_tkn: token = tuple_index(rcv, index=0)
+  data: bits[32] = tuple_index(rcv, index=1)
+  sum: bits[32] = add(a, data)
+  next (rcv_tkn, sum, sum)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, package->GetProc("accumulate"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelQueueManager> queue_manager,
+                           ChannelQueueManager::Create(package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * in,
+                           queue_manager->GetQueueByName("in"));
+  ProcInterpreter interpreter(proc, queue_manager.get());
+  std::unique_ptr<ProcContinuation> continuation =
+      interpreter.NewContinuation();
+
+  // The state is reported correctly while blocked mid-tick and when the next
+  // state shares a node between elements.
+  int64_t expected = 1;
+  for (int64_t i = 0; i < 3; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(TickResult blocked,
+                             interpreter.Tick(*continuation));
+    EXPECT_EQ(blocked.execution_state, TickExecutionState::kBlockedOnReceive);
+    EXPECT_FALSE(continuation->AtStartOfTick());
+    EXPECT_EQ(continuation->GetState()[0], Value(UBits(expected, 32)));
+
+    XLS_ASSERT_OK(in->Write(Value(UBits(10, 32))));
+    XLS_ASSERT_OK_AND_ASSIGN(TickResult completed,
+                             interpreter.Tick(*continuation));
+    EXPECT_EQ(completed.execution_state, TickExecutionState::kCompleted);
+    expected += 10;
+    EXPECT_THAT(continuation->GetState(),
+                ElementsAre(Value(UBits(expected, 32)),
+                            Value(UBits(expected, 32))));
+  }
+}
+
 }  // namespace
 }  // namespace xls
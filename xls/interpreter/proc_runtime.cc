@@ -23,6 +23,7 @@
 
 #include "absl/status/statusor.h"
 #include "absl/strings/str_join.h"
+#include "xls/jit/jit_trace_buffer.h"
 
 namespace xls {
 
@@ -30,7 +31,10 @@ ProcRuntime::ProcRuntime(
     Package* package,
     absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>>&& evaluators,
     std::unique_ptr<ChannelQueueManager>&& queue_manager)
-    : package_(package), queue_manager_(std::move(queue_manager)) {
+    : package_(package),
+      queue_manager_(std::move(queue_manager)),
+      jit_queue_manager_(
+          dynamic_cast<JitChannelQueueManager*>(queue_manager_.get())) {
   for (const std::unique_ptr<Proc>& proc : package_->procs()) {
     std::unique_ptr<ProcContinuation> continuation =
         evaluators.at(proc.get())->NewContinuation();
@@ -40,9 +44,30 @@ ProcRuntime::ProcRuntime(
   }
 }
 
-absl::Status ProcRuntime::Tick() {
-  std::vector<Channel*> blocked_channels;
+absl::StatusOr<ProcRuntime::NetworkTickResult> ProcRuntime::TickNetwork() {
   XLS_ASSIGN_OR_RETURN(NetworkTickResult result, TickInternal());
+  if (profile_ != nullptr) {
+    for (ChannelQueue* queue : queue_manager_->queues()) {
+      profile_->RecordOccupancy(queue->channel(), queue->GetSize());
+    }
+  }
+  // Trace events recorded by jitted procs are stamped with the tick of the
+  // network in which they fired.
+  if (jit_queue_manager_ != nullptr &&
+      jit_queue_manager_->runtime().trace_buffer() != nullptr) {
+    jit_queue_manager_->runtime().trace_buffer()->AdvanceTick();
+  }
+  return result;
+}
+
+bool ProcRuntime::ObservesTicks() const {
+  return profile_ != nullptr ||
+         (jit_queue_manager_ != nullptr &&
+          jit_queue_manager_->runtime().trace_buffer() != nullptr);
+}
+
+absl::Status ProcRuntime::Tick() {
+  XLS_ASSIGN_OR_RETURN(NetworkTickResult result, TickNetwork());
   if (!result.progress_made) {
     // Not a single instruction executed on any proc. This is necessarily a
     // deadlock.
@@ -116,7 +141,7 @@ absl::StatusOr<int64_t> ProcRuntime::TickUntilBlocked(
                                     package_->name());
   int64_t ticks = 0;
   while (!max_ticks.has_value() || ticks < max_ticks.value()) {
-    XLS_ASSIGN_OR_RETURN(NetworkTickResult result, TickInternal());
+    XLS_ASSIGN_OR_RETURN(NetworkTickResult result, TickNetwork());
     if (!result.progress_made_on_io_procs) {
       return ticks;
     }
@@ -132,6 +157,7 @@ void ProcRuntime::ResetState() {
     EvaluatorContext& context = evaluator_contexts_[proc.get()];
     context.continuation = context.evaluator->NewContinuation();
   }
+  ResetScheduling();
 }
 
 absl::StatusOr<JitChannelQueueManager*>
@@ -22,6 +22,7 @@
 #include "absl/status/statusor.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_runtime_profile.h"
 #include "xls/ir/events.h"
 #include "xls/ir/package.h"
 #include "xls/jit/jit_channel_queue.h"
@@ -63,9 +64,11 @@ class ProcRuntime {
   // before returning an error. Note: some proc networks are not guaranteed to
   // block even if given no inputs. `max_ticks` is the maximum number of ticks
   // of the proc network before returning an error.
-  absl::StatusOr<int64_t> TickUntilBlocked(
+  virtual absl::StatusOr<int64_t> TickUntilBlocked(
       std::optional<int64_t> max_ticks = std::nullopt);
 
+  Package* package() const { return package_; }
+
   ChannelQueueManager& queue_manager() { return *queue_manager_; }
 
   // If the contained Channel queue manager is a JitChannelQueueManager then
@@ -80,6 +83,14 @@ class ProcRuntime {
     return evaluator_contexts_.at(proc).continuation->GetState();
   }
 
+  // Returns the continuation holding the execution state of a proc in the
+  // network. As the caller may modify the continuation, any scheduling state
+  // the runtime derived from it is discarded.
+  ProcContinuation& GetContinuation(Proc* proc) {
+    ResetScheduling();
+    return *evaluator_contexts_.at(proc).continuation;
+  }
+
   // Reset the state of all of the procs to their initial state.
   void ResetState();
 
@@ -94,6 +105,12 @@ class ProcRuntime {
     }
   }
 
+  // Records the activity of each proc and the occupancy of each channel queue
+  // at the end of each tick of the network into `profile`, which must outlive
+  // the runtime. Passing nullptr stops profiling. Costs a check per proc
+  // activation when not profiling.
+  void SetProfile(ProcRuntimeProfile* profile) { profile_ = profile; }
+
  protected:
   // Execute (up to) a single iteration of every proc in the package.
   struct NetworkTickResult {
@@ -107,13 +124,29 @@ class ProcRuntime {
   };
   virtual absl::StatusOr<NetworkTickResult> TickInternal() = 0;
 
+  // Runs TickInternal and samples the channel occupancies if profiling.
+  absl::StatusOr<NetworkTickResult> TickNetwork();
+
+  // Returns true if something records per-tick information about the
+  // network (a profile or a trace buffer stamping events with the tick), so
+  // each tick of the network must be run by TickNetwork.
+  bool ObservesTicks() const;
+
+  // Discards any scheduling state derived from the procs' continuations
+  // (e.g., which procs are blocked). Called when continuations are replaced
+  // or may be modified externally.
+  virtual void ResetScheduling() {}
+
   Package* package_;
   std::unique_ptr<ChannelQueueManager> queue_manager_;
+  // `queue_manager_` if it is a JitChannelQueueManager, otherwise nullptr.
+  JitChannelQueueManager* jit_queue_manager_;
   struct EvaluatorContext {
     std::unique_ptr<ProcEvaluator> evaluator;
     std::unique_ptr<ProcContinuation> continuation;
   };
   absl::flat_hash_map<Proc*, EvaluatorContext> evaluator_contexts_;
+  ProcRuntimeProfile* profile_ = nullptr;
 };
 
 }  // namespace xls
@@ -0,0 +1,138 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/proc_runtime_profile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "xls/common/math_util.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/proc.h"
+
+namespace xls {
+namespace {
+
+// Returns e.g. "0:3 1:5 2-3:1 8-15:2" for the non-empty buckets.
+std::string HistogramToString(const std::vector<int64_t>& histogram) {
+  std::vector<std::string> buckets;
+  for (int64_t i = 0; i < histogram.size(); ++i) {
+    if (histogram[i] == 0) {
+      continue;
+    }
+    int64_t low = i == 0 ? 0 : int64_t{1} << (i - 1);
+    int64_t high = i == 0 ? 0 : (int64_t{1} << i) - 1;
+    buckets.push_back(low == high
+                          ? absl::StrFormat("%d:%d", low, histogram[i])
+                          : absl::StrFormat("%d-%d:%d", low, high,
+                                            histogram[i]));
+  }
+  return absl::StrJoin(buckets, " ");
+}
+
+}  // namespace
+
+void ProcRuntimeProfile::RecordTick(Proc* proc, const TickResult& result) {
+  ProcActivity& activity = activities_[proc];
+  ++activity.activations;
+  switch (result.execution_state) {
+    case TickExecutionState::kCompleted:
+      ++activity.completed_ticks;
+      break;
+    case TickExecutionState::kBlockedOnReceive:
+      ++activity.blocked_on_receive;
+      break;
+    case TickExecutionState::kBlockedOnSend:
+      ++activity.blocked_on_send;
+      break;
+    case TickExecutionState::kSentOnChannel:
+      break;
+  }
+}
+
+void ProcRuntimeProfile::RecordOccupancy(Channel* channel, int64_t size) {
+  ChannelOccupancy& occupancy = occupancies_[channel];
+  ++occupancy.samples;
+  occupancy.total += size;
+  occupancy.max = std::max(occupancy.max, size);
+  int64_t bucket = size == 0 ? 0 : FloorOfLog2(size) + 1;
+  if (occupancy.log2_histogram.size() <= bucket) {
+    occupancy.log2_histogram.resize(bucket + 1, 0);
+  }
+  ++occupancy.log2_histogram[bucket];
+}
+
+ProcActivity ProcRuntimeProfile::GetActivity(Proc* proc) const {
+  auto it = activities_.find(proc);
+  return it == activities_.end() ? ProcActivity() : it->second;
+}
+
+ChannelOccupancy ProcRuntimeProfile::GetOccupancy(Channel* channel) const {
+  auto it = occupancies_.find(channel);
+  return it == occupancies_.end() ? ChannelOccupancy() : it->second;
+}
+
+void ProcRuntimeProfile::Reset() {
+  activities_.clear();
+  occupancies_.clear();
+}
+
+std::string ProcRuntimeProfile::ToString() const {
+  std::string result;
+
+  std::vector<std::pair<Proc*, ProcActivity>> procs(activities_.begin(),
+                                                    activities_.end());
+  std::sort(procs.begin(), procs.end(), [](const auto& a, const auto& b) {
+    if (a.second.activations != b.second.activations) {
+      return a.second.activations > b.second.activations;
+    }
+    return a.first->name() < b.first->name();
+  });
+  absl::StrAppendFormat(&result, "Proc activity:\n");
+  absl::StrAppendFormat(&result, "%12s %12s %12s %12s  %s\n", "activations",
+                        "completed", "blocked_recv", "blocked_send", "proc");
+  for (const auto& [proc, activity] : procs) {
+    absl::StrAppendFormat(&result, "%12d %12d %12d %12d  %s\n",
+                          activity.activations, activity.completed_ticks,
+                          activity.blocked_on_receive, activity.blocked_on_send,
+                          proc->name());
+  }
+
+  std::vector<std::pair<Channel*, ChannelOccupancy>> channels(
+      occupancies_.begin(), occupancies_.end());
+  std::sort(channels.begin(), channels.end(),
+            [](const auto& a, const auto& b) {
+              if (a.second.max != b.second.max) {
+                return a.second.max > b.second.max;
+              }
+              return a.first->name() < b.first->name();
+            });
+  absl::StrAppendFormat(&result, "Channel occupancy per network tick:\n");
+  absl::StrAppendFormat(&result, "%8s %10s  %-24s %s\n", "max", "mean",
+                        "channel", "histogram (occupancy:ticks)");
+  for (const auto& [channel, occupancy] : channels) {
+    absl::StrAppendFormat(&result, "%8d %10.2f  %-24s %s\n", occupancy.max,
+                          occupancy.mean(), channel->name(),
+                          HistogramToString(occupancy.log2_histogram));
+  }
+  return result;
+}
+
+}  // namespace xls
@@ -0,0 +1,87 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_PROC_RUNTIME_PROFILE_H_
+#define XLS_INTERPRETER_PROC_RUNTIME_PROFILE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/proc.h"
+
+namespace xls {
+
+// How often a proc was run by a runtime and why it stopped.
+struct ProcActivity {
+  // Calls of the proc's evaluator, i.e. (partial) executions of the proc.
+  int64_t activations = 0;
+  int64_t completed_ticks = 0;
+  int64_t blocked_on_receive = 0;
+  int64_t blocked_on_send = 0;
+};
+
+// Occupancy of a channel queue, sampled at the end of every tick of the proc
+// network.
+struct ChannelOccupancy {
+  int64_t samples = 0;
+  int64_t total = 0;
+  int64_t max = 0;
+  // Element `i` counts the samples with an occupancy in [2^(i-1), 2^i), and
+  // element 0 the samples of an empty queue.
+  std::vector<int64_t> log2_histogram;
+
+  double mean() const {
+    return samples == 0 ? 0.0 : static_cast<double>(total) / samples;
+  }
+};
+
+// Records per-proc activity and per-channel occupancy of a ProcRuntime to
+// find the procs which limit the throughput of a proc network and to size
+// FIFOs. See ProcRuntime::SetProfile.
+//
+// Not synchronized: runtimes record into it only while holding their own
+// locks.
+class ProcRuntimeProfile {
+ public:
+  ProcRuntimeProfile() = default;
+
+  ProcRuntimeProfile(const ProcRuntimeProfile&) = delete;
+  ProcRuntimeProfile& operator=(const ProcRuntimeProfile&) = delete;
+
+  void RecordTick(Proc* proc, const TickResult& result);
+  void RecordOccupancy(Channel* channel, int64_t size);
+
+  // Returns the activity of `proc`, which is all zero if it never ran.
+  ProcActivity GetActivity(Proc* proc) const;
+  ChannelOccupancy GetOccupancy(Channel* channel) const;
+
+  void Reset();
+
+  // Returns tables of the activity of each proc, in descending order of
+  // activations, and of the occupancy of each channel, in descending order
+  // of maximum occupancy.
+  std::string ToString() const;
+
+ private:
+  absl::flat_hash_map<Proc*, ProcActivity> activities_;
+  absl::flat_hash_map<Channel*, ChannelOccupancy> occupancies_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_PROC_RUNTIME_PROFILE_H_
@@ -23,6 +23,7 @@
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/matchers.h"
+#include "xls/interpreter/proc_runtime_profile.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
@@ -34,6 +35,7 @@ namespace {
 
 using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 using ::testing::Optional;
 
@@ -277,6 +279,51 @@ TEST_P(ProcRuntimeTestBase, IotaFeedingAccumulator) {
   EXPECT_THAT(queue.Read(), Optional(Value(UBits(6, 32))));
 }
 
+TEST_P(ProcRuntimeTestBase, Profile) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * iota_accum_channel,
+      package->CreateStreamingChannel("iota_accum", ChannelOps::kSendReceive,
+                                      package->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out_channel,
+      package->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                      package->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * iota, CreateIotaProc("iota", /*starting_value=*/0, /*step=*/1,
+                                  iota_accum_channel, package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * accum, CreateAccumProc("accum", iota_accum_channel, out_channel,
+                                    package.get()));
+
+  std::unique_ptr<ProcRuntime> runtime =
+      GetParam().CreateRuntime(package.get());
+  ProcRuntimeProfile profile;
+  runtime->SetProfile(&profile);
+  XLS_ASSERT_OK_AND_ASSIGN(int64_t tick_count,
+                           runtime->TickUntilOutput({{out_channel, 4}}));
+  EXPECT_EQ(tick_count, 4);
+
+  for (Proc* proc : {iota, accum}) {
+    ProcActivity activity = profile.GetActivity(proc);
+    EXPECT_EQ(activity.completed_ticks, 4) << proc->name();
+    EXPECT_GE(activity.activations, 4) << proc->name();
+    EXPECT_EQ(activity.blocked_on_send, 0) << proc->name();
+  }
+  // The output is not consumed so it fills up by one each tick.
+  ChannelOccupancy occupancy = profile.GetOccupancy(out_channel);
+  EXPECT_EQ(occupancy.samples, 4);
+  EXPECT_EQ(occupancy.max, 4);
+  EXPECT_EQ(occupancy.total, 1 + 2 + 3 + 4);
+  EXPECT_THAT(occupancy.log2_histogram, ElementsAre(0, 1, 2, 1));
+  EXPECT_EQ(profile.GetOccupancy(iota_accum_channel).max, 0);
+  EXPECT_THAT(profile.ToString(), HasSubstr("accum"));
+
+  runtime->SetProfile(nullptr);
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_EQ(profile.GetOccupancy(out_channel).samples, 4);
+}
+
 TEST_P(ProcRuntimeTestBase, DegenerateProc) {
   // Tests interpreting a proc with no send of receive nodes.
   auto package = CreatePackage();
@@ -14,6 +14,7 @@
 
 #include "xls/interpreter/random_value.h"
 
+#include <cstdint>
 #include <random>
 #include <vector>
 
@@ -98,4 +99,14 @@ absl::StatusOr<std::vector<Value>> RandomFunctionArguments(
       "or the limit should be increased."));
 }
 
+std::minstd_rand ShardedRandomEngine(int64_t seed, int64_t shard) {
+  uint64_t useed = static_cast<uint64_t>(seed);
+  uint64_t ushard = static_cast<uint64_t>(shard);
+  std::seed_seq seed_seq{static_cast<uint32_t>(useed),
+                         static_cast<uint32_t>(useed >> 32),
+                         static_cast<uint32_t>(ushard),
+                         static_cast<uint32_t>(ushard >> 32)};
+  return std::minstd_rand(seed_seq);
+}
+
 }  // namespace xls
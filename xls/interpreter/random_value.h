@@ -15,6 +15,7 @@
 #ifndef XLS_INTERPRETER_RANDOM_VALUE_H_
 #define XLS_INTERPRETER_RANDOM_VALUE_H_
 
+#include <cstdint>
 #include <random>
 #include <vector>
 
@@ -37,6 +38,11 @@ absl::StatusOr<std::vector<Value>> RandomFunctionArguments(
     Function* f, std::minstd_rand* engine, Function* validator,
     int64_t max_attempts);
 
+// Returns an engine for shard `shard` of a random stream identified by `seed`.
+// Each shard's engine is seeded independently so the shards of a stream may be
+// generated in parallel and in any order with deterministic results.
+std::minstd_rand ShardedRandomEngine(int64_t seed, int64_t shard);
+
 }  // namespace xls
 
 #endif  // XLS_INTERPRETER_RANDOM_VALUE_H_
@@ -85,6 +85,21 @@ TEST(RandomValueTest, Determinism) {
             RandomValue(p.GetBitsType(42), &rng_engine1));
 }
 
+TEST(RandomValueTest, ShardedEngines) {
+  Package p("test_package");
+  std::minstd_rand shard0 = ShardedRandomEngine(/*seed=*/1, /*shard=*/0);
+  std::minstd_rand shard0_again = ShardedRandomEngine(/*seed=*/1, /*shard=*/0);
+  std::minstd_rand shard1 = ShardedRandomEngine(/*seed=*/1, /*shard=*/1);
+  std::minstd_rand other_seed = ShardedRandomEngine(/*seed=*/2, /*shard=*/0);
+
+  Value v0 = RandomValue(p.GetBitsType(64), &shard0);
+  EXPECT_EQ(v0, RandomValue(p.GetBitsType(64), &shard0_again));
+  // Overwhelmingly likely that different shards and seeds give different
+  // streams.
+  EXPECT_NE(v0, RandomValue(p.GetBitsType(64), &shard1));
+  EXPECT_NE(v0, RandomValue(p.GetBitsType(64), &other_seed));
+}
+
 TEST(RandomValueTest, RandomOtherTypes) {
   Package p("test_package");
   std::minstd_rand rng_engine;
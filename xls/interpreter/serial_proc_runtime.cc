@@ -15,13 +15,20 @@
 #include "xls/interpreter/serial_proc_runtime.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <deque>
+#include <limits>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
 
 namespace xls {
 
@@ -48,17 +55,62 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> SerialProcRuntime::Create(
   return std::move(network_interpreter);
 }
 
+SerialProcRuntime::SerialProcRuntime(
+    Package* package,
+    absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>>&& evaluators,
+    std::unique_ptr<ChannelQueueManager>&& queue_manager)
+    : ProcRuntime(package, std::move(evaluators), std::move(queue_manager)) {
+  for (ChannelQueue* queue : queue_manager_->queues()) {
+    Channel* channel = queue->channel();
+    queue->SetWriteCallback([this, channel]() { WakeBlockedProc(channel); });
+  }
+}
+
+void SerialProcRuntime::WakeBlockedProc(Channel* channel) {
+  if (blocked_procs_.empty()) {
+    return;
+  }
+  auto it = blocked_procs_.find(channel);
+  if (it == blocked_procs_.end()) {
+    return;
+  }
+  XLS_VLOG(3) << absl::StreamFormat(
+      "Unblocking proc `%s` after write to channel `%s`", it->second->name(),
+      channel->name());
+  woken_procs_.push_back(it->second);
+  blocked_proc_set_.erase(it->second);
+  blocked_procs_.erase(it);
+}
+
+void SerialProcRuntime::ResetScheduling() {
+  blocked_procs_.clear();
+  blocked_proc_set_.clear();
+  woken_procs_.clear();
+}
+
 absl::StatusOr<SerialProcRuntime::NetworkTickResult>
 SerialProcRuntime::TickInternal() {
   XLS_VLOG(3) << absl::StreamFormat("TickInternal on package %s",
                                     package_->name());
-  // Map containing any blocked procs and the channels they are blocked on.
-  absl::flat_hash_map<Channel*, Proc*> blocked_procs;
+  // Procs blocked on channels with generators. These are retried every tick
+  // as the generator may produce a value at any time.
+  absl::flat_hash_map<Channel*, Proc*> generator_blocked_procs;
+
+  // Procs blocked on sends to full queues. Queues do not notify on reads, so
+  // these are retried whenever any other proc has made progress since they
+  // blocked.
+  absl::flat_hash_map<Channel*, Proc*> send_blocked_procs;
+  bool progress_since_send_block = false;
 
   std::deque<Proc*> ready_procs;
 
-  // Put all procs on the ready list.
+  // Put all procs which are not blocked on the ready list. Procs woken since
+  // the previous tick are no longer blocked so they are included here.
+  woken_procs_.clear();
   for (const std::unique_ptr<Proc>& proc : package_->procs()) {
+    if (blocked_proc_set_.contains(proc.get())) {
+      continue;
+    }
     XLS_VLOG(3) << absl::StreamFormat("Proc `%s` added to ready list",
                                       proc->name());
     ready_procs.push_back(proc.get());
@@ -66,7 +118,20 @@ SerialProcRuntime::TickInternal() {
 
   bool progress_made = false;
   bool progress_made_on_io_procs = false;
-  while (!ready_procs.empty()) {
+  while (true) {
+    ready_procs.insert(ready_procs.end(), woken_procs_.begin(),
+                       woken_procs_.end());
+    woken_procs_.clear();
+    if (ready_procs.empty()) {
+      if (send_blocked_procs.empty() || !progress_since_send_block) {
+        break;
+      }
+      for (auto [channel, proc] : send_blocked_procs) {
+        ready_procs.push_back(proc);
+      }
+      send_blocked_procs.clear();
+      progress_since_send_block = false;
+    }
     Proc* proc = ready_procs.front();
     EvaluatorContext& context = evaluator_contexts_.at(proc);
     ready_procs.pop_front();
@@ -75,19 +140,18 @@ SerialProcRuntime::TickInternal() {
     XLS_ASSIGN_OR_RETURN(TickResult tick_result,
                          context.evaluator->Tick(*context.continuation));
     XLS_VLOG(3) << "Tick result: " << tick_result;
+    if (profile_ != nullptr) {
+      profile_->RecordTick(proc, tick_result);
+    }
 
     progress_made |= tick_result.progress_made;
+    progress_since_send_block |= tick_result.progress_made;
     progress_made_on_io_procs |=
         (tick_result.progress_made && context.evaluator->ProcHasIoOperations());
     if (tick_result.execution_state == TickExecutionState::kSentOnChannel) {
-      Channel* channel = tick_result.channel.value();
-      if (blocked_procs.contains(channel)) {
-        XLS_VLOG(3) << absl::StreamFormat(
-            "Unblocking proc `%s` and adding to ready list",
-            blocked_procs.at(channel)->name());
-        ready_procs.push_back(blocked_procs.at(channel));
-        blocked_procs.erase(channel);
-      }
+      // Writes to the queue normally wake the receiving proc via the write
+      // callback. Handle queues which do not notify as well.
+      WakeBlockedProc(tick_result.channel.value());
       // This proc can go back on the ready queue.
       ready_procs.push_back(proc);
     } else if (tick_result.execution_state ==
@@ -96,12 +160,29 @@ SerialProcRuntime::TickInternal() {
       XLS_VLOG(3) << absl::StreamFormat(
           "Proc `%s` is now blocked on channel `%s`", proc->name(),
           channel->ToString());
-      blocked_procs[channel] = proc;
+      if (queue_manager_->GetQueue(channel).HasGenerator()) {
+        generator_blocked_procs[channel] = proc;
+      } else {
+        blocked_procs_[channel] = proc;
+        blocked_proc_set_.insert(proc);
+      }
+    } else if (tick_result.execution_state ==
+               TickExecutionState::kBlockedOnSend) {
+      XLS_VLOG(3) << absl::StreamFormat(
+          "Proc `%s` is now blocked on send to full channel `%s`",
+          proc->name(), tick_result.channel.value()->ToString());
+      send_blocked_procs[tick_result.channel.value()] = proc;
     }
   }
   auto get_blocked_channels = [&]() {
     std::vector<Channel*> channels;
-    for (auto [channel, proc] : blocked_procs) {
+    for (auto [channel, proc] : blocked_procs_) {
+      channels.push_back(channel);
+    }
+    for (auto [channel, proc] : generator_blocked_procs) {
+      channels.push_back(channel);
+    }
+    for (auto [channel, proc] : send_blocked_procs) {
       channels.push_back(channel);
     }
     std::sort(channels.begin(), channels.end(),
@@ -115,4 +196,56 @@ SerialProcRuntime::TickInternal() {
   };
 }
 
+bool SerialProcRuntime::CanRunMultipleTicks() const {
+  if (package_->procs().size() != 1 || ObservesTicks()) {
+    return false;
+  }
+  const ProcEvaluator& evaluator =
+      *evaluator_contexts_.begin()->second.evaluator;
+  if (!evaluator.SupportsMultiTick() || !evaluator.ProcHasIoOperations()) {
+    return false;
+  }
+  // Generators may produce values at any time, which a tick blocked on them
+  // only sees when it is retried by the network.
+  for (ChannelQueue* queue : queue_manager_->queues()) {
+    if (queue->HasGenerator()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+absl::StatusOr<int64_t> SerialProcRuntime::TickUntilBlocked(
+    std::optional<int64_t> max_ticks) {
+  if (!CanRunMultipleTicks()) {
+    return ProcRuntime::TickUntilBlocked(max_ticks);
+  }
+  XLS_VLOG(3) << absl::StreamFormat(
+      "TickUntilBlocked on package %s with multi-tick evaluation",
+      package_->name());
+  EvaluatorContext& context = evaluator_contexts_.begin()->second;
+  int64_t limit = max_ticks.value_or(std::numeric_limits<int64_t>::max());
+  XLS_ASSIGN_OR_RETURN(MultiTickResult result,
+                       context.evaluator->RunTicks(*context.continuation,
+                                                   limit));
+  // The proc ran without the scheduler which may consider it blocked.
+  ResetScheduling();
+
+  // Count ticks as ProcRuntime::TickUntilBlocked does: with a single proc
+  // each completed tick is a tick of the network, as is a final tick which
+  // made progress before blocking. The tick after that makes no progress.
+  int64_t ticks = result.ticks_completed;
+  bool blocked =
+      result.tick_result.execution_state != TickExecutionState::kCompleted;
+  if (blocked && result.tick_result.progress_made) {
+    ++ticks;
+  }
+  if (!blocked || ticks >= limit) {
+    return absl::DeadlineExceededError(absl::StrFormat(
+        "Exceeded limit of %d ticks of the proc network before blocking",
+        limit));
+  }
+  return ticks;
+}
+
 }  // namespace xls
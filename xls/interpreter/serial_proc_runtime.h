@@ -15,20 +15,28 @@
 #ifndef XLS_INTERPRETER_SERIAL_PROC_RUNTIME_H_
 #define XLS_INTERPRETER_SERIAL_PROC_RUNTIME_H_
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/proc_evaluator.h"
 #include "xls/interpreter/proc_runtime.h"
+#include "xls/ir/channel.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc.h"
 
 namespace xls {
 
 // Class for interpreting a network of procs. Simultaneously interprets all
 // procs in a package handling all interproc communication via a channel queues.
+// Procs blocked on a receive are only retried after a value is written to the
+// channel so the cost of a tick scales with the number of active procs.
 // SerialProcRuntimes are thread-compatible, but not thread-safe.
 class SerialProcRuntime : public ProcRuntime {
  public:
@@ -39,14 +47,39 @@ class SerialProcRuntime : public ProcRuntime {
       std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
       std::unique_ptr<ChannelQueueManager>&& queue_manager);
 
+  // As ProcRuntime::TickUntilBlocked. A network of a single proc with IO whose
+  // evaluator supports multiple ticks per call (e.g., a ProcJit, including one
+  // of an inlined network) is run with a single ProcEvaluator::RunTicks call
+  // unless ticks are observed (see ObservesTicks) or a channel has a
+  // generator.
+  absl::StatusOr<int64_t> TickUntilBlocked(
+      std::optional<int64_t> max_ticks = std::nullopt) override;
+
  private:
   SerialProcRuntime(
       Package* package,
       absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>>&& evaluators,
-      std::unique_ptr<ChannelQueueManager>&& queue_manager)
-      : ProcRuntime(package, std::move(evaluators), std::move(queue_manager)) {}
+      std::unique_ptr<ChannelQueueManager>&& queue_manager);
 
   absl::StatusOr<SerialProcRuntime::NetworkTickResult> TickInternal() override;
+  void ResetScheduling() override;
+
+  // Returns true if TickUntilBlocked may run the network with RunTicks.
+  bool CanRunMultipleTicks() const;
+
+  // Called after a value is written to the queue of `channel` or a generator
+  // is attached to it. Moves the proc blocked on the channel (if any) to
+  // `woken_procs_`.
+  void WakeBlockedProc(Channel* channel);
+
+  // Procs blocked on receiving from a channel without a generator, indexed by
+  // channel. A blocked proc is not ticked again (even in later ticks) until a
+  // value is written to its channel or a generator is attached to it.
+  absl::flat_hash_map<Channel*, Proc*> blocked_procs_;
+  absl::flat_hash_set<Proc*> blocked_proc_set_;
+
+  // Procs unblocked by a write since they were last considered for ticking.
+  std::vector<Proc*> woken_procs_;
 };
 
 }  // namespace xls
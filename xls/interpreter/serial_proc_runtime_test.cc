@@ -14,12 +14,28 @@
 
 #include "xls/interpreter/serial_proc_runtime.h"
 
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/interpreter_proc_runtime.h"
 #include "xls/interpreter/proc_interpreter.h"
 #include "xls/interpreter/proc_runtime_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/ir_test_base.h"
 #include "xls/ir/package.h"
+#include "xls/ir/value.h"
 #include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/jit_proc_runtime.h"
 #include "xls/jit/proc_jit.h"
@@ -27,6 +43,11 @@
 namespace xls {
 namespace {
 
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using testing::HasSubstr;
+using testing::Optional;
+
 // Create a SerialProcRuntime composed of a mix of ProcInterpreters and
 // ProcJits.
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateMixedSerialProcRuntime(
@@ -71,6 +92,312 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateMixedSerialProcRuntime(
   return std::move(proc_runtime);
 }
 
+// A ProcEvaluator which counts the calls to Tick of the wrapped evaluator.
+class CountingProcEvaluator : public ProcEvaluator {
+ public:
+  explicit CountingProcEvaluator(std::unique_ptr<ProcEvaluator> evaluator)
+      : ProcEvaluator(evaluator->proc()), evaluator_(std::move(evaluator)) {}
+
+  std::unique_ptr<ProcContinuation> NewContinuation() const override {
+    return evaluator_->NewContinuation();
+  }
+  absl::StatusOr<TickResult> Tick(
+      ProcContinuation& continuation) const override {
+    ++tick_count_;
+    return evaluator_->Tick(continuation);
+  }
+  absl::StatusOr<MultiTickResult> RunTicks(ProcContinuation& continuation,
+                                           int64_t max_ticks) const override {
+    ++run_ticks_count_;
+    return evaluator_->RunTicks(continuation, max_ticks);
+  }
+  bool SupportsMultiTick() const override {
+    return evaluator_->SupportsMultiTick();
+  }
+
+  int64_t tick_count() const { return tick_count_; }
+  int64_t run_ticks_count() const { return run_ticks_count_; }
+
+ private:
+  std::unique_ptr<ProcEvaluator> evaluator_;
+  mutable int64_t tick_count_ = 0;
+  mutable int64_t run_ticks_count_ = 0;
+};
+
+// Package with a proc `counter` without IO and `kSinkCount` procs `sink_i`
+// each forwarding values from input channel `in_i` to output channel `out_i`.
+constexpr int64_t kSinkCount = 4;
+constexpr char kSinkPackageHeader[] = R"(
+package sinks
+
+proc counter(tkn: token, st: bits[32], init={0}) {
+  one: bits[32] = literal(value=1)
+  next_st: bits[32] = add(st, one)
+  next (tkn, next_st)
+}
+)";
+
+std::string SinkPackageIr() {
+  std::string ir = kSinkPackageHeader;
+  for (int64_t i = 0; i < kSinkCount; ++i) {
+    absl::StrAppendFormat(&ir, R"(
+chan in_%d(bits[32], id=%d, kind=streaming, ops=receive_only, flow_control=none, metadata="")
+chan out_%d(bits[32], id=%d, kind=streaming, ops=send_only, flow_control=none, metadata="")
+
+proc sink_%d(tkn: token, st: (), init={()}) {
+  rcv: (token, bits[32]) = receive(tkn, channel_id=%d)
+  rcv_tkn: token = tuple_index(rcv, index=0)
+  data: bits[32] = tuple_index(rcv, index=1)
+  snd: token = send(rcv_tkn, data, channel_id=%d)
+  next (snd, st)
+}
+)",
+                          i, 2 * i, i, 2 * i + 1, i, 2 * i, 2 * i + 1);
+  }
+  return ir;
+}
+
+class SerialProcRuntimeSchedulingTest : public IrTestBase {
+ protected:
+  // Creates a runtime of ProcInterpreters wrapped in CountingProcEvaluators.
+  // The wrappers are returned in `evaluators` indexed by proc name.
+  absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateCountingRuntime(
+      Package* package,
+      absl::flat_hash_map<std::string, CountingProcEvaluator*>& evaluators,
+      const absl::flat_hash_map<std::string, int64_t>& channel_capacities =
+          {}) {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<ChannelQueueManager> queue_manager,
+        ChannelQueueManager::Create(package, channel_capacities));
+    std::vector<std::unique_ptr<ProcEvaluator>> proc_evaluators;
+    for (auto& proc : package->procs()) {
+      auto evaluator = std::make_unique<CountingProcEvaluator>(
+          std::make_unique<ProcInterpreter>(proc.get(), queue_manager.get()));
+      evaluators[proc->name()] = evaluator.get();
+      proc_evaluators.push_back(std::move(evaluator));
+    }
+    return SerialProcRuntime::Create(package, std::move(proc_evaluators),
+                                     std::move(queue_manager));
+  }
+};
+
+TEST_F(SerialProcRuntimeSchedulingTest, BlockedProcsAreNotRetried) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           ParsePackage(SinkPackageIr()));
+  absl::flat_hash_map<std::string, CountingProcEvaluator*> evaluators;
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SerialProcRuntime> runtime,
+                           CreateCountingRuntime(package.get(), evaluators));
+
+  // Every proc is ticked in the first tick and the sinks block.
+  XLS_ASSERT_OK(runtime->Tick());
+  for (int64_t i = 0; i < kSinkCount; ++i) {
+    EXPECT_EQ(evaluators.at(absl::StrCat("sink_", i))->tick_count(), 1);
+  }
+
+  // The blocked sinks are not retried while their inputs are empty.
+  constexpr int64_t kIdleTicks = 10;
+  for (int64_t i = 0; i < kIdleTicks; ++i) {
+    XLS_ASSERT_OK(runtime->Tick());
+  }
+  EXPECT_EQ(evaluators.at("counter")->tick_count(), kIdleTicks + 1);
+  for (int64_t i = 0; i < kSinkCount; ++i) {
+    EXPECT_EQ(evaluators.at(absl::StrCat("sink_", i))->tick_count(), 1);
+  }
+
+  // Writing to an input channel between ticks wakes only its sink.
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * in_2,
+                           runtime->queue_manager().GetQueueByName("in_2"));
+  XLS_ASSERT_OK(in_2->Write(Value(UBits(42, 32))));
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_EQ(evaluators.at("sink_2")->tick_count(), 3);
+  EXPECT_EQ(evaluators.at("sink_1")->tick_count(), 1);
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * out_2,
+                           runtime->queue_manager().GetQueueByName("out_2"));
+  EXPECT_THAT(out_2->Read(), Optional(Value(UBits(42, 32))));
+
+  // Resetting the state retries every proc.
+  runtime->ResetState();
+  XLS_ASSERT_OK(runtime->Tick());
+  for (int64_t i = 0; i < kSinkCount; ++i) {
+    EXPECT_GT(evaluators.at(absl::StrCat("sink_", i))->tick_count(), 1);
+  }
+}
+
+TEST_F(SerialProcRuntimeSchedulingTest, ProcsBlockedOnGeneratorsAreRetried) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           ParsePackage(SinkPackageIr()));
+  absl::flat_hash_map<std::string, CountingProcEvaluator*> evaluators;
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SerialProcRuntime> runtime,
+                           CreateCountingRuntime(package.get(), evaluators));
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * in_0,
+                           runtime->queue_manager().GetQueueByName("in_0"));
+  // The generator produces no values for the first few reads.
+  int64_t read_count = 0;
+  XLS_ASSERT_OK(in_0->AttachGenerator([&]() -> std::optional<Value> {
+    if (++read_count < 3) {
+      return std::nullopt;
+    }
+    return Value(UBits(read_count, 32));
+  }));
+  for (int64_t i = 0; i < 3; ++i) {
+    XLS_ASSERT_OK(runtime->Tick());
+  }
+  EXPECT_EQ(evaluators.at("sink_0")->tick_count(), 4);
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * out_0,
+                           runtime->queue_manager().GetQueueByName("out_0"));
+  EXPECT_THAT(out_0->Read(), Optional(Value(UBits(3, 32))));
+}
+
+TEST_F(SerialProcRuntimeSchedulingTest, AttachingGeneratorWakesBlockedProc) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           ParsePackage(SinkPackageIr()));
+  absl::flat_hash_map<std::string, CountingProcEvaluator*> evaluators;
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SerialProcRuntime> runtime,
+                           CreateCountingRuntime(package.get(), evaluators));
+
+  // The sinks block on their empty input channels.
+  XLS_ASSERT_OK(runtime->Tick());
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_EQ(evaluators.at("sink_1")->tick_count(), 1);
+
+  // Attaching a generator to the input of a blocked sink wakes it.
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * in_1,
+                           runtime->queue_manager().GetQueueByName("in_1"));
+  XLS_ASSERT_OK(in_1->AttachGenerator(
+      []() -> std::optional<Value> { return Value(UBits(7, 32)); }));
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_GT(evaluators.at("sink_1")->tick_count(), 1);
+  EXPECT_EQ(evaluators.at("sink_2")->tick_count(), 1);
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * out_1,
+                           runtime->queue_manager().GetQueueByName("out_1"));
+  EXPECT_THAT(out_1->Read(), Optional(Value(UBits(7, 32))));
+}
+
+TEST_F(SerialProcRuntimeSchedulingTest, BoundedQueueBackpressure) {
+  // `producer` sends three values per tick to `consumer` through a channel
+  // holding a single element. `consumer` forwards one value per tick.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           ParsePackage(R"(
+package backpressure
+
+chan mid(bits[32], id=0, kind=streaming, ops=send_receive, flow_control=ready_valid, metadata="")
+chan out(bits[32], id=1, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="")
+
+proc producer(tkn: token, st: bits[32], init={0}) {
+  one: bits[32] = literal(value=1)
+  snd0: token = send(tkn, st, channel_id=0)
+  v1: bits[32] = add(st, one)
+  snd1: token = send(snd0, v1, channel_id=0)
+  v2: bits[32] = add(v1, one)
+  snd2: token = send(snd1, v2, channel_id=0)
+  v3: bits[32] = add(v2, one)
+  next (snd2, v3)
+}
+
+proc consumer(tkn: token, st: (), init={()}) {
+  rcv: (token, bits[32]) = receive(tkn, channel_id=0)
+  rcv_tkn: token = tuple_index(rcv, index=0)
+  data: bits[32] = tuple_index(rcv, index=1)
+  snd: token = send(rcv_tkn, data, channel_id=1)
+  next (snd, st)
+}
+)"));
+  absl::flat_hash_map<std::string, CountingProcEvaluator*> evaluators;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<SerialProcRuntime> runtime,
+      CreateCountingRuntime(package.get(), evaluators, {{"mid", 1}}));
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * mid,
+                           runtime->queue_manager().GetQueueByName("mid"));
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * out,
+                           runtime->queue_manager().GetQueueByName("out"));
+
+  constexpr int64_t kTickCount = 10;
+  int64_t expected = 0;
+  for (int64_t i = 0; i < kTickCount; ++i) {
+    XLS_ASSERT_OK(runtime->Tick());
+    EXPECT_LE(mid->GetSize(), 1);
+    // The producer is throttled to the rate of the consumer so exactly one
+    // value arrives per tick, in order.
+    EXPECT_EQ(out->GetSize(), 1);
+    EXPECT_THAT(out->Read(), Optional(Value(UBits(expected++, 32))));
+  }
+}
+
+constexpr char kSingleSinkPackage[] = R"(
+package single_sink
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=none, metadata="")
+chan out(bits[32], id=1, kind=streaming, ops=send_only, flow_control=none, metadata="")
+
+proc sink(tkn: token, st: (), init={()}) {
+  rcv: (token, bits[32]) = receive(tkn, channel_id=0)
+  rcv_tkn: token = tuple_index(rcv, index=0)
+  data: bits[32] = tuple_index(rcv, index=1)
+  snd: token = send(rcv_tkn, data, channel_id=1)
+  next (snd, st)
+}
+)";
+
+TEST_F(SerialProcRuntimeSchedulingTest, SingleJitProcRunsMultipleTicks) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           ParsePackage(kSingleSinkPackage));
+  Proc* proc = package->procs().front().get();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> queue_manager,
+      JitChannelQueueManager::CreateThreadSafe(package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ProcJit> proc_jit,
+      ProcJit::Create(proc, &queue_manager->runtime(), queue_manager.get()));
+  auto counting_evaluator =
+      std::make_unique<CountingProcEvaluator>(std::move(proc_jit));
+  CountingProcEvaluator* evaluator = counting_evaluator.get();
+  std::vector<std::unique_ptr<ProcEvaluator>> evaluators;
+  evaluators.push_back(std::move(counting_evaluator));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<SerialProcRuntime> runtime,
+      SerialProcRuntime::Create(package.get(), std::move(evaluators),
+                                std::move(queue_manager)));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SerialProcRuntime> reference,
+                           CreateInterpreterSerialProcRuntime(package.get()));
+
+  // Both runtimes count the same ticks, but the jitted proc runs all of them
+  // in a single call.
+  for (ProcRuntime* r : {static_cast<ProcRuntime*>(runtime.get()),
+                         static_cast<ProcRuntime*>(reference.get())}) {
+    XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * in,
+                             r->queue_manager().GetQueueByName("in"));
+    for (int64_t i = 0; i < 5; ++i) {
+      XLS_ASSERT_OK(in->Write(Value(UBits(i, 32))));
+    }
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(int64_t reference_ticks,
+                           reference->TickUntilBlocked(/*max_ticks=*/100));
+  EXPECT_THAT(runtime->TickUntilBlocked(/*max_ticks=*/100),
+              IsOkAndHolds(reference_ticks));
+  EXPECT_EQ(evaluator->run_ticks_count(), 1);
+  EXPECT_EQ(evaluator->tick_count(), 0);
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * out,
+                           runtime->queue_manager().GetQueueByName("out"));
+  for (int64_t i = 0; i < 5; ++i) {
+    EXPECT_THAT(out->Read(), Optional(Value(UBits(i, 32))));
+  }
+  EXPECT_TRUE(out->IsEmpty());
+
+  // Blocking again makes no progress.
+  EXPECT_THAT(runtime->TickUntilBlocked(/*max_ticks=*/100), IsOkAndHolds(0));
+
+  // Running out of ticks before blocking is an error as with single ticks.
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * in,
+                           runtime->queue_manager().GetQueueByName("in"));
+  for (int64_t i = 0; i < 5; ++i) {
+    XLS_ASSERT_OK(in->Write(Value(UBits(i, 32))));
+  }
+  EXPECT_THAT(runtime->TickUntilBlocked(/*max_ticks=*/3),
+              StatusIs(absl::StatusCode::kDeadlineExceeded,
+                       HasSubstr("Exceeded limit of 3 ticks")));
+  EXPECT_EQ(evaluator->tick_count(), 0);
+}
+
 // Instantiate and run all the tests in proc_runtime_test_base.cc using
 // proc interpreters.
 INSTANTIATE_TEST_SUITE_P(
@@ -0,0 +1,102 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/binary_ir.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/base/internal/endian.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "zlib.h"
+
+namespace xls {
+namespace {
+
+constexpr int64_t kVersionOffset = kBinaryIrMagic.size();
+constexpr int64_t kSizeOffset = kVersionOffset + sizeof(uint32_t);
+constexpr int64_t kHeaderSize = kSizeOffset + sizeof(uint64_t);
+
+}  // namespace
+
+bool IsBinaryIr(std::string_view contents) {
+  return contents.substr(0, kBinaryIrMagic.size()) == kBinaryIrMagic;
+}
+
+absl::StatusOr<std::string> PackageToBinaryIr(const Package& package) {
+  std::string text = package.DumpIr();
+  uLongf compressed_size = compressBound(text.size());
+  std::string result(kHeaderSize + compressed_size, '\0');
+  result.replace(0, kBinaryIrMagic.size(), kBinaryIrMagic);
+  absl::little_endian::Store32(result.data() + kVersionOffset,
+                               kBinaryIrVersion);
+  absl::little_endian::Store64(result.data() + kSizeOffset, text.size());
+  int zlib_status = compress2(
+      reinterpret_cast<Bytef*>(result.data() + kHeaderSize), &compressed_size,
+      reinterpret_cast<const Bytef*>(text.data()), text.size(),
+      Z_DEFAULT_COMPRESSION);
+  if (zlib_status != Z_OK) {
+    return absl::InternalError(
+        absl::StrFormat("Failed to compress IR of package %s: zlib error %d",
+                        package.name(), zlib_status));
+  }
+  result.resize(kHeaderSize + compressed_size);
+  return result;
+}
+
+absl::StatusOr<std::string> BinaryIrToText(std::string_view contents) {
+  if (!IsBinaryIr(contents) || contents.size() < kHeaderSize) {
+    return absl::InvalidArgumentError("Contents are not binary IR.");
+  }
+  uint32_t version =
+      absl::little_endian::Load32(contents.data() + kVersionOffset);
+  if (version != kBinaryIrVersion) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Unsupported binary IR version %d, expected %d",
+                        version, kBinaryIrVersion));
+  }
+  uint64_t text_size =
+      absl::little_endian::Load64(contents.data() + kSizeOffset);
+  std::string text(text_size, '\0');
+  uLongf uncompressed_size = text_size;
+  int zlib_status = uncompress(
+      reinterpret_cast<Bytef*>(text.data()), &uncompressed_size,
+      reinterpret_cast<const Bytef*>(contents.data() + kHeaderSize),
+      contents.size() - kHeaderSize);
+  if (zlib_status != Z_OK || uncompressed_size != text_size) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Corrupt binary IR: zlib error %d, decompressed %d of %d bytes",
+        zlib_status, uncompressed_size, text_size));
+  }
+  return text;
+}
+
+absl::StatusOr<std::unique_ptr<Package>> ParsePackageTextOrBinary(
+    std::string_view contents, std::optional<std::string_view> filename) {
+  if (!IsBinaryIr(contents)) {
+    return Parser::ParsePackage(contents, filename);
+  }
+  XLS_ASSIGN_OR_RETURN(std::string text, BinaryIrToText(contents));
+  return Parser::ParsePackage(text, filename);
+}
+
+}  // namespace xls
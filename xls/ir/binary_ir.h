@@ -0,0 +1,62 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compact, versioned binary container for serialized IR packages.
+//
+// The format only reduces the size of stored IR. It holds the compressed IR
+// text, so loading it decompresses the text and then parses and verifies it
+// as for IR text; it is somewhat slower to load than IR text, not faster.
+#ifndef XLS_IR_BINARY_IR_H_
+#define XLS_IR_BINARY_IR_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// Layout of the binary IR format. All integers are little-endian.
+//
+//   bytes [0, 8):   magic, kBinaryIrMagic
+//   bytes [8, 12):  format version, kBinaryIrVersion
+//   bytes [12, 20): size in bytes of the uncompressed IR text
+//   bytes [20, ...): the IR text as emitted by Package::DumpIr, compressed
+//                    with zlib
+inline constexpr std::string_view kBinaryIrMagic = "XLSIRBIN";
+inline constexpr uint32_t kBinaryIrVersion = 1;
+
+// Returns whether `contents` starts with the binary IR magic.
+bool IsBinaryIr(std::string_view contents);
+
+// Serializes the package into the binary IR format.
+absl::StatusOr<std::string> PackageToBinaryIr(const Package& package);
+
+// Returns the IR text held in binary IR `contents`.
+absl::StatusOr<std::string> BinaryIrToText(std::string_view contents);
+
+// Parses a package from either binary IR or IR text, as determined by whether
+// `contents` starts with the binary IR magic. `filename` is used as for
+// Parser::ParsePackage.
+absl::StatusOr<std::unique_ptr<Package>> ParsePackageTextOrBinary(
+    std::string_view contents,
+    std::optional<std::string_view> filename = std::nullopt);
+
+}  // namespace xls
+
+#endif  // XLS_IR_BINARY_IR_H_
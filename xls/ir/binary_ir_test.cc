@@ -0,0 +1,81 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/binary_ir.h"
+
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using testing::HasSubstr;
+
+constexpr char kPackageText[] = R"(package test
+
+fn add3(x: bits[32], y: bits[32], z: bits[32]) -> bits[32] {
+  add.1: bits[32] = add(x, y, id=1)
+  ret add.2: bits[32] = add(add.1, z, id=2)
+}
+)";
+
+TEST(BinaryIrTest, RoundTrip) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kPackageText));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary, PackageToBinaryIr(*package));
+  EXPECT_TRUE(IsBinaryIr(binary));
+  EXPECT_FALSE(IsBinaryIr(kPackageText));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string text, BinaryIrToText(binary));
+  EXPECT_EQ(text, package->DumpIr());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> from_binary,
+                           ParsePackageTextOrBinary(binary));
+  EXPECT_EQ(from_binary->DumpIr(), package->DumpIr());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> from_text,
+                           ParsePackageTextOrBinary(kPackageText));
+  EXPECT_EQ(from_text->DumpIr(), package->DumpIr());
+}
+
+TEST(BinaryIrTest, RejectsBadInput) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kPackageText));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary, PackageToBinaryIr(*package));
+
+  EXPECT_THAT(BinaryIrToText(kPackageText),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("not binary IR")));
+
+  std::string bad_version = binary;
+  bad_version[kBinaryIrMagic.size()] = 42;
+  EXPECT_THAT(BinaryIrToText(bad_version),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Unsupported binary IR version 42")));
+
+  std::string truncated = binary.substr(0, binary.size() - 4);
+  EXPECT_THAT(BinaryIrToText(truncated),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Corrupt binary IR")));
+}
+
+}  // namespace
+}  // namespace xls
@@ -109,51 +109,17 @@ Bits Bits::PowerOfTwo(int64_t set_bit_index, int64_t bit_count) {
 
 bool Bits::IsOne() const { return PopCount() == 1 && Get(0); }
 
-int64_t Bits::PopCount() const {
-  int64_t count = 0;
-  for (int64_t i = 0; i < bit_count(); ++i) {
-    if (Get(i)) {
-      ++count;
-    }
-  }
-  return count;
-}
+int64_t Bits::PopCount() const { return bitmap_.PopCount(); }
 
-int64_t Bits::CountLeadingZeros() const {
-  for (int64_t i = 0; i < bit_count(); ++i) {
-    if (Get(bit_count() - 1 - i)) {
-      return i;
-    }
-  }
-  return bit_count();
-}
+int64_t Bits::CountLeadingZeros() const { return bitmap_.CountLeadingZeros(); }
 
-int64_t Bits::CountLeadingOnes() const {
-  for (int64_t i = 0; i < bit_count(); ++i) {
-    if (!Get(bit_count() - 1 - i)) {
-      return i;
-    }
-  }
-  return bit_count();
-}
+int64_t Bits::CountLeadingOnes() const { return bitmap_.CountLeadingOnes(); }
 
 int64_t Bits::CountTrailingZeros() const {
-  for (int64_t i = 0; i < bit_count(); ++i) {
-    if (Get(i)) {
-      return i;
-    }
-  }
-  return bit_count();
+  return bitmap_.CountTrailingZeros();
 }
 
-int64_t Bits::CountTrailingOnes() const {
-  for (int64_t i = 0; i < bit_count(); ++i) {
-    if (!Get(i)) {
-      return i;
-    }
-  }
-  return bit_count();
-}
+int64_t Bits::CountTrailingOnes() const { return bitmap_.CountTrailingOnes(); }
 
 bool Bits::HasSingleRunOfSetBits(int64_t* leading_zero_count,
                                  int64_t* set_bit_count,
@@ -20,12 +20,14 @@
 #include <vector>
 
 #include "absl/container/inlined_vector.h"
+#include "absl/numeric/int128.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "xls/common/bits_util.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/math_util.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "xls/ir/big_int.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/format_preference.h"
@@ -47,6 +49,96 @@ Bits TruncateOrSignExtend(const Bits& bits, int64_t bit_count) {
   return bits.Slice(0, bit_count);
 }
 
+constexpr int64_t kWordBits = 64;
+
+// Returns word `wordno` of `bits`, or zero if the word is beyond the end of
+// `bits`. Equivalent to reading the words of `bits` zero-extended to infinite
+// width.
+uint64_t ZeroExtendedWord(const Bits& bits, int64_t wordno) {
+  const InlineBitmap& bitmap = bits.bitmap();
+  return wordno < bitmap.word_count() ? bitmap.GetWord(wordno) : 0;
+}
+
+// Returns word `wordno` of `bits` sign-extended to infinite width.
+uint64_t SignExtendedWord(const Bits& bits, int64_t wordno) {
+  const InlineBitmap& bitmap = bits.bitmap();
+  const bool negative = bits.bit_count() > 0 && bits.msb();
+  if (wordno >= bitmap.word_count()) {
+    return negative ? ~uint64_t{0} : 0;
+  }
+  uint64_t word = bitmap.GetWord(wordno);
+  const int64_t remainder = bits.bit_count() % kWordBits;
+  if (negative && wordno == bitmap.word_count() - 1 && remainder != 0) {
+    word |= ~Mask(remainder);
+  }
+  return word;
+}
+
+// Returns a Bits value of width `bit_count` whose i-th 64-bit word is
+// `word_fn(i)`. Bits of the last word beyond `bit_count` are ignored.
+template <typename WordFn>
+Bits BitsFromWords(int64_t bit_count, WordFn word_fn) {
+  InlineBitmap bitmap(bit_count);
+  for (int64_t i = 0; i < bitmap.word_count(); ++i) {
+    bitmap.SetWord(i, word_fn(i));
+  }
+  return Bits::FromBitmap(std::move(bitmap));
+}
+
+// Returns lhs + (invert_rhs ? ~rhs : rhs) + carry_in computed limb-wise.
+Bits AddWords(const Bits& lhs, const Bits& rhs, bool invert_rhs,
+              uint64_t carry_in) {
+  uint64_t carry = carry_in;
+  return BitsFromWords(lhs.bit_count(), [&](int64_t i) {
+    uint64_t rhs_word = rhs.bitmap().GetWord(i);
+    absl::uint128 sum = absl::uint128(lhs.bitmap().GetWord(i)) +
+                        (invert_rhs ? ~rhs_word : rhs_word) + carry;
+    carry = absl::Uint128High64(sum);
+    return absl::Uint128Low64(sum);
+  });
+}
+
+// Returns the low `result_bit_count` bits of the product of the operands whose
+// words (extended to infinite width) are given by `lhs_word` and `rhs_word`.
+// Uses schoolbook multiplication on 64-bit limbs.
+template <typename LhsWordFn, typename RhsWordFn>
+Bits MultiplyWords(LhsWordFn lhs_word, RhsWordFn rhs_word,
+                   int64_t result_bit_count) {
+  const int64_t word_count = CeilOfRatio(result_bit_count, kWordBits);
+  absl::InlinedVector<uint64_t, 4> result(word_count, 0);
+  for (int64_t i = 0; i < word_count; ++i) {
+    const uint64_t lhs_limb = lhs_word(i);
+    if (lhs_limb == 0) {
+      continue;
+    }
+    uint64_t carry = 0;
+    for (int64_t j = 0; i + j < word_count; ++j) {
+      absl::uint128 product = absl::uint128(lhs_limb) * rhs_word(j) +
+                              result[i + j] + carry;
+      result[i + j] = absl::Uint128Low64(product);
+      carry = absl::Uint128High64(product);
+    }
+  }
+  return BitsFromWords(result_bit_count,
+                       [&](int64_t i) { return result[i]; });
+}
+
+// Shifts right by `shift_amount`, which must be at most the bit count, with
+// the words of the (infinitely extended) operand given by `word_fn`.
+template <typename WordFn>
+Bits ShiftRightWords(int64_t bit_count, int64_t shift_amount,
+                     WordFn word_fn) {
+  const int64_t word_shift = shift_amount / kWordBits;
+  const int64_t bit_shift = shift_amount % kWordBits;
+  return BitsFromWords(bit_count, [&](int64_t i) {
+    uint64_t word = word_fn(i + word_shift) >> bit_shift;
+    if (bit_shift != 0) {
+      word |= word_fn(i + word_shift + 1) << (kWordBits - bit_shift);
+    }
+    return word;
+  });
+}
+
 }  // namespace
 
 Bits And(const Bits& lhs, const Bits& rhs) {
@@ -55,12 +147,11 @@ Bits And(const Bits& lhs, const Bits& rhs) {
     return UBits(lhs.ToUint64().value() & rhs.ToUint64().value(),
                  lhs.bit_count());
   }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = bytes[i] & rhs_bytes[i];
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  return BitsFromWords(lhs.bit_count(), [&](int64_t i) {
+    uint64_t lhs_word = lhs.bitmap().GetWord(i);
+    uint64_t rhs_word = rhs.bitmap().GetWord(i);
+    return lhs_word & rhs_word;
+  });
 }
 
 Bits NaryAnd(absl::Span<const Bits> operands) {
@@ -79,12 +170,11 @@ Bits Or(const Bits& lhs, const Bits& rhs) {
     uint64_t result = (lhs_int | rhs_int);
     return UBits(result, lhs.bit_count());
   }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = bytes[i] | rhs_bytes[i];
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  return BitsFromWords(lhs.bit_count(), [&](int64_t i) {
+    uint64_t lhs_word = lhs.bitmap().GetWord(i);
+    uint64_t rhs_word = rhs.bitmap().GetWord(i);
+    return lhs_word | rhs_word;
+  });
 }
 
 Bits NaryOr(absl::Span<const Bits> operands) {
@@ -103,12 +193,11 @@ Bits Xor(const Bits& lhs, const Bits& rhs) {
     uint64_t result = (lhs_int ^ rhs_int);
     return UBits(result, lhs.bit_count());
   }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = bytes[i] ^ rhs_bytes[i];
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  return BitsFromWords(lhs.bit_count(), [&](int64_t i) {
+    uint64_t lhs_word = lhs.bitmap().GetWord(i);
+    uint64_t rhs_word = rhs.bitmap().GetWord(i);
+    return lhs_word ^ rhs_word;
+  });
 }
 
 Bits NaryXor(absl::Span<const Bits> operands) {
@@ -126,12 +215,11 @@ Bits Nand(const Bits& lhs, const Bits& rhs) {
                      Mask(lhs.bit_count()),
                  lhs.bit_count());
   }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = ~(bytes[i] & rhs_bytes[i]);
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  return BitsFromWords(lhs.bit_count(), [&](int64_t i) {
+    uint64_t lhs_word = lhs.bitmap().GetWord(i);
+    uint64_t rhs_word = rhs.bitmap().GetWord(i);
+    return ~(lhs_word & rhs_word);
+  });
 }
 
 Bits NaryNand(absl::Span<const Bits> operands) {
@@ -149,12 +237,11 @@ Bits Nor(const Bits& lhs, const Bits& rhs) {
                      Mask(lhs.bit_count()),
                  lhs.bit_count());
   }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = ~(bytes[i] | rhs_bytes[i]);
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  return BitsFromWords(lhs.bit_count(), [&](int64_t i) {
+    uint64_t lhs_word = lhs.bitmap().GetWord(i);
+    uint64_t rhs_word = rhs.bitmap().GetWord(i);
+    return ~(lhs_word | rhs_word);
+  });
 }
 
 Bits NaryNor(absl::Span<const Bits> operands) {
@@ -170,11 +257,8 @@ Bits Not(const Bits& bits) {
     return UBits((~bits.ToUint64().value()) & Mask(bits.bit_count()),
                  bits.bit_count());
   }
-  std::vector<uint8_t> bytes = bits.ToBytes();
-  for (uint8_t& byte : bytes) {
-    byte = ~byte;
-  }
-  return Bits::FromBytes(bytes, bits.bit_count());
+  return BitsFromWords(bits.bit_count(),
+                       [&](int64_t i) { return ~bits.bitmap().GetWord(i); });
 }
 
 Bits AndReduce(const Bits& operand) {
@@ -200,10 +284,7 @@ Bits Add(const Bits& lhs, const Bits& rhs) {
     uint64_t result = (lhs_int + rhs_int) & Mask(lhs.bit_count());
     return UBits(result, lhs.bit_count());
   }
-
-  Bits sum = BigInt::Add(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
-                 .ToSignedBits();
-  return TruncateOrSignExtend(sum, lhs.bit_count());
+  return AddWords(lhs, rhs, /*invert_rhs=*/false, /*carry_in=*/0);
 }
 
 Bits Sub(const Bits& lhs, const Bits& rhs) {
@@ -214,9 +295,8 @@ Bits Sub(const Bits& lhs, const Bits& rhs) {
     uint64_t result = (lhs_int - rhs_int) & Mask(lhs.bit_count());
     return UBits(result, lhs.bit_count());
   }
-  Bits diff = BigInt::Sub(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
-                  .ToSignedBits();
-  return TruncateOrSignExtend(diff, lhs.bit_count());
+  // lhs - rhs == lhs + ~rhs + 1.
+  return AddWords(lhs, rhs, /*invert_rhs=*/true, /*carry_in=*/1);
 }
 
 Bits SMul(const Bits& lhs, const Bits& rhs) {
@@ -227,10 +307,10 @@ Bits SMul(const Bits& lhs, const Bits& rhs) {
     int64_t result = lhs_int * rhs_int;
     return SBits(result, result_width);
   }
-
-  BigInt product =
-      BigInt::Mul(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs));
-  return product.ToSignedBitsWithBitCount(result_width).value();
+  // The product of the sign-extended operands truncated to the result width.
+  return MultiplyWords(
+      [&](int64_t i) { return SignExtendedWord(lhs, i); },
+      [&](int64_t i) { return SignExtendedWord(rhs, i); }, result_width);
 }
 
 Bits UMul(const Bits& lhs, const Bits& rhs) {
@@ -241,16 +321,19 @@ Bits UMul(const Bits& lhs, const Bits& rhs) {
     uint64_t result = lhs_int * rhs_int;
     return UBits(result, result_width);
   }
-
-  BigInt product =
-      BigInt::Mul(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
-  return product.ToUnsignedBitsWithBitCount(result_width).value();
+  return MultiplyWords(
+      [&](int64_t i) { return ZeroExtendedWord(lhs, i); },
+      [&](int64_t i) { return ZeroExtendedWord(rhs, i); }, result_width);
 }
 
 Bits UDiv(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits::AllOnes(lhs.bit_count());
   }
+  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
+    return UBits(lhs.ToUint64().value() / rhs.ToUint64().value(),
+                 lhs.bit_count());
+  }
   BigInt quotient =
       BigInt::Div(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
   return ZeroExtend(quotient.ToUnsignedBits(), lhs.bit_count());
@@ -260,6 +343,10 @@ Bits UMod(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits(rhs.bit_count());
   }
+  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
+    return UBits(lhs.ToUint64().value() % rhs.ToUint64().value(),
+                 rhs.bit_count());
+  }
   BigInt modulo =
       BigInt::Mod(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
   return ZeroExtend(modulo.ToUnsignedBits(), rhs.bit_count());
@@ -279,6 +366,14 @@ Bits SDiv(const Bits& lhs, const Bits& rhs) {
     // 0b0111...111.
     return ZeroExtend(Bits::AllOnes(lhs.bit_count() - 1), lhs.bit_count());
   }
+  // Operands narrower than 64 bits cannot overflow int64_t division. The
+  // quotient may not fit in the result width (e.g. -128 / -1 for 8-bit
+  // operands), in which case it is truncated as in the wide path.
+  if (lhs.bit_count() < 64 && rhs.bit_count() < 64) {
+    int64_t quotient = lhs.ToInt64().value() / rhs.ToInt64().value();
+    return UBits(static_cast<uint64_t>(quotient) & Mask(lhs.bit_count()),
+                 lhs.bit_count());
+  }
   BigInt quotient =
       BigInt::Div(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs));
   return TruncateOrSignExtend(quotient.ToSignedBits(), lhs.bit_count());
@@ -288,6 +383,11 @@ Bits SMod(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits(rhs.bit_count());
   }
+  if (lhs.bit_count() < 64 && rhs.bit_count() < 64) {
+    int64_t modulo = lhs.ToInt64().value() % rhs.ToInt64().value();
+    return UBits(static_cast<uint64_t>(modulo) & Mask(rhs.bit_count()),
+                 rhs.bit_count());
+  }
   BigInt modulo = BigInt::Mod(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs));
   return TruncateOrSignExtend(modulo.ToSignedBits(), rhs.bit_count());
 }
@@ -346,6 +446,9 @@ bool ULessThan(const Bits& lhs, int64_t rhs) {
 }
 
 bool SEqual(const Bits& lhs, const Bits& rhs) {
+  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
+    return lhs.ToInt64().value() == rhs.ToInt64().value();
+  }
   return BigInt::MakeSigned(lhs) == BigInt::MakeSigned(rhs);
 }
 
@@ -391,15 +494,23 @@ bool SLessThan(const Bits& lhs, int64_t rhs) {
 Bits ZeroExtend(const Bits& bits, int64_t new_bit_count) {
   XLS_CHECK_GE(new_bit_count, 0);
   XLS_CHECK_GE(new_bit_count, bits.bit_count());
-  return Concat({UBits(0, new_bit_count - bits.bit_count()), bits});
+  if (new_bit_count <= 64) {
+    return UBits(bits.ToUint64().value(), new_bit_count);
+  }
+  return BitsFromWords(new_bit_count,
+                       [&](int64_t i) { return ZeroExtendedWord(bits, i); });
 }
 
 Bits SignExtend(const Bits& bits, int64_t new_bit_count) {
   XLS_CHECK_GE(new_bit_count, 0);
   XLS_CHECK_GE(new_bit_count, bits.bit_count());
-  const int64_t ext_width = new_bit_count - bits.bit_count();
-  return Concat(
-      {bits.msb() ? Bits::AllOnes(ext_width) : Bits(ext_width), bits});
+  if (new_bit_count <= 64) {
+    return UBits(static_cast<uint64_t>(bits.ToInt64().value()) &
+                     Mask(new_bit_count),
+                 new_bit_count);
+  }
+  return BitsFromWords(new_bit_count,
+                       [&](int64_t i) { return SignExtendedWord(bits, i); });
 }
 
 Bits Concat(absl::Span<const Bits> inputs) {
@@ -421,8 +532,9 @@ Bits Negate(const Bits& bits) {
     return UBits((-bits.ToInt64().value()) & Mask(bits.bit_count()),
                  bits.bit_count());
   }
-  Bits negated = BigInt::Negate(BigInt::MakeSigned(bits)).ToSignedBits();
-  return TruncateOrSignExtend(negated, bits.bit_count());
+  // -x == ~x + 1.
+  return AddWords(Bits(bits.bit_count()), bits, /*invert_rhs=*/true,
+                  /*carry_in=*/1);
 }
 
 Bits Abs(const Bits& bits) {
@@ -432,23 +544,55 @@ Bits Abs(const Bits& bits) {
 Bits ShiftLeftLogical(const Bits& bits, int64_t shift_amount) {
   XLS_CHECK_GE(shift_amount, 0);
   shift_amount = std::min(shift_amount, bits.bit_count());
-  return Concat(
-      {bits.Slice(0, bits.bit_count() - shift_amount), UBits(0, shift_amount)});
+  if (bits.bit_count() <= 64) {
+    uint64_t value = shift_amount == 64 ? 0
+                                        : bits.ToUint64().value()
+                                              << shift_amount;
+    return UBits(value & Mask(bits.bit_count()), bits.bit_count());
+  }
+  const int64_t word_shift = shift_amount / kWordBits;
+  const int64_t bit_shift = shift_amount % kWordBits;
+  return BitsFromWords(bits.bit_count(), [&](int64_t i) {
+    if (i < word_shift) {
+      return uint64_t{0};
+    }
+    uint64_t word = bits.bitmap().GetWord(i - word_shift) << bit_shift;
+    if (bit_shift != 0 && i > word_shift) {
+      word |= bits.bitmap().GetWord(i - word_shift - 1) >>
+              (kWordBits - bit_shift);
+    }
+    return word;
+  });
 }
 
 Bits ShiftRightLogical(const Bits& bits, int64_t shift_amount) {
   XLS_CHECK_GE(shift_amount, 0);
   shift_amount = std::min(shift_amount, bits.bit_count());
-  return Concat({UBits(0, shift_amount),
-                 bits.Slice(shift_amount, bits.bit_count() - shift_amount)});
+  if (bits.bit_count() <= 64) {
+    uint64_t value = shift_amount == 64 ? 0
+                                        : bits.ToUint64().value() >>
+                                              shift_amount;
+    return UBits(value, bits.bit_count());
+  }
+  return ShiftRightWords(bits.bit_count(), shift_amount, [&](int64_t i) {
+    return ZeroExtendedWord(bits, i);
+  });
 }
 
 Bits ShiftRightArith(const Bits& bits, int64_t shift_amount) {
   XLS_CHECK_GE(shift_amount, 0);
   shift_amount = std::min(shift_amount, bits.bit_count());
-  return Concat(
-      {bits.msb() ? Bits::AllOnes(shift_amount) : UBits(0, shift_amount),
-       bits.Slice(shift_amount, bits.bit_count() - shift_amount)});
+  if (bits.bit_count() <= 64) {
+    // Shifting the sign-extended value by up to 63 bits fills with the sign
+    // bit; a shift by 64 gives the same result as a shift by 63.
+    int64_t value =
+        bits.ToInt64().value() >> std::min<int64_t>(shift_amount, 63);
+    return UBits(static_cast<uint64_t>(value) & Mask(bits.bit_count()),
+                 bits.bit_count());
+  }
+  return ShiftRightWords(bits.bit_count(), shift_amount, [&](int64_t i) {
+    return SignExtendedWord(bits, i);
+  });
 }
 
 Bits OneHotLsbToMsb(const Bits& bits) {
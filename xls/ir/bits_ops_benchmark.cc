@@ -0,0 +1,85 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks for bits_ops across operand widths, covering both the
+// single-word fast paths and the limb-wise wide implementations.
+
+#include <cstdint>
+#include <random>
+
+#include "include/benchmark/benchmark.h"
+#include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+
+namespace xls {
+namespace {
+
+Bits RandomBits(int64_t bit_count, std::mt19937_64& rng) {
+  InlineBitmap bitmap(bit_count);
+  for (int64_t i = 0; i < bitmap.word_count(); ++i) {
+    bitmap.SetWord(i, rng());
+  }
+  return Bits::FromBitmap(std::move(bitmap));
+}
+
+template <typename OpFn>
+void BM_BinaryOp(benchmark::State& state, OpFn op) {
+  std::mt19937_64 rng;
+  Bits lhs = RandomBits(state.range(0), rng);
+  Bits rhs = RandomBits(state.range(0), rng);
+  // Avoid the divide-by-zero special case.
+  rhs = bits_ops::Or(rhs, UBits(1, state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(op(lhs, rhs));
+  }
+}
+
+template <typename OpFn>
+void BM_ShiftOp(benchmark::State& state, OpFn op) {
+  std::mt19937_64 rng;
+  Bits bits = RandomBits(state.range(0), rng);
+  const int64_t shift_amount = state.range(0) / 3;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(op(bits, shift_amount));
+  }
+}
+
+#define XLS_BITS_OPS_BENCHMARK(kind, op)                                  \
+  BENCHMARK_CAPTURE(BM_##kind, op, &bits_ops::op)                         \
+      ->Arg(8)                                                            \
+      ->Arg(32)                                                           \
+      ->Arg(64)                                                           \
+      ->Arg(65)                                                           \
+      ->Arg(128)                                                          \
+      ->Arg(256)                                                          \
+      ->Arg(1024)
+
+XLS_BITS_OPS_BENCHMARK(BinaryOp, And);
+XLS_BITS_OPS_BENCHMARK(BinaryOp, Or);
+XLS_BITS_OPS_BENCHMARK(BinaryOp, Xor);
+XLS_BITS_OPS_BENCHMARK(BinaryOp, Add);
+XLS_BITS_OPS_BENCHMARK(BinaryOp, Sub);
+XLS_BITS_OPS_BENCHMARK(BinaryOp, UMul);
+XLS_BITS_OPS_BENCHMARK(BinaryOp, SMul);
+XLS_BITS_OPS_BENCHMARK(BinaryOp, UDiv);
+XLS_BITS_OPS_BENCHMARK(BinaryOp, SDiv);
+XLS_BITS_OPS_BENCHMARK(ShiftOp, ShiftLeftLogical);
+XLS_BITS_OPS_BENCHMARK(ShiftOp, ShiftRightLogical);
+XLS_BITS_OPS_BENCHMARK(ShiftOp, ShiftRightArith);
+
+}  // namespace
+}  // namespace xls
+
+BENCHMARK_MAIN();
@@ -15,6 +15,8 @@
 #include "xls/ir/bits_ops.h"
 
 #include <array>
+#include <cstdint>
+#include <random>
 #include <utility>
 #include <vector>
 
@@ -23,6 +25,8 @@
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "xls/common/status/matchers.h"
+#include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/big_int.h"
 #include "xls/ir/bits_test_helpers.h"
 #include "xls/ir/number_parser.h"
 
@@ -634,6 +638,75 @@ TEST(BitsOpsTest, Negate) {
   EXPECT_EQ(bits_ops::Negate(UBits(1, 1234)), SBits(-1, 1234));
 }
 
+// Returns a pseudo-random Bits value of the given width.
+Bits RandomBits(int64_t bit_count, std::mt19937_64* rng) {
+  InlineBitmap bitmap(bit_count);
+  for (int64_t i = 0; i < bitmap.word_count(); ++i) {
+    bitmap.SetWord(i, (*rng)());
+  }
+  return Bits::FromBitmap(std::move(bitmap));
+}
+
+// Checks the limb-wise implementations of wide operations against BigInt.
+TEST(BitsOpsTest, WideOpsMatchBigInt) {
+  std::mt19937_64 rng;
+  for (int64_t bit_count : {65, 100, 128, 129, 200, 256}) {
+    for (int64_t trial = 0; trial < 20; ++trial) {
+      Bits a = RandomBits(bit_count, &rng);
+      Bits b = RandomBits(bit_count, &rng);
+      Bits narrow = RandomBits(37, &rng);
+      BigInt a_unsigned = BigInt::MakeUnsigned(a);
+      BigInt b_unsigned = BigInt::MakeUnsigned(b);
+      BigInt a_signed = BigInt::MakeSigned(a);
+      BigInt b_signed = BigInt::MakeSigned(b);
+
+      EXPECT_EQ(bits_ops::Add(a, b),
+                BigInt::Add(a_unsigned, b_unsigned)
+                    .ToUnsignedBitsWithBitCount(bit_count + 1)
+                    .value()
+                    .Slice(0, bit_count));
+      EXPECT_EQ(bits_ops::Sub(a, b),
+                BigInt::Sub(a_signed, b_signed)
+                    .ToSignedBitsWithBitCount(bit_count + 1)
+                    .value()
+                    .Slice(0, bit_count));
+      EXPECT_EQ(bits_ops::Negate(a),
+                BigInt::Negate(a_signed)
+                    .ToSignedBitsWithBitCount(bit_count + 1)
+                    .value()
+                    .Slice(0, bit_count));
+      EXPECT_EQ(bits_ops::UMul(a, b),
+                BigInt::Mul(a_unsigned, b_unsigned)
+                    .ToUnsignedBitsWithBitCount(2 * bit_count)
+                    .value());
+      EXPECT_EQ(bits_ops::SMul(a, b),
+                BigInt::Mul(a_signed, b_signed)
+                    .ToSignedBitsWithBitCount(2 * bit_count)
+                    .value());
+      EXPECT_EQ(bits_ops::SMul(a, narrow),
+                BigInt::Mul(a_signed, BigInt::MakeSigned(narrow))
+                    .ToSignedBitsWithBitCount(bit_count + 37)
+                    .value());
+      EXPECT_EQ(bits_ops::SignExtend(a, bit_count + 100),
+                a_signed.ToSignedBitsWithBitCount(bit_count + 100).value());
+      EXPECT_EQ(bits_ops::ZeroExtend(a, bit_count + 100),
+                a_unsigned.ToUnsignedBitsWithBitCount(bit_count + 100).value());
+
+      int64_t shift = rng() % (bit_count + 1);
+      EXPECT_EQ(bits_ops::ShiftLeftLogical(a, shift),
+                bits_ops::Concat({a.Slice(0, bit_count - shift),
+                                  UBits(0, shift)}));
+      EXPECT_EQ(bits_ops::ShiftRightLogical(a, shift),
+                bits_ops::Concat({UBits(0, shift),
+                                  a.Slice(shift, bit_count - shift)}));
+      EXPECT_EQ(bits_ops::ShiftRightArith(a, shift),
+                bits_ops::Concat(
+                    {a.msb() ? Bits::AllOnes(shift) : UBits(0, shift),
+                     a.Slice(shift, bit_count - shift)}));
+    }
+  }
+}
+
 TEST(BitsOpsTest, OneHot) {
   EXPECT_EQ(bits_ops::OneHotLsbToMsb(Bits(0)), UBits(1, 1));
   EXPECT_EQ(bits_ops::OneHotMsbToLsb(Bits(0)), UBits(1, 1));
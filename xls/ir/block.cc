@@ -262,15 +262,15 @@ absl::Status Block::SetPortNameExactly(std::string_view name, Node* node) {
                             name));
       }
       // Pick a new name for n.
-      n->name_ = UniquifyNodeName(name);
+      n->AssignName(node_name_uniquer().GetUniqueName(name));
       XLS_RET_CHECK_NE(n->GetName(), name);
-      node->name_ = name;
+      node->AssignName(node_name_uniquer().Intern(name));
       return absl::OkStatus();
     }
   }
   // Ensure the name is known by the uniquer.
   UniquifyNodeName(name);
-  node->name_ = name;
+  node->AssignName(node_name_uniquer().Intern(name));
   return absl::OkStatus();
 }
 
@@ -313,7 +313,7 @@ absl::StatusOr<InputPort*> Block::AddInputPort(std::string_view name,
     return absl::InvalidArgumentError(absl::StrFormat(
         "Block %s already contains a port named %s", this->name(), name));
   }
-  InputPort* port = AddNode(std::make_unique<InputPort>(loc, name, type, this));
+  InputPort* port = AddNode(AllocateNode<InputPort>(loc, name, type, this));
   if (name != port->GetName()) {
     // The name uniquer changed the given name of the input port to preserve
     // name uniqueness which means another node with this name may already
@@ -336,7 +336,7 @@ absl::StatusOr<OutputPort*> Block::AddOutputPort(std::string_view name,
         "Block %s already contains a port named %s", this->name(), name));
   }
   OutputPort* port =
-      AddNode(std::make_unique<OutputPort>(loc, operand, name, this));
+      AddNode(AllocateNode<OutputPort>(loc, operand, name, this));
 
   if (name != port->GetName()) {
     // The name uniquer changed the given name of the output port to preserve
@@ -24,10 +24,6 @@
 
 namespace xls {
 
-namespace {
-// Returns the function called directly by the given node. Nodes which call
-// functions include: map, invoke, etc. If the node does not call a function
-// std::nullopt is returned.
 std::optional<Function*> CalledFunction(Node* node) {
   switch (node->op()) {
     case Op::kCountedFor:
@@ -43,6 +39,8 @@ std::optional<Function*> CalledFunction(Node* node) {
   }
 }
 
+namespace {
+
 // Returns the functions called directly by the nodes of the given FunctionBase.
 std::vector<Function*> CalledFunctions(FunctionBase* function_base) {
   absl::flat_hash_set<Function*> called_set;
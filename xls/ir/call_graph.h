@@ -15,6 +15,7 @@
 #ifndef XLS_IR_CALL_GRAPH_H_
 #define XLS_IR_CALL_GRAPH_H_
 
+#include <optional>
 #include <string_view>
 #include <vector>
 
@@ -24,6 +25,11 @@
 
 namespace xls {
 
+// Returns the function called directly by the given node. Nodes which call
+// functions include: map, invoke, etc. If the node does not call a function
+// std::nullopt is returned.
+std::optional<Function*> CalledFunction(Node* node);
+
 // Returns the functions called transitively by the given FunctionBase. Called
 // functions are returned before callee FunctionBases in the returned order. The
 // final element in the returned vector is `function_base`.
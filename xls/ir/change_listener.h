@@ -0,0 +1,59 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_CHANGE_LISTENER_H_
+#define XLS_IR_CHANGE_LISTENER_H_
+
+#include <cstdint>
+
+#include "absl/types/span.h"
+
+namespace xls {
+
+class Node;
+
+// Interface for objects notified of changes to the nodes of a FunctionBase as
+// they happen, e.g. analyses which update their results incrementally. Register
+// with FunctionBase::RegisterChangeListener. Callbacks are invoked after the
+// change is made and must not modify the graph or (un)register listeners.
+//
+// Operand edges set up while a node is constructed, i.e. before it is added to
+// the function, are not reported; NodeAdded is the first notification about a
+// node.
+class ChangeListener {
+ public:
+  virtual ~ChangeListener() = default;
+
+  // `node` was added to the function.
+  virtual void NodeAdded(Node* node) {}
+
+  // `node` is being removed from the function. It no longer has operands
+  // (UserRemoved has been called for each of them) and is destroyed once this
+  // returns.
+  virtual void NodeDeleted(Node* node) {}
+
+  // The operands of `node` at the indices `operand_nos` were `old_operand` and
+  // have been replaced (by node->operand(i) for each index i). Also called for
+  // reordered operands, e.g. by Node::SwapOperands.
+  virtual void OperandChanged(Node* node, Node* old_operand,
+                              absl::Span<const int64_t> operand_nos) {}
+
+  // `user` was added to or removed from the users of `node`.
+  virtual void UserAdded(Node* node, Node* user) {}
+  virtual void UserRemoved(Node* node, Node* user) {}
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_CHANGE_LISTENER_H_
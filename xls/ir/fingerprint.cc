@@ -0,0 +1,444 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/fingerprint.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/numeric/int128.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
+#include "xls/ir/block.h"
+#include "xls/ir/call_graph.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/format_strings.h"
+#include "xls/ir/function.h"
+#include "xls/ir/instantiation.h"
+#include "xls/ir/lsb_or_msb.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/register.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+// The finalizer of SplitMix64.
+uint64_t Mix(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111eb;
+  x ^= x >> 31;
+  return x;
+}
+
+// Returns the key identifying a parameter or port, which its fingerprint
+// covers, or the empty string for other nodes.
+std::string LeafKey(Node* node) {
+  if (node->Is<Param>()) {
+    absl::Span<Param* const> params = node->function_base()->params();
+    return absl::StrCat(
+        "param ", absl::c_find(params, node->As<Param>()) - params.begin());
+  }
+  if (node->Is<InputPort>() || node->Is<OutputPort>()) {
+    return absl::StrCat("port ", node->GetName());
+  }
+  return "";
+}
+
+// Adds the op-specific attributes of `node` which are not operands, and the
+// presence of optional operands.
+void AddAttributes(Node* node, FingerprintBuilder& b) {
+  switch (node->op()) {
+    case Op::kParam:
+    case Op::kInputPort:
+    case Op::kOutputPort:
+      b.Add(LeafKey(node));
+      break;
+    case Op::kLiteral:
+      b.Add(node->As<Literal>()->value().ToString(FormatPreference::kHex));
+      break;
+    case Op::kCountedFor:
+      b.Add(static_cast<uint64_t>(node->As<CountedFor>()->trip_count()));
+      b.Add(static_cast<uint64_t>(node->As<CountedFor>()->stride()));
+      b.Add(node->As<CountedFor>()->body()->name());
+      break;
+    case Op::kDynamicCountedFor:
+      b.Add(node->As<DynamicCountedFor>()->body()->name());
+      break;
+    case Op::kMap:
+      b.Add(node->As<Map>()->to_apply()->name());
+      break;
+    case Op::kInvoke:
+      b.Add(node->As<Invoke>()->to_apply()->name());
+      break;
+    case Op::kTupleIndex:
+      b.Add(static_cast<uint64_t>(node->As<TupleIndex>()->index()));
+      break;
+    case Op::kOneHot:
+      b.Add(uint64_t{node->As<OneHot>()->priority() == LsbOrMsb::kLsb});
+      break;
+    case Op::kSel:
+      b.Add(uint64_t{node->As<Select>()->default_value().has_value()});
+      break;
+    case Op::kSend:
+      b.Add(static_cast<uint64_t>(node->As<Send>()->channel_id()));
+      b.Add(uint64_t{node->As<Send>()->predicate().has_value()});
+      break;
+    case Op::kReceive:
+      b.Add(static_cast<uint64_t>(node->As<Receive>()->channel_id()));
+      b.Add(uint64_t{node->As<Receive>()->predicate().has_value()});
+      b.Add(uint64_t{node->As<Receive>()->is_blocking()});
+      break;
+    case Op::kSignExt:
+    case Op::kZeroExt:
+      b.Add(static_cast<uint64_t>(node->As<ExtendOp>()->new_bit_count()));
+      break;
+    case Op::kBitSlice:
+      b.Add(static_cast<uint64_t>(node->As<BitSlice>()->start()));
+      b.Add(static_cast<uint64_t>(node->As<BitSlice>()->width()));
+      break;
+    case Op::kDynamicBitSlice:
+      b.Add(static_cast<uint64_t>(node->As<DynamicBitSlice>()->width()));
+      break;
+    case Op::kDecode:
+      b.Add(static_cast<uint64_t>(node->As<Decode>()->width()));
+      break;
+    case Op::kArraySlice:
+      b.Add(static_cast<uint64_t>(node->As<ArraySlice>()->width()));
+      break;
+    case Op::kAssert:
+      // Labels only name the assertion in generated code.
+      b.Add(node->As<Assert>()->message());
+      break;
+    case Op::kTrace:
+      b.Add(StepsToXlsFormatString(node->As<Trace>()->format()));
+      break;
+    case Op::kCover:
+      b.Add(node->As<Cover>()->label());
+      break;
+    case Op::kRegisterRead:
+      b.Add(node->As<RegisterRead>()->GetRegister()->name());
+      break;
+    case Op::kRegisterWrite: {
+      const RegisterWrite* write = node->As<RegisterWrite>();
+      b.Add(write->GetRegister()->name());
+      b.Add(uint64_t{write->load_enable().has_value()});
+      b.Add(uint64_t{write->reset().has_value()});
+      break;
+    }
+    case Op::kInstantiationInput:
+      b.Add(node->As<InstantiationInput>()->instantiation()->name());
+      b.Add(node->As<InstantiationInput>()->port_name());
+      break;
+    case Op::kInstantiationOutput:
+      b.Add(node->As<InstantiationOutput>()->instantiation()->name());
+      b.Add(node->As<InstantiationOutput>()->port_name());
+      break;
+    case Op::kMinDelay:
+      b.Add(static_cast<uint64_t>(node->As<MinDelay>()->delay()));
+      break;
+    default:
+      break;
+  }
+}
+
+}  // namespace
+
+std::string FingerprintToString(absl::uint128 fingerprint) {
+  return absl::StrFormat("%016x%016x", absl::Uint128High64(fingerprint),
+                         absl::Uint128Low64(fingerprint));
+}
+
+FingerprintBuilder& FingerprintBuilder::Add(uint64_t value) {
+  lo_ = Mix(lo_ ^ value);
+  hi_ = Mix(hi_ + ((value << 32) | (value >> 32)) + 0x9e3779b97f4a7c15);
+  ++count_;
+  return *this;
+}
+
+FingerprintBuilder& FingerprintBuilder::Add(absl::uint128 value) {
+  Add(absl::Uint128Low64(value));
+  return Add(absl::Uint128High64(value));
+}
+
+FingerprintBuilder& FingerprintBuilder::Add(std::string_view value) {
+  Add(static_cast<uint64_t>(value.size()));
+  // Bytes are packed little-endian regardless of the host.
+  for (int64_t i = 0; i < value.size(); i += 8) {
+    uint64_t word = 0;
+    for (int64_t j = 0; j < 8 && i + j < value.size(); ++j) {
+      word |= uint64_t{static_cast<uint8_t>(value[i + j])} << (8 * j);
+    }
+    Add(word);
+  }
+  return *this;
+}
+
+absl::uint128 FingerprintBuilder::Finish() const {
+  uint64_t lo = Mix(lo_ ^ count_);
+  return absl::MakeUint128(Mix(hi_ ^ lo), lo);
+}
+
+FunctionFingerprinter::FunctionFingerprinter(FunctionBase* f) : f_(f) {
+  for (Node* node : f_->nodes()) {
+    dirty_.insert(node);
+  }
+  f_->RegisterChangeListener(this);
+}
+
+FunctionFingerprinter::~FunctionFingerprinter() {
+  f_->UnregisterChangeListener(this);
+}
+
+void FunctionFingerprinter::NodeAdded(Node* node) { dirty_.insert(node); }
+
+void FunctionFingerprinter::NodeDeleted(Node* node) {
+  // The node has no users, and so no cached user fingerprints depend on it.
+  auto it = node_fingerprints_.find(node);
+  if (it != node_fingerprints_.end()) {
+    node_sum_ -= it->second;
+    node_fingerprints_.erase(it);
+  }
+  dirty_.erase(node);
+  leaf_keys_.erase(node);
+}
+
+void FunctionFingerprinter::OperandChanged(
+    Node* node, Node* old_operand, absl::Span<const int64_t> operand_nos) {
+  InvalidateNode(node);
+}
+
+void FunctionFingerprinter::UserAdded(Node* node, Node* user) {
+  InvalidateNode(user);
+}
+
+void FunctionFingerprinter::UserRemoved(Node* node, Node* user) {
+  InvalidateNode(user);
+}
+
+void FunctionFingerprinter::InvalidateNode(Node* node) {
+  // A node's fingerprint is only cached if its operands' are, so the walk can
+  // stop at users whose fingerprint is not cached.
+  std::vector<Node*> worklist = {node};
+  while (!worklist.empty()) {
+    Node* n = worklist.back();
+    worklist.pop_back();
+    auto it = node_fingerprints_.find(n);
+    if (it == node_fingerprints_.end()) {
+      continue;
+    }
+    node_sum_ -= it->second;
+    node_fingerprints_.erase(it);
+    leaf_keys_.erase(n);
+    dirty_.insert(n);
+    worklist.insert(worklist.end(), n->users().begin(), n->users().end());
+  }
+}
+
+void FunctionFingerprinter::RefreshLeaves() {
+  std::vector<Node*> stale;
+  for (const auto& [node, key] : leaf_keys_) {
+    if (LeafKey(node) != key) {
+      stale.push_back(node);
+    }
+  }
+  for (Node* node : stale) {
+    InvalidateNode(node);
+  }
+}
+
+absl::uint128 FunctionFingerprinter::ComputeNodeFingerprint(Node* node) {
+  FingerprintBuilder b;
+  b.Add(OpToString(node->op()));
+  b.Add(node->GetType()->ToString());
+  b.Add(static_cast<uint64_t>(node->operand_count()));
+  absl::InlinedVector<absl::uint128, 4> operand_fingerprints;
+  for (Node* operand : node->operands()) {
+    operand_fingerprints.push_back(node_fingerprints_.at(operand));
+  }
+  if (OpIsCommutative(node->op())) {
+    absl::c_sort(operand_fingerprints);
+  }
+  for (absl::uint128 operand_fingerprint : operand_fingerprints) {
+    b.Add(operand_fingerprint);
+  }
+  AddAttributes(node, b);
+  ++computed_count_;
+  return b.Finish();
+}
+
+absl::uint128 FunctionFingerprinter::NodeFingerprint(Node* node) {
+  XLS_CHECK_EQ(node->function_base(), f_);
+  RefreshLeaves();
+  return GetOrComputeNodeFingerprint(node);
+}
+
+absl::uint128 FunctionFingerprinter::GetOrComputeNodeFingerprint(Node* node) {
+  // Computes the fingerprints of the uncached nodes in the operand cone of
+  // `node` in post order.
+  std::vector<std::pair<Node*, bool>> stack = {{node, false}};
+  while (!stack.empty()) {
+    auto [n, operands_done] = stack.back();
+    if (node_fingerprints_.contains(n)) {
+      stack.pop_back();
+      continue;
+    }
+    if (!operands_done) {
+      stack.back().second = true;
+      for (Node* operand : n->operands()) {
+        if (!node_fingerprints_.contains(operand)) {
+          stack.push_back({operand, false});
+        }
+      }
+      continue;
+    }
+    stack.pop_back();
+    absl::uint128 fingerprint = ComputeNodeFingerprint(n);
+    node_fingerprints_[n] = fingerprint;
+    node_sum_ += fingerprint;
+    dirty_.erase(n);
+    std::string leaf_key = LeafKey(n);
+    if (!leaf_key.empty()) {
+      leaf_keys_[n] = std::move(leaf_key);
+    }
+  }
+  return node_fingerprints_.at(node);
+}
+
+absl::uint128 FunctionFingerprinter::LocalFingerprint() {
+  RefreshLeaves();
+  std::vector<Node*> dirty(dirty_.begin(), dirty_.end());
+  for (Node* node : dirty) {
+    GetOrComputeNodeFingerprint(node);
+  }
+
+  FingerprintBuilder b;
+  b.Add(static_cast<uint64_t>(f_->node_count()));
+  b.Add(node_sum_);
+  b.Add(static_cast<uint64_t>(f_->params().size()));
+  for (Param* param : f_->params()) {
+    b.Add(GetOrComputeNodeFingerprint(param));
+  }
+  if (f_->IsFunction()) {
+    Function* function = f_->AsFunctionOrDie();
+    b.Add("function");
+    b.Add(function->return_value() == nullptr
+              ? absl::uint128(0)
+              : GetOrComputeNodeFingerprint(function->return_value()));
+    if (function->ForeignFunctionData().has_value()) {
+      b.Add(function->ForeignFunctionData()->code_template());
+    }
+  } else if (f_->IsProc()) {
+    Proc* proc = f_->AsProcOrDie();
+    b.Add("proc");
+    b.Add(GetOrComputeNodeFingerprint(proc->NextToken()));
+    for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
+      b.Add(proc->GetInitValueElement(i).ToString(FormatPreference::kHex));
+      b.Add(GetOrComputeNodeFingerprint(proc->GetNextStateElement(i)));
+    }
+  } else {
+    Block* block = f_->AsBlockOrDie();
+    b.Add("block");
+    for (const Block::Port& port : block->GetPorts()) {
+      b.Add(static_cast<uint64_t>(port.index()));
+      b.Add(Block::PortName(port));
+    }
+    if (block->GetResetPort().has_value()) {
+      b.Add((*block->GetResetPort())->GetName());
+    }
+    for (Register* reg : block->GetRegisters()) {
+      b.Add(reg->ToString());
+    }
+    for (Instantiation* instantiation : block->GetInstantiations()) {
+      b.Add(instantiation->ToString());
+    }
+  }
+  return b.Finish();
+}
+
+FunctionFingerprinter& PackageFingerprinter::GetFunctionFingerprinter(
+    FunctionBase* f) {
+  XLS_CHECK_EQ(f->package(), package_);
+  std::unique_ptr<FunctionFingerprinter>& fingerprinter = fingerprinters_[f];
+  if (fingerprinter == nullptr) {
+    fingerprinter = std::make_unique<FunctionFingerprinter>(f);
+  }
+  return *fingerprinter;
+}
+
+absl::uint128 PackageFingerprinter::FunctionBaseFingerprint(FunctionBase* f) {
+  FingerprintBuilder b;
+  for (FunctionBase* dependent : GetDependentFunctions(f)) {
+    if (dependent != f) {
+      b.Add(dependent->name());
+    }
+    b.Add(GetFunctionFingerprinter(dependent).LocalFingerprint());
+  }
+  return b.Finish();
+}
+
+absl::uint128 PackageFingerprinter::Fingerprint() {
+  std::vector<FunctionBase*> function_bases = package_->GetFunctionBases();
+  std::sort(function_bases.begin(), function_bases.end(),
+            [](FunctionBase* a, FunctionBase* b) {
+              return a->name() < b->name();
+            });
+  FingerprintBuilder b;
+  b.Add(static_cast<uint64_t>(function_bases.size()));
+  for (FunctionBase* f : function_bases) {
+    b.Add(f->name());
+    b.Add(GetFunctionFingerprinter(f).LocalFingerprint());
+  }
+  std::vector<Channel*> channels(package_->channels().begin(),
+                                 package_->channels().end());
+  std::sort(channels.begin(), channels.end(), [](Channel* a, Channel* b) {
+    return a->id() < b->id();
+  });
+  b.Add(static_cast<uint64_t>(channels.size()));
+  for (Channel* channel : channels) {
+    b.Add(channel->ToString());
+  }
+  std::optional<FunctionBase*> top = package_->GetTop();
+  b.Add(top.has_value() ? (*top)->name() : "");
+  return b.Finish();
+}
+
+absl::uint128 NodeFingerprint(Node* node) {
+  return FunctionFingerprinter(node->function_base()).NodeFingerprint(node);
+}
+
+absl::uint128 FunctionBaseFingerprint(FunctionBase* f) {
+  return PackageFingerprinter(f->package()).FunctionBaseFingerprint(f);
+}
+
+absl::uint128 PackageFingerprint(Package* package) {
+  return PackageFingerprinter(package).Fingerprint();
+}
+
+}  // namespace xls
@@ -0,0 +1,171 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Structural fingerprints of IR: stable 128-bit hashes of nodes, function
+// bases and packages which can key caches of results derived from the IR (JIT
+// object code, schedules, optimized IR, ...).
+//
+// Fingerprints are Merkle-style: the fingerprint of a node covers its op, type
+// and attributes and the fingerprints of its operands (in any order for
+// commutative ops). They do not depend on node ids, node names, source
+// locations or the package name, so e.g. IR which round-trips through the
+// parser keeps its fingerprint. They do depend on names which carry meaning:
+// port names, register names, channel ids and the names of functions (which
+// invocations refer to). Parameters are identified by their position.
+//
+// Fingerprints are deterministic across processes and hosts, but are not
+// cryptographic hashes; they are not intended to resist deliberate collisions.
+
+#ifndef XLS_IR_FINGERPRINT_H_
+#define XLS_IR_FINGERPRINT_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/numeric/int128.h"
+#include "absl/types/span.h"
+#include "xls/ir/change_listener.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// Returns the fingerprint as 32 hex digits.
+std::string FingerprintToString(absl::uint128 fingerprint);
+
+// Incrementally computes a fingerprint of a sequence of integers and strings.
+class FingerprintBuilder {
+ public:
+  FingerprintBuilder& Add(uint64_t value);
+  FingerprintBuilder& Add(absl::uint128 value);
+  // Strings are prefixed with their length so distinct sequences of strings
+  // have distinct encodings.
+  FingerprintBuilder& Add(std::string_view value);
+
+  absl::uint128 Finish() const;
+
+ private:
+  uint64_t lo_ = 0x243f6a8885a308d3;
+  uint64_t hi_ = 0x13198a2e03707344;
+  uint64_t count_ = 0;
+};
+
+// Computes the fingerprints of the nodes of a FunctionBase and of the
+// FunctionBase itself and caches them. The cache is kept up to date
+// incrementally: the fingerprinter registers as a change listener of the
+// function and on a change discards only the fingerprints of the changed node
+// and its transitive users.
+//
+// Changes which are not reported to change listeners must be reported with
+// InvalidateNode: those to node attributes other than operands (e.g.
+// Send::ReplaceChannel). Reordering parameters and renaming ports are
+// detected. The fingerprinter must be destroyed before the FunctionBase. Not
+// thread-safe.
+class FunctionFingerprinter : public ChangeListener {
+ public:
+  explicit FunctionFingerprinter(FunctionBase* f);
+  ~FunctionFingerprinter() override;
+
+  FunctionFingerprinter(const FunctionFingerprinter&) = delete;
+  FunctionFingerprinter& operator=(const FunctionFingerprinter&) = delete;
+
+  FunctionBase* function_base() const { return f_; }
+
+  // Returns the fingerprint of `node`, which must belong to the function.
+  absl::uint128 NodeFingerprint(Node* node);
+
+  // Returns the fingerprint of the function base: its kind, interface
+  // (parameters, return value, proc state, block ports and registers, ...)
+  // and all of its nodes, including dead ones. Functions invoked by the nodes
+  // are identified by name only; see FunctionBaseFingerprint for a
+  // fingerprint covering them.
+  absl::uint128 LocalFingerprint();
+
+  // Discards the cached fingerprint of `node` and its transitive users.
+  void InvalidateNode(Node* node);
+
+  // Returns the number of node fingerprints computed so far, for testing.
+  int64_t computed_count() const { return computed_count_; }
+
+  void NodeAdded(Node* node) override;
+  void NodeDeleted(Node* node) override;
+  void OperandChanged(Node* node, Node* old_operand,
+                      absl::Span<const int64_t> operand_nos) override;
+  void UserAdded(Node* node, Node* user) override;
+  void UserRemoved(Node* node, Node* user) override;
+
+ private:
+  // Discards cached fingerprints of parameters and ports whose position or
+  // name changed since they were computed.
+  void RefreshLeaves();
+
+  // Returns the fingerprint of `node`, computing those of the nodes in its
+  // operand cone which are not cached.
+  absl::uint128 GetOrComputeNodeFingerprint(Node* node);
+
+  // Computes the fingerprint of `node` assuming those of its operands are
+  // cached.
+  absl::uint128 ComputeNodeFingerprint(Node* node);
+
+  FunctionBase* f_;
+  absl::flat_hash_map<Node*, absl::uint128> node_fingerprints_;
+  // Nodes whose fingerprint is not cached.
+  absl::flat_hash_set<Node*> dirty_;
+  // The sum of the cached node fingerprints, a fingerprint of the multiset of
+  // all nodes once no node is dirty.
+  absl::uint128 node_sum_ = 0;
+  // The position or name which the cached fingerprint of a parameter or port
+  // was computed with.
+  absl::flat_hash_map<Node*, std::string> leaf_keys_;
+  int64_t computed_count_ = 0;
+};
+
+// Computes fingerprints of the function bases of a package and of the package
+// itself, caching a FunctionFingerprinter per function base. Function bases
+// must not be removed from the package while the PackageFingerprinter exists.
+// Not thread-safe.
+class PackageFingerprinter {
+ public:
+  explicit PackageFingerprinter(Package* package) : package_(package) {}
+
+  // Returns the fingerprinter of `f`, which must belong to the package.
+  FunctionFingerprinter& GetFunctionFingerprinter(FunctionBase* f);
+
+  // Returns the fingerprint of `f` and all the functions it transitively
+  // invokes, i.e. everything the behavior of `f` depends on.
+  absl::uint128 FunctionBaseFingerprint(FunctionBase* f);
+
+  // Returns the fingerprint of the package: all of its function bases (and
+  // their names), its channels and its top.
+  absl::uint128 Fingerprint();
+
+ private:
+  Package* package_;
+  absl::flat_hash_map<FunctionBase*, std::unique_ptr<FunctionFingerprinter>>
+      fingerprinters_;
+};
+
+// One-shot versions of the above.
+absl::uint128 NodeFingerprint(Node* node);
+absl::uint128 FunctionBaseFingerprint(FunctionBase* f);
+absl::uint128 PackageFingerprint(Package* package);
+
+}  // namespace xls
+
+#endif  // XLS_IR_FINGERPRINT_H_
@@ -0,0 +1,182 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/fingerprint.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/numeric/int128.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+class FingerprintTest : public IrTestBase {
+ protected:
+  // Parses `ir` as a package and returns the fingerprint of its top.
+  absl::uint128 TopFingerprint(std::string_view ir) {
+    absl::StatusOr<std::unique_ptr<Package>> p = Parser::ParsePackage(ir);
+    XLS_CHECK_OK(p.status());
+    return FunctionBaseFingerprint((*p)->GetTop().value());
+  }
+};
+
+TEST_F(FingerprintTest, BuilderIsStable) {
+  // Fingerprints must not change across processes, hosts or releases without
+  // a deliberate decision, as they key persistent caches.
+  EXPECT_EQ(FingerprintToString(FingerprintBuilder().Finish()),
+            "0c342374724801c1e9e0033e3badaf36");
+  EXPECT_EQ(FingerprintToString(
+                FingerprintBuilder().Add(uint64_t{42}).Add("xls").Finish()),
+            "a6a7111c08853d3cdb46cb54fb7b4e47");
+  EXPECT_NE(FingerprintBuilder().Add("ab").Add("c").Finish(),
+            FingerprintBuilder().Add("a").Add("bc").Finish());
+}
+
+TEST_F(FingerprintTest, IndependentOfNamesAndIds) {
+  absl::uint128 a = TopFingerprint(R"(
+package a
+
+top fn f(x: bits[32] id=1, y: bits[32] id=2) -> bits[32] {
+  sum: bits[32] = add(x, y, id=3)
+  ret neg: bits[32] = neg(sum, id=4)
+}
+)");
+  absl::uint128 b = TopFingerprint(R"(
+package b
+
+top fn f(p: bits[32] id=10, q: bits[32] id=20) -> bits[32] {
+  add.7: bits[32] = add(q, p, id=7, pos=[(0,1,2)])
+  ret neg.5: bits[32] = neg(add.7, id=5)
+}
+)");
+  EXPECT_EQ(a, b);
+}
+
+TEST_F(FingerprintTest, DependsOnStructure) {
+  auto fingerprint = [&](std::string_view body) {
+    return TopFingerprint(absl::StrCat(R"(
+package p
+
+top fn f(x: bits[32] id=1, y: bits[32] id=2) -> bits[32] {
+  ret r: bits[32] = )",
+                                       body, "\n}\n"));
+  };
+  absl::uint128 x_minus_y = fingerprint("sub(x, y, id=3)");
+  EXPECT_NE(x_minus_y, fingerprint("sub(y, x, id=3)"));
+  EXPECT_NE(x_minus_y, fingerprint("add(x, y, id=3)"));
+  EXPECT_NE(fingerprint("bit_slice(x, start=0, width=32, id=3)"),
+            fingerprint("identity(x, id=3)"));
+  EXPECT_NE(fingerprint("literal(value=1, id=3)"),
+            fingerprint("literal(value=2, id=3)"));
+}
+
+TEST_F(FingerprintTest, CoversCallees) {
+  auto fingerprint = [&](std::string_view callee_op) {
+    return TopFingerprint(absl::StrFormat(R"(
+package p
+
+fn callee(x: bits[32] id=1) -> bits[32] {
+  ret r: bits[32] = %s(x, id=2)
+}
+
+top fn f(y: bits[32] id=3) -> bits[32] {
+  ret r: bits[32] = invoke(y, to_apply=callee, id=4)
+}
+)",
+                                          callee_op));
+  };
+  EXPECT_NE(fingerprint("neg"), fingerprint("not"));
+}
+
+TEST_F(FingerprintTest, IncrementalUpdate) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[32], y: bits[32]) -> bits[32] {
+  a: bits[32] = add(x, y)
+  b: bits[32] = umul(a, y)
+  c: bits[32] = sub(x, y)
+  ret d: bits[32] = and(b, c)
+}
+)",
+                                                       p.get()));
+  FunctionFingerprinter fingerprinter(f);
+  absl::uint128 before = fingerprinter.LocalFingerprint();
+  EXPECT_EQ(fingerprinter.computed_count(), f->node_count());
+  EXPECT_EQ(fingerprinter.LocalFingerprint(), before);
+  EXPECT_EQ(fingerprinter.computed_count(), f->node_count());
+
+  // Only the changed node and its users are recomputed.
+  XLS_ASSERT_OK(FindNode("c", f)->ReplaceOperandNumber(0, FindNode("y", f)));
+  absl::uint128 after = fingerprinter.LocalFingerprint();
+  EXPECT_NE(after, before);
+  EXPECT_EQ(fingerprinter.computed_count(), f->node_count() + 2);
+  EXPECT_EQ(after, FunctionFingerprinter(f).LocalFingerprint());
+  EXPECT_EQ(fingerprinter.NodeFingerprint(FindNode("c", f)),
+            NodeFingerprint(FindNode("c", f)));
+
+  // Adding and removing a node restores the fingerprint.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * neg,
+      f->MakeNode<UnOp>(SourceInfo(), FindNode("a", f), Op::kNeg));
+  EXPECT_NE(fingerprinter.LocalFingerprint(), after);
+  XLS_ASSERT_OK(f->RemoveNode(neg));
+  EXPECT_EQ(fingerprinter.LocalFingerprint(), after);
+
+  // Reordering the parameters is detected.
+  XLS_ASSERT_OK(f->MoveParamToIndex(FindNode("y", f)->As<Param>(), 0));
+  EXPECT_NE(fingerprinter.LocalFingerprint(), after);
+  EXPECT_EQ(fingerprinter.LocalFingerprint(),
+            FunctionFingerprinter(f).LocalFingerprint());
+}
+
+TEST_F(FingerprintTest, Package) {
+  auto fingerprint = [&](std::string_view package_name,
+                         std::string_view top_name) {
+    absl::StatusOr<std::unique_ptr<Package>> p =
+        Parser::ParsePackage(absl::StrFormat(R"(
+package %s
+
+fn g(x: bits[8] id=1) -> bits[8] {
+  ret r: bits[8] = neg(x, id=2)
+}
+
+top fn %s(x: bits[8] id=3) -> bits[8] {
+  ret r: bits[8] = not(x, id=4)
+}
+)",
+                                             package_name, top_name));
+    XLS_CHECK_OK(p.status());
+    return PackageFingerprint(p->get());
+  };
+  EXPECT_EQ(fingerprint("a", "f"), fingerprint("b", "f"));
+  EXPECT_NE(fingerprint("a", "f"), fingerprint("a", "h"));
+}
+
+}  // namespace
+}  // namespace xls
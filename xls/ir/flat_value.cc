@@ -0,0 +1,263 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/flat_value.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_helpers.h"
+
+namespace xls {
+namespace {
+
+constexpr int64_t kWordBits = 64;
+
+int64_t WordCount(int64_t bit_count) {
+  return CeilOfRatio(bit_count, kWordBits);
+}
+
+uint64_t WidthMask(int64_t width) {
+  return width == kWordBits ? ~uint64_t{0} : (uint64_t{1} << width) - 1;
+}
+
+// Reads `width` (at most 64) bits starting at bit `offset` of `words`.
+uint64_t ReadChunk(const uint64_t* words, int64_t offset, int64_t width) {
+  int64_t word = offset / kWordBits;
+  int64_t shift = offset % kWordBits;
+  uint64_t result = words[word] >> shift;
+  if (shift + width > kWordBits) {
+    result |= words[word + 1] << (kWordBits - shift);
+  }
+  return result & WidthMask(width);
+}
+
+// Writes the low `width` (at most 64) bits of `value` starting at bit `offset`
+// of `words`.
+void WriteChunk(uint64_t* words, int64_t offset, int64_t width,
+                uint64_t value) {
+  int64_t word = offset / kWordBits;
+  int64_t shift = offset % kWordBits;
+  uint64_t mask = WidthMask(width);
+  value &= mask;
+  words[word] = (words[word] & ~(mask << shift)) | (value << shift);
+  if (shift + width > kWordBits) {
+    int64_t high_shift = kWordBits - shift;
+    words[word + 1] =
+        (words[word + 1] & ~(mask >> high_shift)) | (value >> high_shift);
+  }
+}
+
+void SetValueUnchecked(const MutableFlatValueView& view, const Value& value) {
+  if (value.IsBits()) {
+    view.SetBits(value.bits());
+    return;
+  }
+  for (int64_t i = 0; i < value.size(); ++i) {
+    SetValueUnchecked(view.element(i), value.element(i));
+  }
+}
+
+}  // namespace
+
+absl::Span<uint64_t> FlatValueArena::Allocate(int64_t word_count) {
+  while (current_block_ < static_cast<int64_t>(blocks_.size())) {
+    std::vector<uint64_t>& block = blocks_[current_block_];
+    if (static_cast<int64_t>(block.size()) - current_block_used_ >=
+        word_count) {
+      absl::Span<uint64_t> result =
+          absl::MakeSpan(block).subspan(current_block_used_, word_count);
+      std::fill(result.begin(), result.end(), 0);
+      current_block_used_ += word_count;
+      return result;
+    }
+    ++current_block_;
+    current_block_used_ = 0;
+  }
+  blocks_.emplace_back(std::max(block_word_count_, word_count), 0);
+  current_block_used_ = word_count;
+  return absl::MakeSpan(blocks_.back()).subspan(0, word_count);
+}
+
+void FlatValueArena::Reset() {
+  current_block_ = 0;
+  current_block_used_ = 0;
+}
+
+int64_t FlatValueView::size() const {
+  if (type_->IsTuple()) {
+    return type_->AsTupleOrDie()->size();
+  }
+  XLS_CHECK(type_->IsArray()) << type_->ToString();
+  return type_->AsArrayOrDie()->size();
+}
+
+int64_t FlatValueView::ElementOffset(int64_t index) const {
+  if (type_->IsArray()) {
+    ArrayType* array_type = type_->AsArrayOrDie();
+    XLS_CHECK_LT(index, array_type->size());
+    return (array_type->size() - 1 - index) *
+           array_type->element_type()->GetFlatBitCount();
+  }
+  TupleType* tuple_type = type_->AsTupleOrDie();
+  XLS_CHECK_LT(index, tuple_type->size());
+  int64_t leading_bits = 0;
+  for (int64_t i = 0; i <= index; ++i) {
+    leading_bits += tuple_type->element_type(i)->GetFlatBitCount();
+  }
+  return bit_count_ - leading_bits;
+}
+
+FlatValueView FlatValueView::element(int64_t index) const {
+  Type* element_type = type_->IsArray()
+                           ? type_->AsArrayOrDie()->element_type()
+                           : type_->AsTupleOrDie()->element_type(index);
+  return FlatValueView(element_type, words_,
+                       bit_offset_ + ElementOffset(index));
+}
+
+Bits FlatValueView::GetBits() const {
+  std::vector<uint8_t> bytes(CeilOfRatio(bit_count_, int64_t{8}));
+  for (int64_t i = 0; i < bit_count_; i += kWordBits) {
+    uint64_t chunk = ReadChunk(words_, bit_offset_ + i,
+                               std::min(kWordBits, bit_count_ - i));
+    int64_t byte_index = i / 8;
+    std::memcpy(bytes.data() + byte_index, &chunk,
+                std::min<int64_t>(sizeof(chunk), bytes.size() - byte_index));
+  }
+  return Bits::FromBytes(bytes, bit_count_);
+}
+
+Value FlatValueView::ToValue() const {
+  switch (type_->kind()) {
+    case TypeKind::kBits:
+      return Value(GetBits());
+    case TypeKind::kToken:
+      return Value::Token();
+    case TypeKind::kTuple: {
+      std::vector<Value> elements;
+      elements.reserve(size());
+      for (int64_t i = 0; i < size(); ++i) {
+        elements.push_back(element(i).ToValue());
+      }
+      return Value::TupleOwned(std::move(elements));
+    }
+    case TypeKind::kArray: {
+      std::vector<Value> elements;
+      elements.reserve(size());
+      for (int64_t i = 0; i < size(); ++i) {
+        elements.push_back(element(i).ToValue());
+      }
+      return Value::ArrayOwned(std::move(elements));
+    }
+  }
+  XLS_LOG(FATAL) << "Invalid type kind: " << type_->ToString();
+}
+
+bool FlatValueView::operator==(const FlatValueView& other) const {
+  if (!type_->IsEqualTo(other.type_)) {
+    return false;
+  }
+  for (int64_t i = 0; i < bit_count_; i += kWordBits) {
+    int64_t width = std::min(kWordBits, bit_count_ - i);
+    if (ReadChunk(words_, bit_offset_ + i, width) !=
+        ReadChunk(other.words_, other.bit_offset_ + i, width)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+MutableFlatValueView MutableFlatValueView::element(int64_t index) const {
+  FlatValueView element_view = FlatValueView::element(index);
+  return MutableFlatValueView(element_view.type(), mutable_words(),
+                              bit_offset_ + ElementOffset(index));
+}
+
+void MutableFlatValueView::SetBits(const Bits& bits) const {
+  XLS_CHECK_EQ(bits.bit_count(), bit_count_);
+  for (int64_t i = 0; i < bit_count_; i += kWordBits) {
+    WriteChunk(mutable_words(), bit_offset_ + i,
+               std::min(kWordBits, bit_count_ - i),
+               bits.WordToUint64(i / kWordBits).value());
+  }
+}
+
+absl::Status MutableFlatValueView::SetValue(const Value& value) const {
+  if (!ValueConformsToType(value, type_)) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Value %s does not conform to type %s",
+                        value.ToString(), type_->ToString()));
+  }
+  SetValueUnchecked(*this, value);
+  return absl::OkStatus();
+}
+
+void MutableFlatValueView::CopyFrom(const FlatValueView& other) const {
+  XLS_CHECK_EQ(other.bit_count(), bit_count_);
+  for (int64_t i = 0; i < bit_count_; i += kWordBits) {
+    int64_t width = std::min(kWordBits, bit_count_ - i);
+    WriteChunk(mutable_words(), bit_offset_ + i, width,
+               ReadChunk(other.words_, other.bit_offset_ + i, width));
+  }
+}
+
+FlatValue::FlatValue(Type* type, FlatValueArena* arena) : type_(type) {
+  AllocateStorage(arena);
+}
+
+void FlatValue::AllocateStorage(FlatValueArena* arena) {
+  int64_t word_count = WordCount(type_->GetFlatBitCount());
+  if (arena != nullptr) {
+    words_ = arena->Allocate(word_count).data();
+  } else {
+    owned_words_.assign(word_count, 0);
+    words_ = owned_words_.data();
+  }
+}
+
+absl::StatusOr<FlatValue> FlatValue::FromValue(const Value& value, Type* type,
+                                               FlatValueArena* arena) {
+  FlatValue result(type, arena);
+  XLS_RETURN_IF_ERROR(result.mutable_view().SetValue(value));
+  return result;
+}
+
+FlatValue::FlatValue(const FlatValue& other) : type_(other.type_) {
+  AllocateStorage(/*arena=*/nullptr);
+  std::copy_n(other.words_, owned_words_.size(), words_);
+}
+
+FlatValue& FlatValue::operator=(const FlatValue& other) {
+  if (this != &other) {
+    type_ = other.type_;
+    AllocateStorage(/*arena=*/nullptr);
+    std::copy_n(other.words_, owned_words_.size(), words_);
+  }
+  return *this;
+}
+
+}  // namespace xls
@@ -0,0 +1,176 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Flat, contiguous representation of XLS IR values.
+//
+// An xls::Value stores each element of a tuple or array as a separate Value,
+// which costs a heap allocation per element and gives poor locality for large
+// aggregates. A FlatValue instead holds a Type* and one contiguous bit buffer
+// in the layout of Value::FlattenTo: the first element of a tuple or array
+// occupies the most significant bits. Elements are accessed through cheap,
+// non-owning views. Like ValueView (value_view.h) these overlay value
+// semantics on a flat buffer, but the type is given at run time rather than as
+// template arguments.
+#ifndef XLS_IR_FLAT_VALUE_H_
+#define XLS_IR_FLAT_VALUE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// A bump allocator for FlatValue buffers. Buffers allocated from an arena are
+// valid until the arena is reset or destroyed. Useful for building many
+// short-lived FlatValues without a heap allocation each.
+class FlatValueArena {
+ public:
+  explicit FlatValueArena(int64_t block_word_count = 4096)
+      : block_word_count_(block_word_count) {}
+
+  // Returns a zero-filled buffer of `word_count` words.
+  absl::Span<uint64_t> Allocate(int64_t word_count);
+
+  // Releases all buffers for reuse. The storage of the arena is retained.
+  void Reset();
+
+ private:
+  int64_t block_word_count_;
+  std::vector<std::vector<uint64_t>> blocks_;
+  // Index of the block being allocated from and the words used in it.
+  int64_t current_block_ = 0;
+  int64_t current_block_used_ = 0;
+};
+
+// A read-only view of a value of type `type` in a flat bit buffer starting at
+// bit `bit_offset`.
+class FlatValueView {
+ public:
+  FlatValueView(Type* type, const uint64_t* words, int64_t bit_offset)
+      : type_(type),
+        words_(words),
+        bit_offset_(bit_offset),
+        bit_count_(type->GetFlatBitCount()) {}
+
+  Type* type() const { return type_; }
+  int64_t bit_count() const { return bit_count_; }
+
+  // Returns the number of elements of a tuple or array typed value.
+  int64_t size() const;
+
+  // Returns a view of element `index` of a tuple or array typed value.
+  FlatValueView element(int64_t index) const;
+
+  // Returns the flattened bits of the value. For bits-typed values this is the
+  // value itself.
+  Bits GetBits() const;
+
+  // Returns the value as an xls::Value.
+  Value ToValue() const;
+
+  // Returns whether the two views hold the same type and bits.
+  bool operator==(const FlatValueView& other) const;
+  bool operator!=(const FlatValueView& other) const {
+    return !(*this == other);
+  }
+
+ protected:
+  friend class MutableFlatValueView;
+
+  // Returns the bit offset of element `index` relative to this value.
+  int64_t ElementOffset(int64_t index) const;
+
+  Type* type_;
+  const uint64_t* words_;
+  int64_t bit_offset_;
+  int64_t bit_count_;
+};
+
+// A mutable view of a value in a flat bit buffer.
+class MutableFlatValueView : public FlatValueView {
+ public:
+  MutableFlatValueView(Type* type, uint64_t* words, int64_t bit_offset)
+      : FlatValueView(type, words, bit_offset) {}
+
+  MutableFlatValueView element(int64_t index) const;
+
+  // Sets the flattened bits of the value. `bits` must have the width of the
+  // type.
+  void SetBits(const Bits& bits) const;
+
+  // Sets the value. `value` must conform to the type.
+  absl::Status SetValue(const Value& value) const;
+
+  // Copies the bits of `other` which must have the same flat bit count.
+  void CopyFrom(const FlatValueView& other) const;
+
+ private:
+  uint64_t* mutable_words() const { return const_cast<uint64_t*>(words_); }
+};
+
+// A value of a given type stored in a single contiguous bit buffer. The buffer
+// is owned by the FlatValue or, if an arena is given, by the arena.
+class FlatValue {
+ public:
+  // Constructs a zero value of the given type.
+  explicit FlatValue(Type* type, FlatValueArena* arena = nullptr);
+
+  // Constructs a FlatValue holding `value`, which must conform to `type`.
+  static absl::StatusOr<FlatValue> FromValue(const Value& value, Type* type,
+                                             FlatValueArena* arena = nullptr);
+
+  // Copies always own their buffer.
+  FlatValue(const FlatValue& other);
+  FlatValue& operator=(const FlatValue& other);
+  FlatValue(FlatValue&& other) = default;
+  FlatValue& operator=(FlatValue&& other) = default;
+
+  Type* type() const { return type_; }
+  int64_t bit_count() const { return view().bit_count(); }
+
+  FlatValueView view() const { return FlatValueView(type_, words_, 0); }
+  MutableFlatValueView mutable_view() {
+    return MutableFlatValueView(type_, words_, 0);
+  }
+
+  int64_t size() const { return view().size(); }
+  FlatValueView element(int64_t index) const { return view().element(index); }
+  MutableFlatValueView mutable_element(int64_t index) {
+    return mutable_view().element(index);
+  }
+
+  Value ToValue() const { return view().ToValue(); }
+
+  bool operator==(const FlatValue& other) const {
+    return view() == other.view();
+  }
+  bool operator!=(const FlatValue& other) const { return !(*this == other); }
+
+ private:
+  void AllocateStorage(FlatValueArena* arena);
+
+  Type* type_;
+  std::vector<uint64_t> owned_words_;
+  uint64_t* words_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_FLAT_VALUE_H_
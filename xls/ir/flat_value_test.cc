@@ -0,0 +1,120 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/flat_value.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+TEST(FlatValueTest, ZeroInitialized) {
+  Package p("test");
+  FlatValue value(p.GetBitsType(100));
+  EXPECT_EQ(value.ToValue(), Value(UBits(0, 100)));
+}
+
+TEST(FlatValueTest, RoundTrip) {
+  Package p("test");
+  Value wide(bits_ops::Concat({UBits(0xdeadbeefcafef00d, 64),
+                               UBits(0x123456789, 37)}));
+  Value tuple = Value::Tuple(
+      {Value(UBits(5, 3)), wide, Value::Token(), Value::Tuple({})});
+  XLS_ASSERT_OK_AND_ASSIGN(Value array, Value::Array({tuple, tuple, tuple}));
+  Type* type = p.GetTypeForValue(array);
+
+  XLS_ASSERT_OK_AND_ASSIGN(FlatValue flat, FlatValue::FromValue(array, type));
+  EXPECT_EQ(flat.bit_count(), 3 * (3 + 101));
+  EXPECT_EQ(flat.size(), 3);
+  EXPECT_EQ(flat.ToValue(), array);
+  EXPECT_EQ(flat.element(1).ToValue(), tuple);
+  EXPECT_EQ(flat.element(2).element(1).GetBits(), wide.bits());
+}
+
+TEST(FlatValueTest, LayoutMatchesFlattening) {
+  Package p("test");
+  Value tuple = Value::Tuple({Value(UBits(0x3, 2)), Value(UBits(0x1, 4)),
+                              Value(UBits(0xab, 8))});
+  XLS_ASSERT_OK_AND_ASSIGN(
+      FlatValue flat, FlatValue::FromValue(tuple, p.GetTypeForValue(tuple)));
+  // The first element occupies the most significant bits.
+  EXPECT_EQ(flat.view().GetBits(), UBits(0b11'0001'10101011, 14));
+}
+
+TEST(FlatValueTest, SetElements) {
+  Package p("test");
+  constexpr int64_t kSize = 1000;
+  Type* element_type = p.GetBitsType(13);
+  FlatValue flat(p.GetArrayType(kSize, element_type));
+  for (int64_t i = 0; i < kSize; ++i) {
+    flat.mutable_element(i).SetBits(UBits(i * 7, 13));
+  }
+  for (int64_t i = 0; i < kSize; ++i) {
+    EXPECT_EQ(flat.element(i).GetBits(), UBits(i * 7, 13));
+  }
+  XLS_ASSERT_OK(flat.mutable_element(3).SetValue(Value(UBits(42, 13))));
+  EXPECT_EQ(flat.element(3).GetBits(), UBits(42, 13));
+  EXPECT_EQ(flat.element(2).GetBits(), UBits(14, 13));
+  EXPECT_EQ(flat.element(4).GetBits(), UBits(28, 13));
+
+  EXPECT_THAT(flat.mutable_element(3).SetValue(Value(UBits(42, 12))),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("does not conform")));
+}
+
+TEST(FlatValueTest, CopyAndCompare) {
+  Package p("test");
+  Type* type = p.GetArrayType(4, p.GetBitsType(70));
+  FlatValue a(type);
+  a.mutable_element(1).SetBits(bits_ops::Concat({UBits(1, 6), UBits(2, 64)}));
+  FlatValue b = a;
+  EXPECT_EQ(a, b);
+  b.mutable_element(2).CopyFrom(b.element(1));
+  EXPECT_NE(a, b);
+  EXPECT_EQ(b.element(1), b.element(2));
+  EXPECT_EQ(a.element(1), b.element(2));
+}
+
+TEST(FlatValueTest, Arena) {
+  Package p("test");
+  FlatValueArena arena(/*block_word_count=*/4);
+  Type* type = p.GetBitsType(128);
+  std::vector<FlatValue> values;
+  for (int64_t i = 0; i < 10; ++i) {
+    values.emplace_back(type, &arena);
+    values.back().mutable_view().SetBits(UBits(i, 128));
+  }
+  for (int64_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(values[i].ToValue(), Value(UBits(i, 128)));
+  }
+  values.clear();
+  arena.Reset();
+  FlatValue reused(p.GetBitsType(300), &arena);
+  EXPECT_EQ(reused.ToValue(), Value(UBits(0, 300)));
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,65 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/foreign_function_model.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+
+namespace xls {
+
+absl::Status ForeignFunctionModelRegistry::Register(
+    std::string_view function_name, ForeignFunctionModel model) {
+  if (model.native == nullptr && !model.evaluate) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Model of foreign function `%s` has no implementation",
+        function_name));
+  }
+  absl::MutexLock lock(&mutex_);
+  auto [it, inserted] = models_.try_emplace(
+      function_name,
+      std::make_shared<const ForeignFunctionModel>(std::move(model)));
+  if (!inserted) {
+    return absl::AlreadyExistsError(absl::StrFormat(
+        "A model of foreign function `%s` is already registered",
+        function_name));
+  }
+  return absl::OkStatus();
+}
+
+void ForeignFunctionModelRegistry::Unregister(std::string_view function_name) {
+  absl::MutexLock lock(&mutex_);
+  models_.erase(function_name);
+}
+
+std::shared_ptr<const ForeignFunctionModel> ForeignFunctionModelRegistry::Find(
+    std::string_view function_name) const {
+  absl::MutexLock lock(&mutex_);
+  auto it = models_.find(function_name);
+  return it == models_.end() ? nullptr : it->second;
+}
+
+ForeignFunctionModelRegistry& GetForeignFunctionModelRegistry() {
+  static ForeignFunctionModelRegistry* registry =
+      new ForeignFunctionModelRegistry();
+  return *registry;
+}
+
+}  // namespace xls
@@ -0,0 +1,83 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_FOREIGN_FUNCTION_MODEL_H_
+#define XLS_IR_FOREIGN_FUNCTION_MODEL_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// Native-layout ABI of a C++ simulation model of a foreign function.
+// `args[i]` points to the i-th argument of the function and `result` to the
+// buffer receiving its result, each in the JIT's native layout of its type
+// (see xls/jit/type_layout.h). Bits are stored little-endian and padded with
+// zeros to a power-of-two number of bytes; the model must write all of
+// `result`, padding included. `context` is passed through from registration.
+using NativeForeignFunction = void (*)(const uint8_t* const* args,
+                                       uint8_t* result, void* context);
+
+// A simulation model of a function marked for FFI (i.e. one with
+// ForeignFunctionData), evaluated instead of the function's IR body.
+struct ForeignFunctionModel {
+  // Called by the JIT, which embeds the address in the generated code, so
+  // the function and `context` must outlive any code compiled while the model
+  // is registered. May be null, in which case the JIT compiles the IR body.
+  NativeForeignFunction native = nullptr;
+  void* context = nullptr;
+
+  // Called by the interpreter. May be empty, in which case the interpreter
+  // interprets the IR body. xls/jit/native_foreign_function.h builds it from
+  // `native`.
+  std::function<absl::StatusOr<Value>(absl::Span<const Value> args)> evaluate;
+};
+
+// Registry of foreign function models, by the name of the IR function they
+// model. Thread-safe.
+class ForeignFunctionModelRegistry {
+ public:
+  // Models of functions which are already compiled by the JIT do not apply to
+  // that compiled code.
+  absl::Status Register(std::string_view function_name,
+                        ForeignFunctionModel model);
+  void Unregister(std::string_view function_name);
+
+  // Returns the model of the function of the given name, or null if there is
+  // none.
+  std::shared_ptr<const ForeignFunctionModel> Find(
+      std::string_view function_name) const;
+
+ private:
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::shared_ptr<const ForeignFunctionModel>>
+      models_ ABSL_GUARDED_BY(mutex_);
+};
+
+ForeignFunctionModelRegistry& GetForeignFunctionModelRegistry();
+
+}  // namespace xls
+
+#endif  // XLS_IR_FOREIGN_FUNCTION_MODEL_H_
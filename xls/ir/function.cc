@@ -19,6 +19,7 @@
 #include <string_view>
 #include <vector>
 
+#include "absl/cleanup/cleanup.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
@@ -88,7 +89,6 @@ absl::StatusOr<Function*> Function::Clone(
     std::string_view new_name, Package* target_package,
     const absl::flat_hash_map<const Function*, Function*>& call_remapping)
     const {
-  absl::flat_hash_map<Node*, Node*> original_to_clone;
   if (target_package == nullptr) {
     target_package = package();
   }
@@ -96,21 +96,39 @@ absl::StatusOr<Function*> Function::Clone(
       std::make_unique<Function>(new_name, target_package));
   cloned_function->SetForeignFunctionData(foreign_function_);
 
+  // The clone is a fresh function, so rather than re-uniquing the name of each
+  // node, it takes over the node name uniquer of this function along with the
+  // (already unique) names. Node storage and the mapping to the clones are
+  // allocated up front.
+  cloned_function->ReserveNodes(node_count(), node_arena_.bytes_in_use());
+  cloned_function->BeginCopyingNodeNames(*this);
+  absl::Cleanup end_copying_names = [cloned_function] {
+    cloned_function->EndCopyingNodeNames();
+  };
+  absl::flat_hash_map<Node*, Node*> original_to_clone;
+  original_to_clone.reserve(node_count());
+  auto add_clone = [&](Node* node, Node* clone) {
+    CopyNodeName(node, clone);
+    original_to_clone.emplace(node, clone);
+  };
+
   // Clone parameters over first to maintain order.
   for (Param* param : (const_cast<Function*>(this))->params()) {
-    XLS_ASSIGN_OR_RETURN(
-            original_to_clone[param],
-            param->CloneInNewFunction({}, cloned_function));
+    XLS_ASSIGN_OR_RETURN(Node * clone,
+                         param->CloneInNewFunction({}, cloned_function));
+    add_clone(param, clone);
   }
+  std::vector<Node*> cloned_operands;
   for (Node* node : TopoSort(const_cast<Function*>(this))) {
     if (node->Is<Param>()) {  // Params were already copied.
       continue;
     }
-    std::vector<Node*> cloned_operands;
+    cloned_operands.clear();
     for (Node* operand : node->operands()) {
       cloned_operands.push_back(original_to_clone.at(operand));
     }
 
+    Node* clone;
     switch (node->op()) {
       // Remap CountedFor body.
       case Op::kCountedFor: {
@@ -119,11 +137,10 @@ absl::StatusOr<Function*> Function::Clone(
                              ? call_remapping.at(src->body())
                              : src->body();
         XLS_ASSIGN_OR_RETURN(
-            original_to_clone[node],
-            cloned_function->MakeNodeWithName<CountedFor>(
-                src->loc(), cloned_operands[0],
-                absl::Span<Node*>(cloned_operands).subspan(1),
-                src->trip_count(), src->stride(), body, src->GetName()));
+            clone, cloned_function->MakeNode<CountedFor>(
+                       src->loc(), cloned_operands[0],
+                       absl::Span<Node*>(cloned_operands).subspan(1),
+                       src->trip_count(), src->stride(), body));
         break;
       }
       // Remap Map to_apply.
@@ -132,10 +149,9 @@ absl::StatusOr<Function*> Function::Clone(
         Function* to_apply = call_remapping.contains(src->to_apply())
                                  ? call_remapping.at(src->to_apply())
                                  : src->to_apply();
-        XLS_ASSIGN_OR_RETURN(
-            original_to_clone[node],
-            cloned_function->MakeNodeWithName<Map>(
-                src->loc(), cloned_operands[0], to_apply, src->GetName()));
+        XLS_ASSIGN_OR_RETURN(clone, cloned_function->MakeNode<Map>(
+                                        src->loc(), cloned_operands[0],
+                                        to_apply));
         break;
       }
       // Remap Invoke to_apply.
@@ -144,20 +160,18 @@ absl::StatusOr<Function*> Function::Clone(
         Function* to_apply = call_remapping.contains(src->to_apply())
                                  ? call_remapping.at(src->to_apply())
                                  : src->to_apply();
-        XLS_ASSIGN_OR_RETURN(
-            original_to_clone[node],
-            cloned_function->MakeNodeWithName<Invoke>(
-                src->loc(), cloned_operands, to_apply, src->GetName()));
+        XLS_ASSIGN_OR_RETURN(clone, cloned_function->MakeNode<Invoke>(
+                                        src->loc(), cloned_operands, to_apply));
         break;
       }
       // Default clone.
       default: {
         XLS_ASSIGN_OR_RETURN(
-            original_to_clone[node],
-            node->CloneInNewFunction(cloned_operands, cloned_function));
+            clone, node->CloneInNewFunction(cloned_operands, cloned_function));
         break;
       }
     }
+    add_clone(node, clone);
   }
   XLS_RETURN_IF_ERROR(
       cloned_function->set_return_value(original_to_clone.at(return_value())));
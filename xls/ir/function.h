@@ -56,6 +56,10 @@ class Function : public FunctionBase {
     XLS_RET_CHECK_EQ(n->function_base(), this) << absl::StreamFormat(
         "Return value node %s is not in this function %s (is in function %s)",
         n->GetName(), name(), n->function_base()->name());
+    if (return_value_ != n) {
+      // The return value is placed first in the reverse topological order.
+      NoteGraphChange();
+    }
     return_value_ = n;
     return absl::OkStatus();
   }
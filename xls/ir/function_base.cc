@@ -15,6 +15,8 @@
 #include "xls/ir/function_base.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <iterator>
 #include <memory>
 #include <ostream>
@@ -23,6 +25,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -38,6 +41,20 @@
 
 namespace xls {
 
+void FunctionBase::SetName(std::string_view name) {
+  std::string old_name = std::move(name_);
+  name_ = name;
+  if (package_ != nullptr && IsFunction()) {
+    package_->OnFunctionRenamed(AsFunctionOrDie(), old_name);
+  }
+}
+
+FunctionBase::FunctionBase(std::string_view name, Package* package)
+    : name_(name), package_(package), instance_id_([] {
+        static std::atomic<int64_t> next_instance_id = 0;
+        return next_instance_id++;
+      }()) {}
+
 absl::StatusOr<Param*> FunctionBase::GetParamByName(
     std::string_view param_name) const {
   for (Param* param : params()) {
@@ -61,13 +78,16 @@ absl::StatusOr<int64_t> FunctionBase::GetParamIndex(Param* param) const {
 
 absl::Status FunctionBase::MoveParamToIndex(Param* param, int64_t index) {
   XLS_RET_CHECK_LT(index, params_.size());
-  auto it = std::find(params_.begin(), params_.end(), param);
-  if (it == params_.end()) {
+  // Search from the back as the param is usually a newly added one, so
+  // appending many params (e.g., proc state elements) is linear overall.
+  auto it = std::find(params_.rbegin(), params_.rend(), param);
+  if (it == params_.rend()) {
     return absl::InvalidArgumentError(
         "Given param is not a member of this function base: " +
         param->ToString());
   }
-  params_.erase(it);
+  NoteGraphChange();
+  params_.erase(std::next(it).base());
   params_.insert(params_.begin() + index, param);
   return absl::OkStatus();
 }
@@ -88,6 +108,35 @@ absl::StatusOr<Node*> FunctionBase::GetNode(
       absl::StrFormat("GetNode(%s) failed.", standard_node_name));
 }
 
+int64_t FunctionBase::GetNextNodeId() {
+  if (next_local_node_id_.has_value()) {
+    return (*next_local_node_id_)++;
+  }
+  return package_->GetNextNodeId();
+}
+
+void FunctionBase::ReserveNodeId(int64_t id) {
+  if (next_local_node_id_.has_value()) {
+    next_local_node_id_ = std::max(id + 1, *next_local_node_id_);
+  } else {
+    package_->set_next_node_id(std::max(id + 1, package_->next_node_id()));
+  }
+}
+
+void FunctionBase::BeginLocalNodeIds(int64_t first_id) {
+  XLS_CHECK(!next_local_node_id_.has_value())
+      << "Function " << name() << " is already using local node ids";
+  next_local_node_id_ = first_id;
+}
+
+int64_t FunctionBase::EndLocalNodeIds() {
+  XLS_CHECK(next_local_node_id_.has_value())
+      << "Function " << name() << " is not using local node ids";
+  int64_t next_id = *next_local_node_id_;
+  next_local_node_id_.reset();
+  return next_id;
+}
+
 absl::Status FunctionBase::RemoveNode(Node* node) {
   XLS_RET_CHECK(node->users().empty()) << node->GetName();
   XLS_RET_CHECK(!HasImplicitUse(node)) << node->GetName();
@@ -106,11 +155,51 @@ absl::Status FunctionBase::RemoveNode(Node* node) {
   }
   auto node_it = node_iterators_.find(node);
   XLS_RET_CHECK(node_it != node_iterators_.end());
+  NoteNodeChange(node, /*removed=*/true);
+  for (ChangeListener* listener : change_listeners_) {
+    listener->NodeDeleted(node);
+  }
   nodes_.erase(node_it->second);
   node_iterators_.erase(node_it);
   return absl::OkStatus();
 }
 
+void FunctionBase::RegisterChangeListener(ChangeListener* listener) {
+  XLS_CHECK(!absl::c_linear_search(change_listeners_, listener))
+      << "Change listener already registered with " << name();
+  change_listeners_.push_back(listener);
+}
+
+void FunctionBase::UnregisterChangeListener(ChangeListener* listener) {
+  auto it = absl::c_find(change_listeners_, listener);
+  XLS_CHECK(it != change_listeners_.end())
+      << "Change listener not registered with " << name();
+  change_listeners_.erase(it);
+}
+
+std::optional<absl::Span<const FunctionBase::NodeChange>>
+FunctionBase::ChangesSince(int64_t position) const {
+  XLS_CHECK_LE(position, change_log_position());
+  if (position < change_log_start_) {
+    return std::nullopt;
+  }
+  return absl::MakeConstSpan(change_log_).subspan(position - change_log_start_);
+}
+
+void FunctionBase::NoteNodeChange(Node* node, bool removed) {
+  NoteGraphChange();
+  // Operand edges are also set up while a node is constructed, before it is
+  // added; such nodes are logged once they are added.
+  if (!removed && !node_iterators_.contains(node)) {
+    return;
+  }
+  if (change_log_.size() >= kMaxChangeLogSize) {
+    change_log_start_ += change_log_.size();
+    change_log_.clear();
+  }
+  change_log_.push_back(NodeChange{node, removed});
+}
+
 absl::Status FunctionBase::Accept(DfsVisitor* visitor) {
   for (Node* node : nodes()) {
     if (node->users().empty()) {
@@ -166,6 +255,17 @@ Block* FunctionBase::AsBlockOrDie() {
   return down_cast<Block*>(this);
 }
 
+void FunctionBase::ReserveNodes(int64_t count, int64_t arena_bytes) {
+  node_iterators_.reserve(node_iterators_.size() + count);
+  node_arena_.Reserve(arena_bytes);
+}
+
+void FunctionBase::BeginCopyingNodeNames(const FunctionBase& source) {
+  XLS_CHECK(nodes_.empty()) << name();
+  node_name_uniquer_.CopyFrom(source.node_name_uniquer_);
+  copying_node_names_ = true;
+}
+
 Node* FunctionBase::AddNodeInternal(std::unique_ptr<Node> node) {
   XLS_VLOG(4) << absl::StrFormat("Adding node %s to FunctionBase %s",
                                  node->GetName(), name());
@@ -174,6 +274,10 @@ Node* FunctionBase::AddNodeInternal(std::unique_ptr<Node> node) {
   }
   Node* ptr = node.get();
   node_iterators_[ptr] = nodes_.insert(nodes_.end(), std::move(node));
+  NoteNodeChange(ptr, /*removed=*/false);
+  for (ChangeListener* listener : change_listeners_) {
+    listener->NodeAdded(ptr);
+  }
   return ptr;
 }
 
@@ -15,22 +15,29 @@
 #ifndef XLS_IR_FUNCTION_BASE_H_
 #define XLS_IR_FUNCTION_BASE_H_
 
+#include <cstdint>
 #include <list>
 #include <memory>
 #include <optional>
 #include <ostream>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xls/common/iterator_range.h"
+#include "xls/ir/change_listener.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/foreign_function.h"
 #include "xls/ir/name_uniquer.h"
 #include "xls/ir/node.h"
+#include "xls/ir/node_arena.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/ir/unwrapping_iterator.h"
@@ -47,13 +54,14 @@ class FunctionBase {
   using NodeList = std::list<std::unique_ptr<Node>>;
 
  public:
-  FunctionBase(std::string_view name, Package* package)
-      : name_(name), package_(package) {}
+  FunctionBase(std::string_view name, Package* package);
   virtual ~FunctionBase() = default;
 
   Package* package() const { return package_; }
   const std::string& name() const { return name_; }
-  void SetName(std::string_view name) { name_ = name; }
+  // Renames the function. The package's index of functions by name is kept
+  // up to date.
+  void SetName(std::string_view name);
   std::string qualified_name() const {
     return absl::StrCat(package_->name(), "::", name_);
   }
@@ -105,6 +113,31 @@ class FunctionBase {
     return ptr;
   }
 
+  // Allocates a new node of type NodeT from this function's node arena. The
+  // node is not added to the function; pass it to AddNode of this function (and
+  // no other). Nodes created this way (and via MakeNode) are laid out
+  // contiguously, whereas nodes created with std::make_unique are individual
+  // heap allocations.
+  template <typename NodeT, typename... Args>
+  std::unique_ptr<NodeT> AllocateNode(Args&&... args) {
+    return std::unique_ptr<NodeT>(new (&node_arena_)
+                                      NodeT(std::forward<Args>(args)...));
+  }
+
+  // Returns the memory of the node arena no longer backing any node to the
+  // system, e.g. after a large number of nodes have been removed. Returns the
+  // number of bytes released.
+  int64_t CompactNodeArena() { return node_arena_.ReleaseUnusedSlabs(); }
+
+  // Returns the number of bytes of memory held by the node arena.
+  int64_t node_arena_bytes() const { return node_arena_.bytes_reserved(); }
+
+  // Preallocates room for `count` more nodes which together take
+  // `arena_bytes` bytes of node arena memory, so that adding many nodes at once
+  // (e.g., when cloning a function) does not repeatedly grow the node
+  // bookkeeping and arena.
+  void ReserveNodes(int64_t count, int64_t arena_bytes);
+
   // Creates a new node and adds it to the function. NodeT is the node subclass
   // (e.g., 'Param') and the variadic args are the constructor arguments with
   // the exception of the final FunctionBase* argument. This method verifies the
@@ -112,8 +145,8 @@ class FunctionBase {
   // to the newly constructed node.
   template <typename NodeT, typename... Args>
   absl::StatusOr<NodeT*> MakeNode(Args&&... args) {
-    NodeT* new_node = AddNode(std::make_unique<NodeT>(
-        std::forward<Args>(args)..., /*name=*/"", this));
+    NodeT* new_node = AddNode(
+        AllocateNode<NodeT>(std::forward<Args>(args)..., /*name=*/"", this));
     XLS_RETURN_IF_ERROR(VerifyNode(new_node));
     return new_node;
   }
@@ -121,11 +154,67 @@ class FunctionBase {
   template <typename NodeT, typename... Args>
   absl::StatusOr<NodeT*> MakeNodeWithName(Args&&... args) {
     NodeT* new_node =
-        AddNode(std::make_unique<NodeT>(std::forward<Args>(args)..., this));
+        AddNode(AllocateNode<NodeT>(std::forward<Args>(args)..., this));
     XLS_RETURN_IF_ERROR(VerifyNode(new_node));
     return new_node;
   }
 
+  // Returns a new id for a node of this function. Ids are normally drawn from
+  // the package-wide sequence. Between BeginLocalNodeIds and EndLocalNodeIds
+  // they are instead drawn from a sequence private to this function, which
+  // lets several functions of a package create nodes concurrently.
+  int64_t GetNextNodeId();
+
+  // Notes that `id` is in use so that GetNextNodeId returns larger ids.
+  void ReserveNodeId(int64_t id);
+
+  // Switches this function to function-local node ids starting at `first_id`.
+  void BeginLocalNodeIds(int64_t first_id);
+
+  // Switches this function back to package node ids. Returns one past the
+  // largest local id handed out, i.e., the next local id.
+  int64_t EndLocalNodeIds();
+
+  // Returns a pair which changes whenever the graph of this function changes
+  // (nodes added or removed, operands replaced or reordered, parameters
+  // reordered, return value or proc next state set)
+  // and which is never shared with another FunctionBase, even one later
+  // allocated at the same address. Analyses use this to detect stale results.
+  std::pair<int64_t, int64_t> graph_version() const {
+    return {instance_id_, graph_version_};
+  }
+
+  // An entry in the change log: `node` was added or had its operands changed,
+  // or (if `removed`) was removed from the function. The node pointer of a
+  // removed node must not be dereferenced.
+  struct NodeChange {
+    Node* node;
+    bool removed;
+  };
+
+  // Returns the current end position of the change log. Analyses record this
+  // when computed and later pass it to ChangesSince to update incrementally.
+  int64_t change_log_position() const {
+    return change_log_start_ + static_cast<int64_t>(change_log_.size());
+  }
+
+  // Returns the node changes recorded since `position` in the order they
+  // occurred, or std::nullopt if the log no longer reaches back that far (it
+  // is bounded in size), in which case the caller should recompute from
+  // scratch.
+  std::optional<absl::Span<const NodeChange>> ChangesSince(
+      int64_t position) const;
+
+  // Registers `listener` to be notified of changes to the nodes of this
+  // function until unregistered. The listener must be unregistered before it
+  // is destroyed. Without registered listeners, changes to the graph incur no
+  // notification cost beyond an emptiness check.
+  void RegisterChangeListener(ChangeListener* listener);
+  void UnregisterChangeListener(ChangeListener* listener);
+  absl::Span<ChangeListener* const> change_listeners() const {
+    return change_listeners_;
+  }
+
   // Find a node by its name, as generated by DumpIr.
   absl::StatusOr<Node*> GetNode(std::string_view standard_node_name) const;
 
@@ -145,6 +234,11 @@ class FunctionBase {
     return node_name_uniquer_.GetSanitizedUniqueName(name);
   }
 
+  // The uniquer which interns the names of the nodes of this function (see
+  // Node::GetName).
+  NameUniquer& node_name_uniquer() { return node_name_uniquer_; }
+  const NameUniquer& node_name_uniquer() const { return node_name_uniquer_; }
+
   // Returns whether this FunctionBase is a function, proc, or block.
   bool IsFunction() const;
   bool IsProc() const;
@@ -186,10 +280,79 @@ class FunctionBase {
   // Returns a vector containing the reserved words in the IR.
   static std::vector<std::string> GetIrReservedWords();
 
+  // Support for cloning the nodes of `source` into this function, which must
+  // have no nodes yet, without re-uniquing their (already unique) names.
+  // BeginCopyingNodeNames copies the node name uniquer of `source`; until
+  // EndCopyingNodeNames, nodes are constructed without a name and must be
+  // given the name of the node they are cloned from with CopyNodeName.
+  void BeginCopyingNodeNames(const FunctionBase& source);
+  void EndCopyingNodeNames() { copying_node_names_ = false; }
+  static void CopyNodeName(const Node* original, Node* clone) {
+    clone->name_ = original->name_;
+  }
+
   std::string name_;
   Package* package_;
   std::optional<int64_t> initiation_interval_;
 
+  // Node and NodeIterator maintain the graph version and cached topological
+  // order below.
+  friend class Node;
+  friend class NodeIterator;
+
+  // Records a change to the graph: bumps the graph version and discards the
+  // cached topological orders. Called on any change to the nodes, their
+  // operands or users, the parameter order, the return value or the proc next
+  // state.
+  void NoteGraphChange() {
+    ++graph_version_;
+    absl::MutexLock lock(&topo_order_mutex_);
+    topo_order_.reset();
+    reverse_topo_order_.reset();
+  }
+
+  // Records a change to the graph which also changes the definition of `node`
+  // (see NodeChange) and appends it to the change log.
+  void NoteNodeChange(Node* node, bool removed);
+
+  // Returns whether change listeners should be told about a change to
+  // `node`, i.e. whether there are any and `node` has been added to this
+  // function.
+  bool ShouldNotifyListeners(const Node* node) const {
+    return !change_listeners_.empty() && node_iterators_.contains(node);
+  }
+
+  // Maximum number of entries held in the change log. Older entries are
+  // discarded once it fills up.
+  static constexpr int64_t kMaxChangeLogSize = int64_t{1} << 16;
+
+  // Identifier unique across all FunctionBases created in the process, and a
+  // counter of graph changes; see graph_version().
+  const int64_t instance_id_;
+  int64_t graph_version_ = 0;
+
+  // Log of node changes. `change_log_start_` is the position of the first
+  // retained entry.
+  std::vector<NodeChange> change_log_;
+  int64_t change_log_start_ = 0;
+
+  // Cached results of TopoSort and ReverseTopoSort, or nullptr if not
+  // computed since the graph last changed. Shared with live NodeIterators.
+  // Sorting only reads the graph, so callers may sort an unchanging function
+  // from several threads at once; the mutex serializes filling the cache.
+  absl::Mutex topo_order_mutex_;
+  std::shared_ptr<const std::vector<Node*>> topo_order_
+      ABSL_GUARDED_BY(topo_order_mutex_);
+  std::shared_ptr<const std::vector<Node*>> reverse_topo_order_
+      ABSL_GUARDED_BY(topo_order_mutex_);
+
+  // Next id to hand out while using function-local node ids.
+  std::optional<int64_t> next_local_node_id_;
+
+  // Backing memory for nodes allocated with AllocateNode. Declared before
+  // `nodes_` so that it outlives them.
+  NodeArena node_arena_;
+
   // Store Nodes in std::list as they can be added and removed arbitrarily and
   // we want a stable iteration order. Keep a map from instruction pointer to
   // location in the list for fast lookup.
@@ -198,8 +361,13 @@ class FunctionBase {
 
   std::vector<Param*> params_;
 
+  std::vector<ChangeListener*> change_listeners_;
+
   NameUniquer node_name_uniquer_ =
       NameUniquer(/*separator=*/"__", GetIrReservedWords());
+  // Whether the names passed to node constructors are ignored; see
+  // BeginCopyingNodeNames.
+  bool copying_node_names_ = false;
 
   std::optional<xls::ForeignFunctionData> foreign_function_;
 };
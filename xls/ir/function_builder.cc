@@ -102,7 +102,7 @@ void BuilderBase::SetForeignFunctionData(
 
 template <typename NodeT, typename... Args>
 BValue BuilderBase::AddNode(const SourceInfo& loc, Args&&... args) {
-  last_node_ = function_->AddNode<NodeT>(std::make_unique<NodeT>(
+  last_node_ = function_->AddNode<NodeT>(function_->AllocateNode<NodeT>(
       loc, std::forward<Args>(args)..., function_.get()));
   return CreateBValue(last_node_, loc);
 }
@@ -14,9 +14,20 @@
 
 #include "xls/ir/function.h"
 
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
+#include "xls/ir/change_listener.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/node_iterator.h"
@@ -28,6 +39,9 @@ namespace {
 using status_testing::StatusIs;
 using ::testing::ElementsAre;
 using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+using ::testing::Optional;
+using ::testing::UnorderedElementsAreArray;
 
 class FunctionTest : public IrTestBase {};
 
@@ -80,6 +94,43 @@ TEST_F(FunctionTest, CloneSimpleFunctionToDifferentPackage) {
   EXPECT_EQ(func_clone->package(), new_package.get());
 }
 
+TEST_F(FunctionTest, CloneKeepsNodeNames) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, ParseFunction(R"(
+fn f(x: bits[32], y: bits[32]) -> bits[32] {
+  a: bits[32] = add(x, y)
+  a__1: bits[32] = sub(a, y)
+  neg.5: bits[32] = neg(a__1)
+  ret b: bits[32] = umul(neg.5, a)
+}
+)",
+                                                          p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func_clone, func->Clone("g"));
+  std::vector<std::string> names;
+  for (Node* node : func->nodes()) {
+    names.push_back(node->HasAssignedName() ? node->GetName() : "");
+  }
+  std::vector<std::string> clone_names;
+  for (Node* node : TopoSort(func_clone)) {
+    clone_names.push_back(node->HasAssignedName() ? node->GetName() : "");
+  }
+  EXPECT_THAT(clone_names, UnorderedElementsAreArray(names));
+  EXPECT_EQ(func_clone->param(0)->GetName(), "x");
+  EXPECT_EQ(func_clone->return_value()->GetName(), "b");
+
+  // Names added to the clone later are still unique.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * new_node,
+      func_clone->MakeNodeWithName<UnOp>(
+          SourceInfo(), func_clone->return_value(), Op::kNot, "a"));
+  EXPECT_EQ(new_node->GetName(), "a__2");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * new_param,
+      func_clone->MakeNodeWithName<Param>(SourceInfo(), "y",
+                                          p->GetBitsType(8)));
+  EXPECT_EQ(new_param->GetName(), "y__1");
+}
+
 TEST_F(FunctionTest, DumpIrWhenParamIsRetval) {
   auto p = CreatePackage();
   FunctionBuilder b("f", p.get());
@@ -379,6 +430,103 @@ class TestVisitor : public DfsVisitorWithDefault {
   absl::Status DefaultHandler(Node* node) override { return absl::OkStatus(); }
 };
 
+TEST_F(FunctionTest, ChangeLog) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue add = fb.Add(x, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(add));
+
+  int64_t position = f->change_log_position();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * neg, f->MakeNode<UnOp>(SourceInfo(), y.node(), Op::kNeg));
+  XLS_ASSERT_OK(add.node()->ReplaceOperandNumber(1, neg));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * unused, f->MakeNode<UnOp>(SourceInfo(), x.node(), Op::kNot));
+  XLS_ASSERT_OK(f->RemoveNode(unused));
+
+  std::optional<absl::Span<const FunctionBase::NodeChange>> changes =
+      f->ChangesSince(position);
+  ASSERT_TRUE(changes.has_value());
+  std::vector<std::pair<Node*, bool>> entries;
+  for (const FunctionBase::NodeChange& change : *changes) {
+    entries.push_back({change.node, change.removed});
+  }
+  // Replacing an operand records both the addition and the removal of an
+  // operand edge; removing a node also removes its operand edges first.
+  EXPECT_THAT(entries,
+              ElementsAre(std::pair(neg, false), std::pair(add.node(), false),
+                          std::pair(add.node(), false),
+                          std::pair(unused, false), std::pair(unused, false),
+                          std::pair(unused, true)));
+  EXPECT_THAT(f->ChangesSince(f->change_log_position()),
+              Optional(IsEmpty()));
+}
+
+// Records the notifications it receives as strings.
+class RecordingListener : public ChangeListener {
+ public:
+  void NodeAdded(Node* node) override {
+    events_.push_back(absl::StrCat("added ", node->GetName()));
+  }
+  void NodeDeleted(Node* node) override {
+    events_.push_back(absl::StrCat("deleted ", node->GetName()));
+  }
+  void OperandChanged(Node* node, Node* old_operand,
+                      absl::Span<const int64_t> operand_nos) override {
+    events_.push_back(absl::StrFormat("operand %s %s [%s]", node->GetName(),
+                                      old_operand->GetName(),
+                                      absl::StrJoin(operand_nos, ",")));
+  }
+  void UserAdded(Node* node, Node* user) override {
+    events_.push_back(
+        absl::StrCat("user+ ", node->GetName(), " ", user->GetName()));
+  }
+  void UserRemoved(Node* node, Node* user) override {
+    events_.push_back(
+        absl::StrCat("user- ", node->GetName(), " ", user->GetName()));
+  }
+
+  const std::vector<std::string>& events() const { return events_; }
+
+ private:
+  std::vector<std::string> events_;
+};
+
+TEST_F(FunctionTest, ChangeListener) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue add = fb.Add(x, x, SourceInfo(), "sum");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(add));
+
+  RecordingListener listener;
+  f->RegisterChangeListener(&listener);
+  EXPECT_THAT(f->change_listeners(), ElementsAre(&listener));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Node * neg,
+                           f->MakeNodeWithName<UnOp>(SourceInfo(), y.node(),
+                                                     Op::kNeg, "neg"));
+  ASSERT_TRUE(add.node()->ReplaceOperand(x.node(), y.node()));
+  XLS_ASSERT_OK(add.node()->ReplaceOperandNumber(1, neg));
+  add.node()->SwapOperands(0, 1);
+  XLS_ASSERT_OK(f->RemoveNode(x.node()));
+  EXPECT_THAT(
+      listener.events(),
+      ElementsAre("added neg", "user+ y sum", "user- x sum",
+                  "operand sum x [0,1]", "user+ neg sum",
+                  "operand sum y [1]", "operand sum y [0]",
+                  "operand sum neg [1]", "deleted x"));
+
+  f->UnregisterChangeListener(&listener);
+  EXPECT_THAT(f->change_listeners(), IsEmpty());
+  XLS_ASSERT_OK(
+      f->MakeNode<UnOp>(SourceInfo(), y.node(), Op::kNot).status());
+  EXPECT_EQ(listener.events().size(), 9);
+}
+
 TEST_F(FunctionTest, GraphWithCycle) {
   std::string input = R"(
 fn graph(p: bits[42], q: bits[42]) -> bits[42] {
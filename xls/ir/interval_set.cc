@@ -17,12 +17,14 @@
 #include <algorithm>
 #include <cstdint>
 #include <functional>
-#include <list>
+#include <limits>
 #include <optional>
 #include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
@@ -65,34 +67,79 @@ void IntervalSet::Normalize() {
   if (is_normalized_) {
     return;
   }
+  if (BitCount() <= 64) {
+    NormalizeNarrow();
+    is_normalized_ = true;
+    return;
+  }
+
+  // Split improper intervals, which wrap around, into two proper intervals.
+  int64_t original_size = intervals_.size();
+  for (int64_t i = 0; i < original_size; ++i) {
+    if (intervals_[i].IsImproper()) {
+      Bits lower = intervals_[i].LowerBound();
+      intervals_[i] = Interval(Bits(BitCount()), intervals_[i].UpperBound());
+      intervals_.push_back(Interval(lower, Bits::AllOnes(BitCount())));
+    }
+  }
+
+  std::sort(intervals_.begin(), intervals_.end());
 
-  Bits zero(BitCount());
-  Bits max = Bits::AllOnes(BitCount());
-  std::vector<Interval> expand_improper;
+  // Merge overlapping and abutting intervals in place.
+  int64_t merged = 0;
+  for (int64_t i = 0; i < intervals_.size(); ++i) {
+    if (merged > 0 &&
+        (Interval::Overlaps(intervals_[merged - 1], intervals_[i]) ||
+         Interval::Abuts(intervals_[merged - 1], intervals_[i]))) {
+      intervals_[merged - 1] =
+          Interval::ConvexHull(intervals_[merged - 1], intervals_[i]);
+    } else {
+      if (merged != i) {
+        intervals_[merged] = std::move(intervals_[i]);
+      }
+      ++merged;
+    }
+  }
+  intervals_.erase(intervals_.begin() + merged, intervals_.end());
+
+  is_normalized_ = true;
+}
+
+void IntervalSet::NormalizeNarrow() {
+  XLS_CHECK_LE(bit_count_, 64);
+  const uint64_t max =
+      bit_count_ == 0 ? 0 : std::numeric_limits<uint64_t>::max() >>
+                                (64 - bit_count_);
+  absl::InlinedVector<std::pair<uint64_t, uint64_t>, 2 * kInlineIntervals>
+      ranges;
+  ranges.reserve(intervals_.size());
   for (const Interval& interval : intervals_) {
-    if (interval.IsImproper()) {
-      expand_improper.push_back(Interval(zero, interval.UpperBound()));
-      expand_improper.push_back(Interval(interval.LowerBound(), max));
+    uint64_t lower = interval.LowerBound().bitmap().GetWord(0);
+    uint64_t upper = interval.UpperBound().bitmap().GetWord(0);
+    if (lower > upper) {
+      // Improper intervals wrap around.
+      ranges.push_back({0, upper});
+      ranges.push_back({lower, max});
     } else {
-      expand_improper.push_back(interval);
+      ranges.push_back({lower, upper});
     }
   }
 
-  std::sort(expand_improper.begin(), expand_improper.end());
+  std::sort(ranges.begin(), ranges.end());
 
   intervals_.clear();
-  for (int32_t i = 0; i < expand_improper.size();) {
-    Interval interval = expand_improper[i++];
-    while ((i < expand_improper.size()) &&
-           (Interval::Overlaps(interval, expand_improper[i]) ||
-            Interval::Abuts(interval, expand_improper[i]))) {
-      interval = Interval::ConvexHull(interval, expand_improper[i]);
+  for (int64_t i = 0; i < ranges.size();) {
+    auto [lower, upper] = ranges[i++];
+    // Absorb the following ranges, which start at or after `lower`, as long as
+    // they overlap or abut the merged range.
+    while (i < ranges.size() &&
+           (upper == max || ranges[i].first <= upper + 1)) {
+      upper = std::max(upper, ranges[i].second);
       ++i;
     }
-    intervals_.push_back(interval);
+    intervals_.push_back(
+        Interval(UBits(lower, bit_count_), UBits(upper, bit_count_)));
   }
-
-  is_normalized_ = true;
 }
 
 std::optional<Interval> IntervalSet::ConvexHull() const {
@@ -174,6 +221,7 @@ IntervalSet IntervalSet::Combine(const IntervalSet& lhs,
                                  const IntervalSet& rhs) {
   XLS_CHECK_EQ(lhs.BitCount(), rhs.BitCount());
   IntervalSet combined(lhs.BitCount());
+  combined.intervals_.reserve(lhs.intervals_.size() + rhs.intervals_.size());
   for (const Interval& interval : lhs.intervals_) {
     combined.AddInterval(interval);
   }
@@ -190,70 +238,53 @@ IntervalSet IntervalSet::Intersect(const IntervalSet& lhs,
   XLS_CHECK(lhs.is_normalized_);
   XLS_CHECK(rhs.is_normalized_);
   IntervalSet result(lhs.BitCount());
-  std::list<Interval> lhs_intervals(lhs.Intervals().begin(),
-                                    lhs.Intervals().end());
-  std::list<Interval> rhs_intervals(rhs.Intervals().begin(),
-                                    rhs.Intervals().end());
-  auto left = lhs_intervals.begin();
-  auto right = rhs_intervals.begin();
-  // lhs/rhs_intervals should be sorted in increasing lexicographic order
-  // (i.e.: compare on lower bound, then upper bound if lower bounds are equal)
-  // at this point, since we CHECK that they are normalized.
-  while ((left != lhs_intervals.end()) && (right != rhs_intervals.end())) {
-    if (bits_ops::ULessThan(left->UpperBound(), right->UpperBound())) {
-      if (std::optional<Interval> intersection =
-              Interval::Intersect(*left, *right)) {
-        result.AddInterval(*intersection);
-        // The difference should only ever contain 0 or 1 interval.
-        std::vector<Interval> difference = Interval::Difference(*right, *left);
-        std::reverse(difference.begin(), difference.end());
-        for (const Interval& remainder : difference) {
-          right = rhs_intervals.insert(right, remainder);
-        }
-      }
-      ++left;
-      continue;
+  // Both sets are sorted and disjoint, so sweep through them together; each
+  // step retires the interval (or both intervals) ending first.
+  int64_t i = 0;
+  int64_t j = 0;
+  while (i < lhs.intervals_.size() && j < rhs.intervals_.size()) {
+    const Interval& left = lhs.intervals_[i];
+    const Interval& right = rhs.intervals_[j];
+    int64_t cmp = bits_ops::UCmp(left.UpperBound(), right.UpperBound());
+    const Bits& lower = bits_ops::UMax(left.LowerBound(), right.LowerBound());
+    const Bits& upper = cmp < 0 ? left.UpperBound() : right.UpperBound();
+    if (bits_ops::ULessThanOrEqual(lower, upper)) {
+      result.intervals_.push_back(Interval(lower, upper));
     }
-    if (bits_ops::ULessThan(right->UpperBound(), left->UpperBound())) {
-      if (std::optional<Interval> intersection =
-              Interval::Intersect(*left, *right)) {
-        result.AddInterval(*intersection);
-        // The difference should only ever contain 0 or 1 interval.
-        std::vector<Interval> difference = Interval::Difference(*left, *right);
-        std::reverse(difference.begin(), difference.end());
-        for (const Interval& remainder : difference) {
-          left = lhs_intervals.insert(left, remainder);
-        }
-      }
-      ++right;
-      continue;
+    if (cmp <= 0) {
+      ++i;
     }
-    if (bits_ops::UEqual(left->UpperBound(), right->UpperBound())) {
-      if (std::optional<Interval> intersection =
-              Interval::Intersect(*left, *right)) {
-        result.AddInterval(*intersection);
-      }
-      ++left;
-      ++right;
-      continue;
+    if (cmp >= 0) {
+      ++j;
     }
   }
-  result.Normalize();
+  // The intersections are sorted. They neither overlap nor abut, since
+  // consecutive ones are separated by a gap between the intervals of one of
+  // the (normalized) inputs.
   return result;
 }
 
 IntervalSet IntervalSet::Complement(const IntervalSet& set) {
-  // The complement of an interval set is the intersection of the complements of
-  // the component intervals.
-  IntervalSet result = Maximal(set.BitCount());
+  // The complement of a normalized set is made of the gaps between its
+  // intervals (and its ends).
+  IntervalSet result(set.BitCount());
+  if (set.BitCount() == 0) {
+    return set.IsEmpty() ? Maximal(0) : result;
+  }
+  Bits one = UBits(1, set.BitCount());
+  Bits next_uncovered(set.BitCount());
   for (const Interval& interval : set.Intervals()) {
-    IntervalSet complement_set(set.BitCount());
-    for (const Interval& complement : Interval::Complement(interval)) {
-      complement_set.AddInterval(complement);
+    if (bits_ops::ULessThan(next_uncovered, interval.LowerBound())) {
+      result.intervals_.push_back(
+          Interval(next_uncovered, bits_ops::Sub(interval.LowerBound(), one)));
+    }
+    if (interval.UpperBound().IsAllOnes()) {
+      return result;
     }
-    complement_set.Normalize();
-    result = Intersect(result, complement_set);
+    next_uncovered = bits_ops::Add(interval.UpperBound(), one);
   }
+  result.intervals_.push_back(
+      Interval(next_uncovered, Bits::AllOnes(set.BitCount())));
   return result;
 }
 
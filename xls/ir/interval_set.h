@@ -22,6 +22,7 @@
 #include <string>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/ir/bits.h"
@@ -32,6 +33,10 @@ namespace xls {
 // This type represents a set of intervals.
 class IntervalSet {
  public:
+  // Number of intervals stored inline, i.e. without a heap allocation. Most
+  // interval sets arising in range analysis hold a handful of intervals.
+  static constexpr int64_t kInlineIntervals = 4;
+
   // Create an empty `IntervalSet` with a `BitCount()` of -1. Every method in
   // this class fails if called on an `IntervalSet` with bit count -1, so you
   // must assign to a default constructed interval set before calling any method
@@ -94,6 +99,9 @@ class IntervalSet {
   // 5. The result of a call to `Intervals()` has the smallest possible size
   //    of any set of intervals representing the same set of points that
   //    contains no improper intervals (hence the name "normalization").
+  //
+  // Normalization happens in place; interval sets of at most 64 bits are
+  // normalized on machine words rather than `Bits`.
   void Normalize();
 
   // Return the smallest single proper interval that contains all points in this
@@ -119,7 +127,7 @@ class IntervalSet {
   static IntervalSet Combine(const IntervalSet& lhs, const IntervalSet& rhs);
 
   // Returns a normalized set of intervals comprising the intersection of the
-  // two given interval sets.
+  // two given interval sets, which must be normalized.
   static IntervalSet Intersect(const IntervalSet& lhs, const IntervalSet& rhs);
 
   // Returns the normalized set of intervals comprising the complemet of the
@@ -219,9 +227,12 @@ class IntervalSet {
   }
 
  private:
+  // Normalize for interval sets of at most 64 bits.
+  void NormalizeNarrow();
+
   bool is_normalized_;
   int64_t bit_count_;
-  std::vector<Interval> intervals_;
+  absl::InlinedVector<Interval, kInlineIntervals> intervals_;
 };
 
 inline std::ostream& operator<<(std::ostream& os,
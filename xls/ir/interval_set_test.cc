@@ -78,6 +78,28 @@ TEST(IntervalTest, Normalize) {
                 MakeInterval(20, std::numeric_limits<uint32_t>::max(), 32)}));
 }
 
+TEST(IntervalTest, NormalizeWide) {
+  // Interval sets wider than 64 bits are normalized on `Bits`.
+  IntervalSet wide(100);
+  wide.AddInterval(MakeInterval(100, 150, 100));
+  wide.AddInterval(MakeInterval(151, 160, 100));
+  wide.AddInterval(MakeInterval(5, 20, 100));
+  wide.AddInterval(Interval(Bits::AllOnes(100), UBits(2, 100)));
+  wide.Normalize();
+  EXPECT_EQ(wide.Intervals(),
+            (std::vector<Interval>{MakeInterval(0, 2, 100),
+                                   MakeInterval(5, 20, 100),
+                                   MakeInterval(100, 160, 100),
+                                   Interval::Precise(Bits::AllOnes(100))}));
+
+  IntervalSet zero_width(0);
+  zero_width.AddInterval(Interval::Maximal(0));
+  zero_width.AddInterval(Interval::Maximal(0));
+  zero_width.Normalize();
+  EXPECT_EQ(zero_width.Intervals(),
+            (std::vector<Interval>{Interval::Maximal(0)}));
+}
+
 TEST(IntervalTest, ConvexHull) {
   IntervalSet example(32);
   example.AddInterval(MakeInterval(10, 20, 32));
@@ -493,5 +515,26 @@ RC_GTEST_PROP(
   RC_ASSERT(union_size != rhs_size || union_set == rhs);
 }
 
+RC_GTEST_PROP(
+    IntervalRapidcheck, NarrowAndWideNormalizationAgree,
+    (const std::vector<std::pair<uint32_t, uint32_t>>& intervals)) {
+  IntervalSet narrow(32);
+  IntervalSet wide(80);
+  for (auto [lower_bound, upper_bound] : intervals) {
+    if (lower_bound > upper_bound) {
+      std::swap(lower_bound, upper_bound);
+    }
+    narrow.AddInterval(MakeInterval(lower_bound, upper_bound, 32));
+    wide.AddInterval(MakeInterval(lower_bound, upper_bound, 80));
+  }
+  narrow.Normalize();
+  wide.Normalize();
+  RC_ASSERT(narrow.ZeroExtend(80) == wide);
+  RC_ASSERT(IntervalSet::Complement(IntervalSet::Complement(narrow)) ==
+            narrow);
+  RC_ASSERT(IntervalSet::Intersect(narrow, IntervalSet::Complement(narrow))
+                .IsEmpty());
+}
+
 }  // namespace
 }  // namespace xls
@@ -16,6 +16,8 @@
 #define XLS_IR_IR_SCANNER_H_
 
 #include <cstdint>
+#include <deque>
+#include <optional>
 #include <ostream>
 #include <string>
 #include <string_view>
@@ -62,6 +64,8 @@ struct TokenPos {
   std::string ToHumanString() const;
 };
 
+// A lexical token. The value of the token is a view into the text it was
+// scanned from, which must outlive the token.
 class Token {
  public:
   // Returns the (singleton) set of keyword strings.
@@ -95,7 +99,7 @@ class Token {
       : type_(type), value_(value), pos_({lineno, colno}) {}
 
   LexicalTokenType type() const { return type_; }
-  const std::string& value() const { return value_; }
+  std::string_view value() const { return value_; }
   const TokenPos& pos() const { return pos_; }
 
   // Returns the token as a (u)int64_t value. Token must be a literal. The
@@ -119,7 +123,7 @@ class Token {
 
  private:
   LexicalTokenType type_;
-  std::string value_;
+  std::string_view value_;
   TokenPos pos_;
 };
 
@@ -129,11 +133,62 @@ inline std::ostream& operator<<(std::ostream& os, const Token& token) {
 }
 
 // Tokenizes the given string and returns the tokens. It maintains precise
-// source location information.  Right now this is a eager implementation - it
-// tokenizes the whole input. This can be easily changed later to a more demand
-// driven tokenization.
+// source location information. The values of the returned tokens are views
+// into `str`.
 absl::StatusOr<std::vector<Token>> TokenizeString(std::string_view str);
 
+// Demand-driven tokenizer which produces one token at a time.
+class Tokenizer {
+ public:
+  explicit Tokenizer(std::string_view str) : str_(str) {}
+
+  // Returns the next token, or std::nullopt at the end of the string.
+  absl::StatusOr<std::optional<Token>> Next();
+
+ private:
+  bool DropWhiteSpace();
+  bool DropEndOfLineComment();
+  bool MatchSubstring(std::string_view substr) const;
+  absl::StatusOr<std::optional<std::string_view>> MatchQuotedString(
+      std::string_view quote, bool allow_multiline);
+  int64_t Advance(int64_t amount = 1);
+  bool EndOfString() const { return index_ >= str_.size(); }
+  template <typename TestFn>
+  std::string_view CaptureWhile(TestFn test_f, int64_t min_chars = 0);
+
+  // Returns the character at the current index.
+  char current() const { return str_[index_]; }
+
+  // Returns the character at the current index + 1, or nullopt if current index
+  // + 1 is beyond the end of the string.
+  std::optional<char> next() const {
+    if (index_ + 1 < str_.size()) {
+      return str_[index_ + 1];
+    }
+    return std::nullopt;
+  }
+
+  // Returns the current index in the string.
+  int64_t index() const { return index_; }
+
+  // Returns the current line/column number.
+  int64_t lineno() const { return lineno_; }
+  int64_t colno() const { return colno_; }
+
+  // The string being tokenized.
+  std::string_view str_;
+
+  // Current index.
+  int64_t index_ = 0;
+
+  // Line/column number based on the current index.
+  int64_t lineno_ = 0;
+  int64_t colno_ = 0;
+};
+
+// Scanner over IR text. Tokens are produced on demand as the parser consumes
+// them so only a small window of lookahead tokens is held in memory. `text`
+// must outlive the scanner and the tokens it returns.
 class Scanner {
  public:
   static absl::StatusOr<Scanner> Create(std::string_view text);
@@ -144,26 +199,28 @@ class Scanner {
 
   // Return the current token.
   const Token& PeekTokenOrDie() const {
-    XLS_CHECK(!AtEof());
-    return tokens_[token_idx_];
+    XLS_CHECK(FillLookahead(0)) << status_;
+    return lookahead_.front();
   }
 
   // Returns true if the next token is the given type.
   bool PeekTokenIs(LexicalTokenType target) const {
-    return !AtEof() && PeekTokenOrDie().type() == target;
+    return PeekNthTokenIs(0, target);
   }
 
   // Returns true if the nth next token is the given type. If `n` is zero this
   // peeks at the immediate next token.
   bool PeekNthTokenIs(int64_t n, LexicalTokenType target) const {
-    return (token_idx_ + n < tokens_.size()) &&
-           tokens_[token_idx_ + n].type() == target;
+    return FillLookahead(n) && lookahead_[n].type() == target;
   }
 
   // Pop the current token, advance token pointer to next token.
   Token PopToken() {
-    XLS_VLOG(6) << "Popping token: " << tokens_[token_idx_];
-    return tokens_.at(token_idx_++);
+    XLS_CHECK(FillLookahead(0)) << status_;
+    Token token = lookahead_.front();
+    lookahead_.pop_front();
+    XLS_VLOG(6) << "Popping token: " << token;
+    return token;
   }
 
   // Same as PopToken() but returns a status error if we are at EOF (in which
@@ -214,14 +271,25 @@ class Scanner {
   // Returns an absl::Status error if we cannot.
   absl::Status DropKeywordOrError(std::string_view keyword);
 
-  // Check if more tokens are available.
-  bool AtEof() const { return token_idx_ >= tokens_.size(); }
+  // Check if more tokens are available. Returns false if tokenizing the rest
+  // of the text failed so that the error is reported by the next pop.
+  bool AtEof() const { return !FillLookahead(0) && status_.ok(); }
 
  private:
-  explicit Scanner(std::vector<Token> tokens) : tokens_(tokens) {}
+  explicit Scanner(std::string_view text) : tokenizer_(text) {}
+
+  // Tokenizes ahead until at least `n` + 1 tokens are buffered. Returns false
+  // if the end of the text or a tokenization error (held in `status_`) is
+  // reached first.
+  bool FillLookahead(int64_t n) const;
+
+  // Returns the tokenization error if one was hit, otherwise an EOF error with
+  // the given message.
+  absl::Status EofError(std::string_view message) const;
 
-  int64_t token_idx_ = 0;
-  std::vector<Token> tokens_;
+  mutable Tokenizer tokenizer_;
+  mutable std::deque<Token> lookahead_;
+  mutable absl::Status status_;
 };
 
 }  // namespace xls
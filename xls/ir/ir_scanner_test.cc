@@ -14,6 +14,7 @@
 
 #include "xls/ir/ir_scanner.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -34,7 +35,7 @@ using testing::HasSubstr;
 std::vector<std::string> TokensToStrings(absl::Span<const Token> tokens) {
   std::vector<std::string> strs;
   for (const Token& token : tokens) {
-    strs.push_back(token.value());
+    strs.push_back(std::string(token.value()));
   }
   return strs;
 }
@@ -178,5 +179,37 @@ TEST(IrScannerTest, UnterminatedTripleQuotedStrings) {
                HasSubstr("Unterminated quoted string starting at 1:1")));
 }
 
+TEST(IrScannerTest, ScannerIsLazy) {
+  // The invalid character is only reported once the scanner reaches it.
+  std::string text = "fn foo(x: bits[32]) $";
+  XLS_ASSERT_OK_AND_ASSIGN(Scanner scanner, Scanner::Create(text));
+  EXPECT_TRUE(scanner.PeekTokenIs(LexicalTokenType::kKeyword));
+  EXPECT_TRUE(scanner.PeekNthTokenIs(2, LexicalTokenType::kParenOpen));
+  EXPECT_FALSE(scanner.PeekNthTokenIs(100, LexicalTokenType::kParenOpen));
+  XLS_ASSERT_OK_AND_ASSIGN(Token fn, scanner.PopTokenOrError());
+  EXPECT_EQ(fn.value(), "fn");
+  XLS_ASSERT_OK_AND_ASSIGN(Token foo, scanner.PopTokenOrError());
+  EXPECT_EQ(foo.value(), "foo");
+  // Token values are views into the scanned text.
+  EXPECT_EQ(foo.value().data(), text.data() + 3);
+  for (int64_t i = 0; i < 8; ++i) {
+    XLS_ASSERT_OK(scanner.PopTokenOrError().status());
+  }
+  EXPECT_FALSE(scanner.AtEof());
+  EXPECT_THAT(scanner.PopTokenOrError(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Invalid character in IR text \"$\"")));
+}
+
+TEST(IrScannerTest, ScannerAtEof) {
+  XLS_ASSERT_OK_AND_ASSIGN(Scanner scanner, Scanner::Create("a // b"));
+  EXPECT_FALSE(scanner.AtEof());
+  XLS_ASSERT_OK(scanner.PopTokenOrError().status());
+  EXPECT_TRUE(scanner.AtEof());
+  EXPECT_THAT(scanner.PopTokenOrError(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("found EOF")));
+}
+
 }  // namespace
 }  // namespace xls
@@ -14,6 +14,9 @@
 
 #include "xls/ir/name_uniquer.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -58,7 +61,7 @@ std::string SanitizeName(
 
 }  // namespace
 
-std::string NameUniquer::GetSanitizedUniqueName(std::string_view prefix) {
+UniqueName NameUniquer::GetUniqueName(std::string_view prefix) {
   std::string root = SanitizeName(prefix, reserved_names_);
 
   // Strip away a numeric suffix. For example, grab "foo" from "foo__42". This
@@ -84,26 +87,98 @@ std::string NameUniquer::GetSanitizedUniqueName(std::string_view prefix) {
     // This root has been seen before.
     SequentialIdGenerator& generator = generated_names_[root];
     if (numeric_suffix.has_value()) {
-      return absl::StrCat(root, separator_,
-                          generator.RegisterId(numeric_suffix.value()));
+      return MakeName(root, generator.RegisterId(numeric_suffix.value()));
     } else {
-      return absl::StrCat(root, separator_, generator.NextId());
+      return MakeName(root, generator.NextId());
     }
   } else {
     // This is the first time that the name root has been seen. Create a
     // SequentialIdGenerator to create future unique names based on this root.
     SequentialIdGenerator& generator = generated_names_[root];
     if (numeric_suffix.has_value()) {
-      return absl::StrCat(root, separator_,
-                          generator.RegisterId(numeric_suffix.value()));
+      return MakeName(root, generator.RegisterId(numeric_suffix.value()));
     } else {
       // Root has not been seen before and there is no suffix. Just return the
       // root.
-      return root;
+      return MakeName(root, std::nullopt);
     }
   }
 }
 
+UniqueName NameUniquer::Intern(std::string_view name) {
+  size_t separator_index = name.rfind(separator_);
+  if (separator_index != std::string_view::npos) {
+    std::string_view suffix = name.substr(separator_index + separator_.size());
+    int64_t i;
+    // Only split off suffixes which print back identically.
+    if (absl::SimpleAtoi(suffix, &i) && absl::StrCat(i) == suffix) {
+      return MakeName(name.substr(0, separator_index), i);
+    }
+  }
+  return MakeName(name, std::nullopt);
+}
+
+UniqueName NameUniquer::Flatten(UniqueName name) {
+  if (name.empty() || name.is_flat()) {
+    return name;
+  }
+  return UniqueName(InternRoot(ToString(name)), -1);
+}
+
+std::string NameUniquer::ToString(UniqueName name) const {
+  if (name.empty()) {
+    return "";
+  }
+  if (name.is_flat()) {
+    return roots_[name.root_id_];
+  }
+  return absl::StrCat(roots_[name.root_id_], separator_, name.suffix_);
+}
+
+std::string_view NameUniquer::ToStringView(UniqueName name) const {
+  if (name.empty()) {
+    return "";
+  }
+  XLS_CHECK(name.is_flat()) << ToString(name);
+  return roots_[name.root_id_];
+}
+
+UniqueName NameUniquer::MakeName(std::string_view root,
+                                 std::optional<int64_t> suffix) {
+  if (!suffix.has_value()) {
+    return UniqueName(InternRoot(root), -1);
+  }
+  if (*suffix < 0 || *suffix > std::numeric_limits<int32_t>::max()) {
+    return UniqueName(InternRoot(absl::StrCat(root, separator_, *suffix)), -1);
+  }
+  return UniqueName(InternRoot(root), static_cast<int32_t>(*suffix));
+}
+
+int32_t NameUniquer::InternRoot(std::string_view root) {
+  auto it = root_ids_.find(root);
+  if (it != root_ids_.end()) {
+    return it->second;
+  }
+  XLS_CHECK_LT(roots_.size(), std::numeric_limits<int32_t>::max());
+  int32_t id = static_cast<int32_t>(roots_.size());
+  roots_.emplace_back(root);
+  root_ids_.emplace(roots_.back(), id);
+  return id;
+}
+
+void NameUniquer::CopyFrom(const NameUniquer& other) {
+  separator_ = other.separator_;
+  reserved_names_ = other.reserved_names_;
+  generated_names_ = other.generated_names_;
+  roots_ = other.roots_;
+  // The views in `root_ids_` must refer to the strings in this uniquer.
+  root_ids_.clear();
+  root_ids_.reserve(roots_.size());
+  for (int32_t id = 0; id < static_cast<int32_t>(roots_.size()); ++id) {
+    root_ids_.emplace(roots_[id], id);
+  }
+}
+
 /* static */ bool NameUniquer::IsValidIdentifier(std::string_view str) {
   if (str.empty()) {
     return false;
@@ -16,6 +16,8 @@
 #define XLS_IR_NAME_UNIQUER_H_
 
 #include <cstdint>
+#include <deque>
+#include <optional>
 #include <string>
 #include <string_view>
 
@@ -25,6 +27,37 @@
 
 namespace xls {
 
+// Compact form of a name held by a NameUniquer: the id of the name's root,
+// which the uniquer interns, and its numeric suffix. For example, "add__1234"
+// is the root "add" with suffix 1234, so the many names sharing a root take
+// eight bytes each. Only meaningful together with the uniquer which created
+// it. A default-constructed UniqueName is no name.
+class UniqueName {
+ public:
+  UniqueName() = default;
+
+  bool empty() const { return root_id_ < 0; }
+
+  // Returns whether the name is stored as a single interned string, i.e. has
+  // no separate suffix.
+  bool is_flat() const { return suffix_ < 0; }
+
+  bool operator==(const UniqueName& other) const {
+    return root_id_ == other.root_id_ && suffix_ == other.suffix_;
+  }
+  bool operator!=(const UniqueName& other) const { return !(*this == other); }
+
+ private:
+  friend class NameUniquer;
+
+  UniqueName(int32_t root_id, int32_t suffix)
+      : root_id_(root_id), suffix_(suffix) {}
+
+  int32_t root_id_ = -1;
+  // -1 if the name has no suffix.
+  int32_t suffix_ = -1;
+};
+
 // Class for generating unique names. Keeps track of names that have currently
 // been seen/generated. The names returned by GetUniqueName are guaranteed to
 // be distinct for this instance of the class.  The names will be
@@ -44,7 +77,32 @@ class NameUniquer {
   // from the given prefix by "separator_". For example,
   // GetSanitizedUniqueName("foo") might return "foo__1" if "foo" is not
   // available.
-  std::string GetSanitizedUniqueName(std::string_view prefix);
+  std::string GetSanitizedUniqueName(std::string_view prefix) {
+    return ToString(GetUniqueName(prefix));
+  }
+
+  // As GetSanitizedUniqueName, but returns the name in compact form.
+  UniqueName GetUniqueName(std::string_view prefix);
+
+  // Returns the compact form of `name` as is, i.e. without sanitizing,
+  // uniquifying or registering it.
+  UniqueName Intern(std::string_view name);
+
+  // Returns `name` stored as a single interned string, for names which must be
+  // viewable with ToStringView.
+  UniqueName Flatten(UniqueName name);
+
+  std::string ToString(UniqueName name) const;
+
+  // Returns a view of a flat name (see UniqueName::is_flat), which is valid
+  // for the lifetime of the uniquer.
+  std::string_view ToStringView(UniqueName name) const;
+
+  // Makes this uniquer a copy of `other`: the names registered with `other`
+  // are registered with this uniquer, and UniqueNames created by `other` are
+  // valid with this uniquer and denote the same names. Any state of this
+  // uniquer is discarded.
+  void CopyFrom(const NameUniquer& other);
 
   // Returns true if the given str is a valid Verilog, and thus XLS, identifier.
   static bool IsValidIdentifier(std::string_view str);
@@ -89,6 +147,13 @@ class NameUniquer {
     absl::flat_hash_set<int64_t> used_;
   };
 
+  // Returns the compact form of `root` followed by the separator and `suffix`,
+  // if any.
+  UniqueName MakeName(std::string_view root, std::optional<int64_t> suffix);
+
+  // Returns the id of the interned string `root`.
+  int32_t InternRoot(std::string_view root);
+
   // The string to use to separate the prefix of the name from the uniquing
   // integer value.
   std::string separator_;
@@ -100,6 +165,11 @@ class NameUniquer {
   // Map from name prefix to the generator data structure which tracks used
   // identifiers and generates new ones.
   absl::flat_hash_map<std::string, SequentialIdGenerator> generated_names_;
+
+  // Interned roots of the names handed out, indexed by id. A deque for the
+  // stability of the views in `root_ids_`.
+  std::deque<std::string> roots_;
+  absl::flat_hash_map<std::string_view, int32_t> root_ids_;
 };
 
 }  // namespace xls
@@ -100,6 +100,60 @@ TEST(NameUniquerTest, CornerCases) {
   EXPECT_EQ("name__5", uniquer.GetSanitizedUniqueName("__2"));
 }
 
+TEST(NameUniquerTest, CompactNames) {
+  NameUniquer uniquer("__");
+
+  UniqueName foo = uniquer.GetUniqueName("foo");
+  UniqueName foo1 = uniquer.GetUniqueName("foo");
+  UniqueName foo42 = uniquer.GetUniqueName("foo__42");
+  EXPECT_FALSE(foo.empty());
+  EXPECT_TRUE(foo.is_flat());
+  EXPECT_FALSE(foo1.is_flat());
+  EXPECT_NE(foo, foo1);
+  EXPECT_EQ(uniquer.ToString(foo), "foo");
+  EXPECT_EQ(uniquer.ToString(foo1), "foo__1");
+  EXPECT_EQ(uniquer.ToString(foo42), "foo__42");
+  EXPECT_EQ(uniquer.ToStringView(foo), "foo");
+
+  UniqueName flat = uniquer.Flatten(foo42);
+  EXPECT_TRUE(flat.is_flat());
+  EXPECT_EQ(uniquer.ToStringView(flat), "foo__42");
+  EXPECT_EQ(uniquer.ToString(flat), "foo__42");
+
+  // Interned names are neither sanitized nor uniquified, and suffixes which
+  // would not print back identically are kept in the root.
+  EXPECT_EQ(uniquer.Intern("foo__1"), foo1);
+  EXPECT_EQ(uniquer.ToString(uniquer.Intern("a.b")), "a.b");
+  EXPECT_EQ(uniquer.ToString(uniquer.Intern("foo__01")), "foo__01");
+  EXPECT_EQ(uniquer.ToString(uniquer.Intern("foo__99999999999")),
+            "foo__99999999999");
+  EXPECT_EQ(uniquer.GetSanitizedUniqueName("foo"), "foo__2");
+
+  EXPECT_TRUE(UniqueName().empty());
+  EXPECT_EQ(uniquer.ToString(UniqueName()), "");
+}
+
+TEST(NameUniquerTest, CopyFrom) {
+  NameUniquer original("__");
+  UniqueName foo = original.GetUniqueName("foo");
+  UniqueName foo_1 = original.GetUniqueName("foo");
+  UniqueName flat = original.Flatten(original.GetUniqueName("bar__7"));
+
+  NameUniquer copy("__");
+  copy.GetUniqueName("qux");
+  copy.CopyFrom(original);
+  EXPECT_EQ(copy.ToString(foo), "foo");
+  EXPECT_EQ(copy.ToString(foo_1), "foo__1");
+  EXPECT_EQ(copy.ToStringView(flat), "bar__7");
+
+  // Names registered with the original remain taken in the copy, and the two
+  // uniquers are independent afterwards.
+  EXPECT_EQ(copy.GetSanitizedUniqueName("foo"), "foo__2");
+  EXPECT_EQ(copy.GetSanitizedUniqueName("qux"), "qux");
+  EXPECT_EQ(original.GetSanitizedUniqueName("foo"), "foo__2");
+  EXPECT_EQ(original.GetSanitizedUniqueName("qux"), "qux");
+}
+
 TEST(NameUniquerTest, IsValidIdentifier) {
   EXPECT_TRUE(NameUniquer::IsValidIdentifier("foo"));
   EXPECT_TRUE(NameUniquer::IsValidIdentifier("foo_bar"));
@@ -15,6 +15,7 @@
 #include "xls/ir/node.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -23,6 +24,8 @@
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/hash/hash.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/escaping.h"
@@ -32,9 +35,11 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/change_listener.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/function.h"
 #include "xls/ir/instantiation.h"
+#include "xls/ir/node_arena.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc.h"
@@ -42,15 +47,59 @@
 #include "xls/ir/verifier.h"
 
 namespace xls {
+namespace {
+
+// Every node allocation is prefixed with a header recording the arena it came
+// from, or nullptr for heap allocations. The header is padded to the arena
+// alignment so the node itself stays suitably aligned.
+constexpr size_t kNodeHeaderSize = NodeArena::kAlignment;
+static_assert(sizeof(NodeArena*) <= kNodeHeaderSize);
+
+void* InitNodeHeader(void* allocation, NodeArena* arena) {
+  *static_cast<NodeArena**>(allocation) = arena;
+  return static_cast<char*>(allocation) + kNodeHeaderSize;
+}
+
+}  // namespace
+
+void* Node::operator new(size_t size) {
+  return InitNodeHeader(::operator new(size + kNodeHeaderSize), nullptr);
+}
+
+void* Node::operator new(size_t size, NodeArena* arena) {
+  return InitNodeHeader(arena->Allocate(size + kNodeHeaderSize), arena);
+}
+
+void Node::operator delete(void* ptr, size_t size) {
+  if (ptr == nullptr) {
+    return;
+  }
+  void* allocation = static_cast<char*>(ptr) - kNodeHeaderSize;
+  NodeArena* arena = *static_cast<NodeArena**>(allocation);
+  if (arena == nullptr) {
+    ::operator delete(allocation);
+  } else {
+    arena->Deallocate(allocation, size + kNodeHeaderSize);
+  }
+}
+
+void Node::operator delete(void* ptr, NodeArena* arena) {
+  // Only reached if a node constructor throws, which XLS code does not do. The
+  // allocation size is unknown here, so the memory is simply left to be
+  // reclaimed when the arena is destroyed.
+}
 
 Node::Node(Op op, Type* type, const SourceInfo& loc, std::string_view name,
            FunctionBase* function_base)
     : function_base_(function_base),
-      id_(function_base_->package()->GetNextNodeId()),
+      id_(function_base_->GetNextNodeId()),
       op_(op),
       type_(type),
-      loc_(loc),
-      name_(name.empty() ? "" : function_base_->UniquifyNodeName(name)) {}
+      loc_(function_base_->package()->source_info_table().Intern(loc)) {
+  if (!name.empty() && !function_base_->copying_node_names_) {
+    AssignName(function_base_->node_name_uniquer().GetUniqueName(name));
+  }
+}
 
 void Node::AddOperand(Node* operand) {
   XLS_VLOG(3) << " Adding operand " << operand->GetName() << " as #"
@@ -80,10 +129,45 @@ absl::Status Node::AddNodeToFunctionAndReplace(
   return ReplaceUsesWith(replacement_ptr);
 }
 
-void Node::AddUser(Node* user) { users_.insert(user); }
+void Node::AddUser(Node* user) {
+  function_base_->NoteNodeChange(user, /*removed=*/false);
+  bool inserted = users_.insert(user).second;
+  if (inserted && function_base_->ShouldNotifyListeners(user)) {
+    for (ChangeListener* listener : function_base_->change_listeners()) {
+      listener->UserAdded(this, user);
+    }
+  }
+}
 
 void Node::RemoveUser(Node* user) {
+  function_base_->NoteNodeChange(user, /*removed=*/false);
   XLS_CHECK_EQ(users_.erase(user), 1) << GetName();
+  if (function_base_->ShouldNotifyListeners(user)) {
+    for (ChangeListener* listener : function_base_->change_listeners()) {
+      listener->UserRemoved(this, user);
+    }
+  }
+}
+
+void Node::NotifyOperandChanged(Node* old_operand,
+                                absl::Span<const int64_t> operand_nos) {
+  if (!function_base_->ShouldNotifyListeners(this)) {
+    return;
+  }
+  for (ChangeListener* listener : function_base_->change_listeners()) {
+    listener->OperandChanged(this, old_operand, operand_nos);
+  }
+}
+
+void Node::SwapOperands(int64_t a, int64_t b) {
+  // Operand/user chains already set up properly, but the operand order feeds
+  // into the topological order.
+  function_base_->NoteNodeChange(this, /*removed=*/false);
+  std::swap(operands_[a], operands_[b]);
+  if (a != b && operands_[a] != operands_[b]) {
+    NotifyOperandChanged(operands_[b], {a});
+    NotifyOperandChanged(operands_[a], {b});
+  }
 }
 
 absl::Status Node::VisitSingleNode(DfsVisitor* visitor) {
@@ -369,6 +453,19 @@ absl::Status Node::Accept(DfsVisitor* visitor) {
   return VisitSingleNode(visitor);
 }
 
+uint64_t Node::StructuralHash() const {
+  absl::InlinedVector<int64_t, kInlineOperandCount> operand_ids;
+  operand_ids.reserve(operand_count());
+  for (Node* operand : operands()) {
+    operand_ids.push_back(operand->id());
+  }
+  if (OpIsCommutative(op())) {
+    std::sort(operand_ids.begin(), operand_ids.end());
+  }
+  return absl::HashOf(op(), GetType()->GetFlatBitCount(), operand_ids,
+                      AttributeHash());
+}
+
 bool Node::IsDefinitelyEqualTo(const Node* other) const {
   if (this == other) {
     return true;
@@ -398,22 +495,39 @@ bool Node::IsDefinitelyEqualTo(const Node* other) const {
 
 std::string Node::GetName() const {
   if (!name_.empty()) {
-    return name_;
+    return function_base_->node_name_uniquer().ToString(name_);
   }
   // Return a generated name based on the id.
   return absl::StrFormat("%s.%d", OpToString(op()), id());
 }
 
 void Node::SetName(std::string_view name) {
-  name_ = function_base()->UniquifyNodeName(name);
+  AssignName(function_base()->node_name_uniquer().GetUniqueName(name));
 }
 
 void Node::ClearName() {
   XLS_CHECK(!Is<Param>());
-  name_ = "";
+  name_ = UniqueName();
 }
 
-void Node::SetLoc(const SourceInfo& loc) { loc_ = loc; }
+void Node::AssignName(UniqueName name) {
+  bool name_is_viewed =
+      op_ == Op::kParam || op_ == Op::kInputPort || op_ == Op::kOutputPort;
+  name_ = name_is_viewed ? function_base_->node_name_uniquer().Flatten(name)
+                         : name;
+}
+
+std::string Node::GetAssignedName() const {
+  return function_base_->node_name_uniquer().ToString(name_);
+}
+
+std::string_view Node::GetAssignedNameView() const {
+  return function_base_->node_name_uniquer().ToStringView(name_);
+}
+
+void Node::SetLoc(const SourceInfo& loc) {
+  loc_ = package()->source_info_table().Intern(loc);
+}
 
 std::string Node::ToStringInternal(bool include_operand_types) const {
   std::string ret = absl::StrCat(GetName(), ": ", GetType()->ToString(), " = ",
@@ -671,6 +785,7 @@ void Node::SetId(int64_t id) {
   // The data structure (btree) containing the users of each node is sorted by
   // node id. To avoid violating invariants of the data structure, remove this
   // node from all users lists, change id, then read to users list.
+  function_base_->NoteGraphChange();
   for (Node* operand : operands()) {
     operand->users_.erase(this);
   }
@@ -678,7 +793,7 @@ void Node::SetId(int64_t id) {
   for (Node* operand : operands()) {
     operand->users_.insert(this);
   }
-  package()->set_next_node_id(std::max(id + 1, package()->next_node_id()));
+  function_base_->ReserveNodeId(id);
 }
 
 bool Node::ReplaceOperand(Node* old_operand, Node* new_operand) {
@@ -694,19 +809,22 @@ bool Node::ReplaceOperand(Node* old_operand, Node* new_operand) {
   if (this == new_operand) {
     return true;
   }
-  bool did_replace = false;
+  absl::InlinedVector<int64_t, 2> replaced;
   for (int64_t i = 0; i < operand_count(); ++i) {
     if (operands_[i] == old_operand) {
-      if (!did_replace && new_operand != nullptr) {
+      if (replaced.empty() && new_operand != nullptr) {
         // Now we know we're definitely using this new operand.
         new_operand->AddUser(this);
       }
-      did_replace = true;
+      replaced.push_back(i);
       operands_[i] = new_operand;
     }
   }
   old_operand->RemoveUser(this);
-  return did_replace;
+  if (!replaced.empty()) {
+    NotifyOperandChanged(old_operand, replaced);
+  }
+  return !replaced.empty();
 }
 
 absl::Status Node::ReplaceOperandNumber(int64_t operand_no, Node* new_operand,
@@ -723,13 +841,13 @@ absl::Status Node::ReplaceOperandNumber(int64_t operand_no, Node* new_operand,
   new_operand->AddUser(this);
   operands_[operand_no] = new_operand;
 
-  for (Node* operand : operands()) {
-    if (operand == old_operand) {
-      return absl::OkStatus();
-    }
+  if (!absl::c_linear_search(operands(), old_operand)) {
+    // old_operand is no longer an operand of this node.
+    old_operand->RemoveUser(this);
+  }
+  if (old_operand != new_operand) {
+    NotifyOperandChanged(old_operand, {operand_no});
   }
-  // old_operand is no longer an operand of this node.
-  old_operand->RemoveUser(this);
   return absl::OkStatus();
 }
 
@@ -753,7 +871,7 @@ absl::Status Node::ReplaceUsesWith(Node* replacement) {
   if (!Is<Param>() && HasAssignedName() && !replacement->HasAssignedName()) {
     // Do not use SetName because we do not want the name to be uniqued which
     // would add a suffix because (clearly) the name already exists.
-    replacement->name_ = name_;
+    replacement->AssignName(name_);
     ClearName();
   }
   return absl::OkStatus();
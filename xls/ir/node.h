@@ -15,6 +15,7 @@
 #ifndef XLS_IR_NODE_H_
 #define XLS_IR_NODE_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -25,12 +26,14 @@
 #include <vector>
 
 #include "absl/container/btree_set.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/common/casts.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/name_uniquer.h"
 #include "xls/ir/op.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
@@ -41,6 +44,7 @@ namespace xls {
 class Package;
 class Node;
 class FunctionBase;
+class NodeArena;
 
 // Forward decaration to avoid circular dependency.
 class DfsVisitor;
@@ -50,8 +54,20 @@ class DfsVisitor;
 // Node is subtyped and can be checked-converted via the As* methods below.
 class Node {
  public:
+  // Number of operands stored inline in the node before the operand list
+  // spills to the heap.
+  static constexpr int64_t kInlineOperandCount = 3;
+
   virtual ~Node() = default;
 
+  // Nodes are allocated either from a FunctionBase's NodeArena (see
+  // FunctionBase::AllocateNode) or from the heap. Each allocation records its
+  // origin so that `delete` returns the memory to the right place.
+  static void* operator new(size_t size);
+  static void* operator new(size_t size, NodeArena* arena);
+  static void operator delete(void* ptr, size_t size);
+  static void operator delete(void* ptr, NodeArena* arena);
+
   // Accepts the visitor, instructing it to visit this node.
   //
   // The visitor is instructed to visit this node with:
@@ -76,7 +92,7 @@ class Node {
   Op op() const { return op_; }
   FunctionBase* function_base() const { return function_base_; }
   Package* package() const;
-  const SourceInfo& loc() const { return loc_; }
+  const SourceInfo& loc() const { return *loc_; }
 
   // Returns the sequence of operands used by this node.
   //
@@ -121,16 +137,35 @@ class Node {
   absl::StatusOr<bool> ReplaceImplicitUsesWith(Node* replacement);
 
   // Swaps the operands at indices 'a' and 'b' in the operands sequence.
-  void SwapOperands(int64_t a, int64_t b) {
-    // Operand/user chains already set up properly.
-    std::swap(operands_[a], operands_[b]);
-  }
+  void SwapOperands(int64_t a, int64_t b);
 
   // Returns true if analysis indicates that this node always produces the
   // same value as 'other' when run with the same operands. The analysis is
   // conservative and false may be returned for some "equivalent" nodes.
   virtual bool IsDefinitelyEqualTo(const Node* other) const;
 
+  // Returns a hash of the structure of this node: its op, type, operands and
+  // op-specific attributes (e.g., the start and width of a bit slice).
+  // Operands are identified by id and, for commutative ops, taken in any
+  // order. Nodes of the same package with the same operands for which
+  // IsDefinitelyEqualTo holds have the same hash, so the hash can key tables
+  // of equivalent nodes which are then verified with IsDefinitelyEqualTo. The
+  // hash does not depend on node names or locations; it is not stable across
+  // processes.
+  uint64_t StructuralHash() const;
+
+  // Returns a hash of the op-specific attributes of the node, as used by
+  // StructuralHash. Attributes equal according to IsDefinitelyEqualTo hash
+  // equally. Function-valued attributes (e.g., the body of a counted for) are
+  // not hashed. Overridden by the generated node classes.
+  virtual uint64_t AttributeHash() const { return 0; }
+
+  // Returns whether the op-specific attributes of this node are equal to those
+  // of `other`, which must have the same op, as compared by
+  // IsDefinitelyEqualTo. Unlike IsDefinitelyEqualTo this ignores types and
+  // holds for side-effecting nodes. Overridden by the generated node classes.
+  virtual bool HasEqualAttributes(const Node* other) const { return true; }
+
   // Returns whether this Op is of the template argument subclass. For example:
   // Is<Param>().
   template <typename OpT>
@@ -265,6 +300,10 @@ class Node {
 
   std::string ToStringInternal(bool include_operand_types) const;
 
+  // Sets the name to `name`, which was created by the function's node name
+  // uniquer, without uniquifying it.
+  void AssignName(UniqueName name);
+
   // Adds an operand to the operand list with a symmetric "user" link added to
   // those operands, noting that this node is a user.
   void AddOperand(Node* operand);
@@ -282,17 +321,32 @@ class Node {
   absl::Status AddNodeToFunctionAndReplace(std::unique_ptr<Node> replacement);
 
  protected:
+  // Returns the name assigned to this node, or the empty string if none is.
+  std::string GetAssignedName() const;
+
+  // Returns a view of the assigned name of a node whose name is stored flat,
+  // i.e. a parameter or port.
+  std::string_view GetAssignedNameView() const;
+
   void AddUser(Node* user);
   void RemoveUser(Node* user);
 
+  // Notifies the function's change listeners that the operands at
+  // `operand_nos` were `old_operand` and have been replaced.
+  void NotifyOperandChanged(Node* old_operand,
+                            absl::Span<const int64_t> operand_nos);
+
   FunctionBase* function_base_;
   int64_t id_;
   Op op_;
   Type* type_;
-  SourceInfo loc_;
-  std::string name_;
+  // Entry of the package's SourceInfoTable.
+  const SourceInfo* loc_;
+  // Interned by the function's node name uniquer. Stored flat (see
+  // UniqueName::is_flat) for nodes whose name() returns a view of it.
+  UniqueName name_;
 
-  std::vector<Node*> operands_;
+  absl::InlinedVector<Node*, kInlineOperandCount> operands_;
 
   // Set of users sorted by node_id for stability.
   absl::btree_set<Node*, NodeIdLessThan> users_;
@@ -0,0 +1,138 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/node_arena.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "xls/common/logging/logging.h"
+
+namespace xls {
+
+char* NodeArena::NewSlab(size_t size) {
+  // `new char[]` memory is aligned for any object of the requested size.
+  auto memory = std::make_unique<char[]>(size);
+  char* start = memory.get();
+  slabs_.emplace(start, Slab{.memory = std::move(memory), .size = size});
+  bytes_reserved_ += size;
+  memory_account_.Add(size);
+  return start;
+}
+
+NodeArena::Slab& NodeArena::SlabContaining(const void* ptr) {
+  auto it = slabs_.upper_bound(static_cast<const char*>(ptr));
+  XLS_DCHECK(it != slabs_.begin());
+  return std::prev(it)->second;
+}
+
+void NodeArena::Reserve(size_t size) {
+  size = RoundUp(size);
+  if (static_cast<size_t>(end_ - cursor_) >= size) {
+    return;
+  }
+  size_t slab_size = std::max(size, kSlabSize);
+  cursor_ = NewSlab(slab_size);
+  end_ = cursor_ + slab_size;
+}
+
+void* NodeArena::Allocate(size_t size) {
+  size = RoundUp(size);
+  bytes_in_use_ += size;
+  size_t size_class = size / kAlignment;
+  if (size_class < free_lists_.size() && free_lists_[size_class] != nullptr) {
+    FreeChunk* chunk = free_lists_[size_class];
+    free_lists_[size_class] = chunk->next;
+    SlabContaining(chunk).live_bytes += size;
+    return chunk;
+  }
+  // Oversized allocations get a slab to themselves rather than wasting the
+  // tail of the current one.
+  if (size > kSlabSize / 4) {
+    char* result = NewSlab(size);
+    slabs_.at(result).live_bytes = size;
+    return result;
+  }
+  if (static_cast<size_t>(end_ - cursor_) < size) {
+    cursor_ = NewSlab(kSlabSize);
+    end_ = cursor_ + kSlabSize;
+  }
+  void* result = cursor_;
+  cursor_ += size;
+  SlabContaining(result).live_bytes += size;
+  return result;
+}
+
+void NodeArena::Deallocate(void* ptr, size_t size) {
+  XLS_DCHECK(ptr != nullptr);
+  size = RoundUp(size);
+  bytes_in_use_ -= size;
+  size_t size_class = size / kAlignment;
+  SlabContaining(ptr).live_bytes -= size;
+  if (size_class >= free_lists_.size()) {
+    free_lists_.resize(size_class + 1, nullptr);
+  }
+  FreeChunk* chunk = static_cast<FreeChunk*>(ptr);
+  chunk->next = free_lists_[size_class];
+  free_lists_[size_class] = chunk;
+}
+
+int64_t NodeArena::ReleaseUnusedSlabs() {
+  // The slab allocations are currently carved from stays, as its unused tail
+  // is still to be handed out.
+  auto is_unused = [&](const Slab& slab) {
+    return slab.live_bytes == 0 && end_ != slab.memory.get() + slab.size;
+  };
+  bool any_unused = false;
+  for (const auto& [start, slab] : slabs_) {
+    if (is_unused(slab)) {
+      any_unused = true;
+      break;
+    }
+  }
+  if (!any_unused) {
+    return 0;
+  }
+
+  // Unlink the free chunks lying in the slabs about to be released.
+  for (FreeChunk*& head : free_lists_) {
+    FreeChunk** link = &head;
+    while (*link != nullptr) {
+      if (is_unused(SlabContaining(*link))) {
+        *link = (*link)->next;
+      } else {
+        link = &(*link)->next;
+      }
+    }
+  }
+
+  int64_t released = 0;
+  for (auto it = slabs_.begin(); it != slabs_.end();) {
+    if (is_unused(it->second)) {
+      released += it->second.size;
+      it = slabs_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  bytes_reserved_ -= released;
+  memory_account_.Remove(released);
+  return released;
+}
+
+}  // namespace xls
@@ -0,0 +1,111 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_NODE_ARENA_H_
+#define XLS_IR_NODE_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "xls/common/memory_accounting.h"
+
+namespace xls {
+
+// Allocator backing the nodes of a single FunctionBase. Memory is carved
+// sequentially out of large slabs so that nodes created together (as they are
+// by the parser, the builders and passes) are contiguous in memory. Freed
+// allocations are kept on per-size free lists and reused for later
+// allocations of the same size. Slabs are returned to the system when the arena
+// is destroyed or, once none of their memory is in use, by ReleaseUnusedSlabs.
+// Not thread safe.
+class NodeArena {
+ public:
+  // Alignment of all allocations made by the arena.
+  static constexpr size_t kAlignment = alignof(std::max_align_t);
+
+  NodeArena() = default;
+  ~NodeArena() = default;
+
+  NodeArena(const NodeArena&) = delete;
+  NodeArena& operator=(const NodeArena&) = delete;
+
+  // Returns `size` bytes of memory aligned to kAlignment.
+  void* Allocate(size_t size);
+
+  // Releases memory returned by Allocate. `size` must be the size passed to
+  // the corresponding Allocate call.
+  void Deallocate(void* ptr, size_t size);
+
+  // Returns the slabs none of whose memory is in use to the system, e.g.
+  // after a large number of nodes have been removed. Returns the number of
+  // bytes released.
+  int64_t ReleaseUnusedSlabs();
+
+  // Makes the arena hold at least `size` contiguous bytes of fresh memory for
+  // upcoming allocations, so that they are served from a single slab rather
+  // than several as the arena grows.
+  void Reserve(size_t size);
+
+  // Returns the total number of bytes of slab memory held by the arena.
+  int64_t bytes_reserved() const { return bytes_reserved_; }
+
+  // Returns the number of bytes handed out by Allocate and not yet
+  // deallocated.
+  int64_t bytes_in_use() const { return bytes_in_use_; }
+
+ private:
+  static constexpr size_t kSlabSize = 64 * 1024;
+
+  struct FreeChunk {
+    FreeChunk* next;
+  };
+
+  static size_t RoundUp(size_t size) {
+    return (size + kAlignment - 1) & ~(kAlignment - 1);
+  }
+
+  struct Slab {
+    std::unique_ptr<char[]> memory;
+    size_t size;
+    // Number of bytes of the slab handed out by Allocate and not yet
+    // deallocated.
+    int64_t live_bytes = 0;
+  };
+
+  // Allocates a new slab of at least `size` bytes.
+  char* NewSlab(size_t size);
+
+  // Returns the slab containing `ptr`.
+  Slab& SlabContaining(const void* ptr);
+
+  // Slabs keyed by their start address.
+  std::map<const char*, Slab> slabs_;
+  char* cursor_ = nullptr;
+  char* end_ = nullptr;
+  int64_t bytes_reserved_ = 0;
+  int64_t bytes_in_use_ = 0;
+
+  // Free lists indexed by allocation size in units of kAlignment.
+  std::vector<FreeChunk*> free_lists_;
+
+  // Slab memory attributed to MemoryTag::kIrNodes.
+  MemoryAccount memory_account_{MemoryTag::kIrNodes};
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_NODE_ARENA_H_
@@ -0,0 +1,156 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/node_arena.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
+
+namespace xls {
+namespace {
+
+class NodeArenaTest : public IrTestBase {};
+
+TEST_F(NodeArenaTest, AllocationsAreAlignedAndContiguous) {
+  NodeArena arena;
+  char* a = static_cast<char*>(arena.Allocate(40));
+  char* b = static_cast<char*>(arena.Allocate(40));
+  char* c = static_cast<char*>(arena.Allocate(1));
+  for (char* p : {a, b, c}) {
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % NodeArena::kAlignment, 0);
+  }
+  EXPECT_EQ(b - a, 48);
+  EXPECT_EQ(c - b, 48);
+  EXPECT_EQ(arena.bytes_reserved(), 64 * 1024);
+}
+
+TEST_F(NodeArenaTest, FreedMemoryIsReused) {
+  NodeArena arena;
+  void* a = arena.Allocate(100);
+  void* b = arena.Allocate(200);
+  arena.Deallocate(a, 100);
+  arena.Deallocate(b, 200);
+  EXPECT_EQ(arena.Allocate(200), b);
+  EXPECT_EQ(arena.Allocate(100), a);
+  EXPECT_NE(arena.Allocate(100), a);
+}
+
+TEST_F(NodeArenaTest, OversizedAllocation) {
+  NodeArena arena;
+  void* a = arena.Allocate(1 << 20);
+  EXPECT_NE(a, nullptr);
+  EXPECT_EQ(arena.bytes_reserved(), 1 << 20);
+  arena.Deallocate(a, 1 << 20);
+  EXPECT_EQ(arena.Allocate(1 << 20), a);
+}
+
+TEST_F(NodeArenaTest, ReleaseUnusedSlabs) {
+  NodeArena arena;
+  // Fill two slabs, then a third that allocations are still carved from.
+  std::vector<void*> first;
+  std::vector<void*> second;
+  for (int64_t i = 0; i < 1024; ++i) {
+    first.push_back(arena.Allocate(64));
+  }
+  for (int64_t i = 0; i < 1024; ++i) {
+    second.push_back(arena.Allocate(64));
+  }
+  void* big = arena.Allocate(1 << 20);
+  void* last = arena.Allocate(64);
+  EXPECT_EQ(arena.bytes_reserved(), 3 * 64 * 1024 + (1 << 20));
+  EXPECT_EQ(arena.ReleaseUnusedSlabs(), 0);
+
+  // Only the slabs with no live allocations are released.
+  for (void* p : first) {
+    arena.Deallocate(p, 64);
+  }
+  arena.Deallocate(second.back(), 64);
+  arena.Deallocate(big, 1 << 20);
+  arena.Deallocate(last, 64);
+  EXPECT_EQ(arena.ReleaseUnusedSlabs(), 64 * 1024 + (1 << 20));
+  EXPECT_EQ(arena.bytes_reserved(), 2 * 64 * 1024);
+
+  // Free chunks of the released slabs are no longer handed out.
+  EXPECT_EQ(arena.Allocate(64), last);
+  EXPECT_EQ(arena.Allocate(64), second.back());
+  EXPECT_NE(arena.Allocate(64), first.back());
+  EXPECT_EQ(arena.bytes_reserved(), 2 * 64 * 1024);
+}
+
+TEST_F(NodeArenaTest, Reserve) {
+  NodeArena arena;
+  void* a = arena.Allocate(64);
+  EXPECT_EQ(arena.bytes_in_use(), 64);
+
+  // Reserving more than the current slab holds starts a new slab large enough
+  // for all the reserved bytes.
+  arena.Reserve(256 * 1024);
+  EXPECT_EQ(arena.bytes_reserved(), 64 * 1024 + 256 * 1024);
+  char* first = static_cast<char*>(arena.Allocate(64));
+  for (int64_t i = 1; i < 4095; ++i) {
+    EXPECT_EQ(arena.Allocate(64), first + 64 * i);
+  }
+  EXPECT_EQ(arena.bytes_reserved(), 64 * 1024 + 256 * 1024);
+
+  // Reserving what is already available is a no-op.
+  arena.Reserve(64);
+  EXPECT_EQ(arena.bytes_reserved(), 64 * 1024 + 256 * 1024);
+  EXPECT_EQ(arena.Allocate(64), first + 64 * 4095);
+
+  arena.Deallocate(a, 64);
+  EXPECT_EQ(arena.bytes_in_use(), 4096 * 64);
+}
+
+TEST_F(NodeArenaTest, FunctionNodesAreArenaAllocated) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue sum = fb.Add(x, y);
+  BValue neg = fb.Negate(sum);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(neg));
+
+  // Nodes created by the builder come from the function's arena and so lie
+  // within one slab.
+  uintptr_t lo = reinterpret_cast<uintptr_t>(x.node());
+  uintptr_t hi = reinterpret_cast<uintptr_t>(neg.node());
+  EXPECT_LT(lo, hi);
+  EXPECT_LT(hi - lo, 64 * 1024);
+
+  // Memory of a removed node is recycled for the next node of the same type.
+  Node* removed = neg.node();
+  XLS_ASSERT_OK(f->set_return_value(sum.node()));
+  XLS_ASSERT_OK(f->RemoveNode(removed));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * new_neg,
+      f->MakeNode<UnOp>(SourceInfo(), sum.node(), Op::kNeg));
+  EXPECT_EQ(new_neg, removed);
+
+  // Nodes allocated on the heap may still be added to a function.
+  Node* heap_node = f->AddNode(std::make_unique<UnOp>(
+      SourceInfo(), sum.node(), Op::kNot, /*name=*/"", f));
+  EXPECT_EQ(heap_node->operand(0), sum.node());
+  XLS_ASSERT_OK(f->RemoveNode(heap_node));
+}
+
+}  // namespace
+}  // namespace xls
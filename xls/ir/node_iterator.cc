@@ -14,20 +14,45 @@
 
 #include "xls/ir/node_iterator.h"
 
+#include <algorithm>
 #include <deque>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/logging/logging.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
 
 namespace xls {
 
-void NodeIterator::Initialize() {
+NodeIterator NodeIterator::Create(FunctionBase* f) {
+  absl::MutexLock lock(&f->topo_order_mutex_);
+  if (f->topo_order_ == nullptr) {
+    std::vector<Node*> order = f->reverse_topo_order_ == nullptr
+                                   ? ComputeReverseOrder(f)
+                                   : *f->reverse_topo_order_;
+    std::reverse(order.begin(), order.end());
+    f->topo_order_ =
+        std::make_shared<const std::vector<Node*>>(std::move(order));
+  }
+  return NodeIterator(f->topo_order_);
+}
+
+NodeIterator NodeIterator::CreateReverse(FunctionBase* f) {
+  absl::MutexLock lock(&f->topo_order_mutex_);
+  if (f->reverse_topo_order_ == nullptr) {
+    f->reverse_topo_order_ =
+        std::make_shared<const std::vector<Node*>>(ComputeReverseOrder(f));
+  }
+  return NodeIterator(f->reverse_topo_order_);
+}
+
+std::vector<Node*> NodeIterator::ComputeReverseOrder(FunctionBase* f) {
   // For topological traversal we only add nodes to the order when all of its
   // users have been scheduled.
   //
@@ -41,14 +66,14 @@ void NodeIterator::Initialize() {
   // keeps track of how many more users must be seen (before that node is ready
   // to place into the ordering).
   //
-  // NOTE: Initialize sorts reverse-topologically.  To sort topologically,
-  // reverse the this->ordered_
+  // NOTE: This sorts reverse-topologically. To sort topologically, reverse
+  // the result.
   absl::flat_hash_map<Node*, int64_t> pending_to_remaining_users;
-  pending_to_remaining_users.reserve(f_->node_count());
+  pending_to_remaining_users.reserve(f->node_count());
   std::deque<Node*> ready;
 
-  ordered_ = std::make_unique<std::vector<Node*>>();
-  ordered_->reserve(f_->node_count());
+  std::vector<Node*> ordered;
+  ordered.reserve(f->node_count());
 
   auto is_scheduled = [&](Node* n) {
     auto it = pending_to_remaining_users.find(n);
@@ -78,7 +103,7 @@ void NodeIterator::Initialize() {
     XLS_VLOG(5) << "Adding node to order: " << r;
     XLS_DCHECK(all_users_scheduled(r))
         << r << " users size: " << r->users().size();
-    ordered_->push_back(r);
+    ordered.push_back(r);
 
     // We want to be careful to only bump down our operands once, since we're a
     // single user, even though we may refer to them multiple times in our
@@ -107,7 +132,7 @@ void NodeIterator::Initialize() {
   };
 
   Node* return_value = nullptr;
-  for (Node* node : f_->nodes()) {
+  for (Node* node : f->nodes()) {
     if (node->users().empty()) {
       if (is_return_value(node)) {
         // Note: we special case the return value so it always comes at the
@@ -132,7 +157,7 @@ void NodeIterator::Initialize() {
     add_to_order(r);
   }
 
-  if (ordered_->size() < f_->node_count()) {
+  if (ordered.size() < f->node_count()) {
     // Not all nodes have been placed indicating a cycle in the graph. Run a
     // trivial DFS visitor which will emit an error message displaying the
     // cycle.
@@ -142,9 +167,10 @@ void NodeIterator::Initialize() {
       }
     };
     CycleChecker cycle_checker;
-    XLS_CHECK_OK(f_->Accept(&cycle_checker));
+    XLS_CHECK_OK(f->Accept(&cycle_checker));
     XLS_LOG(FATAL) << "Expected to find cycle in function base.";
   }
+  return ordered;
 }
 
 }  // namespace xls
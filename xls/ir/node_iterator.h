@@ -15,8 +15,8 @@
 #ifndef XLS_IR_NODE_ITERATOR_H_
 #define XLS_IR_NODE_ITERATOR_H_
 
-#include <algorithm>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "xls/ir/function_base.h"
@@ -27,38 +27,37 @@ namespace xls {
 // A type that orders the reachable nodes in a function into a usable traversal
 // order. Currently just does a stable topological ordering.
 //
+// The order is cached in the FunctionBase and reused until the graph changes
+// (nodes added or removed, operands replaced or reordered, or the return value
+// changed), so repeated sorts of an unchanged function are cheap. An iterator
+// holds a snapshot: mutating the function while iterating is safe, and the
+// iterator continues to yield the order as it was when created. Sorting an
+// unchanging function from several threads at once is safe.
+//
 // Note that this container value must outlive any iterators derived from it
 // (via begin()/end()).
 class NodeIterator {
  public:
-  static NodeIterator Create(FunctionBase* f) {
-    NodeIterator it(f);
-    it.Initialize();
-    std::reverse(it.ordered_->begin(), it.ordered_->end());
-    return it;
-  }
-
-  static NodeIterator CreateReverse(FunctionBase* f) {
-    NodeIterator it(f);
-    it.Initialize();
-    return it;
-  }
+  static NodeIterator Create(FunctionBase* f);
+  static NodeIterator CreateReverse(FunctionBase* f);
 
-  std::vector<Node*>::iterator begin() const { return ordered_->begin(); }
-  std::vector<Node*>::iterator end() const { return ordered_->end(); }
+  std::vector<Node*>::const_iterator begin() const { return ordered_->begin(); }
+  std::vector<Node*>::const_iterator end() const { return ordered_->end(); }
 
   const std::vector<Node*>& AsVector() const { return *ordered_; }
 
  private:
-  explicit NodeIterator(FunctionBase* f) : f_(f) {}
+  explicit NodeIterator(std::shared_ptr<const std::vector<Node*>> ordered)
+      : ordered_(std::move(ordered)) {}
 
-  void Initialize();
+  // Returns the nodes of `f` in reverse topological order.
+  static std::vector<Node*> ComputeReverseOrder(FunctionBase* f);
 
-  // The vector of nodes is wrapped in a unique_ptr so that the
-  // NodeIterator may be movable but the iterators returned to the
-  // caller of begin()/end() are not invalidated by those moves.
-  std::unique_ptr<std::vector<Node*>> ordered_;
-  FunctionBase* f_;
+  // The vector of nodes is shared with the cache in the FunctionBase. It is
+  // held by pointer so that the NodeIterator may be movable but the iterators
+  // returned to the caller of begin()/end() are not invalidated by those
+  // moves.
+  std::shared_ptr<const std::vector<Node*>> ordered_;
 };
 
 // Convenience function for concise use in foreach constructs; e.g.:
@@ -70,8 +69,8 @@ class NodeIterator {
 // Yields nodes in a stable topological traversal order (dependency ordering is
 // satisfied).
 //
-// Note that the ordering for all nodes is computed up front, *not*
-// incrementally as iteration proceeds.
+// Note that the ordering for all nodes is computed up front (or taken from the
+// function's cache), *not* incrementally as iteration proceeds.
 inline NodeIterator TopoSort(FunctionBase* f) {
   return NodeIterator::Create(f);
 }
@@ -26,6 +26,7 @@
 #include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/thread.h"
 #include "xls/ir/benchmark_support.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function.h"
@@ -281,6 +282,96 @@ TEST(NodeIteratorTest, RpoVsTopo) {
   EXPECT_EQ(rni.end(), it);
 }
 
+TEST(NodeIteratorTest, CachedOrderTracksGraphChanges) {
+  std::string program = R"(
+  fn computation(a: bits[32]) -> bits[32] {
+    t: bits[32] = neg(a)
+    b: bits[32] = neg(a)
+    c: bits[32] = neg(b)
+    ret d: bits[32] = add(c, t)
+  })";
+
+  Package p("p");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, Parser::ParseFunction(program, &p));
+  auto names = [](const NodeIterator& it) {
+    std::vector<std::string> result;
+    for (Node* node : it) {
+      result.push_back(node->GetName());
+    }
+    return result;
+  };
+
+  // An unchanged function reuses the cached order.
+  NodeIterator first = TopoSort(f);
+  NodeIterator second = TopoSort(f);
+  EXPECT_EQ(&first.AsVector(), &second.AsVector());
+  EXPECT_EQ(names(first),
+            std::vector<std::string>({"a", "b", "c", "t", "d"}));
+
+  // Swapping operands changes the order.
+  Node* d = f->return_value();
+  d->SwapOperands(0, 1);
+  EXPECT_EQ(names(TopoSort(f)),
+            std::vector<std::string>({"a", "b", "t", "c", "d"}));
+  // Existing iterators keep their snapshot.
+  EXPECT_EQ(names(first),
+            std::vector<std::string>({"a", "b", "c", "t", "d"}));
+
+  // Adding and replacing nodes.
+  XLS_ASSERT_OK_AND_ASSIGN(Node * t, f->GetNode("t"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * e,
+                           f->MakeNodeWithName<UnOp>(SourceInfo(), t, Op::kNot,
+                                                     "e"));
+  EXPECT_EQ(names(ReverseTopoSort(f)),
+            std::vector<std::string>({"d", "e", "c", "t", "b", "a"}));
+  XLS_ASSERT_OK(d->ReplaceOperandNumber(0, e));
+  EXPECT_EQ(names(TopoSort(f)),
+            std::vector<std::string>({"a", "t", "b", "e", "c", "d"}));
+
+  // Removing nodes and changing the return value.
+  XLS_ASSERT_OK(f->set_return_value(e));
+  XLS_ASSERT_OK(f->RemoveNode(d));
+  XLS_ASSERT_OK(f->RemoveNode(f->GetNode("c").value()));
+  XLS_ASSERT_OK(f->RemoveNode(f->GetNode("b").value()));
+  EXPECT_EQ(names(TopoSort(f)), std::vector<std::string>({"a", "t", "e"}));
+  EXPECT_EQ(names(ReverseTopoSort(f)),
+            std::vector<std::string>({"e", "t", "a"}));
+}
+
+TEST(NodeIteratorTest, ConcurrentSortsShareOneOrder) {
+  std::string program = R"(
+  fn computation(a: bits[32], b: bits[32]) -> bits[32] {
+    c: bits[32] = add(a, b)
+    d: bits[32] = neg(c)
+    e: bits[32] = not(b)
+    ret f: bits[32] = sub(d, e)
+  })";
+
+  Package p("p");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, Parser::ParseFunction(program, &p));
+  constexpr int64_t kThreadCount = 8;
+  std::vector<const std::vector<Node*>*> orders(kThreadCount);
+  std::vector<const std::vector<Node*>*> reverse_orders(kThreadCount);
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t i = 0; i < kThreadCount; ++i) {
+      threads.push_back(std::make_unique<Thread>([&, i]() {
+        // The cache keeps the vectors alive while the function is unchanged.
+        orders[i] = &TopoSort(f).AsVector();
+        reverse_orders[i] = &ReverseTopoSort(f).AsVector();
+      }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+  // Every thread got the one cached order.
+  for (int64_t i = 0; i < kThreadCount; ++i) {
+    EXPECT_EQ(orders[i], &TopoSort(f).AsVector());
+    EXPECT_EQ(reverse_orders[i], &ReverseTopoSort(f).AsVector());
+  }
+}
+
 void BM_TopoSortBinaryTree(benchmark::State& state) {
   std::unique_ptr<VerifiedPackage> p =
       std::make_unique<VerifiedPackage>("balanced_tree_pkg");
@@ -365,6 +365,30 @@ fn EqualityTest(x: bits[8], y: bits[8], z: bits[16]) -> bits[32] {
   EXPECT_FALSE(nodes_equal("bit_slice.17", "bit_slice.19"));
 }
 
+TEST_F(NodeTest, HasEqualAttributes) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn AttributeTest(x: bits[8], y: bits[8], z: bits[16]) -> bits[3] {
+  sign_ext.1: bits[20] = sign_ext(x, new_bit_count=20)
+  sign_ext.2: bits[20] = sign_ext(z, new_bit_count=20)
+  sign_ext.3: bits[24] = sign_ext(x, new_bit_count=24)
+  bit_slice.4: bits[3] = bit_slice(x, start=3, width=3)
+  bit_slice.5: bits[3] = bit_slice(z, start=3, width=3)
+  ret bit_slice.6: bits[3] = bit_slice(x, start=2, width=3)
+}
+)",
+                                                       p.get()));
+
+  auto attributes_equal = [&](std::string_view a, std::string_view b) {
+    return FindNode(a, f)->HasEqualAttributes(FindNode(b, f));
+  };
+  // Operand and result types are not considered.
+  EXPECT_TRUE(attributes_equal("sign_ext.1", "sign_ext.2"));
+  EXPECT_FALSE(attributes_equal("sign_ext.1", "sign_ext.3"));
+  EXPECT_TRUE(attributes_equal("bit_slice.4", "bit_slice.5"));
+  EXPECT_FALSE(attributes_equal("bit_slice.4", "bit_slice.6"));
+}
+
 TEST_F(NodeTest, CountedForEqualTo) {
   XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
 package CountedFor
@@ -560,6 +584,35 @@ TEST_F(NodeTest, NodeNames) {
   EXPECT_TRUE(f->return_value()->HasAssignedName());
 }
 
+TEST_F(NodeTest, NamesAndLocationsAreInterned) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  SourceInfo loc(SourceLocation(Fileno(1), Lineno(2), Colno(3)));
+  BValue x = fb.Param("x", p->GetBitsType(32), loc);
+  BValue a = fb.Add(x, x, loc, "sum");
+  BValue b = fb.Add(a, x, loc, "sum");
+  BValue c = fb.Add(b, x, loc, "sum__7");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(c));
+
+  EXPECT_EQ(a.node()->GetName(), "sum");
+  EXPECT_EQ(b.node()->GetName(), "sum__1");
+  EXPECT_EQ(c.node()->GetName(), "sum__7");
+  EXPECT_EQ(f->param(0)->As<Param>()->name(), "x");
+
+  // Nodes with equal locations share one entry of the package's table.
+  EXPECT_EQ(&a.node()->loc(), &b.node()->loc());
+  EXPECT_EQ(&x.node()->loc(), &c.node()->loc());
+  EXPECT_EQ(a.node()->loc().ToString(), "[(1,2,3)]");
+
+  b.node()->SetLoc(SourceInfo());
+  EXPECT_TRUE(b.node()->loc().Empty());
+  EXPECT_EQ(a.node()->loc().ToString(), "[(1,2,3)]");
+
+  // A parameter renamed to a suffixed name still has a viewable name.
+  f->param(0)->SetName("sum");
+  EXPECT_EQ(f->param(0)->As<Param>()->name(), "sum__2");
+}
+
 TEST_F(NodeTest, IsDead) {
   auto p = CreatePackage();
   XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
@@ -575,6 +628,41 @@ fn ReplaceUses(x: bits[8], y: bits[8]) -> bits[8] {
   EXPECT_TRUE(FindNode("y", f)->IsDead());
 }
 
+TEST_F(NodeTest, StructuralHash) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  add1: bits[8] = add(x, y)
+  add2: bits[8] = add(y, x)
+  sub1: bits[8] = sub(x, y)
+  sub2: bits[8] = sub(y, x)
+  slice1: bits[4] = bit_slice(x, start=0, width=4)
+  slice2: bits[4] = bit_slice(x, start=0, width=4)
+  slice3: bits[4] = bit_slice(x, start=4, width=4)
+  literal1: bits[8] = literal(value=42)
+  literal2: bits[8] = literal(value=42)
+  literal3: bits[8] = literal(value=43)
+  ret result: bits[8] = and(add1, add2)
+}
+)",
+                                                       p.get()));
+  auto hash = [&](std::string_view name) {
+    return FindNode(name, f)->StructuralHash();
+  };
+  // Equal nodes hash equally, regardless of the operand order of commutative
+  // ops.
+  EXPECT_EQ(hash("add1"), hash("add2"));
+  EXPECT_EQ(hash("slice1"), hash("slice2"));
+  EXPECT_EQ(hash("literal1"), hash("literal2"));
+
+  // Differences in the op, the order of operands of non-commutative ops or
+  // the attributes are reflected in the hash.
+  EXPECT_NE(hash("add1"), hash("sub1"));
+  EXPECT_NE(hash("sub1"), hash("sub2"));
+  EXPECT_NE(hash("slice1"), hash("slice3"));
+  EXPECT_NE(hash("literal1"), hash("literal3"));
+}
+
 TEST_F(NodeTest, IncorrectOpClass) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
@@ -52,17 +52,23 @@ class DataMember(object):
     equals_tmpl: A Python format string defining the expression for testing this
       member for equality. The format fields are named 'lhs' and 'rhs'. Example:
       '{lhs}.EqualTo({rhs})'.
+    hash_tmpl: A Python format string defining the expression hashed for this
+      member in Node::AttributeHash, or None if the member is not hashed. The
+      format field is named 'member'. Members equal according to equals_tmpl
+      must hash equally.
   """
 
   def __init__(self,
                name: str,
                cpp_type: str,
                init: str,
-               equals_tmpl: str = '{lhs} == {rhs}'):
+               equals_tmpl: str = '{lhs} == {rhs}',
+               hash_tmpl: Optional[str] = '{member}'):
     self.name = name
     self.cpp_type = cpp_type
     self.init = init
     self.equals_tmpl = equals_tmpl
+    self.hash_tmpl = hash_tmpl
 
 
 class Method(object):
@@ -115,6 +121,7 @@ class Attribute(object):
                arg_cpp_type: Optional[str] = None,
                return_cpp_type: Optional[str] = None,
                equals_tmpl: str = '{lhs} == {rhs}',
+               hash_tmpl: Optional[str] = '{member}',
                init_args=None):
     """Initialize an Attribute.
 
@@ -130,6 +137,8 @@ class Attribute(object):
       equals_tmpl: A Python format string defining the expression for testing
         this member for equality. The format fields are named 'lhs' and 'rhs'.
         For example, '{lhs}.EqualTo({rhs})'.
+      hash_tmpl: A Python format string defining the expression hashed for
+        this member, or None if it is not hashed. See DataMember.
       init_args: Optional arguments to pass to the data member constructor. If
         not specified, this is 'name', the name of the attribute constructor
         argument.
@@ -144,7 +153,8 @@ class Attribute(object):
         name=name + '_',
         cpp_type=cpp_type,
         init=name if init_args is None else ', '.join(init_args),
-        equals_tmpl=equals_tmpl)
+        equals_tmpl=equals_tmpl,
+        hash_tmpl=hash_tmpl)
     self.method = Method(
         name=name,
         return_cpp_type=cpp_type
@@ -167,7 +177,9 @@ class Int64Attribute(Attribute):
 class TypeAttribute(Attribute):
 
   def __init__(self, name):
-    super(TypeAttribute, self).__init__(name, cpp_type='Type*')
+    # Types are compared structurally so hash a structural property.
+    super(TypeAttribute, self).__init__(
+        name, cpp_type='Type*', hash_tmpl='{member}->GetFlatBitCount()')
 
 
 class FunctionAttribute(Attribute):
@@ -176,7 +188,8 @@ class FunctionAttribute(Attribute):
     super(FunctionAttribute, self).__init__(
         name,
         cpp_type='Function*',
-        equals_tmpl='{lhs}->IsDefinitelyEqualTo({rhs})')
+        equals_tmpl='{lhs}->IsDefinitelyEqualTo({rhs})',
+        hash_tmpl=None)
 
 
 class ValueAttribute(Attribute):
@@ -186,6 +199,27 @@ class ValueAttribute(Attribute):
         name, cpp_type='Value', return_cpp_type='const Value&')
 
 
+class InternedValueAttribute(Attribute):
+  """A Value attribute stored in the package's interning table.
+
+  Identical values within a package share a single copy, so equality reduces
+  to pointer identity for nodes in the same package.
+  """
+
+  def __init__(self, name):
+    super(InternedValueAttribute, self).__init__(
+        name,
+        cpp_type='std::shared_ptr<const Value>',
+        arg_cpp_type='Value',
+        return_cpp_type='const Value&',
+        equals_tmpl=('({lhs} == {rhs} || (package() != other->package() && '
+                     '*{lhs} == *{rhs}))'),
+        # Within a package identical values share an address.
+        hash_tmpl='{member}.get()',
+        init_args=['function->package()->InternValue(value)'])
+    self.method.expression = '*' + self.data_member.name
+
+
 class StringAttribute(Attribute):
 
   def __init__(self, name):
@@ -225,6 +259,7 @@ class TypeVectorAttribute(Attribute):
         cpp_type='std::vector<Type*>',
         return_cpp_type='absl::Span<Type* const>',
         arg_cpp_type='absl::Span<Type* const>',
+        hash_tmpl='{member}.size()',
         init_args=(f'{name}.begin()', f'{name}.end()'))
 
 
@@ -236,6 +271,7 @@ class FormatStepsAttribute(Attribute):
         cpp_type='std::vector<FormatStep>',
         return_cpp_type='absl::Span<FormatStep const>',
         arg_cpp_type='absl::Span<FormatStep const>',
+        hash_tmpl='{member}.size()',
         init_args=(f'{name}.begin()', f'{name}.end()'))
 
 
@@ -371,7 +407,7 @@ class OpClass(object):
     args.extend('{}()'.format(a.name) for a in self.attributes)
     args.extend(a.clone_expression for a in self.extra_constructor_args)
     if 'name' not in [a.name for a in self.extra_constructor_args]:
-      args.append('name_')
+      args.append('GetAssignedName()')
     return ', '.join(args)
 
   def data_members(self) -> List[DataMember]:
@@ -391,6 +427,15 @@ class OpClass(object):
     assert self.data_members()
     return '&& '.join(data_member_equal(m) for m in self.data_members())
 
+  def hash_expr(self) -> Optional[str]:
+    """Returns the arguments hashed in AttributeHash, or None if none are."""
+    exprs = [
+        m.hash_tmpl.format(member=m.name)
+        for m in self.data_members()
+        if m.hash_tmpl is not None
+    ]
+    return ', '.join(exprs) if exprs else None
+
 
 class Op(object):
   """Describes an xls::Op.
@@ -779,7 +824,7 @@ OpClass.kinds['LITERAL'] = OpClass(
     op='Op::kLiteral',
     operands=[],
     xls_type_expression='function->package()->GetTypeForValue(value)',
-    attributes=[ValueAttribute('value')],
+    attributes=[InternedValueAttribute('value')],
     extra_methods=[Method('IsZero', 'bool',
                           'value().IsBits() && value().bits().IsZero()')],
 )
@@ -852,7 +897,7 @@ OpClass.kinds['PARAM'] = OpClass(
                                                 clone_expression='GetType()')],
     extra_methods=[Method(name='name',
                           return_cpp_type='std::string_view',
-                          expression='name_')],
+                          expression='GetAssignedNameView()')],
     custom_clone_method=True
 )
 
@@ -953,7 +998,7 @@ OpClass.kinds['INPUT_PORT'] = OpClass(
                                                 clone_expression='GetType()')],
     extra_methods=[Method(name='name',
                           return_cpp_type='std::string_view',
-                          expression='name_')],
+                          expression='GetAssignedNameView()')],
 )
 
 OpClass.kinds['OUTPUT_PORT'] = OpClass(
@@ -966,7 +1011,7 @@ OpClass.kinds['OUTPUT_PORT'] = OpClass(
                                                 clone_expression='name()')],
     extra_methods=[Method(name='name',
                           return_cpp_type='std::string_view',
-                          expression='name_')],
+                          expression='GetAssignedNameView()')],
 )
 
 OpClass.kinds['REGISTER_READ'] = OpClass(
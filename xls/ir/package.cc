@@ -27,6 +27,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -56,7 +57,29 @@
 
 namespace xls {
 
-Package::Package(std::string_view name) : name_(name) {
+// Maps each live interned value to the weak reference handed out for it. The
+// key points at the interned value itself which is removed from the table
+// before it is destroyed.
+struct Package::InternedValueTable {
+  struct Hash {
+    using is_transparent = void;
+    size_t operator()(const Value* value) const {
+      return absl::HashOf(*value);
+    }
+  };
+  struct Eq {
+    using is_transparent = void;
+    bool operator()(const Value* a, const Value* b) const { return *a == *b; }
+  };
+  absl::Mutex mutex;
+  absl::flat_hash_map<const Value*, std::weak_ptr<const Value>, Hash, Eq>
+      values ABSL_GUARDED_BY(mutex);
+};
+
+Package::Package(std::string_view name)
+    : name_(name),
+      interned_values_(std::make_shared<InternedValueTable>()) {
+  absl::MutexLock lock(&types_mutex_);
   owned_types_.insert(&token_type_);
 }
 
@@ -147,6 +170,9 @@ absl::StatusOr<FunctionBase*> Package::GetFunctionBaseByName(
 }
 
 Function* Package::AddFunction(std::unique_ptr<Function> f) {
+  // With duplicate names, the scan in GetFunction finds the earliest function,
+  // so keep the existing entry.
+  function_name_index_.try_emplace(f->name(), f.get());
   functions_.push_back(std::move(f));
   return functions_.back().get();
 }
@@ -320,10 +346,9 @@ absl::StatusOr<Package::PackageMergeResult> Package::AddPackage(
 
 absl::StatusOr<Function*> Package::GetFunction(
     std::string_view func_name) const {
-  for (auto& f : functions_) {
-    if (f->name() == func_name) {
-      return f.get();
-    }
+  if (auto it = function_name_index_.find(func_name);
+      it != function_name_index_.end()) {
+    return it->second;
   }
   return absl::NotFoundError(absl::StrFormat(
       "Package does not have a function with name: \"%s\"; available: [%s]",
@@ -401,10 +426,30 @@ absl::Status Package::RemoveFunction(Function* function) {
     return absl::NotFoundError(absl::StrFormat(
         "`%s` is not a function in package `%s`", function->name(), name()));
   }
+  std::string name = function->name();
   functions_.erase(it, functions_.end());
+  ReindexFunctionName(name);
   return absl::OkStatus();
 }
 
+void Package::OnFunctionRenamed(Function* function,
+                                std::string_view old_name) {
+  // Renames are rare, so the entries of both names are recomputed. This also
+  // handles functions renamed before being added to the package.
+  ReindexFunctionName(old_name);
+  ReindexFunctionName(function->name());
+}
+
+void Package::ReindexFunctionName(std::string_view name) {
+  function_name_index_.erase(name);
+  for (const std::unique_ptr<Function>& f : functions_) {
+    if (f->name() == name) {
+      function_name_index_.emplace(name, f.get());
+      return;
+    }
+  }
+}
+
 absl::Status Package::RemoveProc(Proc* proc) {
   if (top_.has_value() && top_.value() == proc) {
     return absl::InvalidArgumentError(absl::StrFormat(
@@ -488,6 +533,7 @@ absl::StatusOr<Type*> Package::MapTypeFromOtherPackage(
 }
 
 BitsType* Package::GetBitsType(int64_t bit_count) {
+  absl::MutexLock lock(&types_mutex_);
   if (bit_count_to_type_.find(bit_count) != bit_count_to_type_.end()) {
     return &bit_count_to_type_.at(bit_count);
   }
@@ -499,10 +545,11 @@ BitsType* Package::GetBitsType(int64_t bit_count) {
 
 ArrayType* Package::GetArrayType(int64_t size, Type* element_type) {
   ArrayKey key{size, element_type};
+  absl::MutexLock lock(&types_mutex_);
   if (array_types_.find(key) != array_types_.end()) {
     return &array_types_.at(key);
   }
-  XLS_CHECK(IsOwnedType(element_type))
+  XLS_CHECK(IsOwnedTypeLocked(element_type))
       << "Type is not owned by package: " << *element_type;
   auto it = array_types_.emplace(key, ArrayType(size, element_type));
   ArrayType* new_type = &(it.first->second);
@@ -512,11 +559,12 @@ ArrayType* Package::GetArrayType(int64_t size, Type* element_type) {
 
 TupleType* Package::GetTupleType(absl::Span<Type* const> element_types) {
   TypeVec key(element_types.begin(), element_types.end());
+  absl::MutexLock lock(&types_mutex_);
   if (tuple_types_.find(key) != tuple_types_.end()) {
     return &tuple_types_.at(key);
   }
   for (const Type* element_type : element_types) {
-    XLS_CHECK(IsOwnedType(element_type))
+    XLS_CHECK(IsOwnedTypeLocked(element_type))
         << "Type is not owned by package: " << *element_type;
   }
   auto it = tuple_types_.emplace(key, TupleType(element_types));
@@ -530,11 +578,12 @@ TokenType* Package::GetTokenType() { return &token_type_; }
 FunctionType* Package::GetFunctionType(absl::Span<Type* const> args_types,
                                        Type* return_type) {
   std::string key = FunctionType(args_types, return_type).ToString();
+  absl::MutexLock lock(&types_mutex_);
   if (function_types_.find(key) != function_types_.end()) {
     return &function_types_.at(key);
   }
   for (Type* t : args_types) {
-    XLS_CHECK(IsOwnedType(t))
+    XLS_CHECK(IsOwnedTypeLocked(t))
         << "Parameter type is not owned by package: " << t->ToString();
   }
   auto it = function_types_.emplace(key, FunctionType(args_types, return_type));
@@ -624,6 +673,39 @@ Type* Package::GetTypeForValue(const Value& value) {
   XLS_LOG(FATAL) << "Invalid value for type extraction.";
 }
 
+std::shared_ptr<const Value> Package::InternValue(const Value& value) {
+  absl::MutexLock lock(&interned_values_->mutex);
+  auto it = interned_values_->values.find(&value);
+  if (it != interned_values_->values.end()) {
+    if (std::shared_ptr<const Value> existing = it->second.lock()) {
+      return existing;
+    }
+    // The value is concurrently being released by another thread whose
+    // deleter has not yet removed it from the table; supersede it.
+    interned_values_->values.erase(it);
+  }
+  std::weak_ptr<InternedValueTable> table = interned_values_;
+  std::shared_ptr<const Value> interned(
+      new Value(value), [table](const Value* interned_value) {
+        if (std::shared_ptr<InternedValueTable> t = table.lock()) {
+          absl::MutexLock lock(&t->mutex);
+          auto it = t->values.find(interned_value);
+          // The entry may have been superseded by an equal value.
+          if (it != t->values.end() && it->first == interned_value) {
+            t->values.erase(it);
+          }
+        }
+        delete interned_value;
+      });
+  interned_values_->values.emplace(interned.get(), interned);
+  return interned;
+}
+
+int64_t Package::interned_value_count() const {
+  absl::MutexLock lock(&interned_values_->mutex);
+  return interned_values_->values.size();
+}
+
 Fileno Package::GetOrCreateFileno(std::string_view filename) {
   // Attempt to add a new fileno/filename pair to the map.
   if (auto it = filename_to_fileno_.find(std::string(filename));
@@ -771,12 +853,7 @@ std::vector<std::string> Package::GetFunctionNames() const {
 }
 
 bool Package::HasFunctionWithName(std::string_view target) const {
-  for (const std::unique_ptr<Function>& function : functions_) {
-    if (function->name() == target) {
-      return true;
-    }
-  }
-  return false;
+  return function_name_index_.contains(target);
 }
 
 namespace {
@@ -821,19 +898,32 @@ absl::StatusOr<SingleValueChannel*> Package::CreateSingleValueChannel(
 }
 
 absl::Status Package::RemoveChannel(Channel* channel) {
-  // First check that the channel is owned by this package.
-  auto it = std::find(channel_vec_.begin(), channel_vec_.end(), channel);
-  XLS_RET_CHECK(it != channel_vec_.end()) << "Channel not owned by package";
+  return RemoveChannels({channel});
+}
+
+absl::Status Package::RemoveChannels(absl::Span<Channel* const> channels) {
+  absl::flat_hash_set<int64_t> channel_ids;
+  for (Channel* channel : channels) {
+    // First check that the channel is owned by this package.
+    XLS_RET_CHECK(channels_.contains(channel->id()) &&
+                  channels_.at(channel->id()).get() == channel)
+        << "Channel not owned by package";
+    channel_ids.insert(channel->id());
+  }
 
-  // Check that no send/receive nodes are associted with the channel.
+  // Check that no send/receive nodes are associted with the channels.
   // TODO(https://github.com/google/xls/issues/411) 2012/04/24 Avoid iterating
   // through all the nodes after channels are mapped to send/receive nodes.
   for (const auto& proc : procs()) {
     for (Node* node : proc->nodes()) {
-      if ((node->Is<Send>() &&
-           node->As<Send>()->channel_id() == channel->id()) ||
-          (node->Is<Receive>() &&
-           node->As<Receive>()->channel_id() == channel->id())) {
+      std::optional<int64_t> channel_id;
+      if (node->Is<Send>()) {
+        channel_id = node->As<Send>()->channel_id();
+      } else if (node->Is<Receive>()) {
+        channel_id = node->As<Receive>()->channel_id();
+      }
+      if (channel_id.has_value() && channel_ids.contains(*channel_id)) {
+        Channel* channel = channels_.at(*channel_id).get();
         return absl::InternalError(absl::StrFormat(
             "Channel %s (id=%d) cannot be removed because it "
             "is used by node %v in %v",
@@ -843,11 +933,16 @@ absl::Status Package::RemoveChannel(Channel* channel) {
   }
 
   // Remove from channel vector.
-  channel_vec_.erase(it);
+  channel_vec_.erase(std::remove_if(channel_vec_.begin(), channel_vec_.end(),
+                                    [&](Channel* ch) {
+                                      return channel_ids.contains(ch->id());
+                                    }),
+                     channel_vec_.end());
 
   // Remove from channel map.
-  XLS_RET_CHECK(channels_.contains(channel->id()));
-  channels_.erase(channel->id());
+  for (int64_t id : channel_ids) {
+    channels_.erase(id);
+  }
 
   return absl::OkStatus();
 }
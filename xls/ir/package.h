@@ -30,6 +30,7 @@
 #include "absl/container/node_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel.pb.h"
@@ -80,10 +81,15 @@ class Package {
   absl::StatusOr<FunctionBase*> GetFunctionBaseByName(std::string_view name);
 
   // Returns whether the given type is one of the types owned by this package.
+  //
+  // The type accessors below, along with InternValue, are thread safe so that
+  // passes may process different functions of the package concurrently.
   bool IsOwnedType(const Type* type) const {
-    return owned_types_.find(type) != owned_types_.end();
+    absl::MutexLock lock(&types_mutex_);
+    return IsOwnedTypeLocked(type);
   }
   bool IsOwnedFunctionType(const FunctionType* function_type) const {
+    absl::MutexLock lock(&types_mutex_);
     return owned_function_types_.find(function_type) !=
            owned_function_types_.end();
   }
@@ -106,6 +112,16 @@ class Package {
 
   Type* GetTypeForValue(const Value& value);
 
+  // Returns a shared immutable copy of `value`, deduplicated against all other
+  // live values interned in this package: two values interned in the same
+  // package are equal iff they are the same object. Literal nodes hold their
+  // values this way so that identical literals share storage. An interned
+  // value is released when the last reference to it is dropped.
+  std::shared_ptr<const Value> InternValue(const Value& value);
+
+  // Returns the number of distinct live values interned in this package.
+  int64_t interned_value_count() const;
+
   // Add a function, proc, or block to the package. Ownership is tranferred to
   // the package.
   Function* AddFunction(std::unique_ptr<Function> f);
@@ -179,6 +195,9 @@ class Package {
   // Get the filename corresponding to the given `Fileno`.
   std::optional<std::string> GetFilename(Fileno file_number) const;
 
+  // Deduplicated storage of the source locations of the nodes of this package.
+  SourceInfoTable& source_info_table() { return source_info_table_; }
+
   // Returns the total number of nodes in the graph. Traverses the functions and
   // sums the node counts.
   int64_t GetNodeCount() const;
@@ -263,6 +282,12 @@ class Package {
   // nodes an error is returned.
   absl::Status RemoveChannel(Channel* channel);
 
+  // Removes the given channels. Equivalent to calling RemoveChannel on each
+  // channel but only scans the nodes of the package once. If any of the
+  // channels has associated send/receive nodes an error is returned and no
+  // channel is removed.
+  absl::Status RemoveChannels(absl::Span<Channel* const> channels);
+
   // Builder to collect overrides when cloning channels.
   // Each field is optional where std::nullopt indicates that the cloned channel
   // should share the same value as the original. If a field contains a value,
@@ -339,9 +364,18 @@ class Package {
  private:
   std::vector<std::string> GetChannelNames() const;
 
+  // Updates `function_name_index_` after `function` is renamed from
+  // `old_name`.
+  void OnFunctionRenamed(Function* function, std::string_view old_name);
+
+  // Points the entry of `name` in `function_name_index_` at the first function
+  // with that name, or removes it if there is none.
+  void ReindexFunctionName(std::string_view name);
+
   // Adds the given channel to the package.
   absl::Status AddChannel(std::unique_ptr<Channel> channel);
 
+  friend class FunctionBase;
   friend class FunctionBuilder;
 
   std::optional<FunctionBase*> top_;
@@ -356,37 +390,64 @@ class Package {
   // Ordinal to assign to the next node created in this package.
   int64_t next_node_id_ = 1;
 
+  // Interned SourceInfos of the nodes of this package. Declared before the
+  // functions so it outlives their nodes.
+  SourceInfoTable source_info_table_;
+
+  // Table of live interned values. Shared so that interned values which
+  // outlive the package can detect that the table is gone.
+  struct InternedValueTable;
+  std::shared_ptr<InternedValueTable> interned_values_;
+
   std::vector<std::unique_ptr<Function>> functions_;
+  // Index of functions by name, to avoid linear scans in GetFunction and
+  // HasFunctionWithName when packages hold many functions. With duplicate
+  // names, holds the first function with the name. Kept up to date by
+  // AddFunction, RemoveFunction and FunctionBase::SetName.
+  absl::flat_hash_map<std::string, Function*> function_name_index_;
   std::vector<std::unique_ptr<Proc>> procs_;
   std::vector<std::unique_ptr<Block>> blocks_;
 
+  bool IsOwnedTypeLocked(const Type* type) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(types_mutex_) {
+    return owned_types_.find(type) != owned_types_.end();
+  }
+
+  // Guards the owned type tables below.
+  mutable absl::Mutex types_mutex_;
+
   // Set of owned types in this package.
-  absl::flat_hash_set<const Type*> owned_types_;
+  absl::flat_hash_set<const Type*> owned_types_ ABSL_GUARDED_BY(types_mutex_);
 
   // Set of owned function types in this package.
-  absl::flat_hash_set<const FunctionType*> owned_function_types_;
+  absl::flat_hash_set<const FunctionType*> owned_function_types_
+      ABSL_GUARDED_BY(types_mutex_);
 
   // Mapping from bit count to the owned "bits" type with that many bits. Use
   // node_hash_map for pointer stability.
-  absl::node_hash_map<int64_t, BitsType> bit_count_to_type_;
+  absl::node_hash_map<int64_t, BitsType> bit_count_to_type_
+      ABSL_GUARDED_BY(types_mutex_);
 
   // Mapping from the size and element type of an array type to the owned
   // ArrayType. Use node_hash_map for pointer stability.
   using ArrayKey = std::pair<int64_t, const Type*>;
-  absl::node_hash_map<ArrayKey, ArrayType> array_types_;
+  absl::node_hash_map<ArrayKey, ArrayType> array_types_
+      ABSL_GUARDED_BY(types_mutex_);
 
   // Mapping from elements to the owned tuple type.
   //
   // Uses node_hash_map for pointer stability.
   using TypeVec = absl::InlinedVector<const Type*, 4>;
-  absl::node_hash_map<TypeVec, TupleType> tuple_types_;
+  absl::node_hash_map<TypeVec, TupleType> tuple_types_
+      ABSL_GUARDED_BY(types_mutex_);
 
   // Owned token type.
   TokenType token_type_;
 
   // Mapping from Type:ToString to the owned function type. Use
   // node_hash_map for pointer stability.
-  absl::node_hash_map<std::string, FunctionType> function_types_;
+  absl::node_hash_map<std::string, FunctionType> function_types_
+      ABSL_GUARDED_BY(types_mutex_);
 
   // The largest `Fileno` used in this `Package`.
   std::optional<Fileno> maximum_fileno_;
@@ -15,6 +15,7 @@
 #include "xls/ir/package.h"
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string_view>
 #include <vector>
@@ -32,6 +33,7 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/xls_type.pb.h"
@@ -133,6 +135,43 @@ TEST_F(PackageTest, GetTokenType) {
   EXPECT_EQ("token", my_token_type->ToString());
 }
 
+TEST_F(PackageTest, InternValue) {
+  Package p(TestName());
+  EXPECT_EQ(p.interned_value_count(), 0);
+  std::shared_ptr<const Value> a = p.InternValue(Value(UBits(42, 32)));
+  std::shared_ptr<const Value> b = p.InternValue(Value(UBits(42, 32)));
+  std::shared_ptr<const Value> c = p.InternValue(Value(UBits(42, 33)));
+  std::shared_ptr<const Value> d =
+      p.InternValue(Value::Tuple({Value(UBits(42, 32))}));
+  EXPECT_EQ(a.get(), b.get());
+  EXPECT_NE(a.get(), c.get());
+  EXPECT_NE(a.get(), d.get());
+  EXPECT_EQ(*a, Value(UBits(42, 32)));
+  EXPECT_EQ(p.interned_value_count(), 3);
+
+  // Values are released once no longer referenced.
+  a.reset();
+  EXPECT_EQ(p.interned_value_count(), 3);
+  b.reset();
+  EXPECT_EQ(p.interned_value_count(), 2);
+  EXPECT_EQ(*p.InternValue(Value(UBits(42, 32))), Value(UBits(42, 32)));
+}
+
+TEST_F(PackageTest, LiteralsShareInternedValues) {
+  Package p(TestName());
+  FunctionBuilder fb(TestName(), &p);
+  BValue x = fb.Literal(UBits(7, 16));
+  BValue y = fb.Literal(UBits(7, 16));
+  BValue z = fb.Literal(UBits(8, 16));
+  fb.Concat({x, y, z});
+  XLS_ASSERT_OK(fb.Build().status());
+  EXPECT_EQ(&x.node()->As<Literal>()->value(),
+            &y.node()->As<Literal>()->value());
+  EXPECT_TRUE(x.node()->IsDefinitelyEqualTo(y.node()));
+  EXPECT_FALSE(x.node()->IsDefinitelyEqualTo(z.node()));
+  EXPECT_EQ(p.interned_value_count(), 2);
+}
+
 TEST_F(PackageTest, MapTypeFromOtherPackageBitsTypes) {
   Package p(TestName());
   Package other_package("other_package");
@@ -392,6 +431,33 @@ TEST_F(PackageTest, ChannelRemoval) {
                        HasSubstr("cannot be removed because it is used")));
 }
 
+TEST_F(PackageTest, MultipleChannelRemoval) {
+  Package p(TestName());
+
+  std::vector<Channel*> channels;
+  for (int64_t i = 0; i < 4; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Channel * ch,
+        p.CreateStreamingChannel(absl::StrCat("ch", i), ChannelOps::kSendOnly,
+                                 p.GetBitsType(32)));
+    channels.push_back(ch);
+  }
+  TokenlessProcBuilder b(TestName(), "tkn", &p);
+  b.Send(channels[0], b.Literal(Value(UBits(42, 32))));
+  XLS_ASSERT_OK(b.Build({}).status());
+
+  // Removing a set of channels which includes one in use removes nothing.
+  EXPECT_THAT(p.RemoveChannels({channels[0], channels[1]}),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("cannot be removed because it is used")));
+  EXPECT_EQ(p.channels().size(), 4);
+
+  int64_t ch1_id = channels[1]->id();
+  XLS_ASSERT_OK(p.RemoveChannels({channels[3], channels[1]}));
+  EXPECT_THAT(p.channels(), ElementsAre(channels[0], channels[2]));
+  EXPECT_FALSE(p.HasChannelWithId(ch1_id));
+}
+
 TEST_F(PackageTest, CloneSingleValueChannelSamePackage) {
   Package p(TestName());
 
@@ -1086,6 +1152,43 @@ block my_block(a: bits[32], b: bits[32], out: bits[32]) {
   XLS_EXPECT_OK(pkg1->GetBlock("my_block_1"));
 }
 
+TEST_F(PackageTest, GetFunctionAfterRenameAndRemove) {
+  constexpr std::string_view text = R"(
+package my_package
+
+fn f(x: bits[32]) -> bits[32] {
+  ret identity.1: bits[32] = identity(x)
+}
+
+fn g(x: bits[32]) -> bits[32] {
+  ret neg.2: bits[32] = neg(x)
+}
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(auto pkg, ParsePackage(text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, pkg->GetFunction("f"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * g, pkg->GetFunction("g"));
+  EXPECT_TRUE(pkg->HasFunctionWithName("f"));
+
+  f->SetName("renamed_f");
+  EXPECT_FALSE(pkg->HasFunctionWithName("f"));
+  EXPECT_THAT(pkg->GetFunction("f"), StatusIs(absl::StatusCode::kNotFound));
+  EXPECT_THAT(pkg->GetFunction("renamed_f"), IsOkAndHolds(f));
+
+  g->SetName("f");
+  EXPECT_THAT(pkg->GetFunction("f"), IsOkAndHolds(g));
+
+  // With duplicate names the first function is found, and the other one once
+  // the first is renamed away.
+  f->SetName("f");
+  EXPECT_THAT(pkg->GetFunction("f"), IsOkAndHolds(f));
+  f->SetName("renamed_f");
+  EXPECT_THAT(pkg->GetFunction("f"), IsOkAndHolds(g));
+
+  XLS_ASSERT_OK(pkg->RemoveFunction(g));
+  EXPECT_FALSE(pkg->HasFunctionWithName("f"));
+  EXPECT_THAT(pkg->GetFunction("renamed_f"), IsOkAndHolds(f));
+}
+
 // TODO(google/xls#917): Remove this test when empty arrays are supported.
 TEST_F(PackageTest, EmptyArrayIsError) {
   constexpr std::string_view text = R"(
@@ -102,6 +102,9 @@ absl::Status Proc::SetNextToken(Node* next) {
         "Cannot set next token to \"%s\", expected token type but has type %s",
         next->GetName(), next->GetType()->ToString()));
   }
+  if (next_token_ != next) {
+    NoteGraphChange();
+  }
   next_token_ = next;
   return absl::OkStatus();
 }
@@ -136,6 +139,9 @@ absl::Status Proc::SetNextStateElement(int64_t index, Node* next) {
         index, next->GetName(), next->GetType()->ToString(),
         GetStateElementType(index)->ToString()));
   }
+  if (next_state_[index] != next) {
+    NoteGraphChange();
+  }
   next_state_indices_[next_state_[index]].erase(index);
   next_state_[index] = next;
   next_state_indices_[next].insert(index);
@@ -47,7 +47,7 @@ class Proc : public FunctionBase {
   Proc(std::string_view name, std::string_view token_param_name,
        Package* package)
       : FunctionBase(name, package),
-        next_token_(AddNode(std::make_unique<Param>(
+        next_token_(AddNode(AllocateNode<Param>(
             SourceInfo(), token_param_name, package->GetTokenType(), this))) {}
 
   ~Proc() override = default;
@@ -0,0 +1,48 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/source_location.h"
+
+#include <cstdint>
+
+#include "absl/synchronization/mutex.h"
+
+namespace xls {
+
+SourceInfoTable::SourceInfoTable() {
+  absl::MutexLock lock(&mutex_);
+  empty_ = &infos_.emplace_back();
+  index_.insert(empty_);
+}
+
+const SourceInfo* SourceInfoTable::Intern(const SourceInfo& info) {
+  if (info.Empty()) {
+    return empty_;
+  }
+  absl::MutexLock lock(&mutex_);
+  auto it = index_.find(&info);
+  if (it != index_.end()) {
+    return *it;
+  }
+  const SourceInfo* entry = &infos_.emplace_back(info);
+  index_.insert(entry);
+  return entry;
+}
+
+int64_t SourceInfoTable::size() const {
+  absl::MutexLock lock(&mutex_);
+  return infos_.size();
+}
+
+}  // namespace xls
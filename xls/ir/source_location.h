@@ -15,11 +15,20 @@
 #ifndef XLS_IR_SOURCE_LOCATION_H_
 #define XLS_IR_SOURCE_LOCATION_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xls/ir/fileno.h"
 
 namespace xls {
@@ -43,6 +52,20 @@ class SourceLocation {
                            colno_.value());
   }
 
+  bool operator==(const SourceLocation& other) const {
+    return fileno_ == other.fileno_ && lineno_ == other.lineno_ &&
+           colno_ == other.colno_;
+  }
+  bool operator!=(const SourceLocation& other) const {
+    return !(*this == other);
+  }
+
+  template <typename H>
+  friend H AbslHashValue(H h, const SourceLocation& loc) {
+    return H::combine(std::move(h), loc.fileno_.value(), loc.lineno_.value(),
+                      loc.colno_.value());
+  }
+
  private:
   Fileno fileno_;
   Lineno lineno_;
@@ -67,6 +90,56 @@ struct SourceInfo {
     }
     return absl::StrFormat("[%s]", absl::StrJoin(strings, ", "));
   }
+
+  bool operator==(const SourceInfo& other) const {
+    return locations == other.locations;
+  }
+  bool operator!=(const SourceInfo& other) const { return !(*this == other); }
+
+  template <typename H>
+  friend H AbslHashValue(H h, const SourceInfo& info) {
+    return H::combine(std::move(h), info.locations);
+  }
+};
+
+// Deduplicated storage of the SourceInfos of the nodes of a package. Nodes
+// hold a pointer to their interned SourceInfo rather than a vector of
+// locations each, which matters for large unrolled functions where many nodes
+// share a location. Entries live as long as the table. Thread-safe.
+class SourceInfoTable {
+ public:
+  SourceInfoTable();
+
+  SourceInfoTable(const SourceInfoTable&) = delete;
+  SourceInfoTable& operator=(const SourceInfoTable&) = delete;
+
+  // Returns the entry equal to `info`, adding it if necessary.
+  const SourceInfo* Intern(const SourceInfo& info);
+
+  // Returns the number of distinct SourceInfos interned, including the empty
+  // one.
+  int64_t size() const;
+
+ private:
+  struct PointeeHash {
+    size_t operator()(const SourceInfo* info) const {
+      return absl::HashOf(*info);
+    }
+  };
+  struct PointeeEq {
+    bool operator()(const SourceInfo* a, const SourceInfo* b) const {
+      return *a == *b;
+    }
+  };
+
+  // The entry of the empty SourceInfo, returned without locking.
+  const SourceInfo* empty_;
+
+  mutable absl::Mutex mutex_;
+  // A deque for the stability of the entries.
+  std::deque<SourceInfo> infos_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_set<const SourceInfo*, PointeeHash, PointeeEq> index_
+      ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace xls
@@ -0,0 +1,52 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/source_location.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/ir/fileno.h"
+
+namespace xls {
+namespace {
+
+TEST(SourceInfoTableTest, InternDeduplicates) {
+  SourceInfoTable table;
+  EXPECT_EQ(table.size(), 1);
+
+  const SourceInfo* empty = table.Intern(SourceInfo());
+  EXPECT_TRUE(empty->Empty());
+
+  SourceLocation a(Fileno(1), Lineno(2), Colno(3));
+  SourceLocation b(Fileno(1), Lineno(4), Colno(5));
+  const SourceInfo* info_a = table.Intern(SourceInfo(a));
+  const SourceInfo* info_ab =
+      table.Intern(SourceInfo(std::vector<SourceLocation>{a, b}));
+  EXPECT_NE(info_a, empty);
+  EXPECT_NE(info_a, info_ab);
+  EXPECT_EQ(table.size(), 3);
+
+  EXPECT_EQ(table.Intern(SourceInfo(a)), info_a);
+  EXPECT_EQ(table.Intern(SourceInfo(std::vector<SourceLocation>{a, b})),
+            info_ab);
+  EXPECT_EQ(table.Intern(SourceInfo()), empty);
+  EXPECT_EQ(table.size(), 3);
+
+  EXPECT_EQ(info_ab->ToString(), "[(1,2,3), (1,4,5)]");
+}
+
+}  // namespace
+}  // namespace xls
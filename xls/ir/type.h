@@ -128,7 +128,9 @@ class TupleType : public Type {
   explicit TupleType(absl::Span<Type* const> members)
       : Type(TypeKind::kTuple), members_(members.begin(), members.end()) {
     leaf_count_ = 0;
+    leaf_offsets_.reserve(members.size());
     for (Type* t : members) {
+      leaf_offsets_.push_back(leaf_count_);
       leaf_count_ += t->leaf_count();
     }
   }
@@ -149,6 +151,10 @@ class TupleType : public Type {
 
   int64_t leaf_count() const override { return leaf_count_; }
 
+  // Returns the number of leaves in the elements preceding the given element,
+  // i.e., the index of the element's first leaf in a flattened tuple.
+  int64_t leaf_offset(int64_t index) const { return leaf_offsets_.at(index); }
+
   int64_t GetFlatBitCount() const override {
     int64_t total = 0;
     for (const Type* type : members_) {
@@ -159,6 +165,7 @@ class TupleType : public Type {
 
  private:
   int64_t leaf_count_;
+  std::vector<int64_t> leaf_offsets_;
   std::vector<Type*> members_;
 };
 
@@ -163,6 +163,19 @@ class Value {
   bool operator==(const Value& other) const;
   bool operator!=(const Value& other) const { return !(*this == other); }
 
+  template <typename H>
+  friend H AbslHashValue(H h, const Value& value) {
+    h = H::combine(std::move(h), value.kind_);
+    if (value.IsBits()) {
+      return H::combine(std::move(h), value.bits());
+    }
+    if (value.kind_ == ValueKind::kInvalid) {
+      return h;
+    }
+    return H::combine(std::move(h),
+                      std::get<std::vector<Value>>(value.payload_));
+  }
+
  private:
   Value(ValueKind kind, absl::Span<const Value> elements)
       : kind_(kind),
@@ -18,29 +18,36 @@
 #include <cstdint>
 #include <deque>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/common/casts.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/block.h"
 #include "xls/ir/caret.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/code_template.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/instantiation.h"
 #include "xls/ir/node.h"
 #include "xls/ir/node_iterator.h"
@@ -56,6 +63,10 @@ namespace {
 
 using ::absl::StrFormat;
 
+// Minimum number of nodes to verify for VerifyPackage to verify function bases
+// in parallel; below it the overhead outweighs the gain.
+constexpr int64_t kMinNodesForParallelVerification = 4096;
+
 // Visitor which verifies various properties of Nodes including the types of the
 // operands and the type of the result.
 class NodeChecker : public DfsVisitor {
@@ -1434,13 +1445,26 @@ absl::Status VerifyNodeIdUnique(Node* node, absl::flat_hash_set<int64_t>* ids) {
   return absl::OkStatus();
 }
 
-// Verify common invariants to function-level constucts.
-absl::Status VerifyFunctionBase(FunctionBase* function) {
+// Returns whether `node` is among the nodes to verify individually: those in
+// `changed_nodes`, or all nodes if it is null.
+bool InScope(Node* node, const absl::flat_hash_set<Node*>* changed_nodes) {
+  return changed_nodes == nullptr || changed_nodes->contains(node);
+}
+
+// Verify common invariants to function-level constucts. If `changed_nodes` is
+// non-null, the function was verified before and only the given nodes (which
+// include all nodes added or with changed operands since) are verified
+// individually.
+absl::Status VerifyFunctionBase(
+    FunctionBase* function, const absl::flat_hash_set<Node*>* changed_nodes) {
   XLS_VLOG(2) << absl::StreamFormat("Verifying function %s:", function->name());
   XLS_VLOG_LINES(4, function->DumpIr());
 
   // Verify all types are owned by package.
   for (Node* node : function->nodes()) {
+    if (!InScope(node, changed_nodes)) {
+      continue;
+    }
     XLS_RET_CHECK(node->package()->IsOwnedType(node->GetType()));
     XLS_RET_CHECK(node->package() == function->package());
   }
@@ -1459,11 +1483,21 @@ absl::Status VerifyFunctionBase(FunctionBase* function) {
     }
   };
   CycleChecker cycle_checker;
-  XLS_RETURN_IF_ERROR(function->Accept(&cycle_checker));
+  if (changed_nodes == nullptr) {
+    XLS_RETURN_IF_ERROR(function->Accept(&cycle_checker));
+  } else {
+    // Any new cycle passes through a node whose operands changed, so it is
+    // found by searching the operands of the changed nodes.
+    for (Node* node : *changed_nodes) {
+      XLS_RETURN_IF_ERROR(node->Accept(&cycle_checker));
+    }
+  }
 
   // Verify consistency of node::users() and node::operands().
   for (Node* node : function->nodes()) {
-    XLS_RETURN_IF_ERROR(VerifyNode(node));
+    if (InScope(node, changed_nodes)) {
+      XLS_RETURN_IF_ERROR(VerifyNode(node));
+    }
   }
 
   // Verify the set of parameter nodes is exactly Function::params(), and that
@@ -1699,24 +1733,9 @@ absl::Status VerifyChannels(Package* package, bool codegen) {
   return absl::OkStatus();
 }
 
-}  // namespace
-
-absl::Status VerifyPackage(Package* package, bool codegen) {
-  XLS_VLOG(4) << absl::StreamFormat("Verifying package %s:\n", package->name());
-  XLS_VLOG_LINES(4, package->DumpIr());
-
-  for (auto& function : package->functions()) {
-    XLS_RETURN_IF_ERROR(VerifyFunction(function.get(), codegen));
-  }
-
-  for (auto& proc : package->procs()) {
-    XLS_RETURN_IF_ERROR(VerifyProc(proc.get(), codegen));
-  }
-
-  for (auto& block : package->blocks()) {
-    XLS_RETURN_IF_ERROR(VerifyBlock(block.get(), codegen));
-  }
-
+// Verifies the invariants of the package as a whole, i.e. all but those of
+// the individual function bases.
+absl::Status VerifyPackageInvariants(Package* package, bool codegen) {
   // Verify node IDs are unique within the package and uplinks point to this
   // package.
   absl::flat_hash_set<int64_t> ids;
@@ -1773,13 +1792,20 @@ absl::Status VerifyPackage(Package* package, bool codegen) {
   return absl::OkStatus();
 }
 
-absl::Status VerifyFunction(Function* function, bool codegen) {
+}  // namespace
+
+static absl::Status VerifyFunction(
+    Function* function, bool codegen,
+    const absl::flat_hash_set<Node*>* changed_nodes) {
   XLS_VLOG(4) << "Verifying function:\n";
   XLS_VLOG_LINES(4, function->DumpIr());
 
-  XLS_RETURN_IF_ERROR(VerifyFunctionBase(function));
+  XLS_RETURN_IF_ERROR(VerifyFunctionBase(function, changed_nodes));
 
   for (Node* node : function->nodes()) {
+    if (!InScope(node, changed_nodes)) {
+      continue;
+    }
     if (node->Is<Send>() || node->Is<Receive>()) {
       return absl::InternalError(absl::StrFormat(
           "Send and receive nodes can only be in procs, not functions (%s)",
@@ -1790,11 +1816,16 @@ absl::Status VerifyFunction(Function* function, bool codegen) {
   return absl::OkStatus();
 }
 
-absl::Status VerifyProc(Proc* proc, bool codegen) {
+absl::Status VerifyFunction(Function* function, bool codegen) {
+  return VerifyFunction(function, codegen, /*changed_nodes=*/nullptr);
+}
+
+static absl::Status VerifyProc(
+    Proc* proc, bool codegen, const absl::flat_hash_set<Node*>* changed_nodes) {
   XLS_VLOG(4) << "Verifying proc:\n";
   XLS_VLOG_LINES(4, proc->DumpIr());
 
-  XLS_RETURN_IF_ERROR(VerifyFunctionBase(proc));
+  XLS_RETURN_IF_ERROR(VerifyFunctionBase(proc, changed_nodes));
 
   // A Proc has a single token parameter and zero or more state paramers.
   XLS_RET_CHECK_EQ(proc->params().size(), proc->GetStateElementCount() + 1);
@@ -1837,6 +1868,10 @@ absl::Status VerifyProc(Proc* proc, bool codegen) {
   return absl::OkStatus();
 }
 
+absl::Status VerifyProc(Proc* proc, bool codegen) {
+  return VerifyProc(proc, codegen, /*changed_nodes=*/nullptr);
+}
+
 // Verify that the given set of port nodes on the instantiated block match
 // one-to-one with the instantiation input/output nodes in the instantiating
 // block.
@@ -2001,11 +2036,13 @@ static absl::Status VerifyExternInstantiation(
   return VerifyForeignFunctionTemplate(fun);
 }
 
-absl::Status VerifyBlock(Block* block, bool codegen) {
+static absl::Status VerifyBlock(
+    Block* block, bool codegen,
+    const absl::flat_hash_set<Node*>* changed_nodes) {
   XLS_VLOG(4) << "Verifying block:\n";
   XLS_VLOG_LINES(4, block->DumpIr());
 
-  XLS_RETURN_IF_ERROR(VerifyFunctionBase(block));
+  XLS_RETURN_IF_ERROR(VerifyFunctionBase(block, changed_nodes));
 
   // Verify the nodes returned by Block::Get*Port methods are consistent.
   absl::flat_hash_set<Node*> all_data_ports;
@@ -2121,6 +2158,122 @@ absl::Status VerifyBlock(Block* block, bool codegen) {
   return absl::OkStatus();
 }
 
+absl::Status VerifyBlock(Block* block, bool codegen) {
+  return VerifyBlock(block, codegen, /*changed_nodes=*/nullptr);
+}
+
+static absl::Status VerifyAnyFunctionBase(
+    FunctionBase* f, bool codegen,
+    const absl::flat_hash_set<Node*>* changed_nodes) {
+  if (f->IsFunction()) {
+    return VerifyFunction(f->AsFunctionOrDie(), codegen, changed_nodes);
+  }
+  if (f->IsProc()) {
+    return VerifyProc(f->AsProcOrDie(), codegen, changed_nodes);
+  }
+  return VerifyBlock(f->AsBlockOrDie(), codegen, changed_nodes);
+}
+
+// Verifies each of `function_bases`, in parallel if there is enough work.
+// `changed_nodes` is empty (all nodes are verified) or holds the argument of
+// VerifyFunctionBase for each function base. Returns the error of the first
+// function base in order which fails, so the result is deterministic.
+static absl::Status VerifyFunctionBases(
+    absl::Span<FunctionBase* const> function_bases, bool codegen,
+    absl::Span<const absl::flat_hash_set<Node*>* const> changed_nodes) {
+  std::vector<absl::Status> statuses(function_bases.size());
+  auto verify = [&](int64_t i) {
+    statuses[i] = VerifyAnyFunctionBase(
+        function_bases[i], codegen,
+        changed_nodes.empty() ? nullptr : changed_nodes[i]);
+  };
+  int64_t node_count = 0;
+  for (int64_t i = 0; i < function_bases.size(); ++i) {
+    node_count += changed_nodes.empty() || changed_nodes[i] == nullptr
+                      ? function_bases[i]->node_count()
+                      : changed_nodes[i]->size();
+  }
+  if (function_bases.size() > 1 &&
+      node_count >= kMinNodesForParallelVerification) {
+    DefaultThreadPool().ParallelFor(0, function_bases.size(), verify);
+  } else {
+    for (int64_t i = 0; i < function_bases.size(); ++i) {
+      verify(i);
+    }
+  }
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status VerifyPackage(Package* package, bool codegen) {
+  XLS_VLOG(4) << absl::StreamFormat("Verifying package %s:\n", package->name());
+  XLS_VLOG_LINES(4, package->DumpIr());
+
+  XLS_RETURN_IF_ERROR(
+      VerifyFunctionBases(package->GetFunctionBases(), codegen, {}));
+  return VerifyPackageInvariants(package, codegen);
+}
+
+absl::Status IncrementalVerifier::Verify(Package* package) {
+  std::vector<FunctionBase*> function_bases = package->GetFunctionBases();
+  absl::flat_hash_map<FunctionBase*, VerifiedState> verified;
+  std::vector<FunctionBase*> to_verify;
+  std::vector<std::optional<absl::flat_hash_set<Node*>>> changed_node_sets;
+  changed_node_sets.reserve(function_bases.size());
+  for (FunctionBase* f : function_bases) {
+    VerifiedState current{f->graph_version(), f->change_log_position()};
+    verified[f] = current;
+    auto it = verified_.find(f);
+    if (it != verified_.end() &&
+        it->second.graph_version == current.graph_version) {
+      continue;
+    }
+    to_verify.push_back(f);
+    std::optional<absl::flat_hash_set<Node*>>& changed_nodes =
+        changed_node_sets.emplace_back();
+    // The first element of the graph version identifies the function base, so
+    // a different one allocated at the same address is verified in full.
+    if (it == verified_.end() ||
+        it->second.graph_version.first != current.graph_version.first) {
+      continue;
+    }
+    std::optional<absl::Span<const FunctionBase::NodeChange>> changes =
+        f->ChangesSince(it->second.change_log_position);
+    if (!changes.has_value()) {
+      continue;
+    }
+    changed_nodes.emplace();
+    for (const FunctionBase::NodeChange& change : *changes) {
+      if (change.removed) {
+        changed_nodes->erase(change.node);
+      } else {
+        changed_nodes->insert(change.node);
+      }
+    }
+    // Operands of changed nodes had their users changed.
+    std::vector<Node*> operands;
+    for (Node* node : *changed_nodes) {
+      operands.insert(operands.end(), node->operands().begin(),
+                      node->operands().end());
+    }
+    changed_nodes->insert(operands.begin(), operands.end());
+  }
+
+  std::vector<const absl::flat_hash_set<Node*>*> changed_node_ptrs;
+  for (const std::optional<absl::flat_hash_set<Node*>>& changed_nodes :
+       changed_node_sets) {
+    changed_node_ptrs.push_back(
+        changed_nodes.has_value() ? &*changed_nodes : nullptr);
+  }
+  XLS_RETURN_IF_ERROR(
+      VerifyFunctionBases(to_verify, codegen_, changed_node_ptrs));
+  XLS_RETURN_IF_ERROR(VerifyPackageInvariants(package, codegen_));
+  verified_ = std::move(verified);
+  return absl::OkStatus();
+}
+
 absl::Status VerifyNode(Node* node, bool codegen) {
   XLS_VLOG(4) << "Verifying node: " << node->ToString();
 
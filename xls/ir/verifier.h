@@ -15,10 +15,15 @@
 #ifndef XLS_IR_VERIFIER_H_
 #define XLS_IR_VERIFIER_H_
 
+#include <cstdint>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 
 namespace xls {
 
+class FunctionBase;
 class Node;
 class Function;
 class Proc;
@@ -26,13 +31,42 @@ class Block;
 class Package;
 
 // Verifies numerous invariants of the IR for the given IR construct. Returns a
-// error status if a violation is found.
+// error status if a violation is found. VerifyPackage verifies the function
+// bases of sufficiently large packages in parallel.
 absl::Status VerifyPackage(Package* package, bool codegen = false);
 absl::Status VerifyFunction(Function* function, bool codegen = false);
 absl::Status VerifyProc(Proc* Proc, bool codegen = false);
 absl::Status VerifyBlock(Block* Block, bool codegen = false);
 absl::Status VerifyNode(Node* Node, bool codegen = false);
 
+// Verifies packages as VerifyPackage does, but only re-verifies what changed
+// since the previous successful verification, e.g. when verifying after every
+// pass of a pipeline. Function bases whose graph did not change (see
+// FunctionBase::graph_version) are skipped. For the others the per-node checks
+// are limited to the nodes recorded in the function's change log (and their
+// operands), while the function-level checks run in full. Package-level checks
+// always run in full. Falls back to full verification of a function base
+// whose change log no longer reaches back to the previous verification.
+//
+// Changes which do not change the graph of a function base, e.g. renaming a
+// parameter, are not re-verified until its graph changes.
+class IncrementalVerifier {
+ public:
+  explicit IncrementalVerifier(bool codegen = false) : codegen_(codegen) {}
+
+  absl::Status Verify(Package* package);
+
+ private:
+  struct VerifiedState {
+    std::pair<int64_t, int64_t> graph_version;
+    int64_t change_log_position;
+  };
+
+  bool codegen_;
+  // The state of each function base at its last successful verification.
+  absl::flat_hash_map<FunctionBase*, VerifiedState> verified_;
+};
+
 }  // namespace xls
 
 #endif  // XLS_IR_VERIFIER_H_
@@ -14,13 +14,19 @@
 
 #include "xls/ir/verifier.h"
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
 #include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/source_location.h"
 
 namespace xls {
 namespace {
@@ -552,5 +558,80 @@ block my_block(a: bits[32], b: bits[32], out: bits[32]) {
   XLS_ASSERT_OK(VerifyBlock(FindBlock("my_block", p.get())));
 }
 
+TEST_F(VerifierTest, ParallelVerificationReportsFirstError) {
+  // Enough nodes for the functions to be verified in parallel.
+  auto p = CreatePackage();
+  std::vector<Node*> bad_nodes;
+  for (int64_t i = 0; i < 8; ++i) {
+    FunctionBuilder fb(absl::StrCat("f", i), p.get());
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    BValue y = fb.Param("y", p->GetBitsType(8));
+    BValue acc = x;
+    for (int64_t j = 0; j < 1000; ++j) {
+      acc = fb.Add(acc, x);
+    }
+    BValue bad = fb.Add(acc, x, SourceInfo(), absl::StrCat("bad_in_f", i));
+    XLS_ASSERT_OK(fb.Build().status());
+    bad_nodes.push_back(bad.node());
+    bad_nodes.push_back(y.node());
+  }
+  XLS_ASSERT_OK(VerifyPackage(p.get()));
+
+  // Break two functions; the error of the first one is reported.
+  for (int64_t i : {5, 2}) {
+    XLS_ASSERT_OK(bad_nodes[2 * i]->ReplaceOperandNumber(
+        1, bad_nodes[2 * i + 1], /*type_must_match=*/false));
+  }
+  for (int64_t i = 0; i < 10; ++i) {
+    EXPECT_THAT(VerifyPackage(p.get()),
+                StatusIs(absl::StatusCode::kInternal, HasSubstr("bad_in_f2")));
+  }
+}
+
+TEST_F(VerifierTest, IncrementalVerifier) {
+  std::string input = R"(
+package test_package
+
+fn f(x: bits[32], y: bits[8]) -> bits[32] {
+  a: bits[32] = add(x, x)
+  ret b: bits[32] = neg(a)
+}
+
+fn g(x: bits[32]) -> bits[32] {
+  ret c: bits[32] = not(x)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackageNoVerify(input));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("f"));
+  IncrementalVerifier verifier;
+  XLS_ASSERT_OK(verifier.Verify(p.get()));
+  XLS_ASSERT_OK(verifier.Verify(p.get()));
+
+  // A change is verified, and is verified again until it is fixed.
+  Node* a = FindNode("a", f);
+  XLS_ASSERT_OK(a->ReplaceOperandNumber(1, FindNode("y", f),
+                                        /*type_must_match=*/false));
+  EXPECT_THAT(verifier.Verify(p.get()),
+              StatusIs(absl::StatusCode::kInternal, HasSubstr("operand 1 of a to")));
+  EXPECT_THAT(verifier.Verify(p.get()),
+              StatusIs(absl::StatusCode::kInternal, HasSubstr("operand 1 of a to")));
+  XLS_ASSERT_OK(a->ReplaceOperandNumber(1, FindNode("x", f)));
+  XLS_ASSERT_OK(verifier.Verify(p.get()));
+
+  // New nodes are verified.
+  XLS_ASSERT_OK(f->MakeNode<UnOp>(SourceInfo(), FindNode("y", f), Op::kNeg)
+                    .status());
+  XLS_ASSERT_OK(verifier.Verify(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * bad_neg,
+      f->MakeNode<UnOp>(SourceInfo(), FindNode("y", f), Op::kNeg));
+  XLS_ASSERT_OK(bad_neg->ReplaceOperandNumber(0, FindNode("x", f),
+                                              /*type_must_match=*/false));
+  EXPECT_THAT(verifier.Verify(p.get()),
+              StatusIs(absl::StatusCode::kInternal, HasSubstr("operand 0 of neg")));
+  XLS_ASSERT_OK(f->RemoveNode(bad_neg));
+  XLS_ASSERT_OK(verifier.Verify(p.get()));
+}
+
 }  // namespace
 }  // namespace xls
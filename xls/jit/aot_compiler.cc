@@ -17,35 +17,60 @@
 // wrap (i.e., simplify) execution of the generated code, and writes the trio to
 // disk.
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <ostream>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_replace.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/strip.h"
+#include "absl/types/span.h"
 #include "google/protobuf/text_format.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/call_graph.h"
+#include "xls/ir/channel.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/proc.h"
 #include "xls/jit/function_jit.h"
 #include "xls/jit/llvm_type_converter.h"
 #include "xls/jit/orc_jit.h"
+#include "xls/jit/proc_jit.h"
+#include "xls/jit/type_layout.pb.h"
 
 ABSL_FLAG(std::string, input, "", "Path to the IR to compile.");
 ABSL_FLAG(std::string, top, "",
           "IR function to compile. "
           "If unspecified, the package top function will be used - "
-          "in that case, the package-scoping mangling will be removed.");
+          "in that case, the package-scoping mangling will be removed. "
+          "If the top is a proc, all of the procs of the package are "
+          "compiled into a network executed by an AotProcRuntime.");
+ABSL_FLAG(std::string, tops, "",
+          "Comma-separated list of IR functions to compile into a single "
+          "bundle. The functions share one object file with a static dispatch "
+          "table; code for functions invoked by more than one top is emitted "
+          "once. Package-scoping mangling is removed from the generated "
+          "wrapper names. Incompatible with --top and --all_functions.");
+ABSL_FLAG(bool, all_functions, false,
+          "If true, compiles every function in the package into a single "
+          "bundle as with --tops. Incompatible with --top and --tops.");
 ABSL_FLAG(std::string, namespaces, "",
           "Comma-separated list of namespaces into which to place the "
           "generated code. Earlier-specified namespaces enclose "
@@ -156,12 +181,13 @@ absl::StatusOr<std::string> GenerateWrapperSource(
 #include "xls/jit/aot_runtime.h"
 
 extern "C" {
-void {{extern_fn}}(const uint8_t* const* inputs,
-                   uint8_t* const* outputs,
-                   uint8_t* temp_buffer,
-                   ::xls::InterpreterEvents* events,
-                   void* unused,
-                   int64_t continuation_point);
+int64_t {{extern_fn}}(const uint8_t* const* inputs,
+                      uint8_t* const* outputs,
+                      uint8_t* temp_buffer,
+                      ::xls::InterpreterEvents* events,
+                      void* unused,
+                      void* jit_runtime,
+                      int64_t continuation_point);
 }
 {{open_ns}}
 
@@ -189,7 +215,8 @@ absl::StatusOr<::xls::Value> {{wrapper_fn_name}}({{wrapper_params}}) {
   std::vector<uint8_t> temp_buffers({{temp_buffer_size}});
   ::xls::InterpreterEvents events;
   {{extern_fn}}(arg_buffers, output_buffers, temp_buffers.data(),
-                &events, /*unused=*/nullptr, /*continuation_point=*/0);
+                &events, /*unused=*/nullptr, /*jit_runtime=*/nullptr,
+                /*continuation_point=*/0);
 
   return GetFunctionTypeLayout().NativeLayoutResultToValue(result_buffer);
 }
@@ -255,7 +282,477 @@ absl::StatusOr<::xls::Value> {{wrapper_fn_name}}({{wrapper_params}}) {
   return absl::StrReplaceAll(kTemplate, substitution_map);
 }
 
+// Returns the strings opening and closing the given namespaces in generated
+// code.
+std::pair<std::string, std::string> NamespaceDelimiters(
+    const std::vector<std::string>& namespaces) {
+  if (namespaces.empty()) {
+    return {"", ""};
+  }
+  return {
+      absl::StrFormat("namespace %s {", absl::StrJoin(namespaces, "::")),
+      absl::StrFormat("}  // namespace %s", absl::StrJoin(namespaces, "::"))};
+}
+
+// Returns the name of the generated wrapper for `f`: the function name with
+// the package-scoping mangling removed.
+std::string WrapperFunctionName(Function* f) {
+  std::string package_prefix = absl::StrCat("__", f->package()->name(), "__");
+  return std::string(absl::StripPrefix(f->name(), package_prefix));
+}
+
+// Returns the C++ parameter list of the generated wrapper for `f`.
+std::string WrapperParams(Function* f) {
+  std::vector<std::string> params;
+  for (const Param* param : f->params()) {
+    params.push_back(absl::StrCat("const ::xls::Value& ", param->name()));
+  }
+  return absl::StrJoin(params, ", ");
+}
+
+// Produces a header file for a bundle of functions containing a wrapper for
+// each function and an accessor for the bundle's dispatch table.
+absl::StatusOr<std::string> GenerateBundleHeader(
+    absl::Span<Function* const> functions,
+    const std::vector<std::string>& namespaces) {
+  constexpr std::string_view kTemplate =
+      R"(// AUTO-GENERATED FILE! DO NOT EDIT!
+#include "absl/status/statusor.h"
+#include "xls/ir/value.h"
+#include "xls/jit/aot_runtime.h"
+
+{{open_ns}}
+{{wrapper_decls}}
+
+// Returns the runtime of the bundle containing the functions above. Supports
+// invoking the functions by name.
+const ::xls::aot_compile::AotBundle& GetAotBundle();
+{{close_ns}}
+)";
+  std::vector<std::string> wrapper_decls;
+  for (Function* f : functions) {
+    wrapper_decls.push_back(
+        absl::StrFormat("absl::StatusOr<::xls::Value> %s(%s);",
+                        WrapperFunctionName(f), WrapperParams(f)));
+  }
+  auto [open_ns, close_ns] = NamespaceDelimiters(namespaces);
+  return absl::StrReplaceAll(
+      kTemplate, {{"{{open_ns}}", open_ns},
+                  {"{{close_ns}}", close_ns},
+                  {"{{wrapper_decls}}", absl::StrJoin(wrapper_decls, "\n")}});
+}
+
+// Generates the source file for a bundle of functions. The TypeLayouts of all
+// of the distinct argument and result types appear once in a single text proto
+// which is deserialized on first use of the bundle. Each entry point refers to
+// its layouts by index in a static dispatch table and the wrapper functions
+// simply dispatch through the shared AotBundle runtime.
+absl::StatusOr<std::string> GenerateBundleSource(
+    absl::Span<Function* const> functions,
+    const JitObjectCodeBundle& object_code, const std::string& header_path,
+    const std::vector<std::string>& namespaces) {
+  constexpr std::string_view kTemplate =
+      R"~(// AUTO-GENERATED FILE! DO NOT EDIT!
+#include "{{header_path}}"
+
+#include <cstdint>
+#include <memory>
+
+#include "absl/types/span.h"
+#include "xls/ir/events.h"
+#include "xls/jit/aot_runtime.h"
+
+extern "C" {
+{{extern_decls}}
+}
+
+{{open_ns}}
+
+namespace {
+
+const char* kLayouts = R"|({{layouts_proto}})|";
+
+{{arg_layout_index_arrays}}
+
+const ::xls::aot_compile::AotEntryPoint kEntryPoints[] = {
+{{entry_points}}
+};
+
+constexpr int64_t kTempBufferSize = {{temp_buffer_size}};
+
+}  //  namespace
+
+const ::xls::aot_compile::AotBundle& GetAotBundle() {
+  static const ::xls::aot_compile::AotBundle* bundle =
+      ::xls::aot_compile::AotBundle::Create(kLayouts, kEntryPoints,
+                                            kTempBufferSize)
+          .value()
+          .release();
+  return *bundle;
+}
+
+{{wrapper_defs}}
+
+{{close_ns}}
+)~";
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit, OrcJit::Create());
+  XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout,
+                       orc_jit->CreateDataLayout());
+  LlvmTypeConverter type_converter(orc_jit->GetContext(), data_layout);
+
+  // Identical types share a single layout.
+  TypeLayoutsProto layouts_proto;
+  absl::flat_hash_map<std::string, int64_t> layout_indices;
+  auto get_layout_index = [&](Type* type) {
+    auto [it, inserted] =
+        layout_indices.insert({type->ToString(), layouts_proto.layouts_size()});
+    if (inserted) {
+      *layouts_proto.add_layouts() =
+          type_converter.CreateTypeLayout(type).ToProto();
+    }
+    return it->second;
+  };
+
+  std::vector<std::string> extern_decls;
+  std::vector<std::string> arg_layout_index_arrays;
+  std::vector<std::string> entry_points;
+  std::vector<std::string> wrapper_defs;
+  for (int64_t i = 0; i < functions.size(); ++i) {
+    Function* f = functions[i];
+    const JitObjectCodeBundle::EntryPoint& entry_point =
+        object_code.entry_points[i];
+    XLS_RET_CHECK_EQ(entry_point.function, f);
+    extern_decls.push_back(absl::StrFormat(
+        "int64_t %s(const uint8_t* const* inputs, uint8_t* const* outputs, "
+        "void* temp_buffer, ::xls::InterpreterEvents* events, void* unused, "
+        "void* jit_runtime, int64_t continuation_point);",
+        entry_point.function_name));
+
+    std::vector<std::string> arg_indices;
+    std::vector<std::string> param_names;
+    for (Param* param : f->params()) {
+      arg_indices.push_back(absl::StrCat(get_layout_index(param->GetType())));
+      param_names.push_back(std::string(param->name()));
+    }
+    std::string arg_layouts = "absl::Span<const int64_t>()";
+    if (!arg_indices.empty()) {
+      arg_layouts = absl::StrCat("kArgLayouts", i);
+      arg_layout_index_arrays.push_back(
+          absl::StrFormat("constexpr int64_t %s[] = {%s};", arg_layouts,
+                          absl::StrJoin(arg_indices, ", ")));
+    }
+    entry_points.push_back(absl::StrFormat(
+        "    {\"%s\", &::%s, %s, %d},", WrapperFunctionName(f),
+        entry_point.function_name, arg_layouts,
+        get_layout_index(f->return_value()->GetType())));
+    wrapper_defs.push_back(absl::StrFormat(
+        "absl::StatusOr<::xls::Value> %s(%s) {\n"
+        "  return GetAotBundle().Run(/*index=*/int64_t{%d}, {%s});\n"
+        "}\n",
+        WrapperFunctionName(f), WrapperParams(f), i,
+        absl::StrJoin(param_names, ", ")));
+  }
+
+  std::string layouts_text;
+  XLS_RET_CHECK(
+      google::protobuf::TextFormat::PrintToString(layouts_proto, &layouts_text));
+  auto [open_ns, close_ns] = NamespaceDelimiters(namespaces);
+  return absl::StrReplaceAll(
+      kTemplate,
+      {{"{{header_path}}", header_path},
+       {"{{extern_decls}}", absl::StrJoin(extern_decls, "\n")},
+       {"{{open_ns}}", open_ns},
+       {"{{close_ns}}", close_ns},
+       {"{{layouts_proto}}", layouts_text},
+       {"{{arg_layout_index_arrays}}",
+        absl::StrJoin(arg_layout_index_arrays, "\n")},
+       {"{{entry_points}}", absl::StrJoin(entry_points, "\n")},
+       {"{{temp_buffer_size}}", absl::StrCat(object_code.temp_buffer_size)},
+       {"{{wrapper_defs}}", absl::StrJoin(wrapper_defs, "\n")}});
+}
+
+// Compiles `functions` into a single bundle and writes the object, header and
+// source files to disk.
+absl::Status CompileBundle(absl::Span<Function* const> functions,
+                           const std::string& output_object_path,
+                           const std::string& output_header_path,
+                           const std::string& output_source_path,
+                           const std::string& header_include_path,
+                           const std::vector<std::string>& namespaces) {
+  XLS_ASSIGN_OR_RETURN(JitObjectCodeBundle object_code,
+                       FunctionJit::CreateObjectCodeBundle(functions));
+  XLS_RETURN_IF_ERROR(SetFileContents(
+      output_object_path, std::string(object_code.object_code.begin(),
+                                      object_code.object_code.end())));
+
+  XLS_ASSIGN_OR_RETURN(std::string header_text,
+                       GenerateBundleHeader(functions, namespaces));
+  XLS_RETURN_IF_ERROR(SetFileContents(output_header_path, header_text));
+
+  XLS_ASSIGN_OR_RETURN(std::string source_text,
+                       GenerateBundleSource(functions, object_code,
+                                            header_include_path, namespaces));
+  return SetFileContents(output_source_path, source_text);
+}
+
+// Returns an error if any of `procs` or the functions they invoke contains an
+// operation whose compiled code calls into the compiler process (traces,
+// assertions and covers), which cannot be linked ahead of time.
+absl::Status CheckProcsCompileAheadOfTime(absl::Span<Proc* const> procs) {
+  for (Proc* proc : procs) {
+    for (FunctionBase* f : GetDependentFunctions(proc)) {
+      for (Node* node : f->nodes()) {
+        if (node->Is<Trace>() || node->Is<Assert>() || node->Is<Cover>()) {
+          return absl::UnimplementedError(absl::StrFormat(
+              "Cannot AOT compile `%s` of proc `%s`: %s operations are not "
+              "supported",
+              node->GetName(), proc->name(), OpToString(node->op())));
+        }
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Produces a header file for a network of procs containing an accessor for
+// its static description, from which runtimes are created.
+std::string GenerateProcHeader(Package* p,
+                               const std::vector<std::string>& namespaces) {
+  constexpr std::string_view kTemplate =
+      R"(// AUTO-GENERATED FILE! DO NOT EDIT!
+#include "xls/jit/aot_runtime.h"
+
+{{open_ns}}
+// Returns the network of the AOT-compiled procs of package `{{package}}`.
+// Execute the procs with a runtime created by its NewRuntime() method.
+const ::xls::aot_compile::AotProcNetwork& GetAotProcNetwork();
+{{close_ns}}
+)";
+  auto [open_ns, close_ns] = NamespaceDelimiters(namespaces);
+  return absl::StrReplaceAll(kTemplate, {{"{{open_ns}}", open_ns},
+                                         {"{{close_ns}}", close_ns},
+                                         {"{{package}}", p->name()}});
+}
+
+// Generates the source file for a network of procs. As for bundles of
+// functions the distinct layouts appear once in a text proto; the channels,
+// procs and their parameters are static tables referring to them by index.
+// The initial state is emitted directly in native layout so creating a
+// runtime converts no values.
+absl::StatusOr<std::string> GenerateProcSource(
+    Package* p, const JitProcObjectCode& object_code,
+    const std::string& header_path,
+    const std::vector<std::string>& namespaces) {
+  constexpr std::string_view kTemplate =
+      R"~(// AUTO-GENERATED FILE! DO NOT EDIT!
+#include "{{header_path}}"
+
+#include <cstdint>
+#include <memory>
+
+#include "absl/types/span.h"
+#include "xls/ir/events.h"
+#include "xls/jit/aot_runtime.h"
+
+extern "C" {
+{{extern_decls}}
+}
+
+{{open_ns}}
+
+namespace {
+
+const char* kLayouts = R"|({{layouts_proto}})|";
+
+{{channel_table}}
+
+{{proc_tables}}
+
+const ::xls::aot_compile::AotProcEntryPoint kProcs[] = {
+{{procs}}
+};
+
+constexpr int64_t kTempBufferSize = {{temp_buffer_size}};
+
+}  //  namespace
+
+const ::xls::aot_compile::AotProcNetwork& GetAotProcNetwork() {
+  static const ::xls::aot_compile::AotProcNetwork* network =
+      ::xls::aot_compile::AotProcNetwork::Create(kLayouts, {{channels}},
+                                                 kProcs, kTempBufferSize)
+          .value()
+          .release();
+  return *network;
+}
+
+{{close_ns}}
+)~";
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit, OrcJit::Create());
+  XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout,
+                       orc_jit->CreateDataLayout());
+  LlvmTypeConverter type_converter(orc_jit->GetContext(), data_layout);
+
+  TypeLayoutsProto layouts_proto;
+  absl::flat_hash_map<std::string, int64_t> layout_indices;
+  auto get_layout_index = [&](Type* type) {
+    auto [it, inserted] =
+        layout_indices.insert({type->ToString(), layouts_proto.layouts_size()});
+    if (inserted) {
+      *layouts_proto.add_layouts() =
+          type_converter.CreateTypeLayout(type).ToProto();
+    }
+    return it->second;
+  };
+
+  // Channels are listed in package order, which is the order of the channel
+  // hooks expected by the compiled code.
+  absl::flat_hash_map<int64_t, int64_t> channel_indices;
+  std::vector<std::string> channels;
+  for (Channel* channel : p->channels()) {
+    channel_indices[channel->id()] = channels.size();
+    channels.push_back(absl::StrFormat(
+        "    {\"%s\", %d, %s},", channel->name(),
+        get_layout_index(channel->type()),
+        channel->kind() == ChannelKind::kSingleValue ? "true" : "false"));
+  }
+  std::string channel_table;
+  std::string channels_span =
+      "absl::Span<const ::xls::aot_compile::AotChannel>()";
+  if (!channels.empty()) {
+    channel_table =
+        absl::StrFormat("const ::xls::aot_compile::AotChannel kChannels[] = {\n"
+                        "%s\n};",
+                        absl::StrJoin(channels, "\n"));
+    channels_span = "kChannels";
+  }
+
+  auto format_bytes = [](std::string* out, uint8_t byte) {
+    absl::StrAppend(out, static_cast<int>(byte));
+  };
+  std::vector<std::string> extern_decls;
+  std::vector<std::string> proc_tables;
+  std::vector<std::string> procs;
+  for (int64_t i = 0; i < object_code.entry_points.size(); ++i) {
+    const JitProcObjectCode::EntryPoint& entry_point =
+        object_code.entry_points[i];
+    Proc* proc = entry_point.proc;
+    extern_decls.push_back(absl::StrFormat(
+        "int64_t %s(const uint8_t* const* inputs, uint8_t* const* outputs, "
+        "void* temp_buffer, ::xls::InterpreterEvents* events, void* user_data, "
+        "void* jit_runtime, int64_t* tick_state);",
+        entry_point.function_name));
+
+    absl::flat_hash_set<int64_t> in_place_state_indices(
+        entry_point.in_place_state_indices.begin(),
+        entry_point.in_place_state_indices.end());
+    std::vector<std::string> params;
+    XLS_RET_CHECK_EQ(entry_point.parameter_buffer_sizes.size(),
+                     proc->params().size());
+    for (int64_t j = 0; j < proc->params().size(); ++j) {
+      int64_t buffer_size = entry_point.parameter_buffer_sizes[j];
+      if (j == 0) {
+        // The token.
+        params.push_back(absl::StrFormat(
+            "    {%d, -1, absl::Span<const uint8_t>(), false},", buffer_size));
+        continue;
+      }
+      int64_t state_index = j - 1;
+      Type* type = proc->GetStateElementType(state_index);
+      std::string initial_value = "absl::Span<const uint8_t>()";
+      if (buffer_size > 0) {
+        std::vector<uint8_t> bytes(buffer_size);
+        type_converter.CreateTypeLayout(type).ValueToNativeLayout(
+            proc->GetInitValueElement(state_index), bytes.data());
+        initial_value = absl::StrFormat("kProc%dInitialValue%d", i, j);
+        proc_tables.push_back(absl::StrFormat(
+            "constexpr uint8_t %s[] = {%s};", initial_value,
+            absl::StrJoin(bytes, ", ", format_bytes)));
+      }
+      params.push_back(absl::StrFormat(
+          "    {%d, %d, %s, %s},", buffer_size, get_layout_index(type),
+          initial_value,
+          in_place_state_indices.contains(state_index) ? "true" : "false"));
+    }
+    std::string params_name = absl::StrFormat("kProc%dParams", i);
+    proc_tables.push_back(absl::StrFormat(
+        "const ::xls::aot_compile::AotProcParam %s[] = {\n%s\n};",
+        params_name, absl::StrJoin(params, "\n")));
+
+    // Multi-tick execution only stops at blocking receives.
+    std::vector<std::pair<int64_t, int64_t>> blocking_points;
+    for (const auto& [point, node] : entry_point.continuation_points) {
+      if (node->Is<Receive>()) {
+        blocking_points.push_back(
+            {point, channel_indices.at(node->As<Receive>()->channel_id())});
+      }
+    }
+    std::sort(blocking_points.begin(), blocking_points.end());
+    std::string blocking_points_name =
+        "absl::Span<const ::xls::aot_compile::AotBlockingPoint>()";
+    if (!blocking_points.empty()) {
+      blocking_points_name = absl::StrFormat("kProc%dBlockingPoints", i);
+      proc_tables.push_back(absl::StrFormat(
+          "const ::xls::aot_compile::AotBlockingPoint %s[] = {%s};",
+          blocking_points_name,
+          absl::StrJoin(blocking_points, ", ",
+                        [](std::string* out, std::pair<int64_t, int64_t> p) {
+                          absl::StrAppend(out, "{", p.first, ", ", p.second,
+                                          "}");
+                        })));
+    }
+
+    std::string package_prefix = absl::StrCat("__", p->name(), "__");
+    procs.push_back(absl::StrFormat(
+        "    {\"%s\", &::%s, %s, %s},",
+        absl::StripPrefix(proc->name(), package_prefix),
+        entry_point.function_name, params_name, blocking_points_name));
+  }
+
+  std::string layouts_text;
+  XLS_RET_CHECK(
+      google::protobuf::TextFormat::PrintToString(layouts_proto, &layouts_text));
+  auto [open_ns, close_ns] = NamespaceDelimiters(namespaces);
+  return absl::StrReplaceAll(
+      kTemplate,
+      {{"{{header_path}}", header_path},
+       {"{{extern_decls}}", absl::StrJoin(extern_decls, "\n")},
+       {"{{open_ns}}", open_ns},
+       {"{{close_ns}}", close_ns},
+       {"{{layouts_proto}}", layouts_text},
+       {"{{channel_table}}", channel_table},
+       {"{{channels}}", channels_span},
+       {"{{proc_tables}}", absl::StrJoin(proc_tables, "\n")},
+       {"{{procs}}", absl::StrJoin(procs, "\n")},
+       {"{{temp_buffer_size}}", absl::StrCat(object_code.temp_buffer_size)}});
+}
+
+// Compiles all of the procs of `p` and writes the object, header and source
+// files to disk.
+absl::Status CompileProcs(Package* p, const std::string& output_object_path,
+                          const std::string& output_header_path,
+                          const std::string& output_source_path,
+                          const std::string& header_include_path,
+                          const std::vector<std::string>& namespaces) {
+  std::vector<Proc*> procs;
+  for (const std::unique_ptr<Proc>& proc : p->procs()) {
+    procs.push_back(proc.get());
+  }
+  XLS_RETURN_IF_ERROR(CheckProcsCompileAheadOfTime(procs));
+  XLS_ASSIGN_OR_RETURN(JitProcObjectCode object_code,
+                       ProcJit::CreateObjectCode(procs));
+  XLS_RETURN_IF_ERROR(SetFileContents(
+      output_object_path, std::string(object_code.object_code.begin(),
+                                      object_code.object_code.end())));
+  XLS_RETURN_IF_ERROR(
+      SetFileContents(output_header_path, GenerateProcHeader(p, namespaces)));
+  XLS_ASSIGN_OR_RETURN(
+      std::string source_text,
+      GenerateProcSource(p, object_code, header_include_path, namespaces));
+  return SetFileContents(output_source_path, source_text);
+}
+
 absl::Status RealMain(const std::string& input_ir_path, std::string top,
+                      const std::vector<std::string>& tops, bool all_functions,
                       const std::string& output_object_path,
                       const std::string& output_header_path,
                       const std::string& output_source_path,
@@ -265,8 +762,36 @@ absl::Status RealMain(const std::string& input_ir_path, std::string top,
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
                        Parser::ParsePackage(input_ir, input_ir_path));
 
+  if (all_functions || !tops.empty()) {
+    std::vector<Function*> functions;
+    if (all_functions) {
+      for (const std::unique_ptr<Function>& f : package->functions()) {
+        functions.push_back(f.get());
+      }
+    } else {
+      for (const std::string& name : tops) {
+        XLS_ASSIGN_OR_RETURN(Function * f, package->GetFunction(name));
+        functions.push_back(f);
+      }
+    }
+    if (functions.empty()) {
+      return absl::InvalidArgumentError("No functions to compile");
+    }
+    return CompileBundle(functions, output_object_path, output_header_path,
+                         output_source_path, header_include_path, namespaces);
+  }
+
+  // A proc top compiles the package's whole network of procs, as the procs
+  // communicate through channels.
+  bool proc_top = top.empty() ? package->GetTop().has_value() &&
+                                     package->GetTop().value()->IsProc()
+                               : package->GetProc(top).ok();
+  if (proc_top) {
+    return CompileProcs(package.get(), output_object_path, output_header_path,
+                        output_source_path, header_include_path, namespaces);
+  }
+
   Function* f;
-  std::string package_prefix = absl::StrCat("__", package->name(), "__");
   if (top.empty()) {
     XLS_ASSIGN_OR_RETURN(f, package->GetTopAsFunction());
   } else {
@@ -300,6 +825,14 @@ int main(int argc, char** argv) {
       << "--input must be specified." << std::endl;
 
   std::string top = absl::GetFlag(FLAGS_top);
+  std::vector<std::string> tops;
+  std::string tops_string = absl::GetFlag(FLAGS_tops);
+  if (!tops_string.empty()) {
+    tops = absl::StrSplit(tops_string, ',');
+  }
+  bool all_functions = absl::GetFlag(FLAGS_all_functions);
+  XLS_QCHECK(int{!top.empty()} + int{!tops.empty()} + int{all_functions} <= 1)
+      << "At most one of --top, --tops and --all_functions may be specified.";
 
   std::string output_object_path = absl::GetFlag(FLAGS_output_object);
   std::string output_header_path = absl::GetFlag(FLAGS_output_header);
@@ -318,8 +851,9 @@ int main(int argc, char** argv) {
     namespaces = absl::StrSplit(namespaces_string, ',');
   }
   absl::Status status =
-      xls::RealMain(input_ir_path, top, output_object_path, output_header_path,
-                    output_source_path, header_include_path, namespaces);
+      xls::RealMain(input_ir_path, top, tops, all_functions, output_object_path,
+                    output_header_path, output_source_path,
+                    header_include_path, namespaces);
   if (!status.ok()) {
     std::cout << status.message();
     return 1;
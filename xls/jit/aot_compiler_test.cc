@@ -12,6 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
@@ -20,6 +27,9 @@
 #include "xls/ir/bits.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/value.h"
+#include "xls/jit/aot_bundle_cc.h"
+#include "xls/jit/aot_procs_cc.h"
+#include "xls/jit/aot_runtime.h"
 #include "xls/jit/compound_type_cc.h"
 #include "xls/jit/null_function_cc.h"
 
@@ -29,6 +39,9 @@
 namespace xls {
 namespace {
 
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+
 Value F32Value(bool sign, uint8_t exp, uint32_t frac) {
   return Value::Tuple({Value(UBits(static_cast<uint64_t>(sign), 1)),
                        Value(UBits(exp, 8)), Value(UBits(frac, 23))});
@@ -71,6 +84,112 @@ TEST(AotCompileTest, CompoundType) {
   EXPECT_EQ(result, Value::Tuple({b, Value(UBits(43, 32)), c}));
 }
 
+TEST(AotCompileTest, BundleWrappers) {
+  XLS_ASSERT_OK_AND_ASSIGN(Value result,
+                           xls::bundle::add_one(Value(UBits(41, 32))));
+  EXPECT_EQ(result, Value(UBits(42, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(result, xls::bundle::add_two(Value(UBits(40, 32))));
+  EXPECT_EQ(result, Value(UBits(42, 32)));
+
+  Value a = Value(UBits(7, 32));
+  Value b = Value::Tuple({Value(UBits(3, 8)), Value(UBits(0xabcdef, 64))});
+  XLS_ASSERT_OK_AND_ASSIGN(result, xls::bundle::swap(a, b));
+  EXPECT_EQ(result, Value::Tuple({b, a}));
+
+  XLS_ASSERT_OK_AND_ASSIGN(result, xls::bundle::constant());
+  EXPECT_EQ(result, Value(UBits(42, 16)));
+}
+
+TEST(AotCompileTest, BundleDispatchByName) {
+  const aot_compile::AotBundle& bundle = xls::bundle::GetAotBundle();
+  EXPECT_EQ(bundle.entry_points().size(), 4);
+
+  XLS_ASSERT_OK_AND_ASSIGN(int64_t index, bundle.GetEntryPointIndex("swap"));
+  EXPECT_EQ(std::string_view(bundle.entry_points()[index].name), "swap");
+
+  std::vector<Value> args = {Value(UBits(100, 32))};
+  EXPECT_THAT(bundle.Run("add_two", args),
+              IsOkAndHolds(Value(UBits(102, 32))));
+  EXPECT_THAT(bundle.Run("not_a_function", args),
+              StatusIs(absl::StatusCode::kNotFound,
+                       testing::HasSubstr("not_a_function")));
+  EXPECT_THAT(bundle.Run("add_one", {}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       testing::HasSubstr("takes 1 arguments")));
+}
+
+// `producer` sends an incrementing count to `consumer`, which adds it and a
+// value received on `in` to its accumulator and sends the sum on `out`.
+TEST(AotCompileTest, ProcNetwork) {
+  std::unique_ptr<aot_compile::AotProcRuntime> runtime =
+      xls::procs::GetAotProcNetwork().NewRuntime();
+  XLS_ASSERT_OK(runtime->Enqueue("in", Value(UBits(5, 32))));
+  XLS_ASSERT_OK(runtime->Enqueue("in", Value(UBits(7, 32))));
+
+  XLS_ASSERT_OK(runtime->Tick());
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_THAT(runtime->Dequeue("out"),
+              IsOkAndHolds(std::optional<Value>(Value(UBits(6, 32)))));
+  EXPECT_THAT(runtime->Dequeue("out"),
+              IsOkAndHolds(std::optional<Value>(Value(UBits(15, 32)))));
+  EXPECT_THAT(runtime->Dequeue("out"), IsOkAndHolds(std::nullopt));
+
+  // With `in` empty the consumer blocks mid-tick.
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_THAT(runtime->GetBlockedChannel("consumer"),
+              IsOkAndHolds(std::optional<std::string_view>("in")));
+  EXPECT_THAT(runtime->GetState("producer"),
+              IsOkAndHolds(std::vector<Value>{Value(UBits(4, 32))}));
+  EXPECT_THAT(runtime->GetState("consumer"),
+              IsOkAndHolds(std::vector<Value>{Value(UBits(15, 32))}));
+
+  XLS_ASSERT_OK(runtime->Enqueue("in", Value(UBits(100, 32))));
+  EXPECT_THAT(runtime->TickProc("consumer", /*max_ticks=*/1),
+              IsOkAndHolds(1));
+  EXPECT_THAT(runtime->Dequeue("out"),
+              IsOkAndHolds(std::optional<Value>(Value(UBits(118, 32)))));
+  EXPECT_THAT(runtime->GetBlockedChannel("consumer"),
+              IsOkAndHolds(std::nullopt));
+}
+
+// Values received on `in` come from a hook rather than the channel queue.
+TEST(AotCompileTest, ProcChannelHook) {
+  std::unique_ptr<aot_compile::AotProcRuntime> runtime =
+      xls::procs::GetAotProcNetwork().NewRuntime();
+  uint32_t next_input = 10;
+  XLS_ASSERT_OK(runtime->SetChannelHook(
+      "in", aot_compile::AotChannelHook{
+                .queue = &next_input,
+                .receive =
+                    [](void* queue, uint8_t* buffer) {
+                      uint32_t* value = static_cast<uint32_t*>(queue);
+                      std::memcpy(buffer, value, sizeof(uint32_t));
+                      ++*value;
+                      return true;
+                    },
+                .send = [](void* queue, const uint8_t* data) {}}));
+
+  EXPECT_THAT(runtime->TickProc("producer", /*max_ticks=*/3),
+              IsOkAndHolds(3));
+  EXPECT_THAT(runtime->TickProc("consumer", /*max_ticks=*/5),
+              IsOkAndHolds(3));
+  // 1 + 10, then 2 + 11 and 3 + 12 accumulate.
+  EXPECT_THAT(runtime->GetState("consumer"),
+              IsOkAndHolds(std::vector<Value>{Value(UBits(39, 32))}));
+  EXPECT_EQ(next_input, 14);
+}
+
+TEST(AotCompileTest, ProcRuntimeUnknownNames) {
+  std::unique_ptr<aot_compile::AotProcRuntime> runtime =
+      xls::procs::GetAotProcNetwork().NewRuntime();
+  EXPECT_THAT(runtime->Enqueue("not_a_channel", Value(UBits(0, 32))),
+              StatusIs(absl::StatusCode::kNotFound,
+                       testing::HasSubstr("not_a_channel")));
+  EXPECT_THAT(runtime->TickProc("not_a_proc", 1),
+              StatusIs(absl::StatusCode::kNotFound,
+                       testing::HasSubstr("not_a_proc")));
+}
+
 #ifndef NDEBUG
 // In non-opt mode, argument values are type-checked using DCHECK.
 TEST(AotCompileTest, InvalidTypes) {
@@ -13,13 +13,22 @@
 // limitations under the License.
 #include "xls/jit/aot_runtime.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <numeric>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
 #include "google/protobuf/text_format.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 
 namespace xls::aot_compile {
@@ -56,4 +65,409 @@ FunctionTypeLayout::Create(std::string_view serialized_arg_layouts,
                                                  std::move(result_layout)));
 }
 
+namespace {
+
+// Alignment of each buffer within the allocation made for a call.
+constexpr int64_t kBufferAlignment = 16;
+
+int64_t AlignUp(int64_t offset) {
+  return RoundUpToNearest(offset, kBufferAlignment);
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<AotBundle>> AotBundle::Create(
+    std::string_view serialized_layouts,
+    absl::Span<const AotEntryPoint> entry_points, int64_t temp_buffer_size) {
+  auto dummy_package = std::make_unique<Package>("__aot_compiler");
+
+  TypeLayoutsProto layouts_proto;
+  if (!google::protobuf::TextFormat::ParseFromString(std::string(serialized_layouts),
+                                           &layouts_proto)) {
+    return absl::InvalidArgumentError("Unable to parse TypeLayoutsProto");
+  }
+  std::vector<TypeLayout> layouts;
+  for (const TypeLayoutProto& layout_proto : layouts_proto.layouts()) {
+    XLS_ASSIGN_OR_RETURN(
+        TypeLayout layout,
+        TypeLayout::FromProto(layout_proto, dummy_package.get()));
+    layouts.push_back(std::move(layout));
+  }
+  for (const AotEntryPoint& entry_point : entry_points) {
+    for (int64_t index : entry_point.arg_layout_indices) {
+      XLS_RET_CHECK(index >= 0 && index < layouts.size());
+    }
+    XLS_RET_CHECK(entry_point.result_layout_index >= 0 &&
+                  entry_point.result_layout_index < layouts.size());
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitRuntime> jit_runtime,
+                       JitRuntime::Create());
+  return absl::WrapUnique(new AotBundle(
+      std::move(dummy_package), std::move(layouts), std::move(jit_runtime),
+      entry_points, temp_buffer_size));
+}
+
+AotBundle::AotBundle(std::unique_ptr<Package> package,
+                     std::vector<TypeLayout> layouts,
+                     std::unique_ptr<JitRuntime> jit_runtime,
+                     absl::Span<const AotEntryPoint> entry_points,
+                     int64_t temp_buffer_size)
+    : package_(std::move(package)),
+      layouts_(std::move(layouts)),
+      jit_runtime_(std::move(jit_runtime)),
+      entry_points_(entry_points) {
+  for (int64_t i = 0; i < entry_points_.size(); ++i) {
+    const AotEntryPoint& entry_point = entry_points_[i];
+    BufferPlan plan;
+    int64_t offset = 0;
+    for (int64_t index : entry_point.arg_layout_indices) {
+      plan.arg_offsets.push_back(offset);
+      offset = AlignUp(offset + layouts_[index].size());
+    }
+    plan.result_offset = offset;
+    offset = AlignUp(offset + layouts_[entry_point.result_layout_index].size());
+    plan.temp_offset = offset;
+    plan.total_size = offset + temp_buffer_size;
+    buffer_plans_.push_back(std::move(plan));
+    entry_point_indices_[entry_point.name] = i;
+  }
+}
+
+absl::StatusOr<int64_t> AotBundle::GetEntryPointIndex(
+    std::string_view name) const {
+  auto it = entry_point_indices_.find(name);
+  if (it == entry_point_indices_.end()) {
+    return absl::NotFoundError(
+        absl::StrFormat("No AOT-compiled function named `%s`", name));
+  }
+  return it->second;
+}
+
+absl::StatusOr<Value> AotBundle::Run(int64_t index,
+                                     absl::Span<const Value> args) const {
+  XLS_RET_CHECK(index >= 0 && index < entry_points_.size());
+  const AotEntryPoint& entry_point = entry_points_[index];
+  const BufferPlan& plan = buffer_plans_[index];
+  if (args.size() != entry_point.arg_layout_indices.size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Function `%s` takes %d arguments, got %d", entry_point.name,
+        entry_point.arg_layout_indices.size(), args.size()));
+  }
+
+  std::vector<uint8_t> buffer(plan.total_size);
+  std::vector<uint8_t*> arg_buffers(args.size());
+  for (int64_t i = 0; i < args.size(); ++i) {
+    arg_buffers[i] = buffer.data() + plan.arg_offsets[i];
+    layouts_[entry_point.arg_layout_indices[i]].ValueToNativeLayout(
+        args[i], arg_buffers[i]);
+  }
+  uint8_t* output_buffers[1] = {buffer.data() + plan.result_offset};
+  InterpreterEvents events;
+  entry_point.function(arg_buffers.data(), output_buffers,
+                       buffer.data() + plan.temp_offset, &events,
+                       /*user_data=*/nullptr, jit_runtime_.get(),
+                       /*continuation_point=*/0);
+  XLS_RETURN_IF_ERROR(InterpreterEventsToStatus(events));
+  return layouts_[entry_point.result_layout_index].NativeLayoutToValue(
+      output_buffers[0]);
+}
+
+absl::StatusOr<Value> AotBundle::Run(std::string_view name,
+                                     absl::Span<const Value> args) const {
+  XLS_ASSIGN_OR_RETURN(int64_t index, GetEntryPointIndex(name));
+  return Run(index, args);
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<AotProcNetwork>>
+AotProcNetwork::Create(std::string_view serialized_layouts,
+                       absl::Span<const AotChannel> channels,
+                       absl::Span<const AotProcEntryPoint> procs,
+                       int64_t temp_buffer_size) {
+  auto dummy_package = std::make_unique<Package>("__aot_compiler");
+
+  TypeLayoutsProto layouts_proto;
+  if (!google::protobuf::TextFormat::ParseFromString(std::string(serialized_layouts),
+                                           &layouts_proto)) {
+    return absl::InvalidArgumentError("Unable to parse TypeLayoutsProto");
+  }
+  std::vector<TypeLayout> layouts;
+  for (const TypeLayoutProto& layout_proto : layouts_proto.layouts()) {
+    XLS_ASSIGN_OR_RETURN(
+        TypeLayout layout,
+        TypeLayout::FromProto(layout_proto, dummy_package.get()));
+    layouts.push_back(std::move(layout));
+  }
+  for (const AotChannel& channel : channels) {
+    XLS_RET_CHECK(channel.layout_index >= 0 &&
+                  channel.layout_index < layouts.size());
+  }
+  for (const AotProcEntryPoint& proc : procs) {
+    for (const AotProcParam& param : proc.params) {
+      if (param.layout_index < 0) {
+        continue;
+      }
+      XLS_RET_CHECK_LT(param.layout_index, layouts.size());
+      XLS_RET_CHECK_EQ(static_cast<int64_t>(param.initial_value.size()),
+                       param.buffer_size);
+    }
+    for (const AotBlockingPoint& point : proc.blocking_points) {
+      XLS_RET_CHECK(point.channel_index >= 0 &&
+                    point.channel_index < channels.size());
+    }
+  }
+  return absl::WrapUnique(new AotProcNetwork(std::move(dummy_package),
+                                             std::move(layouts), channels,
+                                             procs, temp_buffer_size));
+}
+
+AotProcNetwork::AotProcNetwork(std::unique_ptr<Package> package,
+                               std::vector<TypeLayout> layouts,
+                               absl::Span<const AotChannel> channels,
+                               absl::Span<const AotProcEntryPoint> procs,
+                               int64_t temp_buffer_size)
+    : package_(std::move(package)),
+      layouts_(std::move(layouts)),
+      channels_(channels),
+      procs_(procs),
+      temp_buffer_size_(temp_buffer_size) {
+  for (int64_t i = 0; i < channels_.size(); ++i) {
+    channel_indices_[channels_[i].name] = i;
+  }
+  for (int64_t i = 0; i < procs_.size(); ++i) {
+    proc_indices_[procs_[i].name] = i;
+  }
+}
+
+std::unique_ptr<AotProcRuntime> AotProcNetwork::NewRuntime() const {
+  return std::make_unique<AotProcRuntime>(this);
+}
+
+absl::StatusOr<int64_t> AotProcNetwork::GetChannelIndex(
+    std::string_view name) const {
+  auto it = channel_indices_.find(name);
+  if (it == channel_indices_.end()) {
+    return absl::NotFoundError(
+        absl::StrFormat("No AOT-compiled channel named `%s`", name));
+  }
+  return it->second;
+}
+
+absl::StatusOr<int64_t> AotProcNetwork::GetProcIndex(
+    std::string_view name) const {
+  auto it = proc_indices_.find(name);
+  if (it == proc_indices_.end()) {
+    return absl::NotFoundError(
+        absl::StrFormat("No AOT-compiled proc named `%s`", name));
+  }
+  return it->second;
+}
+
+bool AotChannelQueue::Read(uint8_t* buffer) {
+  if (size_ == 0) {
+    return false;
+  }
+  std::memcpy(buffer, buffer_.data() + head_ * element_size_, element_size_);
+  if (!single_value_) {
+    head_ = (head_ + 1) % capacity_;
+    --size_;
+  }
+  return true;
+}
+
+void AotChannelQueue::Write(const uint8_t* data) {
+  if (single_value_) {
+    buffer_.resize(element_size_);
+    capacity_ = 1;
+    size_ = 1;
+    std::memcpy(buffer_.data(), data, element_size_);
+    return;
+  }
+  if (size_ == capacity_) {
+    // Grow the buffer, moving the elements to the front.
+    int64_t new_capacity = std::max<int64_t>(2 * capacity_, 16);
+    std::vector<uint8_t> new_buffer(new_capacity * element_size_);
+    for (int64_t i = 0; i < size_; ++i) {
+      std::memcpy(new_buffer.data() + i * element_size_,
+                  buffer_.data() + ((head_ + i) % capacity_) * element_size_,
+                  element_size_);
+    }
+    buffer_ = std::move(new_buffer);
+    capacity_ = new_capacity;
+    head_ = 0;
+  }
+  std::memcpy(buffer_.data() + ((head_ + size_) % capacity_) * element_size_,
+              data, element_size_);
+  ++size_;
+}
+
+namespace {
+
+bool QueueReceiveHook(void* queue, uint8_t* buffer) {
+  return static_cast<AotChannelQueue*>(queue)->Read(buffer);
+}
+
+void QueueSendHook(void* queue, const uint8_t* data) {
+  static_cast<AotChannelQueue*>(queue)->Write(data);
+}
+
+}  // namespace
+
+AotProcRuntime::AotProcRuntime(const AotProcNetwork* network,
+                               void* jit_runtime)
+    : network_(network), jit_runtime_(jit_runtime) {
+  for (const AotChannel& channel : network_->channels()) {
+    queues_.push_back(std::make_unique<AotChannelQueue>(
+        network_->layout(channel.layout_index).size(), channel.single_value));
+    hooks_.push_back(AotChannelHook{.queue = queues_.back().get(),
+                                    .receive = &QueueReceiveHook,
+                                    .send = &QueueSendHook});
+  }
+  procs_.resize(network_->procs().size());
+  for (int64_t i = 0; i < procs_.size(); ++i) {
+    const AotProcEntryPoint& proc = network_->procs()[i];
+    ProcState& state = procs_[i];
+    // The outer vector is sized up front so the raw pointers into it remain
+    // valid.
+    state.buffers.reserve(2 * proc.params.size());
+    for (const AotProcParam& param : proc.params) {
+      state.buffers.emplace_back(param.initial_value.begin(),
+                                 param.initial_value.end());
+      state.buffers.back().resize(param.buffer_size);
+      state.input_ptrs.push_back(state.buffers.back().data());
+      if (param.in_place) {
+        state.output_ptrs.push_back(state.input_ptrs.back());
+      } else {
+        state.buffers.emplace_back(param.buffer_size);
+        state.output_ptrs.push_back(state.buffers.back().data());
+      }
+    }
+    state.temp_buffer.resize(network_->temp_buffer_size());
+  }
+}
+
+int64_t AotProcRuntime::RunProc(int64_t proc_index, int64_t max_ticks,
+                                bool* progress_made) {
+  const AotProcEntryPoint& proc = network_->procs()[proc_index];
+  ProcState& state = procs_[proc_index];
+  int64_t tick_state[2] = {state.continuation_point, max_ticks};
+  int64_t continuation_point = proc.function(
+      state.input_ptrs.data(), state.output_ptrs.data(),
+      state.temp_buffer.data(), &state.events, hooks_.data(), jit_runtime_,
+      tick_state);
+  int64_t ticks_completed = tick_state[1];
+  // The compiled code swaps the input and output buffers after each tick, so
+  // after an odd number of ticks the next state is in the output buffers.
+  if (ticks_completed % 2 == 1) {
+    std::swap(state.input_ptrs, state.output_ptrs);
+  }
+  *progress_made =
+      ticks_completed > 0 || continuation_point != state.continuation_point;
+  state.continuation_point = continuation_point;
+  return ticks_completed;
+}
+
+absl::Status AotProcRuntime::Tick() {
+  std::vector<int64_t> pending(procs_.size());
+  std::iota(pending.begin(), pending.end(), 0);
+  bool progress_made = true;
+  while (!pending.empty() && progress_made) {
+    progress_made = false;
+    std::vector<int64_t> blocked;
+    for (int64_t proc_index : pending) {
+      bool proc_progress = false;
+      if (RunProc(proc_index, /*max_ticks=*/1, &proc_progress) == 0) {
+        blocked.push_back(proc_index);
+      }
+      progress_made |= proc_progress;
+    }
+    pending = std::move(blocked);
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<int64_t> AotProcRuntime::TickProc(std::string_view proc_name,
+                                                 int64_t max_ticks) {
+  XLS_RET_CHECK_GE(max_ticks, 0);
+  XLS_ASSIGN_OR_RETURN(int64_t proc_index,
+                       network_->GetProcIndex(proc_name));
+  bool progress_made = false;
+  return RunProc(proc_index, max_ticks, &progress_made);
+}
+
+absl::Status AotProcRuntime::Enqueue(std::string_view channel_name,
+                                     const Value& value) {
+  XLS_ASSIGN_OR_RETURN(int64_t channel_index,
+                       network_->GetChannelIndex(channel_name));
+  const TypeLayout& layout =
+      network_->layout(network_->channels()[channel_index].layout_index);
+  std::vector<uint8_t> buffer(layout.size());
+  layout.ValueToNativeLayout(value, buffer.data());
+  queues_[channel_index]->Write(buffer.data());
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::optional<Value>> AotProcRuntime::Dequeue(
+    std::string_view channel_name) {
+  XLS_ASSIGN_OR_RETURN(int64_t channel_index,
+                       network_->GetChannelIndex(channel_name));
+  const TypeLayout& layout =
+      network_->layout(network_->channels()[channel_index].layout_index);
+  std::vector<uint8_t> buffer(layout.size());
+  if (!queues_[channel_index]->Read(buffer.data())) {
+    return std::nullopt;
+  }
+  return layout.NativeLayoutToValue(buffer.data());
+}
+
+absl::Status AotProcRuntime::SetChannelHook(std::string_view channel_name,
+                                            AotChannelHook hook) {
+  XLS_ASSIGN_OR_RETURN(int64_t channel_index,
+                       network_->GetChannelIndex(channel_name));
+  XLS_RET_CHECK(hook.receive != nullptr && hook.send != nullptr);
+  hooks_[channel_index] = hook;
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<Value>> AotProcRuntime::GetState(
+    std::string_view proc_name) const {
+  XLS_ASSIGN_OR_RETURN(int64_t proc_index,
+                       network_->GetProcIndex(proc_name));
+  const AotProcEntryPoint& proc = network_->procs()[proc_index];
+  const ProcState& state = procs_[proc_index];
+  std::vector<Value> values;
+  for (int64_t i = 0; i < proc.params.size(); ++i) {
+    if (proc.params[i].layout_index >= 0) {
+      values.push_back(network_->layout(proc.params[i].layout_index)
+                           .NativeLayoutToValue(state.input_ptrs[i]));
+    }
+  }
+  return values;
+}
+
+absl::StatusOr<std::optional<std::string_view>>
+AotProcRuntime::GetBlockedChannel(std::string_view proc_name) const {
+  XLS_ASSIGN_OR_RETURN(int64_t proc_index,
+                       network_->GetProcIndex(proc_name));
+  int64_t continuation_point = procs_[proc_index].continuation_point;
+  if (continuation_point == 0) {
+    return std::nullopt;
+  }
+  for (const AotBlockingPoint& point :
+       network_->procs()[proc_index].blocking_points) {
+    if (point.continuation_point == continuation_point) {
+      return network_->channels()[point.channel_index].name;
+    }
+  }
+  return absl::InternalError(
+      absl::StrFormat("Proc `%s` stopped at unknown continuation point %d",
+                      proc_name, continuation_point));
+}
+
+absl::StatusOr<const InterpreterEvents*> AotProcRuntime::GetInterpreterEvents(
+    std::string_view proc_name) const {
+  XLS_ASSIGN_OR_RETURN(int64_t proc_index,
+                       network_->GetProcIndex(proc_name));
+  return &procs_[proc_index].events;
+}
+
 }  // namespace xls::aot_compile
@@ -18,14 +18,21 @@
 #ifndef XLS_JIT_AOT_RUNTIME_H_
 #define XLS_JIT_AOT_RUNTIME_H_
 
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/ir/events.h"
 #include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_runtime.h"
 #include "xls/jit/type_layout.h"
 #include "xls/jit/type_layout.pb.h"
 
@@ -74,6 +81,292 @@ class FunctionTypeLayout {
   TypeLayout result_layout_;
 };
 
+// Signature of the jitted functions in AOT-compiled object code. See
+// JitFunctionType in function_base_jit.h; the JitRuntime argument is opaque
+// here.
+using AotFunctionType = int64_t (*)(const uint8_t* const* inputs,
+                                    uint8_t* const* outputs, void* temp_buffer,
+                                    ::xls::InterpreterEvents* events,
+                                    void* user_data, void* jit_runtime,
+                                    int64_t continuation_point);
+
+// Description of a single function in an AOT-compiled bundle of functions.
+// The AOT compiler emits these as a static dispatch table. Layouts are
+// referred to by index into the layouts shared by the whole bundle.
+struct AotEntryPoint {
+  // Name of the XLS function with the package-scoping mangling removed.
+  const char* name;
+  AotFunctionType function;
+  absl::Span<const int64_t> arg_layout_indices;
+  int64_t result_layout_index;
+};
+
+// Runtime support for a bundle of AOT-compiled functions sharing one object
+// file. Holds the TypeLayouts of every distinct argument and result type in the
+// bundle (deserialized once) and precomputed buffer offsets for each entry
+// point so each call performs a single allocation, and the JitRuntime passed
+// to the compiled code, as by FunctionJit. Thread-safe.
+class AotBundle {
+ public:
+  // Creates an AotBundle. `serialized_layouts` is a text serialization of a
+  // TypeLayoutsProto indexed by the layout indices in `entry_points`.
+  // `entry_points` must outlive the returned object. `temp_buffer_size` is the
+  // size of the temporary buffer shared by all entry points.
+  static absl::StatusOr<std::unique_ptr<AotBundle>> Create(
+      std::string_view serialized_layouts,
+      absl::Span<const AotEntryPoint> entry_points, int64_t temp_buffer_size);
+
+  // Calls the entry point at index `index` with the given arguments and
+  // returns the result. Returns an error if an assertion fails during
+  // execution.
+  absl::StatusOr<Value> Run(int64_t index, absl::Span<const Value> args) const;
+
+  // As above, but the entry point is identified by name.
+  absl::StatusOr<Value> Run(std::string_view name,
+                            absl::Span<const Value> args) const;
+
+  // Returns the index of the entry point with the given name.
+  absl::StatusOr<int64_t> GetEntryPointIndex(std::string_view name) const;
+
+  absl::Span<const AotEntryPoint> entry_points() const {
+    return entry_points_;
+  }
+  const TypeLayout& layout(int64_t index) const { return layouts_[index]; }
+
+ private:
+  // Offsets of each buffer within the single allocation made per call.
+  struct BufferPlan {
+    std::vector<int64_t> arg_offsets;
+    int64_t result_offset;
+    int64_t temp_offset;
+    int64_t total_size;
+  };
+
+  AotBundle(std::unique_ptr<Package> package, std::vector<TypeLayout> layouts,
+            std::unique_ptr<JitRuntime> jit_runtime,
+            absl::Span<const AotEntryPoint> entry_points,
+            int64_t temp_buffer_size);
+
+  // Dummy package used for owning Types required by the TypeLayout data
+  // structures.
+  std::unique_ptr<Package> package_;
+  std::vector<TypeLayout> layouts_;
+  std::unique_ptr<JitRuntime> jit_runtime_;
+  absl::Span<const AotEntryPoint> entry_points_;
+  std::vector<BufferPlan> buffer_plans_;
+  absl::flat_hash_map<std::string, int64_t> entry_point_indices_;
+};
+
+// Entry of the table of channel access hooks through which AOT-compiled procs
+// send and receive (see BuildProcFunctionsWithHooks). The table is passed as
+// the `user_data` argument of the compiled code and has an entry for each
+// channel of the package, in package order. Data is in the native layout of
+// the channel's payload type.
+struct AotChannelHook {
+  void* queue;
+  // Reads an element of `queue` into `buffer`. Returns false if `queue` is
+  // empty.
+  bool (*receive)(void* queue, uint8_t* buffer);
+  // Writes the element at `data` to `queue`.
+  void (*send)(void* queue, const uint8_t* data);
+};
+
+// Signature of the jitted functions running multiple proc ticks in
+// AOT-compiled object code. See JitMultiTickFunctionType in
+// function_base_jit.h; the JitRuntime argument is opaque here.
+using AotMultiTickFunctionType = int64_t (*)(const uint8_t* const* inputs,
+                                             uint8_t* const* outputs,
+                                             void* temp_buffer,
+                                             ::xls::InterpreterEvents* events,
+                                             void* user_data, void* jit_runtime,
+                                             int64_t* tick_state);
+
+// Description of a channel of an AOT-compiled network of procs.
+struct AotChannel {
+  const char* name;
+  // Index of the layout of the payload type.
+  int64_t layout_index;
+  // Whether reads of the channel are non-destructive and writes overwrite the
+  // single value it holds.
+  bool single_value;
+};
+
+// Description of a parameter of an AOT-compiled proc: the token or a state
+// element.
+struct AotProcParam {
+  int64_t buffer_size;
+  // Index of the layout of the state element, or -1 for the token.
+  int64_t layout_index;
+  // The initial value of the state element in native layout.
+  absl::Span<const uint8_t> initial_value;
+  // Whether the current and next value of the state element share a buffer
+  // (see JittedFunctionBase::in_place_state_indices).
+  bool in_place;
+};
+
+// A continuation point at which an AOT-compiled proc blocks on a receive from
+// the channel with index `channel_index`.
+struct AotBlockingPoint {
+  int64_t continuation_point;
+  int64_t channel_index;
+};
+
+// Description of a single proc of an AOT-compiled network of procs.
+struct AotProcEntryPoint {
+  // Name of the XLS proc with the package-scoping mangling removed.
+  const char* name;
+  AotMultiTickFunctionType function;
+  absl::Span<const AotProcParam> params;
+  absl::Span<const AotBlockingPoint> blocking_points;
+};
+
+class AotProcRuntime;
+
+// The network of procs of a package compiled ahead of time into one object
+// file. The AOT compiler emits the channels and procs as static tables; this
+// class deserializes the layouts they refer to once. Immutable and
+// thread-safe; the execution state lives in the AotProcRuntimes it creates.
+class AotProcNetwork {
+ public:
+  // Creates an AotProcNetwork. `serialized_layouts` is a text serialization of
+  // a TypeLayoutsProto indexed by the layout indices in `channels` and
+  // `procs`, which must outlive the returned object. `temp_buffer_size` is the
+  // size of the temporary buffer of each proc.
+  static absl::StatusOr<std::unique_ptr<AotProcNetwork>> Create(
+      std::string_view serialized_layouts,
+      absl::Span<const AotChannel> channels,
+      absl::Span<const AotProcEntryPoint> procs, int64_t temp_buffer_size);
+
+  // Returns a runtime executing the procs from their initial state with empty
+  // channels. Creating a runtime compiles nothing.
+  std::unique_ptr<AotProcRuntime> NewRuntime() const;
+
+  absl::StatusOr<int64_t> GetChannelIndex(std::string_view name) const;
+  absl::StatusOr<int64_t> GetProcIndex(std::string_view name) const;
+
+  absl::Span<const AotChannel> channels() const { return channels_; }
+  absl::Span<const AotProcEntryPoint> procs() const { return procs_; }
+  const TypeLayout& layout(int64_t index) const { return layouts_[index]; }
+  int64_t temp_buffer_size() const { return temp_buffer_size_; }
+
+ private:
+  AotProcNetwork(std::unique_ptr<Package> package,
+                 std::vector<TypeLayout> layouts,
+                 absl::Span<const AotChannel> channels,
+                 absl::Span<const AotProcEntryPoint> procs,
+                 int64_t temp_buffer_size);
+
+  // Dummy package used for owning Types required by the TypeLayout data
+  // structures.
+  std::unique_ptr<Package> package_;
+  std::vector<TypeLayout> layouts_;
+  absl::Span<const AotChannel> channels_;
+  absl::Span<const AotProcEntryPoint> procs_;
+  int64_t temp_buffer_size_;
+  absl::flat_hash_map<std::string, int64_t> channel_indices_;
+  absl::flat_hash_map<std::string, int64_t> proc_indices_;
+};
+
+// An unbounded FIFO of elements of a channel in native layout, used as the
+// default target of the channel hooks of an AotProcRuntime.
+class AotChannelQueue {
+ public:
+  AotChannelQueue(int64_t element_size, bool single_value)
+      : element_size_(element_size), single_value_(single_value) {}
+
+  // Reads the element at the head of the queue into `buffer`. Returns false if
+  // the queue is empty. Reads of single-value channels do not remove the
+  // element.
+  bool Read(uint8_t* buffer);
+
+  // Writes the element at `data` to the tail of the queue.
+  void Write(const uint8_t* data);
+
+  int64_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+ private:
+  int64_t element_size_;
+  bool single_value_;
+  // Circular buffer of `capacity_` elements.
+  std::vector<uint8_t> buffer_;
+  int64_t capacity_ = 0;
+  int64_t head_ = 0;
+  int64_t size_ = 0;
+};
+
+// Executes an AOT-compiled network of procs: a lightweight counterpart to the
+// JIT proc runtimes which compiles nothing at run time. Every channel is
+// backed by an AotChannelQueue unless routed to user-provided hooks with
+// SetChannelHook. Not thread-safe.
+class AotProcRuntime {
+ public:
+  // `jit_runtime` is passed to the compiled code, which needs it only to
+  // format trace messages. It may be null if the procs contain no traces.
+  explicit AotProcRuntime(const AotProcNetwork* network,
+                          void* jit_runtime = nullptr);
+
+  // Ticks each proc once: each proc runs until it completes a tick or blocks
+  // on a receive with no data. Blocked procs are retried while other procs make
+  // progress, so data sent within the network is consumed in the same tick.
+  // Procs still blocked afterwards resume where they stopped on the next call.
+  absl::Status Tick();
+
+  // Runs up to `max_ticks` ticks of the given proc in a single call into the
+  // compiled code, stopping early if it blocks on a receive. Returns the
+  // number of ticks completed.
+  absl::StatusOr<int64_t> TickProc(std::string_view proc_name,
+                                   int64_t max_ticks);
+
+  // Runs up to `max_ticks` ticks of the proc with index `proc_index` in the
+  // network. Returns the number of ticks completed and sets `progress_made` if
+  // any node executed.
+  int64_t RunProc(int64_t proc_index, int64_t max_ticks, bool* progress_made);
+
+  // Writes (reads) a value to (from) the queue of the given channel. Dequeue
+  // returns std::nullopt if the queue is empty. Channels routed to hooks have
+  // no queue.
+  absl::Status Enqueue(std::string_view channel_name, const Value& value);
+  absl::StatusOr<std::optional<Value>> Dequeue(std::string_view channel_name);
+
+  // Routes sends and receives on the given channel to `hook` instead of the
+  // channel's queue, e.g., to connect the procs to a C++ model.
+  absl::Status SetChannelHook(std::string_view channel_name,
+                              AotChannelHook hook);
+
+  // Returns the current state of the given proc.
+  absl::StatusOr<std::vector<Value>> GetState(std::string_view proc_name) const;
+
+  // Returns the name of the channel whose receive the given proc is blocked
+  // on, or std::nullopt if the proc is at the start of a tick.
+  absl::StatusOr<std::optional<std::string_view>> GetBlockedChannel(
+      std::string_view proc_name) const;
+
+  // Returns the events recorded by the given proc since the runtime was
+  // created.
+  absl::StatusOr<const InterpreterEvents*> GetInterpreterEvents(
+      std::string_view proc_name) const;
+
+ private:
+  // The execution state of a proc. As in ProcJitContinuation each parameter
+  // has two buffers whose roles as input and output alternate each tick,
+  // except for state elements updated in place which have one.
+  struct ProcState {
+    std::vector<std::vector<uint8_t>> buffers;
+    std::vector<uint8_t*> input_ptrs;
+    std::vector<uint8_t*> output_ptrs;
+    std::vector<uint8_t> temp_buffer;
+    int64_t continuation_point = 0;
+    InterpreterEvents events;
+  };
+
+  const AotProcNetwork* network_;
+  void* jit_runtime_;
+  std::vector<std::unique_ptr<AotChannelQueue>> queues_;
+  std::vector<AotChannelHook> hooks_;
+  std::vector<ProcState> procs_;
+};
+
 }  // namespace xls::aot_compile
 
 #endif  // XLS_JIT_AOT_RUNTIME_H_
@@ -0,0 +1,121 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "include/benchmark/benchmark.h"
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/jit/function_jit.h"
+
+namespace xls {
+namespace {
+
+// Measures the throughput of evaluating a function on a batch of inputs with
+// FunctionJit::RunBatch compared with one FunctionJit::RunWithViews call per
+// set of inputs.
+constexpr char kFunction[] = R"(
+fn f(x: bits[32], y: bits[32], z: bits[32]) -> bits[32] {
+  umul.1: bits[32] = umul(x, y)
+  add.2: bits[32] = add(umul.1, z)
+  shrl.3: bits[32] = shrl(add.2, y)
+  ret xor.4: bits[32] = xor(shrl.3, x)
+}
+)";
+constexpr int64_t kParamCount = 3;
+
+struct BatchedInputs {
+  std::vector<std::vector<uint32_t>> columns;
+  std::vector<uint32_t> results;
+};
+
+BatchedInputs MakeInputs(int64_t batch_size) {
+  std::minstd_rand bitgen;
+  std::uniform_int_distribution<uint32_t> distribution;
+  BatchedInputs inputs;
+  for (int64_t i = 0; i < kParamCount; ++i) {
+    std::vector<uint32_t>& column = inputs.columns.emplace_back(batch_size);
+    for (uint32_t& value : column) {
+      value = distribution(bitgen);
+    }
+  }
+  inputs.results.resize(batch_size);
+  return inputs;
+}
+
+static void BM_RunWithViewsPerLane(benchmark::State& state) {
+  int64_t batch_size = state.range(0);
+  Package package("BM");
+  Function* f = Parser::ParseFunction(kFunction, &package).value();
+  std::unique_ptr<FunctionJit> jit = FunctionJit::Create(f).value();
+  BatchedInputs inputs = MakeInputs(batch_size);
+  std::vector<uint8_t> temp_buffer(jit->GetTempBufferSize());
+  InterpreterEvents events;
+  for (auto _ : state) {
+    for (int64_t lane = 0; lane < batch_size; ++lane) {
+      const uint8_t* args[kParamCount];
+      for (int64_t i = 0; i < kParamCount; ++i) {
+        args[i] = reinterpret_cast<const uint8_t*>(&inputs.columns[i][lane]);
+      }
+      XLS_CHECK_OK(jit->RunWithViews(
+          args,
+          absl::MakeSpan(reinterpret_cast<uint8_t*>(&inputs.results[lane]),
+                         sizeof(uint32_t)),
+          absl::MakeSpan(temp_buffer), &events));
+    }
+    benchmark::DoNotOptimize(inputs.results.data());
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size);
+}
+
+static void BM_RunBatch(benchmark::State& state) {
+  int64_t batch_size = state.range(0);
+  Package package("BM");
+  Function* f = Parser::ParseFunction(kFunction, &package).value();
+  std::unique_ptr<FunctionJit> jit =
+      FunctionJit::Create(f, /*opt_level=*/3, /*profile=*/nullptr,
+                          /*build_batched_wrapper=*/true)
+          .value();
+  BatchedInputs inputs = MakeInputs(batch_size);
+  std::vector<const uint8_t*> arg_columns;
+  for (const std::vector<uint32_t>& column : inputs.columns) {
+    arg_columns.push_back(reinterpret_cast<const uint8_t*>(column.data()));
+  }
+  absl::Span<uint8_t> result_column(
+      reinterpret_cast<uint8_t*>(inputs.results.data()),
+      batch_size * sizeof(uint32_t));
+  std::vector<uint8_t> temp_buffer(jit->GetTempBufferSize());
+  InterpreterEvents events;
+  for (auto _ : state) {
+    XLS_CHECK_OK(jit->RunBatch(arg_columns, result_column, batch_size,
+                               absl::MakeSpan(temp_buffer), &events));
+    benchmark::DoNotOptimize(inputs.results.data());
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size);
+}
+
+BENCHMARK(BM_RunWithViewsPerLane)->Range(1, 4096);
+BENCHMARK(BM_RunBatch)->Range(1, 4096);
+
+}  // namespace
+}  // namespace xls
+
+BENCHMARK_MAIN();
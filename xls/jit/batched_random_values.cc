@@ -0,0 +1,133 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/batched_random_values.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
+#include "xls/ir/type.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+namespace {
+
+uint64_t SplitMix64(uint64_t& state) {
+  uint64_t z = (state += 0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+uint64_t RotateLeft(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+// Appends the bit count of each leaf of `type`, in the order of the element
+// layouts of its TypeLayout. Tokens have a bit count of -1.
+void GetLeafBitCounts(Type* type, std::vector<int64_t>* bit_counts) {
+  if (type->IsBits()) {
+    bit_counts->push_back(type->AsBitsOrDie()->bit_count());
+  } else if (type->IsToken()) {
+    bit_counts->push_back(-1);
+  } else if (type->IsArray()) {
+    ArrayType* array_type = type->AsArrayOrDie();
+    for (int64_t i = 0; i < array_type->size(); ++i) {
+      GetLeafBitCounts(array_type->element_type(), bit_counts);
+    }
+  } else {
+    for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+      GetLeafBitCounts(element_type, bit_counts);
+    }
+  }
+}
+
+}  // namespace
+
+BatchedRandomValueGenerator::BatchedRandomValueGenerator(
+    uint64_t seed, double corner_case_probability)
+    : corner_case_probability_(corner_case_probability) {
+  for (uint64_t& word : state_) {
+    word = SplitMix64(seed);
+  }
+}
+
+uint64_t BatchedRandomValueGenerator::Next() {
+  const uint64_t result = RotateLeft(state_[1] * 5, 7) * 9;
+  const uint64_t t = state_[1] << 17;
+  state_[2] ^= state_[0];
+  state_[3] ^= state_[1];
+  state_[1] ^= state_[2];
+  state_[0] ^= state_[3];
+  state_[2] ^= t;
+  state_[3] = RotateLeft(state_[3], 45);
+  return result;
+}
+
+void BatchedRandomValueGenerator::FillLeaf(int64_t bit_count,
+                                           int64_t data_size,
+                                           uint8_t* buffer) {
+  if (bit_count <= 0) {
+    return;
+  }
+  // The top 53 bits make a uniform double in [0, 1).
+  if (static_cast<double>(Next() >> 11) * 0x1.0p-53 <
+      corner_case_probability_) {
+    switch (Next() % 3) {
+      case 0:
+        std::memset(buffer, 0, data_size);
+        return;
+      case 1:
+        std::memset(buffer, 0xff, data_size);
+        break;
+      default: {
+        std::memset(buffer, 0, data_size);
+        int64_t bit = Next() % bit_count;
+        buffer[bit / 8] = uint8_t{1} << (bit % 8);
+        return;
+      }
+    }
+  } else {
+    for (int64_t i = 0; i < data_size; i += 8) {
+      uint64_t word = Next();
+      std::memcpy(buffer + i, &word, std::min<int64_t>(8, data_size - i));
+    }
+  }
+  if (bit_count % 8 != 0) {
+    buffer[data_size - 1] &= (uint8_t{1} << (bit_count % 8)) - 1;
+  }
+}
+
+void BatchedRandomValueGenerator::Fill(const TypeLayout& layout,
+                                       int64_t batch_size,
+                                       absl::Span<uint8_t> column) {
+  XLS_CHECK_GE(column.size(), batch_size * layout.size());
+  std::vector<int64_t> bit_counts;
+  GetLeafBitCounts(layout.type(), &bit_counts);
+  absl::Span<const ElementLayout> elements = layout.elements();
+  XLS_CHECK_EQ(bit_counts.size(), elements.size());
+
+  std::memset(column.data(), 0, batch_size * layout.size());
+  for (int64_t lane = 0; lane < batch_size; ++lane) {
+    uint8_t* value = column.data() + lane * layout.size();
+    for (int64_t i = 0; i < elements.size(); ++i) {
+      FillLeaf(bit_counts[i], elements[i].data_size,
+               value + elements[i].offset);
+    }
+  }
+}
+
+}  // namespace xls
@@ -0,0 +1,62 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_BATCHED_RANDOM_VALUES_H_
+#define XLS_JIT_BATCHED_RANDOM_VALUES_H_
+
+#include <array>
+#include <cstdint>
+
+#include "absl/types/span.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+
+// Generates random values directly in the native layout used by the JIT, so
+// that large batches of random inputs can be fed to the batched entry points
+// (e.g. FunctionJit::RunBatch) without building a Value per input.
+//
+// Every bits leaf of a generated value is, with probability
+// `corner_case_probability`, one of the corner cases all zeros, all ones or a
+// single set bit (chosen uniformly), and otherwise uniformly random. Bytes are
+// produced 64 bits at a time by a xoshiro256** generator, which is several
+// times cheaper per bit than the std:: engines and distributions.
+class BatchedRandomValueGenerator {
+ public:
+  explicit BatchedRandomValueGenerator(uint64_t seed,
+                                       double corner_case_probability = 0.25);
+
+  // Writes `batch_size` random values of the type described by `layout`
+  // consecutively into `column`, which must hold at least
+  // `batch_size * layout.size()` bytes. Padding bytes are zeroed and the
+  // unused high bits of each leaf are clear, so the values are valid inputs to
+  // the JIT.
+  void Fill(const TypeLayout& layout, int64_t batch_size,
+            absl::Span<uint8_t> column);
+
+  // Returns 64 uniformly random bits.
+  uint64_t Next();
+
+ private:
+  // Writes a random value of `bit_count` bits to the `data_size` bytes at
+  // `buffer`.
+  void FillLeaf(int64_t bit_count, int64_t data_size, uint8_t* buffer);
+
+  std::array<uint64_t, 4> state_;
+  double corner_case_probability_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_BATCHED_RANDOM_VALUES_H_
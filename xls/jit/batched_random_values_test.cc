@@ -0,0 +1,102 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/batched_random_values.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+namespace {
+
+constexpr int64_t kBatchSize = 1000;
+
+TEST(BatchedRandomValuesTest, BitsLeaves) {
+  Package package("test");
+  TypeLayout layout(package.GetBitsType(12), 2,
+                    {ElementLayout{.offset = 0, .data_size = 2,
+                                   .padded_size = 2}});
+  BatchedRandomValueGenerator generator(/*seed=*/42);
+  std::vector<uint8_t> column(kBatchSize * layout.size());
+  generator.Fill(layout, kBatchSize, absl::MakeSpan(column));
+
+  absl::flat_hash_set<uint64_t> values;
+  for (int64_t i = 0; i < kBatchSize; ++i) {
+    // The high four bits are clear.
+    EXPECT_EQ(column[2 * i + 1] & 0xf0, 0);
+    Value value = layout.NativeLayoutToValue(column.data() + 2 * i);
+    values.insert(value.bits().ToUint64().value());
+  }
+  // The corner cases show up, as well as many random values.
+  EXPECT_TRUE(values.contains(0));
+  EXPECT_TRUE(values.contains(0xfff));
+  EXPECT_GT(values.size(), kBatchSize / 2);
+}
+
+TEST(BatchedRandomValuesTest, AggregateWithPadding) {
+  Package package("test");
+  Type* type = package.GetTupleType(
+      {package.GetBitsType(3), package.GetArrayType(2, package.GetBitsType(64)),
+       package.GetTokenType()});
+  TypeLayout layout(
+      type, 32,
+      {ElementLayout{.offset = 0, .data_size = 1, .padded_size = 1},
+       ElementLayout{.offset = 8, .data_size = 8, .padded_size = 8},
+       ElementLayout{.offset = 16, .data_size = 8, .padded_size = 8},
+       ElementLayout{.offset = 24, .data_size = 0, .padded_size = 0}});
+  BatchedRandomValueGenerator generator(/*seed=*/0);
+  std::vector<uint8_t> column(kBatchSize * layout.size(), 0xaa);
+  generator.Fill(layout, kBatchSize, absl::MakeSpan(column));
+
+  for (int64_t i = 0; i < kBatchSize; ++i) {
+    const uint8_t* value = column.data() + i * layout.size();
+    EXPECT_LT(value[0], 8);
+    for (int64_t j = 1; j < 8; ++j) {
+      EXPECT_EQ(value[j], 0);
+    }
+    for (int64_t j = 24; j < 32; ++j) {
+      EXPECT_EQ(value[j], 0);
+    }
+  }
+}
+
+TEST(BatchedRandomValuesTest, Deterministic) {
+  Package package("test");
+  TypeLayout layout(package.GetBitsType(64), 8,
+                    {ElementLayout{.offset = 0, .data_size = 8,
+                                   .padded_size = 8}});
+  std::vector<uint8_t> a(kBatchSize * 8);
+  std::vector<uint8_t> b(kBatchSize * 8);
+  std::vector<uint8_t> c(kBatchSize * 8);
+  BatchedRandomValueGenerator(/*seed=*/7).Fill(layout, kBatchSize,
+                                               absl::MakeSpan(a));
+  BatchedRandomValueGenerator(/*seed=*/7).Fill(layout, kBatchSize,
+                                               absl::MakeSpan(b));
+  BatchedRandomValueGenerator(/*seed=*/8).Fill(layout, kBatchSize,
+                                               absl::MakeSpan(c));
+  EXPECT_EQ(a, b);
+  EXPECT_NE(a, c);
+}
+
+}  // namespace
+}  // namespace xls
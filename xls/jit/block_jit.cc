@@ -0,0 +1,459 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/block_jit.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/register.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value_helpers.h"
+
+namespace xls {
+namespace {
+
+// Returns the next value of the register written by `reg_write` in the cycle
+// function `f`. `current` is the parameter holding the current value of the
+// register and `node_map` maps nodes of the block to their counterparts in
+// `f`. Reset has priority over the load enable matching BlockRun.
+absl::StatusOr<Node*> BuildNextRegisterValue(
+    RegisterWrite* reg_write, Node* current,
+    const absl::flat_hash_map<Node*, Node*>& node_map, Function* f) {
+  Node* next = node_map.at(reg_write->data());
+  if (reg_write->load_enable().has_value()) {
+    XLS_ASSIGN_OR_RETURN(
+        next, f->MakeNode<Select>(
+                  reg_write->loc(), node_map.at(*reg_write->load_enable()),
+                  std::vector<Node*>{current, next},
+                  /*default_value=*/std::nullopt));
+  }
+  if (reg_write->reset().has_value()) {
+    XLS_RET_CHECK(reg_write->GetRegister()->reset().has_value());
+    const Reset& reset = reg_write->GetRegister()->reset().value();
+    Node* reset_active = node_map.at(*reg_write->reset());
+    if (reset.active_low) {
+      XLS_ASSIGN_OR_RETURN(reset_active, f->MakeNode<UnOp>(reg_write->loc(),
+                                                           reset_active,
+                                                           Op::kNot));
+    }
+    XLS_ASSIGN_OR_RETURN(Node * reset_value,
+                         f->MakeNode<Literal>(reg_write->loc(),
+                                              reset.reset_value));
+    XLS_ASSIGN_OR_RETURN(
+        next, f->MakeNode<Select>(reg_write->loc(), reset_active,
+                                  std::vector<Node*>{next, reset_value},
+                                  /*default_value=*/std::nullopt));
+  }
+  return next;
+}
+
+// Builds a function in `package` which computes a single cycle of `block`. The
+// parameters of the function are the input ports followed by the current
+// register values. The function returns a tuple of the values of the output
+// ports followed by the next register values.
+absl::StatusOr<Function*> BuildCycleFunction(Block* block, Package* package) {
+  if (!block->GetInstantiations().empty()) {
+    return absl::UnimplementedError(
+        absl::StrFormat("Block `%s` contains instantiations which are not "
+                        "supported by the block JIT",
+                        block->name()));
+  }
+  Function* f = package->AddFunction(std::make_unique<Function>(
+      absl::StrCat(block->name(), "_cycle"), package));
+
+  absl::flat_hash_map<Node*, Node*> node_map;
+  for (InputPort* port : block->GetInputPorts()) {
+    XLS_ASSIGN_OR_RETURN(Type * type,
+                         package->MapTypeFromOtherPackage(port->GetType()));
+    node_map[port] = f->AddNode(
+        std::make_unique<Param>(port->loc(), port->GetName(), type, f));
+  }
+  std::vector<Node*> register_params;
+  absl::flat_hash_map<Register*, Node*> register_param_map;
+  for (Register* reg : block->GetRegisters()) {
+    XLS_ASSIGN_OR_RETURN(Type * type,
+                         package->MapTypeFromOtherPackage(reg->type()));
+    register_params.push_back(f->AddNode(
+        std::make_unique<Param>(SourceInfo(), reg->name(), type, f)));
+    register_param_map[reg] = register_params.back();
+  }
+
+  for (Node* node : TopoSort(block)) {
+    if (node->Is<InputPort>() || node->Is<OutputPort>() ||
+        node->Is<RegisterWrite>()) {
+      continue;
+    }
+    if (node->Is<RegisterRead>()) {
+      node_map[node] =
+          register_param_map.at(node->As<RegisterRead>()->GetRegister());
+      continue;
+    }
+    if (node->Is<Invoke>() || node->Is<Map>() || node->Is<CountedFor>() ||
+        node->Is<DynamicCountedFor>()) {
+      return absl::UnimplementedError(absl::StrFormat(
+          "Node `%s` in block `%s` calls a function which is not supported by "
+          "the block JIT",
+          node->GetName(), block->name()));
+    }
+    std::vector<Node*> new_operands;
+    new_operands.reserve(node->operand_count());
+    for (Node* operand : node->operands()) {
+      new_operands.push_back(node_map.at(operand));
+    }
+    XLS_ASSIGN_OR_RETURN(node_map[node],
+                         node->CloneInNewFunction(new_operands, f));
+  }
+
+  std::vector<Node*> results;
+  for (OutputPort* port : block->GetOutputPorts()) {
+    results.push_back(node_map.at(port->operand(0)));
+  }
+  for (int64_t i = 0; i < block->GetRegisters().size(); ++i) {
+    Register* reg = block->GetRegisters()[i];
+    absl::StatusOr<RegisterWrite*> reg_write = block->GetRegisterWrite(reg);
+    if (!reg_write.ok()) {
+      // A register which is never written holds its value.
+      results.push_back(register_params[i]);
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(Node * next,
+                         BuildNextRegisterValue(reg_write.value(),
+                                                register_params[i], node_map,
+                                                f));
+    results.push_back(next);
+  }
+  XLS_ASSIGN_OR_RETURN(Node * result,
+                       f->MakeNode<Tuple>(SourceInfo(), results));
+  XLS_RETURN_IF_ERROR(f->set_return_value(result));
+  return f;
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<BlockJit>> BlockJit::Create(Block* block,
+                                                           int64_t opt_level) {
+  auto package = std::make_unique<Package>(
+      absl::StrCat(block->package()->name(), "_block_jit"));
+  XLS_ASSIGN_OR_RETURN(Function * cycle_function,
+                       BuildCycleFunction(block, package.get()));
+  auto jit = absl::WrapUnique(
+      new BlockJit(block, std::move(package), cycle_function));
+  XLS_ASSIGN_OR_RETURN(jit->function_jit_,
+                       FunctionJit::Create(cycle_function, opt_level));
+
+  JitRuntime* runtime = jit->function_jit_->runtime();
+  for (Param* param : cycle_function->params()) {
+    TypeLayout layout = runtime->CreateTypeLayout(param->GetType());
+    if (jit->input_port_layouts_.size() < block->GetInputPorts().size()) {
+      jit->input_port_layouts_.push_back(std::move(layout));
+    } else {
+      jit->register_layouts_.push_back(std::move(layout));
+    }
+  }
+
+  // The offset of each element of the result tuple is the offset of its first
+  // leaf in the layout of the tuple. Elements without leaves occupy no bytes.
+  TypeLayout result_layout = runtime->CreateTypeLayout(
+      cycle_function->return_value()->GetType());
+  TupleType* result_type =
+      cycle_function->return_value()->GetType()->AsTupleOrDie();
+  int64_t leaf_index = 0;
+  for (Type* element_type : result_type->element_types()) {
+    TypeLayout layout = runtime->CreateTypeLayout(element_type);
+    jit->result_offsets_.push_back(
+        layout.elements().empty()
+            ? 0
+            : result_layout.elements()[leaf_index].offset);
+    leaf_index += layout.elements().size();
+    jit->result_layouts_.push_back(std::move(layout));
+  }
+
+  jit->run_continuation_ = jit->NewContinuation();
+  return jit;
+}
+
+namespace {
+
+// Evaluates a single cycle with the given continuation, replacing its port and
+// register state.
+absl::StatusOr<BlockRunResult> RunCycle(
+    BlockJitContinuation* continuation,
+    const absl::flat_hash_map<std::string, Value>& inputs,
+    const absl::flat_hash_map<std::string, Value>& reg_state) {
+  XLS_RETURN_IF_ERROR(continuation->SetInputPorts(inputs));
+  XLS_RETURN_IF_ERROR(continuation->SetRegisters(reg_state));
+  XLS_RETURN_IF_ERROR(continuation->RunOneCycle());
+
+  BlockRunResult result;
+  result.outputs = continuation->GetOutputPortsMap();
+  result.reg_state = continuation->GetRegistersMap();
+  result.interpreter_events = continuation->MoveEvents();
+  return result;
+}
+
+}  // namespace
+
+absl::StatusOr<BlockRunResult> BlockJit::Run(
+    const absl::flat_hash_map<std::string, Value>& inputs,
+    const absl::flat_hash_map<std::string, Value>& reg_state) {
+  return RunCycle(run_continuation_.get(), inputs, reg_state);
+}
+
+std::unique_ptr<BlockJitContinuation> BlockJit::NewContinuation() {
+  return absl::WrapUnique(new BlockJitContinuation(this));
+}
+
+BlockJitContinuation::BlockJitContinuation(BlockJit* jit) : jit_(jit) {
+  FunctionJit* function_jit = jit_->function_jit_.get();
+  for (int64_t i = 0; i < jit_->cycle_function_->params().size(); ++i) {
+    arg_buffers_.push_back(
+        std::vector<uint8_t>(function_jit->GetArgTypeSize(i)));
+    arg_buffer_ptrs_.push_back(arg_buffers_.back().data());
+  }
+  result_buffer_.resize(function_jit->GetReturnTypeSize());
+  temp_buffer_.resize(function_jit->GetTempBufferSize());
+}
+
+absl::Status BlockJitContinuation::SetInputPorts(
+    absl::Span<const Value> values) {
+  absl::Span<InputPort* const> ports = jit_->block_->GetInputPorts();
+  if (values.size() != ports.size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Expected %d input port values, got %d", ports.size(), values.size()));
+  }
+  for (int64_t i = 0; i < ports.size(); ++i) {
+    if (!ValueConformsToType(values[i], ports[i]->GetType())) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Value %s for input port '%s' is not of type %s",
+          values[i].ToString(), ports[i]->GetName(),
+          ports[i]->GetType()->ToString()));
+    }
+  }
+  for (int64_t i = 0; i < ports.size(); ++i) {
+    jit_->input_port_layouts_[i].ValueToNativeLayout(values[i],
+                                                     arg_buffer_ptrs_[i]);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status BlockJitContinuation::SetInputPorts(
+    const absl::flat_hash_map<std::string, Value>& values) {
+  absl::flat_hash_map<std::string, int64_t> port_indices;
+  absl::Span<InputPort* const> ports = jit_->block_->GetInputPorts();
+  for (int64_t i = 0; i < ports.size(); ++i) {
+    port_indices[ports[i]->GetName()] = i;
+  }
+  for (const auto& [name, value] : values) {
+    // Empty tuples don't have data
+    if (value.GetFlatBitCount() == 0) {
+      continue;
+    }
+    if (!port_indices.contains(name)) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Block has no input port '%s'", name));
+    }
+  }
+
+  std::vector<Value> ordered_values;
+  ordered_values.reserve(ports.size());
+  for (InputPort* port : ports) {
+    auto it = values.find(port->GetName());
+    if (it == values.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Missing input for port '%s'", port->GetName()));
+    }
+    ordered_values.push_back(it->second);
+  }
+  return SetInputPorts(ordered_values);
+}
+
+absl::Status BlockJitContinuation::SetRegisters(
+    absl::Span<const Value> values) {
+  absl::Span<Register* const> registers = jit_->block_->GetRegisters();
+  if (values.size() != registers.size()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Expected %d register values, got %d",
+                        registers.size(), values.size()));
+  }
+  for (int64_t i = 0; i < registers.size(); ++i) {
+    if (!ValueConformsToType(values[i], registers[i]->type())) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Value %s for register '%s' is not of type %s", values[i].ToString(),
+          registers[i]->name(), registers[i]->type()->ToString()));
+    }
+  }
+  int64_t first_register_arg = jit_->input_port_layouts_.size();
+  for (int64_t i = 0; i < registers.size(); ++i) {
+    jit_->register_layouts_[i].ValueToNativeLayout(
+        values[i], arg_buffer_ptrs_[first_register_arg + i]);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status BlockJitContinuation::SetRegisters(
+    const absl::flat_hash_map<std::string, Value>& values) {
+  for (const auto& [name, value] : values) {
+    if (!jit_->block_->GetRegister(name).ok()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Block has no register '%s'", name));
+    }
+  }
+
+  std::vector<Value> ordered_values;
+  ordered_values.reserve(jit_->block_->GetRegisters().size());
+  for (Register* reg : jit_->block_->GetRegisters()) {
+    auto it = values.find(reg->name());
+    if (it == values.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Missing value for register '%s'", reg->name()));
+    }
+    ordered_values.push_back(it->second);
+  }
+  return SetRegisters(ordered_values);
+}
+
+absl::Status BlockJitContinuation::RunOneCycle() {
+  events_ = InterpreterEvents();
+  XLS_RETURN_IF_ERROR(jit_->function_jit_->RunWithViews(
+      absl::Span<const uint8_t* const>(arg_buffer_ptrs_.data(),
+                                       arg_buffer_ptrs_.size()),
+      absl::MakeSpan(result_buffer_), absl::MakeSpan(temp_buffer_),
+      &events_));
+
+  // Latch the next register values computed by the cycle into the register
+  // parameter buffers.
+  int64_t first_register_arg = jit_->input_port_layouts_.size();
+  int64_t first_register_result = jit_->block_->GetOutputPorts().size();
+  for (int64_t i = 0; i < jit_->register_layouts_.size(); ++i) {
+    if (arg_buffers_[first_register_arg + i].empty()) {
+      continue;
+    }
+    std::memcpy(arg_buffer_ptrs_[first_register_arg + i],
+                result_buffer_.data() +
+                    jit_->result_offsets_[first_register_result + i],
+                arg_buffers_[first_register_arg + i].size());
+  }
+  return absl::OkStatus();
+}
+
+std::vector<Value> BlockJitContinuation::GetOutputPorts() const {
+  std::vector<Value> values;
+  values.reserve(jit_->block_->GetOutputPorts().size());
+  for (int64_t i = 0; i < jit_->block_->GetOutputPorts().size(); ++i) {
+    values.push_back(jit_->result_layouts_[i].NativeLayoutToValue(
+        result_buffer_.data() + jit_->result_offsets_[i]));
+  }
+  return values;
+}
+
+absl::flat_hash_map<std::string, Value>
+BlockJitContinuation::GetOutputPortsMap() const {
+  absl::flat_hash_map<std::string, Value> values;
+  std::vector<Value> ordered_values = GetOutputPorts();
+  for (int64_t i = 0; i < ordered_values.size(); ++i) {
+    values[jit_->block_->GetOutputPorts()[i]->GetName()] =
+        std::move(ordered_values[i]);
+  }
+  return values;
+}
+
+std::vector<Value> BlockJitContinuation::GetRegisters() const {
+  std::vector<Value> values;
+  values.reserve(jit_->register_layouts_.size());
+  int64_t first_register_arg = jit_->input_port_layouts_.size();
+  for (int64_t i = 0; i < jit_->register_layouts_.size(); ++i) {
+    values.push_back(jit_->register_layouts_[i].NativeLayoutToValue(
+        arg_buffer_ptrs_[first_register_arg + i]));
+  }
+  return values;
+}
+
+absl::flat_hash_map<std::string, Value> BlockJitContinuation::GetRegistersMap()
+    const {
+  absl::flat_hash_map<std::string, Value> values;
+  std::vector<Value> ordered_values = GetRegisters();
+  for (int64_t i = 0; i < ordered_values.size(); ++i) {
+    values[jit_->block_->GetRegisters()[i]->name()] =
+        std::move(ordered_values[i]);
+  }
+  return values;
+}
+
+namespace {
+
+BlockCycleEvaluator MakeJitEvaluator(BlockJit* jit) {
+  return [jit](const absl::flat_hash_map<std::string, Value>& inputs,
+               const absl::flat_hash_map<std::string, Value>& reg_state) {
+    return jit->Run(inputs, reg_state);
+  };
+}
+
+}  // namespace
+
+absl::StatusOr<BlockIOResults> JitChannelizedSequentialBlock(
+    BlockJit* jit, absl::Span<ChannelSource> channel_sources,
+    absl::Span<ChannelSink> channel_sinks,
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
+    std::optional<verilog::ResetProto> reset, int64_t seed) {
+  return RunChannelizedSequentialBlock(jit->block(), channel_sources,
+                                       channel_sinks, inputs,
+                                       MakeJitEvaluator(jit), reset, seed);
+}
+
+absl::StatusOr<BlockIOResultsAsUint64> JitChannelizedSequentialBlockWithUint64(
+    BlockJit* jit, absl::Span<ChannelSource> channel_sources,
+    absl::Span<ChannelSink> channel_sinks,
+    absl::Span<const absl::flat_hash_map<std::string, uint64_t>> inputs,
+    std::optional<verilog::ResetProto> reset, int64_t seed) {
+  return RunChannelizedSequentialBlockWithUint64(
+      jit->block(), channel_sources, channel_sinks, inputs,
+      MakeJitEvaluator(jit), reset, seed);
+}
+
+absl::StatusOr<std::vector<BlockIOResults>> JitChannelizedSequentialBlocks(
+    BlockJit* jit, absl::Span<BlockStimulus> stimuli,
+    std::optional<int64_t> thread_count) {
+  return RunChannelizedSequentialBlocks(
+      jit->block(), stimuli,
+      [jit]() -> absl::StatusOr<BlockCycleEvaluator> {
+        std::shared_ptr<BlockJitContinuation> continuation =
+            jit->NewContinuation();
+        return [continuation](
+                   const absl::flat_hash_map<std::string, Value>& inputs,
+                   const absl::flat_hash_map<std::string, Value>& reg_state) {
+          return RunCycle(continuation.get(), inputs, reg_state);
+        };
+      },
+      thread_count);
+}
+
+}  // namespace xls
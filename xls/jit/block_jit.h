@@ -0,0 +1,183 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_BLOCK_JIT_H_
+#define XLS_JIT_BLOCK_JIT_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/codegen/module_signature.pb.h"
+#include "xls/interpreter/block_interpreter.h"
+#include "xls/ir/block.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+
+class BlockJitContinuation;
+
+// This class provides a facility to simulate XLS blocks cycle by cycle using
+// natively compiled code. The combinational logic of the block along with the
+// next-state logic of its registers (load enables and resets) is lowered to an
+// equivalent XLS function which computes a single clock cycle:
+//
+//   (input ports..., register values...) -> (output ports..., next registers)
+//
+// and this function is compiled with FunctionJit. Blocks with instantiations
+// are not supported. Run() is not thread-safe, but distinct continuations of
+// the same BlockJit may be evaluated concurrently.
+class BlockJit {
+ public:
+  static absl::StatusOr<std::unique_ptr<BlockJit>> Create(
+      Block* block, int64_t opt_level = 3);
+
+  // Runs a single cycle of the block. Same semantics as BlockRun in
+  // xls/interpreter/block_interpreter.h.
+  absl::StatusOr<BlockRunResult> Run(
+      const absl::flat_hash_map<std::string, Value>& inputs,
+      const absl::flat_hash_map<std::string, Value>& reg_state);
+
+  // Returns a new continuation which holds the port and register state of a
+  // simulation in native buffers. Evaluating many cycles through a
+  // continuation avoids converting register values to and from xls::Values
+  // each cycle. All registers start with zero values.
+  std::unique_ptr<BlockJitContinuation> NewContinuation();
+
+  Block* block() const { return block_; }
+
+  // The function computing a single cycle of the block.
+  Function* cycle_function() const { return cycle_function_; }
+
+ private:
+  friend class BlockJitContinuation;
+
+  BlockJit(Block* block, std::unique_ptr<Package> package,
+           Function* cycle_function)
+      : block_(block),
+        package_(std::move(package)),
+        cycle_function_(cycle_function) {}
+
+  Block* block_;
+
+  // Package owning `cycle_function_`. Kept separate from the package of the
+  // block so that the block's package is not modified.
+  std::unique_ptr<Package> package_;
+  Function* cycle_function_;
+  std::unique_ptr<FunctionJit> function_jit_;
+
+  // Layouts of the input ports and registers (the parameters of the cycle
+  // function).
+  std::vector<TypeLayout> input_port_layouts_;
+  std::vector<TypeLayout> register_layouts_;
+
+  // Byte offset and layout of each element of the tuple returned by the cycle
+  // function. The first elements are the output ports followed by the next
+  // register values.
+  std::vector<int64_t> result_offsets_;
+  std::vector<TypeLayout> result_layouts_;
+
+  // Continuation used by Run().
+  std::unique_ptr<BlockJitContinuation> run_continuation_;
+};
+
+// The state of a block simulated with a BlockJit: the values on the input
+// ports, the register values, and the values of the output ports after the
+// most recent cycle.
+class BlockJitContinuation {
+ public:
+  // Sets the values on the input ports. `values` must be in the order of
+  // Block::GetInputPorts().
+  absl::Status SetInputPorts(absl::Span<const Value> values);
+  absl::Status SetInputPorts(
+      const absl::flat_hash_map<std::string, Value>& values);
+
+  // Sets the values of the registers. `values` must be in the order of
+  // Block::GetRegisters().
+  absl::Status SetRegisters(absl::Span<const Value> values);
+  absl::Status SetRegisters(
+      const absl::flat_hash_map<std::string, Value>& values);
+
+  // Evaluates one clock cycle: the output ports are computed from the current
+  // inputs and registers and the registers are updated with their next
+  // values. Events produced by the cycle are available via events().
+  absl::Status RunOneCycle();
+
+  // Returns the values of the output ports as computed by the most recent
+  // cycle, in the order of Block::GetOutputPorts().
+  std::vector<Value> GetOutputPorts() const;
+  absl::flat_hash_map<std::string, Value> GetOutputPortsMap() const;
+
+  // Returns the current register values in the order of Block::GetRegisters().
+  std::vector<Value> GetRegisters() const;
+  absl::flat_hash_map<std::string, Value> GetRegistersMap() const;
+
+  const InterpreterEvents& events() const { return events_; }
+  InterpreterEvents&& MoveEvents() { return std::move(events_); }
+
+ private:
+  friend class BlockJit;
+
+  explicit BlockJitContinuation(BlockJit* jit);
+
+  BlockJit* jit_;
+
+  // Native buffers of the parameters of the cycle function. The input port
+  // buffers come first followed by the register buffers.
+  std::vector<std::vector<uint8_t>> arg_buffers_;
+  std::vector<uint8_t*> arg_buffer_ptrs_;
+  std::vector<uint8_t> result_buffer_;
+  // Scratch space of the jitted code, owned by the continuation so that
+  // continuations do not share any mutable state.
+  std::vector<uint8_t> temp_buffer_;
+  InterpreterEvents events_;
+};
+
+// Analogues of InterpretChannelizedSequentialBlock and
+// InterpretChannelizedSequentialBlockWithUint64 which evaluate each cycle with
+// the given BlockJit.
+absl::StatusOr<BlockIOResults> JitChannelizedSequentialBlock(
+    BlockJit* jit, absl::Span<ChannelSource> channel_sources,
+    absl::Span<ChannelSink> channel_sinks,
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
+    std::optional<verilog::ResetProto> reset = std::nullopt, int64_t seed = 0);
+
+absl::StatusOr<BlockIOResultsAsUint64> JitChannelizedSequentialBlockWithUint64(
+    BlockJit* jit, absl::Span<ChannelSource> channel_sources,
+    absl::Span<ChannelSink> channel_sinks,
+    absl::Span<const absl::flat_hash_map<std::string, uint64_t>> inputs,
+    std::optional<verilog::ResetProto> reset = std::nullopt, int64_t seed = 0);
+
+// Analogue of InterpretChannelizedSequentialBlocks which simulates each of the
+// independent `stimuli` with the given BlockJit. The compiled code is shared;
+// each worker thread evaluates cycles with its own continuation.
+absl::StatusOr<std::vector<BlockIOResults>> JitChannelizedSequentialBlocks(
+    BlockJit* jit, absl::Span<BlockStimulus> stimuli,
+    std::optional<int64_t> thread_count = std::nullopt);
+
+}  // namespace xls
+
+#endif  // XLS_JIT_BLOCK_JIT_H_
@@ -0,0 +1,355 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/block_jit.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/block_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_helpers.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using testing::ElementsAre;
+using testing::HasSubstr;
+using testing::Pair;
+using testing::UnorderedElementsAre;
+
+class BlockJitTest : public IrTestBase {
+ protected:
+  // Runs the block for each set of inputs with both the interpreter and the
+  // JIT starting from zero-valued registers and checks that the outputs and
+  // register states match.
+  void ExpectJitMatchesInterpreter(
+      Block* block,
+      absl::Span<const absl::flat_hash_map<std::string, Value>> inputs) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                             BlockJit::Create(block));
+    absl::flat_hash_map<std::string, Value> interpreter_regs;
+    for (Register* reg : block->GetRegisters()) {
+      interpreter_regs[reg->name()] = ZeroOfType(reg->type());
+    }
+    absl::flat_hash_map<std::string, Value> jit_regs = interpreter_regs;
+    for (const absl::flat_hash_map<std::string, Value>& input_set : inputs) {
+      XLS_ASSERT_OK_AND_ASSIGN(BlockRunResult expected,
+                               BlockRun(input_set, interpreter_regs, block));
+      XLS_ASSERT_OK_AND_ASSIGN(BlockRunResult actual,
+                               jit->Run(input_set, jit_regs));
+      EXPECT_EQ(actual.outputs, expected.outputs);
+      EXPECT_EQ(actual.reg_state, expected.reg_state);
+      interpreter_regs = expected.reg_state;
+      jit_regs = actual.reg_state;
+    }
+  }
+};
+
+TEST_F(BlockJitTest, SumAndDifferenceBlock) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue y = b.InputPort("y", package->GetBitsType(32));
+  b.OutputPort("sum", b.Add(x, y));
+  b.OutputPort("diff", b.Subtract(x, y));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      BlockRunResult result,
+      jit->Run({{"x", Value(UBits(42, 32))}, {"y", Value(UBits(10, 32))}},
+               {}));
+  EXPECT_THAT(result.outputs,
+              UnorderedElementsAre(Pair("sum", Value(UBits(52, 32))),
+                                   Pair("diff", Value(UBits(32, 32)))));
+  EXPECT_TRUE(result.reg_state.empty());
+}
+
+TEST_F(BlockJitTest, InputErrors) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue y = b.InputPort("y", package->GetBitsType(32));
+  b.OutputPort("sum", b.Add(x, y));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+
+  EXPECT_THAT(jit->Run({{"x", Value(UBits(42, 32))}}, {}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Missing input for port 'y'")));
+  EXPECT_THAT(jit->Run({{"x", Value(UBits(42, 32))},
+                        {"y", Value(UBits(10, 32))},
+                        {"z", Value(UBits(123, 32))}},
+                       {}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Block has no input port 'z'")));
+  EXPECT_THAT(
+      jit->Run({{"x", Value(UBits(42, 32))}, {"y", Value(UBits(10, 16))}}, {}),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("is not of type bits[32]")));
+  EXPECT_THAT(jit->Run({{"x", Value(UBits(42, 32))},
+                        {"y", Value(UBits(10, 32))}},
+                       {{"r", Value(UBits(0, 32))}}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Block has no register 'r'")));
+}
+
+TEST_F(BlockJitTest, PipelinedAdder) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue y = b.InputPort("y", package->GetBitsType(32));
+  BValue x_d = b.InsertRegister("x_d", x);
+  BValue y_d = b.InsertRegister("y_d", y);
+  BValue x_plus_y_d = b.InsertRegister("x_plus_y_d", b.Add(x_d, y_d));
+  b.OutputPort("out", x_plus_y_d);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  std::vector<absl::flat_hash_map<std::string, Value>> inputs = {
+      {{"x", Value(UBits(1, 32))}, {"y", Value(UBits(2, 32))}},
+      {{"x", Value(UBits(42, 32))}, {"y", Value(UBits(100, 32))}},
+      {{"x", Value(UBits(0, 32))}, {"y", Value(UBits(0, 32))}},
+      {{"x", Value(UBits(0, 32))}, {"y", Value(UBits(0, 32))}},
+      {{"x", Value(UBits(0, 32))}, {"y", Value(UBits(0, 32))}}};
+  ExpectJitMatchesInterpreter(block, inputs);
+}
+
+TEST_F(BlockJitTest, RegisterWithResetAndLoadEnable) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue rst_n = b.InputPort("rst_n", package->GetBitsType(1));
+  BValue le = b.InputPort("le", package->GetBitsType(1));
+  BValue x_d =
+      b.InsertRegister("x_d", x, rst_n,
+                       Reset{Value(UBits(42, 32)), /*asynchronous=*/false,
+                             /*active_low=*/true},
+                       le);
+  b.OutputPort("out", x_d);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  auto make_inputs = [](uint64_t rst_n, uint64_t le, uint64_t x) {
+    return absl::flat_hash_map<std::string, Value>{
+        {"rst_n", Value(UBits(rst_n, 1))},
+        {"le", Value(UBits(le, 1))},
+        {"x", Value(UBits(x, 32))}};
+  };
+  std::vector<absl::flat_hash_map<std::string, Value>> inputs = {
+      make_inputs(1, 0, 1), make_inputs(0, 0, 2), make_inputs(0, 1, 3),
+      make_inputs(1, 1, 4), make_inputs(1, 0, 5)};
+  ExpectJitMatchesInterpreter(block, inputs);
+
+  // Drive the same inputs through a continuation.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  std::unique_ptr<BlockJitContinuation> continuation = jit->NewContinuation();
+  std::vector<Value> outputs;
+  for (const absl::flat_hash_map<std::string, Value>& input_set : inputs) {
+    XLS_ASSERT_OK(continuation->SetInputPorts(input_set));
+    XLS_ASSERT_OK(continuation->RunOneCycle());
+    outputs.push_back(continuation->GetOutputPorts().at(0));
+  }
+  EXPECT_THAT(outputs, ElementsAre(Value(UBits(0, 32)), Value(UBits(0, 32)),
+                                   Value(UBits(42, 32)), Value(UBits(42, 32)),
+                                   Value(UBits(4, 32))));
+  EXPECT_THAT(continuation->GetRegisters(), ElementsAre(Value(UBits(4, 32))));
+}
+
+TEST_F(BlockJitTest, AccumulatorContinuation) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Register * reg,
+      b.block()->AddRegister("accum", package->GetBitsType(32)));
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue next_accum = b.Add(x, b.RegisterRead(reg));
+  b.RegisterWrite(reg, next_accum);
+  b.OutputPort("out", next_accum);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  std::unique_ptr<BlockJitContinuation> continuation = jit->NewContinuation();
+  XLS_ASSERT_OK(continuation->SetRegisters({Value(UBits(100, 32))}));
+  std::vector<Value> outputs;
+  for (uint64_t i = 1; i <= 5; ++i) {
+    XLS_ASSERT_OK(continuation->SetInputPorts({Value(UBits(i, 32))}));
+    XLS_ASSERT_OK(continuation->RunOneCycle());
+    outputs.push_back(continuation->GetOutputPorts().at(0));
+  }
+  EXPECT_THAT(outputs, ElementsAre(Value(UBits(101, 32)), Value(UBits(103, 32)),
+                                   Value(UBits(106, 32)), Value(UBits(110, 32)),
+                                   Value(UBits(115, 32))));
+  EXPECT_THAT(continuation->GetRegistersMap(),
+              UnorderedElementsAre(Pair("accum", Value(UBits(115, 32)))));
+}
+
+TEST_F(BlockJitTest, CompoundTypedRegister) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+  Type* tuple_type = package->GetTupleType(
+      {package->GetBitsType(3),
+       package->GetArrayType(2, package->GetBitsType(17))});
+  XLS_ASSERT_OK_AND_ASSIGN(Register * reg,
+                           b.block()->AddRegister("state", tuple_type));
+  BValue x = b.InputPort("x", package->GetBitsType(17));
+  BValue state = b.RegisterRead(reg);
+  BValue array = b.TupleIndex(state, 1);
+  BValue next_state = b.Tuple(
+      {b.Add(b.TupleIndex(state, 0), b.Literal(UBits(1, 3))),
+       b.Array({b.ArrayIndex(array, {b.Literal(UBits(1, 1))}), x},
+               package->GetBitsType(17))});
+  b.RegisterWrite(reg, next_state);
+  b.OutputPort("out", state);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  std::vector<absl::flat_hash_map<std::string, Value>> inputs;
+  for (uint64_t i = 0; i < 10; ++i) {
+    inputs.push_back({{"x", Value(UBits(1000 * i + 7, 17))}});
+  }
+  ExpectJitMatchesInterpreter(block, inputs);
+}
+
+TEST_F(BlockJitTest, ChannelizedAccumulatorMatchesInterpreter) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Register * reg,
+      b.block()->AddRegister("accum", package->GetBitsType(32)));
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue x_vld = b.InputPort("x_vld", package->GetBitsType(1));
+  BValue out_rdy = b.InputPort("out_rdy", package->GetBitsType(1));
+  BValue input_valid_and_output_ready = b.And(x_vld, out_rdy);
+  BValue accum = b.RegisterRead(reg);
+  BValue next_accum =
+      b.Select(input_valid_and_output_ready, {accum, b.Add(x, accum)});
+  b.RegisterWrite(reg, next_accum);
+  b.OutputPort("x_rdy", out_rdy);
+  b.OutputPort("out", next_accum);
+  b.OutputPort("out_vld", x_vld);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  std::vector<absl::flat_hash_map<std::string, uint64_t>> inputs(100);
+  auto run = [&](bool use_jit)
+      -> absl::StatusOr<std::vector<std::optional<uint64_t>>> {
+    std::vector<ChannelSource> sources{
+        ChannelSource("x", "x_vld", "x_rdy", 0.5, block)};
+    XLS_RETURN_IF_ERROR(
+        sources.at(0).SetDataSequence(std::vector<uint64_t>{1, 2, 3, 4, 5}));
+    std::vector<ChannelSink> sinks{
+        ChannelSink("out", "out_vld", "out_rdy", 0.1, block)};
+    if (use_jit) {
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+      XLS_RETURN_IF_ERROR(JitChannelizedSequentialBlockWithUint64(
+                              jit.get(), absl::MakeSpan(sources),
+                              absl::MakeSpan(sinks), inputs, std::nullopt,
+                              /*seed=*/42)
+                              .status());
+    } else {
+      XLS_RETURN_IF_ERROR(InterpretChannelizedSequentialBlockWithUint64(
+                              block, absl::MakeSpan(sources),
+                              absl::MakeSpan(sinks), inputs, std::nullopt,
+                              /*seed=*/42)
+                              .status());
+    }
+    return sinks.at(0).GetOutputCycleSequenceAsUint64();
+  };
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::optional<uint64_t>> interpreter_sequence,
+      run(/*use_jit=*/false));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::optional<uint64_t>> jit_sequence,
+                           run(/*use_jit=*/true));
+  EXPECT_EQ(jit_sequence, interpreter_sequence);
+}
+
+TEST_F(BlockJitTest, ParallelStimuliMatchInterpreter) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Register * reg,
+      b.block()->AddRegister("accum", package->GetBitsType(32)));
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue x_vld = b.InputPort("x_vld", package->GetBitsType(1));
+  BValue out_rdy = b.InputPort("out_rdy", package->GetBitsType(1));
+  BValue accum = b.RegisterRead(reg);
+  BValue next_accum =
+      b.Select(b.And(x_vld, out_rdy), {accum, b.Add(x, accum)});
+  b.RegisterWrite(reg, next_accum);
+  b.OutputPort("x_rdy", out_rdy);
+  b.OutputPort("out", next_accum);
+  b.OutputPort("out_vld", x_vld);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  auto make_stimuli = [&]() -> absl::StatusOr<std::vector<BlockStimulus>> {
+    std::vector<BlockStimulus> stimuli(8);
+    for (int64_t i = 0; i < stimuli.size(); ++i) {
+      stimuli[i].channel_sources.push_back(
+          ChannelSource("x", "x_vld", "x_rdy", 0.5, block));
+      XLS_RETURN_IF_ERROR(stimuli[i].channel_sources[0].SetDataSequence(
+          std::vector<uint64_t>{1, 2, 3, static_cast<uint64_t>(i)}));
+      stimuli[i].channel_sinks.push_back(
+          ChannelSink("out", "out_vld", "out_rdy", 0.5, block));
+      stimuli[i].inputs.resize(40);
+      stimuli[i].seed = i;
+    }
+    return stimuli;
+  };
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<BlockStimulus> interpreter_stimuli,
+                           make_stimuli());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<BlockIOResults> expected,
+      InterpretChannelizedSequentialBlocks(
+          block, absl::MakeSpan(interpreter_stimuli), /*thread_count=*/1));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<BlockStimulus> jit_stimuli,
+                           make_stimuli());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<BlockIOResults> actual,
+      JitChannelizedSequentialBlocks(jit.get(), absl::MakeSpan(jit_stimuli),
+                                     /*thread_count=*/4));
+  ASSERT_EQ(actual.size(), expected.size());
+  for (int64_t i = 0; i < actual.size(); ++i) {
+    EXPECT_EQ(actual[i].outputs, expected[i].outputs);
+    EXPECT_EQ(jit_stimuli[i].channel_sinks[0].GetOutputSequence(),
+              interpreter_stimuli[i].channel_sinks[0].GetOutputSequence());
+  }
+}
+
+}  // namespace
+}  // namespace xls
@@ -23,10 +23,15 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
+#include "llvm/include/llvm/IR/Attributes.h"
 #include "llvm/include/llvm/IR/Constants.h"
 #include "llvm/include/llvm/IR/DerivedTypes.h"
 #include "llvm/include/llvm/IR/Function.h"
 #include "llvm/include/llvm/IR/IRBuilder.h"
+#include "llvm/include/llvm/IR/Instructions.h"
+#include "llvm/include/llvm/IR/Intrinsics.h"
 #include "llvm/include/llvm/IR/Type.h"
 #include "llvm/include/llvm/IR/Value.h"
 #include "xls/common/logging/logging.h"
@@ -35,6 +40,7 @@
 #include "xls/ir/node.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/jit/ir_builder_visitor.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/jit/llvm_type_converter.h"
 
 namespace xls {
@@ -265,6 +271,11 @@ enum class AllocationKind {
   // passed in via already-allocated input buffers and some Bits-typed literals
   // which are materialized as LLVM constants at their uses.
   kNone,
+
+  // The node reuses the buffer of another node whose value is dead after the
+  // node is computed, e.g., an array update which updates its operand in
+  // place. See BufferAllocator::GetAliasRoot.
+  kAlias,
 };
 
 // Allocator for the buffers used to hold xls::Node values within jitted
@@ -286,6 +297,22 @@ class BufferAllocator {
     return allocation_kinds_.at(node);
   }
 
+  // Sets `node` to reuse the buffer of `root`, which must not have allocation
+  // kind kAlias itself.
+  void SetAlias(Node* node, Node* root) {
+    XLS_CHECK(!allocation_kinds_.contains(node));
+    XLS_CHECK(allocation_kinds_.at(root) != AllocationKind::kAlias);
+    allocation_kinds_[node] = AllocationKind::kAlias;
+    alias_roots_[node] = root;
+  }
+
+  // Returns the node whose buffer `node` reuses. Node must be assigned
+  // allocation kind kAlias.
+  Node* GetAliasRoot(Node* node) const {
+    XLS_CHECK(allocation_kinds_.at(node) == AllocationKind::kAlias);
+    return alias_roots_.at(node);
+  }
+
   // Returns the offset within the temp block for the buffer allocated for
   // `node`. Node must be assigned allocation kind kTempblock.
   int64_t GetOffset(Node* node) const {
@@ -314,6 +341,7 @@ class BufferAllocator {
   absl::flat_hash_map<Node*, int64_t> temp_block_offsets_;
   int64_t current_offset_ = 0;
   absl::flat_hash_map<Node*, AllocationKind> allocation_kinds_;
+  absl::flat_hash_map<Node*, Node*> alias_roots_;
 };
 
 // The maximum number of xls::Nodes in a partition.
@@ -460,6 +488,30 @@ std::vector<Partition> PartitionFunctionBase(FunctionBase* f) {
   return partitions;
 }
 
+// Emits a read of the host cycle counter.
+llvm::Value* EmitReadCycleCounter(llvm::IRBuilder<>& b) {
+  llvm::Function* read_cycle_counter = llvm::Intrinsic::getDeclaration(
+      b.GetInsertBlock()->getModule(), llvm::Intrinsic::readcyclecounter);
+  return b.CreateCall(read_cycle_counter);
+}
+
+// Emits code which increments the execution count of `counter` and adds the
+// cycles elapsed since `start_cycles` (as returned by EmitReadCycleCounter).
+void EmitProfileCounterUpdate(JitProfileCounter* counter,
+                              llvm::Value* start_cycles,
+                              llvm::IRBuilder<>& b) {
+  llvm::Value* end_cycles = EmitReadCycleCounter(b);
+  llvm::Type* ptr_type = llvm::PointerType::get(b.getContext(), 0);
+  auto add_to_field = [&](int64_t* field, llvm::Value* addend) {
+    llvm::Value* field_ptr =
+        b.CreateIntToPtr(b.getInt64(absl::bit_cast<uint64_t>(field)), ptr_type);
+    llvm::Value* value = b.CreateLoad(b.getInt64Ty(), field_ptr);
+    b.CreateStore(b.CreateAdd(value, addend), field_ptr);
+  };
+  add_to_field(&counter->count, b.getInt64(1));
+  add_to_field(&counter->cycles, b.CreateSub(end_cycles, start_cycles));
+}
+
 // Builds an LLVM function of the given `name` which executes the given set of
 // nodes. The signature of the partition function is the same as the jitted
 // function implementing a FunctionBase (i.e., `JitFunctionType`). A partition
@@ -500,7 +552,8 @@ std::vector<Partition> PartitionFunctionBase(FunctionBase* f) {
 // `global_input_nodes` and `global_output_nodes` are the set of nodes whose
 // buffers are passed in via the `input`/`output` arguments of the function.
 absl::StatusOr<llvm::Function*> BuildPartitionFunction(
-    std::string_view name, const Partition& partition,
+    std::string_view name, FunctionBase* function_base,
+    int64_t partition_index, const Partition& partition,
     absl::Span<Node* const> global_input_nodes,
     absl::Span<Node* const> global_output_nodes,
     const BufferAllocator& allocator, JitBuilderContext& jit_context) {
@@ -509,12 +562,49 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
       llvm::Type::getInt1Ty(jit_context.context()), jit_context);
   llvm::IRBuilder<>& b = wrapper.entry_builder();
 
+  JitProfile* profile = jit_context.profile();
+  llvm::Value* partition_start_cycles = nullptr;
+  if (profile != nullptr) {
+    partition_start_cycles = EmitReadCycleCounter(b);
+  }
+
   // Whether to interrupt execution of the FunctionBase. Only used for
   // partitions which are early exit points (e.g., have a blocking receive).
   llvm::Value* interrupt_execution = nullptr;
 
   // The pointers to the buffers of nodes in the partition.
   absl::flat_hash_map<Node*, llvm::Value*> value_buffers;
+
+  // Returns the buffer holding the value of `node` computed before the node
+  // currently being emitted.
+  auto get_buffer = [&](Node* node) -> absl::StatusOr<llvm::Value*> {
+    if (allocator.GetAllocationKind(node) == AllocationKind::kAlias) {
+      node = allocator.GetAliasRoot(node);
+    }
+    if (value_buffers.contains(node)) {
+      return value_buffers.at(node);
+    }
+    llvm::Value* buffer;
+    if (wrapper.IsInputNode(node)) {
+      // `node` is a global input. Load the pointer to the buffer from the
+      // input array argument.
+      buffer = wrapper.GetInputBuffer(node, b);
+    } else if (wrapper.IsOutputNode(node)) {
+      // `node` is a global output. `node` may have more than one buffer in
+      // this case which is one of the pointer in the output array argument.
+      // Arbitrarily choose the first.
+      buffer = wrapper.GetFirstOutputBuffer(node, b);
+    } else {
+      // `node` is stored inside the temporary buffer.
+      XLS_RET_CHECK(allocator.GetAllocationKind(node) ==
+                    AllocationKind::kTempBlock)
+          << node;
+      buffer = wrapper.GetOffsetIntoTempBuffer(allocator.GetOffset(node), b);
+    }
+    value_buffers[node] = buffer;
+    return buffer;
+  };
+
   for (Node* node : partition.nodes) {
     if (wrapper.IsInputNode(node)) {
       // Node is an input node. There is no need to generate a node function for
@@ -548,6 +638,11 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
       // nor has a temp buffer). Allocate a buffer on the stack with alloca.
       output_buffers = {b.CreateAlloca(
           jit_context.type_converter().ConvertToLlvmType(node->GetType()))};
+    } else if (allocator.GetAllocationKind(node) == AllocationKind::kAlias) {
+      // `node` computes its value in the buffer of a node whose value is dead
+      // afterwards.
+      XLS_ASSIGN_OR_RETURN(llvm::Value * buffer, get_buffer(node));
+      output_buffers = {buffer};
     } else {
       // Node has no allocation and is not an output buffer. Nothing to emit for
       // this node.
@@ -556,7 +651,9 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
       continue;
     }
 
-    value_buffers[node] = output_buffers.front();
+    if (allocator.GetAllocationKind(node) != AllocationKind::kAlias) {
+      value_buffers[node] = output_buffers.front();
+    }
 
     // Create the function which computes the node value.
     XLS_ASSIGN_OR_RETURN(
@@ -566,29 +663,8 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
     // Gather the operand values to be passed to the node function.
     std::vector<llvm::Value*> operand_buffers;
     for (Node* operand : node_function.operand_arguments) {
-      if (value_buffers.contains(operand)) {
-        operand_buffers.push_back(value_buffers.at(operand));
-        continue;
-      }
-      llvm::Value* arg;
-      if (wrapper.IsInputNode(operand)) {
-        // `operand` is a global input. Load the pointer to the buffer from the
-        // input array argument.
-        arg = wrapper.GetInputBuffer(operand, b);
-      } else if (wrapper.IsOutputNode(operand)) {
-        // `operand` is a global output. `operand` may have more than one buffer
-        // in this case which is one of the pointer in the output array
-        // argument. Arbitrarily choose the first.
-        arg = wrapper.GetFirstOutputBuffer(operand, b);
-      } else {
-        // `operand` is stored inside the temporary buffer.
-        XLS_RET_CHECK(allocator.GetAllocationKind(operand) ==
-                      AllocationKind::kTempBlock)
-            << operand;
-        arg = wrapper.GetOffsetIntoTempBuffer(allocator.GetOffset(operand), b);
-      }
+      XLS_ASSIGN_OR_RETURN(llvm::Value * arg, get_buffer(operand));
       operand_buffers.push_back(arg);
-      value_buffers[operand] = arg;
     }
 
     // Call the node function.
@@ -605,13 +681,28 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
       args.push_back(wrapper.GetUserDataArg());
       args.push_back(wrapper.GetJitRuntimeArg());
     }
+    llvm::Value* node_start_cycles = nullptr;
+    if (profile != nullptr && profile->mode() == JitProfileMode::kNode) {
+      node_start_cycles = EmitReadCycleCounter(b);
+    }
     llvm::CallInst* node_blocked = b.CreateCall(node_function.function, args);
+    if (node_start_cycles != nullptr) {
+      EmitProfileCounterUpdate(
+          profile->AddNodeCounter(function_base, partition_index, node),
+          node_start_cycles, b);
+    }
 
     if (partition.early_exit_point.has_value()) {
       XLS_RET_CHECK_EQ(partition.nodes.size(), 1);
       interrupt_execution = node_blocked;
     }
   }
+  if (profile != nullptr) {
+    EmitProfileCounterUpdate(
+        profile->AddPartitionCounter(function_base, partition_index,
+                                     partition.nodes),
+        partition_start_cycles, b);
+  }
   // Return false to indicate that execution of the FunctionBase should not be
   // interrupted.
   b.CreateRet(interrupt_execution == nullptr ? b.getFalse()
@@ -622,21 +713,109 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
   return wrapper.function();
 }
 
+// Returns whether `node` is an array update which may update the buffer of its
+// array operand in place because the update is the only use of the operand.
+bool UpdatesOperandInPlace(Node* node, const LlvmFunctionWrapper& wrapper) {
+  if (!node->Is<ArrayUpdate>() || wrapper.IsOutputNode(node)) {
+    return false;
+  }
+  Node* array = node->As<ArrayUpdate>()->array_to_update();
+  return array->users().size() == 1 &&
+         std::count(node->operands().begin(), node->operands().end(), array) ==
+             1 &&
+         !wrapper.IsOutputNode(array);
+}
+
+// Returns the indices of the state elements of `proc` which may be updated in
+// place: those whose next value is computed from the state param by a chain
+// of array updates each of which is the only use of its operand. The input and
+// output buffers of these elements may be the same buffer, in which case the
+// updates write directly into the state.
+absl::flat_hash_set<int64_t> GetInPlaceStateIndices(
+    Proc* proc, const LlvmFunctionWrapper& wrapper) {
+  absl::flat_hash_set<int64_t> indices;
+  for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
+    Node* next_state = proc->GetNextStateElement(i);
+    if (wrapper.GetOutputArgIndices(next_state).size() != 1) {
+      continue;
+    }
+    Node* param = proc->GetStateParam(i);
+    if (wrapper.IsOutputNode(param)) {
+      continue;
+    }
+    Node* node = param;
+    while (node->users().size() == 1) {
+      Node* user = *node->users().begin();
+      if (!user->Is<ArrayUpdate>() ||
+          user->As<ArrayUpdate>()->array_to_update() != node ||
+          std::count(user->operands().begin(), user->operands().end(),
+                     node) != 1) {
+        break;
+      }
+      node = user;
+      if (wrapper.IsOutputNode(node)) {
+        break;
+      }
+    }
+    if (node == next_state && node != param) {
+      indices.insert(i);
+    }
+  }
+  return indices;
+}
+
 // Determine the type of buffers required by each node. Allocates the temporary
-// buffers for nodes as needed.
+// buffers for nodes as needed. Array updates which are the only use of their
+// array operand reuse the operand's buffer if it lives at least as long as the
+// update's value needs to. The buffers of `in_place_inputs` may be updated
+// this way as well.
 absl::Status AllocateBuffers(absl::Span<const Partition> partitions,
                              const LlvmFunctionWrapper& wrapper,
+                             const absl::flat_hash_set<Node*>& in_place_inputs,
                              BufferAllocator& allocator) {
   for (const Partition& partition : partitions) {
     absl::flat_hash_set<Node*> partition_set(partition.nodes.begin(),
                                              partition.nodes.end());
+    auto all_uses_in_partition = [&](Node* node) {
+      return std::all_of(node->users().begin(), node->users().end(),
+                         [&](Node* u) { return partition_set.contains(u); });
+    };
+    // Returns the node whose buffer `node` may update in place, if any.
+    auto in_place_root = [&](Node* node) -> std::optional<Node*> {
+      if (!UpdatesOperandInPlace(node, wrapper)) {
+        return std::nullopt;
+      }
+      Node* root = node->As<ArrayUpdate>()->array_to_update();
+      if (allocator.GetAllocationKind(root) == AllocationKind::kAlias) {
+        root = allocator.GetAliasRoot(root);
+      }
+      if (wrapper.IsInputNode(root)) {
+        if (in_place_inputs.contains(root)) {
+          return root;
+        }
+        return std::nullopt;
+      }
+      switch (allocator.GetAllocationKind(root)) {
+        case AllocationKind::kTempBlock:
+          return root;
+        case AllocationKind::kAlloca:
+          // The stack buffer only lives until the end of the partition.
+          if (partition_set.contains(root) && all_uses_in_partition(node)) {
+            return root;
+          }
+          return std::nullopt;
+        default:
+          return std::nullopt;
+      }
+    };
     for (Node* node : partition.nodes) {
       if (wrapper.IsInputNode(node) || wrapper.IsOutputNode(node) ||
           ShouldMaterializeAtUse(node)) {
         allocator.SetAllocationKind(node, AllocationKind::kNone);
-      } else if (std::all_of(
-                     node->users().begin(), node->users().end(),
-                     [&](Node* u) { return partition_set.contains(u); })) {
+      } else if (std::optional<Node*> root = in_place_root(node);
+                 root.has_value()) {
+        allocator.SetAlias(node, *root);
+      } else if (all_uses_in_partition(node)) {
         // All of the uses of node are in the partition.
         allocator.SetAllocationKind(node, AllocationKind::kAlloca);
       } else {
@@ -717,6 +896,9 @@ std::vector<Node*> GetJittedFunctionOutputs(FunctionBase* function_base) {
 struct PartitionedFunction {
   llvm::Function* function;
   std::vector<Partition> partitions;
+  // Indices of the state elements of a proc which may be updated in place
+  // (see GetInPlaceStateIndices).
+  absl::flat_hash_set<int64_t> in_place_state_indices;
 };
 absl::StatusOr<PartitionedFunction> BuildFunctionInternal(
     FunctionBase* xls_function, BufferAllocator& allocator,
@@ -733,8 +915,19 @@ absl::StatusOr<PartitionedFunction> BuildFunctionInternal(
       LlvmFunctionWrapper::FunctionArg{
           .name = "continuation_point",
           .type = llvm::Type::getInt64Ty(jit_context.context())});
-
-  XLS_RETURN_IF_ERROR(AllocateBuffers(partitions, wrapper, allocator));
+  wrapper.function()->addFnAttr(kJitEntryPointAttribute);
+
+  absl::flat_hash_set<int64_t> in_place_state_indices;
+  absl::flat_hash_set<Node*> in_place_inputs;
+  if (xls_function->IsProc()) {
+    Proc* proc = xls_function->AsProcOrDie();
+    in_place_state_indices = GetInPlaceStateIndices(proc, wrapper);
+    for (int64_t i : in_place_state_indices) {
+      in_place_inputs.insert(proc->GetStateParam(i));
+    }
+  }
+  XLS_RETURN_IF_ERROR(
+      AllocateBuffers(partitions, wrapper, in_place_inputs, allocator));
 
   std::vector<llvm::Function*> partition_functions;
   for (int64_t i = 0; i < partitions.size(); ++i) {
@@ -742,8 +935,8 @@ absl::StatusOr<PartitionedFunction> BuildFunctionInternal(
         absl::StrFormat("__%s_partition_%d", xls_function->name(), i);
     XLS_ASSIGN_OR_RETURN(
         llvm::Function * partition_function,
-        BuildPartitionFunction(name, partitions[i], inputs, outputs, allocator,
-                               jit_context));
+        BuildPartitionFunction(name, xls_function, i, partitions[i], inputs,
+                               outputs, allocator, jit_context));
     partition_functions.push_back(partition_function);
   }
 
@@ -836,8 +1029,10 @@ absl::StatusOr<PartitionedFunction> BuildFunctionInternal(
       }
     }
   }
-  return PartitionedFunction{.function = wrapper.function(),
-                             .partitions = std::move(partitions)};
+  return PartitionedFunction{
+      .function = wrapper.function(),
+      .partitions = std::move(partitions),
+      .in_place_state_indices = std::move(in_place_state_indices)};
 }
 
 // Unpacks the packed value in `packed_buffer` and writes it to
@@ -1059,6 +1254,7 @@ absl::StatusOr<llvm::Function*> BuildPackedWrapper(
       LlvmFunctionWrapper::FunctionArg{
           .name = "continuation_point",
           .type = llvm::Type::getInt64Ty(*context)});
+  wrapper.function()->addFnAttr(kJitEntryPointAttribute);
 
   // First load and unpack the arguments then store them in LLVM native data
   // layout. These unpacked values are pointed to by an array of pointers passed
@@ -1144,95 +1340,479 @@ absl::StatusOr<llvm::Function*> BuildPackedWrapper(
   return wrapper.function();
 }
 
-// Jits a function implementing `xls_function`. Also jits all transitively
-// dependent xls::Functions which may be called by `xls_function`.
-absl::StatusOr<JittedFunctionBase> BuildFunctionAndDependencies(
-    FunctionBase* xls_function, JitBuilderContext& jit_context,
-    bool build_packed_wrapper) {
-  std::vector<FunctionBase*> functions = GetDependentFunctions(xls_function);
+// Builds a wrapper around the jitted function `callee` which evaluates a batch
+// of independent invocations in a single call. The wrapper has the signature
+// of `JitBatchedFunctionType`: `inputs[i]` points to a column holding
+// `batch_size` consecutive values of the i-th input in the native LLVM data
+// layout and `outputs[i]` points to a similarly laid out column which receives
+// the results. The stride of each column is the allocation size of the
+// element type. The wrapper looks like:
+//
+//    int64_t
+//    __f_batched(const uint8_t* const* inputs,
+//                uint8_t* const* outputs,
+//                void* temp_buffer,
+//                InterpreterEvents* events,
+//                void* user_data,
+//                JitRuntime* jit_runtime,
+//                int64_t batch_size) {
+//      for (int64_t lane = 0; lane < batch_size; ++lane) {
+//        lane_inputs[i] = inputs[i] + lane * input_stride[i];
+//        lane_outputs[i] = outputs[i] + lane * output_stride[i];
+//        __f(lane_inputs, lane_outputs, temp_buffer, events, user_data,
+//            jit_runtime, /*continuation_point=*/0);
+//      }
+//      return 0;
+//    }
+//
+// Keeping the lane loop in native code avoids the per-invocation overhead of
+// the call from C++. The call of `callee` is marked always-inline so the lane
+// body is part of the loop, which lets LLVM hoist lane-invariant code and
+// vectorize lanes whose bodies permit it. With lazy compilation `callee` is
+// compiled separately (see kJitEntryPointAttribute) and is not inlined.
+absl::StatusOr<llvm::Function*> BuildBatchedWrapper(
+    FunctionBase* xls_function, llvm::Function* callee,
+    JitBuilderContext& jit_context) {
+  XLS_RET_CHECK(xls_function->IsFunction());
+  llvm::LLVMContext* context = &jit_context.context();
+  llvm::Type* i64 = llvm::Type::getInt64Ty(*context);
+  llvm::Type* ptr_type = llvm::PointerType::get(*context, 0);
+  std::vector<Node*> inputs = GetJittedFunctionInputs(xls_function);
+  std::vector<Node*> outputs = GetJittedFunctionOutputs(xls_function);
+  LlvmFunctionWrapper wrapper = LlvmFunctionWrapper::Create(
+      absl::StrFormat("%s_batched", xls_function->name()), inputs, outputs, i64,
+      jit_context,
+      LlvmFunctionWrapper::FunctionArg{.name = "batch_size", .type = i64});
+  wrapper.function()->addFnAttr(kJitEntryPointAttribute);
+  llvm::IRBuilder<>& entry = wrapper.entry_builder();
+
+  // Arrays of pointers to the per-lane input and output buffers passed to
+  // `callee`.
+  llvm::Value* input_arg_array =
+      entry.CreateAlloca(llvm::ArrayType::get(ptr_type, inputs.size()));
+  llvm::Value* output_arg_array =
+      entry.CreateAlloca(llvm::ArrayType::get(ptr_type, outputs.size()));
+
+  // Load the base pointers of the columns once outside of the loop.
+  std::vector<llvm::Value*> input_columns;
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    input_columns.push_back(
+        LoadPointerFromPointerArray(i, wrapper.GetInputsArg(), &entry));
+  }
+  std::vector<llvm::Value*> output_columns;
+  for (int64_t i = 0; i < outputs.size(); ++i) {
+    output_columns.push_back(
+        LoadPointerFromPointerArray(i, wrapper.GetOutputsArg(), &entry));
+  }
+
+  llvm::BasicBlock* loop_header = llvm::BasicBlock::Create(
+      *context, "loop_header", wrapper.function(), /*InsertBefore=*/nullptr);
+  llvm::BasicBlock* loop_body = llvm::BasicBlock::Create(
+      *context, "loop_body", wrapper.function(), /*InsertBefore=*/nullptr);
+  llvm::BasicBlock* exit_block = llvm::BasicBlock::Create(
+      *context, "exit", wrapper.function(), /*InsertBefore=*/nullptr);
+  entry.CreateBr(loop_header);
+
+  llvm::IRBuilder<> header_builder(loop_header);
+  llvm::PHINode* lane = header_builder.CreatePHI(i64, 2, "lane");
+  lane->addIncoming(llvm::ConstantInt::get(i64, 0), entry.GetInsertBlock());
+  header_builder.CreateCondBr(
+      header_builder.CreateICmpSLT(lane, wrapper.GetExtraArg().value()),
+      loop_body, exit_block);
+
+  llvm::IRBuilder<> body_builder(loop_body);
+  llvm::Type* pointer_array_type =
+      llvm::ArrayType::get(llvm::Type::getInt8PtrTy(*context), 0);
+  auto set_lane_pointer = [&](llvm::Value* pointer_array, int64_t index,
+                              llvm::Value* column, Node* node) {
+    int64_t stride =
+        jit_context.type_converter().GetTypeByteSize(node->GetType());
+    llvm::Value* lane_buffer = body_builder.CreateGEP(
+        body_builder.getInt8Ty(), column,
+        body_builder.CreateMul(lane, llvm::ConstantInt::get(i64, stride)));
+    llvm::Value* gep = body_builder.CreateGEP(
+        pointer_array_type, pointer_array,
+        {body_builder.getInt32(0), body_builder.getInt32(index)});
+    body_builder.CreateStore(lane_buffer, gep);
+  };
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    set_lane_pointer(input_arg_array, i, input_columns[i], inputs[i]);
+  }
+  for (int64_t i = 0; i < outputs.size(); ++i) {
+    set_lane_pointer(output_arg_array, i, output_columns[i], outputs[i]);
+  }
+
+  std::vector<llvm::Value*> args = {input_arg_array,
+                                    output_arg_array,
+                                    wrapper.GetTempBufferArg(),
+                                    wrapper.GetInterpreterEventsArg(),
+                                    wrapper.GetUserDataArg(),
+                                    wrapper.GetJitRuntimeArg(),
+                                    body_builder.getInt64(0)};
+  llvm::CallInst* call = body_builder.CreateCall(callee, args);
+  call->addFnAttr(llvm::Attribute::AlwaysInline);
+  llvm::Value* next_lane =
+      body_builder.CreateAdd(lane, llvm::ConstantInt::get(i64, 1));
+  lane->addIncoming(next_lane, loop_body);
+  body_builder.CreateBr(loop_header);
+
+  // No unpoisoning is necessary here as `callee` unpoisons the output buffers
+  // of each lane.
+  llvm::IRBuilder<> exit_builder(exit_block);
+  exit_builder.CreateRet(exit_builder.getInt64(0));
+
+  return wrapper.function();
+}
+
+// Builds a wrapper around the jitted function `callee` implementing the proc
+// `xls_function` which runs multiple ticks in a single call. The wrapper has
+// the signature of `JitMultiTickFunctionType`. `tick_state[0]` holds the
+// continuation point at which to resume and `tick_state[1]` the number of
+// ticks to complete. Early exits after sends do not return from the wrapper,
+// only blocked receives do. On return `tick_state` holds the continuation
+// point at which execution stopped and the number of ticks completed. The
+// wrapper looks like:
+//
+//    int64_t
+//    __p_multi_tick(const uint8_t* const* inputs,
+//                   uint8_t* const* outputs,
+//                   void* temp_buffer,
+//                   InterpreterEvents* events,
+//                   void* user_data,
+//                   JitRuntime* jit_runtime,
+//                   int64_t* tick_state) {
+//      int64_t point = tick_state[0];
+//      int64_t ticks = 0;
+//      while (point != 0 || ticks < tick_state[1]) {
+//        point = __p(inputs, outputs, temp_buffer, events, user_data,
+//                    jit_runtime, point);
+//        if (point == 0) {
+//          ++ticks;
+//          swap(inputs, outputs);
+//        } else if (!<point is the exit point of a send>) {
+//          break;
+//        }
+//      }
+//      tick_state[0] = point;
+//      tick_state[1] = ticks;
+//      return point;
+//    }
+//
+// The next state computed by a tick is the input of the next one, so after an
+// odd number of ticks the roles of the caller's input and output buffers are
+// swapped.
+absl::StatusOr<llvm::Function*> BuildMultiTickWrapper(
+    FunctionBase* xls_function, const PartitionedFunction& callee,
+    JitBuilderContext& jit_context) {
+  XLS_RET_CHECK(xls_function->IsProc());
+  llvm::LLVMContext* context = &jit_context.context();
+  llvm::Type* i64 = llvm::Type::getInt64Ty(*context);
+  llvm::Type* ptr_type = llvm::PointerType::get(*context, 0);
+  std::vector<Node*> inputs = GetJittedFunctionInputs(xls_function);
+  std::vector<Node*> outputs = GetJittedFunctionOutputs(xls_function);
+  LlvmFunctionWrapper wrapper = LlvmFunctionWrapper::Create(
+      absl::StrFormat("%s_multi_tick", xls_function->name()), inputs, outputs,
+      i64, jit_context,
+      LlvmFunctionWrapper::FunctionArg{.name = "tick_state",
+                                       .type = ptr_type});
+  wrapper.function()->addFnAttr(kJitEntryPointAttribute);
+  llvm::IRBuilder<>& entry = wrapper.entry_builder();
+  llvm::Value* tick_state = wrapper.GetExtraArg().value();
+  llvm::Value* ticks_gep =
+      entry.CreateGEP(i64, tick_state, llvm::ConstantInt::get(i64, 1));
+  llvm::Value* start_point = entry.CreateLoad(i64, tick_state);
+  llvm::Value* max_ticks = entry.CreateLoad(i64, ticks_gep);
+
+  llvm::BasicBlock* loop_header = llvm::BasicBlock::Create(
+      *context, "loop_header", wrapper.function(), /*InsertBefore=*/nullptr);
+  llvm::BasicBlock* loop_body = llvm::BasicBlock::Create(
+      *context, "loop_body", wrapper.function(), /*InsertBefore=*/nullptr);
+  llvm::BasicBlock* tick_completed = llvm::BasicBlock::Create(
+      *context, "tick_completed", wrapper.function(), /*InsertBefore=*/nullptr);
+  llvm::BasicBlock* early_exit = llvm::BasicBlock::Create(
+      *context, "early_exit", wrapper.function(), /*InsertBefore=*/nullptr);
+  llvm::BasicBlock* exit_block = llvm::BasicBlock::Create(
+      *context, "exit", wrapper.function(), /*InsertBefore=*/nullptr);
+  entry.CreateBr(loop_header);
+
+  llvm::IRBuilder<> header_builder(loop_header);
+  llvm::PHINode* input_array = header_builder.CreatePHI(ptr_type, 3, "inputs");
+  llvm::PHINode* output_array =
+      header_builder.CreatePHI(ptr_type, 3, "outputs");
+  llvm::PHINode* point = header_builder.CreatePHI(i64, 3, "point");
+  llvm::PHINode* ticks = header_builder.CreatePHI(i64, 3, "ticks");
+  input_array->addIncoming(wrapper.GetInputsArg(), entry.GetInsertBlock());
+  output_array->addIncoming(wrapper.GetOutputsArg(), entry.GetInsertBlock());
+  point->addIncoming(start_point, entry.GetInsertBlock());
+  ticks->addIncoming(llvm::ConstantInt::get(i64, 0), entry.GetInsertBlock());
+  // Stop only between ticks.
+  llvm::Value* done = header_builder.CreateAnd(
+      header_builder.CreateICmpEQ(point, llvm::ConstantInt::get(i64, 0)),
+      header_builder.CreateICmpSGE(ticks, max_ticks));
+  header_builder.CreateCondBr(done, exit_block, loop_body);
+
+  llvm::IRBuilder<> body_builder(loop_body);
+  std::vector<llvm::Value*> args = {
+      input_array,          output_array,
+      wrapper.GetTempBufferArg(), wrapper.GetInterpreterEventsArg(),
+      wrapper.GetUserDataArg(),   wrapper.GetJitRuntimeArg(),
+      point};
+  llvm::Value* next_point = body_builder.CreateCall(callee.function, args);
+  body_builder.CreateCondBr(
+      body_builder.CreateICmpEQ(next_point, llvm::ConstantInt::get(i64, 0)),
+      tick_completed, early_exit);
+
+  llvm::IRBuilder<> completed_builder(tick_completed);
+  llvm::Value* next_ticks =
+      completed_builder.CreateAdd(ticks, llvm::ConstantInt::get(i64, 1));
+  input_array->addIncoming(output_array, tick_completed);
+  output_array->addIncoming(input_array, tick_completed);
+  point->addIncoming(llvm::ConstantInt::get(i64, 0), tick_completed);
+  ticks->addIncoming(next_ticks, tick_completed);
+  completed_builder.CreateBr(loop_header);
+
+  // Execution resumes right away after a send; any other early exit is a
+  // blocked receive which returns to the caller.
+  llvm::IRBuilder<> early_exit_builder(early_exit);
+  llvm::Value* after_send = early_exit_builder.getFalse();
+  for (const Partition& partition : callee.partitions) {
+    if (partition.early_exit_point.has_value() &&
+        partition.nodes.front()->Is<Send>()) {
+      after_send = early_exit_builder.CreateOr(
+          after_send, early_exit_builder.CreateICmpEQ(
+                          next_point, early_exit_builder.getInt64(
+                                          partition.early_exit_point->id)));
+    }
+  }
+  early_exit_builder.CreateCondBr(after_send, loop_header, exit_block);
+  input_array->addIncoming(input_array, early_exit);
+  output_array->addIncoming(output_array, early_exit);
+  point->addIncoming(next_point, early_exit);
+  ticks->addIncoming(ticks, early_exit);
+
+  llvm::IRBuilder<> exit_builder(exit_block);
+  llvm::PHINode* final_point = exit_builder.CreatePHI(i64, 2);
+  final_point->addIncoming(point, loop_header);
+  final_point->addIncoming(next_point, early_exit);
+  llvm::PHINode* final_ticks = exit_builder.CreatePHI(i64, 2);
+  final_ticks->addIncoming(ticks, loop_header);
+  final_ticks->addIncoming(ticks, early_exit);
+  exit_builder.CreateStore(final_point, tick_state);
+  exit_builder.CreateStore(final_ticks, ticks_gep);
+  exit_builder.CreateRet(final_point);
+
+  return wrapper.function();
+}
+
+// Jits functions implementing each of `xls_functions` in a single LLVM
+// module. Also jits all transitively dependent xls::Functions which may be
+// called by any of `xls_functions`. Dependencies shared between the functions
+// are built only once. The returned JittedFunctionBases are in the same order
+// as `xls_functions`.
+absl::StatusOr<std::vector<JittedFunctionBase>> BuildFunctionsAndDependencies(
+    absl::Span<FunctionBase* const> xls_functions,
+    JitBuilderContext& jit_context, bool build_packed_wrapper,
+    bool build_batched_wrapper, bool build_multi_tick_wrapper) {
+  absl::flat_hash_set<FunctionBase*> tops(xls_functions.begin(),
+                                          xls_functions.end());
+  XLS_RET_CHECK_EQ(tops.size(), xls_functions.size())
+      << "Functions to jit must be unique";
+
+  // Concatenating the dependency lists of each function (skipping functions
+  // already seen) preserves the property that callees precede callers.
+  std::vector<FunctionBase*> functions;
+  absl::flat_hash_set<FunctionBase*> seen;
+  for (FunctionBase* xls_function : xls_functions) {
+    for (FunctionBase* f : GetDependentFunctions(xls_function)) {
+      if (seen.insert(f).second) {
+        functions.push_back(f);
+      }
+    }
+  }
+
   BufferAllocator allocator(&jit_context.type_converter());
-  llvm::Function* top_function = nullptr;
-  std::vector<Partition> top_partitions;
+  absl::flat_hash_map<FunctionBase*, PartitionedFunction> top_functions;
   for (FunctionBase* f : functions) {
     XLS_ASSIGN_OR_RETURN(
         PartitionedFunction partitioned_function,
         BuildFunctionInternal(f, allocator, jit_context,
-                              /*unpoison_outputs=*/f == xls_function));
+                              /*unpoison_outputs=*/tops.contains(f)));
     jit_context.SetLlvmFunction(f, partitioned_function.function);
-    if (f == xls_function) {
-      top_function = partitioned_function.function;
-      top_partitions = std::move(partitioned_function.partitions);
+    if (tops.contains(f)) {
+      top_functions[f] = std::move(partitioned_function);
     }
   }
-  XLS_RET_CHECK(top_function != nullptr);
-
-  std::string function_name = top_function->getName().str();
-  std::string packed_wrapper_name;
-  if (build_packed_wrapper) {
-    XLS_ASSIGN_OR_RETURN(
-        llvm::Function * packed_wrapper_function,
-        BuildPackedWrapper(xls_function, top_function, jit_context));
-    packed_wrapper_name = packed_wrapper_function->getName().str();
+  XLS_RET_CHECK_EQ(top_functions.size(), xls_functions.size());
+
+  std::vector<std::string> packed_wrapper_names;
+  std::vector<std::string> batched_wrapper_names;
+  std::vector<std::string> multi_tick_wrapper_names;
+  for (FunctionBase* xls_function : xls_functions) {
+    llvm::Function* top_function = top_functions.at(xls_function).function;
+    if (build_packed_wrapper) {
+      XLS_ASSIGN_OR_RETURN(
+          llvm::Function * packed_wrapper_function,
+          BuildPackedWrapper(xls_function, top_function, jit_context));
+      packed_wrapper_names.push_back(packed_wrapper_function->getName().str());
+    }
+    if (build_batched_wrapper) {
+      XLS_ASSIGN_OR_RETURN(
+          llvm::Function * batched_wrapper_function,
+          BuildBatchedWrapper(xls_function, top_function, jit_context));
+      batched_wrapper_names.push_back(
+          batched_wrapper_function->getName().str());
+    }
+    if (build_multi_tick_wrapper) {
+      XLS_ASSIGN_OR_RETURN(
+          llvm::Function * multi_tick_wrapper_function,
+          BuildMultiTickWrapper(xls_function, top_functions.at(xls_function),
+                                jit_context));
+      multi_tick_wrapper_names.push_back(
+          multi_tick_wrapper_function->getName().str());
+    }
   }
 
   XLS_RETURN_IF_ERROR(
       jit_context.orc_jit().CompileModule(jit_context.ConsumeModule()));
 
-  JittedFunctionBase jitted_function;
+  std::vector<JittedFunctionBase> jitted_functions;
+  for (int64_t i = 0; i < xls_functions.size(); ++i) {
+    FunctionBase* xls_function = xls_functions[i];
+    const PartitionedFunction& top = top_functions.at(xls_function);
+    JittedFunctionBase jitted_function;
+    jitted_function.function_base = xls_function;
 
-  jitted_function.function_name = function_name;
-  XLS_ASSIGN_OR_RETURN(auto fn_address,
-                       jit_context.orc_jit().LoadSymbol(function_name));
-  jitted_function.function = absl::bit_cast<JitFunctionType>(fn_address);
+    jitted_function.function_name = top.function->getName().str();
+    XLS_ASSIGN_OR_RETURN(
+        auto fn_address,
+        jit_context.orc_jit().LoadSymbol(jitted_function.function_name));
+    jitted_function.function = absl::bit_cast<JitFunctionType>(fn_address);
+
+    if (build_packed_wrapper) {
+      jitted_function.packed_function_name = packed_wrapper_names[i];
+      XLS_ASSIGN_OR_RETURN(
+          auto packed_fn_address,
+          jit_context.orc_jit().LoadSymbol(packed_wrapper_names[i]));
+      jitted_function.packed_function =
+          absl::bit_cast<JitFunctionType>(packed_fn_address);
+    }
 
-  if (build_packed_wrapper) {
-    jitted_function.packed_function_name = packed_wrapper_name;
-    XLS_ASSIGN_OR_RETURN(auto packed_fn_address,
-                         jit_context.orc_jit().LoadSymbol(packed_wrapper_name));
-    jitted_function.packed_function =
-        absl::bit_cast<JitFunctionType>(packed_fn_address);
-  }
+    if (build_batched_wrapper) {
+      jitted_function.batched_function_name = batched_wrapper_names[i];
+      XLS_ASSIGN_OR_RETURN(
+          auto batched_fn_address,
+          jit_context.orc_jit().LoadSymbol(batched_wrapper_names[i]));
+      jitted_function.batched_function =
+          absl::bit_cast<JitBatchedFunctionType>(batched_fn_address);
+    }
 
-  for (const Node* input : GetJittedFunctionInputs(xls_function)) {
-    jitted_function.input_buffer_sizes.push_back(
-        jit_context.type_converter().GetTypeByteSize(input->GetType()));
-    jitted_function.packed_input_buffer_sizes.push_back(
-        jit_context.type_converter().GetPackedTypeByteSize(input->GetType()));
-  }
-  for (const Node* output : GetJittedFunctionOutputs(xls_function)) {
-    jitted_function.output_buffer_sizes.push_back(
-        jit_context.type_converter().GetTypeByteSize(output->GetType()));
-    jitted_function.packed_output_buffer_sizes.push_back(
-        jit_context.type_converter().GetPackedTypeByteSize(output->GetType()));
-  }
-  jitted_function.temp_buffer_size = allocator.size();
+    if (build_multi_tick_wrapper) {
+      jitted_function.multi_tick_function_name = multi_tick_wrapper_names[i];
+      XLS_ASSIGN_OR_RETURN(
+          auto multi_tick_fn_address,
+          jit_context.orc_jit().LoadSymbol(multi_tick_wrapper_names[i]));
+      jitted_function.multi_tick_function =
+          absl::bit_cast<JitMultiTickFunctionType>(multi_tick_fn_address);
+    }
 
-  // Indicate which nodes correspond to which early exit points.
-  for (const Partition& partition : top_partitions) {
-    if (partition.early_exit_point.has_value()) {
-      XLS_RET_CHECK_EQ(partition.nodes.size(), 1);
-      jitted_function.continuation_points[partition.early_exit_point->id] =
-          partition.nodes.front();
+    for (const Node* input : GetJittedFunctionInputs(xls_function)) {
+      jitted_function.input_buffer_sizes.push_back(
+          jit_context.type_converter().GetTypeByteSize(input->GetType()));
+      jitted_function.packed_input_buffer_sizes.push_back(
+          jit_context.type_converter().GetPackedTypeByteSize(
+              input->GetType()));
+    }
+    for (const Node* output : GetJittedFunctionOutputs(xls_function)) {
+      jitted_function.output_buffer_sizes.push_back(
+          jit_context.type_converter().GetTypeByteSize(output->GetType()));
+      jitted_function.packed_output_buffer_sizes.push_back(
+          jit_context.type_converter().GetPackedTypeByteSize(
+              output->GetType()));
     }
+    // All of the functions share a single temporary buffer allocation.
+    jitted_function.temp_buffer_size = allocator.size();
+
+    jitted_function.in_place_state_indices =
+        std::vector<int64_t>(top.in_place_state_indices.begin(),
+                             top.in_place_state_indices.end());
+    std::sort(jitted_function.in_place_state_indices.begin(),
+              jitted_function.in_place_state_indices.end());
+
+    // Indicate which nodes correspond to which early exit points.
+    for (const Partition& partition : top.partitions) {
+      if (partition.early_exit_point.has_value()) {
+        XLS_RET_CHECK_EQ(partition.nodes.size(), 1);
+        jitted_function.continuation_points[partition.early_exit_point->id] =
+            partition.nodes.front();
+      }
+    }
+    jitted_functions.push_back(std::move(jitted_function));
   }
 
-  return std::move(jitted_function);
+  return jitted_functions;
+}
+
+// As BuildFunctionsAndDependencies but for a single FunctionBase.
+absl::StatusOr<JittedFunctionBase> BuildFunctionAndDependencies(
+    FunctionBase* xls_function, JitBuilderContext& jit_context,
+    bool build_packed_wrapper, bool build_batched_wrapper,
+    bool build_multi_tick_wrapper) {
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<JittedFunctionBase> jitted_functions,
+      BuildFunctionsAndDependencies({xls_function}, jit_context,
+                                    build_packed_wrapper, build_batched_wrapper,
+                                    build_multi_tick_wrapper));
+  return std::move(jitted_functions.front());
 }
 
 }  // namespace
 
 absl::StatusOr<JittedFunctionBase> BuildFunction(Function* xls_function,
-                                                 OrcJit& orc_jit) {
-  JitBuilderContext jit_context(orc_jit);
+                                                 OrcJit& orc_jit,
+                                                 JitProfile* profile,
+                                                 bool build_batched_wrapper) {
+  JitBuilderContext jit_context(orc_jit, /*queue_mgr=*/std::nullopt, profile);
   return BuildFunctionAndDependencies(xls_function, jit_context,
-                                      /*build_packed_wrapper=*/true);
+                                      /*build_packed_wrapper=*/true,
+                                      build_batched_wrapper,
+                                      /*build_multi_tick_wrapper=*/false);
+}
+
+absl::StatusOr<std::vector<JittedFunctionBase>> BuildFunctions(
+    absl::Span<Function* const> xls_functions, OrcJit& orc_jit) {
+  JitBuilderContext jit_context(orc_jit, /*queue_mgr=*/std::nullopt);
+  std::vector<FunctionBase*> function_bases(xls_functions.begin(),
+                                            xls_functions.end());
+  return BuildFunctionsAndDependencies(function_bases, jit_context,
+                                       /*build_packed_wrapper=*/false,
+                                       /*build_batched_wrapper=*/false,
+                                       /*build_multi_tick_wrapper=*/false);
 }
 
 absl::StatusOr<JittedFunctionBase> BuildProcFunction(
-    Proc* proc, JitChannelQueueManager* queue_mgr, OrcJit& orc_jit) {
-  JitBuilderContext jit_context(orc_jit, queue_mgr);
+    Proc* proc, JitChannelQueueManager* queue_mgr, OrcJit& orc_jit,
+    JitProfile* profile) {
+  JitBuilderContext jit_context(orc_jit, queue_mgr, profile);
   return BuildFunctionAndDependencies(proc, jit_context,
-                                      /*build_packed_wrapper=*/false);
+                                      /*build_packed_wrapper=*/false,
+                                      /*build_batched_wrapper=*/false,
+                                      /*build_multi_tick_wrapper=*/true);
+}
+
+absl::StatusOr<std::vector<JittedFunctionBase>> BuildProcFunctionsWithHooks(
+    absl::Span<Proc* const> procs, OrcJit& orc_jit) {
+  XLS_RET_CHECK(!procs.empty());
+  absl::flat_hash_map<int64_t, int64_t> channel_hook_indices;
+  for (Channel* channel : procs.front()->package()->channels()) {
+    channel_hook_indices.insert({channel->id(), channel_hook_indices.size()});
+  }
+  JitBuilderContext jit_context(orc_jit, /*queue_mgr=*/std::nullopt);
+  jit_context.UseChannelHooks(std::move(channel_hook_indices));
+  std::vector<FunctionBase*> function_bases(procs.begin(), procs.end());
+  return BuildFunctionsAndDependencies(function_bases, jit_context,
+                                       /*build_packed_wrapper=*/false,
+                                       /*build_batched_wrapper=*/false,
+                                       /*build_multi_tick_wrapper=*/true);
 }
 
 }  // namespace xls
@@ -19,10 +19,13 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
 #include "xls/ir/proc.h"
 #include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/orc_jit.h"
 
@@ -54,6 +57,36 @@ using JitFunctionType = int64_t (*)(const uint8_t* const* inputs,
                                     JitRuntime* jit_runtime,
                                     int64_t continuation_point);
 
+// Type alias for the jitted functions which evaluate a batch of independent
+// invocations of an XLS Function. The arguments are the same as
+// `JitFunctionType` except that each element of `inputs` and `outputs` points
+// to a column of `batch_size` consecutive values in the native LLVM data
+// layout, and the final argument is the number of invocations to evaluate.
+using JitBatchedFunctionType = int64_t (*)(const uint8_t* const* inputs,
+                                           uint8_t* const* outputs,
+                                           void* temp_buffer,
+                                           InterpreterEvents* events,
+                                           void* user_data,
+                                           JitRuntime* jit_runtime,
+                                           int64_t batch_size);
+
+// Type alias for the jitted functions which evaluate multiple ticks of a Proc
+// in a single call. The arguments are the same as `JitFunctionType` except
+// the last. `tick_state[0]` is the continuation point at which to resume and
+// `tick_state[1]` the number of ticks to complete. Execution continues past
+// sends and stops only when the ticks are done or a blocking receive has no
+// data. On return `tick_state[0]` holds the continuation point at which
+// execution stopped (also returned) and `tick_state[1]` the number of ticks
+// completed. The state produced by a tick is the input of the next one, so the
+// roles of the `inputs` and `outputs` buffers are swapped after each tick.
+using JitMultiTickFunctionType = int64_t (*)(const uint8_t* const* inputs,
+                                             uint8_t* const* outputs,
+                                             void* temp_buffer,
+                                             InterpreterEvents* events,
+                                             void* user_data,
+                                             JitRuntime* jit_runtime,
+                                             int64_t* tick_state);
+
 // Abstraction holding function pointers and metadata about a jitted function
 // implementing a XLS Function, Proc, etc.
 struct JittedFunctionBase {
@@ -71,6 +104,18 @@ struct JittedFunctionBase {
   std::optional<std::string> packed_function_name;
   std::optional<JitFunctionType> packed_function;
 
+  // Name and function pointer for the jitted function which evaluates a batch
+  // of invocations with arguments/results in LLVM native format. Only exists
+  // for JITted xls::Functions, not procs.
+  std::optional<std::string> batched_function_name;
+  std::optional<JitBatchedFunctionType> batched_function;
+
+  // Name and function pointer for the jitted function which evaluates
+  // multiple ticks with arguments/results in LLVM native format. Only exists
+  // for JITted procs.
+  std::optional<std::string> multi_tick_function_name;
+  std::optional<JitMultiTickFunctionType> multi_tick_function;
+
   // Sizes of the inputs/outputs in native LLVM format for `function_base`.
   std::vector<int64_t> input_buffer_sizes;
   std::vector<int64_t> output_buffer_sizes;
@@ -85,17 +130,46 @@ struct JittedFunctionBase {
   // Map from the continuation point return value to the corresponding node at
   // which execution was interrupted.
   absl::flat_hash_map<int64_t, Node*> continuation_points;
+
+  // Indices of the proc state elements whose input and output buffers may be
+  // the same buffer. The next values of these elements are computed by array
+  // updates of the state, e.g., writes to a memory, which then update the
+  // state in place instead of copying it each tick. Only exists for procs.
+  std::vector<int64_t> in_place_state_indices;
 };
 
 // Builds and returns an LLVM IR function implementing the given XLS
-// function.
-absl::StatusOr<JittedFunctionBase> BuildFunction(Function* xls_function,
-                                                 OrcJit& orc_jit);
+// function. If `profile` is non-null the function is instrumented to record
+// counters into it. The batched wrapper is only built if
+// `build_batched_wrapper` is true.
+absl::StatusOr<JittedFunctionBase> BuildFunction(
+    Function* xls_function, OrcJit& orc_jit, JitProfile* profile = nullptr,
+    bool build_batched_wrapper = false);
+
+// Builds LLVM IR functions implementing each of the given XLS functions in a
+// single LLVM module. Functions invoked by more than one of `xls_functions` are
+// built once and shared. Packed and batched wrappers are not built. All of the
+// returned functions share a single temporary buffer layout so
+// `temp_buffer_size` is the same for each. The returned JittedFunctionBases are
+// in the same order as `xls_functions`.
+absl::StatusOr<std::vector<JittedFunctionBase>> BuildFunctions(
+    absl::Span<Function* const> xls_functions, OrcJit& orc_jit);
 
 // Builds and returns an LLVM IR function implementing the given XLS
 // proc.
 absl::StatusOr<JittedFunctionBase> BuildProcFunction(
-    Proc* proc, JitChannelQueueManager* queue_mgr, OrcJit& orc_jit);
+    Proc* proc, JitChannelQueueManager* queue_mgr, OrcJit& orc_jit,
+    JitProfile* profile = nullptr);
+
+// Builds LLVM IR functions implementing each of the given procs in a single
+// LLVM module for ahead-of-time compilation. Instead of embedding the
+// addresses of channel queues, sends and receives call through the table of
+// aot_compile::AotChannelHooks passed as the `user_data` argument, indexed by
+// the position of the channel in the package's list of channels. As with
+// BuildFunctions the procs share a single temporary buffer layout. The
+// returned JittedFunctionBases are in the same order as `procs`.
+absl::StatusOr<std::vector<JittedFunctionBase>> BuildProcFunctionsWithHooks(
+    absl::Span<Proc* const> procs, OrcJit& orc_jit);
 
 }  // namespace xls
 
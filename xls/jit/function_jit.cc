@@ -25,6 +25,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/format_preference.h"
 #include "xls/ir/keyword_args.h"
@@ -36,8 +37,10 @@
 namespace xls {
 
 absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::Create(
-    Function* xls_function, int64_t opt_level) {
-  return CreateInternal(xls_function, opt_level, /*emit_object_code=*/false);
+    Function* xls_function, int64_t opt_level, JitProfile* profile,
+    bool build_batched_wrapper) {
+  return CreateInternal(xls_function, opt_level, /*emit_object_code=*/false,
+                        profile, build_batched_wrapper);
 }
 
 absl::StatusOr<JitObjectCode> FunctionJit::CreateObjectCode(
@@ -54,8 +57,30 @@ absl::StatusOr<JitObjectCode> FunctionJit::CreateObjectCode(
   };
 }
 
+absl::StatusOr<JitObjectCodeBundle> FunctionJit::CreateObjectCodeBundle(
+    absl::Span<Function* const> xls_functions, int64_t opt_level) {
+  XLS_RET_CHECK(!xls_functions.empty());
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit,
+                       OrcJit::Create(opt_level, /*emit_object_code=*/true));
+  XLS_ASSIGN_OR_RETURN(std::vector<JittedFunctionBase> jitted_functions,
+                       BuildFunctions(xls_functions, *orc_jit));
+  JitObjectCodeBundle bundle;
+  bundle.object_code = orc_jit->GetObjectCode();
+  bundle.temp_buffer_size = jitted_functions.front().temp_buffer_size;
+  for (int64_t i = 0; i < xls_functions.size(); ++i) {
+    bundle.entry_points.push_back(JitObjectCodeBundle::EntryPoint{
+        .function = xls_functions[i],
+        .function_name = jitted_functions[i].function_name,
+        .parameter_buffer_sizes = jitted_functions[i].input_buffer_sizes,
+        .return_buffer_size = jitted_functions[i].output_buffer_sizes[0],
+    });
+  }
+  return bundle;
+}
+
 absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::CreateInternal(
-    Function* xls_function, int64_t opt_level, bool emit_object_code) {
+    Function* xls_function, int64_t opt_level, bool emit_object_code,
+    JitProfile* profile, bool build_batched_wrapper) {
   auto jit = absl::WrapUnique(new FunctionJit(xls_function));
   XLS_ASSIGN_OR_RETURN(jit->orc_jit_,
                        OrcJit::Create(opt_level, emit_object_code));
@@ -63,15 +88,25 @@ absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::CreateInternal(
                        OrcJit::CreateDataLayout());
   jit->jit_runtime_ = std::make_unique<JitRuntime>(data_layout);
   XLS_ASSIGN_OR_RETURN(jit->jitted_function_base_,
-                       BuildFunction(xls_function, *jit->orc_jit_));
+                       BuildFunction(xls_function, *jit->orc_jit_, profile,
+                                     build_batched_wrapper));
 
   // Pre-allocate argument, result, and temporary buffers.
   for (int64_t i = 0; i < xls_function->params().size(); ++i) {
     jit->arg_buffers_.push_back(std::vector<uint8_t>(jit->GetArgTypeSize(i)));
     jit->arg_buffer_ptrs_.push_back(jit->arg_buffers_.back().data());
+    jit->arg_layouts_.push_back(jit->jit_runtime_->CreateTypeLayout(
+        xls_function->param(i)->GetType()));
   }
   jit->result_buffer_.resize(jit->GetReturnTypeSize());
+  jit->result_layout_ = jit->jit_runtime_->CreateTypeLayout(
+      xls_function->return_value()->GetType());
   jit->temp_buffer_.resize(jit->GetTempBufferSize());
+  int64_t buffer_bytes = jit->result_buffer_.size() + jit->temp_buffer_.size();
+  for (const std::vector<uint8_t>& arg_buffer : jit->arg_buffers_) {
+    buffer_bytes += arg_buffer.size();
+  }
+  jit->buffer_memory_account_.Add(buffer_bytes);
 
   return jit;
 }
@@ -93,19 +128,17 @@ absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
     }
   }
 
-  std::vector<Type*> param_types;
-  for (const Param* param : xls_function_->params()) {
-    param_types.push_back(param->GetType());
+  // Copy in arg Values. The buffers were zeroed when allocated and layouts
+  // only write data bytes and their padding, so inter-element padding stays
+  // zero.
+  for (int64_t i = 0; i < args.size(); ++i) {
+    arg_layouts_[i].ValueToNativeLayout(args[i], arg_buffer_ptrs_[i]);
   }
 
-  // Allocate argument buffers and copy in arg Values.
-  XLS_RETURN_IF_ERROR(jit_runtime_->PackArgs(args, param_types,
-                                             absl::MakeSpan(arg_buffer_ptrs_)));
-
   InterpreterEvents events;
-  InvokeJitFunction(arg_buffer_ptrs_, result_buffer_.data(), &events);
-  Value result = jit_runtime_->UnpackBuffer(
-      result_buffer_.data(), xls_function_->return_value()->GetType());
+  InvokeJitFunction(arg_buffer_ptrs_, result_buffer_.data(),
+                    temp_buffer_.data(), &events);
+  Value result = result_layout_->NativeLayoutToValue(result_buffer_.data());
 
   return InterpreterResult<Value>{std::move(result), std::move(events)};
 }
@@ -120,6 +153,15 @@ absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
 absl::Status FunctionJit::RunWithViews(absl::Span<uint8_t* const> args,
                                        absl::Span<uint8_t> result_buffer,
                                        InterpreterEvents* events) {
+  return RunWithViews(
+      absl::Span<const uint8_t* const>(args.data(), args.size()),
+      result_buffer, absl::MakeSpan(temp_buffer_), events);
+}
+
+absl::Status FunctionJit::RunWithViews(absl::Span<const uint8_t* const> args,
+                                       absl::Span<uint8_t> result_buffer,
+                                       absl::Span<uint8_t> temp_buffer,
+                                       InterpreterEvents* events) const {
   absl::Span<Param* const> params = xls_function_->params();
   if (args.size() != params.size()) {
     return absl::InvalidArgumentError(
@@ -132,17 +174,108 @@ absl::Status FunctionJit::RunWithViews(absl::Span<uint8_t* const> args,
         absl::StrCat("Result buffer too small - must be at least %d bytes!",
                      GetReturnTypeSize()));
   }
+  XLS_RET_CHECK_GE(temp_buffer.size(), GetTempBufferSize());
+
+  InvokeJitFunction(args, result_buffer.data(), temp_buffer.data(), events);
+  return absl::OkStatus();
+}
+
+absl::Status FunctionJit::RunBatch(
+    absl::Span<const uint8_t* const> arg_columns,
+    absl::Span<uint8_t> result_column, int64_t batch_size,
+    InterpreterEvents* events) {
+  return RunBatch(arg_columns, result_column, batch_size,
+                  absl::MakeSpan(temp_buffer_), events);
+}
+
+absl::Status FunctionJit::RunBatch(
+    absl::Span<const uint8_t* const> arg_columns,
+    absl::Span<uint8_t> result_column, int64_t batch_size,
+    absl::Span<uint8_t> temp_buffer, InterpreterEvents* events) const {
+  if (!jitted_function_base_.batched_function.has_value()) {
+    return absl::FailedPreconditionError(absl::StrFormat(
+        "No batched entry point was built for function '%s'; create the "
+        "FunctionJit with build_batched_wrapper set",
+        xls_function_->name()));
+  }
+  if (arg_columns.size() != xls_function_->params().size()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Arg list has the wrong size: %d vs expected %d.",
+                        arg_columns.size(), xls_function_->params().size()));
+  }
+  if (batch_size < 0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Batch size must be non-negative, got %d", batch_size));
+  }
+  if (result_column.size() < batch_size * GetReturnTypeSize()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Result buffer too small - must be at least %d bytes!",
+        batch_size * GetReturnTypeSize()));
+  }
+  XLS_RET_CHECK_GE(temp_buffer.size(), GetTempBufferSize());
 
-  InvokeJitFunction(args, result_buffer.data(), events);
+  uint8_t* output_columns[1] = {result_column.data()};
+  jitted_function_base_.batched_function.value()(
+      arg_columns.data(), output_columns, temp_buffer.data(), events,
+      /*user_data=*/nullptr, runtime(), batch_size);
   return absl::OkStatus();
 }
 
+absl::StatusOr<InterpreterResult<std::vector<Value>>> FunctionJit::RunBatch(
+    absl::Span<const std::vector<Value>> args_batch) {
+  absl::Span<Param* const> params = xls_function_->params();
+  int64_t batch_size = args_batch.size();
+
+  // Lay out the arguments as one contiguous column per parameter.
+  std::vector<std::vector<uint8_t>> arg_columns(params.size());
+  for (int64_t i = 0; i < params.size(); ++i) {
+    arg_columns[i].resize(batch_size * GetArgTypeSize(i));
+  }
+  for (int64_t lane = 0; lane < batch_size; ++lane) {
+    const std::vector<Value>& args = args_batch[lane];
+    if (args.size() != params.size()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Arg list %d to '%s' has the wrong size: %d vs expected %d.", lane,
+          xls_function_->name(), args.size(), params.size()));
+    }
+    for (int64_t i = 0; i < params.size(); ++i) {
+      if (!ValueConformsToType(args[i], params[i]->GetType())) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Got argument %s for parameter %d which is not of type %s",
+            args[i].ToString(), i, params[i]->GetType()->ToString()));
+      }
+      arg_layouts_[i].ValueToNativeLayout(
+          args[i], arg_columns[i].data() + lane * GetArgTypeSize(i));
+    }
+  }
+
+  std::vector<const uint8_t*> arg_column_ptrs;
+  arg_column_ptrs.reserve(arg_columns.size());
+  for (const std::vector<uint8_t>& column : arg_columns) {
+    arg_column_ptrs.push_back(column.data());
+  }
+  std::vector<uint8_t> result_column(batch_size * GetReturnTypeSize());
+
+  InterpreterEvents events;
+  XLS_RETURN_IF_ERROR(RunBatch(arg_column_ptrs, absl::MakeSpan(result_column),
+                               batch_size, &events));
+
+  std::vector<Value> results;
+  results.reserve(batch_size);
+  for (int64_t lane = 0; lane < batch_size; ++lane) {
+    results.push_back(result_layout_->NativeLayoutToValue(
+        result_column.data() + lane * GetReturnTypeSize()));
+  }
+  return InterpreterResult<std::vector<Value>>{std::move(results),
+                                               std::move(events)};
+}
+
 void FunctionJit::InvokeJitFunction(
     absl::Span<const uint8_t* const> arg_buffers, uint8_t* output_buffer,
-    InterpreterEvents* events) {
+    uint8_t* temp_buffer, InterpreterEvents* events) const {
   uint8_t* output_buffers[1] = {output_buffer};
   jitted_function_base_.function(
-      arg_buffers.data(), output_buffers, temp_buffer_.data(), events,
+      arg_buffers.data(), output_buffers, temp_buffer, events,
       /*user_data=*/nullptr, runtime(), /*continuation_point=*/0);
 }
 
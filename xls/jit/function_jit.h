@@ -16,6 +16,7 @@
 #define XLS_JIT_FUNCTION_JIT_H_
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -23,12 +24,15 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/common/memory_accounting.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
 #include "xls/ir/value.h"
 #include "xls/jit/function_base_jit.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -47,6 +51,33 @@ struct JitObjectCode {
   int64_t temp_buffer_size;
 };
 
+// Data structure containing jitted object code implementing multiple XLS
+// functions along with metadata about how to call each of them. Functions
+// invoked by more than one entry point appear only once in the object code.
+struct JitObjectCodeBundle {
+  // Metadata about a single entry point in the object code.
+  struct EntryPoint {
+    Function* function;
+
+    // Name of the jitted function in the object code.
+    std::string function_name;
+
+    // Size of the buffers for the parameters and result.
+    std::vector<int64_t> parameter_buffer_sizes;
+    int64_t return_buffer_size;
+  };
+
+  std::vector<uint8_t> object_code;
+
+  // The entry points in the same order as the functions passed to
+  // FunctionJit::CreateObjectCodeBundle.
+  std::vector<EntryPoint> entry_points;
+
+  // Minimum size of the temporary buffer passed to any of the entry points.
+  // The entry points share a single temporary buffer layout.
+  int64_t temp_buffer_size;
+};
+
 // This class provides a facility to execute XLS functions (on the host) by
 // converting it to LLVM IR, compiling it, and finally executing it. Not
 // thread-safe due to sharing of result and temporary buffers between
@@ -54,14 +85,22 @@ struct JitObjectCode {
 class FunctionJit {
  public:
   // Returns an object containing a host-compiled version of the specified XLS
-  // function.
+  // function. If `profile` is non-null the compiled code records execution
+  // counters into it (see JitProfile). The batched entry point used by
+  // RunBatch is only built if `build_batched_wrapper` is true.
   static absl::StatusOr<std::unique_ptr<FunctionJit>> Create(
-      Function* xls_function, int64_t opt_level = 3);
+      Function* xls_function, int64_t opt_level = 3,
+      JitProfile* profile = nullptr, bool build_batched_wrapper = false);
 
   // Returns the bytes of an object file containing the compiled XLS function.
   static absl::StatusOr<JitObjectCode> CreateObjectCode(Function* xls_function,
                                                         int64_t opt_level = 3);
 
+  // Returns the bytes of a single object file containing the compiled XLS
+  // functions. Unlike CreateObjectCode, packed wrappers are not included.
+  static absl::StatusOr<JitObjectCodeBundle> CreateObjectCodeBundle(
+      absl::Span<Function* const> xls_functions, int64_t opt_level = 3);
+
   // Executes the compiled function with the specified arguments.
   absl::StatusOr<InterpreterResult<Value>> Run(absl::Span<const Value> args);
 
@@ -85,6 +124,39 @@ class FunctionJit {
                             absl::Span<uint8_t> result_buffer,
                             InterpreterEvents* events);
 
+  // Executes the compiled function on a batch of `batch_size` independent sets
+  // of arguments with a single call into the jitted code. The arguments use a
+  // structure-of-arrays layout: `arg_columns[i]` points to `batch_size`
+  // consecutive values of the i-th parameter in the native LLVM data layout
+  // (each value occupies GetArgTypeSize(i) bytes). The results are written
+  // consecutively to `result_column` which must hold at least
+  // `batch_size * GetReturnTypeSize()` bytes. Events produced by all of the
+  // invocations are accumulated in `events`. The FunctionJit must have been
+  // created with `build_batched_wrapper` set.
+  absl::Status RunBatch(absl::Span<const uint8_t* const> arg_columns,
+                        absl::Span<uint8_t> result_column, int64_t batch_size,
+                        InterpreterEvents* events);
+
+  // As RunWithViews and RunBatch above, but with scratch space provided by
+  // the caller in `temp_buffer`, which must hold at least
+  // GetTempBufferSize() bytes, rather than owned by the FunctionJit. These
+  // leave the FunctionJit untouched, so concurrent calls with distinct
+  // temporary buffers are safe.
+  absl::Status RunWithViews(absl::Span<const uint8_t* const> args,
+                            absl::Span<uint8_t> result_buffer,
+                            absl::Span<uint8_t> temp_buffer,
+                            InterpreterEvents* events) const;
+  absl::Status RunBatch(absl::Span<const uint8_t* const> arg_columns,
+                        absl::Span<uint8_t> result_column, int64_t batch_size,
+                        absl::Span<uint8_t> temp_buffer,
+                        InterpreterEvents* events) const;
+
+  // As above, but with the arguments given as Values. `args_batch[j]` holds
+  // the arguments for the j-th invocation. Returns the result of each
+  // invocation in order, along with the events produced by all invocations.
+  absl::StatusOr<InterpreterResult<std::vector<Value>>> RunBatch(
+      absl::Span<const std::vector<Value>> args_batch);
+
   // Similar to RunWithViews(), except the arguments here are _packed_views_ -
   // views whose data elements are tightly packed, with no padding bits or bytes
   // between them. The function return value is specified as the last arg - its
@@ -131,7 +203,8 @@ class FunctionJit {
     PackArgBuffers(arg_buffers, &result_buffer, args...);
 
     InterpreterEvents events;
-    InvokeJitFunction(arg_buffers, result_buffer, &events);
+    InvokeJitFunction(arg_buffers, result_buffer, temp_buffer_.data(),
+                      &events);
     return InterpreterEventsToStatus(events);
   }
 
@@ -147,6 +220,13 @@ class FunctionJit {
     return jitted_function_base_.output_buffer_sizes[0];
   }
 
+  // Gets the native layouts of the compiled function's arguments (or return
+  // value), e.g. to read or write the columns of RunBatch.
+  const TypeLayout& GetArgTypeLayout(int arg_index) const {
+    return arg_layouts_.at(arg_index);
+  }
+  const TypeLayout& GetReturnTypeLayout() const { return *result_layout_; }
+
   // Gets the size of the compiled function's arguments (or return value) in the
   // packed layout.
   int64_t GetPackedArgTypeSize(int arg_index) const {
@@ -174,7 +254,8 @@ class FunctionJit {
   explicit FunctionJit(Function* xls_function) : xls_function_(xls_function) {}
 
   static absl::StatusOr<std::unique_ptr<FunctionJit>> CreateInternal(
-      Function* xls_function, int64_t opt_level, bool emit_object_code);
+      Function* xls_function, int64_t opt_level, bool emit_object_code,
+      JitProfile* profile = nullptr, bool build_batched_wrapper = false);
 
   // Builds a function which wraps the natively compiled XLS function `callee`
   // (as built by xls::BuildFunction) with another function which accepts the
@@ -215,7 +296,8 @@ class FunctionJit {
 
   // Invokes the jitted function with the given argument and outputs.
   void InvokeJitFunction(absl::Span<const uint8_t* const> arg_buffers,
-                         uint8_t* output_buffer, InterpreterEvents* events);
+                         uint8_t* output_buffer, uint8_t* temp_buffer,
+                         InterpreterEvents* events) const;
 
   std::unique_ptr<OrcJit> orc_jit_;
 
@@ -226,10 +308,16 @@ class FunctionJit {
   std::vector<std::vector<uint8_t>> arg_buffers_;
   std::vector<uint8_t> result_buffer_;
   std::vector<uint8_t> temp_buffer_;
+  MemoryAccount buffer_memory_account_{MemoryTag::kJitBuffers};
 
   // Raw pointers to the buffers held in `arg_buffers_`.
   std::vector<uint8_t*> arg_buffer_ptrs_;
 
+  // Native layouts of the parameters and the return value used to convert
+  // between Values and the buffers above.
+  std::vector<TypeLayout> arg_layouts_;
+  std::optional<TypeLayout> result_layout_;
+
   JittedFunctionBase jitted_function_base_;
   std::unique_ptr<JitRuntime> jit_runtime_;
 };
@@ -24,6 +24,8 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/flags/declare.h"
+#include "absl/flags/flag.h"
 #include "absl/random/random.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/substitute.h"
@@ -34,6 +36,9 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/value_view.h"
 
+ABSL_DECLARE_FLAG(int64_t, xls_jit_compile_threads);
+ABSL_DECLARE_FLAG(bool, xls_jit_lazy_compilation);
+
 namespace xls {
 namespace {
 
@@ -602,6 +607,36 @@ TEST(FunctionJitTest, ArrayConcatArrayOfBits) {
   EXPECT_THAT(RunJitNoEvents(jit.get(), args), IsOkAndHolds(ret));
 }
 
+TEST(FunctionJitTest, ArrayUpdatesInPlace) {
+  Package package("my_package");
+
+  // The second and third updates are the only uses of their array operand so
+  // they update its buffer in place. The param, which is also read by the
+  // array_index, is not updated in place.
+  std::string ir_text = R"(
+  fn f(a: bits[32][4], i: bits[2], x: bits[32]) -> (bits[32][4], bits[32]) {
+    one: bits[2] = literal(value=1)
+    nine: bits[32] = literal(value=9)
+    j: bits[2] = add(i, one)
+    update.1: bits[32][4] = array_update(a, x, indices=[i])
+    update.2: bits[32][4] = array_update(update.1, x, indices=[j])
+    update.3: bits[32][4] = array_update(update.2, nine, indices=[one])
+    read: bits[32] = array_index(a, indices=[i])
+    ret result: (bits[32][4], bits[32]) = tuple(update.3, read)
+  }
+  )";
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Value a, Value::UBitsArray({1, 2, 3, 4}, 32));
+  XLS_ASSERT_OK_AND_ASSIGN(Value updated, Value::UBitsArray({1, 9, 7, 7}, 32));
+  std::vector args{a, Value(UBits(2, 2)), Value(UBits(7, 32))};
+  EXPECT_THAT(RunJitNoEvents(jit.get(), args),
+              IsOkAndHolds(Value::Tuple({updated, Value(UBits(3, 32))})));
+}
+
 TEST(FunctionJitTest, ArrayConcatArrayOfBitsMixedOperands) {
   Package package("my_package");
 
@@ -876,5 +911,167 @@ fn f(x: bits[1], y: bits[8]) -> (bits[1], bits[8], bits[16]) {
   }
 }
 
+TEST(FunctionJitTest, RunBatch) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn batch(x: bits[8], y: bits[16]) -> (bits[16], bits[8]) {
+    zero_ext.1: bits[16] = zero_ext(x, new_bit_count=16)
+    add.2: bits[16] = add(zero_ext.1, y)
+    ret tuple.3: (bits[16], bits[8]) = tuple(add.2, x)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto jit, FunctionJit::Create(function, /*opt_level=*/3,
+                                    /*profile=*/nullptr,
+                                    /*build_batched_wrapper=*/true));
+
+  std::vector<std::vector<Value>> args_batch;
+  std::vector<Value> expected;
+  for (int64_t i = 0; i < 37; ++i) {
+    args_batch.push_back({Value(UBits(i, 8)), Value(UBits(1000 * i, 16))});
+    expected.push_back(Value::Tuple(
+        {Value(UBits(1001 * i, 16)), Value(UBits(i, 8))}));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<std::vector<Value>> result,
+                           jit->RunBatch(args_batch));
+  EXPECT_THAT(result.value, testing::ElementsAreArray(expected));
+
+  // An empty batch is a no-op.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpreterResult<std::vector<Value>> empty_result,
+      jit->RunBatch(absl::Span<const std::vector<Value>>()));
+  EXPECT_TRUE(empty_result.value.empty());
+}
+
+TEST(FunctionJitTest, RunBatchWithViews) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn batch(x: bits[32], y: bits[32]) -> bits[32] {
+    ret umul.1: bits[32] = umul(x, y)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto jit, FunctionJit::Create(function, /*opt_level=*/3,
+                                    /*profile=*/nullptr,
+                                    /*build_batched_wrapper=*/true));
+  ASSERT_EQ(jit->GetArgTypeSize(0), sizeof(uint32_t));
+  ASSERT_EQ(jit->GetReturnTypeSize(), sizeof(uint32_t));
+
+  constexpr int64_t kBatchSize = 100;
+  std::vector<uint32_t> x(kBatchSize);
+  std::vector<uint32_t> y(kBatchSize);
+  std::vector<uint32_t> result(kBatchSize);
+  for (int64_t i = 0; i < kBatchSize; ++i) {
+    x[i] = i;
+    y[i] = 3 * i + 1;
+  }
+  std::vector<const uint8_t*> arg_columns = {
+      reinterpret_cast<const uint8_t*>(x.data()),
+      reinterpret_cast<const uint8_t*>(y.data())};
+  InterpreterEvents events;
+  absl::Span<uint8_t> result_column = absl::MakeSpan(
+      reinterpret_cast<uint8_t*>(result.data()), kBatchSize * sizeof(uint32_t));
+  XLS_ASSERT_OK(jit->RunBatch(arg_columns, result_column, kBatchSize, &events));
+  for (int64_t i = 0; i < kBatchSize; ++i) {
+    EXPECT_EQ(result[i], x[i] * y[i]) << "lane " << i;
+  }
+
+  // A result buffer which cannot hold the whole batch is rejected.
+  EXPECT_THAT(jit->RunBatch(arg_columns,
+                            result_column.subspan(0, sizeof(uint32_t)),
+                            kBatchSize, &events),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(FunctionJitTest, RunBatchRequiresBatchedWrapper) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn f(x: bits[32]) -> bits[32] {
+    ret neg.1: bits[32] = neg(x)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  EXPECT_THAT(jit->RunBatch({{Value(UBits(1, 32))}}),
+              StatusIs(absl::StatusCode::kFailedPrecondition,
+                       testing::HasSubstr("build_batched_wrapper")));
+}
+
+TEST(FunctionJitTest, ParallelCompilation) {
+  // Build a function large enough to be divided into many partitions and
+  // compile it with several compilation threads.
+  Package package("my_package");
+  FunctionBuilder fb("big", &package);
+  BValue x = fb.Param("x", package.GetBitsType(32));
+  BValue accum = x;
+  for (int64_t i = 0; i < 1000; ++i) {
+    accum = fb.Add(fb.UMul(accum, fb.Literal(UBits(3, 32))),
+                   fb.Literal(UBits(i, 32)));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+
+  absl::SetFlag(&FLAGS_xls_jit_compile_threads, 4);
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  absl::SetFlag(&FLAGS_xls_jit_compile_threads, 1);
+
+  for (uint32_t input : {0, 1, 42, 123456}) {
+    uint32_t expected = input;
+    for (uint32_t i = 0; i < 1000; ++i) {
+      expected = expected * 3 + i;
+    }
+    EXPECT_THAT(RunJitNoEvents(jit.get(), {Value(UBits(input, 32))}),
+                IsOkAndHolds(Value(UBits(expected, 32))));
+  }
+}
+
+TEST(FunctionJitTest, LazyCompilation) {
+  std::string ir_text = R"(
+package my_package
+
+fn square(x: bits[32]) -> bits[32] {
+  ret umul.1: bits[32] = umul(x, x)
+}
+
+fn unused(x: bits[32]) -> bits[32] {
+  ret neg.2: bits[32] = neg(x)
+}
+
+top fn main(x: bits[32], y: bits[32]) -> bits[32] {
+  invoke.3: bits[32] = invoke(x, to_apply=square)
+  ret add.4: bits[32] = add(invoke.3, y)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, package->GetTopAsFunction());
+
+  absl::SetFlag(&FLAGS_xls_jit_lazy_compilation, true);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto jit, FunctionJit::Create(function, /*opt_level=*/3,
+                                    /*profile=*/nullptr,
+                                    /*build_batched_wrapper=*/true));
+  absl::SetFlag(&FLAGS_xls_jit_lazy_compilation, false);
+
+  EXPECT_THAT(
+      RunJitNoEvents(jit.get(), {Value(UBits(7, 32)), Value(UBits(1, 32))}),
+      IsOkAndHolds(Value(UBits(50, 32))));
+  EXPECT_THAT(
+      RunJitNoEvents(jit.get(), {Value(UBits(3, 32)), Value(UBits(2, 32))}),
+      IsOkAndHolds(Value(UBits(11, 32))));
+
+  // The batched and packed entry points are compiled on their own first call.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpreterResult<std::vector<Value>> batch_result,
+      jit->RunBatch({{Value(UBits(2, 32)), Value(UBits(0, 32))},
+                     {Value(UBits(4, 32)), Value(UBits(4, 32))}}));
+  EXPECT_THAT(batch_result.value, testing::ElementsAre(Value(UBits(4, 32)),
+                                                       Value(UBits(20, 32))));
+}
+
 }  // namespace
 }  // namespace xls
@@ -14,6 +14,7 @@
 #include "xls/jit/ir_builder_visitor.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -25,6 +26,7 @@
 #include <vector>
 
 #include "absl/base/config.h"  // IWYU pragma: keep
+#include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
@@ -36,22 +38,38 @@
 #include "llvm/include/llvm/IR/Module.h"
 #include "llvm/include/llvm/IR/Type.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/events.h"
+#include "xls/ir/foreign_function_model.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_helpers.h"
+#include "xls/jit/aot_runtime.h"
 #include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/jit_trace_buffer.h"
 #include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/native_float_lowering.h"
 #include "xls/jit/orc_jit.h"
+#include "xls/jit/wide_integer_kernels.h"
+
+ABSL_FLAG(bool, xls_jit_wide_integer_kernels, true,
+          "If true, the JIT lowers multiplies, divides and shifts of bits "
+          "values wider than 128 bits to calls to limb-based kernels rather "
+          "than to LLVM integer instructions.");
+ABSL_FLAG(bool, xls_jit_native_float, false,
+          "If true, the JIT lowers invocations of the float32/float64 add, "
+          "sub, mul and fma routines of the DSLX standard library to native "
+          "floating-point instructions. Results are bit-identical to those "
+          "of the IR bodies.");
 
 namespace xls {
 
@@ -433,136 +451,52 @@ llvm::Value* ClampIndexInBounds(llvm::Value* index, ArrayType* array_type,
   return inbounds_index;
 }
 
-// This is a shim to let JIT code add a new trace fragment to an existing trace
-// buffer.
-void PerformStringStep(char* step_string, std::string* buffer) {
-  buffer->append(step_string);
-}
-
-// Build the LLVM IR that handles string fragment format steps.
-absl::Status InvokeStringStepCallback(llvm::IRBuilder<>* builder,
-                                      const std::string& step_string,
-                                      llvm::Value* buffer_ptr) {
-  llvm::Constant* step_constant = builder->CreateGlobalStringPtr(step_string);
-
-  std::vector<llvm::Type*> params = {step_constant->getType(),
-                                     buffer_ptr->getType()};
-
-  llvm::Type* void_type = llvm::Type::getVoidTy(builder->getContext());
-
-  llvm::FunctionType* fn_type =
-      llvm::FunctionType::get(void_type, params, /*isVarArg=*/false);
-
-  std::vector<llvm::Value*> args = {step_constant, buffer_ptr};
-
-  llvm::ConstantInt* fn_addr =
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(builder->getContext()),
-                             absl::bit_cast<uint64_t>(&PerformStringStep));
-  llvm::Value* fn_ptr =
-      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
-  builder->CreateCall(fn_type, fn_ptr, args);
-  return absl::OkStatus();
-}
-
-void PerformFormatStep(JitRuntime* runtime, const xls::Type* type,
-                       const uint8_t* value, uint64_t format_u64,
-                       std::string* buffer) {
-  FormatPreference format = static_cast<FormatPreference>(format_u64);
-  Value ir_value = runtime->UnpackBuffer(value, type, /*unpoison=*/true);
-  absl::StrAppend(buffer, ir_value.ToHumanString(format));
-}
-
-// Build the LLVM IR that handles formatting a runtime value according to a
-// format preference.
-absl::Status InvokeFormatStepCallback(llvm::IRBuilder<>* builder,
-                                      FormatPreference format,
-                                      xls::Type* operand_type,
-                                      llvm::Value* operand,
-                                      llvm::Value* buffer_ptr,
-                                      llvm::Value* jit_runtime_ptr) {
-  llvm::Type* void_type = llvm::Type::getVoidTy(builder->getContext());
-  auto* i64_type = llvm::Type::getInt64Ty(builder->getContext());
-
-  llvm::ConstantInt* llvm_format =
-      llvm::ConstantInt::get(i64_type, static_cast<uint64_t>(format));
-
-  // Note: we assume the package lifetime is >= that of the JIT code by
-  // capturing this type pointer as a value burned into the JIT code, which
-  // should always be true.
-  llvm::ConstantInt* llvm_operand_type =
-      llvm::ConstantInt::get(i64_type, absl::bit_cast<uint64_t>(operand_type));
-
-  std::vector<llvm::Type*> params = {
-      jit_runtime_ptr->getType(), llvm_operand_type->getType(),
-      operand->getType(), llvm_format->getType(), buffer_ptr->getType()};
-  llvm::FunctionType* fn_type =
-      llvm::FunctionType::get(void_type, params, /*isVarArg=*/false);
-
-  std::vector<llvm::Value*> args = {jit_runtime_ptr, llvm_operand_type, operand,
-                                    llvm_format, buffer_ptr};
-
-  llvm::ConstantInt* fn_addr = llvm::ConstantInt::get(
-      i64_type, absl::bit_cast<uint64_t>(&PerformFormatStep));
-  llvm::Value* fn_ptr =
-      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
-  builder->CreateCall(fn_type, fn_ptr, args);
-  return absl::OkStatus();
-}
-
-// This a shim to let JIT code record a completed trace as an interpreter event.
-void RecordTrace(std::string* buffer, xls::InterpreterEvents* events) {
-  events->trace_msgs.push_back(*buffer);
-  delete buffer;
+// This is a shim to let JIT code record a trace event. `args` holds the
+// trace's data operands packed as in JitTraceBuffer records. If the runtime
+// has a trace buffer the event is recorded there unformatted, otherwise the
+// message is formatted and recorded as an interpreter event.
+void RecordTrace(const Trace* trace, const uint8_t* args, int64_t args_size,
+                 xls::InterpreterEvents* events, JitRuntime* runtime) {
+  if (JitTraceBuffer* buffer = runtime->trace_buffer(); buffer != nullptr) {
+    buffer->Append(trace, runtime, args, args_size);
+    return;
+  }
+  events->trace_msgs.push_back(FormatTraceMessage(trace, runtime, args));
 }
 
 // Build the LLVM IR to invoke the callback that records traces.
 absl::Status InvokeRecordTraceCallback(llvm::IRBuilder<>* builder,
-                                       llvm::Value* buffer_ptr,
-                                       llvm::Value* interpreter_events_ptr) {
+                                       Trace* trace, llvm::Value* args_ptr,
+                                       int64_t args_size,
+                                       llvm::Value* interpreter_events_ptr,
+                                       llvm::Value* jit_runtime_ptr) {
   llvm::Type* ptr_type = llvm::PointerType::get(builder->getContext(), 0);
-
-  std::vector<llvm::Type*> params = {buffer_ptr->getType(), ptr_type};
-
+  llvm::IntegerType* i64_type = llvm::Type::getInt64Ty(builder->getContext());
   llvm::Type* void_type = llvm::Type::getVoidTy(builder->getContext());
 
+  // Note: as with other callbacks we assume the package lifetime is >= that of
+  // the JIT code by burning the trace node pointer into the JIT code.
+  llvm::Value* trace_ptr = builder->CreateIntToPtr(
+      llvm::ConstantInt::get(i64_type, absl::bit_cast<uint64_t>(trace)),
+      ptr_type);
+
+  std::vector<llvm::Type*> params = {ptr_type, ptr_type, i64_type, ptr_type,
+                                     ptr_type};
   llvm::FunctionType* fn_type =
       llvm::FunctionType::get(void_type, params, /*isVarArg=*/false);
 
-  std::vector<llvm::Value*> args = {buffer_ptr, interpreter_events_ptr};
+  std::vector<llvm::Value*> args = {
+      trace_ptr, args_ptr, llvm::ConstantInt::get(i64_type, args_size),
+      interpreter_events_ptr, jit_runtime_ptr};
 
-  llvm::ConstantInt* fn_addr =
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(builder->getContext()),
-                             absl::bit_cast<uint64_t>(&RecordTrace));
+  llvm::ConstantInt* fn_addr = llvm::ConstantInt::get(
+      i64_type, absl::bit_cast<uint64_t>(&RecordTrace));
   llvm::Value* fn_ptr =
       builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
   builder->CreateCall(fn_type, fn_ptr, args);
   return absl::OkStatus();
 }
 
-// This is a shim to let JIT code create a buffer for accumulating trace
-// fragments.
-std::string* CreateTraceBuffer() { return new std::string(); }
-
-// Build the LLVM IR to invoke the callback that creates a trace buffer.
-absl::StatusOr<llvm::Value*> InvokeCreateBufferCallback(
-    llvm::IRBuilder<>* builder) {
-  std::vector<llvm::Type*> params;
-
-  llvm::Type* ptr_type = llvm::PointerType::get(builder->getContext(), 0);
-
-  llvm::FunctionType* fn_type =
-      llvm::FunctionType::get(ptr_type, params, /*isVarArg=*/false);
-
-  std::vector<llvm::Value*> args;
-
-  llvm::ConstantInt* fn_addr =
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(builder->getContext()),
-                             absl::bit_cast<uint64_t>(&CreateTraceBuffer));
-  llvm::Value* fn_ptr =
-      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
-  return builder->CreateCall(fn_type, fn_ptr, args);
-}
-
 // This a shim to let JIT code record an assertion failure as an interpreter
 // event.
 void RecordAssertion(char* msg, xls::InterpreterEvents* events) {
@@ -1001,6 +935,15 @@ class IrBuilderVisitor : public DfsVisitorWithDefault {
       Node* node, std::function<llvm::Value*(absl::Span<llvm::Value* const>,
                                              llvm::IRBuilder<>&)>);
 
+  // Returns true if `node` should be lowered to a call to one of the wide
+  // integer kernels (see wide_integer_kernels.h) rather than to LLVM integer
+  // instructions.
+  bool UseWideIntegerKernel(Node* node);
+
+  // Implements the binary operation `node` as a call to `kernel`.
+  absl::Status HandleWithWideIntegerKernel(Node* node,
+                                           WideIntegerKernel kernel);
+
   // HandleBinaryOp variant which converts the operands to result type prior to
   // calling `build_result`.
   absl::Status HandleBinaryOpWithOperandConversion(
@@ -1061,6 +1004,21 @@ class IrBuilderVisitor : public DfsVisitorWithDefault {
                            Send* send, llvm::Value* send_data_ptr,
                            llvm::Value* user_data);
 
+  // Returns the queue of the channel with the given id, or nullptr if channels
+  // are accessed through the hooks passed in `user_data` (see
+  // JitBuilderContext::UseChannelHooks).
+  absl::StatusOr<JitChannelQueue*> GetChannelQueue(Node* node,
+                                                   int64_t channel_id);
+
+  // Emits a call to the receive (send) function of the channel hook of the
+  // given channel. Receives return an i1 value indicating whether the receive
+  // fired.
+  absl::StatusOr<llvm::Value*> CallChannelHook(llvm::IRBuilder<>* builder,
+                                               int64_t channel_id,
+                                               bool is_send,
+                                               llvm::Value* data_ptr,
+                                               llvm::Value* user_data);
+
   int64_t output_arg_count_;
   JitBuilderContext& jit_context_;
   std::optional<NodeIrContext> node_context_;
@@ -1199,36 +1157,44 @@ absl::Status IrBuilderVisitor::HandleTrace(Trace* trace_op) {
       ctx(), absl::StrCat(trace_name, "_print"), node_context.llvm_function());
   llvm::IRBuilder<> print_builder(print_block);
 
-  XLS_ASSIGN_OR_RETURN(llvm::Value * buffer_ptr,
-                       InvokeCreateBufferCallback(&print_builder));
-
   // Operands are: (tok, pred, ..data_operands..)
   XLS_RET_CHECK_EQ(trace_op->operand(0)->GetType(),
                    trace_op->package()->GetTokenType());
   XLS_RET_CHECK_EQ(trace_op->operand(1)->GetType(),
                    trace_op->package()->GetBitsType(1));
 
-  size_t operand_index = 2;
-  for (const FormatStep& step : trace_op->format()) {
-    if (std::holds_alternative<std::string>(step)) {
-      XLS_RETURN_IF_ERROR(InvokeStringStepCallback(
-          &print_builder, std::get<std::string>(step), buffer_ptr));
-    } else {
-      xls::Node* o = trace_op->operand(operand_index);
-      llvm::Value* operand = node_context.LoadOperand(operand_index);
-      llvm::AllocaInst* alloca = print_builder.CreateAlloca(operand->getType());
-      print_builder.CreateStore(operand, alloca);
-      // The way our format strings are currently formed we implicitly refer to
-      // the next operand after formatting this one.
-      operand_index += 1;
-      XLS_RETURN_IF_ERROR(InvokeFormatStepCallback(
-          &print_builder, std::get<FormatPreference>(step), o->GetType(),
-          alloca, buffer_ptr, jit_runtime_ptr));
+  // Pack the data operands into a single buffer so the event is recorded with
+  // one callback. Formatting of the message happens in the callback (or later
+  // if the runtime has a trace buffer).
+  std::vector<int64_t> arg_offsets;
+  int64_t args_size = 0;
+  for (Node* arg : trace_op->args()) {
+    arg_offsets.push_back(args_size);
+    args_size = RoundUpToNearest(
+        args_size + type_converter()->GetTypeByteSize(arg->GetType()),
+        JitTraceBuffer::kArgAlignment);
+  }
+  llvm::Value* args_ptr =
+      llvm::ConstantPointerNull::get(llvm::PointerType::get(ctx(), 0));
+  if (args_size > 0) {
+    llvm::AllocaInst* args_buffer = print_builder.CreateAlloca(
+        llvm::ArrayType::get(print_builder.getInt8Ty(), args_size));
+    args_buffer->setAlignment(llvm::Align(JitTraceBuffer::kArgAlignment));
+    args_buffer->setName(absl::StrCat(trace_name, "_args"));
+    for (int64_t i = 0; i < trace_op->args().size(); ++i) {
+      Node* arg = trace_op->args()[i];
+      llvm::Value* arg_ptr = print_builder.CreateConstGEP1_64(
+          print_builder.getInt8Ty(), args_buffer, arg_offsets[i]);
+      LlvmMemcpy(arg_ptr, node_context.GetOperandPtr(i + 2, &print_builder),
+                 type_converter()->GetTypeByteSize(arg->GetType()),
+                 print_builder);
     }
+    args_ptr = args_buffer;
   }
 
-  XLS_RETURN_IF_ERROR(
-      InvokeRecordTraceCallback(&print_builder, buffer_ptr, events_ptr));
+  XLS_RETURN_IF_ERROR(InvokeRecordTraceCallback(&print_builder, trace_op,
+                                                args_ptr, args_size,
+                                                events_ptr, jit_runtime_ptr));
 
   print_builder.CreateBr(after_block);
 
@@ -1344,9 +1310,22 @@ absl::Status IrBuilderVisitor::HandleArrayUpdate(ArrayUpdate* update) {
   llvm::IRBuilder<>& b = node_context.entry_builder();
 
   // First, copy the entire array to update (operand 0) to the output buffer.
+  // The buffers are the same if the array is updated in place (see
+  // AllocateBuffers in function_base_jit.cc), in which case there is nothing
+  // to copy.
   llvm::Value* output_buffer = node_context.GetOutputPtr(0);
-  LlvmMemcpy(output_buffer, node_context.GetOperandPtr(0),
+  llvm::Value* array_buffer = node_context.GetOperandPtr(0);
+  llvm::BasicBlock* copy_block =
+      llvm::BasicBlock::Create(ctx(), "copy", node_context.llvm_function());
+  llvm::BasicBlock* update_block =
+      llvm::BasicBlock::Create(ctx(), "update", node_context.llvm_function());
+  b.CreateCondBr(b.CreateICmpEQ(output_buffer, array_buffer), update_block,
+                 copy_block);
+  b.SetInsertPoint(copy_block);
+  LlvmMemcpy(output_buffer, array_buffer,
              type_converter()->GetTypeByteSize(update->GetType()), b);
+  b.CreateBr(update_block);
+  b.SetInsertPoint(update_block);
 
   // Determine whether the indices are all inbounds. If any are out of bounds
   // then the array update operation is a NOP. Also, gather the GEP indices for
@@ -1918,14 +1897,72 @@ absl::Status IrBuilderVisitor::HandleInvoke(Invoke* invoke) {
                        /*include_wrapper_args=*/true));
   llvm::IRBuilder<>& b = node_context.entry_builder();
 
-  XLS_ASSIGN_OR_RETURN(llvm::Function * function,
-                       GetFunction(invoke->to_apply()));
-
   llvm::Value* output_buffer = node_context.GetOutputPtr(0);
   std::vector<llvm::Value*> operand_ptrs;
   for (int64_t i = 0; i < invoke->operand_count(); ++i) {
     operand_ptrs.push_back(node_context.GetOperandPtr(i));
   }
+
+  // Foreign functions with a native model call the model rather than the
+  // code compiled from their IR body.
+  if (invoke->to_apply()->ForeignFunctionData().has_value()) {
+    std::shared_ptr<const ForeignFunctionModel> model =
+        GetForeignFunctionModelRegistry().Find(invoke->to_apply()->name());
+    if (model != nullptr && model->native != nullptr) {
+      llvm::Type* ptr_type = llvm::PointerType::get(ctx(), 0);
+      llvm::ArrayType* args_type =
+          llvm::ArrayType::get(ptr_type, operand_ptrs.size());
+      llvm::Value* args = b.CreateAlloca(args_type);
+      for (int64_t i = 0; i < operand_ptrs.size(); ++i) {
+        b.CreateStore(operand_ptrs[i],
+                      b.CreateConstGEP2_64(args_type, args, 0, i));
+      }
+      llvm::Value* context = b.CreateIntToPtr(
+          b.getInt64(absl::bit_cast<uint64_t>(model->context)), ptr_type);
+      llvm::FunctionType* fn_type = llvm::FunctionType::get(
+          llvm::Type::getVoidTy(ctx()), {ptr_type, ptr_type, ptr_type},
+          /*isVarArg=*/false);
+      llvm::Value* fn_ptr = b.CreateIntToPtr(
+          b.getInt64(absl::bit_cast<uint64_t>(model->native)),
+          llvm::PointerType::get(fn_type, 0));
+      b.CreateCall(fn_type, fn_ptr, {args, output_buffer, context});
+      return FinalizeNodeIrContextWithPointerToValue(std::move(node_context),
+                                                     output_buffer);
+    }
+  }
+
+  // Standard library floating-point routines may be lowered to native
+  // floating-point instructions, falling back to the IR body for operands on
+  // which the results could differ.
+  std::optional<NativeFloatRoutine> float_routine;
+  if (absl::GetFlag(FLAGS_xls_jit_native_float)) {
+    float_routine = MatchNativeFloatRoutine(invoke->to_apply());
+  }
+  if (float_routine.has_value()) {
+    llvm::Value* use_ir_body = EmitNativeFloatRoutine(
+        *float_routine, invoke->GetType()->AsTupleOrDie(), operand_ptrs,
+        output_buffer, type_converter(), b);
+    if (use_ir_body == nullptr) {
+      return FinalizeNodeIrContextWithPointerToValue(std::move(node_context),
+                                                     output_buffer);
+    }
+    LlvmIfThen if_then = CreateIfThen(use_ir_body, b, "native_float_fallback");
+    XLS_ASSIGN_OR_RETURN(llvm::Function * function,
+                         GetFunction(invoke->to_apply()));
+    XLS_RETURN_IF_ERROR(CallFunction(function, operand_ptrs, {output_buffer},
+                                     node_context.GetTempBufferArg(),
+                                     node_context.GetInterpreterEventsArg(),
+                                     node_context.GetUserDataArg(),
+                                     node_context.GetJitRuntimeArg(),
+                                     *if_then.then_builder)
+                            .status());
+    if_then.Finalize();
+    return FinalizeNodeIrContextWithPointerToValue(
+        std::move(node_context), output_buffer, if_then.join_builder.get());
+  }
+
+  XLS_ASSIGN_OR_RETURN(llvm::Function * function,
+                       GetFunction(invoke->to_apply()));
   XLS_RETURN_IF_ERROR(CallFunction(function, operand_ptrs, {output_buffer},
                                    node_context.GetTempBufferArg(),
                                    node_context.GetInterpreterEventsArg(),
@@ -1990,6 +2027,9 @@ absl::Status IrBuilderVisitor::HandleMap(Map* map) {
 }
 
 absl::Status IrBuilderVisitor::HandleSMul(ArithOp* mul) {
+  if (UseWideIntegerKernel(mul)) {
+    return HandleWithWideIntegerKernel(mul, &WideSMul);
+  }
   return HandleBinaryOpWithOperandConversion(
       mul,
       [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
@@ -1999,6 +2039,9 @@ absl::Status IrBuilderVisitor::HandleSMul(ArithOp* mul) {
 }
 
 absl::Status IrBuilderVisitor::HandleUMul(ArithOp* mul) {
+  if (UseWideIntegerKernel(mul)) {
+    return HandleWithWideIntegerKernel(mul, &WideUMul);
+  }
   return HandleBinaryOpWithOperandConversion(
       mul,
       [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
@@ -2408,6 +2451,9 @@ absl::Status IrBuilderVisitor::HandleReverse(UnOp* reverse) {
 }
 
 absl::Status IrBuilderVisitor::HandleSDiv(BinOp* binop) {
+  if (UseWideIntegerKernel(binop)) {
+    return HandleWithWideIntegerKernel(binop, &WideSDiv);
+  }
   return HandleBinaryOp(
       binop,
       [&](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
@@ -2418,6 +2464,9 @@ absl::Status IrBuilderVisitor::HandleSDiv(BinOp* binop) {
 }
 
 absl::Status IrBuilderVisitor::HandleSMod(BinOp* binop) {
+  if (UseWideIntegerKernel(binop)) {
+    return HandleWithWideIntegerKernel(binop, &WideSMod);
+  }
   return HandleBinaryOp(
       binop,
       [&](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
@@ -2507,6 +2556,9 @@ absl::Status IrBuilderVisitor::HandleSLt(CompareOp* lt) {
 }
 
 absl::Status IrBuilderVisitor::HandleShll(BinOp* binop) {
+  if (UseWideIntegerKernel(binop)) {
+    return HandleWithWideIntegerKernel(binop, &WideShll);
+  }
   return HandleBinaryOp(
       binop, [&](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
         return EmitShiftOp(binop, lhs, rhs, &b, type_converter());
@@ -2514,6 +2566,9 @@ absl::Status IrBuilderVisitor::HandleShll(BinOp* binop) {
 }
 
 absl::Status IrBuilderVisitor::HandleShra(BinOp* binop) {
+  if (UseWideIntegerKernel(binop)) {
+    return HandleWithWideIntegerKernel(binop, &WideShra);
+  }
   return HandleBinaryOp(
       binop, [&](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
         // Only the LHS is treated as a signed number.
@@ -2525,6 +2580,9 @@ absl::Status IrBuilderVisitor::HandleShra(BinOp* binop) {
 }
 
 absl::Status IrBuilderVisitor::HandleShrl(BinOp* binop) {
+  if (UseWideIntegerKernel(binop)) {
+    return HandleWithWideIntegerKernel(binop, &WideShrl);
+  }
   return HandleBinaryOp(
       binop, [&](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
         return EmitShiftOp(binop, lhs, rhs, &b, type_converter());
@@ -2580,6 +2638,9 @@ absl::Status IrBuilderVisitor::HandleTupleIndex(TupleIndex* index) {
 }
 
 absl::Status IrBuilderVisitor::HandleUDiv(BinOp* binop) {
+  if (UseWideIntegerKernel(binop)) {
+    return HandleWithWideIntegerKernel(binop, &WideUDiv);
+  }
   return HandleBinaryOp(
       binop, [&](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
         return EmitDiv(lhs, rhs, binop->BitCountOrDie(), /*is_signed=*/false,
@@ -2588,6 +2649,9 @@ absl::Status IrBuilderVisitor::HandleUDiv(BinOp* binop) {
 }
 
 absl::Status IrBuilderVisitor::HandleUMod(BinOp* binop) {
+  if (UseWideIntegerKernel(binop)) {
+    return HandleWithWideIntegerKernel(binop, &WideUMod);
+  }
   return HandleBinaryOp(
       binop, [&](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
         return EmitMod(lhs, rhs, /*is_signed=*/false, &b);
@@ -2715,6 +2779,60 @@ absl::Status IrBuilderVisitor::HandleBinaryOpWithOperandConversion(
       });
 }
 
+bool IrBuilderVisitor::UseWideIntegerKernel(Node* node) {
+  // The kernels are called through host addresses embedded in the generated
+  // code which are not valid in other processes.
+  if (!absl::GetFlag(FLAGS_xls_jit_wide_integer_kernels) ||
+      jit_context_.orc_jit().emit_object_code()) {
+    return false;
+  }
+  int64_t bit_count = node->BitCountOrDie();
+  for (Node* operand : node->operands()) {
+    bit_count = std::max(bit_count, operand->BitCountOrDie());
+  }
+  return bit_count >= kMinWideIntegerKernelBitCount;
+}
+
+absl::Status IrBuilderVisitor::HandleWithWideIntegerKernel(
+    Node* node, WideIntegerKernel kernel) {
+  XLS_RET_CHECK_EQ(node->operand_count(), 2);
+  XLS_ASSIGN_OR_RETURN(NodeIrContext node_context,
+                       NewNodeIrContext(node, {"lhs", "rhs"}));
+  llvm::IRBuilder<>& b = node_context.entry_builder();
+
+  // The kernel operates directly on the operand and output buffers.
+  llvm::Value* lhs_ptr = node_context.GetOperandPtr(0);
+  llvm::Value* rhs_ptr = node_context.GetOperandPtr(1);
+  llvm::Value* result_ptr =
+      node_context.GetOutputPtrs().empty()
+          ? b.CreateAlloca(type_converter()->ConvertToLlvmType(node->GetType()))
+          : node_context.GetOutputPtr(0);
+
+  llvm::IntegerType* i64_type = b.getInt64Ty();
+  std::vector<llvm::Type*> params = {lhs_ptr->getType(),    i64_type,
+                                     rhs_ptr->getType(),    i64_type,
+                                     result_ptr->getType(), i64_type,
+                                     i64_type};
+  llvm::FunctionType* fn_type = llvm::FunctionType::get(
+      llvm::Type::getVoidTy(ctx()), params, /*isVarArg=*/false);
+  std::vector<llvm::Value*> args = {
+      lhs_ptr,
+      b.getInt64(node->operand(0)->BitCountOrDie()),
+      rhs_ptr,
+      b.getInt64(node->operand(1)->BitCountOrDie()),
+      result_ptr,
+      b.getInt64(node->BitCountOrDie()),
+      b.getInt64(type_converter()->GetTypeByteSize(node->GetType()))};
+
+  llvm::ConstantInt* fn_addr =
+      llvm::ConstantInt::get(i64_type, absl::bit_cast<uint64_t>(kernel));
+  llvm::Value* fn_ptr =
+      b.CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
+  b.CreateCall(fn_type, fn_ptr, args);
+  return FinalizeNodeIrContextWithPointerToValue(std::move(node_context),
+                                                 result_ptr);
+}
+
 absl::StatusOr<NodeIrContext> IrBuilderVisitor::NewNodeIrContext(
     Node* node, absl::Span<const std::string> operand_names,
     bool include_wrapper_args) {
@@ -2787,13 +2905,136 @@ absl::StatusOr<llvm::Value*> IrBuilderVisitor::CallFunction(
   return builder.CreateCall(f, args);
 }
 
+absl::StatusOr<JitChannelQueue*> IrBuilderVisitor::GetChannelQueue(
+    Node* node, int64_t channel_id) {
+  if (jit_context_.channel_hook_indices().has_value()) {
+    return nullptr;
+  }
+  XLS_RET_CHECK(jit_context_.queue_manager().has_value());
+  XLS_ASSIGN_OR_RETURN(Channel * channel,
+                       node->package()->GetChannel(channel_id));
+  return &jit_context_.queue_manager().value()->GetJitQueue(channel);
+}
+
+absl::StatusOr<llvm::Value*> IrBuilderVisitor::CallChannelHook(
+    llvm::IRBuilder<>* builder, int64_t channel_id, bool is_send,
+    llvm::Value* data_ptr, llvm::Value* user_data) {
+  auto it = jit_context_.channel_hook_indices()->find(channel_id);
+  XLS_RET_CHECK(it != jit_context_.channel_hook_indices()->end())
+      << "No channel hook for channel " << channel_id;
+  llvm::Type* ptr_type = llvm::PointerType::get(ctx(), 0);
+  // Loads the field at `offset` of this channel's entry in the hook table.
+  auto load_field = [&](size_t offset) {
+    int64_t index = it->second;
+    return builder->CreateLoad(
+        ptr_type,
+        builder->CreateGEP(
+            builder->getInt8Ty(), user_data,
+            builder->getInt64(index * sizeof(aot_compile::AotChannelHook) +
+                              offset)));
+  };
+  llvm::Value* queue = load_field(offsetof(aot_compile::AotChannelHook, queue));
+  llvm::FunctionType* fn_type = llvm::FunctionType::get(
+      is_send ? llvm::Type::getVoidTy(ctx()) : llvm::Type::getInt1Ty(ctx()),
+      {ptr_type, ptr_type}, /*isVarArg=*/false);
+  llvm::Value* fn_ptr =
+      load_field(is_send ? offsetof(aot_compile::AotChannelHook, send)
+                         : offsetof(aot_compile::AotChannelHook, receive));
+  return builder->CreateCall(fn_type, fn_ptr, {queue, data_ptr});
+}
+
 bool QueueReceiveWrapper(JitChannelQueue* queue, uint8_t* buffer) {
   return queue->ReadRaw(buffer);
 }
 
+// Returns a pointer to the field at `offset` of the ByteQueue::State at
+// `state`.
+llvm::Value* ByteQueueStateField(llvm::Value* state, size_t offset,
+                                 llvm::IRBuilder<>* builder) {
+  return builder->CreateGEP(builder->getInt8Ty(), state,
+                            builder->getInt64(offset));
+}
+
+// Advances the index of the byte queue at `index_ptr` by one element, wrapping
+// around at the end of the circular buffer.
+void AdvanceByteQueueIndex(ByteQueue* byte_queue, llvm::Value* state,
+                           llvm::Value* index_ptr,
+                           llvm::IRBuilder<>* builder) {
+  llvm::Type* i64 = builder->getInt64Ty();
+  llvm::Value* max_byte_count = builder->CreateLoad(
+      i64, ByteQueueStateField(
+               state, offsetof(ByteQueue::State, max_byte_count), builder));
+  llvm::Value* next_index = builder->CreateAdd(
+      builder->CreateLoad(i64, index_ptr),
+      builder->getInt64(byte_queue->allocated_element_size()));
+  builder->CreateStore(
+      builder->CreateSelect(builder->CreateICmpEQ(next_index, max_byte_count),
+                            builder->getInt64(0), next_index),
+      index_ptr);
+}
+
+// Emits code which reads an element from `byte_queue` into `output_ptr` as
+// ByteQueue::Read does. Leaves `builder` at the end of the emitted code and
+// returns an i1 value indicating whether an element was read.
+llvm::Value* ReadInlineQueue(ByteQueue* byte_queue, llvm::Value* output_ptr,
+                             std::string_view name,
+                             llvm::IRBuilder<>* builder) {
+  llvm::LLVMContext& context = builder->getContext();
+  llvm::Function* function = builder->GetInsertBlock()->getParent();
+  llvm::Type* i64 = builder->getInt64Ty();
+  llvm::Value* state = builder->CreateIntToPtr(
+      builder->getInt64(absl::bit_cast<uint64_t>(byte_queue->state())),
+      llvm::PointerType::get(context, 0));
+  llvm::Value* bytes_used_ptr = ByteQueueStateField(
+      state, offsetof(ByteQueue::State, bytes_used), builder);
+  llvm::Value* bytes_used = builder->CreateLoad(i64, bytes_used_ptr);
+
+  llvm::BasicBlock* entry_block = builder->GetInsertBlock();
+  llvm::BasicBlock* read_block = llvm::BasicBlock::Create(
+      context, absl::StrCat(name, "_read"), function);
+  llvm::BasicBlock* done_block = llvm::BasicBlock::Create(
+      context, absl::StrCat(name, "_read_done"), function);
+  builder->CreateCondBr(
+      builder->CreateICmpNE(bytes_used, builder->getInt64(0)), read_block,
+      done_block);
+
+  builder->SetInsertPoint(read_block);
+  llvm::Value* buffer = builder->CreateLoad(
+      llvm::PointerType::get(context, 0),
+      ByteQueueStateField(state, offsetof(ByteQueue::State, buffer), builder));
+  llvm::Value* read_index_ptr = ByteQueueStateField(
+      state, offsetof(ByteQueue::State, read_index), builder);
+  llvm::Value* element = builder->CreateGEP(
+      builder->getInt8Ty(), buffer, builder->CreateLoad(i64, read_index_ptr));
+  LlvmMemcpy(output_ptr, element, byte_queue->element_size(), *builder);
+  if (!byte_queue->is_single_value()) {
+    // Reads are destructive for non single-value channels.
+    builder->CreateStore(
+        builder->CreateSub(
+            bytes_used,
+            builder->getInt64(byte_queue->allocated_element_size())),
+        bytes_used_ptr);
+    AdvanceByteQueueIndex(byte_queue, state, read_index_ptr, builder);
+  }
+  builder->CreateBr(done_block);
+
+  builder->SetInsertPoint(done_block);
+  llvm::PHINode* read = builder->CreatePHI(builder->getInt1Ty(), 2);
+  read->addIncoming(builder->getFalse(), entry_block);
+  read->addIncoming(builder->getTrue(), read_block);
+  return read;
+}
+
 absl::StatusOr<llvm::Value*> IrBuilderVisitor::ReceiveFromQueue(
     llvm::IRBuilder<>* builder, JitChannelQueue* queue, Receive* receive,
     llvm::Value* output_ptr, llvm::Value* user_data) {
+  if (queue == nullptr) {
+    return CallChannelHook(builder, receive->channel_id(), /*is_send=*/false,
+                           output_ptr, user_data);
+  }
+  if (ByteQueue* byte_queue = queue->InlineQueue(); byte_queue != nullptr) {
+    return ReadInlineQueue(byte_queue, output_ptr, receive->GetName(), builder);
+  }
   llvm::Type* bool_type = llvm::Type::getInt1Ty(ctx());
   llvm::Type* ptr_type = llvm::PointerType::get(ctx(), 0);
 
@@ -2828,11 +3069,8 @@ absl::Status IrBuilderVisitor::HandleReceive(Receive* recv) {
                                         /*include_wrapper_args=*/true));
   llvm::Value* user_data = node_context.GetUserDataArg();
 
-  XLS_RET_CHECK(jit_context_.queue_manager().has_value());
-  XLS_ASSIGN_OR_RETURN(Channel * channel,
-                       recv->package()->GetChannel(recv->channel_id()));
-  JitChannelQueue& queue =
-      jit_context_.queue_manager().value()->GetJitQueue(channel);
+  XLS_ASSIGN_OR_RETURN(JitChannelQueue * queue,
+                       GetChannelQueue(recv, recv->channel_id()));
 
   llvm::Value* output_buffer = node_context.GetOutputPtr(0);
   // The data buffer is element 1 of the output tuple.
@@ -2859,7 +3097,7 @@ absl::Status IrBuilderVisitor::HandleReceive(Receive* recv) {
     llvm::IRBuilder<> true_builder(true_block);
     XLS_ASSIGN_OR_RETURN(
         llvm::Value * true_receive_fired,
-        ReceiveFromQueue(&true_builder, &queue, recv, data_buffer, user_data));
+        ReceiveFromQueue(&true_builder, queue, recv, data_buffer, user_data));
     true_builder.CreateBr(join_block);
 
     // And the same for a false predicate - this will store a zero
@@ -2883,7 +3121,8 @@ absl::Status IrBuilderVisitor::HandleReceive(Receive* recv) {
 
     llvm::PHINode* receive_fired = join_builder.CreatePHI(
         llvm::Type::getInt1Ty(ctx()), /*NumReservedValues=*/2);
-    receive_fired->addIncoming(true_receive_fired, true_block);
+    receive_fired->addIncoming(true_receive_fired,
+                               true_builder.GetInsertBlock());
     receive_fired->addIncoming(llvm::ConstantInt::getFalse(ctx()), false_block);
     receive_fired->setName("receive_fired");
     if (!recv->is_blocking()) {
@@ -2904,7 +3143,7 @@ absl::Status IrBuilderVisitor::HandleReceive(Receive* recv) {
             : join_builder.getFalse());
   }
   XLS_ASSIGN_OR_RETURN(llvm::Value * receive_fired,
-                       ReceiveFromQueue(&node_context.entry_builder(), &queue,
+                       ReceiveFromQueue(&node_context.entry_builder(), queue,
                                         recv, data_buffer, user_data));
   receive_fired->setName("receive_fired");
   if (!recv->is_blocking()) {
@@ -2930,10 +3169,81 @@ void QueueSendWrapper(JitChannelQueue* queue, const uint8_t* data) {
   queue->WriteRaw(data);
 }
 
+// Emits code which writes the element at `data_ptr` to `byte_queue` as
+// ByteQueue::Write does. Only when the circular buffer is full does it call
+// `write_slow_path`, which emits a call to ByteQueue::Write to grow the
+// buffer. Leaves `builder` at the end of the emitted code.
+void WriteInlineQueue(
+    ByteQueue* byte_queue, llvm::Value* data_ptr, std::string_view name,
+    llvm::IRBuilder<>* builder,
+    const std::function<void(llvm::IRBuilder<>*)>& write_slow_path) {
+  llvm::LLVMContext& context = builder->getContext();
+  llvm::Function* function = builder->GetInsertBlock()->getParent();
+  llvm::Type* i64 = builder->getInt64Ty();
+  llvm::Value* state = builder->CreateIntToPtr(
+      builder->getInt64(absl::bit_cast<uint64_t>(byte_queue->state())),
+      llvm::PointerType::get(context, 0));
+  llvm::Value* bytes_used_ptr = ByteQueueStateField(
+      state, offsetof(ByteQueue::State, bytes_used), builder);
+  llvm::Value* write_index_ptr = ByteQueueStateField(
+      state, offsetof(ByteQueue::State, write_index), builder);
+  auto write_element = [&]() {
+    llvm::Value* buffer = builder->CreateLoad(
+        llvm::PointerType::get(context, 0),
+        ByteQueueStateField(state, offsetof(ByteQueue::State, buffer),
+                            builder));
+    llvm::Value* element = builder->CreateGEP(
+        builder->getInt8Ty(), buffer,
+        builder->CreateLoad(i64, write_index_ptr));
+    LlvmMemcpy(element, data_ptr, byte_queue->element_size(), *builder);
+  };
+  if (byte_queue->is_single_value()) {
+    // The single value is overwritten in place.
+    write_element();
+    builder->CreateStore(
+        builder->getInt64(byte_queue->allocated_element_size()),
+        bytes_used_ptr);
+    return;
+  }
+
+  llvm::BasicBlock* write_block = llvm::BasicBlock::Create(
+      context, absl::StrCat(name, "_write"), function);
+  llvm::BasicBlock* full_block = llvm::BasicBlock::Create(
+      context, absl::StrCat(name, "_full"), function);
+  llvm::BasicBlock* done_block = llvm::BasicBlock::Create(
+      context, absl::StrCat(name, "_write_done"), function);
+  llvm::Value* bytes_used = builder->CreateLoad(i64, bytes_used_ptr);
+  llvm::Value* max_byte_count = builder->CreateLoad(
+      i64, ByteQueueStateField(
+               state, offsetof(ByteQueue::State, max_byte_count), builder));
+  builder->CreateCondBr(builder->CreateICmpEQ(bytes_used, max_byte_count),
+                        full_block, write_block);
+
+  builder->SetInsertPoint(full_block);
+  write_slow_path(builder);
+  builder->CreateBr(done_block);
+
+  builder->SetInsertPoint(write_block);
+  write_element();
+  builder->CreateStore(
+      builder->CreateAdd(
+          bytes_used, builder->getInt64(byte_queue->allocated_element_size())),
+      bytes_used_ptr);
+  AdvanceByteQueueIndex(byte_queue, state, write_index_ptr, builder);
+  builder->CreateBr(done_block);
+
+  builder->SetInsertPoint(done_block);
+}
+
 absl::Status IrBuilderVisitor::SendToQueue(llvm::IRBuilder<>* builder,
                                            JitChannelQueue* queue, Send* send,
                                            llvm::Value* send_data_ptr,
                                            llvm::Value* user_data) {
+  if (queue == nullptr) {
+    return CallChannelHook(builder, send->channel_id(), /*is_send=*/true,
+                           send_data_ptr, user_data)
+        .status();
+  }
   llvm::Type* void_type = llvm::Type::getVoidTy(ctx());
   llvm::Type* ptr_type = llvm::PointerType::get(ctx(), 0);
 
@@ -2943,17 +3253,25 @@ absl::Status IrBuilderVisitor::SendToQueue(llvm::IRBuilder<>* builder,
   llvm::FunctionType* fn_type =
       llvm::FunctionType::get(void_type, params, /*isVarArg=*/false);
 
-  llvm::Value* queue_address = llvm::ConstantInt::get(
-      llvm::Type::getInt64Ty(ctx()), absl::bit_cast<uint64_t>(queue));
-  std::vector<llvm::Value*> args = {
-      builder->CreateIntToPtr(queue_address, ptr_type), send_data_ptr};
-
-  llvm::ConstantInt* fn_addr =
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx()),
-                             absl::bit_cast<uint64_t>(&QueueSendWrapper));
-  llvm::Value* fn_ptr =
-      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
-  builder->CreateCall(fn_type, fn_ptr, args);
+  auto call_send_wrapper = [&](llvm::IRBuilder<>* b) {
+    llvm::Value* queue_address = llvm::ConstantInt::get(
+        llvm::Type::getInt64Ty(ctx()), absl::bit_cast<uint64_t>(queue));
+    std::vector<llvm::Value*> args = {
+        b->CreateIntToPtr(queue_address, ptr_type), send_data_ptr};
+
+    llvm::ConstantInt* fn_addr =
+        llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx()),
+                               absl::bit_cast<uint64_t>(&QueueSendWrapper));
+    llvm::Value* fn_ptr =
+        b->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
+    b->CreateCall(fn_type, fn_ptr, args);
+  };
+  if (ByteQueue* byte_queue = queue->InlineQueue(); byte_queue != nullptr) {
+    WriteInlineQueue(byte_queue, send_data_ptr, send->GetName(), builder,
+                     call_send_wrapper);
+  } else {
+    call_send_wrapper(builder);
+  }
   return absl::OkStatus();
 }
 
@@ -2969,11 +3287,8 @@ absl::Status IrBuilderVisitor::HandleSend(Send* send) {
   llvm::Value* data_ptr = node_context.GetOperandPtr(1);
   llvm::Value* user_data = node_context.GetUserDataArg();
 
-  XLS_RET_CHECK(jit_context_.queue_manager().has_value());
-  XLS_ASSIGN_OR_RETURN(Channel * channel,
-                       send->package()->GetChannel(send->channel_id()));
-  JitChannelQueue& queue =
-      jit_context_.queue_manager().value()->GetJitQueue(channel);
+  XLS_ASSIGN_OR_RETURN(JitChannelQueue * queue,
+                       GetChannelQueue(send, send->channel_id()));
   if (send->predicate().has_value()) {
     llvm::Value* predicate = node_context.LoadOperand(2);
 
@@ -2987,7 +3302,7 @@ absl::Status IrBuilderVisitor::HandleSend(Send* send) {
                                  node_context.llvm_function(), join_block);
     llvm::IRBuilder<> true_builder(true_block);
     XLS_RETURN_IF_ERROR(
-        SendToQueue(&true_builder, &queue, send, data_ptr, user_data));
+        SendToQueue(&true_builder, queue, send, data_ptr, user_data));
     true_builder.CreateBr(join_block);
 
     llvm::BasicBlock* false_block =
@@ -3008,7 +3323,7 @@ absl::Status IrBuilderVisitor::HandleSend(Send* send) {
                                           /*return_value=*/predicate);
   }
   // Unconditional send.
-  XLS_RETURN_IF_ERROR(SendToQueue(&b, &queue, send, data_ptr, user_data));
+  XLS_RETURN_IF_ERROR(SendToQueue(&b, queue, send, data_ptr, user_data));
 
   // The node function should return true if data was sent. This will trigger
   // an early exit from the top-level function.
@@ -14,15 +14,18 @@
 #ifndef XLS_JIT_IR_BUILDER_VISITOR_H_
 #define XLS_JIT_IR_BUILDER_VISITOR_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "llvm/include/llvm/IR/Function.h"
 #include "xls/ir/node.h"
 #include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/jit/orc_jit.h"
 
 namespace xls {
@@ -36,14 +39,18 @@ bool ShouldMaterializeAtUse(Node* node);
 // etc.
 class JitBuilderContext {
  public:
+  // If `profile` is given the jitted code is instrumented to record execution
+  // counts and cycles into counters of the profile.
   explicit JitBuilderContext(
       OrcJit& orc_jit,
-      std::optional<JitChannelQueueManager*> queue_mgr = std::nullopt)
+      std::optional<JitChannelQueueManager*> queue_mgr = std::nullopt,
+      JitProfile* profile = nullptr)
       : module_(orc_jit.NewModule("__module")),
         orc_jit_(orc_jit),
         type_converter_(orc_jit.GetContext(),
                         orc_jit.CreateDataLayout().value()),
-        queue_manager_(queue_mgr) {}
+        queue_manager_(queue_mgr),
+        profile_(profile) {}
 
   llvm::Module* module() const { return module_.get(); }
   llvm::LLVMContext& context() const { return module_->getContext(); }
@@ -68,11 +75,31 @@ class JitBuilderContext {
     return queue_manager_;
   }
 
+  // Makes sends and receives call through the table of
+  // aot_compile::AotChannelHooks passed as the `user_data` argument of the
+  // jitted function instead of accessing the queues of the queue manager. The
+  // code then embeds no queue addresses and can be compiled ahead of time.
+  // `channel_hook_indices` maps channel ids to indices in the table.
+  void UseChannelHooks(
+      absl::flat_hash_map<int64_t, int64_t> channel_hook_indices) {
+    channel_hook_indices_ = std::move(channel_hook_indices);
+  }
+  const std::optional<absl::flat_hash_map<int64_t, int64_t>>&
+  channel_hook_indices() const {
+    return channel_hook_indices_;
+  }
+
+  // The profile into which instrumented code records counters, or nullptr if
+  // the code is not instrumented.
+  JitProfile* profile() const { return profile_; }
+
  private:
   std::unique_ptr<llvm::Module> module_;
   OrcJit& orc_jit_;
   LlvmTypeConverter type_converter_;
   std::optional<JitChannelQueueManager*> queue_manager_;
+  std::optional<absl::flat_hash_map<int64_t, int64_t>> channel_hook_indices_;
+  JitProfile* profile_;
 
   // Map from FunctionBase to the associated JITed llvm::Function.
   absl::flat_hash_map<FunctionBase*, llvm::Function*> llvm_functions_;
@@ -0,0 +1,294 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks JIT compile time and execution throughput of IR packages at each
+// LLVM optimization level and emits the results as JSON (see
+// jit_benchmark.proto) suitable for diffing between releases.
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "google/protobuf/util/json_util.h"
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/resource_usage.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_benchmark.pb.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/proc_jit.h"
+
+const char kUsage[] = R"(
+Measures JIT compile time, peak memory, and execution throughput (calls per
+second for functions, ticks per second for proc networks) of each given IR
+file at each of the given LLVM optimization levels. Results are emitted as
+JSON.
+
+Expected invocation:
+  jit_benchmark_main <IR file> [<IR file>...]
+
+Example invocation:
+  jit_benchmark_main --opt_levels=1,3 --output_json=/tmp/results.json \
+    path/to/a.opt.ir path/to/b.opt.ir
+)";
+
+ABSL_FLAG(std::vector<std::string>, opt_levels,
+          std::vector<std::string>({"0", "1", "2", "3"}),
+          "Comma-separated list of LLVM optimization levels to benchmark.");
+ABSL_FLAG(int64_t, run_duration_ms, 500,
+          "Approximate time in milliseconds to run each benchmark entry when "
+          "measuring throughput.");
+ABSL_FLAG(std::string, output_json, "",
+          "Path of the file to write the JSON results to. If empty the "
+          "results are written to stdout.");
+
+namespace xls {
+namespace {
+
+double ToMs(absl::Duration duration) {
+  return absl::ToDoubleMilliseconds(duration);
+}
+
+// Invokes `f` until (approximately) `duration_ms` milliseconds have passed and
+// returns the number of calls per second. The call count is first estimated
+// over a tenth of the duration so the measured loop does not call
+// absl::Now().
+absl::StatusOr<double> MeasureRate(const std::function<absl::Status()>& f,
+                                   int64_t duration_ms) {
+  int64_t call_count = 0;
+  absl::Time start_estimate = absl::Now();
+  while (ToMs(absl::Now() - start_estimate) < duration_ms / 10.0) {
+    XLS_RETURN_IF_ERROR(f());
+    ++call_count;
+  }
+  absl::Time start = absl::Now();
+  for (int64_t i = 0; i < call_count * 10; ++i) {
+    XLS_RETURN_IF_ERROR(f());
+  }
+  double elapsed_s = absl::ToDoubleSeconds(absl::Now() - start);
+  return elapsed_s == 0.0 ? 0.0 : (call_count * 10) / elapsed_s;
+}
+
+absl::Status BenchmarkFunction(Function* function, int64_t opt_level,
+                               JitBenchmarkResultProto& result) {
+  result.set_top(function->name());
+  result.set_is_proc_network(false);
+
+  absl::Time start = absl::Now();
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
+                       FunctionJit::Create(function, opt_level));
+  result.set_compile_time_ms(ToMs(absl::Now() - start));
+
+  // Preconvert a set of random arguments so the measurement isn't dominated
+  // by conversion of Values to the native layout.
+  constexpr int64_t kInputCount = 100;
+  std::minstd_rand bitgen;
+  std::vector<std::vector<std::vector<uint8_t>>> arg_buffers(kInputCount);
+  std::vector<std::vector<uint8_t*>> arg_pointers(kInputCount);
+  for (int64_t i = 0; i < kInputCount; ++i) {
+    std::vector<Value> args;
+    for (Param* param : function->params()) {
+      args.push_back(RandomValue(param->GetType(), &bitgen));
+      arg_buffers[i].push_back(
+          std::vector<uint8_t>(jit->GetArgTypeSize(args.size() - 1)));
+    }
+    for (std::vector<uint8_t>& buffer : arg_buffers[i]) {
+      arg_pointers[i].push_back(buffer.data());
+    }
+    XLS_RETURN_IF_ERROR(jit->runtime()->PackArgs(
+        args, function->GetType()->parameters(), arg_pointers[i]));
+  }
+
+  std::vector<uint8_t> result_buffer(jit->GetReturnTypeSize());
+  InterpreterEvents events;
+  XLS_ASSIGN_OR_RETURN(
+      double rate,
+      MeasureRate(
+          [&]() -> absl::Status {
+            for (absl::Span<uint8_t* const> pointers : arg_pointers) {
+              XLS_RETURN_IF_ERROR(jit->RunWithViews(
+                  pointers, absl::MakeSpan(result_buffer), &events));
+            }
+            events.Clear();
+            return absl::OkStatus();
+          },
+          absl::GetFlag(FLAGS_run_duration_ms)));
+  result.set_calls_per_second(rate * kInputCount);
+  return absl::OkStatus();
+}
+
+// Benchmarks all procs of `package` ticked together by a SerialProcRuntime.
+// Input channels are fed random values and output channels are drained after
+// every tick.
+absl::Status BenchmarkProcNetwork(Package* package, int64_t opt_level,
+                                  JitBenchmarkResultProto& result) {
+  XLS_ASSIGN_OR_RETURN(Proc * top, package->GetTopAsProc());
+  result.set_top(top->name());
+  result.set_is_proc_network(true);
+
+  absl::Time start = absl::Now();
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitChannelQueueManager> queue_manager,
+                       JitChannelQueueManager::CreateThreadSafe(package));
+  std::vector<std::unique_ptr<ProcEvaluator>> proc_jits;
+  for (const std::unique_ptr<Proc>& proc : package->procs()) {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<ProcJit> proc_jit,
+        ProcJit::Create(proc.get(), &queue_manager->runtime(),
+                        queue_manager.get(), /*profile=*/nullptr, opt_level));
+    proc_jits.push_back(std::move(proc_jit));
+  }
+  result.set_compile_time_ms(ToMs(absl::Now() - start));
+
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> runtime,
+                       SerialProcRuntime::Create(package, std::move(proc_jits),
+                                                 std::move(queue_manager)));
+  XLS_ASSIGN_OR_RETURN(JitChannelQueueManager * jit_queue_manager,
+                       runtime->GetJitChannelQueueManager());
+
+  std::minstd_rand bitgen;
+  std::vector<JitChannelQueue*> output_queues;
+  for (Channel* channel : package->channels()) {
+    JitChannelQueue& queue = jit_queue_manager->GetJitQueue(channel);
+    for (const Value& value : channel->initial_values()) {
+      XLS_RETURN_IF_ERROR(queue.Write(value));
+    }
+    if (channel->supported_ops() == ChannelOps::kReceiveOnly) {
+      XLS_RETURN_IF_ERROR(queue.AttachGenerator(
+          [channel, &bitgen]() -> std::optional<Value> {
+            return RandomValue(channel->type(), &bitgen);
+          }));
+    } else if (channel->supported_ops() == ChannelOps::kSendOnly) {
+      output_queues.push_back(&queue);
+    }
+  }
+
+  std::vector<uint8_t> drain_buffer;
+  for (JitChannelQueue* queue : output_queues) {
+    drain_buffer.resize(std::max<int64_t>(drain_buffer.size(),
+                                          queue->raw_element_size()));
+  }
+  XLS_ASSIGN_OR_RETURN(double rate,
+                       MeasureRate(
+                           [&]() -> absl::Status {
+                             XLS_RETURN_IF_ERROR(runtime->Tick());
+                             for (JitChannelQueue* queue : output_queues) {
+                               while (queue->ReadRaw(drain_buffer.data())) {
+                               }
+                             }
+                             runtime->ClearInterpreterEvents();
+                             return absl::OkStatus();
+                           },
+                           absl::GetFlag(FLAGS_run_duration_ms)));
+  result.set_ticks_per_second(rate);
+  return absl::OkStatus();
+}
+
+absl::Status BenchmarkPackage(Package* package, int64_t opt_level,
+                              JitBenchmarkResultProto& result) {
+  if (!package->procs().empty()) {
+    return BenchmarkProcNetwork(package, opt_level, result);
+  }
+  XLS_ASSIGN_OR_RETURN(Function * function, package->GetTopAsFunction());
+  return BenchmarkFunction(function, opt_level, result);
+}
+
+absl::Status RealMain(absl::Span<const std::string_view> ir_paths) {
+  std::vector<int64_t> opt_levels;
+  for (const std::string& level : absl::GetFlag(FLAGS_opt_levels)) {
+    int64_t opt_level;
+    if (!absl::SimpleAtoi(level, &opt_level) || opt_level < 0 ||
+        opt_level > 3) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid optimization level: `%s`", level));
+    }
+    opt_levels.push_back(opt_level);
+  }
+
+  JitBenchmarkResultsProto results;
+  for (std::string_view ir_path : ir_paths) {
+    XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                         Parser::ParsePackage(ir_text, ir_path));
+    for (int64_t opt_level : opt_levels) {
+      JitBenchmarkResultProto* result = results.add_results();
+      result->set_ir_file(std::string{ir_path});
+      result->set_opt_level(opt_level);
+      absl::Status status = BenchmarkPackage(package.get(), opt_level, *result);
+      if (!status.ok()) {
+        XLS_LOG(WARNING) << "Benchmarking " << ir_path << " at opt level "
+                         << opt_level << " failed: " << status;
+        result->set_error(status.ToString());
+      }
+      result->set_peak_rss_bytes(PeakRssBytes());
+    }
+  }
+
+  std::string json;
+  google::protobuf::util::JsonPrintOptions print_options;
+  print_options.add_whitespace = true;
+  print_options.preserve_proto_field_names = true;
+  auto json_status = google::protobuf::util::MessageToJsonString(
+      results, &json, print_options);
+  XLS_RET_CHECK(json_status.ok()) << json_status.ToString();
+  if (absl::GetFlag(FLAGS_output_json).empty()) {
+    std::cout << json;
+    return absl::OkStatus();
+  }
+  return SetFileContents(absl::GetFlag(FLAGS_output_json), json);
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+
+  if (positional_arguments.empty()) {
+    XLS_LOG(QFATAL) << "Expected path arguments with IR: " << argv[0]
+                    << " <ir_path> [<ir_path>...]";
+  }
+  return xls::ExitStatus(xls::RealMain(positional_arguments));
+}
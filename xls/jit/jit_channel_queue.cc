@@ -22,25 +22,28 @@
 
 #include "absl/memory/memory.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/proc.h"
 
 namespace xls {
 namespace {
 
-void WriteValueOnQueue(const Value& value, Type* type, JitRuntime& runtime,
+void WriteValueOnQueue(const Value& value, const TypeLayout& type_layout,
                        ByteQueue& queue) {
   absl::InlinedVector<uint8_t, ByteQueue::kInitBufferSize> buffer(
       queue.element_size());
-  runtime.BlitValueToBuffer(value, type, absl::MakeSpan(buffer));
+  type_layout.ValueToNativeLayout(value, buffer.data());
   queue.Write(buffer.data());
 }
 
-std::optional<Value> ReadValueFromQueue(Type* type, JitRuntime& runtime,
+std::optional<Value> ReadValueFromQueue(const TypeLayout& type_layout,
                                         ByteQueue& queue) {
-  std::vector<uint8_t> buffer(queue.element_size());
+  absl::InlinedVector<uint8_t, ByteQueue::kInitBufferSize> buffer(
+      queue.element_size());
   if (!queue.Read(buffer.data())) {
     return std::nullopt;
   }
-  return runtime.UnpackBuffer(buffer.data(), type, /*unpoision=*/true);
+  return type_layout.NativeLayoutToValue(buffer.data());
 }
 
 }  // namespace
@@ -65,52 +68,301 @@ ByteQueue::ByteQueue(int64_t channel_element_size, bool is_single_value)
   } else {
     circular_buffer_.resize(kInitBufferSize);
   }
-  max_byte_count_ = FloorOfRatio(static_cast<int64_t>(circular_buffer_.size()),
-                                 allocated_element_size_) *
-                    allocated_element_size_;
+  state_.buffer = circular_buffer_.data();
+  state_.max_byte_count =
+      FloorOfRatio(static_cast<int64_t>(circular_buffer_.size()),
+                   allocated_element_size_) *
+      allocated_element_size_;
 }
 
 void ByteQueue::Resize() {
   circular_buffer_.resize(circular_buffer_.size() * 2);
-  max_byte_count_ = FloorOfRatio(static_cast<int64_t>(circular_buffer_.size()),
-                                 allocated_element_size_) *
-                    allocated_element_size_;
+  state_.buffer = circular_buffer_.data();
+  state_.max_byte_count =
+      FloorOfRatio(static_cast<int64_t>(circular_buffer_.size()),
+                   allocated_element_size_) *
+      allocated_element_size_;
   // The content of the circular buffer must be rearranged when the read
   // index is not at the beginning of the circular buffer to ensure correct
   // ordering.
-  if (read_index_ != 0) {
-    std::move(circular_buffer_.begin(), circular_buffer_.begin() + read_index_,
-              circular_buffer_.begin() + bytes_used_);
+  if (state_.read_index != 0) {
+    std::move(circular_buffer_.begin(),
+              circular_buffer_.begin() + state_.read_index,
+              circular_buffer_.begin() + state_.bytes_used);
   }
   // Realign the write index to the next available slot.
-  write_index_ = bytes_used_ + read_index_;
-  if (write_index_ == max_byte_count_) {
-    write_index_ = 0;
+  state_.write_index = state_.bytes_used + state_.read_index;
+  if (state_.write_index == state_.max_byte_count) {
+    state_.write_index = 0;
+  }
+}
+
+void ByteQueue::CopyContentsTo(std::vector<uint8_t>& contents) const {
+  int64_t index = state_.read_index;
+  for (int64_t i = 0; i < size(); ++i) {
+    const uint8_t* element = circular_buffer_.data() + index;
+    contents.insert(contents.end(), element, element + channel_element_size_);
+    index += allocated_element_size_;
+    if (index == state_.max_byte_count) {
+      index = 0;
+    }
+  }
+}
+
+void ByteQueue::Clear() {
+  state_.bytes_used = 0;
+  state_.read_index = 0;
+  state_.write_index = 0;
+}
+
+SpscByteQueue::SpscByteQueue(int64_t channel_element_size)
+    : channel_element_size_(channel_element_size),
+      allocated_element_size_(std::max(
+          RoundUpToNearest(channel_element_size,
+                           static_cast<int64_t>(alignof(std::max_align_t))),
+          int64_t{1})),
+      elements_per_segment_(std::max(
+          kSegmentByteSize / allocated_element_size_, int64_t{16})) {
+  write_segment_ = NewSegment();
+  read_segment_ = write_segment_;
+}
+
+SpscByteQueue::~SpscByteQueue() {
+  Segment* segment = read_segment_;
+  while (segment != nullptr) {
+    Segment* next = segment->next.load(std::memory_order_acquire);
+    delete segment;
+    segment = next;
+  }
+  delete spare_segment_.load(std::memory_order_acquire);
+}
+
+SpscByteQueue::Segment* SpscByteQueue::NewSegment() {
+  Segment* segment = new Segment;
+  segment->data = std::make_unique<uint8_t[]>(elements_per_segment_ *
+                                              allocated_element_size_);
+  return segment;
+}
+
+void SpscByteQueue::AdvanceWriteSegment() {
+  Segment* segment =
+      spare_segment_.exchange(nullptr, std::memory_order_acquire);
+  if (segment == nullptr) {
+    segment = NewSegment();
+  } else {
+    segment->committed.store(0, std::memory_order_relaxed);
+    segment->next.store(nullptr, std::memory_order_relaxed);
+  }
+  // Publishing the next segment tells the consumer the producer is done with
+  // the current one.
+  write_segment_->next.store(segment, std::memory_order_release);
+  write_segment_ = segment;
+  write_index_ = 0;
+}
+
+bool SpscByteQueue::AdvanceReadSegment() {
+  Segment* next = read_segment_->next.load(std::memory_order_acquire);
+  if (next == nullptr) {
+    return false;
+  }
+  // The producer has moved on from the drained segment. Offer it back for
+  // reuse, freeing it if a spare is already available.
+  Segment* drained = read_segment_;
+  Segment* expected = nullptr;
+  if (!spare_segment_.compare_exchange_strong(expected, drained,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+    delete drained;
   }
+  read_segment_ = next;
+  read_index_ = 0;
+  return true;
+}
+
+void SpscByteQueue::CopyContentsTo(std::vector<uint8_t>& contents) const {
+  int64_t index = read_index_;
+  for (const Segment* segment = read_segment_; segment != nullptr;
+       segment = segment->next.load(std::memory_order_acquire)) {
+    int64_t committed = segment->committed.load(std::memory_order_acquire);
+    for (; index < committed; ++index) {
+      const uint8_t* element =
+          segment->data.get() + index * allocated_element_size_;
+      contents.insert(contents.end(), element,
+                      element + channel_element_size_);
+    }
+    index = 0;
+  }
+}
+
+void SpscByteQueue::Clear() {
+  std::vector<uint8_t> element(allocated_element_size_);
+  while (Read(element.data())) {
+  }
+}
+
+LockFreeJitChannelQueue::LockFreeJitChannelQueue(Channel* channel,
+                                                 JitRuntime* jit_runtime)
+    : JitChannelQueue(channel, jit_runtime),
+      spsc_queue_(jit_runtime->GetTypeByteSize(channel->type())) {
+  if (channel->kind() == ChannelKind::kSingleValue) {
+    single_value_queue_.emplace(spsc_queue_.element_size(),
+                                /*is_single_value=*/true);
+  }
+}
+
+int64_t LockFreeJitChannelQueue::GetSizeInternal() const {
+  if (single_value_queue_.has_value()) {
+    return single_value_queue_->size();
+  }
+  return spsc_queue_.size();
+}
+
+void LockFreeJitChannelQueue::WriteValue(const Value& value) {
+  absl::InlinedVector<uint8_t, ByteQueue::kInitBufferSize> buffer(
+      spsc_queue_.element_size());
+  type_layout_.ValueToNativeLayout(value, buffer.data());
+  spsc_queue_.Write(buffer.data());
+}
+
+void LockFreeJitChannelQueue::WriteInternal(Value value) {
+  if (single_value_queue_.has_value()) {
+    // `mutex_` is already held.
+    WriteValueOnQueue(value, type_layout_, *single_value_queue_);
+    return;
+  }
+  WriteValue(value);
+}
+
+std::optional<Value> LockFreeJitChannelQueue::ReadInternal() {
+  if (single_value_queue_.has_value()) {
+    return ReadValueFromQueue(type_layout_, *single_value_queue_);
+  }
+  absl::InlinedVector<uint8_t, ByteQueue::kInitBufferSize> buffer(
+      spsc_queue_.element_size());
+  if (!spsc_queue_.Read(buffer.data())) {
+    return std::nullopt;
+  }
+  return type_layout_.NativeLayoutToValue(buffer.data());
+}
+
+std::vector<uint8_t> LockFreeJitChannelQueue::GetRawContents() {
+  std::vector<uint8_t> contents;
+  if (single_value_queue_.has_value()) {
+    absl::MutexLock lock(&mutex_);
+    single_value_queue_->CopyContentsTo(contents);
+  } else {
+    spsc_queue_.CopyContentsTo(contents);
+  }
+  return contents;
+}
+
+absl::Status LockFreeJitChannelQueue::SetRawContents(
+    absl::Span<const uint8_t> contents, int64_t element_count) {
+  XLS_RETURN_IF_ERROR(CheckRawContents(contents, element_count));
+  if (single_value_queue_.has_value()) {
+    absl::MutexLock lock(&mutex_);
+    single_value_queue_->Clear();
+  } else {
+    spsc_queue_.Clear();
+  }
+  for (int64_t i = 0; i < element_count; ++i) {
+    WriteRaw(contents.data() + i * raw_element_size());
+  }
+  return absl::OkStatus();
+}
+
+bool IsSingleProducerSingleConsumer(Channel* channel, Package* package) {
+  std::optional<Proc*> sender;
+  std::optional<Proc*> receiver;
+  for (const std::unique_ptr<Proc>& proc : package->procs()) {
+    for (Node* node : proc->nodes()) {
+      if (node->Is<Send>() &&
+          node->As<Send>()->channel_id() == channel->id()) {
+        if (sender.has_value() && sender.value() != proc.get()) {
+          return false;
+        }
+        sender = proc.get();
+      }
+      if (node->Is<Receive>() &&
+          node->As<Receive>()->channel_id() == channel->id()) {
+        if (receiver.has_value() && receiver.value() != proc.get()) {
+          return false;
+        }
+        receiver = proc.get();
+      }
+    }
+  }
+  return true;
+}
+
+absl::Status JitChannelQueue::CheckRawContents(
+    absl::Span<const uint8_t> contents, int64_t element_count) const {
+  XLS_RET_CHECK_EQ(contents.size(), element_count * raw_element_size())
+      << "Invalid contents for channel queue " << channel()->name();
+  if (channel()->kind() == ChannelKind::kSingleValue) {
+    XLS_RET_CHECK_LE(element_count, 1)
+        << "Single-value channel queue " << channel()->name()
+        << " can hold at most one element";
+  }
+  return absl::OkStatus();
+}
+
+std::vector<uint8_t> ThreadSafeJitChannelQueue::GetRawContents() {
+  absl::MutexLock lock(&mutex_);
+  std::vector<uint8_t> contents;
+  byte_queue_.CopyContentsTo(contents);
+  return contents;
+}
+
+absl::Status ThreadSafeJitChannelQueue::SetRawContents(
+    absl::Span<const uint8_t> contents, int64_t element_count) {
+  XLS_RETURN_IF_ERROR(CheckRawContents(contents, element_count));
+  absl::MutexLock lock(&mutex_);
+  byte_queue_.Clear();
+  for (int64_t i = 0; i < element_count; ++i) {
+    byte_queue_.Write(contents.data() + i * raw_element_size());
+  }
+  return absl::OkStatus();
 }
 
 int64_t ThreadSafeJitChannelQueue::GetSizeInternal() const {
   return byte_queue_.size();
 }
 
-void ThreadSafeJitChannelQueue::WriteInternal(const Value& value) {
-  WriteValueOnQueue(value, channel()->type(), *jit_runtime_, byte_queue_);
+void ThreadSafeJitChannelQueue::WriteInternal(Value value) {
+  WriteValueOnQueue(value, type_layout_, byte_queue_);
 }
 
 std::optional<Value> ThreadSafeJitChannelQueue::ReadInternal() {
-  return ReadValueFromQueue(channel()->type(), *jit_runtime_, byte_queue_);
+  return ReadValueFromQueue(type_layout_, byte_queue_);
+}
+
+std::vector<uint8_t> ThreadUnsafeJitChannelQueue::GetRawContents() {
+  std::vector<uint8_t> contents;
+  byte_queue_.CopyContentsTo(contents);
+  return contents;
+}
+
+absl::Status ThreadUnsafeJitChannelQueue::SetRawContents(
+    absl::Span<const uint8_t> contents, int64_t element_count) {
+  XLS_RETURN_IF_ERROR(CheckRawContents(contents, element_count));
+  byte_queue_.Clear();
+  for (int64_t i = 0; i < element_count; ++i) {
+    byte_queue_.Write(contents.data() + i * raw_element_size());
+  }
+  return absl::OkStatus();
 }
 
 int64_t ThreadUnsafeJitChannelQueue::GetSizeInternal() const {
   return byte_queue_.size();
 }
 
-void ThreadUnsafeJitChannelQueue::WriteInternal(const Value& value) {
-  WriteValueOnQueue(value, channel()->type(), *jit_runtime_, byte_queue_);
+void ThreadUnsafeJitChannelQueue::WriteInternal(Value value) {
+  WriteValueOnQueue(value, type_layout_, byte_queue_);
 }
 
 std::optional<Value> ThreadUnsafeJitChannelQueue::ReadInternal() {
-  return ReadValueFromQueue(channel()->type(), *jit_runtime_, byte_queue_);
+  return ReadValueFromQueue(type_layout_, byte_queue_);
 }
 
 /* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
@@ -139,6 +391,42 @@ JitChannelQueueManager::CreateThreadUnsafe(Package* package) {
                                                      std::move(runtime)));
 }
 
+/* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
+JitChannelQueueManager::CreateLockFree(Package* package) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitRuntime> runtime,
+                       JitRuntime::Create());
+  std::vector<std::unique_ptr<ChannelQueue>> queues;
+  for (Channel* channel : package->channels()) {
+    if (IsSingleProducerSingleConsumer(channel, package)) {
+      queues.push_back(
+          std::make_unique<LockFreeJitChannelQueue>(channel, runtime.get()));
+    } else {
+      queues.push_back(
+          std::make_unique<ThreadSafeJitChannelQueue>(channel, runtime.get()));
+    }
+  }
+  return absl::WrapUnique(new JitChannelQueueManager(package, std::move(queues),
+                                                     std::move(runtime)));
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
+JitChannelQueueManager::CreateSingleThreaded(Package* package) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitRuntime> runtime,
+                       JitRuntime::Create());
+  std::vector<std::unique_ptr<ChannelQueue>> queues;
+  for (Channel* channel : package->channels()) {
+    if (channel->supported_ops() == ChannelOps::kSendReceive) {
+      queues.push_back(std::make_unique<ThreadUnsafeJitChannelQueue>(
+          channel, runtime.get()));
+    } else {
+      queues.push_back(
+          std::make_unique<ThreadSafeJitChannelQueue>(channel, runtime.get()));
+    }
+  }
+  return absl::WrapUnique(new JitChannelQueueManager(package, std::move(queues),
+                                                     std::move(runtime)));
+}
+
 JitChannelQueue& JitChannelQueueManager::GetJitQueue(Channel* channel) {
   JitChannelQueue* queue = dynamic_cast<JitChannelQueue*>(&GetQueue(channel));
   XLS_CHECK_NE(queue, nullptr);
@@ -15,8 +15,10 @@
 #define XLS_JIT_JIT_CHANNEL_QUEUE_H_
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <optional>
 #include <string>
@@ -28,6 +30,8 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
@@ -36,6 +40,7 @@
 #include "xls/ir/package.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -50,8 +55,36 @@ class ByteQueue {
   // queue has FIFO semantics.
   ByteQueue(int64_t channel_element_size, bool is_single_value);
 
+  // The state of the circular buffer. Jitted code may read and write elements
+  // by operating on this state directly, as Read and Write do, only calling
+  // out to Write when the buffer is full (see JitChannelQueue::InlineQueue).
+  struct State {
+    // The circular buffer holding the elements.
+    uint8_t* buffer;
+    // The maximum number of bytes that can hold elements in the circular
+    // buffer.
+    int64_t max_byte_count;
+    // The number of bytes used in the circular buffer.
+    int64_t bytes_used;
+    // Index in the circular buffer to read values from.
+    int64_t read_index;
+    // Index in the circular buffer to write values to.
+    int64_t write_index;
+  };
+
+  // The state refers to the storage of the queue, so it may not be copied.
+  ByteQueue(const ByteQueue&) = delete;
+  ByteQueue& operator=(const ByteQueue&) = delete;
+
   int64_t element_size() const { return channel_element_size_; }
 
+  // Allocated size of an element in the circular buffer in units of bytes.
+  int64_t allocated_element_size() const { return allocated_element_size_; }
+
+  bool is_single_value() const { return is_single_value_; }
+
+  State* state() { return &state_; }
+
   // Doubles the size of the queue.
   void Resize();
 
@@ -59,39 +92,45 @@ class ByteQueue {
 #ifdef ABSL_HAVE_MEMORY_SANITIZER
     __msan_unpoison(data, channel_element_size_);
 #endif
-    if (bytes_used_ == max_byte_count_ && !is_single_value_) {
+    if (state_.bytes_used == state_.max_byte_count && !is_single_value_) {
       Resize();
     }
-    memcpy(circular_buffer_.data() + write_index_, data, channel_element_size_);
+    memcpy(state_.buffer + state_.write_index, data, channel_element_size_);
     if (is_single_value_) {
-      bytes_used_ = allocated_element_size_;
+      state_.bytes_used = allocated_element_size_;
     } else {
-      bytes_used_ += allocated_element_size_;
-      write_index_ = write_index_ + allocated_element_size_;
-      if (write_index_ == max_byte_count_) {
-        write_index_ = 0;
+      state_.bytes_used += allocated_element_size_;
+      state_.write_index = state_.write_index + allocated_element_size_;
+      if (state_.write_index == state_.max_byte_count) {
+        state_.write_index = 0;
       }
     }
   }
 
   bool Read(uint8_t* buffer) {
-    if (bytes_used_ == 0) {
+    if (state_.bytes_used == 0) {
       return false;
     }
-    memcpy(buffer, circular_buffer_.data() + read_index_,
-           channel_element_size_);
+    memcpy(buffer, state_.buffer + state_.read_index, channel_element_size_);
     if (!is_single_value_) {
       // Reads are destructive for non single-value channels.
-      bytes_used_ -= allocated_element_size_;
-      read_index_ = read_index_ + allocated_element_size_;
-      if (read_index_ == max_byte_count_) {
-        read_index_ = 0;
+      state_.bytes_used -= allocated_element_size_;
+      state_.read_index = state_.read_index + allocated_element_size_;
+      if (state_.read_index == state_.max_byte_count) {
+        state_.read_index = 0;
       }
     }
     return true;
   }
 
-  int64_t size() const { return bytes_used_ / allocated_element_size_; }
+  int64_t size() const { return state_.bytes_used / allocated_element_size_; }
+
+  // Appends the elements of the queue, oldest first, to `contents` with no
+  // padding between them.
+  void CopyContentsTo(std::vector<uint8_t>& contents) const;
+
+  // Removes all elements from the queue.
+  void Clear();
 
   static constexpr int64_t kInitBufferSize = 128;
 
@@ -103,34 +142,167 @@ class ByteQueue {
   int64_t allocated_element_size_ = 0;
   // TODO(vmirian): 8-09-2022 Place the following guarded members on a single
   // cache line for optimal performance.
-  // The maximum number of bytes that can hold elements in the circular buffer.
-  int64_t max_byte_count_ = 0;
-  // The number of bytes used in the circular buffer.
-  int64_t bytes_used_ = 0;
-  // Index in the circular buffer to write values to.
-  int64_t read_index_ = 0;
-  // Index in the circular buffer to read values from.
-  int64_t write_index_ = 0;
+  State state_ = {.buffer = nullptr,
+                  .max_byte_count = 0,
+                  .bytes_used = 0,
+                  .read_index = 0,
+                  .write_index = 0};
   // A circular buffer to store the elements. It is preallocated with storage.
   absl::InlinedVector<uint8_t, kInitBufferSize> circular_buffer_;
   // Whether this queue follows single-value channel semantics.
   bool is_single_value_;
 };
 
+// A single-producer single-consumer queue of raw bytes which requires no
+// locking. Writes are performed only by a single producer thread and reads only
+// by a single consumer thread; under this discipline both operations are
+// wait-free except when the producer must allocate storage.
+//
+// Elements are stored in fixed-size ring segments linked together. When the
+// producer fills a segment it links in a new one so the queue is unbounded
+// like other channel queues. Segments drained by the consumer are handed back
+// to the producer for reuse so a queue in steady state does not allocate.
+class SpscByteQueue {
+ public:
+  explicit SpscByteQueue(int64_t channel_element_size);
+  ~SpscByteQueue();
+
+  SpscByteQueue(const SpscByteQueue&) = delete;
+  SpscByteQueue& operator=(const SpscByteQueue&) = delete;
+
+  int64_t element_size() const { return channel_element_size_; }
+
+  // Target size in bytes of each ring segment.
+  static constexpr int64_t kSegmentByteSize = 4096;
+
+  // Writes an element to the queue. Must only be called by the producer.
+  void Write(const uint8_t* data) {
+#ifdef ABSL_HAVE_MEMORY_SANITIZER
+    __msan_unpoison(data, channel_element_size_);
+#endif
+    if (write_index_ == elements_per_segment_) {
+      AdvanceWriteSegment();
+    }
+    memcpy(write_segment_->data.get() + write_index_ * allocated_element_size_,
+           data, channel_element_size_);
+    ++write_index_;
+    // Publish the element to the consumer.
+    write_segment_->committed.store(write_index_, std::memory_order_release);
+    write_count_.store(write_count_.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_release);
+  }
+
+  // Reads an element from the queue into `buffer`. Returns false if the queue
+  // is empty. Must only be called by the consumer.
+  bool Read(uint8_t* buffer) {
+    if (read_index_ == elements_per_segment_ && !AdvanceReadSegment()) {
+      return false;
+    }
+    if (read_index_ >=
+        read_segment_->committed.load(std::memory_order_acquire)) {
+      return false;
+    }
+    memcpy(buffer,
+           read_segment_->data.get() + read_index_ * allocated_element_size_,
+           channel_element_size_);
+    ++read_index_;
+    read_count_.store(read_count_.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_release);
+    return true;
+  }
+
+  // Returns the number of elements in the queue. May be called from any thread
+  // though the value may be stale by the time it is returned.
+  int64_t size() const {
+    int64_t read_count = read_count_.load(std::memory_order_acquire);
+    return write_count_.load(std::memory_order_acquire) - read_count;
+  }
+
+  // Appends the elements of the queue, oldest first, to `contents` with no
+  // padding between them. Must not be called concurrently with reads or
+  // writes.
+  void CopyContentsTo(std::vector<uint8_t>& contents) const;
+
+  // Removes all elements from the queue. Must only be called by the consumer.
+  void Clear();
+
+ private:
+  struct Segment {
+    std::unique_ptr<uint8_t[]> data;
+    // Number of elements written into this segment by the producer.
+    std::atomic<int64_t> committed = 0;
+    // Next segment in the queue. Set by the producer after it has finished
+    // writing to this segment.
+    std::atomic<Segment*> next = nullptr;
+  };
+
+  Segment* NewSegment();
+  void AdvanceWriteSegment();
+  bool AdvanceReadSegment();
+
+  int64_t channel_element_size_;
+  int64_t allocated_element_size_;
+  int64_t elements_per_segment_;
+
+  // State owned by the producer. Aligned to avoid false sharing with the
+  // consumer state.
+  alignas(64) Segment* write_segment_;
+  int64_t write_index_ = 0;
+  std::atomic<int64_t> write_count_ = 0;
+
+  // State owned by the consumer.
+  alignas(64) Segment* read_segment_;
+  int64_t read_index_ = 0;
+  std::atomic<int64_t> read_count_ = 0;
+
+  // A drained segment handed from the consumer back to the producer.
+  alignas(64) std::atomic<Segment*> spare_segment_ = nullptr;
+};
+
 // Abstract base class for channel queues which may be used by the JIT. These
 // queues support reading and writing raw bytes to the queue rather the just
 // xls::Values.
 class JitChannelQueue : public ChannelQueue {
  public:
   JitChannelQueue(Channel* channel, JitRuntime* jit_runtime)
-      : ChannelQueue(channel), jit_runtime_(jit_runtime) {}
+      : ChannelQueue(channel),
+        jit_runtime_(jit_runtime),
+        type_layout_(jit_runtime->CreateTypeLayout(channel->type())) {}
   ~JitChannelQueue() override = default;
 
   virtual void WriteRaw(const uint8_t* data) = 0;
   virtual bool ReadRaw(uint8_t* buffer) = 0;
 
+  // Returns the byte queue holding the elements if jitted code may read and
+  // write it directly in place of calling ReadRaw and WriteRaw, otherwise
+  // nullptr. Such accesses do not run generators or call the write callback;
+  // runtimes wake receivers when the sending proc reports kSentOnChannel.
+  virtual ByteQueue* InlineQueue() { return nullptr; }
+
+  // Size in bytes of an element in the native layout.
+  int64_t raw_element_size() const { return type_layout_.size(); }
+
+  // Returns the elements of the queue, oldest first, in the native layout
+  // packed back to back (raw_element_size() bytes each). Used to snapshot
+  // the queue so it must not be called while the queue is being accessed
+  // concurrently.
+  virtual std::vector<uint8_t> GetRawContents() = 0;
+
+  // Replaces the contents of the queue with `element_count` elements packed
+  // in `contents` as returned by GetRawContents.
+  virtual absl::Status SetRawContents(absl::Span<const uint8_t> contents,
+                                      int64_t element_count) = 0;
+
  protected:
+  // Checks that `contents` holds exactly `element_count` elements.
+  absl::Status CheckRawContents(absl::Span<const uint8_t> contents,
+                                int64_t element_count) const;
+
   JitRuntime* jit_runtime_;
+
+  // Native layout of the channel type used to convert between Values and the
+  // raw queue elements.
+  TypeLayout type_layout_;
 };
 
 // A thread-safe version of the JIT channel queue. All accesses are guarded by a
@@ -147,24 +319,24 @@ class ThreadSafeJitChannelQueue : public JitChannelQueue {
   void WriteRaw(const uint8_t* data) override {
     absl::MutexLock lock(&mutex_);
     byte_queue_.Write(data);
+    NotifyWrite();
   }
 
   // Reads raw bytes representing a value in LLVM's native format. Returns
   // true if queue was not empty and data was read.
   bool ReadRaw(uint8_t* buffer) override {
     absl::MutexLock lock(&mutex_);
-    if (generator_.has_value()) {
-      std::optional<Value> generated_value = (*generator_)();
-      if (generated_value.has_value()) {
-        WriteInternal(generated_value.value());
-      }
-    }
+    RunGenerator();
     return byte_queue_.Read(buffer);
   }
 
+  std::vector<uint8_t> GetRawContents() override;
+  absl::Status SetRawContents(absl::Span<const uint8_t> contents,
+                              int64_t element_count) override;
+
  protected:
   int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
-  void WriteInternal(const Value& value)
+  void WriteInternal(Value value)
       ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
   std::optional<Value> ReadInternal()
       ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
@@ -181,25 +353,91 @@ class ThreadUnsafeJitChannelQueue : public JitChannelQueue {
                     channel->kind() == ChannelKind::kSingleValue) {}
   ~ThreadUnsafeJitChannelQueue() override = default;
 
-  void WriteRaw(const uint8_t* data) override { byte_queue_.Write(data); }
+  void WriteRaw(const uint8_t* data) override {
+    byte_queue_.Write(data);
+    NotifyWriteWithLock();
+  }
   bool ReadRaw(uint8_t* buffer) override {
-    if (generator_.has_value()) {
-      std::optional<Value> generated_value = (*generator_)();
-      if (generated_value.has_value()) {
-        WriteInternal(generated_value.value());
-      }
-    }
+    RunGeneratorWithLock();
     return byte_queue_.Read(buffer);
   }
 
+  // Internal channels are only accessed by the procs, which all run on one
+  // thread when using this queue, so jitted code may operate on the queue
+  // directly.
+  ByteQueue* InlineQueue() override {
+    return channel()->supported_ops() == ChannelOps::kSendReceive
+               ? &byte_queue_
+               : nullptr;
+  }
+
+  std::vector<uint8_t> GetRawContents() override;
+  absl::Status SetRawContents(absl::Span<const uint8_t> contents,
+                              int64_t element_count) override;
+
  protected:
   int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
-  void WriteInternal(const Value& value) override;
+  void WriteInternal(Value value) override;
   std::optional<Value> ReadInternal() override;
 
   ByteQueue byte_queue_;
 };
 
+// A JIT channel queue which needs no locks for raw reads and writes. Only valid
+// for channels with a single producer and a single consumer each running on
+// one thread (e.g., a channel whose send and receive nodes are each in a single
+// proc). Streaming channels use a lock-free SpscByteQueue. Single-value
+// channels, which have no FIFO behavior to exploit, are guarded by a mutex.
+class LockFreeJitChannelQueue : public JitChannelQueue {
+ public:
+  LockFreeJitChannelQueue(Channel* channel, JitRuntime* jit_runtime);
+  ~LockFreeJitChannelQueue() override = default;
+
+  void WriteRaw(const uint8_t* data) override {
+    if (single_value_queue_.has_value()) {
+      absl::MutexLock lock(&mutex_);
+      single_value_queue_->Write(data);
+      NotifyWrite();
+      return;
+    }
+    spsc_queue_.Write(data);
+    NotifyWriteWithLock();
+  }
+
+  bool ReadRaw(uint8_t* buffer) override {
+    RunGeneratorWithLock();
+    if (single_value_queue_.has_value()) {
+      absl::MutexLock lock(&mutex_);
+      return single_value_queue_->Read(buffer);
+    }
+    return spsc_queue_.Read(buffer);
+  }
+
+  std::vector<uint8_t> GetRawContents() override;
+  absl::Status SetRawContents(absl::Span<const uint8_t> contents,
+                              int64_t element_count) override;
+
+ protected:
+  int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  void WriteInternal(Value value)
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  std::optional<Value> ReadInternal()
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+
+ private:
+  // Writes `value` to the SPSC queue without calling the write callback.
+  void WriteValue(const Value& value);
+
+  SpscByteQueue spsc_queue_;
+  std::optional<ByteQueue> single_value_queue_;
+};
+
+// Returns whether the given channel has a single producer and a single
+// consumer: all of the send nodes on the channel are in one proc and all of the
+// receive nodes are in one proc. Channels with no sends (or receives) in the
+// package are assumed to be written (read) by a single external agent.
+bool IsSingleProducerSingleConsumer(Channel* channel, Package* package);
+
 // A Channel manager which holds exclusively JitChannelQueues.
 class JitChannelQueueManager : public ChannelQueueManager {
  public:
@@ -212,6 +450,20 @@ class JitChannelQueueManager : public ChannelQueueManager {
   static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
   CreateThreadUnsafe(Package* package);
 
+  // Factory which creates a queue manager using LockFreeJitChannelQueues for
+  // all channels with a single producer and single consumer (see
+  // IsSingleProducerSingleConsumer) and ThreadSafeJitChannelQueues for all
+  // other channels.
+  static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
+  CreateLockFree(Package* package);
+
+  // Factory for procs which all run on a single thread. Internal channels use
+  // ThreadUnsafeJitChannelQueues, which jitted code reads and writes directly
+  // (see JitChannelQueue::InlineQueue), and all other channels use
+  // ThreadSafeJitChannelQueues so I/O may be performed from other threads.
+  static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
+  CreateSingleThreaded(Package* package);
+
   JitChannelQueue& GetJitQueue(Channel* channel);
 
   JitRuntime& runtime() { return *runtime_; }
@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "include/benchmark/benchmark.h"
@@ -82,6 +83,61 @@ BENCHMARK(BM_QueueWriteThenRead<ThreadUnsafeJitChannelQueue>)
     ->ArgPair(2048, 1)
     ->ArgPair(2048, 128);
 
+BENCHMARK(BM_QueueWriteThenRead<LockFreeJitChannelQueue>)
+    ->ArgPair(1, 1)
+    ->ArgPair(1, 128)
+    ->ArgPair(8, 1)
+    ->ArgPair(8, 128)
+    ->ArgPair(32, 1)
+    ->ArgPair(32, 128)
+    ->ArgPair(2048, 1)
+    ->ArgPair(2048, 128);
+
+// Benchmark evaluating a producer thread writing to the channel while the
+// benchmark thread concurrently reads from it.
+template <typename QueueT,
+          typename std::enable_if<std::is_base_of_v<JitChannelQueue, QueueT>,
+                                  QueueT>::type* = nullptr>
+static void BM_QueueProducerConsumer(benchmark::State& state) {
+  int64_t element_size_bytes = state.range(0);
+
+  Package package("benchmark");
+  std::unique_ptr<JitRuntime> jit_runtime = JitRuntime::Create().value();
+  Channel* channel =
+      package
+          .CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                  package.GetBitsType(8 * element_size_bytes))
+          .value();
+  QueueT queue(channel, jit_runtime.get());
+
+  int64_t send_count = state.range(1);
+  std::vector<uint8_t> send_buffer(element_size_bytes);
+  std::vector<uint8_t> recv_buffer(element_size_bytes);
+  std::fill(send_buffer.begin(), send_buffer.end(), 42);
+  for (auto _ : state) {
+    std::thread producer([&]() {
+      for (int64_t i = 0; i < send_count; ++i) {
+        queue.WriteRaw(send_buffer.data());
+      }
+    });
+    for (int64_t i = 0; i < send_count;) {
+      if (queue.ReadRaw(recv_buffer.data())) {
+        ++i;
+      }
+    }
+    producer.join();
+  }
+  state.SetItemsProcessed(state.iterations() * send_count);
+}
+
+BENCHMARK(BM_QueueProducerConsumer<ThreadSafeJitChannelQueue>)
+    ->ArgPair(8, 100000)
+    ->ArgPair(2048, 10000);
+
+BENCHMARK(BM_QueueProducerConsumer<LockFreeJitChannelQueue>)
+    ->ArgPair(8, 100000)
+    ->ArgPair(2048, 10000);
+
 }  // namespace
 }  // namespace xls
 
@@ -14,7 +14,10 @@
 
 #include "xls/jit/jit_channel_queue.h"
 
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -23,13 +26,16 @@
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/channel_queue_test_base.h"
 #include "xls/ir/channel.h"
+#include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 namespace {
 
 using status_testing::StatusIs;
 using ::testing::HasSubstr;
+using ::testing::Optional;
 
 JitRuntime* GetJitRuntime() {
   static auto jit_runtime =
@@ -51,11 +57,19 @@ INSTANTIATE_TEST_SUITE_P(
                                                            GetJitRuntime());
     })));
 
+INSTANTIATE_TEST_SUITE_P(
+    LockFreeJitChannelQueueTest, ChannelQueueTestBase,
+    testing::Values(ChannelQueueTestParam([](Channel* channel) {
+      return std::make_unique<LockFreeJitChannelQueue>(channel,
+                                                       GetJitRuntime());
+    })));
+
 template <typename QueueT>
 class JitChannelQueueTest : public ::testing::Test {};
 
 using QueueTypes =
-    ::testing::Types<ThreadSafeJitChannelQueue, ThreadUnsafeJitChannelQueue>;
+    ::testing::Types<ThreadSafeJitChannelQueue, ThreadUnsafeJitChannelQueue,
+                     LockFreeJitChannelQueue>;
 TYPED_TEST_SUITE(JitChannelQueueTest, QueueTypes);
 
 // An empty tuple represents a zero width.
@@ -156,5 +170,117 @@ TYPED_TEST(JitChannelQueueTest, IotaGeneratorWithRawApi) {
                                  "a generator function")));
 }
 
+TEST(LockFreeJitChannelQueueTest, ConcurrentProducerConsumer) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(64)));
+  LockFreeJitChannelQueue queue(channel, GetJitRuntime());
+
+  // Enough elements to wrap through many ring segments.
+  constexpr int64_t kCount = 100000;
+  std::thread producer([&]() {
+    for (int64_t i = 0; i < kCount; ++i) {
+      queue.WriteRaw(reinterpret_cast<const uint8_t*>(&i));
+    }
+  });
+  std::vector<int64_t> received;
+  received.reserve(kCount);
+  while (received.size() < kCount) {
+    int64_t value;
+    if (queue.ReadRaw(reinterpret_cast<uint8_t*>(&value))) {
+      received.push_back(value);
+    }
+  }
+  producer.join();
+
+  for (int64_t i = 0; i < kCount; ++i) {
+    ASSERT_EQ(received[i], i);
+  }
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(LockFreeJitChannelQueueTest, ManagerSelectsQueueByTopology) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(
+package test
+
+chan spsc(bits[32], id=0, kind=streaming, ops=send_receive, flow_control=ready_valid, metadata="""""")
+chan mpsc(bits[32], id=1, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="""""")
+
+proc a(tkn: token, st: bits[1], init={0}) {
+  lit: bits[32] = literal(value=1)
+  send0: token = send(tkn, lit, channel_id=0)
+  send1: token = send(send0, lit, channel_id=1)
+  next (send1, st)
+}
+
+proc b(tkn: token, st: bits[1], init={0}) {
+  recv: (token, bits[32]) = receive(tkn, channel_id=0)
+  recv_tkn: token = tuple_index(recv, index=0)
+  data: bits[32] = tuple_index(recv, index=1)
+  send1: token = send(recv_tkn, data, channel_id=1)
+  next (send1, st)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> manager,
+      JitChannelQueueManager::CreateLockFree(package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * spsc, package->GetChannel("spsc"));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * mpsc, package->GetChannel("mpsc"));
+  EXPECT_TRUE(IsSingleProducerSingleConsumer(spsc, package.get()));
+  EXPECT_FALSE(IsSingleProducerSingleConsumer(mpsc, package.get()));
+  EXPECT_NE(dynamic_cast<LockFreeJitChannelQueue*>(&manager->GetJitQueue(spsc)),
+            nullptr);
+  EXPECT_NE(
+      dynamic_cast<ThreadSafeJitChannelQueue*>(&manager->GetJitQueue(mpsc)),
+      nullptr);
+}
+
+TEST(JitChannelQueueManagerTest, SingleThreadedManagerInlinesInternalQueues) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(
+package test
+
+chan internal(bits[32], id=0, kind=streaming, ops=send_receive, flow_control=ready_valid, metadata="""""")
+chan out(bits[32], id=1, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="""""")
+
+proc a(tkn: token, st: bits[1], init={0}) {
+  lit: bits[32] = literal(value=1)
+  send0: token = send(tkn, lit, channel_id=0)
+  next (send0, st)
+}
+
+proc b(tkn: token, st: bits[1], init={0}) {
+  recv: (token, bits[32]) = receive(tkn, channel_id=0)
+  recv_tkn: token = tuple_index(recv, index=0)
+  data: bits[32] = tuple_index(recv, index=1)
+  send1: token = send(recv_tkn, data, channel_id=1)
+  next (send1, st)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> manager,
+      JitChannelQueueManager::CreateSingleThreaded(package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * internal, package->GetChannel("internal"));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * out, package->GetChannel("out"));
+  JitChannelQueue& internal_queue = manager->GetJitQueue(internal);
+  ASSERT_NE(internal_queue.InlineQueue(), nullptr);
+  EXPECT_EQ(manager->GetJitQueue(out).InlineQueue(), nullptr);
+
+  // Elements written through the byte queue are visible through the channel
+  // queue.
+  XLS_ASSERT_OK(internal_queue.Write(Value(UBits(42, 32))));
+  ByteQueue::State* state = internal_queue.InlineQueue()->state();
+  EXPECT_EQ(state->bytes_used,
+            internal_queue.InlineQueue()->allocated_element_size());
+  uint32_t data = 123;
+  internal_queue.InlineQueue()->Write(reinterpret_cast<uint8_t*>(&data));
+  EXPECT_THAT(internal_queue.Read(), Optional(Value(UBits(42, 32))));
+  EXPECT_THAT(internal_queue.Read(), Optional(Value(UBits(123, 32))));
+  EXPECT_TRUE(internal_queue.IsEmpty());
+}
+
 }  // namespace
 }  // namespace xls
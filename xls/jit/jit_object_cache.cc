@@ -0,0 +1,183 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_object_cache.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/random/random.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "llvm/include/llvm/ADT/StringExtras.h"
+#include "llvm/include/llvm/Config/llvm-config.h"
+#include "llvm/include/llvm/Support/SHA256.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls {
+namespace {
+
+// Version of the on-disk format. Bump this to invalidate all existing entries
+// if the way object code is generated changes in a way which is not reflected
+// in the LLVM module text (e.g., a change in the JIT's code generation
+// options).
+constexpr int64_t kCacheFormatVersion = 2;
+
+constexpr std::string_view kEntrySuffix = ".o";
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<JitObjectCache>>
+JitObjectCache::Create(const std::filesystem::path& directory,
+                       int64_t max_bytes) {
+  XLS_RET_CHECK_GT(max_bytes, 0);
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(directory));
+  XLS_ASSIGN_OR_RETURN(std::string build, ExecutableFingerprint());
+  return absl::WrapUnique(
+      new JitObjectCache(directory, std::move(build), max_bytes));
+}
+
+/* static */ std::string JitObjectCache::ComputeKey(std::string_view llvm_ir,
+                                                    int64_t opt_level,
+                                                    std::string_view target,
+                                                    std::string_view build) {
+  llvm::SHA256 hasher;
+  std::string header = absl::StrFormat(
+      "xls_jit_object_cache:%d;llvm:%s;build:%s;opt_level:%d;target:%s;",
+      kCacheFormatVersion, LLVM_VERSION_STRING, build, opt_level, target);
+  hasher.update(llvm::StringRef(header));
+  hasher.update(llvm::StringRef(llvm_ir.data(), llvm_ir.size()));
+  auto digest = hasher.final();
+  return llvm::toHex(digest, /*LowerCase=*/true);
+}
+
+std::filesystem::path JitObjectCache::GetEntryPath(std::string_view key) const {
+  return directory_ / absl::StrCat(key, kEntrySuffix);
+}
+
+absl::StatusOr<std::optional<std::vector<uint8_t>>> JitObjectCache::Lookup(
+    std::string_view key) {
+  std::filesystem::path path = GetEntryPath(key);
+  // The entry may be evicted by another process at any time so a missing file
+  // is a miss rather than an error.
+  absl::StatusOr<std::string> contents = GetFileContents(path);
+  if (absl::IsNotFound(contents.status())) {
+    XLS_VLOG(2) << "JIT object cache miss: " << path;
+    ++miss_count_;
+    return std::nullopt;
+  }
+  XLS_RETURN_IF_ERROR(contents.status());
+  XLS_VLOG(2) << absl::StreamFormat("JIT object cache hit: %s (%d bytes)",
+                                    path.string(), contents->size());
+  ++hit_count_;
+  // Mark the entry as recently used for eviction. Failure only makes the entry
+  // a more likely eviction candidate.
+  std::error_code ec;
+  std::filesystem::last_write_time(
+      path, std::filesystem::file_time_type::clock::now(), ec);
+  return std::vector<uint8_t>(contents->begin(), contents->end());
+}
+
+absl::Status JitObjectCache::Insert(std::string_view key,
+                                    absl::Span<const uint8_t> object_code) {
+  std::filesystem::path path = GetEntryPath(key);
+  // Write to a uniquely named file first so concurrent writers of the same
+  // entry do not interleave and readers never see a partial file.
+  absl::BitGen bitgen;
+  std::filesystem::path temp_path = directory_ / absl::StrFormat(
+      "%s.tmp.%d.%x", key, getpid(), absl::Uniform<uint64_t>(bitgen));
+  XLS_RETURN_IF_ERROR(SetFileContents(
+      temp_path,
+      std::string_view(reinterpret_cast<const char*>(object_code.data()),
+                       object_code.size())));
+  std::error_code ec;
+  std::filesystem::rename(temp_path, path, ec);
+  if (ec) {
+    std::filesystem::remove(temp_path, ec);
+    return absl::InternalError(
+        absl::StrFormat("Unable to add entry to JIT object cache at %s: %s",
+                        path.string(), ec.message()));
+  }
+  XLS_VLOG(2) << absl::StreamFormat("Added JIT object cache entry: %s",
+                                    path.string());
+  return EvictIfOverLimit();
+}
+
+absl::Status JitObjectCache::EvictIfOverLimit() {
+  struct Entry {
+    std::filesystem::path path;
+    std::filesystem::file_time_type last_used;
+    int64_t size;
+  };
+  std::vector<Entry> entries;
+  int64_t total_bytes = 0;
+  std::error_code ec;
+  for (const std::filesystem::directory_entry& dir_entry :
+       std::filesystem::directory_iterator(directory_, ec)) {
+    if (dir_entry.path().extension() != kEntrySuffix) {
+      continue;
+    }
+    // Entries removed concurrently by other processes are skipped.
+    std::error_code entry_ec;
+    int64_t size = dir_entry.file_size(entry_ec);
+    std::filesystem::file_time_type last_used =
+        dir_entry.last_write_time(entry_ec);
+    if (entry_ec) {
+      continue;
+    }
+    entries.push_back(Entry{dir_entry.path(), last_used, size});
+    total_bytes += size;
+  }
+  if (ec) {
+    return absl::InternalError(
+        absl::StrFormat("Unable to list JIT object cache at %s: %s",
+                        directory_.string(), ec.message()));
+  }
+  if (total_bytes <= max_bytes_) {
+    return absl::OkStatus();
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) {
+              return a.last_used < b.last_used;
+            });
+  for (const Entry& entry : entries) {
+    if (total_bytes <= max_bytes_) {
+      break;
+    }
+    std::filesystem::remove(entry.path, ec);
+    total_bytes -= entry.size;
+    XLS_VLOG(2) << "Evicted JIT object cache entry: " << entry.path;
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace xls
@@ -0,0 +1,114 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_JIT_OBJECT_CACHE_H_
+#define XLS_JIT_JIT_OBJECT_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+
+namespace xls {
+
+// A persistent on-disk cache of object code produced by the JIT. Entries are
+// keyed by a content hash of the unoptimized LLVM module, the LLVM
+// optimization level, a description of the target machine and a fingerprint
+// of the running XLS build (see ExecutableFingerprint), so entries written by
+// a different build of XLS are never reused. Each entry is stored as a
+// separate file in the cache directory so a directory may be shared by
+// concurrently running processes.
+//
+// Modules which embed host addresses of the compiling process (e.g., of
+// runtime callbacks or channel queues) must not be cached: their text differs
+// between processes so they would never hit, and their object code is only
+// valid in the process which produced it. OrcJit bypasses the cache for such
+// modules.
+//
+// The total size of the entries is bounded. When an insertion pushes the
+// cache over its limit the least recently used entries are removed.
+class JitObjectCache {
+ public:
+  // Default limit on the total size of the entries in a cache directory.
+  static constexpr int64_t kDefaultMaxBytes = int64_t{1} << 30;
+
+  // Creates a cache backed by the given directory holding at most `max_bytes`
+  // of object code. The directory is created if it does not exist.
+  static absl::StatusOr<std::unique_ptr<JitObjectCache>> Create(
+      const std::filesystem::path& directory,
+      int64_t max_bytes = kDefaultMaxBytes);
+
+  // Returns the cache key for an LLVM module with the given textual IR
+  // compiled at `opt_level` for the target described by `target` by the XLS
+  // build identified by `build`.
+  static std::string ComputeKey(std::string_view llvm_ir, int64_t opt_level,
+                                std::string_view target,
+                                std::string_view build);
+
+  // Returns the object code stored under `key` or std::nullopt if there is no
+  // such entry. A hit marks the entry as recently used.
+  absl::StatusOr<std::optional<std::vector<uint8_t>>> Lookup(
+      std::string_view key);
+
+  // Stores `object_code` under `key` and then evicts the least recently used
+  // entries if the cache exceeds its size limit. The entry is written to a
+  // temporary file which is then renamed into place so readers never observe
+  // a partially written entry.
+  absl::Status Insert(std::string_view key,
+                      absl::Span<const uint8_t> object_code);
+
+  const std::filesystem::path& directory() const { return directory_; }
+
+  // Fingerprint of the running XLS build to pass to ComputeKey.
+  const std::string& build() const { return build_; }
+
+  int64_t max_bytes() const { return max_bytes_; }
+
+  // Number of lookups through this object which found or did not find an
+  // entry.
+  int64_t hit_count() const { return hit_count_.load(); }
+  int64_t miss_count() const { return miss_count_.load(); }
+
+ private:
+  JitObjectCache(std::filesystem::path directory, std::string build,
+                 int64_t max_bytes)
+      : directory_(std::move(directory)),
+        build_(std::move(build)),
+        max_bytes_(max_bytes) {}
+
+  std::filesystem::path GetEntryPath(std::string_view key) const;
+
+  // Removes the least recently used entries until the entries total at most
+  // `max_bytes_`.
+  absl::Status EvictIfOverLimit();
+
+  std::filesystem::path directory_;
+  std::string build_;
+  int64_t max_bytes_;
+  std::atomic<int64_t> hit_count_ = 0;
+  std::atomic<int64_t> miss_count_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_OBJECT_CACHE_H_
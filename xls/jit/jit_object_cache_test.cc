@@ -0,0 +1,192 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_object_cache.h"
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/flags/declare.h"
+#include "absl/flags/flag.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_base_jit.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/orc_jit.h"
+
+ABSL_DECLARE_FLAG(std::string, xls_jit_object_cache_dir);
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using testing::Optional;
+
+TEST(JitObjectCacheTest, InsertAndLookup) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitObjectCache> cache,
+                           JitObjectCache::Create(temp_dir.path() / "cache"));
+
+  std::string key =
+      JitObjectCache::ComputeKey("some ir", 3, "target", cache->build());
+  EXPECT_THAT(cache->Lookup(key), IsOkAndHolds(std::nullopt));
+
+  std::vector<uint8_t> object_code = {1, 2, 3, 0, 42};
+  XLS_ASSERT_OK(cache->Insert(key, object_code));
+  EXPECT_THAT(cache->Lookup(key), IsOkAndHolds(Optional(object_code)));
+  EXPECT_EQ(cache->hit_count(), 1);
+  EXPECT_EQ(cache->miss_count(), 1);
+
+  // A second cache on the same directory sees the entry.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitObjectCache> other_cache,
+                           JitObjectCache::Create(temp_dir.path() / "cache"));
+  EXPECT_EQ(other_cache->build(), cache->build());
+  EXPECT_THAT(other_cache->Lookup(key), IsOkAndHolds(Optional(object_code)));
+}
+
+TEST(JitObjectCacheTest, KeyDependsOnAllInputs) {
+  std::string key = JitObjectCache::ComputeKey("some ir", 3, "target", "b");
+  EXPECT_EQ(key, JitObjectCache::ComputeKey("some ir", 3, "target", "b"));
+  EXPECT_NE(key, JitObjectCache::ComputeKey("other ir", 3, "target", "b"));
+  EXPECT_NE(key, JitObjectCache::ComputeKey("some ir", 1, "target", "b"));
+  EXPECT_NE(key, JitObjectCache::ComputeKey("some ir", 3, "other", "b"));
+  EXPECT_NE(key, JitObjectCache::ComputeKey("some ir", 3, "target", "c"));
+}
+
+TEST(JitObjectCacheTest, EvictsLeastRecentlyUsedEntries) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitObjectCache> cache,
+      JitObjectCache::Create(temp_dir.path(), /*max_bytes=*/20));
+  std::vector<uint8_t> object_code(8, 42);
+  std::string a = JitObjectCache::ComputeKey("a", 3, "target", "b");
+  std::string b = JitObjectCache::ComputeKey("b", 3, "target", "b");
+  std::string c = JitObjectCache::ComputeKey("c", 3, "target", "b");
+  XLS_ASSERT_OK(cache->Insert(a, object_code));
+  XLS_ASSERT_OK(cache->Insert(b, object_code));
+
+  // Make `b` the least recently used entry.
+  std::filesystem::path b_path = temp_dir.path() / absl::StrCat(b, ".o");
+  std::filesystem::last_write_time(
+      b_path, std::filesystem::last_write_time(b_path) - std::chrono::hours(1));
+
+  // The third entry exceeds the limit so `b` is evicted.
+  XLS_ASSERT_OK(cache->Insert(c, object_code));
+  EXPECT_THAT(cache->Lookup(a), IsOkAndHolds(Optional(object_code)));
+  EXPECT_THAT(cache->Lookup(b), IsOkAndHolds(std::nullopt));
+  EXPECT_THAT(cache->Lookup(c), IsOkAndHolds(Optional(object_code)));
+}
+
+TEST(JitObjectCacheTest, SecondJitHitsCache) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  Package package("my_package");
+  std::string ir_text = R"(
+    fn f(x: bits[32], y: bits[32]) -> bits[32] {
+      ret add.1: bits[32] = add(x, y)
+    }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<OrcJit> cold_jit,
+      OrcJit::Create(/*opt_level=*/3, /*emit_object_code=*/false,
+                     temp_dir.path()));
+  XLS_ASSERT_OK(BuildFunction(function, *cold_jit).status());
+  EXPECT_EQ(cold_jit->object_cache()->hit_count(), 0);
+  EXPECT_GT(cold_jit->object_cache()->miss_count(), 0);
+
+  // A fresh JIT, as in a new process, loads the object code from the cache.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<OrcJit> warm_jit,
+      OrcJit::Create(/*opt_level=*/3, /*emit_object_code=*/false,
+                     temp_dir.path()));
+  XLS_ASSERT_OK(BuildFunction(function, *warm_jit).status());
+  EXPECT_GT(warm_jit->object_cache()->hit_count(), 0);
+  EXPECT_EQ(warm_jit->object_cache()->miss_count(), 0);
+}
+
+TEST(JitObjectCacheTest, ModulesWithHostAddressesAreNotCached) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  Package package("my_package");
+  // The trace calls a runtime callback whose address is embedded in the code.
+  std::string ir_text = R"(
+  fn f(tkn: token, pred: bits[1]) -> token {
+    ret trace.1: token = trace(tkn, pred, format="hi", data_operands=[], id=1)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<OrcJit> jit,
+      OrcJit::Create(/*opt_level=*/3, /*emit_object_code=*/false,
+                     temp_dir.path()));
+  XLS_ASSERT_OK(BuildFunction(function, *jit).status());
+  EXPECT_EQ(jit->object_cache()->hit_count(), 0);
+  EXPECT_EQ(jit->object_cache()->miss_count(), 0);
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::filesystem::path> entries,
+                           GetDirectoryEntries(temp_dir.path()));
+  EXPECT_TRUE(entries.empty());
+}
+
+TEST(JitObjectCacheTest, FunctionJitWarmStart) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  absl::SetFlag(&FLAGS_xls_jit_object_cache_dir, temp_dir.path().string());
+
+  auto run_once = [](int64_t x, int64_t y) -> absl::StatusOr<Value> {
+    Package package("my_package");
+    std::string ir_text = R"(
+      fn f(x: bits[32], y: bits[32]) -> bits[32] {
+        ret add.1: bits[32] = add(x, y)
+      }
+    )";
+    XLS_ASSIGN_OR_RETURN(Function * function,
+                         Parser::ParseFunction(ir_text, &package));
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
+                         FunctionJit::Create(function));
+    std::vector<Value> args = {Value(UBits(x, 32)), Value(UBits(y, 32))};
+    return DropInterpreterEvents(jit->Run(args));
+  };
+
+  // The first run populates the cache, the second run loads the object code
+  // from the cache.
+  EXPECT_THAT(run_once(1, 2), IsOkAndHolds(Value(UBits(3, 32))));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::filesystem::path> entries,
+                           GetDirectoryEntries(temp_dir.path()));
+  EXPECT_EQ(entries.size(), 1);
+
+  EXPECT_THAT(run_once(40, 2), IsOkAndHolds(Value(UBits(42, 32))));
+  XLS_ASSERT_OK_AND_ASSIGN(entries, GetDirectoryEntries(temp_dir.path()));
+  EXPECT_EQ(entries.size(), 1);
+
+  absl::SetFlag(&FLAGS_xls_jit_object_cache_dir, "");
+}
+
+}  // namespace
+}  // namespace xls
@@ -29,36 +29,72 @@
 #include "xls/jit/proc_jit.h"
 
 namespace xls {
+namespace {
 
-absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
-    Package* package) {
-  // Create a queue manager for the queues. This factory verifies that there an
-  // receive only queue for every receive only channel.
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitChannelQueueManager> queue_manager,
-                       JitChannelQueueManager::CreateThreadSafe(package));
-
-  // Create a ProcJit for each Proc.
+// Creates a ProcJit for each proc in the package.
+absl::StatusOr<std::vector<std::unique_ptr<ProcEvaluator>>> CreateProcJits(
+    Package* package, JitChannelQueueManager* queue_manager,
+    JitProfile* profile) {
   std::vector<std::unique_ptr<ProcEvaluator>> proc_jits;
   for (auto& proc : package->procs()) {
     XLS_ASSIGN_OR_RETURN(std::unique_ptr<ProcJit> proc_jit,
                          ProcJit::Create(proc.get(), &queue_manager->runtime(),
-                                         queue_manager.get()));
+                                         queue_manager, profile));
     proc_jits.push_back(std::move(proc_jit));
   }
+  return proc_jits;
+}
 
-  // Create a runtime.
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> proc_runtime,
-                       SerialProcRuntime::Create(package, std::move(proc_jits),
-                                                 std::move(queue_manager)));
-
-  // Inject initial values into channels.
+// Injects the initial values of each channel into its queue.
+absl::Status InjectInitialValues(Package* package, ProcRuntime* proc_runtime) {
   for (Channel* channel : package->channels()) {
     ChannelQueue& queue = proc_runtime->queue_manager().GetQueue(channel);
     for (const Value& value : channel->initial_values()) {
       XLS_RETURN_IF_ERROR(queue.Write(value));
     }
   }
+  return absl::OkStatus();
+}
+
+}  // namespace
 
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
+    Package* package, JitProfile* profile, JitTraceBuffer* trace_buffer) {
+  // Create a queue manager for the queues. All procs are ticked on the calling
+  // thread, so jitted code accesses the queues of internal channels directly.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitChannelQueueManager> queue_manager,
+                       JitChannelQueueManager::CreateSingleThreaded(package));
+  queue_manager->runtime().set_trace_buffer(trace_buffer);
+
+  XLS_ASSIGN_OR_RETURN(std::vector<std::unique_ptr<ProcEvaluator>> proc_jits,
+                       CreateProcJits(package, queue_manager.get(), profile));
+
+  // Create a runtime.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> proc_runtime,
+                       SerialProcRuntime::Create(package, std::move(proc_jits),
+                                                 std::move(queue_manager)));
+  XLS_RETURN_IF_ERROR(InjectInitialValues(package, proc_runtime.get()));
+  return std::move(proc_runtime);
+}
+
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(Package* package,
+                             std::optional<int64_t> thread_count,
+                             JitProfile* profile,
+                             JitTraceBuffer* trace_buffer) {
+  // Each proc runs on at most one worker at a time and workers hand procs off
+  // under a mutex, so single-producer single-consumer channels may use
+  // lock-free queues.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitChannelQueueManager> queue_manager,
+                       JitChannelQueueManager::CreateLockFree(package));
+  queue_manager->runtime().set_trace_buffer(trace_buffer);
+  XLS_ASSIGN_OR_RETURN(std::vector<std::unique_ptr<ProcEvaluator>> proc_jits,
+                       CreateProcJits(package, queue_manager.get(), profile));
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<ParallelProcRuntime> proc_runtime,
+      ParallelProcRuntime::Create(package, std::move(proc_jits),
+                                  std::move(queue_manager), thread_count));
+  XLS_RETURN_IF_ERROR(InjectInitialValues(package, proc_runtime.get()));
   return std::move(proc_runtime);
 }
 
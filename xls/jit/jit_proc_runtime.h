@@ -15,17 +15,35 @@
 #ifndef XLS_JIT_JIT_PROC_RUNTIME_H_
 #define XLS_JIT_JIT_PROC_RUNTIME_H_
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 
 #include "absl/status/statusor.h"
+#include "xls/interpreter/parallel_proc_runtime.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/package.h"
+#include "xls/jit/jit_profile.h"
+#include "xls/jit/jit_trace_buffer.h"
 
 namespace xls {
 
-// Create a SerialProcRuntime composed of ProcJits.
+// Create a SerialProcRuntime composed of ProcJits. If `profile` is non-null
+// the procs record execution counters into it (see JitProfile). If
+// `trace_buffer` is non-null trace events are recorded into it rather than
+// into the procs' interpreter events (see JitTraceBuffer). Both must outlive
+// the runtime.
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
-    Package* package);
+    Package* package, JitProfile* profile = nullptr,
+    JitTraceBuffer* trace_buffer = nullptr);
+
+// Creates a runtime which ticks the JIT-compiled procs of the package
+// concurrently on `thread_count` worker threads (see ParallelProcRuntime).
+// Channels with a single producer and consumer use lock-free queues.
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(
+    Package* package, std::optional<int64_t> thread_count = std::nullopt,
+    JitProfile* profile = nullptr, JitTraceBuffer* trace_buffer = nullptr);
 
 }  // namespace xls
 
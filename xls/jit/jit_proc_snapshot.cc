@@ -0,0 +1,154 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_proc_snapshot.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/jit/jit_channel_queue.h"
+
+namespace xls {
+namespace {
+
+absl::StatusOr<ProcJitContinuation*> GetJitContinuation(ProcRuntime& runtime,
+                                                        Proc* proc) {
+  auto* continuation =
+      dynamic_cast<ProcJitContinuation*>(&runtime.GetContinuation(proc));
+  if (continuation == nullptr) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Proc `%s` is not evaluated by the JIT", proc->name()));
+  }
+  return continuation;
+}
+
+std::vector<uint8_t> ToBytes(const std::string& s) {
+  return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+std::string ToString(absl::Span<const uint8_t> bytes) {
+  return std::string(bytes.begin(), bytes.end());
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<JitProcNetworkSnapshot>
+JitProcNetworkSnapshot::Capture(ProcRuntime& runtime) {
+  JitProcNetworkSnapshot snapshot(runtime.package());
+  for (const std::unique_ptr<Proc>& proc : runtime.package()->procs()) {
+    XLS_ASSIGN_OR_RETURN(ProcJitContinuation * continuation,
+                         GetJitContinuation(runtime, proc.get()));
+    snapshot.proc_states_[proc.get()] = continuation->SaveState();
+  }
+  XLS_ASSIGN_OR_RETURN(JitChannelQueueManager * queue_manager,
+                       runtime.GetJitChannelQueueManager());
+  for (Channel* channel : runtime.package()->channels()) {
+    JitChannelQueue& queue = queue_manager->GetJitQueue(channel);
+    QueueContents& contents = snapshot.queue_contents_[channel];
+    contents.contents = queue.GetRawContents();
+    contents.element_count =
+        queue.raw_element_size() == 0
+            ? queue.GetSize()
+            : contents.contents.size() / queue.raw_element_size();
+  }
+  return snapshot;
+}
+
+absl::Status JitProcNetworkSnapshot::Restore(ProcRuntime& runtime) const {
+  XLS_RET_CHECK_EQ(runtime.package(), package_)
+      << "Snapshot is of a different package";
+  for (const auto& [proc, state] : proc_states_) {
+    XLS_ASSIGN_OR_RETURN(ProcJitContinuation * continuation,
+                         GetJitContinuation(runtime, proc));
+    XLS_RETURN_IF_ERROR(continuation->RestoreState(state));
+  }
+  XLS_ASSIGN_OR_RETURN(JitChannelQueueManager * queue_manager,
+                       runtime.GetJitChannelQueueManager());
+  for (const auto& [channel, contents] : queue_contents_) {
+    XLS_RETURN_IF_ERROR(
+        queue_manager->GetJitQueue(channel).SetRawContents(
+            contents.contents, contents.element_count));
+  }
+  return absl::OkStatus();
+}
+
+/* static */ absl::StatusOr<JitProcNetworkSnapshot>
+JitProcNetworkSnapshot::FromProto(const JitProcNetworkSnapshotProto& proto,
+                                  Package* package) {
+  JitProcNetworkSnapshot snapshot(package);
+  for (const ProcJitStateProto& proc_proto : proto.procs()) {
+    XLS_ASSIGN_OR_RETURN(Proc * proc, package->GetProc(proc_proto.proc()));
+    ProcJitContinuationState& state = snapshot.proc_states_[proc];
+    state.continuation_point = proc_proto.continuation_point();
+    for (const std::string& buffer : proc_proto.input_buffers()) {
+      state.input_buffers.push_back(ToBytes(buffer));
+    }
+    for (const std::string& buffer : proc_proto.output_buffers()) {
+      state.output_buffers.push_back(ToBytes(buffer));
+    }
+    state.temp_buffer = ToBytes(proc_proto.temp_buffer());
+  }
+  for (const JitChannelQueueStateProto& queue_proto : proto.queues()) {
+    XLS_ASSIGN_OR_RETURN(Channel * channel,
+                         package->GetChannel(queue_proto.channel()));
+    QueueContents& contents = snapshot.queue_contents_[channel];
+    contents.element_count = queue_proto.element_count();
+    contents.contents = ToBytes(queue_proto.contents());
+  }
+  return snapshot;
+}
+
+JitProcNetworkSnapshotProto JitProcNetworkSnapshot::ToProto() const {
+  JitProcNetworkSnapshotProto proto;
+  // Emit in package order so the serialization is deterministic.
+  for (const std::unique_ptr<Proc>& proc : package_->procs()) {
+    auto it = proc_states_.find(proc.get());
+    if (it == proc_states_.end()) {
+      continue;
+    }
+    const ProcJitContinuationState& state = it->second;
+    ProcJitStateProto* proc_proto = proto.add_procs();
+    proc_proto->set_proc(proc->name());
+    proc_proto->set_continuation_point(state.continuation_point);
+    for (const std::vector<uint8_t>& buffer : state.input_buffers) {
+      proc_proto->add_input_buffers(ToString(buffer));
+    }
+    for (const std::vector<uint8_t>& buffer : state.output_buffers) {
+      proc_proto->add_output_buffers(ToString(buffer));
+    }
+    proc_proto->set_temp_buffer(ToString(state.temp_buffer));
+  }
+  for (Channel* channel : package_->channels()) {
+    auto it = queue_contents_.find(channel);
+    if (it == queue_contents_.end()) {
+      continue;
+    }
+    JitChannelQueueStateProto* queue_proto = proto.add_queues();
+    queue_proto->set_channel(channel->name());
+    queue_proto->set_element_count(it->second.element_count);
+    queue_proto->set_contents(ToString(it->second.contents));
+  }
+  return proto;
+}
+
+}  // namespace xls
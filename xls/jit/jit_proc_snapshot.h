@@ -0,0 +1,86 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_JIT_PROC_SNAPSHOT_H_
+#define XLS_JIT_JIT_PROC_SNAPSHOT_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/jit/jit_proc_snapshot.pb.h"
+#include "xls/jit/proc_jit.h"
+
+namespace xls {
+
+// A snapshot of the state of a runtime of JIT-compiled procs (see
+// CreateJitSerialProcRuntime): the continuation state of every proc and the
+// contents of every channel queue. State is captured as the native-layout
+// byte buffers used by the JIT, without converting to Values, so capturing
+// and restoring take time linear in the size of the state. A snapshot may be
+// restored any number of times, e.g., to fork many experiments from a state
+// reached after a warm-up phase, and into any JIT proc runtime of the same
+// package. Snapshots may be serialized to protos for use by another process
+// on a host with the same native data layout.
+//
+// Interpreter events and channel queue generators are not part of the
+// snapshot. The runtime must not be ticking while a snapshot is captured or
+// restored.
+class JitProcNetworkSnapshot {
+ public:
+  struct QueueContents {
+    int64_t element_count = 0;
+    // `element_count` elements in the native layout packed back to back.
+    std::vector<uint8_t> contents;
+  };
+
+  // Captures the current state of `runtime`. Returns an error if the runtime
+  // is not composed of ProcJits and JIT channel queues.
+  static absl::StatusOr<JitProcNetworkSnapshot> Capture(ProcRuntime& runtime);
+
+  // Restores `runtime` to the captured state.
+  absl::Status Restore(ProcRuntime& runtime) const;
+
+  // Converts snapshots to/from protos. Procs and channels are referred to by
+  // name and resolved in `package` when converting from a proto.
+  static absl::StatusOr<JitProcNetworkSnapshot> FromProto(
+      const JitProcNetworkSnapshotProto& proto, Package* package);
+  JitProcNetworkSnapshotProto ToProto() const;
+
+  Package* package() const { return package_; }
+  const absl::flat_hash_map<Proc*, ProcJitContinuationState>& proc_states()
+      const {
+    return proc_states_;
+  }
+  const absl::flat_hash_map<Channel*, QueueContents>& queue_contents() const {
+    return queue_contents_;
+  }
+
+ private:
+  explicit JitProcNetworkSnapshot(Package* package) : package_(package) {}
+
+  Package* package_;
+  absl::flat_hash_map<Proc*, ProcJitContinuationState> proc_states_;
+  absl::flat_hash_map<Channel*, QueueContents> queue_contents_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_PROC_SNAPSHOT_H_
@@ -0,0 +1,199 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_proc_snapshot.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_proc_runtime.h"
+#include "xls/jit/jit_proc_snapshot.pb.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using testing::HasSubstr;
+
+// `producer` sends an incrementing count to `consumer` which adds it and a
+// value received from the `in` channel to its accumulator and sends the sum on
+// `out`. The consumer blocks mid-tick when `in` is empty.
+constexpr char kNetwork[] = R"(
+package test
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="""""")
+chan out(bits[32], id=1, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="""""")
+chan internal(bits[32], id=2, kind=streaming, ops=send_receive, flow_control=ready_valid, metadata="""""")
+
+proc producer(tkn: token, count: bits[32], init={1}) {
+  one: bits[32] = literal(value=1)
+  send.1: token = send(tkn, count, channel_id=2)
+  next_count: bits[32] = add(count, one)
+  next (send.1, next_count)
+}
+
+proc consumer(tkn: token, acc: bits[32], init={0}) {
+  rcv_internal: (token, bits[32]) = receive(tkn, channel_id=2)
+  internal_tkn: token = tuple_index(rcv_internal, index=0)
+  x: bits[32] = tuple_index(rcv_internal, index=1)
+  rcv_in: (token, bits[32]) = receive(internal_tkn, channel_id=0)
+  in_tkn: token = tuple_index(rcv_in, index=0)
+  y: bits[32] = tuple_index(rcv_in, index=1)
+  x_plus_y: bits[32] = add(x, y)
+  sum: bits[32] = add(acc, x_plus_y)
+  send.2: token = send(in_tkn, sum, channel_id=1)
+  next (send.2, sum)
+}
+)";
+
+class JitProcSnapshotTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(package_, Parser::ParsePackage(kNetwork));
+    XLS_ASSERT_OK_AND_ASSIGN(in_, package_->GetChannel("in"));
+    XLS_ASSERT_OK_AND_ASSIGN(out_, package_->GetChannel("out"));
+    XLS_ASSERT_OK_AND_ASSIGN(consumer_, package_->GetProc("consumer"));
+  }
+
+  // Feeds two inputs, ticks the network and returns everything written to
+  // `out` followed by the state of the consumer.
+  absl::StatusOr<std::vector<Value>> RunExperiment(ProcRuntime& runtime,
+                                                   int64_t input) {
+    ChannelQueue& in_queue = runtime.queue_manager().GetQueue(in_);
+    XLS_RETURN_IF_ERROR(in_queue.Write(Value(UBits(input, 32))));
+    XLS_RETURN_IF_ERROR(in_queue.Write(Value(UBits(input + 1, 32))));
+    for (int64_t i = 0; i < 3; ++i) {
+      XLS_RETURN_IF_ERROR(runtime.Tick());
+    }
+    std::vector<Value> result;
+    ChannelQueue& out_queue = runtime.queue_manager().GetQueue(out_);
+    while (std::optional<Value> value = out_queue.Read()) {
+      result.push_back(*value);
+    }
+    for (const Value& state : runtime.ResolveState(consumer_)) {
+      result.push_back(state);
+    }
+    return result;
+  }
+
+  // Creates a runtime which has been ticked until the consumer is blocked
+  // mid-tick with values buffered on the internal and output channels.
+  absl::StatusOr<std::unique_ptr<ProcRuntime>> CreateWarmRuntime() {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<ProcRuntime> runtime,
+                         CreateJitSerialProcRuntime(package_.get()));
+    ChannelQueue& in_queue = runtime->queue_manager().GetQueue(in_);
+    XLS_RETURN_IF_ERROR(in_queue.Write(Value(UBits(10, 32))));
+    for (int64_t i = 0; i < 3; ++i) {
+      XLS_RETURN_IF_ERROR(runtime->Tick());
+    }
+    return runtime;
+  }
+
+  std::unique_ptr<Package> package_;
+  Channel* in_;
+  Channel* out_;
+  Proc* consumer_;
+};
+
+TEST_F(JitProcSnapshotTest, ForkFromSnapshot) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ProcRuntime> runtime,
+                           CreateWarmRuntime());
+  EXPECT_FALSE(runtime->GetContinuation(consumer_).AtStartOfTick());
+  EXPECT_EQ(runtime->queue_manager().GetQueue(out_).GetSize(), 1);
+
+  XLS_ASSERT_OK_AND_ASSIGN(JitProcNetworkSnapshot snapshot,
+                           JitProcNetworkSnapshot::Capture(*runtime));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Value> first,
+                           RunExperiment(*runtime, 100));
+  // The output buffered before the snapshot and the two new sums.
+  ASSERT_EQ(first.size(), 4);
+  EXPECT_EQ(first[0], Value(UBits(11, 32)));
+
+  for (int64_t input : {100, 1000}) {
+    XLS_ASSERT_OK(snapshot.Restore(*runtime));
+    EXPECT_FALSE(runtime->GetContinuation(consumer_).AtStartOfTick());
+    XLS_ASSERT_OK_AND_ASSIGN(std::vector<Value> result,
+                             RunExperiment(*runtime, input));
+    if (input == 100) {
+      EXPECT_EQ(result, first);
+    } else {
+      EXPECT_NE(result, first);
+      EXPECT_EQ(result[0], first[0]);
+    }
+  }
+}
+
+TEST_F(JitProcSnapshotTest, SerializedSnapshotRestoresInFreshRuntime) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ProcRuntime> runtime,
+                           CreateWarmRuntime());
+  XLS_ASSERT_OK_AND_ASSIGN(JitProcNetworkSnapshot snapshot,
+                           JitProcNetworkSnapshot::Capture(*runtime));
+  std::string serialized = snapshot.ToProto().SerializeAsString();
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Value> expected,
+                           RunExperiment(*runtime, 7));
+
+  JitProcNetworkSnapshotProto proto;
+  ASSERT_TRUE(proto.ParseFromString(serialized));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      JitProcNetworkSnapshot restored,
+      JitProcNetworkSnapshot::FromProto(proto, package_.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ProcRuntime> fresh,
+                           CreateJitParallelProcRuntime(package_.get()));
+  XLS_ASSERT_OK(restored.Restore(*fresh));
+  EXPECT_THAT(RunExperiment(*fresh, 7),
+              status_testing::IsOkAndHolds(expected));
+}
+
+TEST_F(JitProcSnapshotTest, InvalidSnapshot) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ProcRuntime> runtime,
+                           CreateWarmRuntime());
+  XLS_ASSERT_OK_AND_ASSIGN(JitProcNetworkSnapshot snapshot,
+                           JitProcNetworkSnapshot::Capture(*runtime));
+  JitProcNetworkSnapshotProto proto = snapshot.ToProto();
+  proto.mutable_procs(0)->mutable_input_buffers(0)->push_back('x');
+  XLS_ASSERT_OK_AND_ASSIGN(
+      JitProcNetworkSnapshot bad,
+      JitProcNetworkSnapshot::FromProto(proto, package_.get()));
+  EXPECT_THAT(bad.Restore(*runtime),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Invalid state for proc")));
+
+  proto = snapshot.ToProto();
+  proto.mutable_queues(0)->set_element_count(12);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      bad, JitProcNetworkSnapshot::FromProto(proto, package_.get()));
+  EXPECT_THAT(bad.Restore(*runtime),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Invalid contents for channel queue")));
+
+  proto.mutable_queues(0)->set_channel("nonexistent");
+  EXPECT_THAT(JitProcNetworkSnapshot::FromProto(proto, package_.get()),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+}  // namespace
+}  // namespace xls
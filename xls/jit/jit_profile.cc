@@ -0,0 +1,153 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_profile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+// Maximum number of node names listed for a partition in the report.
+constexpr int64_t kMaxPartitionNodeNames = 3;
+
+// Returns the source location of the first node with a location as
+// "<file>:<line>" or the empty string if no node has a location.
+std::string NodesLocation(absl::Span<Node* const> nodes) {
+  for (Node* node : nodes) {
+    if (!node->loc().Empty()) {
+      return node->package()->SourceLocationToString(
+          node->loc().locations.front());
+    }
+  }
+  return "";
+}
+
+std::string DescribeEntry(const JitProfile::Entry& entry) {
+  if (entry.is_node_counter) {
+    return absl::StrFormat("%s:%d %s", entry.function_base->name(),
+                           entry.partition, entry.nodes.front()->GetName());
+  }
+  std::vector<std::string> names;
+  for (int64_t i = 0;
+       i < entry.nodes.size() && i < kMaxPartitionNodeNames; ++i) {
+    names.push_back(entry.nodes[i]->GetName());
+  }
+  if (entry.nodes.size() > kMaxPartitionNodeNames) {
+    names.push_back("...");
+  }
+  return absl::StrFormat("%s:%d (%d nodes: %s)", entry.function_base->name(),
+                         entry.partition, entry.nodes.size(),
+                         absl::StrJoin(names, ", "));
+}
+
+}  // namespace
+
+absl::StatusOr<JitProfileMode> JitProfileModeFromString(std::string_view s) {
+  if (s == "partition") {
+    return JitProfileMode::kPartition;
+  }
+  if (s == "node") {
+    return JitProfileMode::kNode;
+  }
+  return absl::InvalidArgumentError(absl::StrFormat(
+      "Invalid JIT profile mode `%s`; expected `partition` or `node`", s));
+}
+
+JitProfileCounter* JitProfile::AddPartitionCounter(
+    FunctionBase* function_base, int64_t partition,
+    absl::Span<Node* const> nodes) {
+  entries_.push_back(Entry{.function_base = function_base,
+                           .partition = partition,
+                           .nodes = std::vector<Node*>(nodes.begin(),
+                                                       nodes.end()),
+                           .is_node_counter = false});
+  return &counters_.emplace_back();
+}
+
+JitProfileCounter* JitProfile::AddNodeCounter(FunctionBase* function_base,
+                                              int64_t partition, Node* node) {
+  entries_.push_back(Entry{.function_base = function_base,
+                           .partition = partition,
+                           .nodes = {node},
+                           .is_node_counter = true});
+  return &counters_.emplace_back();
+}
+
+void JitProfile::Reset() {
+  for (JitProfileCounter& counter : counters_) {
+    counter = JitProfileCounter();
+  }
+}
+
+std::string JitProfile::ToString(int64_t max_rows) const {
+  std::string result;
+  for (bool node_counters : {false, true}) {
+    std::vector<int64_t> indices;
+    int64_t total_cycles = 0;
+    for (int64_t i = 0; i < entries_.size(); ++i) {
+      if (entries_[i].is_node_counter == node_counters) {
+        indices.push_back(i);
+        total_cycles += counters_[i].cycles;
+      }
+    }
+    if (indices.empty()) {
+      continue;
+    }
+    std::stable_sort(indices.begin(), indices.end(), [&](int64_t a, int64_t b) {
+      return counters_[a].cycles > counters_[b].cycles;
+    });
+
+    absl::StrAppendFormat(&result, "%s profile (%d cycles total):\n",
+                          node_counters ? "Node" : "Partition", total_cycles);
+    absl::StrAppendFormat(&result, "%14s %7s %12s %12s  %s\n", "cycles", "%",
+                          "count", "cycles/exec", "location");
+    for (int64_t i = 0; i < indices.size() && i < max_rows; ++i) {
+      const Entry& entry = entries_[indices[i]];
+      const JitProfileCounter& counter = counters_[indices[i]];
+      double percent =
+          total_cycles == 0
+              ? 0.0
+              : 100.0 * counter.cycles / static_cast<double>(total_cycles);
+      int64_t cycles_per_exec =
+          counter.count == 0 ? 0 : counter.cycles / counter.count;
+      std::string location = NodesLocation(entry.nodes);
+      absl::StrAppendFormat(
+          &result, "%14d %6.2f%% %12d %12d  %s%s\n", counter.cycles, percent,
+          counter.count, cycles_per_exec, DescribeEntry(entry),
+          location.empty() ? "" : absl::StrCat(" ", location));
+    }
+    if (indices.size() > max_rows) {
+      absl::StrAppendFormat(&result, "  (%d more not shown)\n",
+                            indices.size() - max_rows);
+    }
+  }
+  return result;
+}
+
+}  // namespace xls
@@ -0,0 +1,111 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_JIT_PROFILE_H_
+#define XLS_JIT_JIT_PROFILE_H_
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// Granularity of the profiling instrumentation emitted into jitted code.
+enum class JitProfileMode {
+  // Each partition of a jitted function records its execution count and
+  // elapsed cycles.
+  kPartition,
+  // In addition, each node records its execution count and elapsed cycles.
+  // Instrumenting every node inhibits optimization across nodes so the
+  // absolute numbers are inflated though the relative costs remain useful.
+  kNode,
+};
+
+// Parses a profile mode from its flag spelling: "partition" or "node".
+absl::StatusOr<JitProfileMode> JitProfileModeFromString(std::string_view s);
+
+// Counter updated by instrumented jitted code. Cycles are measured with the
+// host's cycle counter (e.g., rdtsc on x86).
+struct JitProfileCounter {
+  int64_t count = 0;
+  int64_t cycles = 0;
+};
+
+// Side buffer of counters which jitted code built with a profile writes
+// into. Describes what each counter measures so the counters can be mapped
+// back to IR nodes and their source locations. A profile may be shared by
+// several jits (e.g., all of the procs of a package) and must outlive them.
+//
+// Counters are updated without synchronization so a function or proc must
+// not be evaluated concurrently from multiple threads while profiled.
+class JitProfile {
+ public:
+  explicit JitProfile(JitProfileMode mode) : mode_(mode) {}
+
+  JitProfile(const JitProfile&) = delete;
+  JitProfile& operator=(const JitProfile&) = delete;
+
+  JitProfileMode mode() const { return mode_; }
+
+  // Describes the code measured by a counter.
+  struct Entry {
+    FunctionBase* function_base;
+    int64_t partition;
+    // The nodes of the partition for partition counters, or the single node
+    // of a node counter.
+    std::vector<Node*> nodes;
+    bool is_node_counter;
+  };
+
+  // Adds a counter for the given partition of `function_base` and returns
+  // it. The address of the counter is stable for the lifetime of the profile
+  // and is embedded in the jitted code.
+  JitProfileCounter* AddPartitionCounter(FunctionBase* function_base,
+                                         int64_t partition,
+                                         absl::Span<Node* const> nodes);
+
+  // Adds a counter for a single node of the given partition.
+  JitProfileCounter* AddNodeCounter(FunctionBase* function_base,
+                                    int64_t partition, Node* node);
+
+  int64_t size() const { return entries_.size(); }
+  const Entry& entry(int64_t i) const { return entries_.at(i); }
+  const JitProfileCounter& counter(int64_t i) const { return counters_.at(i); }
+
+  // Zeroes all counters.
+  void Reset();
+
+  // Returns a table of the counters in descending order of elapsed cycles.
+  // Partition and node counters are listed separately. Each row names the
+  // function, partition and nodes along with the source location of the nodes.
+  // At most `max_rows` rows are listed per table.
+  std::string ToString(int64_t max_rows = 50) const;
+
+ private:
+  JitProfileMode mode_;
+  std::vector<Entry> entries_;
+  // A deque so the addresses of counters do not change as counters are added.
+  std::deque<JitProfileCounter> counters_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_PROFILE_H_
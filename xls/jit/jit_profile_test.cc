@@ -0,0 +1,147 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_profile.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_proc_runtime.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using testing::HasSubstr;
+using testing::Not;
+
+class JitProfileTest : public IrTestBase {};
+
+TEST_F(JitProfileTest, ModeFromString) {
+  EXPECT_THAT(JitProfileModeFromString("partition"),
+              IsOkAndHolds(JitProfileMode::kPartition));
+  EXPECT_THAT(JitProfileModeFromString("node"),
+              IsOkAndHolds(JitProfileMode::kNode));
+  EXPECT_THAT(JitProfileModeFromString("nodes"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Invalid JIT profile mode")));
+}
+
+TEST_F(JitProfileTest, PartitionCounters) {
+  constexpr int64_t kRunCount = 10;
+  auto package = CreatePackage();
+  FunctionBuilder fb(TestName(), package.get());
+  BValue x = fb.Param("x", package->GetBitsType(32));
+  BValue y = fb.Param("y", package->GetBitsType(32));
+  fb.UMul(fb.Add(x, y), y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  JitProfile profile(JitProfileMode::kPartition);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                           FunctionJit::Create(f, /*opt_level=*/3, &profile));
+  ASSERT_GT(profile.size(), 0);
+  for (int64_t i = 0; i < kRunCount; ++i) {
+    std::vector<Value> args = {Value(UBits(i, 32)), Value(UBits(3, 32))};
+    XLS_ASSERT_OK(jit->Run(args).status());
+  }
+  for (int64_t i = 0; i < profile.size(); ++i) {
+    EXPECT_FALSE(profile.entry(i).is_node_counter);
+    EXPECT_EQ(profile.entry(i).function_base, f);
+    EXPECT_EQ(profile.counter(i).count, kRunCount);
+    EXPECT_GE(profile.counter(i).cycles, 0);
+  }
+  std::string report = profile.ToString();
+  EXPECT_THAT(report, HasSubstr("Partition profile"));
+  EXPECT_THAT(report, Not(HasSubstr("Node profile")));
+  EXPECT_THAT(report, HasSubstr(f->name()));
+
+  profile.Reset();
+  for (int64_t i = 0; i < profile.size(); ++i) {
+    EXPECT_EQ(profile.counter(i).count, 0);
+    EXPECT_EQ(profile.counter(i).cycles, 0);
+  }
+}
+
+TEST_F(JitProfileTest, NodeCounters) {
+  constexpr int64_t kRunCount = 7;
+  auto package = CreatePackage();
+  FunctionBuilder fb(TestName(), package.get());
+  BValue x = fb.Param("x", package->GetBitsType(128));
+  BValue y = fb.Param("y", package->GetBitsType(128));
+  fb.UMul(x, y, SourceInfo(), "my_mul");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  JitProfile profile(JitProfileMode::kNode);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                           FunctionJit::Create(f, /*opt_level=*/3, &profile));
+  for (int64_t i = 0; i < kRunCount; ++i) {
+    std::vector<Value> args = {Value(UBits(i, 128)), Value(UBits(42, 128))};
+    XLS_ASSERT_OK(jit->Run(args).status());
+  }
+
+  bool found_mul = false;
+  for (int64_t i = 0; i < profile.size(); ++i) {
+    const JitProfile::Entry& entry = profile.entry(i);
+    if (entry.is_node_counter && entry.nodes.front()->GetName() == "my_mul") {
+      found_mul = true;
+      EXPECT_EQ(profile.counter(i).count, kRunCount);
+    }
+  }
+  EXPECT_TRUE(found_mul);
+  std::string report = profile.ToString();
+  EXPECT_THAT(report, HasSubstr("Partition profile"));
+  EXPECT_THAT(report, HasSubstr("Node profile"));
+  EXPECT_THAT(report, HasSubstr("my_mul"));
+}
+
+TEST_F(JitProfileTest, ProcCounters) {
+  constexpr int64_t kTickCount = 5;
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(
+package test
+
+proc counter(tkn: token, st: bits[32], init={0}) {
+  one: bits[32] = literal(value=1)
+  next_st: bits[32] = add(st, one)
+  next (tkn, next_st)
+}
+)"));
+  JitProfile profile(JitProfileMode::kNode);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<SerialProcRuntime> runtime,
+      CreateJitSerialProcRuntime(package.get(), &profile));
+  for (int64_t i = 0; i < kTickCount; ++i) {
+    XLS_ASSERT_OK(runtime->Tick());
+  }
+  ASSERT_GT(profile.size(), 0);
+  for (int64_t i = 0; i < profile.size(); ++i) {
+    EXPECT_EQ(profile.counter(i).count, kTickCount);
+  }
+  EXPECT_THAT(profile.ToString(), HasSubstr("next_st"));
+}
+
+}  // namespace
+}  // namespace xls
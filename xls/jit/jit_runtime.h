@@ -15,21 +15,37 @@
 #ifndef XLS_JIT_JIT_RUNTIME_H_
 #define XLS_JIT_JIT_RUNTIME_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
+#include "xls/ir/package.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
+class JitTraceBuffer;
+
 // JitRuntime contains routines necessary for executing code generated by the
 // IR JIT. For type resolution, the JIT packs input data into and pulls
 // data out of a flat character buffer, thus these routines are necessary.
+//
+// Conversions are driven by TypeLayouts which are computed from the LLVM type
+// converter once per type and cached. Only computing a layout touches LLVM
+// state (under an exclusive lock); converting values of previously seen types
+// takes a shared lock so concurrent callers do not serialize. Layouts are
+// cached by the structure of the type and computed from a copy of the type
+// owned by the runtime, so types of any package may be passed to the runtime
+// and a cached layout is never stale.
 class JitRuntime {
  public:
   explicit JitRuntime(llvm::DataLayout data_layout);
@@ -45,10 +61,9 @@ class JitRuntime {
 
   // Returns a Value constructed from the data inside "buffer" whose
   // contents are laid out according to the LLVM interpretation of the passed-in
-  // type. If "unpoison" is set the buffer is marked as MSAN-unpoisoned as we
-  // determine its extent (from the result_type).
-  Value UnpackBuffer(const uint8_t* buffer, const Type* result_type,
-                     bool unpoison = false);
+  // type. The buffer is marked as MSAN-unpoisoned as its extent is determined
+  // (from the result_type).
+  Value UnpackBuffer(const uint8_t* buffer, const Type* result_type);
 
   // Splats the value into the buffer according to the data layout expected by
   // LLVM.
@@ -58,22 +73,59 @@ class JitRuntime {
   const llvm::DataLayout& data_layout() { return data_layout_; }
 
   int64_t GetTypeByteSize(Type* xls_type) {
-    absl::MutexLock lock(&mutex_);
-    return type_converter_->GetTypeByteSize(xls_type);
+    return GetTypeLayout(xls_type).size();
   }
 
+  // Returns the native layout of the given type. Layouts convert between
+  // Values and native buffers without traversing the type or locking the
+  // runtime so callers on hot paths should create them once and reuse them.
+  TypeLayout CreateTypeLayout(Type* xls_type) {
+    return GetTypeLayout(xls_type);
+  }
+
+  // Computes and caches the layouts of the given types so later conversions
+  // of values of these types never take the exclusive lock.
+  void PrecomputeTypeLayouts(absl::Span<Type* const> types);
+
+  // If set, jitted code using this runtime records trace events into `buffer`
+  // rather than formatting them into InterpreterEvents (see JitTraceBuffer).
+  // Must not be changed while jitted code is running.
+  void set_trace_buffer(JitTraceBuffer* buffer) { trace_buffer_ = buffer; }
+  JitTraceBuffer* trace_buffer() const { return trace_buffer_; }
+
  private:
-  Value UnpackBufferInternal(const uint8_t* buffer, const Type* result_type,
-                             bool unpoison) ABSL_SHARED_LOCKS_REQUIRED(mutex_);
-  void BlitValueToBufferInternal(const Value& value, const Type* type,
-                                 absl::Span<uint8_t> buffer)
-      ABSL_SHARED_LOCKS_REQUIRED(mutex_);
+  // Returns the cached layout of `type`, computing it on first use. The
+  // returned reference is valid for the lifetime of the runtime.
+  const TypeLayout& GetTypeLayout(const Type* type)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Hashes and compares types by structure without allocating, so
+  // structurally equal types of any package share a cached layout.
+  struct TypeStructureHash {
+    size_t operator()(const Type* type) const;
+  };
+  struct TypeStructureEq {
+    bool operator()(const Type* a, const Type* b) const {
+      return a->IsEqualTo(b);
+    }
+  };
 
   mutable absl::Mutex mutex_;
 
   const llvm::DataLayout data_layout_;
   std::unique_ptr<llvm::LLVMContext> context_ ABSL_GUARDED_BY(mutex_);
   std::unique_ptr<LlvmTypeConverter> type_converter_ ABSL_GUARDED_BY(mutex_);
+
+  // Owns the types keying `type_layouts_`, which the layouts also refer to, so
+  // they outlive the types passed by callers.
+  std::unique_ptr<Package> type_package_ ABSL_GUARDED_BY(mutex_);
+
+  // Layouts are boxed so references remain stable as the map grows.
+  absl::flat_hash_map<const Type*, std::unique_ptr<const TypeLayout>,
+                      TypeStructureHash, TypeStructureEq>
+      type_layouts_ ABSL_GUARDED_BY(mutex_);
+
+  JitTraceBuffer* trace_buffer_ = nullptr;
 };
 
 }  // namespace xls
@@ -0,0 +1,231 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_trace_buffer.h"
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/math_util.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/format_strings.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+std::string FormatTraceMessage(const Trace* trace, JitRuntime* runtime,
+                               const uint8_t* args) {
+  std::string message;
+  int64_t arg_index = 0;
+  int64_t offset = 0;
+  for (const FormatStep& step : trace->format()) {
+    if (std::holds_alternative<std::string>(step)) {
+      absl::StrAppend(&message, std::get<std::string>(step));
+      continue;
+    }
+    Type* type = trace->args()[arg_index++]->GetType();
+    Value value = runtime->UnpackBuffer(args + offset, type);
+    absl::StrAppend(&message,
+                    value.ToHumanString(std::get<FormatPreference>(step)));
+    offset = RoundUpToNearest(offset + runtime->GetTypeByteSize(type),
+                              JitTraceBuffer::kArgAlignment);
+  }
+  return message;
+}
+
+JitTraceBuffer::JitTraceBuffer(int64_t capacity, TraceOverflowPolicy policy,
+                               FlushCallback flush)
+    : capacity_(RoundUpToNearest(capacity, kArgAlignment)),
+      policy_(policy),
+      flush_(std::move(flush)),
+      storage_(capacity_) {
+  XLS_CHECK(policy_ != TraceOverflowPolicy::kFlush || flush_ != nullptr)
+      << "kFlush overflow policy requires a flush callback";
+}
+
+void JitTraceBuffer::set_tick(int64_t tick) {
+  absl::MutexLock lock(&mutex_);
+  tick_ = tick;
+}
+
+void JitTraceBuffer::AdvanceTick() {
+  absl::MutexLock lock(&mutex_);
+  ++tick_;
+}
+
+int64_t JitTraceBuffer::tick() const {
+  absl::MutexLock lock(&mutex_);
+  return tick_;
+}
+
+int64_t JitTraceBuffer::size() const {
+  absl::MutexLock lock(&mutex_);
+  return record_count_;
+}
+
+int64_t JitTraceBuffer::dropped_count() const {
+  absl::MutexLock lock(&mutex_);
+  return dropped_count_;
+}
+
+/* static */ int64_t JitTraceBuffer::RecordSize(int64_t args_size) {
+  return sizeof(RecordHeader) + RoundUpToNearest(args_size, kArgAlignment);
+}
+
+int64_t JitTraceBuffer::Reserve(int64_t size) {
+  if (record_count_ == 0) {
+    ResetLocked();
+  }
+  if (!wrapped_) {
+    if (capacity_ - tail_ >= size) {
+      return tail_;
+    }
+    if (head_ >= size) {
+      wrap_end_ = tail_;
+      wrapped_ = true;
+      return 0;
+    }
+    return -1;
+  }
+  return head_ - tail_ >= size ? tail_ : -1;
+}
+
+void JitTraceBuffer::PopOldest() {
+  XLS_CHECK_GT(record_count_, 0);
+  RecordHeader header;
+  std::memcpy(&header, storage_.data() + head_, sizeof(header));
+  head_ += RecordSize(header.args_size);
+  --record_count_;
+  if (wrapped_ && head_ == wrap_end_) {
+    head_ = 0;
+    wrapped_ = false;
+  }
+  if (record_count_ == 0) {
+    ResetLocked();
+  }
+}
+
+void JitTraceBuffer::ResetLocked() {
+  head_ = 0;
+  tail_ = 0;
+  wrap_end_ = 0;
+  wrapped_ = false;
+  record_count_ = 0;
+}
+
+void JitTraceBuffer::Append(const Trace* trace, JitRuntime* runtime,
+                            const uint8_t* args, int64_t args_size) {
+  absl::MutexLock lock(&mutex_);
+  int64_t size = RecordSize(args_size);
+  if (size > capacity_) {
+    ++dropped_count_;
+    return;
+  }
+  int64_t offset = Reserve(size);
+  while (offset < 0) {
+    switch (policy_) {
+      case TraceOverflowPolicy::kDropNewest:
+        ++dropped_count_;
+        return;
+      case TraceOverflowPolicy::kDropOldest:
+        PopOldest();
+        ++dropped_count_;
+        break;
+      case TraceOverflowPolicy::kFlush:
+        ForEachRecordLocked(flush_);
+        ResetLocked();
+        break;
+    }
+    offset = Reserve(size);
+  }
+  RecordHeader header{.trace = trace,
+                      .runtime = runtime,
+                      .tick = tick_,
+                      .args_size = args_size};
+  std::memcpy(storage_.data() + offset, &header, sizeof(header));
+  if (args_size > 0) {
+    std::memcpy(storage_.data() + offset + sizeof(header), args, args_size);
+  }
+  tail_ = offset + size;
+  ++record_count_;
+}
+
+void JitTraceBuffer::ForEachRecordLocked(
+    const std::function<void(const Record&)>& f) const {
+  auto visit_range = [&](int64_t begin, int64_t end) {
+    for (int64_t offset = begin; offset < end;) {
+      RecordHeader header;
+      std::memcpy(&header, storage_.data() + offset, sizeof(header));
+      f(Record{.trace = header.trace,
+               .runtime = header.runtime,
+               .tick = header.tick,
+               .args = absl::MakeConstSpan(
+                   storage_.data() + offset + sizeof(header),
+                   header.args_size)});
+      offset += RecordSize(header.args_size);
+    }
+  };
+  if (record_count_ == 0) {
+    return;
+  }
+  if (wrapped_) {
+    visit_range(head_, wrap_end_);
+    visit_range(0, tail_);
+  } else {
+    visit_range(head_, tail_);
+  }
+}
+
+void JitTraceBuffer::ForEachRecord(
+    const std::function<void(const Record&)>& f) const {
+  absl::MutexLock lock(&mutex_);
+  ForEachRecordLocked(f);
+}
+
+std::vector<std::string> JitTraceBuffer::Drain() {
+  absl::MutexLock lock(&mutex_);
+  std::vector<std::string> messages;
+  messages.reserve(record_count_);
+  ForEachRecordLocked([&](const Record& record) {
+    messages.push_back(FormatRecord(record));
+  });
+  ResetLocked();
+  return messages;
+}
+
+void JitTraceBuffer::DrainTo(InterpreterEvents* events) {
+  for (std::string& message : Drain()) {
+    events->trace_msgs.push_back(std::move(message));
+  }
+}
+
+void JitTraceBuffer::Clear() {
+  absl::MutexLock lock(&mutex_);
+  ResetLocked();
+  dropped_count_ = 0;
+}
+
+/* static */ std::string JitTraceBuffer::FormatRecord(const Record& record) {
+  return FormatTraceMessage(record.trace, record.runtime, record.args.data());
+}
+
+}  // namespace xls
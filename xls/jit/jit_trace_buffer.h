@@ -0,0 +1,160 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_JIT_TRACE_BUFFER_H_
+#define XLS_JIT_JIT_TRACE_BUFFER_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/ir/events.h"
+#include "xls/ir/nodes.h"
+#include "xls/jit/jit_runtime.h"
+
+namespace xls {
+
+// What JitTraceBuffer::Append does when a record does not fit.
+enum class TraceOverflowPolicy {
+  // Discard the new record.
+  kDropNewest,
+  // Discard the oldest records until the new record fits.
+  kDropOldest,
+  // Pass all buffered records to the flush callback and empty the buffer.
+  kFlush,
+};
+
+// A preallocated ring of trace events recorded by JIT-compiled code. By
+// default jitted code formats each trace message as it fires and appends it to
+// InterpreterEvents::trace_msgs, which allocates on every event. When a
+// JitTraceBuffer is installed on the JitRuntime (JitRuntime::set_trace_buffer)
+// jitted code instead copies the trace's operands in their native layout into
+// the ring as a compact binary record. Recording never allocates; messages
+// are formatted only when the consumer asks for them.
+//
+// Records reference the Trace node and the JitRuntime which produced them so
+// both must outlive the records. The buffer is thread-safe so the procs of a
+// parallel proc runtime may share one.
+class JitTraceBuffer {
+ public:
+  // A recorded trace event. `args` holds the trace's data operands in the
+  // native layout, each at an offset aligned to kArgAlignment.
+  struct Record {
+    const Trace* trace;
+    JitRuntime* runtime;
+    int64_t tick;
+    absl::Span<const uint8_t> args;
+  };
+  using FlushCallback = std::function<void(const Record&)>;
+
+  static constexpr int64_t kArgAlignment = 8;
+
+  // Creates a buffer holding up to `capacity` bytes of records. Each record
+  // takes a fixed-size header plus its operand bytes. `flush` is required for
+  // (and only used by) the kFlush policy and receives records oldest first;
+  // it is called with the buffer locked and must not call back into it.
+  explicit JitTraceBuffer(int64_t capacity,
+                          TraceOverflowPolicy policy =
+                              TraceOverflowPolicy::kDropOldest,
+                          FlushCallback flush = nullptr);
+
+  JitTraceBuffer(const JitTraceBuffer&) = delete;
+  JitTraceBuffer& operator=(const JitTraceBuffer&) = delete;
+
+  // The tick number stamped on subsequently appended records. The buffer
+  // does not advance it itself; a ProcRuntime whose JitRuntime holds the
+  // buffer calls AdvanceTick after each tick of the proc network.
+  void set_tick(int64_t tick) ABSL_LOCKS_EXCLUDED(mutex_);
+  void AdvanceTick() ABSL_LOCKS_EXCLUDED(mutex_);
+  int64_t tick() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Records an event of `trace` whose packed operands are the `args_size`
+  // bytes at `args`. Called from jitted code.
+  void Append(const Trace* trace, JitRuntime* runtime, const uint8_t* args,
+              int64_t args_size) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Number of buffered records and of records discarded on overflow (or
+  // because they were larger than the buffer).
+  int64_t size() const ABSL_LOCKS_EXCLUDED(mutex_);
+  int64_t dropped_count() const ABSL_LOCKS_EXCLUDED(mutex_);
+  int64_t capacity() const { return capacity_; }
+
+  // Calls `f` on each buffered record, oldest first, without removing them.
+  // Record args are only valid for the duration of the call.
+  void ForEachRecord(const std::function<void(const Record&)>& f) const
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Formats the buffered records oldest first and removes them.
+  std::vector<std::string> Drain() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // As Drain but appends the messages to `events->trace_msgs`.
+  void DrainTo(InterpreterEvents* events) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Discards all buffered records and resets the dropped count.
+  void Clear() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the message of the given record as the interpreter would have
+  // produced it.
+  static std::string FormatRecord(const Record& record);
+
+ private:
+  struct RecordHeader {
+    const Trace* trace;
+    JitRuntime* runtime;
+    int64_t tick;
+    int64_t args_size;
+  };
+
+  static int64_t RecordSize(int64_t args_size);
+
+  // Returns the offset at which a record of `size` bytes can be written or -1
+  // if there is no room. Updates the wrap state if the record is placed at the
+  // start of the storage.
+  int64_t Reserve(int64_t size) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void PopOldest() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void ForEachRecordLocked(const std::function<void(const Record&)>& f) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void ResetLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const int64_t capacity_;
+  const TraceOverflowPolicy policy_;
+  const FlushCallback flush_;
+
+  mutable absl::Mutex mutex_;
+  std::vector<uint8_t> storage_ ABSL_GUARDED_BY(mutex_);
+
+  // Records occupy [head_, tail_) or, when `wrapped_`, [head_, wrap_end_)
+  // followed by [0, tail_).
+  int64_t head_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t tail_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t wrap_end_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool wrapped_ ABSL_GUARDED_BY(mutex_) = false;
+
+  int64_t record_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t dropped_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t tick_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+// Returns the message of `trace` whose packed operands (laid out as in
+// JitTraceBuffer records) are at `args`.
+std::string FormatTraceMessage(const Trace* trace, JitRuntime* runtime,
+                               const uint8_t* args);
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_TRACE_BUFFER_H_
@@ -0,0 +1,195 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_trace_buffer.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_proc_runtime.h"
+
+namespace xls {
+namespace {
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+class JitTraceBufferTest : public IrTestBase {
+ protected:
+  // Creates a jit of a function with a trace of its arguments and a trace
+  // without data operands.
+  absl::StatusOr<std::unique_ptr<FunctionJit>> CreateTracingJit(
+      Package* package) {
+    XLS_ASSIGN_OR_RETURN(Function * f, ParseFunction(R"(
+fn f(tkn: token, x: bits[8], y: bits[200]) -> token {
+  pred: bits[1] = literal(value=1)
+  trace.1: token = trace(tkn, pred, format="x={:d} y={:x}", data_operands=[x, y])
+  ret trace.2: token = trace(trace.1, pred, format="no args")
+}
+)",
+                                                     package));
+    return FunctionJit::Create(f);
+  }
+
+  absl::StatusOr<InterpreterEvents> Run(FunctionJit* jit, int64_t x) {
+    std::vector<Value> args = {Value::Token(), Value(SBits(x, 8)),
+                               Value(UBits(x + 1, 200))};
+    XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> result, jit->Run(args));
+    return result.events;
+  }
+};
+
+TEST_F(JitTraceBufferTest, FormatsImmediatelyWithoutBuffer) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                           CreateTracingJit(package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterEvents events, Run(jit.get(), 3));
+  EXPECT_THAT(events.trace_msgs, ElementsAre("x=3 y=0x4", "no args"));
+}
+
+TEST_F(JitTraceBufferTest, RecordsIntoBuffer) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                           CreateTracingJit(package.get()));
+  JitTraceBuffer buffer(/*capacity=*/4096);
+  jit->runtime()->set_trace_buffer(&buffer);
+
+  for (int64_t i = 0; i < 3; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterEvents events, Run(jit.get(), i));
+    EXPECT_THAT(events.trace_msgs, IsEmpty());
+    buffer.AdvanceTick();
+  }
+  EXPECT_EQ(buffer.size(), 6);
+  EXPECT_EQ(buffer.dropped_count(), 0);
+
+  std::vector<int64_t> ticks;
+  buffer.ForEachRecord([&](const JitTraceBuffer::Record& record) {
+    ticks.push_back(record.tick);
+  });
+  EXPECT_THAT(ticks, ElementsAre(0, 0, 1, 1, 2, 2));
+
+  EXPECT_THAT(buffer.Drain(),
+              ElementsAre("x=0 y=0x1", "no args", "x=1 y=0x2", "no args",
+                          "x=2 y=0x3", "no args"));
+  EXPECT_EQ(buffer.size(), 0);
+}
+
+TEST_F(JitTraceBufferTest, OverflowDropNewest) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                           CreateTracingJit(package.get()));
+  // Room for a few records only.
+  JitTraceBuffer buffer(/*capacity=*/200, TraceOverflowPolicy::kDropNewest);
+  jit->runtime()->set_trace_buffer(&buffer);
+  for (int64_t i = 0; i < 10; ++i) {
+    XLS_ASSERT_OK(Run(jit.get(), i).status());
+  }
+  std::vector<std::string> messages = buffer.Drain();
+  ASSERT_FALSE(messages.empty());
+  EXPECT_EQ(messages.front(), "x=0 y=0x1");
+  EXPECT_EQ(buffer.dropped_count() + messages.size(), 20);
+}
+
+TEST_F(JitTraceBufferTest, OverflowDropOldest) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                           CreateTracingJit(package.get()));
+  JitTraceBuffer buffer(/*capacity=*/200, TraceOverflowPolicy::kDropOldest);
+  jit->runtime()->set_trace_buffer(&buffer);
+  for (int64_t i = 0; i < 10; ++i) {
+    XLS_ASSERT_OK(Run(jit.get(), i).status());
+  }
+  std::vector<std::string> messages = buffer.Drain();
+  ASSERT_GE(messages.size(), 2);
+  EXPECT_EQ(messages[messages.size() - 2], "x=9 y=0xa");
+  EXPECT_EQ(messages.back(), "no args");
+  EXPECT_EQ(buffer.dropped_count() + messages.size(), 20);
+}
+
+TEST_F(JitTraceBufferTest, OverflowFlush) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                           CreateTracingJit(package.get()));
+  std::vector<std::string> flushed;
+  JitTraceBuffer buffer(/*capacity=*/200, TraceOverflowPolicy::kFlush,
+                        [&](const JitTraceBuffer::Record& record) {
+                          flushed.push_back(
+                              JitTraceBuffer::FormatRecord(record));
+                        });
+  jit->runtime()->set_trace_buffer(&buffer);
+  for (int64_t i = 0; i < 10; ++i) {
+    XLS_ASSERT_OK(Run(jit.get(), i).status());
+  }
+  EXPECT_FALSE(flushed.empty());
+  InterpreterEvents events;
+  buffer.DrainTo(&events);
+  flushed.insert(flushed.end(), events.trace_msgs.begin(),
+                 events.trace_msgs.end());
+  ASSERT_EQ(flushed.size(), 20);
+  EXPECT_EQ(buffer.dropped_count(), 0);
+  for (int64_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(flushed[2 * i], absl::StrFormat("x=%d y=0x%x", i, i + 1));
+    EXPECT_EQ(flushed[2 * i + 1], "no args");
+  }
+}
+
+TEST_F(JitTraceBufferTest, ProcRuntime) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(
+package test
+
+proc counter(tkn: token, st: bits[32], init={0}) {
+  one: bits[32] = literal(value=1)
+  pred: bits[1] = literal(value=1)
+  trace.1: token = trace(tkn, pred, format="st={}", data_operands=[st])
+  next_st: bits[32] = add(st, one)
+  next (trace.1, next_st)
+}
+)"));
+  JitTraceBuffer buffer(/*capacity=*/4096);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<SerialProcRuntime> runtime,
+      CreateJitSerialProcRuntime(package.get(), /*profile=*/nullptr, &buffer));
+  for (int64_t i = 0; i < 3; ++i) {
+    XLS_ASSERT_OK(runtime->Tick());
+  }
+  EXPECT_THAT(runtime->GetInterpreterEvents(package->procs().front().get())
+                  .trace_msgs,
+              IsEmpty());
+  // The runtime advances the buffer's tick after each tick of the network.
+  EXPECT_EQ(buffer.tick(), 3);
+  std::vector<int64_t> ticks;
+  buffer.ForEachRecord([&](const JitTraceBuffer::Record& record) {
+    ticks.push_back(record.tick);
+  });
+  EXPECT_THAT(ticks, ElementsAre(0, 1, 2));
+  EXPECT_THAT(buffer.Drain(), ElementsAre("st=0", "st=1", "st=2"));
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,222 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/multi_instance_proc_runtime.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/casts.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/strip.h"
+#include "google/protobuf/text_format.h"
+#include "llvm/include/llvm/IR/DataLayout.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/proc.h"
+#include "xls/jit/function_base_jit.h"
+#include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/type_layout.pb.h"
+
+namespace xls {
+
+absl::StatusOr<std::unique_ptr<MultiInstanceProcRuntime>>
+MultiInstanceProcRuntime::Create(Package* package, int64_t instance_count,
+                                 int64_t opt_level) {
+  XLS_RET_CHECK_GT(instance_count, 0);
+  std::vector<Proc*> procs;
+  for (const std::unique_ptr<Proc>& proc : package->procs()) {
+    procs.push_back(proc.get());
+  }
+  XLS_RET_CHECK(!procs.empty()) << "Package has no procs";
+
+  auto runtime = absl::WrapUnique(new MultiInstanceProcRuntime());
+  XLS_ASSIGN_OR_RETURN(runtime->orc_jit_, OrcJit::Create(opt_level));
+  XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout,
+                       runtime->orc_jit_->CreateDataLayout());
+  runtime->jit_runtime_ = std::make_unique<JitRuntime>(data_layout);
+  XLS_ASSIGN_OR_RETURN(std::vector<JittedFunctionBase> jitted_procs,
+                       BuildProcFunctionsWithHooks(procs, *runtime->orc_jit_));
+
+  // The tables are built as the AOT compiler emits them (see
+  // aot_compiler.cc), but in memory.
+  LlvmTypeConverter type_converter(runtime->orc_jit_->GetContext(),
+                                   data_layout);
+  TypeLayoutsProto layouts_proto;
+  absl::flat_hash_map<std::string, int64_t> layout_indices;
+  auto get_layout_index = [&](Type* type) {
+    auto [it, inserted] =
+        layout_indices.insert({type->ToString(), layouts_proto.layouts_size()});
+    if (inserted) {
+      *layouts_proto.add_layouts() =
+          type_converter.CreateTypeLayout(type).ToProto();
+    }
+    return it->second;
+  };
+
+  // The tables refer to names and initial values by pointer so their storage
+  // is sized up front.
+  int64_t state_element_count = 0;
+  for (Proc* proc : procs) {
+    state_element_count += proc->GetStateElementCount();
+  }
+  runtime->names_.reserve(package->channels().size() + procs.size());
+  runtime->initial_values_.reserve(state_element_count);
+  runtime->params_.reserve(procs.size());
+  runtime->blocking_points_.reserve(procs.size());
+
+  // Channels are listed in package order, which is the order of the channel
+  // hooks expected by the compiled code.
+  absl::flat_hash_map<int64_t, int64_t> channel_indices;
+  for (Channel* channel : package->channels()) {
+    channel_indices[channel->id()] = runtime->channels_.size();
+    runtime->names_.push_back(channel->name());
+    runtime->channels_.push_back(aot_compile::AotChannel{
+        .name = runtime->names_.back().c_str(),
+        .layout_index = get_layout_index(channel->type()),
+        .single_value = channel->kind() == ChannelKind::kSingleValue,
+    });
+  }
+
+  std::string package_prefix = absl::StrCat("__", package->name(), "__");
+  for (int64_t i = 0; i < procs.size(); ++i) {
+    Proc* proc = procs[i];
+    const JittedFunctionBase& jitted_proc = jitted_procs[i];
+    XLS_RET_CHECK(jitted_proc.multi_tick_function.has_value());
+    XLS_RET_CHECK_EQ(jitted_proc.input_buffer_sizes.size(),
+                     proc->params().size());
+
+    std::vector<aot_compile::AotProcParam>& params =
+        runtime->params_.emplace_back();
+    // The token.
+    params.push_back(aot_compile::AotProcParam{
+        .buffer_size = jitted_proc.input_buffer_sizes[0],
+        .layout_index = -1,
+        .initial_value = {},
+        .in_place = false,
+    });
+    for (int64_t j = 1; j < proc->params().size(); ++j) {
+      int64_t state_index = j - 1;
+      Type* type = proc->GetStateElementType(state_index);
+      std::vector<uint8_t>& initial_value =
+          runtime->initial_values_.emplace_back(
+              jitted_proc.input_buffer_sizes[j]);
+      if (!initial_value.empty()) {
+        type_converter.CreateTypeLayout(type).ValueToNativeLayout(
+            proc->GetInitValueElement(state_index), initial_value.data());
+      }
+      params.push_back(aot_compile::AotProcParam{
+          .buffer_size = jitted_proc.input_buffer_sizes[j],
+          .layout_index = get_layout_index(type),
+          .initial_value = initial_value,
+          .in_place = std::find(jitted_proc.in_place_state_indices.begin(),
+                                jitted_proc.in_place_state_indices.end(),
+                                state_index) !=
+                      jitted_proc.in_place_state_indices.end(),
+      });
+    }
+
+    // Multi-tick execution only stops at blocking receives.
+    std::vector<aot_compile::AotBlockingPoint>& blocking_points =
+        runtime->blocking_points_.emplace_back();
+    for (const auto& [point, node] : jitted_proc.continuation_points) {
+      if (node->Is<Receive>()) {
+        blocking_points.push_back(aot_compile::AotBlockingPoint{
+            .continuation_point = point,
+            .channel_index =
+                channel_indices.at(node->As<Receive>()->channel_id()),
+        });
+      }
+    }
+    std::sort(blocking_points.begin(), blocking_points.end(),
+              [](const aot_compile::AotBlockingPoint& a,
+                 const aot_compile::AotBlockingPoint& b) {
+                return a.continuation_point < b.continuation_point;
+              });
+
+    runtime->names_.push_back(
+        std::string(absl::StripPrefix(proc->name(), package_prefix)));
+    runtime->procs_.push_back(aot_compile::AotProcEntryPoint{
+        .name = runtime->names_.back().c_str(),
+        .function = absl::bit_cast<aot_compile::AotMultiTickFunctionType>(
+            *jitted_proc.multi_tick_function),
+        .params = params,
+        .blocking_points = blocking_points,
+    });
+  }
+
+  XLS_RET_CHECK(google::protobuf::TextFormat::PrintToString(
+      layouts_proto, &runtime->layouts_text_));
+  XLS_ASSIGN_OR_RETURN(
+      runtime->network_,
+      aot_compile::AotProcNetwork::Create(
+          runtime->layouts_text_, runtime->channels_, runtime->procs_,
+          jitted_procs.front().temp_buffer_size));
+  for (int64_t i = 0; i < instance_count; ++i) {
+    runtime->instances_.push_back(std::make_unique<aot_compile::AotProcRuntime>(
+        runtime->network_.get(), runtime->jit_runtime_.get()));
+  }
+  return runtime;
+}
+
+absl::Status MultiInstanceProcRuntime::Tick() {
+  // The (proc, instance) pairs which have not completed the tick, in
+  // proc-major order.
+  std::vector<std::pair<int64_t, int64_t>> pending;
+  pending.reserve(procs_.size() * instances_.size());
+  for (int64_t proc_index = 0; proc_index < procs_.size(); ++proc_index) {
+    for (int64_t instance_index = 0; instance_index < instances_.size();
+         ++instance_index) {
+      pending.push_back({proc_index, instance_index});
+    }
+  }
+  // The instances share no channels, so an instance which made no progress in
+  // a round makes none in later rounds either. Retrying while any instance
+  // progresses thus leaves each instance where its own Tick would.
+  bool progress_made = true;
+  while (!pending.empty() && progress_made) {
+    progress_made = false;
+    std::vector<std::pair<int64_t, int64_t>> blocked;
+    for (const auto& [proc_index, instance_index] : pending) {
+      bool proc_progress = false;
+      if (instances_[instance_index]->RunProc(proc_index, /*max_ticks=*/1,
+                                              &proc_progress) == 0) {
+        blocked.push_back({proc_index, instance_index});
+      }
+      progress_made |= proc_progress;
+    }
+    pending = std::move(blocked);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status MultiInstanceProcRuntime::TickN(int64_t count) {
+  XLS_RET_CHECK_GE(count, 0);
+  for (int64_t i = 0; i < count; ++i) {
+    XLS_RETURN_IF_ERROR(Tick());
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace xls
@@ -0,0 +1,91 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_MULTI_INSTANCE_PROC_RUNTIME_H_
+#define XLS_JIT_MULTI_INSTANCE_PROC_RUNTIME_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/ir/package.h"
+#include "xls/jit/aot_runtime.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/orc_jit.h"
+
+namespace xls {
+
+// Executes many independent instances of the network of procs of a package,
+// e.g., to run a Monte Carlo model of a channel with different stimulus per
+// instance. The procs are JIT-compiled once with channel accesses routed
+// through per-instance hook tables (see BuildProcFunctionsWithHooks), so each
+// instance costs only its state, temporary buffers and channel queues rather
+// than a compilation of its own as with one JIT proc runtime per instance.
+//
+// Instances are identified by index and accessed through the AotProcRuntime
+// of each to enqueue stimulus, dequeue results and inspect state. Proc and
+// channel names are those of the package with the package-scoping mangling
+// removed. Not thread-safe.
+class MultiInstanceProcRuntime {
+ public:
+  // Compiles the procs of `package`, which must outlive the returned object,
+  // and creates `instance_count` instances in their initial state.
+  static absl::StatusOr<std::unique_ptr<MultiInstanceProcRuntime>> Create(
+      Package* package, int64_t instance_count, int64_t opt_level = 3);
+
+  // Ticks every instance once, with the same semantics as
+  // AotProcRuntime::Tick for each instance. The instances are stepped in
+  // lockstep: each proc is run for all instances before the next proc, so the
+  // instances share the proc's code and table data in cache. Instances whose
+  // procs block are retried individually while any instance makes progress.
+  absl::Status Tick();
+
+  // Calls Tick() `count` times.
+  absl::Status TickN(int64_t count);
+
+  int64_t instance_count() const { return instances_.size(); }
+  aot_compile::AotProcRuntime& instance(int64_t index) {
+    return *instances_[index];
+  }
+  const aot_compile::AotProcRuntime& instance(int64_t index) const {
+    return *instances_[index];
+  }
+  const aot_compile::AotProcNetwork& network() const { return *network_; }
+
+ private:
+  MultiInstanceProcRuntime() = default;
+
+  std::unique_ptr<OrcJit> orc_jit_;
+  std::unique_ptr<JitRuntime> jit_runtime_;
+
+  // Storage of the tables describing the compiled network. AotProcNetwork
+  // refers to these without copying them.
+  std::string layouts_text_;
+  std::vector<std::string> names_;
+  std::vector<aot_compile::AotChannel> channels_;
+  std::vector<std::vector<uint8_t>> initial_values_;
+  std::vector<std::vector<aot_compile::AotProcParam>> params_;
+  std::vector<std::vector<aot_compile::AotBlockingPoint>> blocking_points_;
+  std::vector<aot_compile::AotProcEntryPoint> procs_;
+
+  std::unique_ptr<aot_compile::AotProcNetwork> network_;
+  std::vector<std::unique_ptr<aot_compile::AotProcRuntime>> instances_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_MULTI_INSTANCE_PROC_RUNTIME_H_
@@ -0,0 +1,127 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/multi_instance_proc_runtime.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::ElementsAre;
+using ::testing::Optional;
+
+// A producer sending an incrementing count to a consumer which adds it and a
+// value received from `in` to an accumulator sent on `out`.
+constexpr char kNetwork[] = R"(
+package net
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="""""")
+chan out(bits[32], id=1, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="""""")
+chan internal(bits[32], id=2, kind=streaming, ops=send_receive, flow_control=ready_valid, metadata="""""")
+
+proc producer(tkn: token, count: bits[32], init={1}) {
+  one: bits[32] = literal(value=1)
+  send.1: token = send(tkn, count, channel_id=2)
+  next_count: bits[32] = add(count, one)
+  next (send.1, next_count)
+}
+
+proc consumer(tkn: token, acc: bits[32], init={0}) {
+  rcv_internal: (token, bits[32]) = receive(tkn, channel_id=2)
+  internal_tkn: token = tuple_index(rcv_internal, index=0)
+  x: bits[32] = tuple_index(rcv_internal, index=1)
+  rcv_in: (token, bits[32]) = receive(internal_tkn, channel_id=0)
+  in_tkn: token = tuple_index(rcv_in, index=0)
+  y: bits[32] = tuple_index(rcv_in, index=1)
+  x_plus_y: bits[32] = add(x, y)
+  sum: bits[32] = add(acc, x_plus_y)
+  send.2: token = send(in_tkn, sum, channel_id=1)
+  next (send.2, sum)
+}
+)";
+
+Value U32(int64_t value) { return Value(UBits(value, 32)); }
+
+TEST(MultiInstanceProcRuntimeTest, InstancesRunIndependently) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kNetwork));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<MultiInstanceProcRuntime> runtime,
+      MultiInstanceProcRuntime::Create(package.get(), /*instance_count=*/3));
+  ASSERT_EQ(runtime->instance_count(), 3);
+
+  // Instance i receives 10 * i each tick.
+  for (int64_t tick = 0; tick < 2; ++tick) {
+    for (int64_t i = 0; i < 3; ++i) {
+      XLS_ASSERT_OK(runtime->instance(i).Enqueue("in", U32(10 * i)));
+    }
+  }
+  XLS_ASSERT_OK(runtime->TickN(2));
+  for (int64_t i = 0; i < 3; ++i) {
+    // Each tick adds the count and the input to the accumulator.
+    EXPECT_THAT(runtime->instance(i).Dequeue("out"),
+                IsOkAndHolds(Optional(U32(1 + 10 * i))));
+    EXPECT_THAT(runtime->instance(i).Dequeue("out"),
+                IsOkAndHolds(Optional(U32(3 + 20 * i))));
+    EXPECT_THAT(runtime->instance(i).GetState("consumer"),
+                IsOkAndHolds(ElementsAre(U32(3 + 20 * i))));
+    EXPECT_THAT(runtime->instance(i).GetState("producer"),
+                IsOkAndHolds(ElementsAre(U32(3))));
+  }
+}
+
+TEST(MultiInstanceProcRuntimeTest, BlockedInstancesDoNotHoldBackOthers) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kNetwork));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<MultiInstanceProcRuntime> runtime,
+      MultiInstanceProcRuntime::Create(package.get(), /*instance_count=*/2));
+
+  // Only instance 0 has input, so the consumer of instance 1 blocks.
+  XLS_ASSERT_OK(runtime->instance(0).Enqueue("in", U32(5)));
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_THAT(runtime->instance(0).Dequeue("out"),
+              IsOkAndHolds(Optional(U32(6))));
+  EXPECT_THAT(runtime->instance(1).Dequeue("out"),
+              IsOkAndHolds(std::nullopt));
+  EXPECT_THAT(runtime->instance(0).GetBlockedChannel("consumer"),
+              IsOkAndHolds(std::nullopt));
+  EXPECT_THAT(runtime->instance(1).GetBlockedChannel("consumer"),
+              IsOkAndHolds(Optional(std::string_view("in"))));
+
+  // Once its input arrives instance 1 resumes where it blocked.
+  XLS_ASSERT_OK(runtime->instance(0).Enqueue("in", U32(5)));
+  XLS_ASSERT_OK(runtime->instance(1).Enqueue("in", U32(7)));
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_THAT(runtime->instance(0).Dequeue("out"),
+              IsOkAndHolds(Optional(U32(13))));
+  EXPECT_THAT(runtime->instance(1).Dequeue("out"),
+              IsOkAndHolds(Optional(U32(8))));
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,293 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/native_float_lowering.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "llvm/include/llvm/IR/Constants.h"
+#include "llvm/include/llvm/IR/DerivedTypes.h"
+#include "llvm/include/llvm/IR/IRBuilder.h"
+#include "llvm/include/llvm/IR/Intrinsics.h"
+#include "llvm/include/llvm/IR/Type.h"
+#include "llvm/include/llvm/IR/Value.h"
+#include "xls/ir/function.h"
+#include "xls/ir/type.h"
+#include "xls/jit/llvm_type_converter.h"
+
+namespace xls {
+namespace {
+
+constexpr std::pair<std::string_view, NativeFloatOp> kOps[] = {
+    {"add", NativeFloatOp::kAdd},
+    {"sub", NativeFloatOp::kSub},
+    {"mul", NativeFloatOp::kMul},
+    {"fma", NativeFloatOp::kFma},
+};
+
+// Returns the exponent and fraction widths of `type` if it is the APFloat type
+// of an IEEE binary32 or binary64 value.
+std::optional<std::pair<int64_t, int64_t>> GetFloatFormat(Type* type) {
+  if (!type->IsTuple() || type->AsTupleOrDie()->size() != 3) {
+    return std::nullopt;
+  }
+  TupleType* tuple_type = type->AsTupleOrDie();
+  int64_t widths[3];
+  for (int64_t i = 0; i < 3; ++i) {
+    if (!tuple_type->element_type(i)->IsBits()) {
+      return std::nullopt;
+    }
+    widths[i] = tuple_type->element_type(i)->GetFlatBitCount();
+  }
+  if (widths[0] != 1 || !((widths[1] == 8 && widths[2] == 23) ||
+                          (widths[1] == 11 && widths[2] == 52))) {
+    return std::nullopt;
+  }
+  return std::make_pair(widths[1], widths[2]);
+}
+
+// Emits code for a float of the given routine's format held in an integer of
+// the same width.
+class FloatEmitter {
+ public:
+  FloatEmitter(const NativeFloatRoutine& routine, TupleType* float_type,
+               LlvmTypeConverter* type_converter, llvm::IRBuilder<>& builder)
+      : routine_(routine),
+        float_type_(float_type),
+        type_converter_(type_converter),
+        b_(builder),
+        width_(1 + routine.exponent_bit_count + routine.fraction_bit_count),
+        int_type_(b_.getIntNTy(width_)),
+        fp_type_(width_ == 32 ? b_.getFloatTy() : b_.getDoubleTy()) {}
+
+  llvm::Value* Constant(uint64_t value) {
+    return llvm::ConstantInt::get(int_type_, value);
+  }
+  llvm::Value* SignMask() { return Constant(uint64_t{1} << (width_ - 1)); }
+  llvm::Value* MaxExponent() {
+    return Constant((uint64_t{1} << routine_.exponent_bit_count) - 1);
+  }
+  llvm::Value* FractionMask() {
+    return Constant((uint64_t{1} << routine_.fraction_bit_count) - 1);
+  }
+
+  // Assembles the IEEE bit pattern of the APFloat tuple at `ptr`.
+  llvm::Value* Load(llvm::Value* ptr) {
+    llvm::Type* tuple_type = type_converter_->ConvertToLlvmType(float_type_);
+    llvm::Value* result = Constant(0);
+    for (int64_t i = 0; i < 3; ++i) {
+      llvm::Value* element = b_.CreateLoad(
+          type_converter_->ConvertToLlvmType(float_type_->element_type(i)),
+          b_.CreateStructGEP(tuple_type, ptr, i));
+      result = b_.CreateOr(
+          result, b_.CreateShl(b_.CreateZExtOrTrunc(element, int_type_),
+                               ElementShift(i)));
+    }
+    return result;
+  }
+
+  // Stores the IEEE bit pattern `value` as an APFloat tuple at `ptr`.
+  void Store(llvm::Value* value, llvm::Value* ptr) {
+    llvm::Type* tuple_type = type_converter_->ConvertToLlvmType(float_type_);
+    for (int64_t i = 0; i < 3; ++i) {
+      Type* element_type = float_type_->element_type(i);
+      llvm::Value* element = b_.CreateAnd(
+          b_.CreateLShr(value, ElementShift(i)),
+          Constant((uint64_t{1} << element_type->GetFlatBitCount()) - 1));
+      b_.CreateStore(
+          b_.CreateZExtOrTrunc(
+              element, type_converter_->ConvertToLlvmType(element_type)),
+          b_.CreateStructGEP(tuple_type, ptr, i));
+    }
+  }
+
+  llvm::Value* Exponent(llvm::Value* value) {
+    return b_.CreateAnd(
+        b_.CreateLShr(value, Constant(routine_.fraction_bit_count)),
+        MaxExponent());
+  }
+  llvm::Value* Fraction(llvm::Value* value) {
+    return b_.CreateAnd(value, FractionMask());
+  }
+  llvm::Value* Sign(llvm::Value* value) {
+    return b_.CreateAnd(value, SignMask());
+  }
+
+  // The stdlib treats all values with a zero exponent as (signed) zero.
+  llvm::Value* FlushSubnormal(llvm::Value* value) {
+    return b_.CreateSelect(b_.CreateICmpEQ(Exponent(value), Constant(0)),
+                           Sign(value), value);
+  }
+
+  llvm::Value* ToFp(llvm::Value* value) {
+    return b_.CreateBitCast(value, fp_type_);
+  }
+  llvm::Value* FromFp(llvm::Value* value) {
+    return b_.CreateBitCast(value, int_type_);
+  }
+
+  llvm::Type* fp_type() { return fp_type_; }
+  llvm::IRBuilder<>& builder() { return b_; }
+
+ private:
+  llvm::Value* ElementShift(int64_t index) {
+    switch (index) {
+      case 0:
+        return Constant(width_ - 1);
+      case 1:
+        return Constant(routine_.fraction_bit_count);
+      default:
+        return Constant(0);
+    }
+  }
+
+  const NativeFloatRoutine& routine_;
+  TupleType* float_type_;
+  LlvmTypeConverter* type_converter_;
+  llvm::IRBuilder<>& b_;
+  int64_t width_;
+  llvm::IntegerType* int_type_;
+  llvm::Type* fp_type_;
+};
+
+}  // namespace
+
+std::optional<NativeFloatRoutine> MatchNativeFloatRoutine(Function* function) {
+  std::optional<std::pair<int64_t, int64_t>> format =
+      GetFloatFormat(function->return_type());
+  if (!format.has_value()) {
+    return std::nullopt;
+  }
+  auto [exponent_bit_count, fraction_bit_count] = *format;
+  for (const auto& [op_name, op] : kOps) {
+    std::string float_name = absl::StrFormat(
+        "__float%d__%s", 1 + exponent_bit_count + fraction_bit_count, op_name);
+    std::string apfloat_name = absl::StrFormat(
+        "__apfloat__%s__%d_%d", op_name, exponent_bit_count,
+        fraction_bit_count);
+    if (function->name() != float_name && function->name() != apfloat_name) {
+      continue;
+    }
+    int64_t arity = op == NativeFloatOp::kFma ? 3 : 2;
+    if (function->params().size() != arity) {
+      return std::nullopt;
+    }
+    for (Param* param : function->params()) {
+      if (param->GetType() != function->return_type()) {
+        return std::nullopt;
+      }
+    }
+    return NativeFloatRoutine{op, exponent_bit_count, fraction_bit_count};
+  }
+  return std::nullopt;
+}
+
+llvm::Value* EmitNativeFloatRoutine(const NativeFloatRoutine& routine,
+                                    TupleType* float_type,
+                                    absl::Span<llvm::Value* const> operand_ptrs,
+                                    llvm::Value* output_ptr,
+                                    LlvmTypeConverter* type_converter,
+                                    llvm::IRBuilder<>& builder) {
+  FloatEmitter e(routine, float_type, type_converter, builder);
+  llvm::IRBuilder<>& b = e.builder();
+
+  std::vector<llvm::Value*> operands;
+  for (llvm::Value* ptr : operand_ptrs) {
+    operands.push_back(e.FlushSubnormal(e.Load(ptr)));
+  }
+
+  llvm::Value* result;
+  switch (routine.op) {
+    case NativeFloatOp::kAdd:
+      result = b.CreateFAdd(e.ToFp(operands[0]), e.ToFp(operands[1]));
+      break;
+    case NativeFloatOp::kSub:
+      result = b.CreateFSub(e.ToFp(operands[0]), e.ToFp(operands[1]));
+      break;
+    case NativeFloatOp::kMul:
+      result = b.CreateFMul(e.ToFp(operands[0]), e.ToFp(operands[1]));
+      break;
+    case NativeFloatOp::kFma: {
+      llvm::Function* fma = llvm::Intrinsic::getDeclaration(
+          b.GetInsertBlock()->getModule(), llvm::Intrinsic::fma,
+          {e.fp_type()});
+      result = b.CreateCall(fma, {e.ToFp(operands[0]), e.ToFp(operands[1]),
+                                  e.ToFp(operands[2])});
+      break;
+    }
+  }
+  llvm::Value* native = e.FromFp(result);
+
+  // Subnormal results are flushed to zero. The sign of a zero follows the
+  // stdlib: exact zero sums are positive, while products (and sums which
+  // underflowed) keep the sign of the exact result.
+  llvm::Value* zero = e.Constant(0);
+  if (routine.op == NativeFloatOp::kMul) {
+    zero = e.Sign(native);
+  } else if (routine.op != NativeFloatOp::kFma) {
+    zero = b.CreateSelect(b.CreateICmpEQ(e.Fraction(native), e.Constant(0)),
+                          e.Constant(0), e.Sign(native));
+  }
+  llvm::Value* is_zero_or_subnormal =
+      b.CreateICmpEQ(e.Exponent(native), e.Constant(0));
+
+  // NaN results are positive quiet NaNs; fma sets a lower fraction bit.
+  int64_t nan_fraction_bit = routine.op == NativeFloatOp::kFma
+                                 ? routine.fraction_bit_count - 4
+                                 : routine.fraction_bit_count - 1;
+  llvm::Value* nan = e.Constant(
+      (((uint64_t{1} << routine.exponent_bit_count) - 1)
+       << routine.fraction_bit_count) |
+      (uint64_t{1} << nan_fraction_bit));
+  llvm::Value* is_nan = b.CreateAnd(
+      b.CreateICmpEQ(e.Exponent(native), e.MaxExponent()),
+      b.CreateICmpNE(e.Fraction(native), e.Constant(0)));
+
+  llvm::Value* value = b.CreateSelect(is_zero_or_subnormal, zero, native);
+  value = b.CreateSelect(is_nan, nan, value);
+  e.Store(value, output_ptr);
+
+  if (routine.op != NativeFloatOp::kFma) {
+    return nullptr;
+  }
+
+  // The stdlib fma denormalizes tiny products (without a sticky bit) and
+  // rounds results below the smallest normal with the precision of normal
+  // values before flushing them, so IEEE results may differ for a nonzero
+  // product which is tiny or a result of at most the smallest normal
+  // magnitude. Exact zero sums of a nonzero product are also resolved by the
+  // IR body, as their sign may depend on a residue rounded away.
+  llvm::Value* a_exponent = e.Exponent(operands[0]);
+  llvm::Value* b_exponent = e.Exponent(operands[1]);
+  llvm::Value* nonzero_product =
+      b.CreateAnd(b.CreateICmpNE(a_exponent, e.Constant(0)),
+                  b.CreateICmpNE(b_exponent, e.Constant(0)));
+  uint64_t bias = (uint64_t{1} << (routine.exponent_bit_count - 1)) - 1;
+  llvm::Value* tiny_product = b.CreateICmpULE(
+      b.CreateAdd(a_exponent, b_exponent), e.Constant(bias + 1));
+  llvm::Value* small_result = b.CreateICmpULE(
+      b.CreateAnd(native, b.CreateNot(e.SignMask())),
+      e.Constant(uint64_t{1} << routine.fraction_bit_count));
+  return b.CreateAnd(nonzero_product,
+                     b.CreateOr(tiny_product, small_result));
+}
+
+}  // namespace xls
@@ -0,0 +1,78 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Lowering of invocations of the DSLX standard library floating-point routines
+// (float32.x, float64.x and their apfloat.x instantiations) to native
+// floating-point instructions rather than to the thousands of bit-level
+// operations of their IR bodies.
+//
+// The native results are fixed up to match the stdlib semantics bit for bit:
+// subnormal operands and results are flushed to zero, NaN results are the
+// stdlib's canonical quiet NaN, and exactly-zero sums are positive. For the
+// few fused multiply-add operands where the stdlib rounds differently than
+// IEEE 754 (tiny products and results at the subnormal boundary) the IR body
+// is evaluated instead. This assumes the host's default floating-point
+// environment (round to nearest even, no flush-to-zero modes).
+//
+// The optimizer inlines all invocations, so this applies to IR simulated before
+// optimization, e.g. IR converted from DSLX and run by the DSLX interpreter or
+// eval_ir_main/eval_proc_main.
+
+#ifndef XLS_JIT_NATIVE_FLOAT_LOWERING_H_
+#define XLS_JIT_NATIVE_FLOAT_LOWERING_H_
+
+#include <cstdint>
+#include <optional>
+
+#include "absl/types/span.h"
+#include "llvm/include/llvm/IR/IRBuilder.h"
+#include "llvm/include/llvm/IR/Value.h"
+#include "xls/ir/function.h"
+#include "xls/ir/type.h"
+#include "xls/jit/llvm_type_converter.h"
+
+namespace xls {
+
+enum class NativeFloatOp { kAdd, kSub, kMul, kFma };
+
+// A standard library floating-point routine on APFloat values, i.e. tuples of
+// (sign: bits[1], bexp: bits[exponent_bit_count],
+//  fraction: bits[fraction_bit_count]).
+struct NativeFloatRoutine {
+  NativeFloatOp op;
+  // 8 and 23 for float32, 11 and 52 for float64.
+  int64_t exponent_bit_count;
+  int64_t fraction_bit_count;
+};
+
+// Returns the routine implemented by `function` if it is one of the float32,
+// float64 or corresponding apfloat add, sub, mul or fma functions, identified
+// by their mangled names and signatures.
+std::optional<NativeFloatRoutine> MatchNativeFloatRoutine(Function* function);
+
+// Emits code which computes `routine` on the APFloat values of type
+// `float_type` pointed to by `operand_ptrs` and writes the result to
+// `output_ptr`. Returns null, or an i1 value which is true if the result
+// written may differ from the stdlib's and the IR body must be evaluated
+// instead.
+llvm::Value* EmitNativeFloatRoutine(const NativeFloatRoutine& routine,
+                                    TupleType* float_type,
+                                    absl::Span<llvm::Value* const> operand_ptrs,
+                                    llvm::Value* output_ptr,
+                                    LlvmTypeConverter* type_converter,
+                                    llvm::IRBuilder<>& builder);
+
+}  // namespace xls
+
+#endif  // XLS_JIT_NATIVE_FLOAT_LOWERING_H_
@@ -0,0 +1,337 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/native_float_lowering.h"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/flags/declare.h"
+#include "absl/flags/flag.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+
+ABSL_DECLARE_FLAG(bool, xls_jit_native_float);
+
+namespace xls {
+namespace {
+
+struct StdlibRoutine {
+  std::string_view ir_path;
+  std::string_view top;
+  // Name of the apfloat function invoked by `top`.
+  std::string_view apfloat_function;
+  NativeFloatOp op;
+  int64_t exponent_bit_count;
+  int64_t fraction_bit_count;
+};
+
+constexpr StdlibRoutine kRoutines[] = {
+    {"xls/dslx/stdlib/float32_add.ir", "__float32__add",
+     "__apfloat__add__8_23", NativeFloatOp::kAdd, 8, 23},
+    {"xls/dslx/stdlib/float32_mul.ir", "__float32__mul",
+     "__apfloat__mul__8_23", NativeFloatOp::kMul, 8, 23},
+    {"xls/dslx/stdlib/float32_fma.ir", "__float32__fma",
+     "__apfloat__fma__8_23", NativeFloatOp::kFma, 8, 23},
+    {"xls/dslx/stdlib/float64_add.ir", "__float64__add",
+     "__apfloat__add__11_52", NativeFloatOp::kAdd, 11, 52},
+    {"xls/dslx/stdlib/float64_mul.ir", "__float64__mul",
+     "__apfloat__mul__11_52", NativeFloatOp::kMul, 11, 52},
+    {"xls/dslx/stdlib/float64_fma.ir", "__float64__fma",
+     "__apfloat__fma__11_52", NativeFloatOp::kFma, 11, 52},
+};
+
+// Float values as IEEE bit patterns of the routine's format.
+class FloatFormat {
+ public:
+  explicit FloatFormat(const StdlibRoutine& routine)
+      : exponent_bit_count_(routine.exponent_bit_count),
+        fraction_bit_count_(routine.fraction_bit_count) {}
+
+  uint64_t Make(bool sign, uint64_t bexp, uint64_t fraction) const {
+    return (static_cast<uint64_t>(sign)
+            << (exponent_bit_count_ + fraction_bit_count_)) |
+           (bexp << fraction_bit_count_) | fraction;
+  }
+  uint64_t max_exponent() const {
+    return (uint64_t{1} << exponent_bit_count_) - 1;
+  }
+  uint64_t bias() const { return max_exponent() >> 1; }
+  uint64_t fraction_mask() const {
+    return (uint64_t{1} << fraction_bit_count_) - 1;
+  }
+
+  Value ToValue(uint64_t bits) const {
+    int64_t bit_count = 1 + exponent_bit_count_ + fraction_bit_count_;
+    if (bit_count < 64) {
+      bits &= (uint64_t{1} << bit_count) - 1;
+    }
+    return Value::Tuple(
+        {Value(UBits(bits >> (exponent_bit_count_ + fraction_bit_count_), 1)),
+         Value(UBits((bits >> fraction_bit_count_) & max_exponent(),
+                     exponent_bit_count_)),
+         Value(UBits(bits & fraction_mask(), fraction_bit_count_))});
+  }
+
+  double ToDouble(uint64_t bits) const {
+    if (fraction_bit_count_ == 52) {
+      double value;
+      std::memcpy(&value, &bits, sizeof(value));
+      return value;
+    }
+    uint32_t narrow = static_cast<uint32_t>(bits);
+    float value;
+    std::memcpy(&value, &narrow, sizeof(value));
+    return value;
+  }
+  uint64_t FromDouble(double value) const {
+    if (fraction_bit_count_ == 52) {
+      uint64_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      return bits;
+    }
+    float narrow = static_cast<float>(value);
+    uint32_t bits;
+    std::memcpy(&bits, &narrow, sizeof(bits));
+    return bits;
+  }
+
+  // Zeros, subnormals, the smallest normals, ones, the largest finite values,
+  // infinities, NaNs and values whose products are at the bottom of the
+  // normal range, of both signs.
+  std::vector<uint64_t> SpecialValues() const {
+    std::vector<uint64_t> values;
+    for (bool sign : {false, true}) {
+      for (uint64_t value : {
+               Make(sign, 0, 0),
+               Make(sign, 0, 1),
+               Make(sign, 0, fraction_mask()),
+               Make(sign, 1, 0),
+               Make(sign, 1, 1),
+               Make(sign, 1, fraction_mask()),
+               Make(sign, 2, 0),
+               Make(sign, bias() / 2, 0),
+               Make(sign, bias() / 2 + 1, fraction_mask()),
+               Make(sign, bias(), 0),
+               Make(sign, bias(), 1),
+               Make(sign, bias(), fraction_mask()),
+               Make(sign, bias() + 1, fraction_mask() >> 1),
+               Make(sign, max_exponent() - 1, fraction_mask()),
+               Make(sign, max_exponent(), 0),
+               Make(sign, max_exponent(), 1),
+               Make(sign, max_exponent(), uint64_t{1}
+                                              << (fraction_bit_count_ - 1)),
+           }) {
+        values.push_back(value);
+      }
+    }
+    return values;
+  }
+
+  // Returns a value with a random sign and fraction and an exponent in
+  // [min_bexp, max_bexp].
+  uint64_t Random(std::mt19937_64& bitgen, uint64_t min_bexp,
+                  uint64_t max_bexp) const {
+    uint64_t bexp =
+        std::uniform_int_distribution<uint64_t>(min_bexp, max_bexp)(bitgen);
+    return Make(bitgen() & 1, bexp, bitgen() & fraction_mask());
+  }
+
+ private:
+  int64_t exponent_bit_count_;
+  int64_t fraction_bit_count_;
+};
+
+class NativeFloatLoweringTest
+    : public IrTestBase,
+      public testing::WithParamInterface<StdlibRoutine> {
+ protected:
+  void TearDown() override {
+    absl::SetFlag(&FLAGS_xls_jit_native_float, false);
+  }
+
+  absl::StatusOr<std::unique_ptr<Package>> ParseRoutine() {
+    XLS_ASSIGN_OR_RETURN(std::filesystem::path ir_path,
+                         GetXlsRunfilePath(GetParam().ir_path));
+    XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
+    return Parser::ParsePackage(ir_text);
+  }
+};
+
+TEST_P(NativeFloatLoweringTest, MatchesStdlibFunctions) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package, ParseRoutine());
+  for (std::string_view name : {GetParam().top, GetParam().apfloat_function}) {
+    XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                             package->GetFunction(name));
+    std::optional<NativeFloatRoutine> routine =
+        MatchNativeFloatRoutine(function);
+    ASSERT_TRUE(routine.has_value()) << name;
+    EXPECT_EQ(routine->op, GetParam().op);
+    EXPECT_EQ(routine->exponent_bit_count, GetParam().exponent_bit_count);
+    EXPECT_EQ(routine->fraction_bit_count, GetParam().fraction_bit_count);
+  }
+}
+
+TEST_P(NativeFloatLoweringTest, BitIdenticalToIrBody) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package, ParseRoutine());
+  XLS_ASSERT_OK_AND_ASSIGN(Function * top,
+                           package->GetFunction(GetParam().top));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> reference,
+                           FunctionJit::Create(top));
+  absl::SetFlag(&FLAGS_xls_jit_native_float, true);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> native,
+                           FunctionJit::Create(top));
+
+  const FloatFormat format(GetParam());
+  const int64_t arity = top->params().size();
+  auto check = [&](const std::vector<uint64_t>& operands) {
+    std::vector<Value> args;
+    for (uint64_t operand : operands) {
+      args.push_back(format.ToValue(operand));
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected,
+                             reference->Run(args));
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> actual,
+                             native->Run(args));
+    ASSERT_EQ(actual.value, expected.value) << absl::StrFormat(
+        "operands: %s", absl::StrJoin(operands, ", ", [](std::string* out,
+                                                          uint64_t operand) {
+          absl::StrAppendFormat(out, "%#x", operand);
+        }));
+  };
+
+  std::vector<uint64_t> specials = format.SpecialValues();
+  for (uint64_t x : specials) {
+    for (uint64_t y : specials) {
+      if (arity == 2) {
+        check({x, y});
+        continue;
+      }
+      for (uint64_t z : specials) {
+        check({x, y, z});
+      }
+    }
+  }
+
+  std::mt19937_64 bitgen;
+  const uint64_t max_exponent = format.max_exponent();
+  const uint64_t bias = format.bias();
+  for (int64_t i = 0; i < 20000; ++i) {
+    // Operands across the whole range, operands whose results are near the
+    // bottom of the normal range, and operands which (nearly) cancel.
+    std::vector<uint64_t> operands;
+    switch (i % 3) {
+      case 0:
+        for (int64_t j = 0; j < arity; ++j) {
+          operands.push_back(format.Random(bitgen, 0, max_exponent));
+        }
+        break;
+      case 1:
+        if (arity == 2 && GetParam().op != NativeFloatOp::kMul) {
+          operands = {format.Random(bitgen, 1, 4),
+                      format.Random(bitgen, 1, 4)};
+        } else {
+          operands = {format.Random(bitgen, bias / 2 - 2, bias / 2 + 2),
+                      format.Random(bitgen, bias / 2 - 2, bias / 2 + 2)};
+          if (arity == 3) {
+            operands.push_back(format.Random(bitgen, 0, 3));
+          }
+        }
+        break;
+      default: {
+        uint64_t x = format.Random(bitgen, 1, max_exponent - 1);
+        uint64_t y = format.Random(bitgen, bias - 8, bias + 8);
+        if (arity == 2) {
+          // x + y where y is -x nudged by a few ulps.
+          operands = {x, (x ^ format.Make(true, 0, 0)) + (bitgen() % 5) - 2};
+          if (GetParam().op == NativeFloatOp::kMul) {
+            operands[1] = y;
+          }
+          break;
+        }
+        // x * y + z where z is about -(x * y).
+        uint64_t z = format.FromDouble(
+            -(format.ToDouble(x) * format.ToDouble(y)));
+        operands = {x, y, z + (bitgen() % 5) - 2};
+        break;
+      }
+    }
+    check(operands);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    NativeFloatLoweringTestInstantiation, NativeFloatLoweringTest,
+    testing::ValuesIn(kRoutines),
+    [](const testing::TestParamInfo<StdlibRoutine>& info) {
+      return std::string(info.param.top.substr(2));
+    });
+
+class MatchNativeFloatRoutineTest : public IrTestBase {};
+
+TEST_F(MatchNativeFloatRoutineTest, RequiresNameAndSignature) {
+  auto p = CreatePackage();
+  Type* f32 = p->GetTupleType(
+      {p->GetBitsType(1), p->GetBitsType(8), p->GetBitsType(23)});
+  Type* other = p->GetTupleType(
+      {p->GetBitsType(1), p->GetBitsType(5), p->GetBitsType(10)});
+  auto build = [&](std::string_view name, Type* type, int64_t arity) {
+    FunctionBuilder fb(name, p.get());
+    BValue x;
+    for (int64_t i = 0; i < arity; ++i) {
+      x = fb.Param(absl::StrFormat("x%d", i), type);
+    }
+    return fb.BuildWithReturnValue(x).value();
+  };
+
+  std::optional<NativeFloatRoutine> routine =
+      MatchNativeFloatRoutine(build("__float32__sub", f32, 2));
+  ASSERT_TRUE(routine.has_value());
+  EXPECT_EQ(routine->op, NativeFloatOp::kSub);
+  EXPECT_TRUE(
+      MatchNativeFloatRoutine(build("__apfloat__fma__8_23", f32, 3))
+          .has_value());
+
+  EXPECT_FALSE(
+      MatchNativeFloatRoutine(build("__float32__add", f32, 3)).has_value());
+  EXPECT_FALSE(
+      MatchNativeFloatRoutine(build("__float64__add", f32, 2)).has_value());
+  EXPECT_FALSE(
+      MatchNativeFloatRoutine(build("__float32__div", f32, 2)).has_value());
+  EXPECT_FALSE(MatchNativeFloatRoutine(build("__apfloat__add__5_10", other, 2))
+                   .has_value());
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,109 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/native_foreign_function.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/foreign_function_model.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_helpers.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+namespace {
+
+// Native buffers are aligned for the widest scalar the JIT uses.
+struct alignas(16) Chunk {
+  uint8_t bytes[16];
+};
+
+struct NativeLayouts {
+  FunctionType* type;
+  std::vector<TypeLayout> params;
+  TypeLayout result;
+};
+
+}  // namespace
+
+absl::StatusOr<ForeignFunctionModel> CreateNativeForeignFunctionModel(
+    FunctionType* type, NativeForeignFunction native, void* context) {
+  if (native == nullptr) {
+    return absl::InvalidArgumentError("Native foreign function is null");
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitRuntime> runtime,
+                       JitRuntime::Create());
+  std::vector<TypeLayout> params;
+  for (Type* param_type : type->parameters()) {
+    params.push_back(runtime->CreateTypeLayout(param_type));
+  }
+  auto layouts = std::make_shared<const NativeLayouts>(NativeLayouts{
+      .type = type,
+      .params = std::move(params),
+      .result = runtime->CreateTypeLayout(type->return_type())});
+
+  ForeignFunctionModel model;
+  model.native = native;
+  model.context = context;
+  model.evaluate =
+      [layouts, native,
+       context](absl::Span<const Value> args) -> absl::StatusOr<Value> {
+    if (args.size() != layouts->params.size()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Foreign function of type %s called with %d arguments",
+          layouts->type->ToString(), args.size()));
+    }
+    auto chunk_count = [](int64_t size) {
+      return CeilOfRatio(size, static_cast<int64_t>(sizeof(Chunk)));
+    };
+    std::vector<std::vector<Chunk>> arg_buffers;
+    std::vector<const uint8_t*> arg_ptrs;
+    arg_buffers.reserve(args.size());
+    for (int64_t i = 0; i < args.size(); ++i) {
+      const TypeLayout& layout = layouts->params[i];
+      if (!ValueConformsToType(args[i], layout.type())) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Argument %d of foreign function of type %s is not a %s: %s", i,
+            layouts->type->ToString(), layout.type()->ToString(),
+            args[i].ToString()));
+      }
+      std::vector<Chunk>& buffer =
+          arg_buffers.emplace_back(chunk_count(layout.size()));
+      auto* bytes = reinterpret_cast<uint8_t*>(buffer.data());
+      layout.ValueToNativeLayout(args[i], bytes);
+      arg_ptrs.push_back(bytes);
+    }
+    // Results are zero-initialized so padding is zero as the layout
+    // requires, even if the model only writes the data bytes.
+    std::vector<Chunk> result_buffer(chunk_count(layouts->result.size()),
+                                     Chunk{});
+    auto* result = reinterpret_cast<uint8_t*>(result_buffer.data());
+    native(arg_ptrs.data(), result, context);
+    return layouts->result.NativeLayoutToValue(result);
+  };
+  return model;
+}
+
+}  // namespace xls
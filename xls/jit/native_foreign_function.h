@@ -0,0 +1,43 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_NATIVE_FOREIGN_FUNCTION_H_
+#define XLS_JIT_NATIVE_FOREIGN_FUNCTION_H_
+
+#include "absl/status/statusor.h"
+#include "xls/ir/foreign_function_model.h"
+#include "xls/ir/type.h"
+
+namespace xls {
+
+// Returns a model of a foreign function of type `type` implemented by
+// `native`, which the JIT calls directly and the interpreter calls after
+// converting the arguments to and the result from the native layout. The
+// model refers to `type`, so the package holding it must outlive the model.
+//
+// Ex:
+//   void Mac(const uint8_t* const* args, uint8_t* result, void* context) {
+//     ...
+//   }
+//   XLS_ASSIGN_OR_RETURN(
+//       ForeignFunctionModel model,
+//       CreateNativeForeignFunctionModel(f->GetType(), &Mac, nullptr));
+//   XLS_RETURN_IF_ERROR(
+//       GetForeignFunctionModelRegistry().Register(f->name(), model));
+absl::StatusOr<ForeignFunctionModel> CreateNativeForeignFunctionModel(
+    FunctionType* type, NativeForeignFunction native, void* context);
+
+}  // namespace xls
+
+#endif  // XLS_JIT_NATIVE_FOREIGN_FUNCTION_H_
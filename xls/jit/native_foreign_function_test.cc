@@ -0,0 +1,136 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/native_foreign_function.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/foreign_function.h"
+#include "xls/ir/foreign_function_model.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+
+// Model of a function whose IR body adds its u32 arguments, which multiplies
+// them instead so the tests can tell which one ran.
+void MultiplyModel(const uint8_t* const* args, uint8_t* result,
+                   void* context) {
+  uint32_t a;
+  uint32_t b;
+  std::memcpy(&a, args[0], sizeof(a));
+  std::memcpy(&b, args[1], sizeof(b));
+  uint32_t product = a * b;
+  std::memcpy(result, &product, sizeof(product));
+  ++*static_cast<int64_t*>(context);
+}
+
+class NativeForeignFunctionTest : public IrTestBase {
+ protected:
+  // Builds `f(x, y) = ffi(x, y) + 1` where `ffi` adds its arguments.
+  absl::StatusOr<Function*> BuildCaller(Package* p) {
+    FunctionBuilder ffi_builder(TestName() + "_ffi", p);
+    BValue a = ffi_builder.Param("a", p->GetBitsType(32));
+    BValue b = ffi_builder.Param("b", p->GetBitsType(32));
+    XLS_ASSIGN_OR_RETURN(
+        ForeignFunctionData ffd,
+        ForeignFunctionDataCreateFromTemplate(
+            "mult {fn} (.a({a}), .b({b}), .out({return}))"));
+    ffi_builder.SetForeignFunctionData(ffd);
+    XLS_ASSIGN_OR_RETURN(ffi_,
+                         ffi_builder.BuildWithReturnValue(
+                             ffi_builder.Add(a, b)));
+
+    FunctionBuilder fb(TestName(), p);
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    BValue y = fb.Param("y", p->GetBitsType(32));
+    return fb.BuildWithReturnValue(
+        fb.Add(fb.Invoke({x, y}, ffi_), fb.Literal(UBits(1, 32))));
+  }
+
+  Function* ffi_ = nullptr;
+};
+
+TEST_F(NativeForeignFunctionTest, InterpreterAndJitCallModel) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildCaller(p.get()));
+  Value x(UBits(6, 32));
+  Value y(UBits(7, 32));
+
+  // Without a model the IR body is evaluated.
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result,
+                           InterpretFunction(f, {x, y}));
+  EXPECT_EQ(result.value, Value(UBits(14, 32)));
+
+  int64_t calls = 0;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ForeignFunctionModel model,
+      CreateNativeForeignFunctionModel(ffi_->GetType(), &MultiplyModel,
+                                       &calls));
+  XLS_ASSERT_OK(
+      GetForeignFunctionModelRegistry().Register(ffi_->name(), model));
+  EXPECT_THAT(
+      GetForeignFunctionModelRegistry().Register(ffi_->name(), model),
+      StatusIs(absl::StatusCode::kAlreadyExists));
+
+  XLS_ASSERT_OK_AND_ASSIGN(result, InterpretFunction(f, {x, y}));
+  EXPECT_EQ(result.value, Value(UBits(43, 32)));
+  EXPECT_EQ(calls, 1);
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                           FunctionJit::Create(f));
+  XLS_ASSERT_OK_AND_ASSIGN(result, jit->Run({x, y}));
+  EXPECT_EQ(result.value, Value(UBits(43, 32)));
+  EXPECT_EQ(calls, 2);
+
+  GetForeignFunctionModelRegistry().Unregister(ffi_->name());
+  XLS_ASSERT_OK_AND_ASSIGN(result, InterpretFunction(f, {x, y}));
+  EXPECT_EQ(result.value, Value(UBits(14, 32)));
+}
+
+TEST_F(NativeForeignFunctionTest, ModelChecksArguments) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK(BuildCaller(p.get()).status());
+  int64_t calls = 0;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ForeignFunctionModel model,
+      CreateNativeForeignFunctionModel(ffi_->GetType(), &MultiplyModel,
+                                       &calls));
+  EXPECT_THAT(model.evaluate({Value(UBits(3, 32)), Value(UBits(5, 32))}),
+              IsOkAndHolds(Value(UBits(15, 32))));
+  EXPECT_THAT(model.evaluate({Value(UBits(3, 32))}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(model.evaluate({Value(UBits(3, 32)), Value(UBits(5, 8))}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_EQ(calls, 1);
+}
+
+}  // namespace
+}  // namespace xls
@@ -17,37 +17,76 @@
 #include <cerrno>
 #include <cstddef>
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <system_error>  // NOLINT
 #include <utility>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/flags/flag.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm-c/Target.h"
 #include "llvm/include/llvm/ADT/StringExtras.h"
 #include "llvm/include/llvm/Analysis/CGSCCPassManager.h"
 #include "llvm/include/llvm/Analysis/LoopAnalysisManager.h"
+#include "llvm/include/llvm/Bitcode/BitcodeReader.h"
+#include "llvm/include/llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/CompileUtils.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ExecutionUtils.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ExecutorProcessControl.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/IndirectionUtils.h"
+#include "llvm/include/llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/TaskDispatch.h"
 #include "llvm/include/llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/include/llvm/IR/BasicBlock.h"
+#include "llvm/include/llvm/IR/Constants.h"
+#include "llvm/include/llvm/IR/Function.h"
+#include "llvm/include/llvm/IR/Instruction.h"
+#include "llvm/include/llvm/IR/Instructions.h"
 #include "llvm/include/llvm/IR/LegacyPassManager.h"
+#include "llvm/include/llvm/IR/Module.h"
 #include "llvm/include/llvm/IR/PassManager.h"
 #include "llvm/include/llvm/Passes/OptimizationLevel.h"
 #include "llvm/include/llvm/Passes/PassBuilder.h"
+#include "llvm/include/llvm/Support/Casting.h"
 #include "llvm/include/llvm/Support/CodeGen.h"
+#include "llvm/include/llvm/Support/MemoryBuffer.h"
+#include "llvm/include/llvm/Transforms/Utils/SplitModule.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/logging/vlog_is_on.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/trace.h"
+#include "xls/jit/jit_object_cache.h"
+
+ABSL_FLAG(std::string, xls_jit_object_cache_dir, "",
+          "If non-empty, object code produced by the JIT is cached in this "
+          "directory and reused by later runs compiling identical code.");
+
+ABSL_FLAG(int64_t, xls_jit_object_cache_max_bytes,
+          xls::JitObjectCache::kDefaultMaxBytes,
+          "Maximum total size of the entries in the JIT object cache. The "
+          "least recently used entries are evicted beyond this limit.");
+
+ABSL_FLAG(int64_t, xls_jit_compile_threads, 1,
+          "Number of threads used to optimize and generate code for each "
+          "module compiled by the JIT. If greater than one, modules are split "
+          "into independent pieces which are compiled concurrently.");
+
+ABSL_FLAG(bool, xls_jit_lazy_compilation, false,
+          "If true, the JIT compiles each jitted XLS function or proc when it "
+          "is first called rather than when it is created.");
 
 namespace xls {
 namespace {
@@ -90,16 +129,173 @@ char BadOptLevelError::ID;
 
 }  // namespace
 
-OrcJit::OrcJit(int64_t opt_level, bool emit_object_code)
+// Hook called by the LLVM compiler after code generation which writes the
+// object code of modules which missed in the persistent cache into the cache.
+// Lookups are performed by OrcJit::CompileModule before optimization so
+// `getObject` never returns a cached object.
+class OrcJitObjectCacheWriter : public llvm::ObjectCache {
+ public:
+  explicit OrcJitObjectCacheWriter(JitObjectCache* cache) : cache_(cache) {}
+
+  // Sets the cache key under which the object code of `module` is stored.
+  void SetKey(const llvm::Module* module, std::string key) {
+    absl::MutexLock lock(&mutex_);
+    keys_[module] = std::move(key);
+  }
+
+  void notifyObjectCompiled(const llvm::Module* module,
+                            llvm::MemoryBufferRef object) override {
+    std::string key;
+    {
+      absl::MutexLock lock(&mutex_);
+      auto it = keys_.find(module);
+      if (it == keys_.end()) {
+        return;
+      }
+      key = std::move(it->second);
+      keys_.erase(it);
+    }
+    absl::Status status = cache_->Insert(
+        key, absl::MakeConstSpan(
+                 reinterpret_cast<const uint8_t*>(object.getBufferStart()),
+                 object.getBufferSize()));
+    if (!status.ok()) {
+      // Failing to populate the cache is not fatal; the object has already
+      // been compiled.
+      XLS_LOG(WARNING) << "Unable to write JIT object cache entry: " << status;
+    }
+  }
+
+  std::unique_ptr<llvm::MemoryBuffer> getObject(
+      const llvm::Module* module) override {
+    return nullptr;
+  }
+
+ private:
+  JitObjectCache* cache_;
+  absl::Mutex mutex_;
+  absl::flat_hash_map<const llvm::Module*, std::string> keys_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+namespace {
+
+// Returns the executor process control for the JIT's execution session. If
+// `concurrent` is true then materialization (optimization and code
+// generation) tasks are dispatched to separate threads.
+std::unique_ptr<llvm::orc::ExecutorProcessControl> CreateExecutorProcessControl(
+    bool concurrent) {
+  if (!concurrent) {
+    return std::make_unique<llvm::orc::UnsupportedExecutorProcessControl>();
+  }
+  return std::make_unique<llvm::orc::UnsupportedExecutorProcessControl>(
+      /*SSP=*/nullptr,
+      std::make_unique<llvm::orc::DynamicThreadPoolTaskDispatcher>());
+}
+
+// Returns true if `constant` is, or is computed from, an integer constant
+// converted to a pointer. The JIT emits host addresses of runtime objects and
+// callbacks this way.
+bool IsHostAddress(const llvm::Constant* constant) {
+  const llvm::ConstantExpr* expr = llvm::dyn_cast<llvm::ConstantExpr>(constant);
+  if (expr == nullptr) {
+    return false;
+  }
+  if (expr->getOpcode() == llvm::Instruction::IntToPtr &&
+      llvm::isa<llvm::ConstantInt>(expr->getOperand(0))) {
+    return true;
+  }
+  for (const llvm::Use& operand : expr->operands()) {
+    if (IsHostAddress(llvm::cast<llvm::Constant>(operand.get()))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns true if `module` embeds host addresses of the current process (e.g.,
+// of channel queues, trace and assertion callbacks, wide-op kernels or
+// profile counters). Object code of such modules is only valid in this
+// process so it must not be persisted.
+bool EmbedsHostAddresses(const llvm::Module& module) {
+  for (const llvm::Function& function : module) {
+    for (const llvm::BasicBlock& block : function) {
+      for (const llvm::Instruction& instruction : block) {
+        if (llvm::isa<llvm::IntToPtrInst>(instruction) &&
+            llvm::isa<llvm::ConstantInt>(instruction.getOperand(0))) {
+          return true;
+        }
+        for (const llvm::Use& operand : instruction.operands()) {
+          const llvm::Constant* constant =
+              llvm::dyn_cast<llvm::Constant>(operand.get());
+          if (constant != nullptr && IsHostAddress(constant)) {
+            return true;
+          }
+        }
+      }
+    }
+  }
+  return false;
+}
+
+// Partitioning function for lazy compilation. Returns the requested functions
+// along with all the functions transitively referenced by them, stopping at
+// other entry points which are compiled separately on demand. This keeps the
+// partition and node functions of a FunctionBase in one module so they can be
+// inlined into each other.
+std::optional<llvm::orc::CompileOnDemandLayer::GlobalValueSet>
+PartitionAtEntryPoints(
+    llvm::orc::CompileOnDemandLayer::GlobalValueSet requested) {
+  llvm::orc::CompileOnDemandLayer::GlobalValueSet partition;
+  std::vector<const llvm::Function*> worklist;
+  for (const llvm::GlobalValue* value : requested) {
+    if (const llvm::Function* fn = llvm::dyn_cast<llvm::Function>(value)) {
+      worklist.push_back(fn);
+    } else {
+      partition.insert(value);
+    }
+  }
+  while (!worklist.empty()) {
+    const llvm::Function* fn = worklist.back();
+    worklist.pop_back();
+    if (fn->isDeclaration() || !partition.insert(fn).second) {
+      continue;
+    }
+    for (const llvm::BasicBlock& basic_block : *fn) {
+      for (const llvm::Instruction& inst : basic_block) {
+        for (const llvm::Use& use : inst.operands()) {
+          const llvm::Function* callee =
+              llvm::dyn_cast<llvm::Function>(use.get());
+          if (callee == nullptr) {
+            continue;
+          }
+          if (callee->hasFnAttribute(kJitEntryPointAttribute) &&
+              !requested.contains(callee)) {
+            continue;
+          }
+          worklist.push_back(callee);
+        }
+      }
+    }
+  }
+  return partition;
+}
+
+}  // namespace
+
+OrcJit::OrcJit(int64_t opt_level, bool emit_object_code,
+               int64_t compile_threads, bool lazy_compilation)
     : context_(std::make_unique<llvm::LLVMContext>()),
-      execution_session_(
-          std::make_unique<llvm::orc::UnsupportedExecutorProcessControl>()),
+      execution_session_(CreateExecutorProcessControl(
+          /*concurrent=*/compile_threads > 1 && !emit_object_code)),
       object_layer_(
           execution_session_,
           []() { return std::make_unique<llvm::SectionMemoryManager>(); }),
       dylib_(execution_session_.createBareJITDylib("main")),
       opt_level_(opt_level),
       emit_object_code_(emit_object_code),
+      compile_threads_(compile_threads),
+      lazy_compilation_(lazy_compilation),
       data_layout_("") {}
 
 OrcJit::~OrcJit() {
@@ -158,6 +354,7 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
   XLS_VLOG_LINES(2, DumpLlvmModuleToString(bare_module));
 
   if (XLS_VLOG_IS_ON(3)) {
+    absl::MutexLock lock(&asm_dump_mutex_);
     // The ostream and its buffer must be declared before the
     // module_pass_manager because the destrutor of the pass manager calls flush
     // on the ostream so these must be destructed *after* the pass manager. C++
@@ -178,12 +375,22 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
   return module;
 }
 
-absl::StatusOr<std::unique_ptr<OrcJit>> OrcJit::Create(int64_t opt_level,
-                                                       bool emit_object_code) {
+absl::StatusOr<std::unique_ptr<OrcJit>> OrcJit::Create(
+    int64_t opt_level, bool emit_object_code,
+    std::optional<std::filesystem::path> object_cache_dir,
+    std::optional<int64_t> compile_threads,
+    std::optional<bool> lazy_compilation) {
   absl::call_once(once, OnceInit);
-  std::unique_ptr<OrcJit> jit =
-      absl::WrapUnique(new OrcJit(opt_level, emit_object_code));
-  XLS_RETURN_IF_ERROR(jit->Init());
+  std::unique_ptr<OrcJit> jit = absl::WrapUnique(new OrcJit(
+      opt_level, emit_object_code,
+      compile_threads.value_or(absl::GetFlag(FLAGS_xls_jit_compile_threads)),
+      lazy_compilation.value_or(
+          absl::GetFlag(FLAGS_xls_jit_lazy_compilation))));
+  if (!object_cache_dir.has_value() &&
+      !absl::GetFlag(FLAGS_xls_jit_object_cache_dir).empty()) {
+    object_cache_dir = absl::GetFlag(FLAGS_xls_jit_object_cache_dir);
+  }
+  XLS_RETURN_IF_ERROR(jit->Init(object_cache_dir));
   return std::move(jit);
 }
 
@@ -194,8 +401,8 @@ absl::StatusOr<std::unique_ptr<OrcJit>> OrcJit::Create(int64_t opt_level,
   return target_machine->createDataLayout();
 }
 
-/* static */ absl::StatusOr<std::unique_ptr<llvm::TargetMachine>>
-OrcJit::CreateTargetMachine() {
+/* static */ absl::StatusOr<llvm::orc::JITTargetMachineBuilder>
+OrcJit::CreateTargetMachineBuilder() {
   auto error_or_target_builder =
       llvm::orc::JITTargetMachineBuilder::detectHost();
   if (!error_or_target_builder) {
@@ -205,7 +412,14 @@ OrcJit::CreateTargetMachine() {
   }
 
   error_or_target_builder->setRelocationModel(llvm::Reloc::Model::PIC_);
-  auto error_or_target_machine = error_or_target_builder->createTargetMachine();
+  return std::move(error_or_target_builder.get());
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<llvm::TargetMachine>>
+OrcJit::CreateTargetMachine() {
+  XLS_ASSIGN_OR_RETURN(llvm::orc::JITTargetMachineBuilder target_builder,
+                       CreateTargetMachineBuilder());
+  auto error_or_target_machine = target_builder.createTargetMachine();
   if (!error_or_target_machine) {
     return absl::InternalError(
         absl::StrCat("Unable to create target machine: ",
@@ -214,8 +428,25 @@ OrcJit::CreateTargetMachine() {
   return std::move(error_or_target_machine.get());
 }
 
-absl::Status OrcJit::Init() {
+std::string OrcJit::GetTargetDescription() const {
+  return absl::StrFormat("%s;%s;%s",
+                         target_machine_->getTargetTriple().normalize(),
+                         target_machine_->getTargetCPU().str(),
+                         target_machine_->getTargetFeatureString().str());
+}
+
+absl::Status OrcJit::Init(
+    std::optional<std::filesystem::path> object_cache_dir) {
   XLS_ASSIGN_OR_RETURN(target_machine_, CreateTargetMachine());
+  if (object_cache_dir.has_value()) {
+    XLS_ASSIGN_OR_RETURN(
+        object_cache_,
+        JitObjectCache::Create(
+            object_cache_dir.value(),
+            absl::GetFlag(FLAGS_xls_jit_object_cache_max_bytes)));
+    object_cache_writer_ =
+        std::make_unique<OrcJitObjectCacheWriter>(object_cache_.get());
+  }
   if (XLS_VLOG_IS_ON(1)) {
     std::string triple = target_machine_->getTargetTriple().normalize();
     std::string cpu = target_machine_->getTargetCPU().str();
@@ -238,7 +469,18 @@ absl::Status OrcJit::Init() {
             data_layout_.getGlobalPrefix())));
   });
 
-  auto compiler = std::make_unique<llvm::orc::SimpleCompiler>(*target_machine_);
+  std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler> compiler;
+  if (compile_in_parallel()) {
+    // The shared target machine may not be used concurrently. The concurrent
+    // compiler creates a target machine for each compilation.
+    XLS_ASSIGN_OR_RETURN(llvm::orc::JITTargetMachineBuilder target_builder,
+                         CreateTargetMachineBuilder());
+    compiler = std::make_unique<llvm::orc::ConcurrentIRCompiler>(
+        std::move(target_builder), object_cache_writer_.get());
+  } else {
+    compiler = std::make_unique<llvm::orc::SimpleCompiler>(
+        *target_machine_, object_cache_writer_.get());
+  }
   compile_layer_ = std::make_unique<llvm::orc::IRCompileLayer>(
       execution_session_, object_layer_, std::move(compiler));
 
@@ -273,6 +515,25 @@ absl::Status OrcJit::Init() {
         return Optimizer(std::move(module), responsibility);
       });
 
+  if (compile_lazily()) {
+    llvm::Triple triple = target_machine_->getTargetTriple();
+    auto lazy_call_through_manager =
+        llvm::orc::createLocalLazyCallThroughManager(triple,
+                                                     execution_session_,
+                                                     llvm::orc::ExecutorAddr());
+    if (!lazy_call_through_manager) {
+      return absl::InternalError(absl::StrCat(
+          "Unable to create lazy call-through manager: ",
+          llvm::toString(lazy_call_through_manager.takeError())));
+    }
+    lazy_call_through_manager_ = std::move(lazy_call_through_manager.get());
+    compile_on_demand_layer_ =
+        std::make_unique<llvm::orc::CompileOnDemandLayer>(
+            execution_session_, *transform_layer_, *lazy_call_through_manager_,
+            llvm::orc::createLocalIndirectStubsManagerBuilder(triple));
+    compile_on_demand_layer_->setPartitionFunction(PartitionAtEntryPoints);
+  }
+
   return absl::OkStatus();
 }
 
@@ -325,10 +586,95 @@ absl::Status VerifyModule(const llvm::Module& module) {
 
 }  // namespace
 
+absl::StatusOr<std::vector<llvm::orc::ThreadSafeModule>> OrcJit::SplitModule(
+    std::unique_ptr<llvm::Module> module) {
+  // Each piece is moved into a fresh LLVM context by round-tripping through
+  // bitcode as LLVM contexts may not be used from multiple threads.
+  std::vector<llvm::orc::ThreadSafeModule> pieces;
+  absl::Status status = absl::OkStatus();
+  llvm::SplitModule(
+      *module, compile_threads_, [&](std::unique_ptr<llvm::Module> piece) {
+        if (!status.ok()) {
+          return;
+        }
+        llvm::SmallVector<char, 0> bitcode;
+        llvm::raw_svector_ostream ostream(bitcode);
+        llvm::WriteBitcodeToFile(*piece, ostream);
+
+        llvm::orc::ThreadSafeContext context(
+            std::make_unique<llvm::LLVMContext>());
+        llvm::Expected<std::unique_ptr<llvm::Module>> parsed =
+            llvm::parseBitcodeFile(
+                llvm::MemoryBufferRef(
+                    llvm::StringRef(bitcode.data(), bitcode.size()),
+                    piece->getModuleIdentifier()),
+                *context.getContext());
+        if (!parsed) {
+          status = absl::InternalError(
+              absl::StrFormat("Unable to split module for compilation: %s",
+                              llvm::toString(parsed.takeError())));
+          return;
+        }
+        pieces.push_back(
+            llvm::orc::ThreadSafeModule(std::move(parsed.get()), context));
+      });
+  XLS_RETURN_IF_ERROR(status);
+  XLS_VLOG(2) << absl::StreamFormat("Split module `%s` into %d pieces",
+                                    module->getModuleIdentifier(),
+                                    pieces.size());
+  return pieces;
+}
+
 absl::Status OrcJit::CompileModule(std::unique_ptr<llvm::Module>&& module) {
+  ScopedTrace trace("OrcJit::CompileModule", "jit");
   XLS_RETURN_IF_ERROR(VerifyModule(*module));
-  llvm::Error error = transform_layer_->add(
-      dylib_, llvm::orc::ThreadSafeModule(std::move(module), context_));
+  if (!compile_in_parallel() || module->size() < 2) {
+    return AddModule(llvm::orc::ThreadSafeModule(std::move(module), context_));
+  }
+  XLS_ASSIGN_OR_RETURN(std::vector<llvm::orc::ThreadSafeModule> pieces,
+                       SplitModule(std::move(module)));
+  for (llvm::orc::ThreadSafeModule& piece : pieces) {
+    XLS_RETURN_IF_ERROR(AddModule(std::move(piece)));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status OrcJit::AddModule(llvm::orc::ThreadSafeModule module) {
+  // The object cache is bypassed with lazy compilation because the modules
+  // which are eventually compiled are extracted on demand from `module`. It
+  // is also bypassed for modules embedding host addresses, whose object code
+  // cannot be reused by another process.
+  if (object_cache_ != nullptr && !compile_lazily() &&
+      !EmbedsHostAddresses(*module.getModuleUnlocked())) {
+    std::string key = JitObjectCache::ComputeKey(
+        DumpLlvmModuleToString(*module.getModuleUnlocked()), opt_level_,
+        GetTargetDescription(), object_cache_->build());
+    XLS_ASSIGN_OR_RETURN(std::optional<std::vector<uint8_t>> cached_object,
+                         object_cache_->Lookup(key));
+    if (cached_object.has_value()) {
+      // Add the cached object directly to the object linking layer bypassing
+      // optimization and code generation.
+      llvm::Error error = object_layer_.add(
+          dylib_, llvm::MemoryBuffer::getMemBufferCopy(llvm::StringRef(
+                      reinterpret_cast<const char*>(cached_object->data()),
+                      cached_object->size())));
+      if (error) {
+        return absl::UnknownError(
+            absl::StrFormat("Error loading cached object code: %s",
+                            llvm::toString(std::move(error))));
+      }
+      if (emit_object_code_) {
+        object_code_ = std::move(cached_object).value();
+      }
+      return absl::OkStatus();
+    }
+    object_cache_writer_->SetKey(module.getModuleUnlocked(), std::move(key));
+  }
+  llvm::orc::IRLayer* layer =
+      compile_lazily()
+          ? static_cast<llvm::orc::IRLayer*>(compile_on_demand_layer_.get())
+          : static_cast<llvm::orc::IRLayer*>(transform_layer_.get());
+  llvm::Error error = layer->add(dylib_, std::move(module));
   if (error) {
     return absl::UnknownError(absl::StrFormat(
         "Error compiling converted IR: %s", llvm::toString(std::move(error))));
@@ -15,23 +15,38 @@
 #ifndef XLS_JIT_ORC_JIT_H_
 #define XLS_JIT_ORC_JIT_H_
 
+#include <filesystem>  // NOLINT
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Core.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRCompileLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRTransformLayer.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/LazyReexports.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
 #include "llvm/include/llvm/Target/TargetMachine.h"
+#include "xls/jit/jit_object_cache.h"
 
 namespace xls {
 
+class OrcJitObjectCacheWriter;
+
+// Name of the LLVM function attribute marking functions which are entry points
+// of jitted XLS FunctionBases (e.g., the function implementing an invoked XLS
+// function). With lazy compilation these functions are compiled on first call
+// along with all the functions they reference other than other entry points.
+inline constexpr std::string_view kJitEntryPointAttribute = "xls-entry-point";
+
 // A wrapper around ORC JIT which hides some of the internals of the LLVM
 // interface.
 class OrcJit {
@@ -40,8 +55,34 @@ class OrcJit {
   // Create an LLVM ORC JIT instance which compiles at the given optimization
   // level. If `emit_object_code` is true then `GetObjectCode` can be called
   // after compilation to get the object code.
+  //
+  // If `object_cache_dir` is given (or, if not given, the
+  // --xls_jit_object_cache_dir flag is set) compiled object code is stored in
+  // and reloaded from a persistent cache in that directory (see
+  // JitObjectCache). Modules found in the cache are neither optimized nor
+  // code-generated. Modules which embed host addresses of this process (e.g.,
+  // procs, whose code refers to their channel queues, and functions with
+  // traces, assertions or wide operations calling runtime callbacks) are
+  // always compiled and never cached. The size of the cache is bounded by the
+  // --xls_jit_object_cache_max_bytes flag.
+  //
+  // If `compile_threads` is greater than one (or, if not given, the
+  // --xls_jit_compile_threads flag is greater than one) modules passed to
+  // CompileModule are split into up to that many independent modules, each in
+  // its own LLVM context, which are optimized and code-generated concurrently.
+  // Parallel compilation is not supported when `emit_object_code` is true.
+  //
+  // If `lazy_compilation` is true (or, if not given, the
+  // --xls_jit_lazy_compilation flag is set) compilation of each entry point
+  // (see kJitEntryPointAttribute) is deferred until it is first called. Symbols
+  // returned by LoadSymbol are then stubs which compile the code on demand.
+  // Lazy compilation is not supported when `emit_object_code` is true and
+  // bypasses the object cache.
   static absl::StatusOr<std::unique_ptr<OrcJit>> Create(
-      int64_t opt_level = 3, bool emit_object_code = false);
+      int64_t opt_level = 3, bool emit_object_code = false,
+      std::optional<std::filesystem::path> object_cache_dir = std::nullopt,
+      std::optional<int64_t> compile_threads = std::nullopt,
+      std::optional<bool> lazy_compilation = std::nullopt);
 
   // Creates and returns a new LLVM module of the given name.
   std::unique_ptr<llvm::Module> NewModule(std::string_view name);
@@ -63,9 +104,41 @@ class OrcJit {
   // Creates and returns a data layout object.
   static absl::StatusOr<llvm::DataLayout> CreateDataLayout();
 
+  // Returns true if this JIT emits object code (see `Create`). Generated code
+  // may then be run in a different process so must not embed host addresses.
+  bool emit_object_code() const { return emit_object_code_; }
+
+  // Returns the persistent object cache used by this JIT, or nullptr if
+  // caching is disabled.
+  JitObjectCache* object_cache() const { return object_cache_.get(); }
+
  private:
-  OrcJit(int64_t opt_level, bool emit_object_code);
-  absl::Status Init();
+  OrcJit(int64_t opt_level, bool emit_object_code, int64_t compile_threads,
+         bool lazy_compilation);
+  absl::Status Init(std::optional<std::filesystem::path> object_cache_dir);
+
+  // Adds the given module to the JIT, either by loading its object code from
+  // the object cache (if enabled) or by adding it to the compilation pipeline.
+  absl::Status AddModule(llvm::orc::ThreadSafeModule module);
+
+  // Splits `module` into at most `compile_threads_` modules each with its own
+  // LLVM context so that they may be compiled concurrently.
+  absl::StatusOr<std::vector<llvm::orc::ThreadSafeModule>> SplitModule(
+      std::unique_ptr<llvm::Module> module);
+
+  bool compile_in_parallel() const {
+    return compile_threads_ > 1 && !emit_object_code_;
+  }
+  bool compile_lazily() const {
+    return lazy_compilation_ && !emit_object_code_;
+  }
+
+  static absl::StatusOr<llvm::orc::JITTargetMachineBuilder>
+  CreateTargetMachineBuilder();
+
+  // Returns a string describing the target machine. Used as part of the key
+  // for cached object code.
+  std::string GetTargetDescription() const;
 
   static absl::StatusOr<std::unique_ptr<llvm::TargetMachine>>
   CreateTargetMachine();
@@ -83,6 +156,12 @@ class OrcJit {
 
   int64_t opt_level_;
   bool emit_object_code_;
+  int64_t compile_threads_;
+  bool lazy_compilation_;
+
+  // Guards use of `target_machine_` for dumping assembly from the optimizer
+  // which may run concurrently when compiling in parallel.
+  absl::Mutex asm_dump_mutex_;
 
   std::unique_ptr<llvm::TargetMachine> target_machine_;
   llvm::DataLayout data_layout_;
@@ -92,9 +171,18 @@ class OrcJit {
   // If set, this contains the logic to emit object code.
   std::unique_ptr<llvm::orc::IRTransformLayer> object_code_layer_;
 
+  // Layers and managers implementing lazy compilation (if enabled).
+  std::unique_ptr<llvm::orc::LazyCallThroughManager> lazy_call_through_manager_;
+  std::unique_ptr<llvm::orc::CompileOnDemandLayer> compile_on_demand_layer_;
+
   // When `CompileModule` is called and `emit_object_code` is true, this vector
   // will be allocated and filled with the object code of the compiled module.
   std::vector<uint8_t> object_code_;
+
+  // The persistent object code cache (if enabled) and the hook which writes
+  // newly compiled objects into it.
+  std::unique_ptr<JitObjectCache> object_cache_;
+  std::unique_ptr<OrcJitObjectCacheWriter> object_cache_writer_;
 };
 
 // Calls the dump method on the given LLVM object and returns the string.
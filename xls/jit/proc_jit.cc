@@ -14,16 +14,20 @@
 
 #include "xls/jit/proc_jit.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/proc.h"
@@ -33,28 +37,45 @@
 
 namespace xls {
 
-ProcJitContinuation::ProcJitContinuation(Proc* proc, int64_t temp_buffer_size,
-                                         JitRuntime* jit_runtime)
+ProcJitContinuation::ProcJitContinuation(
+    Proc* proc, int64_t temp_buffer_size, JitRuntime* jit_runtime,
+    absl::Span<const int64_t> in_place_state_indices)
     : proc_(proc), continuation_point_(0), jit_runtime_(jit_runtime) {
-  // Pre-allocate input, output, and temporary buffers.
+  absl::flat_hash_set<Param*> in_place_params;
+  for (int64_t index : in_place_state_indices) {
+    in_place_params.insert(proc->GetStateParam(index));
+  }
+  // Pre-allocate input, output, and temporary buffers. The outer vector is
+  // sized up front so the raw pointers into it remain valid.
+  buffers_.reserve(2 * proc->params().size());
   for (Param* param : proc->params()) {
     int64_t param_size = jit_runtime_->GetTypeByteSize(param->GetType());
-    input_buffers_.push_back(std::vector<uint8_t>(param_size));
-    output_buffers_.push_back(std::vector<uint8_t>(param_size));
-    input_ptrs_.push_back(input_buffers_.back().data());
-    output_ptrs_.push_back(output_buffers_.back().data());
+    buffer_sizes_.push_back(param_size);
+    buffers_.push_back(std::vector<uint8_t>(param_size));
+    input_ptrs_.push_back(buffers_.back().data());
+    if (in_place_params.contains(param)) {
+      output_ptrs_.push_back(input_ptrs_.back());
+    } else {
+      buffers_.push_back(std::vector<uint8_t>(param_size));
+      output_ptrs_.push_back(buffers_.back().data());
+    }
   }
 
   // Write initial state value to the input_buffer.
   for (Param* state_param : proc->StateParams()) {
     int64_t param_index = proc->GetParamIndex(state_param).value();
     int64_t state_index = proc->GetStateParamIndex(state_param).value();
-    jit_runtime->BlitValueToBuffer(proc->GetInitValueElement(state_index),
-                                   state_param->GetType(),
-                                   absl::MakeSpan(input_buffers_[param_index]));
+    jit_runtime->BlitValueToBuffer(
+        proc->GetInitValueElement(state_index), state_param->GetType(),
+        absl::MakeSpan(input_ptrs_[param_index], buffer_sizes_[param_index]));
   }
 
   temp_buffer_.resize(temp_buffer_size);
+  int64_t buffer_bytes = temp_buffer_.size();
+  for (const std::vector<uint8_t>& buffer : buffers_) {
+    buffer_bytes += buffer.size();
+  }
+  buffer_memory_account_.Add(buffer_bytes);
 }
 
 std::vector<Value> ProcJitContinuation::GetState() const {
@@ -62,8 +83,7 @@ std::vector<Value> ProcJitContinuation::GetState() const {
   for (Param* state_param : proc()->StateParams()) {
     int64_t param_index = proc()->GetParamIndex(state_param).value();
     state.push_back(jit_runtime_->UnpackBuffer(input_ptrs_[param_index],
-                                               state_param->GetType(),
-                                               /*unpoison=*/true));
+                                               state_param->GetType()));
   }
   return state;
 }
@@ -72,24 +92,101 @@ void ProcJitContinuation::NextTick() {
   continuation_point_ = 0;
   {
     using std::swap;
-    swap(input_buffers_, output_buffers_);
     swap(input_ptrs_, output_ptrs_);
   }
 }
 
+ProcJitContinuationState ProcJitContinuation::SaveState() const {
+  auto copy_buffers = [&](absl::Span<uint8_t* const> ptrs) {
+    std::vector<std::vector<uint8_t>> buffers;
+    for (int64_t i = 0; i < ptrs.size(); ++i) {
+      buffers.push_back(
+          std::vector<uint8_t>(ptrs[i], ptrs[i] + buffer_sizes_[i]));
+    }
+    return buffers;
+  };
+  return ProcJitContinuationState{.continuation_point = continuation_point_,
+                                  .input_buffers = copy_buffers(input_ptrs_),
+                                  .output_buffers = copy_buffers(output_ptrs_),
+                                  .temp_buffer = temp_buffer_};
+}
+
+absl::Status ProcJitContinuation::RestoreState(
+    const ProcJitContinuationState& state) {
+  auto check_buffers = [&](absl::Span<const std::vector<uint8_t>> actual,
+                           absl::Span<uint8_t* const> ptrs) -> absl::Status {
+    XLS_RET_CHECK_EQ(actual.size(), ptrs.size());
+    for (int64_t i = 0; i < actual.size(); ++i) {
+      XLS_RET_CHECK_EQ(actual[i].size(), buffer_sizes_[i])
+          << "Mismatched size of buffer " << i;
+    }
+    return absl::OkStatus();
+  };
+  XLS_RETURN_IF_ERROR(check_buffers(state.input_buffers, input_ptrs_))
+      << "Invalid state for proc " << proc()->name();
+  XLS_RETURN_IF_ERROR(check_buffers(state.output_buffers, output_ptrs_))
+      << "Invalid state for proc " << proc()->name();
+  XLS_RET_CHECK_EQ(state.temp_buffer.size(), temp_buffer_.size())
+      << "Invalid state for proc " << proc()->name();
+
+  // Copy into the existing buffers so the raw pointers remain valid. The
+  // inputs are copied last as they take precedence for state elements updated
+  // in place, whose input and output share a buffer.
+  for (int64_t i = 0; i < output_ptrs_.size(); ++i) {
+    std::copy(state.output_buffers[i].begin(), state.output_buffers[i].end(),
+              output_ptrs_[i]);
+  }
+  for (int64_t i = 0; i < input_ptrs_.size(); ++i) {
+    std::copy(state.input_buffers[i].begin(), state.input_buffers[i].end(),
+              input_ptrs_[i]);
+  }
+  std::copy(state.temp_buffer.begin(), state.temp_buffer.end(),
+            temp_buffer_.begin());
+  continuation_point_ = state.continuation_point;
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::unique_ptr<ProcJit>> ProcJit::Create(
-    Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr) {
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit, OrcJit::Create());
+    Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr,
+    JitProfile* profile, int64_t opt_level) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit,
+                       OrcJit::Create(opt_level));
   auto jit =
       absl::WrapUnique(new ProcJit(proc, jit_runtime, std::move(orc_jit)));
   XLS_ASSIGN_OR_RETURN(jit->jitted_function_base_,
-                       BuildProcFunction(proc, queue_mgr, jit->GetOrcJit()));
+                       BuildProcFunction(proc, queue_mgr, jit->GetOrcJit(),
+                                         profile));
   return jit;
 }
 
+absl::StatusOr<JitProcObjectCode> ProcJit::CreateObjectCode(
+    absl::Span<Proc* const> procs, int64_t opt_level) {
+  XLS_RET_CHECK(!procs.empty());
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit,
+                       OrcJit::Create(opt_level, /*emit_object_code=*/true));
+  XLS_ASSIGN_OR_RETURN(std::vector<JittedFunctionBase> jitted_procs,
+                       BuildProcFunctionsWithHooks(procs, *orc_jit));
+  JitProcObjectCode object_code;
+  object_code.object_code = orc_jit->GetObjectCode();
+  object_code.temp_buffer_size = jitted_procs.front().temp_buffer_size;
+  for (int64_t i = 0; i < procs.size(); ++i) {
+    JittedFunctionBase& jitted_proc = jitted_procs[i];
+    XLS_RET_CHECK(jitted_proc.multi_tick_function_name.has_value());
+    object_code.entry_points.push_back(JitProcObjectCode::EntryPoint{
+        .proc = procs[i],
+        .function_name = *jitted_proc.multi_tick_function_name,
+        .parameter_buffer_sizes = jitted_proc.input_buffer_sizes,
+        .in_place_state_indices = jitted_proc.in_place_state_indices,
+        .continuation_points = std::move(jitted_proc.continuation_points),
+    });
+  }
+  return object_code;
+}
+
 std::unique_ptr<ProcContinuation> ProcJit::NewContinuation() const {
   return std::make_unique<ProcJitContinuation>(
-      proc(), jitted_function_base_.temp_buffer_size, jit_runtime_);
+      proc(), jitted_function_base_.temp_buffer_size, jit_runtime_,
+      jitted_function_base_.in_place_state_indices);
 }
 
 absl::StatusOr<TickResult> ProcJit::Tick(ProcContinuation& continuation) const {
@@ -140,4 +237,54 @@ absl::StatusOr<TickResult> ProcJit::Tick(ProcContinuation& continuation) const {
       .progress_made = next_continuation_point != start_continuation_point};
 }
 
+absl::StatusOr<MultiTickResult> ProcJit::RunTicks(
+    ProcContinuation& continuation, int64_t max_ticks) const {
+  ProcJitContinuation* cont = dynamic_cast<ProcJitContinuation*>(&continuation);
+  XLS_RET_CHECK_NE(cont, nullptr)
+      << "ProcJit requires a continuation of type ProcJitContinuation";
+  XLS_RET_CHECK_GE(max_ticks, 0);
+  XLS_RET_CHECK(jitted_function_base_.multi_tick_function.has_value());
+  int64_t start_continuation_point = cont->GetContinuationPoint();
+
+  int64_t tick_state[2] = {start_continuation_point, max_ticks};
+  JitMultiTickFunctionType multi_tick_function =
+      *jitted_function_base_.multi_tick_function;
+  int64_t next_continuation_point = multi_tick_function(
+      cont->GetInputBuffers().data(), cont->GetOutputBuffers().data(),
+      cont->GetTempBuffer().data(), &cont->GetEvents(),
+      /*user_data=*/nullptr, runtime(), tick_state);
+  int64_t ticks_completed = tick_state[1];
+
+  // The jitted code swaps the input and output buffers after each tick, so
+  // after an odd number of ticks the next state is in the output buffers.
+  if (ticks_completed % 2 == 1) {
+    cont->NextTick();
+  }
+  cont->SetContinuationPoint(next_continuation_point);
+  if (next_continuation_point == 0) {
+    return MultiTickResult{
+        .ticks_completed = ticks_completed,
+        .tick_result = TickResult{
+            .execution_state = TickExecutionState::kCompleted,
+            .channel = std::nullopt,
+            .progress_made = ticks_completed > 0}};
+  }
+  XLS_RET_CHECK(jitted_function_base_.continuation_points.contains(
+      next_continuation_point));
+  Node* early_exit_node =
+      jitted_function_base_.continuation_points.at(next_continuation_point);
+  XLS_RET_CHECK(early_exit_node->Is<Receive>());
+  XLS_ASSIGN_OR_RETURN(Channel * blocked_channel,
+                       proc()->package()->GetChannel(
+                           early_exit_node->As<Receive>()->channel_id()));
+  return MultiTickResult{
+      .ticks_completed = ticks_completed,
+      .tick_result = TickResult{
+          .execution_state = TickExecutionState::kBlockedOnReceive,
+          .channel = blocked_channel,
+          .progress_made =
+              ticks_completed > 0 ||
+              next_continuation_point != start_continuation_point}};
+}
+
 }  // namespace xls
@@ -15,12 +15,17 @@
 #ifndef XLS_JIT_PROC_JIT_H_
 #define XLS_JIT_PROC_JIT_H_
 
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/common/memory_accounting.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/proc_evaluator.h"
 #include "xls/interpreter/serial_proc_runtime.h"
@@ -29,11 +34,23 @@
 #include "xls/ir/value.h"
 #include "xls/jit/function_base_jit.h"
 #include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/orc_jit.h"
 
 namespace xls {
 
+// The execution state of a ProcJitContinuation as raw native-layout buffers.
+// Captures everything needed to resume the proc, including the partially
+// executed tick if the proc is blocked mid-tick. Interpreter events are not
+// included.
+struct ProcJitContinuationState {
+  int64_t continuation_point = 0;
+  std::vector<std::vector<uint8_t>> input_buffers;
+  std::vector<std::vector<uint8_t>> output_buffers;
+  std::vector<uint8_t> temp_buffer;
+};
+
 // A continuation used by the ProcJit. Stores control and data state of proc
 // execution for the JIT.
 class ProcJitContinuation : public ProcContinuation {
@@ -42,9 +59,13 @@ class ProcJitContinuation : public ProcContinuation {
   // to its initial values with no proc nodes yet executed. `temp_buffer_size`
   // specifies the size of a flat buffer used to hold temporary xls::Node values
   // during execution of the JITed function. The size of the buffer is
-  // determined at JIT compile time and known by the ProcJit.
-  explicit ProcJitContinuation(Proc* proc, int64_t temp_buffer_size,
-                               JitRuntime* jit_runtime);
+  // determined at JIT compile time and known by the ProcJit. The state
+  // elements with indices `in_place_state_indices` use the same buffer for
+  // their current and next value (see
+  // JittedFunctionBase::in_place_state_indices).
+  explicit ProcJitContinuation(
+      Proc* proc, int64_t temp_buffer_size, JitRuntime* jit_runtime,
+      absl::Span<const int64_t> in_place_state_indices = {});
 
   ~ProcJitContinuation() override = default;
 
@@ -74,6 +95,12 @@ class ProcJitContinuation : public ProcContinuation {
 
   Proc* proc() const { return proc_; }
 
+  // Copies the execution state out of (into) the continuation. Restoring
+  // requires a state saved from a continuation of the same proc compiled the
+  // same way.
+  ProcJitContinuationState SaveState() const;
+  absl::Status RestoreState(const ProcJitContinuationState& state);
+
  private:
   Proc* proc_;
   int64_t continuation_point_;
@@ -82,14 +109,47 @@ class ProcJitContinuation : public ProcContinuation {
   InterpreterEvents events_;
 
   // Buffers to hold inputs, outputs, and temporary storage. This is allocated
-  // once and then re-used with each invocation of Run. Not thread-safe.
-  std::vector<std::vector<uint8_t>> input_buffers_;
-  std::vector<std::vector<uint8_t>> output_buffers_;
+  // once and then re-used with each invocation of Run. Not thread-safe. Each
+  // param has two buffers whose roles as input and output alternate each
+  // tick, except for state elements updated in place which have one.
+  std::vector<std::vector<uint8_t>> buffers_;
 
-  // Raw pointers to the buffers held in `input_buffers_` and `output_buffers_`.
+  // Raw pointers to the input and output buffers held in `buffers_`.
   std::vector<uint8_t*> input_ptrs_;
   std::vector<uint8_t*> output_ptrs_;
+  std::vector<int64_t> buffer_sizes_;
   std::vector<uint8_t> temp_buffer_;
+  MemoryAccount buffer_memory_account_{MemoryTag::kJitBuffers};
+};
+
+// Data structure containing jitted object code implementing a set of procs
+// for ahead-of-time compilation (see BuildProcFunctionsWithHooks) along with
+// metadata about how to call each of them.
+struct JitProcObjectCode {
+  // Metadata about a single proc in the object code.
+  struct EntryPoint {
+    Proc* proc;
+
+    // Name of the jitted function running multiple ticks of the proc (see
+    // JitMultiTickFunctionType).
+    std::string function_name;
+
+    // Sizes of the buffers of the proc parameters.
+    std::vector<int64_t> parameter_buffer_sizes;
+
+    // See JittedFunctionBase.
+    std::vector<int64_t> in_place_state_indices;
+    absl::flat_hash_map<int64_t, Node*> continuation_points;
+  };
+
+  std::vector<uint8_t> object_code;
+
+  // The entry points in the same order as the procs passed to
+  // ProcJit::CreateObjectCode.
+  std::vector<EntryPoint> entry_points;
+
+  // Minimum size of the temporary buffer of each proc.
+  int64_t temp_buffer_size;
 };
 
 // This class provides a facility to execute XLS procs (on the host) by
@@ -97,9 +157,18 @@ class ProcJitContinuation : public ProcContinuation {
 class ProcJit : public ProcEvaluator {
  public:
   // Returns an object containing a host-compiled version of the specified XLS
-  // proc.
+  // proc. If `profile` is non-null the compiled code records execution
+  // counters into it (see JitProfile). `opt_level` is the LLVM optimization
+  // level.
   static absl::StatusOr<std::unique_ptr<ProcJit>> Create(
-      Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr);
+      Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr,
+      JitProfile* profile = nullptr, int64_t opt_level = 3);
+
+  // Returns the object code implementing `procs`, which must belong to the
+  // same package, for ahead-of-time compilation. Sends and receives in the
+  // code call through channel hooks rather than JitChannelQueues.
+  static absl::StatusOr<JitProcObjectCode> CreateObjectCode(
+      absl::Span<Proc* const> procs, int64_t opt_level = 3);
 
   ~ProcJit() override = default;
 
@@ -107,6 +176,17 @@ class ProcJit : public ProcEvaluator {
   absl::StatusOr<TickResult> Tick(
       ProcContinuation& continuation) const override;
 
+  // Runs up to `max_ticks` ticks of the proc, resuming `continuation` where it
+  // stopped, in a single call into the jitted code. Unlike Tick, execution
+  // continues past sends and control returns only when `max_ticks` ticks have
+  // completed or a blocking receive has no data; the channel queues are read
+  // and written directly by the jitted code in the meantime. Interpreter
+  // events of all the ticks accumulate in the continuation. Execution stops
+  // either with kCompleted or kBlockedOnReceive.
+  absl::StatusOr<MultiTickResult> RunTicks(ProcContinuation& continuation,
+                                           int64_t max_ticks) const override;
+  bool SupportsMultiTick() const override { return true; }
+
   JitRuntime* runtime() const { return jit_runtime_; }
 
   OrcJit& GetOrcJit() { return *orc_jit_; }
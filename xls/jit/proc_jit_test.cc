@@ -14,7 +14,9 @@
 
 #include "xls/jit/proc_jit.h"
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -22,7 +24,12 @@
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/proc_evaluator.h"
 #include "xls/interpreter/proc_evaluator_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/package.h"
 #include "xls/ir/proc.h"
+#include "xls/ir/value.h"
 #include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/orc_jit.h"
@@ -52,5 +59,208 @@ INSTANTIATE_TEST_SUITE_P(
           return JitChannelQueueManager::CreateThreadSafe(package).value();
         })));
 
+using status_testing::IsOkAndHolds;
+using testing::ElementsAre;
+using testing::Optional;
+
+TEST(ProcJitTest, RunTicks) {
+  Package package("run_ticks");
+  ProcBuilder pb("prev", /*token_name=*/"tok", &package);
+  BValue prev_input = pb.StateElement("prev_in", Value(UBits(55, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * ch_in, package.CreateStreamingChannel(
+                                                "in", ChannelOps::kSendReceive,
+                                                package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * ch_out, package.CreateStreamingChannel(
+                                                 "out", ChannelOps::kSendOnly,
+                                                 package.GetBitsType(32)));
+
+  // Receives a value and saves it, and sends the value received in the
+  // previous tick.
+  BValue token_input = pb.Receive(ch_in, pb.GetTokenParam());
+  BValue input = pb.TupleIndex(token_input, 1);
+  BValue send_token =
+      pb.Send(ch_out, pb.TupleIndex(token_input, 0), prev_input);
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build(send_token, {input}));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> queue_manager,
+      JitChannelQueueManager::CreateThreadSafe(&package));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ProcJit> jit,
+      ProcJit::Create(proc, GetJitRuntime(), queue_manager.get()));
+  ChannelQueue& input_queue = queue_manager->GetQueue(ch_in);
+  ChannelQueue& output_queue = queue_manager->GetQueue(ch_out);
+  for (int64_t i = 1; i <= 5; ++i) {
+    XLS_ASSERT_OK(input_queue.Write(Value(UBits(i, 32))));
+  }
+
+  // Sends do not return control, so only the requested number of ticks stops
+  // execution.
+  std::unique_ptr<ProcContinuation> continuation = jit->NewContinuation();
+  XLS_ASSERT_OK_AND_ASSIGN(MultiTickResult result,
+                           jit->RunTicks(*continuation, 3));
+  EXPECT_EQ(result.ticks_completed, 3);
+  EXPECT_EQ(result.tick_result,
+            (TickResult{.execution_state = TickExecutionState::kCompleted,
+                        .channel = std::nullopt,
+                        .progress_made = true}));
+  EXPECT_TRUE(continuation->AtStartOfTick());
+  EXPECT_THAT(continuation->GetState(), ElementsAre(Value(UBits(3, 32))));
+
+  // Running out of input blocks mid-tick.
+  XLS_ASSERT_OK_AND_ASSIGN(result, jit->RunTicks(*continuation, 100));
+  EXPECT_EQ(result.ticks_completed, 2);
+  EXPECT_EQ(result.tick_result,
+            (TickResult{
+                .execution_state = TickExecutionState::kBlockedOnReceive,
+                .channel = ch_in,
+                .progress_made = true}));
+  EXPECT_FALSE(continuation->AtStartOfTick());
+  EXPECT_THAT(continuation->GetState(), ElementsAre(Value(UBits(5, 32))));
+  for (int64_t expected : {55, 1, 2, 3, 4}) {
+    EXPECT_THAT(output_queue.Read(), Optional(Value(UBits(expected, 32))));
+  }
+  EXPECT_TRUE(output_queue.IsEmpty());
+
+  // Blocking again without new input makes no progress.
+  XLS_ASSERT_OK_AND_ASSIGN(result, jit->RunTicks(*continuation, 100));
+  EXPECT_EQ(result.ticks_completed, 0);
+  EXPECT_FALSE(result.tick_result.progress_made);
+
+  // Single ticks pick up where the multi-tick run stopped.
+  XLS_ASSERT_OK(input_queue.Write(Value(UBits(6, 32))));
+  EXPECT_THAT(jit->Tick(*continuation),
+              IsOkAndHolds(TickResult{
+                  .execution_state = TickExecutionState::kSentOnChannel,
+                  .channel = ch_out,
+                  .progress_made = true}));
+  EXPECT_THAT(
+      jit->Tick(*continuation),
+      IsOkAndHolds(TickResult{.execution_state = TickExecutionState::kCompleted,
+                              .channel = std::nullopt,
+                              .progress_made = true}));
+  EXPECT_THAT(output_queue.Read(), Optional(Value(UBits(5, 32))));
+  EXPECT_THAT(continuation->GetState(), ElementsAre(Value(UBits(6, 32))));
+}
+
+TEST(ProcJitTest, StateUpdatedInPlace) {
+  Package package("in_place");
+  ProcBuilder pb("memory", /*token_name=*/"tok", &package);
+  XLS_ASSERT_OK_AND_ASSIGN(Value zeros,
+                           Value::UBitsArray({0, 0, 0, 0, 0, 0, 0, 0}, 32));
+  BValue mem = pb.StateElement("mem", zeros);
+  BValue count = pb.StateElement("count", Value(UBits(0, 32)));
+  BValue next_count = pb.Add(count, pb.Literal(UBits(1, 32)));
+  // Two writes to the memory held in the state, each the only use of the
+  // array it updates.
+  BValue write = pb.ArrayUpdate(mem, count, {pb.BitSlice(count, 0, 3)});
+  BValue next_mem =
+      pb.ArrayUpdate(write, next_count, {pb.BitSlice(next_count, 0, 3)});
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * proc, pb.Build(pb.GetTokenParam(), {next_mem, next_count}));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> queue_manager,
+      JitChannelQueueManager::CreateThreadSafe(&package));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ProcJit> jit,
+      ProcJit::Create(proc, GetJitRuntime(), queue_manager.get()));
+  std::unique_ptr<ProcContinuation> continuation = jit->NewContinuation();
+
+  // The memory has a single buffer for its current and next value. The count
+  // is also used by other nodes so it is not updated in place.
+  ProcJitContinuation* jit_continuation =
+      dynamic_cast<ProcJitContinuation*>(continuation.get());
+  ASSERT_NE(jit_continuation, nullptr);
+  int64_t mem_index = proc->GetParamIndex(proc->GetStateParam(0)).value();
+  int64_t count_index = proc->GetParamIndex(proc->GetStateParam(1)).value();
+  EXPECT_EQ(jit_continuation->GetInputBuffers()[mem_index],
+            jit_continuation->GetOutputBuffers()[mem_index]);
+  EXPECT_NE(jit_continuation->GetInputBuffers()[count_index],
+            jit_continuation->GetOutputBuffers()[count_index]);
+
+  for (int64_t i = 0; i < 10; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(TickResult result, jit->Tick(*continuation));
+    EXPECT_EQ(result.execution_state, TickExecutionState::kCompleted);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Value expected,
+                           Value::UBitsArray({8, 9, 10, 3, 4, 5, 6, 7}, 32));
+  EXPECT_THAT(continuation->GetState(),
+              ElementsAre(expected, Value(UBits(10, 32))));
+}
+
+TEST(ProcJitTest, InlineQueuesOfInternalChannels) {
+  Package package("inline_queues");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * ch_internal,
+      package.CreateStreamingChannel("internal", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * ch_out, package.CreateStreamingChannel(
+                                                 "out", ChannelOps::kSendOnly,
+                                                 package.GetBitsType(32)));
+
+  // Sends an incrementing count on the internal channel.
+  ProcBuilder producer_builder("producer", /*token_name=*/"tok", &package);
+  BValue count = producer_builder.StateElement("count", Value(UBits(0, 32)));
+  BValue producer_send = producer_builder.Send(
+      ch_internal, producer_builder.GetTokenParam(), count);
+  BValue next_count =
+      producer_builder.Add(count, producer_builder.Literal(UBits(1, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * producer,
+                           producer_builder.Build(producer_send, {next_count}));
+
+  // Forwards values from the internal channel to the output channel.
+  ProcBuilder consumer_builder("consumer", /*token_name=*/"tok", &package);
+  consumer_builder.StateElement("unused", Value(UBits(0, 1)));
+  BValue receive =
+      consumer_builder.Receive(ch_internal, consumer_builder.GetTokenParam());
+  BValue consumer_send = consumer_builder.Send(
+      ch_out, consumer_builder.TupleIndex(receive, 0),
+      consumer_builder.TupleIndex(receive, 1));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * consumer,
+      consumer_builder.Build(consumer_send,
+                             {consumer_builder.Literal(UBits(0, 1))}));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> queue_manager,
+      JitChannelQueueManager::CreateSingleThreaded(&package));
+  ASSERT_NE(queue_manager->GetJitQueue(ch_internal).InlineQueue(), nullptr);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ProcJit> producer_jit,
+      ProcJit::Create(producer, GetJitRuntime(), queue_manager.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ProcJit> consumer_jit,
+      ProcJit::Create(consumer, GetJitRuntime(), queue_manager.get()));
+
+  // Enough elements to grow the circular buffer of the queue several times.
+  constexpr int64_t kCount = 100;
+  std::unique_ptr<ProcContinuation> producer_continuation =
+      producer_jit->NewContinuation();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      MultiTickResult result,
+      producer_jit->RunTicks(*producer_continuation, kCount));
+  EXPECT_EQ(result.ticks_completed, kCount);
+  ChannelQueue& internal_queue = queue_manager->GetQueue(ch_internal);
+  EXPECT_EQ(internal_queue.GetSize(), kCount);
+
+  // Values written in C++ are read by the jitted code in order as well.
+  XLS_ASSERT_OK(internal_queue.Write(Value(UBits(kCount, 32))));
+  std::unique_ptr<ProcContinuation> consumer_continuation =
+      consumer_jit->NewContinuation();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      result, consumer_jit->RunTicks(*consumer_continuation, 2 * kCount));
+  EXPECT_EQ(result.ticks_completed, kCount + 1);
+  EXPECT_EQ(result.tick_result.execution_state,
+            TickExecutionState::kBlockedOnReceive);
+  EXPECT_EQ(result.tick_result.channel, ch_internal);
+  EXPECT_TRUE(internal_queue.IsEmpty());
+  ChannelQueue& output_queue = queue_manager->GetQueue(ch_out);
+  for (int64_t i = 0; i <= kCount; ++i) {
+    EXPECT_THAT(output_queue.Read(), Optional(Value(UBits(i, 32))));
+  }
+  EXPECT_TRUE(output_queue.IsEmpty());
+}
+
 }  // namespace
 }  // namespace xls
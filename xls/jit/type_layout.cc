@@ -15,16 +15,54 @@
 #include "xls/jit/type_layout.h"
 
 #include <cstring>
+#include <iterator>
 #include <ostream>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/value_helpers.h"
 
 namespace xls {
 
+TypeLayout::TypeLayout(Type* type, int64_t size,
+                       absl::Span<const ElementLayout> elements)
+    : type_(type), size_(size), elements_(elements.begin(), elements.end()) {
+  XLS_CHECK_EQ(elements.size(), type->leaf_count());
+  BuildValueSteps(type);
+}
+
+void TypeLayout::BuildValueSteps(Type* element_type) {
+  if (element_type->IsBits()) {
+    value_steps_.push_back(
+        ValueStep{.kind = ValueStep::kBits,
+                  .count = element_type->AsBitsOrDie()->bit_count()});
+    return;
+  }
+  if (element_type->IsToken()) {
+    value_steps_.push_back(ValueStep{.kind = ValueStep::kToken, .count = 0});
+    return;
+  }
+  if (element_type->IsTuple()) {
+    TupleType* tuple_type = element_type->AsTupleOrDie();
+    for (int64_t i = 0; i < tuple_type->size(); ++i) {
+      BuildValueSteps(tuple_type->element_type(i));
+    }
+    value_steps_.push_back(
+        ValueStep{.kind = ValueStep::kTuple, .count = tuple_type->size()});
+    return;
+  }
+  XLS_CHECK(element_type->IsArray());
+  ArrayType* array_type = element_type->AsArrayOrDie();
+  for (int64_t i = 0; i < array_type->size(); ++i) {
+    BuildValueSteps(array_type->element_type());
+  }
+  value_steps_.push_back(
+      ValueStep{.kind = ValueStep::kArray, .count = array_type->size()});
+}
+
 static bool IsLeafValue(const Value& value) {
   return value.IsBits() || value.IsToken();
 }
@@ -43,7 +81,7 @@ static void LeafValueToNativeLayout(const Value& value,
     return;
   }
   XLS_CHECK(value.IsToken());
-  std::memset(buffer, 0, element_layout.padded_size);
+  std::memset(element_buffer, 0, element_layout.padded_size);
 }
 
 void TypeLayout::ValueToNativeLayout(const Value& value,
@@ -95,50 +133,44 @@ void TypeLayout::ValueToNativeLayout(const Value& value,
   XLS_CHECK_EQ(leaf_index, elements_.size());
 }
 
-Value TypeLayout::NativeLayoutToValueInternal(Type* element_type,
-                                              const uint8_t* buffer,
-                                              int64_t* leaf_index) const {
-  if (element_type->IsBits()) {
-    int64_t bit_count = element_type->AsBitsOrDie()->bit_count();
-    const ElementLayout& element_layout = elements_.at(*leaf_index);
-    ++(*leaf_index);
-    return Value(
-        Bits::FromBytes(absl::MakeSpan(buffer + element_layout.offset,
-                                       CeilOfRatio(bit_count, int64_t{8})),
-                        bit_count));
-  }
-  if (element_type->IsToken()) {
-    ++(*leaf_index);
-    return Value::Token();
-  }
-  if (element_type->IsTuple()) {
-    TupleType* tuple_type = element_type->AsTupleOrDie();
-    std::vector<Value> elements;
-    for (int64_t i = 0; i < tuple_type->size(); ++i) {
-      elements.push_back(NativeLayoutToValueInternal(
-          tuple_type->element_type(i), buffer, leaf_index));
-    }
-    return Value::TupleOwned(std::move(elements));
-  }
-
-  XLS_CHECK(element_type->IsArray());
-  ArrayType* array_type = element_type->AsArrayOrDie();
-  std::vector<Value> elements;
-  for (int64_t i = 0; i < array_type->size(); ++i) {
-    elements.push_back(NativeLayoutToValueInternal(array_type->element_type(),
-                                                   buffer, leaf_index));
-  }
-  return Value::ArrayOwned(std::move(elements));
-}
-
 Value TypeLayout::NativeLayoutToValue(const uint8_t* buffer) const {
 #ifdef ABSL_HAVE_MEMORY_SANITIZER
   // The buffer likely was written by the JIT so it may appear uninitialized to
   // sanitizers.
   __msan_unpoison(buffer, size());
 #endif  // ABSL_HAVE_MEMORY_SANITIZER
+  absl::InlinedVector<Value, 8> stack;
   int64_t leaf_index = 0;
-  return NativeLayoutToValueInternal(type_, buffer, &leaf_index);
+  // Moves the top `count` values on the stack into a vector.
+  auto pop_elements = [&](int64_t count) {
+    std::vector<Value> elements(std::make_move_iterator(stack.end() - count),
+                                std::make_move_iterator(stack.end()));
+    stack.resize(stack.size() - count);
+    return elements;
+  };
+  for (const ValueStep& step : value_steps_) {
+    switch (step.kind) {
+      case ValueStep::kBits:
+        stack.push_back(Value(Bits::FromBytes(
+            absl::MakeSpan(buffer + elements_[leaf_index].offset,
+                           CeilOfRatio(step.count, int64_t{8})),
+            step.count)));
+        ++leaf_index;
+        break;
+      case ValueStep::kToken:
+        stack.push_back(Value::Token());
+        ++leaf_index;
+        break;
+      case ValueStep::kTuple:
+        stack.push_back(Value::TupleOwned(pop_elements(step.count)));
+        break;
+      case ValueStep::kArray:
+        stack.push_back(Value::ArrayOwned(pop_elements(step.count)));
+        break;
+    }
+  }
+  XLS_CHECK_EQ(stack.size(), 1);
+  return std::move(stack.front());
 }
 
 std::string TypeLayout::ToString() const {
@@ -86,10 +86,7 @@ struct ElementLayout {
 class TypeLayout {
  public:
   explicit TypeLayout(Type* type, int64_t size,
-                      absl::Span<const ElementLayout> elements)
-      : type_(type), size_(size), elements_(elements.begin(), elements.end()) {
-    XLS_CHECK_EQ(elements.size(), type->leaf_count());
-  }
+                      absl::Span<const ElementLayout> elements);
 
   // Converts TypeLayout objects to/from TypeLayoutProtos.
   static absl::StatusOr<TypeLayout> FromProto(const TypeLayoutProto& proto,
@@ -101,7 +98,8 @@ class TypeLayout {
   void ValueToNativeLayout(const Value& value, uint8_t* buffer) const;
 
   // Returns a Value object representing the data of XLS type `type()` stored in
-  // `buffer`.
+  // `buffer`. Executes the precomputed construction plan of the type so no
+  // type traversal is performed.
   Value NativeLayoutToValue(const uint8_t* buffer) const;
 
   absl::Span<const ElementLayout> elements() const { return elements_; }
@@ -114,12 +112,22 @@ class TypeLayout {
   std::string ToString() const;
 
  private:
-  Value NativeLayoutToValueInternal(Type* element_type, const uint8_t* buffer,
-                                    int64_t* leaf_index) const;
+  // A step in the flattened plan for constructing a Value from the native
+  // layout. Steps are in post-order: leaf steps push a value onto a stack and
+  // compound steps replace the top `count` values with an aggregate of them.
+  struct ValueStep {
+    enum Kind : uint8_t { kBits, kToken, kTuple, kArray };
+    Kind kind;
+    // Bit count for kBits steps, element count for kTuple and kArray steps.
+    int64_t count;
+  };
+
+  void BuildValueSteps(Type* element_type);
 
   Type* type_;
   int64_t size_;
   std::vector<ElementLayout> elements_;
+  std::vector<ValueStep> value_steps_;
 };
 
 std::ostream& operator<<(std::ostream& os, ElementLayout layout);
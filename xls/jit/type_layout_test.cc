@@ -22,6 +22,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/bits_util.h"
+#include "xls/common/thread.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/matchers.h"
 #include "xls/data_structures/leaf_type_tree.h"
@@ -30,6 +31,7 @@
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/number_parser.h"
 #include "xls/ir/type.h"
+#include "xls/jit/jit_runtime.h"
 #include "xls/jit/llvm_type_converter.h"
 #include "xls/jit/orc_jit.h"
 
@@ -351,5 +353,98 @@ TEST_F(TypeLayoutTest, JitTypes) {
   }
 }
 
+TEST_F(TypeLayoutTest, MatchesJitRuntime) {
+  // Layouts and the JitRuntime conversion routines must agree on the native
+  // layout of values.
+  constexpr int64_t kValuesPerType = 10;
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitRuntime> runtime,
+                           JitRuntime::Create());
+  std::minstd_rand bitgen;
+  for (const char* type_str :
+       {"()", "token", "bits[42]", "(token, bits[3])",
+        "(bits[1], (bits[8], bits[16], bits[1][3])[2], bits[77])",
+        "(bits[3], (), bits[5], bits[7])[2][1][3]"}) {
+    XLS_ASSERT_OK_AND_ASSIGN(Type * type,
+                             Parser::ParseType(type_str, package.get()));
+    TypeLayout layout = runtime->CreateTypeLayout(type);
+    ASSERT_EQ(layout.size(), runtime->GetTypeByteSize(type));
+    for (int64_t i = 0; i < kValuesPerType; ++i) {
+      Value value = RandomValue(type, &bitgen);
+
+      std::vector<uint8_t> runtime_buffer(layout.size());
+      runtime->BlitValueToBuffer(value, type, absl::MakeSpan(runtime_buffer));
+      EXPECT_EQ(layout.NativeLayoutToValue(runtime_buffer.data()), value);
+
+      std::vector<uint8_t> layout_buffer(layout.size(), 0);
+      layout.ValueToNativeLayout(value, layout_buffer.data());
+      EXPECT_EQ(runtime->UnpackBuffer(layout_buffer.data(), type), value);
+      EXPECT_EQ(layout_buffer, runtime_buffer);
+    }
+  }
+}
+
+TEST_F(TypeLayoutTest, ConcurrentJitRuntimeConversions) {
+  // Conversions of values of the same types from multiple threads must not
+  // interfere with each other, including the first conversion of each type
+  // which computes its layout.
+  constexpr int64_t kThreadCount = 8;
+  constexpr int64_t kIterations = 100;
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitRuntime> runtime,
+                           JitRuntime::Create());
+  std::vector<Type*> types;
+  for (const char* type_str :
+       {"bits[42]", "(token, bits[3])", "(bits[1], bits[16][3], bits[77])",
+        "(bits[3], (), bits[5])[2][3]"}) {
+    XLS_ASSERT_OK_AND_ASSIGN(Type * type,
+                             Parser::ParseType(type_str, package.get()));
+    types.push_back(type);
+  }
+
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t t = 0; t < kThreadCount; ++t) {
+    threads.push_back(std::make_unique<Thread>([&, t]() {
+      std::minstd_rand bitgen(t);
+      for (int64_t i = 0; i < kIterations; ++i) {
+        Type* type = types[i % types.size()];
+        Value value = RandomValue(type, &bitgen);
+        std::vector<uint8_t> buffer(runtime->GetTypeByteSize(type));
+        runtime->BlitValueToBuffer(value, type, absl::MakeSpan(buffer));
+        EXPECT_EQ(runtime->UnpackBuffer(buffer.data(), type), value);
+      }
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+}
+
+TEST_F(TypeLayoutTest, JitRuntimeLayoutsOutliveTypes) {
+  // Cached layouts must stay valid after the types they were computed from are
+  // destroyed and be shared by structurally equal types of other packages.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitRuntime> runtime,
+                           JitRuntime::Create());
+  std::string type_str = "(bits[3], bits[16][3], ())";
+  {
+    auto package = CreatePackage();
+    XLS_ASSERT_OK_AND_ASSIGN(Type * type,
+                             Parser::ParseType(type_str, package.get()));
+    runtime->PrecomputeTypeLayouts({type});
+  }
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Type * type,
+                           Parser::ParseType(type_str, package.get()));
+  TypeLayout layout = runtime->CreateTypeLayout(type);
+  EXPECT_NE(layout.type(), type);
+  EXPECT_TRUE(layout.type()->IsEqualTo(type));
+
+  std::minstd_rand bitgen(0);
+  Value value = RandomValue(type, &bitgen);
+  std::vector<uint8_t> buffer(runtime->GetTypeByteSize(type));
+  runtime->BlitValueToBuffer(value, type, absl::MakeSpan(buffer));
+  EXPECT_EQ(runtime->UnpackBuffer(buffer.data(), type), value);
+}
+
 }  // namespace
 }  // namespace xls
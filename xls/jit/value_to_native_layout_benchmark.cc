@@ -20,6 +20,7 @@
 #include "xls/interpreter/random_value.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
+#include "xls/jit/jit_runtime.h"
 #include "xls/jit/llvm_type_converter.h"
 #include "xls/jit/orc_jit.h"
 
@@ -71,8 +72,34 @@ static void BM_NativeLayoutToValue(benchmark::State& state) {
   }
 }
 
+// The following benchmarks measure the JitRuntime conversion routines which
+// traverse the type on each call, for comparison with the layouts above.
+static void BM_BlitValueToBuffer(benchmark::State& state) {
+  Package package("BM");
+  Type* type = Parser::ParseType(kValueTypes[state.range(0)], &package).value();
+  std::minstd_rand bitgen;
+  Value value = RandomValue(type, &bitgen);
+  std::unique_ptr<JitRuntime> runtime = JitRuntime::Create().value();
+  std::vector<uint8_t> buffer(runtime->GetTypeByteSize(type));
+  for (auto _ : state) {
+    runtime->BlitValueToBuffer(value, type, absl::MakeSpan(buffer));
+  }
+}
+
+static void BM_UnpackBuffer(benchmark::State& state) {
+  Package package("BM");
+  Type* type = Parser::ParseType(kValueTypes[state.range(0)], &package).value();
+  std::unique_ptr<JitRuntime> runtime = JitRuntime::Create().value();
+  std::vector<uint8_t> buffer(runtime->GetTypeByteSize(type), 0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(runtime->UnpackBuffer(buffer.data(), type));
+  }
+}
+
 BENCHMARK(BM_ValueToNativeLayout)->DenseRange(0, kNumTypes - 1);
 BENCHMARK(BM_NativeLayoutToValue)->DenseRange(0, kNumTypes - 1);
+BENCHMARK(BM_BlitValueToBuffer)->DenseRange(0, kNumTypes - 1);
+BENCHMARK(BM_UnpackBuffer)->DenseRange(0, kNumTypes - 1);
 
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,76 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "include/benchmark/benchmark.h"
+#include "absl/flags/declare.h"
+#include "absl/flags/flag.h"
+#include "absl/strings/str_format.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+
+ABSL_DECLARE_FLAG(bool, xls_jit_wide_integer_kernels);
+
+namespace xls {
+namespace {
+
+// Measure the performance of wide arithmetic in the jit when lowered to the
+// limb-based kernels compared with LLVM's own lowering of wide integer
+// instructions.
+constexpr int kNumOps = 5;
+const char* kOps[] = {"umul", "smul", "udiv", "sdiv", "shll"};
+
+static void BM_WideOp(benchmark::State& state) {
+  const char* op = kOps[state.range(0)];
+  int64_t bit_count = state.range(1);
+  // Keep shift amounts in range so the shift isn't trivially an overshift.
+  int64_t rhs_bit_count = op == std::string("shll") ? 9 : bit_count;
+  absl::SetFlag(&FLAGS_xls_jit_wide_integer_kernels, state.range(2) != 0);
+  Package package("BM");
+  Function* f =
+      Parser::ParseFunction(
+          absl::StrFormat(R"(fn f(x: bits[%d], y: bits[%d]) -> bits[%d] {
+  ret result: bits[%d] = %s(x, y)
+})",
+                          bit_count, rhs_bit_count, bit_count, bit_count, op),
+          &package)
+          .value();
+  std::unique_ptr<FunctionJit> jit = FunctionJit::Create(f).value();
+  std::minstd_rand bitgen;
+  std::vector<Value> args = {RandomValue(f->param(0)->GetType(), &bitgen),
+                             RandomValue(f->param(1)->GetType(), &bitgen)};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(jit->Run(args));
+  }
+  absl::SetFlag(&FLAGS_xls_jit_wide_integer_kernels, true);
+}
+
+BENCHMARK(BM_WideOp)->ArgsProduct({benchmark::CreateDenseRange(0, kNumOps - 1,
+                                                               /*step=*/1),
+                                   {256, 512, 1024},
+                                   {0, 1}});
+
+}  // namespace
+}  // namespace xls
+
+BENCHMARK_MAIN();
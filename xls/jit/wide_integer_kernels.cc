@@ -0,0 +1,430 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/wide_integer_kernels.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "absl/base/config.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/numeric/bits.h"
+#include "absl/numeric/int128.h"
+#include "absl/types/span.h"
+#include "xls/common/math_util.h"
+
+#ifdef ABSL_IS_BIG_ENDIAN
+#error "The JIT wide integer kernels assume a little-endian host."
+#endif
+
+namespace xls {
+namespace {
+
+// Inline capacity covers values up to 1024 bits without heap allocation.
+using Limbs = absl::InlinedVector<uint64_t, 16>;
+using Digits = absl::InlinedVector<uint32_t, 32>;
+
+constexpr int64_t kLimbBits = 64;
+
+int64_t LimbCount(int64_t bit_count) {
+  return CeilOfRatio(bit_count, kLimbBits);
+}
+
+bool SignBit(const uint8_t* buffer, int64_t bit_count) {
+  if (bit_count == 0) {
+    return false;
+  }
+  return (buffer[(bit_count - 1) / 8] >> ((bit_count - 1) % 8)) & 1;
+}
+
+// Reads the `bit_count`-bit value in `buffer` into `limb_count` limbs,
+// truncating or extending (zero or sign) as necessary.
+Limbs LoadLimbs(const uint8_t* buffer, int64_t bit_count, int64_t limb_count,
+                bool sign_extend) {
+  Limbs limbs(limb_count, 0);
+  int64_t byte_count =
+      std::min(CeilOfRatio(bit_count, int64_t{8}), limb_count * 8);
+  memcpy(limbs.data(), buffer, byte_count);
+  if (sign_extend && bit_count < limb_count * kLimbBits &&
+      SignBit(buffer, bit_count)) {
+    int64_t top = (bit_count - 1) / kLimbBits;
+    int64_t bits_in_top = bit_count - top * kLimbBits;
+    if (bits_in_top < kLimbBits) {
+      limbs[top] |= ~uint64_t{0} << bits_in_top;
+    }
+    for (int64_t i = top + 1; i < limb_count; ++i) {
+      limbs[i] = ~uint64_t{0};
+    }
+  }
+  return limbs;
+}
+
+// Writes the low `bit_count` bits of `limbs` to `buffer` of size
+// `buffer_size` in the native layout, zeroing the padding.
+void StoreLimbs(Limbs& limbs, int64_t bit_count, uint8_t* buffer,
+                int64_t buffer_size) {
+  if (bit_count % kLimbBits != 0) {
+    limbs[bit_count / kLimbBits] &=
+        (uint64_t{1} << (bit_count % kLimbBits)) - 1;
+  }
+  int64_t byte_count = CeilOfRatio(bit_count, int64_t{8});
+  memcpy(buffer, limbs.data(), byte_count);
+  memset(buffer + byte_count, 0, buffer_size - byte_count);
+}
+
+// Returns the number of limbs in `limbs` excluding leading zero limbs.
+int64_t SignificantLimbCount(absl::Span<const uint64_t> limbs) {
+  int64_t count = limbs.size();
+  while (count > 0 && limbs[count - 1] == 0) {
+    --count;
+  }
+  return count;
+}
+
+bool IsZero(absl::Span<const uint64_t> limbs) {
+  return SignificantLimbCount(limbs) == 0;
+}
+
+// Negates the two's complement value in `limbs` in place.
+void Negate(Limbs& limbs) {
+  uint64_t carry = 1;
+  for (uint64_t& limb : limbs) {
+    limb = ~limb + carry;
+    carry = (carry != 0 && limb == 0) ? 1 : 0;
+  }
+}
+
+// Returns the low `result.size()` limbs of the product of `a` and `b` using
+// schoolbook multiplication. Only the partial products contributing to the
+// truncated result are computed.
+void MultiplyLimbs(absl::Span<const uint64_t> a, absl::Span<const uint64_t> b,
+                   absl::Span<uint64_t> result) {
+  std::fill(result.begin(), result.end(), 0);
+  int64_t n = result.size();
+  int64_t a_count = std::min<int64_t>(SignificantLimbCount(a), n);
+  int64_t b_count = std::min<int64_t>(SignificantLimbCount(b), n);
+  for (int64_t i = 0; i < a_count; ++i) {
+    if (a[i] == 0) {
+      continue;
+    }
+    uint64_t carry = 0;
+    int64_t j_limit = std::min(b_count, n - i);
+    for (int64_t j = 0; j < j_limit; ++j) {
+      absl::uint128 t = absl::uint128{a[i]} * b[j] + result[i + j] + carry;
+      result[i + j] = absl::Uint128Low64(t);
+      carry = absl::Uint128High64(t);
+    }
+    // Positions at or above i + b_count have not been written by this or any
+    // earlier row so the carry can be stored directly.
+    if (i + j_limit < n) {
+      result[i + j_limit] = carry;
+    }
+  }
+}
+
+// Computes the quotient and remainder of `u` divided by the nonzero `v` using
+// Knuth's algorithm D with 32-bit digits. `quotient` and `remainder` are
+// resized to the size of `u` and `v` respectively.
+void DivideLimbs(absl::Span<const uint64_t> u_limbs,
+                 absl::Span<const uint64_t> v_limbs, Limbs& quotient,
+                 Limbs& remainder) {
+  quotient.assign(u_limbs.size(), 0);
+  remainder.assign(v_limbs.size(), 0);
+
+  // Reinterpret the limbs as little-endian 32-bit digits.
+  Digits u(u_limbs.size() * 2);
+  Digits v(v_limbs.size() * 2);
+  memcpy(u.data(), u_limbs.data(), u_limbs.size() * sizeof(uint64_t));
+  memcpy(v.data(), v_limbs.data(), v_limbs.size() * sizeof(uint64_t));
+  int64_t m = u.size();
+  while (m > 0 && u[m - 1] == 0) {
+    --m;
+  }
+  int64_t n = v.size();
+  while (n > 0 && v[n - 1] == 0) {
+    --n;
+  }
+
+  Digits q(std::max<int64_t>(m, 1), 0);
+  Digits r(std::max<int64_t>(n, 1), 0);
+  constexpr uint64_t kBase = uint64_t{1} << 32;
+  if (m < n) {
+    std::copy(u.begin(), u.begin() + m, r.begin());
+  } else if (n == 1) {
+    uint64_t rem = 0;
+    for (int64_t j = m - 1; j >= 0; --j) {
+      uint64_t num = rem * kBase + u[j];
+      q[j] = static_cast<uint32_t>(num / v[0]);
+      rem = num - q[j] * uint64_t{v[0]};
+    }
+    r[0] = static_cast<uint32_t>(rem);
+  } else {
+    // Normalize so the high digit of the divisor has its high bit set.
+    int s = absl::countl_zero(v[n - 1]);
+    Digits vn(n);
+    for (int64_t i = n - 1; i > 0; --i) {
+      vn[i] = (v[i] << s) |
+              static_cast<uint32_t>((uint64_t{v[i - 1]} >> (32 - s)));
+    }
+    vn[0] = v[0] << s;
+    Digits un(m + 1);
+    un[m] = static_cast<uint32_t>(uint64_t{u[m - 1]} >> (32 - s));
+    for (int64_t i = m - 1; i > 0; --i) {
+      un[i] = (u[i] << s) |
+              static_cast<uint32_t>((uint64_t{u[i - 1]} >> (32 - s)));
+    }
+    un[0] = u[0] << s;
+
+    for (int64_t j = m - n; j >= 0; --j) {
+      uint64_t num = uint64_t{un[j + n]} * kBase + un[j + n - 1];
+      uint64_t qhat = num / vn[n - 1];
+      uint64_t rhat = num - qhat * vn[n - 1];
+      while (qhat >= kBase ||
+             qhat * vn[n - 2] > kBase * rhat + un[j + n - 2]) {
+        --qhat;
+        rhat += vn[n - 1];
+        if (rhat >= kBase) {
+          break;
+        }
+      }
+
+      // Multiply and subtract.
+      int64_t borrow = 0;
+      int64_t t;
+      for (int64_t i = 0; i < n; ++i) {
+        uint64_t p = qhat * vn[i];
+        t = int64_t{un[i + j]} - borrow -
+            static_cast<int64_t>(p & 0xffffffff);
+        un[i + j] = static_cast<uint32_t>(t);
+        borrow = static_cast<int64_t>(p >> 32) - (t >> 32);
+      }
+      t = int64_t{un[j + n]} - borrow;
+      un[j + n] = static_cast<uint32_t>(t);
+
+      q[j] = static_cast<uint32_t>(qhat);
+      if (t < 0) {
+        // qhat was one too large; add back.
+        --q[j];
+        uint64_t carry = 0;
+        for (int64_t i = 0; i < n; ++i) {
+          uint64_t sum = uint64_t{un[i + j]} + vn[i] + carry;
+          un[i + j] = static_cast<uint32_t>(sum);
+          carry = sum >> 32;
+        }
+        un[j + n] += static_cast<uint32_t>(carry);
+      }
+    }
+    // Unnormalize the remainder.
+    for (int64_t i = 0; i < n; ++i) {
+      r[i] = (un[i] >> s) |
+             static_cast<uint32_t>((uint64_t{un[i + 1]} << (32 - s)));
+    }
+  }
+  memcpy(quotient.data(), q.data(),
+         std::min<int64_t>(q.size(), u.size()) * sizeof(uint32_t));
+  memcpy(remainder.data(), r.data(),
+         std::min<int64_t>(r.size(), v.size()) * sizeof(uint32_t));
+}
+
+// Shared implementation of the multiply kernels.
+void Multiply(const uint8_t* lhs, int64_t lhs_bit_count, const uint8_t* rhs,
+              int64_t rhs_bit_count, uint8_t* result, int64_t result_bit_count,
+              int64_t result_size, bool is_signed) {
+  int64_t n = LimbCount(result_bit_count);
+  Limbs a = LoadLimbs(lhs, lhs_bit_count, n, is_signed);
+  Limbs b = LoadLimbs(rhs, rhs_bit_count, n, is_signed);
+  Limbs product(n);
+  MultiplyLimbs(a, b, absl::MakeSpan(product));
+  StoreLimbs(product, result_bit_count, result, result_size);
+}
+
+// Shared implementation of the divide and modulo kernels. Writes the quotient
+// or the remainder to `result`.
+void DivideOrModulo(const uint8_t* lhs, int64_t lhs_bit_count,
+                    const uint8_t* rhs, int64_t rhs_bit_count, uint8_t* result,
+                    int64_t result_bit_count, int64_t result_size,
+                    bool is_signed, bool is_modulo) {
+  int64_t width = std::max(lhs_bit_count, rhs_bit_count);
+  int64_t n = std::max(LimbCount(width), LimbCount(result_bit_count));
+  Limbs a = LoadLimbs(lhs, lhs_bit_count, n, is_signed);
+  Limbs b = LoadLimbs(rhs, rhs_bit_count, n, is_signed);
+  bool lhs_negative = is_signed && SignBit(lhs, lhs_bit_count);
+  bool rhs_negative = is_signed && SignBit(rhs, rhs_bit_count);
+
+  Limbs value(n, 0);
+  if (IsZero(b)) {
+    if (!is_modulo) {
+      // All ones (unsigned), or the maximal magnitude value with the sign of
+      // the lhs (signed).
+      std::fill(value.begin(), value.end(), ~uint64_t{0});
+      if (is_signed) {
+        Limbs& v = value;
+        int64_t sign_limb = (result_bit_count - 1) / kLimbBits;
+        uint64_t sign_mask = uint64_t{1}
+                             << ((result_bit_count - 1) % kLimbBits);
+        if (lhs_negative) {
+          std::fill(v.begin(), v.end(), 0);
+          v[sign_limb] = sign_mask;
+        } else {
+          v[sign_limb] &= ~sign_mask;
+          for (int64_t i = sign_limb + 1; i < n; ++i) {
+            v[i] = 0;
+          }
+        }
+      }
+    }
+    StoreLimbs(value, result_bit_count, result, result_size);
+    return;
+  }
+
+  if (lhs_negative) {
+    Negate(a);
+  }
+  if (rhs_negative) {
+    Negate(b);
+  }
+  Limbs quotient;
+  Limbs remainder;
+  DivideLimbs(a, b, quotient, remainder);
+  if (is_modulo) {
+    value = std::move(remainder);
+    if (lhs_negative) {
+      Negate(value);
+    }
+  } else {
+    value = std::move(quotient);
+    if (lhs_negative != rhs_negative) {
+      Negate(value);
+    }
+  }
+  StoreLimbs(value, result_bit_count, result, result_size);
+}
+
+enum class ShiftKind { kLeft, kRightLogical, kRightArithmetic };
+
+// Shared implementation of the shift kernels.
+void Shift(const uint8_t* lhs, int64_t lhs_bit_count, const uint8_t* rhs,
+           int64_t rhs_bit_count, uint8_t* result, int64_t result_bit_count,
+           int64_t result_size, ShiftKind kind) {
+  int64_t n = LimbCount(result_bit_count);
+  bool arithmetic = kind == ShiftKind::kRightArithmetic;
+  Limbs a = LoadLimbs(lhs, lhs_bit_count, n, /*sign_extend=*/arithmetic);
+  uint64_t fill =
+      arithmetic && SignBit(lhs, lhs_bit_count) ? ~uint64_t{0} : uint64_t{0};
+
+  Limbs amount_limbs = LoadLimbs(rhs, rhs_bit_count, LimbCount(rhs_bit_count),
+                                 /*sign_extend=*/false);
+  bool overshift = SignificantLimbCount(amount_limbs) > 1 ||
+                   (!amount_limbs.empty() &&
+                    amount_limbs[0] >= static_cast<uint64_t>(lhs_bit_count));
+  Limbs value(n, fill);
+  if (!overshift) {
+    int64_t amount = amount_limbs.empty() ? 0 : amount_limbs[0];
+    int64_t word_shift = amount / kLimbBits;
+    int bit_shift = amount % kLimbBits;
+    if (kind == ShiftKind::kLeft) {
+      for (int64_t i = n - 1; i >= 0; --i) {
+        int64_t src = i - word_shift;
+        uint64_t limb = src >= 0 ? a[src] << bit_shift : 0;
+        if (bit_shift != 0 && src - 1 >= 0) {
+          limb |= a[src - 1] >> (kLimbBits - bit_shift);
+        }
+        value[i] = limb;
+      }
+    } else {
+      auto source = [&](int64_t i) { return i < n ? a[i] : fill; };
+      for (int64_t i = 0; i < n; ++i) {
+        int64_t src = i + word_shift;
+        uint64_t limb = source(src) >> bit_shift;
+        if (bit_shift != 0) {
+          limb |= source(src + 1) << (kLimbBits - bit_shift);
+        }
+        value[i] = limb;
+      }
+    }
+  }
+  StoreLimbs(value, result_bit_count, result, result_size);
+}
+
+}  // namespace
+
+void WideUMul(const uint8_t* lhs, int64_t lhs_bit_count, const uint8_t* rhs,
+              int64_t rhs_bit_count, uint8_t* result, int64_t result_bit_count,
+              int64_t result_size) {
+  Multiply(lhs, lhs_bit_count, rhs, rhs_bit_count, result, result_bit_count,
+           result_size, /*is_signed=*/false);
+}
+
+void WideSMul(const uint8_t* lhs, int64_t lhs_bit_count, const uint8_t* rhs,
+              int64_t rhs_bit_count, uint8_t* result, int64_t result_bit_count,
+              int64_t result_size) {
+  Multiply(lhs, lhs_bit_count, rhs, rhs_bit_count, result, result_bit_count,
+           result_size, /*is_signed=*/true);
+}
+
+void WideUDiv(const uint8_t* lhs, int64_t lhs_bit_count, const uint8_t* rhs,
+              int64_t rhs_bit_count, uint8_t* result, int64_t result_bit_count,
+              int64_t result_size) {
+  DivideOrModulo(lhs, lhs_bit_count, rhs, rhs_bit_count, result,
+                 result_bit_count, result_size, /*is_signed=*/false,
+                 /*is_modulo=*/false);
+}
+
+void WideSDiv(const uint8_t* lhs, int64_t lhs_bit_count, const uint8_t* rhs,
+              int64_t rhs_bit_count, uint8_t* result, int64_t result_bit_count,
+              int64_t result_size) {
+  DivideOrModulo(lhs, lhs_bit_count, rhs, rhs_bit_count, result,
+                 result_bit_count, result_size, /*is_signed=*/true,
+                 /*is_modulo=*/false);
+}
+
+void WideUMod(const uint8_t* lhs, int64_t lhs_bit_count, const uint8_t* rhs,
+              int64_t rhs_bit_count, uint8_t* result, int64_t result_bit_count,
+              int64_t result_size) {
+  DivideOrModulo(lhs, lhs_bit_count, rhs, rhs_bit_count, result,
+                 result_bit_count, result_size, /*is_signed=*/false,
+                 /*is_modulo=*/true);
+}
+
+void WideSMod(const uint8_t* lhs, int64_t lhs_bit_count, const uint8_t* rhs,
+              int64_t rhs_bit_count, uint8_t* result, int64_t result_bit_count,
+              int64_t result_size) {
+  DivideOrModulo(lhs, lhs_bit_count, rhs, rhs_bit_count, result,
+                 result_bit_count, result_size, /*is_signed=*/true,
+                 /*is_modulo=*/true);
+}
+
+void WideShll(const uint8_t* lhs, int64_t lhs_bit_count, const uint8_t* rhs,
+              int64_t rhs_bit_count, uint8_t* result, int64_t result_bit_count,
+              int64_t result_size) {
+  Shift(lhs, lhs_bit_count, rhs, rhs_bit_count, result, result_bit_count,
+        result_size, ShiftKind::kLeft);
+}
+
+void WideShrl(const uint8_t* lhs, int64_t lhs_bit_count, const uint8_t* rhs,
+              int64_t rhs_bit_count, uint8_t* result, int64_t result_bit_count,
+              int64_t result_size) {
+  Shift(lhs, lhs_bit_count, rhs, rhs_bit_count, result, result_bit_count,
+        result_size, ShiftKind::kRightLogical);
+}
+
+void WideShra(const uint8_t* lhs, int64_t lhs_bit_count, const uint8_t* rhs,
+              int64_t rhs_bit_count, uint8_t* result, int64_t result_bit_count,
+              int64_t result_size) {
+  Shift(lhs, lhs_bit_count, rhs, rhs_bit_count, result, result_bit_count,
+        result_size, ShiftKind::kRightArithmetic);
+}
+
+}  // namespace xls
@@ -0,0 +1,78 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Kernels implementing arithmetic on wide (more than 128 bit) bits values in
+// the native data layout used by the JIT. The JIT lowers such operations to
+// calls to these functions rather than to LLVM integer instructions, which
+// the LLVM backend expands into very large inline instruction sequences
+// (multiplies and shifts) or bit-serial loops (divides). Values are processed
+// as little-endian sequences of 64-bit limbs.
+
+#ifndef XLS_JIT_WIDE_INTEGER_KERNELS_H_
+#define XLS_JIT_WIDE_INTEGER_KERNELS_H_
+
+#include <cstdint>
+
+namespace xls {
+
+// Operations for which the widest operand or result has at least this many
+// bits are lowered to calls to the kernels below. LLVM handles 128-bit
+// operations well (inline or via compiler-rt).
+inline constexpr int64_t kMinWideIntegerKernelBitCount = 129;
+
+// Signature of the kernels. `lhs` and `rhs` point to bits values of
+// `lhs_bit_count` and `rhs_bit_count` bits in the native layout. The result
+// value of `result_bit_count` bits is written to `result` which is
+// `result_size` bytes; bytes beyond the value's data are zeroed.
+//
+// Semantics match the corresponding XLS ops: multiplies truncate the product
+// to the result width, division by zero produces the maximal value (of the
+// appropriate sign for signed division), modulo by zero produces zero, and
+// overshifting produces zero (or the sign bit for arithmetic shifts).
+using WideIntegerKernel = void (*)(const uint8_t* lhs, int64_t lhs_bit_count,
+                                   const uint8_t* rhs, int64_t rhs_bit_count,
+                                   uint8_t* result, int64_t result_bit_count,
+                                   int64_t result_size);
+
+void WideUMul(const uint8_t* lhs, int64_t lhs_bit_count, const uint8_t* rhs,
+              int64_t rhs_bit_count, uint8_t* result, int64_t result_bit_count,
+              int64_t result_size);
+void WideSMul(const uint8_t* lhs, int64_t lhs_bit_count, const uint8_t* rhs,
+              int64_t rhs_bit_count, uint8_t* result, int64_t result_bit_count,
+              int64_t result_size);
+void WideUDiv(const uint8_t* lhs, int64_t lhs_bit_count, const uint8_t* rhs,
+              int64_t rhs_bit_count, uint8_t* result, int64_t result_bit_count,
+              int64_t result_size);
+void WideSDiv(const uint8_t* lhs, int64_t lhs_bit_count, const uint8_t* rhs,
+              int64_t rhs_bit_count, uint8_t* result, int64_t result_bit_count,
+              int64_t result_size);
+void WideUMod(const uint8_t* lhs, int64_t lhs_bit_count, const uint8_t* rhs,
+              int64_t rhs_bit_count, uint8_t* result, int64_t result_bit_count,
+              int64_t result_size);
+void WideSMod(const uint8_t* lhs, int64_t lhs_bit_count, const uint8_t* rhs,
+              int64_t rhs_bit_count, uint8_t* result, int64_t result_bit_count,
+              int64_t result_size);
+void WideShll(const uint8_t* lhs, int64_t lhs_bit_count, const uint8_t* rhs,
+              int64_t rhs_bit_count, uint8_t* result, int64_t result_bit_count,
+              int64_t result_size);
+void WideShrl(const uint8_t* lhs, int64_t lhs_bit_count, const uint8_t* rhs,
+              int64_t rhs_bit_count, uint8_t* result, int64_t result_bit_count,
+              int64_t result_size);
+void WideShra(const uint8_t* lhs, int64_t lhs_bit_count, const uint8_t* rhs,
+              int64_t rhs_bit_count, uint8_t* result, int64_t result_bit_count,
+              int64_t result_size);
+
+}  // namespace xls
+
+#endif  // XLS_JIT_WIDE_INTEGER_KERNELS_H_
@@ -0,0 +1,240 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/wide_integer_kernels.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/flags/declare.h"
+#include "absl/flags/flag.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/events.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+
+ABSL_DECLARE_FLAG(bool, xls_jit_wide_integer_kernels);
+
+namespace xls {
+namespace {
+
+constexpr int64_t kWidths[] = {129, 192, 256, 300, 1024};
+
+// Returns the size in bytes of a bits value of the given width in the native
+// layout used by the JIT (the LLVM integer width is a power of two).
+int64_t NativeSize(int64_t bit_count) {
+  return std::max(int64_t{8}, int64_t{1} << CeilOfLog2(bit_count)) / 8;
+}
+
+std::vector<uint8_t> ToNative(const Bits& bits) {
+  std::vector<uint8_t> bytes(NativeSize(bits.bit_count()), 0);
+  bits.ToBytes(absl::MakeSpan(bytes));
+  return bytes;
+}
+
+// Runs `kernel` and checks that the padding bytes of the result are zeroed.
+Bits RunKernel(WideIntegerKernel kernel, const Bits& lhs, const Bits& rhs,
+               int64_t result_bit_count) {
+  std::vector<uint8_t> lhs_bytes = ToNative(lhs);
+  std::vector<uint8_t> rhs_bytes = ToNative(rhs);
+  std::vector<uint8_t> result(NativeSize(result_bit_count), 0xff);
+  kernel(lhs_bytes.data(), lhs.bit_count(), rhs_bytes.data(), rhs.bit_count(),
+         result.data(), result_bit_count, result.size());
+  Bits value = Bits::FromBytes(result, result_bit_count);
+  EXPECT_EQ(ToNative(value), result) << "padding not zeroed";
+  return value;
+}
+
+Bits ResizeUnsigned(const Bits& bits, int64_t bit_count) {
+  return bit_count <= bits.bit_count() ? bits.Slice(0, bit_count)
+                                       : bits_ops::ZeroExtend(bits, bit_count);
+}
+
+Bits ResizeSigned(const Bits& bits, int64_t bit_count) {
+  return bit_count <= bits.bit_count() ? bits.Slice(0, bit_count)
+                                       : bits_ops::SignExtend(bits, bit_count);
+}
+
+int64_t ShiftAmount(const Bits& amount, int64_t bit_count) {
+  if (bits_ops::UGreaterThanOrEqual(amount, bit_count)) {
+    return bit_count;
+  }
+  return static_cast<int64_t>(amount.ToUint64().value());
+}
+
+// Interesting operand values of the given width: zero, one, all ones, the
+// minimum and maximum signed values, and a few random values including some
+// with many leading zeros.
+std::vector<Bits> TestValues(int64_t bit_count, std::minstd_rand& bitgen) {
+  std::vector<Bits> values = {
+      Bits(bit_count),
+      UBits(1, bit_count),
+      Bits::AllOnes(bit_count),
+      bits_ops::ShiftLeftLogical(UBits(1, bit_count), bit_count - 1),
+      bits_ops::ShiftRightLogical(Bits::AllOnes(bit_count), 1),
+      UBits(7, bit_count),
+  };
+  for (int64_t i = 0; i < 6; ++i) {
+    std::vector<uint8_t> bytes(CeilOfRatio(bit_count, int64_t{8}));
+    for (uint8_t& byte : bytes) {
+      byte = static_cast<uint8_t>(bitgen());
+    }
+    Bits random = Bits::FromBytes(bytes, bit_count);
+    values.push_back(random);
+    values.push_back(
+        bits_ops::ShiftRightLogical(random, (i + 1) * bit_count / 8));
+  }
+  return values;
+}
+
+TEST(WideIntegerKernelsTest, Multiply) {
+  std::minstd_rand bitgen;
+  for (int64_t lhs_width : kWidths) {
+    for (int64_t rhs_width : {int64_t{64}, int64_t{200}, lhs_width}) {
+      for (int64_t result_width : {lhs_width, lhs_width + rhs_width + 7}) {
+        for (const Bits& lhs : TestValues(lhs_width, bitgen)) {
+          for (const Bits& rhs : TestValues(rhs_width, bitgen)) {
+            SCOPED_TRACE(absl::StrFormat("%s * %s -> bits[%d]",
+                                         BitsToString(lhs), BitsToString(rhs),
+                                         result_width));
+            EXPECT_EQ(RunKernel(WideUMul, lhs, rhs, result_width),
+                      ResizeUnsigned(bits_ops::UMul(lhs, rhs), result_width));
+            EXPECT_EQ(RunKernel(WideSMul, lhs, rhs, result_width),
+                      ResizeSigned(bits_ops::SMul(lhs, rhs), result_width));
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(WideIntegerKernelsTest, DivideAndModulo) {
+  std::minstd_rand bitgen;
+  for (int64_t width : kWidths) {
+    for (const Bits& lhs : TestValues(width, bitgen)) {
+      for (const Bits& rhs : TestValues(width, bitgen)) {
+        SCOPED_TRACE(absl::StrFormat("%s / %s", BitsToString(lhs),
+                                     BitsToString(rhs)));
+        EXPECT_EQ(RunKernel(WideUDiv, lhs, rhs, width),
+                  bits_ops::UDiv(lhs, rhs));
+        EXPECT_EQ(RunKernel(WideSDiv, lhs, rhs, width),
+                  bits_ops::SDiv(lhs, rhs));
+        EXPECT_EQ(RunKernel(WideUMod, lhs, rhs, width),
+                  bits_ops::UMod(lhs, rhs));
+        EXPECT_EQ(RunKernel(WideSMod, lhs, rhs, width),
+                  bits_ops::SMod(lhs, rhs));
+      }
+    }
+  }
+}
+
+TEST(WideIntegerKernelsTest, Shifts) {
+  std::minstd_rand bitgen;
+  for (int64_t width : kWidths) {
+    std::vector<Bits> amounts = {Bits::AllOnes(200)};
+    for (int64_t amount : {int64_t{0}, int64_t{1}, int64_t{63}, int64_t{64},
+                           int64_t{65}, width - 1, width, width + 1}) {
+      amounts.push_back(UBits(amount, 32));
+    }
+    for (const Bits& value : TestValues(width, bitgen)) {
+      for (const Bits& amount : amounts) {
+        SCOPED_TRACE(absl::StrFormat("%s shifted by %s",
+                                     BitsToString(value),
+                                     BitsToString(amount)));
+        int64_t shift = ShiftAmount(amount, width);
+        EXPECT_EQ(RunKernel(WideShll, value, amount, width),
+                  bits_ops::ShiftLeftLogical(value, shift));
+        EXPECT_EQ(RunKernel(WideShrl, value, amount, width),
+                  bits_ops::ShiftRightLogical(value, shift));
+        EXPECT_EQ(RunKernel(WideShra, value, amount, width),
+                  bits_ops::ShiftRightArith(value, shift));
+      }
+    }
+  }
+}
+
+class WideIntegerJitTest : public IrTestBase,
+                           public testing::WithParamInterface<bool> {
+ protected:
+  void SetUp() override {
+    absl::SetFlag(&FLAGS_xls_jit_wide_integer_kernels, GetParam());
+  }
+  void TearDown() override {
+    absl::SetFlag(&FLAGS_xls_jit_wide_integer_kernels, true);
+  }
+};
+
+// Checks the JIT against the interpreter for wide arithmetic ops, both with
+// and without the kernels enabled.
+TEST_P(WideIntegerJitTest, MatchesInterpreter) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn wide_ops(x: bits[300], y: bits[300], s: bits[9]) -> (bits[300], bits[300], bits[300], bits[300], bits[512], bits[200], bits[300], bits[300], bits[300]) {
+  umul.1: bits[300] = umul(x, y)
+  smul.2: bits[512] = smul(x, s)
+  udiv.3: bits[300] = udiv(x, y)
+  sdiv.4: bits[300] = sdiv(x, y)
+  umod.5: bits[300] = umod(x, y)
+  bit_slice.6: bits[200] = bit_slice(x, start=0, width=200)
+  bit_slice.7: bits[200] = bit_slice(y, start=100, width=200)
+  smod.8: bits[200] = smod(bit_slice.6, bit_slice.7)
+  shll.9: bits[300] = shll(x, s)
+  shrl.10: bits[300] = shrl(x, s)
+  shra.11: bits[300] = shra(y, s)
+  ret tuple.12: (bits[300], bits[300], bits[300], bits[300], bits[512], bits[200], bits[300], bits[300], bits[300]) = tuple(umul.1, udiv.3, sdiv.4, umod.5, smul.2, smod.8, shll.9, shrl.10, shra.11)
+}
+)",
+                                                       package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(f));
+  std::minstd_rand bitgen;
+  for (int64_t i = 0; i < 100; ++i) {
+    std::vector<Value> args;
+    for (Param* param : f->params()) {
+      args.push_back(RandomValue(param->GetType(), &bitgen));
+    }
+    if (i % 10 == 0) {
+      // Exercise division by zero.
+      args[1] = Value(Bits(300));
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(Value expected,
+                             DropInterpreterEvents(InterpretFunction(f, args)));
+    XLS_ASSERT_OK_AND_ASSIGN(Value actual,
+                             DropInterpreterEvents(jit->Run(args)));
+    EXPECT_EQ(actual, expected);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(WideIntegerJitTestInstance, WideIntegerJitTest,
+                         testing::Bool(),
+                         [](const testing::TestParamInfo<bool>& info) {
+                           return info.param ? "Kernels" : "LlvmLowering";
+                         });
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,77 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/bit_parallel.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/netlist/interpreter.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+
+absl::StatusOr<std::vector<BitParallelVector>> InterpretModuleBitParallel(
+    AbstractInterpreter<BitParallelValue>& interpreter,
+    const rtl::AbstractModule<BitParallelValue>* module,
+    absl::Span<const BitParallelVector> vectors, bool levelized) {
+  std::vector<BitParallelVector> results;
+  results.reserve(vectors.size());
+  for (int64_t start = 0; start < vectors.size();
+       start += BitParallelValue::kLanes) {
+    const int64_t lane_count = std::min<int64_t>(BitParallelValue::kLanes,
+                                                 vectors.size() - start);
+    // Unused lanes of the last pass are left zero.
+    AbstractNetRef2Value<BitParallelValue> inputs;
+    for (const rtl::AbstractNetRef<BitParallelValue> input : module->inputs()) {
+      uint64_t lanes = 0;
+      for (int64_t lane = 0; lane < lane_count; ++lane) {
+        const BitParallelVector& vector = vectors[start + lane];
+        auto it = vector.find(input);
+        if (it == vector.end()) {
+          return absl::InvalidArgumentError(
+              absl::StrFormat("Input vector %d has no value for input %s",
+                              start + lane, input->name()));
+        }
+        if (it->second) {
+          lanes |= uint64_t{1} << lane;
+        }
+      }
+      inputs.emplace(input, BitParallelValue::FromLanes(lanes));
+    }
+
+    XLS_ASSIGN_OR_RETURN(
+        AbstractNetRef2Value<BitParallelValue> outputs,
+        levelized ? interpreter.InterpretModuleLevelized(module, inputs)
+                  : interpreter.InterpretModule(module, inputs));
+    for (int64_t lane = 0; lane < lane_count; ++lane) {
+      BitParallelVector& result = results.emplace_back();
+      for (const rtl::AbstractNetRef<BitParallelValue> output :
+           module->outputs()) {
+        result[output] = outputs.at(output).lane(lane);
+      }
+    }
+  }
+  return results;
+}
+
+}  // namespace netlist
+}  // namespace xls
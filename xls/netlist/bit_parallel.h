@@ -0,0 +1,103 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NETLIST_BIT_PARALLEL_H_
+#define XLS_NETLIST_BIT_PARALLEL_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/netlist/interpreter.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+
+// The values of a net in kLanes independent evaluations of a netlist, one per
+// bit: bit `i` holds the value in evaluation (lane) `i`. Using this as the
+// EvalT of the cell library, netlist and interpreter evaluates kLanes input
+// vectors in a single pass, as the operators used to evaluate cell functions
+// act on every lane at once. Cells described only by state tables are not
+// supported, as matching a state table row requires a single value per net.
+class BitParallelValue {
+ public:
+  static constexpr int64_t kLanes = 64;
+
+  BitParallelValue() = default;
+
+  // Returns the value with every lane equal to `value`.
+  explicit BitParallelValue(bool value)
+      : lanes_(value ? ~uint64_t{0} : uint64_t{0}) {}
+
+  static BitParallelValue FromLanes(uint64_t lanes) {
+    BitParallelValue result;
+    result.lanes_ = lanes;
+    return result;
+  }
+
+  uint64_t lanes() const { return lanes_; }
+  bool lane(int64_t i) const { return ((lanes_ >> i) & 1) != 0; }
+
+  BitParallelValue operator&(const BitParallelValue& rhs) const {
+    return FromLanes(lanes_ & rhs.lanes_);
+  }
+  BitParallelValue operator|(const BitParallelValue& rhs) const {
+    return FromLanes(lanes_ | rhs.lanes_);
+  }
+  BitParallelValue operator^(const BitParallelValue& rhs) const {
+    return FromLanes(lanes_ ^ rhs.lanes_);
+  }
+  // Cell functions use `!` for inversion, so this complements every lane.
+  BitParallelValue operator!() const { return FromLanes(~lanes_); }
+
+  bool operator==(const BitParallelValue& rhs) const {
+    return lanes_ == rhs.lanes_;
+  }
+  bool operator!=(const BitParallelValue& rhs) const {
+    return lanes_ != rhs.lanes_;
+  }
+
+  template <typename H>
+  friend H AbslHashValue(H h, const BitParallelValue& value) {
+    return H::combine(std::move(h), value.lanes_);
+  }
+
+ private:
+  uint64_t lanes_ = 0;
+};
+
+// The values of the inputs or outputs of a module in a single evaluation.
+using BitParallelVector =
+    absl::flat_hash_map<rtl::AbstractNetRef<BitParallelValue>, bool>;
+
+// Interprets `module` once for each of `vectors`, each of which must hold a
+// value for every input of the module. The vectors are packed into the lanes
+// of BitParallelValues so that `interpreter` evaluates up to
+// BitParallelValue::kLanes of them per pass. Passes use
+// InterpretModuleLevelized if `levelized` is true and InterpretModule
+// otherwise. Returns the values of the module outputs for each vector, in the
+// order of `vectors`.
+absl::StatusOr<std::vector<BitParallelVector>> InterpretModuleBitParallel(
+    AbstractInterpreter<BitParallelValue>& interpreter,
+    const rtl::AbstractModule<BitParallelValue>* module,
+    absl::Span<const BitParallelVector> vectors, bool levelized = true);
+
+}  // namespace netlist
+}  // namespace xls
+
+#endif  // XLS_NETLIST_BIT_PARALLEL_H_
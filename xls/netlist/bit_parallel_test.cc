@@ -0,0 +1,113 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/bit_parallel.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/fake_cell_library.h"
+#include "xls/netlist/interpreter.h"
+#include "xls/netlist/netlist.h"
+#include "xls/netlist/netlist.pb.h"
+#include "xls/netlist/netlist_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+TEST(BitParallelTest, LaneWiseOperators) {
+  BitParallelValue a = BitParallelValue::FromLanes(0b1100);
+  BitParallelValue b = BitParallelValue::FromLanes(0b1010);
+  EXPECT_EQ((a & b).lanes(), 0b1000);
+  EXPECT_EQ((a | b).lanes(), 0b1110);
+  EXPECT_EQ((a ^ b).lanes(), 0b0110);
+  EXPECT_EQ((!a).lanes(), ~uint64_t{0b1100});
+  EXPECT_EQ(BitParallelValue(true).lanes(), ~uint64_t{0});
+  EXPECT_EQ(BitParallelValue(false).lanes(), 0);
+  EXPECT_TRUE(a.lane(2));
+  EXPECT_FALSE(a.lane(1));
+}
+
+TEST(BitParallelTest, InterpretsManyVectors) {
+  std::string module_text = R"(
+module m (a, b, c, o0, o1);
+  input a, b, c;
+  output o0, o1;
+  wire t;
+
+  AND and0( .A(a), .B(b), .Z(t) );
+  XOR xor0( .A(t), .B(c), .Z(o0) );
+  AOI21 aoi0( .A(a), .B(b), .C(c), .ZN(o1) );
+endmodule
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto proto, MakeFakeCellLibraryProto());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      AbstractCellLibrary<BitParallelValue> cell_library,
+      AbstractCellLibrary<BitParallelValue>::FromProto(proto));
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<rtl::AbstractNetlist<BitParallelValue>> netlist,
+      rtl::AbstractParser<BitParallelValue>::ParseNetlist(&cell_library,
+                                                          &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::AbstractModule<BitParallelValue>* module,
+                           netlist->GetModule("m"));
+  XLS_ASSERT_OK_AND_ASSIGN(rtl::AbstractNetRef<BitParallelValue> a,
+                           module->ResolveNet("a"));
+  XLS_ASSERT_OK_AND_ASSIGN(rtl::AbstractNetRef<BitParallelValue> b,
+                           module->ResolveNet("b"));
+  XLS_ASSERT_OK_AND_ASSIGN(rtl::AbstractNetRef<BitParallelValue> c,
+                           module->ResolveNet("c"));
+  XLS_ASSERT_OK_AND_ASSIGN(rtl::AbstractNetRef<BitParallelValue> o0,
+                           module->ResolveNet("o0"));
+  XLS_ASSERT_OK_AND_ASSIGN(rtl::AbstractNetRef<BitParallelValue> o1,
+                           module->ResolveNet("o1"));
+
+  // More vectors than lanes so the last pass is partially filled.
+  std::vector<BitParallelVector> vectors;
+  for (int64_t i = 0; i < 2 * BitParallelValue::kLanes + 5; ++i) {
+    int64_t bits = (i * 37) >> 2;
+    vectors.push_back(
+        {{a, (bits & 1) != 0}, {b, (bits & 2) != 0}, {c, (bits & 4) != 0}});
+  }
+
+  AbstractInterpreter<BitParallelValue> interpreter(netlist.get());
+  for (bool levelized : {false, true}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::vector<BitParallelVector> results,
+        InterpretModuleBitParallel(interpreter, module, vectors, levelized));
+    ASSERT_EQ(results.size(), vectors.size());
+    for (int64_t i = 0; i < vectors.size(); ++i) {
+      bool and_ab = vectors[i].at(a) && vectors[i].at(b);
+      EXPECT_EQ(results[i].at(o0), and_ab != vectors[i].at(c)) << i;
+      EXPECT_EQ(results[i].at(o1), !(and_ab || vectors[i].at(c))) << i;
+    }
+  }
+
+  // Every input must be given a value.
+  std::vector<BitParallelVector> missing_input = {{{a, true}, {b, true}}};
+  EXPECT_THAT(InterpretModuleBitParallel(interpreter, module, missing_input),
+              status_testing::StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace netlist
+}  // namespace xls
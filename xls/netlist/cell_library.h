@@ -25,8 +25,10 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/netlist/compiled_function.h"
 #include "xls/netlist/netlist.pb.h"
 
 namespace xls {
@@ -186,7 +188,9 @@ class AbstractCellLibraryEntry {
         input_names_(input_names.begin(), input_names.end()),
         output_pin_to_function_(output_pin_to_function),
         state_table_(state_table),
-        clock_name_(clock_name) {}
+        clock_name_(clock_name) {
+    CompileFunctions();
+  }
 
   CellKind kind() const { return kind_; }
   const std::string& name() const { return name_; }
@@ -199,15 +203,48 @@ class AbstractCellLibraryEntry {
   }
   std::optional<std::string> clock_name() const { return clock_name_; }
 
+  // Returns the function of `output_pin` compiled against the inputs of the
+  // cell, in the order of input_names(), and its state table's internal
+  // signals. Functions are compiled once, when the entry is constructed; an
+  // error compiling the function is returned here.
+  absl::StatusOr<const function::CompiledFunction*> GetCompiledFunction(
+      std::string_view output_pin) const {
+    auto it = compiled_functions_.find(output_pin);
+    if (it == compiled_functions_.end()) {
+      return absl::NotFoundError(absl::StrFormat(
+          "Cell %s has no output pin %s.", name_, output_pin));
+    }
+    if (!it->second.ok()) {
+      return it->second.status();
+    }
+    return &it->second.value();
+  }
+
   absl::StatusOr<CellLibraryEntryProto> ToProto() const;
 
  private:
+  void CompileFunctions() {
+    std::vector<std::string> internal_names;
+    if (state_table_.has_value()) {
+      internal_names.assign(state_table_->internal_signals().begin(),
+                            state_table_->internal_signals().end());
+    }
+    for (const auto& [pin, function] : output_pin_to_function_) {
+      compiled_functions_.emplace(
+          pin, function::CompiledFunction::Compile(function, input_names_,
+                                                   internal_names));
+    }
+  }
+
   CellKind kind_;
   std::string name_;
   std::vector<std::string> input_names_;
   OutputPinToFunction output_pin_to_function_;
   std::optional<AbstractStateTable<EvalT>> state_table_;
   std::optional<std::string> clock_name_;
+  absl::flat_hash_map<std::string,
+                      absl::StatusOr<function::CompiledFunction>>
+      compiled_functions_;
 };
 
 using CellLibraryEntry = AbstractCellLibraryEntry<>;
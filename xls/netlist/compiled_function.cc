@@ -0,0 +1,175 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/compiled_function.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/netlist/function_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace function {
+namespace {
+
+// Lane `j` of kInputLanes[i] is bit `i` of `j`, so evaluating a function on
+// these with bitwise operators yields its truth table.
+constexpr uint64_t kInputLanes[CompiledFunction::kMaxTruthTableInputs] = {
+    0xaaaaaaaaaaaaaaaa, 0xcccccccccccccccc, 0xf0f0f0f0f0f0f0f0,
+    0xff00ff00ff00ff00, 0xffff0000ffff0000, 0xffffffff00000000,
+};
+
+uint64_t ComputeTruthTable(
+    absl::Span<const CompiledFunction::Instruction> instructions,
+    int64_t input_count) {
+  using Opcode = CompiledFunction::Opcode;
+  std::vector<uint64_t> stack;
+  for (const CompiledFunction::Instruction& instruction : instructions) {
+    switch (instruction.opcode) {
+      case Opcode::kInput:
+        stack.push_back(kInputLanes[instruction.operand]);
+        break;
+      case Opcode::kInternal:
+        XLS_LOG(FATAL) << "Functions of internal signals have no truth table";
+        break;
+      case Opcode::kZero:
+        stack.push_back(0);
+        break;
+      case Opcode::kOne:
+        stack.push_back(~uint64_t{0});
+        break;
+      case Opcode::kNot:
+        stack.back() = ~stack.back();
+        break;
+      case Opcode::kAnd:
+      case Opcode::kOr:
+      case Opcode::kXor: {
+        uint64_t rhs = stack.back();
+        stack.pop_back();
+        if (instruction.opcode == Opcode::kAnd) {
+          stack.back() &= rhs;
+        } else if (instruction.opcode == Opcode::kOr) {
+          stack.back() |= rhs;
+        } else {
+          stack.back() ^= rhs;
+        }
+        break;
+      }
+    }
+  }
+  // Only the first 2^input_count lanes are meaningful.
+  int64_t rows = int64_t{1} << input_count;
+  return rows == 64 ? stack.back()
+                    : stack.back() & ((uint64_t{1} << rows) - 1);
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<CompiledFunction> CompiledFunction::Compile(
+    const Ast& ast, absl::Span<const std::string> input_names,
+    absl::Span<const std::string> internal_names) {
+  CompiledFunction function;
+  XLS_RETURN_IF_ERROR(
+      function.CompileNode(ast, input_names, internal_names, /*depth=*/1));
+  if (function.internal_names_.empty() &&
+      input_names.size() <= kMaxTruthTableInputs) {
+    function.truth_table_ =
+        ComputeTruthTable(function.instructions_, input_names.size());
+  }
+  return function;
+}
+
+/* static */ absl::StatusOr<CompiledFunction> CompiledFunction::Compile(
+    std::string_view function, absl::Span<const std::string> input_names,
+    absl::Span<const std::string> internal_names) {
+  XLS_ASSIGN_OR_RETURN(Ast ast, Parser::ParseFunction(std::string(function)));
+  return Compile(ast, input_names, internal_names);
+}
+
+absl::Status CompiledFunction::CompileNode(
+    const Ast& ast, absl::Span<const std::string> input_names,
+    absl::Span<const std::string> internal_names, int64_t depth) {
+  // `depth` is the stack depth once this node's value has been pushed.
+  max_stack_depth_ = std::max(max_stack_depth_, depth);
+  switch (ast.kind()) {
+    case Ast::Kind::kIdentifier: {
+      auto input = std::find(input_names.begin(), input_names.end(),
+                             ast.name());
+      if (input != input_names.end()) {
+        instructions_.push_back(
+            {Opcode::kInput,
+             static_cast<int32_t>(input - input_names.begin())});
+        return absl::OkStatus();
+      }
+      if (std::find(internal_names.begin(), internal_names.end(),
+                    ast.name()) == internal_names.end()) {
+        return absl::NotFoundError(absl::StrFormat(
+            "Identifier \"%s\" not found in cell inputs or internal signals.",
+            ast.name()));
+      }
+      auto internal = std::find(internal_names_.begin(), internal_names_.end(),
+                                ast.name());
+      if (internal == internal_names_.end()) {
+        internal = internal_names_.insert(internal, ast.name());
+      }
+      instructions_.push_back(
+          {Opcode::kInternal,
+           static_cast<int32_t>(internal - internal_names_.begin())});
+      return absl::OkStatus();
+    }
+    case Ast::Kind::kLiteralZero:
+      instructions_.push_back({Opcode::kZero});
+      return absl::OkStatus();
+    case Ast::Kind::kLiteralOne:
+      instructions_.push_back({Opcode::kOne});
+      return absl::OkStatus();
+    case Ast::Kind::kNot:
+      XLS_RET_CHECK_EQ(ast.children().size(), 1);
+      XLS_RETURN_IF_ERROR(
+          CompileNode(ast.children()[0], input_names, internal_names, depth));
+      instructions_.push_back({Opcode::kNot});
+      return absl::OkStatus();
+    case Ast::Kind::kAnd:
+    case Ast::Kind::kOr:
+    case Ast::Kind::kXor: {
+      XLS_RET_CHECK_EQ(ast.children().size(), 2);
+      XLS_RETURN_IF_ERROR(
+          CompileNode(ast.children()[0], input_names, internal_names, depth));
+      XLS_RETURN_IF_ERROR(CompileNode(ast.children()[1], input_names,
+                                      internal_names, depth + 1));
+      Opcode opcode = ast.kind() == Ast::Kind::kAnd  ? Opcode::kAnd
+                      : ast.kind() == Ast::Kind::kOr ? Opcode::kOr
+                                                     : Opcode::kXor;
+      instructions_.push_back({opcode});
+      return absl::OkStatus();
+    }
+  }
+  return absl::InvalidArgumentError(absl::StrFormat(
+      "Unknown AST element type: %d", static_cast<int>(ast.kind())));
+}
+
+}  // namespace function
+}  // namespace netlist
+}  // namespace xls
@@ -0,0 +1,168 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NETLIST_COMPILED_FUNCTION_H_
+#define XLS_NETLIST_COMPILED_FUNCTION_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/netlist/function_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace function {
+
+// A cell pin function (see function_parser.h) compiled to a straight-line
+// stack program, so that it can be evaluated repeatedly without parsing it or
+// walking its Ast. Identifiers are resolved when compiling: inputs of the cell
+// by their position in the cell's input list and internal (state table)
+// signals by name.
+//
+// Functions of at most kMaxTruthTableInputs inputs which do not reference
+// internal signals are also compiled to a truth table, so evaluating them on
+// single bits is one table lookup.
+class CompiledFunction {
+ public:
+  static constexpr int64_t kMaxTruthTableInputs = 6;
+
+  enum class Opcode : uint8_t {
+    // Pushes the value of the input with index `operand`.
+    kInput,
+    // Pushes the value of the internal signal internal_names()[operand].
+    kInternal,
+    kZero,
+    kOne,
+    // Pop their operand(s) and push the result.
+    kAnd,
+    kOr,
+    kXor,
+    kNot,
+  };
+
+  struct Instruction {
+    Opcode opcode;
+    int32_t operand = 0;
+  };
+
+  // Compiles `ast`. Identifiers must name one of `input_names` or
+  // `internal_names`.
+  static absl::StatusOr<CompiledFunction> Compile(
+      const Ast& ast, absl::Span<const std::string> input_names,
+      absl::Span<const std::string> internal_names = {});
+
+  // Parses and compiles `function`.
+  static absl::StatusOr<CompiledFunction> Compile(
+      std::string_view function, absl::Span<const std::string> input_names,
+      absl::Span<const std::string> internal_names = {});
+
+  absl::Span<const Instruction> instructions() const { return instructions_; }
+
+  // The internal signals referenced by kInternal instructions.
+  absl::Span<const std::string> internal_names() const {
+    return internal_names_;
+  }
+
+  // If present, bit `i` of the truth table is the value of the function when
+  // input `j` has the value of bit `j` of `i`.
+  std::optional<uint64_t> truth_table() const { return truth_table_; }
+
+  // Evaluates the function on single bits; `input(i)` returns the value of
+  // input `i`. Requires a truth table.
+  template <typename InputFn>
+  bool EvaluateTruthTable(int64_t input_count, InputFn input) const {
+    uint64_t index = 0;
+    for (int64_t i = 0; i < input_count; ++i) {
+      index |= static_cast<uint64_t>(static_cast<bool>(input(i))) << i;
+    }
+    return ((*truth_table_ >> index) & 1) != 0;
+  }
+
+  // Evaluates the function using the &, |, ^ and ! operators of EvalT.
+  // `input(i)` returns the value of input `i` and `internal(name)` returns an
+  // absl::StatusOr<EvalT> with the value of an internal signal.
+  template <typename EvalT, typename InputFn, typename InternalFn>
+  absl::StatusOr<EvalT> Evaluate(const EvalT& zero, const EvalT& one,
+                                 InputFn input, InternalFn internal) const {
+    absl::InlinedVector<EvalT, 8> stack;
+    stack.reserve(max_stack_depth_);
+    for (const Instruction& instruction : instructions_) {
+      switch (instruction.opcode) {
+        case Opcode::kInput:
+          stack.push_back(input(instruction.operand));
+          break;
+        case Opcode::kInternal: {
+          absl::StatusOr<EvalT> value =
+              internal(internal_names_[instruction.operand]);
+          if (!value.ok()) {
+            return value.status();
+          }
+          stack.push_back(std::move(value).value());
+          break;
+        }
+        case Opcode::kZero:
+          stack.push_back(zero);
+          break;
+        case Opcode::kOne:
+          stack.push_back(one);
+          break;
+        case Opcode::kNot:
+          stack.back() = !stack.back();
+          break;
+        case Opcode::kAnd:
+        case Opcode::kOr:
+        case Opcode::kXor: {
+          EvalT rhs = std::move(stack.back());
+          stack.pop_back();
+          EvalT& lhs = stack.back();
+          if (instruction.opcode == Opcode::kAnd) {
+            lhs = lhs & rhs;
+          } else if (instruction.opcode == Opcode::kOr) {
+            lhs = lhs | rhs;
+          } else {
+            lhs = lhs ^ rhs;
+          }
+          break;
+        }
+      }
+    }
+    return std::move(stack.back());
+  }
+
+ private:
+  CompiledFunction() = default;
+
+  absl::Status CompileNode(const Ast& ast,
+                           absl::Span<const std::string> input_names,
+                           absl::Span<const std::string> internal_names,
+                           int64_t depth);
+
+  std::vector<Instruction> instructions_;
+  std::vector<std::string> internal_names_;
+  int64_t max_stack_depth_ = 0;
+  std::optional<uint64_t> truth_table_;
+};
+
+}  // namespace function
+}  // namespace netlist
+}  // namespace xls
+
+#endif  // XLS_NETLIST_COMPILED_FUNCTION_H_
@@ -0,0 +1,136 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/compiled_function.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls {
+namespace netlist {
+namespace function {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+// Evaluates `function` on the inputs given by the bits of `index` both via its
+// truth table and via its instructions, and checks that they agree.
+bool EvaluateBoth(const CompiledFunction& function, int64_t input_count,
+                  uint64_t index) {
+  auto input = [&](int64_t i) { return ((index >> i) & 1) != 0; };
+  bool from_table = function.EvaluateTruthTable(input_count, input);
+  absl::StatusOr<bool> from_program = function.Evaluate(
+      false, true, input,
+      [](const std::string&) -> absl::StatusOr<bool> { return false; });
+  EXPECT_TRUE(from_program.ok());
+  EXPECT_EQ(from_table, *from_program) << index;
+  return from_table;
+}
+
+TEST(CompiledFunctionTest, TruthTables) {
+  std::vector<std::string> inputs = {"A", "B", "C"};
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledFunction and_fn,
+                           CompiledFunction::Compile("A&B", inputs));
+  EXPECT_EQ(and_fn.truth_table(), 0x88);
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledFunction nand_fn,
+                           CompiledFunction::Compile("!(A B)", inputs));
+  EXPECT_EQ(nand_fn.truth_table(), 0x77);
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledFunction mux_fn,
+                           CompiledFunction::Compile("(A&!C)|(B&C)", inputs));
+  EXPECT_EQ(mux_fn.truth_table(), 0xca);
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledFunction one_fn,
+                           CompiledFunction::Compile("1", inputs));
+  EXPECT_EQ(one_fn.truth_table(), 0xff);
+
+  for (uint64_t index = 0; index < 8; ++index) {
+    bool a = (index & 1) != 0;
+    bool b = (index & 2) != 0;
+    bool c = (index & 4) != 0;
+    EXPECT_EQ(EvaluateBoth(mux_fn, 3, index), c ? b : a);
+    EXPECT_EQ(EvaluateBoth(nand_fn, 3, index), !(a && b));
+  }
+}
+
+TEST(CompiledFunctionTest, SixInputTruthTable) {
+  std::vector<std::string> inputs = {"A", "B", "C", "D", "E", "F"};
+  XLS_ASSERT_OK_AND_ASSIGN(
+      CompiledFunction function,
+      CompiledFunction::Compile("(A^B^C)|(D&E&!F)", inputs));
+  ASSERT_TRUE(function.truth_table().has_value());
+  for (uint64_t index = 0; index < 64; ++index) {
+    auto bit = [&](int64_t i) { return ((index >> i) & 1) != 0; };
+    bool expected =
+        (bit(0) ^ bit(1) ^ bit(2)) || (bit(3) && bit(4) && !bit(5));
+    EXPECT_EQ(EvaluateBoth(function, 6, index), expected);
+  }
+}
+
+TEST(CompiledFunctionTest, WideFunctionHasNoTruthTable) {
+  std::vector<std::string> inputs = {"A", "B", "C", "D", "E", "F", "G"};
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledFunction function,
+                           CompiledFunction::Compile("A&G", inputs));
+  EXPECT_FALSE(function.truth_table().has_value());
+  std::vector<bool> values = {true, false, false, false, false, false, true};
+  XLS_ASSERT_OK_AND_ASSIGN(
+      bool value,
+      function.Evaluate(
+          false, true, [&](int64_t i) { return values[i]; },
+          [](const std::string&) -> absl::StatusOr<bool> { return false; }));
+  EXPECT_TRUE(value);
+}
+
+TEST(CompiledFunctionTest, InternalSignals) {
+  std::vector<std::string> inputs = {"A"};
+  std::vector<std::string> internal = {"IQ", "IQN"};
+  XLS_ASSERT_OK_AND_ASSIGN(
+      CompiledFunction function,
+      CompiledFunction::Compile("(A&IQN)|(IQN^IQ)", inputs, internal));
+  EXPECT_FALSE(function.truth_table().has_value());
+  EXPECT_THAT(function.internal_names(),
+              ::testing::ElementsAre("IQN", "IQ"));
+  auto internal_value = [](const std::string& name) -> absl::StatusOr<bool> {
+    return name == "IQN";
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(
+      bool value,
+      function.Evaluate(
+          false, true, [](int64_t) { return false; }, internal_value));
+  EXPECT_TRUE(value);
+
+  auto failing = [](const std::string&) -> absl::StatusOr<bool> {
+    return absl::InternalError("no state");
+  };
+  EXPECT_THAT(
+      function.Evaluate(false, true, [](int64_t) { return true; }, failing),
+      StatusIs(absl::StatusCode::kInternal, HasSubstr("no state")));
+}
+
+TEST(CompiledFunctionTest, UnknownIdentifier) {
+  std::vector<std::string> inputs = {"A"};
+  EXPECT_THAT(CompiledFunction::Compile("A&B", inputs),
+              StatusIs(absl::StatusCode::kNotFound, HasSubstr("\"B\"")));
+}
+
+}  // namespace
+}  // namespace function
+}  // namespace netlist
+}  // namespace xls
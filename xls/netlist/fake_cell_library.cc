@@ -25,13 +25,18 @@ namespace xls {
 namespace netlist {
 
 absl::StatusOr<CellLibrary> MakeFakeCellLibrary() {
+  XLS_ASSIGN_OR_RETURN(CellLibraryProto proto, MakeFakeCellLibraryProto());
+  return CellLibrary::FromProto(proto);
+}
+
+absl::StatusOr<CellLibraryProto> MakeFakeCellLibraryProto() {
   XLS_ASSIGN_OR_RETURN(
       std::filesystem::path proto_path,
       GetXlsRunfilePath("xls/netlist/fake_cell_library.textproto"));
 
   CellLibraryProto proto;
   XLS_RETURN_IF_ERROR(ParseTextProtoFile(proto_path, &proto));
-  return CellLibrary::FromProto(proto);
+  return proto;
 }
 
 }  // namespace netlist
@@ -17,6 +17,7 @@
 
 #include "absl/status/statusor.h"
 #include "xls/netlist/netlist.h"
+#include "xls/netlist/netlist.pb.h"
 
 namespace xls {
 namespace netlist {
@@ -24,6 +25,10 @@ namespace netlist {
 // Creates a fake cell library suitable for testing.
 absl::StatusOr<CellLibrary> MakeFakeCellLibrary();
 
+// Returns the proto of the fake cell library, e.g., to create it for an EvalT
+// other than bool.
+absl::StatusOr<CellLibraryProto> MakeFakeCellLibraryProto();
+
 }  // namespace netlist
 }  // namespace xls
 
@@ -15,12 +15,18 @@
 #include "xls/netlist/find_logic_clouds.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/data_structures/union_find.h"
 
@@ -46,88 +52,92 @@ void Cluster::SortCells() {
 
 std::vector<Cluster> FindLogicClouds(const Module& module,
                                      bool include_vacuous) {
-  UnionFind<Cell*> cell_to_uf;
-
-  // Gets-or-adds the given cell to the UnionFind.
-  auto get_uf = [&cell_to_uf](Cell* c) -> Cell* {
-    cell_to_uf.Insert(c);
-    return cell_to_uf.Find(c);
-  };
-
-  // Helper for debugging that counts the number of equivalence classes in
-  // cell_to_uf.
-  auto count_equivalence_classes = [&cell_to_uf]() -> int64_t {
-    return cell_to_uf.GetRepresentatives().size();
-  };
-
-  for (auto& item : module.cells()) {
-    Cell* cell = item.get();
-    XLS_VLOG(4) << "Considering cell: " << cell->name();
+  // Cells are identified by their index in module.cells().
+  absl::Span<const std::unique_ptr<Cell>> cells = module.cells();
+  absl::flat_hash_map<const Cell*, int64_t> cell_indices;
+  cell_indices.reserve(cells.size());
+  UnionFind<int64_t> cell_to_uf;
+  for (int64_t i = 0; i < cells.size(); ++i) {
+    cell_indices[cells[i].get()] = i;
+    cell_to_uf.Insert(i);
+  }
 
-    // Flop output connectivity is excluded from the equivalence class, so we
-    // get partitions along flop (output) boundaries.
-    if (cell->kind() == CellKind::kFlop) {
-      // For flops we just make sure an equivalence class is present in the
-      // map, in case it doesn't have any cells on the input side.
-      get_uf(cell);
-      XLS_VLOG(4) << "--- Now " << count_equivalence_classes()
-                  << " equivalence classes for " << cell_to_uf.size()
-                  << " cells.";
-      continue;
+  // Two cells are in the same cloud if they are connected by a net which is an
+  // input or output of a logic (non-flop) cell, except that flop output
+  // connectivity is excluded so we get partitions along flop (output)
+  // boundaries. So for each such net:
+  //  - all logic cells on the net are in one cloud; and
+  //  - if a logic cell drives the net, the flops on the net are in its cloud
+  //    (flops are associated with their input side).
+  // Each net is visited once and its cells are united with one representative,
+  // rather than with every other cell on the net, which would be quadratic in
+  // the fanout of the net.
+  absl::flat_hash_set<NetRef> visited_nets;
+  auto visit_net = [&](NetRef net) {
+    if (!visited_nets.insert(net).second) {
+      return;
     }
-
-    for (auto& input : cell->inputs()) {
-      XLS_VLOG(4) << "- Considering input net: " << input.netref->name();
-      for (Cell* connected : input.netref->connected_cells()) {
-        if (cell == connected) {
-          continue;
-        }
-        if (connected->kind() == CellKind::kFlop) {
-          XLS_VLOG(4) << absl::StreamFormat(
-              "-- Cell is connected to flop cell %s on an input pin; not "
-              "merging equivalence classes.",
-              connected->name());
-          continue;
+    XLS_VLOG(4) << "- Considering net: " << net->name();
+    std::optional<int64_t> first_logic_cell;
+    std::optional<int64_t> logic_driver;
+    for (Cell* connected : net->connected_cells()) {
+      if (connected->kind() == CellKind::kFlop) {
+        continue;
+      }
+      int64_t index = cell_indices.at(connected);
+      if (first_logic_cell.has_value()) {
+        cell_to_uf.Union(*first_logic_cell, index);
+      } else {
+        first_logic_cell = index;
+      }
+      for (const auto& output : connected->outputs()) {
+        if (output.netref == net) {
+          logic_driver = index;
         }
-        XLS_VLOG(4) << absl::StreamFormat("-- Cell %s is connected to cell %s",
-                                          cell->name(), connected->name());
-        cell_to_uf.Union(get_uf(cell), get_uf(connected));
-        XLS_VLOG(4) << "--- Now " << count_equivalence_classes()
-                    << " equivalence classes for " << cell_to_uf.size()
-                    << " cells.";
       }
     }
-
-    for (const auto& iter : cell->outputs()) {
-      NetRef output = iter.netref;
-      XLS_VLOG(4) << "- Considering output net: " << output->name();
-      for (Cell* connected : output->connected_cells()) {
-        if (cell == connected) {
-          continue;
-        }
-        XLS_VLOG(4) << absl::StreamFormat("-- Cell %s is connected to cell %s",
-                                          cell->name(), connected->name());
-        cell_to_uf.Union(get_uf(cell), get_uf(connected));
-        XLS_VLOG(4) << "--- Now " << count_equivalence_classes()
-                    << " equivalence classes for " << cell_to_uf.size()
-                    << " cells.";
+    if (!logic_driver.has_value()) {
+      return;
+    }
+    for (Cell* connected : net->connected_cells()) {
+      if (connected->kind() == CellKind::kFlop) {
+        XLS_VLOG(4) << absl::StreamFormat("-- Flop %s is driven by cell %s",
+                                          connected->name(),
+                                          cells[*logic_driver]->name());
+        cell_to_uf.Union(*logic_driver, cell_indices.at(connected));
       }
     }
+  };
+  for (const auto& cell : cells) {
+    if (cell->kind() == CellKind::kFlop) {
+      continue;
+    }
+    XLS_VLOG(4) << "Considering cell: " << cell->name();
+    for (const auto& input : cell->inputs()) {
+      visit_net(input.netref);
+    }
+    for (const auto& output : cell->outputs()) {
+      visit_net(output.netref);
+    }
   }
 
   // Run through the cells and put them into clusters according to their
   // equivalence classes.
-  absl::flat_hash_map<Cell*, Cluster> equivalence_set_to_cluster;
-  for (auto& item : module.cells()) {
-    Cell* cell = item.get();
-    equivalence_set_to_cluster[get_uf(cell)].Add(cell);
+  std::vector<Cluster> equivalence_set_clusters;
+  std::vector<int64_t> representative_to_cluster(cells.size(), -1);
+  for (int64_t i = 0; i < cells.size(); ++i) {
+    int64_t& cluster_index = representative_to_cluster[cell_to_uf.Find(i)];
+    if (cluster_index == -1) {
+      cluster_index = equivalence_set_clusters.size();
+      equivalence_set_clusters.emplace_back();
+    }
+    equivalence_set_clusters[cluster_index].Add(cells[i].get());
   }
 
-  // Put them into a vector and sort each cluster's internal cells for
+  // Drop vacuous clusters and sort each cluster's internal cells for
   // determinism.
   std::vector<Cluster> clusters;
-  for (auto& item : equivalence_set_to_cluster) {
-    Cluster& cluster = item.second;
+  for (Cluster& cluster : equivalence_set_clusters) {
     if (!include_vacuous && (cluster.terminating_flops().size() == 1 &&
                              cluster.other_cells().empty())) {
       // Vacuous 'just a flop' cluster.
@@ -138,20 +148,27 @@ std::vector<Cluster> FindLogicClouds(const Module& module,
   }
 
   // For convenience (for now) we convert the cell names to a string and rely on
-  // string comparison for deterministic order.
+  // string comparison for deterministic order. The strings are built once per
+  // cluster rather than once per comparison.
   auto cells_to_str = [](absl::Span<const Cell* const> cells) {
     return absl::StrJoin(cells, ", ", [](std::string* out, const Cell* cell) {
       absl::StrAppend(out, cell->name());
     });
   };
-  auto cluster_sort_lt = [cells_to_str](const Cluster& a, const Cluster& b) {
-    return std::make_pair(cells_to_str(a.terminating_flops()),
-                          cells_to_str(a.other_cells())) <
-           std::make_pair(cells_to_str(b.terminating_flops()),
-                          cells_to_str(b.other_cells()));
-  };
-  std::sort(clusters.begin(), clusters.end(), cluster_sort_lt);
-  return clusters;
+  std::vector<std::pair<std::pair<std::string, std::string>, int64_t>> keys;
+  keys.reserve(clusters.size());
+  for (int64_t i = 0; i < clusters.size(); ++i) {
+    keys.push_back({{cells_to_str(clusters[i].terminating_flops()),
+                     cells_to_str(clusters[i].other_cells())},
+                    i});
+  }
+  std::sort(keys.begin(), keys.end());
+  std::vector<Cluster> sorted_clusters;
+  sorted_clusters.reserve(clusters.size());
+  for (const auto& [key, index] : keys) {
+    sorted_clusters.push_back(std::move(clusters[index]));
+  }
+  return sorted_clusters;
 }
 
 std::string ClustersToString(absl::Span<const Cluster> clusters) {
@@ -14,13 +14,17 @@
 
 #include "xls/netlist/find_logic_clouds.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "xls/common/status/matchers.h"
 #include "xls/netlist/fake_cell_library.h"
 #include "xls/netlist/netlist_parser.h"
@@ -133,6 +137,82 @@ cluster {
             ClustersToString(clusters));
 }
 
+TEST(ClusterTest, HighFanoutNets) {
+  // A logic-driven enable net fans out to the logic of every stage and to a
+  // flop, merging them all into one cloud; the flop-driven net q does not
+  // merge the flop dff_q with its fanout.
+  std::string netlist = R"(module main(clk, en_n, a, b, q, y);
+  input clk, en_n, a, b;
+  output q, y;
+  wire en, a_en, b_en, q_en, q_n;
+
+  INV inv_en(.A(en_n), .ZN(en));
+  AND and_a(.A(a), .B(en), .Z(a_en));
+  AND and_b(.A(b), .B(en), .Z(b_en));
+  DFF dff_en(.D(en), .Q(q_en), .CLK(clk));
+  DFF dff_q(.D(a_en), .Q(q), .CLK(clk));
+  INV inv_q(.A(q), .ZN(q_n));
+  OR or_y(.A(q_n), .B(b_en), .Z(y));
+endmodule)";
+  Scanner scanner(netlist);
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Netlist> n,
+                           Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* m, n->GetModule("main"));
+  std::vector<Cluster> clusters = FindLogicClouds(*m);
+  EXPECT_EQ(R"(cluster {
+  terminating_flop: dff_en
+  terminating_flop: dff_q
+  other_cell: and_a
+  other_cell: and_b
+  other_cell: inv_en
+  other_cell: inv_q
+  other_cell: or_y
+}
+)",
+            ClustersToString(clusters));
+}
+
+// Generates a netlist of `stages` pipeline stages, each an inverter and an
+// AND gate feeding a flop. The AND gates share a single enable net, so the
+// netlist has a net with a fanout of `stages`.
+std::string GenerateStagedNetlist(int64_t stages) {
+  std::string netlist = "module main(clk, en, d, q);\n";
+  absl::StrAppend(&netlist, "  input clk, en, d;\n  output q;\n");
+  for (int64_t i = 0; i < stages; ++i) {
+    absl::StrAppendFormat(&netlist, "  wire q%d, n%d, e%d;\n", i, i, i);
+  }
+  absl::StrAppend(&netlist, "  INV inv_d(.A(d), .ZN(q0));\n");
+  for (int64_t i = 0; i < stages; ++i) {
+    std::string next = i + 1 == stages ? "q" : absl::StrCat("q", i + 1);
+    absl::StrAppendFormat(&netlist, "  INV inv_%d(.A(q%d), .ZN(n%d));\n", i, i,
+                          i);
+    absl::StrAppendFormat(&netlist,
+                          "  AND and_%d(.A(n%d), .B(en), .Z(e%d));\n", i, i,
+                          i);
+    absl::StrAppendFormat(&netlist,
+                          "  DFF dff_%d(.D(e%d), .Q(%s), .CLK(clk));\n", i, i,
+                          next);
+  }
+  absl::StrAppend(&netlist, "endmodule");
+  return netlist;
+}
+
+void BM_FindLogicClouds(benchmark::State& state) {
+  std::string netlist = GenerateStagedNetlist(state.range(0));
+  Scanner scanner(netlist);
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Netlist> n,
+                           Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* m, n->GetModule("main"));
+  for (auto _ : state) {
+    std::vector<Cluster> clusters = FindLogicClouds(*m);
+    benchmark::DoNotOptimize(clusters);
+  }
+  state.SetItemsProcessed(state.iterations() * m->cells().size());
+}
+BENCHMARK(BM_FindLogicClouds)->Range(64, 1 << 16);
+
 }  // namespace
 }  // namespace rtl
 }  // namespace netlist
@@ -14,6 +14,8 @@
 
 #include "xls/netlist/function_extractor.h"
 
+#include <cstdint>
+#include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <string>
@@ -25,7 +27,10 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/common/file/memory_mapped_file.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -47,6 +52,10 @@ constexpr const char kPinKind[] = "pin";
 constexpr const char kFfKind[] = "ff";
 constexpr const char kStateTableKind[] = "statetable";
 
+// Bumped whenever the extraction changes in a way which affects its result, so
+// stale cache entries are not reused.
+constexpr std::string_view kCacheFormatVersion = "xls-cell-library-cache-v1";
+
 // Translates an individual signal value char to the protobuf equivalent.
 absl::StatusOr<StateTableSignalProto> LibertyToTableSignal(
     const std::string& input) {
@@ -280,7 +289,7 @@ absl::StatusOr<CellLibraryProto> ExtractFunctions(
   absl::flat_hash_set<std::string> kind_allowlist(
       {"library", "cell", "pin", "direction", "function", "ff", "next_state",
        "statetable"});
-  cell_lib::Parser parser(&scanner);
+  cell_lib::Parser parser(&scanner, std::move(kind_allowlist));
 
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<cell_lib::Block> block,
                        parser.ParseLibrary());
@@ -298,6 +307,38 @@ absl::StatusOr<CellLibraryProto> ExtractFunctions(
   return proto;
 }
 
+absl::StatusOr<CellLibraryProto> ExtractFunctionsFromPath(
+    const std::filesystem::path& path,
+    std::optional<std::filesystem::path> cache_dir) {
+  XLS_ASSIGN_OR_RETURN(MemoryMappedFile file, MemoryMappedFile::Open(path));
+  std::optional<ContentAddressedCache> cache;
+  std::string key;
+  if (cache_dir.has_value()) {
+    cache.emplace(*cache_dir, ".cell_library.pb");
+    CacheKeyBuilder builder(kCacheFormatVersion);
+    builder.Add(file.contents());
+    key = builder.Finish();
+    XLS_ASSIGN_OR_RETURN(std::optional<std::string> contents,
+                         cache->Lookup(key));
+    if (contents.has_value()) {
+      CellLibraryProto proto;
+      if (proto.ParseFromString(*contents)) {
+        return proto;
+      }
+      XLS_LOG(WARNING) << "Ignoring unparseable cached cell library "
+                       << cache->EntryPath(key);
+    }
+  }
+
+  XLS_ASSIGN_OR_RETURN(cell_lib::CharStream stream,
+                       cell_lib::CharStream::FromPath(path.string()));
+  XLS_ASSIGN_OR_RETURN(CellLibraryProto proto, ExtractFunctions(&stream));
+  if (cache.has_value()) {
+    XLS_RETURN_IF_ERROR(cache->Insert(key, proto.SerializeAsString()));
+  }
+  return proto;
+}
+
 }  // namespace function
 }  // namespace netlist
 }  // namespace xls
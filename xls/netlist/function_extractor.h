@@ -15,6 +15,8 @@
 #ifndef XLS_NETLIST_FUNCTION_EXTRACTOR_H_
 #define XLS_NETLIST_FUNCTION_EXTRACTOR_H_
 
+#include <filesystem>  // NOLINT
+#include <optional>
 #include <string>
 
 #include "absl/status/statusor.h"
@@ -31,6 +33,14 @@ namespace function {
 // logical operation of the cell or pin (in the case of multiple output pins).
 absl::StatusOr<CellLibraryProto> ExtractFunctions(cell_lib::CharStream* stream);
 
+// As above, for the Liberty file at `path`. If `cache_dir` is given, the
+// extracted CellLibraryProto is stored in that directory keyed by a hash of the
+// file contents, and reused instead of parsing the file when the contents
+// match. The directory is created if it does not exist.
+absl::StatusOr<CellLibraryProto> ExtractFunctionsFromPath(
+    const std::filesystem::path& path,
+    std::optional<std::filesystem::path> cache_dir = std::nullopt);
+
 }  // namespace function
 }  // namespace netlist
 }  // namespace xls
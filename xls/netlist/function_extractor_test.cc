@@ -14,11 +14,15 @@
 
 #include "xls/netlist/function_extractor.h"
 
+#include <filesystem>  // NOLINT
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_set.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/status/matchers.h"
 #include "xls/netlist/lib_parser.h"
 #include "xls/netlist/netlist.pb.h"
@@ -218,6 +222,56 @@ library (simple_statetable_cells) {
   EXPECT_EQ(row.next_internal_signals().at("X"), STATE_TABLE_SIGNAL_HIGH);
 }
 
+TEST(FunctionExtractorTest, ExtractFromPathWithCache) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path lib_path = temp_dir.path() / "test.lib";
+  std::filesystem::path cache_dir = temp_dir.path() / "cache";
+  XLS_ASSERT_OK(SetFileContents(lib_path, R"(
+library (blah) {
+  cell (cell_1) {
+    pin (i) {
+      direction: input;
+    }
+    pin (o) {
+      direction: output;
+      function: "!i";
+    }
+  }
+}
+)"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto uncached,
+                           ExtractFunctionsFromPath(lib_path));
+  ASSERT_EQ(uncached.entries_size(), 1);
+  EXPECT_EQ(uncached.entries(0).output_pin_list().pins(0).function(), "!i");
+
+  // The first extraction populates the cache.
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto miss,
+                           ExtractFunctionsFromPath(lib_path, cache_dir));
+  EXPECT_EQ(miss.SerializeAsString(), uncached.SerializeAsString());
+  std::vector<std::filesystem::path> entries;
+  for (const auto& entry : std::filesystem::directory_iterator(cache_dir)) {
+    entries.push_back(entry.path());
+  }
+  ASSERT_EQ(entries.size(), 1);
+
+  // Doctor the cache entry to show that it, not the library, is used.
+  CellLibraryProto doctored = uncached;
+  doctored.mutable_entries(0)->set_name("cached_cell");
+  XLS_ASSERT_OK(SetFileContents(entries[0], doctored.SerializeAsString()));
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto hit,
+                           ExtractFunctionsFromPath(lib_path, cache_dir));
+  EXPECT_EQ(hit.entries(0).name(), "cached_cell");
+
+  // A changed library misses the cache.
+  XLS_ASSERT_OK(SetFileContents(
+      lib_path, "library (blah) { cell (cell_2) { pin (i) { direction: "
+                "input; } } }"));
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto changed,
+                           ExtractFunctionsFromPath(lib_path, cache_dir));
+  EXPECT_EQ(changed.entries(0).name(), "cell_2");
+}
+
 }  // namespace
 }  // namespace function
 }  // namespace netlist
@@ -14,25 +14,30 @@
 #ifndef XLS_NETLIST_INTERPRETER_H_
 #define XLS_NETLIST_INTERPRETER_H_
 
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
 #include <deque>
 #include <memory>
 #include <queue>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/synchronization/notification.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/thread.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
-#include "xls/netlist/function_parser.h"
+#include "xls/netlist/compiled_function.h"
 #include "xls/netlist/netlist.h"
 
 namespace xls {
@@ -90,13 +95,49 @@ class AbstractInterpreter {
       const AbstractNetRef2Value<EvalT>& inputs,
       absl::Span<const std::string> dump_cells = {});
 
+  // As InterpretModule, but evaluates the cells in a levelized order rather
+  // than dispatching each cell as its inputs become ready. The first time a
+  // module is interpreted its cells are sorted into levels, where every input
+  // of a cell is a module input, a constant or an output of a cell in an
+  // earlier level; the schedule is cached and reused by later calls. Levels
+  // are evaluated one after another on the calling thread, except that levels
+  // wider than kLevelizedChunkSize are split into chunks which the calling
+  // thread evaluates together with up to `num_threads` helper threads.
+  // Submodules are interpreted the same way.
+  absl::StatusOr<AbstractNetRef2Value<EvalT>> InterpretModuleLevelized(
+      const rtl::AbstractModule<EvalT>* module,
+      const AbstractNetRef2Value<EvalT>& inputs,
+      absl::Span<const std::string> dump_cells = {});
+
+  // Number of cells in a chunk of a level evaluated by one thread in
+  // InterpretModuleLevelized. Narrower levels are not worth the cost of
+  // handing off to other threads.
+  static constexpr int64_t kLevelizedChunkSize = 256;
+
  private:
-  // Returns true if the specified AbstractNetRef is an output of the given
-  // cell.
+  // The cells of a module in evaluation order for InterpretModuleLevelized.
+  // Level `i` consists of cells[level_starts[i]] to cells[level_starts[i + 1]]
+  // (exclusive); cells within a level do not depend on each other.
+  struct LevelizedSchedule {
+    std::vector<const rtl::AbstractCell<EvalT>*> cells;
+    std::vector<int64_t> level_starts;
+  };
+
+  // Returns the levelized schedule of `module`, computing it if necessary.
+  absl::StatusOr<const LevelizedSchedule*> GetLevelizedSchedule(
+      const rtl::AbstractModule<EvalT>* module);
 
+  // Interprets `cell`, whose input values are in `inputs`. Submodules are
+  // interpreted with InterpretModuleLevelized if `levelized` is true and with
+  // InterpretModule otherwise.
   absl::StatusOr<AbstractNetRef2Value<EvalT>> InterpretCell(
       const rtl::AbstractCell<EvalT>* cell,
-      const AbstractNetRef2Value<EvalT>& inputs);
+      const AbstractNetRef2Value<EvalT>& inputs, bool levelized = false);
+
+  // Logs the input and output values of `cell`.
+  void DumpCell(const rtl::AbstractCell<EvalT>* cell,
+                const AbstractNetRef2Value<EvalT>& inputs,
+                const AbstractNetRef2Value<EvalT>& outputs);
 
   // A struct to contain the state of a cell as we are processing the netlist.
   // Initially, all cells are unsatisfied, meaning none of their input wires are
@@ -120,8 +161,12 @@ class AbstractInterpreter {
       const absl::flat_hash_set<std::string>& dump_cell_set,
       const rtl::AbstractCell<EvalT>* cell, AbstractNetRef2Value<EvalT>& wires);
 
+  // Evaluates `function`, an output pin function of `cell`'s library entry.
+  // Single-bit values are looked up in the function's truth table when it has
+  // one.
   absl::StatusOr<EvalT> InterpretFunction(
-      const rtl::AbstractCell<EvalT>& cell, const function::Ast& ast,
+      const rtl::AbstractCell<EvalT>& cell,
+      const function::CompiledFunction& function,
       const AbstractNetRef2Value<EvalT>& inputs);
 
   // Returns the value of the internal/output pin from the cell (defined by a
@@ -170,6 +215,12 @@ class AbstractInterpreter {
   std::atomic_size_t num_available_threads_ ABSL_GUARDED_BY(input_queue_guard_);
   // Set to shut down thread pool.
   std::atomic_bool threads_should_exit_ ABSL_GUARDED_BY(input_queue_guard_);
+
+  // Levelized schedules of the modules interpreted so far.
+  absl::Mutex schedules_guard_;
+  absl::flat_hash_map<const rtl::AbstractModule<EvalT>*,
+                      std::unique_ptr<LevelizedSchedule>>
+      schedules_ ABSL_GUARDED_BY(schedules_guard_);
 };
 
 using Interpreter = AbstractInterpreter<>;
@@ -207,22 +258,29 @@ void AbstractInterpreter<EvalT>::UpdateProcessedState(
   }
 
   if (dump_cell_set.contains(cell->name())) {
-    XLS_LOG(INFO) << "Cell " << cell->name() << " inputs:";
-    if constexpr (std::is_convertible<EvalT, int>()) {
-      for (const auto& input : cell->inputs()) {
-        XLS_LOG(INFO) << "   " << input.netref->name() << " : "
-                      << static_cast<int>(
-                             processed_cells.at(cell)->inputs.at(input.netref));
-      }
+    DumpCell(cell, processed_cells.at(cell)->inputs, wires);
+  }
+}
 
-      XLS_LOG(INFO) << "Cell " << cell->name() << " outputs:";
-      for (const auto& output : cell->outputs()) {
-        XLS_LOG(INFO) << "   " << output.netref->name() << " : "
-                      << static_cast<int>(wires[output.netref]);
-      }
-    } else {
-      XLS_LOG(INFO) << "Cell " << cell->name() << " inputs are not printable.";
+template <typename EvalT>
+void AbstractInterpreter<EvalT>::DumpCell(
+    const rtl::AbstractCell<EvalT>* cell,
+    const AbstractNetRef2Value<EvalT>& inputs,
+    const AbstractNetRef2Value<EvalT>& outputs) {
+  XLS_LOG(INFO) << "Cell " << cell->name() << " inputs:";
+  if constexpr (std::is_convertible<EvalT, int>()) {
+    for (const auto& input : cell->inputs()) {
+      XLS_LOG(INFO) << "   " << input.netref->name() << " : "
+                    << static_cast<int>(inputs.at(input.netref));
+    }
+
+    XLS_LOG(INFO) << "Cell " << cell->name() << " outputs:";
+    for (const auto& output : cell->outputs()) {
+      XLS_LOG(INFO) << "   " << output.netref->name() << " : "
+                    << static_cast<int>(outputs.at(output.netref));
     }
+  } else {
+    XLS_LOG(INFO) << "Cell " << cell->name() << " inputs are not printable.";
   }
 }
 
@@ -386,11 +444,191 @@ AbstractInterpreter<EvalT>::InterpretModule(
   return outputs;
 }
 
+template <typename EvalT>
+absl::StatusOr<const typename AbstractInterpreter<EvalT>::LevelizedSchedule*>
+AbstractInterpreter<EvalT>::GetLevelizedSchedule(
+    const rtl::AbstractModule<EvalT>* module) {
+  {
+    absl::MutexLock lock(&schedules_guard_);
+    auto it = schedules_.find(module);
+    if (it != schedules_.end()) {
+      return it->second.get();
+    }
+  }
+
+  // Nets with a value before any cell is evaluated.
+  absl::flat_hash_set<rtl::AbstractNetRef<EvalT>> available_nets(
+      module->inputs().begin(), module->inputs().end());
+  available_nets.insert(module->zero());
+  available_nets.insert(module->one());
+  absl::flat_hash_set<rtl::AbstractNetRef<EvalT>> driven_nets;
+  for (const auto& cell : module->cells()) {
+    for (const auto& output : cell->outputs()) {
+      driven_nets.insert(output.netref);
+    }
+  }
+
+  // Sort the cells into levels with Kahn's algorithm. A cell is ready once the
+  // cells driving all of its inputs have been scheduled.
+  absl::flat_hash_map<rtl::AbstractNetRef<EvalT>,
+                      std::vector<const rtl::AbstractCell<EvalT>*>>
+      consumers;
+  absl::flat_hash_map<const rtl::AbstractCell<EvalT>*, int64_t> pending_inputs;
+  std::vector<const rtl::AbstractCell<EvalT>*> level;
+  for (const auto& cell : module->cells()) {
+    int64_t pending = 0;
+    for (const auto& input : cell->inputs()) {
+      if (driven_nets.contains(input.netref)) {
+        consumers[input.netref].push_back(cell.get());
+        ++pending;
+      } else if (!available_nets.contains(input.netref)) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Netlist contains unconnected subgraphs and cannot be translated. "
+            "Example: cell %s",
+            cell->name()));
+      }
+    }
+    pending_inputs[cell.get()] = pending;
+    if (pending == 0) {
+      level.push_back(cell.get());
+    }
+  }
+
+  auto schedule = std::make_unique<LevelizedSchedule>();
+  schedule->cells.reserve(module->cells().size());
+  while (!level.empty()) {
+    schedule->level_starts.push_back(schedule->cells.size());
+    std::vector<const rtl::AbstractCell<EvalT>*> next_level;
+    for (const rtl::AbstractCell<EvalT>* cell : level) {
+      schedule->cells.push_back(cell);
+      for (const auto& output : cell->outputs()) {
+        auto it = consumers.find(output.netref);
+        if (it == consumers.end()) {
+          continue;
+        }
+        for (const rtl::AbstractCell<EvalT>* consumer : it->second) {
+          if (--pending_inputs[consumer] == 0) {
+            next_level.push_back(consumer);
+          }
+        }
+      }
+    }
+    level = std::move(next_level);
+  }
+  schedule->level_starts.push_back(schedule->cells.size());
+
+  // Cells on a combinational cycle are never ready.
+  if (schedule->cells.size() != module->cells().size()) {
+    for (const auto& cell : module->cells()) {
+      if (pending_inputs.at(cell.get()) > 0) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Netlist contains unconnected subgraphs and cannot be translated. "
+            "Example: cell %s",
+            cell->name()));
+      }
+    }
+  }
+
+  absl::MutexLock lock(&schedules_guard_);
+  // Another thread may have computed the schedule in the meantime; either is
+  // fine.
+  auto [it, inserted] = schedules_.try_emplace(module, std::move(schedule));
+  return it->second.get();
+}
+
+template <typename EvalT>
+absl::StatusOr<AbstractNetRef2Value<EvalT>>
+AbstractInterpreter<EvalT>::InterpretModuleLevelized(
+    const rtl::AbstractModule<EvalT>* module,
+    const AbstractNetRef2Value<EvalT>& inputs,
+    absl::Span<const std::string> dump_cells) {
+  XLS_ASSIGN_OR_RETURN(const LevelizedSchedule* schedule,
+                       GetLevelizedSchedule(module));
+  for (const rtl::AbstractNetRef<EvalT> input : module->inputs()) {
+    XLS_RET_CHECK(inputs.contains(input))
+        << "No value given for module input " << input->name();
+  }
+  absl::flat_hash_set<std::string> dump_cell_set(dump_cells.begin(),
+                                                 dump_cells.end());
+
+  // The values of all nets evaluated so far. Cells only read this while a level
+  // is evaluated; their results are added once the whole level is done.
+  AbstractNetRef2Value<EvalT> values = inputs;
+  values.try_emplace(module->zero(), zero_);
+  values.try_emplace(module->one(), one_);
+
+  std::vector<absl::StatusOr<AbstractNetRef2Value<EvalT>>> results;
+  for (int64_t level = 0; level + 1 < schedule->level_starts.size(); ++level) {
+    absl::Span<const rtl::AbstractCell<EvalT>* const> cells =
+        absl::MakeConstSpan(schedule->cells)
+            .subspan(schedule->level_starts[level],
+                     schedule->level_starts[level + 1] -
+                         schedule->level_starts[level]);
+    results.clear();
+    results.resize(cells.size());
+    const int64_t num_chunks =
+        (cells.size() + kLevelizedChunkSize - 1) / kLevelizedChunkSize;
+    std::atomic<int64_t> next_chunk = 0;
+    auto evaluate_chunks = [&]() {
+      for (int64_t chunk = next_chunk++; chunk < num_chunks;
+           chunk = next_chunk++) {
+        int64_t end = std::min<int64_t>((chunk + 1) * kLevelizedChunkSize,
+                                        cells.size());
+        for (int64_t i = chunk * kLevelizedChunkSize; i < end; ++i) {
+          results[i] = InterpretCell(cells[i], values, /*levelized=*/true);
+        }
+      }
+    };
+    {
+      // The calling thread evaluates chunks too.
+      int64_t num_helpers =
+          std::min<int64_t>(threads_.size(), num_chunks - 1);
+      std::vector<std::unique_ptr<xls::Thread>> helpers;
+      helpers.reserve(num_helpers);
+      for (int64_t i = 0; i < num_helpers; ++i) {
+        helpers.push_back(std::make_unique<xls::Thread>(evaluate_chunks));
+      }
+      evaluate_chunks();
+      // Threads are joined on destruction.
+    }
+
+    for (int64_t i = 0; i < cells.size(); ++i) {
+      XLS_RETURN_IF_ERROR(results[i].status());
+      if (dump_cell_set.contains(cells[i]->name())) {
+        DumpCell(cells[i], values, *results[i]);
+      }
+    }
+    for (absl::StatusOr<AbstractNetRef2Value<EvalT>>& result : results) {
+      for (auto& [wire, value] : *result) {
+        values.insert_or_assign(wire, std::move(value));
+      }
+    }
+  }
+
+  AbstractNetRef2Value<EvalT> outputs;
+  outputs.reserve(module->outputs().size());
+  const auto& assigns = module->assigns();
+  for (const rtl::AbstractNetRef<EvalT> output : module->outputs()) {
+    rtl::AbstractNetRef<EvalT> net_value = output;
+    if (!values.contains(net_value)) {
+      // As in InterpretModule, an output which is not driven by a cell must be
+      // assigned from a constant, an input or (here) another net with a value.
+      XLS_RET_CHECK(assigns.contains(output));
+      while (assigns.contains(net_value)) {
+        net_value = assigns.at(net_value);
+      }
+      XLS_RET_CHECK(values.contains(net_value));
+    }
+    outputs.insert({output, values.at(net_value)});
+  }
+  return outputs;
+}
+
 template <typename EvalT>
 absl::StatusOr<AbstractNetRef2Value<EvalT>>
 AbstractInterpreter<EvalT>::InterpretCell(
     const rtl::AbstractCell<EvalT>* cell,
-    const AbstractNetRef2Value<EvalT>& inputs) {
+    const AbstractNetRef2Value<EvalT>& inputs, bool levelized) {
   const AbstractCellLibraryEntry<EvalT>* entry = cell->cell_library_entry();
   std::optional<const rtl::AbstractModule<EvalT>*> opt_module =
       netlist_->MaybeGetModule(entry->name());
@@ -437,7 +675,9 @@ AbstractInterpreter<EvalT>::InterpretCell(
     }
 
     XLS_ASSIGN_OR_RETURN(AbstractNetRef2Value<EvalT> child_outputs,
-                         InterpretModule(module, module_inputs));
+                         levelized
+                             ? InterpretModuleLevelized(module, module_inputs)
+                             : InterpretModule(module, module_inputs));
     // We need to do the same here - map the AbstractNetRefs in the module's
     // output to the AbstractNetRefs in this module, using pin names as the
     // matching keys.
@@ -460,7 +700,6 @@ AbstractInterpreter<EvalT>::InterpretCell(
     return results;
   }
 
-  const auto& pins = entry->output_pin_to_function();
   for (int i = 0; i < cell->outputs().size(); i++) {
     if (cell->outputs()[i].eval != nullptr) {
       // The order of values in cell->inputs() is the same as the order of
@@ -474,9 +713,10 @@ AbstractInterpreter<EvalT>::InterpretCell(
       results.insert({cell->outputs()[i].netref, value});
     } else {
       XLS_ASSIGN_OR_RETURN(
-          function::Ast ast,
-          function::Parser::ParseFunction(pins.at(cell->outputs()[i].name)));
-      XLS_ASSIGN_OR_RETURN(EvalT value, InterpretFunction(*cell, ast, inputs));
+          const function::CompiledFunction* function,
+          entry->GetCompiledFunction(cell->outputs()[i].name));
+      XLS_ASSIGN_OR_RETURN(EvalT value,
+                           InterpretFunction(*cell, *function, inputs));
       results.insert({cell->outputs()[i].netref, value});
     }
   }
@@ -514,68 +754,21 @@ absl::Status AbstractInterpreter<EvalT>::ThreadBody() {
 
 template <typename EvalT>
 absl::StatusOr<EvalT> AbstractInterpreter<EvalT>::InterpretFunction(
-    const rtl::AbstractCell<EvalT>& cell, const function::Ast& ast,
+    const rtl::AbstractCell<EvalT>& cell,
+    const function::CompiledFunction& function,
     const AbstractNetRef2Value<EvalT>& inputs) {
-  switch (ast.kind()) {
-    case function::Ast::Kind::kAnd: {
-      XLS_ASSIGN_OR_RETURN(EvalT lhs,
-                           InterpretFunction(cell, ast.children()[0], inputs));
-      XLS_ASSIGN_OR_RETURN(EvalT rhs,
-                           InterpretFunction(cell, ast.children()[1], inputs));
-      return lhs & rhs;
-    }
-    case function::Ast::Kind::kIdentifier: {
-      rtl::AbstractNetRef<EvalT> ref = nullptr;
-      for (const auto& input : cell.inputs()) {
-        if (input.name == ast.name()) {
-          ref = input.netref;
-        }
-      }
-
-      if (ref == nullptr) {
-        for (const auto& internal : cell.internal_pins()) {
-          if (internal.name == ast.name()) {
-            return InterpretStateTable(cell, internal.name, inputs);
-          }
-        }
-      }
-
-      if (ref == nullptr) {
-        return absl::NotFoundError(
-            absl::StrFormat("Identifier \"%s\" not found in cell %s's inputs "
-                            "or internal signals.",
-                            ast.name(), cell.name()));
-      }
-
-      return inputs.at(ref);
-    }
-    case function::Ast::Kind::kLiteralOne:
-      return one_;
-    case function::Ast::Kind::kLiteralZero:
-      return zero_;
-    case function::Ast::Kind::kNot: {
-      XLS_ASSIGN_OR_RETURN(EvalT value,
-                           InterpretFunction(cell, ast.children()[0], inputs));
-      return !value;
-    }
-    case function::Ast::Kind::kOr: {
-      XLS_ASSIGN_OR_RETURN(EvalT lhs,
-                           InterpretFunction(cell, ast.children()[0], inputs));
-      XLS_ASSIGN_OR_RETURN(EvalT rhs,
-                           InterpretFunction(cell, ast.children()[1], inputs));
-      return lhs | rhs;
-    }
-    case function::Ast::Kind::kXor: {
-      XLS_ASSIGN_OR_RETURN(EvalT lhs,
-                           InterpretFunction(cell, ast.children()[0], inputs));
-      XLS_ASSIGN_OR_RETURN(EvalT rhs,
-                           InterpretFunction(cell, ast.children()[1], inputs));
-      return lhs ^ rhs;
+  auto input = [&](int64_t i) -> const EvalT& {
+    return inputs.at(cell.inputs()[i].netref);
+  };
+  if constexpr (std::is_same_v<EvalT, bool>) {
+    if (function.truth_table().has_value()) {
+      return function.EvaluateTruthTable(cell.inputs().size(), input);
     }
-    default:
-      return absl::InvalidArgumentError(
-          absl::StrCat("Unknown AST element type: ", ast.kind()));
   }
+  return function.Evaluate(
+      zero_, one_, input, [&](const std::string& name) {
+        return InterpretStateTable(cell, name, inputs);
+      });
 }
 
 template <typename EvalT>
@@ -14,14 +14,18 @@
 #include "xls/netlist/interpreter.h"
 
 #include <atomic>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "xls/common/status/matchers.h"
@@ -220,6 +224,56 @@ endmodule
 
   EXPECT_EQ(outputs.size(), 1);
   EXPECT_EQ(outputs[module->outputs()[0]], 1);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      outputs, interpreter.InterpretModuleLevelized(module, inputs));
+  EXPECT_EQ(outputs.size(), 1);
+  EXPECT_EQ(outputs[module->outputs()[0]], 1);
+}
+
+TEST(InterpreterTest, LevelizedWideNetlist) {
+  // Two levels of kCells cells each, wide enough to be split into chunks.
+  constexpr int64_t kCells = 3 * Interpreter::kLevelizedChunkSize + 1;
+  std::vector<std::string> ports;
+  std::string declarations;
+  std::string cells;
+  for (int64_t i = 0; i < kCells; ++i) {
+    ports.push_back(absl::StrFormat("a%d, b%d, o%d", i, i, i));
+    absl::StrAppendFormat(&declarations,
+                          "  input a%d, b%d;\n  output o%d;\n  wire w%d;\n", i,
+                          i, i, i);
+    absl::StrAppendFormat(&cells,
+                          "  AND and%d( .A(a%d), .B(b%d), .Z(w%d) );\n"
+                          "  XOR xor%d( .A(w%d), .B(a%d), .Z(o%d) );\n",
+                          i, i, i, i, i, i, i, i);
+  }
+  std::string module_text =
+      absl::StrFormat("module wide (%s);\n%s%sendmodule\n",
+                      absl::StrJoin(ports, ", "), declarations, cells);
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("wide"));
+
+  NetRef2Value inputs;
+  for (int64_t i = 0; i < module->inputs().size(); ++i) {
+    inputs[module->inputs()[i]] = (i % 3) == 0;
+  }
+  Interpreter interpreter(netlist.get(), /*zero=*/false, /*one=*/true,
+                          /*num_threads=*/4);
+  XLS_ASSERT_OK_AND_ASSIGN(NetRef2Value expected,
+                           interpreter.InterpretModule(module, inputs));
+  ASSERT_EQ(expected.size(), kCells);
+  // The second call reuses the cached schedule.
+  for (int64_t i = 0; i < 2; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        NetRef2Value outputs,
+        interpreter.InterpretModuleLevelized(module, inputs));
+    EXPECT_EQ(outputs, expected);
+  }
 }
 
 // Verifies that a [combinational] StateTable can be correctly interpreted in a
@@ -413,7 +467,8 @@ template <typename ValueT>
 static void TestXorUsing(
     const std::string& cell_definitions, std::function<bool(ValueT)> eval,
     const xls::netlist::rtl::CellToOutputEvalFns<ValueT>& eval_fns,
-    const ValueT kFalse, const ValueT kTrue, size_t num_threads = 0) {
+    const ValueT kFalse, const ValueT kTrue, size_t num_threads = 0,
+    bool levelized = false) {
   rtl::Scanner scanner(netlist_src);
   XLS_ASSERT_OK_AND_ASSIGN(
       auto stream,
@@ -437,12 +492,14 @@ static void TestXorUsing(
   xls::netlist::AbstractInterpreter<ValueT> interpreter(n.get(), kFalse, kTrue,
                                                         num_threads);
 
-  auto test_xor = [&m, &interpreter, &eval](const ValueT& a, const ValueT& b,
-                                            const ValueT& y) {
+  auto test_xor = [&m, &interpreter, &eval, levelized](
+                      const ValueT& a, const ValueT& b, const ValueT& y) {
     AbstractNetRef2Value<ValueT> inputs, outputs;
     inputs.emplace(m->inputs()[0], a);
     inputs.emplace(m->inputs()[1], b);
-    XLS_ASSERT_OK_AND_ASSIGN(outputs, interpreter.InterpretModule(m, inputs));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        outputs, levelized ? interpreter.InterpretModuleLevelized(m, inputs)
+                           : interpreter.InterpretModule(m, inputs));
     EXPECT_EQ(outputs.size(), 1);
     EXPECT_EQ(eval(outputs.at(m->outputs()[0])), eval(y));
   };
@@ -465,6 +522,12 @@ TEST(NetlistParserTest, XorUsingCellFunctions) {
       true);
 }
 
+TEST(NetlistParserTest, XorUsingCellFunctionsLevelized) {
+  TestXorUsing<bool>(
+      std::string(liberty_src), [](bool x) -> bool { return x; }, {}, false,
+      true, /*num_threads=*/0, /*levelized=*/true);
+}
+
 class OpaqueBoolValue {
  public:
   OpaqueBoolValue(const OpaqueBoolValue& rhs)  = default;
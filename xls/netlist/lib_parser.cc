@@ -14,7 +14,7 @@
 
 #include "xls/netlist/lib_parser.h"
 
-#include <fstream>
+#include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <string>
@@ -24,7 +24,9 @@
 
 #include "absl/status/statusor.h"
 #include "absl/strings/str_join.h"
+#include "xls/common/file/memory_mapped_file.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
 
 namespace xls {
 namespace netlist {
@@ -32,12 +34,9 @@ namespace cell_lib {
 
 /* static */ absl::StatusOr<CharStream> CharStream::FromPath(
     std::string_view path) {
-  std::ifstream file_stream{std::string(path)};
-  if (file_stream.is_open()) {
-    return CharStream(std::move(file_stream));
-  }
-  return absl::NotFoundError(
-      absl::StrCat("Could not open file at path: ", path));
+  XLS_ASSIGN_OR_RETURN(MemoryMappedFile mapped_file,
+                       MemoryMappedFile::Open(std::filesystem::path(path)));
+  return CharStream(std::move(mapped_file));
 }
 
 /* static */ absl::StatusOr<CharStream> CharStream::FromText(std::string text) {
@@ -73,52 +72,76 @@ std::string TokenKindToString(TokenKind kind) {
 absl::StatusOr<Token> Scanner::ScanIdentifier() {
   const Pos start_pos = cs_->GetPos();
   XLS_CHECK(IsIdentifierStart(cs_->PeekCharOrDie()));
-  absl::InlinedVector<char, 16> chars;
-  while (!cs_->AtEof() && IsIdentifierRest(cs_->PeekCharOrDie())) {
-    chars.push_back(cs_->PopCharOrDie());
-  }
-  return Token::Identifier(
-      start_pos, std::string(std::string_view(chars.data(), chars.size())));
+  return Token::Identifier(start_pos,
+                           std::string(cs_->PopCharsWhile(IsIdentifierRest)));
 }
 
 // Scans a number token.
 absl::StatusOr<Token> Scanner::ScanNumber() {
   const Pos start_pos = cs_->GetPos();
   XLS_CHECK(std::isdigit(cs_->PeekCharOrDie()) != 0);
-  absl::InlinedVector<char, 16> chars;
-  while (!cs_->AtEof()) {
-    if (IsNumberRest(cs_->PeekCharOrDie())) {
-      chars.push_back(cs_->PopCharOrDie());
-    } else if (cs_->TryDropChars('e', '-')) {
-      chars.push_back('e');
-      chars.push_back('-');
-    } else {
-      break;
-    }
-  }
-  return Token::Number(
-      start_pos, std::string(std::string_view(chars.data(), chars.size())));
+  // Exponents such as "e-10" are covered as 'e' and '-' are number characters.
+  return Token::Number(start_pos,
+                       std::string(cs_->PopCharsWhile(IsNumberRest)));
 }
 
 // Scans a string token.
 absl::StatusOr<Token> Scanner::ScanQuotedString() {
   const Pos start_pos = cs_->GetPos();
   XLS_CHECK(cs_->TryDropChar('"'));
-  absl::InlinedVector<char, 16> chars;
-  while (true) {
+  std::string_view chars = cs_->PopCharsWhile([](char c) { return c != '"'; });
+  if (!cs_->TryDropChar('"')) {
+    return absl::InvalidArgumentError(
+        "Unexpected end-of-file in string token starting @ " +
+        start_pos.ToHumanString());
+  }
+  return Token::QuotedString(start_pos, std::string(chars));
+}
+
+absl::Status Scanner::DropBlockBody() {
+  XLS_RET_CHECK(!lookahead_.has_value());
+  const Pos start_pos = cs_->GetPos();
+  int64_t depth = 1;
+  while (depth > 0) {
+    cs_->PopCharsWhile(
+        [](char c) { return c != '{' && c != '}' && c != '"' && c != '/'; });
     if (cs_->AtEof()) {
       return absl::InvalidArgumentError(
-          "Unexpected end-of-file in string token starting @ " +
+          "Unexpected end-of-file in block starting @ " +
           start_pos.ToHumanString());
     }
-    char c = cs_->PopCharOrDie();
-    if (c == '"') {
-      break;
+    if (cs_->TryDropChars('/', '*')) {
+      while (!cs_->AtEof() && !cs_->TryDropChars('*', '/')) {
+        cs_->DropCharOrDie();
+      }
+      continue;
+    }
+    if (cs_->TryDropChars('/', '/')) {
+      cs_->PopCharsWhile([](char c) { return c != '\n'; });
+      continue;
+    }
+    switch (cs_->PopCharOrDie()) {
+      case '"':
+        cs_->PopCharsWhile([](char c) { return c != '"'; });
+        if (!cs_->TryDropChar('"')) {
+          return absl::InvalidArgumentError(
+              "Unexpected end-of-file in string in block starting @ " +
+              start_pos.ToHumanString());
+        }
+        break;
+      case '{':
+        ++depth;
+        break;
+      case '}':
+        --depth;
+        break;
+      default:
+        // A lone '/'.
+        break;
     }
-    chars.push_back(c);
   }
-  return Token::QuotedString(
-      start_pos, std::string(std::string_view(chars.data(), chars.size())));
+  DropWhitespaceAndComments();
+  return absl::OkStatus();
 }
 
 absl::Status Scanner::PeekInternal() {
@@ -382,11 +405,13 @@ absl::StatusOr<std::unique_ptr<Block>> Parser::ParseBlock(
     }
   }
 
-  XLS_ASSIGN_OR_RETURN(block->entries, ParseEntries());
   if (!kind_allowed) {
-    // Save memory on disallowed blocks by clearing out its entries.
-    block->entries.clear();
+    // Save time and memory on disallowed blocks by skipping their entries.
+    XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kOpenCurl));
+    XLS_RETURN_IF_ERROR(scanner_->DropBlockBody());
+    return block;
   }
+  XLS_ASSIGN_OR_RETURN(block->entries, ParseEntries());
   return block;
 }
 
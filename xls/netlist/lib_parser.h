@@ -21,7 +21,7 @@
 #define XLS_NETLIST_LIB_PARSER_H_
 
 #include <cctype>
-#include <fstream>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -34,6 +34,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "xls/common/file/memory_mapped_file.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 
@@ -52,34 +53,27 @@ struct Pos {
 };
 
 // Wraps a file as a character stream with a 1- or 2-character lookahead
-// interface.
+// interface. Files are memory-mapped rather than read, so even very large
+// libraries are scanned without copying them into memory.
 class CharStream {
  public:
   static absl::StatusOr<CharStream> FromPath(std::string_view path);
   static absl::StatusOr<CharStream> FromText(std::string text);
 
-  ~CharStream() {
-    if (if_.has_value()) {
-      if_->close();
-    }
+  CharStream(CharStream&& other)
+      : pos_(other.pos_),
+        mapped_file_(std::move(other.mapped_file_)),
+        text_(std::move(other.text_)),
+        cursor_(other.cursor_),
+        last_colno_(other.last_colno_) {
+    UpdateContents();
   }
 
-  CharStream(CharStream&& other) = default;
-
   Pos GetPos() const { return pos_; }
-  bool AtEof() const {
-    if (if_.has_value()) {
-      return if_->eof();
-    }
-    return cursor_ >= text_.size();
-  }
+  bool AtEof() const { return cursor_ >= contents_.size(); }
   char PeekCharOrDie() {
-    if (if_.has_value()) {
-      XLS_DCHECK(!if_->eof());
-      return if_->peek();
-    }
-    XLS_DCHECK_LT(cursor_, text_.size());
-    return text_[cursor_];
+    XLS_DCHECK_LT(cursor_, contents_.size());
+    return contents_[cursor_];
   }
   char PopCharOrDie() {
     char c = PeekCharOrDie();
@@ -88,6 +82,17 @@ class CharStream {
   }
   void DropCharOrDie() { (void)PopCharOrDie(); }
 
+  // Pops the longest run of characters satisfying `pred` and returns it. The
+  // returned view is valid for the lifetime of the stream.
+  template <typename Pred>
+  std::string_view PopCharsWhile(Pred pred) {
+    const int64_t start = cursor_;
+    while (cursor_ < contents_.size() && pred(contents_[cursor_])) {
+      BumpPos(contents_[cursor_]);
+    }
+    return contents_.substr(start, cursor_ - start);
+  }
+
   // Attempts to drop character "c" from the character stream and returns true
   // if it can.
   bool TryDropChar(char c) {
@@ -115,9 +120,20 @@ class CharStream {
   }
 
  private:
-  explicit CharStream(std::ifstream file_stream)
-      : if_(std::move(file_stream)) {}
-  explicit CharStream(std::string text) : text_(std::move(text)) {}
+  explicit CharStream(MemoryMappedFile mapped_file)
+      : mapped_file_(std::move(mapped_file)) {
+    UpdateContents();
+  }
+  explicit CharStream(std::string text) : text_(std::move(text)) {
+    UpdateContents();
+  }
+
+  // Points `contents_` at the characters of the stream, which the stream owns
+  // either as a mapped file or as text.
+  void UpdateContents() {
+    contents_ = mapped_file_.has_value() ? mapped_file_->contents()
+                                         : std::string_view(text_);
+  }
 
   void Unget(char c) {
     cursor_--;
@@ -127,9 +143,6 @@ class CharStream {
     } else {
       pos_.colno--;
     }
-    if (if_.has_value()) {
-      if_->unget();
-    }
   }
 
   void BumpPos(char c) {
@@ -145,13 +158,11 @@ class CharStream {
 
   Pos pos_ = {0, 0};
 
-  // We have both ifstream mode and text mode data, we store both inline.
-
-  // ifstream mode
-  std::optional<std::ifstream> if_;
-
-  // text mode
+  // The stream is backed by either a mapped file or text held by the stream.
+  std::optional<MemoryMappedFile> mapped_file_;
   std::string text_;
+  std::string_view contents_;
+
   int64_t cursor_ = 0;
   int64_t last_colno_ = 0;
 };
@@ -223,6 +234,11 @@ class Scanner {
 
   bool AtEof() const { return !lookahead_.has_value() && cs_->AtEof(); }
 
+  // Drops the rest of a block whose opening curly brace was just popped, up to
+  // and including the matching closing curly brace, without scanning it into
+  // tokens. Braces within quoted strings and comments are not counted.
+  absl::Status DropBlockBody();
+
   Pos GetPos() {
     if (lookahead_.has_value()) {
       return lookahead_.value().pos();
@@ -397,12 +413,13 @@ class Parser {
   Scanner* scanner_;
 
   // Optional allowlist of keys (including block kinds) that we're interested in
-  // keeping in the result data structure. "Denied" (non-allowed) block kinds
-  // are still parsed properly, but then may have incomplete data (or not be
-  // present at all) in the resulting data structure.
+  // keeping in the result data structure. The entries of "denied" (non-allowed)
+  // block kinds are skipped without being parsed (only their braces must
+  // balance), so such blocks are present in the resulting data structure but
+  // empty.
   //
-  // This is very useful for minimizing memory usage when we're interested in
-  // just a subset of particular fields, e.g. as part of a query.
+  // This is very useful for minimizing time and memory usage when we're
+  // interested in just a subset of particular fields, e.g. as part of a query.
   std::optional<absl::flat_hash_set<std::string>> kind_allowlist_;
 };
 
@@ -14,6 +14,7 @@
 
 #include "xls/netlist/lib_parser.h"
 
+#include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <string>
@@ -21,7 +22,10 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/status/matchers.h"
 
 namespace xls {
@@ -29,6 +33,9 @@ namespace netlist {
 namespace cell_lib {
 namespace {
 
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
 TEST(LibParserTest, ScanSimple) {
   std::string text = "{}()";
   XLS_ASSERT_OK_AND_ASSIGN(auto cs, CharStream::FromText(text));
@@ -162,6 +169,59 @@ library (foo) {
             "))");
 }
 
+TEST(LibParserTest, AllowlistSkipsBracesInStringsAndComments) {
+  std::string text = R"(
+library (foo) {
+  foo () {
+    foo_key: "}}";
+    /* } */
+    // }
+    nested () { a: "{"; }
+  }
+  bar () {
+    bar_key: bar_value;
+  }
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Block> library,
+      Parse(text, absl::flat_hash_set<std::string>{"library", "bar"}));
+  EXPECT_EQ(library->ToString(),
+            "(block library (foo) ("
+            "(block foo () ()) "
+            "(block bar () ((bar_key \"bar_value\")))"
+            "))");
+}
+
+TEST(LibParserTest, AllowlistUnterminatedBlock) {
+  EXPECT_THAT(Parse("library (foo) { foo () { a: b; ",
+                    absl::flat_hash_set<std::string>{"library"})
+                  .status(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("end-of-file in block")));
+}
+
+TEST(LibParserTest, ParseFromPath) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "test.lib";
+  XLS_ASSERT_OK(SetFileContents(path, R"(library (foo) {
+  cell (and2) {
+    area: 1.0e-3;
+  }
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(CharStream cs, CharStream::FromPath(path.string()));
+  Scanner scanner(&cs);
+  Parser parser(&scanner);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Block> library,
+                           parser.ParseLibrary());
+  EXPECT_EQ(library->ToString(),
+            "(block library (foo) ((block cell (and2) ((area \"1.0e-3\")))))");
+  EXPECT_THAT(CharStream::FromPath((temp_dir.path() / "missing.lib").string())
+                  .status(),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
 }  // namespace
 }  // namespace cell_lib
 }  // namespace netlist
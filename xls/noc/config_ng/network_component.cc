@@ -36,9 +36,22 @@ NetworkComponentPort& NetworkComponent::AddPort(const PortType port_type,
   // Using `new` to access a non-public constructor.
   ports_.push_back(
       absl::WrapUnique(new NetworkComponentPort(this, port_type, direction)));
+  ports_.back()->id_ = ports_.size() - 1;
   return (*ports_.back());
 }
 
+NetworkComponentPort& NetworkComponent::GetPort(const int64_t id) const {
+  XLS_CHECK_GE(id, 0);
+  XLS_CHECK_LT(id, GetPortCount());
+  return *ports_[id];
+}
+
+void NetworkComponent::ReservePorts(const int64_t port_count) {
+  ports_.reserve(port_count);
+}
+
+int64_t NetworkComponent::GetId() const { return id_; }
+
 xabsl::iterator_range<UnwrappingIterator<
     std::vector<std::unique_ptr<NetworkComponentPort>>::iterator>>
 NetworkComponent::ports() {
@@ -72,6 +72,18 @@ class NetworkComponent {
   // Returns the number of ports.
   int64_t GetPortCount() const;
 
+  // Returns the port with the given id. The ids of the ports of a component are
+  // dense: the i-th port added to the component has id i.
+  NetworkComponentPort& GetPort(int64_t id) const;
+
+  // Reserves storage for `port_count` ports in total, e.g. before adding many
+  // ports in bulk.
+  void ReservePorts(int64_t port_count);
+
+  // Returns the id of the component in its view. The ids of the components of
+  // a view are dense: the i-th component added to the view has id i.
+  int64_t GetId() const;
+
   // Sets the name of the component.
   void SetName(std::string name);
 
@@ -90,9 +102,13 @@ class NetworkComponent {
   explicit NetworkComponent(NetworkView* network_view);
 
  private:
+  // The id is assigned by the network view when the component is added.
+  friend class NetworkView;
+
   std::vector<std::unique_ptr<NetworkComponentPort>> ports_;
   NetworkView& network_view_;
   std::string name_;
+  int64_t id_ = -1;
 };
 
 }  // namespace xls::noc
@@ -62,4 +62,6 @@ NetworkComponentPort::GetConnections() const {
   return connections_;
 }
 
+int64_t NetworkComponentPort::GetId() const { return id_; }
+
 }  // namespace xls::noc
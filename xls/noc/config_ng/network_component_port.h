@@ -15,6 +15,8 @@
 #ifndef XLS_NOC_CONFIG_NETWORK_COMPONENT_PORT_H_
 #define XLS_NOC_CONFIG_NETWORK_COMPONENT_PORT_H_
 
+#include <cstdint>
+
 #include "absl/container/flat_hash_set.h"
 
 namespace xls::noc {
@@ -70,6 +72,9 @@ class NetworkComponentPort final {
   // Gets the connections. The objects are guaranteed to be non-null.
   const absl::flat_hash_set<const NetworkConnection*>& GetConnections() const;
 
+  // Gets the id of the port in its component. See NetworkComponent::GetPort.
+  int64_t GetId() const;
+
  private:
   // The private constructor is accessed by the network component.
   friend class NetworkComponent;
@@ -99,6 +104,8 @@ class NetworkComponentPort final {
   // TODO(vmirian) 02-05-21 make data and control port
   PortType type_;
   PortDirection direction_;
+  // Assigned by the network component when the port is added.
+  int64_t id_ = -1;
 };
 
 }  // namespace xls::noc
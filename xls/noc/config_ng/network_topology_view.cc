@@ -14,6 +14,11 @@
 
 #include "xls/noc/config_ng/network_topology_view.h"
 
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/noc/config_ng/network_view_utils.h"
 
@@ -35,6 +40,11 @@ ChannelTopologyComponent& NetworkTopologyView::AddChannel() {
   return AddComponent<ChannelTopologyComponent>();
 }
 
+std::vector<RouterTopologyComponent*> NetworkTopologyView::AddRouters(
+    const int64_t count) {
+  return AddComponents<RouterTopologyComponent>(count);
+}
+
 int64_t NetworkTopologyView::GetSendPortCount() const {
   return GetCount<SendPortTopologyComponent>();
 }
@@ -77,6 +87,31 @@ NetworkTopologyView::ConnectThroughChannel(NetworkComponent& source,
   return &channel;
 }
 
+absl::StatusOr<std::vector<ChannelTopologyComponent*>>
+NetworkTopologyView::ConnectThroughChannels(
+    absl::Span<const std::pair<NetworkComponent*, NetworkComponent*>>
+        source_sink_pairs) {
+  for (const auto& [source, sink] : source_sink_pairs) {
+    if (source == nullptr || sink == nullptr) {
+      return absl::FailedPreconditionError("source or sink component is null.");
+    }
+    if (&source->GetNetworkView() != this || &sink->GetNetworkView() != this) {
+      return absl::FailedPreconditionError(
+          "source or sink component is from a different view.");
+    }
+  }
+  ReserveComponents(GetComponentCount() + source_sink_pairs.size());
+  ReserveConnections(GetConnectionCount() + 2 * source_sink_pairs.size());
+  std::vector<ChannelTopologyComponent*> channels;
+  channels.reserve(source_sink_pairs.size());
+  for (const auto& [source, sink] : source_sink_pairs) {
+    XLS_ASSIGN_OR_RETURN(ChannelTopologyComponent * channel,
+                         ConnectThroughChannel(*source, *sink));
+    channels.push_back(channel);
+  }
+  return channels;
+}
+
 absl::StatusOr<RouterTopologyComponent*> NetworkTopologyView::AddRouter(
     int64_t send_port_count, int64_t recv_port_count) {
   RouterTopologyComponent& router = this->AddRouter();
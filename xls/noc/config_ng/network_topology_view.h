@@ -15,9 +15,12 @@
 #ifndef XLS_NOC_CONFIG_NETWORK_TOPOLOGY_VIEW_H_
 #define XLS_NOC_CONFIG_NETWORK_TOPOLOGY_VIEW_H_
 
+#include <cstdint>
+#include <utility>
 #include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/noc/config_ng/network_topology_component.h"
 #include "xls/noc/config_ng/network_view.h"
 
@@ -42,6 +45,9 @@ class NetworkTopologyView final : public NetworkView {
   // See xls::noc::NetworkView::AddComponent.
   ChannelTopologyComponent& AddChannel();
 
+  // Adds `count` routers. See xls::noc::NetworkView::AddComponents.
+  std::vector<RouterTopologyComponent*> AddRouters(int64_t count);
+
   int64_t GetSendPortCount() const;
 
   int64_t GetReceivePortCount() const;
@@ -60,6 +66,18 @@ class NetworkTopologyView final : public NetworkView {
   absl::StatusOr<ChannelTopologyComponent*> ConnectThroughChannel(
       NetworkComponent& source, NetworkComponent& sink);
 
+  // Connects the source network component to the sink network component of each
+  // pair using a new channel, as ConnectThroughChannel. Storage for the
+  // channels and connections is reserved up front, so this is the preferred
+  // way to build large topologies (e.g. the links of a mesh). All pairs are
+  // checked before any is connected.
+  //
+  // Returns the newly created channels in the order of the pairs on success.
+  // Otherwise, returns an absl::FailedPreconditionError.
+  absl::StatusOr<std::vector<ChannelTopologyComponent*>> ConnectThroughChannels(
+      absl::Span<const std::pair<NetworkComponent*, NetworkComponent*>>
+          source_sink_pairs);
+
   // TODO(vmirian) 02-05-2021 return send ports, receive ports and channels
   // Adds a router to the view and connects the router to send ports
   // and receive ports through channels.
@@ -14,8 +14,16 @@
 
 #include "xls/noc/config_ng/network_topology_view.h"
 
+#include <cstdint>
+#include <utility>
+#include <vector>
+
 #include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "benchmark/benchmark.h"
+#include "xls/common/logging/logging.h"
 #include "xls/common/status/matchers.h"
+#include "xls/noc/config_ng/network_view_utils.h"
 
 namespace xls::noc {
 namespace {
@@ -118,5 +126,83 @@ TEST(NetworkTopologyViewTest, ConnectComponentToReceivePort) {
   EXPECT_EQ(view.GetConnectionCount(), 6);
 }
 
+// Test ConnectThroughChannels function for network topology view.
+TEST(NetworkTopologyViewTest, ConnectThroughChannels) {
+  NetworkTopologyView view;
+  std::vector<RouterTopologyComponent*> routers = view.AddRouters(3);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<ChannelTopologyComponent*> channels,
+      view.ConnectThroughChannels({{routers[0], routers[1]},
+                                   {routers[1], routers[2]},
+                                   {routers[2], routers[0]}}));
+  EXPECT_EQ(channels.size(), 3);
+  EXPECT_EQ(view.GetRouterCount(), 3);
+  EXPECT_EQ(view.GetChannelCount(), 3);
+  EXPECT_EQ(view.GetConnectionCount(), 6);
+  EXPECT_EQ(routers[1]->GetPortCount(), 2);
+  XLS_EXPECT_OK(ValidateNetworkView(view));
+
+  // A component from another view is rejected before anything is connected.
+  NetworkTopologyView other_view;
+  EXPECT_FALSE(
+      view.ConnectThroughChannels(
+              {{routers[0], routers[1]}, {routers[0], &other_view.AddRouter()}})
+          .ok());
+  EXPECT_EQ(view.GetChannelCount(), 3);
+}
+
+// Builds a `side` x `side` mesh of routers, each with a send port and a receive
+// port, with a pair of channels between neighboring routers.
+absl::Status BuildMesh(int64_t side, NetworkTopologyView& view) {
+  std::vector<RouterTopologyComponent*> routers = view.AddRouters(side * side);
+  std::vector<std::pair<NetworkComponent*, NetworkComponent*>> links;
+  std::vector<SendPortTopologyComponent*> send_ports =
+      view.AddComponents<SendPortTopologyComponent>(routers.size());
+  std::vector<ReceivePortTopologyComponent*> recv_ports =
+      view.AddComponents<ReceivePortTopologyComponent>(routers.size());
+  for (int64_t i = 0; i < routers.size(); ++i) {
+    links.push_back({send_ports[i], routers[i]});
+    links.push_back({routers[i], recv_ports[i]});
+  }
+  for (int64_t y = 0; y < side; ++y) {
+    for (int64_t x = 0; x < side; ++x) {
+      RouterTopologyComponent* router = routers[y * side + x];
+      if (x + 1 < side) {
+        links.push_back({router, routers[y * side + x + 1]});
+        links.push_back({routers[y * side + x + 1], router});
+      }
+      if (y + 1 < side) {
+        links.push_back({router, routers[(y + 1) * side + x]});
+        links.push_back({routers[(y + 1) * side + x], router});
+      }
+    }
+  }
+  return view.ConnectThroughChannels(links).status();
+}
+
+TEST(NetworkTopologyViewTest, Mesh) {
+  NetworkTopologyView view;
+  XLS_ASSERT_OK(BuildMesh(8, view));
+  EXPECT_EQ(view.GetRouterCount(), 64);
+  EXPECT_EQ(view.GetSendPortCount(), 64);
+  EXPECT_EQ(view.GetReceivePortCount(), 64);
+  // Two channels per router for the endpoints and two per mesh link.
+  EXPECT_EQ(view.GetChannelCount(), 2 * 64 + 2 * 2 * 8 * 7);
+  XLS_EXPECT_OK(ValidateNetworkView(view));
+}
+
+void BM_BuildMesh(benchmark::State& state) {
+  for (auto _ : state) {
+    NetworkTopologyView view;
+    XLS_CHECK_OK(BuildMesh(state.range(0), view));
+    XLS_CHECK_OK(ValidateNetworkView(view));
+    benchmark::DoNotOptimize(view.GetRouterCount());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) *
+                          state.range(0));
+}
+// Up to a 128x128 mesh, i.e. 16K routers.
+BENCHMARK(BM_BuildMesh)->RangeMultiplier(2)->Range(8, 128);
+
 }  // namespace
 }  // namespace xls::noc
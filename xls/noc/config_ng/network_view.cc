@@ -14,9 +14,12 @@
 
 #include "xls/noc/config_ng/network_view.h"
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 
+#include "xls/common/logging/logging.h"
+
 namespace xls::noc {
 
 xabsl::iterator_range<UnwrappingIterator<
@@ -34,6 +37,20 @@ NetworkView::components() const {
 
 int64_t NetworkView::GetComponentCount() const { return components_.size(); }
 
+NetworkComponent& NetworkView::GetComponent(const int64_t id) const {
+  XLS_CHECK_GE(id, 0);
+  XLS_CHECK_LT(id, GetComponentCount());
+  return *components_[id];
+}
+
+void NetworkView::ReserveComponents(const int64_t component_count) {
+  components_.reserve(component_count);
+}
+
+void NetworkView::ReserveConnections(const int64_t connection_count) {
+  connections_.reserve(connection_count);
+}
+
 NetworkConnection& NetworkView::AddConnection() {
   // Using `new` to access a non-public constructor.
   connections_.emplace_back(absl::WrapUnique(new NetworkConnection(this)));
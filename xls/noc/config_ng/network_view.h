@@ -15,9 +15,13 @@
 #ifndef XLS_NOC_CONFIG_NETWORK_VIEW_H_
 #define XLS_NOC_CONFIG_NETWORK_VIEW_H_
 
+#include <cstdint>
 #include <memory>
+#include <typeindex>
+#include <typeinfo>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "xls/noc/config_ng/network_component.h"
 #include "xls/noc/config_ng/network_connection.h"
 
@@ -42,24 +46,46 @@ class NetworkView {
     static_assert(std::is_base_of<NetworkComponent, Type>::value,
                   "Type is not a Network Component subclass");
     components_.emplace_back(std::make_unique<Type>(this));
+    components_.back()->id_ = components_.size() - 1;
+    ++component_counts_[std::type_index(typeid(Type))];
     return static_cast<Type&>(*components_.back());
   }
 
+  // Adds `count` components of the type specified by the template to the view,
+  // as AddComponent, and returns them in order of addition. Storage is
+  // reserved up front, so building large views in bulk does not repeatedly
+  // grow the component list.
+  template <typename Type>
+  std::vector<Type*> AddComponents(int64_t count) {
+    ReserveComponents(components_.size() + count);
+    std::vector<Type*> components;
+    components.reserve(count);
+    for (int64_t i = 0; i < count; ++i) {
+      components.push_back(&AddComponent<Type>());
+    }
+    return components;
+  }
+
   // Counts the number of a components of the type specified by the template.
   // The component type must be a network component base class or derived class.
+  // Only components of exactly that type are counted. Takes constant time.
   template <typename Type>
   int64_t GetCount() const {
     static_assert(std::is_base_of<NetworkComponent, Type>::value,
                   "Type is not a Network Component subclass");
-    int64_t count = 0;
-    for (const NetworkComponent* component : components()) {
-      if (typeid(*component) == typeid(Type)) {
-        count++;
-      }
-    }
-    return count;
+    auto it = component_counts_.find(std::type_index(typeid(Type)));
+    return it == component_counts_.end() ? 0 : it->second;
   }
 
+  // Returns the component with the given id (see NetworkComponent::GetId).
+  NetworkComponent& GetComponent(int64_t id) const;
+
+  // Reserves storage for `component_count` components in total.
+  void ReserveComponents(int64_t component_count);
+
+  // Reserves storage for `connection_count` connections in total.
+  void ReserveConnections(int64_t connection_count);
+
   // Returns an iterator range for the components. The objects are guaranteed to
   // be non-null. Note that, when using the result of this function, if the view
   // is modified (e.g. a component is added), the returned result may become
@@ -97,6 +123,8 @@ class NetworkView {
  private:
   std::vector<std::unique_ptr<NetworkComponent>> components_;
   std::vector<std::unique_ptr<NetworkConnection>> connections_;
+  // The number of components of each (exact) component type.
+  absl::flat_hash_map<std::type_index, int64_t> component_counts_;
 };
 
 }  // namespace xls::noc
@@ -14,6 +14,9 @@
 
 #include "xls/noc/config_ng/network_view.h"
 
+#include <cstdint>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "xls/noc/config_ng/fake_network_component.h"
 
@@ -34,5 +37,27 @@ TEST(NetworkViewTest, MemberFunction) {
   EXPECT_EQ(*view.connections().begin(), &connection);
 }
 
+// Test the dense ids and bulk construction of a network view.
+TEST(NetworkViewTest, ComponentIds) {
+  NetworkView view;
+  std::vector<FakeNetworkComponent*> components =
+      view.AddComponents<FakeNetworkComponent>(3);
+  ASSERT_EQ(components.size(), 3);
+  EXPECT_EQ(view.GetComponentCount(), 3);
+  EXPECT_EQ(view.GetCount<FakeNetworkComponent>(), 3);
+  EXPECT_EQ(view.GetCount<NetworkComponent>(), 0);
+  for (int64_t id = 0; id < 3; ++id) {
+    EXPECT_EQ(components[id]->GetId(), id);
+    EXPECT_EQ(&view.GetComponent(id), components[id]);
+  }
+  NetworkComponentPort& port0 =
+      components[1]->AddPort(PortType::kData, PortDirection::kInput);
+  NetworkComponentPort& port1 =
+      components[1]->AddPort(PortType::kData, PortDirection::kOutput);
+  EXPECT_EQ(port0.GetId(), 0);
+  EXPECT_EQ(port1.GetId(), 1);
+  EXPECT_EQ(&components[1]->GetPort(1), &port1);
+}
+
 }  // namespace
 }  // namespace xls::noc
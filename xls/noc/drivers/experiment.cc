@@ -15,6 +15,8 @@
 #include "xls/noc/drivers/experiment.h"
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -22,6 +24,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/types/variant.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/thread.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/global_routing_table.h"
 #include "xls/noc/simulation/network_graph.h"
@@ -180,13 +183,19 @@ absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
   simulator.RegisterPreCycleService(injector_shim);
 
   NocSimulatorToLinkMonitorServiceShim link_monitor(simulator);
+  link_monitor.SetUtilizationWindow(link_utilization_window_);
   simulator.RegisterPostCycleService(link_monitor);
 
-  // Run simulation.
-  for (int64_t i = 0; i < total_simulation_cycle_count_; ++i) {
-    XLS_RET_CHECK_OK(simulator.RunCycle());
+  for (NetworkComponentId sink_id :
+       routing_table.GetSinkIndices().GetNetworkComponents()) {
+    XLS_ASSIGN_OR_RETURN(SimNetworkInterfaceSink * sink,
+                         simulator.GetSimNetworkInterfaceSink(sink_id));
+    sink->SetRecordReceivedTraffic(record_received_traffic_);
   }
 
+  // Run simulation.
+  XLS_RET_CHECK_OK(simulator.RunCycles(total_simulation_cycle_count_));
+
   // Obtain metrics.  For now, the runner will measure traffic rate
   // for each flow, and sink. It will also collect the latency metrics from the
   // sink.
@@ -228,7 +237,7 @@ absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
     metrics.SetFloatMetric(entry_name, traffic_rate);
 
     entry_name = absl::StrFormat("Sink:%s:FlitCount", nc_name);
-    metrics.SetIntegerMetric(entry_name, sink->GetReceivedTraffic().size());
+    metrics.SetIntegerMetric(entry_name, sink->GetReceivedFlitCount());
 
     // Per VC Metrics
     int64_t vc_count =
@@ -239,30 +248,33 @@ absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
       traffic_rate = sink->MeasuredTrafficRateInMiBps(cycle_time_in_ps_, vc);
       metrics.SetFloatMetric(entry_name, traffic_rate);
       // Latency stats
-      const internal::Stats stats =
-          GetStats(internal::GetPacketInfo(sink->GetReceivedTraffic(), 0));
+      const SinkVcStatistics& stats = sink->GetVcStatistics(vc);
       entry_name =
           absl::StrFormat("Sink:%s:VC:%d:MinimumInjectionTime", nc_name, vc);
-      metrics.SetIntegerMetric(entry_name, stats.min_injection_cycle_time);
+      metrics.SetIntegerMetric(entry_name, stats.min_injection_cycle);
       entry_name =
           absl::StrFormat("Sink:%s:VC:%d:MaximumInjectionTime", nc_name, vc);
-      metrics.SetIntegerMetric(entry_name, stats.max_injection_cycle_time);
+      metrics.SetIntegerMetric(entry_name, stats.max_injection_cycle);
       entry_name =
           absl::StrFormat("Sink:%s:VC:%d:MinimumArrivalTime", nc_name, vc);
-      metrics.SetIntegerMetric(entry_name, stats.min_arrival_cycle_time);
+      metrics.SetIntegerMetric(entry_name, stats.min_arrival_cycle);
       entry_name =
           absl::StrFormat("Sink:%s:VC:%d:MaximumArrivalTime", nc_name, vc);
-      metrics.SetIntegerMetric(entry_name, stats.max_arrival_cycle_time);
+      metrics.SetIntegerMetric(entry_name, stats.max_arrival_cycle);
       entry_name = absl::StrFormat("Sink:%s:VC:%d:MinimumLatency", nc_name, vc);
-      metrics.SetIntegerMetric(entry_name, stats.min_latency);
+      metrics.SetIntegerMetric(entry_name, stats.latency.Min());
       entry_name = absl::StrFormat("Sink:%s:VC:%d:MaximumLatency", nc_name, vc);
-      metrics.SetIntegerMetric(entry_name, stats.max_latency);
+      metrics.SetIntegerMetric(entry_name, stats.latency.Max());
       entry_name = absl::StrFormat("Sink:%s:VC:%d:AverageLatency", nc_name, vc);
-      metrics.SetFloatMetric(entry_name, stats.average_latency);
+      metrics.SetFloatMetric(entry_name, stats.latency.Mean());
+      entry_name =
+          absl::StrFormat("Sink:%s:VC:%d:99PercentileLatency", nc_name, vc);
+      metrics.SetIntegerMetric(entry_name,
+                               stats.latency.ValueAtQuantile(0.99));
       entry_name =
           absl::StrFormat("Sink:%s:VC:%d:LatencyHistogram", nc_name, vc);
       metrics.SetIntegerIntegerMapMetric(entry_name,
-                                         std::move(stats.latency_histogram));
+                                         stats.latency.GetBucketCounts());
       for (const TimedDataFlit& timed_data_flit : sink->GetReceivedTraffic()) {
         entry_name =
             absl::StrFormat("Sink:%s:VC:%d:TimedRouteInfo", nc_name, vc);
@@ -320,6 +332,55 @@ absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
                                            std::move(vc_name)}] = packet_count;
     }
   }
+
+  // Get link utilization from link monitor.
+  for (auto& [nc_id, utilization] : link_monitor.GetLinkUtilizationMap()) {
+    XLS_ASSIGN_OR_RETURN(NetworkComponentParam link_param,
+                         params.GetNetworkComponentParam(nc_id));
+    std::string link_name = std::string(absl::visit(
+        [](const auto& nc_param) { return nc_param.GetName(); }, link_param));
+    metrics.SetFloatMetric(
+        absl::StrFormat("Link:%s:Utilization", link_name),
+        static_cast<double>(utilization.flit_count) /
+            static_cast<double>(total_simulation_cycle_count_));
+    metrics.SetFloatMetric(
+        absl::StrFormat("Link:%s:PeakWindowUtilization", link_name),
+        static_cast<double>(utilization.peak_window_flit_count) /
+            static_cast<double>(link_utilization_window_));
+  }
+  return experiment_data;
+}
+
+absl::StatusOr<std::vector<ExperimentData>> Experiment::RunAllSteps(
+    int64_t thread_count) const {
+  XLS_RET_CHECK_GT(thread_count, 0);
+  int64_t step_count = GetStepCount();
+
+  std::vector<absl::StatusOr<ExperimentData>> step_results(
+      step_count, absl::InternalError("Step was not run."));
+  std::atomic<int64_t> next_step = 0;
+  auto run_steps = [&]() {
+    for (int64_t step = next_step++; step < step_count; step = next_step++) {
+      step_results[step] = RunStep(step);
+    }
+  };
+
+  // The calling thread runs steps as well.
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < std::min(thread_count, step_count); ++i) {
+    threads.push_back(std::make_unique<Thread>(run_steps));
+  }
+  run_steps();
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
+  std::vector<ExperimentData> experiment_data;
+  experiment_data.reserve(step_count);
+  for (absl::StatusOr<ExperimentData>& step_result : step_results) {
+    XLS_ASSIGN_OR_RETURN(ExperimentData data, std::move(step_result));
+    experiment_data.push_back(std::move(data));
+  }
   return experiment_data;
 }
 
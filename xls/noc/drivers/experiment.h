@@ -247,6 +247,22 @@ class ExperimentRunner {
     return *this;
   }
 
+  // Sets whether the sinks keep every flit received, which is needed for the
+  // TimedRouteInfo of the experiment info but grows with the length of the
+  // simulation.  The sink and link metrics do not depend on it.
+  ExperimentRunner& SetRecordReceivedTraffic(bool record) {
+    record_received_traffic_ = record;
+    return *this;
+  }
+
+  // Sets the number of cycles in each window over which the peak link
+  // utilization is measured.
+  ExperimentRunner& SetLinkUtilizationWindow(int64_t cycle_count) {
+    XLS_CHECK_GT(cycle_count, 0);
+    link_utilization_window_ = cycle_count;
+    return *this;
+  }
+
   int64_t GetSimulationCycleCount() const {
     return total_simulation_cycle_count_;
   }
@@ -254,11 +270,17 @@ class ExperimentRunner {
 
   int16_t GetSeed() const { return seed_; }
   std::string_view GetTrafficMode() const { return mode_name_; }
+  bool GetRecordReceivedTraffic() const { return record_received_traffic_; }
+  int64_t GetLinkUtilizationWindow() const {
+    return link_utilization_window_;
+  }
 
  private:
   int64_t total_simulation_cycle_count_;
   int64_t cycle_time_in_ps_;
   int16_t seed_;
+  bool record_received_traffic_ = true;
+  int64_t link_utilization_window_ = 1000;
 
   std::string mode_name_;
 };
@@ -291,6 +313,15 @@ class Experiment {
                                 std::move(distributed_routing_table_builder));
   }
 
+  // Runs every step and returns the data of each, in step order.
+  //
+  // Steps are independent, each building its own network graph and
+  // simulator, so up to thread_count of them are run concurrently.  Results
+  // do not depend on thread_count.  Returns the error of the first failing
+  // step, if any.
+  absl::StatusOr<std::vector<ExperimentData>> RunAllSteps(
+      int64_t thread_count = 1) const;
+
   // Get the configuration for step N.
   absl::StatusOr<ExperimentConfig> GetConfigForStep(int64_t step) const {
     XLS_RET_CHECK(step >= 0 && step < GetStepCount());
@@ -14,7 +14,9 @@
 
 #include "xls/noc/drivers/sample_experiments.h"
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -159,6 +161,64 @@ TEST(SampleExperimentsTest, SimpleVCExperiment) {
   EXPECT_EQ(
       link_to_packet_count_map.at("LinkA0").at(SinkVcPair{"RecvPort0", "VC0"}),
       link_to_packet_count_map.at("Link0A").begin()->second);
+
+  // Rerun experiment 2 without recording the received traffic: the metrics
+  // are unchanged but there is no route info.
+  ExperimentRunner runner = experiment.GetRunner();
+  runner.SetRecordReceivedTraffic(false);
+  XLS_ASSERT_OK_AND_ASSIGN(ExperimentConfig config,
+                           experiment.GetConfigForStep(2));
+  XLS_ASSERT_OK_AND_ASSIGN(ExperimentData unrecorded_data,
+                           runner.RunExperiment(config));
+  for (std::string_view metric :
+       {"Sink:RecvPort0:FlitCount", "Sink:RecvPort0:VC:0:MaximumLatency"}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        int64_t expected,
+        experiment_data.at(2).metrics.GetIntegerMetric(metric));
+    XLS_ASSERT_OK_AND_ASSIGN(int64_t actual,
+                             unrecorded_data.metrics.GetIntegerMetric(metric));
+    EXPECT_EQ(actual, expected) << metric;
+  }
+  EXPECT_FALSE(unrecorded_data.info
+                   .GetTimedRouteInfo("Sink:RecvPort0:VC:1:TimedRouteInfo")
+                   .ok());
+
+  // The network of experiment 2 is saturated, so its links are busy in
+  // almost every cycle.
+  XLS_ASSERT_OK_AND_ASSIGN(double ex2_link_utilization,
+                           unrecorded_data.metrics.GetFloatMetric(
+                               "Link:LinkA0:Utilization"));
+  XLS_ASSERT_OK_AND_ASSIGN(double ex2_link_peak_utilization,
+                           unrecorded_data.metrics.GetFloatMetric(
+                               "Link:LinkA0:PeakWindowUtilization"));
+  EXPECT_GT(ex2_link_utilization, 0.9);
+  EXPECT_LE(ex2_link_utilization, 1.0);
+  EXPECT_GE(ex2_link_peak_utilization, ex2_link_utilization);
+  EXPECT_LE(ex2_link_peak_utilization, 1.0);
+}
+
+TEST(SampleExperimentsTest, SimpleVCExperimentRunAllSteps) {
+  ExperimentFactory experiment_factory;
+  XLS_ASSERT_OK(RegisterSampleExperiments(experiment_factory));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Experiment experiment,
+      experiment_factory.BuildExperiment("SimpleVCExperiment"));
+
+  // Steps run concurrently must give the same results as run in sequence.
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<ExperimentData> experiment_data,
+                           experiment.RunAllSteps(/*thread_count=*/4));
+  ASSERT_EQ(experiment_data.size(), experiment.GetStepCount());
+  for (int64_t i = 0; i < experiment.GetStepCount(); ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(ExperimentData step_data, experiment.RunStep(i));
+    for (std::string_view metric : {"Flow:flow_0:TrafficRateInMiBps",
+                                    "Flow:flow_1:TrafficRateInMiBps"}) {
+      XLS_ASSERT_OK_AND_ASSIGN(
+          double expected, step_data.metrics.GetFloatMetric(metric));
+      XLS_ASSERT_OK_AND_ASSIGN(
+          double actual, experiment_data.at(i).metrics.GetFloatMetric(metric));
+      EXPECT_EQ(actual, expected) << "step " << i << " metric " << metric;
+    }
+  }
 }
 
 TEST(SampleExperimentsTest, AggregateTreeTest) {
@@ -0,0 +1,45 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string_view>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/noc/simulation/traffic_trace.h"
+
+const char kUsage[] = R"(
+Converts a CSV file of packet injection cycles, one packet per line in
+non-decreasing cycle order, to the binary traffic trace format replayed by
+TrafficFlow::SetTraceFile() (see xls/noc/simulation/traffic_trace.h).
+
+Invocation:
+
+  csv_to_traffic_trace_main flow.csv flow.trace
+)";
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+
+  if (positional_arguments.size() != 2) {
+    XLS_LOG(QFATAL) << absl::StreamFormat(
+        "Expected invocation: %s <csv path> <trace path>", argv[0]);
+  }
+
+  return xls::ExitStatus(xls::noc::ConvertCsvToTrafficTrace(
+      positional_arguments[0], positional_arguments[1]));
+}
@@ -152,8 +152,9 @@ inline bool operator==(const TimedRouteInfo& lhs, const TimedRouteInfo& rhs) {
 // TODO(vmirian) This can be expanded to have 'metadata' objects hooked onto the
 // flit. Discussion is required to evaluate the performance tradeoff.
 struct TimedDataFlitInfo {
-  int64_t injection_cycle_time;  // the cycle iteration the flit was injected by
-  // the simulator into the network
+  // the cycle iteration the flit was injected by the simulator into the
+  // network
+  int64_t injection_cycle_time = 0;
   TimedRouteInfo
       timed_route_info;  // The route of the flit from source to sink.
   std::string ToString() const {
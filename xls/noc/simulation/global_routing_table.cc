@@ -15,6 +15,8 @@
 #include "xls/noc/simulation/global_routing_table.h"
 
 #include <cstdint>
+#include <limits>
+#include <optional>
 #include <ostream>
 #include <queue>
 #include <sstream>
@@ -25,6 +27,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/variant.h"
@@ -176,12 +179,9 @@ absl::StatusOr<PortAndVCIndex> DistributedRoutingTable::GetRouterOutputPort(
 absl::StatusOr<PortAndVCIndex>
 DistributedRoutingTable::GetRouterOutputPortByIndex(PortAndVCIndex from,
                                                     int64_t destination_index) {
-  PortRoutingList& routes = GetRoutingList(from);
-
-  for (std::pair<int64_t, PortAndVCIndex>& hop : routes) {
-    if (hop.first == destination_index) {
-      return hop.second;
-    }
+  std::optional<PortAndVCIndex> route = FindRoute(from, destination_index);
+  if (route.has_value()) {
+    return *route;
   }
 
   XLS_ASSIGN_OR_RETURN(
@@ -202,8 +202,6 @@ DistributedRoutingTable::GetRouterOutputPortByIndex(PortAndVCIndex from,
 absl::Status DistributedRoutingTable::DumpRouterRoutingTable(
     NetworkId network_id) const {
   const Network& network = network_manager_->GetNetwork(network_id);
-  std::vector<RouterRoutingTable> nc_routing_tables =
-      routing_tables_.at(network_id.id());
   XLS_ASSIGN_OR_RETURN(NetworkParam network_param,
                        network_parameters_->GetNetworkParam(network_id));
   XLS_LOG(INFO) << "Routing table for network: " << network_param.GetName();
@@ -218,7 +216,6 @@ absl::Status DistributedRoutingTable::DumpRouterRoutingTable(
                   << std::get<RouterParam>(nc_param).GetName();
     XLS_LOG(INFO) << "Input Port Name | Input VC Name | Sink Name | Output "
                      "Port Name | Output VC Name";
-    RouterRoutingTable& router_routing_table = nc_routing_tables.at(nc_id.id());
     for (PortId input_port_id : nc.GetInputPortIds()) {
       XLS_ASSIGN_OR_RETURN(PortParam input_port_param,
                            network_parameters_->GetPortParam(input_port_id));
@@ -237,9 +234,14 @@ absl::Status DistributedRoutingTable::DumpRouterRoutingTable(
         if (get_vc_param) {
           vc_name = input_vc_params.at(vc_index).GetName();
         }
-        const PortRoutingList& routes =
-            router_routing_table.routes.at(input_port_id.id()).at(vc_index);
-        for (auto& [destination_index, port_id_vc_index] : routes) {
+        for (int64_t destination_index = 0;
+             destination_index < sink_indices_.NetworkComponentCount();
+             ++destination_index) {
+          std::optional<PortAndVCIndex> port_id_vc_index = FindRoute(
+              PortAndVCIndex{input_port_id, vc_index}, destination_index);
+          if (!port_id_vc_index.has_value()) {
+            continue;
+          }
           XLS_ASSIGN_OR_RETURN(
               NetworkComponentId sink_id,
               sink_indices_.GetNetworkComponentByIndex(destination_index));
@@ -248,7 +250,7 @@ absl::Status DistributedRoutingTable::DumpRouterRoutingTable(
               network_parameters_->GetNetworkComponentParam(sink_id));
           XLS_ASSIGN_OR_RETURN(
               PortParam output_port_param,
-              network_parameters_->GetPortParam(port_id_vc_index.port_id_));
+              network_parameters_->GetPortParam(port_id_vc_index->port_id_));
           std::string_view output_port_name = output_port_param.GetName();
           std::vector<VirtualChannelParam> output_vc_params =
               output_port_param.GetVirtualChannels();
@@ -256,7 +258,7 @@ absl::Status DistributedRoutingTable::DumpRouterRoutingTable(
               << input_port_name << "   " << vc_name << "   "
               << std::get<NetworkInterfaceSinkParam>(sink_param).GetName()
               << "   " << output_port_name << "   "
-              << output_vc_params.at(port_id_vc_index.vc_index_).GetName();
+              << output_vc_params.at(port_id_vc_index->vc_index_).GetName();
         }
       }
     }
@@ -264,6 +266,96 @@ absl::Status DistributedRoutingTable::DumpRouterRoutingTable(
   return absl::OkStatus();
 }
 
+std::optional<PortAndVCIndex> DistributedRoutingTable::FindRoute(
+    PortAndVCIndex from, int64_t destination_index) const {
+  NetworkComponentId nc_id = from.port_id_.GetNetworkComponentId();
+  const RouterRoutingTable& table =
+      routing_tables_.at(nc_id.network()).at(nc_id.id());
+
+  if (!compiled_) {
+    for (const std::pair<int64_t, PortAndVCIndex>& hop :
+         table.routes.at(from.port_id_.id()).at(from.vc_index_)) {
+      if (hop.first == destination_index) {
+        return hop.second;
+      }
+    }
+    return std::nullopt;
+  }
+
+  int64_t destination_count = sink_indices_.NetworkComponentCount();
+  int64_t port_index = from.port_id_.id();
+  if (port_index + 1 >= table.compiled_offsets.size() || from.vc_index_ < 0 ||
+      destination_index < 0 || destination_index >= destination_count) {
+    return std::nullopt;
+  }
+  int64_t offset = table.compiled_offsets[port_index] +
+                   from.vc_index_ * destination_count + destination_index;
+  if (offset >= table.compiled_offsets[port_index + 1]) {
+    return std::nullopt;
+  }
+  const CompiledHop& hop = table.compiled_routes[offset];
+  if (hop.vc_index < 0) {
+    return std::nullopt;
+  }
+  return PortAndVCIndex{PortId(nc_id, hop.port_id), hop.vc_index};
+}
+
+absl::Status DistributedRoutingTable::Compile() {
+  if (compiled_) {
+    return absl::OkStatus();
+  }
+
+  // Build all dense tables before releasing any routing list so that the
+  // table is left unchanged on error.
+  int64_t destination_count = sink_indices_.NetworkComponentCount();
+  std::vector<std::vector<RouterRoutingTable>> compiled_tables(
+      routing_tables_.size());
+  for (int64_t network = 0; network < routing_tables_.size(); ++network) {
+    compiled_tables[network].resize(routing_tables_[network].size());
+    for (int64_t nc = 0; nc < routing_tables_[network].size(); ++nc) {
+      const RouterRoutingTable& table = routing_tables_[network][nc];
+      RouterRoutingTable& compiled = compiled_tables[network][nc];
+
+      compiled.compiled_offsets.reserve(table.routes.size() + 1);
+      compiled.compiled_offsets.push_back(0);
+      for (const std::vector<PortRoutingList>& port_routes : table.routes) {
+        int64_t entry_count = port_routes.size() * destination_count;
+        compiled.compiled_offsets.push_back(compiled.compiled_offsets.back() +
+                                            entry_count);
+      }
+      compiled.compiled_routes.resize(compiled.compiled_offsets.back(),
+                                      CompiledHop{0, -1});
+
+      for (int64_t port = 0; port < table.routes.size(); ++port) {
+        for (int64_t vc = 0; vc < table.routes[port].size(); ++vc) {
+          for (const auto& [destination_index, hop] : table.routes[port][vc]) {
+            XLS_RET_CHECK(destination_index >= 0 &&
+                          destination_index < destination_count);
+            XLS_RET_CHECK(hop.port_id_.network() == network &&
+                          hop.port_id_.component() == nc)
+                << "Route leaves through a port of another component.";
+            XLS_RET_CHECK(hop.vc_index_ >= 0 &&
+                          hop.vc_index_ <= std::numeric_limits<int16_t>::max());
+            CompiledHop& entry =
+                compiled.compiled_routes[compiled.compiled_offsets[port] +
+                                         vc * destination_count +
+                                         destination_index];
+            // As when searching the list, the first route listed is used.
+            if (entry.vc_index < 0) {
+              entry = CompiledHop{hop.port_id_.id(),
+                                  static_cast<int16_t>(hop.vc_index_)};
+            }
+          }
+        }
+      }
+    }
+  }
+
+  routing_tables_ = std::move(compiled_tables);
+  compiled_ = true;
+  return absl::OkStatus();
+}
+
 void DistributedRoutingTable::AllocateTableForNetwork(NetworkId network_id,
                                                       int64_t component_count) {
   int64_t network_index = network_id.id();
@@ -19,10 +19,14 @@
 #ifndef XLS_NOC_SIMULATION_GLOBAL_ROUTING_TABLE_H_
 #define XLS_NOC_SIMULATION_GLOBAL_ROUTING_TABLE_H_
 
+#include <cstdint>
+#include <optional>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "xls/common/logging/logging.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/indexer.h"
 #include "xls/noc/simulation/network_graph.h"
@@ -65,9 +69,25 @@ class DistributedRoutingTable {
   //   2. Find the tuple that matched the given destination within the list.
   using PortRoutingList = std::vector<std::pair<int64_t, PortAndVCIndex>>;
 
+  // A route of a compiled routing table: the local id of the output port
+  // (within the same router) and its vc index.  A negative vc index denotes
+  // that no route exists.
+  struct CompiledHop {
+    uint16_t port_id;
+    int16_t vc_index;
+  };
+
   // See comment above.
+  //
+  // Once compiled (see Compile()), routes is released and the table is
+  // instead stored densely:
+  //   compiled_routes[compiled_offsets[port_index] +
+  //                   vc_input_index * destination_count + destination_index]
   struct RouterRoutingTable {
     std::vector<std::vector<PortRoutingList>> routes;
+
+    std::vector<int64_t> compiled_offsets;
+    std::vector<CompiledHop> compiled_routes;
   };
 
   // Returns route to destination from a particular source network interface
@@ -103,6 +123,18 @@ class DistributedRoutingTable {
   absl::StatusOr<PortAndVCIndex> GetRouterOutputPortByIndex(
       PortAndVCIndex from, int64_t destination_index);
 
+  // Flattens the routing lists of each router into dense arrays indexed by
+  // input port, input vc and destination index so that routes are found
+  // without searching.  The dense form takes 4 bytes per entry rather than
+  // the 24 bytes per route of the lists, so it is smaller unless few
+  // destinations are reachable from each port.
+  //
+  // Lookups give the same results before and after compilation.  No routes
+  // may be added afterwards.  Compiling a compiled table is a no-op.
+  absl::Status Compile();
+
+  bool IsCompiled() const { return compiled_; }
+
   // TODO(tedhong): 2020-01-25 Add indexer for input/output ports of a router
   //                          and support routing directly via indices.
 
@@ -137,8 +169,16 @@ class DistributedRoutingTable {
     return routing_tables_[nc_id.network()][nc_id.id()];
   }
 
+  // Returns the route to destination_index from the given input port and
+  // vc, or std::nullopt if there is none.
+  std::optional<PortAndVCIndex> FindRoute(PortAndVCIndex from,
+                                          int64_t destination_index) const;
+
   // Get possible routes associated with given port and vc.
+  //
+  // Only available before the table is compiled.
   PortRoutingList& GetRoutingList(PortAndVCIndex port_and_vc) {
+    XLS_CHECK(!compiled_);
     NetworkComponentId nc_id = port_and_vc.port_id_.GetNetworkComponentId();
 
     return GetRoutingTable(nc_id)
@@ -155,6 +195,9 @@ class DistributedRoutingTable {
   NetworkManager* network_manager_;
   NocParameters* network_parameters_;
 
+  // True once Compile() has been called.
+  bool compiled_ = false;
+
   // Routing tables for all components.
   // This vector of vectors is indexed via network and component local id's.
   // ie. routing table for ComponentId id is
@@ -14,10 +14,16 @@
 
 #include "xls/noc/simulation/global_routing_table.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "absl/types/variant.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/matchers.h"
@@ -280,6 +286,62 @@ TEST(GlobalRoutingTableTest, RouterLoop) {
   EXPECT_EQ(route01[6], recvport1);
 }
 
+TEST(GlobalRoutingTableTest, CompiledTableGivesSameRoutes) {
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_ASSERT_OK(BuildNetworkGraphTree000(&proto, &graph, &params));
+  NetworkId network_id = graph.GetNetworkIds()[0];
+
+  DistributedRoutingTableBuilderForTrees route_builder;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      DistributedRoutingTable routing_table,
+      route_builder.BuildNetworkRoutingTables(network_id, graph, params));
+  int64_t destination_count =
+      routing_table.GetSinkIndices().NetworkComponentCount();
+
+  // Looks up the route of every router input port, vc and destination.
+  auto lookup_all_routes = [&]() {
+    std::vector<std::string> routes;
+    for (NetworkComponentId nc_id :
+         graph.GetNetwork(network_id).GetNetworkComponentIds()) {
+      const NetworkComponent& nc = graph.GetNetworkComponent(nc_id);
+      if (nc.kind() != NetworkComponentKind::kRouter) {
+        continue;
+      }
+      for (PortId port_id : nc.GetInputPortIds()) {
+        absl::StatusOr<PortParam> port_param = params.GetPortParam(port_id);
+        XLS_CHECK_OK(port_param.status());
+        int64_t vc_count =
+            std::max<int64_t>(port_param->VirtualChannelCount(), 1);
+        for (int64_t vc = 0; vc < vc_count; ++vc) {
+          for (int64_t d = 0; d < destination_count; ++d) {
+            absl::StatusOr<PortAndVCIndex> route =
+                routing_table.GetRouterOutputPortByIndex(
+                    PortAndVCIndex{port_id, vc}, d);
+            if (!route.ok()) {
+              routes.push_back("none");
+              continue;
+            }
+            routes.push_back(absl::StrFormat(
+                "%x:%d", route->port_id_.AsUInt64(), route->vc_index_));
+          }
+        }
+      }
+    }
+    return routes;
+  };
+
+  std::vector<std::string> list_routes = lookup_all_routes();
+  EXPECT_FALSE(routing_table.IsCompiled());
+  XLS_ASSERT_OK(routing_table.Compile());
+  EXPECT_TRUE(routing_table.IsCompiled());
+  EXPECT_EQ(lookup_all_routes(), list_routes);
+  EXPECT_THAT(list_routes, testing::Contains(testing::Ne("none")));
+
+  XLS_EXPECT_OK(routing_table.DumpRouterRoutingTable(network_id));
+}
+
 TEST(GlobalRoutingTableTest, MultiplePathsBetweenRouters) {
   // Build and assign simulation objects
   NetworkConfigProto proto;
@@ -0,0 +1,126 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/noc/simulation/histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/numeric/bits.h"
+#include "xls/common/logging/logging.h"
+
+namespace xls::noc {
+
+Histogram::Histogram(int64_t sub_bucket_bits)
+    : sub_bucket_bits_(sub_bucket_bits) {
+  XLS_CHECK(sub_bucket_bits >= 1 && sub_bucket_bits <= 16);
+}
+
+// Bucket indices are laid out as
+//   [0, S)  : the values 0 .. S-1 where S = 2^sub_bucket_bits.
+//   [S, ..) : groups of S/2 buckets; group g (g >= 1) covers
+//             [S * 2^(g-1), S * 2^g) in buckets of width 2^g.
+int64_t Histogram::BucketIndex(int64_t value) const {
+  int64_t sub_bucket_count = int64_t{1} << sub_bucket_bits_;
+  if (value < sub_bucket_count) {
+    return value;
+  }
+  int64_t exponent =
+      63 - absl::countl_zero(static_cast<uint64_t>(value));
+  int64_t shift = exponent - sub_bucket_bits_ + 1;
+  int64_t half_count = sub_bucket_count / 2;
+  int64_t mantissa = value >> shift;
+  return sub_bucket_count + (shift - 1) * half_count + (mantissa - half_count);
+}
+
+int64_t Histogram::BucketLowerBound(int64_t index) const {
+  int64_t sub_bucket_count = int64_t{1} << sub_bucket_bits_;
+  if (index < sub_bucket_count) {
+    return index;
+  }
+  int64_t half_count = sub_bucket_count / 2;
+  int64_t offset = index - sub_bucket_count;
+  int64_t shift = offset / half_count + 1;
+  int64_t mantissa = offset % half_count + half_count;
+  return mantissa << shift;
+}
+
+void Histogram::Add(int64_t value, int64_t count) {
+  XLS_DCHECK_GE(value, 0);
+  XLS_DCHECK_GE(count, 0);
+  if (count == 0) {
+    return;
+  }
+  int64_t index = BucketIndex(value);
+  if (index >= counts_.size()) {
+    counts_.resize(index + 1, 0);
+  }
+  counts_[index] += count;
+  count_ += count;
+  sum_ += value * count;
+  min_ = std::min(min_, value);
+  max_ = std::max(max_, value);
+}
+
+void Histogram::Merge(const Histogram& other) {
+  XLS_CHECK_EQ(sub_bucket_bits_, other.sub_bucket_bits_);
+  if (other.counts_.size() > counts_.size()) {
+    counts_.resize(other.counts_.size(), 0);
+  }
+  for (int64_t i = 0; i < other.counts_.size(); ++i) {
+    counts_[i] += other.counts_[i];
+  }
+  count_ += other.count_;
+  sum_ += other.sum_;
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+}
+
+double Histogram::Mean() const {
+  if (count_ == 0) {
+    return 0.0;
+  }
+  return static_cast<double>(sum_) / static_cast<double>(count_);
+}
+
+int64_t Histogram::ValueAtQuantile(double quantile) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  quantile = std::clamp(quantile, 0.0, 1.0);
+  int64_t rank = std::max<int64_t>(
+      1, static_cast<int64_t>(std::ceil(quantile * count_)));
+  int64_t seen = 0;
+  for (int64_t i = 0; i < counts_.size(); ++i) {
+    seen += counts_[i];
+    if (seen >= rank) {
+      return std::clamp(BucketLowerBound(i), min_, max_);
+    }
+  }
+  return max_;
+}
+
+absl::flat_hash_map<int64_t, int64_t> Histogram::GetBucketCounts() const {
+  absl::flat_hash_map<int64_t, int64_t> bucket_counts;
+  for (int64_t i = 0; i < counts_.size(); ++i) {
+    if (counts_[i] != 0) {
+      bucket_counts[BucketLowerBound(i)] = counts_[i];
+    }
+  }
+  return bucket_counts;
+}
+
+}  // namespace xls::noc
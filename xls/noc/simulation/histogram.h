@@ -0,0 +1,81 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NOC_SIMULATION_HISTOGRAM_H_
+#define XLS_NOC_SIMULATION_HISTOGRAM_H_
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+
+namespace xls::noc {
+
+// A histogram of non-negative integers (ex. latencies in cycles) with
+// bounded memory, in the style of HdrHistogram.
+//
+// Values below 2^sub_bucket_bits are counted exactly.  Larger values are
+// counted in log-linear buckets: each power-of-two range is split into
+// 2^(sub_bucket_bits-1) equal buckets, so a value is represented by a bucket
+// within a relative error of 2^-(sub_bucket_bits-1).  Memory is thus
+// proportional to sub_bucket_bits * log2(max value) rather than to the
+// number or range of the values.
+//
+// The count, minimum, maximum and mean are exact.
+class Histogram {
+ public:
+  explicit Histogram(int64_t sub_bucket_bits = 6);
+
+  // Records count occurrences of value.
+  void Add(int64_t value, int64_t count = 1);
+
+  // Adds all values recorded in other, which must use the same
+  // sub_bucket_bits.
+  void Merge(const Histogram& other);
+
+  int64_t Count() const { return count_; }
+  bool empty() const { return count_ == 0; }
+
+  // Minimum and maximum values recorded; only meaningful if !empty().
+  int64_t Min() const { return min_; }
+  int64_t Max() const { return max_; }
+
+  // Returns the mean of the values recorded, or 0 if empty.
+  double Mean() const;
+
+  // Returns the least value of the bucket holding the value at quantile
+  // (in [0, 1]), or 0 if empty.
+  int64_t ValueAtQuantile(double quantile) const;
+
+  // Returns the count of each non-empty bucket keyed by the least value in
+  // the bucket.
+  absl::flat_hash_map<int64_t, int64_t> GetBucketCounts() const;
+
+ private:
+  int64_t BucketIndex(int64_t value) const;
+  int64_t BucketLowerBound(int64_t index) const;
+
+  int64_t sub_bucket_bits_;
+  std::vector<int64_t> counts_;
+
+  int64_t count_ = 0;
+  int64_t sum_ = 0;
+  int64_t min_ = std::numeric_limits<int64_t>::max();
+  int64_t max_ = std::numeric_limits<int64_t>::min();
+};
+
+}  // namespace xls::noc
+
+#endif  // XLS_NOC_SIMULATION_HISTOGRAM_H_
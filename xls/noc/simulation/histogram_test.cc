@@ -0,0 +1,83 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/noc/simulation/histogram.h"
+
+#include <cstdint>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace xls::noc {
+namespace {
+
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+TEST(HistogramTest, SmallValuesAreExact) {
+  Histogram histogram(/*sub_bucket_bits=*/4);
+  EXPECT_TRUE(histogram.empty());
+  EXPECT_EQ(histogram.ValueAtQuantile(0.5), 0);
+
+  histogram.Add(3);
+  histogram.Add(3);
+  histogram.Add(15, 2);
+  histogram.Add(0);
+
+  EXPECT_EQ(histogram.Count(), 5);
+  EXPECT_EQ(histogram.Min(), 0);
+  EXPECT_EQ(histogram.Max(), 15);
+  EXPECT_DOUBLE_EQ(histogram.Mean(), 36.0 / 5.0);
+  EXPECT_EQ(histogram.ValueAtQuantile(0.0), 0);
+  EXPECT_EQ(histogram.ValueAtQuantile(0.5), 3);
+  EXPECT_EQ(histogram.ValueAtQuantile(1.0), 15);
+  EXPECT_THAT(histogram.GetBucketCounts(),
+              UnorderedElementsAre(Pair(0, 1), Pair(3, 2), Pair(15, 2)));
+}
+
+TEST(HistogramTest, LargeValuesAreBucketed) {
+  Histogram histogram(/*sub_bucket_bits=*/4);
+  // 16..31 are in buckets of width 2, 32..63 of width 4, etc.
+  histogram.Add(16);
+  histogram.Add(17);
+  histogram.Add(18);
+  histogram.Add(63);
+  histogram.Add(1000000);
+
+  EXPECT_EQ(histogram.Min(), 16);
+  EXPECT_EQ(histogram.Max(), 1000000);
+  EXPECT_THAT(histogram.GetBucketCounts(),
+              UnorderedElementsAre(Pair(16, 2), Pair(18, 1), Pair(60, 1),
+                                   Pair(983040, 1)));
+  EXPECT_EQ(histogram.ValueAtQuantile(0.5), 18);
+  EXPECT_EQ(histogram.ValueAtQuantile(1.0), 983040);
+}
+
+TEST(HistogramTest, RelativeErrorIsBounded) {
+  Histogram histogram(/*sub_bucket_bits=*/6);
+  for (int64_t value = 1; value < 1000000; value = value * 3 / 2 + 1) {
+    Histogram single(/*sub_bucket_bits=*/6);
+    single.Add(value);
+    auto buckets = single.GetBucketCounts();
+    ASSERT_EQ(buckets.size(), 1);
+    int64_t lower_bound = buckets.begin()->first;
+    EXPECT_LE(lower_bound, value);
+    EXPECT_LE(value - lower_bound, value / 32);
+    histogram.Merge(single);
+  }
+  EXPECT_EQ(histogram.Min(), 1);
+}
+
+}  // namespace
+}  // namespace xls::noc
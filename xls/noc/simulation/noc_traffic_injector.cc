@@ -15,6 +15,11 @@
 #include "xls/noc/simulation/noc_traffic_injector.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
 #include <string_view>
 #include <utility>
 #include <variant>
@@ -78,6 +83,36 @@ absl::Status NocTrafficInjector::RunCycle() {
   return absl::OkStatus();
 }
 
+std::optional<int64_t> NocTrafficInjector::NextInjectionCycle() const {
+  int64_t next_cycle = std::numeric_limits<int64_t>::max();
+  for (const std::unique_ptr<TrafficModel>& model : traffic_models_) {
+    std::optional<int64_t> model_next_cycle = model->NextPacketCycle();
+    if (!model_next_cycle.has_value()) {
+      return std::nullopt;
+    }
+    next_cycle = std::min(next_cycle, *model_next_cycle);
+  }
+  return next_cycle;
+}
+
+absl::Status NocTrafficInjector::SkipCycles(int64_t cycle_count) {
+  cycle_ += cycle_count;
+
+  // Let the models and monitors see the last skipped cycle so that rates
+  // are measured over the same span as without skipping.
+  for (int64_t i = 0; i < traffic_models_.size(); ++i) {
+    std::vector<DataPacket> packets =
+        traffic_models_[i]->GetNewCyclePackets(cycle_);
+    XLS_RET_CHECK(packets.empty())
+        << "Skipped cycle " << cycle_ << " in which flow " << i
+        << " injects packets.";
+    traffic_model_monitor_[i].AcceptNewPackets(absl::MakeSpan(packets),
+                                               cycle_);
+  }
+
+  return absl::OkStatus();
+}
+
 namespace {
 
 // Function that calls run_action(i, j) for each flow and network_component
@@ -274,7 +309,17 @@ absl::Status NocTrafficInjectorBuilder::BuildPerFlowTrafficModels(
     int64_t sink_index = injector.flows_index_to_sinks_index_map_.at(i);
     int64_t vc_index = injector.flows_index_to_vc_index_map_.at(i);
 
-    if (flow.IsReplay()) {
+    if (flow.IsTrace()) {
+      XLS_ASSIGN_OR_RETURN(
+          std::unique_ptr<TraceTrafficModel> model,
+          TraceTrafficModelBuilder(bits_per_packet,
+                                   std::string(flow.GetTraceFile()))
+              .SetVCIndex(vc_index)
+              .SetSourceIndex(source_index)
+              .SetDestinationIndex(sink_index)
+              .Build());
+      injector.traffic_models_.push_back(std::move(model));
+    } else if (flow.IsReplay()) {
       XLS_ASSIGN_OR_RETURN(
           std::unique_ptr<ReplayTrafficModel> model,
           ReplayTrafficModelBuilder(bits_per_packet, flow.GetClockCycleTimes())
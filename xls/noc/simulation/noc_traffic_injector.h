@@ -46,6 +46,14 @@ class NocTrafficInjector {
   // on the current_cycle.
   absl::Status RunCycle();
 
+  // Returns the next cycle in which any flow may inject packets, or
+  // std::nullopt if a traffic model cannot tell in advance.
+  std::optional<int64_t> NextInjectionCycle() const;
+
+  // Advances over "cycle_count" cycles in which no packets are injected;
+  // these must all precede NextInjectionCycle().
+  absl::Status SkipCycles(int64_t cycle_count);
+
   // Provides the interface between this object and the NOC simulator.
   void SetSimulatorShim(NocSimulatorTrafficServiceShim& simulator) {
     simulator_ = &simulator;
@@ -0,0 +1,106 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NOC_SIMULATION_RING_BUFFER_H_
+#define XLS_NOC_SIMULATION_RING_BUFFER_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "xls/common/logging/logging.h"
+
+namespace xls::noc {
+
+// A fifo of elements stored in a ring of slots, used in place of std::queue
+// for the flit buffers of the simulator.
+//
+// Slots are never destroyed when an element is popped: the next element
+// pushed into the slot is assigned over the old one, so the heap storage
+// owned by an element (e.g. the Bits payload and route of a flit) is reused
+// rather than reallocated on every hop.
+//
+// The capacity is expected to be set from the buffer depths of the network
+// configuration.  Should more elements be pushed than fit, the ring grows.
+template <typename T>
+class RingBuffer {
+ public:
+  explicit RingBuffer(int64_t capacity = 0) { Reserve(capacity); }
+
+  // Grows the ring to hold at least "capacity" elements.
+  void Reserve(int64_t capacity) {
+    if (capacity <= slots_.size()) {
+      return;
+    }
+    std::vector<T> slots(capacity);
+    for (int64_t i = 0; i < size_; ++i) {
+      slots[i] = std::move(slots_[SlotIndex(i)]);
+    }
+    slots_ = std::move(slots);
+    head_ = 0;
+  }
+
+  int64_t capacity() const { return slots_.size(); }
+  int64_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // Returns the i-th element counting from the front.
+  const T& operator[](int64_t i) const {
+    XLS_DCHECK_LT(i, size_);
+    return slots_[SlotIndex(i)];
+  }
+
+  T& front() {
+    XLS_DCHECK(!empty());
+    return slots_[head_];
+  }
+  const T& front() const {
+    XLS_DCHECK(!empty());
+    return slots_[head_];
+  }
+
+  // Appends a slot at the back and returns it.  The slot holds a previously
+  // popped element (or a default constructed one), so the caller is expected
+  // to assign every field.
+  T& AppendSlot() {
+    if (size_ == slots_.size()) {
+      Reserve(slots_.empty() ? 1 : 2 * slots_.size());
+    }
+    T& slot = slots_[SlotIndex(size_)];
+    ++size_;
+    return slot;
+  }
+
+  void push_back(const T& value) { AppendSlot() = value; }
+
+  void pop_front() {
+    XLS_DCHECK(!empty());
+    head_ = SlotIndex(1);
+    --size_;
+  }
+
+ private:
+  int64_t SlotIndex(int64_t i) const {
+    int64_t index = head_ + i;
+    return index >= slots_.size() ? index - slots_.size() : index;
+  }
+
+  std::vector<T> slots_;
+  int64_t head_ = 0;
+  int64_t size_ = 0;
+};
+
+}  // namespace xls::noc
+
+#endif  // XLS_NOC_SIMULATION_RING_BUFFER_H_
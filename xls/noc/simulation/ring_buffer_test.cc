@@ -0,0 +1,76 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/noc/simulation/ring_buffer.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace xls::noc {
+namespace {
+
+TEST(RingBufferTest, FifoOrderAcrossWrapAround) {
+  RingBuffer<int64_t> buffer(3);
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ(buffer.capacity(), 3);
+
+  int64_t next_push = 0;
+  int64_t next_pop = 0;
+  for (int64_t round = 0; round < 5; ++round) {
+    buffer.push_back(next_push++);
+    buffer.push_back(next_push++);
+    ASSERT_EQ(buffer.size(), 2);
+    EXPECT_EQ(buffer[1], next_pop + 1);
+    EXPECT_EQ(buffer.front(), next_pop++);
+    buffer.pop_front();
+    EXPECT_EQ(buffer.front(), next_pop++);
+    buffer.pop_front();
+  }
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ(buffer.capacity(), 3);
+}
+
+TEST(RingBufferTest, GrowsWhenFull) {
+  RingBuffer<int64_t> buffer(2);
+  buffer.push_back(0);
+  buffer.push_back(1);
+  buffer.pop_front();
+  // The ring is now wrapped around; growing must preserve the order.
+  buffer.push_back(2);
+  buffer.push_back(3);
+  EXPECT_EQ(buffer.capacity(), 4);
+  ASSERT_EQ(buffer.size(), 3);
+  for (int64_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(buffer.front(), i + 1);
+    buffer.pop_front();
+  }
+}
+
+TEST(RingBufferTest, SlotsAreReused) {
+  RingBuffer<std::vector<int64_t>> buffer(1);
+  buffer.push_back(std::vector<int64_t>(16, 1));
+  const int64_t* storage = buffer.front().data();
+  buffer.pop_front();
+
+  std::vector<int64_t>& slot = buffer.AppendSlot();
+  EXPECT_GE(slot.capacity(), 16);
+  slot.assign(8, 2);
+  EXPECT_EQ(buffer.front().data(), storage);
+  EXPECT_EQ(buffer.front().size(), 8);
+}
+
+}  // namespace
+}  // namespace xls::noc
@@ -14,6 +14,10 @@
 
 #include "xls/noc/simulation/sim_objects.h"
 
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <queue>
 #include <utility>
 #include <vector>
@@ -21,7 +25,9 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/noc/config/network_config.pb.h"
 #include "xls/noc/simulation/common.h"
@@ -33,6 +39,16 @@ namespace xls {
 namespace noc {
 namespace {
 
+// Returns true if the flit carries no data.
+bool IsIdleFlit(const TimedDataFlit& flit) {
+  return flit.flit.type == FlitType::kInvalid;
+}
+
+// Returns true if the flit carries no credits.
+bool IsIdleFlit(const TimedMetadataFlit& flit) {
+  return flit.flit.type == FlitType::kInvalid || flit.flit.data.IsZero();
+}
+
 // Implements an simple pipeline between two connections.
 //
 // Template parameters are used to switch between the different types of
@@ -43,7 +59,7 @@ class SimplePipelineImpl {
  public:
   SimplePipelineImpl(int64_t stage_count, DataTimePhitT& from_channel,
                      DataTimePhitT& to_channel,
-                     std::queue<DataTimePhitT>& state,
+                     RingBuffer<DataTimePhitT>& state,
                      int64_t& internal_propagated_cycle)
       : stage_count_(stage_count),
         from_(from_channel),
@@ -58,7 +74,7 @@ class SimplePipelineImpl {
   DataTimePhitT& from_;
   DataTimePhitT& to_;
   // TODO(vmirian) 09-07-21 Optimize to select flit data and its metadata
-  std::queue<DataTimePhitT>& state_;
+  RingBuffer<DataTimePhitT>& state_;
   int64_t& internal_propagated_cycle_;
 };
 
@@ -95,7 +111,7 @@ bool SimplePipelineImpl<DataTimePhitT>::TryPropagation(
         to_.flit = state_.front().flit;
         to_.cycle = current_cycle;
         to_.metadata = state_.front().metadata;
-        state_.pop();
+        state_.pop_front();
       } else {
         to_.flit.type = FlitType::kInvalid;
         to_.flit.data = Bits(32);
@@ -108,7 +124,7 @@ bool SimplePipelineImpl<DataTimePhitT>::TryPropagation(
     }
 
     if (from_.cycle == current_cycle) {
-      state_.push(from_);
+      state_.push_back(from_);
       XLS_VLOG(2) << absl::StreamFormat("... link received data %v type %d",
                                         from_.flit.data, from_.flit.type);
 
@@ -292,12 +308,207 @@ absl::Status NocSimulator::RunCycle(int64_t max_ticks) {
   return absl::OkStatus();
 }
 
+absl::Status NocSimulator::RunCycles(int64_t cycle_count, int64_t max_ticks) {
+  int64_t last_cycle = cycle_ + cycle_count;
+  while (cycle_ < last_cycle) {
+    int64_t skip_count =
+        std::min(NextActiveCycle(), last_cycle + 1) - (cycle_ + 1);
+    if (skip_count > 0) {
+      XLS_VLOG(2) << absl::StreamFormat("*** Skipping cycles %d to %d",
+                                        cycle_ + 1, cycle_ + skip_count);
+      for (NocSimulatorServiceShim* svc : pre_cycle_services_) {
+        XLS_RETURN_IF_ERROR(svc->SkipCycles(skip_count));
+      }
+      for (NocSimulatorServiceShim* svc : post_cycle_services_) {
+        XLS_RETURN_IF_ERROR(svc->SkipCycles(skip_count));
+      }
+      cycle_ += skip_count;
+      skipped_cycle_count_ += skip_count;
+      continue;
+    }
+    XLS_RETURN_IF_ERROR(RunCycle(max_ticks));
+  }
+  return absl::OkStatus();
+}
+
+bool NocSimulator::IsQuiescent() const {
+  for (const SimConnectionState& connection : connections_) {
+    if (!IsIdleFlit(connection.forward_channels) ||
+        !std::all_of(
+            connection.reverse_channels.begin(),
+            connection.reverse_channels.end(),
+            [](const TimedMetadataFlit& flit) { return IsIdleFlit(flit); })) {
+      return false;
+    }
+  }
+  auto is_quiescent = [](const SimNetworkComponentBase& component) {
+    return component.IsQuiescent();
+  };
+  return std::all_of(network_interface_sources_.begin(),
+                     network_interface_sources_.end(), is_quiescent) &&
+         std::all_of(links_.begin(), links_.end(), is_quiescent) &&
+         std::all_of(routers_.begin(), routers_.end(), is_quiescent) &&
+         std::all_of(network_interface_sinks_.begin(),
+                     network_interface_sinks_.end(), is_quiescent);
+}
+
+int64_t NocSimulator::NextActiveCycle() {
+  int64_t next_cycle = cycle_ + 1;
+  // The first cycle distributes the initial credits, so always simulate it.
+  if (cycle_ < 0 || !IsQuiescent()) {
+    return next_cycle;
+  }
+  int64_t active_cycle = std::numeric_limits<int64_t>::max();
+  for (const SimNetworkInterfaceSrc& src : network_interface_sources_) {
+    active_cycle = std::min(active_cycle, src.NextSendCycle());
+  }
+  for (NocSimulatorServiceShim* svc : pre_cycle_services_) {
+    active_cycle = std::min(active_cycle, svc->NextActiveCycle(next_cycle));
+  }
+  for (NocSimulatorServiceShim* svc : post_cycle_services_) {
+    active_cycle = std::min(active_cycle, svc->NextActiveCycle(next_cycle));
+  }
+  return std::max(active_cycle, next_cycle);
+}
+
+// A fixed set of threads which repeatedly run a function over shards
+// [0, shard_count()) in lock step; the calling thread runs shard 0.
+class NocSimulator::TickThreadPool {
+ public:
+  explicit TickThreadPool(int64_t thread_count) : shard_count_(thread_count) {
+    for (int64_t shard = 1; shard < thread_count; ++shard) {
+      workers_.push_back(
+          std::make_unique<Thread>([this, shard]() { WorkerLoop(shard); }));
+    }
+  }
+
+  ~TickThreadPool() {
+    {
+      absl::MutexLock lock(&mutex_);
+      shutdown_ = true;
+      ++generation_;
+    }
+    for (std::unique_ptr<Thread>& worker : workers_) {
+      worker->Join();
+    }
+  }
+
+  int64_t shard_count() const { return shard_count_; }
+
+  // Runs fn(shard) for every shard and returns once all have finished.
+  void Run(const std::function<void(int64_t)>& fn) {
+    {
+      absl::MutexLock lock(&mutex_);
+      fn_ = &fn;
+      pending_ = workers_.size();
+      ++generation_;
+    }
+    fn(0);
+    absl::MutexLock lock(&mutex_);
+    auto done = [this]() { return pending_ == 0; };
+    mutex_.Await(absl::Condition(&done));
+  }
+
+ private:
+  void WorkerLoop(int64_t shard) {
+    int64_t seen_generation = 0;
+    while (true) {
+      const std::function<void(int64_t)>* fn;
+      {
+        absl::MutexLock lock(&mutex_);
+        auto started = [&]() { return generation_ != seen_generation; };
+        mutex_.Await(absl::Condition(&started));
+        if (shutdown_) {
+          return;
+        }
+        seen_generation = generation_;
+        fn = fn_;
+      }
+      (*fn)(shard);
+      absl::MutexLock lock(&mutex_);
+      --pending_;
+    }
+  }
+
+  int64_t shard_count_;
+  std::vector<std::unique_ptr<Thread>> workers_;
+
+  absl::Mutex mutex_;
+  const std::function<void(int64_t)>* fn_ ABSL_GUARDED_BY(mutex_) = nullptr;
+  int64_t generation_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t pending_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+NocSimulator::~NocSimulator() = default;
+
+absl::Status NocSimulator::SetThreadCount(int64_t thread_count) {
+  XLS_RET_CHECK_GE(thread_count, 1);
+  XLS_RET_CHECK(mgr_ != nullptr) << "Simulator is not initialized.";
+  tick_pool_.reset();
+  if (thread_count == 1) {
+    return absl::OkStatus();
+  }
+
+  // Components of one kind are ticked concurrently, so none of them may read
+  // state another writes during the same phase.
+  Network& network_obj = mgr_->GetNetwork(network_);
+  for (int64_t i = 0; i < network_obj.GetConnectionCount(); ++i) {
+    Connection& connection =
+        mgr_->GetConnection(network_obj.GetConnectionIdByIndex(i));
+    NetworkComponentKind src_kind =
+        mgr_->GetNetworkComponent(connection.src().GetNetworkComponentId())
+            .kind();
+    NetworkComponentKind sink_kind =
+        mgr_->GetNetworkComponent(connection.sink().GetNetworkComponentId())
+            .kind();
+    if (src_kind == sink_kind) {
+      return absl::FailedPreconditionError(absl::StrFormat(
+          "Connection %x joins two components of the same kind; the network "
+          "cannot be simulated on multiple threads.",
+          connection.id().AsUInt64()));
+    }
+  }
+
+  tick_pool_ = std::make_unique<TickThreadPool>(thread_count);
+  return absl::OkStatus();
+}
+
+template <typename ComponentT>
+bool NocSimulator::ParallelTick(absl::Span<ComponentT> components) {
+  int64_t shard_count = tick_pool_->shard_count();
+  int64_t shard_size = (components.size() + shard_count - 1) / shard_count;
+  // Not std::vector<bool>, as each shard writes its own element concurrently.
+  std::vector<char> shard_converged(shard_count, true);
+  std::function<void(int64_t)> tick_shard = [&](int64_t shard) {
+    int64_t begin = std::min<int64_t>(shard * shard_size, components.size());
+    int64_t end = std::min<int64_t>(begin + shard_size, components.size());
+    for (int64_t i = begin; i < end; ++i) {
+      // Every component must tick, so don't short-circuit on convergence.
+      bool this_converged = components[i].Tick(*this);
+      shard_converged[shard] &= this_converged;
+    }
+  };
+  tick_pool_->Run(tick_shard);
+  return std::all_of(shard_converged.begin(), shard_converged.end(),
+                     [](char converged) { return converged; });
+}
+
 bool NocSimulator::Tick() {
   // Goes through each simulator object and run atick.
   // Converges when everyone returns True -- that determines new cycle
 
   bool converged = true;
 
+  if (tick_pool_ != nullptr) {
+    // Same phase order as below; bitwise & so that every phase runs.
+    converged &= ParallelTick(absl::MakeSpan(network_interface_sources_));
+    converged &= ParallelTick(absl::MakeSpan(links_));
+    converged &= ParallelTick(absl::MakeSpan(routers_));
+    converged &= ParallelTick(absl::MakeSpan(network_interface_sinks_));
+    return converged;
+  }
+
   XLS_VLOG(2) << " Network Interfaces";
   for (SimNetworkInterfaceSrc& nc : network_interface_sources_) {
     NetworkComponentId id = nc.GetId();
@@ -366,6 +577,22 @@ int64_t SimLink::GetSinkConnectionIndex() const {
   return sink_connection_index_;
 }
 
+bool SimLink::IsQuiescent() const {
+  for (int64_t i = 0; i < forward_data_stages_.size(); ++i) {
+    if (!IsIdleFlit(forward_data_stages_[i])) {
+      return false;
+    }
+  }
+  for (const RingBuffer<TimedMetadataFlit>& stages : reverse_credit_stages_) {
+    for (int64_t i = 0; i < stages.size(); ++i) {
+      if (!IsIdleFlit(stages[i])) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 absl::Status SimLink::InitializeImpl(NocSimulator& simulator) {
   XLS_ASSIGN_OR_RETURN(
       NetworkComponentParam nc_param,
@@ -402,8 +629,14 @@ absl::Status SimLink::InitializeImpl(NocSimulator& simulator) {
   SimConnectionState& sink =
       simulator.GetSimConnectionByIndex(sink_connection_index_);
 
+  // A stage is popped before it is pushed each cycle, so the pipelines never
+  // hold more flits than they have stages.
+  forward_data_stages_.Reserve(forward_pipeline_stages_);
   int64_t reverse_channel_count = sink.reverse_channels.size();
   reverse_credit_stages_.resize(reverse_channel_count);
+  for (RingBuffer<TimedMetadataFlit>& stages : reverse_credit_stages_) {
+    stages.Reserve(reverse_pipeline_stages_);
+  }
   internal_reverse_propagated_cycle_ =
       std::vector(reverse_channel_count, simulator.GetCurrentCycle());
 
@@ -437,8 +670,12 @@ absl::Status SimNetworkInterfaceSrc::InitializeImpl(NocSimulator& simulator) {
 absl::Status SimNetworkInterfaceSrc::SendFlitAtTime(TimedDataFlit flit) {
   int64_t vc_index = flit.flit.vc;
 
+  // The flit is injected once it is presented to the source, even though it
+  // may wait for credits before it enters the network.
+  flit.metadata.injection_cycle_time = flit.cycle;
+
   if (vc_index < data_to_send_.size()) {
-    data_to_send_[vc_index].push(flit);
+    data_to_send_[vc_index].push(std::move(flit));
     return absl::OkStatus();
   }
   return absl::OutOfRangeError(
@@ -446,6 +683,22 @@ absl::Status SimNetworkInterfaceSrc::SendFlitAtTime(TimedDataFlit flit) {
                       data_to_send_.size()));
 }
 
+int64_t SimNetworkInterfaceSrc::NextSendCycle() const {
+  int64_t next_cycle = std::numeric_limits<int64_t>::max();
+  for (const std::queue<TimedDataFlit>& send_queue : data_to_send_) {
+    if (!send_queue.empty()) {
+      next_cycle = std::min(next_cycle, send_queue.front().cycle);
+    }
+  }
+  return next_cycle;
+}
+
+bool SimNetworkInterfaceSrc::IsQuiescent() const {
+  return std::all_of(
+      credit_update_.begin(), credit_update_.end(),
+      [](const CreditState& update) { return update.credit == 0; });
+}
+
 absl::Status SimNetworkInterfaceSink::InitializeImpl(NocSimulator& simulator) {
   XLS_ASSIGN_OR_RETURN(
       NetworkComponentParam nc_param,
@@ -458,9 +711,11 @@ absl::Status SimNetworkInterfaceSink::InitializeImpl(NocSimulator& simulator) {
   int64_t virtual_channel_count = port_param.VirtualChannelCount();
 
   input_buffers_.resize(virtual_channel_count);
+  vc_statistics_.resize(virtual_channel_count);
 
   for (int64_t vc = 0; vc < virtual_channel_count; ++vc) {
     input_buffers_[vc].max_queue_size = vc_params[vc].GetDepth();
+    input_buffers_[vc].queue.Reserve(vc_params[vc].GetDepth());
   }
 
   NetworkManager* network_manager = simulator.GetNetworkManager();
@@ -476,6 +731,24 @@ absl::Status SimNetworkInterfaceSink::InitializeImpl(NocSimulator& simulator) {
 int64_t SimInputBufferedVCRouter::GetUtilizationCycleCount() const {
   return utilization_cycle_count_;
 }
+
+bool SimInputBufferedVCRouter::IsQuiescent() const {
+  for (const std::vector<DataFlitQueue>& port_buffers : input_buffers_) {
+    for (const DataFlitQueue& buffer : port_buffers) {
+      if (!buffer.queue.empty()) {
+        return false;
+      }
+    }
+  }
+  for (const std::vector<CreditState>& port_updates : credit_update_) {
+    for (const CreditState& update : port_updates) {
+      if (update.credit != 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
 absl::Status SimInputBufferedVCRouter::InitializeImpl(NocSimulator& simulator) {
   NetworkManager* network_manager = simulator.GetNetworkManager();
   NetworkComponent& nc = network_manager->GetNetworkComponent(id_);
@@ -509,6 +782,7 @@ absl::Status SimInputBufferedVCRouter::InitializeImpl(NocSimulator& simulator) {
     input_buffers_[i].resize(port_param.VirtualChannelCount());
     for (int64_t vc = 0; vc < port_param.VirtualChannelCount(); ++vc) {
       input_buffers_[i][vc].max_queue_size = vc_params[vc].GetDepth();
+      input_buffers_[i][vc].queue.Reserve(vc_params[vc].GetDepth());
     }
     input_credit_to_send_[i].resize(port_param.VirtualChannelCount());
     if (max_vc_ < port_param.VirtualChannelCount()) {
@@ -792,8 +1066,9 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
 
     if (input.forward_channels.flit.type != FlitType::kInvalid) {
       int64_t vc = input.forward_channels.flit.vc;
-      input_buffers_[i][vc].queue.push(
-          {input.forward_channels.flit, input.forward_channels.metadata});
+      DataFlitQueueElement& element = input_buffers_[i][vc].queue.AppendSlot();
+      element.flit = input.forward_channels.flit;
+      element.metadata = input.forward_channels.metadata;
 
       XLS_VLOG(2) << absl::StrFormat(
           "... router %x from %x received data %s port %d vc %d",
@@ -815,8 +1090,10 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
         continue;
       }
 
-      DataFlit flit = input_buffers_[i][vc].queue.front().flit;
-      TimedDataFlitInfo metadata = input_buffers_[i][vc].queue.front().metadata;
+      // Referenced in place; the element is only popped once sent.
+      const DataFlit& flit = input_buffers_[i][vc].queue.front().flit;
+      const TimedDataFlitInfo& metadata =
+          input_buffers_[i][vc].queue.front().metadata;
       int64_t destination_index = flit.destination_index;
 
       PortIndexAndVCIndex input{i, vc};
@@ -857,7 +1134,7 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
 
       // Update credit to send back to input.
       ++input_credit_to_send_[i][vc];
-      input_buffers_[i][vc].queue.pop();
+      input_buffers_[i][vc].queue.pop_front();
 
       flit_sent = true;
 
@@ -983,6 +1260,35 @@ bool SimInputBufferedVCRouter::TryReversePropagation(NocSimulator& simulator) {
   return false;
 }
 
+void SimNetworkInterfaceSink::RecordStatistics(
+    const TimedDataFlit& received_flit) {
+  ++received_flit_count_;
+  max_received_cycle_ = std::max(max_received_cycle_, received_flit.cycle);
+
+  SinkVcStatistics& stats = vc_statistics_[received_flit.flit.vc];
+  ++stats.flit_count;
+  stats.bit_count += received_flit.flit.data_bit_count;
+
+  int64_t injection_cycle = received_flit.metadata.injection_cycle_time;
+  if (received_flit.flit.type == FlitType::kHead) {
+    stats.head_injection_cycle = injection_cycle;
+  } else if (received_flit.flit.type == FlitType::kTail) {
+    if (stats.head_injection_cycle.has_value()) {
+      injection_cycle = *stats.head_injection_cycle;
+      stats.head_injection_cycle.reset();
+    }
+    int64_t arrival_cycle = received_flit.cycle;
+    ++stats.packet_count;
+    stats.min_injection_cycle =
+        std::min(stats.min_injection_cycle, injection_cycle);
+    stats.max_injection_cycle =
+        std::max(stats.max_injection_cycle, injection_cycle);
+    stats.min_arrival_cycle = std::min(stats.min_arrival_cycle, arrival_cycle);
+    stats.max_arrival_cycle = std::max(stats.max_arrival_cycle, arrival_cycle);
+    stats.latency.Add(arrival_cycle - injection_cycle);
+  }
+}
+
 bool SimNetworkInterfaceSink::TryForwardPropagation(NocSimulator& simulator) {
   int64_t current_cycle = simulator.GetCurrentCycle();
 
@@ -1006,7 +1312,10 @@ bool SimNetworkInterfaceSink::TryForwardPropagation(NocSimulator& simulator) {
     received_flit.metadata = src.forward_channels.metadata;
     received_flit.metadata.timed_route_info.route.push_back(
         TimedRouteItem{id_, current_cycle});
-    received_traffic_.push_back(received_flit);
+    RecordStatistics(received_flit);
+    if (record_received_traffic_) {
+      received_traffic_.push_back(std::move(received_flit));
+    }
 
     // Send one credit back
     src.reverse_channels[vc].cycle = current_cycle;
@@ -16,14 +16,20 @@
 #define XLS_NOC_SIMULATION_SIM_OBJECTS_H_
 
 #include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <queue>
 #include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/flit.h"
 #include "xls/noc/simulation/global_routing_table.h"
+#include "xls/noc/simulation/histogram.h"
 #include "xls/noc/simulation/parameters.h"
+#include "xls/noc/simulation/ring_buffer.h"
 #include "xls/noc/simulation/simulator_shims.h"
 
 // This file contains classes used to store, access, and define simulation
@@ -54,14 +60,17 @@ struct DataFlitQueueElement {
 };
 
 // Represents a fifo/buffer used to store phits.
+//
+// The queue is reserved to max_queue_size slots, which credit-based flow
+// control never exceeds.
 struct DataFlitQueue {
-  std::queue<DataFlitQueueElement> queue;
+  RingBuffer<DataFlitQueueElement> queue;
   int64_t max_queue_size;
 };
 
 // Represents a fifo/buffer used to store metadata phits.
 struct MetadataFlitQueue {
-  std::queue<MetadataFlit> queue;
+  RingBuffer<MetadataFlit> queue;
   int64_t max_queue_size;
 };
 
@@ -84,6 +93,11 @@ class SimNetworkComponentBase {
   // Returns the associated NetworkComponentId.
   NetworkComponentId GetId() const { return id_; }
 
+  // Returns true if the component holds no flits or pending credit updates,
+  // i.e., simulating another cycle would not change its state provided its
+  // connections carry no flits or credits either.
+  virtual bool IsQuiescent() const { return true; }
+
   virtual ~SimNetworkComponentBase() = default;
 
  protected:
@@ -156,6 +170,8 @@ class SimLink : public SimNetworkComponentBase {
   // Get the sink connection index that in used in the simulator.
   int64_t GetSinkConnectionIndex() const;
 
+  bool IsQuiescent() const override;
+
  private:
   SimLink() = default;
 
@@ -173,10 +189,10 @@ class SimLink : public SimNetworkComponentBase {
   int64_t src_connection_index_;
   int64_t sink_connection_index_;
 
-  std::queue<TimedDataFlit> forward_data_stages_;
+  RingBuffer<TimedDataFlit> forward_data_stages_;
   int64_t internal_forward_propagated_cycle_;
 
-  std::vector<std::queue<TimedMetadataFlit>> reverse_credit_stages_;
+  std::vector<RingBuffer<TimedMetadataFlit>> reverse_credit_stages_;
   std::vector<int64_t> internal_reverse_propagated_cycle_;
 };
 
@@ -193,6 +209,14 @@ class SimNetworkInterfaceSrc : public SimNetworkComponentBase {
   // Register a flit to be sent at a specific time.
   absl::Status SendFlitAtTime(TimedDataFlit flit);
 
+  // Returns the earliest cycle a registered flit is to be sent, or the
+  // maximum int64_t if there is none.
+  int64_t NextSendCycle() const;
+
+  // Note: flits registered to be sent in the future do not make a source
+  // active; see NextSendCycle().
+  bool IsQuiescent() const override;
+
  private:
   SimNetworkInterfaceSrc() = default;
 
@@ -206,6 +230,30 @@ class SimNetworkInterfaceSrc : public SimNetworkComponentBase {
   std::vector<std::queue<TimedDataFlit>> data_to_send_;
 };
 
+// Statistics of the traffic received by a sink on a virtual channel.
+//
+// These are updated as each flit arrives, so are available even if the sink
+// does not record the received traffic.
+struct SinkVcStatistics {
+  int64_t flit_count = 0;
+  int64_t bit_count = 0;
+  int64_t packet_count = 0;
+
+  // Packets take their injection time from their head flit (or from their
+  // tail flit if they have no head flit) and their arrival time from their
+  // tail flit.
+  int64_t min_injection_cycle = std::numeric_limits<int64_t>::max();
+  int64_t max_injection_cycle = std::numeric_limits<int64_t>::min();
+  int64_t min_arrival_cycle = std::numeric_limits<int64_t>::max();
+  int64_t max_arrival_cycle = std::numeric_limits<int64_t>::min();
+
+  // Latency, in cycles, from injection to arrival of each packet.
+  Histogram latency;
+
+  // Injection time of the head flit of the packet being received, if any.
+  std::optional<int64_t> head_injection_cycle;
+};
+
 // Sink - traffic leaves the network via a sink.
 class SimNetworkInterfaceSink : public SimNetworkComponentBase {
  public:
@@ -216,36 +264,44 @@ class SimNetworkInterfaceSink : public SimNetworkComponentBase {
     return ret;
   }
 
+  // Sets whether the sink keeps every flit it receives, to be returned by
+  // GetReceivedTraffic().  On by default; long simulations which only need
+  // the streaming statistics below should turn this off.
+  void SetRecordReceivedTraffic(bool record) {
+    record_received_traffic_ = record;
+  }
+
   // Returns all traffic received by this sink from the beginning
-  // of the simulation.
+  // of the simulation, or from when recording was last turned on.
   absl::Span<const TimedDataFlit> GetReceivedTraffic() {
     return received_traffic_;
   }
 
+  // Returns the number of flits received by this sink from the beginning of
+  // the simulation.
+  int64_t GetReceivedFlitCount() const { return received_flit_count_; }
+
+  // Returns the statistics of the traffic received on vc.
+  const SinkVcStatistics& GetVcStatistics(int64_t vc) const {
+    return vc_statistics_.at(vc);
+  }
+
   // Returns the observed rate of traffic in MebiBytes Per Second from the
   // beginning of simulation to the last flit processed by this sink.
   //
   // VC is used to filter out the traffic as received on a specific vc index.
   // Negative VC is used to match any vc.
-  double MeasuredTrafficRateInMiBps(int64_t cycle_time_ps, int64_t vc = -1) {
+  double MeasuredTrafficRateInMiBps(int64_t cycle_time_ps,
+                                    int64_t vc = -1) const {
     // TODO(tedhong): 2021-07-01 Factor this logic out into common library.
     int64_t num_bits = 0;
-    int64_t max_cycle = 0;
-    for (TimedDataFlit& f : received_traffic_) {
-      if (vc < 0) {
-        num_bits += f.flit.data_bit_count;
-      } else {
-        if (f.flit.vc == vc) {
-          num_bits += f.flit.data_bit_count;
-        }
-      }
-
-      if (max_cycle < f.cycle) {
-        max_cycle = f.cycle;
+    for (int64_t i = 0; i < vc_statistics_.size(); ++i) {
+      if (vc < 0 || vc == i) {
+        num_bits += vc_statistics_[i].bit_count;
       }
     }
 
-    double total_sec = static_cast<double>(max_cycle + 1) *
+    double total_sec = static_cast<double>(max_received_cycle_ + 1) *
                        static_cast<double>(cycle_time_ps) * 1.0e-12;
     double bits_per_sec = static_cast<double>(num_bits) / total_sec;
     return bits_per_sec / 1024.0 / 1024.0 / 8.0;
@@ -258,9 +314,18 @@ class SimNetworkInterfaceSink : public SimNetworkComponentBase {
 
   bool TryForwardPropagation(NocSimulator& simulator) override;
 
+  // Updates the statistics with a flit received on the current cycle.
+  void RecordStatistics(const TimedDataFlit& received_flit);
+
   int64_t src_connection_index_;
   std::vector<DataFlitQueue> input_buffers_;
+
+  bool record_received_traffic_ = true;
   std::vector<TimedDataFlit> received_traffic_;
+
+  int64_t received_flit_count_ = 0;
+  int64_t max_received_cycle_ = 0;
+  std::vector<SinkVcStatistics> vc_statistics_;
 };
 
 // Represents an input-buffered, fixed priority, credit-based, virtual-channel
@@ -296,6 +361,8 @@ class SimInputBufferedVCRouter : public SimNetworkComponentBase {
 
   int64_t GetUtilizationCycleCount() const;
 
+  bool IsQuiescent() const override;
+
  private:
   SimInputBufferedVCRouter() = default;
 
@@ -369,6 +436,7 @@ class NocSimulator {
  public:
   NocSimulator()
       : mgr_(nullptr), params_(nullptr), routing_(nullptr), cycle_(-1) {}
+  ~NocSimulator();
 
   // Creates all simulation objects for a given network.
   // NetworkManager, NocParameters, and DistributedRoutingTable should
@@ -381,6 +449,9 @@ class NocSimulator {
     network_ = network;
     cycle_ = -1;
 
+    // Routers look up a route for every flit, so use the dense tables.
+    XLS_RETURN_IF_ERROR(routing.Compile());
+
     return CreateSimulationObjects(network);
   }
 
@@ -445,9 +516,31 @@ class NocSimulator {
   // Run a single cycle of the simulator.
   absl::Status RunCycle(int64_t max_ticks = 9999);
 
+  // Runs "cycle_count" cycles of the simulator. Cycles in which nothing can
+  // happen -- no flits or credits are in flight, and neither the sources nor
+  // the registered services have anything to do until a later cycle -- are
+  // skipped rather than simulated; results are identical to calling
+  // RunCycle() "cycle_count" times.
+  absl::Status RunCycles(int64_t cycle_count, int64_t max_ticks = 9999);
+
+  // Returns the number of cycles RunCycles() skipped rather than simulated.
+  int64_t GetSkippedCycleCount() const { return skipped_cycle_count_; }
+
+  // Returns true if no flits or credits are in flight anywhere in the
+  // network.
+  bool IsQuiescent() const;
+
   // Runs a single tick of the simulator.
   bool Tick();
 
+  // Ticks the components of each kind (sources, links, routers and sinks) on
+  // up to "thread_count" threads, synchronizing between kinds. Results are
+  // identical to single-threaded simulation. Must be called after
+  // Initialize(); fails if any connection joins two components of the same
+  // kind, since those could then be ticked concurrently. A count of 1
+  // restores single-threaded simulation.
+  absl::Status SetThreadCount(int64_t thread_count);
+
   // Register a service to run once at the beginning of each cycle.
   // TODO(tedhong): 2021-07-27 Add a scheme to provide a total order
   //                of services.
@@ -483,12 +576,25 @@ class NocSimulator {
   absl::Status CreateLink(NetworkComponentId nc_id);
   absl::Status CreateRouter(NetworkComponentId nc_id);
 
+  // Returns the next cycle in which anything can happen in the network; this
+  // is later than the next cycle only if the network is quiescent.
+  int64_t NextActiveCycle();
+
+  // Runs Tick() on each of the given components, spread over tick_pool_.
+  template <typename ComponentT>
+  bool ParallelTick(absl::Span<ComponentT> components);
+
+  // Persistent worker threads used by Tick() when SetThreadCount() > 1.
+  class TickThreadPool;
+  std::unique_ptr<TickThreadPool> tick_pool_;
+
   NetworkManager* mgr_;
   NocParameters* params_;
   DistributedRoutingTable* routing_;
 
   NetworkId network_;
   int64_t cycle_;
+  int64_t skipped_cycle_count_ = 0;
 
   // Map a specific ConnectionId to an index used to access
   // a specific SimConnectionState via the connections_ object.
@@ -114,6 +114,146 @@ TEST(SimObjectsTest, BackToBackNetwork0) {
   EXPECT_EQ(traffic_recv_port_0[0].flit.data, UBits(707, 64));
   EXPECT_EQ(traffic_recv_port_0[4].cycle, 9);
   EXPECT_EQ(traffic_recv_port_0[4].flit.data, UBits(707, 64));
+
+  // All flits were presented to the source on cycle 1, so each waited a
+  // cycle longer than the last for the link.
+  EXPECT_EQ(sim_recv_port_0->GetReceivedFlitCount(), 5);
+  const SinkVcStatistics& stats = sim_recv_port_0->GetVcStatistics(0);
+  EXPECT_EQ(stats.flit_count, 5);
+  EXPECT_EQ(stats.bit_count, 5 * 64);
+  EXPECT_EQ(stats.packet_count, 5);
+  EXPECT_EQ(stats.min_injection_cycle, 1);
+  EXPECT_EQ(stats.max_injection_cycle, 1);
+  EXPECT_EQ(stats.min_arrival_cycle, 5);
+  EXPECT_EQ(stats.max_arrival_cycle, 9);
+  EXPECT_EQ(stats.latency.Min(), 4);
+  EXPECT_EQ(stats.latency.Max(), 8);
+  EXPECT_DOUBLE_EQ(stats.latency.Mean(), 6.0);
+}
+
+// Verifies that RunCycles() skips the cycles in which the network is idle
+// without changing when flits arrive.
+TEST(SimObjectsTest, RunCyclesSkipsIdleCycles) {
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_ASSERT_OK(BuildNetworkGraphLinear000(&proto, &graph, &params));
+
+  DistributedRoutingTableBuilderForTrees route_builder;
+  XLS_ASSERT_OK_AND_ASSIGN(DistributedRoutingTable routing_table,
+                           route_builder.BuildNetworkRoutingTables(
+                               graph.GetNetworkIds()[0], graph, params));
+
+  NocSimulator simulator;
+  XLS_ASSERT_OK(simulator.Initialize(graph, params, routing_table,
+                                     graph.GetNetworkIds()[0]));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetworkComponentId send_port_0,
+      FindNetworkComponentByName("SendPort0", graph, params));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetworkComponentId recv_port_0,
+      FindNetworkComponentByName("RecvPort0", graph, params));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      int64_t dest_index_0,
+      simulator.GetRoutingTable()->GetSinkIndices().GetNetworkComponentIndex(
+          recv_port_0));
+  XLS_ASSERT_OK_AND_ASSIGN(SimNetworkInterfaceSrc * sim_send_port_0,
+                           simulator.GetSimNetworkInterfaceSrc(send_port_0));
+
+  // As in BackToBackNetwork0, a flit takes 4 cycles to arrive.
+  for (int64_t cycle : {1, 1000}) {
+    XLS_ASSERT_OK_AND_ASSIGN(TimedDataFlit flit,
+                             DataFlitBuilder()
+                                 .Cycle(cycle)
+                                 .Type(FlitType::kTail)
+                                 .VirtualChannel(0)
+                                 .SourceIndex(0)
+                                 .DestinationIndex(dest_index_0)
+                                 .Data(UBits(cycle, 64))
+                                 .BuildTimedFlit());
+    XLS_ASSERT_OK(sim_send_port_0->SendFlitAtTime(flit));
+  }
+
+  XLS_ASSERT_OK(simulator.RunCycles(1100));
+  EXPECT_EQ(simulator.GetCurrentCycle(), 1099);
+  EXPECT_TRUE(simulator.IsQuiescent());
+  // Only the cycles around the two flits need to be simulated.
+  EXPECT_GT(simulator.GetSkippedCycleCount(), 1000);
+
+  XLS_ASSERT_OK_AND_ASSIGN(SimNetworkInterfaceSink * sim_recv_port_0,
+                           simulator.GetSimNetworkInterfaceSink(recv_port_0));
+  absl::Span<const TimedDataFlit> traffic_recv_port_0 =
+      sim_recv_port_0->GetReceivedTraffic();
+  ASSERT_EQ(traffic_recv_port_0.size(), 2);
+  EXPECT_EQ(traffic_recv_port_0[0].cycle, 5);
+  EXPECT_EQ(traffic_recv_port_0[0].flit.data, UBits(1, 64));
+  EXPECT_EQ(traffic_recv_port_0[1].cycle, 1004);
+  EXPECT_EQ(traffic_recv_port_0[1].flit.data, UBits(1000, 64));
+}
+
+// Verifies that a sink which does not record the received traffic still
+// keeps its statistics.
+TEST(SimObjectsTest, SinkStatisticsWithoutRecordedTraffic) {
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_ASSERT_OK(BuildNetworkGraphLinear000(&proto, &graph, &params));
+
+  DistributedRoutingTableBuilderForTrees route_builder;
+  XLS_ASSERT_OK_AND_ASSIGN(DistributedRoutingTable routing_table,
+                           route_builder.BuildNetworkRoutingTables(
+                               graph.GetNetworkIds()[0], graph, params));
+
+  NocSimulator simulator;
+  XLS_ASSERT_OK(simulator.Initialize(graph, params, routing_table,
+                                     graph.GetNetworkIds()[0]));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetworkComponentId send_port_0,
+      FindNetworkComponentByName("SendPort0", graph, params));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetworkComponentId recv_port_0,
+      FindNetworkComponentByName("RecvPort0", graph, params));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      int64_t dest_index_0,
+      simulator.GetRoutingTable()->GetSinkIndices().GetNetworkComponentIndex(
+          recv_port_0));
+  XLS_ASSERT_OK_AND_ASSIGN(SimNetworkInterfaceSrc * sim_send_port_0,
+                           simulator.GetSimNetworkInterfaceSrc(send_port_0));
+  XLS_ASSERT_OK_AND_ASSIGN(SimNetworkInterfaceSink * sim_recv_port_0,
+                           simulator.GetSimNetworkInterfaceSink(recv_port_0));
+  sim_recv_port_0->SetRecordReceivedTraffic(false);
+
+  // A two flit packet followed by a single flit packet.
+  for (FlitType type : {FlitType::kHead, FlitType::kTail, FlitType::kTail}) {
+    XLS_ASSERT_OK_AND_ASSIGN(TimedDataFlit flit,
+                             DataFlitBuilder()
+                                 .Cycle(1)
+                                 .Type(type)
+                                 .VirtualChannel(0)
+                                 .SourceIndex(0)
+                                 .DestinationIndex(dest_index_0)
+                                 .Data(UBits(0, 32))
+                                 .BuildTimedFlit());
+    XLS_ASSERT_OK(sim_send_port_0->SendFlitAtTime(flit));
+  }
+
+  XLS_ASSERT_OK(simulator.RunCycles(20));
+  EXPECT_TRUE(sim_recv_port_0->GetReceivedTraffic().empty());
+  EXPECT_EQ(sim_recv_port_0->GetReceivedFlitCount(), 3);
+
+  // The flits arrive on cycles 5, 6 and 7.
+  const SinkVcStatistics& stats = sim_recv_port_0->GetVcStatistics(0);
+  EXPECT_EQ(stats.bit_count, 3 * 32);
+  EXPECT_EQ(stats.packet_count, 2);
+  EXPECT_EQ(stats.min_arrival_cycle, 6);
+  EXPECT_EQ(stats.max_arrival_cycle, 7);
+  EXPECT_EQ(stats.latency.Min(), 5);
+  EXPECT_EQ(stats.latency.Max(), 6);
+  EXPECT_DOUBLE_EQ(sim_recv_port_0->MeasuredTrafficRateInMiBps(100),
+                   3.0 * 32.0 / (8.0 * 100.0 * 1.0e-12) / 1024.0 / 1024.0 /
+                       8.0);
 }
 
 TEST(SimObjectsTest, TreeNetwork0) {
@@ -295,6 +435,105 @@ TEST(SimObjectsTest, TreeNetwork0) {
       38146);
 }
 
+// Runs the traffic of TreeNetwork0 on several threads; arrivals must match
+// single-threaded simulation exactly.
+TEST(SimObjectsTest, TreeNetwork0MultiThreaded) {
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_ASSERT_OK(BuildNetworkGraphTree000(&proto, &graph, &params));
+
+  DistributedRoutingTableBuilderForTrees route_builder;
+  XLS_ASSERT_OK_AND_ASSIGN(DistributedRoutingTable routing_table,
+                           route_builder.BuildNetworkRoutingTables(
+                               graph.GetNetworkIds()[0], graph, params));
+
+  NocSimulator simulator;
+  EXPECT_FALSE(simulator.SetThreadCount(3).ok());
+  XLS_ASSERT_OK(simulator.Initialize(graph, params, routing_table,
+                                     graph.GetNetworkIds()[0]));
+  XLS_ASSERT_OK(simulator.SetThreadCount(3));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetworkComponentId send_port_0,
+      FindNetworkComponentByName("SendPort0", graph, params));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetworkComponentId send_port_1,
+      FindNetworkComponentByName("SendPort1", graph, params));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetworkComponentId recv_port_1,
+      FindNetworkComponentByName("RecvPort1", graph, params));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetworkComponentId recv_port_3,
+      FindNetworkComponentByName("RecvPort3", graph, params));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      int64_t dest_index_1,
+      simulator.GetRoutingTable()->GetSinkIndices().GetNetworkComponentIndex(
+          recv_port_1));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      int64_t dest_index_3,
+      simulator.GetRoutingTable()->GetSinkIndices().GetNetworkComponentIndex(
+          recv_port_3));
+
+  XLS_ASSERT_OK_AND_ASSIGN(TimedDataFlit flit0,
+                           DataFlitBuilder()
+                               .Cycle(1)
+                               .Type(FlitType::kTail)
+                               .VirtualChannel(0)
+                               .SourceIndex(0)
+                               .DestinationIndex(dest_index_1)
+                               .Data(UBits(707, 64))
+                               .BuildTimedFlit());
+  XLS_ASSERT_OK_AND_ASSIGN(TimedDataFlit flit1,
+                           DataFlitBuilder()
+                               .Cycle(1)
+                               .Type(FlitType::kTail)
+                               .VirtualChannel(1)
+                               .SourceIndex(0)
+                               .DestinationIndex(dest_index_3)
+                               .Data(UBits(1001, 64))
+                               .BuildTimedFlit());
+  XLS_ASSERT_OK_AND_ASSIGN(TimedDataFlit flit2,
+                           DataFlitBuilder()
+                               .Cycle(3)
+                               .Type(FlitType::kTail)
+                               .VirtualChannel(1)
+                               .SourceIndex(0)
+                               .DestinationIndex(dest_index_3)
+                               .Data(UBits(2002, 64))
+                               .BuildTimedFlit());
+
+  XLS_ASSERT_OK_AND_ASSIGN(SimNetworkInterfaceSrc * sim_send_port_0,
+                           simulator.GetSimNetworkInterfaceSrc(send_port_0));
+  XLS_ASSERT_OK(sim_send_port_0->SendFlitAtTime(flit0));
+  XLS_ASSERT_OK_AND_ASSIGN(SimNetworkInterfaceSrc * sim_send_port_1,
+                           simulator.GetSimNetworkInterfaceSrc(send_port_1));
+  XLS_ASSERT_OK(sim_send_port_1->SendFlitAtTime(flit1));
+  XLS_ASSERT_OK(sim_send_port_1->SendFlitAtTime(flit2));
+
+  for (int64_t i = 0; i < 10; ++i) {
+    XLS_ASSERT_OK(simulator.RunCycle());
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(SimNetworkInterfaceSink * sim_recv_port_1,
+                           simulator.GetSimNetworkInterfaceSink(recv_port_1));
+  XLS_ASSERT_OK_AND_ASSIGN(SimNetworkInterfaceSink * sim_recv_port_3,
+                           simulator.GetSimNetworkInterfaceSink(recv_port_3));
+  absl::Span<const TimedDataFlit> traffic_recv_port_1 =
+      sim_recv_port_1->GetReceivedTraffic();
+  absl::Span<const TimedDataFlit> traffic_recv_port_3 =
+      sim_recv_port_3->GetReceivedTraffic();
+
+  ASSERT_EQ(traffic_recv_port_1.size(), 1);
+  ASSERT_EQ(traffic_recv_port_3.size(), 2);
+  EXPECT_EQ(traffic_recv_port_1[0].cycle, 3);
+  EXPECT_EQ(traffic_recv_port_1[0].flit.data, UBits(707, 64));
+  EXPECT_EQ(traffic_recv_port_3[0].cycle, 2);
+  EXPECT_EQ(traffic_recv_port_3[0].flit.data, UBits(1001, 64));
+  EXPECT_EQ(traffic_recv_port_3[1].cycle, 3);
+  EXPECT_EQ(traffic_recv_port_3[1].flit.data, UBits(2002, 64));
+}
+
 }  // namespace
 }  // namespace noc
 }  // namespace xls
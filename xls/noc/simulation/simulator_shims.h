@@ -15,6 +15,9 @@
 #ifndef XLS_NOC_SIMULATION_SIMULATOR_SHIMS_H_
 #define XLS_NOC_SIMULATION_SIMULATOR_SHIMS_H_
 
+#include <cstdint>
+
+#include "absl/status/status.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/flit.h"
 
@@ -28,6 +31,19 @@ namespace xls::noc {
 class NocSimulatorServiceShim {
  public:
   virtual absl::Status RunCycle() = 0;
+
+  // Returns the earliest cycle, no earlier than "cycle", in which the service
+  // may act on or observe anything in an otherwise quiescent network.
+  // NocSimulator::RunCycles() does not skip past that cycle. By default,
+  // services are assumed to be active every cycle.
+  virtual int64_t NextActiveCycle(int64_t cycle) { return cycle; }
+
+  // Called in place of RunCycle() for "cycle_count" successive cycles which
+  // the simulator skipped; these all precede NextActiveCycle().
+  virtual absl::Status SkipCycles(int64_t cycle_count) {
+    return absl::OkStatus();
+  }
+
   virtual ~NocSimulatorServiceShim() = default;
 };
 
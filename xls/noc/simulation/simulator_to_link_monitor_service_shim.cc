@@ -14,25 +14,63 @@
 
 #include "xls/noc/simulation/simulator_to_link_monitor_service_shim.h"
 
+#include <algorithm>
+#include <cstdint>
+
+#include "xls/common/logging/logging.h"
+#include "xls/noc/simulation/flit.h"
+
 namespace xls::noc {
 
 NocSimulatorToLinkMonitorServiceShim::NocSimulatorToLinkMonitorServiceShim(
     NocSimulator& simulator)
     : simulator_(simulator) {}
 
+void NocSimulatorToLinkMonitorServiceShim::SetUtilizationWindow(
+    int64_t cycle_count) {
+  XLS_CHECK_GT(cycle_count, 0);
+  utilization_window_ = cycle_count;
+}
+
+void NocSimulatorToLinkMonitorServiceShim::RecordUtilization(
+    NetworkComponentId link_id, int64_t window) {
+  LinkUtilization& utilization = link_utilization_map_[link_id];
+
+  // Close the windows since the link last carried a flit; all but the first
+  // of those were idle.
+  if (window != utilization.window) {
+    utilization.window_flit_counts.Add(utilization.window_flit_count);
+    utilization.window_flit_counts.Add(0, window - utilization.window - 1);
+    utilization.window = window;
+    utilization.window_flit_count = 0;
+  }
+
+  ++utilization.flit_count;
+  ++utilization.window_flit_count;
+  utilization.peak_window_flit_count = std::max(
+      utilization.peak_window_flit_count, utilization.window_flit_count);
+}
+
 absl::Status NocSimulatorToLinkMonitorServiceShim::RunCycle() {
-  // Count the number of packet passing through the link. A tail flit indicates
-  // the end of a packet.
+  int64_t cycle = simulator_.GetCurrentCycle();
   for (const SimLink& link : simulator_.GetLinks()) {
     SimConnectionState& src =
         simulator_.GetSimConnectionByIndex(link.GetSourceConnectionIndex());
     const DataFlit& flit = src.forward_channels.flit;
+
+    // Count the number of packet passing through the link. A tail flit
+    // indicates the end of a packet.
     if (flit.type == FlitType::kTail) {
       DestinationToPacketCount& destination_to_pkt_count_map =
           link_to_packet_count_map_[link.GetId()];
       destination_to_pkt_count_map[FlitDestination{flit.destination_index,
                                                    flit.vc}]++;
     }
+
+    if (flit.type != FlitType::kInvalid &&
+        src.forward_channels.cycle == cycle) {
+      RecordUtilization(link.GetId(), cycle / utilization_window_);
+    }
   }
   return absl::OkStatus();
 }
@@ -15,7 +15,12 @@
 #ifndef XLS_NOC_SIMULATION_NOC_SIMULATOR_TO_LINK_MONITOR_SERVICE_SHIM_H_
 #define XLS_NOC_SIMULATION_NOC_SIMULATOR_TO_LINK_MONITOR_SERVICE_SHIM_H_
 
+#include <cstdint>
+#include <limits>
+
+#include "absl/container/flat_hash_map.h"
 #include "xls/noc/simulation/common.h"
+#include "xls/noc/simulation/histogram.h"
 #include "xls/noc/simulation/sim_objects.h"
 
 namespace xls::noc {
@@ -43,6 +48,21 @@ inline bool operator==(const FlitDestination& lhs, const FlitDestination& rhs) {
 
 using DestinationToPacketCount = absl::flat_hash_map<FlitDestination, int64_t>;
 
+// Utilization of a link, measured in consecutive windows of cycles.
+struct LinkUtilization {
+  // Flits carried over the whole simulation.
+  int64_t flit_count = 0;
+  // Most flits carried in any one window.
+  int64_t peak_window_flit_count = 0;
+  // Flits carried in each completed window, up to the window in which the
+  // link last carried a flit.
+  Histogram window_flit_counts;
+
+  // Index of the window being measured and the flits carried in it so far.
+  int64_t window = 0;
+  int64_t window_flit_count = 0;
+};
+
 // Shim to collect information from the links of the simulator.
 class NocSimulatorToLinkMonitorServiceShim
     : public NocSimulatorServiceShim {
@@ -50,13 +70,36 @@ class NocSimulatorToLinkMonitorServiceShim
   explicit NocSimulatorToLinkMonitorServiceShim(NocSimulator& simulator);
   absl::Status RunCycle() override;
 
+  // The monitor only counts flits on links, of which there are none while the
+  // network is quiescent, so it never needs a cycle to be simulated.
+  int64_t NextActiveCycle(int64_t cycle) override {
+    return std::numeric_limits<int64_t>::max();
+  }
+
   const absl::flat_hash_map<NetworkComponentId, DestinationToPacketCount>&
   GetLinkToPacketCountMap() const;
 
+  // Sets the number of cycles in each utilization window; must be called
+  // before the simulation starts.
+  void SetUtilizationWindow(int64_t cycle_count);
+  int64_t GetUtilizationWindow() const { return utilization_window_; }
+
+  // Returns the utilization of each link which carried at least one flit.
+  const absl::flat_hash_map<NetworkComponentId, LinkUtilization>&
+  GetLinkUtilizationMap() const {
+    return link_utilization_map_;
+  }
+
  private:
+  // Counts a flit carried by the link during the given window.
+  void RecordUtilization(NetworkComponentId link_id, int64_t window);
+
   // Contains the packet count for each destination/vc pair at each link.
   absl::flat_hash_map<NetworkComponentId, DestinationToPacketCount>
       link_to_packet_count_map_;
+  int64_t utilization_window_ = 1000;
+  absl::flat_hash_map<NetworkComponentId, LinkUtilization>
+      link_utilization_map_;
   // TODO(vmirian) 11-8-21 should be const, but other API require change. So it
   // leave for now.
   NocSimulator& simulator_;
@@ -15,6 +15,9 @@
 #ifndef XLS_NOC_SIMULATION_SIMULATOR_TO_TRAFFIC_INJECTOR_SHIM_H_
 #define XLS_NOC_SIMULATION_SIMULATOR_TO_TRAFFIC_INJECTOR_SHIM_H_
 
+#include <algorithm>
+#include <cstdint>
+
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/noc_traffic_injector.h"
 #include "xls/noc/simulation/sim_objects.h"
@@ -32,6 +35,15 @@ class NocSimulatorToNocTrafficInjectorShim
   // Called by the simulator each cycle to request for traffic.
   absl::Status RunCycle() override { return traffic_injector_->RunCycle(); }
 
+  int64_t NextActiveCycle(int64_t cycle) override {
+    return std::max(
+        traffic_injector_->NextInjectionCycle().value_or(cycle), cycle);
+  }
+
+  absl::Status SkipCycles(int64_t cycle_count) override {
+    return traffic_injector_->SkipCycles(cycle_count);
+  }
+
   // Called by the traffic injector to inject traffic.
   absl::Status SendFlitAtTime(TimedDataFlit flit,
                               NetworkComponentId source) override {
@@ -151,6 +151,9 @@ class TrafficFlow {
   // Get clock cycle times.
   absl::Span<const int64_t> GetClockCycleTimes() const { return cycle_times_; }
 
+  // Get path of the trace file the flow is replayed from.
+  std::string_view GetTraceFile() const { return trace_file_; }
+
   TrafficFlow& SetBandwidthBits(int64_t bits) {
     bandwidth_bits_ = bits;
     return *this;
@@ -185,6 +188,16 @@ class TrafficFlow {
 
   bool IsReplay() const { return !cycle_times_.empty(); }
 
+  // Set the path of a trace file (see traffic_trace.h) holding the clock
+  // cycles in which the flow sends packets.  Traces are streamed during
+  // simulation, so they may be far larger than clock cycle times.
+  TrafficFlow& SetTraceFile(std::string_view trace_file) {
+    trace_file_ = trace_file;
+    return *this;
+  }
+
+  bool IsTrace() const { return !trace_file_.empty(); }
+
  private:
   TrafficFlowId id_;
 
@@ -205,6 +218,9 @@ class TrafficFlow {
   // instances where the source sends a packet to the destination.
   // TODO(vmirian) Add support for clock cycle interval: 09-02-2021.
   std::vector<int64_t> cycle_times_;
+
+  // Replay trace file.
+  std::string trace_file_;
 };
 
 class NocTrafficManager;
@@ -15,8 +15,10 @@
 #include "xls/noc/simulation/traffic_models.h"
 
 #include <algorithm>
+#include <filesystem>  // NOLINT
 #include <iterator>
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace xls::noc {
@@ -167,4 +169,53 @@ absl::Span<const int64_t> ReplayTrafficModel::GetClockCycles() const {
   return clock_cycles_;
 }
 
+TraceTrafficModelBuilder::TraceTrafficModelBuilder(
+    int64_t packet_size_bits, std::filesystem::path trace_path)
+    : trace_path_(std::move(trace_path)) {
+  SetPacketSizeBits(packet_size_bits);
+}
+
+absl::StatusOr<std::unique_ptr<TraceTrafficModel>>
+TraceTrafficModelBuilder::Build() const {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<TraceTrafficModel> model,
+                       TrafficModelBuilder::Build());
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<TrafficTraceReader> trace_reader,
+                       TrafficTraceReader::Open(trace_path_));
+  model->SetTraceReader(std::move(trace_reader));
+  return model;
+}
+
+std::vector<DataPacket> TraceTrafficModel::GetNewCyclePackets(int64_t cycle) {
+  if (cycle > cycle_count_) {
+    cycle_count_ = cycle;
+  }
+
+  std::vector<DataPacket> packets;
+  while (trace_reader_ != nullptr && !trace_reader_->AtEnd() &&
+         trace_reader_->NextCycle() <= cycle) {
+    absl::StatusOr<DataPacket> packet =
+        DataPacketBuilder()
+            .Valid(true)
+            .ZeroedData(packet_size_bits_)
+            .VirtualChannel(vc_)
+            .SourceIndex(source_index_)
+            .DestinationIndex(destination_index_)
+            .Build();
+    XLS_CHECK(packet.ok());
+    packets.push_back(std::move(packet).value());
+    ++packet_count_;
+    XLS_CHECK_OK(trace_reader_->Advance());
+  }
+  return packets;
+}
+
+double TraceTrafficModel::ExpectedTrafficRateInMiBps(
+    int64_t cycle_time_ps) const {
+  double total_sec = static_cast<double>(cycle_count_ + 1) *
+                     static_cast<double>(cycle_time_ps) * 1.0e-12;
+  double bits_per_sec = static_cast<double>(packet_size_bits_) * packet_count_;
+  bits_per_sec = bits_per_sec / 1024.0 / 1024.0 / 8.0;
+  return bits_per_sec / total_sec;
+}
+
 }  // namespace xls::noc
@@ -16,8 +16,13 @@
 #define XLS_NOC_SIMULATION_TRAFFIC_MODELS_H_
 
 #include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <limits>
 #include <memory>
+#include <optional>
 #include <queue>
+#include <utility>
 #include <vector>
 
 #include "absl/status/statusor.h"
@@ -26,6 +31,7 @@
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/packetizer.h"
 #include "xls/noc/simulation/random_number_interface.h"
+#include "xls/noc/simulation/traffic_trace.h"
 #include "xls/noc/simulation/units.h"
 
 // This file contains classes used to model traffic of a NOC.
@@ -43,11 +49,17 @@ class TrafficModel {
   // Note: A call to this function advances the model's internal state, so
   //       a call to GetNewCyclePackets(N) should not be called multiple times.
   // Note: The simulator will successively call GetNewCyclePackets(0),
-  //       GetNewCyclePackets(1), GetNewCyclePackets(2), ...
-  //
-  // TODO(tedhong): 2021-06-27 Add an interface to support fast-forwarding.
+  //       GetNewCyclePackets(1), GetNewCyclePackets(2), ... but may skip
+  //       cycles before NextPacketCycle().
   virtual std::vector<DataPacket> GetNewCyclePackets(int64_t cycle) = 0;
 
+  // Returns the earliest cycle in which GetNewCyclePackets() may return
+  // packets (the maximum int64_t if it never will), or std::nullopt if that
+  // is not known in advance.
+  virtual std::optional<int64_t> NextPacketCycle() const {
+    return std::nullopt;
+  }
+
   // Returns expected rate of traffic injected in MebiBytes Per Sec.
   virtual double ExpectedTrafficRateInMiBps(int64_t cycle_time_ps) const = 0;
 
@@ -143,6 +155,11 @@ class GeneralizedGeometricTrafficModel : public TrafficModel {
 
   std::vector<DataPacket> GetNewCyclePackets(int64_t cycle) override;
 
+  std::optional<int64_t> NextPacketCycle() const override {
+    // The first call to GetNewCyclePackets() may send a burst.
+    return std::max<int64_t>(next_packet_cycle_, 0);
+  }
+
   double ExpectedTrafficRateInMiBps(int64_t cycle_time_ps) const override {
     double num_cycles = 1.0e12 / static_cast<double>(cycle_time_ps);
     double num_packets = lambda_ * num_cycles;
@@ -205,6 +222,13 @@ class ReplayTrafficModel : public TrafficModel {
 
   std::vector<DataPacket> GetNewCyclePackets(int64_t cycle) override;
 
+  std::optional<int64_t> NextPacketCycle() const override {
+    if (clock_cycle_iter_ == clock_cycles_.cend()) {
+      return std::numeric_limits<int64_t>::max();
+    }
+    return *clock_cycle_iter_;
+  }
+
   double ExpectedTrafficRateInMiBps(int64_t cycle_time_ps) const override;
 
   // Sets clock cycles to list and sorts the complete list of clock cycle.
@@ -233,6 +257,51 @@ class ReplayTrafficModelBuilder
   std::vector<int64_t> clock_cycles_;
 };
 
+// Models the traffic injected into a single source at the cycles streamed
+// from a trace file (see traffic_trace.h).
+//
+// Only the next packet of the trace is held in memory, so traces need not
+// fit in memory.
+class TraceTrafficModel : public TrafficModel {
+ public:
+  explicit TraceTrafficModel(int64_t packet_size_bits)
+      : TrafficModel(packet_size_bits) {}
+
+  std::vector<DataPacket> GetNewCyclePackets(int64_t cycle) override;
+
+  std::optional<int64_t> NextPacketCycle() const override {
+    if (trace_reader_ == nullptr || trace_reader_->AtEnd()) {
+      return std::numeric_limits<int64_t>::max();
+    }
+    return trace_reader_->NextCycle();
+  }
+
+  // Returns the rate of the packets read so far.
+  double ExpectedTrafficRateInMiBps(int64_t cycle_time_ps) const override;
+
+  void SetTraceReader(std::unique_ptr<TrafficTraceReader> trace_reader) {
+    trace_reader_ = std::move(trace_reader);
+  }
+
+ private:
+  int64_t cycle_count_ = 0;
+  int64_t packet_count_ = 0;
+  std::unique_ptr<TrafficTraceReader> trace_reader_;
+};
+
+class TraceTrafficModelBuilder
+    : public TrafficModelBuilder<TraceTrafficModelBuilder, TraceTrafficModel> {
+ public:
+  TraceTrafficModelBuilder(int64_t packet_size_bits,
+                           std::filesystem::path trace_path);
+
+  // Opens the trace file; each model built streams the trace anew.
+  absl::StatusOr<std::unique_ptr<TraceTrafficModel>> Build() const;
+
+ private:
+  std::filesystem::path trace_path_;
+};
+
 // Measures the traffic injected and computes aggregate statistics.
 class TrafficModelMonitor {
  public:
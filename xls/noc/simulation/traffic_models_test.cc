@@ -14,11 +14,16 @@
 
 #include "xls/noc/simulation/traffic_models.h"
 
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
+#include "xls/noc/simulation/traffic_trace.h"
 
 namespace xls::noc {
 namespace {
@@ -188,5 +193,41 @@ TEST(TrafficModelsTest, ReplayModelClockCycleClearTest) {
   EXPECT_EQ(model.GetClockCycles(), std::vector<int64_t>({6, 7, 8, 9, 10}));
 }
 
+TEST(TrafficModelsTest, TraceModelTest) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile trace, TempFile::Create(".trace"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TrafficTraceWriter> writer,
+                           TrafficTraceWriter::Create(trace.path()));
+  for (int64_t cycle : {1, 1, 4}) {
+    XLS_ASSERT_OK(writer->AddPacket(cycle));
+  }
+  XLS_ASSERT_OK(writer->Close());
+
+  int64_t packet_size_bits = 64;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<TraceTrafficModel> model,
+      TraceTrafficModelBuilder(packet_size_bits, trace.path())
+          .SetVCIndex(1)
+          .SetSourceIndex(10)
+          .SetDestinationIndex(3)
+          .Build());
+
+  std::vector<int64_t> packets_per_cycle;
+  for (int64_t cycle = 0; cycle < 6; ++cycle) {
+    std::vector<DataPacket> packets = model->GetNewCyclePackets(cycle);
+    for (DataPacket& p : packets) {
+      EXPECT_EQ(p.vc, 1);
+      EXPECT_EQ(p.source_index, 10);
+      EXPECT_EQ(p.destination_index, 3);
+      EXPECT_EQ(p.data.bit_count(), packet_size_bits);
+    }
+    packets_per_cycle.push_back(packets.size());
+    if (cycle == 2) {
+      EXPECT_EQ(model->NextPacketCycle(), 4);
+    }
+  }
+  EXPECT_EQ(packets_per_cycle, std::vector<int64_t>({0, 2, 0, 0, 1, 0}));
+  EXPECT_EQ(model->NextPacketCycle(), std::numeric_limits<int64_t>::max());
+}
+
 }  // namespace
 }  // namespace xls::noc
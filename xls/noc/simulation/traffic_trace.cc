@@ -0,0 +1,205 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/noc/simulation/traffic_trace.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls::noc {
+namespace {
+
+constexpr std::string_view kTraceMagic = "XLSNOCT1";
+
+void WriteVarint(std::ostream& stream, uint64_t value) {
+  while (value >= 0x80) {
+    stream.put(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  stream.put(static_cast<char>(value));
+}
+
+// Reads a varint, returning std::nullopt if the stream ends before its
+// first byte.
+absl::StatusOr<std::optional<uint64_t>> ReadVarint(std::istream& stream) {
+  uint64_t value = 0;
+  for (int64_t shift = 0; shift < 64; shift += 7) {
+    int byte = stream.get();
+    if (byte == std::char_traits<char>::eof()) {
+      if (shift == 0) {
+        return std::nullopt;
+      }
+      return absl::DataLossError("Traffic trace ends within a varint.");
+    }
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+  return absl::DataLossError("Traffic trace contains an over-long varint.");
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<TrafficTraceWriter>> TrafficTraceWriter::Create(
+    const std::filesystem::path& path) {
+  std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+  if (!stream.is_open()) {
+    return absl::NotFoundError(absl::StrFormat(
+        "Unable to open traffic trace %s for writing.", path.string()));
+  }
+  stream.write(kTraceMagic.data(), kTraceMagic.size());
+  return absl::WrapUnique(new TrafficTraceWriter(std::move(stream)));
+}
+
+absl::Status TrafficTraceWriter::AddPacket(int64_t cycle) {
+  if (cycle < last_cycle_) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Traffic trace packet cycle %d precedes the previous packet's cycle "
+        "%d.",
+        cycle, last_cycle_));
+  }
+  int64_t interval = cycle - last_cycle_;
+  if (run_count_ > 0 && interval != run_interval_) {
+    XLS_RETURN_IF_ERROR(FlushRun());
+  }
+  run_interval_ = interval;
+  ++run_count_;
+  ++packet_count_;
+  last_cycle_ = cycle;
+  return absl::OkStatus();
+}
+
+absl::Status TrafficTraceWriter::FlushRun() {
+  WriteVarint(stream_, run_interval_);
+  WriteVarint(stream_, run_count_);
+  run_count_ = 0;
+  if (!stream_.good()) {
+    return absl::InternalError("Failed writing traffic trace.");
+  }
+  return absl::OkStatus();
+}
+
+absl::Status TrafficTraceWriter::Close() {
+  if (run_count_ > 0) {
+    XLS_RETURN_IF_ERROR(FlushRun());
+  }
+  stream_.close();
+  if (stream_.fail()) {
+    return absl::InternalError("Failed closing traffic trace.");
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::unique_ptr<TrafficTraceReader>> TrafficTraceReader::Open(
+    const std::filesystem::path& path) {
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream.is_open()) {
+    return absl::NotFoundError(
+        absl::StrFormat("Unable to open traffic trace %s.", path.string()));
+  }
+  std::string magic(kTraceMagic.size(), '\0');
+  stream.read(magic.data(), magic.size());
+  if (!stream.good() || magic != kTraceMagic) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("%s is not a traffic trace.", path.string()));
+  }
+  auto reader = absl::WrapUnique(new TrafficTraceReader(std::move(stream)));
+  XLS_RETURN_IF_ERROR(reader->ReadRun());
+  return reader;
+}
+
+absl::Status TrafficTraceReader::Advance() {
+  XLS_RET_CHECK(!AtEnd());
+  if (--run_remaining_ > 0) {
+    next_cycle_ += run_interval_;
+    return absl::OkStatus();
+  }
+  return ReadRun();
+}
+
+absl::Status TrafficTraceReader::ReadRun() {
+  while (run_remaining_ == 0) {
+    XLS_ASSIGN_OR_RETURN(std::optional<uint64_t> interval,
+                         ReadVarint(stream_));
+    if (!interval.has_value()) {
+      return absl::OkStatus();
+    }
+    XLS_ASSIGN_OR_RETURN(std::optional<uint64_t> count, ReadVarint(stream_));
+    if (!count.has_value()) {
+      return absl::DataLossError("Traffic trace ends within a run.");
+    }
+    run_interval_ = *interval;
+    run_remaining_ = *count;
+    if (run_remaining_ > 0) {
+      next_cycle_ += run_interval_;
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ConvertCsvToTrafficTrace(const std::filesystem::path& csv_path,
+                                      const std::filesystem::path& trace_path) {
+  std::ifstream csv(csv_path);
+  if (!csv.is_open()) {
+    return absl::NotFoundError(
+        absl::StrFormat("Unable to open %s.", csv_path.string()));
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<TrafficTraceWriter> writer,
+                       TrafficTraceWriter::Create(trace_path));
+
+  std::string line;
+  for (int64_t line_number = 1; std::getline(csv, line); ++line_number) {
+    std::string_view field = absl::StripAsciiWhitespace(
+        std::string_view(line).substr(0, line.find(',')));
+    if (field.empty() || field[0] == '#') {
+      continue;
+    }
+    int64_t cycle;
+    if (!absl::SimpleAtoi(field, &cycle)) {
+      if (line_number == 1) {
+        // Header line.
+        continue;
+      }
+      return absl::InvalidArgumentError(
+          absl::StrFormat("%s:%d: invalid cycle \"%s\".", csv_path.string(),
+                          line_number, field));
+    }
+    absl::Status status = writer->AddPacket(cycle);
+    if (!status.ok()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "%s:%d: %s", csv_path.string(), line_number, status.message()));
+    }
+  }
+  return writer->Close();
+}
+
+}  // namespace xls::noc
@@ -0,0 +1,112 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NOC_SIMULATION_TRAFFIC_TRACE_H_
+#define XLS_NOC_SIMULATION_TRAFFIC_TRACE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <fstream>
+#include <memory>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+
+// This file contains classes used to store and stream traces of the cycles
+// in which a traffic flow injects packets.
+//
+// Traces are stored in a compact binary format so that captured workloads
+// with billions of packets can be replayed (see TraceTrafficModel) while only
+// a constant amount of the trace is held in memory.
+//
+// Format:
+//   - The 8 byte magic "XLSNOCT1".
+//   - A sequence of runs, each consisting of two unsigned LEB128 varints
+//     "interval" and "count".  A run injects "count" packets, each "interval"
+//     cycles after the previous packet of the trace (or after cycle 0 for the
+//     first packet).  An interval of zero injects packets on the same cycle.
+//
+// Runs compress the periodic traffic common in captured workloads: a flow
+// injecting a packet every N cycles is stored as a single run.
+
+namespace xls::noc {
+
+// Writes a trace from packet injection cycles given in non-decreasing order.
+class TrafficTraceWriter {
+ public:
+  static absl::StatusOr<std::unique_ptr<TrafficTraceWriter>> Create(
+      const std::filesystem::path& path);
+
+  // Records a packet injected at cycle.
+  absl::Status AddPacket(int64_t cycle);
+
+  // Flushes all packets added and closes the file.  Must be called once
+  // all packets are added.
+  absl::Status Close();
+
+  int64_t PacketCount() const { return packet_count_; }
+
+ private:
+  explicit TrafficTraceWriter(std::ofstream stream)
+      : stream_(std::move(stream)) {}
+
+  absl::Status FlushRun();
+
+  std::ofstream stream_;
+  int64_t last_cycle_ = 0;
+  int64_t run_interval_ = 0;
+  int64_t run_count_ = 0;
+  int64_t packet_count_ = 0;
+};
+
+// Streams the packet injection cycles of a trace.
+class TrafficTraceReader {
+ public:
+  static absl::StatusOr<std::unique_ptr<TrafficTraceReader>> Open(
+      const std::filesystem::path& path);
+
+  // Returns true once all packets of the trace have been read.
+  bool AtEnd() const { return run_remaining_ == 0; }
+
+  // Returns the injection cycle of the next packet.  Requires !AtEnd().
+  int64_t NextCycle() const { return next_cycle_; }
+
+  // Advances to the next packet of the trace.  Requires !AtEnd().
+  absl::Status Advance();
+
+ private:
+  explicit TrafficTraceReader(std::ifstream stream)
+      : stream_(std::move(stream)) {}
+
+  // Reads runs until one with packets is found or the trace ends.
+  absl::Status ReadRun();
+
+  std::ifstream stream_;
+  int64_t next_cycle_ = 0;
+  int64_t run_interval_ = 0;
+  int64_t run_remaining_ = 0;
+};
+
+// Converts a CSV file to a trace.
+//
+// The first field of each line is the cycle a packet is injected on; other
+// fields are ignored, as are empty lines, lines starting with '#' and a
+// header line.  Cycles must be in non-decreasing order.
+absl::Status ConvertCsvToTrafficTrace(const std::filesystem::path& csv_path,
+                                      const std::filesystem::path& trace_path);
+
+}  // namespace xls::noc
+
+#endif  // XLS_NOC_SIMULATION_TRAFFIC_TRACE_H_
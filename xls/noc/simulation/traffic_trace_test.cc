@@ -0,0 +1,140 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/noc/simulation/traffic_trace.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_file.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls::noc {
+namespace {
+
+using status_testing::StatusIs;
+
+absl::StatusOr<std::vector<int64_t>> ReadTrace(
+    const std::filesystem::path& path) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<TrafficTraceReader> reader,
+                       TrafficTraceReader::Open(path));
+  std::vector<int64_t> cycles;
+  while (!reader->AtEnd()) {
+    cycles.push_back(reader->NextCycle());
+    XLS_RETURN_IF_ERROR(reader->Advance());
+  }
+  return cycles;
+}
+
+TEST(TrafficTraceTest, WriteAndRead) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile trace, TempFile::Create(".trace"));
+  std::vector<int64_t> cycles = {0, 0, 3, 6, 9, 10, 10, 10, 1000000000000};
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TrafficTraceWriter> writer,
+                           TrafficTraceWriter::Create(trace.path()));
+  for (int64_t cycle : cycles) {
+    XLS_ASSERT_OK(writer->AddPacket(cycle));
+  }
+  XLS_ASSERT_OK(writer->Close());
+  EXPECT_EQ(writer->PacketCount(), cycles.size());
+
+  EXPECT_THAT(ReadTrace(trace.path()),
+              status_testing::IsOkAndHolds(testing::ElementsAreArray(cycles)));
+}
+
+TEST(TrafficTraceTest, PeriodicTrafficIsCompact) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile trace, TempFile::Create(".trace"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TrafficTraceWriter> writer,
+                           TrafficTraceWriter::Create(trace.path()));
+  for (int64_t i = 0; i < 100000; ++i) {
+    XLS_ASSERT_OK(writer->AddPacket(7 * i + 5));
+  }
+  XLS_ASSERT_OK(writer->Close());
+
+  // Two runs: the first packet, then every 7 cycles.
+  EXPECT_LT(std::filesystem::file_size(trace.path()), 32);
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TrafficTraceReader> reader,
+                           TrafficTraceReader::Open(trace.path()));
+  int64_t packet_count = 0;
+  for (; !reader->AtEnd(); ++packet_count) {
+    ASSERT_EQ(reader->NextCycle(), 7 * packet_count + 5);
+    XLS_ASSERT_OK(reader->Advance());
+  }
+  EXPECT_EQ(packet_count, 100000);
+}
+
+TEST(TrafficTraceTest, EmptyTrace) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile trace, TempFile::Create(".trace"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TrafficTraceWriter> writer,
+                           TrafficTraceWriter::Create(trace.path()));
+  XLS_ASSERT_OK(writer->Close());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TrafficTraceReader> reader,
+                           TrafficTraceReader::Open(trace.path()));
+  EXPECT_TRUE(reader->AtEnd());
+}
+
+TEST(TrafficTraceTest, DecreasingCyclesAreRejected) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile trace, TempFile::Create(".trace"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TrafficTraceWriter> writer,
+                           TrafficTraceWriter::Create(trace.path()));
+  XLS_ASSERT_OK(writer->AddPacket(5));
+  EXPECT_THAT(writer->AddPacket(4),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(TrafficTraceTest, InvalidTraces) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile not_a_trace,
+                           TempFile::CreateWithContent("0,1\n1,1\n"));
+  EXPECT_THAT(TrafficTraceReader::Open(not_a_trace.path()),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  // A run missing its count.
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile truncated,
+                           TempFile::CreateWithContent("XLSNOCT1\x05"));
+  EXPECT_THAT(TrafficTraceReader::Open(truncated.path()),
+              StatusIs(absl::StatusCode::kDataLoss));
+}
+
+TEST(TrafficTraceTest, ConvertCsv) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TempFile csv, TempFile::CreateWithContent("cycle,size\n"
+                                                "# comment\n"
+                                                "2,64\n"
+                                                "\n"
+                                                " 4 ,64\n"
+                                                "4\n",
+                                                ".csv"));
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile trace, TempFile::Create(".trace"));
+  XLS_ASSERT_OK(ConvertCsvToTrafficTrace(csv.path(), trace.path()));
+  EXPECT_THAT(ReadTrace(trace.path()),
+              status_testing::IsOkAndHolds(testing::ElementsAre(2, 4, 4)));
+
+  XLS_ASSERT_OK(SetFileContents(csv.path(), "2\nfoo\n"));
+  EXPECT_THAT(ConvertCsvToTrafficTrace(csv.path(), trace.path()),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  XLS_ASSERT_OK(SetFileContents(csv.path(), "2\n1\n"));
+  EXPECT_THAT(ConvertCsvToTrafficTrace(csv.path(), trace.path()),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace xls::noc
@@ -15,6 +15,7 @@
 #include "xls/passes/array_simplification_pass.h"
 
 #include <algorithm>
+#include <memory>
 #include <optional>
 #include <vector>
 
@@ -27,6 +28,7 @@
 #include "xls/ir/nodes.h"
 #include "xls/ir/type.h"
 #include "xls/passes/optimization_pass.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/ternary_query_engine.h"
 
 namespace xls {
@@ -917,28 +919,29 @@ absl::StatusOr<bool> ArraySimplificationPass::RunOnFunctionBaseInternal(
   XLS_ASSIGN_OR_RETURN(bool clamp_changed, ClampArrayIndexIndices(func));
   changed = changed || clamp_changed;
 
-  TernaryQueryEngine query_engine;
-  XLS_RETURN_IF_ERROR(query_engine.Populate(func).status());
+  XLS_ASSIGN_OR_RETURN(std::shared_ptr<const TernaryQueryEngine> query_engine,
+                       GetQueryEngine<TernaryQueryEngine>(
+                           options.query_engine_cache.get(), func));
 
   for (Node* node : TopoSort(func)) {
     if (node->Is<ArrayIndex>()) {
       ArrayIndex* array_index = node->As<ArrayIndex>();
       XLS_ASSIGN_OR_RETURN(bool node_changed,
-                           SimplifyArrayIndex(array_index, query_engine));
+                           SimplifyArrayIndex(array_index, *query_engine));
       changed = changed || node_changed;
     } else if (node->Is<ArrayUpdate>()) {
       XLS_ASSIGN_OR_RETURN(
           bool node_changed,
-          SimplifyArrayUpdate(node->As<ArrayUpdate>(), query_engine));
+          SimplifyArrayUpdate(node->As<ArrayUpdate>(), *query_engine));
       changed = changed || node_changed;
     } else if (node->Is<Array>()) {
       XLS_ASSIGN_OR_RETURN(bool node_changed,
-                           SimplifyArray(node->As<Array>(), query_engine));
+                           SimplifyArray(node->As<Array>(), *query_engine));
       changed = changed || node_changed;
     } else if (IsBinarySelect(node)) {
       XLS_ASSIGN_OR_RETURN(
           bool node_changed,
-          SimplifyBinarySelect(node->As<Select>(), query_engine));
+          SimplifyBinarySelect(node->As<Select>(), *query_engine));
       changed = changed || node_changed;
     }
   }
@@ -276,7 +276,26 @@ bool ShouldEvaluate(Node* node) {
     std::optional<std::function<bool(const Node*)>> node_filter) {
   XLS_VLOG(1) << absl::StreamFormat("BddFunction::Run(%s):", f->name());
   XLS_VLOG_LINES(5, f->DumpIr());
+  std::vector<Node*> nodes;
+  nodes.reserve(f->node_count());
+  for (Node* node : TopoSort(f)) {
+    nodes.push_back(node);
+  }
+  return Build(f, nodes, path_limit, node_filter);
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<BddFunction>>
+BddFunction::RunOnNodes(
+    FunctionBase* f, absl::Span<Node* const> nodes, int64_t path_limit,
+    std::optional<std::function<bool(const Node*)>> node_filter) {
+  XLS_VLOG(3) << absl::StreamFormat("BddFunction::RunOnNodes(%s): %d nodes",
+                                    f->name(), nodes.size());
+  return Build(f, nodes, path_limit, node_filter);
+}
 
+/* static */ absl::StatusOr<std::unique_ptr<BddFunction>> BddFunction::Build(
+    FunctionBase* f, absl::Span<Node* const> nodes, int64_t path_limit,
+    const std::optional<std::function<bool(const Node*)>>& node_filter) {
   auto bdd_function = absl::WrapUnique(new BddFunction(f));
   SaturatingBddEvaluator evaluator(path_limit, &bdd_function->bdd());
 
@@ -292,7 +311,21 @@ bool ShouldEvaluate(Node* node) {
 
   XLS_VLOG(3) << "BDD expressions:";
   absl::flat_hash_map<Node*, SaturatingBddNodeVector> values;
-  for (Node* node : TopoSort(f)) {
+  // Returns the value of the given operand. Operands outside of `nodes` (the
+  // cut when building over part of the function) are new BDD variables, which
+  // represent them exactly in terms of themselves.
+  auto operand_value = [&](Node* operand) -> const SaturatingBddNodeVector& {
+    auto it = values.find(operand);
+    if (it == values.end()) {
+      SaturatingBddNodeVector v;
+      for (int64_t i = 0; i < operand->BitCountOrDie(); ++i) {
+        v.push_back(bdd_function->bdd().NewVariable());
+      }
+      it = values.emplace(operand, std::move(v)).first;
+    }
+    return it->second;
+  };
+  for (Node* node : nodes) {
     XLS_VLOG(3) << "node: " << node->ToString();
     if (!node->GetType()->IsBits()) {
       XLS_VLOG(3) << "  skipping node, type is not bits: "
@@ -312,7 +345,7 @@ bool ShouldEvaluate(Node* node) {
       XLS_VLOG(2) << "  computing BDD value...";
       std::vector<SaturatingBddNodeVector> operand_values;
       for (Node* operand : node->operands()) {
-        operand_values.push_back(values.at(operand));
+        operand_values.push_back(operand_value(operand));
       }
       XLS_ASSIGN_OR_RETURN(
           values[node],
@@ -328,6 +361,19 @@ bool ShouldEvaluate(Node* node) {
         }
       }
     }
+
+    // Reclaim the BDD nodes which are no longer referenced by the expression
+    // of any evaluated node, e.g. intermediate results of the evaluation and
+    // the expressions of bits which exceeded the path limit.
+    if (bdd_function->bdd().ShouldGarbageCollect()) {
+      std::vector<BddNodeIndex> roots;
+      for (const auto& [_, node_values] : values) {
+        for (const SaturatingBddNodeIndex& value : node_values) {
+          roots.push_back(std::get<BddNodeIndex>(value));
+        }
+      }
+      bdd_function->bdd().GarbageCollect(roots);
+    }
     XLS_VLOG(5) << "  " << node->GetName() << ":";
     for (int64_t i = 0; i < node->BitCountOrDie(); ++i) {
       XLS_VLOG(5) << absl::StreamFormat(
@@ -22,6 +22,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/data_structures/binary_decision_diagram.h"
 #include "xls/data_structures/leaf_type_tree.h"
@@ -65,6 +66,21 @@ class BddFunction {
       std::optional<std::function<bool(const Node*)>> node_filter =
           std::nullopt);
 
+  // Construct a BDD representing only `nodes`, a subset of the nodes of `f` in
+  // topological order, e.g. a window around some node of a function too large
+  // for a single BDD. Bits-typed operands of `nodes` which are not themselves
+  // in `nodes` (the cut) are modeled as new BDD variables, so the expressions
+  // of `nodes` are exact in terms of the cut. GetBddNode may be called on
+  // `nodes` and the cut. Does not modify `f`, so BDDs over different parts of
+  // a function can be constructed concurrently.
+  static absl::StatusOr<std::unique_ptr<BddFunction>> RunOnNodes(
+      FunctionBase* f, absl::Span<Node* const> nodes, int64_t path_limit = 0,
+      std::optional<std::function<bool(const Node*)>> node_filter =
+          std::nullopt);
+
+  // Returns true if the BDD has an expression for the given node.
+  bool HasNode(const Node* node) const { return node_map_.contains(node); }
+
   // Returns the underlying BDD.
   const BinaryDecisionDiagram& bdd() const { return bdd_; }
   BinaryDecisionDiagram& bdd() { return bdd_; }
@@ -85,6 +101,10 @@ class BddFunction {
  private:
   explicit BddFunction(FunctionBase* f) : func_base_(f) {}
 
+  static absl::StatusOr<std::unique_ptr<BddFunction>> Build(
+      FunctionBase* f, absl::Span<Node* const> nodes, int64_t path_limit,
+      const std::optional<std::function<bool(const Node*)>>& node_filter);
+
   FunctionBase* func_base_;
   BinaryDecisionDiagram bdd_;
 
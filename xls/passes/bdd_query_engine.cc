@@ -31,46 +31,63 @@ namespace xls {
 absl::StatusOr<ReachedFixpoint> BddQueryEngine::Populate(FunctionBase* f) {
   XLS_ASSIGN_OR_RETURN(bdd_function_,
                        BddFunction::Run(f, path_limit_, node_filter_));
-  // Construct the Bits objects indication which bit values are statically known
-  // for each node and what those values are (0 or 1) if known.
-  BinaryDecisionDiagram& bdd = this->bdd();
   ReachedFixpoint rf = ReachedFixpoint::Unchanged;
   for (Node* node : f->nodes()) {
-    if (node->GetType()->IsBits()) {
-      absl::InlinedVector<bool, 1> known_bits;
-      absl::InlinedVector<bool, 1> bits_values;
-      for (int64_t i = 0; i < node->BitCountOrDie(); ++i) {
-        if (GetBddNode(TreeBitLocation(node, i)) == bdd.zero()) {
-          known_bits.push_back(true);
-          bits_values.push_back(false);
-        } else if (GetBddNode(TreeBitLocation(node, i)) == bdd.one()) {
-          known_bits.push_back(true);
-          bits_values.push_back(true);
-        } else {
-          known_bits.push_back(false);
-          bits_values.push_back(false);
-        }
-      }
-      if (!known_bits_.contains(node)) {
-        known_bits_[node] = Bits(known_bits.size());
-        bits_values_[node] = Bits(bits_values.size());
-      }
-      Bits new_known_bits(known_bits);
-      Bits new_bits_values(bits_values);
-      // TODO(taktoa): check for inconsistency
-      Bits ored_known_bits = bits_ops::Or(known_bits_[node], new_known_bits);
-      Bits ored_bits_values = bits_ops::Or(bits_values_[node], new_bits_values);
-      if ((ored_known_bits != known_bits_[node]) ||
-          (ored_bits_values != bits_values_[node])) {
-        rf = ReachedFixpoint::Changed;
-      }
-      known_bits_[node] = ored_known_bits;
-      bits_values_[node] = ored_bits_values;
-    }
+    UpdateKnownBits(node, &rf);
+  }
+  return rf;
+}
+
+absl::StatusOr<ReachedFixpoint> BddQueryEngine::PopulateWindow(
+    FunctionBase* f, absl::Span<Node* const> nodes) {
+  XLS_ASSIGN_OR_RETURN(
+      bdd_function_,
+      BddFunction::RunOnNodes(f, nodes, path_limit_, node_filter_));
+  ReachedFixpoint rf = ReachedFixpoint::Unchanged;
+  for (Node* node : nodes) {
+    UpdateKnownBits(node, &rf);
   }
   return rf;
 }
 
+void BddQueryEngine::UpdateKnownBits(Node* node, ReachedFixpoint* rf) {
+  if (!node->GetType()->IsBits()) {
+    return;
+  }
+  // Construct the Bits objects indication which bit values are statically
+  // known for the node and what those values are (0 or 1) if known.
+  BinaryDecisionDiagram& bdd = this->bdd();
+  absl::InlinedVector<bool, 1> known_bits;
+  absl::InlinedVector<bool, 1> bits_values;
+  for (int64_t i = 0; i < node->BitCountOrDie(); ++i) {
+    if (GetBddNode(TreeBitLocation(node, i)) == bdd.zero()) {
+      known_bits.push_back(true);
+      bits_values.push_back(false);
+    } else if (GetBddNode(TreeBitLocation(node, i)) == bdd.one()) {
+      known_bits.push_back(true);
+      bits_values.push_back(true);
+    } else {
+      known_bits.push_back(false);
+      bits_values.push_back(false);
+    }
+  }
+  if (!known_bits_.contains(node)) {
+    known_bits_[node] = Bits(known_bits.size());
+    bits_values_[node] = Bits(bits_values.size());
+  }
+  Bits new_known_bits(known_bits);
+  Bits new_bits_values(bits_values);
+  // TODO(taktoa): check for inconsistency
+  Bits ored_known_bits = bits_ops::Or(known_bits_[node], new_known_bits);
+  Bits ored_bits_values = bits_ops::Or(bits_values_[node], new_bits_values);
+  if ((ored_known_bits != known_bits_[node]) ||
+      (ored_bits_values != bits_values_[node])) {
+    *rf = ReachedFixpoint::Changed;
+  }
+  known_bits_[node] = ored_known_bits;
+  bits_values_[node] = ored_bits_values;
+}
+
 bool BddQueryEngine::AtMostOneTrue(
     absl::Span<TreeBitLocation const> bits) const {
   // Computing this property is quadratic (at least) so limit the width.
@@ -23,6 +23,7 @@
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function.h"
 #include "xls/ir/nodes.h"
@@ -52,6 +53,13 @@ class BddQueryEngine : public QueryEngine {
 
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
 
+  // Populates the engine with a BDD over only `nodes`, a subset of the nodes of
+  // `f` in topological order (see BddFunction::RunOnNodes). Only `nodes` are
+  // tracked. Does not modify `f`, so engines over different windows of a
+  // function can be populated concurrently.
+  absl::StatusOr<ReachedFixpoint> PopulateWindow(FunctionBase* f,
+                                                 absl::Span<Node* const> nodes);
+
   bool IsTracked(Node* node) const override {
     return known_bits_.contains(node);
   }
@@ -97,6 +105,10 @@ class BddQueryEngine : public QueryEngine {
   // A implies B  <=>  !(A && !B)
   bool Implies(const BddNodeIndex& a, const BddNodeIndex& b) const;
 
+  // Updates the known bits of `node` from the BDD, setting `rf` to Changed if
+  // they changed.
+  void UpdateKnownBits(Node* node, ReachedFixpoint* rf);
+
   // Returns true if the expression of the given BDD node exceeds the path
   // limit.
   // TODO(meheff): This should be part of the BDD itself where a query can be
@@ -15,6 +15,7 @@
 #include "xls/passes/bdd_simplification_pass.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -37,11 +38,16 @@
 #include "xls/passes/bdd_query_engine.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/windowed_bdd_query_engine.h"
 
 namespace xls {
 
 namespace {
 
+// Functions with more nodes than this are analyzed with a
+// WindowedBddQueryEngine rather than a single BDD.
+constexpr int64_t kWindowedBddNodeCount = 100000;
+
 // Returns a conscise string representation of the given node if it is a
 // comparator. For example, a kEq with a literal operand might produce:
 // "x == 42".
@@ -330,7 +336,23 @@ absl::StatusOr<bool> SimplifyNode(Node* node, const QueryEngine& query_engine,
 absl::StatusOr<bool> BddSimplificationPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
-  BddQueryEngine query_engine(BddFunction::kDefaultPathLimit);
+  if (options.CompileTimeBudgetExhausted()) {
+    options.compile_time_budget->RecordSkip(short_name(),
+                                            "skipped BDD simplification");
+    return false;
+  }
+  // A single BDD over a very large function is slow to build even when each
+  // expression is small, so large functions are analyzed in windows.
+  std::unique_ptr<QueryEngine> query_engine_ptr;
+  if (f->node_count() > kWindowedBddNodeCount) {
+    query_engine_ptr = std::make_unique<WindowedBddQueryEngine>(
+        WindowedBddQueryEngine::kDefaultWindowSize,
+        BddFunction::kDefaultPathLimit);
+  } else {
+    query_engine_ptr =
+        std::make_unique<BddQueryEngine>(BddFunction::kDefaultPathLimit);
+  }
+  QueryEngine& query_engine = *query_engine_ptr;
   XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
 
   bool modified = false;
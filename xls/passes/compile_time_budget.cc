@@ -0,0 +1,59 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/compile_time_budget.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace xls {
+
+void CompileTimeBudget::RecordSkip(std::string_view pass_name,
+                                   std::string_view description) {
+  absl::MutexLock lock(&mutex_);
+  ++skips_[{std::string(pass_name), std::string(description)}];
+}
+
+std::vector<CompileTimeBudget::Skip> CompileTimeBudget::skips() const {
+  absl::MutexLock lock(&mutex_);
+  std::vector<Skip> result;
+  result.reserve(skips_.size());
+  for (const auto& [key, count] : skips_) {
+    result.push_back(Skip{key.first, key.second, count});
+  }
+  return result;
+}
+
+std::string CompileTimeBudget::ToString() const {
+  std::vector<Skip> skipped = skips();
+  if (skipped.empty()) {
+    return absl::StrFormat("Compile-time budget of %s: nothing skipped\n",
+                           absl::FormatDuration(budget_));
+  }
+  std::string result =
+      absl::StrFormat("Compile-time budget of %s exhausted, skipped:\n",
+                      absl::FormatDuration(budget_));
+  for (const Skip& skip : skipped) {
+    absl::StrAppendFormat(&result, "  %-30s %s (x%d)\n", skip.pass_name,
+                          skip.description, skip.count);
+  }
+  return result;
+}
+
+}  // namespace xls
@@ -0,0 +1,74 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_COMPILE_TIME_BUDGET_H_
+#define XLS_PASSES_COMPILE_TIME_BUDGET_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/btree_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace xls {
+
+// A budget for the wall-clock time of a run of a pass pipeline. The clock
+// starts when the budget is constructed. Once the budget is exhausted,
+// fixed-point compound passes stop iterating and expensive passes skip or scale
+// down their work, recording what they skipped with RecordSkip so it can be
+// reported. Thread safe.
+class CompileTimeBudget {
+ public:
+  explicit CompileTimeBudget(absl::Duration budget)
+      : budget_(budget), deadline_(absl::Now() + budget) {}
+
+  absl::Duration budget() const { return budget_; }
+
+  // Returns whether the budget has been spent.
+  bool IsExhausted() const { return absl::Now() >= deadline_; }
+
+  // Records that `pass_name` skipped or reduced some of its work, described by
+  // `description`, because the budget was exhausted.
+  void RecordSkip(std::string_view pass_name, std::string_view description);
+
+  // A kind of skipped work and the number of times it was recorded.
+  struct Skip {
+    std::string pass_name;
+    std::string description;
+    int64_t count;
+  };
+
+  // Returns the recorded skips ordered by pass name and description.
+  std::vector<Skip> skips() const;
+
+  // Returns a human-readable summary of the skipped work.
+  std::string ToString() const;
+
+ private:
+  absl::Duration budget_;
+  absl::Time deadline_;
+
+  mutable absl::Mutex mutex_;
+  absl::btree_map<std::pair<std::string, std::string>, int64_t> skips_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_COMPILE_TIME_BUDGET_H_
@@ -0,0 +1,55 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/compile_time_budget.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+
+namespace xls {
+namespace {
+
+using ::testing::HasSubstr;
+
+TEST(CompileTimeBudgetTest, Exhausted) {
+  EXPECT_TRUE(CompileTimeBudget(absl::ZeroDuration()).IsExhausted());
+  EXPECT_FALSE(CompileTimeBudget(absl::InfiniteDuration()).IsExhausted());
+  EXPECT_FALSE(CompileTimeBudget(absl::Hours(1)).IsExhausted());
+}
+
+TEST(CompileTimeBudgetTest, RecordSkips) {
+  CompileTimeBudget budget(absl::Seconds(10));
+  EXPECT_TRUE(budget.skips().empty());
+  EXPECT_THAT(budget.ToString(), HasSubstr("nothing skipped"));
+
+  budget.RecordSkip("narrow", "used ternary instead of range analysis");
+  budget.RecordSkip("bdd_simp", "skipped BDD simplification");
+  budget.RecordSkip("narrow", "used ternary instead of range analysis");
+
+  std::vector<CompileTimeBudget::Skip> skips = budget.skips();
+  ASSERT_EQ(skips.size(), 2);
+  EXPECT_EQ(skips[0].pass_name, "bdd_simp");
+  EXPECT_EQ(skips[0].count, 1);
+  EXPECT_EQ(skips[1].pass_name, "narrow");
+  EXPECT_EQ(skips[1].description, "used ternary instead of range analysis");
+  EXPECT_EQ(skips[1].count, 2);
+  EXPECT_THAT(budget.ToString(), HasSubstr("10s exhausted"));
+  EXPECT_THAT(budget.ToString(), HasSubstr("skipped BDD simplification (x1)"));
+}
+
+}  // namespace
+}  // namespace xls
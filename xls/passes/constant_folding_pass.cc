@@ -15,45 +15,117 @@
 #include "xls/passes/constant_folding_pass.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/ir_interpreter.h"
+#include "xls/ir/events.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/type.h"
+#include "xls/ir/value.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
 
 namespace xls {
+namespace {
+
+// Returns whether `node` may be replaced by a literal if its operands are
+// constant. Types with tokens are excluded because literal tokens are not
+// allowed.
+bool IsFoldable(Node* node) {
+  return !node->Is<Literal>() && !TypeHasToken(node->GetType()) &&
+         !OpIsSideEffecting(node->op());
+}
+
+// Folds each node in `to_fold` individually, in order.
+absl::Status FoldNodes(absl::Span<Node* const> to_fold) {
+  for (Node* node : to_fold) {
+    XLS_VLOG(2) << "Folding: " << *node;
+    std::vector<Value> operand_values;
+    for (Node* operand : node->operands()) {
+      operand_values.push_back(operand->As<Literal>()->value());
+    }
+    XLS_ASSIGN_OR_RETURN(Value result, InterpretNode(node, operand_values));
+    XLS_RETURN_IF_ERROR(node->ReplaceUsesWithNew<Literal>(result).status());
+  }
+  return absl::OkStatus();
+}
+
+// Evaluates the constant cone `to_fold` (in topological order) with a single
+// interpreter and replaces only the nodes used outside of the cone by literals.
+absl::Status FoldConeAsBatch(FunctionBase* f, absl::Span<Node* const> to_fold) {
+  XLS_VLOG(2) << "Folding a cone of " << to_fold.size() << " constant nodes";
+  absl::flat_hash_set<Node*> in_cone(to_fold.begin(), to_fold.end());
+  NodeValueSlots values(f);
+  InterpreterEvents events;
+  IrInterpreter interpreter(&values, &events);
+  for (Node* node : to_fold) {
+    for (Node* operand : node->operands()) {
+      if (!interpreter.HasResult(operand)) {
+        XLS_RETURN_IF_ERROR(interpreter.SetValueResult(
+            operand, operand->As<Literal>()->value()));
+      }
+    }
+    XLS_RETURN_IF_ERROR(node->VisitSingleNode(&interpreter));
+  }
+
+  std::vector<Node*> cone_outputs;
+  for (Node* node : to_fold) {
+    if (f->HasImplicitUse(node) ||
+        std::any_of(node->users().begin(), node->users().end(),
+                    [&](Node* user) { return !in_cone.contains(user); })) {
+      cone_outputs.push_back(node);
+    }
+  }
+  for (Node* node : cone_outputs) {
+    XLS_VLOG(2) << "Folding: " << *node;
+    XLS_RETURN_IF_ERROR(
+        node->ReplaceUsesWithNew<Literal>(interpreter.ResolveAsValue(node))
+            .status());
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
 
 absl::StatusOr<bool> ConstantFoldingPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
-  bool changed = false;
+  // Gather every foldable node whose operands are literals or are themselves
+  // folded, i.e., the nodes which would become literals after repeatedly
+  // folding nodes with only literal operands.
+  // TODO(meheff): 2019/6/26 Consider not folding loops with large trip counts
+  // to avoid hanging at compile time.
+  absl::flat_hash_set<Node*> constant;
+  std::vector<Node*> to_fold;
   for (Node* node : TopoSort(f)) {
-    // Fold any non-side-effecting op with constant paramters. Avoid any types
-    // with tokens because literal tokens are not allowed.
-    // TODO(meheff): 2019/6/26 Consider not folding loops with large trip counts
-    // to avoid hanging at compile time.
-    if (!node->Is<Literal>() && !TypeHasToken(node->GetType()) &&
-        !OpIsSideEffecting(node->op()) &&
+    if (IsFoldable(node) &&
         std::all_of(node->operands().begin(), node->operands().end(),
-                    [](Node* o) { return o->Is<Literal>(); })) {
-      XLS_VLOG(2) << "Folding: " << *node;
-      std::vector<Value> operand_values;
-      for (Node* operand : node->operands()) {
-        operand_values.push_back(operand->As<Literal>()->value());
-      }
-      XLS_ASSIGN_OR_RETURN(Value result, InterpretNode(node, operand_values));
-      XLS_RETURN_IF_ERROR(node->ReplaceUsesWithNew<Literal>(result).status());
-      changed = true;
+                    [&](Node* o) {
+                      return o->Is<Literal>() || constant.contains(o);
+                    })) {
+      constant.insert(node);
+      to_fold.push_back(node);
     }
   }
+  if (to_fold.empty()) {
+    return false;
+  }
 
-  return changed;
+  if (static_cast<int64_t>(to_fold.size()) >= batch_threshold_) {
+    XLS_RETURN_IF_ERROR(FoldConeAsBatch(f, to_fold));
+  } else {
+    XLS_RETURN_IF_ERROR(FoldNodes(to_fold));
+  }
+  return true;
 }
 
 }  // namespace xls
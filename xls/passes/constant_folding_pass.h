@@ -15,6 +15,8 @@
 #ifndef XLS_PASSES_CONSTANT_FOLDING_PASS_H_
 #define XLS_PASSES_CONSTANT_FOLDING_PASS_H_
 
+#include <cstdint>
+
 #include "absl/status/statusor.h"
 #include "xls/ir/function.h"
 #include "xls/passes/optimization_pass.h"
@@ -23,16 +25,28 @@ namespace xls {
 
 // Pass which performs constant folding. Every op with only literal operands is
 // replaced by a equivalent literal. Runs DCE after constant folding.
+//
+// If at least `batch_threshold` nodes are constant, the whole constant cone is
+// evaluated in a single interpreter pass and only the nodes with users outside
+// of the cone are replaced by literals, leaving the (now dead) interior of the
+// cone to DCE. This avoids creating a literal for every node of large constant
+// subcomputations such as unrolled table-generation loops.
 class ConstantFoldingPass : public OptimizationFunctionBasePass {
  public:
-  ConstantFoldingPass()
-      : OptimizationFunctionBasePass("const_fold", "Constant folding") {}
+  static constexpr int64_t kDefaultBatchThreshold = 32;
+
+  explicit ConstantFoldingPass(int64_t batch_threshold = kDefaultBatchThreshold)
+      : OptimizationFunctionBasePass("const_fold", "Constant folding"),
+        batch_threshold_(batch_threshold) {}
   ~ConstantFoldingPass() override = default;
 
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
       PassResults* results) const override;
+
+ private:
+  int64_t batch_threshold_;
 };
 
 }  // namespace xls
@@ -14,6 +14,8 @@
 
 #include "xls/passes/constant_folding_pass.h"
 
+#include <cstdint>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
@@ -38,11 +40,14 @@ class ConstantFoldingPassTest : public IrTestBase {
  protected:
   ConstantFoldingPassTest() = default;
 
-  absl::StatusOr<bool> Run(Function* f) {
+  absl::StatusOr<bool> Run(
+      Function* f,
+      int64_t batch_threshold = ConstantFoldingPass::kDefaultBatchThreshold) {
     PassResults results;
     XLS_ASSIGN_OR_RETURN(bool changed,
-                         ConstantFoldingPass().RunOnFunctionBase(
-                             f, OptimizationPassOptions(), &results));
+                         ConstantFoldingPass(batch_threshold)
+                             .RunOnFunctionBase(f, OptimizationPassOptions(),
+                                                &results));
     // Run dce to clean things up.
     XLS_RETURN_IF_ERROR(
         DeadCodeEliminationPass()
@@ -148,5 +153,24 @@ TEST_F(ConstantFoldingPassTest, GateOp) {
   EXPECT_THAT(f->return_value(), m::Gate(m::Literal(), m::Literal()));
 }
 
+TEST_F(ConstantFoldingPassTest, BatchedConstantCone) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+     fn cone(x: bits[8]) -> (bits[8], bits[8]) {
+        literal.1: bits[8] = literal(value=3)
+        literal.2: bits[8] = literal(value=5)
+        add.3: bits[8] = add(literal.1, literal.2)
+        umul.4: bits[8] = umul(add.3, literal.2)
+        sub.5: bits[8] = sub(umul.4, literal.1)
+        add.6: bits[8] = add(x, umul.4)
+        ret tuple.7: (bits[8], bits[8]) = tuple(add.6, sub.5)
+     }
+  )",
+                                                       p.get()));
+  EXPECT_THAT(Run(f, /*batch_threshold=*/1), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(),
+              m::Tuple(m::Add(m::Param("x"), m::Literal(40)), m::Literal(37)));
+}
+
 }  // namespace
 }  // namespace xls
@@ -14,33 +14,22 @@
 
 #include "xls/passes/cse_pass.h"
 
+#include <cstdint>
 #include <vector>
 
-#include "absl/hash/hash.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/node_util.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
 
 namespace xls {
 
-namespace {
-
-// Returns the operands of the given node for the purposes of the CSE
-// optimization. The order of the nodes may not match the order of the node's
-// actual operands. Motivation: generally for nodes to be considered equivalent
-// the operands must be in the same order. However, commutative operations are
-// agnostic to operand order. So to expand the CSE optimization, compare
-// operands as an unordered set for commutative operands. This is done be
-// ordered commutative operation operands by id prior to comparison. To avoid
-// having to construct a vector every time, a span is returned by this
-// function. If the operation is not commutative, the node's own operand span is
-// simply returned. For the commutative case, a vector of sorted operands is
-// constructed in span_backing_store from which a span is constructed.
 absl::Span<Node* const> GetOperandsForCse(
     Node* node, std::vector<Node*>* span_backing_store) {
   XLS_CHECK(span_backing_store->empty());
@@ -53,34 +42,20 @@ absl::Span<Node* const> GetOperandsForCse(
   return *span_backing_store;
 }
 
-}  // namespace
-
 absl::StatusOr<bool> RunCse(FunctionBase* f,
                             absl::flat_hash_map<Node*, Node*>* replacements) {
-  // To improve efficiency, bucket potentially common nodes together. The
-  // bucketing is done via an int64_t hash value which is constructed from the
-  // op() of the node and the uid's of the node's operands.
-  auto hasher = absl::Hash<std::vector<int64_t>>();
-  auto node_hash = [&](Node* n) {
-    std::vector<int64_t> values_to_hash = {static_cast<int64_t>(n->op())};
-    std::vector<Node*> span_backing_store;
-    for (Node* operand : GetOperandsForCse(n, &span_backing_store)) {
-      values_to_hash.push_back(operand->id());
-    }
-    // If this is slow because of many literals, the Literal values could be
-    // combined into the hash. As is, all literals get the same hash value.
-    return hasher(values_to_hash);
-  };
-
   bool changed = false;
-  absl::flat_hash_map<int64_t, std::vector<Node*>> node_buckets;
+  // To improve efficiency, bucket potentially common nodes together by their
+  // structural hash which covers the op, operands and attributes of the node,
+  // so only nodes which are very likely equal share a bucket.
+  absl::flat_hash_map<uint64_t, std::vector<Node*>> node_buckets;
   node_buckets.reserve(f->node_count());
   for (Node* node : TopoSort(f)) {
     if (OpIsSideEffecting(node->op())) {
       continue;
     }
 
-    int64_t hash = node_hash(node);
+    uint64_t hash = node->StructuralHash();
     if (!node_buckets.contains(hash)) {
       node_buckets[hash].push_back(node);
       continue;
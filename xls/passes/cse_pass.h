@@ -15,7 +15,10 @@
 #ifndef XLS_PASSES_CSE_PASS_H_
 #define XLS_PASSES_CSE_PASS_H_
 
+#include <vector>
+
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/ir/function.h"
 #include "xls/passes/optimization_pass.h"
 
@@ -30,6 +33,13 @@ namespace xls {
 absl::StatusOr<bool> RunCse(FunctionBase* f,
                             absl::flat_hash_map<Node*, Node*>* replacements);
 
+// Returns the operands of the given node for the purposes of CSE. Operands of
+// commutative operations are sorted by node id (using `span_backing_store`,
+// which must be empty, as storage) so operand order does not prevent commoning.
+// Otherwise the node's own operand span is returned.
+absl::Span<Node* const> GetOperandsForCse(
+    Node* node, std::vector<Node*>* span_backing_store);
+
 // Computes the fixed point of a strict partial order, i.e.: the relation that
 // solves the equation `F = R ∘ F` where `R` is the given strict partial order.
 template <typename T>
@@ -59,6 +69,8 @@ class CsePass : public OptimizationFunctionBasePass {
                                      "Common subexpression elimination") {}
   ~CsePass() override = default;
 
+  bool IsFunctionLocal() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
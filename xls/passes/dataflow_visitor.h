@@ -61,6 +61,8 @@ class DataFlowVisitor : public DfsVisitorWithDefault {
         tuple, LeafTypeTree<T>(tuple->GetType(), absl::MakeSpan(elements)));
   }
 
+  // The value of the tuple index shares the leaves of the operand's value so
+  // this takes constant time regardless of the size of the element.
   absl::Status HandleTupleIndex(TupleIndex* tuple_index) override {
     return SetValue(tuple_index,
                     map_.at(tuple_index->operand(0))
@@ -14,6 +14,7 @@
 
 #include "xls/passes/dce_pass.h"
 
+#include <cstdint>
 #include <deque>
 
 #include "absl/status/statusor.h"
@@ -25,6 +26,13 @@
 #include "xls/passes/pass_base.h"
 
 namespace xls {
+namespace {
+
+// Minimum number of nodes removed by one run for the node arena to be
+// compacted.
+constexpr int64_t kCompactArenaMinRemovedNodes = 1024;
+
+}  // namespace
 
 absl::StatusOr<bool> DeadCodeEliminationPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
@@ -34,6 +42,7 @@ absl::StatusOr<bool> DeadCodeEliminationPass::RunOnFunctionBaseInternal(
            (!OpIsSideEffecting(n->op()) || n->Is<Gate>());
   };
 
+  int64_t original_count = f->node_count();
   std::deque<Node*> worklist;
   for (Node* n : f->nodes()) {
     if (n->users().empty() && is_deletable(n)) {
@@ -62,6 +71,15 @@ absl::StatusOr<bool> DeadCodeEliminationPass::RunOnFunctionBaseInternal(
   }
 
   XLS_VLOG(2) << "Removed " << removed_count << " dead nodes";
+
+  // After removing a large part of the graph, return the memory of the node
+  // arena slabs left without nodes rather than holding it for the rest of the
+  // pipeline.
+  if (removed_count >= kCompactArenaMinRemovedNodes &&
+      removed_count * 4 >= original_count) {
+    int64_t released = f->CompactNodeArena();
+    XLS_VLOG(2) << "Released " << released << " bytes of node arena memory";
+  }
   return removed_count > 0;
 }
 
@@ -32,6 +32,8 @@ class DeadCodeEliminationPass : public OptimizationFunctionBasePass {
       : OptimizationFunctionBasePass("dce", "Dead Code Elimination") {}
   ~DeadCodeEliminationPass() override = default;
 
+  bool IsFunctionLocal() const override { return true; }
+
  protected:
   // Iterate all nodes, mark and eliminate the unvisited nodes.
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
@@ -143,6 +143,9 @@ absl::StatusOr<bool> DeadFunctionEliminationPass::RunInternal(
   for (FunctionBase* f : p->GetFunctionBases()) {
     if (!reached.contains(f)) {
       XLS_VLOG(2) << "Removing: " << f->name();
+      if (options.query_engine_cache != nullptr) {
+        options.query_engine_cache->Invalidate(f);
+      }
       XLS_RETURN_IF_ERROR(p->RemoveFunctionBase(f));
       changed = true;
     }
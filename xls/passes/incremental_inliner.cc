@@ -0,0 +1,175 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/incremental_inliner.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/ir_interpreter.h"
+#include "xls/ir/function.h"
+#include "xls/ir/op.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/passes/cse_pass.h"
+#include "xls/passes/inlining_pass.h"
+
+namespace xls {
+
+bool IncrementalInliner::CanInline(Invoke* invoke) {
+  if (!IsInlineable(invoke)) {
+    return false;
+  }
+  Function* invoked = invoke->to_apply();
+  auto [it, inserted] = can_inline_.insert({invoked, true});
+  if (inserted) {
+    for (Node* node : invoked->nodes()) {
+      if ((node->Is<Invoke>() && IsInlineable(node->As<Invoke>())) ||
+          node->Is<Cover>() ||
+          (node->Is<Assert>() && node->As<Assert>()->label().has_value())) {
+        it->second = false;
+        break;
+      }
+    }
+  }
+  return it->second;
+}
+
+absl::StatusOr<Node*> IncrementalInliner::InlineAndSimplify(Invoke* invoke) {
+  XLS_RET_CHECK(CanInline(invoke)) << invoke->ToString();
+  XLS_RET_CHECK_EQ(invoke->function_base(), f_);
+  std::vector<Node*> operands(invoke->operands().begin(),
+                              invoke->operands().end());
+  std::vector<Node*> inlined_nodes;
+  // No labels are relabeled (see CanInline) so the inline count is unused.
+  XLS_ASSIGN_OR_RETURN(Node * result, InlineInvoke(invoke, /*inline_count=*/0,
+                                                   &inlined_nodes));
+
+  // Simplify in topological order so the operands of each node are already in
+  // simplified form when the node itself is considered.
+  std::vector<Node*> dead_candidates = std::move(operands);
+  for (Node* node : inlined_nodes) {
+    XLS_ASSIGN_OR_RETURN(Node * replacement, Simplify(node));
+    if (node == result) {
+      result = replacement;
+    }
+    dead_candidates.push_back(replacement);
+  }
+  // The result has no users yet, keep it alive while removing dead nodes.
+  bool newly_pinned = pinned_.insert(result).second;
+  XLS_RETURN_IF_ERROR(RemoveDeadNodes(dead_candidates));
+  if (newly_pinned) {
+    pinned_.erase(result);
+  }
+  return result;
+}
+
+absl::StatusOr<Node*> IncrementalInliner::Simplify(Node* node) {
+  if (OpIsSideEffecting(node->op())) {
+    return node;
+  }
+
+  if (!node->Is<Literal>() && !TypeHasToken(node->GetType()) &&
+      absl::c_all_of(node->operands(),
+                     [](Node* o) { return o->Is<Literal>(); })) {
+    std::vector<Value> operand_values;
+    for (Node* operand : node->operands()) {
+      operand_values.push_back(operand->As<Literal>()->value());
+    }
+    XLS_ASSIGN_OR_RETURN(Value result, InterpretNode(node, operand_values));
+    XLS_ASSIGN_OR_RETURN(Literal * literal,
+                         f_->MakeNode<Literal>(node->loc(), result));
+    XLS_VLOG(3) << "Folding " << node->GetName() << " to " << *literal;
+    XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(literal));
+    XLS_RETURN_IF_ERROR(RemoveNode(node));
+    node = literal;
+  }
+
+  uint64_t hash = node->StructuralHash();
+  std::vector<Node*>& bucket = cse_table_[hash];
+  std::vector<Node*> node_span_backing_store;
+  absl::Span<Node* const> node_operands_for_cse =
+      GetOperandsForCse(node, &node_span_backing_store);
+  for (Node* candidate : bucket) {
+    std::vector<Node*> candidate_span_backing_store;
+    if (node_operands_for_cse ==
+            GetOperandsForCse(candidate, &candidate_span_backing_store) &&
+        node->IsDefinitelyEqualTo(candidate)) {
+      XLS_VLOG(3) << "Replacing " << node->GetName()
+                  << " with equivalent node " << candidate->GetName();
+      XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(candidate));
+      XLS_RETURN_IF_ERROR(RemoveNode(node));
+      return candidate;
+    }
+  }
+  bucket.push_back(node);
+  cse_hashes_[node] = hash;
+  return node;
+}
+
+absl::Status IncrementalInliner::RemoveDeadNodes(
+    const std::vector<Node*>& candidates) {
+  auto is_dead = [&](Node* n) {
+    return n->users().empty() && !f_->HasImplicitUse(n) &&
+           !OpIsSideEffecting(n->op()) && !pinned_.contains(n);
+  };
+  // Candidates may contain duplicates and nodes removed while processing
+  // earlier candidates so track which nodes have been removed.
+  absl::flat_hash_set<Node*> removed;
+  std::deque<Node*> worklist;
+  for (auto it = candidates.rbegin(); it != candidates.rend(); ++it) {
+    worklist.push_back(*it);
+  }
+  while (!worklist.empty()) {
+    Node* node = worklist.front();
+    worklist.pop_front();
+    if (removed.contains(node) || !is_dead(node)) {
+      continue;
+    }
+    std::vector<Node*> operands(node->operands().begin(),
+                                node->operands().end());
+    XLS_RETURN_IF_ERROR(RemoveNode(node));
+    removed.insert(node);
+    for (Node* operand : operands) {
+      worklist.push_front(operand);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status IncrementalInliner::RemoveNode(Node* node) {
+  auto it = cse_hashes_.find(node);
+  if (it != cse_hashes_.end()) {
+    std::vector<Node*>& bucket = cse_table_.at(it->second);
+    bucket.erase(std::find(bucket.begin(), bucket.end(), node));
+    if (bucket.empty()) {
+      cse_table_.erase(it->second);
+    }
+    cse_hashes_.erase(it);
+  }
+  return f_->RemoveNode(node);
+}
+
+}  // namespace xls
@@ -0,0 +1,80 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_INCREMENTAL_INLINER_H_
+#define XLS_PASSES_INCREMENTAL_INLINER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+
+namespace xls {
+
+// Inlines invocations into a function one at a time and immediately simplifies
+// the inlined nodes with local constant folding, CSE and DCE. Used by the loop
+// and map unrollers so that the size of the function while unrolling tracks the
+// simplified design rather than the raw expansion.
+//
+// CSE only considers nodes which have been passed through this object, so the
+// cost of each inlining is proportional to the size of the invoked function
+// rather than the size of the function being inlined into.
+class IncrementalInliner {
+ public:
+  explicit IncrementalInliner(FunctionBase* f) : f_(f) {}
+
+  // Returns true if `invoke` can be inlined incrementally. This requires the
+  // invoked function to contain no inlineable invokes, and no coverpoints or
+  // labeled asserts whose labels would have to be uniquified.
+  bool CanInline(Invoke* invoke);
+
+  // Inlines `invoke`, which must satisfy CanInline, and simplifies the inlined
+  // nodes. Nodes which are dead after inlining are removed unless pinned.
+  // Returns the node which replaced the invoke.
+  absl::StatusOr<Node*> InlineAndSimplify(Invoke* invoke);
+
+  // Constant folds `node` if all of its operands are literals and then commons
+  // it with an equivalent node previously seen by this object. Returns the node
+  // which replaced `node` or `node` itself.
+  absl::StatusOr<Node*> Simplify(Node* node);
+
+  // Prevents `node` from being removed as dead code. Used for values which are
+  // not yet used but which will be used by the caller later.
+  void Pin(Node* node) { pinned_.insert(node); }
+
+ private:
+  // Removes nodes in `candidates` which have no users, and transitively any of
+  // their operands which become dead as a result.
+  absl::Status RemoveDeadNodes(const std::vector<Node*>& candidates);
+
+  // Removes `node` from the function and from the CSE table.
+  absl::Status RemoveNode(Node* node);
+
+  FunctionBase* f_;
+  absl::flat_hash_map<Function*, bool> can_inline_;
+  absl::flat_hash_map<uint64_t, std::vector<Node*>> cse_table_;
+  // The hash under which each node in `cse_table_` is stored.
+  absl::flat_hash_map<Node*, uint64_t> cse_hashes_;
+  absl::flat_hash_set<Node*> pinned_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_INCREMENTAL_INLINER_H_
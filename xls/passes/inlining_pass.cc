@@ -14,20 +14,25 @@
 
 #include "xls/passes/inlining_pass.h"
 
+#include <cstdint>
+#include <functional>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
+#include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/call_graph.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
 #include "xls/passes/optimization_pass.h"
 
 namespace xls {
@@ -82,14 +87,15 @@ std::string GetPrefixedLabel(Invoke* invoke, std::string_view label,
                       invoke->to_apply()->name(), "_", label);
 }
 
-static bool IsInlineable(const Invoke* invoke) {
+}  // namespace
+
+bool IsInlineable(const Invoke* invoke) {
   // Foreign functions can not and should not be inlined.
   return !invoke->to_apply()->ForeignFunctionData().has_value();
 }
 
-// Inlines the node "invoke" by replacing it with the contents of the called
-// function.
-absl::Status InlineInvoke(Invoke* invoke, int inline_count) {
+absl::StatusOr<Node*> InlineInvoke(Invoke* invoke, int inline_count,
+                                   std::vector<Node*>* inlined_nodes) {
   Function* invoked = invoke->to_apply();
   absl::flat_hash_map<Node*, Node*> invoked_node_to_replacement;
   for (int64_t i = 0; i < invoked->params().size(); ++i) {
@@ -186,30 +192,92 @@ absl::Status InlineInvoke(Invoke* invoke, int inline_count) {
     }
   }
 
-  XLS_RETURN_IF_ERROR(invoke->ReplaceUsesWith(
-      invoked_node_to_replacement.at(invoked->return_value())));
-  return invoke->function_base()->RemoveNode(invoke);
-}
+  if (inlined_nodes != nullptr) {
+    for (Node* node : TopoSort(invoked)) {
+      if (!node->Is<Param>()) {
+        inlined_nodes->push_back(invoked_node_to_replacement.at(node));
+      }
+    }
+  }
 
-}  // namespace
+  Node* replacement = invoked_node_to_replacement.at(invoked->return_value());
+  XLS_RETURN_IF_ERROR(invoke->ReplaceUsesWith(replacement));
+  XLS_RETURN_IF_ERROR(invoke->function_base()->RemoveNode(invoke));
+  return replacement;
+}
 
 absl::StatusOr<bool> InliningPass::RunInternal(
     Package* p, const OptimizationPassOptions& options,
     PassResults* results) const {
+  // Number of nodes calling each function. Once all calls of a function have
+  // been inlined it is unreachable, and if the package has a top it is removed
+  // right away rather than by a later dead function elimination, so that the
+  // memory of large callees is not held while their callers are inlined.
+  absl::flat_hash_map<Function*, int64_t> call_counts;
+  std::optional<FunctionBase*> top = p->GetTop();
+  bool remove_dead_callees = top.has_value();
+  if (remove_dead_callees) {
+    for (FunctionBase* f : p->GetFunctionBases()) {
+      for (Node* node : f->nodes()) {
+        if (std::optional<Function*> callee = CalledFunction(node)) {
+          ++call_counts[*callee];
+        }
+      }
+    }
+  }
+  std::function<absl::Status(Function*)> remove_call =
+      [&](Function* callee) -> absl::Status {
+    if (--call_counts[callee] > 0 || *top == callee) {
+      return absl::OkStatus();
+    }
+    XLS_VLOG(2) << "Removing fully inlined function: " << callee->name();
+    // The nodes of the removed function no longer call anything.
+    std::vector<Function*> called;
+    for (Node* node : callee->nodes()) {
+      if (std::optional<Function*> f = CalledFunction(node)) {
+        called.push_back(*f);
+      }
+    }
+    if (options.query_engine_cache != nullptr) {
+      options.query_engine_cache->Invalidate(callee);
+    }
+    XLS_RETURN_IF_ERROR(p->RemoveFunction(callee));
+    for (Function* f : called) {
+      XLS_RETURN_IF_ERROR(remove_call(f));
+    }
+    return absl::OkStatus();
+  };
+
   bool changed = false;
   // Inline all the invokes of each function where functions are processed in a
   // post order of the call graph (leaves first). This ensures that when a
   // function Foo is inlined into its callsites, no invokes remain in Foo. This
-  // avoid duplicate work.
+  // avoid duplicate work. Removed callees always precede the function being
+  // processed in this order.
   int inline_count = 0;
+  std::vector<Node*> inlined_nodes;
   for (FunctionBase* f : FunctionsInPostOrder(p)) {
     // Create copy of nodes() because we will be adding and removing nodes
     // during inlining.
     std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
     for (Node* node : nodes) {
       if (node->Is<Invoke>() && IsInlineable(node->As<Invoke>())) {
-        XLS_RETURN_IF_ERROR(InlineInvoke(node->As<Invoke>(), inline_count++));
+        Function* callee = node->As<Invoke>()->to_apply();
+        inlined_nodes.clear();
+        XLS_RETURN_IF_ERROR(InlineInvoke(node->As<Invoke>(), inline_count++,
+                                         remove_dead_callees ? &inlined_nodes
+                                                             : nullptr)
+                                .status());
         changed = true;
+        if (remove_dead_callees) {
+          // Calls in the callee (e.g. maps) are copied into the caller.
+          for (Node* inlined : inlined_nodes) {
+            if (std::optional<Function*> called = CalledFunction(inlined)) {
+              ++call_counts[*called];
+            }
+          }
+          XLS_RETURN_IF_ERROR(remove_call(callee));
+        }
       }
     }
   }
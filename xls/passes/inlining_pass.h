@@ -15,12 +15,27 @@
 #ifndef XLS_PASSES_INLINING_PASS_H_
 #define XLS_PASSES_INLINING_PASS_H_
 
+#include <vector>
+
 #include "absl/status/statusor.h"
 #include "xls/ir/function.h"
+#include "xls/ir/nodes.h"
 #include "xls/passes/optimization_pass.h"
 
 namespace xls {
 
+// Returns true if the invoke can be inlined, i.e. the invoked function is not
+// a foreign function.
+bool IsInlineable(const Invoke* invoke);
+
+// Inlines the node "invoke" by replacing it with the contents of the called
+// function and returns the node which replaced it. The called function must not
+// contain any inlineable invokes. `inline_count` is used to make the labels of
+// inlined coverpoints and asserts unique. If `inlined_nodes` is non-null the
+// nodes created by inlining are appended to it in topological order.
+absl::StatusOr<Node*> InlineInvoke(Invoke* invoke, int inline_count,
+                                   std::vector<Node*>* inlined_nodes = nullptr);
+
 class InliningPass : public OptimizationPass {
  public:
   InliningPass() : OptimizationPass("inlining", "Inlines invocations") {}
@@ -19,6 +19,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
@@ -37,6 +38,7 @@ namespace xls {
 namespace {
 
 using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
 using testing::AnyOf;
 using testing::Eq;
 
@@ -157,6 +159,47 @@ fn caller() -> bits[32] {
   EXPECT_EQ(f->return_value()->As<Invoke>()->to_apply()->name(), "ffi_callee");
 }
 
+TEST_F(InliningPassTest, FullyInlinedFunctionsRemovedWithTop) {
+  const std::string program = R"(
+package some_package
+
+fn mapped(x: bits[32]) -> bits[32] {
+  ret neg.1: bits[32] = neg(x)
+}
+
+fn callee2(x: bits[32][4]) -> bits[32][4] {
+  ret map.2: bits[32][4] = map(x, to_apply=mapped)
+}
+
+fn callee1(x: bits[32][4]) -> bits[32][4] {
+  ret invoke.3: bits[32][4] = invoke(x, to_apply=callee2)
+}
+
+fn unused(x: bits[32]) -> bits[32] {
+  ret not.4: bits[32] = not(x)
+}
+
+top fn caller(x: bits[32][4]) -> bits[32][4] {
+  invoke.5: bits[32][4] = invoke(x, to_apply=callee1)
+  ret invoke.6: bits[32][4] = invoke(invoke.5, to_apply=callee1)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(program));
+  ASSERT_THAT(Inline(package.get()), IsOkAndHolds(true));
+  // The inlined functions are removed, whereas the function called by the
+  // inlined maps remains, as does the function never called (left to dead
+  // function elimination).
+  EXPECT_THAT(package->GetFunction("callee1"),
+              StatusIs(absl::StatusCode::kNotFound));
+  EXPECT_THAT(package->GetFunction("callee2"),
+              StatusIs(absl::StatusCode::kNotFound));
+  XLS_EXPECT_OK(package->GetFunction("mapped").status());
+  XLS_EXPECT_OK(package->GetFunction("unused").status());
+  Function* f = FindFunction("caller", package.get());
+  EXPECT_THAT(f->return_value(), m::Map(m::Map(m::Param("x"))));
+}
+
 TEST_F(InliningPassTest, NamePropagation) {
   const std::string program = R"(
 package some_package
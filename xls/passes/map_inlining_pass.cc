@@ -14,6 +14,7 @@
 
 #include "xls/passes/map_inlining_pass.h"
 
+#include <optional>
 #include <vector>
 
 #include "absl/status/status.h"
@@ -29,8 +30,9 @@
 
 namespace xls {
 
-MapInliningPass::MapInliningPass()
-    : OptimizationFunctionBasePass("map_inlining", "Inline map operations") {}
+MapInliningPass::MapInliningPass(bool simplify_incrementally)
+    : OptimizationFunctionBasePass("map_inlining", "Inline map operations"),
+      simplify_incrementally_(simplify_incrementally) {}
 
 absl::StatusOr<bool> MapInliningPass::RunOnFunctionBaseInternal(
     FunctionBase* function, const OptimizationPassOptions& options,
@@ -44,14 +46,20 @@ absl::StatusOr<bool> MapInliningPass::RunOnFunctionBaseInternal(
     }
   }
 
+  std::optional<IncrementalInliner> inliner;
+  if (simplify_incrementally_) {
+    inliner.emplace(function);
+  }
   for (Node* node : map_nodes) {
-    XLS_RETURN_IF_ERROR(ReplaceMap(node->As<Map>()));
+    XLS_RETURN_IF_ERROR(ReplaceMap(
+        node->As<Map>(), inliner.has_value() ? &inliner.value() : nullptr));
   }
 
   return changed;
 }
 
-absl::Status MapInliningPass::ReplaceMap(Map* map) const {
+absl::Status MapInliningPass::ReplaceMap(Map* map,
+                                         IncrementalInliner* inliner) const {
   FunctionBase* function = map->function_base();
 
   int map_inputs_size = map->operand(0)->GetType()->AsArrayOrDie()->size();
@@ -62,13 +70,25 @@ absl::Status MapInliningPass::ReplaceMap(Map* map) const {
         Value(UBits(i, Bits::MinBitCountUnsigned(map_inputs_size)));
     XLS_ASSIGN_OR_RETURN(Node * index,
                          function->MakeNode<Literal>(map->loc(), index_value));
+    if (inliner != nullptr) {
+      XLS_ASSIGN_OR_RETURN(index, inliner->Simplify(index));
+    }
     XLS_ASSIGN_OR_RETURN(Node * array_index, function->MakeNode<ArrayIndex>(
                                                  map->loc(), map->operand(0),
                                                  std::vector<Node*>({index})));
+    if (inliner != nullptr) {
+      XLS_ASSIGN_OR_RETURN(array_index, inliner->Simplify(array_index));
+    }
     XLS_ASSIGN_OR_RETURN(
-        Node * node,
+        Invoke * invoke,
         function->MakeNode<Invoke>(map->loc(), absl::MakeSpan(&array_index, 1),
                                    map->to_apply()));
+    Node* node = invoke;
+    if (inliner != nullptr && inliner->CanInline(invoke)) {
+      XLS_ASSIGN_OR_RETURN(node, inliner->InlineAndSimplify(invoke));
+      // The element is not used until the array is created below.
+      inliner->Pin(node);
+    }
     invocations.push_back(node);
   }
 
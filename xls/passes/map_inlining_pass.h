@@ -16,6 +16,8 @@
 #define XLS_PASSES_MAP_INLINING_PASS_H_
 
 #include "absl/status/statusor.h"
+#include "xls/ir/nodes.h"
+#include "xls/passes/incremental_inliner.h"
 #include "xls/passes/optimization_pass.h"
 
 namespace xls {
@@ -24,15 +26,21 @@ namespace xls {
 // maps to Verilog.
 class MapInliningPass : public OptimizationFunctionBasePass {
  public:
-  MapInliningPass();
+  // If `simplify_incrementally` is true then the invocation for each element is
+  // inlined and locally simplified as soon as it is created. See UnrollPass.
+  explicit MapInliningPass(bool simplify_incrementally = false);
 
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* function, const OptimizationPassOptions& options,
       PassResults* results) const override;
 
-  // Replaces a single Map node with a CountedFor operation.
-  absl::Status ReplaceMap(Map* map) const;
+  // Replaces a single Map node with a CountedFor operation. If `inliner` is
+  // non-null it is used to inline and simplify the per-element invocations.
+  absl::Status ReplaceMap(Map* map, IncrementalInliner* inliner) const;
+
+ private:
+  bool simplify_incrementally_;
 };
 
 }  // namespace xls
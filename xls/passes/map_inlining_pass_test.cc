@@ -94,5 +94,43 @@ fn main(a: bits[32][4]) -> bits[16][4] {
           m::Invoke(m::ArrayIndex(m::Param(), /*indices=*/{m::Literal(3)}))));
 }
 
+TEST(MapInliningPass, SimplifyIncrementally) {
+  const char kPackage[] = R"(
+package p
+
+fn map_fn(x: bits[32]) -> bits[16] {
+  ret bit_slice.1: bits[16] = bit_slice(x, start=0, width=16)
+}
+
+fn main(a: bits[32][3]) -> (bits[16][3], bits[16][3]) {
+  literal.1: bits[32][3] = literal(value=[0x10001, 0x20002, 0x10001])
+  map.2: bits[16][3] = map(literal.1, to_apply=map_fn)
+  map.3: bits[16][3] = map(a, to_apply=map_fn)
+  ret tuple.4: (bits[16][3], bits[16][3]) = tuple(map.2, map.3)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(kPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(auto func, package->GetFunction("main"));
+  MapInliningPass pass(/*simplify_incrementally=*/true);
+  OptimizationPassOptions options;
+  XLS_ASSERT_OK_AND_ASSIGN(bool changed,
+                           pass.RunOnFunctionBase(func, options, nullptr));
+  ASSERT_TRUE(changed);
+
+  // The map over the literal is folded, with the repeated element commoned.
+  // The map over the parameter is inlined without invokes.
+  EXPECT_THAT(
+      func->return_value(),
+      m::Tuple(
+          m::Array(m::Literal(1), m::Literal(2), m::Literal(1)),
+          m::Array(
+              m::BitSlice(m::ArrayIndex(m::Param(), {m::Literal(0)})),
+              m::BitSlice(m::ArrayIndex(m::Param(), {m::Literal(1)})),
+              m::BitSlice(m::ArrayIndex(m::Param(), {m::Literal(2)})))));
+  Node* array = func->return_value()->operand(0);
+  EXPECT_EQ(array->operand(0), array->operand(2));
+}
+
 }  // namespace
 }  // namespace xls
@@ -22,12 +22,16 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/numeric/int128.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits_ops.h"
+#include "xls/ir/fingerprint.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/node_util.h"
 #include "xls/ir/nodes.h"
@@ -37,6 +41,7 @@
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/range_query_engine.h"
 #include "xls/passes/ternary_query_engine.h"
 #include "xls/passes/union_query_engine.h"
@@ -957,40 +962,117 @@ static absl::StatusOr<bool> MaybeReplacePreciseWithLiteral(
   return true;
 }
 
-static absl::StatusOr<std::unique_ptr<QueryEngine>> GetQueryEngine(
-    FunctionBase* f, bool use_range_analysis) {
-  std::unique_ptr<QueryEngine> query_engine;
+// The query engines narrowing consults. The ternary and range engines are
+// shared through the QueryEngineCache; `engine` combines them.
+struct NarrowingQueryEngines {
+  std::shared_ptr<const TernaryQueryEngine> ternary;
+  std::shared_ptr<const RangeQueryEngine> range;
+  std::unique_ptr<UnionQueryEngine> engine;
+};
+
+static absl::StatusOr<NarrowingQueryEngines> GetNarrowingQueryEngines(
+    FunctionBase* f, bool use_range_analysis, QueryEngineCache* cache) {
+  NarrowingQueryEngines engines;
+  XLS_ASSIGN_OR_RETURN(engines.ternary,
+                       GetQueryEngine<TernaryQueryEngine>(cache, f));
+  std::vector<const QueryEngine*> engine_ptrs = {engines.ternary.get()};
   if (use_range_analysis) {
-    auto ternary_query_engine = std::make_unique<TernaryQueryEngine>();
-    auto range_query_engine = std::make_unique<RangeQueryEngine>();
-
+    XLS_ASSIGN_OR_RETURN(engines.range,
+                         GetQueryEngine<RangeQueryEngine>(cache, f));
     if (XLS_VLOG_IS_ON(3)) {
-      RangeAnalysisLog(f, *ternary_query_engine, *range_query_engine);
+      RangeAnalysisLog(f, *engines.ternary, *engines.range);
     }
+    engine_ptrs.push_back(engines.range.get());
+  }
+  engines.engine = std::make_unique<UnionQueryEngine>(std::move(engine_ptrs));
+  return std::move(engines);
+}
+
+// Returns whether the narrowing of `node` depends on more than its operand
+// cone. Partial products are narrowed together with the add of their users.
+static bool NarrowingDependsOnUsers(Node* node) {
+  return node->op() == Op::kSMulp || node->op() == Op::kUMulp;
+}
+
+// Returns the key under which the decision not to narrow the node with the
+// given fingerprint is cached: the fingerprint along with the configuration
+// the decision was made with.
+static absl::uint128 NarrowingDecisionKey(
+    absl::uint128 node_fingerprint, bool use_range_analysis,
+    const OptimizationPassOptions& options) {
+  return FingerprintBuilder()
+      .Add(node_fingerprint)
+      .Add(uint64_t{use_range_analysis})
+      .Add(static_cast<uint64_t>(
+          options.convert_array_index_to_select.value_or(-1)))
+      .Finish();
+}
+
+// Bound on the number of cached decisions, past which the cache is cleared.
+constexpr int64_t kMaxUnnarrowableCount = int64_t{1} << 20;
 
-    std::vector<std::unique_ptr<QueryEngine>> engines;
-    engines.push_back(std::move(ternary_query_engine));
-    engines.push_back(std::move(range_query_engine));
-    query_engine = std::make_unique<UnionQueryEngine>(std::move(engines));
-  } else {
-    query_engine = std::make_unique<TernaryQueryEngine>();
+bool NarrowingPass::IsKnownUnnarrowable(absl::uint128 key) const {
+  absl::MutexLock lock(&mutex_);
+  if (!unnarrowable_.contains(key)) {
+    return false;
   }
-  XLS_RETURN_IF_ERROR(query_engine->Populate(f).status());
-  return std::move(query_engine);
+  ++decision_cache_hit_count_;
+  return true;
+}
+
+void NarrowingPass::RecordUnnarrowable(absl::uint128 key) const {
+  absl::MutexLock lock(&mutex_);
+  if (unnarrowable_.size() >= kMaxUnnarrowableCount) {
+    unnarrowable_.clear();
+  }
+  unnarrowable_.insert(key);
 }
 
 absl::StatusOr<bool> NarrowingPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<QueryEngine> query_engine,
-                       GetQueryEngine(f, use_range_analysis_));
+  // Range analysis is much more expensive than ternary analysis, so fall back
+  // to the latter once the compile-time budget is spent.
+  bool use_range_analysis = use_range_analysis_;
+  if (use_range_analysis && options.CompileTimeBudgetExhausted()) {
+    options.compile_time_budget->RecordSkip(
+        short_name(), "used ternary instead of range analysis");
+    use_range_analysis = false;
+  }
+
+  // Fingerprints of the nodes as they are before the pass changes anything,
+  // which is the state the query engines describe. A decision is only cached
+  // if the node still has this fingerprint when it is made.
+  FunctionFingerprinter fingerprinter(f);
+  absl::flat_hash_map<Node*, absl::uint128> analyzed_fingerprints;
+  for (Node* node : f->nodes()) {
+    analyzed_fingerprints[node] = fingerprinter.NodeFingerprint(node);
+  }
 
+  // The query engines are only populated once a node needs examining.
+  std::optional<NarrowingQueryEngines> engines;
   bool modified = false;
 
   for (Node* node : TopoSort(f)) {
     if (OpIsSideEffecting(node->op())) {
       continue;
     }
+    std::optional<absl::uint128> key;
+    if (!NarrowingDependsOnUsers(node)) {
+      absl::uint128 fingerprint = fingerprinter.NodeFingerprint(node);
+      if (fingerprint == analyzed_fingerprints.at(node)) {
+        key = NarrowingDecisionKey(fingerprint, use_range_analysis, options);
+        if (IsKnownUnnarrowable(*key)) {
+          continue;
+        }
+      }
+    }
+    if (!engines.has_value()) {
+      XLS_ASSIGN_OR_RETURN(
+          engines, GetNarrowingQueryEngines(f, use_range_analysis,
+                                            options.query_engine_cache.get()));
+    }
+    const QueryEngine* query_engine = engines->engine.get();
     bool node_modified = false;
     if (!node->Is<Literal>() && !node->Is<Param>()) {
       XLS_ASSIGN_OR_RETURN(node_modified,
@@ -1011,7 +1093,7 @@ absl::StatusOr<bool> NarrowingPass::RunOnFunctionBaseInternal(
       case Op::kArrayIndex: {
         XLS_ASSIGN_OR_RETURN(
             node_modified,
-            MaybeNarrowArrayIndex(use_range_analysis_, options,
+            MaybeNarrowArrayIndex(use_range_analysis, options,
                                   node->As<ArrayIndex>(), *query_engine));
         break;
       }
@@ -1053,6 +1135,9 @@ absl::StatusOr<bool> NarrowingPass::RunOnFunctionBaseInternal(
         break;
     }
     modified |= node_modified;
+    if (!node_modified && key.has_value()) {
+      RecordUnnarrowable(*key);
+    }
   }
   return modified;
 }
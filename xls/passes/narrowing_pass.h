@@ -15,7 +15,13 @@
 #ifndef XLS_PASSES_NARROWING_PASS_H_
 #define XLS_PASSES_NARROWING_PASS_H_
 
+#include <cstdint>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/numeric/int128.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/ir/function.h"
 #include "xls/passes/optimization_pass.h"
 
@@ -23,6 +29,14 @@ namespace xls {
 
 // A pass which reduces the width of operations eliminating redundant or unused
 // bits.
+//
+// The pass runs many times per function within the fixed-point pipeline, so it
+// remembers the nodes it examined and left alone, keyed by their structural
+// fingerprint (see xls/ir/fingerprint.h). A fingerprint covers the node's whole
+// operand cone, which determines everything the analyses know about the node,
+// so a node which comes up again with the same fingerprint is skipped. Only
+// nodes whose fan-in changed are reexamined, and the analyses are not
+// consulted at all if there are none.
 class NarrowingPass : public OptimizationFunctionBasePass {
  public:
   explicit NarrowingPass(bool use_range_analysis = true,
@@ -32,12 +46,30 @@ class NarrowingPass : public OptimizationFunctionBasePass {
         opt_level_(opt_level) {}
   ~NarrowingPass() override = default;
 
+  bool IsFunctionLocal() const override { return true; }
+
+  // Number of nodes skipped because they were known not to be narrowable.
+  int64_t decision_cache_hit_count() const {
+    absl::MutexLock lock(&mutex_);
+    return decision_cache_hit_count_;
+  }
+
  protected:
   bool use_range_analysis_;
   int64_t opt_level_;
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
       PassResults* results) const override;
+
+ private:
+  bool IsKnownUnnarrowable(absl::uint128 key) const;
+  void RecordUnnarrowable(absl::uint128 key) const;
+
+  mutable absl::Mutex mutex_;
+  // Keys (see NarrowingDecisionKey) of the nodes found not to be narrowable.
+  mutable absl::flat_hash_set<absl::uint128> unnarrowable_
+      ABSL_GUARDED_BY(mutex_);
+  mutable int64_t decision_cache_hit_count_ ABSL_GUARDED_BY(mutex_) = 0;
 };
 
 }  // namespace xls
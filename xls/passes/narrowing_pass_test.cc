@@ -564,6 +564,53 @@ TEST_P(NarrowingPassTest, SideEffectfulButNarrowable) {
   ASSERT_THAT(Run(p.get()), IsOkAndHolds(false));
 }
 
+TEST_P(NarrowingPassTest, SkipsNodesKnownNotToBeNarrowable) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue in = fb.Param("in", p->GetBitsType(32));
+  BValue shra = fb.Shra(in, fb.Param("amt", p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  NarrowingPass pass(/*use_range_analysis=*/GetParam());
+  PassResults results;
+  OptimizationPassOptions options;
+  ASSERT_THAT(pass.Run(p.get(), options, &results), IsOkAndHolds(false));
+  EXPECT_EQ(pass.decision_cache_hit_count(), 0);
+
+  // Only the new node is examined; the parameters and the shift are known not
+  // to be narrowable.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * add, f->MakeNode<BinOp>(SourceInfo(), shra.node(), in.node(),
+                                     Op::kAdd));
+  XLS_ASSERT_OK(f->set_return_value(add));
+  ASSERT_THAT(pass.Run(p.get(), options, &results), IsOkAndHolds(false));
+  EXPECT_EQ(pass.decision_cache_hit_count(), 3);
+}
+
+TEST_P(NarrowingPassTest, ReexaminesNodesWhoseFaninChanged) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue amt = fb.Param("amt", p->GetBitsType(3));
+  BValue wide_amt = fb.Param("wide_amt", p->GetBitsType(32));
+  fb.Shll(fb.Param("in", p->GetBitsType(32)), wide_amt);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  NarrowingPass pass(/*use_range_analysis=*/GetParam());
+  PassResults results;
+  OptimizationPassOptions options;
+  ASSERT_THAT(pass.Run(p.get(), options, &results), IsOkAndHolds(false));
+
+  // Once the shift amount is known to fit in three bits the shift narrows.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * zero_ext,
+      f->MakeNode<ExtendOp>(SourceInfo(), amt.node(), /*new_bit_count=*/32,
+                            Op::kZeroExt));
+  XLS_ASSERT_OK(wide_amt.node()->ReplaceUsesWith(zero_ext));
+  ASSERT_THAT(pass.Run(p.get(), options, &results), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(),
+              m::Shll(m::Param("in"), m::BitSlice(/*start=*/0, /*width=*/3)));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     NarrowingPassTestInstantiation, NarrowingPassTest,
     testing::Values(false, true),
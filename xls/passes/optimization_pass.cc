@@ -14,9 +14,12 @@
 
 #include "xls/passes/optimization_pass.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <iterator>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -26,10 +29,12 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/package.h"
 #include "xls/ir/ram_rewrite.pb.h"
@@ -125,6 +130,28 @@ absl::StatusOr<std::vector<RamRewrite>> RamRewritesFromProto(
   return rewrites;
 }
 
+bool FunctionPassHistory::IsKnownUnchanged(
+    const OptimizationFunctionBasePass* pass, FunctionBase* f) const {
+  auto [function_id, version] = f->graph_version();
+  absl::MutexLock lock(&mutex_);
+  auto it = unchanged_.find({pass->instance_id(), function_id});
+  return it != unchanged_.end() && it->second == version;
+}
+
+void FunctionPassHistory::RecordUnchanged(
+    const OptimizationFunctionBasePass* pass, FunctionBase* f) {
+  auto [function_id, version] = f->graph_version();
+  absl::MutexLock lock(&mutex_);
+  unchanged_[{pass->instance_id(), function_id}] = version;
+}
+
+OptimizationFunctionBasePass::OptimizationFunctionBasePass(
+    std::string_view short_name, std::string_view long_name)
+    : OptimizationPass(short_name, long_name), instance_id_([] {
+        static std::atomic<int64_t> next_instance_id = 0;
+        return next_instance_id++;
+      }()) {}
+
 absl::StatusOr<bool> OptimizationFunctionBasePass::RunOnFunctionBase(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
@@ -145,10 +172,101 @@ absl::StatusOr<bool> OptimizationFunctionBasePass::RunOnFunctionBase(
 absl::StatusOr<bool> OptimizationFunctionBasePass::RunInternal(
     Package* p, const OptimizationPassOptions& options,
     PassResults* results) const {
+  std::vector<FunctionBase*> function_bases = p->GetFunctionBases();
+  FunctionPassHistory* history =
+      IsFunctionLocal() ? options.function_pass_history.get() : nullptr;
+  if (history != nullptr) {
+    function_bases.erase(
+        std::remove_if(function_bases.begin(), function_bases.end(),
+                       [&](FunctionBase* f) {
+                         return history->IsKnownUnchanged(this, f);
+                       }),
+        function_bases.end());
+  }
+  if (IsFunctionLocal() && options.function_parallelism > 1 &&
+      function_bases.size() > 1) {
+    return RunOnFunctionBasesInParallel(p, function_bases, options);
+  }
   bool changed = false;
-  for (FunctionBase* f : p->GetFunctionBases()) {
+  for (FunctionBase* f : function_bases) {
     XLS_ASSIGN_OR_RETURN(bool function_changed,
                          RunOnFunctionBaseInternal(f, options, results));
+    if (history != nullptr && !function_changed) {
+      history->RecordUnchanged(this, f);
+    }
+    changed = changed || function_changed;
+  }
+  return changed;
+}
+
+absl::StatusOr<bool> OptimizationFunctionBasePass::RunOnFunctionBasesInParallel(
+    Package* p, absl::Span<FunctionBase* const> function_bases,
+    const OptimizationPassOptions& options) const {
+  // Each function draws node ids from a private sequence starting at the
+  // package's next id. Afterwards the new ids are shifted to the values that
+  // processing the functions sequentially in package order would have
+  // produced. The relative order of ids within each function is the same as in
+  // a sequential run, so the pass sees identically ordered user lists and the
+  // output does not depend on thread scheduling.
+  const int64_t first_id = p->next_node_id();
+  for (FunctionBase* f : function_bases) {
+    f->BeginLocalNodeIds(first_id);
+  }
+
+  std::vector<absl::StatusOr<bool>> function_results(function_bases.size(),
+                                                     false);
+  std::atomic<int64_t> next_function = 0;
+  auto worker = [&]() {
+    // Function-local passes do not consult the pass results so each worker
+    // gets a scratch instance.
+    PassResults worker_results;
+    for (int64_t i = next_function++; i < function_bases.size();
+         i = next_function++) {
+      function_results[i] = RunOnFunctionBaseInternal(function_bases[i],
+                                                      options, &worker_results);
+      if (options.function_pass_history != nullptr &&
+          function_results[i].ok() && !*function_results[i]) {
+        options.function_pass_history->RecordUnchanged(this, function_bases[i]);
+      }
+    }
+  };
+  {
+    int64_t thread_count = std::min<int64_t>(options.function_parallelism,
+                                             function_bases.size());
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t i = 0; i < thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    // Threads are joined on destruction.
+  }
+
+  int64_t id_offset = 0;
+  for (FunctionBase* f : function_bases) {
+    int64_t end_id = f->EndLocalNodeIds();
+    if (id_offset != 0 && end_id > first_id) {
+      std::vector<Node*> new_nodes;
+      for (Node* node : f->nodes()) {
+        if (node->id() >= first_id) {
+          new_nodes.push_back(node);
+        }
+      }
+      // Shift the largest ids first so that no two nodes of the function share
+      // an id at any point.
+      std::sort(new_nodes.begin(), new_nodes.end(),
+                [](Node* a, Node* b) { return a->id() > b->id(); });
+      for (Node* node : new_nodes) {
+        node->SetId(node->id() + id_offset);
+      }
+    }
+    id_offset += end_id - first_id;
+  }
+  p->set_next_node_id(first_id + id_offset);
+
+  // Report the first error in package order so failures are deterministic too.
+  bool changed = false;
+  for (absl::StatusOr<bool>& result : function_results) {
+    XLS_ASSIGN_OR_RETURN(bool function_changed, result);
     changed = changed || function_changed;
   }
   return changed;
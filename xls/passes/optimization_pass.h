@@ -21,15 +21,20 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc.h"
 #include "xls/ir/ram_rewrite.pb.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/query_engine_cache.h"
 
 namespace xls {
 
@@ -95,6 +100,37 @@ struct RamRewrite {
 absl::StatusOr<std::vector<RamRewrite>> RamRewritesFromProto(
     const RamRewritesProto& proto);
 
+class OptimizationFunctionBasePass;
+
+// Records the functions and procs which each function-local pass (see
+// OptimizationFunctionBasePass::IsFunctionLocal) has run on without changing
+// them, tagged with the graph version at the time. Running the pass on such a
+// function again before the function changes would be a no-op, so it is
+// skipped; within fixed-point pipelines this confines the later iterations of
+// these passes to the functions other passes have touched. Passes and
+// functions are identified by process-unique instance ids rather than
+// addresses, which may be reused. The options the passes run with are not
+// recorded, so a history must only be shared by runs with the same options.
+// Thread safe.
+class FunctionPassHistory {
+ public:
+  // Returns whether `pass` last ran on `f` without changing it, and `f` has
+  // not changed since.
+  bool IsKnownUnchanged(const OptimizationFunctionBasePass* pass,
+                        FunctionBase* f) const;
+
+  // Records that `pass` ran on `f` and did not change it.
+  void RecordUnchanged(const OptimizationFunctionBasePass* pass,
+                       FunctionBase* f);
+
+ private:
+  mutable absl::Mutex mutex_;
+  // Graph version counter of each function, keyed by the instance ids of the
+  // pass and the function.
+  absl::flat_hash_map<std::pair<int64_t, int64_t>, int64_t> unchanged_
+      ABSL_GUARDED_BY(mutex_);
+};
+
 struct OptimizationPassOptions : public PassOptionsBase {
   OptimizationPassOptions() = default;
 
@@ -120,6 +156,24 @@ struct OptimizationPassOptions : public PassOptionsBase {
   // List of RAM rewrites, generally lowering abstract RAMs into concrete
   // variants.
   std::vector<RamRewrite> ram_rewrites;
+
+  // Maximum number of threads used to run function-local passes (see
+  // OptimizationFunctionBasePass::IsFunctionLocal) across the functions and
+  // procs of a package. A value of one runs everything on the calling thread.
+  int64_t function_parallelism = 1;
+
+  // Query engines shared by all passes run with these options (copies of the
+  // options share the cache). Passes obtain engines with
+  // GetQueryEngine<EngineT>(options.query_engine_cache.get(), f). May be null,
+  // in which case every request populates a new engine.
+  std::shared_ptr<QueryEngineCache> query_engine_cache =
+      std::make_shared<QueryEngineCache>();
+
+  // History used to skip rerunning function-local passes on functions they
+  // left unchanged (copies of the options share it). If null, the default,
+  // every pass runs on every function. Pipeline drivers set it for a single
+  // run of the pipeline with fixed options.
+  std::shared_ptr<FunctionPassHistory> function_pass_history;
 };
 
 // An object containing information about the invocation of a pass (single call
@@ -146,14 +200,26 @@ inline bool NarrowingEnabled(int64_t opt_level) { return opt_level >= 2; }
 class OptimizationFunctionBasePass : public OptimizationPass {
  public:
   OptimizationFunctionBasePass(std::string_view short_name,
-                               std::string_view long_name)
-      : OptimizationPass(short_name, long_name) {}
+                               std::string_view long_name);
+
+  // Identifier unique across all passes created in the process.
+  int64_t instance_id() const { return instance_id_; }
 
   // Runs the pass on a single function/proc.
   absl::StatusOr<bool> RunOnFunctionBase(FunctionBase* f,
                                          const OptimizationPassOptions& options,
                                          PassResults* results) const;
 
+  // Returns whether the pass reads and writes nothing but the function/proc it
+  // is run on, aside from the thread-safe package services (type creation and
+  // value interning), and ignores `results`. Such passes are run concurrently
+  // across functions and procs when options.function_parallelism is greater
+  // than one. Node ids, and therefore the result, are the same as when the
+  // functions are processed sequentially. They are also not rerun on functions
+  // which they left unchanged and which have not changed since (see
+  // FunctionPassHistory), so the result must depend only on the function.
+  virtual bool IsFunctionLocal() const { return false; }
+
  protected:
   // Iterates over each function and proc in the package calling
   // RunOnFunctionBase.
@@ -175,6 +241,15 @@ class OptimizationFunctionBasePass : public OptimizationPass {
   absl::StatusOr<bool> TransformNodesToFixedPoint(
       FunctionBase* f,
       std::function<absl::StatusOr<bool>(Node*)> simplify_f) const;
+
+ private:
+  // Runs the pass on each of `function_bases` using up to
+  // options.function_parallelism threads.
+  absl::StatusOr<bool> RunOnFunctionBasesInParallel(
+      Package* p, absl::Span<FunctionBase* const> function_bases,
+      const OptimizationPassOptions& options) const;
+
+  const int64_t instance_id_;
 };
 
 // Abstract base class for passes operate on procs. The derived
@@ -122,8 +122,10 @@ std::unique_ptr<OptimizationCompoundPass> CreateOptimizationPassPipeline(
   // in the entire pipeline so set the level of the simplification pass to the
   // minimum of the two values. Same below.
   top->Add<SimplificationPass>(std::min(int64_t{2}, opt_level));
-  top->Add<UnrollPass>();
-  top->Add<MapInliningPass>();
+  // Inline and simplify each unrolled iteration as it is produced so large
+  // loops and maps do not expand to their full unsimplified size.
+  top->Add<UnrollPass>(/*simplify_incrementally=*/true);
+  top->Add<MapInliningPass>(/*simplify_incrementally=*/true);
   top->Add<InliningPass>();
   top->Add<DeadFunctionEliminationPass>();
 
@@ -196,8 +198,10 @@ absl::StatusOr<bool> RunOptimizationPassPipeline(Package* package,
                                                  int64_t opt_level) {
   std::unique_ptr<OptimizationCompoundPass> pipeline =
       CreateOptimizationPassPipeline();
+  OptimizationPassOptions options;
+  options.function_pass_history = std::make_shared<FunctionPassHistory>();
   PassResults results;
-  return pipeline->Run(package, OptimizationPassOptions(), &results);
+  return pipeline->Run(package, options, &results);
 }
 
 }  // namespace xls
@@ -14,6 +14,7 @@
 
 #include "xls/passes/optimization_pass.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -27,6 +28,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/time.h"
 #include "xls/common/casts.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/matchers.h"
@@ -36,9 +38,11 @@
 #include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/ir/ram_rewrite.pb.h"
 #include "xls/ir/type.h"
+#include "xls/passes/compile_time_budget.h"
 
 namespace xls {
 namespace {
@@ -632,5 +636,186 @@ TEST(RamDatastructuresTest, RamRewritesProtoTest) {
   EXPECT_EQ(RamRewritesFromProto(proto)->at(0).to_name_prefix, "ram");
 }
 
+// Function-local pass which wraps the return value of each function in one
+// `not` per parameter.
+class WrapReturnValuePass : public OptimizationFunctionBasePass {
+ public:
+  WrapReturnValuePass()
+      : OptimizationFunctionBasePass("wrap", "Wrap return value") {}
+
+  bool IsFunctionLocal() const override { return true; }
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      PassResults* results) const override {
+    Function* function = f->AsFunctionOrDie();
+    for (int64_t i = 0; i < function->params().size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          Node * wrapped,
+          function->MakeNode<UnOp>(SourceInfo(), function->return_value(),
+                                   Op::kNot));
+      XLS_RETURN_IF_ERROR(function->set_return_value(wrapped));
+    }
+    return !function->params().empty();
+  }
+};
+
+TEST(PassesTest, ParallelFunctionBasePassMatchesSequential) {
+  auto make_package = []() -> absl::StatusOr<std::unique_ptr<Package>> {
+    auto p = std::make_unique<Package>("p");
+    for (int64_t i = 0; i < 16; ++i) {
+      FunctionBuilder fb(absl::StrCat("f", i), p.get());
+      BValue x = fb.Param("x", p->GetBitsType(8));
+      for (int64_t j = 0; j < i % 4; ++j) {
+        x = fb.Add(x, fb.Param(absl::StrCat("y", j), p->GetBitsType(8)));
+      }
+      XLS_RETURN_IF_ERROR(fb.BuildWithReturnValue(x).status());
+    }
+    return p;
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> sequential,
+                           make_package());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> parallel, make_package());
+
+  WrapReturnValuePass pass;
+  OptimizationPassOptions options;
+  PassResults results;
+  EXPECT_THAT(pass.Run(sequential.get(), options, &results),
+              IsOkAndHolds(true));
+  options.function_parallelism = 4;
+  EXPECT_THAT(pass.Run(parallel.get(), options, &results),
+              IsOkAndHolds(true));
+
+  // Node ids (and hence names) match those of the sequential run.
+  EXPECT_EQ(parallel->DumpIr(), sequential->DumpIr());
+  EXPECT_EQ(parallel->next_node_id(), sequential->next_node_id());
+}
+
+// Pass which reports changing the IR the first `change_count` times it is run.
+class ChangeNTimesPass : public OptimizationPass {
+ public:
+  ChangeNTimesPass(std::string short_name, int64_t change_count)
+      : OptimizationPass(short_name, short_name), change_count_(change_count) {}
+
+  absl::StatusOr<bool> RunInternal(Package* p,
+                                   const OptimizationPassOptions& options,
+                                   PassResults* results) const override {
+    if (change_count_ == 0) {
+      return false;
+    }
+    --change_count_;
+    return true;
+  }
+
+ private:
+  mutable int64_t change_count_;
+};
+
+TEST(PassesTest, FixedPointStopsOncePassesRanUnchanged) {
+  auto p = std::make_unique<Package>("p");
+  OptimizationFixedPointCompoundPass compound("fixed", "Fixed point");
+  compound.Add<DummyPass>("a", "A");
+  compound.Add<ChangeNTimesPass>("b", 2);
+  compound.Add<DummyPass>("c", "C");
+  PassResults results;
+  EXPECT_THAT(compound.Run(p.get(), OptimizationPassOptions(), &results),
+              IsOkAndHolds(true));
+  std::vector<std::string> invocations;
+  for (const PassInvocation& invocation : results.invocations) {
+    invocations.push_back(invocation.pass_name);
+  }
+  // After the last change by `b`, `c` and `a` run once more, then `b` itself;
+  // rerunning `c` would be a no-op.
+  EXPECT_THAT(invocations,
+              ElementsAre("a", "b", "c", "a", "b", "c", "a", "b"));
+}
+
+// Function-local pass which changes nothing and counts how many functions it
+// is run on.
+class CountingPass : public OptimizationFunctionBasePass {
+ public:
+  CountingPass() : OptimizationFunctionBasePass("count", "Count") {}
+
+  bool IsFunctionLocal() const override { return true; }
+
+  int64_t run_count() const { return run_count_; }
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      PassResults* results) const override {
+    ++run_count_;
+    return false;
+  }
+
+ private:
+  mutable int64_t run_count_ = 0;
+};
+
+TEST(PassesTest, FunctionLocalPassSkipsUnchangedFunctions) {
+  auto p = std::make_unique<Package>("p");
+  std::vector<Function*> functions;
+  for (int64_t i = 0; i < 3; ++i) {
+    FunctionBuilder fb(absl::StrCat("f", i), p.get());
+    BValue x = fb.Param("x", p->GetBitsType(8));
+    XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(x));
+    functions.push_back(f);
+  }
+
+  CountingPass pass;
+  OptimizationPassOptions options;
+  options.function_pass_history = std::make_shared<FunctionPassHistory>();
+  PassResults results;
+  XLS_ASSERT_OK(pass.Run(p.get(), options, &results).status());
+  EXPECT_EQ(pass.run_count(), 3);
+  XLS_ASSERT_OK(pass.Run(p.get(), options, &results).status());
+  EXPECT_EQ(pass.run_count(), 3);
+
+  // The history of one pass instance does not apply to another.
+  CountingPass other_pass;
+  XLS_ASSERT_OK(other_pass.Run(p.get(), options, &results).status());
+  EXPECT_EQ(other_pass.run_count(), 3);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * negated,
+      functions[1]->MakeNode<UnOp>(SourceInfo(),
+                                   functions[1]->return_value(), Op::kNeg));
+  XLS_ASSERT_OK(functions[1]->set_return_value(negated));
+  XLS_ASSERT_OK(pass.Run(p.get(), options, &results).status());
+  EXPECT_EQ(pass.run_count(), 4);
+
+  // Without a history every function is visited.
+  options.function_pass_history = nullptr;
+  XLS_ASSERT_OK(pass.Run(p.get(), options, &results).status());
+  EXPECT_EQ(pass.run_count(), 7);
+}
+
+TEST(PassesTest, FixedPointStopsWhenCompileTimeBudgetExhausted) {
+  auto p = std::make_unique<Package>("p");
+  OptimizationCompoundPass top("top", "Top");
+  OptimizationFixedPointCompoundPass* fixed =
+      top.Add<OptimizationFixedPointCompoundPass>("fixed", "Fixed point");
+  fixed->Add<ChangeNTimesPass>("a", 100);
+  top.Add<DummyPass>("b", "B");
+  OptimizationPassOptions options;
+  options.compile_time_budget =
+      std::make_shared<CompileTimeBudget>(absl::ZeroDuration());
+  PassResults results;
+  EXPECT_THAT(top.Run(p.get(), options, &results), IsOkAndHolds(false));
+  // The fixed-point pass stops immediately but passes outside of fixed-point
+  // compound passes still run.
+  std::vector<std::string> invocations;
+  for (const PassInvocation& invocation : results.invocations) {
+    invocations.push_back(invocation.pass_name);
+  }
+  EXPECT_THAT(invocations, ElementsAre("b"));
+  std::vector<CompileTimeBudget::Skip> skips =
+      options.compile_time_budget->skips();
+  ASSERT_EQ(skips.size(), 1);
+  EXPECT_EQ(skips[0].pass_name, "fixed");
+  EXPECT_EQ(skips[0].count, 1);
+}
+
 }  // namespace
 }  // namespace xls
@@ -15,6 +15,7 @@
 #ifndef XLS_PASSES_PASS_BASE_H_
 #define XLS_PASSES_PASS_BASE_H_
 
+#include <cstdint>
 #include <filesystem>
 #include <memory>
 #include <optional>
@@ -31,7 +32,11 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/resource_usage.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/trace.h"
+#include "xls/common/type_traits_helpers.h"
+#include "xls/passes/compile_time_budget.h"
 
 namespace xls {
 
@@ -54,6 +59,16 @@ struct PassOptionsBase {
   // both run_only_passes and skip_passes are present, then only passes which
   // are present in run_only_passes and not present in skip_passes will be run.
   std::vector<std::string> skip_passes;
+
+  // If non-null, the compile-time budget of the pipeline run (copies of the
+  // options share it). Once the budget is exhausted fixed-point compound passes
+  // stop iterating, and expensive passes may skip or scale down their work.
+  std::shared_ptr<CompileTimeBudget> compile_time_budget;
+
+  // Returns whether there is a compile-time budget and it has been spent.
+  bool CompileTimeBudgetExhausted() const {
+    return compile_time_budget != nullptr && compile_time_budget->IsExhausted();
+  }
 };
 
 // An object containing information about the invocation of a pass (single call
@@ -67,6 +82,24 @@ struct PassInvocation {
 
   // The run duration of the pass.
   absl::Duration run_duration;
+
+  // Profiling data, only recorded when PassResults::collect_profile is set.
+  // Node counts are only available if the IR type has a GetNodeCount method.
+  // The peak resident set size is that of the whole process after the pass.
+  int64_t node_count_before = 0;
+  int64_t node_count_after = 0;
+  int64_t peak_rss_bytes = 0;
+};
+
+// An object containing information about a run of a fixed-point compound
+// pass.
+struct FixedPointInvocation {
+  // The name of the compound pass.
+  std::string pass_name;
+
+  // Number of sweeps over the passes until they stopped changing the IR,
+  // counting a partial final sweep as one.
+  int64_t iteration_count;
 };
 
 // A object to which metadata may be written in each pass invocation. This data
@@ -74,6 +107,14 @@ struct PassInvocation {
 struct PassResults {
   // This vector contains and entry for each invocation of each pass.
   std::vector<PassInvocation> invocations;
+
+  // An entry for each run of a fixed-point compound pass, recorded when the
+  // run finishes.
+  std::vector<FixedPointInvocation> fixed_point_invocations;
+
+  // Whether to record node counts and memory use in `invocations` (see
+  // pass_profile.h for aggregating them).
+  bool collect_profile = false;
 };
 
 // Base class for all compiler passes. Template parameters:
@@ -196,6 +237,7 @@ class CompoundPassBase : public PassBase<IrT, OptionsT, ResultsT> {
 
   absl::StatusOr<bool> RunInternal(IrT* ir, const OptionsT& options,
                                    ResultsT* results) const override {
+    ScopedTrace trace(this->short_name(), "pass");
     if (!options.ir_dump_path.empty()) {
       // Start of the top-level pass. Dump IR.
       XLS_RETURN_IF_ERROR(DumpIr(options.ir_dump_path, ir, this->short_name(),
@@ -217,6 +259,42 @@ class CompoundPassBase : public PassBase<IrT, OptionsT, ResultsT> {
   bool IsCompound() const override { return true; }
 
  protected:
+  // Returns the invariant checkers passed in from enclosing compound passes
+  // followed by those contained by this pass itself.
+  std::vector<const InvariantChecker*> MergeInvariantCheckers(
+      absl::Span<const InvariantChecker* const> invariant_checkers) const {
+    std::vector<const InvariantChecker*> checkers(invariant_checkers.begin(),
+                                                  invariant_checkers.end());
+    checkers.insert(checkers.end(), invariant_checker_ptrs_.begin(),
+                    invariant_checker_ptrs_.end());
+    return checkers;
+  }
+
+  // Runs the given invariant checkers, annotating any error with
+  // `str_context`.
+  absl::Status RunInvariantCheckers(
+      IrT* ir, const OptionsT& options, ResultsT* results,
+      absl::Span<const InvariantChecker* const> checkers,
+      std::string_view str_context) const {
+    for (const auto& checker : checkers) {
+      absl::Status status = checker->Run(ir, options, results);
+      if (!status.ok()) {
+        return absl::Status(status.code(), absl::StrCat(status.message(), "; [",
+                                                        str_context, "]"));
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  // Runs `pass`, one of the passes of this compound pass, followed by the
+  // invariant checkers if it changed the IR. Returns std::nullopt if the pass
+  // is excluded by the run_only_passes or skip_passes options, and otherwise
+  // whether the pass changed the IR.
+  absl::StatusOr<std::optional<bool>> RunSubPass(
+      Pass* pass, IrT* ir, const OptionsT& options, ResultsT* results,
+      std::string_view top_level_name,
+      absl::Span<const InvariantChecker* const> checkers) const;
+
   // Dump the IR to a file in the given directory. Name is determined by the
   // various arguments passed in. File names will be lexographically ordered by
   // package name and ordinal.
@@ -246,22 +324,54 @@ class FixedPointCompoundPassBase
                              std::string_view long_name)
       : CompoundPassBase<IrT, OptionsT, ResultsT>(short_name, long_name) {}
 
+  // Runs the passes in order, cyclically, until each has run once since the
+  // last change to the IR without changing it. This is the same sequence of
+  // pass runs as repeating the whole list until a sweep changes nothing,
+  // minus the trailing runs of passes on IR which they have already left
+  // unchanged: passes are deterministic, so those runs would be no-ops.
   absl::StatusOr<bool> RunNested(
       IrT* ir, const OptionsT& options, ResultsT* results,
       std::string_view top_level_name,
       absl::Span<const typename CompoundPassBase<
           IrT, OptionsT, ResultsT>::InvariantChecker* const>
           invariant_checkers) const override {
-    bool local_changed = true;
-    bool global_changed = false;
-    while (local_changed) {
+    XLS_VLOG(1) << "Running " << this->short_name()
+                << " fixed-point compound pass on package " << ir->name();
+    std::vector<const typename CompoundPassBase<IrT, OptionsT,
+                                                ResultsT>::InvariantChecker*>
+        checkers = this->MergeInvariantCheckers(invariant_checkers);
+    XLS_RETURN_IF_ERROR(this->RunInvariantCheckers(
+        ir, options, results, checkers,
+        absl::StrCat("start of compound pass '", this->long_name(), "'")));
+
+    const int64_t pass_count = this->passes_.size();
+    bool changed = false;
+    int64_t unchanged_count = 0;
+    int64_t run_count = 0;
+    for (int64_t i = 0; unchanged_count < pass_count;
+         i = (i + 1) % pass_count, ++run_count) {
+      if (options.CompileTimeBudgetExhausted()) {
+        XLS_VLOG(1) << "Compile-time budget exhausted, stopping "
+                    << this->short_name() << " before reaching a fixed point";
+        options.compile_time_budget->RecordSkip(
+            this->short_name(), "stopped before reaching a fixed point");
+        break;
+      }
       XLS_ASSIGN_OR_RETURN(
-          local_changed,
-          (CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
-              ir, options, results, top_level_name, invariant_checkers)));
-      global_changed = global_changed || local_changed;
+          std::optional<bool> pass_changed,
+          this->RunSubPass(this->passes_[i].get(), ir, options, results,
+                           top_level_name, checkers));
+      if (pass_changed.value_or(false)) {
+        changed = true;
+        unchanged_count = 0;
+      } else {
+        ++unchanged_count;
+      }
     }
-    return global_changed;
+    results->fixed_point_invocations.push_back(
+        {std::string(this->short_name()),
+         pass_count == 0 ? 0 : (run_count + pass_count - 1) / pass_count});
+    return changed;
   }
 };
 
@@ -277,110 +387,127 @@ absl::StatusOr<bool> CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
 
   // Invariant checkers may be passed in from parent compound passes or
   // contained by this pass itself. Merge them together.
-  std::vector<const InvariantChecker*> checkers(invariant_checkers.begin(),
-                                                invariant_checkers.end());
-  checkers.insert(checkers.end(), invariant_checker_ptrs_.begin(),
-                  invariant_checker_ptrs_.end());
-  auto run_invariant_checkers =
-      [&](std::string_view str_context) -> absl::Status {
-    for (const auto& checker : checkers) {
-      absl::Status status = checker->Run(ir, options, results);
-      if (!status.ok()) {
-        return absl::Status(status.code(), absl::StrCat(status.message(), "; [",
-                                                        str_context, "]"));
-      }
-    }
-    return absl::OkStatus();
-  };
-  XLS_RETURN_IF_ERROR(run_invariant_checkers(
+  std::vector<const InvariantChecker*> checkers =
+      MergeInvariantCheckers(invariant_checkers);
+  XLS_RETURN_IF_ERROR(RunInvariantCheckers(
+      ir, options, results, checkers,
       absl::StrCat("start of compound pass '", this->long_name(), "'")));
 
   bool changed = false;
   for (const auto& pass : passes_) {
-    XLS_VLOG(1) << absl::StreamFormat("Running %s (%s) pass on package %s",
-                                      pass->long_name(), pass->short_name(),
-                                      ir->name());
-
-    if (!pass->IsCompound() && options.run_only_passes.has_value() &&
-        std::find_if(options.run_only_passes->begin(),
-                     options.run_only_passes->end(),
-                     [&](const std::string& name) {
-                       return pass->short_name() == name;
-                     }) == options.run_only_passes->end()) {
-      XLS_VLOG(1) << "Skipping pass. Not contained in run_only_passes option.";
-      continue;
-    }
+    XLS_ASSIGN_OR_RETURN(std::optional<bool> pass_changed,
+                         RunSubPass(pass.get(), ir, options, results,
+                                    top_level_name, checkers));
+    changed = changed || pass_changed.value_or(false);
+  }
+  return changed;
+}
 
-    if (std::find_if(options.skip_passes.begin(), options.skip_passes.end(),
-                     [&](const std::string& name) {
-                       return pass->short_name() == name;
-                     }) != options.skip_passes.end()) {
-      XLS_VLOG(1) << "Skipping pass. Contained in skip_passes option.";
-      continue;
-    }
+template <typename IrT, typename OptionsT, typename ResultsT>
+absl::StatusOr<std::optional<bool>>
+CompoundPassBase<IrT, OptionsT, ResultsT>::RunSubPass(
+    Pass* pass, IrT* ir, const OptionsT& options, ResultsT* results,
+    std::string_view top_level_name,
+    absl::Span<const InvariantChecker* const> checkers) const {
+  XLS_VLOG(1) << absl::StreamFormat("Running %s (%s) pass on package %s",
+                                    pass->long_name(), pass->short_name(),
+                                    ir->name());
+
+  if (!pass->IsCompound() && options.run_only_passes.has_value() &&
+      std::find_if(options.run_only_passes->begin(),
+                   options.run_only_passes->end(),
+                   [&](const std::string& name) {
+                     return pass->short_name() == name;
+                   }) == options.run_only_passes->end()) {
+    XLS_VLOG(1) << "Skipping pass. Not contained in run_only_passes option.";
+    return std::nullopt;
+  }
+
+  if (std::find_if(options.skip_passes.begin(), options.skip_passes.end(),
+                   [&](const std::string& name) {
+                     return pass->short_name() == name;
+                   }) != options.skip_passes.end()) {
+    XLS_VLOG(1) << "Skipping pass. Contained in skip_passes option.";
+    return std::nullopt;
+  }
 
 #ifdef DEBUG
-    // Verify that the IR should change iff Run returns true. This is slow, so
-    // do not check it in optimized builds.
-    std::string ir_before = ir->DumpIr();
+  // Verify that the IR should change iff Run returns true. This is slow, so
+  // do not check it in optimized builds.
+  std::string ir_before = ir->DumpIr();
 #endif
-    absl::Time start = absl::Now();
-    bool pass_changed;
+  int64_t node_count_before = 0;
+  if constexpr (has_member_get_node_count_v<IrT>) {
+    if (results->collect_profile) {
+      node_count_before = ir->GetNodeCount();
+    }
+  }
+  absl::Time start = absl::Now();
+  bool pass_changed;
+  {
+    ScopedTrace trace(pass->short_name(), "pass");
     if (pass->IsCompound()) {
       XLS_ASSIGN_OR_RETURN(
           pass_changed,
-          (down_cast<CompoundPassBase<IrT, OptionsT, ResultsT>*>(pass.get())
+          (down_cast<CompoundPassBase<IrT, OptionsT, ResultsT>*>(pass)
                ->RunNested(ir, options, results, top_level_name, checkers)));
     } else {
       XLS_ASSIGN_OR_RETURN(pass_changed, pass->Run(ir, options, results));
     }
-    absl::Duration duration = absl::Now() - start;
+  }
+  absl::Duration duration = absl::Now() - start;
 #ifdef DEBUG
-    std::string ir_after = ir->DumpIr();
-    if (pass_changed) {
-      if (ir_before == ir_after) {
-        return absl::InternalError(absl::StrFormat(
-            "Pass %s indicated IR changed, but IR is unchanged:\n\n%s",
-            pass->short_name(), ir_before));
-      }
-    } else {
-      if (ir_before != ir_after) {
-        return absl::InternalError(
-            absl::StrFormat("Pass %s indicated IR unchanged, but IR is "
-                            "changed:\n\n[Before]\n%s  !=\n[after]\n%s",
-                            pass->short_name(), ir_before, ir_after));
-      }
+  std::string ir_after = ir->DumpIr();
+  if (pass_changed) {
+    if (ir_before == ir_after) {
+      return absl::InternalError(absl::StrFormat(
+          "Pass %s indicated IR changed, but IR is unchanged:\n\n%s",
+          pass->short_name(), ir_before));
     }
-#endif
-    changed = changed || pass_changed;
-    XLS_VLOG(1) << absl::StreamFormat(
-        "[elapsed %s] Pass %s %s.", FormatDuration(duration),
-        pass->short_name(),
-        (pass_changed ? "changed IR" : "did not change IR"));
-    if (!pass->IsCompound()) {
-      results->invocations.push_back(
-          {pass->short_name(), pass_changed, duration});
-    }
-    if (!options.ir_dump_path.empty()) {
-      XLS_RETURN_IF_ERROR(DumpIr(options.ir_dump_path, ir, top_level_name,
-                                 absl::StrCat("after_", pass->short_name()),
-                                 /*ordinal=*/results->invocations.size(),
-                                 /*changed=*/pass_changed));
+  } else {
+    if (ir_before != ir_after) {
+      return absl::InternalError(
+          absl::StrFormat("Pass %s indicated IR unchanged, but IR is "
+                          "changed:\n\n[Before]\n%s  !=\n[after]\n%s",
+                          pass->short_name(), ir_before, ir_after));
     }
-    // Only run the verifiers if the pass changed.
-    if (pass_changed) {
-      absl::Time checker_start = absl::Now();
-      XLS_RETURN_IF_ERROR(run_invariant_checkers(
-          absl::StrFormat("after '%s' pass, dynamic pass #%d",
-                          pass->long_name(), results->invocations.size() - 1)));
-      XLS_VLOG(1) << absl::StreamFormat(
-          "Ran invariant checkers [elapsed %s]",
-          FormatDuration(absl::Now() - checker_start));
+  }
+#endif
+  XLS_VLOG(1) << absl::StreamFormat(
+      "[elapsed %s] Pass %s %s.", FormatDuration(duration),
+      pass->short_name(),
+      (pass_changed ? "changed IR" : "did not change IR"));
+  if (!pass->IsCompound()) {
+    PassInvocation invocation{pass->short_name(), pass_changed, duration};
+    if (results->collect_profile) {
+      invocation.node_count_before = node_count_before;
+      if constexpr (has_member_get_node_count_v<IrT>) {
+        invocation.node_count_after = ir->GetNodeCount();
+      }
+      invocation.peak_rss_bytes = PeakRssBytes();
     }
-    XLS_VLOG(5) << "After " << pass->long_name() << ":";
-    XLS_VLOG_LINES(5, ir->DumpIr());
+    results->invocations.push_back(std::move(invocation));
   }
-  return changed;
+  if (!options.ir_dump_path.empty()) {
+    XLS_RETURN_IF_ERROR(DumpIr(options.ir_dump_path, ir, top_level_name,
+                               absl::StrCat("after_", pass->short_name()),
+                               /*ordinal=*/results->invocations.size(),
+                               /*changed=*/pass_changed));
+  }
+  // Only run the verifiers if the pass changed.
+  if (pass_changed) {
+    absl::Time checker_start = absl::Now();
+    XLS_RETURN_IF_ERROR(RunInvariantCheckers(
+        ir, options, results, checkers,
+        absl::StrFormat("after '%s' pass, dynamic pass #%d",
+                        pass->long_name(), results->invocations.size() - 1)));
+    XLS_VLOG(1) << absl::StreamFormat(
+        "Ran invariant checkers [elapsed %s]",
+        FormatDuration(absl::Now() - checker_start));
+  }
+  XLS_VLOG(5) << "After " << pass->long_name() << ":";
+  XLS_VLOG_LINES(5, ir->DumpIr());
+  return pass_changed;
 }
 
 }  // namespace xls
@@ -0,0 +1,176 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/pass_profile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#include "google/protobuf/util/json_util.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/time.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/passes/compile_time_budget.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/pass_profile.pb.h"
+
+namespace xls {
+namespace {
+
+double ToMs(absl::Duration duration) {
+  return absl::ToDoubleMilliseconds(duration);
+}
+
+double ToMiB(int64_t bytes) { return static_cast<double>(bytes) / (1 << 20); }
+
+}  // namespace
+
+PassProfileProto CreatePassProfile(const PassResults& results,
+                                   const CompileTimeBudget* budget) {
+  PassProfileProto profile;
+  absl::flat_hash_map<std::string, PassProfileEntryProto*> entries;
+  absl::Duration total_duration;
+  int64_t previous_peak_rss = 0;
+  for (const PassInvocation& invocation : results.invocations) {
+    PassProfileEntryProto*& entry = entries[invocation.pass_name];
+    if (entry == nullptr) {
+      entry = profile.add_passes();
+      entry->set_pass_name(invocation.pass_name);
+    }
+    entry->set_invocation_count(entry->invocation_count() + 1);
+    entry->set_changed_count(entry->changed_count() +
+                             (invocation.ir_changed ? 1 : 0));
+    double time_ms = ToMs(invocation.run_duration);
+    entry->set_total_time_ms(entry->total_time_ms() + time_ms);
+    entry->set_max_time_ms(std::max(entry->max_time_ms(), time_ms));
+    entry->set_node_count_delta(entry->node_count_delta() +
+                                invocation.node_count_after -
+                                invocation.node_count_before);
+    entry->set_max_node_count(
+        std::max(entry->max_node_count(), invocation.node_count_after));
+    // The growth during the first invocation is unknown as there is no
+    // measurement before it.
+    if (previous_peak_rss != 0 && invocation.peak_rss_bytes > 0) {
+      entry->set_peak_rss_growth_bytes(
+          entry->peak_rss_growth_bytes() +
+          std::max<int64_t>(0, invocation.peak_rss_bytes - previous_peak_rss));
+    }
+    previous_peak_rss = std::max(previous_peak_rss, invocation.peak_rss_bytes);
+    total_duration += invocation.run_duration;
+  }
+  std::stable_sort(profile.mutable_passes()->begin(),
+                   profile.mutable_passes()->end(),
+                   [](const PassProfileEntryProto& a,
+                      const PassProfileEntryProto& b) {
+                     return a.total_time_ms() > b.total_time_ms();
+                   });
+
+  absl::flat_hash_map<std::string, FixedPointProfileProto*> fixed_points;
+  for (const FixedPointInvocation& invocation :
+       results.fixed_point_invocations) {
+    FixedPointProfileProto*& entry = fixed_points[invocation.pass_name];
+    if (entry == nullptr) {
+      entry = profile.add_fixed_point_passes();
+      entry->set_pass_name(invocation.pass_name);
+    }
+    entry->set_run_count(entry->run_count() + 1);
+    entry->set_total_iterations(entry->total_iterations() +
+                                invocation.iteration_count);
+    entry->set_max_iterations(
+        std::max(entry->max_iterations(), invocation.iteration_count));
+  }
+
+  if (budget != nullptr) {
+    profile.set_compile_time_budget_ms(ToMs(budget->budget()));
+    for (const CompileTimeBudget::Skip& skip : budget->skips()) {
+      BudgetSkipProto* skip_proto = profile.add_budget_skips();
+      skip_proto->set_pass_name(skip.pass_name);
+      skip_proto->set_description(skip.description);
+      skip_proto->set_count(skip.count);
+    }
+  }
+
+  profile.set_total_time_ms(ToMs(total_duration));
+  profile.set_peak_rss_bytes(previous_peak_rss);
+  return profile;
+}
+
+std::string PassProfileToString(const PassProfileProto& profile) {
+  int64_t name_width = 4;
+  for (const PassProfileEntryProto& entry : profile.passes()) {
+    name_width = std::max<int64_t>(name_width, entry.pass_name().size());
+  }
+  for (const FixedPointProfileProto& entry : profile.fixed_point_passes()) {
+    name_width = std::max<int64_t>(name_width, entry.pass_name().size());
+  }
+  for (const BudgetSkipProto& skip : profile.budget_skips()) {
+    name_width = std::max<int64_t>(name_width, skip.pass_name().size());
+  }
+
+  std::string result = absl::StrFormat(
+      "Pass profile (%.3f ms total, %.1f MiB peak RSS):\n",
+      profile.total_time_ms(), ToMiB(profile.peak_rss_bytes()));
+  absl::StrAppendFormat(&result, "%-*s %6s %7s %12s %7s %10s %10s %10s %12s\n",
+                        name_width, "pass", "runs", "changed", "total ms", "%",
+                        "max ms", "node delta", "max nodes", "RSS +MiB");
+  for (const PassProfileEntryProto& entry : profile.passes()) {
+    double percent = profile.total_time_ms() == 0.0
+                         ? 0.0
+                         : 100.0 * entry.total_time_ms() /
+                               profile.total_time_ms();
+    absl::StrAppendFormat(
+        &result, "%-*s %6d %7d %12.3f %6.2f%% %10.3f %+10d %10d %12.1f\n",
+        name_width, entry.pass_name(), entry.invocation_count(),
+        entry.changed_count(), entry.total_time_ms(), percent,
+        entry.max_time_ms(), entry.node_count_delta(), entry.max_node_count(),
+        ToMiB(entry.peak_rss_growth_bytes()));
+  }
+  if (!profile.fixed_point_passes().empty()) {
+    absl::StrAppendFormat(&result, "\nFixed-point passes:\n");
+    absl::StrAppendFormat(&result, "%-*s %6s %10s %10s\n", name_width, "pass",
+                          "runs", "iterations", "max");
+    for (const FixedPointProfileProto& entry : profile.fixed_point_passes()) {
+      absl::StrAppendFormat(&result, "%-*s %6d %10d %10d\n", name_width,
+                            entry.pass_name(), entry.run_count(),
+                            entry.total_iterations(), entry.max_iterations());
+    }
+  }
+  if (profile.has_compile_time_budget_ms()) {
+    absl::StrAppendFormat(&result, "\nCompile-time budget: %.3f ms, %s\n",
+                          profile.compile_time_budget_ms(),
+                          profile.budget_skips().empty() ? "nothing skipped"
+                                                         : "skipped:");
+    for (const BudgetSkipProto& skip : profile.budget_skips()) {
+      absl::StrAppendFormat(&result, "%-*s %6d  %s\n", name_width,
+                            skip.pass_name(), skip.count(), skip.description());
+    }
+  }
+  return result;
+}
+
+absl::StatusOr<std::string> PassProfileToJson(const PassProfileProto& profile) {
+  std::string json;
+  google::protobuf::util::JsonPrintOptions print_options;
+  print_options.add_whitespace = true;
+  print_options.preserve_proto_field_names = true;
+  auto json_status = google::protobuf::util::MessageToJsonString(
+      profile, &json, print_options);
+  XLS_RET_CHECK(json_status.ok()) << json_status.ToString();
+  return json;
+}
+
+}  // namespace xls
@@ -0,0 +1,43 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_PASS_PROFILE_H_
+#define XLS_PASSES_PASS_PROFILE_H_
+
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "xls/passes/compile_time_budget.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/pass_profile.pb.h"
+
+namespace xls {
+
+// Aggregates the pass invocations recorded in `results` into per-pass
+// statistics sorted by decreasing total run time. Node counts and memory use
+// are only meaningful if the results were collected with
+// PassResults::collect_profile set. If `budget` is non-null the work skipped
+// because of it is included.
+PassProfileProto CreatePassProfile(const PassResults& results,
+                                   const CompileTimeBudget* budget = nullptr);
+
+// Returns a human-readable report of the profile.
+std::string PassProfileToString(const PassProfileProto& profile);
+
+// Returns the profile serialized as JSON.
+absl::StatusOr<std::string> PassProfileToJson(const PassProfileProto& profile);
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_PASS_PROFILE_H_
@@ -0,0 +1,123 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/pass_profile.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "xls/common/status/matchers.h"
+#include "xls/passes/compile_time_budget.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/pass_profile.pb.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using testing::HasSubstr;
+
+PassInvocation Invocation(std::string pass_name, bool ir_changed,
+                          int64_t ms, int64_t nodes_before,
+                          int64_t nodes_after, int64_t peak_rss) {
+  PassInvocation invocation;
+  invocation.pass_name = std::move(pass_name);
+  invocation.ir_changed = ir_changed;
+  invocation.run_duration = absl::Milliseconds(ms);
+  invocation.node_count_before = nodes_before;
+  invocation.node_count_after = nodes_after;
+  invocation.peak_rss_bytes = peak_rss;
+  return invocation;
+}
+
+TEST(PassProfileTest, AggregatesInvocations) {
+  PassResults results;
+  results.invocations.push_back(Invocation("dce", true, 2, 100, 90, 1000));
+  results.invocations.push_back(Invocation("inline", true, 10, 90, 150, 5000));
+  results.invocations.push_back(Invocation("dce", false, 1, 150, 150, 5000));
+  results.invocations.push_back(Invocation("dce", true, 4, 150, 120, 6000));
+  results.fixed_point_invocations.push_back({"fixedpoint", 3});
+  results.fixed_point_invocations.push_back({"fixedpoint", 1});
+
+  PassProfileProto profile = CreatePassProfile(results);
+  EXPECT_DOUBLE_EQ(profile.total_time_ms(), 17.0);
+  EXPECT_EQ(profile.peak_rss_bytes(), 6000);
+  ASSERT_EQ(profile.passes_size(), 2);
+
+  // Sorted by decreasing total time.
+  const PassProfileEntryProto& inline_entry = profile.passes(0);
+  EXPECT_EQ(inline_entry.pass_name(), "inline");
+  EXPECT_EQ(inline_entry.invocation_count(), 1);
+  EXPECT_EQ(inline_entry.node_count_delta(), 60);
+  EXPECT_EQ(inline_entry.peak_rss_growth_bytes(), 4000);
+
+  const PassProfileEntryProto& dce_entry = profile.passes(1);
+  EXPECT_EQ(dce_entry.pass_name(), "dce");
+  EXPECT_EQ(dce_entry.invocation_count(), 3);
+  EXPECT_EQ(dce_entry.changed_count(), 2);
+  EXPECT_DOUBLE_EQ(dce_entry.total_time_ms(), 7.0);
+  EXPECT_DOUBLE_EQ(dce_entry.max_time_ms(), 4.0);
+  EXPECT_EQ(dce_entry.node_count_delta(), -40);
+  EXPECT_EQ(dce_entry.max_node_count(), 150);
+  // The growth during the first invocation is not attributed to any pass.
+  EXPECT_EQ(dce_entry.peak_rss_growth_bytes(), 1000);
+
+  ASSERT_EQ(profile.fixed_point_passes_size(), 1);
+  EXPECT_EQ(profile.fixed_point_passes(0).run_count(), 2);
+  EXPECT_EQ(profile.fixed_point_passes(0).total_iterations(), 4);
+  EXPECT_EQ(profile.fixed_point_passes(0).max_iterations(), 3);
+}
+
+TEST(PassProfileTest, Reports) {
+  PassResults results;
+  results.invocations.push_back(Invocation("dce", true, 2, 100, 90, 1000));
+  results.fixed_point_invocations.push_back({"fixedpoint", 2});
+  PassProfileProto profile = CreatePassProfile(results);
+
+  std::string report = PassProfileToString(profile);
+  EXPECT_THAT(report, HasSubstr("Pass profile"));
+  EXPECT_THAT(report, HasSubstr("dce"));
+  EXPECT_THAT(report, HasSubstr("Fixed-point passes"));
+  EXPECT_THAT(report, HasSubstr("fixedpoint"));
+
+  EXPECT_THAT(PassProfileToJson(profile),
+              IsOkAndHolds(HasSubstr("\"pass_name\": \"dce\"")));
+}
+
+TEST(PassProfileTest, Empty) {
+  PassProfileProto profile = CreatePassProfile(PassResults());
+  EXPECT_EQ(profile.passes_size(), 0);
+  EXPECT_THAT(PassProfileToString(profile), HasSubstr("Pass profile"));
+}
+
+TEST(PassProfileTest, BudgetSkips) {
+  CompileTimeBudget budget(absl::Milliseconds(250));
+  budget.RecordSkip("bdd_simp", "skipped BDD simplification");
+  PassProfileProto profile = CreatePassProfile(PassResults(), &budget);
+  EXPECT_EQ(profile.compile_time_budget_ms(), 250.0);
+  ASSERT_EQ(profile.budget_skips_size(), 1);
+  EXPECT_EQ(profile.budget_skips(0).pass_name(), "bdd_simp");
+  EXPECT_EQ(profile.budget_skips(0).count(), 1);
+  EXPECT_THAT(PassProfileToString(profile),
+              HasSubstr("Compile-time budget: 250.000 ms, skipped:"));
+  EXPECT_THAT(PassProfileToString(profile),
+              HasSubstr("skipped BDD simplification"));
+}
+
+}  // namespace
+}  // namespace xls
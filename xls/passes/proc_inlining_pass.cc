@@ -60,6 +60,10 @@
 namespace xls {
 namespace {
 
+// BDD path limit used to analyze the inlined procs once the compile-time budget
+// is exhausted.
+constexpr int64_t kReducedBddPathLimit = BddFunction::kDefaultPathLimit / 16;
+
 // Makes and returns a node computing Not(node).
 absl::StatusOr<Node*> Not(
     Node* node, std::optional<std::string_view> name = std::nullopt) {
@@ -1609,10 +1613,14 @@ absl::StatusOr<Node*> ProcThread::ConvertToActivatedReceive(
 // Inlines the given proc into `container_proc` as a proc thread. Sends and
 // receives in `proc` are replaced with virtual sends/receives which execute via
 // the activation chain. Newly created virtual send/receieves are inserted into
-// the `virtual_send` and `virtual_receive` maps.
+// the `virtual_send` and `virtual_receive` maps. The next token of the inlined
+// proc is appended to `next_tokens`; the caller joins these into the next token
+// of `container_proc` once all procs are inlined (joining them one proc at a
+// time would rebuild an ever-growing after_all per proc).
 absl::StatusOr<ProcThread> InlineProcAsProcThread(
     Proc* proc_to_inline, Proc* container_proc,
-    absl::flat_hash_map<Channel*, VirtualChannel>& virtual_channels) {
+    absl::flat_hash_map<Channel*, VirtualChannel>& virtual_channels,
+    std::vector<Node*>& next_tokens) {
   auto topo_sort = TopoSort(proc_to_inline);
   XLS_ASSIGN_OR_RETURN(ProcThread proc_thread,
                        ProcThread::Create(proc_to_inline, container_proc));
@@ -1678,10 +1686,7 @@ absl::StatusOr<ProcThread> InlineProcAsProcThread(
   }
   XLS_RETURN_IF_ERROR(proc_thread.SetNextState(next_state));
 
-  // Wire in the next-token value from the inlined proc into the next-token of
-  // the container proc.
-  XLS_RETURN_IF_ERROR(container_proc->JoinNextTokenWith(
-      {node_map.at(proc_to_inline->NextToken())}));
+  next_tokens.push_back(node_map.at(proc_to_inline->NextToken()));
   return std::move(proc_thread);
 }
 
@@ -1776,16 +1781,28 @@ absl::StatusOr<bool> ProcInliningPass::RunInternal(
   // virtual send/receives.
   // TODO(meheff): 2022/02/11 Add analysis which determines whether inlining is
   // a legal transformation.
+  std::vector<Node*> next_tokens;
   for (Proc* proc : procs_to_inline) {
-    XLS_ASSIGN_OR_RETURN(
-        ProcThread proc_thread,
-        InlineProcAsProcThread(proc, container_proc, virtual_channels));
+    XLS_ASSIGN_OR_RETURN(ProcThread proc_thread,
+                         InlineProcAsProcThread(proc, container_proc,
+                                                virtual_channels, next_tokens));
     proc_threads.push_back(std::move(proc_thread));
   }
+  // Wire in the next-token values from the inlined procs into the next-token of
+  // the container proc.
+  XLS_RETURN_IF_ERROR(container_proc->JoinNextTokenWith(next_tokens));
 
   XLS_VLOG(3) << "After inlining procs:\n" << p->DumpIr();
 
-  BddQueryEngine query_engine(BddFunction::kDefaultPathLimit, IsCheapForBdds);
+  // The BDD only serves to avoid saving received data unnecessarily, so a less
+  // precise one is fine once the compile-time budget is spent.
+  int64_t path_limit = BddFunction::kDefaultPathLimit;
+  if (options.CompileTimeBudgetExhausted()) {
+    options.compile_time_budget->RecordSkip(short_name(),
+                                            "used a reduced BDD path limit");
+    path_limit = kReducedBddPathLimit;
+  }
+  BddQueryEngine query_engine(path_limit, IsCheapForBdds);
   XLS_RETURN_IF_ERROR(query_engine.Populate(container_proc).status());
 
   for (ProcThread& proc_thread : proc_threads) {
@@ -1821,6 +1838,9 @@ absl::StatusOr<bool> ProcInliningPass::RunInternal(
   XLS_RETURN_IF_ERROR(p->SetTop(container_proc));
   std::string top_proc_name = top_func_base->AsProcOrDie()->name();
   for (Proc* proc : procs_to_inline) {
+    if (options.query_engine_cache != nullptr) {
+      options.query_engine_cache->Invalidate(proc);
+    }
     XLS_RETURN_IF_ERROR(p->RemoveProc(proc));
   }
   container_proc->SetName(top_proc_name);
@@ -1841,13 +1861,15 @@ absl::StatusOr<bool> ProcInliningPass::RunInternal(
     XLS_RETURN_IF_ERROR(container_proc->RemoveNode(node));
   }
 
-  // Delete channels used for communicating with the inlined procs.
-  std::vector<Channel*> channels(p->channels().begin(), p->channels().end());
-  for (Channel* ch : channels) {
+  // Delete channels used for communicating with the inlined procs. They are
+  // removed together as removing a channel scans every node of the package.
+  std::vector<Channel*> internal_channels;
+  for (Channel* ch : p->channels()) {
     if (ch->supported_ops() == ChannelOps::kSendReceive) {
-      XLS_RETURN_IF_ERROR(p->RemoveChannel(ch));
+      internal_channels.push_back(ch);
     }
   }
+  XLS_RETURN_IF_ERROR(p->RemoveChannels(internal_channels));
 
   XLS_VLOG(3) << "After deleting inlined procs:\n" << p->DumpIr();
 
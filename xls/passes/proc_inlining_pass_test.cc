@@ -25,6 +25,7 @@
 #include <utility>
 #include <vector>
 
+#include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
@@ -48,6 +49,7 @@
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/package.h"
 #include "xls/ir/source_location.h"
+#include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_helpers.h"
 #include "xls/passes/dce_pass.h"
@@ -4022,5 +4024,70 @@ proc output_passthrough(tkn: token, state:bits[1], init={0}) {
                     .status());
 }
 
+// Builds a package containing a pipeline of `stage_count` procs connected by
+// internal streaming channels. The first stage (the top) receives from the
+// external channel `in` and the last stage sends on the external channel `out`.
+absl::StatusOr<std::unique_ptr<Package>> MakePipelinePackage(
+    int64_t stage_count) {
+  auto p = std::make_unique<Package>("pipeline");
+  Type* u32 = p->GetBitsType(32);
+  XLS_ASSIGN_OR_RETURN(
+      Channel * in,
+      p->CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+  Channel* prev = in;
+  Proc* top = nullptr;
+  for (int64_t i = 0; i < stage_count; ++i) {
+    Channel* out;
+    if (i == stage_count - 1) {
+      XLS_ASSIGN_OR_RETURN(
+          out, p->CreateStreamingChannel("out", ChannelOps::kSendOnly, u32));
+    } else {
+      XLS_ASSIGN_OR_RETURN(
+          out, p->CreateStreamingChannel(absl::StrFormat("ch%d", i),
+                                         ChannelOps::kSendReceive, u32));
+    }
+    ProcBuilder b(absl::StrFormat("stage%d", i), "tkn", p.get());
+    BValue count = b.StateElement("count", Value(UBits(0, 32)));
+    BValue rcv = b.Receive(prev, b.GetTokenParam());
+    BValue send =
+        b.Send(out, b.TupleIndex(rcv, 0), b.Add(b.TupleIndex(rcv, 1), count));
+    XLS_ASSIGN_OR_RETURN(
+        Proc * proc, b.Build(send, {b.Add(count, b.Literal(UBits(1, 32)))}));
+    if (top == nullptr) {
+      top = proc;
+    }
+    prev = out;
+  }
+  XLS_RETURN_IF_ERROR(p->SetTop(top));
+  return p;
+}
+
+TEST_F(ProcInliningPassTest, LongPipeline) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           MakePipelinePackage(/*stage_count=*/32));
+  EXPECT_EQ(p->procs().size(), 32);
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(true));
+  EXPECT_EQ(p->procs().size(), 1);
+  EXPECT_EQ(p->channels().size(), 2);
+}
+
+// Inlines pipelines of increasing length to check that the pass scales
+// near-linearly with the size of the proc network.
+void BM_InlinePipeline(benchmark::State& state) {
+  OptimizationPassOptions options;
+  options.inline_procs = true;
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::unique_ptr<Package> p =
+        MakePipelinePackage(/*stage_count=*/state.range(0)).value();
+    state.ResumeTiming();
+    PassResults results;
+    XLS_CHECK_OK(ProcInliningPass().Run(p.get(), options, &results).status());
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BM_InlinePipeline)->RangeMultiplier(2)->Range(8, 512)->Complexity();
+
 }  // namespace
 }  // namespace xls
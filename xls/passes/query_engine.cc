@@ -20,6 +20,7 @@
 
 #include "xls/common/logging/logging.h"
 #include "xls/ir/bits_ops.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/ternary.h"
 
 namespace xls {
@@ -205,6 +206,34 @@ bool QueryEngine::NodesKnownUnsignedEquals(Node* a, Node* b) const {
                            ternary_ops::ToKnownBitsValues(b_ternary)));
 }
 
+std::optional<ChangeLogCursor::Changes> ChangeLogCursor::Advance(
+    FunctionBase* f) {
+  int64_t instance_id = f->graph_version().first;
+  bool same_function = instance_id_ == instance_id;
+  int64_t start = position_;
+  instance_id_ = instance_id;
+  position_ = f->change_log_position();
+  if (!same_function) {
+    return std::nullopt;
+  }
+  Changes changes;
+  std::optional<absl::Span<const FunctionBase::NodeChange>> log =
+      f->ChangesSince(start);
+  if (!log.has_value()) {
+    changes.lost = true;
+    return changes;
+  }
+  for (const FunctionBase::NodeChange& change : *log) {
+    if (change.removed) {
+      changes.modified.erase(change.node);
+      changes.removed.push_back(change.node);
+    } else {
+      changes.modified.insert(change.node);
+    }
+  }
+  return changes;
+}
+
 std::string QueryEngine::ToString(Node* node) const {
   XLS_CHECK(node->GetType()->IsBits());
   XLS_CHECK(IsTracked(node));
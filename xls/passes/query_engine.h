@@ -70,6 +70,38 @@ class TreeBitLocation {
 
 enum class ReachedFixpoint { Unchanged, Changed, Unknown };
 
+// Follows the change log of a FunctionBase (see FunctionBase::ChangesSince) on
+// behalf of a query engine, so that repopulating the engine after a pass has
+// modified a few nodes only needs to reanalyze the forward cone of those nodes.
+class ChangeLogCursor {
+ public:
+  struct Changes {
+    // Whether the change log no longer covered the changes; the engine must
+    // discard its results and repopulate from scratch.
+    bool lost = false;
+
+    // Nodes removed since the previous call. The pointers must not be
+    // dereferenced; a pointer may also appear in `modified` if its memory was
+    // reused for a new node.
+    std::vector<Node*> removed;
+
+    // Nodes added, or whose operands changed, since the previous call and
+    // which are still in the function.
+    absl::flat_hash_set<Node*> modified;
+  };
+
+  // Moves the cursor to the end of the change log of `f` and returns the
+  // changes passed over. Returns std::nullopt if the previous call was for a
+  // different FunctionBase (or there was none), in which case nothing is known
+  // about the changes.
+  std::optional<Changes> Advance(FunctionBase* f);
+
+ private:
+  // FunctionBase::graph_version().first of the function last advanced over.
+  std::optional<int64_t> instance_id_;
+  int64_t position_ = 0;
+};
+
 // An abstract base class providing an interface for answering queries about the
 // values of and relationship between bits in an XLS function. Information
 // provided include statically known bit values and implications between bits in
@@ -0,0 +1,136 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_QUERY_ENGINE_CACHE_H_
+#define XLS_PASSES_QUERY_ENGINE_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function_base.h"
+#include "xls/passes/query_engine.h"
+
+namespace xls {
+
+// Cache of populated query engines, shared by the passes of a pipeline so that
+// analyses of an unchanged function are not recomputed by every pass. Engines
+// are cached per FunctionBase and engine type, and are tagged with the graph
+// version (FunctionBase::graph_version) they were computed at: a lookup after
+// the function has changed repopulates the engine, incrementally if no one
+// else still holds it. Thread safe.
+class QueryEngineCache {
+ public:
+  // Returns a query engine of type EngineT (which must be default
+  // constructible) populated for the current state of `f`. The engine is
+  // immutable and remains usable after `f` changes, though its results then
+  // describe the function as it was.
+  template <typename EngineT>
+  absl::StatusOr<std::shared_ptr<const EngineT>> Get(FunctionBase* f) {
+    static_assert(std::is_base_of_v<QueryEngine, EngineT>);
+    const std::type_index type = typeid(EngineT);
+    std::shared_ptr<EngineT> engine;
+    {
+      absl::MutexLock lock(&mutex_);
+      auto f_it = entries_.find(f);
+      if (f_it != entries_.end()) {
+        auto it = f_it->second.find(type);
+        if (it != f_it->second.end()) {
+          if (it->second.graph_version == f->graph_version()) {
+            ++hit_count_;
+            return std::static_pointer_cast<const EngineT>(it->second.engine);
+          }
+          // A stale engine no one else holds can be brought up to date in
+          // place, which only reanalyzes the changed part of the function.
+          if (it->second.engine.use_count() == 1) {
+            engine = std::static_pointer_cast<EngineT>(
+                std::move(it->second.engine));
+          }
+          f_it->second.erase(it);
+        }
+      }
+    }
+    // Populate outside of the lock; other functions may be analyzed
+    // concurrently.
+    if (engine == nullptr) {
+      engine = std::make_shared<EngineT>();
+    }
+    XLS_RETURN_IF_ERROR(engine->Populate(f).status());
+    absl::MutexLock lock(&mutex_);
+    ++miss_count_;
+    entries_[f][type] = Entry{f->graph_version(), engine};
+    return std::shared_ptr<const EngineT>(std::move(engine));
+  }
+
+  // Drops all engines cached for `f`.
+  void Invalidate(FunctionBase* f) {
+    absl::MutexLock lock(&mutex_);
+    entries_.erase(f);
+  }
+
+  // Drops all cached engines.
+  void Clear() {
+    absl::MutexLock lock(&mutex_);
+    entries_.clear();
+  }
+
+  // Number of lookups served from the cache and number which populated a new
+  // engine.
+  int64_t hit_count() const {
+    absl::MutexLock lock(&mutex_);
+    return hit_count_;
+  }
+  int64_t miss_count() const {
+    absl::MutexLock lock(&mutex_);
+    return miss_count_;
+  }
+
+ private:
+  struct Entry {
+    std::pair<int64_t, int64_t> graph_version;
+    std::shared_ptr<QueryEngine> engine;
+  };
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<const FunctionBase*,
+                      absl::flat_hash_map<std::type_index, Entry>>
+      entries_ ABSL_GUARDED_BY(mutex_);
+  int64_t hit_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t miss_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+// Returns a query engine of type EngineT populated for `f`, taken from `cache`
+// or freshly populated if `cache` is null.
+template <typename EngineT>
+absl::StatusOr<std::shared_ptr<const EngineT>> GetQueryEngine(
+    QueryEngineCache* cache, FunctionBase* f) {
+  if (cache != nullptr) {
+    return cache->Get<EngineT>(f);
+  }
+  auto engine = std::make_shared<EngineT>();
+  XLS_RETURN_IF_ERROR(engine->Populate(f).status());
+  return std::shared_ptr<const EngineT>(std::move(engine));
+}
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_QUERY_ENGINE_CACHE_H_
@@ -0,0 +1,113 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/query_engine_cache.h"
+
+#include <memory>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/passes/range_query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
+
+namespace xls {
+namespace {
+
+class QueryEngineCacheTest : public IrTestBase {};
+
+TEST_F(QueryEngineCacheTest, ReusesEnginesUntilFunctionChanges) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue masked = fb.And(x, fb.Literal(UBits(0x0f, 8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(masked));
+
+  QueryEngineCache cache;
+  XLS_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const TernaryQueryEngine> ternary,
+                           cache.Get<TernaryQueryEngine>(f));
+  XLS_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const TernaryQueryEngine> again,
+                           cache.Get<TernaryQueryEngine>(f));
+  EXPECT_EQ(ternary, again);
+  EXPECT_EQ(cache.hit_count(), 1);
+  EXPECT_EQ(cache.miss_count(), 1);
+
+  // Engines of different types are cached separately.
+  XLS_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const RangeQueryEngine> range,
+                           cache.Get<RangeQueryEngine>(f));
+  EXPECT_TRUE(range->IsTracked(masked.node()));
+  EXPECT_EQ(cache.miss_count(), 2);
+
+  // Changing the function forces recomputation; the old engine stays usable.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * negated,
+      f->MakeNode<UnOp>(SourceInfo(), masked.node(), Op::kNeg));
+  XLS_ASSERT_OK(f->set_return_value(negated));
+  XLS_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const TernaryQueryEngine> updated,
+                           cache.Get<TernaryQueryEngine>(f));
+  EXPECT_NE(updated, ternary);
+  EXPECT_TRUE(updated->IsTracked(negated));
+  EXPECT_FALSE(ternary->IsTracked(negated));
+  EXPECT_TRUE(ternary->IsTracked(masked.node()));
+
+  cache.Invalidate(f);
+  XLS_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const TernaryQueryEngine> fresh,
+                           cache.Get<TernaryQueryEngine>(f));
+  EXPECT_NE(fresh, updated);
+  EXPECT_EQ(cache.hit_count(), 1);
+}
+
+TEST_F(QueryEngineCacheTest, UpdatesUnsharedEnginesInPlace) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(x));
+
+  QueryEngineCache cache;
+  XLS_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const TernaryQueryEngine> engine,
+                           cache.Get<TernaryQueryEngine>(f));
+  const TernaryQueryEngine* engine_ptr = engine.get();
+  engine.reset();
+
+  XLS_ASSERT_OK_AND_ASSIGN(Node * negated,
+                           f->MakeNode<UnOp>(SourceInfo(), x.node(), Op::kNeg));
+  XLS_ASSERT_OK(f->set_return_value(negated));
+  XLS_ASSERT_OK_AND_ASSIGN(engine, cache.Get<TernaryQueryEngine>(f));
+  EXPECT_EQ(engine.get(), engine_ptr);
+  EXPECT_TRUE(engine->IsTracked(negated));
+  EXPECT_EQ(cache.miss_count(), 2);
+}
+
+TEST_F(QueryEngineCacheTest, NullCachePopulatesFreshEngines) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(x));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const TernaryQueryEngine> a,
+      GetQueryEngine<TernaryQueryEngine>(/*cache=*/nullptr, f));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const TernaryQueryEngine> b,
+      GetQueryEngine<TernaryQueryEngine>(/*cache=*/nullptr, f));
+  EXPECT_NE(a, b);
+  EXPECT_TRUE(a->IsTracked(x.node()));
+}
+
+}  // namespace
+}  // namespace xls
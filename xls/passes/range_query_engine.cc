@@ -27,6 +27,7 @@
 #include "absl/container/inlined_vector.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "xls/common/logging/logging.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/data_structures/leaf_type_tree.h"
@@ -379,12 +380,127 @@ IntervalSet MinimizeIntervals(IntervalSet intervals, int64_t size) {
 }
 
 absl::StatusOr<ReachedFixpoint> RangeQueryEngine::Populate(FunctionBase* f) {
+  std::optional<ChangeLogCursor::Changes> changes =
+      change_log_cursor_.Advance(f);
+  if (lazy_) {
+    if (changes.has_value() && !changes->lost) {
+      InvalidateLazily(*changes);
+    } else {
+      analyzed_.clear();
+      known_bits_.clear();
+      known_bit_values_.clear();
+      interval_sets_.clear();
+    }
+    return ReachedFixpoint::Unknown;
+  }
+  if (changes.has_value()) {
+    if (!changes->lost) {
+      return PopulateIncrementally(f, *changes);
+    }
+    known_bits_.clear();
+    known_bit_values_.clear();
+    interval_sets_.clear();
+  }
   RangeQueryVisitor visitor(this);
   XLS_RETURN_IF_ERROR(f->Accept(&visitor));
   return visitor.GetReachedFixpoint();
 }
 
+absl::StatusOr<ReachedFixpoint> RangeQueryEngine::PopulateIncrementally(
+    FunctionBase* f, const ChangeLogCursor::Changes& changes) {
+  for (Node* node : changes.removed) {
+    ForgetNode(node);
+  }
+  // Revisit the modified nodes in topological order, continuing into the
+  // users of any node whose intervals changed. A revisited node starts from
+  // scratch rather than refining its previous intervals, so the result is the
+  // same as repopulating a fresh engine.
+  RangeQueryVisitor visitor(this);
+  absl::flat_hash_set<Node*> pending = changes.modified;
+  ReachedFixpoint rf = ReachedFixpoint::Unchanged;
+  for (Node* node : TopoSort(f)) {
+    if (pending.empty()) {
+      break;
+    }
+    if (pending.erase(node) == 0) {
+      continue;
+    }
+    std::optional<IntervalSetTree> before;
+    if (auto it = interval_sets_.find(node); it != interval_sets_.end()) {
+      before = std::move(it->second);
+    }
+    ForgetNode(node);
+    XLS_RETURN_IF_ERROR(node->VisitSingleNode(&visitor));
+    auto after = interval_sets_.find(node);
+    if (after == interval_sets_.end() ? !before.has_value()
+                                      : before == after->second) {
+      continue;
+    }
+    rf = ReachedFixpoint::Changed;
+    for (Node* user : node->users()) {
+      pending.insert(user);
+    }
+  }
+  return rf;
+}
+
+void RangeQueryEngine::InvalidateLazily(
+    const ChangeLogCursor::Changes& changes) {
+  for (Node* node : changes.removed) {
+    analyzed_.erase(node);
+    ForgetNode(node);
+  }
+  // Analyzing a node analyzes all of its operands, so the users of a node
+  // which has not been analyzed have not been analyzed either.
+  std::vector<Node*> worklist(changes.modified.begin(),
+                              changes.modified.end());
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    if (analyzed_.erase(node) == 0) {
+      continue;
+    }
+    ForgetNode(node);
+    worklist.insert(worklist.end(), node->users().begin(),
+                    node->users().end());
+  }
+}
+
+void RangeQueryEngine::AnalyzeLazily(Node* node) const {
+  // Memoization does not change the logical state of the engine.
+  RangeQueryVisitor visitor(const_cast<RangeQueryEngine*>(this));
+  // Visit the unanalyzed fanin in post order, iteratively to support deep
+  // graphs. The flag of a stack entry is set once its operands are pushed.
+  std::vector<std::pair<Node*, bool>> stack = {{node, false}};
+  while (!stack.empty()) {
+    auto [current, operands_pushed] = stack.back();
+    stack.pop_back();
+    if (analyzed_.contains(current)) {
+      continue;
+    }
+    if (!operands_pushed) {
+      stack.push_back({current, true});
+      for (Node* operand : current->operands()) {
+        if (!analyzed_.contains(operand)) {
+          stack.push_back({operand, false});
+        }
+      }
+      continue;
+    }
+    // Mark the node first: visiting it queries its own current intervals.
+    analyzed_.insert(current);
+    XLS_CHECK_OK(current->VisitSingleNode(&visitor));
+  }
+}
+
+void RangeQueryEngine::ForgetNode(Node* node) {
+  known_bits_.erase(node);
+  known_bit_values_.erase(node);
+  interval_sets_.erase(node);
+}
+
 IntervalSetTree RangeQueryEngine::GetIntervalSetTree(Node* node) const {
+  EnsureAnalyzed(node);
   if (interval_sets_.contains(node)) {
     return interval_sets_.at(node);
   }
@@ -49,16 +49,26 @@ class RangeQueryEngine : public QueryEngine {
   // Create a `RangeQueryEngine` that contains no data.
   RangeQueryEngine() = default;
 
+  // Create a `RangeQueryEngine` which, if `lazy` is true, analyzes nodes only
+  // when they are queried (see LazyRangeQueryEngine).
+  explicit RangeQueryEngine(bool lazy) : lazy_(lazy) {}
+
   // Populate the data in this `RangeQueryEngine` using the
-  // given `FunctionBase*`;
+  // given `FunctionBase*`. When the engine was last populated for the same
+  // function, only the nodes changed since then (and their users, as far as
+  // the change propagates) are reanalyzed. A lazy engine only drops its
+  // results for the changed nodes and their users, and returns
+  // ReachedFixpoint::Unknown.
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
 
   bool IsTracked(Node* node) const override {
+    EnsureAnalyzed(node);
     return known_bits_.contains(node);
   }
 
   LeafTypeTree<TernaryVector> GetTernary(Node* node) const override {
     XLS_CHECK(node->GetType()->IsBits());
+    EnsureAnalyzed(node);
     TernaryVector tvec = ternary_ops::FromKnownBits(known_bits_.at(node),
                                                     known_bit_values_.at(node));
     LeafTypeTree<TernaryVector> tree(node->GetType());
@@ -131,11 +141,50 @@ class RangeQueryEngine : public QueryEngine {
  private:
   friend class RangeQueryVisitor;
 
+  absl::StatusOr<ReachedFixpoint> PopulateIncrementally(
+      FunctionBase* f, const ChangeLogCursor::Changes& changes);
+
+  // Drops the results of a lazy engine for the changed nodes and, as they
+  // depend on them, for all analyzed users of those nodes.
+  void InvalidateLazily(const ChangeLogCursor::Changes& changes);
+
+  // For a lazy engine, analyzes `node` and any of its transitive operands
+  // which have not been analyzed yet. Does nothing for an eager engine.
+  void EnsureAnalyzed(Node* node) const {
+    if (lazy_ && !analyzed_.contains(node)) {
+      AnalyzeLazily(node);
+    }
+  }
+  void AnalyzeLazily(Node* node) const;
+
+  // Drops all data about `node`.
+  void ForgetNode(Node* node);
+
+  // Position in the change log of the function last populated for.
+  ChangeLogCursor change_log_cursor_;
+
+  bool lazy_ = false;
+
+  // The nodes analyzed by a lazy engine. Lazy analysis memoizes its results in
+  // the maps below from within const queries, so queries of a lazy engine must
+  // not run concurrently.
+  mutable absl::flat_hash_set<Node*> analyzed_;
+
   absl::flat_hash_map<Node*, Bits> known_bits_;
   absl::flat_hash_map<Node*, Bits> known_bit_values_;
   absl::flat_hash_map<Node*, IntervalSetTree> interval_sets_;
 };
 
+// A range query engine which computes the intervals of a node only when the
+// node is first queried, along with those of its transitive operands, and
+// memoizes them. Cheaper than a RangeQueryEngine when a pass only queries a
+// small part of a large function. The results for a node are the same as
+// those of an eager engine populated at the time of the query.
+class LazyRangeQueryEngine : public RangeQueryEngine {
+ public:
+  LazyRangeQueryEngine() : RangeQueryEngine(/*lazy=*/true) {}
+};
+
 // Reduce the size of the given `IntervalSet` to the given size.
 // This is used to prevent the analysis from using too much memory and CPU.
 //
@@ -1351,5 +1351,87 @@ TEST_F(RangeQueryEngineTest, ZeroExtend) {
             BitsLTT(expr.node(), {Interval(UBits(500, 40), UBits(700, 40))}));
 }
 
+TEST_F(RangeQueryEngineTest, IncrementalUpdate) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue sum = fb.Add(fb.Literal(UBits(5, 8)), fb.Literal(UBits(7, 8)));
+  BValue ext = fb.ZeroExtend(sum, 16);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(ext));
+
+  RangeQueryEngine engine;
+  XLS_ASSERT_OK(engine.Populate(f));
+  EXPECT_EQ(engine.GetIntervalSetTree(ext.node()),
+            BitsLTT(ext.node(), {{12, 12}}));
+  EXPECT_THAT(engine.Populate(f),
+              status_testing::IsOkAndHolds(ReachedFixpoint::Unchanged));
+
+  // Replace an operand of the add; the add and its user are reanalyzed from
+  // scratch rather than refined.
+  Node* old_literal = sum.node()->operand(1);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * nine, f->MakeNode<Literal>(SourceInfo(), Value(UBits(9, 8))));
+  XLS_ASSERT_OK(sum.node()->ReplaceOperandNumber(1, nine));
+  XLS_ASSERT_OK(f->RemoveNode(old_literal));
+  EXPECT_THAT(engine.Populate(f),
+              status_testing::IsOkAndHolds(ReachedFixpoint::Changed));
+  EXPECT_EQ(engine.GetIntervalSetTree(sum.node()),
+            BitsLTT(sum.node(), {{14, 14}}));
+  EXPECT_EQ(engine.GetIntervalSetTree(ext.node()),
+            BitsLTT(ext.node(), {{14, 14}}));
+  EXPECT_FALSE(engine.IsTracked(old_literal));
+
+  RangeQueryEngine fresh;
+  XLS_ASSERT_OK(fresh.Populate(f));
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(engine.GetIntervalSetTree(node), fresh.GetIntervalSetTree(node))
+        << node->GetName();
+  }
+}
+
+TEST_F(RangeQueryEngineTest, LazyEvaluation) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue sum = fb.Add(fb.ZeroExtend(x, 16), fb.Literal(UBits(10, 16)));
+  BValue other = fb.Add(fb.Literal(UBits(5, 8)), fb.Literal(UBits(7, 8)));
+  BValue result = fb.Concat({sum, other});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(result));
+
+  LazyRangeQueryEngine lazy;
+  EXPECT_THAT(lazy.Populate(f),
+              status_testing::IsOkAndHolds(ReachedFixpoint::Unknown));
+  EXPECT_EQ(lazy.GetIntervalSetTree(sum.node()),
+            BitsLTT(sum.node(), {{10, 265}}));
+
+  // Nodes are analyzed when queried, including nodes added after Populate.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * neg, f->MakeNode<UnOp>(SourceInfo(), other.node(), Op::kNeg));
+  EXPECT_EQ(lazy.GetIntervalSetTree(neg), BitsLTT(neg, {{244, 244}}));
+
+  RangeQueryEngine eager;
+  XLS_ASSERT_OK(eager.Populate(f));
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(lazy.GetIntervalSetTree(node), eager.GetIntervalSetTree(node))
+        << node->GetName();
+    EXPECT_EQ(lazy.IsTracked(node), eager.IsTracked(node)) << node->GetName();
+  }
+
+  // Changes drop the results of the changed nodes and their users.
+  Node* old_literal = other.node()->operand(1);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * nine, f->MakeNode<Literal>(SourceInfo(), Value(UBits(9, 8))));
+  XLS_ASSERT_OK(other.node()->ReplaceOperandNumber(1, nine));
+  XLS_ASSERT_OK(f->RemoveNode(old_literal));
+  XLS_ASSERT_OK(lazy.Populate(f));
+  EXPECT_EQ(lazy.GetIntervalSetTree(neg), BitsLTT(neg, {{242, 242}}));
+
+  RangeQueryEngine fresh;
+  XLS_ASSERT_OK(fresh.Populate(f));
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(lazy.GetIntervalSetTree(node), fresh.GetIntervalSetTree(node))
+        << node->GetName();
+  }
+}
+
 }  // namespace
 }  // namespace xls
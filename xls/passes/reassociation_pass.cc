@@ -15,6 +15,8 @@
 #include "xls/passes/reassociation_pass.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -23,6 +25,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/math_util.h"
@@ -45,6 +48,29 @@ bool NodeAndOperandsSameType(Node* n) {
                      [n](Node* o) { return o->GetType() == n->GetType(); });
 }
 
+// Returns true if `operand`, an operand of an interior node of an expression
+// tree, can itself be an interior node of the tree. Operands with other users
+// are leaves so that shared subexpressions are neither duplicated nor walked
+// once per tree they appear in, which keeps gathering linear in the size of the
+// function.
+bool CanBeInterior(Node* operand) { return operand->users().size() == 1; }
+
+// Returns true if `node` is dead, i.e. it is not side-effecting, not used
+// implicitly (e.g. as the return value) and only used by dead nodes. Must be
+// called on every node of a reverse topological traversal; `dead_nodes` holds
+// the dead nodes visited so far. Expressions replaced earlier in the pass are
+// dead, and reassociating them would only create nodes for DCE to remove.
+bool IsDead(Node* node, absl::flat_hash_set<Node*>* dead_nodes) {
+  if (OpIsSideEffecting(node->op()) ||
+      node->function_base()->HasImplicitUse(node) ||
+      !std::all_of(node->users().begin(), node->users().end(),
+                   [&](Node* user) { return dead_nodes->contains(user); })) {
+    return false;
+  }
+  dead_nodes->insert(node);
+  return true;
+}
+
 // Walks an expression tree of adds and substracts and gathers the leafs of the
 // expression. Each leaf includes a boolean value indicating whether the leaf id
 // negated (as in the right side of a subtract). For example, if called at the
@@ -63,52 +89,174 @@ bool NodeAndOperandsSameType(Node* n) {
 //   leaves = {{false, a}, {false, b}, {true, c}, {false, d}, {true, e}}
 //
 // The expression is equivalently: a + b + (-c) + d + (-e)
+//
+// The walk is iterative, so arbitrarily deep chains do not exhaust the stack.
 struct AddSubLeaf {
   bool negated;
   Node* node;
 };
-absl::Status GatherAddsAndSubtracts(Node* node, bool negated,
+absl::Status GatherAddsAndSubtracts(Node* root,
                                     std::vector<AddSubLeaf>* leaves,
                                     std::vector<Node*>* interior_nodes) {
-  if ((node->op() != Op::kAdd && node->op() != Op::kSub) ||
-      !NodeAndOperandsSameType(node)) {
-    // 'node' is not an add or subtract or has differently typed operads.
-    leaves->push_back(AddSubLeaf{negated, node});
-    return absl::OkStatus();
-  }
-
-  interior_nodes->push_back(node);
-
-  XLS_RET_CHECK_EQ(node->operand_count(), 2);
-  for (int64_t operand_no = 0; operand_no < 2; ++operand_no) {
-    Node* operand = node->operand(operand_no);
+  auto is_interior = [](Node* node) {
+    return (node->op() == Op::kAdd || node->op() == Op::kSub) &&
+           NodeAndOperandsSameType(node);
+  };
+  // Operands are pushed in reverse so leaves are gathered left to right.
+  std::vector<AddSubLeaf> stack = {AddSubLeaf{false, root}};
+  while (!stack.empty()) {
+    AddSubLeaf item = stack.back();
+    stack.pop_back();
+    if (!is_interior(item.node) ||
+        (item.node != root && !CanBeInterior(item.node))) {
+      leaves->push_back(item);
+      continue;
+    }
+    interior_nodes->push_back(item.node);
+    XLS_RET_CHECK_EQ(item.node->operand_count(), 2);
     // Subtraction negates it's second operand (operand number 1).
-    bool negated_next =
-        (operand_no == 1 && node->op() == Op::kSub) ? !negated : negated;
-    XLS_RETURN_IF_ERROR(GatherAddsAndSubtracts(operand, negated_next, leaves,
-                                                 interior_nodes));
+    stack.push_back(AddSubLeaf{item.node->op() == Op::kSub ? !item.negated
+                                                            : item.negated,
+                               item.node->operand(1)});
+    stack.push_back(AddSubLeaf{item.negated, item.node->operand(0)});
   }
   return absl::OkStatus();
 }
 
-// Returns an expression equal to the sum of the given nodes. The expression is
-// a right-leaning tree of adds. That is, given:
+// Walks an expression tree of operations with the given op and bit
+// width. 'root' is the root of the tree. The leaves of the expression tree are
+// added to 'leaves', and the interior nodes of the tree are added to
+// 'interior_nodes'. Returns the height of the tree.
 //
-//   {a, b, c, d}
+// For example, if called at the root of the following expression:
 //
-// Will return:
+//   a    b   c    d
+//    \  /     \  /
+//   add.2    add.3
+//       \    /
+//       add.1
 //
-//   (a + (b + (c + d)))
+// Upon return the passed in vectors would be:
 //
-// TODO(meheff): 2021-01-27 Use n-ary adds when they are supported.
-absl::StatusOr<Node*> CreateSum(absl::Span<Node* const> nodes) {
-  XLS_RET_CHECK(!nodes.empty());
-  if (nodes.size() == 1) {
-    return nodes.front();
+//   leaves = {a, b, c, d}
+//   interior_nodes = {add.1, add.2, add.3}
+//
+// And the function would return 2, the depth of the tree (not counting the
+// leaves).
+int64_t GatherExpressionLeaves(Op op, Node* root, std::vector<Node*>* leaves,
+                               std::vector<Node*>* interior_nodes) {
+  if (root->op() != op || !NodeAndOperandsSameType(root)) {
+    // 'root' does not match the other nodes of the tree and is thus a leaf.
+    leaves->push_back(root);
+    return 0;
+  }
+  // Nodes to visit along with their depth in the tree. Operands are pushed in
+  // reverse so leaves are gathered left to right.
+  std::vector<std::pair<Node*, int64_t>> stack = {{root, 1}};
+  int64_t max_depth = 0;
+  while (!stack.empty()) {
+    auto [node, depth] = stack.back();
+    stack.pop_back();
+    // An operand is an interior node in the tree of identical operations if it
+    // has a single use, otherwise it is a leaf.
+    // TODO(meheff): 2021-01-27 Consider handling cases with more than one user.
+    if (node != root && (node->op() != op || !NodeAndOperandsSameType(node) ||
+                         !CanBeInterior(node))) {
+      leaves->push_back(node);
+      continue;
+    }
+    interior_nodes->push_back(node);
+    max_depth = std::max(max_depth, depth);
+    for (auto it = node->operands().rbegin(); it != node->operands().rend();
+         ++it) {
+      stack.push_back({*it, depth + 1});
+    }
   }
-  Node* lhs = nodes.front();
-  XLS_ASSIGN_OR_RETURN(Node * rhs, CreateSum(nodes.subspan(1)));
-  return lhs->function_base()->MakeNode<BinOp>(lhs->loc(), lhs, rhs, Op::kAdd);
+  return max_depth;
+}
+
+// Builds the expression of `inputs` combined with `make_node` as a balanced
+// tree, in a single step and without intermediate nodes. Literals in `inputs`
+// are first combined with each other (so the result can be constant folded)
+// and the result placed on the far right of the tree.
+absl::StatusOr<Node*> BuildBalancedTree(
+    absl::Span<Node* const> leaves,
+    const std::function<absl::StatusOr<Node*>(Node*, Node*)>& make_node) {
+  XLS_RET_CHECK(!leaves.empty());
+  std::vector<Node*> literals;
+  std::vector<Node*> inputs;
+  for (Node* leaf : leaves) {
+    if (leaf->Is<Literal>()) {
+      literals.push_back(leaf);
+    } else {
+      inputs.push_back(leaf);
+    }
+  }
+
+  if (literals.size() == 1) {
+    // Only one literal in the expression. Just add it to the other inputs. It
+    // will appear on the far right of the tree.
+    inputs.push_back(literals.front());
+  } else if (literals.size() > 1) {
+    // More than one literal appears in the expression. Compute the result of
+    // the literals separately so it will be folded, then append the result to
+    // the other inputs.
+    XLS_ASSIGN_OR_RETURN(Node * literal_expr,
+                         make_node(literals[0], literals[1]));
+    for (int64_t i = 2; i < literals.size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(literal_expr, make_node(literals[i], literal_expr));
+    }
+    inputs.push_back(literal_expr);
+  }
+
+  // Reassociate the expressions into a balanced tree. First, reduce the
+  // number of inputs to a power of two. Then build a balanced tree.
+  if (!IsPowerOfTwo(inputs.size())) {
+    // Number of operations to apply to the inputs to reduce operand count to
+    // a power of two. These ops will be the ragged top layer of the
+    // expression tree.
+    int64_t op_count = inputs.size() - (1ULL << FloorOfLog2(inputs.size()));
+    std::vector<Node*> next_inputs;
+    for (int64_t i = 0; i < op_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(Node * new_op,
+                           make_node(inputs[2 * i], inputs[2 * i + 1]));
+      next_inputs.push_back(new_op);
+    }
+    for (int64_t i = op_count * 2; i < inputs.size(); ++i) {
+      next_inputs.push_back(inputs[i]);
+    }
+    inputs = std::move(next_inputs);
+  }
+
+  XLS_RET_CHECK(IsPowerOfTwo(inputs.size()));
+  while (inputs.size() != 1) {
+    // Inputs for the next layer in the tree. Will contain half as many
+    // elements as 'inputs'.
+    std::vector<Node*> next_inputs;
+    for (int64_t i = 0; i < inputs.size() / 2; ++i) {
+      XLS_ASSIGN_OR_RETURN(Node * new_op,
+                           make_node(inputs[2 * i], inputs[2 * i + 1]));
+      next_inputs.push_back(new_op);
+    }
+    inputs = std::move(next_inputs);
+  }
+  return inputs[0];
+}
+
+// Returns an expression equal to the sum of the given nodes, built as a
+// balanced tree of adds (see BuildBalancedTree). Nodes created are added to
+// `created_nodes`.
+//
+// TODO(meheff): 2021-01-27 Use n-ary adds when they are supported.
+absl::StatusOr<Node*> CreateSum(absl::Span<Node* const> nodes,
+                                absl::flat_hash_set<Node*>* created_nodes) {
+  return BuildBalancedTree(
+      nodes, [&](Node* lhs, Node* rhs) -> absl::StatusOr<Node*> {
+        XLS_ASSIGN_OR_RETURN(Node * sum, lhs->function_base()->MakeNode<BinOp>(
+                                             lhs->loc(), lhs, rhs, Op::kAdd));
+        created_nodes->insert(sum);
+        return sum;
+      });
 }
 
 // Attempts to simplify expressions containing adds and subtracts using
@@ -121,24 +269,31 @@ absl::StatusOr<Node*> CreateSum(absl::Span<Node* const> nodes) {
 //
 // Might be transformed into:
 //
-//  (a + b + -C0 + -C1 + d) - (c + e)
+//  (a + b + d + (-C0 + -C1)) - (c + e)
 //
-// The advantage of this optimization is that add expressions of maximal size
-// are created enabling beneficial reassociation for delay minimization when
-// Reassociate() is run. Also, literals are grouped together across add and
-// subtract expressions.
-absl::StatusOr<bool> ReassociateSubtracts(FunctionBase* f) {
+// The sums are built directly as balanced trees with their literals grouped,
+// which is the form Reassociate() would give them, so nodes created here are
+// added to `created_nodes` for Reassociate() to leave alone. Also, literals are
+// grouped together across add and subtract expressions.
+absl::StatusOr<bool> ReassociateSubtracts(
+    FunctionBase* f, absl::flat_hash_set<Node*>* created_nodes) {
   XLS_VLOG(4) << "Reassociating subtracts";
   bool changed = false;
   // Keep track of which nodes we've already considered for reassociation so we
   // don't revisit subexpressions multiple times.
   absl::flat_hash_set<Node*> visited_nodes;
+  absl::flat_hash_set<Node*> dead_nodes;
 
   // Traverse the nodes in reverse order because we construct expressions for
   // reassociation starting from the roots.
   for (Node* node : ReverseTopoSort(f)) {
     XLS_VLOG(4) << "Considering node: " << node->GetName();
 
+    if (IsDead(node, &dead_nodes)) {
+      XLS_VLOG(4) << "  Is dead.";
+      continue;
+    }
+
     if (visited_nodes.contains(node)) {
       XLS_VLOG(4) << "  Already visited.";
       continue;
@@ -151,8 +306,7 @@ absl::StatusOr<bool> ReassociateSubtracts(FunctionBase* f) {
 
     std::vector<AddSubLeaf> leaves;
     std::vector<Node*> interior_nodes;
-    XLS_RETURN_IF_ERROR(GatherAddsAndSubtracts(node, /*negated=*/false, &leaves,
-                                               &interior_nodes));
+    XLS_RETURN_IF_ERROR(GatherAddsAndSubtracts(node, &leaves, &interior_nodes));
 
     // Count the number of subtraction operations in the tree, and mark any
     // interior nodes as visited so they are not traverse in later iterations.
@@ -182,7 +336,22 @@ absl::StatusOr<bool> ReassociateSubtracts(FunctionBase* f) {
       continue;
     }
 
-    bool negated_constant = false;
+    int64_t negated_constant_count = 0;
+    for (const AddSubLeaf& leaf : leaves) {
+      if (leaf.negated && leaf.node->Is<Literal>()) {
+        ++negated_constant_count;
+      }
+    }
+
+    if (subtract_count == 1 && negated_constant_count == 0) {
+      // The expression tree had a single subtract and no literal was found that
+      // could be negated. Nothing to do here as we would transform into an
+      // expression with a single subtraction anyway.
+      XLS_VLOG(4) << "Only a single subtract and no negated literals found,"
+                     "continuing.";
+      continue;
+    }
+
     std::vector<Node*> nonnegated_nodes;
     std::vector<Node*> negated_nodes;
     for (const AddSubLeaf& leaf : leaves) {
@@ -196,7 +365,6 @@ absl::StatusOr<bool> ReassociateSubtracts(FunctionBase* f) {
               f->MakeNode<Literal>(leaf.node->loc(),
                                    Value(bits_ops::Negate(value))));
           nonnegated_nodes.push_back(new_literal);
-          negated_constant = true;
         } else {
           // Negated non-literal term.
           negated_nodes.push_back(leaf.node);
@@ -207,29 +375,22 @@ absl::StatusOr<bool> ReassociateSubtracts(FunctionBase* f) {
       }
     }
 
-    if (subtract_count == 1 && !negated_constant) {
-      // The expression tree had a single subtract and no literal was found that
-      // could be negated. Nothing to do here as we would transform into an
-      // expression with a single subtraction anyway.
-      XLS_VLOG(4) << "Only a single subtract and no negated literals found,"
-                     "continuing.";
-      continue;
-    }
-
     Node* replacement;
     if (negated_nodes.empty()) {
       // There are no negated nodes in the expression. This can only occur if
       // some of the originally negated terms were literals that were negated in
       // the above loop.
-      XLS_RET_CHECK(negated_constant);
-      XLS_ASSIGN_OR_RETURN(replacement, CreateSum(nonnegated_nodes));
-      XLS_VLOG(4) << "All nodes non-negated. Replacing with chain of adds.";
+      XLS_RET_CHECK_GT(negated_constant_count, 0);
+      XLS_ASSIGN_OR_RETURN(replacement,
+                           CreateSum(nonnegated_nodes, created_nodes));
+      XLS_VLOG(4) << "All nodes non-negated. Replacing with a sum.";
     } else {
       // Create a subtraction with the LHS being the sum of 'nonnegated_nodes'
       // and the RHS a sum of 'negated_nodes'.
       XLS_RET_CHECK(!nonnegated_nodes.empty());
-      XLS_ASSIGN_OR_RETURN(Node * lhs, CreateSum(nonnegated_nodes));
-      XLS_ASSIGN_OR_RETURN(Node * rhs, CreateSum(negated_nodes));
+      XLS_ASSIGN_OR_RETURN(Node * lhs,
+                           CreateSum(nonnegated_nodes, created_nodes));
+      XLS_ASSIGN_OR_RETURN(Node * rhs, CreateSum(negated_nodes, created_nodes));
       XLS_ASSIGN_OR_RETURN(replacement,
                            f->MakeNode<BinOp>(node->loc(), lhs, rhs, Op::kSub));
       XLS_VLOG(4) << "Expression includes negated and non-negated terms. "
@@ -245,63 +406,22 @@ absl::StatusOr<bool> ReassociateSubtracts(FunctionBase* f) {
   return changed;
 }
 
-// Walks an expression tree of operations with the given op and bit
-// width. 'node' is the node currently being visited.  The leaves of the
-// expression tree are added to 'leaves', and the interior nodes of the tree are
-// added to 'interior_nodes'. Returns the height of the tree.
-//
-// For example, if called at the root of the following expression:
-//
-//   a    b   c    d
-//    \  /     \  /
-//   add.2    add.3
-//       \    /
-//       add.1
-//
-// Upon return the passed in vectors would be:
-//
-//   leaves = {a, b, c, d}
-//   interior_nodes = {add.1, add.2, add.3}
-//
-// And the function would return 2, the depth of the tree (not counting the
-// leaves).
-int64_t GatherExpressionLeaves(Op op, Node* node, std::vector<Node*>* leaves,
-                               std::vector<Node*>* interior_nodes) {
-  if (node->op() != op || !NodeAndOperandsSameType(node)) {
-    // 'node' does not match the other nodes of the tree and is thus a leaf.
-    leaves->push_back(node);
-    return 0;
-  }
-  // 'node' is an interior node in the tree of identical operations. Traverse
-  // into the operands if the operand has a single use, otherwise the operand is
-  // a leaf.
-  interior_nodes->push_back(node);
-  int64_t max_depth = 1;
-  for (Node* operand : node->operands()) {
-    // TODO(meheff): 2021-01-27 Consider handling cases with more than one user.
-    if (operand->users().size() == 1) {
-      max_depth = std::max(
-          max_depth,
-          GatherExpressionLeaves(op, operand, leaves, interior_nodes) + 1);
-    } else {
-      leaves->push_back(operand);
-    }
-  }
-  return max_depth;
-}
-
 // Reassociate associative and commutative operations to minimize delay and
-// maximize opportunity for constant folding.
-absl::StatusOr<bool> Reassociate(FunctionBase* f) {
+// maximize opportunity for constant folding. Nodes in `created_nodes` are
+// already balanced and are not reassociated again.
+absl::StatusOr<bool> Reassociate(
+    FunctionBase* f, const absl::flat_hash_set<Node*>& created_nodes) {
   bool changed = false;
   // Keep track of which nodes we've already considered for reassociation so we
   // don't revisit subexpressions multiple times.
   absl::flat_hash_set<Node*> visited_nodes;
+  absl::flat_hash_set<Node*> dead_nodes;
 
   // Traverse the nodes in reverse order because we construct expressions for
   // reassociation starting from the roots.
   for (Node* node : ReverseTopoSort(f)) {
-    if (visited_nodes.contains(node)) {
+    if (IsDead(node, &dead_nodes) || visited_nodes.contains(node) ||
+        created_nodes.contains(node)) {
       continue;
     }
 
@@ -361,85 +481,29 @@ absl::StatusOr<bool> Reassociate(FunctionBase* f) {
     //              +
     //
     //     Then C_0 + C_1 can be folded.
-
-    // First, separate the leaves of the expression into literals and
-    // non-literals ('inputs').
-    std::vector<Node*> literals;
-    std::vector<Node*> inputs;
-    for (Node* leaf : leaves) {
-      if (leaf->Is<Literal>()) {
-        literals.push_back(leaf);
-      } else {
-        inputs.push_back(leaf);
-      }
-    }
+    int64_t literal_count = std::count_if(
+        leaves.begin(), leaves.end(), [](Node* n) { return n->Is<Literal>(); });
 
     // We only want to transform for one of the two cases above.
     if (interior_nodes.size() <= 1 ||
         (expression_depth == CeilOfLog2(leaves.size()) &&
-         literals.size() <= 1)) {
+         literal_count <= 1)) {
       continue;
     }
 
-    XLS_VLOG(4) << "Reassociated expression rooted at: "
-                << inputs[0]->GetName();
+    XLS_VLOG(4) << "Reassociated expression rooted at: " << node->GetName();
     XLS_VLOG(4) << "  operations to reassociate:  "
                 << absl::StrJoin(interior_nodes, ", ");
     XLS_VLOG(4) << "  leaves:  " << absl::StrJoin(leaves, ", ");
 
-    // Create a clone of 'node' for construcing a reassociated expression.
-    auto new_node = [&](Node* lhs, Node* rhs) -> absl::StatusOr<Node*> {
-      return node->Clone({lhs, rhs});
-    };
-
-    if (literals.size() == 1) {
-      // Only one literal in the expression. Just add it to the other inputs. It
-      // will appear on the far right of the tree.
-      inputs.push_back(literals.front());
-    } else if (literals.size() > 1) {
-      // More than one literal appears in the expression. Compute the result of
-      // the literals separately so it will be folded, then append the result to
-      // the other inputs.
-      XLS_ASSIGN_OR_RETURN(Node * literal_expr,
-                           new_node(literals[0], literals[1]));
-      for (int64_t i = 2; i < literals.size(); ++i) {
-        XLS_ASSIGN_OR_RETURN(literal_expr, new_node(literals[i], literal_expr));
-      }
-      inputs.push_back(literal_expr);
-    }
-
-    // Reassociate the expressions into a balanced tree. First, reduce the
-    // number of inputs to a power of two. Then build a balanced tree.
-    if (!IsPowerOfTwo(inputs.size())) {
-      // Number of operations to apply to the inputs to reduce operand count to
-      // a power of two. These ops will be the ragged top layer of the
-      // expression tree.
-      int64_t op_count = inputs.size() - (1ULL << FloorOfLog2(inputs.size()));
-      std::vector<Node*> next_inputs;
-      for (int64_t i = 0; i < op_count; ++i) {
-        XLS_ASSIGN_OR_RETURN(Node * new_op,
-                             new_node(inputs[2 * i], inputs[2 * i + 1]));
-        next_inputs.push_back(new_op);
-      }
-      for (int64_t i = op_count * 2; i < inputs.size(); ++i) {
-        next_inputs.push_back(inputs[i]);
-      }
-      inputs = std::move(next_inputs);
-    }
-
-    XLS_RET_CHECK(IsPowerOfTwo(inputs.size()));
-    while (inputs.size() != 1) {
-      // Inputs for the next layer in the tree. Will contain half as many
-      // elements as 'inputs'.
-      std::vector<Node*> next_inputs;
-      for (int64_t i = 0; i < inputs.size() / 2; ++i) {
-        XLS_ASSIGN_OR_RETURN(Node * new_op,
-                             new_node(inputs[2 * i], inputs[2 * i + 1]));
-        next_inputs.push_back(new_op);
-      }
-      inputs = std::move(next_inputs);
-    }
-    XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(inputs[0]));
+    // Build the reassociated expression from clones of 'node'.
+    XLS_ASSIGN_OR_RETURN(
+        Node * replacement,
+        BuildBalancedTree(leaves,
+                          [&](Node* lhs, Node* rhs) -> absl::StatusOr<Node*> {
+                            return node->Clone({lhs, rhs});
+                          }));
+    XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(replacement));
     changed = true;
   }
 
@@ -451,8 +515,10 @@ absl::StatusOr<bool> Reassociate(FunctionBase* f) {
 absl::StatusOr<bool> ReassociationPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
-  XLS_ASSIGN_OR_RETURN(bool reassoc_subtracts_changed, ReassociateSubtracts(f));
-  XLS_ASSIGN_OR_RETURN(bool reassoc_changed, Reassociate(f));
+  absl::flat_hash_set<Node*> created_nodes;
+  XLS_ASSIGN_OR_RETURN(bool reassoc_subtracts_changed,
+                       ReassociateSubtracts(f, &created_nodes));
+  XLS_ASSIGN_OR_RETURN(bool reassoc_changed, Reassociate(f, created_nodes));
   return reassoc_subtracts_changed || reassoc_changed;
 }
 
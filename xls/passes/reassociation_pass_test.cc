@@ -14,9 +14,16 @@
 
 #include "xls/passes/reassociation_pass.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "benchmark/benchmark.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
@@ -30,6 +37,30 @@ namespace {
 
 using status_testing::IsOkAndHolds;
 
+// Builds a function which sums `term_count` parameters in a left-leaning chain,
+// subtracting every third term if `with_subtracts` is true.
+absl::StatusOr<Function*> BuildChain(Package* p, int64_t term_count,
+                                     bool with_subtracts) {
+  FunctionBuilder fb("chain", p);
+  Type* u32 = p->GetBitsType(32);
+  BValue sum = fb.Param("p0", u32);
+  for (int64_t i = 1; i < term_count; ++i) {
+    BValue term = fb.Param(absl::StrFormat("p%d", i), u32);
+    sum = (with_subtracts && i % 3 == 0) ? fb.Subtract(sum, term)
+                                         : fb.Add(sum, term);
+  }
+  return fb.Build();
+}
+
+// Returns the depth of the tree of adds and subtracts rooted at `node`.
+int64_t AddSubDepth(Node* node) {
+  if (node->op() != Op::kAdd && node->op() != Op::kSub) {
+    return 0;
+  }
+  return 1 + std::max(AddSubDepth(node->operand(0)),
+                      AddSubDepth(node->operand(1)));
+}
+
 class ReassociationPassTest : public IrTestBase {
  protected:
   ReassociationPassTest() = default;
@@ -137,6 +168,22 @@ TEST_F(ReassociationPassTest, DeepChain) {
   ASSERT_THAT(Run(p.get()), IsOkAndHolds(true));
 }
 
+TEST_F(ReassociationPassTest, VeryDeepChainOfAddsAndSubtracts) {
+  constexpr int64_t kTermCount = 10000;
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           BuildChain(p.get(), kTermCount,
+                                      /*with_subtracts=*/true));
+  int64_t node_count = f->node_count();
+  ASSERT_THAT(Run(p.get()), IsOkAndHolds(true));
+
+  // The chain is rebuilt as the difference of two balanced sums, without
+  // intermediate trees for DCE to remove.
+  EXPECT_THAT(f->return_value(), m::Sub(m::Add(), m::Add()));
+  EXPECT_LE(AddSubDepth(f->return_value()), CeilOfLog2(kTermCount) + 1);
+  EXPECT_EQ(f->node_count() - node_count, kTermCount - 1);
+}
+
 TEST_F(ReassociationPassTest, BalancedTreeOfThreeAdds) {
   // An already balanced tree should not be transformed.
   auto p = CreatePackage();
@@ -277,5 +324,29 @@ TEST_F(ReassociationPassTest, SubOfSub) {
               m::Sub(m::Add(m::Param("x"), m::Param("z")), m::Param("y")));
 }
 
+void BM_ReassociateChain(benchmark::State& state, bool with_subtracts) {
+  for (auto s : state) {
+    state.PauseTiming();
+    Package p("bm_test");
+    XLS_ASSERT_OK(BuildChain(&p, state.range(0), with_subtracts).status());
+    state.ResumeTiming();
+    PassResults results;
+    XLS_ASSERT_OK(
+        ReassociationPass().Run(&p, OptimizationPassOptions(), &results));
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+void BM_ReassociateAddChain(benchmark::State& state) {
+  BM_ReassociateChain(state, /*with_subtracts=*/false);
+}
+
+void BM_ReassociateAddSubChain(benchmark::State& state) {
+  BM_ReassociateChain(state, /*with_subtracts=*/true);
+}
+
+BENCHMARK(BM_ReassociateAddChain)->Range(64, 16384)->Complexity();
+BENCHMARK(BM_ReassociateAddSubChain)->Range(64, 16384)->Complexity();
+
 }  // namespace
 }  // namespace xls
@@ -15,6 +15,7 @@
 #include "xls/passes/sparsify_select_pass.h"
 
 #include <algorithm>
+#include <memory>
 #include <optional>
 #include <vector>
 
@@ -30,6 +31,7 @@
 #include "xls/ir/type.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/range_query_engine.h"
 
 namespace xls {
@@ -156,15 +158,17 @@ static absl::Status SparsifySelect(FunctionBase* f, Select* select,
 absl::StatusOr<bool> SparsifySelectPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
-  RangeQueryEngine engine;
-  XLS_RETURN_IF_ERROR(engine.Populate(f).status());
+  // Only the selectors are queried so analyze them lazily.
+  XLS_ASSIGN_OR_RETURN(std::shared_ptr<const LazyRangeQueryEngine> engine,
+                       GetQueryEngine<LazyRangeQueryEngine>(
+                           options.query_engine_cache.get(), f));
 
   bool changed = false;
   for (Node* node : TopoSort(f)) {
     if (node->Is<Select>()) {
       Select* select = node->As<Select>();
       Node* selector = select->selector();
-      IntervalSetTree selector_ist = engine.GetIntervalSetTree(selector);
+      IntervalSetTree selector_ist = engine->GetIntervalSetTree(selector);
       IntervalSet selector_intervals = selector_ist.Get({});
       if (std::optional<int64_t> size = selector_intervals.Size()) {
         if (size >= select->cases().size()) {
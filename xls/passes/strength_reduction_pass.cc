@@ -15,6 +15,7 @@
 #include "xls/passes/strength_reduction_pass.h"
 
 #include <algorithm>
+#include <memory>
 #include <utility>
 
 #include "absl/status/statusor.h"
@@ -29,6 +30,7 @@
 #include "xls/ir/nodes.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/ternary_query_engine.h"
 
 namespace xls {
@@ -341,10 +343,11 @@ absl::StatusOr<bool> StrengthReduceNode(
 absl::StatusOr<bool> StrengthReductionPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
-  TernaryQueryEngine query_engine;
-  XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
+  XLS_ASSIGN_OR_RETURN(std::shared_ptr<const TernaryQueryEngine> query_engine,
+                       GetQueryEngine<TernaryQueryEngine>(
+                           options.query_engine_cache.get(), f));
   XLS_ASSIGN_OR_RETURN(absl::flat_hash_set<Node*> reducible_adds,
-                       FindReducibleAdds(f, query_engine));
+                       FindReducibleAdds(f, *query_engine));
   // Note: because we introduce new nodes into the graph that were not present
   // for the original QueryEngine analysis, we must be careful to guard our
   // bit value tests with "IsKnown" sorts of calls.
@@ -356,7 +359,7 @@ absl::StatusOr<bool> StrengthReductionPass::RunOnFunctionBaseInternal(
   for (Node* node : TopoSort(f)) {
     XLS_ASSIGN_OR_RETURN(
         bool node_modified,
-        StrengthReduceNode(node, reducible_adds, query_engine, opt_level_));
+        StrengthReduceNode(node, reducible_adds, *query_engine, opt_level_));
     modified |= node_modified;
   }
   return modified;
@@ -16,8 +16,12 @@
 
 #include <algorithm>
 #include <limits>
+#include <optional>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -65,32 +69,48 @@ static Bits TernaryVectorToValueBits(
   return Bits(bits);
 }
 
+// Evaluates the bits-typed `node` over the given ternary values of its
+// operands.
+static absl::StatusOr<TernaryEvaluator::Vector> EvaluateNode(
+    Node* node, absl::Span<const TernaryEvaluator::Vector> operand_values,
+    TernaryEvaluator* evaluator) {
+  auto create_unknown_vector = [](Node* n) {
+    return TernaryEvaluator::Vector(n->BitCountOrDie(), TernaryValue::kUnknown);
+  };
+  if (IsExpensiveToEvaluate(node) ||
+      std::any_of(node->operands().begin(), node->operands().end(),
+                  [](Node* o) { return !o->GetType()->IsBits(); })) {
+    return create_unknown_vector(node);
+  }
+  return AbstractEvaluate(node, operand_values, evaluator,
+                          /*default_handler=*/create_unknown_vector);
+}
+
 absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::Populate(FunctionBase* f) {
+  std::optional<ChangeLogCursor::Changes> changes =
+      change_log_cursor_.Advance(f);
+  if (changes.has_value()) {
+    if (!changes->lost) {
+      return PopulateIncrementally(f, *changes);
+    }
+    known_bits_.clear();
+    bits_values_.clear();
+  }
+
   TernaryEvaluator evaluator;
   absl::flat_hash_map<Node*, TernaryEvaluator::Vector> values;
   for (Node* node : TopoSort(f)) {
     if (!node->GetType()->IsBits()) {
       continue;
     }
-    auto create_unknown_vector = [](Node* n) {
-      return TernaryEvaluator::Vector(n->BitCountOrDie(),
-                                      TernaryValue::kUnknown);
-    };
-    if (IsExpensiveToEvaluate(node) ||
-        std::any_of(node->operands().begin(), node->operands().end(),
-                    [](Node* o) { return !o->GetType()->IsBits(); })) {
-      values[node] = create_unknown_vector(node);
-      continue;
-    }
-
     std::vector<TernaryEvaluator::Vector> operand_values;
     for (Node* operand : node->operands()) {
-      operand_values.push_back(values.at(operand));
+      if (operand->GetType()->IsBits()) {
+        operand_values.push_back(values.at(operand));
+      }
     }
-    XLS_ASSIGN_OR_RETURN(
-        values[node],
-        AbstractEvaluate(node, operand_values, &evaluator,
-                         /*default_handler=*/create_unknown_vector));
+    XLS_ASSIGN_OR_RETURN(values[node],
+                         EvaluateNode(node, operand_values, &evaluator));
   }
 
   ReachedFixpoint rf = ReachedFixpoint::Unchanged;
@@ -113,9 +133,64 @@ absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::Populate(FunctionBase* f) {
       bits_values_[node] = combined_bits_values;
     }
   }
+  UpdateMemoryAccount();
+  return rf;
+}
+
+absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::PopulateIncrementally(
+    FunctionBase* f, const ChangeLogCursor::Changes& changes) {
+  for (Node* node : changes.removed) {
+    known_bits_.erase(node);
+    bits_values_.erase(node);
+  }
+  // Reevaluate the modified nodes in topological order, continuing into the
+  // users of any node whose result changed. Unchanged nodes keep their values
+  // so the result is the same as repopulating a fresh engine.
+  TernaryEvaluator evaluator;
+  absl::flat_hash_set<Node*> pending = changes.modified;
+  ReachedFixpoint rf = ReachedFixpoint::Unchanged;
+  for (Node* node : TopoSort(f)) {
+    if (pending.empty()) {
+      break;
+    }
+    if (pending.erase(node) == 0 || !node->GetType()->IsBits()) {
+      continue;
+    }
+    std::vector<TernaryEvaluator::Vector> operand_values;
+    for (Node* operand : node->operands()) {
+      if (operand->GetType()->IsBits()) {
+        operand_values.push_back(ternary_ops::FromKnownBits(
+            known_bits_.at(operand), bits_values_.at(operand)));
+      }
+    }
+    XLS_ASSIGN_OR_RETURN(TernaryEvaluator::Vector value,
+                         EvaluateNode(node, operand_values, &evaluator));
+    Bits known_bits = TernaryVectorToKnownBits(value);
+    Bits bits_values = TernaryVectorToValueBits(value);
+    auto known_it = known_bits_.find(node);
+    if (known_it != known_bits_.end() && known_it->second == known_bits &&
+        bits_values_.at(node) == bits_values) {
+      continue;
+    }
+    rf = ReachedFixpoint::Changed;
+    known_bits_[node] = std::move(known_bits);
+    bits_values_[node] = std::move(bits_values);
+    for (Node* user : node->users()) {
+      pending.insert(user);
+    }
+  }
+  UpdateMemoryAccount();
   return rf;
 }
 
+void TernaryQueryEngine::UpdateMemoryAccount() {
+  // Bits wider than 64 bits hold their words out of line; those are not
+  // counted.
+  memory_account_.Set(
+      static_cast<int64_t>(known_bits_.capacity() + bits_values_.capacity()) *
+      static_cast<int64_t>(sizeof(Node*) + sizeof(Bits)));
+}
+
 bool TernaryQueryEngine::AtMostOneTrue(
     absl::Span<TreeBitLocation const> bits) const {
   int64_t maybe_one_count = 0;
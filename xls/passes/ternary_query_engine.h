@@ -19,6 +19,7 @@
 #include <utility>
 
 #include "absl/status/statusor.h"
+#include "xls/common/memory_accounting.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function.h"
 #include "xls/ir/nodes.h"
@@ -35,6 +36,9 @@ class TernaryQueryEngine : public QueryEngine {
  public:
   TernaryQueryEngine() = default;
 
+  // Populates the engine for `f`. When the engine was last populated for the
+  // same function, only the nodes changed since then (and their users, as far
+  // as the change propagates) are reanalyzed.
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
 
   bool IsTracked(Node* node) const override {
@@ -77,6 +81,15 @@ class TernaryQueryEngine : public QueryEngine {
   }
 
  private:
+  absl::StatusOr<ReachedFixpoint> PopulateIncrementally(
+      FunctionBase* f, const ChangeLogCursor::Changes& changes);
+
+  // Attributes the capacity of the maps below to MemoryTag::kQueryEngine.
+  void UpdateMemoryAccount();
+
+  // Position in the change log of the function last populated for.
+  ChangeLogCursor change_log_cursor_;
+
   // Holds which bits values are known for nodes in the function. A one in a bit
   // position indications the respective bit value in the respective node is
   // statically known.
@@ -84,6 +97,8 @@ class TernaryQueryEngine : public QueryEngine {
 
   // Holds the values of statically known bits of nodes in the function.
   absl::flat_hash_map<Node*, Bits> bits_values_;
+
+  MemoryAccount memory_account_{MemoryTag::kQueryEngine};
 };
 
 }  // namespace xls
@@ -132,5 +132,39 @@ TEST_F(TernaryQueryEngineTest, Ne) {
   EXPECT_THAT(RunOnBinaryOp("0b011", "0b011", make_ne), IsOkAndHolds("0b0"));
 }
 
+TEST_F(TernaryQueryEngineTest, IncrementalUpdate) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue masked = fb.And(x, fb.Literal(UBits(0x0f, 8)));
+  BValue result = fb.Or(masked, fb.Literal(UBits(0x30, 8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(result));
+
+  TernaryQueryEngine query_engine;
+  XLS_ASSERT_OK(query_engine.Populate(f).status());
+  EXPECT_FALSE(query_engine.IsKnown(TreeBitLocation(result.node(), 2)));
+  EXPECT_THAT(query_engine.Populate(f),
+              IsOkAndHolds(ReachedFixpoint::Unchanged));
+
+  // Narrow the mask. The change propagates through the users of the and.
+  Node* old_mask = masked.node()->operand(1);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * new_mask,
+      f->MakeNode<Literal>(SourceInfo(), Value(UBits(0x03, 8))));
+  XLS_ASSERT_OK(masked.node()->ReplaceOperandNumber(1, new_mask));
+  XLS_ASSERT_OK(f->RemoveNode(old_mask));
+  EXPECT_THAT(query_engine.Populate(f), IsOkAndHolds(ReachedFixpoint::Changed));
+  EXPECT_TRUE(query_engine.IsKnown(TreeBitLocation(result.node(), 2)));
+  EXPECT_FALSE(query_engine.IsOne(TreeBitLocation(result.node(), 2)));
+  EXPECT_FALSE(query_engine.IsTracked(old_mask));
+
+  TernaryQueryEngine fresh;
+  XLS_ASSERT_OK(fresh.Populate(f).status());
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(query_engine.ToString(node), fresh.ToString(node))
+        << node->GetName();
+  }
+}
+
 }  // namespace
 }  // namespace xls
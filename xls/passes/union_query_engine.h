@@ -39,10 +39,19 @@ namespace xls {
 // will be fixed at some point.
 class UnionQueryEngine : public QueryEngine {
  public:
-  explicit UnionQueryEngine(std::vector<std::unique_ptr<QueryEngine>> engines) {
-    engines_ = std::move(engines);
+  explicit UnionQueryEngine(std::vector<std::unique_ptr<QueryEngine>> engines)
+      : owned_engines_(std::move(engines)) {
+    for (const std::unique_ptr<QueryEngine>& engine : owned_engines_) {
+      engines_.push_back(engine.get());
+    }
   }
 
+  // Combines engines owned elsewhere (e.g. by a QueryEngineCache), which must
+  // already be populated and outlive this engine. Populate leaves them
+  // untouched.
+  explicit UnionQueryEngine(std::vector<const QueryEngine*> engines)
+      : engines_(std::move(engines)) {}
+
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
 
   bool IsTracked(Node* node) const override;
@@ -73,7 +82,8 @@ class UnionQueryEngine : public QueryEngine {
  private:
   absl::flat_hash_map<Node*, Bits> known_bits_;
   absl::flat_hash_map<Node*, Bits> known_bit_values_;
-  std::vector<std::unique_ptr<QueryEngine>> engines_;
+  std::vector<std::unique_ptr<QueryEngine>> owned_engines_;
+  std::vector<const QueryEngine*> engines_;
 };
 
 }  // namespace xls
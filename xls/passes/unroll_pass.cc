@@ -14,12 +14,14 @@
 
 #include "xls/passes/unroll_pass.h"
 
+#include <optional>
 #include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/node_iterator.h"
+#include "xls/passes/incremental_inliner.h"
 #include "xls/passes/optimization_pass.h"
 
 namespace xls {
@@ -38,16 +40,20 @@ CountedFor* FindCountedFor(FunctionBase* f) {
 }
 
 // Unrolls the node "loop" by replacing it with a sequence of dependent
-// invocations.
-absl::Status UnrollCountedFor(CountedFor* loop) {
+// invocations. If `inliner` is non-null and can inline the loop body then each
+// invocation is inlined and simplified as soon as it is created.
+absl::Status UnrollCountedFor(CountedFor* loop, IncrementalInliner* inliner) {
   FunctionBase* f = loop->function_base();
   Node* loop_carry = loop->initial_value();
   int64_t ivar_bit_count = loop->body()->params()[0]->BitCountOrDie();
   for (int64_t trip = 0, iv = 0; trip < loop->trip_count();
        ++trip, iv += loop->stride()) {
     XLS_ASSIGN_OR_RETURN(
-        Literal * iv_node,
+        Node * iv_node,
         f->MakeNode<Literal>(loop->loc(), Value(UBits(iv, ivar_bit_count))));
+    if (inliner != nullptr) {
+      XLS_ASSIGN_OR_RETURN(iv_node, inliner->Simplify(iv_node));
+    }
 
     // Construct the args for invocation.
     std::vector<Node*> invoke_args = {iv_node, loop_carry};
@@ -56,9 +62,14 @@ absl::Status UnrollCountedFor(CountedFor* loop) {
     }
 
     XLS_ASSIGN_OR_RETURN(
-        loop_carry,
+        Invoke * invoke,
         f->MakeNode<Invoke>(loop->loc(), absl::MakeSpan(invoke_args),
                             loop->body()));
+    if (inliner != nullptr && inliner->CanInline(invoke)) {
+      XLS_ASSIGN_OR_RETURN(loop_carry, inliner->InlineAndSimplify(invoke));
+    } else {
+      loop_carry = invoke;
+    }
   }
   XLS_RETURN_IF_ERROR(loop->ReplaceUsesWith(loop_carry));
   return f->RemoveNode(loop);
@@ -70,12 +81,17 @@ absl::StatusOr<bool> UnrollPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
   bool changed = false;
+  std::optional<IncrementalInliner> inliner;
+  if (simplify_incrementally_) {
+    inliner.emplace(f);
+  }
   while (true) {
     CountedFor* loop = FindCountedFor(f);
     if (loop == nullptr) {
       break;
     }
-    XLS_RETURN_IF_ERROR(UnrollCountedFor(loop));
+    XLS_RETURN_IF_ERROR(UnrollCountedFor(
+        loop, inliner.has_value() ? &inliner.value() : nullptr));
     changed = true;
   }
   return changed;
@@ -23,13 +23,21 @@ namespace xls {
 
 class UnrollPass : public OptimizationFunctionBasePass {
  public:
-  UnrollPass()
-      : OptimizationFunctionBasePass("loop_unroll", "Unroll counted loops") {}
+  // If `simplify_incrementally` is true then each unrolled iteration is inlined
+  // and locally simplified (constant folding, CSE and DCE) as it is produced
+  // rather than being left as an invoke for the inlining pass. This keeps the
+  // function from growing to the size of the raw expansion of the loop.
+  explicit UnrollPass(bool simplify_incrementally = false)
+      : OptimizationFunctionBasePass("loop_unroll", "Unroll counted loops"),
+        simplify_incrementally_(simplify_incrementally) {}
 
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
       PassResults* results) const override;
+
+ private:
+  bool simplify_incrementally_;
 };
 
 }  // namespace xls
@@ -14,6 +14,8 @@
 
 #include "xls/passes/unroll_pass.h"
 
+#include <cstdint>
+#include <memory>
 #include <string>
 
 #include "gmock/gmock.h"
@@ -60,5 +62,78 @@ fn unrollable() -> bits[32] {
                         m::Literal(0)));
 }
 
+TEST(UnrollPassTest, SimplifiesIncrementally) {
+  const std::string program = R"(
+package some_package
+
+fn body(i: bits[4], accum: bits[32], x: bits[32]) -> bits[32] {
+  umul.3: bits[32] = umul(x, x)
+  zero_ext.4: bits[32] = zero_ext(i, new_bit_count=32)
+  add.5: bits[32] = add(zero_ext.4, umul.3)
+  ret add.6: bits[32] = add(add.5, accum)
+}
+
+fn unrollable(x: bits[32]) -> bits[32] {
+  literal.1: bits[32] = literal(value=0)
+  ret counted_for.2: bits[32] = counted_for(literal.1, trip_count=3, stride=1, body=body, invariant_args=[x])
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(program));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("unrollable"));
+  PassResults results;
+  UnrollPass pass(/*simplify_incrementally=*/true);
+  EXPECT_THAT(pass.RunOnFunctionBase(f, OptimizationPassOptions(), &results),
+              IsOkAndHolds(true));
+  // The zero-extended induction variable is folded to a literal and the
+  // loop-invariant multiply is shared by all iterations.
+  auto sq = m::UMul(m::Param("x"), m::Param("x"));
+  EXPECT_THAT(
+      f->return_value(),
+      m::Add(m::Add(m::Literal(2), sq),
+             m::Add(m::Add(m::Literal(1), sq),
+                    m::Add(m::Add(m::Literal(0), sq), m::Literal(0)))));
+  int64_t umul_count = 0;
+  for (Node* node : f->nodes()) {
+    EXPECT_FALSE(node->Is<Invoke>());
+    if (node->op() == Op::kUMul) {
+      ++umul_count;
+    }
+  }
+  EXPECT_EQ(umul_count, 1);
+}
+
+TEST(UnrollPassTest, SimplifyIncrementallyKeepsInvokesWithCovers) {
+  const std::string program = R"(
+package some_package
+
+fn body(i: bits[4], accum: bits[32], tkn: token) -> bits[32] {
+  literal.3: bits[1] = literal(value=1)
+  cover.4: token = cover(tkn, literal.3, label="my_cover")
+  ret add.5: bits[32] = add(accum, accum)
+}
+
+fn unrollable(tkn: token) -> bits[32] {
+  literal.1: bits[32] = literal(value=1)
+  ret counted_for.2: bits[32] = counted_for(literal.1, trip_count=2, stride=1, body=body, invariant_args=[tkn])
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(program));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("unrollable"));
+  PassResults results;
+  UnrollPass pass(/*simplify_incrementally=*/true);
+  EXPECT_THAT(pass.RunOnFunctionBase(f, OptimizationPassOptions(), &results),
+              IsOkAndHolds(true));
+  // Inlining would duplicate the cover label so the invokes are left for the
+  // inlining pass.
+  EXPECT_THAT(f->return_value(),
+              m::Invoke(m::Literal(1),
+                        m::Invoke(m::Literal(0), m::Literal(1), m::Param()),
+                        m::Param()));
+}
+
 }  // namespace
 }  // namespace xls
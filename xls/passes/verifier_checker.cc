@@ -15,6 +15,7 @@
 #include "xls/passes/verifier_checker.h"
 
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/ir/verifier.h"
 #include "xls/passes/optimization_pass.h"
 
@@ -23,7 +24,8 @@ namespace xls {
 absl::Status VerifierChecker::Run(Package* p,
                                   const OptimizationPassOptions& options,
                                   PassResults* results) const {
-  return VerifyPackage(p);
+  absl::MutexLock lock(&mutex_);
+  return verifier_.Verify(p);
 }
 
 }  // namespace xls
@@ -15,16 +15,25 @@
 #ifndef XLS_PASSES_VERIFIER_CHECKER_H_
 #define XLS_PASSES_VERIFIER_CHECKER_H_
 
+#include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/verifier.h"
 #include "xls/passes/optimization_pass.h"
 
 namespace xls {
 
-// Invariant checker which just runs xls::Verifier.
+// Invariant checker which just runs xls::Verifier. As it runs after every
+// pass, it only re-verifies what changed since its previous run (see
+// IncrementalVerifier).
 class VerifierChecker : public OptimizationInvariantChecker {
  public:
   absl::Status Run(Package* p, const OptimizationPassOptions& options,
                    PassResults* results) const override;
+
+ private:
+  mutable absl::Mutex mutex_;
+  mutable IncrementalVerifier verifier_ ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace xls
@@ -0,0 +1,226 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/windowed_bdd_query_engine.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/ternary.h"
+
+namespace xls {
+namespace {
+
+// Returns true if `node` should be the root of its own window even if it is
+// already in another window. These are the nodes whose simplification relies
+// most on the relationships between bits which a BDD captures.
+bool IsWindowRoot(Node* node) {
+  return node->Is<Select>() || node->Is<OneHotSelect>() ||
+         node->Is<PrioritySelect>() || node->Is<OneHot>() ||
+         OpIsCompare(node->op());
+}
+
+// Returns the distinct nodes of `locations`.
+std::vector<Node*> NodesOf(absl::Span<TreeBitLocation const> locations) {
+  std::vector<Node*> nodes;
+  for (const TreeBitLocation& location : locations) {
+    if (std::find(nodes.begin(), nodes.end(), location.node()) ==
+        nodes.end()) {
+      nodes.push_back(location.node());
+    }
+  }
+  return nodes;
+}
+
+}  // namespace
+
+std::vector<Node*> WindowedBddQueryEngine::GatherWindow(
+    Node* root, const absl::flat_hash_map<Node*, int64_t>& topo_index) const {
+  std::vector<Node*> window;
+  absl::flat_hash_set<Node*> visited = {root};
+  std::deque<Node*> worklist = {root};
+  while (!worklist.empty() &&
+         static_cast<int64_t>(window.size()) < window_size_) {
+    Node* node = worklist.front();
+    worklist.pop_front();
+    window.push_back(node);
+    for (Node* operand : node->operands()) {
+      // Non-bits values are not expressed in the BDD, so they bound the
+      // window like the operands beyond its size limit.
+      if (operand->GetType()->IsBits() && visited.insert(operand).second) {
+        worklist.push_back(operand);
+      }
+    }
+  }
+  std::sort(window.begin(), window.end(), [&](Node* a, Node* b) {
+    return topo_index.at(a) < topo_index.at(b);
+  });
+  return window;
+}
+
+absl::StatusOr<ReachedFixpoint> WindowedBddQueryEngine::Populate(
+    FunctionBase* f) {
+  std::vector<Node*> topo_sort = TopoSort(f).AsVector();
+  absl::flat_hash_map<Node*, int64_t> topo_index;
+  for (int64_t i = 0; i < topo_sort.size(); ++i) {
+    topo_index[topo_sort[i]] = i;
+  }
+
+  // Visit the nodes from the outputs back so that each window covers as much
+  // not-yet-covered logic as possible.
+  std::vector<std::vector<Node*>> window_nodes;
+  absl::flat_hash_set<Node*> covered;
+  for (auto it = topo_sort.rbegin(); it != topo_sort.rend(); ++it) {
+    Node* node = *it;
+    if (!node->GetType()->IsBits() ||
+        (covered.contains(node) && !IsWindowRoot(node))) {
+      continue;
+    }
+    std::vector<Node*> window = GatherWindow(node, topo_index);
+    covered.insert(window.begin(), window.end());
+    window_nodes.push_back(std::move(window));
+  }
+  XLS_VLOG(2) << "Covered " << f->name() << " (" << f->node_count()
+              << " nodes) with " << window_nodes.size() << " BDD windows";
+
+  windows_.clear();
+  for (int64_t i = 0; i < window_nodes.size(); ++i) {
+    windows_.push_back(
+        std::make_unique<BddQueryEngine>(path_limit_, node_filter_));
+  }
+  XLS_RETURN_IF_ERROR(DefaultThreadPool().ParallelForWithStatus(
+      0, window_nodes.size(), [&](int64_t i) -> absl::Status {
+        return windows_[i]->PopulateWindow(f, window_nodes[i]).status();
+      }));
+
+  absl::flat_hash_map<Node*, Bits> known_bits;
+  absl::flat_hash_map<Node*, Bits> bits_values;
+  node_windows_.clear();
+  for (int64_t i = 0; i < window_nodes.size(); ++i) {
+    for (Node* node : window_nodes[i]) {
+      node_windows_[node].push_back(i);
+      TernaryVector ternary = windows_[i]->GetTernary(node).Get({});
+      Bits window_known = ternary_ops::ToKnownBits(ternary);
+      Bits window_values = ternary_ops::ToKnownBitsValues(ternary);
+      auto [known_it, inserted] = known_bits.try_emplace(node, window_known);
+      if (inserted) {
+        bits_values[node] = window_values;
+      } else {
+        known_it->second = bits_ops::Or(known_it->second, window_known);
+        bits_values[node] = bits_ops::Or(bits_values[node], window_values);
+      }
+    }
+  }
+  ReachedFixpoint rf =
+      (known_bits == known_bits_ && bits_values == bits_values_)
+          ? ReachedFixpoint::Unchanged
+          : ReachedFixpoint::Changed;
+  known_bits_ = std::move(known_bits);
+  bits_values_ = std::move(bits_values);
+  return rf;
+}
+
+LeafTypeTree<TernaryVector> WindowedBddQueryEngine::GetTernary(
+    Node* node) const {
+  XLS_CHECK(node->GetType()->IsBits());
+  LeafTypeTree<TernaryVector> result(node->GetType());
+  result.Set({}, ternary_ops::FromKnownBits(known_bits_.at(node),
+                                            bits_values_.at(node)));
+  return result;
+}
+
+const BddQueryEngine* WindowedBddQueryEngine::FindWindow(
+    absl::Span<Node* const> nodes) const {
+  if (nodes.empty()) {
+    return nullptr;
+  }
+  auto it = node_windows_.find(nodes.front());
+  if (it == node_windows_.end()) {
+    return nullptr;
+  }
+  for (int64_t index : it->second) {
+    const BddQueryEngine* window = windows_[index].get();
+    if (std::all_of(nodes.begin() + 1, nodes.end(),
+                    [&](Node* node) { return window->IsTracked(node); })) {
+      return window;
+    }
+  }
+  return nullptr;
+}
+
+bool WindowedBddQueryEngine::AtMostOneTrue(
+    absl::Span<TreeBitLocation const> bits) const {
+  const BddQueryEngine* window = FindWindow(NodesOf(bits));
+  return window != nullptr && window->AtMostOneTrue(bits);
+}
+
+bool WindowedBddQueryEngine::AtLeastOneTrue(
+    absl::Span<TreeBitLocation const> bits) const {
+  const BddQueryEngine* window = FindWindow(NodesOf(bits));
+  return window != nullptr && window->AtLeastOneTrue(bits);
+}
+
+bool WindowedBddQueryEngine::Implies(const TreeBitLocation& a,
+                                     const TreeBitLocation& b) const {
+  const BddQueryEngine* window = FindWindow(NodesOf({a, b}));
+  return window != nullptr && window->Implies(a, b);
+}
+
+std::optional<Bits> WindowedBddQueryEngine::ImpliedNodeValue(
+    absl::Span<const std::pair<TreeBitLocation, bool>> predicate_bit_values,
+    Node* node) const {
+  std::vector<Node*> nodes = {node};
+  for (const auto& [location, value] : predicate_bit_values) {
+    if (std::find(nodes.begin(), nodes.end(), location.node()) ==
+        nodes.end()) {
+      nodes.push_back(location.node());
+    }
+  }
+  const BddQueryEngine* window = FindWindow(nodes);
+  if (window == nullptr) {
+    return std::nullopt;
+  }
+  return window->ImpliedNodeValue(predicate_bit_values, node);
+}
+
+bool WindowedBddQueryEngine::KnownEquals(const TreeBitLocation& a,
+                                         const TreeBitLocation& b) const {
+  const BddQueryEngine* window = FindWindow(NodesOf({a, b}));
+  return window != nullptr && window->KnownEquals(a, b);
+}
+
+bool WindowedBddQueryEngine::KnownNotEquals(const TreeBitLocation& a,
+                                            const TreeBitLocation& b) const {
+  const BddQueryEngine* window = FindWindow(NodesOf({a, b}));
+  return window != nullptr && window->KnownNotEquals(a, b);
+}
+
+}  // namespace xls
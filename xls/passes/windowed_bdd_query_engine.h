@@ -0,0 +1,116 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_WINDOWED_BDD_QUERY_ENGINE_H_
+#define XLS_PASSES_WINDOWED_BDD_QUERY_ENGINE_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/nodes.h"
+#include "xls/passes/bdd_query_engine.h"
+#include "xls/passes/query_engine.h"
+
+namespace xls {
+
+// A query engine which analyzes a function with many small BDDs rather than
+// one BDD over the whole function, for functions too large for a global BDD
+// (whose cost grows with the function even when each expression is small).
+//
+// The function is covered by windows: each window is a bounded cone of at most
+// `window_size` nodes gathered breadth-first through the operands of a root
+// node. Roots are the nodes whose analysis most benefits from a BDD (selects,
+// one-hots and comparisons) plus any node not yet in a window, so every
+// bits-typed node is in at least one window. The operands at the boundary of
+// a window become free variables of its BDD, so the results are sound but
+// weaker than those of a global BDD: facts which depend on logic more than a
+// window away are lost. Windows are independent and are built in parallel on
+// the default thread pool.
+//
+// A bit is known if any window containing its node knows it. Queries relating
+// several nodes are answered by a window containing all of them, and
+// conservatively if there is none.
+class WindowedBddQueryEngine : public QueryEngine {
+ public:
+  static constexpr int64_t kDefaultWindowSize = 64;
+
+  // `path_limit` and `node_filter` are as in BddQueryEngine and apply to each
+  // window.
+  explicit WindowedBddQueryEngine(
+      int64_t window_size = kDefaultWindowSize, int64_t path_limit = 0,
+      std::optional<std::function<bool(const Node*)>> node_filter =
+          std::nullopt)
+      : window_size_(window_size),
+        path_limit_(path_limit),
+        node_filter_(std::move(node_filter)) {}
+
+  absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
+
+  bool IsTracked(Node* node) const override {
+    return known_bits_.contains(node);
+  }
+
+  LeafTypeTree<TernaryVector> GetTernary(Node* node) const override;
+
+  bool AtMostOneTrue(absl::Span<TreeBitLocation const> bits) const override;
+  bool AtLeastOneTrue(absl::Span<TreeBitLocation const> bits) const override;
+  bool Implies(const TreeBitLocation& a,
+               const TreeBitLocation& b) const override;
+  std::optional<Bits> ImpliedNodeValue(
+      absl::Span<const std::pair<TreeBitLocation, bool>> predicate_bit_values,
+      Node* node) const override;
+  bool KnownEquals(const TreeBitLocation& a,
+                   const TreeBitLocation& b) const override;
+  bool KnownNotEquals(const TreeBitLocation& a,
+                      const TreeBitLocation& b) const override;
+
+  // Returns the number of windows built by the last call to Populate.
+  int64_t window_count() const { return windows_.size(); }
+
+ private:
+  // Returns the nodes of the window rooted at `root` in topological order.
+  // `topo_index` maps each node of the function to its topological position.
+  std::vector<Node*> GatherWindow(
+      Node* root, const absl::flat_hash_map<Node*, int64_t>& topo_index) const;
+
+  // Returns a window which contains all of `nodes`, or nullptr if there is
+  // none.
+  const BddQueryEngine* FindWindow(absl::Span<Node* const> nodes) const;
+
+  int64_t window_size_;
+  int64_t path_limit_;
+  std::optional<std::function<bool(const Node*)>> node_filter_;
+
+  std::vector<std::unique_ptr<BddQueryEngine>> windows_;
+
+  // The indices in `windows_` of the windows containing each node.
+  absl::flat_hash_map<Node*, std::vector<int64_t>> node_windows_;
+
+  // The known bits of each node and their values, merged over all windows.
+  absl::flat_hash_map<Node*, Bits> known_bits_;
+  absl::flat_hash_map<Node*, Bits> bits_values_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_WINDOWED_BDD_QUERY_ENGINE_H_
@@ -0,0 +1,138 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/windowed_bdd_query_engine.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/passes/bdd_query_engine.h"
+
+namespace xls {
+namespace {
+
+class WindowedBddQueryEngineTest : public IrTestBase {
+ protected:
+  bool Implies(const QueryEngine& engine, Node* a, Node* b) {
+    return engine.Implies(TreeBitLocation(a, 0), TreeBitLocation(b, 0));
+  }
+  bool KnownEquals(const QueryEngine& engine, Node* a, Node* b) {
+    return engine.KnownEquals(TreeBitLocation(a, 0), TreeBitLocation(b, 0));
+  }
+  bool KnownNotEquals(const QueryEngine& engine, Node* a, Node* b) {
+    return engine.KnownNotEquals(TreeBitLocation(a, 0), TreeBitLocation(b, 0));
+  }
+};
+
+TEST_F(WindowedBddQueryEngineTest, PredicatesWithinAWindow) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue x_eq_0 = fb.Eq(x, fb.Literal(UBits(0, 8)));
+  BValue x_eq_0_2 = fb.Eq(x, fb.Literal(UBits(0, 8)));
+  BValue x_ne_0 = fb.Not(x_eq_0);
+  BValue x_eq_7 = fb.Eq(x, fb.Literal(UBits(7, 8)));
+  BValue y_eq_7 = fb.Eq(y, fb.Literal(UBits(7, 8)));
+  fb.Tuple({x_eq_0_2, x_ne_0, x_eq_7, y_eq_7});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  WindowedBddQueryEngine query_engine;
+  XLS_ASSERT_OK(query_engine.Populate(f).status());
+
+  EXPECT_TRUE(query_engine.AtMostOneNodeTrue({x_eq_0.node(), x_eq_7.node()}));
+  EXPECT_TRUE(query_engine.AtLeastOneNodeTrue({x_eq_0.node(), x_ne_0.node()}));
+  EXPECT_TRUE(KnownNotEquals(query_engine, x_eq_0.node(), x_ne_0.node()));
+  EXPECT_TRUE(Implies(query_engine, x_eq_0.node(), x_eq_0.node()));
+  EXPECT_FALSE(Implies(query_engine, x_eq_0.node(), x_eq_7.node()));
+
+  // Unrelated values 'x' and 'y' should have no relationships.
+  EXPECT_FALSE(Implies(query_engine, x_eq_7.node(), y_eq_7.node()));
+  EXPECT_FALSE(KnownEquals(query_engine, x_eq_7.node(), y_eq_7.node()));
+  EXPECT_FALSE(query_engine.AtMostOneNodeTrue({x_eq_7.node(), y_eq_7.node()}));
+}
+
+TEST_F(WindowedBddQueryEngineTest, EveryBitsNodeIsTracked) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  std::vector<BValue> elements;
+  for (int64_t i = 0; i < 50; ++i) {
+    BValue value = fb.Xor(x, fb.Literal(UBits(i, 8)));
+    elements.push_back(fb.Select(fb.BitSlice(value, 0, 1),
+                                 {value, fb.Not(value)}));
+  }
+  fb.Tuple(elements);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  WindowedBddQueryEngine query_engine(/*window_size=*/4);
+  XLS_ASSERT_OK(query_engine.Populate(f).status());
+
+  EXPECT_GT(query_engine.window_count(), 1);
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(query_engine.IsTracked(node), node->GetType()->IsBits())
+        << node->GetName();
+  }
+}
+
+TEST_F(WindowedBddQueryEngineTest, KnownBitsAreLocal) {
+  // The low nibble of `masked` is known zero, which a window rooted at the end
+  // of a long chain of inversions cannot see.
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue masked = fb.And(x, fb.Literal(UBits(0xf0, 8)));
+  BValue value = masked;
+  for (int64_t i = 0; i < 20; ++i) {
+    value = fb.Not(value);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(value));
+
+  BddQueryEngine global;
+  XLS_ASSERT_OK(global.Populate(f).status());
+  WindowedBddQueryEngine windowed(/*window_size=*/4);
+  XLS_ASSERT_OK(windowed.Populate(f).status());
+
+  EXPECT_EQ(global.ToString(masked.node()), "0bXXXX_0000");
+  EXPECT_EQ(windowed.ToString(masked.node()), "0bXXXX_0000");
+  EXPECT_EQ(global.ToString(value.node()), "0bXXXX_0000");
+  EXPECT_EQ(windowed.ToString(value.node()), "0bXXXX_XXXX");
+
+  // Nothing is lost if the window covers the chain.
+  WindowedBddQueryEngine wide(/*window_size=*/64);
+  XLS_ASSERT_OK(wide.Populate(f).status());
+  EXPECT_EQ(wide.ToString(value.node()), "0bXXXX_0000");
+}
+
+TEST_F(WindowedBddQueryEngineTest, RepopulateReachesFixpoint) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  fb.And(x, fb.Literal(UBits(0x0f, 8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  WindowedBddQueryEngine query_engine;
+  XLS_ASSERT_OK_AND_ASSIGN(ReachedFixpoint first, query_engine.Populate(f));
+  EXPECT_EQ(first, ReachedFixpoint::Changed);
+  XLS_ASSERT_OK_AND_ASSIGN(ReachedFixpoint second, query_engine.Populate(f));
+  EXPECT_EQ(second, ReachedFixpoint::Unchanged);
+}
+
+}  // namespace
+}  // namespace xls
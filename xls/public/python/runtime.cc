@@ -0,0 +1,124 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/public/runtime.h"
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "pybind11/numpy.h"
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+#include "pybind11_abseil/status_caster.h"
+#include "pybind11_abseil/statusor_caster.h"
+#include "xls/common/status/import_status_module.h"
+#include "xls/common/status/status_macros.h"
+
+namespace py = pybind11;
+
+namespace xls {
+namespace {
+
+// Checks that `array` is a contiguous column of `batch_size` elements of
+// `element_size` bytes each, in the native layout: e.g. a uint32 array for
+// bits[32], or a uint8 array of shape (batch_size, element_size) for types
+// without a matching dtype.
+absl::Status CheckColumn(const py::array& array, int64_t element_size,
+                         int64_t batch_size, std::string_view what) {
+  if (!(array.flags() & py::array::c_style)) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Array for %s must be C-contiguous", what));
+  }
+  char kind = array.dtype().kind();
+  if (kind != 'u' && kind != 'i' && kind != 'b') {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Array for %s must have an integer or bool dtype, got '%c'", what,
+        kind));
+  }
+  if (array.ndim() == 0 || array.shape(0) != batch_size ||
+      array.nbytes() != batch_size * element_size) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Array for %s must hold %d elements of %d bytes each, got %d bytes "
+        "in %d rows",
+        what, batch_size, element_size, array.nbytes(),
+        array.ndim() == 0 ? 0 : array.shape(0)));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RunBatch(const CompiledFunction& f,
+                      const std::vector<py::array>& args, py::array result) {
+  if (args.size() != f.arg_count()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Expected %d argument arrays, got %d", f.arg_count(),
+                        args.size()));
+  }
+  int64_t batch_size = result.ndim() == 0 ? 0 : result.shape(0);
+  std::vector<const uint8_t*> arg_columns;
+  arg_columns.reserve(args.size());
+  for (int64_t i = 0; i < args.size(); ++i) {
+    XLS_RETURN_IF_ERROR(CheckColumn(args[i], f.arg_size(i), batch_size,
+                                    absl::StrFormat("argument %d", i)));
+    arg_columns.push_back(static_cast<const uint8_t*>(args[i].data()));
+  }
+  XLS_RETURN_IF_ERROR(
+      CheckColumn(result, f.result_size(), batch_size, "the result"));
+  absl::Span<uint8_t> result_column(
+      static_cast<uint8_t*>(result.mutable_data()), result.nbytes());
+
+  // The arrays stay alive, as the caller holds them, while other Python
+  // threads run.
+  py::gil_scoped_release release;
+  return f.RunBatch(arg_columns, result_column, batch_size);
+}
+
+}  // namespace
+
+PYBIND11_MODULE(runtime, m) {
+  ImportStatusModule();
+
+  py::class_<CompiledFunction>(m, "CompiledFunction")
+      .def_static("create", &CompiledFunction::Create,
+                  R"(JIT-compiles the named function (or the top function if
+the name is empty) of the given IR package text.)",
+                  py::arg("ir_text"), py::arg("function_name") = "",
+                  py::arg("opt_level") = 3)
+      .def("arg_count", &CompiledFunction::arg_count)
+      .def("arg_size", &CompiledFunction::arg_size,
+           "Returns the size in bytes of an argument in the native layout.",
+           py::arg("i"))
+      .def("result_size", &CompiledFunction::result_size,
+           "Returns the size in bytes of the result in the native layout.")
+      .def("run_batch", &RunBatch,
+           R"(Evaluates the function over columns of arguments held in NumPy
+arrays, writing the results into a preallocated array, with the GIL released.
+
+Each array holds one element per evaluation in the JIT's native layout: bits
+types up to 64 bits wide use the unsigned (or signed) integer dtype of the
+same size as their layout, e.g. uint8 for bits[1..8] and uint32 for
+bits[17..32], with values that fit the bit width; other types use uint8
+arrays of shape (batch_size, size). The number of evaluations is the length of
+the result array.
+
+Args:
+ args: One array per parameter of the function.
+ result: Array to write the results to.)",
+           py::arg("args"), py::arg("result"));
+}
+
+}  // namespace xls
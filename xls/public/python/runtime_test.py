@@ -0,0 +1,88 @@
+# Copyright 2023 The XLS Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Tests for xls.public.python.runtime."""
+
+import sys
+
+import numpy as np
+
+from absl.testing import absltest
+from xls.common.python import init_xls
+from xls.public.python import runtime
+
+IR_TEXT = """package p
+
+fn add(x: bits[32], y: bits[32]) -> bits[32] {
+  ret add.1: bits[32] = add(x, y, id=1)
+}
+
+fn wide_add(x: bits[100], y: bits[100]) -> bits[100] {
+  ret add.2: bits[100] = add(x, y, id=2)
+}
+"""
+
+
+def setUpModule():
+  init_xls.init_xls(sys.argv)
+
+
+class RuntimeTest(absltest.TestCase):
+
+  def test_run_batch(self):
+    f = runtime.CompiledFunction.create(IR_TEXT, 'add')
+    self.assertEqual(f.arg_count(), 2)
+    self.assertEqual(f.result_size(), 4)
+    x = np.arange(1000, dtype=np.uint32)
+    y = np.full(1000, 0xffffffff, dtype=np.uint32)
+    result = np.zeros(1000, dtype=np.uint32)
+    f.run_batch([x, y], result)
+    np.testing.assert_array_equal(result, x - 1)
+    self.assertEqual(result[0], 0xffffffff)
+
+  def test_run_batch_on_byte_arrays(self):
+    f = runtime.CompiledFunction.create(IR_TEXT, 'wide_add')
+    size = f.arg_size(0)
+    xs = [2**99 + i for i in range(10)]
+    ys = [2**64 * i for i in range(10)]
+
+    def to_array(values):
+      return np.array([list(v.to_bytes(size, 'little')) for v in values],
+                      dtype=np.uint8)
+
+    result = np.zeros((10, f.result_size()), dtype=np.uint8)
+    f.run_batch([to_array(xs), to_array(ys)], result)
+    for i in range(10):
+      self.assertEqual(
+          int.from_bytes(result[i].tobytes(), 'little'),
+          (xs[i] + ys[i]) % 2**100)
+
+  def test_mismatched_arrays(self):
+    f = runtime.CompiledFunction.create(IR_TEXT, 'add')
+    x = np.zeros(10, dtype=np.uint32)
+    with self.assertRaisesRegex(Exception, 'argument 1'):
+      f.run_batch([x, np.zeros(10, dtype=np.uint16)],
+                  np.zeros(10, dtype=np.uint32))
+    with self.assertRaisesRegex(Exception, 'argument 0'):
+      f.run_batch([np.zeros(5, dtype=np.uint32), x],
+                  np.zeros(10, dtype=np.uint32))
+    with self.assertRaisesRegex(Exception, 'integer or bool'):
+      f.run_batch([x, np.zeros(10, dtype=np.float32)],
+                  np.zeros(10, dtype=np.uint32))
+    with self.assertRaisesRegex(Exception, 'Expected 2'):
+      f.run_batch([x], np.zeros(10, dtype=np.uint32))
+
+
+if __name__ == '__main__':
+  absltest.main()
@@ -0,0 +1,126 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/public/runtime.h"
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_helpers.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+namespace {
+
+// Returns scratch space of at least `size` bytes private to the calling
+// thread, so concurrent evaluations neither share nor allocate it.
+absl::Span<uint8_t> ThreadTempBuffer(int64_t size) {
+  thread_local std::vector<uint8_t> buffer;
+  if (buffer.size() < size) {
+    buffer.resize(size);
+  }
+  return absl::MakeSpan(buffer);
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<CompiledFunction>>
+CompiledFunction::Create(std::string_view ir_text,
+                         std::string_view function_name, int64_t opt_level) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text));
+  Function* function;
+  if (function_name.empty()) {
+    XLS_ASSIGN_OR_RETURN(function, package->GetTopAsFunction());
+  } else {
+    XLS_ASSIGN_OR_RETURN(function, package->GetFunction(function_name));
+  }
+  // RunBatch is part of the interface so the batched entry point is always
+  // built.
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<FunctionJit> jit,
+      FunctionJit::Create(function, opt_level, /*profile=*/nullptr,
+                          /*build_batched_wrapper=*/true));
+
+  std::vector<TypeLayout> arg_layouts;
+  for (Param* param : function->params()) {
+    arg_layouts.push_back(jit->runtime()->CreateTypeLayout(param->GetType()));
+  }
+  TypeLayout result_layout =
+      jit->runtime()->CreateTypeLayout(function->return_value()->GetType());
+  return absl::WrapUnique(new CompiledFunction(
+      std::move(package), function, std::move(jit), std::move(arg_layouts),
+      std::move(result_layout)));
+}
+
+absl::Status CompiledFunction::Run(absl::Span<const uint8_t* const> args,
+                                   absl::Span<uint8_t> result) const {
+  InterpreterEvents events;
+  XLS_RETURN_IF_ERROR(jit_->RunWithViews(
+      args, result, ThreadTempBuffer(jit_->GetTempBufferSize()), &events));
+  return InterpreterEventsToStatus(events);
+}
+
+absl::Status CompiledFunction::RunBatch(
+    absl::Span<const uint8_t* const> arg_columns,
+    absl::Span<uint8_t> result_column, int64_t batch_size) const {
+  InterpreterEvents events;
+  XLS_RETURN_IF_ERROR(jit_->RunBatch(
+      arg_columns, result_column, batch_size,
+      ThreadTempBuffer(jit_->GetTempBufferSize()), &events));
+  return InterpreterEventsToStatus(events);
+}
+
+absl::Status CompiledFunction::ArgToNative(int64_t i, const Value& value,
+                                           absl::Span<uint8_t> buffer) const {
+  if (i < 0 || i >= arg_count()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Argument index %d out of range; function has %d arguments", i,
+        arg_count()));
+  }
+  if (buffer.size() < arg_size(i)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Buffer too small - must be at least %d bytes!", arg_size(i)));
+  }
+  Type* type = function_->params()[i]->GetType();
+  if (!ValueConformsToType(value, type)) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Value %s does not match argument type %s",
+                        value.ToString(), type->ToString()));
+  }
+  arg_layouts_[i].ValueToNativeLayout(value, buffer.data());
+  return absl::OkStatus();
+}
+
+Value CompiledFunction::ResultToValue(absl::Span<const uint8_t> buffer) const {
+  return result_layout_.NativeLayoutToValue(buffer.data());
+}
+
+}  // namespace xls
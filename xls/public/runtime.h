@@ -0,0 +1,105 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Public API for evaluating XLS functions at runtime, e.g. as golden models
+// embedded in other software.
+//
+// Functions are evaluated over caller-owned buffers holding values in the
+// JIT's native layout, so that the hot path constructs no Values:
+//
+//   XLS_ASSIGN_OR_RETURN(std::unique_ptr<CompiledFunction> f,
+//                        CompiledFunction::Create(ir_text, "add"));
+//   std::vector<uint8_t> x(f->arg_size(0)), y(f->arg_size(1));
+//   std::vector<uint8_t> sum(f->result_size());
+//   ... fill x and y, e.g. with f->ArgToNative ...
+//   XLS_RETURN_IF_ERROR(f->Run({x.data(), y.data()}, absl::MakeSpan(sum)));
+
+#ifndef XLS_PUBLIC_RUNTIME_H_
+#define XLS_PUBLIC_RUNTIME_H_
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/function.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+
+// An XLS function compiled to native code. All the const methods may be called
+// concurrently from any number of threads.
+class CompiledFunction {
+ public:
+  // Parses the package in `ir_text` and JIT-compiles its function named
+  // `function_name`, or its top function if the name is empty.
+  static absl::StatusOr<std::unique_ptr<CompiledFunction>> Create(
+      std::string_view ir_text, std::string_view function_name = "",
+      int64_t opt_level = 3);
+
+  int64_t arg_count() const { return arg_layouts_.size(); }
+
+  // The number of bytes of each argument and of the result in native layout.
+  int64_t arg_size(int64_t i) const { return arg_layouts_.at(i).size(); }
+  int64_t result_size() const { return result_layout_.size(); }
+
+  // Evaluates the function on `args`, one buffer of arg_size(i) bytes per
+  // argument, writing the result to `result`, which must hold at least
+  // result_size() bytes. A failed assertion is returned as an error.
+  absl::Status Run(absl::Span<const uint8_t* const> args,
+                   absl::Span<uint8_t> result) const;
+
+  // Evaluates the function `batch_size` times. `arg_columns[i]` holds the i-th
+  // argument of each evaluation back to back, every arg_size(i) bytes, and the
+  // results are written likewise to `result_column`.
+  absl::Status RunBatch(absl::Span<const uint8_t* const> arg_columns,
+                        absl::Span<uint8_t> result_column,
+                        int64_t batch_size) const;
+
+  // Conversions between Values and the native layout, for setting up and
+  // checking buffers off the hot path.
+  absl::Status ArgToNative(int64_t i, const Value& value,
+                           absl::Span<uint8_t> buffer) const;
+  Value ResultToValue(absl::Span<const uint8_t> buffer) const;
+
+  Function* function() const { return function_; }
+
+ private:
+  CompiledFunction(std::unique_ptr<Package> package, Function* function,
+                   std::unique_ptr<FunctionJit> jit,
+                   std::vector<TypeLayout> arg_layouts,
+                   TypeLayout result_layout)
+      : package_(std::move(package)),
+        function_(function),
+        jit_(std::move(jit)),
+        arg_layouts_(std::move(arg_layouts)),
+        result_layout_(std::move(result_layout)) {}
+
+  std::unique_ptr<Package> package_;
+  Function* function_;
+  std::unique_ptr<FunctionJit> jit_;
+  std::vector<TypeLayout> arg_layouts_;
+  TypeLayout result_layout_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PUBLIC_RUNTIME_H_
@@ -0,0 +1,133 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/public/runtime.h"
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/thread.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+constexpr std::string_view kIr = R"(package p
+
+fn add(x: bits[32], y: bits[32]) -> bits[32] {
+  ret add.1: bits[32] = add(x, y, id=1)
+}
+
+top fn checked_neg(x: bits[8]) -> bits[8] {
+  after_all.2: token = after_all(id=2)
+  literal.3: bits[8] = literal(value=128, id=3)
+  ne.4: bits[1] = ne(x, literal.3, id=4)
+  assert.5: token = assert(after_all.2, ne.4, message="overflow", id=5)
+  ret neg.6: bits[8] = neg(x, id=6)
+}
+)";
+
+TEST(RuntimeTest, RunOnNativeBuffers) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledFunction> f,
+                           CompiledFunction::Create(kIr, "add"));
+  ASSERT_EQ(f->arg_count(), 2);
+  std::vector<uint8_t> x(f->arg_size(0));
+  std::vector<uint8_t> y(f->arg_size(1));
+  std::vector<uint8_t> sum(f->result_size());
+  XLS_ASSERT_OK(f->ArgToNative(0, Value(UBits(40, 32)), absl::MakeSpan(x)));
+  XLS_ASSERT_OK(f->ArgToNative(1, Value(UBits(2, 32)), absl::MakeSpan(y)));
+  XLS_ASSERT_OK(f->Run({x.data(), y.data()}, absl::MakeSpan(sum)));
+  EXPECT_EQ(f->ResultToValue(sum), Value(UBits(42, 32)));
+
+  EXPECT_THAT(f->ArgToNative(0, Value(UBits(1, 8)), absl::MakeSpan(x)),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(f->Run({x.data()}, absl::MakeSpan(sum)),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(RuntimeTest, FailedAssertionIsAnError) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledFunction> f,
+                           CompiledFunction::Create(kIr));
+  std::vector<uint8_t> x(f->arg_size(0));
+  std::vector<uint8_t> result(f->result_size());
+  XLS_ASSERT_OK(f->ArgToNative(0, Value(UBits(3, 8)), absl::MakeSpan(x)));
+  XLS_ASSERT_OK(f->Run({x.data()}, absl::MakeSpan(result)));
+  EXPECT_EQ(f->ResultToValue(result), Value(UBits(253, 8)));
+
+  XLS_ASSERT_OK(f->ArgToNative(0, Value(UBits(128, 8)), absl::MakeSpan(x)));
+  EXPECT_THAT(f->Run({x.data()}, absl::MakeSpan(result)),
+              StatusIs(absl::StatusCode::kAborted, HasSubstr("overflow")));
+}
+
+TEST(RuntimeTest, RunBatch) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledFunction> f,
+                           CompiledFunction::Create(kIr, "add"));
+  constexpr int64_t kBatchSize = 100;
+  std::vector<uint8_t> xs(kBatchSize * f->arg_size(0));
+  std::vector<uint8_t> ys(kBatchSize * f->arg_size(1));
+  std::vector<uint8_t> sums(kBatchSize * f->result_size());
+  for (int64_t i = 0; i < kBatchSize; ++i) {
+    XLS_ASSERT_OK(f->ArgToNative(
+        0, Value(UBits(i, 32)),
+        absl::MakeSpan(xs).subspan(i * f->arg_size(0), f->arg_size(0))));
+    XLS_ASSERT_OK(f->ArgToNative(
+        1, Value(UBits(2 * i, 32)),
+        absl::MakeSpan(ys).subspan(i * f->arg_size(1), f->arg_size(1))));
+  }
+  XLS_ASSERT_OK(
+      f->RunBatch({xs.data(), ys.data()}, absl::MakeSpan(sums), kBatchSize));
+  for (int64_t i = 0; i < kBatchSize; ++i) {
+    EXPECT_EQ(f->ResultToValue(absl::MakeSpan(sums).subspan(
+                  i * f->result_size(), f->result_size())),
+              Value(UBits(3 * i, 32)));
+  }
+}
+
+TEST(RuntimeTest, ConcurrentRuns) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledFunction> f,
+                           CompiledFunction::Create(kIr, "add"));
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t t = 0; t < 8; ++t) {
+    threads.push_back(std::make_unique<Thread>([&f, t] {
+      std::vector<uint8_t> x(f->arg_size(0));
+      std::vector<uint8_t> y(f->arg_size(1));
+      std::vector<uint8_t> sum(f->result_size());
+      for (int64_t i = 0; i < 1000; ++i) {
+        XLS_ASSERT_OK(
+            f->ArgToNative(0, Value(UBits(t, 32)), absl::MakeSpan(x)));
+        XLS_ASSERT_OK(
+            f->ArgToNative(1, Value(UBits(i, 32)), absl::MakeSpan(y)));
+        XLS_ASSERT_OK(f->Run({x.data(), y.data()}, absl::MakeSpan(sum)));
+        EXPECT_EQ(f->ResultToValue(sum), Value(UBits(t + i, 32)));
+      }
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+}
+
+}  // namespace
+}  // namespace xls
@@ -15,7 +15,10 @@
 #include "xls/scheduling/extract_stage.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -23,67 +26,73 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/node.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value_helpers.h"
 
 namespace xls {
+namespace {
 
-absl::StatusOr<Function*> ExtractStage(FunctionBase* src,
-                                       const PipelineSchedule& schedule,
-                                       int stage) {
-  // Create a new function in the package which only contains the nodes at the
-  // given stage (cycle).
-  Package* package = src->package();
+// Builds the function for `stage` of `src` from `stage_nodes`, the nodes
+// scheduled in that stage in topological order. If `first_local_id` is set the
+// new function draws node ids from a private sequence starting there, so that
+// several stages can be built concurrently.
+absl::StatusOr<std::unique_ptr<Function>> BuildStageFunction(
+    FunctionBase* src, const PipelineSchedule& schedule, int64_t stage,
+    absl::Span<Node* const> stage_nodes,
+    std::optional<int64_t> first_local_id) {
   auto new_f = std::make_unique<Function>(
-      absl::StrFormat("%s_stage_%d", src->name(), stage), package);
+      absl::StrFormat("%s_stage_%d", src->name(), stage), src->package());
+  if (first_local_id.has_value()) {
+    new_f->BeginLocalNodeIds(*first_local_id);
+  }
   absl::flat_hash_map<Node*, Node*> node_map;
   std::vector<Node*> live_out;
-  for (Node* node : TopoSort(src)) {
-    if (schedule.cycle(node) == stage) {
-      std::vector<Node*> new_operands;
-      for (Node* operand : node->operands()) {
-        if (node_map.contains(operand)) {
-          new_operands.push_back(node_map.at(operand));
-        } else {
-          Node* new_param = new_f->AddNode(
-              std::make_unique<Param>(operand->loc(), operand->GetName(),
-                                      operand->GetType(), new_f.get()));
-          node_map[operand] = new_param;
-          new_operands.push_back(new_param);
-        }
-      }
-      // hack to support viewing procs as functions
-      Node* new_node;
-      if (node->Is<Send>() || node->Is<Receive>()) {
-        new_node = new_f->AddNode(std::make_unique<xls::Param>(
-            node->loc(), node->GetName(), node->GetType(), new_f.get()));
+  for (Node* node : stage_nodes) {
+    std::vector<Node*> new_operands;
+    for (Node* operand : node->operands()) {
+      if (node_map.contains(operand)) {
+        new_operands.push_back(node_map.at(operand));
       } else {
-        XLS_ASSIGN_OR_RETURN(
-            new_node, node->CloneInNewFunction(new_operands, new_f.get()));
-      }
-      node_map[node] = new_node;
-      if (std::any_of(node->users().begin(), node->users().end(), [&](Node* u) {
-            return schedule.cycle(u) > stage || u->Is<Send>() ||
-                   new_f->HasImplicitUse(node);
-          })) {
-        live_out.push_back(new_node);
+        Node* new_param = new_f->AddNode(
+            std::make_unique<Param>(operand->loc(), operand->GetName(),
+                                    operand->GetType(), new_f.get()));
+        node_map[operand] = new_param;
+        new_operands.push_back(new_param);
       }
     }
+    // hack to support viewing procs as functions
+    Node* new_node;
+    if (node->Is<Send>() || node->Is<Receive>()) {
+      new_node = new_f->AddNode(std::make_unique<xls::Param>(
+          node->loc(), node->GetName(), node->GetType(), new_f.get()));
+    } else {
+      XLS_ASSIGN_OR_RETURN(
+          new_node, node->CloneInNewFunction(new_operands, new_f.get()));
+    }
+    node_map[node] = new_node;
+    if (std::any_of(node->users().begin(), node->users().end(), [&](Node* u) {
+          return schedule.cycle(u) > stage || u->Is<Send>() ||
+                 new_f->HasImplicitUse(node);
+        })) {
+      live_out.push_back(new_node);
+    }
   }
 
   // If this stage doesn't include the function output, create a final tuple
   // which gathers all nodes scheduled in the stage that are live out.
   // The tuple will be the return value of the new function.
   // Otherwise, just use the mapped function output.
-
-  auto src_function = static_cast<Function*>(src);
-  if (node_map.contains(src_function->return_value())) {
-    XLS_RETURN_IF_ERROR(
-        new_f->set_return_value(node_map[src_function->return_value()]));
+  if (src->IsFunction() &&
+      node_map.contains(src->AsFunctionOrDie()->return_value())) {
+    XLS_RETURN_IF_ERROR(new_f->set_return_value(
+        node_map.at(src->AsFunctionOrDie()->return_value())));
   } else {
     if (live_out.size() == 1) {
       XLS_RETURN_IF_ERROR(new_f->set_return_value(live_out.front()));
@@ -93,6 +102,86 @@ absl::StatusOr<Function*> ExtractStage(FunctionBase* src,
       XLS_RETURN_IF_ERROR(new_f->set_return_value(return_tuple));
     }
   }
-  return package->AddFunction(std::move(new_f));
+  return new_f;
+}
+
+}  // namespace
+
+absl::StatusOr<Function*> ExtractStage(FunctionBase* src,
+                                       const PipelineSchedule& schedule,
+                                       int stage) {
+  // Create a new function in the package which only contains the nodes at the
+  // given stage (cycle).
+  std::vector<Node*> stage_nodes;
+  for (Node* node : TopoSort(src)) {
+    if (schedule.cycle(node) == stage) {
+      stage_nodes.push_back(node);
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Function> new_f,
+                       BuildStageFunction(src, schedule, stage, stage_nodes,
+                                          /*first_local_id=*/std::nullopt));
+  return src->package()->AddFunction(std::move(new_f));
 }
+
+absl::StatusOr<std::vector<Function*>> ExtractAllStages(
+    FunctionBase* src, const PipelineSchedule& schedule,
+    int64_t thread_count) {
+  std::vector<std::vector<Node*>> stage_nodes(schedule.length());
+  for (Node* node : TopoSort(src)) {
+    stage_nodes.at(schedule.cycle(node)).push_back(node);
+  }
+
+  // Each stage draws node ids from a private sequence starting at the
+  // package's next id. Afterwards the ids are shifted to the values that
+  // extracting the stages one after another would have produced.
+  Package* package = src->package();
+  const int64_t first_id = package->next_node_id();
+  std::vector<absl::StatusOr<std::unique_ptr<Function>>> stage_functions(
+      stage_nodes.size());
+  std::atomic<int64_t> next_stage = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_stage++; i < stage_nodes.size();
+         i = next_stage++) {
+      stage_functions[i] =
+          BuildStageFunction(src, schedule, i, stage_nodes[i], first_id);
+    }
+  };
+  thread_count = std::min<int64_t>(thread_count, stage_nodes.size());
+  if (thread_count <= 1) {
+    worker();
+  } else {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t i = 0; i < thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    // Threads are joined on destruction.
+  }
+
+  std::vector<Function*> result;
+  result.reserve(stage_functions.size());
+  int64_t id_offset = 0;
+  for (absl::StatusOr<std::unique_ptr<Function>>& stage_function :
+       stage_functions) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Function> new_f,
+                         std::move(stage_function));
+    int64_t end_id = new_f->EndLocalNodeIds();
+    if (id_offset != 0) {
+      std::vector<Node*> nodes(new_f->nodes().begin(), new_f->nodes().end());
+      // Shift the largest ids first so that no two nodes of the function share
+      // an id at any point.
+      std::sort(nodes.begin(), nodes.end(),
+                [](Node* a, Node* b) { return a->id() > b->id(); });
+      for (Node* node : nodes) {
+        node->SetId(node->id() + id_offset);
+      }
+    }
+    id_offset += end_id - first_id;
+    package->set_next_node_id(first_id + id_offset);
+    result.push_back(package->AddFunction(std::move(new_f)));
+  }
+  return result;
+}
+
 }  // namespace xls
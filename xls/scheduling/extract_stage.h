@@ -15,6 +15,9 @@
 #ifndef XLS_SCHEDULING_EXTRACT_STAGE_H_
 #define XLS_SCHEDULING_EXTRACT_STAGE_H_
 
+#include <cstdint>
+#include <vector>
+
 #include "absl/status/statusor.h"
 #include "xls/ir/function.h"
 #include "xls/scheduling/pipeline_schedule.h"
@@ -27,6 +30,15 @@ absl::StatusOr<Function*> ExtractStage(FunctionBase* src,
                                        const PipelineSchedule& schedule,
                                        int stage);
 
+// Creates the function of every stage of `schedule` as ExtractStage would and
+// adds them to the package of `src`, returning them in stage order. The
+// schedule is scanned once rather than once per stage, and the stage functions
+// are built on up to `thread_count` threads. The result, including node ids,
+// is the same as calling ExtractStage for each stage in turn.
+absl::StatusOr<std::vector<Function*>> ExtractAllStages(
+    FunctionBase* src, const PipelineSchedule& schedule,
+    int64_t thread_count = 1);
+
 }  // namespace xls
 
 #endif  // XLS_SCHEDULING_EXTRACT_STAGE_H_
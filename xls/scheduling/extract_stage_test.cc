@@ -14,9 +14,11 @@
 
 #include "xls/scheduling/extract_stage.h"
 
+#include <cstdint>
 #include <iostream>
 #include <ostream>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -201,5 +203,54 @@ TEST_F(ExtractStageTest, ProcSchedule) {
   EXPECT_EQ(schedule.length(), 3);
 }
 
+// Extracting all stages at once, on several threads, gives the same functions
+// (including node ids) as extracting the stages one at a time.
+TEST_F(ExtractStageTest, ExtractAllStagesMatchesExtractStage) {
+  std::string ir_text = R"(
+package p
+
+fn main(i0: bits[8], i1: bits[8]) -> bits[8] {
+  add.1: bits[8] = add(i0, i1)
+  sub.2: bits[8] = sub(add.1, i1)
+  or.3: bits[8] = or(sub.2, add.1)
+  xor.4: bits[8] = xor(or.3, i0)
+  umul.5: bits[8] = umul(xor.4, sub.2)
+  ret and.6: bits[8] = and(umul.5, or.3)
+}
+)";
+  auto schedule_function = [](Function* function) {
+    ScheduleCycleMap cycle_map;
+    for (Node* node : function->nodes()) {
+      cycle_map[node] = node->Is<Param>() ? 0 : node->id() - 1;
+    }
+    return PipelineSchedule(function, cycle_map, 6);
+  };
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto expected_package,
+                           Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * expected_function,
+                           expected_package->GetFunction("main"));
+  PipelineSchedule expected_schedule = schedule_function(expected_function);
+  std::vector<std::string> expected;
+  for (int stage = 0; stage < expected_schedule.length(); ++stage) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Function * stage_fn,
+        ExtractStage(expected_function, expected_schedule, stage));
+    expected.push_back(stage_fn->DumpIr());
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, package->GetFunction("main"));
+  PipelineSchedule schedule = schedule_function(function);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<Function*> stages,
+      ExtractAllStages(function, schedule, /*thread_count=*/4));
+  ASSERT_EQ(stages.size(), expected.size());
+  for (int64_t stage = 0; stage < stages.size(); ++stage) {
+    EXPECT_EQ(stages[stage]->DumpIr(), expected[stage]);
+  }
+  EXPECT_EQ(package->next_node_id(), expected_package->next_node_id());
+}
+
 }  // namespace
 }  // namespace xls
@@ -14,6 +14,8 @@
 
 #include "xls/scheduling/function_partition.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <utility>
 #include <vector>
@@ -24,12 +26,14 @@
 #include "xls/common/logging/vlog_is_on.h"
 #include "xls/data_structures/min_cut.h"
 #include "xls/ir/function.h"
+#include "xls/ir/node_iterator.h"
 
 namespace xls {
 namespace sched {
 
 std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
-    FunctionBase* f, absl::Span<Node* const> partitionable_nodes) {
+    FunctionBase* f, absl::Span<Node* const> partitionable_nodes,
+    min_cut::MaxFlowAlgorithm max_flow_algorithm) {
   if (XLS_VLOG_IS_ON(4)) {
     XLS_VLOG(4) << "Computing min-cut of function " << f->name()
                 << ", partitionable nodes:";
@@ -164,7 +168,7 @@ std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
   }
 
   min_cut::GraphCut graph_cut =
-      min_cut::MinCutBetweenNodes(graph, source, sink);
+      min_cut::MinCutBetweenNodes(graph, source, sink, max_flow_algorithm);
 
   // Map the mincut graph partition back to the XLS graph.
   std::pair<std::vector<Node*>, std::vector<Node*>> partitions;
@@ -197,5 +201,71 @@ std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
   return partitions;
 }
 
+namespace {
+
+// Bisects the topologically ordered `nodes` until the parts have at most
+// `max_region_size` nodes, appending the parts to `regions` in order.
+void BisectIntoRegions(FunctionBase* f, std::vector<Node*> nodes,
+                       int64_t max_region_size,
+                       min_cut::MaxFlowAlgorithm max_flow_algorithm,
+                       const absl::flat_hash_map<Node*, int64_t>& topo_index,
+                       std::vector<std::vector<Node*>>& regions) {
+  const int64_t size = nodes.size();
+  if (size <= max_region_size) {
+    regions.push_back(std::move(nodes));
+    return;
+  }
+
+  // The window is contiguous in the topological order, so any path between
+  // its nodes stays in the window as MinCostFunctionPartition requires. It
+  // leaves at least a quarter of the nodes on either side, so both halves are
+  // non-empty and the recursion is logarithmically deep.
+  const int64_t half_window = std::min(max_region_size, size) / 4;
+  const int64_t window_begin = size / 2 - half_window;
+  const int64_t window_end = size / 2 + half_window;
+  std::vector<Node*> first(nodes.begin(), nodes.begin() + window_begin);
+  std::vector<Node*> second;
+  if (window_begin < window_end) {
+    auto [before, after] = MinCostFunctionPartition(
+        f,
+        absl::MakeConstSpan(nodes).subspan(window_begin,
+                                           window_end - window_begin),
+        max_flow_algorithm);
+    auto topo_less = [&](Node* a, Node* b) {
+      return topo_index.at(a) < topo_index.at(b);
+    };
+    std::sort(before.begin(), before.end(), topo_less);
+    std::sort(after.begin(), after.end(), topo_less);
+    first.insert(first.end(), before.begin(), before.end());
+    second = std::move(after);
+  }
+  second.insert(second.end(), nodes.begin() + window_end, nodes.end());
+  nodes.clear();
+  nodes.shrink_to_fit();
+
+  BisectIntoRegions(f, std::move(first), max_region_size, max_flow_algorithm,
+                    topo_index, regions);
+  BisectIntoRegions(f, std::move(second), max_region_size, max_flow_algorithm,
+                    topo_index, regions);
+}
+
+}  // namespace
+
+std::vector<std::vector<Node*>> PartitionFunctionIntoRegions(
+    FunctionBase* f, int64_t max_region_size,
+    min_cut::MaxFlowAlgorithm max_flow_algorithm) {
+  XLS_CHECK_GT(max_region_size, 0);
+  std::vector<Node*> topo_sort = TopoSort(f).AsVector();
+  absl::flat_hash_map<Node*, int64_t> topo_index;
+  topo_index.reserve(topo_sort.size());
+  for (int64_t i = 0; i < topo_sort.size(); ++i) {
+    topo_index[topo_sort[i]] = i;
+  }
+  std::vector<std::vector<Node*>> regions;
+  BisectIntoRegions(f, std::move(topo_sort), max_region_size,
+                    max_flow_algorithm, topo_index, regions);
+  return regions;
+}
+
 }  // namespace sched
 }  // namespace xls
@@ -15,10 +15,12 @@
 #ifndef XLS_SCHEDULING_FUNCTION_PARTITION_H_
 #define XLS_SCHEDULING_FUNCTION_PARTITION_H_
 
+#include <cstdint>
 #include <utility>
 #include <vector>
 
 #include "absl/types/span.h"
+#include "xls/data_structures/min_cut.h"
 #include "xls/ir/function.h"
 #include "xls/ir/node.h"
 
@@ -52,9 +54,31 @@ namespace sched {
 // are inserted between the nodes of A and the nodes of B.
 //
 // Returns the two partitions as a std::pair. The first element is the
-// predecessor partition of the dicut (partition A in the example above).
+// predecessor partition of the dicut (partition A in the example above). The
+// min cut is computed with the given max-flow algorithm.
 std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
-    FunctionBase* f, absl::Span<Node* const> partitionable_nodes);
+    FunctionBase* f, absl::Span<Node* const> partitionable_nodes,
+    min_cut::MaxFlowAlgorithm max_flow_algorithm =
+        min_cut::MaxFlowAlgorithm::kAugmentingPath);
+
+// Partitions the nodes of the function into loosely coupled regions of at most
+// 'max_region_size' nodes each, for scheduling very large functions region by
+// region.
+//
+// The regions are found by recursively bisecting a topological sort of the
+// nodes. Each bisection cuts across the middle of the order: the nodes in a
+// window around the middle are split with MinCostFunctionPartition, and the
+// nodes before (after) the window join the first (second) half. So few bits
+// flow between the regions, and partitioning takes time near-linear in the
+// size of the function.
+//
+// The nodes of each region are in topological order, and edges only extend
+// from earlier regions to later ones. In particular, any path between two nodes
+// of a region only includes nodes of the region.
+std::vector<std::vector<Node*>> PartitionFunctionIntoRegions(
+    FunctionBase* f, int64_t max_region_size,
+    min_cut::MaxFlowAlgorithm max_flow_algorithm =
+        min_cut::MaxFlowAlgorithm::kAugmentingPath);
 
 }  // namespace sched
 }  // namespace xls
@@ -14,6 +14,7 @@
 
 #include "xls/scheduling/function_partition.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
@@ -21,8 +22,10 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "xls/common/status/matchers.h"
+#include "xls/data_structures/min_cut.h"
 #include "xls/examples/sample_packages.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
@@ -200,6 +203,13 @@ TEST_F(FunctionPartitionTest, BenchmarkTest) {
 
       auto partition = MinCostFunctionPartition(f, nodes_to_partition);
 
+      // Every max-flow algorithm should produce the same partition.
+      EXPECT_EQ(MinCostFunctionPartition(
+                    f, nodes_to_partition,
+                    min_cut::MaxFlowAlgorithm::kPushRelabel),
+                partition)
+          << benchmark_name;
+
       EXPECT_EQ(partition.first.size() + partition.second.size(),
                 nodes_to_partition.size());
 
@@ -248,6 +258,58 @@ TEST_F(FunctionPartitionTest, BenchmarkTest) {
   }
 }
 
+TEST_F(FunctionPartitionTest, PartitionIntoRegions) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue a = x;
+  BValue b = y;
+  for (int64_t i = 0; i < 20; ++i) {
+    a = fb.Add(a, y);
+    b = fb.Negate(fb.Subtract(b, a));
+  }
+  fb.Concat({a, b});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  for (int64_t max_region_size : {1, 3, 7, 16, 1000}) {
+    std::vector<std::vector<Node*>> regions =
+        PartitionFunctionIntoRegions(f, max_region_size);
+    absl::flat_hash_map<Node*, int64_t> region_of;
+    for (int64_t r = 0; r < regions.size(); ++r) {
+      EXPECT_GT(regions[r].size(), 0);
+      EXPECT_LE(regions[r].size(), max_region_size);
+      for (Node* node : regions[r]) {
+        EXPECT_TRUE(region_of.emplace(node, r).second) << node->GetName();
+      }
+    }
+    EXPECT_EQ(region_of.size(), f->node_count());
+    if (max_region_size >= f->node_count()) {
+      EXPECT_EQ(regions.size(), 1);
+    }
+
+    // Edges only extend to the same or a later region, and within a region
+    // operands come before their users.
+    for (Node* node : f->nodes()) {
+      for (Node* operand : node->operands()) {
+        EXPECT_LE(region_of.at(operand), region_of.at(node))
+            << operand->GetName() << "->" << node->GetName();
+      }
+    }
+    for (const std::vector<Node*>& region : regions) {
+      absl::flat_hash_set<Node*> seen;
+      for (Node* node : region) {
+        for (Node* operand : node->operands()) {
+          if (region_of.at(operand) == region_of.at(node)) {
+            EXPECT_TRUE(seen.contains(operand)) << node->GetName();
+          }
+        }
+        seen.insert(node);
+      }
+    }
+  }
+}
+
 }  // namespace
 }  // namespace sched
 }  // namespace xls
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <functional>
 #include <limits>
 #include <numeric>
@@ -33,6 +34,9 @@
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
+#include "xls/data_structures/min_cut.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/node_util.h"
 #include "xls/ir/nodes.h"
@@ -50,6 +54,7 @@ namespace {
 // 'cycle + 1'.
 absl::Status SplitAfterCycle(FunctionBase* f, int64_t cycle,
                              const DelayEstimator& delay_estimator,
+                             min_cut::MaxFlowAlgorithm max_flow_algorithm,
                              sched::ScheduleBounds* bounds) {
   XLS_VLOG(3) << "Splitting after cycle " << cycle;
 
@@ -63,7 +68,8 @@ absl::Status SplitAfterCycle(FunctionBase* f, int64_t cycle,
   }
 
   std::pair<std::vector<Node*>, std::vector<Node*>> partitions =
-      sched::MinCostFunctionPartition(f, partitionable_nodes);
+      sched::MinCostFunctionPartition(f, partitionable_nodes,
+                                      max_flow_algorithm);
 
   // Tighten bounds based on the cut.
   for (Node* node : partitions.first) {
@@ -117,6 +123,121 @@ std::vector<int64_t> MiddleFirstOrder(int64_t first, int64_t last) {
   return ret;
 }
 
+// Tightens `bounds` to satisfy `constraints` and the requirements of proc
+// state, returning an error for constraints (or nodes) the min-cut schedulers
+// do not support.
+absl::Status ApplyConstraintsToBounds(
+    FunctionBase* f, int64_t pipeline_stages,
+    absl::Span<const SchedulingConstraint> constraints,
+    sched::ScheduleBounds* bounds) {
+  for (const SchedulingConstraint& constraint : constraints) {
+    if (std::holds_alternative<RecvsFirstSendsLastConstraint>(constraint)) {
+      for (Node* node : f->nodes()) {
+        if (node->Is<Receive>()) {
+          XLS_RETURN_IF_ERROR(bounds->TightenNodeUb(node, 0));
+          XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
+        }
+        if (node->Is<Send>()) {
+          XLS_RETURN_IF_ERROR(bounds->TightenNodeLb(node, pipeline_stages - 1));
+          XLS_RETURN_IF_ERROR(bounds->PropagateLowerBounds());
+        }
+      }
+    } else {
+      return absl::InternalError(
+          "MinCutScheduler doesn't support constraints "
+          "other than receives-first-sends-last.");
+    }
+  }
+
+  for (Node* node : f->nodes()) {
+    if (node->Is<MinDelay>()) {
+      return absl::InternalError(
+          "MinCutScheduler doesn't support min_delay nodes.");
+    }
+  }
+
+  // The state backedge must be in the first cycle.
+  if (Proc* proc = dynamic_cast<Proc*>(f)) {
+    for (Node* node : proc->params()) {
+      XLS_RETURN_IF_ERROR(bounds->TightenNodeUb(node, 0));
+      XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
+    }
+    for (Node* node : proc->NextState()) {
+      XLS_RETURN_IF_ERROR(bounds->TightenNodeUb(node, 0));
+      XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Schedules the nodes of `region`, which must be in topological order, with a
+// min cut at each cycle boundary within the bounds in `bounds`. Only the
+// dependencies among the nodes of the region are respected, not timing.
+// Returns the cycle of each node of the region.
+absl::StatusOr<std::vector<int64_t>> ScheduleRegion(
+    FunctionBase* f, absl::Span<Node* const> region,
+    const sched::ScheduleBounds& bounds,
+    min_cut::MaxFlowAlgorithm max_flow_algorithm) {
+  absl::flat_hash_map<Node*, int64_t> index;
+  index.reserve(region.size());
+  std::vector<int64_t> lb(region.size());
+  std::vector<int64_t> ub(region.size());
+  int64_t first_cycle = std::numeric_limits<int64_t>::max();
+  int64_t last_cycle = std::numeric_limits<int64_t>::min();
+  for (int64_t i = 0; i < region.size(); ++i) {
+    index[region[i]] = i;
+    lb[i] = bounds.lb(region[i]);
+    ub[i] = bounds.ub(region[i]);
+    first_cycle = std::min(first_cycle, lb[i]);
+    last_cycle = std::max(last_cycle, ub[i]);
+  }
+
+  for (int64_t cycle = first_cycle; cycle < last_cycle; ++cycle) {
+    std::vector<Node*> partitionable_nodes;
+    for (int64_t i = 0; i < region.size(); ++i) {
+      if (lb[i] <= cycle && ub[i] >= cycle + 1) {
+        partitionable_nodes.push_back(region[i]);
+      }
+    }
+    if (partitionable_nodes.empty()) {
+      continue;
+    }
+    std::pair<std::vector<Node*>, std::vector<Node*>> partitions =
+        sched::MinCostFunctionPartition(f, partitionable_nodes,
+                                        max_flow_algorithm);
+    for (Node* node : partitions.first) {
+      ub[index.at(node)] = cycle;
+    }
+    for (Node* node : partitions.second) {
+      lb[index.at(node)] = cycle + 1;
+    }
+
+    // Propagate the tightened bounds along the edges within the region.
+    for (int64_t i = 0; i < region.size(); ++i) {
+      for (Node* operand : region[i]->operands()) {
+        auto it = index.find(operand);
+        if (it != index.end()) {
+          lb[i] = std::max(lb[i], lb[it->second]);
+        }
+      }
+    }
+    for (int64_t i = region.size() - 1; i >= 0; --i) {
+      for (Node* user : region[i]->users()) {
+        auto it = index.find(user);
+        if (it != index.end()) {
+          ub[i] = std::min(ub[i], ub[it->second]);
+        }
+      }
+      XLS_RET_CHECK_LE(lb[i], ub[i]) << region[i]->GetName();
+    }
+  }
+
+  for (int64_t i = 0; i < region.size(); ++i) {
+    XLS_RET_CHECK_EQ(lb[i], ub[i]) << region[i]->GetName();
+  }
+  return lb;
+}
+
 }  // namespace
 
 std::vector<std::vector<int64_t>> GetMinCutCycleOrders(int64_t length) {
@@ -148,7 +269,8 @@ std::vector<std::vector<int64_t>> GetMinCutCycleOrders(int64_t length) {
 absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
     FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
     const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
-    absl::Span<const SchedulingConstraint> constraints) {
+    absl::Span<const SchedulingConstraint> constraints,
+    min_cut::MaxFlowAlgorithm max_flow_algorithm) {
   XLS_VLOG(3) << "MinCutScheduler()";
   XLS_VLOG(3) << "  pipeline stages = " << pipeline_stages;
   XLS_VLOG_LINES(4, f->DumpIr());
@@ -156,43 +278,8 @@ absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
   XLS_VLOG(4) << "Initial bounds:";
   XLS_VLOG_LINES(4, bounds->ToString());
 
-  for (const SchedulingConstraint& constraint : constraints) {
-    if (std::holds_alternative<RecvsFirstSendsLastConstraint>(constraint)) {
-      for (Node* node : f->nodes()) {
-        if (node->Is<Receive>()) {
-          XLS_RETURN_IF_ERROR(bounds->TightenNodeUb(node, 0));
-          XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
-        }
-        if (node->Is<Send>()) {
-          XLS_RETURN_IF_ERROR(bounds->TightenNodeLb(node, pipeline_stages - 1));
-          XLS_RETURN_IF_ERROR(bounds->PropagateLowerBounds());
-        }
-      }
-    } else {
-      return absl::InternalError(
-          "MinCutScheduler doesn't support constraints "
-          "other than receives-first-sends-last.");
-    }
-  }
-
-  for (Node* node : f->nodes()) {
-    if (node->Is<MinDelay>()) {
-      return absl::InternalError(
-          "MinCutScheduler doesn't support min_delay nodes.");
-    }
-  }
-
-  // The state backedge must be in the first cycle.
-  if (Proc* proc = dynamic_cast<Proc*>(f)) {
-    for (Node* node : proc->params()) {
-      XLS_RETURN_IF_ERROR(bounds->TightenNodeUb(node, 0));
-      XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
-    }
-    for (Node* node : proc->NextState()) {
-      XLS_RETURN_IF_ERROR(bounds->TightenNodeUb(node, 0));
-      XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
-    }
-  }
+  XLS_RETURN_IF_ERROR(
+      ApplyConstraintsToBounds(f, pipeline_stages, constraints, bounds));
 
   // Try a number of different orderings of cycle boundary at which the min-cut
   // is performed and keep the best one.
@@ -208,8 +295,8 @@ absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
     // cycle and those which must be scheduled after. Upon loop completion each
     // node will have a range of exactly one cycle.
     for (int64_t cycle : cut_order) {
-      XLS_RETURN_IF_ERROR(
-          SplitAfterCycle(f, cycle, delay_estimator, &trial_bounds));
+      XLS_RETURN_IF_ERROR(SplitAfterCycle(f, cycle, delay_estimator,
+                                          max_flow_algorithm, &trial_bounds));
       XLS_RETURN_IF_ERROR(trial_bounds.PropagateLowerBounds());
       XLS_RETURN_IF_ERROR(trial_bounds.PropagateUpperBounds());
     }
@@ -231,4 +318,50 @@ absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
   return cycle_map;
 }
 
+absl::StatusOr<ScheduleCycleMap> PartitionedMinCutScheduler(
+    FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
+    const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
+    absl::Span<const SchedulingConstraint> constraints,
+    int64_t max_region_size, min_cut::MaxFlowAlgorithm max_flow_algorithm) {
+  XLS_VLOG(3) << "PartitionedMinCutScheduler()";
+  XLS_VLOG(3) << "  pipeline stages = " << pipeline_stages;
+  XLS_VLOG(3) << "  max region size = " << max_region_size;
+  XLS_RET_CHECK_GT(max_region_size, 0);
+
+  XLS_RETURN_IF_ERROR(
+      ApplyConstraintsToBounds(f, pipeline_stages, constraints, bounds));
+
+  std::vector<std::vector<Node*>> regions =
+      sched::PartitionFunctionIntoRegions(f, max_region_size,
+                                          max_flow_algorithm);
+  XLS_VLOG(3) << "  regions = " << regions.size();
+
+  std::vector<std::vector<int64_t>> region_cycles(regions.size());
+  XLS_RETURN_IF_ERROR(DefaultThreadPool().ParallelForWithStatus(
+      0, regions.size(), [&](int64_t i) -> absl::Status {
+        XLS_ASSIGN_OR_RETURN(
+            region_cycles[i],
+            ScheduleRegion(f, regions[i], *bounds, max_flow_algorithm));
+        return absl::OkStatus();
+      }));
+
+  // Stitch the region schedules together, repairing the dependencies and
+  // timing of paths between regions. Regions are in topological order, so
+  // this fixes the nodes in topological order.
+  ScheduleCycleMap cycle_map;
+  for (int64_t r = 0; r < regions.size(); ++r) {
+    for (int64_t i = 0; i < regions[r].size(); ++i) {
+      Node* node = regions[r][i];
+      int64_t cycle = std::clamp(region_cycles[r][i], bounds->lb(node),
+                                 bounds->ub(node));
+      XLS_RETURN_IF_ERROR(bounds->TightenNodeLb(node, cycle));
+      XLS_RETURN_IF_ERROR(bounds->PropagateLowerBounds());
+      XLS_RETURN_IF_ERROR(bounds->TightenNodeUb(node, cycle));
+      XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
+      cycle_map[node] = cycle;
+    }
+  }
+  return cycle_map;
+}
+
 }  // namespace xls
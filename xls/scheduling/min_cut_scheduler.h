@@ -15,11 +15,13 @@
 #ifndef XLS_SCHEDULING_MIN_CUT_SCHEDULER_H_
 #define XLS_SCHEDULING_MIN_CUT_SCHEDULER_H_
 
+#include <cstdint>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "xls/data_structures/min_cut.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
@@ -32,11 +34,34 @@ namespace xls {
 // Schedules the given function into a pipeline with the given clock
 // period. Attempts to split nodes into stages such that the total number of
 // flops in the pipeline stages is minimized without violating the target clock
-// period.
+// period. The min cuts are computed with the given max-flow algorithm.
 absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
     FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
     const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
-    absl::Span<const SchedulingConstraint> constraints);
+    absl::Span<const SchedulingConstraint> constraints,
+    min_cut::MaxFlowAlgorithm max_flow_algorithm =
+        min_cut::MaxFlowAlgorithm::kAugmentingPath);
+
+// Like MinCutScheduler, but for very large functions: scheduling takes time
+// near-linear in the size of the function, at the cost of some pipeline
+// registers.
+//
+// The function is partitioned into loosely coupled regions of at most
+// 'max_region_size' nodes (see sched::PartitionFunctionIntoRegions). The
+// regions are scheduled in parallel, each with a min cut at every cycle
+// boundary among its nodes, within the ASAP/ALAP bounds given by 'bounds'. As
+// each region is scheduled independently, respecting only the dependencies
+// among its own nodes, the region schedules are then stitched together and
+// repaired: in topological order, each node is fixed to the cycle chosen for
+// it clamped to its bounds, which are propagated after each node is fixed. So
+// the result is always a valid schedule.
+absl::StatusOr<ScheduleCycleMap> PartitionedMinCutScheduler(
+    FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
+    const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
+    absl::Span<const SchedulingConstraint> constraints,
+    int64_t max_region_size,
+    min_cut::MaxFlowAlgorithm max_flow_algorithm =
+        min_cut::MaxFlowAlgorithm::kAugmentingPath);
 
 // Returns the list of ordering of cycles (pipeline stages) in which to compute
 // min cut of the graph. Each min cut of the graph computes which XLS node
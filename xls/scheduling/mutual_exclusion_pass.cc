@@ -28,20 +28,25 @@
 #include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/numeric/int128.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/logging/vlog_is_on.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/data_structures/graph_coloring.h"
+#include "xls/data_structures/inline_bitmap.h"
+#include "xls/data_structures/maximum_clique.h"
 #include "xls/data_structures/transitive_closure.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
+#include "xls/ir/fingerprint.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/node_iterator.h"
@@ -50,7 +55,10 @@
 #include "xls/ir/source_location.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_helpers.h"
+#include "xls/passes/bdd_function.h"
+#include "xls/passes/bdd_query_engine.h"
 #include "xls/passes/post_dominator_analysis.h"
+#include "xls/passes/query_engine.h"
 #include "xls/passes/token_provenance_analysis.h"
 #include "xls/scheduling/scheduling_options.h"
 #include "xls/scheduling/scheduling_pass.h"
@@ -91,14 +99,6 @@ bool HasIntersection(const absl::flat_hash_set<T>& lhs,
                      [&bigger](T element) { return bigger.contains(element); });
 }
 
-Z3_lbool RunSolver(Z3_context c, Z3_ast asserted) {
-  Z3_solver solver = solvers::z3::CreateSolver(c, 1);
-  Z3_solver_assert(c, solver, asserted);
-  Z3_lbool satisfiable = Z3_solver_check(c, solver);
-  Z3_solver_dec_ref(c, solver);
-  return satisfiable;
-}
-
 // Returns a list of all predicates in a deterministic order, paired with their
 // index in the list.
 std::vector<std::pair<Node*, int64_t>> PredicateNodes(Predicates* p,
@@ -252,12 +252,64 @@ absl::StatusOr<NodeRelation> ComputeMergableEffects(FunctionBase* f) {
   return result;
 }
 
+// Partitions `nodes` into merge classes by repeatedly removing a maximum (or,
+// if `greedy`, a greedily built) clique of what remains of the mutual exclusion
+// graph `neighborhoods`.
+std::vector<absl::flat_hash_set<Node*>> CliqueMergeClasses(
+    absl::Span<Node* const> nodes,
+    const absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>>& neighborhoods,
+    bool greedy) {
+  // Bounds the search for each clique; once exhausted, the largest clique
+  // found so far is used.
+  constexpr int64_t kCliqueSearchNodeBudget = 100000;
+  MaximumCliqueOptions options;
+  options.greedy = greedy;
+  options.node_budget = kCliqueSearchNodeBudget;
+
+  std::vector<absl::flat_hash_set<Node*>> merge_classes;
+  std::vector<Node*> remaining(nodes.begin(), nodes.end());
+  while (!remaining.empty()) {
+    std::vector<InlineBitmap> adjacency(remaining.size(),
+                                        InlineBitmap(remaining.size()));
+    for (int64_t i = 0; i < remaining.size(); ++i) {
+      const absl::flat_hash_set<Node*>& neighbors =
+          neighborhoods.at(remaining[i]);
+      for (int64_t j = 0; j < remaining.size(); ++j) {
+        if (i != j && neighbors.contains(remaining[j])) {
+          adjacency[i].Set(j);
+        }
+      }
+    }
+    MaximumCliqueResult clique = DenseMaximumClique(adjacency, options);
+    XLS_VLOG(4) << absl::StreamFormat(
+        "Merge class of %d out of %d nodes (%s, %d search nodes)",
+        clique.clique.size(), remaining.size(),
+        clique.is_maximum ? "maximum" : "not known to be maximum",
+        clique.nodes_expanded);
+
+    absl::flat_hash_set<Node*> merge_class;
+    for (int64_t index : clique.clique) {
+      merge_class.insert(remaining[index]);
+    }
+    std::vector<Node*> rest;
+    for (Node* node : remaining) {
+      if (!merge_class.contains(node)) {
+        rest.push_back(node);
+      }
+    }
+    merge_classes.push_back(std::move(merge_class));
+    remaining = std::move(rest);
+  }
+  return merge_classes;
+}
+
 // This computes a partition of a subset of all nodes into merge classes.
 // Nodes that are not in this partition can be assumed to be in a merge class of
 // size 1 including only themselves.
 // A merge class is a set of nodes that are all jointly mutually exclusive.
 absl::StatusOr<std::vector<absl::flat_hash_set<Node*>>> ComputeMergeClasses(
-    Predicates* p, FunctionBase* f, const ScheduleCycleMap& scm) {
+    Predicates* p, FunctionBase* f, const ScheduleCycleMap& scm,
+    MutualExclusionPass::MergeStrategy merge_strategy) {
   absl::flat_hash_set<Node*> nodes;
   std::vector<Node*> ordered_nodes;
   absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>> neighborhoods;
@@ -307,6 +359,12 @@ absl::StatusOr<std::vector<absl::flat_hash_set<Node*>>> ComputeMergeClasses(
     }
   }
 
+  if (merge_strategy != MutualExclusionPass::MergeStrategy::kColoring) {
+    return CliqueMergeClasses(
+        ordered_nodes, neighborhoods,
+        merge_strategy == MutualExclusionPass::MergeStrategy::kGreedyClique);
+  }
+
   // The complement of the `neighborhoods` graph
   absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>> inverted_neighborhoods;
 
@@ -324,18 +382,28 @@ absl::StatusOr<std::vector<absl::flat_hash_set<Node*>>> ComputeMergeClasses(
 
   std::vector<int64_t> iota(ordered_nodes.size());
   std::iota(iota.begin(), iota.end(), 0);
+  auto inverted_neighborhood =
+      [&](int64_t node_index) -> absl::flat_hash_set<int64_t> {
+    const absl::flat_hash_set<Node*>& inv_neighbors =
+        inverted_neighborhoods.at(ordered_nodes.at(node_index));
+    absl::flat_hash_set<int64_t> result;
+    for (Node* inv_neighbor : inv_neighbors) {
+      result.insert(node_to_index.at(inv_neighbor));
+    }
+    return result;
+  };
+  // Recursive largest first gives better colorings, but does not scale to
+  // large graphs.
+  constexpr int64_t kMaxRecursiveLargestFirstNodes = 1000;
+  constexpr int64_t kDsaturRecoloringPasses = 20;
   std::vector<absl::flat_hash_set<int64_t>> coloring_indices =
-      RecursiveLargestFirstColoring<int64_t>(
-          absl::flat_hash_set<int64_t>(iota.begin(), iota.end()),
-          [&](int64_t node_index) -> absl::flat_hash_set<int64_t> {
-            absl::flat_hash_set<Node*> inv_neighbors =
-                inverted_neighborhoods.at(ordered_nodes.at(node_index));
-            absl::flat_hash_set<int64_t> result;
-            for (Node* inv_neighbor : inv_neighbors) {
-              result.insert(node_to_index.at(inv_neighbor));
-            }
-            return result;
-          });
+      ordered_nodes.size() <= kMaxRecursiveLargestFirstNodes
+          ? RecursiveLargestFirstColoring<int64_t>(
+                absl::flat_hash_set<int64_t>(iota.begin(), iota.end()),
+                inverted_neighborhood)
+          : DsaturColoring<int64_t>(
+                absl::flat_hash_set<int64_t>(iota.begin(), iota.end()),
+                inverted_neighborhood, kDsaturRecoloringPasses);
 
   std::vector<absl::flat_hash_set<Node*>> coloring;
   for (const absl::flat_hash_set<int64_t>& color_class : coloring_indices) {
@@ -827,28 +895,170 @@ absl::Status AddSelectPredicates(Predicates* p, FunctionBase* f) {
   return absl::OkStatus();
 }
 
-absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f) {
-  if (f->IsBlock()) {
-    return absl::OkStatus();
+// Bound on the number of cached query results, past which the cache is
+// cleared.
+constexpr int64_t kMaxCachedQueryCount = int64_t{1} << 20;
+
+std::optional<bool> MutualExclusionQueryCache::Lookup(absl::uint128 key) const {
+  absl::MutexLock lock(&mutex_);
+  auto it = results_.find(key);
+  if (it == results_.end()) {
+    return std::nullopt;
   }
+  ++hit_count_;
+  return it->second;
+}
 
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<solvers::z3::IrTranslator> translator,
-                       solvers::z3::IrTranslator::CreateAndTranslate(f, true));
+void MutualExclusionQueryCache::Insert(absl::uint128 key, bool result) {
+  absl::MutexLock lock(&mutex_);
+  if (results_.size() >= kMaxCachedQueryCount) {
+    results_.clear();
+  }
+  results_[key] = result;
+}
 
-  Z3_context ctx = translator->ctx();
+namespace {
 
-  solvers::z3::ScopedErrorHandler seh(ctx);
+// Returns the fingerprints of those of `predicates` which may key cached query
+// results. A fingerprint determines the structure of a node's operand cone but
+// does not distinguish distinct nodes of the same structure (e.g. two receives
+// on the same channel with the same operands), which the solver treats as
+// independent. So only predicates whose cones contain no node sharing its
+// fingerprint with another node of `f` are keyed; the cones of two such
+// predicates are then identified by their fingerprints even where they
+// overlap.
+absl::flat_hash_map<Node*, absl::uint128> PredicateCacheFingerprints(
+    FunctionBase* f, absl::Span<const std::pair<Node*, int64_t>> predicates) {
+  FunctionFingerprinter fingerprinter(f);
+  absl::flat_hash_map<absl::uint128, int64_t> fingerprint_counts;
+  for (Node* node : f->nodes()) {
+    ++fingerprint_counts[fingerprinter.NodeFingerprint(node)];
+  }
+  absl::flat_hash_set<Node*> ambiguous_cone;
+  for (Node* node : TopoSort(f)) {
+    if (fingerprint_counts.at(fingerprinter.NodeFingerprint(node)) > 1 ||
+        std::any_of(node->operands().begin(), node->operands().end(),
+                    [&](Node* operand) {
+                      return ambiguous_cone.contains(operand);
+                    })) {
+      ambiguous_cone.insert(node);
+    }
+  }
+  absl::flat_hash_map<Node*, absl::uint128> result;
+  for (const auto& [node, index] : predicates) {
+    if (!ambiguous_cone.contains(node)) {
+      result[node] = fingerprinter.NodeFingerprint(node);
+    }
+  }
+  return result;
+}
+
+absl::uint128 AlwaysFalseQueryKey(absl::uint128 pred) {
+  return FingerprintBuilder().Add("always_false").Add(pred).Finish();
+}
+
+absl::uint128 MutuallyExclusiveQueryKey(absl::uint128 pred_a,
+                                        absl::uint128 pred_b) {
+  return FingerprintBuilder()
+      .Add("mutually_exclusive")
+      .Add(std::min(pred_a, pred_b))
+      .Add(std::max(pred_a, pred_b))
+      .Finish();
+}
+
+}  // namespace
+
+absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
+                                    MutualExclusionQueryCache* cache) {
+  if (f->IsBlock()) {
+    return absl::OkStatus();
+  }
 
   std::vector<std::pair<Node*, int64_t>> predicate_nodes = PredicateNodes(p, f);
+  if (predicate_nodes.empty()) {
+    return absl::OkStatus();
+  }
+
+  // BDDs over the cones of the predicates decide many queries (e.g. those
+  // about complementary predicates) far more cheaply than the solver.
+  absl::flat_hash_set<const Node*> predicate_cones;
+  {
+    std::vector<Node*> stack;
+    for (const auto& [node, index] : predicate_nodes) {
+      stack.push_back(node);
+    }
+    while (!stack.empty()) {
+      Node* popped = stack.back();
+      stack.pop_back();
+      if (predicate_cones.insert(popped).second) {
+        for (Node* operand : popped->operands()) {
+          stack.push_back(operand);
+        }
+      }
+    }
+  }
+  BddQueryEngine query_engine(
+      BddFunction::kDefaultPathLimit,
+      [&](const Node* node) { return predicate_cones.contains(node); });
+  XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
+
+  absl::flat_hash_map<Node*, absl::uint128> cache_fingerprints;
+  if (cache != nullptr) {
+    cache_fingerprints = PredicateCacheFingerprints(f, predicate_nodes);
+  }
+
+  // All solver queries share one translation of `f` and one incremental
+  // solver, which are only created once a query needs them.
+  std::unique_ptr<solvers::z3::IncrementalProver> prover;
+  std::optional<solvers::z3::ScopedErrorHandler> seh;
+  int64_t solver_queries = 0;
+  // Returns whether `formula`, built by `make_formula` from the translations
+  // of the predicates, is satisfiable.
+  auto solve = [&](const std::function<Z3_ast(
+                       solvers::z3::IrTranslator*, Z3_context)>& make_formula)
+      -> absl::StatusOr<Z3_lbool> {
+    if (prover == nullptr) {
+      XLS_ASSIGN_OR_RETURN(prover,
+                           solvers::z3::IncrementalProver::Create(
+                               f, /*allow_unsupported=*/true));
+      seh.emplace(prover->ctx());
+    }
+    ++solver_queries;
+    return prover->Check(make_formula(prover->translator(), prover->ctx()));
+  };
 
-  // Determine for each predicate whether it is always false using Z3.
+  // Determine for each predicate whether it is always false.
   // Dead nodes are mutually exclusive with all other nodes, so this can reduce
   // the runtime  by doing only a linear amount of Z3 calls to remove
   // quadratically many Z3 calls.
   for (const auto& [node, index] : predicate_nodes) {
-    Z3_ast translated = translator->GetTranslation(node);
-    if (RunSolver(ctx, solvers::z3::BitVectorToBoolean(ctx, translated)) ==
-        Z3_L_FALSE) {
+    std::optional<bool> always_false;
+    if (query_engine.IsAllZeros(node)) {
+      always_false = true;
+    } else if (query_engine.IsAllOnes(node)) {
+      always_false = false;
+    }
+    std::optional<absl::uint128> key;
+    if (!always_false.has_value() && cache_fingerprints.contains(node)) {
+      key = AlwaysFalseQueryKey(cache_fingerprints.at(node));
+      always_false = cache->Lookup(*key);
+    }
+    if (!always_false.has_value()) {
+      XLS_ASSIGN_OR_RETURN(
+          Z3_lbool satisfiable,
+          solve([node = node](solvers::z3::IrTranslator* translator,
+                              Z3_context ctx) {
+            return solvers::z3::BitVectorToBoolean(
+                ctx, translator->GetTranslation(node));
+          }));
+      if (satisfiable != Z3_L_UNDEF) {
+        always_false = satisfiable == Z3_L_FALSE;
+        if (key.has_value()) {
+          cache->Insert(*key, *always_false);
+        }
+      }
+    }
+    if (always_false == std::make_optional(true)) {
       XLS_VLOG(3) << "Proved that " << node << " is always false";
       // A constant false node is mutually exclusive with all other nodes.
       for (const auto& [other, other_index] : predicate_nodes) {
@@ -866,6 +1076,7 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f) {
   int64_t known_false = 0;
   int64_t known_true = 0;
   int64_t unknown = 0;
+  int64_t decided_by_bdd = 0;
 
   absl::flat_hash_map<Node*, absl::flat_hash_set<Op>> ops_for_pred;
   for (const auto& [node, index] : predicate_nodes) {
@@ -903,20 +1114,53 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f) {
         continue;
       }
 
-      Z3_ast z3_a = translator->GetTranslation(node_a);
-      Z3_ast z3_b = translator->GetTranslation(node_b);
+      // A BDD may approximate a node by a variable, so it can prove mutual
+      // exclusion but not its absence, except for predicates which are
+      // always true.
+      std::optional<bool> mutually_exclusive;
+      if (query_engine.AtMostOneTrue(
+              {TreeBitLocation(node_a, 0), TreeBitLocation(node_b, 0)})) {
+        mutually_exclusive = true;
+      } else if (query_engine.IsAllOnes(node_a) &&
+                 query_engine.IsAllOnes(node_b)) {
+        mutually_exclusive = false;
+      }
+      if (mutually_exclusive.has_value()) {
+        ++decided_by_bdd;
+      }
 
-      // We try to find out if `a ∧ b` is satisfiable, which is true iff
-      // `a NAND b` is not valid.
-      Z3_ast a_and_b =
-          solvers::z3::BitVectorToBoolean(ctx, Z3_mk_bvand(ctx, z3_a, z3_b));
+      std::optional<absl::uint128> key;
+      if (!mutually_exclusive.has_value() &&
+          cache_fingerprints.contains(node_a) &&
+          cache_fingerprints.contains(node_b)) {
+        key = MutuallyExclusiveQueryKey(cache_fingerprints.at(node_a),
+                                        cache_fingerprints.at(node_b));
+        mutually_exclusive = cache->Lookup(*key);
+      }
 
-      Z3_lbool satisfiable = RunSolver(ctx, a_and_b);
+      if (!mutually_exclusive.has_value()) {
+        // We try to find out if `a ∧ b` is satisfiable, which is true iff
+        // `a NAND b` is not valid.
+        XLS_ASSIGN_OR_RETURN(
+            Z3_lbool satisfiable,
+            solve([node_a = node_a, node_b = node_b](
+                      solvers::z3::IrTranslator* translator, Z3_context ctx) {
+              return solvers::z3::BitVectorToBoolean(
+                  ctx, Z3_mk_bvand(ctx, translator->GetTranslation(node_a),
+                                   translator->GetTranslation(node_b)));
+            }));
+        if (satisfiable != Z3_L_UNDEF) {
+          mutually_exclusive = satisfiable == Z3_L_FALSE;
+          if (key.has_value()) {
+            cache->Insert(*key, *mutually_exclusive);
+          }
+        }
+      }
 
-      if (satisfiable == Z3_L_FALSE) {
+      if (mutually_exclusive == std::make_optional(true)) {
         known_true += 1;
         XLS_RETURN_IF_ERROR(p->MarkMutuallyExclusive(node_a, node_b));
-      } else if (satisfiable == Z3_L_TRUE) {
+      } else if (mutually_exclusive == std::make_optional(false)) {
         known_false += 1;
         XLS_RETURN_IF_ERROR(p->MarkNotMutuallyExclusive(node_a, node_b));
       } else {
@@ -930,8 +1174,12 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f) {
   XLS_VLOG(3) << "known_false = " << known_false;
   XLS_VLOG(3) << "known_true  = " << known_true;
   XLS_VLOG(3) << "unknown     = " << unknown;
+  XLS_VLOG(3) << "decided by BDD = " << decided_by_bdd
+              << ", solver queries = " << solver_queries;
 
-  XLS_RETURN_IF_ERROR(seh.status());
+  if (seh.has_value()) {
+    XLS_RETURN_IF_ERROR(seh->status());
+  }
 
   return absl::OkStatus();
 }
@@ -965,9 +1213,9 @@ absl::StatusOr<bool> MutualExclusionPass::RunOnFunctionBaseInternal(
 
   Predicates p;
   XLS_RETURN_IF_ERROR(AddSendReceivePredicates(&p, f));
-  XLS_RETURN_IF_ERROR(ComputeMutualExclusion(&p, f));
+  XLS_RETURN_IF_ERROR(ComputeMutualExclusion(&p, f, query_cache_.get()));
   XLS_ASSIGN_OR_RETURN(std::vector<absl::flat_hash_set<Node*>> merge_classes,
-                       ComputeMergeClasses(&p, f, scm));
+                       ComputeMergeClasses(&p, f, scm, merge_strategy_));
 
   if (XLS_VLOG_IS_ON(3)) {
     for (const absl::flat_hash_set<Node*>& merge_class : merge_classes) {
@@ -15,9 +15,16 @@
 #ifndef XLS_SCHEDULING_MUTUAL_EXCLUSION_PASS_H_
 #define XLS_SCHEDULING_MUTUAL_EXCLUSION_PASS_H_
 
+#include <cstdint>
+#include <memory>
 #include <optional>
+#include <utility>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/numeric/int128.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/ir/function.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/scheduling/scheduling_pass.h"
@@ -98,24 +105,77 @@ absl::StatusOr<Node*> AddPredicate(Predicates* p, Node* node, Node* pred);
 // another pass.
 absl::Status AddSelectPredicates(Predicates* p, FunctionBase* f);
 
+// Results of the mutual exclusion queries answered by the SMT solver, keyed by
+// the structural fingerprints (see xls/ir/fingerprint.h) of the predicates
+// involved, so that they carry over to later runs on the same or changed IR.
+// Only predicates whose fingerprints identify their operand cones are keyed;
+// see ComputeMutualExclusion. Thread-safe.
+class MutualExclusionQueryCache {
+ public:
+  std::optional<bool> Lookup(absl::uint128 key) const;
+  void Insert(absl::uint128 key, bool result);
+
+  // Number of lookups answered by the cache.
+  int64_t hit_count() const {
+    absl::MutexLock lock(&mutex_);
+    return hit_count_;
+  }
+
+ private:
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<absl::uint128, bool> results_ ABSL_GUARDED_BY(mutex_);
+  mutable int64_t hit_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
 // Use an SMT solver to populate the given `Predicates*` with information about
-// whether nodes are used in a mutually exclusive way.
-absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f);
+// whether nodes are used in a mutually exclusive way. Queries which BDD
+// analysis decides are not sent to the solver. If `cache` is given, solver
+// results are looked up in and added to it.
+absl::Status ComputeMutualExclusion(
+    Predicates* p, FunctionBase* f,
+    MutualExclusionQueryCache* cache = nullptr);
 
 // Pass which merges together nodes that are determined to be mutually exclusive
 // via SMT solver analysis.
 class MutualExclusionPass : public SchedulingOptimizationFunctionBasePass {
  public:
-  MutualExclusionPass()
+  // How nodes are partitioned into classes of mutually exclusive nodes to
+  // merge.
+  enum class MergeStrategy {
+    // Color the complement of the mutual exclusion graph.
+    kColoring,
+    // Repeatedly take a maximum clique of the remaining mutual exclusion
+    // graph, found by a budgeted branch-and-bound search.
+    kMaximumClique,
+    // As kMaximumClique, but take greedily built cliques. This is the
+    // cheapest strategy for procs with many channel operations.
+    kGreedyClique,
+  };
+
+  // Solver results are cached in `query_cache`, which may be shared by several
+  // instances of the pass. If null, the pass uses a cache of its own.
+  explicit MutualExclusionPass(
+      MergeStrategy merge_strategy = MergeStrategy::kColoring,
+      std::shared_ptr<MutualExclusionQueryCache> query_cache = nullptr)
       : SchedulingOptimizationFunctionBasePass(
             "mutual_exclusion",
-            "Merge mutually exclusively used nodes using SMT solver") {}
+            "Merge mutually exclusively used nodes using SMT solver"),
+        merge_strategy_(merge_strategy),
+        query_cache_(query_cache != nullptr
+                         ? std::move(query_cache)
+                         : std::make_shared<MutualExclusionQueryCache>()) {}
   ~MutualExclusionPass() override = default;
 
+  MutualExclusionQueryCache* query_cache() const { return query_cache_.get(); }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       SchedulingUnit<FunctionBase*>* unit, const SchedulingPassOptions& options,
       SchedulingPassResults* results) const override;
+
+ private:
+  MergeStrategy merge_strategy_;
+  std::shared_ptr<MutualExclusionQueryCache> query_cache_;
 };
 
 }  // namespace xls
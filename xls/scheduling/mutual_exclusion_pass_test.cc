@@ -14,6 +14,10 @@
 
 #include "xls/scheduling/mutual_exclusion_pass.h"
 
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
@@ -45,7 +49,9 @@ class MutualExclusionPassTest : public IrTestBase {
  protected:
   MutualExclusionPassTest() = default;
 
-  absl::StatusOr<bool> Run(FunctionBase* f) {
+  absl::StatusOr<bool> Run(FunctionBase* f,
+                           MutualExclusionPass::MergeStrategy merge_strategy =
+                               MutualExclusionPass::MergeStrategy::kColoring) {
     PassResults results;
     bool changed = false;
     bool subpass_changed;
@@ -53,10 +59,11 @@ class MutualExclusionPassTest : public IrTestBase {
       SchedulingUnit<FunctionBase*> unit;
       unit.ir = f;
       SchedulingPassResults scheduling_results;
-      XLS_ASSIGN_OR_RETURN(
-          subpass_changed,
-          MutualExclusionPass().RunOnFunctionBase(
-              &unit, SchedulingPassOptions(), &scheduling_results));
+      XLS_ASSIGN_OR_RETURN(subpass_changed,
+                           MutualExclusionPass(merge_strategy)
+                               .RunOnFunctionBase(&unit,
+                                                  SchedulingPassOptions(),
+                                                  &scheduling_results));
       changed = changed || subpass_changed;
     }
     XLS_ASSIGN_OR_RETURN(
@@ -116,6 +123,52 @@ TEST_F(MutualExclusionPassTest, TwoParallelSends) {
   XLS_EXPECT_OK(VerifyProc(proc, true));
 }
 
+TEST_F(MutualExclusionPassTest, SolverResultsAreCachedAcrossRuns) {
+  // Deciding that the predicates are mutually exclusive takes the solver since
+  // BDDs do not model the multiply.
+  constexpr std::string_view kIr = R"(
+     package test_module
+
+     chan test_channel(
+       bits[32], id=0, kind=streaming, ops=send_only,
+       flow_control=ready_valid, metadata="""""")
+
+     top proc main(__token: token, __state: bits[8], init={0}) {
+       umul.1: bits[8] = umul(__state, __state)
+       literal.2: bits[8] = literal(value=4)
+       literal.3: bits[8] = literal(value=3)
+       eq.4: bits[1] = eq(umul.1, literal.2)
+       eq.5: bits[1] = eq(__state, literal.3)
+       literal.6: bits[32] = literal(value=50)
+       literal.7: bits[32] = literal(value=60)
+       send.8: token = send(__token, literal.6, predicate=eq.4, channel_id=0)
+       send.9: token = send(__token, literal.7, predicate=eq.5, channel_id=0)
+       after_all.10: token = after_all(send.8, send.9)
+       next (after_all.10, umul.1)
+     }
+  )";
+  auto cache = std::make_shared<MutualExclusionQueryCache>();
+  for (int64_t run = 0; run < 2; ++run) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(kIr));
+    XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, p->GetTopAsProc());
+    SchedulingUnit<FunctionBase*> unit;
+    unit.ir = proc;
+    SchedulingPassResults results;
+    EXPECT_THAT(
+        MutualExclusionPass(MutualExclusionPass::MergeStrategy::kColoring,
+                            cache)
+            .RunOnFunctionBase(&unit, SchedulingPassOptions(), &results),
+        IsOkAndHolds(true));
+    EXPECT_EQ(NumberOfOp(proc, Op::kSend), 1);
+    if (run == 0) {
+      EXPECT_EQ(cache->hit_count(), 0);
+    } else {
+      // The second run finds every query of the first in the cache.
+      EXPECT_GT(cache->hit_count(), 0);
+    }
+  }
+}
+
 TEST_F(MutualExclusionPassTest, ThreeParallelSends) {
   XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
      package test_module
@@ -157,6 +210,41 @@ TEST_F(MutualExclusionPassTest, ThreeParallelSends) {
                        *proc->GetNode("literal.4")}));
 }
 
+TEST_F(MutualExclusionPassTest, ThreeParallelSendsWithCliqueStrategies) {
+  for (MutualExclusionPass::MergeStrategy merge_strategy :
+       {MutualExclusionPass::MergeStrategy::kMaximumClique,
+        MutualExclusionPass::MergeStrategy::kGreedyClique}) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
+       package test_module
+
+       chan test_channel(
+         bits[32], id=0, kind=streaming, ops=send_only,
+         flow_control=ready_valid, metadata="""""")
+
+       top proc main(__token: token, __state: bits[2], init={0}) {
+         literal.1: bits[2] = literal(value=1)
+         add.2: bits[2] = add(literal.1, __state)
+         zero_ext.3: bits[32] = zero_ext(add.2, new_bit_count=32)
+         literal.4: bits[32] = literal(value=50)
+         literal.5: bits[32] = literal(value=60)
+         literal.6: bits[32] = literal(value=70)
+         eq.7: bits[1] = eq(zero_ext.3, literal.4)
+         eq.8: bits[1] = eq(zero_ext.3, literal.5)
+         eq.9: bits[1] = eq(zero_ext.3, literal.6)
+         send.10: token = send(__token, literal.4, predicate=eq.7, channel_id=0)
+         send.11: token = send(__token, literal.5, predicate=eq.8, channel_id=0)
+         send.12: token = send(__token, literal.6, predicate=eq.9, channel_id=0)
+         after_all.13: token = after_all(send.10, send.11, send.12)
+         next (after_all.13, add.2)
+       }
+    )"));
+    XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, p->GetTopAsProc());
+    EXPECT_THAT(Run(proc, merge_strategy), IsOkAndHolds(true));
+    EXPECT_EQ(NumberOfOp(proc, Op::kSend), 1);
+    XLS_EXPECT_OK(VerifyProc(proc, true));
+  }
+}
+
 TEST_F(MutualExclusionPassTest, TwoSequentialSends) {
   XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
      package test_module
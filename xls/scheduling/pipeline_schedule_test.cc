@@ -16,6 +16,8 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <memory>
+#include <optional>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -41,6 +43,7 @@
 #include "xls/scheduling/pipeline_schedule.pb.h"
 #include "xls/scheduling/run_pipeline_schedule.h"
 #include "xls/scheduling/scheduling_options.h"
+#include "xls/scheduling/sdc_scheduler.h"
 
 namespace m = ::xls::op_matchers;
 
@@ -1288,5 +1291,124 @@ TEST_F(PipelineScheduleTest, SingleStageSchedule) {
   EXPECT_EQ(schedule.value().nodes_in_cycle(0).size(), 21);
 }
 
+TEST_F(PipelineScheduleTest, SdcSchedulerReusedAcrossClockPeriods) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue a = x;
+  BValue b = y;
+  for (int64_t i = 0; i < 8; ++i) {
+    a = fb.Add(a, y);
+    b = fb.Negate(fb.Subtract(b, a));
+  }
+  fb.Concat({a, b});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  // Sweep the clock period up and down with a single scheduler, as the
+  // clock-period search does; each schedule must be as short as one from a
+  // freshly built scheduler and meet timing.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SDCScheduler> scheduler,
+                           SDCScheduler::Create(func, TestDelayEstimator()));
+  for (int64_t clock_period_ps : {3, 1, 8, 2, 2, 5, 1, 20, 4}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        ScheduleCycleMap cycle_map,
+        scheduler->Schedule(/*pipeline_stages=*/std::nullopt,
+                            clock_period_ps));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        ScheduleCycleMap fresh_cycle_map,
+        SDCSchedule(func, /*pipeline_stages=*/std::nullopt, clock_period_ps,
+                    TestDelayEstimator(), /*constraints=*/{}));
+    PipelineSchedule schedule(func, cycle_map);
+    PipelineSchedule fresh_schedule(func, fresh_cycle_map);
+    EXPECT_EQ(schedule.length(), fresh_schedule.length())
+        << "clock period: " << clock_period_ps;
+    XLS_EXPECT_OK(schedule.VerifyTiming(clock_period_ps, TestDelayEstimator()))
+        << "clock period: " << clock_period_ps;
+  }
+}
+
+TEST_F(PipelineScheduleTest, SdcFirstOrderSolver) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue a = x;
+  BValue b = y;
+  for (int64_t i = 0; i < 8; ++i) {
+    a = fb.Add(a, y);
+    b = fb.Negate(fb.Subtract(b, a));
+  }
+  fb.Concat({a, b});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  // The repaired first-order schedule must be feasible and, as this problem
+  // is small enough for the first-order solver to converge, as short as the
+  // simplex schedule.
+  for (int64_t clock_period_ps : {1, 2, 5}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule simplex_schedule,
+        RunPipelineSchedule(func, TestDelayEstimator(),
+                            SchedulingOptions(SchedulingStrategy::SDC)
+                                .clock_period_ps(clock_period_ps)));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule schedule,
+        RunPipelineSchedule(func, TestDelayEstimator(),
+                            SchedulingOptions(SchedulingStrategy::SDC)
+                                .clock_period_ps(clock_period_ps)
+                                .sdc_solver(SDCSolver::kFirstOrder)));
+    XLS_EXPECT_OK(schedule.Verify()) << "clock period: " << clock_period_ps;
+    XLS_EXPECT_OK(schedule.VerifyTiming(clock_period_ps, TestDelayEstimator()))
+        << "clock period: " << clock_period_ps;
+    EXPECT_EQ(schedule.length(), simplex_schedule.length())
+        << "clock period: " << clock_period_ps;
+  }
+}
+
+TEST_F(PipelineScheduleTest, PartitionedScheduling) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue a = x;
+  BValue b = y;
+  for (int64_t i = 0; i < 20; ++i) {
+    a = fb.Add(a, y);
+    b = fb.Negate(fb.Subtract(b, a));
+  }
+  fb.Concat({a, b});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  // RunPipelineSchedule verifies the schedule, including its timing, so the
+  // stitched region schedules must form a valid schedule whatever the size of
+  // the regions.
+  for (int64_t partition_size : {1, 4, 10, 1000}) {
+    for (int64_t clock_period_ps : {1, 3}) {
+      XLS_ASSERT_OK_AND_ASSIGN(
+          PipelineSchedule min_cut_schedule,
+          RunPipelineSchedule(func, TestDelayEstimator(),
+                              SchedulingOptions(SchedulingStrategy::MIN_CUT)
+                                  .clock_period_ps(clock_period_ps)));
+      XLS_ASSERT_OK_AND_ASSIGN(
+          PipelineSchedule schedule,
+          RunPipelineSchedule(func, TestDelayEstimator(),
+                              SchedulingOptions(SchedulingStrategy::SDC)
+                                  .clock_period_ps(clock_period_ps)
+                                  .schedule_partition_size(partition_size)));
+      EXPECT_EQ(schedule.length(), min_cut_schedule.length())
+          << "partition size: " << partition_size
+          << ", clock period: " << clock_period_ps;
+    }
+  }
+
+  EXPECT_THAT(
+      RunPipelineSchedule(func, TestDelayEstimator(),
+                          SchedulingOptions(SchedulingStrategy::SDC)
+                              .pipeline_stages(4)
+                              .schedule_partition_size(4)),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("requires a clock period")));
+}
+
 }  // namespace
 }  // namespace xls
@@ -19,6 +19,9 @@
 #include <memory>
 #include <optional>
 #include <random>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -31,6 +34,7 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/trace.h"
 #include "xls/data_structures/binary_search.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/fdo/delay_manager.h"
@@ -43,7 +47,9 @@
 #include "xls/ir/op.h"
 #include "xls/scheduling/min_cut_scheduler.h"
 #include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/pipeline_schedule.pb.h"
 #include "xls/scheduling/schedule_bounds.h"
+#include "xls/scheduling/schedule_cache.h"
 #include "xls/scheduling/scheduling_options.h"
 #include "xls/scheduling/sdc_scheduler.h"
 
@@ -213,9 +219,27 @@ absl::StatusOr<int64_t> FindMinimumClockPeriod(
   return min_clk_period_ps;
 }
 
-}  // namespace
+// Returns the clock period to schedule for, i.e., the target clock period
+// less the clock margin.
+absl::StatusOr<int64_t> ClockPeriodWithMargin(
+    const SchedulingOptions& options) {
+  int64_t clock_period_ps = *options.clock_period_ps();
+  if (options.clock_margin_percent().has_value()) {
+    int64_t original_clock_period_ps = clock_period_ps;
+    clock_period_ps -=
+        (clock_period_ps * options.clock_margin_percent().value() + 50) / 100;
+    if (clock_period_ps <= 0) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Clock period non-positive (%dps) after adjusting for margin. "
+          "Original clock period: %dps, clock margin: %d%%",
+          clock_period_ps, original_clock_period_ps,
+          *options.clock_margin_percent()));
+    }
+  }
+  return clock_period_ps;
+}
 
-absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
+absl::StatusOr<PipelineSchedule> RunPipelineScheduleInternal(
     FunctionBase* f, const DelayEstimator& delay_estimator,
     const SchedulingOptions& options,
     const synthesis::Synthesizer* synthesizer) {
@@ -230,36 +254,28 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
                                           : base_delay;
       });
 
-  if (options.worst_case_throughput().has_value()) {
-    f->SetInitiationInterval(*options.worst_case_throughput());
+  // Very large functions are partitioned and scheduled region by region.
+  const bool partitioned = options.schedule_partition_size().has_value() &&
+                           f->node_count() > *options.schedule_partition_size();
+  if (partitioned && !options.clock_period_ps().has_value()) {
+    return absl::InvalidArgumentError(
+        "Partitioned scheduling requires a clock period.");
   }
 
   std::unique_ptr<SDCScheduler> sdc_scheduler;
   if (!options.clock_period_ps().has_value() ||
-      options.strategy() == SchedulingStrategy::SDC) {
+      (options.strategy() == SchedulingStrategy::SDC && !partitioned)) {
     // We currently use the SDC scheduler to determine the minimum clock period
     // (if not specified), even if we're not using it for the final schedule.
     XLS_ASSIGN_OR_RETURN(sdc_scheduler,
-                         SDCScheduler::Create(f, input_delay_added));
+                         SDCScheduler::Create(f, input_delay_added,
+                                              options.sdc_solver()));
     XLS_RETURN_IF_ERROR(sdc_scheduler->AddConstraints(options.constraints()));
   }
 
   int64_t clock_period_ps;
   if (options.clock_period_ps().has_value()) {
-    clock_period_ps = *options.clock_period_ps();
-
-    if (options.clock_margin_percent().has_value()) {
-      int64_t original_clock_period_ps = clock_period_ps;
-      clock_period_ps -=
-          (clock_period_ps * options.clock_margin_percent().value() + 50) / 100;
-      if (clock_period_ps <= 0) {
-        return absl::InvalidArgumentError(absl::StrFormat(
-            "Clock period non-positive (%dps) after adjusting for margin. "
-            "Original clock period: %dps, clock margin: %d%%",
-            clock_period_ps, original_clock_period_ps,
-            *options.clock_margin_percent()));
-      }
-    }
+    XLS_ASSIGN_OR_RETURN(clock_period_ps, ClockPeriodWithMargin(options));
   } else {
     XLS_RET_CHECK(options.pipeline_stages().has_value());
     // A pipeline length is specified, but no target clock period. Determine
@@ -279,7 +295,7 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
   }
 
   ScheduleCycleMap cycle_map;
-  if (options.strategy() == SchedulingStrategy::SDC) {
+  if (options.strategy() == SchedulingStrategy::SDC && !partitioned) {
     // Enable iterative SDC scheduling when iteration number is larger than 1.
     if (options.fdo_iteration_number() > 1) {
       if (!options.clock_period_ps().has_value()) {
@@ -327,13 +343,23 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
                                  input_delay_added);
     XLS_RETURN_IF_ERROR(TightenBounds(bounds, f, options.pipeline_stages()));
 
-    if (options.strategy() == SchedulingStrategy::MIN_CUT) {
-      XLS_ASSIGN_OR_RETURN(cycle_map,
-                           MinCutScheduler(f,
-                                           options.pipeline_stages().value_or(
-                                               bounds.max_lower_bound() + 1),
-                                           clock_period_ps, input_delay_added,
-                                           &bounds, options.constraints()));
+    if (partitioned) {
+      XLS_ASSIGN_OR_RETURN(
+          cycle_map,
+          PartitionedMinCutScheduler(
+              f,
+              options.pipeline_stages().value_or(bounds.max_lower_bound() + 1),
+              clock_period_ps, input_delay_added, &bounds,
+              options.constraints(), *options.schedule_partition_size(),
+              options.min_cut_max_flow_algorithm()));
+    } else if (options.strategy() == SchedulingStrategy::MIN_CUT) {
+      XLS_ASSIGN_OR_RETURN(
+          cycle_map,
+          MinCutScheduler(
+              f,
+              options.pipeline_stages().value_or(bounds.max_lower_bound() + 1),
+              clock_period_ps, input_delay_added, &bounds,
+              options.constraints(), options.min_cut_max_flow_algorithm()));
     } else if (options.strategy() == SchedulingStrategy::RANDOM) {
       std::mt19937_64 gen(options.seed().value_or(0));
 
@@ -374,4 +400,89 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
   return schedule;
 }
 
+// Returns the schedule cached under `key` if there is one and it is valid for
+// `f` and `options`.
+std::optional<PipelineSchedule> LookupCachedSchedule(
+    const ScheduleCache& cache, std::string_view key, FunctionBase* f,
+    const DelayEstimator& delay_estimator, const SchedulingOptions& options) {
+  absl::StatusOr<std::optional<PipelineScheduleProto>> proto =
+      cache.Lookup(key);
+  if (!proto.ok()) {
+    XLS_LOG(WARNING) << "Ignoring schedule cache entry " << key << ": "
+                     << proto.status();
+    return std::nullopt;
+  }
+  if (!proto->has_value()) {
+    return std::nullopt;
+  }
+  absl::StatusOr<PipelineSchedule> schedule =
+      PipelineSchedule::FromProto(f, **proto);
+  absl::Status status = schedule.status();
+  if (status.ok()) {
+    status = schedule->Verify();
+  }
+  if (status.ok() && options.pipeline_stages().has_value() &&
+      schedule->length() != *options.pipeline_stages()) {
+    status = absl::InternalError(
+        absl::StrFormat("expected %d stages, got %d",
+                        *options.pipeline_stages(), schedule->length()));
+  }
+  if (status.ok()) {
+    status = schedule->VerifyConstraints(options.constraints(),
+                                         f->GetInitiationInterval());
+  }
+  if (status.ok() && options.clock_period_ps().has_value()) {
+    absl::StatusOr<int64_t> clock_period_ps = ClockPeriodWithMargin(options);
+    status = clock_period_ps.ok()
+                 ? schedule->VerifyTiming(*clock_period_ps, delay_estimator)
+                 : clock_period_ps.status();
+  }
+  if (!status.ok()) {
+    XLS_LOG(WARNING) << "Ignoring invalid schedule cache entry " << key << ": "
+                     << status;
+    return std::nullopt;
+  }
+  XLS_VLOG(1) << "Using cached schedule " << key << " for " << f->name();
+  return *std::move(schedule);
+}
+
+}  // namespace
+
+absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
+    FunctionBase* f, const DelayEstimator& delay_estimator,
+    const SchedulingOptions& options,
+    const synthesis::Synthesizer* synthesizer) {
+  ScopedTrace trace("RunPipelineSchedule", "scheduling");
+  if (options.worst_case_throughput().has_value()) {
+    f->SetInitiationInterval(*options.worst_case_throughput());
+  }
+
+  // Schedules refined by synthesis feedback depend on more than the inputs
+  // covered by the cache key, so they are not cached.
+  if (options.schedule_cache_dir().empty() ||
+      options.fdo_iteration_number() > 1) {
+    return RunPipelineScheduleInternal(f, delay_estimator, options,
+                                       synthesizer);
+  }
+
+  ScheduleCache cache(options.schedule_cache_dir());
+  XLS_ASSIGN_OR_RETURN(std::string key,
+                       ScheduleCacheKey(f, delay_estimator, options));
+  std::optional<PipelineSchedule> cached =
+      LookupCachedSchedule(cache, key, f, delay_estimator, options);
+  if (cached.has_value()) {
+    return *std::move(cached);
+  }
+
+  XLS_ASSIGN_OR_RETURN(
+      PipelineSchedule schedule,
+      RunPipelineScheduleInternal(f, delay_estimator, options, synthesizer));
+  absl::Status status = cache.Insert(key, schedule.ToProto(delay_estimator));
+  if (!status.ok()) {
+    XLS_LOG(WARNING) << "Failed to cache schedule of " << f->name() << ": "
+                     << status;
+  }
+  return schedule;
+}
+
 }  // namespace xls
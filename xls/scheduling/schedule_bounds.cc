@@ -15,11 +15,13 @@
 #include "xls/scheduling/schedule_bounds.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/logging/logging.h"
@@ -35,6 +37,9 @@ ScheduleBounds::ScheduleBounds(FunctionBase* f, int64_t clock_period_ps,
     : clock_period_ps_(clock_period_ps), delay_estimator_(&delay_estimator) {
   auto topo_sort_it = TopoSort(f);
   topo_sort_ = std::vector<Node*>(topo_sort_it.begin(), topo_sort_it.end());
+  for (int64_t i = 0; i < topo_sort_.size(); ++i) {
+    topo_index_[topo_sort_[i]] = i;
+  }
   Reset();
 }
 
@@ -44,6 +49,9 @@ ScheduleBounds::ScheduleBounds(FunctionBase* f, std::vector<Node*> topo_sort,
     : topo_sort_(std::move(topo_sort)),
       clock_period_ps_(clock_period_ps),
       delay_estimator_(&delay_estimator) {
+  for (int64_t i = 0; i < topo_sort_.size(); ++i) {
+    topo_index_[topo_sort_[i]] = i;
+  }
   Reset();
 }
 
@@ -55,6 +63,19 @@ void ScheduleBounds::Reset() {
     max_lower_bound_ = 0;
     min_upper_bound_ = std::numeric_limits<int64_t>::max();
   }
+  lb_in_cycle_delay_.assign(topo_sort_.size(), 0);
+  ub_in_cycle_delay_.assign(topo_sort_.size(), 0);
+  MarkAllStale();
+}
+
+void ScheduleBounds::MarkAllStale() {
+  // Values no bound can take, so every node is treated as changed.
+  propagated_lb_.assign(topo_sort_.size(), -1);
+  propagated_ub_.assign(topo_sort_.size(), -1);
+  for (int64_t i = 0; i < topo_sort_.size(); ++i) {
+    stale_lower_bounds_.insert(stale_lower_bounds_.end(), i);
+    stale_upper_bounds_.insert(stale_upper_bounds_.end(), i);
+  }
 }
 
 std::string ScheduleBounds::ToString() const {
@@ -72,98 +93,151 @@ std::string ScheduleBounds::ToString() const {
 
 absl::Status ScheduleBounds::PropagateLowerBounds() {
   XLS_VLOG(4) << "PropagateLowerBounds()";
+  // Visit the stale nodes in topological order so each node is visited after
+  // the bounds of its operands are final. A node is recomputed from the bounds
+  // and in-cycle delays of its operands, so its users only need to be
+  // recomputed if either of these changed since they were last propagated.
+  while (!stale_lower_bounds_.empty()) {
+    int64_t index = *stale_lower_bounds_.begin();
+    Node* node = topo_sort_[index];
+    int64_t original_in_cycle_delay = lb_in_cycle_delay_[index];
+    absl::Status status = UpdateLowerBound(index);
+    if (!status.ok()) {
+      // The bounds may be partially updated; recompute everything next time.
+      MarkAllStale();
+      return status;
+    }
+    stale_lower_bounds_.erase(index);
+    if (lb(node) == propagated_lb_[index] &&
+        lb_in_cycle_delay_[index] == original_in_cycle_delay) {
+      continue;
+    }
+    propagated_lb_[index] = lb(node);
+    for (Node* user : node->users()) {
+      stale_lower_bounds_.insert(topo_index_.at(user));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ScheduleBounds::UpdateLowerBound(int64_t index) {
+  Node* node = topo_sort_[index];
   // The delay in picoseconds from the beginning of a cycle to the start of the
   // node.
-  absl::flat_hash_map<Node*, int64_t> in_cycle_delay;
+  int64_t node_in_cycle_delay = 0;
 
-  // Compute the lower bound of each node based on the lower bounds of the
+  // Compute the lower bound of the node based on the lower bounds of the
   // operands of the node.
-  for (Node* node : topo_sort_) {
-    int64_t& node_in_cycle_delay = in_cycle_delay[node];
-    XLS_VLOG(4) << absl::StreamFormat("  %s : original lb=%d", node->GetName(),
-                                      lb(node));
-    for (Node* operand : node->operands()) {
-      int64_t operand_lb = lb(operand);
-      if (operand_lb < lb(node)) {
-        continue;
-      }
-      XLS_ASSIGN_OR_RETURN(int64_t operand_delay,
-                           delay_estimator_->GetOperationDelayInPs(operand));
-      if (operand_lb > lb(node)) {
-        XLS_VLOG(4) << absl::StreamFormat(
-            "    tightened lb to %d because of operand %s", operand_lb,
-            operand->GetName());
-        XLS_RETURN_IF_ERROR(TightenNodeLb(node, operand_lb));
-        node_in_cycle_delay = in_cycle_delay.at(operand) + operand_delay;
-        continue;
-      }
-      node_in_cycle_delay = std::max(
-          node_in_cycle_delay, in_cycle_delay.at(operand) + operand_delay);
+  XLS_VLOG(4) << absl::StreamFormat("  %s : original lb=%d", node->GetName(),
+                                    lb(node));
+  for (Node* operand : node->operands()) {
+    int64_t operand_lb = lb(operand);
+    if (operand_lb < lb(node)) {
+      continue;
     }
-    XLS_ASSIGN_OR_RETURN(int64_t node_delay,
-                         delay_estimator_->GetOperationDelayInPs(node));
-    if (node_delay > clock_period_ps_) {
-      return absl::ResourceExhaustedError(absl::StrFormat(
-          "Node %s has a greater delay (%dps) than the clock period (%dps)",
-          node->GetName(), node_delay, clock_period_ps_));
-    }
-    if (node_in_cycle_delay + node_delay > clock_period_ps_) {
-      // Node does not fit in this cycle. Move to next cycle.
-      XLS_VLOG(4) << "    overflows clock period, tightened lb to "
-                  << lb(node) + 1;
-      XLS_RETURN_IF_ERROR(TightenNodeLb(node, lb(node) + 1));
-      node_in_cycle_delay = 0;
+    XLS_ASSIGN_OR_RETURN(int64_t operand_delay,
+                         delay_estimator_->GetOperationDelayInPs(operand));
+    int64_t operand_in_cycle_delay =
+        lb_in_cycle_delay_[topo_index_.at(operand)];
+    if (operand_lb > lb(node)) {
+      XLS_VLOG(4) << absl::StreamFormat(
+          "    tightened lb to %d because of operand %s", operand_lb,
+          operand->GetName());
+      XLS_RETURN_IF_ERROR(TightenNodeLb(node, operand_lb));
+      node_in_cycle_delay = operand_in_cycle_delay + operand_delay;
+      continue;
     }
+    node_in_cycle_delay =
+        std::max(node_in_cycle_delay, operand_in_cycle_delay + operand_delay);
+  }
+  XLS_ASSIGN_OR_RETURN(int64_t node_delay,
+                       delay_estimator_->GetOperationDelayInPs(node));
+  if (node_delay > clock_period_ps_) {
+    return absl::ResourceExhaustedError(absl::StrFormat(
+        "Node %s has a greater delay (%dps) than the clock period (%dps)",
+        node->GetName(), node_delay, clock_period_ps_));
+  }
+  if (node_in_cycle_delay + node_delay > clock_period_ps_) {
+    // Node does not fit in this cycle. Move to next cycle.
+    XLS_VLOG(4) << "    overflows clock period, tightened lb to "
+                << lb(node) + 1;
+    XLS_RETURN_IF_ERROR(TightenNodeLb(node, lb(node) + 1));
+    node_in_cycle_delay = 0;
   }
+  lb_in_cycle_delay_[index] = node_in_cycle_delay;
   return absl::OkStatus();
 }
 
 absl::Status ScheduleBounds::PropagateUpperBounds() {
   XLS_VLOG(4) << "PropagateUpperBounds()";
+  // Visit the stale nodes in reverse topological order so each node is visited
+  // after the bounds of its users are final.
+  while (!stale_upper_bounds_.empty()) {
+    int64_t index = *stale_upper_bounds_.rbegin();
+    Node* node = topo_sort_[index];
+    int64_t original_in_cycle_delay = ub_in_cycle_delay_[index];
+    absl::Status status = UpdateUpperBound(index);
+    if (!status.ok()) {
+      // The bounds may be partially updated; recompute everything next time.
+      MarkAllStale();
+      return status;
+    }
+    stale_upper_bounds_.erase(index);
+    if (ub(node) == propagated_ub_[index] &&
+        ub_in_cycle_delay_[index] == original_in_cycle_delay) {
+      continue;
+    }
+    propagated_ub_[index] = ub(node);
+    for (Node* operand : node->operands()) {
+      stale_upper_bounds_.insert(topo_index_.at(operand));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ScheduleBounds::UpdateUpperBound(int64_t index) {
+  Node* node = topo_sort_[index];
   // The delay in picoseconds from the end of a cycle to the end of the node.
-  absl::flat_hash_map<Node*, int64_t> in_cycle_delay;
+  int64_t node_in_cycle_delay = 0;
 
-  // Compute the upper bound of each node based on the upper bounds of the
+  // Compute the upper bound of the node based on the upper bounds of the
   // users of the node.
-  for (auto it = topo_sort_.rbegin(); it != topo_sort_.rend(); ++it) {
-    Node* node = *it;
-    int64_t& node_in_cycle_delay = in_cycle_delay[node];
-    XLS_VLOG(4) << absl::StreamFormat("  %s : original ub=%d", node->GetName(),
-                                      ub(node));
-    for (Node* user : node->users()) {
-      int64_t user_ub = ub(user);
-      if (user_ub == std::numeric_limits<int64_t>::max() ||
-          user_ub > ub(node)) {
-        continue;
-      }
-      XLS_ASSIGN_OR_RETURN(int64_t user_delay,
-                           delay_estimator_->GetOperationDelayInPs(user));
-      if (user_ub < ub(node)) {
-        XLS_VLOG(4) << absl::StreamFormat(
-            "    tightened ub to %d because of user %s", user_ub,
-            user->GetName());
-        XLS_RETURN_IF_ERROR(TightenNodeUb(node, user_ub));
-        node_in_cycle_delay = in_cycle_delay.at(user) + user_delay;
-        continue;
-      }
-      node_in_cycle_delay =
-          std::max(node_in_cycle_delay, in_cycle_delay.at(user) + user_delay);
-    }
-    XLS_ASSIGN_OR_RETURN(int64_t node_delay,
-                         delay_estimator_->GetOperationDelayInPs(node));
-    if (node_delay > clock_period_ps_) {
-      return absl::ResourceExhaustedError(absl::StrFormat(
-          "Node %s has a greater delay (%dps) than the clock period (%dps)",
-          node->GetName(), node_delay, clock_period_ps_));
+  XLS_VLOG(4) << absl::StreamFormat("  %s : original ub=%d", node->GetName(),
+                                    ub(node));
+  for (Node* user : node->users()) {
+    int64_t user_ub = ub(user);
+    if (user_ub == std::numeric_limits<int64_t>::max() || user_ub > ub(node)) {
+      continue;
     }
-    if (node_in_cycle_delay + node_delay > clock_period_ps_) {
-      // Node does not fit in this cycle. Move to next cycle.
-      XLS_VLOG(4) << "    overflows clock period, tightened ub to "
-                  << ub(node) - 1;
-      XLS_RETURN_IF_ERROR(TightenNodeUb(node, ub(node) - 1));
-      node_in_cycle_delay = 0;
+    XLS_ASSIGN_OR_RETURN(int64_t user_delay,
+                         delay_estimator_->GetOperationDelayInPs(user));
+    int64_t user_in_cycle_delay = ub_in_cycle_delay_[topo_index_.at(user)];
+    if (user_ub < ub(node)) {
+      XLS_VLOG(4) << absl::StreamFormat(
+          "    tightened ub to %d because of user %s", user_ub,
+          user->GetName());
+      XLS_RETURN_IF_ERROR(TightenNodeUb(node, user_ub));
+      node_in_cycle_delay = user_in_cycle_delay + user_delay;
+      continue;
     }
+    node_in_cycle_delay =
+        std::max(node_in_cycle_delay, user_in_cycle_delay + user_delay);
+  }
+  XLS_ASSIGN_OR_RETURN(int64_t node_delay,
+                       delay_estimator_->GetOperationDelayInPs(node));
+  if (node_delay > clock_period_ps_) {
+    return absl::ResourceExhaustedError(absl::StrFormat(
+        "Node %s has a greater delay (%dps) than the clock period (%dps)",
+        node->GetName(), node_delay, clock_period_ps_));
+  }
+  if (node_in_cycle_delay + node_delay > clock_period_ps_) {
+    // Node does not fit in this cycle. Move to next cycle.
+    XLS_VLOG(4) << "    overflows clock period, tightened ub to "
+                << ub(node) - 1;
+    XLS_RETURN_IF_ERROR(TightenNodeUb(node, ub(node) - 1));
+    node_in_cycle_delay = 0;
   }
+  ub_in_cycle_delay_[index] = node_in_cycle_delay;
   return absl::OkStatus();
 }
 
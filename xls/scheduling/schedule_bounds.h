@@ -22,6 +22,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -38,6 +39,11 @@ namespace sched {
 // An abstraction holding lower and upper bounds for each node in a
 // function. The bounds are constraints on cycles in which a node may be
 // scheduled.
+//
+// Propagation is incremental: the object records which nodes had their bounds
+// tightened since the last propagation, and propagation only visits those nodes
+// and the nodes whose bounds (or in-cycle delays) change as a result. The
+// bounds are the same as those of a propagation over the entire graph.
 class ScheduleBounds {
  public:
   // Returns a object with the lower bounds of each node set to the earliest
@@ -86,7 +92,10 @@ class ScheduleBounds {
           absl::StrFormat("Unable to tighten the lower bound of node %s to %d.",
                           node->GetName(), value));
     }
-    bounds_.at(node).first = std::max(bounds_.at(node).first, value);
+    if (value > lb(node)) {
+      bounds_.at(node).first = value;
+      stale_lower_bounds_.insert(topo_index_.at(node));
+    }
     max_lower_bound_ = std::max(max_lower_bound_, value);
     return absl::OkStatus();
   }
@@ -100,7 +109,10 @@ class ScheduleBounds {
           absl::StrFormat("Unable to tighten the upper bound of node %s to %d.",
                           node->GetName(), value));
     }
-    bounds_.at(node).second = std::min(bounds_.at(node).second, value);
+    if (value < ub(node)) {
+      bounds_.at(node).second = value;
+      stale_upper_bounds_.insert(topo_index_.at(node));
+    }
     min_upper_bound_ = std::min(min_upper_bound_, value);
     return absl::OkStatus();
   }
@@ -121,9 +133,20 @@ class ScheduleBounds {
   absl::Status PropagateUpperBounds();
 
  private:
+  // Recomputes the lower (upper) bound and in-cycle delay of the node at the
+  // given index of the topological sort from those of its operands (users).
+  absl::Status UpdateLowerBound(int64_t index);
+  absl::Status UpdateUpperBound(int64_t index);
+
+  // Marks the bounds of every node as needing propagation.
+  void MarkAllStale();
+
   // A topological sort of the nodes in the function.
   std::vector<Node*> topo_sort_;
 
+  // The index of each node in `topo_sort_`.
+  absl::flat_hash_map<Node*, int64_t> topo_index_;
+
   int64_t clock_period_ps_;
   const DelayEstimator* delay_estimator_;
 
@@ -132,6 +155,24 @@ class ScheduleBounds {
 
   int64_t max_lower_bound_;
   int64_t min_upper_bound_;
+
+  // Indexed by position in `topo_sort_`. The lower (upper) bound of each node
+  // as of the last propagation which visited the node. A user (operand) of the
+  // node must be revisited if the bound has since changed.
+  std::vector<int64_t> propagated_lb_;
+  std::vector<int64_t> propagated_ub_;
+
+  // Indexed by position in `topo_sort_`. The delay in picoseconds from the
+  // beginning of the cycle of the node's lower bound to the start of the node,
+  // and from the end of the node to the end of the cycle of its upper bound,
+  // as of the last propagation which visited the node.
+  std::vector<int64_t> lb_in_cycle_delay_;
+  std::vector<int64_t> ub_in_cycle_delay_;
+
+  // Indices in `topo_sort_` of the nodes whose lower (upper) bounds must be
+  // recomputed by the next propagation.
+  absl::btree_set<int64_t> stale_lower_bounds_;
+  absl::btree_set<int64_t> stale_upper_bounds_;
 };
 
 }  // namespace sched
@@ -164,6 +164,49 @@ TEST_F(ScheduleBoundsTest, SimpleExpressionTightenBounds) {
   EXPECT_EQ(bounds.lb(result.node()), 23);
 }
 
+TEST_F(ScheduleBoundsTest, IncrementalPropagationReachesFixedPoint) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  BValue a = fb.Add(x, y);
+  BValue b = fb.Not(x);
+  for (int64_t i = 0; i < 8; ++i) {
+    BValue c = fb.Add(a, b);
+    b = fb.Not(a);
+    a = c;
+  }
+  fb.Concat({a, b});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  // Fix each node to a cycle in topological order, propagating after each
+  // step as the random scheduler does.
+  XLS_ASSERT_OK_AND_ASSIGN(ScheduleBounds bounds,
+                           ScheduleBounds::ComputeAsapAndAlapBounds(
+                               f, /*clock_period_ps=*/2, delay_estimator_));
+  int64_t step = 0;
+  for (Node* node : TopoSort(f)) {
+    int64_t cycle = (step++ % 2 == 0) ? bounds.lb(node) : bounds.ub(node);
+    XLS_ASSERT_OK(bounds.TightenNodeLb(node, cycle));
+    XLS_ASSERT_OK(bounds.PropagateLowerBounds());
+    XLS_ASSERT_OK(bounds.TightenNodeUb(node, cycle));
+    XLS_ASSERT_OK(bounds.PropagateUpperBounds());
+
+    // Propagating the current bounds over the whole graph must not tighten
+    // them any further.
+    ScheduleBounds full_bounds(f, /*clock_period_ps=*/2, delay_estimator_);
+    for (Node* n : f->nodes()) {
+      XLS_ASSERT_OK(full_bounds.TightenNodeLb(n, bounds.lb(n)));
+      XLS_ASSERT_OK(full_bounds.TightenNodeUb(n, bounds.ub(n)));
+    }
+    XLS_ASSERT_OK(full_bounds.PropagateLowerBounds());
+    XLS_ASSERT_OK(full_bounds.PropagateUpperBounds());
+    for (Node* n : f->nodes()) {
+      EXPECT_EQ(full_bounds.bounds(n), bounds.bounds(n)) << n->GetName();
+    }
+  }
+}
+
 }  // namespace
 }  // namespace sched
 }  // namespace xls
@@ -0,0 +1,142 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/schedule_cache.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/visitor.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/package.h"
+#include "xls/scheduling/pipeline_schedule.pb.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+namespace {
+
+// Bumped whenever the format of the cached schedules or the composition of the
+// keys changes.
+constexpr std::string_view kCacheFormatVersion = "xls-schedule-cache-v1";
+
+std::string ConstraintToString(const SchedulingConstraint& constraint) {
+  return std::visit(
+      Visitor{
+          [](const IOConstraint& c) {
+            return absl::StrFormat("io:%s:%d:%s:%d:%d:%d", c.SourceChannel(),
+                                   static_cast<int>(c.SourceDirection()),
+                                   c.TargetChannel(),
+                                   static_cast<int>(c.TargetDirection()),
+                                   c.MinimumLatency(), c.MaximumLatency());
+          },
+          [](const NodeInCycleConstraint& c) {
+            return absl::StrFormat("node_in_cycle:%s:%d",
+                                   c.GetNode()->GetName(), c.GetCycle());
+          },
+          [](const DifferenceConstraint& c) {
+            return absl::StrFormat("difference:%s:%s:%d", c.GetA()->GetName(),
+                                   c.GetB()->GetName(), c.GetMaxDifference());
+          },
+          [](const RecvsFirstSendsLastConstraint&) {
+            return std::string("recvs_first_sends_last");
+          },
+          [](const BackedgeConstraint&) { return std::string("backedge"); },
+          [](const SendThenRecvConstraint& c) {
+            return absl::StrFormat("send_then_recv:%d", c.MinimumLatency());
+          },
+      },
+      constraint);
+}
+
+}  // namespace
+
+absl::StatusOr<std::optional<PipelineScheduleProto>> ScheduleCache::Lookup(
+    std::string_view key) const {
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> contents, cache_.Lookup(key));
+  if (!contents.has_value()) {
+    return std::nullopt;
+  }
+  PipelineScheduleProto schedule;
+  if (!schedule.ParseFromString(*contents)) {
+    return absl::DataLossError(absl::StrFormat(
+        "Failed to parse cached schedule %s", cache_.EntryPath(key).string()));
+  }
+  return schedule;
+}
+
+absl::Status ScheduleCache::Insert(
+    std::string_view key, const PipelineScheduleProto& schedule) const {
+  return cache_.Insert(key, schedule.SerializeAsString());
+}
+
+absl::StatusOr<std::string> ScheduleCacheKey(
+    FunctionBase* f, const DelayEstimator& delay_estimator,
+    const SchedulingOptions& options) {
+  CacheKeyBuilder builder(kCacheFormatVersion);
+  builder.Add(f->DumpIr());
+  builder.Add(f->GetInitiationInterval());
+  if (f->IsProc()) {
+    // Channel declarations live in the package but affect how the proc's sends
+    // and receives are scheduled.
+    for (Channel* channel : f->package()->channels()) {
+      builder.Add(channel->ToString());
+    }
+  }
+
+  builder.Add(delay_estimator.name());
+  for (Node* node : TopoSort(f)) {
+    XLS_ASSIGN_OR_RETURN(int64_t delay,
+                         delay_estimator.GetOperationDelayInPs(node));
+    builder.Add(absl::StrCat(node->GetName(), ":", delay));
+  }
+
+  builder.Add(absl::StrCat(static_cast<int>(options.strategy())));
+  builder.Add(options.clock_period_ps());
+  builder.Add(options.pipeline_stages());
+  builder.Add(options.clock_margin_percent());
+  builder.Add(options.period_relaxation_percent());
+  builder.Add(options.worst_case_throughput());
+  builder.Add(options.additional_input_delay_ps());
+  builder.Add(options.ffi_fallback_delay_ps());
+  builder.Add(options.seed());
+  builder.Add(options.mutual_exclusion_z3_rlimit());
+  builder.Add(absl::StrCat(static_cast<int>(options.sdc_solver())));
+  builder.Add(options.schedule_partition_size());
+  for (const SchedulingConstraint& constraint : options.constraints()) {
+    builder.Add(ConstraintToString(constraint));
+  }
+  builder.Add(absl::StrCat(
+      options.fdo_iteration_number(), ":",
+      options.fdo_delay_driven_path_number(), ":",
+      options.fdo_fanout_driven_path_number(), ":",
+      options.fdo_refinement_stochastic_ratio(), ":",
+      static_cast<int>(options.fdo_path_evaluate_strategy()), ":",
+      options.fdo_synthesizer_name()));
+  return builder.Finish();
+}
+
+}  // namespace xls
@@ -0,0 +1,70 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SCHEDULING_SCHEDULE_CACHE_H_
+#define XLS_SCHEDULING_SCHEDULE_CACHE_H_
+
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/scheduling/pipeline_schedule.pb.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+
+// An on-disk cache of pipeline schedules, used by RunPipelineSchedule to avoid
+// rescheduling functions which are unchanged since a previous run. Each entry
+// is a file in the cache directory named after its key and holding a binary
+// PipelineScheduleProto. Keys are hex SHA-256 digests (see ScheduleCacheKey),
+// so entries never need to be invalidated; stale entries may simply be deleted.
+class ScheduleCache {
+ public:
+  explicit ScheduleCache(std::filesystem::path directory)
+      : cache_(std::move(directory), ".schedule.pb") {}
+
+  const std::filesystem::path& directory() const { return cache_.directory(); }
+
+  // Returns the schedule cached under `key`, or std::nullopt if there is none.
+  absl::StatusOr<std::optional<PipelineScheduleProto>> Lookup(
+      std::string_view key) const;
+
+  // Caches `schedule` under `key`, replacing any existing entry (see
+  // ContentAddressedCache::Insert).
+  absl::Status Insert(std::string_view key,
+                      const PipelineScheduleProto& schedule) const;
+
+ private:
+  ContentAddressedCache cache_;
+};
+
+// Returns the cache key of the schedule of `f` computed with `delay_estimator`
+// and `options`. The key covers the IR of `f` (including node names, which the
+// cached schedule refers to), its initiation interval, the name of the delay
+// estimator and the delay it estimates for each node, and every option which
+// affects the schedule.
+absl::StatusOr<std::string> ScheduleCacheKey(
+    FunctionBase* f, const DelayEstimator& delay_estimator,
+    const SchedulingOptions& options);
+
+}  // namespace xls
+
+#endif  // XLS_SCHEDULING_SCHEDULE_CACHE_H_
@@ -0,0 +1,158 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/schedule_cache.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/pipeline_schedule.pb.h"
+#include "xls/scheduling/run_pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+
+// Returns the paths of the entries in the cache directory.
+std::vector<std::filesystem::path> CacheEntries(
+    const std::filesystem::path& directory) {
+  std::vector<std::filesystem::path> entries;
+  for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+    entries.push_back(entry.path());
+  }
+  return entries;
+}
+
+class ScheduleCacheTest : public IrTestBase {
+ protected:
+  // Builds a chain of `length` negations.
+  Function* BuildChain(Package* p, int64_t length) {
+    FunctionBuilder fb(TestName(), p);
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    for (int64_t i = 0; i < length; ++i) {
+      x = fb.Negate(x);
+    }
+    return fb.Build().value();
+  }
+};
+
+TEST_F(ScheduleCacheTest, LookupAndInsert) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  ScheduleCache cache(temp_dir.path() / "cache");
+  EXPECT_THAT(cache.Lookup("abc"), IsOkAndHolds(std::nullopt));
+
+  PipelineScheduleProto proto;
+  proto.set_function("foo");
+  proto.add_stages()->set_stage(0);
+  XLS_ASSERT_OK(cache.Insert("abc", proto));
+  XLS_ASSERT_OK_AND_ASSIGN(std::optional<PipelineScheduleProto> cached,
+                           cache.Lookup("abc"));
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_EQ(cached->function(), "foo");
+  EXPECT_EQ(cached->stages_size(), 1);
+  EXPECT_THAT(cache.Lookup("abd"), IsOkAndHolds(std::nullopt));
+}
+
+TEST_F(ScheduleCacheTest, KeyDependsOnIrDelaysAndOptions) {
+  auto p = CreatePackage();
+  Function* f = BuildChain(p.get(), 4);
+  Function* g = BuildChain(p.get(), 5);
+  SchedulingOptions options(SchedulingStrategy::SDC);
+  options.clock_period_ps(2);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string key, ScheduleCacheKey(f, TestDelayEstimator(), options));
+  EXPECT_THAT(ScheduleCacheKey(f, TestDelayEstimator(), options),
+              IsOkAndHolds(key));
+
+  // The cache directory does not affect the schedule.
+  SchedulingOptions with_cache_dir = options;
+  with_cache_dir.schedule_cache_dir("/some/dir");
+  EXPECT_THAT(ScheduleCacheKey(f, TestDelayEstimator(), with_cache_dir),
+              IsOkAndHolds(key));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string other_function_key,
+                           ScheduleCacheKey(g, TestDelayEstimator(), options));
+  EXPECT_NE(other_function_key, key);
+
+  SchedulingOptions other_clock = options;
+  other_clock.clock_period_ps(3);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string other_clock_key,
+      ScheduleCacheKey(f, TestDelayEstimator(), other_clock));
+  EXPECT_NE(other_clock_key, key);
+
+  DecoratingDelayEstimator slower(
+      "test", TestDelayEstimator(),
+      [](Node*, int64_t delay) { return delay + 1; });
+  XLS_ASSERT_OK_AND_ASSIGN(std::string other_delays_key,
+                           ScheduleCacheKey(f, slower, options));
+  EXPECT_NE(other_delays_key, key);
+}
+
+TEST_F(ScheduleCacheTest, RunPipelineScheduleUsesCache) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path cache_dir = temp_dir.path() / "cache";
+  auto p = CreatePackage();
+  Function* f = BuildChain(p.get(), 6);
+  SchedulingOptions options(SchedulingStrategy::SDC);
+  options.clock_period_ps(2).schedule_cache_dir(cache_dir.string());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(f, TestDelayEstimator(), options));
+  EXPECT_EQ(schedule.length(), 3);
+  std::vector<std::filesystem::path> entries = CacheEntries(cache_dir);
+  ASSERT_EQ(entries.size(), 1);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule cached_schedule,
+      RunPipelineSchedule(f, TestDelayEstimator(), options));
+  EXPECT_EQ(cached_schedule.ToString(), schedule.ToString());
+
+  // An entry which does not meet timing is ignored and replaced.
+  XLS_ASSERT_OK_AND_ASSIGN(PipelineSchedule single_stage,
+                           PipelineSchedule::SingleStage(f));
+  XLS_ASSERT_OK(SetFileContents(
+      entries.front(),
+      single_stage.ToProto(TestDelayEstimator()).SerializeAsString()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule rescheduled,
+      RunPipelineSchedule(f, TestDelayEstimator(), options));
+  EXPECT_EQ(rescheduled.ToString(), schedule.ToString());
+
+  // So is an entry which cannot be parsed.
+  XLS_ASSERT_OK(SetFileContents(entries.front(), "garbage"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      rescheduled, RunPipelineSchedule(f, TestDelayEstimator(), options));
+  EXPECT_EQ(rescheduled.ToString(), schedule.ToString());
+  EXPECT_EQ(CacheEntries(cache_dir).size(), 1);
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,227 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/schedule_sweep.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/run_pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+namespace {
+
+absl::StatusOr<std::optional<int64_t>> ParseTargetValue(
+    std::string_view value, std::string_view text) {
+  if (value == "*") {
+    return std::nullopt;
+  }
+  int64_t result;
+  if (!absl::SimpleAtoi(value, &result) || result <= 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Invalid schedule sweep target `%s`; expected a positive integer or "
+        "`*`, got `%s`",
+        text, value));
+  }
+  return result;
+}
+
+// Returns the longest combinational path through any stage of `schedule`.
+absl::StatusOr<int64_t> ComputeStageCriticalPath(
+    const PipelineSchedule& schedule, const DelayEstimator& delay_estimator) {
+  int64_t critical_path_ps = 0;
+  absl::flat_hash_map<Node*, int64_t> path_delays;
+  for (Node* node : TopoSort(schedule.function_base())) {
+    int64_t start = 0;
+    for (Node* operand : node->operands()) {
+      if (schedule.cycle(operand) == schedule.cycle(node)) {
+        start = std::max(start, path_delays.at(operand));
+      }
+    }
+    XLS_ASSIGN_OR_RETURN(int64_t delay,
+                         delay_estimator.GetOperationDelayInPs(node));
+    path_delays[node] = start + delay;
+    critical_path_ps = std::max(critical_path_ps, start + delay);
+  }
+  return critical_path_ps;
+}
+
+absl::Status ComputeMetrics(const DelayEstimator& delay_estimator,
+                            ScheduleSweepResult& result) {
+  const PipelineSchedule& schedule = result.schedule.value();
+  result.pipeline_stages = schedule.length();
+  result.register_bits = schedule.CountFinalInteriorPipelineRegisters();
+  XLS_ASSIGN_OR_RETURN(result.critical_path_ps,
+                       ComputeStageCriticalPath(schedule, delay_estimator));
+  if (result.target.clock_period_ps.has_value()) {
+    result.slack_ps =
+        *result.target.clock_period_ps - result.critical_path_ps;
+  }
+  return absl::OkStatus();
+}
+
+bool Dominates(const ScheduleSweepResult& a, const ScheduleSweepResult& b) {
+  return a.pipeline_stages <= b.pipeline_stages &&
+         a.register_bits <= b.register_bits &&
+         a.critical_path_ps <= b.critical_path_ps &&
+         (a.pipeline_stages < b.pipeline_stages ||
+          a.register_bits < b.register_bits ||
+          a.critical_path_ps < b.critical_path_ps);
+}
+
+}  // namespace
+
+std::string ScheduleSweepTarget::ToString() const {
+  return absl::StrCat(
+      clock_period_ps.has_value() ? absl::StrCat(*clock_period_ps) : "*", ":",
+      pipeline_stages.has_value() ? absl::StrCat(*pipeline_stages) : "*");
+}
+
+absl::StatusOr<ScheduleSweepTarget> ParseScheduleSweepTarget(
+    std::string_view text) {
+  std::vector<std::string_view> components = absl::StrSplit(text, ':');
+  if (components.size() != 2) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Invalid schedule sweep target `%s`; expected "
+        "`CLOCK_PERIOD_PS:PIPELINE_STAGES`",
+        text));
+  }
+  ScheduleSweepTarget target;
+  XLS_ASSIGN_OR_RETURN(target.clock_period_ps,
+                       ParseTargetValue(components[0], text));
+  XLS_ASSIGN_OR_RETURN(target.pipeline_stages,
+                       ParseTargetValue(components[1], text));
+  if (!target.clock_period_ps.has_value() &&
+      !target.pipeline_stages.has_value()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Invalid schedule sweep target `%s`; a clock period or a number of "
+        "pipeline stages must be given",
+        text));
+  }
+  return target;
+}
+
+absl::StatusOr<std::vector<ScheduleSweepResult>> RunScheduleSweep(
+    FunctionBase* f, const DelayEstimator& delay_estimator,
+    const SchedulingOptions& options,
+    absl::Span<const ScheduleSweepTarget> targets, int64_t thread_count) {
+  // Estimate every delay up front so the workers only read the cache, and so
+  // that an estimation error is reported once rather than for each target.
+  CachingDelayEstimator cached_delays("schedule_sweep", delay_estimator);
+  for (Node* node : f->nodes()) {
+    XLS_RETURN_IF_ERROR(cached_delays.GetOperationDelayInPs(node).status());
+  }
+
+  // RunPipelineSchedule sets the initiation interval of `f`, which would race
+  // between workers; set it once here instead.
+  SchedulingOptions target_options = options;
+  if (options.worst_case_throughput().has_value()) {
+    f->SetInitiationInterval(*options.worst_case_throughput());
+    target_options.clear_worst_case_throughput();
+  }
+
+  // The schedulers sort `f`, which fills its topological order cache. Sorting
+  // is safe concurrently, but filling the cache here leaves the workers only
+  // reading it.
+  TopoSort(f);
+  ReverseTopoSort(f);
+
+  std::vector<ScheduleSweepResult> results(targets.size());
+  if (targets.empty()) {
+    return results;
+  }
+  auto schedule_target = [&](int64_t i) {
+    ScheduleSweepResult& result = results[i];
+    result.target = targets[i];
+    SchedulingOptions scheduling_options = target_options;
+    scheduling_options.clear_clock_period_ps().clear_pipeline_stages();
+    if (targets[i].clock_period_ps.has_value()) {
+      scheduling_options.clock_period_ps(*targets[i].clock_period_ps);
+    }
+    if (targets[i].pipeline_stages.has_value()) {
+      scheduling_options.pipeline_stages(*targets[i].pipeline_stages);
+    }
+    result.schedule = RunPipelineSchedule(f, cached_delays, scheduling_options);
+    if (result.schedule.ok()) {
+      absl::Status status = ComputeMetrics(cached_delays, result);
+      if (!status.ok()) {
+        result.schedule = status;
+      }
+    }
+  };
+  thread_count = std::clamp<int64_t>(thread_count, 1, targets.size());
+  if (thread_count == 1) {
+    for (int64_t i = 0; i < targets.size(); ++i) {
+      schedule_target(i);
+    }
+  } else {
+    // The calling thread schedules targets too.
+    ThreadPool pool(thread_count - 1);
+    pool.ParallelFor(0, targets.size(), schedule_target);
+  }
+
+  for (ScheduleSweepResult& result : results) {
+    if (!result.schedule.ok()) {
+      continue;
+    }
+    result.pareto_optimal = std::none_of(
+        results.begin(), results.end(), [&](const ScheduleSweepResult& other) {
+          return other.schedule.ok() && Dominates(other, result);
+        });
+  }
+  return results;
+}
+
+std::string ScheduleSweepTable(absl::Span<const ScheduleSweepResult> results) {
+  std::string table;
+  absl::StrAppendFormat(&table, "%-16s %6s %10s %12s %10s %6s\n", "target",
+                        "stages", "registers", "critical_ps", "slack_ps",
+                        "pareto");
+  for (const ScheduleSweepResult& result : results) {
+    if (!result.schedule.ok()) {
+      absl::StrAppendFormat(&table, "%-16s error: %s\n",
+                            result.target.ToString(),
+                            result.schedule.status().message());
+      continue;
+    }
+    absl::StrAppendFormat(
+        &table, "%-16s %6d %10d %12d %10s %6s\n", result.target.ToString(),
+        result.pipeline_stages, result.register_bits, result.critical_path_ps,
+        result.slack_ps.has_value() ? absl::StrCat(*result.slack_ps) : "-",
+        result.pareto_optimal ? "*" : "");
+  }
+  return table;
+}
+
+}  // namespace xls
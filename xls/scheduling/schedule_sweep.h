@@ -0,0 +1,93 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SCHEDULING_SCHEDULE_SWEEP_H_
+#define XLS_SCHEDULING_SCHEDULE_SWEEP_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+
+// A design point to schedule for. At least one of the clock period and the
+// number of pipeline stages must be given; the scheduler picks the other as it
+// would if only that one were specified in the scheduling options.
+struct ScheduleSweepTarget {
+  std::optional<int64_t> clock_period_ps;
+  std::optional<int64_t> pipeline_stages;
+
+  std::string ToString() const;
+};
+
+// Parses a target of the form "CLOCK_PERIOD_PS:PIPELINE_STAGES" where either
+// (but not both) of the values may be "*" to leave it unspecified. For example,
+// "500:*" or "*:4" or "500:4".
+absl::StatusOr<ScheduleSweepTarget> ParseScheduleSweepTarget(
+    std::string_view text);
+
+// The result of scheduling for one target of a sweep.
+struct ScheduleSweepResult {
+  ScheduleSweepTarget target;
+
+  // The schedule, or the error if the target cannot be met.
+  absl::StatusOr<PipelineSchedule> schedule;
+
+  // Metrics of the schedule; only meaningful if `schedule` is ok.
+  int64_t pipeline_stages = 0;
+  // Total number of bits in interior pipeline registers.
+  int64_t register_bits = 0;
+  // Longest combinational path through any stage.
+  int64_t critical_path_ps = 0;
+  // The target clock period minus `critical_path_ps`, if a clock period was
+  // given.
+  std::optional<int64_t> slack_ps;
+
+  // Whether no other successful result has at most as many stages, register
+  // bits and critical-path delay, and fewer of at least one of them.
+  bool pareto_optimal = false;
+};
+
+// Schedules `f` for each of `targets` using `thread_count` threads. Each target
+// is scheduled with a copy of `options` in which the clock period and number
+// of pipeline stages are replaced by the target's. The operation delays are
+// computed once and shared by all targets.
+//
+// Unlike the scheduling pass pipeline this only schedules `f`. Its initiation
+// interval and cached topological orders are set before any target is
+// scheduled, so targets can be scheduled concurrently. Failing to meet a target
+// is reported in its result; an error is returned only if the delays cannot be
+// estimated. Results are in the order of `targets`.
+absl::StatusOr<std::vector<ScheduleSweepResult>> RunScheduleSweep(
+    FunctionBase* f, const DelayEstimator& delay_estimator,
+    const SchedulingOptions& options,
+    absl::Span<const ScheduleSweepTarget> targets, int64_t thread_count = 1);
+
+// Returns a table with one row per result listing the target, the number of
+// stages, the register bits, the critical path, the slack and whether the
+// result is Pareto optimal, or the error of a failed target.
+std::string ScheduleSweepTable(absl::Span<const ScheduleSweepResult> results);
+
+}  // namespace xls
+
+#endif  // XLS_SCHEDULING_SCHEDULE_SWEEP_H_
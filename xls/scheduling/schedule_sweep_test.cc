@@ -0,0 +1,128 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/schedule_sweep.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/run_pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+namespace {
+
+using ::testing::HasSubstr;
+using status_testing::StatusIs;
+
+class ScheduleSweepTest : public IrTestBase {};
+
+TEST_F(ScheduleSweepTest, ParseTarget) {
+  XLS_ASSERT_OK_AND_ASSIGN(ScheduleSweepTarget target,
+                           ParseScheduleSweepTarget("500:4"));
+  EXPECT_EQ(target.clock_period_ps, 500);
+  EXPECT_EQ(target.pipeline_stages, 4);
+  EXPECT_EQ(target.ToString(), "500:4");
+
+  XLS_ASSERT_OK_AND_ASSIGN(target, ParseScheduleSweepTarget("*:3"));
+  EXPECT_EQ(target.clock_period_ps, std::nullopt);
+  EXPECT_EQ(target.pipeline_stages, 3);
+  EXPECT_EQ(target.ToString(), "*:3");
+
+  EXPECT_THAT(ParseScheduleSweepTarget("*:*"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("must be given")));
+  EXPECT_THAT(ParseScheduleSweepTarget("500"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(ParseScheduleSweepTarget("500:-1"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST_F(ScheduleSweepTest, MatchesIndividualSchedules) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  for (int64_t i = 0; i < 6; ++i) {
+    x = fb.Negate(fb.Add(x, y));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  std::vector<ScheduleSweepTarget> targets = {
+      {.clock_period_ps = 1},
+      {.clock_period_ps = 2},
+      {.clock_period_ps = 4},
+      {.pipeline_stages = 3},
+      {.clock_period_ps = 2, .pipeline_stages = 8},
+      // Cannot be met.
+      {.clock_period_ps = 1, .pipeline_stages = 2},
+  };
+  SchedulingOptions options(SchedulingStrategy::SDC);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<ScheduleSweepResult> results,
+      RunScheduleSweep(f, TestDelayEstimator(), options, targets,
+                       /*thread_count=*/3));
+  ASSERT_EQ(results.size(), targets.size());
+
+  for (int64_t i = 0; i < targets.size(); ++i) {
+    const ScheduleSweepResult& result = results[i];
+    EXPECT_EQ(result.target.ToString(), targets[i].ToString());
+    SchedulingOptions target_options = options;
+    if (targets[i].clock_period_ps.has_value()) {
+      target_options.clock_period_ps(*targets[i].clock_period_ps);
+    }
+    if (targets[i].pipeline_stages.has_value()) {
+      target_options.pipeline_stages(*targets[i].pipeline_stages);
+    }
+    absl::StatusOr<PipelineSchedule> expected =
+        RunPipelineSchedule(f, TestDelayEstimator(), target_options);
+    ASSERT_EQ(result.schedule.ok(), expected.ok()) << targets[i].ToString();
+    if (!expected.ok()) {
+      EXPECT_FALSE(result.pareto_optimal);
+      continue;
+    }
+    EXPECT_EQ(result.pipeline_stages, expected->length());
+    EXPECT_EQ(result.register_bits,
+              expected->CountFinalInteriorPipelineRegisters());
+    if (targets[i].clock_period_ps.has_value()) {
+      ASSERT_TRUE(result.slack_ps.has_value());
+      EXPECT_EQ(*result.slack_ps,
+                *targets[i].clock_period_ps - result.critical_path_ps);
+      EXPECT_GE(*result.slack_ps, 0);
+    } else {
+      EXPECT_FALSE(result.slack_ps.has_value());
+    }
+  }
+
+  // Eight stages at a 2ps clock use more stages and registers than the plain
+  // 2ps target, with no shorter critical path.
+  EXPECT_TRUE(results[1].pareto_optimal);
+  EXPECT_FALSE(results[4].pareto_optimal);
+
+  std::string table = ScheduleSweepTable(results);
+  EXPECT_THAT(table, HasSubstr("registers"));
+  EXPECT_THAT(table, HasSubstr("1:2"));
+  EXPECT_THAT(table, HasSubstr("error"));
+}
+
+}  // namespace
+}  // namespace xls
@@ -25,6 +25,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
+#include "xls/data_structures/min_cut.h"
 #include "xls/ir/node.h"
 
 namespace xls {
@@ -53,6 +54,18 @@ enum class PathEvaluateStrategy : int8_t {
   WINDOW,
 };
 
+// The linear programming solver used by the SDC scheduler.
+enum class SDCSolver : int8_t {
+  // A simplex solver (GLOP), which finds exact vertex solutions. The default.
+  kSimplex,
+
+  // A first-order primal-dual solver (PDLP), which needs no matrix
+  // factorization and so scales to much larger problems than simplex, at the
+  // cost of only approximately optimal solutions. Its solutions are rounded
+  // and repaired into a feasible integral schedule.
+  kFirstOrder,
+};
+
 enum class IODirection : int8_t { kReceive, kSend };
 
 // This represents a constraint saying that interactions on the given
@@ -196,7 +209,10 @@ class SchedulingOptions {
         fdo_delay_driven_path_number_(0),
         fdo_fanout_driven_path_number_(0),
         fdo_refinement_stochastic_ratio_(1.0),
-        fdo_path_evaluate_strategy_(PathEvaluateStrategy::WINDOW) {}
+        fdo_path_evaluate_strategy_(PathEvaluateStrategy::WINDOW),
+        min_cut_max_flow_algorithm_(
+            min_cut::MaxFlowAlgorithm::kAugmentingPath),
+        sdc_solver_(SDCSolver::kSimplex) {}
 
   // Returns the scheduling strategy.
   SchedulingStrategy strategy() const { return strategy_; }
@@ -206,6 +222,10 @@ class SchedulingOptions {
     clock_period_ps_ = value;
     return *this;
   }
+  SchedulingOptions& clear_clock_period_ps() {
+    clock_period_ps_.reset();
+    return *this;
+  }
   std::optional<int64_t> clock_period_ps() const { return clock_period_ps_; }
 
   // Sets/gets the target number of stages in the pipeline.
@@ -213,6 +233,10 @@ class SchedulingOptions {
     pipeline_stages_ = value;
     return *this;
   }
+  SchedulingOptions& clear_pipeline_stages() {
+    pipeline_stages_.reset();
+    return *this;
+  }
   std::optional<int64_t> pipeline_stages() const { return pipeline_stages_; }
 
   // Sets/gets the percentage of clock period to set aside as a margin to ensure
@@ -243,6 +267,10 @@ class SchedulingOptions {
     worst_case_throughput_ = value;
     return *this;
   }
+  SchedulingOptions& clear_worst_case_throughput() {
+    worst_case_throughput_.reset();
+    return *this;
+  }
   std::optional<int64_t> worst_case_throughput() const {
     return worst_case_throughput_;
   }
@@ -357,6 +385,48 @@ class SchedulingOptions {
   }
   std::string fdo_synthesizer_name() const { return fdo_synthesizer_name_; }
 
+  // Sets/gets the max-flow algorithm used to compute the min cuts of the
+  // MIN_CUT strategy. All algorithms produce the same schedule.
+  SchedulingOptions& min_cut_max_flow_algorithm(
+      min_cut::MaxFlowAlgorithm value) {
+    min_cut_max_flow_algorithm_ = value;
+    return *this;
+  }
+  min_cut::MaxFlowAlgorithm min_cut_max_flow_algorithm() const {
+    return min_cut_max_flow_algorithm_;
+  }
+
+  // Sets/gets the LP solver used by the SDC strategy (and to find the minimum
+  // clock period).
+  SchedulingOptions& sdc_solver(SDCSolver value) {
+    sdc_solver_ = value;
+    return *this;
+  }
+  SDCSolver sdc_solver() const { return sdc_solver_; }
+
+  // Sets/gets the size above which functions are scheduled by partitioning:
+  // functions with more nodes are partitioned into regions of at most this
+  // many nodes, which are scheduled in parallel with min cuts and stitched
+  // together (see PartitionedMinCutScheduler), whatever the strategy. This
+  // makes scheduling time near-linear in the size of the function, at the cost
+  // of some pipeline registers. Requires a clock period.
+  SchedulingOptions& schedule_partition_size(int64_t value) {
+    schedule_partition_size_ = value;
+    return *this;
+  }
+  std::optional<int64_t> schedule_partition_size() const {
+    return schedule_partition_size_;
+  }
+
+  // If non-empty, a directory holding an on-disk cache of schedules (see
+  // xls/scheduling/schedule_cache.h) consulted by RunPipelineSchedule. The
+  // directory does not affect the schedule.
+  SchedulingOptions& schedule_cache_dir(std::string_view value) {
+    schedule_cache_dir_ = value;
+    return *this;
+  }
+  const std::string& schedule_cache_dir() const { return schedule_cache_dir_; }
+
  private:
   SchedulingStrategy strategy_;
   std::optional<int64_t> clock_period_ps_;
@@ -375,6 +445,10 @@ class SchedulingOptions {
   float fdo_refinement_stochastic_ratio_;
   PathEvaluateStrategy fdo_path_evaluate_strategy_;
   std::string fdo_synthesizer_name_;
+  min_cut::MaxFlowAlgorithm min_cut_max_flow_algorithm_;
+  SDCSolver sdc_solver_;
+  std::optional<int64_t> schedule_partition_size_;
+  std::string schedule_cache_dir_;
 };
 
 // A map from node to cycle as a bare-bones representation of a schedule.
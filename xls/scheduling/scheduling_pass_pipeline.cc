@@ -35,12 +35,17 @@ std::unique_ptr<SchedulingCompoundPass> CreateSchedulingPassPipeline() {
       "scheduling", "Top level scheduling pass pipeline");
   top->AddInvariantChecker<SchedulingChecker>();
 
-  top->Add<MutualExclusionPass>();
+  // The second mutual exclusion pass reuses the solver results of the first
+  // for predicates the intervening passes left unchanged.
+  auto mutual_exclusion_cache = std::make_shared<MutualExclusionQueryCache>();
+  top->Add<MutualExclusionPass>(MutualExclusionPass::MergeStrategy::kColoring,
+                                mutual_exclusion_cache);
   top->Add<SchedulingWrapperPass>(std::make_unique<SimplificationPass>(3));
   top->Add<SchedulingWrapperPass>(std::make_unique<LiteralUncommoningPass>());
   top->Add<PipelineSchedulingPass>();
   top->Add<SchedulingWrapperPass>(std::make_unique<DeadCodeEliminationPass>());
-  top->Add<MutualExclusionPass>();
+  top->Add<MutualExclusionPass>(MutualExclusionPass::MergeStrategy::kColoring,
+                                mutual_exclusion_cache);
   top->Add<SchedulingWrapperPass>(std::make_unique<DeadCodeEliminationPass>());
   top->Add<PipelineSchedulingPass>();
 
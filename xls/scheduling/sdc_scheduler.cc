@@ -14,9 +14,12 @@
 
 #include "xls/scheduling/sdc_scheduler.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <deque>
 #include <memory>
+#include <numeric>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -24,6 +27,7 @@
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -61,10 +65,13 @@ namespace math_opt = ::operations_research::math_opt;
 // A helper function to compute each node's delay by calling the delay estimator
 absl::StatusOr<DelayMap> ComputeNodeDelays(
     FunctionBase* f, const DelayEstimator& delay_estimator) {
+  std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
+  XLS_ASSIGN_OR_RETURN(std::vector<int64_t> delays,
+                       delay_estimator.GetOperationDelaysInPs(nodes));
   DelayMap result;
-  for (Node* node : f->nodes()) {
-    XLS_ASSIGN_OR_RETURN(result[node],
-                         delay_estimator.GetOperationDelayInPs(node));
+  result.reserve(nodes.size());
+  for (int64_t i = 0; i < nodes.size(); ++i) {
+    result[nodes[i]] = delays[i];
   }
   return result;
 }
@@ -146,63 +153,6 @@ ComputeDistancesToNodes(FunctionBase* f, const NodeIterator& topo_sort,
   return distances_to_node;
 }
 
-// Returns the minimal set of schedule constraints which ensure that no
-// combinational path in the schedule exceeds `clock_period_ps`. The returned
-// map has a (potentially empty) vector entry for each node in `f`. The map
-// value (vector of nodes) for node `x` is the set of nodes which must be
-// scheduled at least one cycle later than `x`. That is, if `return_value[x]` is
-// `S` then:
-//
-//   cycle(i) + 1 >= cycle(x) for i \in S
-//
-// The set of constraints is a minimal set which guarantees that no
-// combinational path violates the clock period timing. Specifically, `(a, b)`
-// is in the set of returned constraints (ie., `return_value[a]` contains `b`)
-// iff critical-path distance from `a` to `b` including the delay of `a` and `b`
-// is greater than `critical_path_period`, but the critical-path distance of the
-// path *not* including the delay of `b` is *less than* `critical_path_period`.
-absl::flat_hash_map<Node*, std::vector<Node*>>
-ComputeCombinationalDelayConstraints(
-    FunctionBase* f, const NodeIterator& topo_sort, int64_t clock_period_ps,
-    const absl::flat_hash_map<Node*, absl::flat_hash_map<Node*, int64_t>>&
-        distances_to_node,
-    const DelayMap& delay_map) {
-  absl::flat_hash_map<Node*, std::vector<Node*>> result;
-  result.reserve(f->node_count());
-  for (Node* a : topo_sort) {
-    result[a];
-  }
-
-  for (Node* node : topo_sort) {
-    const int64_t node_delay = delay_map.at(node);
-
-    // For each ancestor `a`, check whether the critical-path length from `a`'s
-    // start to `node`'s end crosses a `clock_period_ps` boundary due to
-    // `node`'s delay. If so, we need a constraint to ensure that `node` is in a
-    // later stage than `a`.
-    //
-    // NOTE: The order in which we iterate over the ancestors `a` here does not
-    // matter. As long as our iteration over `node` is deterministic, we will
-    // push the same sequence of `node`s into each `result[a]` every time.
-    for (auto [a, distance] : distances_to_node.at(node)) {
-      if (distance > clock_period_ps &&
-          distance - node_delay <= clock_period_ps) {
-        result.at(a).push_back(node);
-      }
-    }
-  }
-
-  if (XLS_VLOG_IS_ON(4)) {
-    XLS_VLOG(4) << absl::StrFormat("Constraints (clock period: %dps):",
-                                   clock_period_ps);
-    for (Node* node : topo_sort) {
-      XLS_VLOG(4) << absl::StrFormat("  %s: [%s]", node->GetName(),
-                                     absl::StrJoin(result.at(node), ", "));
-    }
-  }
-  return result;
-}
-
 }  // namespace
 
 SDCSchedulingModel::SDCSchedulingModel(FunctionBase* func,
@@ -532,45 +482,232 @@ absl::StatusOr<ScheduleCycleMap> SDCSchedulingModel::ExtractResult(
   return cycle_map;
 }
 
-void SDCSchedulingModel::SetClockPeriod(int64_t clock_period_ps) {
-  absl::flat_hash_map<Node*, std::vector<Node*>> prev_delay_constraints =
-      std::move(delay_constraints_);
-  delay_constraints_ = ComputeCombinationalDelayConstraints(
-      func_, topo_sort_, clock_period_ps, distances_to_node_, delay_map_);
-
-  for (Node* source : topo_sort_) {
-    if (!prev_delay_constraints.empty()) {
-      // Check over all the prior constraints, dropping any that are obsolete.
-      absl::flat_hash_set<Node*> new_targets(
-          delay_constraints_.at(source).begin(),
-          delay_constraints_.at(source).end());
-      for (Node* target : prev_delay_constraints.at(source)) {
-        if (new_targets.contains(target)) {
-          continue;
-        }
+absl::StatusOr<ScheduleCycleMap> SDCSchedulingModel::ExtractRepairedResult(
+    const math_opt::VariableMap<double>& variable_values) const {
+  // Number the schedule variables from 1; 0 is a reference variable fixed at
+  // zero, against which the variable bounds are expressed.
+  absl::flat_hash_map<math_opt::Variable, int64_t> index;
+  std::vector<math_opt::Variable> variables = {last_stage_,
+                                               cycle_at_sinknode_};
+  for (Node* node : topo_sort_) {
+    variables.push_back(cycle_var_.at(node));
+  }
+  const int64_t n = static_cast<int64_t>(variables.size()) + 1;
+  index.reserve(variables.size());
+  for (int64_t i = 0; i < variables.size(); ++i) {
+    index.emplace(variables[i], i + 1);
+  }
 
-        // No longer related; remove constraint.
-        auto it = timing_constraint_.find(std::make_pair(source, target));
-        model_.DeleteLinearConstraint(it->second);
-        timing_constraint_.erase(it);
+  // Every constraint on the schedule variables is a difference constraint
+  // `lb <= x[plus] - x[minus] <= ub`, i.e. a pair of edges in a constraint
+  // graph where an edge (from, to, weight) requires x[to] >= x[from] + weight.
+  struct Edge {
+    int64_t to;
+    int64_t weight;
+  };
+  std::vector<std::vector<Edge>> edges(n);
+  auto add_difference = [&](int64_t plus, int64_t minus, double lb,
+                            double ub) {
+    if (lb != -kInfinity) {
+      edges[minus].push_back(
+          Edge{.to = plus, .weight = static_cast<int64_t>(std::ceil(lb))});
+    }
+    if (ub != kInfinity) {
+      edges[plus].push_back(
+          Edge{.to = minus, .weight = -static_cast<int64_t>(std::floor(ub))});
+    }
+  };
+  for (int64_t i = 0; i < variables.size(); ++i) {
+    add_difference(i + 1, 0, variables[i].lower_bound(),
+                   variables[i].upper_bound());
+  }
+  for (const math_opt::LinearConstraint& c : model_.LinearConstraints()) {
+    std::vector<math_opt::Variable> row = model_.RowNonzeros(c);
+    if (absl::c_any_of(row, [&](const math_opt::Variable& v) {
+          return !index.contains(v);
+        })) {
+      // Constraints on the lifetimes (or slacks) don't restrict the schedule.
+      continue;
+    }
+    std::optional<int64_t> plus;
+    std::optional<int64_t> minus;
+    for (const math_opt::Variable& v : row) {
+      std::optional<int64_t>& slot = c.coefficient(v) > 0 ? plus : minus;
+      if (std::fabs(c.coefficient(v)) != 1.0 || slot.has_value()) {
+        return absl::InternalError(absl::StrCat(
+            "Constraint is not a difference constraint: ", c.name()));
       }
+      slot = index.at(v);
+    }
+    if (!plus.has_value() && !minus.has_value()) {
+      continue;
     }
+    add_difference(plus.value_or(0), minus.value_or(0), c.lower_bound(),
+                   c.upper_bound());
+  }
 
-    // Add all new constraints, avoiding duplicates for any that already exist.
-    for (Node* target : delay_constraints_.at(source)) {
-      auto key = std::make_pair(source, target);
-      if (timing_constraint_.contains(key)) {
+  // Starting from the rounded solution, raise variables until every edge is
+  // satisfied (a longest-path computation with a FIFO worklist). This
+  // converges after at most `n` raises of each variable unless the constraints
+  // contain a positive cycle, i.e. are infeasible.
+  std::vector<int64_t> x(n, 0);
+  for (int64_t i = 0; i < variables.size(); ++i) {
+    x[i + 1] = std::llround(variable_values.at(variables[i]));
+  }
+  std::vector<int64_t> raises(n, 0);
+  std::vector<bool> queued(n, true);
+  std::deque<int64_t> worklist(n);
+  std::iota(worklist.begin(), worklist.end(), 0);
+  while (!worklist.empty()) {
+    int64_t from = worklist.front();
+    worklist.pop_front();
+    queued[from] = false;
+    for (const Edge& edge : edges[from]) {
+      if (x[edge.to] >= x[from] + edge.weight) {
         continue;
       }
+      x[edge.to] = x[from] + edge.weight;
+      if (++raises[edge.to] > n) {
+        return absl::InternalError(
+            "Unable to repair the scheduling result; the constraints are "
+            "infeasible");
+      }
+      if (!queued[edge.to]) {
+        queued[edge.to] = true;
+        worklist.push_back(edge.to);
+      }
+    }
+  }
+
+  ScheduleCycleMap cycle_map;
+  for (Node* node : topo_sort_) {
+    cycle_map[node] = x[index.at(cycle_var_.at(node))] - x[0];
+  }
+  return cycle_map;
+}
 
-      // Newly related; add constraint.
-      XLS_VLOG(2) << "Setting timing constraint: "
-                  << absl::StrFormat("1 ≤ %s - %s", target->GetName(),
-                                     source->GetName());
-      timing_constraint_.emplace(
-          key, DiffAtLeastConstraint(target, source, 1, "timing"));
+// The timing constraints form the minimal set of schedule constraints which
+// ensure that no combinational path in the schedule exceeds the clock period.
+// Specifically, `target` must be scheduled at least one cycle later than
+// `source` iff the critical-path distance from `source` to `target` including
+// the delay of both is greater than the clock period, but the critical-path
+// distance *not* including the delay of `target` is not. That is, iff the
+// clock period lies in [distance - target_delay, distance).
+void SDCSchedulingModel::ComputeTimingIntervals() {
+  absl::flat_hash_map<Node*, std::vector<TimingInterval>> intervals_by_source;
+  for (Node* target : topo_sort_) {
+    const int64_t target_delay = delay_map_.at(target);
+    for (auto [source, distance] : distances_to_node_.at(target)) {
+      intervals_by_source[source].push_back(TimingInterval{
+          .source = source,
+          .target = target,
+          .min_clock_period_ps = distance - target_delay,
+          .max_clock_period_ps = distance,
+      });
     }
   }
+  // Order the intervals by source then target, both in topological order; this
+  // is the order in which the respective constraints are added to the model.
+  for (Node* source : topo_sort_) {
+    auto it = intervals_by_source.find(source);
+    if (it != intervals_by_source.end()) {
+      timing_intervals_.insert(timing_intervals_.end(), it->second.begin(),
+                               it->second.end());
+    }
+  }
+
+  intervals_by_min_period_.resize(timing_intervals_.size());
+  std::iota(intervals_by_min_period_.begin(), intervals_by_min_period_.end(),
+            0);
+  intervals_by_max_period_ = intervals_by_min_period_;
+  std::stable_sort(intervals_by_min_period_.begin(),
+                   intervals_by_min_period_.end(), [&](int64_t a, int64_t b) {
+                     return timing_intervals_[a].min_clock_period_ps <
+                            timing_intervals_[b].min_clock_period_ps;
+                   });
+  std::stable_sort(intervals_by_max_period_.begin(),
+                   intervals_by_max_period_.end(), [&](int64_t a, int64_t b) {
+                     return timing_intervals_[a].max_clock_period_ps <
+                            timing_intervals_[b].max_clock_period_ps;
+                   });
+}
+
+void SDCSchedulingModel::SetClockPeriod(int64_t clock_period_ps) {
+  // Gather the intervals whose timing constraint may have to be added or
+  // removed. Only the timing constraints depend on the clock period, so when
+  // the model is reused across clock periods (e.g., while searching for the
+  // minimum clock period) only the constraints of intervals with an endpoint
+  // between the old and the new clock period change.
+  std::vector<int64_t> candidates;
+  if (!clock_period_ps_.has_value()) {
+    ComputeTimingIntervals();
+    candidates.resize(timing_intervals_.size());
+    std::iota(candidates.begin(), candidates.end(), 0);
+  } else {
+    const int64_t lo = std::min(*clock_period_ps_, clock_period_ps);
+    const int64_t hi = std::max(*clock_period_ps_, clock_period_ps);
+    auto add_endpoints_in_range = [&](const std::vector<int64_t>& sorted,
+                                      auto endpoint) {
+      auto begin = std::upper_bound(
+          sorted.begin(), sorted.end(), lo, [&](int64_t value, int64_t i) {
+            return value < endpoint(timing_intervals_[i]);
+          });
+      auto end = std::upper_bound(
+          begin, sorted.end(), hi, [&](int64_t value, int64_t i) {
+            return value < endpoint(timing_intervals_[i]);
+          });
+      candidates.insert(candidates.end(), begin, end);
+    };
+    add_endpoints_in_range(intervals_by_min_period_,
+                           [](const TimingInterval& interval) {
+                             return interval.min_clock_period_ps;
+                           });
+    add_endpoints_in_range(intervals_by_max_period_,
+                           [](const TimingInterval& interval) {
+                             return interval.max_clock_period_ps;
+                           });
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                     candidates.end());
+  }
+  clock_period_ps_ = clock_period_ps;
+
+  auto is_active = [&](const TimingInterval& interval) {
+    return interval.min_clock_period_ps <= clock_period_ps &&
+           clock_period_ps < interval.max_clock_period_ps;
+  };
+
+  // Drop any constraints which are now obsolete...
+  for (int64_t i : candidates) {
+    const TimingInterval& interval = timing_intervals_[i];
+    if (is_active(interval)) {
+      continue;
+    }
+    auto it = timing_constraint_.find(
+        std::make_pair(interval.source, interval.target));
+    if (it != timing_constraint_.end()) {
+      // No longer related; remove constraint.
+      model_.DeleteLinearConstraint(it->second);
+      timing_constraint_.erase(it);
+    }
+  }
+
+  // ... and add the new ones, avoiding duplicates for any that already exist.
+  for (int64_t i : candidates) {
+    const TimingInterval& interval = timing_intervals_[i];
+    auto key = std::make_pair(interval.source, interval.target);
+    if (!is_active(interval) || timing_constraint_.contains(key)) {
+      continue;
+    }
+
+    // Newly related; add constraint.
+    XLS_VLOG(2) << "Setting timing constraint: "
+                << absl::StrFormat("1 ≤ %s - %s", interval.target->GetName(),
+                                   interval.source->GetName());
+    timing_constraint_.emplace(
+        key, DiffAtLeastConstraint(interval.target, interval.source, 1,
+                                   "timing"));
+  }
 }
 
 void SDCSchedulingModel::SetPipelineLength(
@@ -824,24 +961,30 @@ SDCSchedulingModel::AddLowerBoundSlack(
 }
 
 absl::StatusOr<std::unique_ptr<SDCScheduler>> SDCScheduler::Create(
-    FunctionBase* f, const DelayEstimator& delay_estimator) {
+    FunctionBase* f, const DelayEstimator& delay_estimator,
+    SDCSolver solver_type) {
   XLS_ASSIGN_OR_RETURN(DelayMap delay_map,
                        ComputeNodeDelays(f, delay_estimator));
   std::unique_ptr<SDCScheduler> scheduler(
-      new SDCScheduler(f, std::move(delay_map)));
+      new SDCScheduler(f, std::move(delay_map), solver_type));
   XLS_RETURN_IF_ERROR(scheduler->Initialize());
   return std::move(scheduler);
 }
 
-SDCScheduler::SDCScheduler(FunctionBase* f, DelayMap delay_map)
+SDCScheduler::SDCScheduler(FunctionBase* f, DelayMap delay_map,
+                           SDCSolver solver_type)
     : f_(f),
       delay_map_(std::move(delay_map)),
+      solver_type_(solver_type),
       model_(f, delay_map_, absl::StrCat("sdc_model:", f->name())) {}
 
 absl::Status SDCScheduler::Initialize() {
   XLS_ASSIGN_OR_RETURN(
-      solver_, math_opt::IncrementalSolver::New(&model_.UnderlyingModel(),
-                                                math_opt::SolverType::kGlop));
+      solver_, math_opt::IncrementalSolver::New(
+                   &model_.UnderlyingModel(),
+                   solver_type_ == SDCSolver::kFirstOrder
+                       ? math_opt::SolverType::kPdlp
+                       : math_opt::SolverType::kGlop));
 
   for (Node* node : f_->nodes()) {
     for (Node* user : node->users()) {
@@ -924,10 +1067,24 @@ absl::StatusOr<ScheduleCycleMap> SDCScheduler::Schedule(
       return BuildError(result_with_minimized_pipeline_length,
                         explain_infeasibility);
     }
-    XLS_ASSIGN_OR_RETURN(
-        const int64_t min_pipeline_length,
-        model_.ExtractPipelineLength(
-            result_with_minimized_pipeline_length.variable_values()));
+    int64_t min_pipeline_length;
+    if (solver_type_ == SDCSolver::kFirstOrder) {
+      // The first-order optimum is only approximate; use the length of the
+      // repaired schedule, which is feasible by construction.
+      XLS_ASSIGN_OR_RETURN(
+          ScheduleCycleMap cycle_map,
+          model_.ExtractRepairedResult(
+              result_with_minimized_pipeline_length.variable_values()));
+      min_pipeline_length = 1;
+      for (const auto& [node, cycle] : cycle_map) {
+        min_pipeline_length = std::max(min_pipeline_length, cycle + 1);
+      }
+    } else {
+      XLS_ASSIGN_OR_RETURN(
+          min_pipeline_length,
+          model_.ExtractPipelineLength(
+              result_with_minimized_pipeline_length.variable_values()));
+    }
     model_.SetPipelineLength(min_pipeline_length);
   }
 
@@ -941,6 +1098,9 @@ absl::StatusOr<ScheduleCycleMap> SDCScheduler::Schedule(
   if (result.termination.reason == math_opt::TerminationReason::kOptimal ||
       (check_feasibility &&
        result.termination.reason == math_opt::TerminationReason::kFeasible)) {
+    if (solver_type_ == SDCSolver::kFirstOrder) {
+      return model_.ExtractRepairedResult(result.variable_values());
+    }
     return model_.ExtractResult(result.variable_values());
   }
   return BuildError(result, explain_infeasibility);
@@ -950,7 +1110,7 @@ absl::StatusOr<ScheduleCycleMap> SDCSchedule(
     FunctionBase* f, std::optional<int64_t> pipeline_stages,
     int64_t clock_period_ps, const DelayEstimator& delay_estimator,
     absl::Span<const SchedulingConstraint> constraints, bool check_feasibility,
-    bool explain_infeasibility) {
+    bool explain_infeasibility, SDCSolver solver_type) {
   XLS_VLOG(3) << "SDCScheduler()";
   XLS_VLOG(3) << "  pipeline stages = "
               << (pipeline_stages.has_value()
@@ -959,7 +1119,7 @@ absl::StatusOr<ScheduleCycleMap> SDCSchedule(
   XLS_VLOG_LINES(4, f->DumpIr());
 
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<SDCScheduler> scheduler,
-                       SDCScheduler::Create(f, delay_estimator));
+                       SDCScheduler::Create(f, delay_estimator, solver_type));
   XLS_RETURN_IF_ERROR(scheduler->AddConstraints(constraints));
   return scheduler->Schedule(pipeline_stages, clock_period_ps,
                              check_feasibility, explain_infeasibility);
@@ -86,6 +86,16 @@ class SDCSchedulingModel {
       const operations_research::math_opt::VariableMap<double>& variable_values)
       const;
 
+  // Like ExtractResult, but for solutions which are only approximately
+  // optimal and may violate the constraints by a small tolerance, e.g. those of
+  // first-order solvers. Rounds the cycles to the nearest integers, then
+  // repairs any violated constraint by delaying nodes (the least amount
+  // necessary, as a longest-path computation over the difference constraints)
+  // so the result is always a feasible schedule.
+  absl::StatusOr<ScheduleCycleMap> ExtractRepairedResult(
+      const operations_research::math_opt::VariableMap<double>& variable_values)
+      const;
+
   absl::Status ExtractError(
       const operations_research::math_opt::VariableMap<double>& variable_values)
       const;
@@ -170,8 +180,29 @@ class SDCSchedulingModel {
   // data-dependence graph.
   operations_research::math_opt::Variable cycle_at_sinknode_;
 
-  // A cache of the delay constraints.
-  absl::flat_hash_map<Node*, std::vector<Node*>> delay_constraints_;
+  // A pair of nodes for which a timing constraint (`target` is scheduled in a
+  // later cycle than `source`) is needed iff the clock period is in
+  // [min_clock_period_ps, max_clock_period_ps).
+  struct TimingInterval {
+    Node* source;
+    Node* target;
+    int64_t min_clock_period_ps;
+    int64_t max_clock_period_ps;
+  };
+
+  // Computes `timing_intervals_` and the sorted indices into it from the
+  // critical-path distances.
+  void ComputeTimingIntervals();
+
+  // The timing intervals of all pairs of nodes connected by a path, and indices
+  // into `timing_intervals_` sorted by minimum and by maximum clock period.
+  // Computed the first time a clock period is set.
+  std::vector<TimingInterval> timing_intervals_;
+  std::vector<int64_t> intervals_by_min_period_;
+  std::vector<int64_t> intervals_by_max_period_;
+
+  // The clock period the timing constraints were last set for.
+  std::optional<int64_t> clock_period_ps_;
 
   absl::flat_hash_map<std::pair<Node*, Node*>,
                       operations_research::math_opt::LinearConstraint>
@@ -204,7 +235,8 @@ class SDCScheduler {
 
  public:
   static absl::StatusOr<std::unique_ptr<SDCScheduler>> Create(
-      FunctionBase* f, const DelayEstimator& delay_estimator);
+      FunctionBase* f, const DelayEstimator& delay_estimator,
+      SDCSolver solver_type = SDCSolver::kSimplex);
 
   absl::Status AddConstraints(
       absl::Span<const SchedulingConstraint> constraints);
@@ -232,7 +264,7 @@ class SDCScheduler {
       bool check_feasibility = false, bool explain_infeasibility = true);
 
  private:
-  SDCScheduler(FunctionBase* f, DelayMap delay_map);
+  SDCScheduler(FunctionBase* f, DelayMap delay_map, SDCSolver solver_type);
   absl::Status Initialize();
 
   absl::Status BuildError(
@@ -241,6 +273,7 @@ class SDCScheduler {
 
   FunctionBase* f_;
   DelayMap delay_map_;
+  SDCSolver solver_type_;
 
   SDCSchedulingModel model_;
   std::unique_ptr<operations_research::math_opt::IncrementalSolver> solver_;
@@ -257,6 +290,8 @@ class SDCScheduler {
 // If `pipeline_stages` is not specified, the solver will use the smallest
 // feasible value.
 //
+// `solver_type` selects the LP solver; see SDCSolver.
+//
 // References:
 //   - Cong, Jason, and Zhiru Zhang. "An efficient and versatile scheduling
 //   algorithm based on SDC formulation." 2006 43rd ACM/IEEE Design Automation
@@ -268,7 +303,8 @@ absl::StatusOr<ScheduleCycleMap> SDCSchedule(
     FunctionBase* f, std::optional<int64_t> pipeline_stages,
     int64_t clock_period_ps, const DelayEstimator& delay_estimator,
     absl::Span<const SchedulingConstraint> constraints,
-    bool check_feasibility = false, bool explain_infeasibility = true);
+    bool check_feasibility = false, bool explain_infeasibility = true,
+    SDCSolver solver_type = SDCSolver::kSimplex);
 
 }  // namespace xls
 
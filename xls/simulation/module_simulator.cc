@@ -15,6 +15,7 @@
 #include "xls/simulation/module_simulator.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -27,13 +28,20 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "absl/types/span.h"
 #include "xls/codegen/flattening.h"
+#include "xls/common/file/temp_file.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/logging/vlog_is_on.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/number_parser.h"
 #include "xls/tools/eval_helpers.h"
 
 namespace xls {
@@ -263,8 +271,197 @@ absl::StatusOr<std::vector<std::unique_ptr<Bits>>> CaptureOutputChannel(
   return outputs;
 }
 
+// Prefix of the lines printed by the batch testbench holding the outputs of
+// one input vector.
+constexpr std::string_view kBatchOutputPrefix = "__xls_batch_output:";
+
+// Number of cycles for which the batch testbench asserts reset, matching
+// ModuleTestbench.
+constexpr int64_t kBatchResetCycles = 5;
+
+// Returns the Verilog text of the testbench used by BatchModuleSimulator. The
+// testbench reads the file named by the `input_vectors` plusarg. The first
+// line of the file holds the number of input vectors, followed by a line per
+// vector holding the data inputs in hex in the order of the signature. For
+// each vector the testbench prints a line holding kBatchOutputPrefix followed
+// by the data outputs in hex in the order of the signature. Zero-width ports
+// are omitted from both.
+absl::StatusOr<std::string> GenerateBatchTestbenchVerilog(
+    const ModuleSignature& signature) {
+  const ModuleSignatureProto& proto = signature.proto();
+  if (!proto.has_combinational() && !proto.has_fixed_latency() &&
+      !proto.has_pipeline()) {
+    return absl::UnimplementedError(
+        absl::StrCat("Unsupported interface for batch simulation: ",
+                     proto.interface_oneof_case()));
+  }
+  if (!proto.has_clock_name() && !proto.has_combinational()) {
+    return absl::InvalidArgumentError("Expected clock in signature");
+  }
+  std::optional<ValidProto> valid;
+  if (proto.has_pipeline() && proto.pipeline().has_pipeline_control()) {
+    if (!proto.pipeline().pipeline_control().has_valid()) {
+      return absl::UnimplementedError(
+          "Manual pipeline control is not supported in batch simulation");
+    }
+    valid = proto.pipeline().pipeline_control().valid();
+  }
+
+  std::string declarations;
+  std::vector<std::string> connections;
+  auto add_port = [&](std::string_view kind, std::string_view name,
+                      int64_t width) {
+    absl::StrAppendFormat(&declarations, "  %s [%d:0] %s;\n", kind, width - 1,
+                          name);
+    connections.push_back(absl::StrFormat(".%s(%s)", name, name));
+  };
+  std::string clk = "clk";
+  if (proto.has_clock_name()) {
+    clk = proto.clock_name();
+    add_port("reg", clk, 1);
+  } else {
+    absl::StrAppendFormat(&declarations, "  reg %s;\n", clk);
+  }
+  if (proto.has_reset()) {
+    add_port("reg", proto.reset().name(), 1);
+  }
+  if (valid.has_value()) {
+    add_port("reg", valid->input_name(), 1);
+    if (valid->has_output_name()) {
+      add_port("wire", valid->output_name(), 1);
+    }
+  }
+
+  std::vector<std::string> input_names;
+  std::string set_inputs_x;
+  for (const PortProto& input : signature.data_inputs()) {
+    if (input.width() == 0) {
+      continue;
+    }
+    add_port("reg", input.name(), input.width());
+    input_names.push_back(input.name());
+    absl::StrAppendFormat(&set_inputs_x, "      %s = {%d{1'bx}};\n",
+                          input.name(), input.width());
+  }
+  std::vector<std::string> output_names;
+  for (const PortProto& output : signature.data_outputs()) {
+    if (output.width() == 0) {
+      continue;
+    }
+    add_port("wire", output.name(), output.width());
+    output_names.push_back(output.name());
+  }
+
+  std::string read_inputs;
+  if (!input_names.empty()) {
+    read_inputs = absl::StrFormat(
+        "      __status = $fscanf(__fd, \"%s\\n\", %s);\n",
+        absl::StrJoin(std::vector<std::string>(input_names.size(), "%h"), " "),
+        absl::StrJoin(input_names, ", "));
+  }
+  std::string display_outputs =
+      output_names.empty()
+          ? absl::StrFormat("      $display(\"%s\");\n", kBatchOutputPrefix)
+          : absl::StrFormat(
+                "      $display(\"%s %s\", %s);\n", kBatchOutputPrefix,
+                absl::StrJoin(
+                    std::vector<std::string>(output_names.size(), "%h"), " "),
+                absl::StrJoin(output_names, ", "));
+  const std::string next_cycle =
+      absl::StrFormat("      @(posedge %s);\n      #1;\n", clk);
+
+  std::string tb;
+  absl::StrAppend(&tb, "module __xls_batch_testbench;\n", declarations,
+                  "  reg [8191:0] __path;\n  integer __fd;\n",
+                  "  integer __status;\n  integer __count;\n",
+                  "  integer __i;\n\n");
+  absl::StrAppendFormat(&tb, "  %s dut (\n    %s\n  );\n\n",
+                        signature.module_name(),
+                        absl::StrJoin(connections, ",\n    "));
+  absl::StrAppendFormat(&tb,
+                        "  initial begin\n    %s = 0;\n"
+                        "    forever #5 %s = !%s;\n  end\n\n",
+                        clk, clk, clk);
+  absl::StrAppend(
+      &tb, "  initial begin\n",
+      "    if (!$value$plusargs(\"input_vectors=%s\", __path)) begin\n",
+      "      $display(\"ERROR: +input_vectors=<file> is required\");\n",
+      "      $finish;\n    end\n", "    __fd = $fopen(__path, \"r\");\n",
+      "    if (__fd == 0) begin\n",
+      "      $display(\"ERROR: cannot open input vectors file\");\n",
+      "      $finish;\n    end\n",
+      "    __status = $fscanf(__fd, \"%d\\n\", __count);\n");
+
+  // Hold the inputs at X and any valid input deasserted through reset.
+  absl::StrAppend(&tb, set_inputs_x);
+  if (valid.has_value()) {
+    absl::StrAppendFormat(&tb, "    %s = 1'b0;\n", valid->input_name());
+  }
+  if (proto.has_reset()) {
+    absl::StrAppendFormat(&tb, "    %s = 1'b%d;\n", proto.reset().name(),
+                          proto.reset().active_low() ? 0 : 1);
+  }
+  absl::StrAppendFormat(&tb, "    repeat (%d) @(posedge %s);\n    #1;\n",
+                        proto.has_reset() ? kBatchResetCycles : 1, clk);
+  if (proto.has_reset()) {
+    absl::StrAppendFormat(&tb, "    %s = 1'b%d;\n", proto.reset().name(),
+                          proto.reset().active_low() ? 1 : 0);
+  }
+
+  if (proto.has_combinational()) {
+    absl::StrAppend(&tb,
+                    "    for (__i = 0; __i < __count; __i = __i + 1) begin\n",
+                    read_inputs, "      #8;\n", display_outputs,
+                    next_cycle, "    end\n");
+  } else if (proto.has_fixed_latency()) {
+    // Wait for the computation to complete, then hold the inputs for one more
+    // cycle while the outputs are read.
+    absl::StrAppend(&tb,
+                    "    for (__i = 0; __i < __count; __i = __i + 1) begin\n",
+                    read_inputs);
+    for (int64_t i = 0; i < proto.fixed_latency().latency(); ++i) {
+      absl::StrAppend(&tb, next_cycle);
+    }
+    absl::StrAppend(&tb, "      #8;\n", display_outputs,
+                    next_cycle,
+                    next_cycle, "    end\n");
+  } else {
+    // Drive a new input vector every cycle and read the outputs of the vector
+    // driven `latency` cycles earlier.
+    const int64_t latency = proto.pipeline().latency();
+    absl::StrAppendFormat(
+        &tb, "    for (__i = 0; __i < __count + %d; __i = __i + 1) begin\n",
+        latency);
+    absl::StrAppend(&tb, "      if (__i < __count) begin\n", read_inputs);
+    if (valid.has_value()) {
+      absl::StrAppendFormat(&tb, "      %s = 1'b1;\n", valid->input_name());
+    }
+    absl::StrAppend(&tb, "      end else begin\n", set_inputs_x);
+    if (valid.has_value()) {
+      absl::StrAppendFormat(&tb, "      %s = 1'b0;\n", valid->input_name());
+    }
+    absl::StrAppendFormat(
+        &tb, "      end\n      #8;\n      if (__i >= %d) begin\n", latency);
+    absl::StrAppend(&tb, display_outputs, "      end\n",
+                    next_cycle, "    end\n");
+  }
+  absl::StrAppend(&tb, "    $fclose(__fd);\n    $finish;\n  end\n",
+                  "endmodule\n");
+  return tb;
+}
+
 }  // namespace
 
+std::string CosimulationMismatch::ToString() const {
+  return absl::StrFormat(
+      "cycle %d: output #%d on channel `%s` mismatched: expected %s, actual %s",
+      cycle, index, channel_name,
+      BitsToString(expected, FormatPreference::kHex,
+                   /*include_bit_count=*/true),
+      BitsToString(actual, FormatPreference::kHex,
+                   /*include_bit_count=*/true));
+}
+
 absl::flat_hash_map<std::string, Bits> ModuleSimulator::DeassertControlSignals()
     const {
   absl::flat_hash_map<std::string, Bits> control_signals;
@@ -511,6 +708,19 @@ absl::StatusOr<std::vector<Value>> ModuleSimulator::RunBatched(
   return outputs;
 }
 
+absl::StatusOr<std::unique_ptr<BatchModuleSimulator>>
+ModuleSimulator::CompileBatchSimulator() const {
+  XLS_ASSIGN_OR_RETURN(std::string testbench,
+                       GenerateBatchTestbenchVerilog(signature_));
+  XLS_VLOG(2) << "Batch testbench:\n" << testbench;
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<CompiledSimulation> simulation,
+      simulator_->Compile(absl::StrCat(verilog_text_, "\n", testbench),
+                          file_type_, includes_));
+  return std::make_unique<BatchModuleSimulator>(signature_,
+                                                std::move(simulation));
+}
+
 absl::StatusOr<std::string> ModuleSimulator::GenerateProcTestbenchVerilog(
     const absl::flat_hash_map<std::string, std::vector<Bits>>& channel_inputs,
     const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
@@ -659,6 +869,53 @@ ModuleSimulator::RunInputSeriesProc(
   return outputs;
 }
 
+absl::StatusOr<std::optional<CosimulationMismatch>>
+ModuleSimulator::CosimulateInputSeriesProc(
+    const absl::flat_hash_map<std::string, std::vector<Bits>>& channel_inputs,
+    const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
+    const ChannelOutputReference& reference,
+    std::optional<ReadyValidHoldoffs> holdoffs) const {
+  XLS_ASSIGN_OR_RETURN(
+      ProcTestbench proc_tb,
+      CreateProcTestbench(channel_inputs, output_channel_counts,
+                          std::move(holdoffs)));
+
+  // Identifies the transaction of each value captured by the testbench.
+  absl::flat_hash_map<const Bits*, std::pair<std::string_view, int64_t>>
+      transactions;
+  for (const auto& [channel_name, captures] : proc_tb.outputs) {
+    for (int64_t i = 0; i < captures.size(); ++i) {
+      transactions[captures[i].get()] = {channel_name, i};
+    }
+  }
+
+  std::optional<CosimulationMismatch> mismatch;
+  absl::Status status = proc_tb.testbench->RunStreaming(
+      [&](const Bits* capture, const Bits& value,
+          int64_t cycle) -> absl::Status {
+        auto it = transactions.find(capture);
+        XLS_RET_CHECK(it != transactions.end());
+        const auto& [channel_name, index] = it->second;
+        XLS_ASSIGN_OR_RETURN(Bits expected, reference(channel_name, index));
+        if (value != expected) {
+          mismatch = CosimulationMismatch{
+              .channel_name = std::string(channel_name),
+              .index = index,
+              .cycle = cycle,
+              .expected = std::move(expected),
+              .actual = value};
+          return absl::CancelledError("Output mismatch");
+        }
+        return absl::OkStatus();
+      });
+  if (mismatch.has_value()) {
+    XLS_VLOG(1) << "Co-simulation stopped at " << mismatch->ToString();
+    return mismatch;
+  }
+  XLS_RETURN_IF_ERROR(status);
+  return std::nullopt;
+}
+
 absl::StatusOr<absl::flat_hash_map<std::string, std::vector<Value>>>
 ModuleSimulator::RunInputSeriesProc(
     const absl::flat_hash_map<std::string, std::vector<Value>>& channel_inputs,
@@ -699,5 +956,89 @@ absl::StatusOr<Value> ModuleSimulator::RunFunction(
   return RunFunction(kwargs);
 }
 
+absl::StatusOr<std::vector<ModuleSimulator::BitsMap>>
+BatchModuleSimulator::RunBatched(
+    absl::Span<const ModuleSimulator::BitsMap> inputs) const {
+  if (inputs.empty()) {
+    return std::vector<ModuleSimulator::BitsMap>();
+  }
+
+  std::string input_vectors = absl::StrCat(inputs.size(), "\n");
+  for (const ModuleSimulator::BitsMap& input : inputs) {
+    XLS_RETURN_IF_ERROR(signature_.ValidateInputs(input));
+    std::vector<std::string> values;
+    for (const PortProto& port : signature_.data_inputs()) {
+      if (port.width() > 0) {
+        values.push_back(
+            input.at(port.name()).ToString(FormatPreference::kPlainHex));
+      }
+    }
+    absl::StrAppend(&input_vectors, absl::StrJoin(values, " "), "\n");
+  }
+  XLS_ASSIGN_OR_RETURN(TempFile input_file,
+                       TempFile::CreateWithContent(input_vectors, ".txt"));
+  XLS_ASSIGN_OR_RETURN(
+      auto stdout_stderr,
+      simulation_->Run(
+          {absl::StrCat("input_vectors=", input_file.path().string())}));
+
+  std::vector<ModuleSimulator::BitsMap> outputs;
+  for (std::string_view line : absl::StrSplit(stdout_stderr.first, '\n')) {
+    if (!absl::ConsumePrefix(&line, kBatchOutputPrefix)) {
+      continue;
+    }
+    std::vector<std::string_view> values =
+        absl::StrSplit(line, ' ', absl::SkipEmpty());
+    ModuleSimulator::BitsMap& output = outputs.emplace_back();
+    int64_t value_index = 0;
+    for (const PortProto& port : signature_.data_outputs()) {
+      if (port.width() == 0) {
+        output[port.name()] = Bits();
+        continue;
+      }
+      XLS_RET_CHECK_LT(value_index, values.size())
+          << "Too few output values in line: " << line;
+      std::string_view value = values[value_index++];
+      if (value.find_first_of("xXzZ") != std::string_view::npos) {
+        return absl::FailedPreconditionError(absl::StrFormat(
+            "Output `%s` of input set %d has X or Z bits: %s", port.name(),
+            outputs.size() - 1, value));
+      }
+      XLS_ASSIGN_OR_RETURN(output[port.name()],
+                           ParseUnsignedNumberWithoutPrefix(
+                               value, FormatPreference::kHex, port.width()));
+    }
+  }
+  if (outputs.size() != inputs.size()) {
+    return absl::InternalError(absl::StrFormat(
+        "Expected %d output sets from batch simulation, got %d. Simulation "
+        "output:\n%s\n%s",
+        inputs.size(), outputs.size(), stdout_stderr.first,
+        stdout_stderr.second));
+  }
+  return outputs;
+}
+
+absl::StatusOr<std::vector<Value>> BatchModuleSimulator::RunBatched(
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs) const {
+  std::vector<ModuleSimulator::BitsMap> bits_inputs;
+  for (const auto& input : inputs) {
+    XLS_RETURN_IF_ERROR(signature_.ValidateInputs(input));
+    bits_inputs.push_back(ValueMapToBitsMap(input));
+  }
+  XLS_ASSIGN_OR_RETURN(std::vector<ModuleSimulator::BitsMap> bits_outputs,
+                       RunBatched(bits_inputs));
+  XLS_RET_CHECK_EQ(signature_.data_outputs().size(), 1);
+  std::vector<Value> outputs;
+  for (const ModuleSimulator::BitsMap& bits_output : bits_outputs) {
+    XLS_ASSIGN_OR_RETURN(
+        Value output,
+        UnflattenBitsToValue(bits_output.begin()->second,
+                             signature_.data_outputs().begin()->type()));
+    outputs.push_back(std::move(output));
+  }
+  return outputs;
+}
+
 }  // namespace verilog
 }  // namespace xls
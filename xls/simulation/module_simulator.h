@@ -15,16 +15,22 @@
 #ifndef XLS_SIMULATION_MODULE_SIMULATOR_H_
 #define XLS_SIMULATION_MODULE_SIMULATOR_H_
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/vast.h"
+#include "xls/ir/bits.h"
 #include "xls/ir/value.h"
 #include "xls/simulation/module_testbench.h"
 #include "xls/simulation/verilog_simulator.h"
@@ -70,6 +76,30 @@ struct ReadyValidHoldoffs {
   absl::flat_hash_map<std::string, std::vector<int64_t>> ready_holdoffs;
 };
 
+// The first output channel transaction of a co-simulated module whose value
+// differs from the reference.
+struct CosimulationMismatch {
+  std::string channel_name;
+  // Index of the transaction among those on the channel.
+  int64_t index;
+  // Clock cycle of the Verilog simulation in which the transaction occurred.
+  int64_t cycle;
+  Bits expected;
+  Bits actual;
+
+  std::string ToString() const;
+};
+
+// Returns the value of the `index`-th transaction (counting from zero) on the
+// output channel `channel_name` of the reference model of a co-simulated
+// module. It is called in order of increasing index for each channel, as the
+// Verilog simulation produces the corresponding outputs, so the reference need
+// only be run as far as is necessary to produce each value.
+using ChannelOutputReference = std::function<absl::StatusOr<Bits>(
+    std::string_view channel_name, int64_t index)>;
+
+class BatchModuleSimulator;
+
 // Abstraction for simulating a module described by a SignatureProto using a
 // testbench run under the Verilog simulator.
 class ModuleSimulator {
@@ -111,6 +141,15 @@ class ModuleSimulator {
   absl::StatusOr<std::vector<Value>> RunBatched(
       absl::Span<const absl::flat_hash_map<std::string, Value>> inputs) const;
 
+  // Compiles a testbench for the module which reads its inputs from a file
+  // when it is run, and returns a simulator which runs any number of batches
+  // through it without recompiling. Only modules with a combinational, fixed
+  // latency or pipelined interface (without manual pipeline control) are
+  // supported. Returns an UnimplementedError if the Verilog simulator does not
+  // support separate compilation.
+  absl::StatusOr<std::unique_ptr<BatchModuleSimulator>> CompileBatchSimulator()
+      const;
+
   // Runs the given channel inputs and expects a number of values at an output
   // channel on the a design under test (DUT) derived from a proc.
   absl::StatusOr<absl::flat_hash_map<std::string, std::vector<Bits>>>
@@ -126,6 +165,18 @@ class ModuleSimulator {
       const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
       std::optional<ReadyValidHoldoffs> holdoffs = std::nullopt) const;
 
+  // Runs the given channel inputs like RunInputSeriesProc, but compares each
+  // output channel transaction against `reference` as soon as the Verilog
+  // simulation produces it rather than after the simulation finishes. The
+  // simulation is stopped at the first transaction which differs, which is
+  // returned. Returns std::nullopt if all of the outputs match.
+  absl::StatusOr<std::optional<CosimulationMismatch>>
+  CosimulateInputSeriesProc(
+      const absl::flat_hash_map<std::string, std::vector<Bits>>& channel_inputs,
+      const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
+      const ChannelOutputReference& reference,
+      std::optional<ReadyValidHoldoffs> holdoffs = std::nullopt) const;
+
   // Runs a function with arguments as a Span.
   absl::StatusOr<Value> RunFunction(absl::Span<const Value> inputs) const;
 
@@ -160,6 +211,34 @@ class ModuleSimulator {
   absl::Span<const VerilogInclude> includes_;
 };
 
+// Simulates batches of inputs through a module with a testbench compiled once
+// by ModuleSimulator::CompileBatchSimulator. The input vectors of a batch are
+// written to a file which the testbench reads, driving the module with the
+// same timing as ModuleSimulator::RunBatched, and the outputs are read back
+// from the output of the simulation. Each batch costs one run of the compiled
+// simulation rather than the generation and compilation of a testbench with
+// the inputs inlined.
+class BatchModuleSimulator {
+ public:
+  BatchModuleSimulator(const ModuleSignature& signature,
+                       std::unique_ptr<CompiledSimulation> simulation)
+      : signature_(signature), simulation_(std::move(simulation)) {}
+
+  // Runs the given batch of inputs through the module. Returns the outputs by
+  // port name in the order of `inputs`.
+  absl::StatusOr<std::vector<ModuleSimulator::BitsMap>> RunBatched(
+      absl::Span<const ModuleSimulator::BitsMap> inputs) const;
+
+  // Overload which accepts Values rather than Bits. The module must have a
+  // single data output.
+  absl::StatusOr<std::vector<Value>> RunBatched(
+      absl::Span<const absl::flat_hash_map<std::string, Value>> inputs) const;
+
+ private:
+  ModuleSignature signature_;
+  std::unique_ptr<CompiledSimulation> simulation_;
+};
+
 }  // namespace verilog
 }  // namespace xls
 
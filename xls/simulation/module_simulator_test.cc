@@ -14,19 +14,26 @@
 
 #include "xls/simulation/module_simulator.h"
 
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
 #include "xls/simulation/verilog_test_base.h"
 
 namespace xls {
@@ -329,6 +336,41 @@ TEST_P(ModuleSimulatorTest, CombinationalBatched) {
   EXPECT_THAT(outputs[2], ElementsAre(Pair("out", UBits(100, 8))));
 }
 
+TEST_P(ModuleSimulatorTest, CompiledBatchSimulator) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto fixed_latency, MakeFixedLatencyModule());
+  ModuleSimulator fixed_latency_simulator =
+      NewModuleSimulator(fixed_latency.first, fixed_latency.second);
+  absl::StatusOr<std::unique_ptr<BatchModuleSimulator>> fixed_latency_batch =
+      fixed_latency_simulator.CompileBatchSimulator();
+  if (absl::IsUnimplemented(fixed_latency_batch.status())) {
+    GTEST_SKIP() << "Simulator does not support separate compilation";
+  }
+  XLS_ASSERT_OK(fixed_latency_batch.status());
+
+  // The compiled simulation can be run repeatedly.
+  EXPECT_THAT(
+      (*fixed_latency_batch)
+          ->RunBatched({{{"x", UBits(44, 8)}}, {{"x", UBits(123, 8)}}}),
+      IsOkAndHolds(ElementsAre(ElementsAre(Pair("out", UBits(88, 8))),
+                               ElementsAre(Pair("out", UBits(246, 8))))));
+  EXPECT_THAT(
+      (*fixed_latency_batch)->RunBatched({{{"x", UBits(7, 8)}}}),
+      IsOkAndHolds(ElementsAre(ElementsAre(Pair("out", UBits(14, 8))))));
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto combinational, MakeCombinationalModule());
+  ModuleSimulator combinational_simulator =
+      NewModuleSimulator(combinational.first, combinational.second);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BatchModuleSimulator> batch,
+                           combinational_simulator.CompileBatchSimulator());
+  EXPECT_THAT(
+      batch->RunBatched({{{"x", UBits(99, 8)}, {"y", UBits(12, 8)}},
+                         {{"x", UBits(100, 8)}, {"y", UBits(25, 8)}},
+                         {{"x", UBits(255, 8)}, {"y", UBits(155, 8)}}}),
+      IsOkAndHolds(ElementsAre(ElementsAre(Pair("out", UBits(87, 8))),
+                               ElementsAre(Pair("out", UBits(75, 8))),
+                               ElementsAre(Pair("out", UBits(100, 8))))));
+}
+
 TEST_P(ModuleSimulatorTest, MultipleOutputs) {
   const std::string text = R"(
 module delay_3(
@@ -524,6 +566,60 @@ TEST_P(ModuleSimulatorTest, RunPipelinedProcBits) {
                                  verilog);
 }
 
+TEST_P(ModuleSimulatorTest, CosimulatePipelinedProc) {
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleGeneratorResult result, GetPipelinedProc());
+  ModuleSimulator simulator =
+      NewModuleSimulator(result.verilog_text, result.signature);
+  absl::flat_hash_map<std::string, std::vector<Bits>> input_values;
+  input_values["operand_0"] = {UBits(41, 32), UBits(32, 32), UBits(1, 32)};
+  input_values["operand_1"] = {UBits(1, 32), UBits(32, 32), UBits(2, 32)};
+
+  std::vector<int64_t> queried;
+  auto reference = [&](std::string_view channel_name,
+                       int64_t index) -> absl::StatusOr<Bits> {
+    XLS_RET_CHECK_EQ(channel_name, "result");
+    queried.push_back(index);
+    return bits_ops::Add(input_values["operand_0"].at(index),
+                         input_values["operand_1"].at(index));
+  };
+  EXPECT_THAT(simulator.CosimulateInputSeriesProc(input_values, {{"result", 3}},
+                                                  reference),
+              IsOkAndHolds(std::nullopt));
+  EXPECT_THAT(queried, ElementsAre(0, 1, 2));
+}
+
+TEST_P(ModuleSimulatorTest, CosimulatePipelinedProcStopsAtFirstMismatch) {
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleGeneratorResult result, GetPipelinedProc());
+  ModuleSimulator simulator =
+      NewModuleSimulator(result.verilog_text, result.signature);
+  absl::flat_hash_map<std::string, std::vector<Bits>> input_values;
+  input_values["operand_0"] = {UBits(41, 32), UBits(32, 32), UBits(1, 32)};
+  input_values["operand_1"] = {UBits(1, 32), UBits(32, 32), UBits(2, 32)};
+
+  // The reference disagrees with the module on the second output, so the
+  // third is never compared.
+  std::vector<Bits> expected = {UBits(42, 32), UBits(65, 32), UBits(3, 32)};
+  std::vector<int64_t> queried;
+  auto reference = [&](std::string_view channel_name,
+                       int64_t index) -> absl::StatusOr<Bits> {
+    queried.push_back(index);
+    return expected.at(index);
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::optional<CosimulationMismatch> mismatch,
+      simulator.CosimulateInputSeriesProc(input_values, {{"result", 3}},
+                                          reference));
+  ASSERT_TRUE(mismatch.has_value());
+  EXPECT_EQ(mismatch->channel_name, "result");
+  EXPECT_EQ(mismatch->index, 1);
+  EXPECT_GT(mismatch->cycle, 0);
+  EXPECT_EQ(mismatch->expected, UBits(65, 32));
+  EXPECT_EQ(mismatch->actual, UBits(64, 32));
+  EXPECT_THAT(mismatch->ToString(),
+              HasSubstr("output #1 on channel `result` mismatched"));
+  EXPECT_THAT(queried, ElementsAre(0, 1));
+}
+
 TEST_P(ModuleSimulatorTest, RunPipelinedProcValues) {
   XLS_ASSERT_OK_AND_ASSIGN(ModuleGeneratorResult result, GetPipelinedProc());
   ModuleSimulator simulator =
@@ -741,14 +741,22 @@ absl::StatusOr<ModuleTestbenchThread*> ModuleTestbench::CreateThread(
   return threads_.back().get();
 }
 
+// A value printed by the $display statement of a signal capture.
+struct SignalOutput {
+  // Id of the capture instance.
+  int64_t instance;
+  // Simulation time at which the value was captured.
+  int64_t time;
+  BitsOrX value;
+};
+
 // Scans the given simulation stdout and finds the $display statement outputs
-// associated with captured signals. Returns the signal values as Bits (or X)
-// for each output found in a map indexed by id of the capture instance.
-static absl::StatusOr<absl::flat_hash_map<int64_t, std::vector<BitsOrX>>>
-ExtractSignalValues(std::string_view stdout_str) {
+// associated with captured signals, in the order they were printed.
+static absl::StatusOr<std::vector<SignalOutput>> ParseSignalOutputs(
+    std::string_view stdout_str) {
   // Scan the simulator output and pick out the OUTPUT lines holding the value
   // of module signal.
-  absl::flat_hash_map<int64_t, std::vector<BitsOrX>> parsed_values;
+  std::vector<SignalOutput> outputs;
 
   // Example output lines for a bits value:
   //
@@ -758,14 +766,17 @@ ExtractSignalValues(std::string_view stdout_str) {
   //
   //   5 OUTPUT out0 = 16'hxxab (#1)
   RE2 re(
-      R"(\s+[0-9]+\s+OUTPUT\s(\w+)\s+=\s+([0-9]+)'h([0-9a-fA-FxX]+)\s+\(#([0-9]+)\))");
+      R"(\s*([0-9]+)\s+OUTPUT\s(\w+)\s+=\s+([0-9]+)'h([0-9a-fA-FxX]+)\s+\(#([0-9]+)\))");
+  std::string time_str;
   std::string output_name;
   std::string output_width;
   std::string output_value;
   std::string instance_str;
   std::string_view piece(stdout_str);
-  while (RE2::FindAndConsume(&piece, re, &output_name, &output_width,
-                             &output_value, &instance_str)) {
+  while (RE2::FindAndConsume(&piece, re, &time_str, &output_name,
+                             &output_width, &output_value, &instance_str)) {
+    int64_t time;
+    XLS_RET_CHECK(absl::SimpleAtoi(time_str, &time));
     int64_t width;
     XLS_RET_CHECK(absl::SimpleAtoi(output_width, &width));
     int64_t instance;
@@ -777,15 +788,32 @@ ExtractSignalValues(std::string_view stdout_str) {
 
     if (absl::StrContains(output_value, "x") ||
         absl::StrContains(output_value, "X")) {
-      parsed_values[instance].push_back(IsX());
+      outputs.push_back(
+          SignalOutput{.instance = instance, .time = time, .value = IsX()});
     } else {
       XLS_ASSIGN_OR_RETURN(
           Bits value, ParseUnsignedNumberWithoutPrefix(output_value,
                                                        FormatPreference::kHex));
       XLS_RET_CHECK_GE(width, value.bit_count());
-      parsed_values[instance].push_back(bits_ops::ZeroExtend(value, width));
+      outputs.push_back(SignalOutput{.instance = instance,
+                                     .time = time,
+                                     .value = bits_ops::ZeroExtend(value,
+                                                                   width)});
     }
   }
+  return outputs;
+}
+
+// Returns the signal values found by ParseSignalOutputs as Bits (or X) for
+// each output found in a map indexed by id of the capture instance.
+static absl::StatusOr<absl::flat_hash_map<int64_t, std::vector<BitsOrX>>>
+ExtractSignalValues(std::string_view stdout_str) {
+  XLS_ASSIGN_OR_RETURN(std::vector<SignalOutput> outputs,
+                       ParseSignalOutputs(stdout_str));
+  absl::flat_hash_map<int64_t, std::vector<BitsOrX>> parsed_values;
+  for (SignalOutput& output : outputs) {
+    parsed_values[output.instance].push_back(std::move(output.value));
+  }
   return parsed_values;
 }
 
@@ -1097,6 +1125,61 @@ std::vector<std::string> ModuleTestbench::GatherExpectedTraces() const {
   return expected_traces;
 }
 
+absl::Status ModuleTestbench::RunStreaming(
+    const CaptureCallback& on_capture) {
+  std::string verilog_text = GenerateVerilog();
+  XLS_VLOG_LINES(3, verilog_text);
+
+  absl::flat_hash_map<int64_t, const SignalCapture*> captures_by_id;
+  for (const SignalCapture& signal_capture :
+       capture_manager_.signal_captures()) {
+    captures_by_id[signal_capture.instance_id] = &signal_capture;
+  }
+
+  // Each line is parsed as it arrives; a capture callback error stops the
+  // simulation.
+  std::string stdout_str;
+  absl::Status status;
+  auto on_line = [&](std::string_view line) {
+    absl::StrAppend(&stdout_str, line, "\n");
+    absl::StatusOr<std::vector<SignalOutput>> outputs =
+        ParseSignalOutputs(line);
+    if (!outputs.ok()) {
+      status = outputs.status();
+      return false;
+    }
+    for (const SignalOutput& output : *outputs) {
+      auto it = captures_by_id.find(output.instance);
+      if (it == captures_by_id.end() ||
+          !std::holds_alternative<TestbenchCapture>(it->second->action)) {
+        continue;
+      }
+      const SignalCapture& signal_capture = *it->second;
+      if (std::holds_alternative<IsX>(output.value)) {
+        status = absl::NotFoundError(absl::StrFormat(
+            "Output `%s`, instance #%d holds X value in "
+            "Verilog simulator output.",
+            signal_capture.signal.name, signal_capture.instance_id));
+        return false;
+      }
+      const TestbenchCapture& capture =
+          std::get<TestbenchCapture>(signal_capture.action);
+      status = on_capture(capture.bits, std::get<Bits>(output.value),
+                          output.time / kClockPeriod);
+      if (!status.ok()) {
+        return false;
+      }
+    }
+    return true;
+  };
+  XLS_RETURN_IF_ERROR(
+      simulator_->RunStreaming(verilog_text, file_type_, includes_, on_line));
+  XLS_RETURN_IF_ERROR(status);
+
+  XLS_VLOG(2) << "Verilog simulator stdout:\n" << stdout_str;
+  return CaptureOutputsAndCheckExpectations(stdout_str);
+}
+
 absl::Status ModuleTestbench::Run() {
   std::string verilog_text = GenerateVerilog();
   XLS_VLOG_LINES(3, verilog_text);
@@ -16,6 +16,7 @@
 #define XLS_CODEGEN_MODULE_TESTBENCH_H_
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -430,6 +431,19 @@ class ModuleTestbench {
   // Runs the simulation.
   absl::Status Run();
 
+  // Called by RunStreaming with each value captured by a `Capture` action as
+  // the simulation produces it. `capture` is the pointer passed to `Capture`
+  // and `cycle` the clock cycle, counted from the start of the simulation, at
+  // whose end the value was captured. A non-OK status stops the simulation.
+  using CaptureCallback = std::function<absl::Status(
+      const Bits* capture, const Bits& value, int64_t cycle)>;
+
+  // Runs the simulation like Run, but also passes captured values to
+  // `on_capture` while the simulator is still running, in the order they are
+  // captured. If `on_capture` returns an error the simulation is stopped and
+  // the error is returned; otherwise expectations are checked as in Run.
+  absl::Status RunStreaming(const CaptureCallback& on_capture);
+
  private:
   // Checks the stdout of a simulation run against expectations.
   absl::Status CaptureOutputsAndCheckExpectations(
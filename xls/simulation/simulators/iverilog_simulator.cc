@@ -12,13 +12,25 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <chrono>  // NOLINT(build/c++11)
+#include <deque>
+#include <filesystem>  // NOLINT
+#include <functional>
+#include <future>  // NOLINT(build/c++11)
+#include <memory>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/strip.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/file/temp_directory.h"
@@ -57,7 +69,7 @@ absl::StatusOr<std::pair<std::string, std::string>> InvokeIverilog(
       SubprocessErrorAsStatus(InvokeSubprocess(args_vec)));
 }
 
-absl::StatusOr<std::pair<std::string, std::string>> InvokeVvp(
+absl::StatusOr<std::vector<std::string>> VvpArgv(
     absl::Span<const std::string> args) {
   std::vector<std::string> args_vec;
   XLS_ASSIGN_OR_RETURN(std::filesystem::path iverilog_path,
@@ -67,10 +79,120 @@ absl::StatusOr<std::pair<std::string, std::string>> InvokeVvp(
   args_vec.push_back(
       std::string(absl::StripSuffix(iverilog_path.string(), "vvp-bin")));
   args_vec.insert(args_vec.end(), args.begin(), args.end());
+  return args_vec;
+}
+
+absl::StatusOr<std::pair<std::string, std::string>> InvokeVvp(
+    absl::Span<const std::string> args) {
+  XLS_ASSIGN_OR_RETURN(std::vector<std::string> args_vec, VvpArgv(args));
   return SubprocessResultToStrings(
       SubprocessErrorAsStatus(InvokeSubprocess(args_vec)));
 }
 
+// Lines of output of a subprocess, filled by its stdout sink as they arrive.
+struct LineQueue {
+  absl::Mutex mutex;
+  std::deque<std::string> lines ABSL_GUARDED_BY(mutex);
+  // The output after the last newline.
+  std::string partial_line ABSL_GUARDED_BY(mutex);
+};
+
+// Runs vvp with the given arguments in the background and passes the lines of
+// its stdout to `on_line` on the calling thread as they are written. Kills vvp
+// as soon as `on_line` returns false.
+absl::Status StreamVvp(absl::Span<const std::string> args,
+                       const std::function<bool(std::string_view)>& on_line) {
+  XLS_ASSIGN_OR_RETURN(std::vector<std::string> args_vec, VvpArgv(args));
+  auto queue = std::make_shared<LineQueue>();
+  SubprocessOptions options;
+  options.stdout_sink = [queue](std::string_view chunk) {
+    absl::MutexLock lock(&queue->mutex);
+    queue->partial_line.append(chunk);
+    size_t start = 0;
+    for (size_t end = queue->partial_line.find('\n');
+         end != std::string::npos;
+         end = queue->partial_line.find('\n', start)) {
+      queue->lines.push_back(queue->partial_line.substr(start, end - start));
+      start = end + 1;
+    }
+    queue->partial_line.erase(0, start);
+  };
+  std::unique_ptr<AsyncSubprocess> vvp =
+      InvokeSubprocessAsync(std::move(args_vec), std::move(options));
+  std::shared_future<absl::StatusOr<SubprocessResult>> result = vvp->result();
+
+  bool exited = false;
+  while (true) {
+    std::deque<std::string> lines;
+    {
+      absl::MutexLock lock(&queue->mutex);
+      if (exited) {
+        // The sink has seen all of the output; the last line may lack a
+        // newline.
+        if (!queue->partial_line.empty()) {
+          queue->lines.push_back(std::move(queue->partial_line));
+          queue->partial_line.clear();
+        }
+      } else {
+        // Wakes up now and then to check whether vvp has exited.
+        queue->mutex.AwaitWithTimeout(
+            absl::Condition(
+                +[](LineQueue* q) ABSL_EXCLUSIVE_LOCKS_REQUIRED(q->mutex) {
+                  return !q->lines.empty();
+                },
+                queue.get()),
+            absl::Milliseconds(10));
+      }
+      lines.swap(queue->lines);
+    }
+    for (const std::string& line : lines) {
+      if (!on_line(line)) {
+        vvp->Kill();
+        return absl::OkStatus();
+      }
+    }
+    if (exited) {
+      break;
+    }
+    exited = result.wait_for(std::chrono::seconds(0)) ==
+             std::future_status::ready;
+  }
+  return SubprocessErrorAsStatus(result.get()).status();
+}
+
+// A testbench compiled by iverilog. Each run invokes vvp on the compiled
+// output, which is kept in a temporary directory for the lifetime of the
+// object.
+class IcarusCompiledSimulation : public CompiledSimulation {
+ public:
+  IcarusCompiledSimulation(TempDirectory temp_dir,
+                           std::filesystem::path vvp_path)
+      : temp_dir_(std::move(temp_dir)), vvp_path_(std::move(vvp_path)) {}
+
+  absl::StatusOr<std::pair<std::string, std::string>> Run(
+      absl::Span<const std::string> plusargs) const override {
+    std::vector<std::string> args = {vvp_path_.string()};
+    for (const std::string& plusarg : plusargs) {
+      args.push_back(absl::StrCat("+", plusarg));
+    }
+    return InvokeVvp(args);
+  }
+
+  absl::Status RunStreaming(
+      absl::Span<const std::string> plusargs,
+      const std::function<bool(std::string_view)>& on_line) const override {
+    std::vector<std::string> args = {vvp_path_.string()};
+    for (const std::string& plusarg : plusargs) {
+      args.push_back(absl::StrCat("+", plusarg));
+    }
+    return StreamVvp(args, on_line);
+  }
+
+ private:
+  TempDirectory temp_dir_;
+  std::filesystem::path vvp_path_;
+};
+
 class IcarusVerilogSimulator : public VerilogSimulator {
  public:
   absl::StatusOr<std::pair<std::string, std::string>> Run(
@@ -98,6 +220,28 @@ class IcarusVerilogSimulator : public VerilogSimulator {
     return InvokeVvp({temp_out.path().string()});
   }
 
+  absl::StatusOr<std::unique_ptr<CompiledSimulation>> Compile(
+      std::string_view text, FileType file_type,
+      absl::Span<const VerilogInclude> includes) const override {
+    if (file_type == FileType::kSystemVerilog) {
+      return absl::UnimplementedError(
+          "iverilog does not support SystemVerilog");
+    }
+    XLS_ASSIGN_OR_RETURN(TempDirectory temp_top, TempDirectory::Create());
+    std::filesystem::path temp_dir = temp_top.path();
+
+    std::string top_v_path = temp_dir / GetTopFileName(file_type);
+    XLS_RETURN_IF_ERROR(SetFileContents(top_v_path, text));
+    XLS_RETURN_IF_ERROR(SetUpIncludes(temp_dir, includes));
+
+    std::filesystem::path vvp_path = temp_dir / "top.vvp";
+    XLS_RETURN_IF_ERROR(InvokeIverilog({top_v_path, "-o", vvp_path.string(),
+                                        "-I", temp_dir.string()})
+                            .status());
+    return std::make_unique<IcarusCompiledSimulation>(std::move(temp_top),
+                                                      std::move(vvp_path));
+  }
+
   absl::Status RunSyntaxChecking(
       std::string_view text, FileType file_type,
       absl::Span<const VerilogInclude> includes) const override {
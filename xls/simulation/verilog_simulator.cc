@@ -15,25 +15,32 @@
 #include "xls/simulation/verilog_simulator.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
 #include "absl/flags/flag.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/temp_directory.h"
 #include "xls/common/file/temp_file.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/subprocess.h"
+#include "xls/common/thread.h"
 #include "re2/re2.h"
 
 namespace xls {
@@ -90,8 +97,39 @@ absl::StatusOr<std::vector<Observation>> StdoutToObservations(
   return result;
 }
 
+// Returns a key identifying the source of the simulation of `request`.
+std::string SimulationSourceKey(const SimulationRequest& request) {
+  std::string key = absl::StrCat(static_cast<int>(request.file_type), ":",
+                                 request.text.size(), ":", request.text);
+  for (const VerilogInclude& include : request.includes) {
+    absl::StrAppend(&key, ":", include.relative_path.string().size(), ":",
+                    include.relative_path.string(), ":",
+                    include.verilog_text.size(), ":", include.verilog_text);
+  }
+  return key;
+}
+
+// Passes the lines of `output` to `on_line` until it returns false.
+void PassLines(std::string_view output,
+               const std::function<bool(std::string_view)>& on_line) {
+  for (std::string_view line :
+       absl::StrSplit(output, '\n', absl::SkipEmpty())) {
+    if (!on_line(line)) {
+      return;
+    }
+  }
+}
+
 }  // namespace
 
+absl::Status CompiledSimulation::RunStreaming(
+    absl::Span<const std::string> plusargs,
+    const std::function<bool(std::string_view)>& on_line) const {
+  XLS_ASSIGN_OR_RETURN(auto stdout_stderr, Run(plusargs));
+  PassLines(stdout_stderr.first, on_line);
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::pair<std::string, std::string>> VerilogSimulator::Run(
     std::string_view text, FileType file_type) const {
   return Run(text, file_type, /*includes=*/{});
@@ -102,6 +140,30 @@ absl::Status VerilogSimulator::RunSyntaxChecking(std::string_view text,
   return RunSyntaxChecking(text, file_type, /*includes=*/{});
 }
 
+absl::StatusOr<std::unique_ptr<CompiledSimulation>> VerilogSimulator::Compile(
+    std::string_view text, FileType file_type,
+    absl::Span<const VerilogInclude> includes) const {
+  return absl::UnimplementedError(
+      "Verilog simulator does not support separate compilation");
+}
+
+absl::Status VerilogSimulator::RunStreaming(
+    std::string_view text, FileType file_type,
+    absl::Span<const VerilogInclude> includes,
+    const std::function<bool(std::string_view)>& on_line) const {
+  absl::StatusOr<std::unique_ptr<CompiledSimulation>> simulation =
+      Compile(text, file_type, includes);
+  if (simulation.ok()) {
+    return (*simulation)->RunStreaming(/*plusargs=*/{}, on_line);
+  }
+  if (!absl::IsUnimplemented(simulation.status())) {
+    return simulation.status();
+  }
+  XLS_ASSIGN_OR_RETURN(auto stdout_stderr, Run(text, file_type, includes));
+  PassLines(stdout_stderr.first, on_line);
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::vector<Observation>>
 VerilogSimulator::SimulateCombinational(
     std::string_view text, FileType file_type,
@@ -111,6 +173,79 @@ VerilogSimulator::SimulateCombinational(
   return StdoutToObservations(stdout_stderr.first, to_observe);
 }
 
+VerilogSimulatorPool::VerilogSimulatorPool(const VerilogSimulator* simulator,
+                                           int64_t max_concurrency)
+    : simulator_(simulator),
+      max_concurrency_(max_concurrency > 0
+                           ? max_concurrency
+                           : std::max<int64_t>(
+                                 1, std::thread::hardware_concurrency())) {}
+
+absl::StatusOr<const CompiledSimulation*>
+VerilogSimulatorPool::GetCompiledSimulation(const SimulationRequest& request) {
+  Compilation* compilation;
+  {
+    absl::MutexLock lock(&mutex_);
+    std::unique_ptr<Compilation>& entry =
+        compilations_[SimulationSourceKey(request)];
+    if (entry == nullptr) {
+      entry = std::make_unique<Compilation>();
+    }
+    compilation = entry.get();
+  }
+  absl::MutexLock lock(&compilation->mutex);
+  if (!compilation->done) {
+    compilation->simulation =
+        simulator_->Compile(request.text, request.file_type, request.includes);
+    compilation->done = true;
+  }
+  if (absl::IsUnimplemented(compilation->simulation.status())) {
+    return nullptr;
+  }
+  XLS_RETURN_IF_ERROR(compilation->simulation.status());
+  return compilation->simulation->get();
+}
+
+absl::StatusOr<std::pair<std::string, std::string>> VerilogSimulatorPool::Run(
+    const SimulationRequest& request) {
+  XLS_ASSIGN_OR_RETURN(const CompiledSimulation* simulation,
+                       GetCompiledSimulation(request));
+  if (simulation != nullptr) {
+    return simulation->Run(request.plusargs);
+  }
+  if (!request.plusargs.empty()) {
+    return absl::UnimplementedError(
+        "Plusargs require a simulator which supports separate compilation");
+  }
+  return simulator_->Run(request.text, request.file_type, request.includes);
+}
+
+std::vector<absl::StatusOr<std::pair<std::string, std::string>>>
+VerilogSimulatorPool::RunAll(absl::Span<const SimulationRequest> requests) {
+  std::vector<absl::StatusOr<std::pair<std::string, std::string>>> results(
+      requests.size());
+  if (requests.empty()) {
+    return results;
+  }
+  std::atomic<int64_t> next_request = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_request++; i < requests.size(); i = next_request++) {
+      results[i] = Run(requests[i]);
+    }
+  };
+  {
+    int64_t thread_count =
+        std::min<int64_t>(max_concurrency_, requests.size());
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t i = 0; i < thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    // Threads are joined on destruction.
+  }
+  return results;
+}
+
 VerilogSimulatorManager& GetVerilogSimulatorManagerSingleton() {
   static VerilogSimulatorManager* manager = new VerilogSimulatorManager;
   return *manager;
@@ -15,16 +15,20 @@
 #ifndef XLS_SIMULATION_VERILOG_SIMULATOR_H_
 #define XLS_SIMULATION_VERILOG_SIMULATOR_H_
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/codegen/name_to_bit_count.h"
 #include "xls/codegen/vast.h"
@@ -40,6 +44,28 @@ struct Observation {
   Bits value;
 };
 
+// A simulation which has been compiled once and may be run many times. Values
+// which vary between runs (e.g., the path of a file of input vectors) are
+// passed as plusargs and read in Verilog with $value$plusargs.
+class CompiledSimulation {
+ public:
+  virtual ~CompiledSimulation() = default;
+
+  // Runs the simulation with the given plusargs (e.g., "input_file=/tmp/in",
+  // without the leading '+') and returns the stdout/stderr as a string pair.
+  virtual absl::StatusOr<std::pair<std::string, std::string>> Run(
+      absl::Span<const std::string> plusargs) const = 0;
+
+  // Runs the simulation with the given plusargs, passing each line of stdout
+  // (without the newline) to `on_line` as the simulation produces it. If
+  // `on_line` returns false the simulation is stopped and no further lines
+  // are passed. The default implementation runs the simulation to completion
+  // before passing any lines.
+  virtual absl::Status RunStreaming(
+      absl::Span<const std::string> plusargs,
+      const std::function<bool(std::string_view)>& on_line) const;
+};
+
 // Interface wrapping a Verilog simulator such Icarus verilog.
 class VerilogSimulator {
  public:
@@ -60,6 +86,21 @@ class VerilogSimulator {
   absl::Status RunSyntaxChecking(std::string_view text,
                                  FileType file_type) const;
 
+  // Compiles the given Verilog text into a simulation which can be run
+  // repeatedly without recompiling. Returns an UnimplementedError if the
+  // simulator does not support separate compilation.
+  virtual absl::StatusOr<std::unique_ptr<CompiledSimulation>> Compile(
+      std::string_view text, FileType file_type,
+      absl::Span<const VerilogInclude> includes) const;
+
+  // Runs the given Verilog text, passing each line of stdout to `on_line` as
+  // in CompiledSimulation::RunStreaming. Simulators which do not support
+  // separate compilation run to completion before passing any lines.
+  absl::Status RunStreaming(
+      std::string_view text, FileType file_type,
+      absl::Span<const VerilogInclude> includes,
+      const std::function<bool(std::string_view)>& on_line) const;
+
   // Simulation runner harness: runs the given Verilog text using the verilog
   // simulator infrastructure and returns observations of data values that arose
   // during simulation.
@@ -82,6 +123,62 @@ class VerilogSimulator {
   }
 };
 
+// A single simulation to be run by a VerilogSimulatorPool.
+struct SimulationRequest {
+  std::string text;
+  FileType file_type = FileType::kVerilog;
+  std::vector<VerilogInclude> includes;
+  // Plusargs passed to the simulation (without the leading '+'). Only
+  // supported by simulators which support separate compilation.
+  std::vector<std::string> plusargs;
+};
+
+// Runs many simulations with a VerilogSimulator, at most `max_concurrency` of
+// them at a time. If the simulator supports separate compilation then each
+// distinct source (text, file type and includes) is compiled once and the
+// compiled simulation is reused by every run of that source, including runs in
+// later calls to RunAll. Otherwise each run invokes VerilogSimulator::Run.
+// Thread-safe.
+class VerilogSimulatorPool {
+ public:
+  // A `max_concurrency` of zero uses the number of hardware threads.
+  explicit VerilogSimulatorPool(const VerilogSimulator* simulator,
+                                int64_t max_concurrency = 0);
+
+  // Runs a single simulation and returns the stdout/stderr as a string pair.
+  absl::StatusOr<std::pair<std::string, std::string>> Run(
+      const SimulationRequest& request);
+
+  // Runs all of the given simulations and returns their results in the order
+  // of `requests`. A failing simulation does not affect the others.
+  std::vector<absl::StatusOr<std::pair<std::string, std::string>>> RunAll(
+      absl::Span<const SimulationRequest> requests);
+
+  int64_t max_concurrency() const { return max_concurrency_; }
+
+ private:
+  // The compilation of one source, shared by all runs of that source. The
+  // mutex is held while compiling so a source is compiled at most once.
+  struct Compilation {
+    absl::Mutex mutex;
+    bool done ABSL_GUARDED_BY(mutex) = false;
+    absl::StatusOr<std::unique_ptr<CompiledSimulation>> simulation
+        ABSL_GUARDED_BY(mutex);
+  };
+
+  // Returns the compiled simulation of the source of `request`, or nullptr if
+  // the simulator does not support separate compilation.
+  absl::StatusOr<const CompiledSimulation*> GetCompiledSimulation(
+      const SimulationRequest& request);
+
+  const VerilogSimulator* simulator_;
+  int64_t max_concurrency_;
+
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::unique_ptr<Compilation>> compilations_
+      ABSL_GUARDED_BY(mutex_);
+};
+
 // An abstraction which holds multiple VerilogSimulator objects organized by
 // name.
 class VerilogSimulatorManager {
@@ -14,10 +14,15 @@
 
 #include "xls/simulation/verilog_simulator.h"
 
+#include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "xls/common/status/matchers.h"
 #include "xls/simulation/verilog_simulators.h"
 #include "xls/simulation/verilog_test_base.h"
@@ -28,6 +33,7 @@ namespace {
 
 using status_testing::StatusIs;
 using ::testing::HasSubstr;
+using ::testing::IsEmpty;
 
 class VerilogSimulatorTest : public VerilogTestBase {};
 
@@ -133,6 +139,37 @@ endmodule
   XLS_EXPECT_OK(GetSimulator()->Run(text, FileType::kSystemVerilog));
 }
 
+TEST_P(VerilogSimulatorTest, PoolRunsSimulations) {
+  auto make_request = [&](int64_t value) {
+    SimulationRequest request;
+    request.text = absl::StrFormat(R"(module tb;
+  initial begin
+    $display("value: %%d", %d);
+  end
+endmodule
+)",
+                                   value);
+    request.file_type = GetFileType();
+    return request;
+  };
+  std::vector<SimulationRequest> requests;
+  for (int64_t i = 0; i < 6; ++i) {
+    // Requests with the same source share a compiled simulation.
+    requests.push_back(make_request(i % 3));
+  }
+
+  VerilogSimulatorPool pool(GetSimulator(), /*max_concurrency=*/2);
+  std::vector<absl::StatusOr<std::pair<std::string, std::string>>> results =
+      pool.RunAll(requests);
+  ASSERT_EQ(results.size(), 6);
+  for (int64_t i = 0; i < results.size(); ++i) {
+    XLS_ASSERT_OK(results[i].status());
+    EXPECT_THAT(results[i]->first,
+                HasSubstr(absl::StrFormat("value: %d", i % 3)));
+  }
+  EXPECT_THAT(pool.RunAll({}), IsEmpty());
+}
+
 INSTANTIATE_TEST_SUITE_P(VerilogSimulatorTestInstantiation,
                          VerilogSimulatorTest,
                          testing::ValuesIn(kDefaultSimulationTargets),
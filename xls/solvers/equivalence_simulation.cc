@@ -0,0 +1,218 @@
+// Copyright 2021 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/equivalence_simulation.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/type.h"
+#include "xls/jit/batched_random_values.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+namespace solvers {
+namespace {
+
+// Returns a value of the given type with every bits leaf set to
+// `leaf(bit_count)`.
+Value FillLeaves(Type* type, const std::function<Bits(int64_t)>& leaf) {
+  switch (type->kind()) {
+    case TypeKind::kBits:
+      return Value(leaf(type->AsBitsOrDie()->bit_count()));
+    case TypeKind::kTuple: {
+      std::vector<Value> elements;
+      for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+        elements.push_back(FillLeaves(element_type, leaf));
+      }
+      return Value::TupleOwned(std::move(elements));
+    }
+    case TypeKind::kArray: {
+      ArrayType* array_type = type->AsArrayOrDie();
+      std::vector<Value> elements(
+          array_type->size(), FillLeaves(array_type->element_type(), leaf));
+      return Value::ArrayOwned(std::move(elements));
+    }
+    case TypeKind::kToken:
+      return Value::Token();
+  }
+  XLS_LOG(FATAL) << "Unknown type kind: " << type->ToString();
+}
+
+// Runs both JITs on a batch of argument sets and returns the index of the
+// first one on which the results differ.
+absl::StatusOr<std::optional<int64_t>> FirstMismatch(
+    FunctionJit* jit_a, FunctionJit* jit_b,
+    absl::Span<const std::vector<Value>> args_batch) {
+  XLS_ASSIGN_OR_RETURN(InterpreterResult<std::vector<Value>> results_a,
+                       jit_a->RunBatch(args_batch));
+  XLS_ASSIGN_OR_RETURN(InterpreterResult<std::vector<Value>> results_b,
+                       jit_b->RunBatch(args_batch));
+  for (int64_t i = 0; i < args_batch.size(); ++i) {
+    if (results_a.value[i] != results_b.value[i]) {
+      return i;
+    }
+  }
+  return std::nullopt;
+}
+
+// As above, but on `batch_size` argument sets given in the native layout as
+// one column per parameter.
+absl::StatusOr<std::optional<int64_t>> FirstMismatch(
+    FunctionJit* jit_a, FunctionJit* jit_b,
+    absl::Span<const uint8_t* const> arg_columns, int64_t batch_size) {
+  const int64_t result_size = jit_a->GetReturnTypeSize();
+  std::vector<uint8_t> results_a(batch_size * result_size);
+  std::vector<uint8_t> results_b(batch_size * result_size);
+  InterpreterEvents events;
+  XLS_RETURN_IF_ERROR(jit_a->RunBatch(arg_columns, absl::MakeSpan(results_a),
+                                      batch_size, &events));
+  XLS_RETURN_IF_ERROR(jit_b->RunBatch(arg_columns, absl::MakeSpan(results_b),
+                                      batch_size, &events));
+  const TypeLayout& result_layout = jit_a->GetReturnTypeLayout();
+  for (int64_t i = 0; i < batch_size; ++i) {
+    const uint8_t* result_a = results_a.data() + i * result_size;
+    const uint8_t* result_b = results_b.data() + i * result_size;
+    // Equal bytes are equal values; otherwise padding may differ so compare
+    // the values.
+    if (std::memcmp(result_a, result_b, result_size) != 0 &&
+        result_layout.NativeLayoutToValue(result_a) !=
+            result_layout.NativeLayoutToValue(result_b)) {
+      return i;
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+std::vector<std::vector<Value>> CornerCaseArguments(Function* f) {
+  const std::vector<std::function<Bits(int64_t)>> corners = {
+      [](int64_t bit_count) { return Bits(bit_count); },
+      [](int64_t bit_count) { return UBits(bit_count > 0 ? 1 : 0, bit_count); },
+      [](int64_t bit_count) { return Bits::AllOnes(bit_count); },
+      [](int64_t bit_count) {
+        return bit_count > 0 ? Bits::MinSigned(bit_count) : Bits();
+      },
+      [](int64_t bit_count) {
+        return bit_count > 0 ? Bits::MaxSigned(bit_count) : Bits();
+      },
+  };
+  std::vector<Value> zeros;
+  for (Param* param : f->params()) {
+    zeros.push_back(FillLeaves(param->GetType(), corners[0]));
+  }
+
+  std::vector<std::vector<Value>> args_batch;
+  for (const auto& corner : corners) {
+    std::vector<Value> args;
+    for (Param* param : f->params()) {
+      args.push_back(FillLeaves(param->GetType(), corner));
+    }
+    args_batch.push_back(std::move(args));
+  }
+  if (f->params().size() > 1) {
+    for (int64_t i = 0; i < f->params().size(); ++i) {
+      for (int64_t c = 1; c < corners.size(); ++c) {
+        std::vector<Value> args = zeros;
+        args[i] = FillLeaves(f->params()[i]->GetType(), corners[c]);
+        args_batch.push_back(std::move(args));
+      }
+    }
+  }
+  return args_batch;
+}
+
+absl::StatusOr<std::optional<std::vector<Value>>>
+FindCounterexampleBySimulation(Function* a, Function* b,
+                               const EquivalenceSimulationOptions& options) {
+  XLS_RET_CHECK_EQ(a->params().size(), b->params().size());
+  for (int64_t i = 0; i < a->params().size(); ++i) {
+    XLS_RET_CHECK(
+        a->params()[i]->GetType()->IsEqualTo(b->params()[i]->GetType()))
+        << absl::StreamFormat("Parameter %d types differ: %s vs %s", i,
+                              a->params()[i]->GetType()->ToString(),
+                              b->params()[i]->GetType()->ToString());
+  }
+  XLS_RET_CHECK(a->GetType()->return_type()->IsEqualTo(
+      b->GetType()->return_type()));
+
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<FunctionJit> jit_a,
+      FunctionJit::Create(a, /*opt_level=*/3, /*profile=*/nullptr,
+                          /*build_batched_wrapper=*/true));
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<FunctionJit> jit_b,
+      FunctionJit::Create(b, /*opt_level=*/3, /*profile=*/nullptr,
+                          /*build_batched_wrapper=*/true));
+
+  std::vector<std::vector<Value>> args_batch = CornerCaseArguments(a);
+  XLS_ASSIGN_OR_RETURN(std::optional<int64_t> mismatch,
+                       FirstMismatch(jit_a.get(), jit_b.get(), args_batch));
+  if (mismatch.has_value()) {
+    return args_batch[*mismatch];
+  }
+
+  // The random arguments are generated directly in the native layout, which
+  // avoids building (and laying out) a Value per argument.
+  BatchedRandomValueGenerator generator(options.seed);
+  const int64_t batch_size = std::max<int64_t>(options.batch_size, 1);
+  const int64_t param_count = a->params().size();
+  std::vector<std::vector<uint8_t>> arg_columns(param_count);
+  std::vector<const uint8_t*> arg_column_ptrs(param_count);
+  for (int64_t i = 0; i < param_count; ++i) {
+    arg_columns[i].resize(batch_size * jit_a->GetArgTypeSize(i));
+    arg_column_ptrs[i] = arg_columns[i].data();
+  }
+  for (int64_t start = 0; start < options.random_sample_count;
+       start += batch_size) {
+    const int64_t count =
+        std::min(batch_size, options.random_sample_count - start);
+    for (int64_t i = 0; i < param_count; ++i) {
+      generator.Fill(jit_a->GetArgTypeLayout(i), count,
+                     absl::MakeSpan(arg_columns[i]));
+    }
+    XLS_ASSIGN_OR_RETURN(
+        mismatch,
+        FirstMismatch(jit_a.get(), jit_b.get(), arg_column_ptrs, count));
+    if (mismatch.has_value()) {
+      std::vector<Value> args;
+      for (int64_t i = 0; i < param_count; ++i) {
+        args.push_back(jit_a->GetArgTypeLayout(i).NativeLayoutToValue(
+            arg_columns[i].data() + *mismatch * jit_a->GetArgTypeSize(i)));
+      }
+      return args;
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace solvers
+}  // namespace xls
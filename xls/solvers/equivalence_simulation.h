@@ -0,0 +1,62 @@
+// Copyright 2021 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Random simulation used to look for counterexamples to the equivalence of two
+// functions before resorting to a solver.
+#ifndef XLS_SOLVERS_EQUIVALENCE_SIMULATION_H_
+#define XLS_SOLVERS_EQUIVALENCE_SIMULATION_H_
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "xls/ir/function.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace solvers {
+
+struct EquivalenceSimulationOptions {
+  // Number of random argument sets to try after the corner cases.
+  int64_t random_sample_count = 4096;
+
+  // Number of argument sets run through the JIT with a single call.
+  int64_t batch_size = 256;
+
+  // Seed of the random argument generator.
+  int64_t seed = 0;
+};
+
+// Returns the corner-case argument sets tried by
+// FindCounterexampleBySimulation: every parameter set to each of zero, one,
+// all ones, the minimum and the maximum signed value (applied to every leaf of
+// aggregate parameters), and each parameter set to each of those values in
+// turn with the others zero.
+std::vector<std::vector<Value>> CornerCaseArguments(Function* f);
+
+// Runs `a` and `b`, which must have the same parameter and return types,
+// through the JIT on the corner-case arguments of `a` followed by random
+// arguments, and returns the first argument set on which their results differ,
+// or std::nullopt if they agree on all of them. Only return values are
+// compared; assertions and traces are ignored.
+absl::StatusOr<std::optional<std::vector<Value>>>
+FindCounterexampleBySimulation(Function* a, Function* b,
+                               const EquivalenceSimulationOptions& options =
+                                   EquivalenceSimulationOptions());
+
+}  // namespace solvers
+}  // namespace xls
+
+#endif  // XLS_SOLVERS_EQUIVALENCE_SIMULATION_H_
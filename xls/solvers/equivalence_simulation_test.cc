@@ -0,0 +1,122 @@
+// Copyright 2021 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/equivalence_simulation.h"
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace solvers {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::ElementsAre;
+using ::testing::Optional;
+
+constexpr char kPackage[] = R"(
+package p
+
+fn add(x: bits[8], y: bits[8]) -> bits[8] {
+  ret add.1: bits[8] = add(x, y)
+}
+
+fn add_commuted(x: bits[8], y: bits[8]) -> bits[8] {
+  ret add.2: bits[8] = add(y, x)
+}
+
+fn add_wrong_at_all_ones(x: bits[8], y: bits[8]) -> bits[8] {
+  add.3: bits[8] = add(x, y)
+  all_ones: bits[8] = literal(value=255)
+  zero: bits[8] = literal(value=0)
+  is_all_ones: bits[1] = eq(x, all_ones)
+  ret sel.4: bits[8] = sel(is_all_ones, cases=[add.3, zero])
+}
+
+fn add_wrong_at_bit_5(x: bits[8], y: bits[8]) -> bits[8] {
+  add.5: bits[8] = add(x, y)
+  bit_5: bits[1] = bit_slice(x, start=5, width=1)
+  bit_0: bits[1] = bit_slice(x, start=0, width=1)
+  not_bit_0: bits[1] = not(bit_0)
+  both: bits[1] = and(bit_5, not_bit_0)
+  one: bits[8] = literal(value=1)
+  wrong: bits[8] = add(add.5, one)
+  ret sel.6: bits[8] = sel(both, cases=[add.5, wrong])
+}
+)";
+
+class EquivalenceSimulationTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(package_, Parser::ParsePackage(kPackage));
+  }
+
+  Function* GetFunction(std::string_view name) {
+    return package_->GetFunction(name).value();
+  }
+
+  std::unique_ptr<Package> package_;
+};
+
+TEST_F(EquivalenceSimulationTest, CornerCases) {
+  std::vector<std::vector<Value>> args =
+      CornerCaseArguments(GetFunction("add"));
+  // Five cases with both parameters equal, then four per parameter with the
+  // other zero.
+  EXPECT_EQ(args.size(), 13);
+  EXPECT_THAT(args[2], ElementsAre(Value(UBits(255, 8)), Value(UBits(255, 8))));
+  EXPECT_THAT(args[3], ElementsAre(Value(UBits(128, 8)), Value(UBits(128, 8))));
+  EXPECT_THAT(args[5], ElementsAre(Value(UBits(1, 8)), Value(UBits(0, 8))));
+}
+
+TEST_F(EquivalenceSimulationTest, EquivalentFunctions) {
+  EXPECT_THAT(FindCounterexampleBySimulation(GetFunction("add"),
+                                             GetFunction("add_commuted")),
+              IsOkAndHolds(std::nullopt));
+}
+
+TEST_F(EquivalenceSimulationTest, CornerCaseCounterexample) {
+  EXPECT_THAT(
+      FindCounterexampleBySimulation(GetFunction("add"),
+                                     GetFunction("add_wrong_at_all_ones"),
+                                     EquivalenceSimulationOptions{
+                                         .random_sample_count = 0}),
+      IsOkAndHolds(Optional(
+          ElementsAre(Value(UBits(255, 8)), Value(UBits(255, 8))))));
+}
+
+// None of the corner cases has bit 5 set and bit 0 clear.
+TEST_F(EquivalenceSimulationTest, RandomCounterexample) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::optional<std::vector<Value>> counterexample,
+      FindCounterexampleBySimulation(GetFunction("add"),
+                                     GetFunction("add_wrong_at_bit_5")));
+  ASSERT_TRUE(counterexample.has_value());
+  EXPECT_TRUE(counterexample->at(0).bits().Get(5));
+  EXPECT_FALSE(counterexample->at(0).bits().Get(0));
+}
+
+}  // namespace
+}  // namespace solvers
+}  // namespace xls
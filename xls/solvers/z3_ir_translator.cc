@@ -21,9 +21,11 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/debugging/leak_check.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
@@ -1462,11 +1464,45 @@ static absl::StatusOr<Z3_ast> PredicateToObjective(Predicate p, Z3_ast a,
   return objective;
 }
 
-absl::StatusOr<bool> TryProve(Function* f, Node* subject, Predicate p,
-                              absl::Duration timeout) {
-  XLS_ASSIGN_OR_RETURN(auto translator, IrTranslator::CreateAndTranslate(f));
-  translator->SetTimeout(timeout);
-  Z3_ast value = translator->GetTranslation(subject);
+absl::StatusOr<std::unique_ptr<IncrementalProver>> IncrementalProver::Create(
+    FunctionBase* source, bool allow_unsupported) {
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<IrTranslator> translator,
+      IrTranslator::CreateAndTranslate(source, allow_unsupported));
+  return absl::WrapUnique(new IncrementalProver(std::move(translator)));
+}
+
+IncrementalProver::IncrementalProver(std::unique_ptr<IrTranslator> translator)
+    : translator_(std::move(translator)),
+      solver_(CreateSolver(translator_->ctx(), 1)) {}
+
+IncrementalProver::~IncrementalProver() {
+  Z3_solver_dec_ref(ctx(), solver_);
+}
+
+void IncrementalProver::SetTimeout(absl::Duration timeout) {
+  Z3_params params = Z3_mk_params(ctx());
+  Z3_params_inc_ref(ctx(), params);
+  Z3_params_set_uint(ctx(), params, Z3_mk_string_symbol(ctx(), "timeout"),
+                     static_cast<unsigned>(absl::ToInt64Milliseconds(timeout)));
+  Z3_solver_set_params(ctx(), solver_, params);
+  Z3_params_dec_ref(ctx(), params);
+}
+
+Z3_lbool IncrementalProver::Check(Z3_ast formula) {
+  // Rather than push/pop (which discards what the solver learned inside the
+  // scope), guard the formula with a fresh literal, check under the
+  // assumption that the literal holds, and then permanently retire it.
+  Z3_ast guard = Z3_mk_fresh_const(ctx(), "query", Z3_mk_bool_sort(ctx()));
+  Z3_solver_assert(ctx(), solver_, Z3_mk_implies(ctx(), guard, formula));
+  Z3_lbool satisfiable = Z3_solver_check_assumptions(ctx(), solver_, 1, &guard);
+  XLS_VLOG(2) << SolverResultToString(ctx(), solver_, satisfiable);
+  Z3_solver_assert(ctx(), solver_, Z3_mk_not(ctx(), guard));
+  return satisfiable;
+}
+
+absl::StatusOr<bool> IncrementalProver::TryProve(Node* subject, Predicate p) {
+  Z3_ast value = translator_->GetTranslation(subject);
 
   // All token types are equal.
   if (subject->GetType()->IsToken() &&
@@ -1474,29 +1510,27 @@ absl::StatusOr<bool> TryProve(Function* f, Node* subject, Predicate p,
       p.node()->GetType()->IsToken()) {
     return true;
   }
-  if (translator->GetValueKind(value) != Z3_BV_SORT) {
+  if (translator_->GetValueKind(value) != Z3_BV_SORT) {
     return absl::InvalidArgumentError(
         "Cannot prove properties of non-bits-typed node: " +
         subject->ToString());
   }
   XLS_ASSIGN_OR_RETURN(Z3_ast objective,
-                       PredicateToObjective(p, value, translator.get()));
-  Z3_context ctx = translator->ctx();
-  XLS_VLOG(2) << "objective:\n" << Z3_ast_to_string(ctx, objective);
-  Z3_solver solver = solvers::z3::CreateSolver(ctx, 1);
-  Z3_solver_assert(ctx, solver, objective);
-  Z3_lbool satisfiable = Z3_solver_check(ctx, solver);
-  XLS_VLOG(2) << solvers::z3::SolverResultToString(ctx, solver, satisfiable);
-  Z3_solver_dec_ref(ctx, solver);
-
-  if (Z3_solver_check(ctx, solver) == Z3_L_FALSE) {
-    // We posit the inverse of the predicate we want to check -- when that is
-    // unsatisfiable, the predicate has been proven (there was no way found that
-    // we could not satisfy its inverse).
-    return true;
-  }
+                       PredicateToObjective(p, value, translator_.get()));
+  XLS_VLOG(2) << "objective:\n" << Z3_ast_to_string(ctx(), objective);
 
-  return false;
+  // We posit the inverse of the predicate we want to check -- when that is
+  // unsatisfiable, the predicate has been proven (there was no way found that
+  // we could not satisfy its inverse).
+  return Check(objective) == Z3_L_FALSE;
+}
+
+absl::StatusOr<bool> TryProve(Function* f, Node* subject, Predicate p,
+                              absl::Duration timeout) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IncrementalProver> prover,
+                       IncrementalProver::Create(f));
+  prover->SetTimeout(timeout);
+  return prover->TryProve(subject, p);
 }
 
 }  // namespace z3
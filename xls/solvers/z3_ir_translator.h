@@ -322,8 +322,44 @@ class Predicate {
   std::optional<Node*> node_;
 };
 
+// Answers a series of queries about the nodes of a single function. The
+// function is translated once, and every query reuses that translation and a
+// single incremental solver (so lemmas learned by one query can speed up the
+// next), instead of paying for a fresh translation and solver per query.
+// The function must not be modified while the prover is alive.
+class IncrementalProver {
+ public:
+  static absl::StatusOr<std::unique_ptr<IncrementalProver>> Create(
+      FunctionBase* source, bool allow_unsupported = false);
+  ~IncrementalProver();
+
+  // Sets the amount of time each query may run before giving up.
+  void SetTimeout(absl::Duration timeout);
+
+  // Attempts to prove node "subject" satisfies the given predicate over all
+  // possible inputs. Returns false if that could not be shown, including when
+  // the query timed out.
+  absl::StatusOr<bool> TryProve(Node* subject, Predicate p);
+
+  // Returns whether the given Boolean-sorted formula (built in ctx()) is
+  // satisfiable. The formula is only assumed for the duration of this query;
+  // it does not constrain later ones.
+  Z3_lbool Check(Z3_ast formula);
+
+  IrTranslator* translator() { return translator_.get(); }
+  Z3_context ctx() { return translator_->ctx(); }
+
+ private:
+  explicit IncrementalProver(std::unique_ptr<IrTranslator> translator);
+
+  std::unique_ptr<IrTranslator> translator_;
+  Z3_solver solver_;
+};
+
 // Attempts to prove node "subject" in function "f" satisfies the given
 // predicate (over all possible inputs) within the duration "timeout".
+// Callers making several queries about the same function should use an
+// IncrementalProver instead.
 absl::StatusOr<bool> TryProve(Function* f, Node* subject, Predicate p,
                               absl::Duration timeout);
 
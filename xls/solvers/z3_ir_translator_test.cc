@@ -42,6 +42,7 @@
 namespace xls {
 namespace {
 
+using solvers::z3::IncrementalProver;
 using solvers::z3::IrTranslator;
 using solvers::z3::Predicate;
 using solvers::z3::TryProve;
@@ -138,6 +139,37 @@ fn f(x: bits[32], y: bits[32]) -> bits[32] {
   EXPECT_TRUE(proven);
 }
 
+TEST_F(Z3IrTranslatorTest, IncrementalProverAnswersSuccessiveQueries) {
+  const std::string program = R"(
+fn f(x: bits[32], y: bits[32]) -> bits[32] {
+  add.1: bits[32] = add(x, y)
+  zero: bits[32] = sub(x, x)
+  ret sub.2: bits[32] = sub(add.1, y)
+}
+)";
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(program, p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<IncrementalProver> prover,
+                           IncrementalProver::Create(f));
+  Node* x = f->GetParamByName("x").value();
+  Node* zero = FindNode("zero", f);
+
+  // Each query only holds for its own duration, so a failed proof (whose
+  // objective is satisfiable) must not affect the ones that follow.
+  EXPECT_THAT(prover->TryProve(x, Predicate::EqualToZero()),
+              IsOkAndHolds(false));
+  EXPECT_THAT(prover->TryProve(zero, Predicate::EqualToZero()),
+              IsOkAndHolds(true));
+  EXPECT_THAT(prover->TryProve(f->return_value(), Predicate::EqualTo(x)),
+              IsOkAndHolds(true));
+  EXPECT_THAT(prover->TryProve(x, Predicate::NotEqualToZero()),
+              IsOkAndHolds(false));
+  EXPECT_THAT(prover->TryProve(f->return_value(), Predicate::EqualTo(zero)),
+              IsOkAndHolds(false));
+  EXPECT_THAT(prover->TryProve(zero, Predicate::EqualToZero()),
+              IsOkAndHolds(true));
+}
+
 TEST_F(Z3IrTranslatorTest, TupleIndexMinusSelf) {
   const std::string program = R"(
 fn f(p: (bits[1], bits[32])) -> bits[32] {
@@ -15,6 +15,8 @@
 #include "xls/solvers/z3_lec.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <deque>
 #include <iostream>
 #include <memory>
@@ -26,10 +28,14 @@
 
 #include "absl/base/internal/sysinfo.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/time/time.h"
 #include "xls/codegen/vast.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/node_util.h"
 #include "xls/solvers/z3_utils.h"
@@ -54,9 +60,7 @@ bool CheckingSingleStage(std::optional<PipelineSchedule> schedule,
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<Lec>> Lec::Create(const LecParams& params) {
-  auto lec = absl::WrapUnique<Lec>(new Lec(params.ir_function, params.netlist,
-                                           params.netlist_module_name,
-                                           std::nullopt, 0));
+  auto lec = absl::WrapUnique<Lec>(new Lec(params, std::nullopt, 0));
   XLS_RETURN_IF_ERROR(lec->Init());
   return lec;
 }
@@ -65,21 +69,20 @@ absl::StatusOr<std::unique_ptr<Lec>> Lec::Create(const LecParams& params) {
 // the more-explicit invocation style here.
 absl::StatusOr<std::unique_ptr<Lec>> Lec::CreateForStage(
     const LecParams& params, const PipelineSchedule& schedule, int stage) {
-  auto lec = absl::WrapUnique<Lec>(new Lec(params.ir_function, params.netlist,
-                                           params.netlist_module_name, schedule,
-                                           stage));
+  auto lec = absl::WrapUnique<Lec>(new Lec(params, schedule, stage));
   XLS_RETURN_IF_ERROR(lec->Init());
   return lec;
 }
 
-Lec::Lec(Function* ir_function, Netlist* netlist,
-         const std::string& netlist_module_name,
-         std::optional<PipelineSchedule> schedule, int stage)
-    : ir_function_(ir_function),
-      netlist_(netlist),
-      netlist_module_name_(netlist_module_name),
+Lec::Lec(const LecParams& params, std::optional<PipelineSchedule> schedule,
+         int stage)
+    : ir_function_(params.ir_function),
+      netlist_(params.netlist),
+      netlist_module_name_(params.netlist_module_name),
       schedule_(schedule),
-      stage_(stage) {}
+      stage_(stage),
+      output_bit_range_(params.output_bit_range),
+      solver_threads_(params.solver_threads) {}
 
 Lec::~Lec() {
   if (model_) {
@@ -109,6 +112,7 @@ absl::Status Lec::Init() {
   Z3_ast x = Z3_mk_const(ctx(), Z3_mk_string_symbol(ctx(), "X"),
                          Z3_mk_bv_sort(ctx(), 1));
   std::vector<Z3_ast> eq_nodes;
+  int64_t output_bit = 0;
   for (const Node* node : ir_output_nodes_) {
     // Extract the individual bits out of each IR output node, and match those
     // up the corresponding netlist bits. The netlist outputs do not contain
@@ -123,7 +127,10 @@ absl::Status Lec::Init() {
                          GetNetlistZ3ForIr(node));
     XLS_RET_CHECK(ir_bits.size() == netlist_bits.size());
 
-    for (int i = 0; i < ir_bits.size(); i++) {
+    for (int i = 0; i < ir_bits.size(); i++, output_bit++) {
+      bool in_range = !output_bit_range_.has_value() ||
+                      (output_bit >= output_bit_range_->first &&
+                       output_bit < output_bit_range_->second);
       if (netlist_bits[i] == nullptr) {
         XLS_VLOG(3) << "  Skipping " << node->GetName() << " IR output bit "
                     << i;
@@ -132,14 +139,21 @@ absl::Status Lec::Init() {
       } else {
         ir_outputs_.push_back(ir_bits[i]);
         netlist_outputs_.push_back(netlist_bits[i]);
-        eq_nodes.push_back(Z3_mk_eq(ctx(), ir_bits[i], netlist_bits[i]));
+        if (in_range) {
+          eq_nodes.push_back(Z3_mk_eq(ctx(), ir_bits[i], netlist_bits[i]));
+        }
       }
     }
   }
 
+  if (eq_nodes.empty()) {
+    // Nothing to compare, e.g., a slice holding only unused output bits.
+    eq_nodes.push_back(Z3_mk_true(ctx()));
+  }
   Z3_ast eval_node = Z3_mk_and(ctx(), eq_nodes.size(), eq_nodes.data());
   eval_node = Z3_mk_not(ctx(), eval_node);
-  solver_ = CreateSolver(ctx(), std::thread::hardware_concurrency());
+  solver_ = CreateSolver(
+      ctx(), solver_threads_.value_or(std::thread::hardware_concurrency()));
   Z3_solver_assert(ctx(), solver_.value(), eval_node);
 
   return absl::OkStatus();
@@ -263,9 +277,23 @@ absl::Status Lec::AddConstraints(Function* constraints) {
   return absl::OkStatus();
 }
 
+void Lec::SetTimeout(absl::Duration timeout) {
+  Z3_params params = Z3_mk_params(ctx());
+  Z3_params_inc_ref(ctx(), params);
+  Z3_params_set_uint(ctx(), params, Z3_mk_string_symbol(ctx(), "timeout"),
+                     static_cast<unsigned>(absl::ToInt64Milliseconds(timeout)));
+  Z3_solver_set_params(ctx(), solver_.value(), params);
+  Z3_params_dec_ref(ctx(), params);
+}
+
 bool Lec::Run() {
   XLS_LOG(INFO) << "Beginning execution";
-  satisfiable_ = Z3_solver_check(ctx(), solver_.value()) == Z3_L_TRUE;
+  Z3_lbool check_result = Z3_solver_check(ctx(), solver_.value());
+  satisfiable_ = check_result == Z3_L_TRUE;
+  inconclusive_ = check_result == Z3_L_UNDEF;
+  if (inconclusive_) {
+    return false;
+  }
   if (satisfiable_) {
     model_ = Z3_solver_get_model(ctx(), solver_.value());
     Z3_model_inc_ref(ctx(), model_.value());
@@ -275,8 +303,13 @@ bool Lec::Run() {
 
 std::string Lec::ResultToString() {
   std::vector<std::string> output;
-  output.push_back(SolverResultToString(ctx(), solver_.value(),
-                                        satisfiable_ ? Z3_L_TRUE : Z3_L_FALSE,
+  Z3_lbool check_result = Z3_L_FALSE;
+  if (inconclusive_) {
+    check_result = Z3_L_UNDEF;
+  } else if (satisfiable_) {
+    check_result = Z3_L_TRUE;
+  }
+  output.push_back(SolverResultToString(ctx(), solver_.value(), check_result,
                                         /*hexify=*/true));
   if (satisfiable_) {
     for (const Node* node : ir_output_nodes_) {
@@ -502,6 +535,124 @@ std::string Lec::NodeToNetlistName(const Node* node,
   return name;
 }
 
+bool PartitionedLecResult::Proven() const {
+  return std::all_of(slices.begin(), slices.end(),
+                     [](const LecSliceResult& slice) {
+                       return slice.status == LecSliceResult::Status::kProven;
+                     });
+}
+
+std::string PartitionedLecResult::ToString() const {
+  std::vector<std::string> lines;
+  std::vector<std::string> details;
+  for (const LecSliceResult& slice : slices) {
+    std::string status;
+    switch (slice.status) {
+      case LecSliceResult::Status::kProven:
+        status = "proven";
+        break;
+      case LecSliceResult::Status::kDisproven:
+        status = "DISPROVEN";
+        details.push_back(absl::StrCat("\n", slice.name, ":\n", slice.result));
+        break;
+      case LecSliceResult::Status::kInconclusive:
+        status = "INCONCLUSIVE";
+        break;
+    }
+    lines.push_back(absl::StrFormat("%s (bits [%d, %d)): %s", slice.name,
+                                    slice.first_bit,
+                                    slice.first_bit + slice.bit_count, status));
+  }
+  lines.insert(lines.end(), details.begin(), details.end());
+  return absl::StrJoin(lines, "\n");
+}
+
+absl::StatusOr<PartitionedLecResult> RunPartitionedLec(
+    const LecParams& params, const PartitionedLecOptions& options,
+    std::optional<PipelineSchedule> schedule, int stage) {
+  // Translate the whole design once up front to find the compared outputs;
+  // this also surfaces any translation errors before spawning workers.
+  std::unique_ptr<Lec> whole;
+  if (schedule.has_value()) {
+    XLS_ASSIGN_OR_RETURN(whole, Lec::CreateForStage(params, *schedule, stage));
+  } else {
+    XLS_ASSIGN_OR_RETURN(whole, Lec::Create(params));
+  }
+
+  PartitionedLecResult result;
+  int64_t first_bit = 0;
+  for (const Node* node : whole->ir_output_nodes()) {
+    int64_t bit_count = node->GetType()->GetFlatBitCount();
+    if (options.granularity ==
+        PartitionedLecOptions::Granularity::kOutputNode) {
+      result.slices.push_back(LecSliceResult{.name = node->GetName(),
+                                             .first_bit = first_bit,
+                                             .bit_count = bit_count});
+    } else {
+      for (int64_t i = 0; i < bit_count; ++i) {
+        result.slices.push_back(
+            LecSliceResult{.name = absl::StrCat(node->GetName(), "[", i, "]"),
+                           .first_bit = first_bit + i,
+                           .bit_count = 1});
+      }
+    }
+    first_bit += bit_count;
+  }
+  whole.reset();
+
+  // Z3 contexts may not be shared between threads, so each slice gets its own
+  // Lec (and thereby its own translation of the design). Each solver is
+  // single-threaded; the parallelism comes from solving slices concurrently.
+  std::vector<absl::Status> statuses(result.slices.size());
+  std::atomic<int64_t> next_slice = 0;
+  auto check_slices = [&]() {
+    for (int64_t i = next_slice++; i < result.slices.size();
+         i = next_slice++) {
+      LecSliceResult& slice = result.slices[i];
+      LecParams slice_params = params;
+      slice_params.output_bit_range =
+          std::make_pair(slice.first_bit, slice.first_bit + slice.bit_count);
+      slice_params.solver_threads = 1;
+      absl::StatusOr<std::unique_ptr<Lec>> lec =
+          schedule.has_value()
+              ? Lec::CreateForStage(slice_params, *schedule, stage)
+              : Lec::Create(slice_params);
+      if (!lec.ok()) {
+        statuses[i] = lec.status();
+        continue;
+      }
+      if (options.slice_timeout.has_value()) {
+        (*lec)->SetTimeout(*options.slice_timeout);
+      }
+      if ((*lec)->Run()) {
+        slice.status = LecSliceResult::Status::kProven;
+      } else if ((*lec)->Inconclusive()) {
+        slice.status = LecSliceResult::Status::kInconclusive;
+      } else {
+        slice.status = LecSliceResult::Status::kDisproven;
+      }
+      slice.result = (*lec)->ResultToString();
+    }
+  };
+
+  int64_t worker_count = options.worker_count > 0
+                             ? options.worker_count
+                             : std::thread::hardware_concurrency();
+  worker_count = std::max<int64_t>(
+      std::min<int64_t>(worker_count, result.slices.size()), 1);
+  std::vector<std::unique_ptr<Thread>> workers;
+  for (int64_t i = 0; i < worker_count; ++i) {
+    workers.push_back(std::make_unique<Thread>(check_slices));
+  }
+  for (std::unique_ptr<Thread>& worker : workers) {
+    worker->Join();
+  }
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return result;
+}
+
 }  // namespace z3
 }  // namespace solvers
 }  // namespace xls
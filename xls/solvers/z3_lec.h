@@ -15,6 +15,7 @@
 #ifndef XLS_SOLVERS_Z3_LEC_H_
 #define XLS_SOLVERS_Z3_LEC_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -23,6 +24,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "xls/ir/package.h"
 #include "xls/netlist/netlist.h"
 #include "xls/scheduling/pipeline_schedule.h"
@@ -48,6 +50,15 @@ struct LecParams {
 
   // The name of the module (inside "netlist") to compare.
   std::string netlist_module_name;
+
+  // If set, only the output bits in [first, second) are compared. Bits are
+  // numbered by flattening the compared IR output nodes in order, each from
+  // its LSB up. Used to split a comparison into independent output cones.
+  std::optional<std::pair<int64_t, int64_t>> output_bit_range;
+
+  // Number of threads the solver may use; defaults to the hardware
+  // concurrency.
+  std::optional<int> solver_threads;
 };
 
 // Class for performing logical equivalence checks between a function specified
@@ -75,9 +86,22 @@ class Lec {
   // Constraints can not be currently specified with per-stage evaluation.
   absl::Status AddConstraints(Function* constraints);
 
+  // Limits the time spent in Run(); if it expires, Run() returns false and
+  // Inconclusive() returns true.
+  void SetTimeout(absl::Duration timeout);
+
   // Returns true of the netlist and IR are proved to be equivalent.
   bool Run();
 
+  // Returns true if the last Run() neither proved nor disproved equivalence,
+  // e.g., because the timeout expired.
+  bool Inconclusive() const { return inconclusive_; }
+
+  // Returns the IR nodes whose values are compared, in output bit order.
+  const std::vector<const Node*>& ir_output_nodes() const {
+    return ir_output_nodes_;
+  }
+
   // Dumps all Z3 values corresponding to IR nodes in the input function.
   void DumpIrTree();
 
@@ -87,9 +111,8 @@ class Lec {
   Z3_context ctx() { return ir_translator_->ctx(); }
 
  private:
-  Lec(Function* ir_function, netlist::rtl::Netlist* netlist,
-      const std::string& netlist_module_name,
-      std::optional<PipelineSchedule> schedule, int stage);
+  Lec(const LecParams& params, std::optional<PipelineSchedule> schedule,
+      int stage);
   absl::Status Init();
   absl::Status CreateIrTranslator();
   absl::Status CreateNetlistTranslator();
@@ -156,6 +179,9 @@ class Lec {
   std::optional<PipelineSchedule> schedule_;
   int stage_;
 
+  std::optional<std::pair<int64_t, int64_t>> output_bit_range_;
+  std::optional<int> solver_threads_;
+
   // Z3 elements are, under the hood, void pointers, but let's respect the
   // interface and use std::optional to determine live-ness.
   std::optional<Z3_solver> solver_;
@@ -163,9 +189,62 @@ class Lec {
   // Satisfiable is equivalent to "model_.has_value()", but having an explicit
   // value is more understandable.
   bool satisfiable_;
+  bool inconclusive_ = false;
   std::optional<Z3_model> model_;
 };
 
+// Options for RunPartitionedLec().
+struct PartitionedLecOptions {
+  enum class Granularity {
+    // One slice per compared IR output node (e.g., per output port).
+    kOutputNode,
+    // One slice per output bit.
+    kOutputBit,
+  };
+  Granularity granularity = Granularity::kOutputNode;
+
+  // Number of slices checked concurrently; zero selects the hardware
+  // concurrency.
+  int64_t worker_count = 0;
+
+  // Time limit for each slice's solver, if any.
+  std::optional<absl::Duration> slice_timeout;
+};
+
+// The outcome of checking one slice of a partitioned LEC.
+struct LecSliceResult {
+  enum class Status { kProven, kDisproven, kInconclusive };
+
+  // The output node name, with a "[bit]" suffix for per-bit slices.
+  std::string name;
+  int64_t first_bit;
+  int64_t bit_count;
+  Status status = Status::kInconclusive;
+  // Lec::ResultToString() for the slice; includes the counterexample if the
+  // slice was disproven.
+  std::string result;
+};
+
+struct PartitionedLecResult {
+  // One entry per slice, in output bit order.
+  std::vector<LecSliceResult> slices;
+
+  // True if every slice was proven equivalent.
+  bool Proven() const;
+
+  // Returns a per-slice summary followed by the details of any failing slice.
+  std::string ToString() const;
+};
+
+// Checks equivalence of the given function (or pipeline stage, if "schedule"
+// is given) and netlist by splitting the comparison into one query per output
+// node or bit. Each slice is translated into its own Z3 context, so the
+// (typically small) cones of logic feeding each output are solved
+// independently and concurrently rather than as one monolithic query.
+absl::StatusOr<PartitionedLecResult> RunPartitionedLec(
+    const LecParams& params, const PartitionedLecOptions& options,
+    std::optional<PipelineSchedule> schedule = std::nullopt, int stage = 0);
+
 }  // namespace z3
 }  // namespace solvers
 }  // namespace xls
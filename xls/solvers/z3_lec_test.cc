@@ -14,11 +14,15 @@
 
 #include "xls/solvers/z3_lec.h"
 
+#include <cstdint>
+#include <memory>
 #include <string>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/netlist/cell_library.h"
@@ -57,6 +61,28 @@ absl::StatusOr<bool> Match(const std::string& ir_text,
   return lec->Run();
 }
 
+absl::StatusOr<PartitionedLecResult> PartitionedMatch(
+    const std::string& ir_text, const std::string& netlist_text,
+    const PartitionedLecOptions& options) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text));
+  XLS_ASSIGN_OR_RETURN(Function * entry_function, package->GetTopAsFunction());
+
+  XLS_ASSIGN_OR_RETURN(netlist::CellLibrary cell_library,
+                       netlist::MakeFakeCellLibrary());
+  netlist::rtl::Scanner scanner(netlist_text);
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<Netlist> netlist,
+      netlist::rtl::Parser::ParseNetlist(&cell_library, &scanner));
+
+  LecParams params;
+  params.ir_package = package.get();
+  params.ir_function = entry_function;
+  params.netlist = netlist.get();
+  params.netlist_module_name = "main";
+  return RunPartitionedLec(params, options);
+}
+
 // This test verifies that we can do a simple LEC.
 TEST(Z3LecTest, SimpleLec) {
   std::string ir_text = R"(
@@ -137,6 +163,68 @@ endmodule
   ASSERT_FALSE(match);
 }
 
+// Verifies that a partitioned LEC isolates the mismatching output bit.
+TEST(Z3LecTest, PartitionedLecFindsBadBit) {
+  std::string ir_text = R"(
+package p
+
+top fn main(input: bits[4]) -> bits[4] {
+  ret not.2: bits[4] = not(input)
+}
+)";
+
+  // As in FailsBadComparison, bit 1 is computed incorrectly.
+  std::string netlist_text = R"(
+module main ( clk, input_3_, input_2_, input_1_, input_0_, out_3_, out_2_, out_1_, out_0_);
+  input clk, input_3_, input_2_, input_1_, input_0_;
+  output out_3_, out_2_, out_1_, out_0_;
+  wire p0_input_3_, p0_input_2_, p0_input_1_, p0_input_0_,
+       p0_not_2_comb_3_, p0_not_2_comb_2_, p0_not_2_comb_1_, p0_not_2_comb_0_;
+
+  DFF p0_input_reg_3_ ( .D(input_3_), .CLK(clk), .Q(p0_input_3_) );
+  DFF p0_input_reg_2_ ( .D(input_2_), .CLK(clk), .Q(p0_input_2_) );
+  DFF p0_input_reg_1_ ( .D(input_1_), .CLK(clk), .Q(p0_input_1_) );
+  DFF p0_input_reg_0_ ( .D(input_0_), .CLK(clk), .Q(p0_input_0_) );
+
+  INV p0_not_2_3_ ( .A(p0_input_3_), .ZN(p0_not_2_comb_3_) );
+  INV p0_not_2_2_ ( .A(p0_input_2_), .ZN(p0_not_2_comb_2_) );
+  OR  p0_not_2_1_ ( .A(p0_input_1_), .B(p0_input_1_), .Z(p0_not_2_comb_1_) );
+  INV p0_not_2_0_ ( .A(p0_input_0_), .ZN(p0_not_2_comb_0_) );
+
+  DFF p0_not_2_reg_3_ (.D(p0_not_2_comb_3_), .CLK(clk), .Q(out_3_));
+  DFF p0_not_2_reg_2_ (.D(p0_not_2_comb_2_), .CLK(clk), .Q(out_2_));
+  DFF p0_not_2_reg_1_ (.D(p0_not_2_comb_1_), .CLK(clk), .Q(out_1_));
+  DFF p0_not_2_reg_0_ (.D(p0_not_2_comb_0_), .CLK(clk), .Q(out_0_));
+endmodule
+)";
+
+  PartitionedLecOptions options;
+  options.worker_count = 2;
+  options.slice_timeout = absl::Seconds(30);
+  XLS_ASSERT_OK_AND_ASSIGN(PartitionedLecResult per_node,
+                           PartitionedMatch(ir_text, netlist_text, options));
+  ASSERT_EQ(per_node.slices.size(), 1);
+  EXPECT_EQ(per_node.slices[0].name, "not.2");
+  EXPECT_EQ(per_node.slices[0].bit_count, 4);
+  EXPECT_EQ(per_node.slices[0].status, LecSliceResult::Status::kDisproven);
+  EXPECT_FALSE(per_node.Proven());
+
+  options.granularity = PartitionedLecOptions::Granularity::kOutputBit;
+  XLS_ASSERT_OK_AND_ASSIGN(PartitionedLecResult per_bit,
+                           PartitionedMatch(ir_text, netlist_text, options));
+  ASSERT_EQ(per_bit.slices.size(), 4);
+  for (int64_t i = 0; i < per_bit.slices.size(); ++i) {
+    const LecSliceResult& slice = per_bit.slices[i];
+    EXPECT_EQ(slice.name, absl::StrCat("not.2[", i, "]"));
+    EXPECT_EQ(slice.first_bit, i);
+    EXPECT_EQ(slice.status, i == 1 ? LecSliceResult::Status::kDisproven
+                                   : LecSliceResult::Status::kProven);
+  }
+  EXPECT_FALSE(per_bit.Proven());
+  EXPECT_THAT(per_bit.ToString(),
+              ::testing::HasSubstr("not.2[1] (bits [1, 2)): DISPROVEN"));
+}
+
 // This test verifies that we can do a simple multi-stage LEC.
 // There are three defined stages:
 // [inputs] -> p0_AND -> p1_OR -> p2 NOT -> [outputs]
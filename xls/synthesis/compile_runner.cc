@@ -0,0 +1,232 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/synthesis/compile_runner.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+#include <thread>        // NOLINT
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "openssl/sha.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/synthesis/synthesis.pb.h"
+
+namespace xls {
+namespace synthesis {
+namespace {
+
+// Bumped whenever the format of the cache entries or the composition of the
+// keys changes.
+constexpr std::string_view kCacheFormatVersion = "xls-compile-cache-v1";
+
+// Returns the hex SHA-256 digest of a sequence of strings. Each string is
+// prefixed with its length so distinct sequences have distinct encodings.
+std::string Sha256Digest(absl::Span<const std::string_view> strings) {
+  SHA256_CTX ctx;
+  SHA256_Init(&ctx);
+  for (std::string_view s : strings) {
+    uint64_t size = s.size();
+    SHA256_Update(&ctx, &size, sizeof(size));
+    SHA256_Update(&ctx, s.data(), s.size());
+  }
+  uint8_t digest[SHA256_DIGEST_LENGTH];
+  SHA256_Final(digest, &ctx);
+  return absl::BytesToHexString(std::string_view(
+      reinterpret_cast<const char*>(digest), SHA256_DIGEST_LENGTH));
+}
+
+}  // namespace
+
+CompileRunner::CompileRunner(CompileFn compile, Options options)
+    : compile_(std::move(compile)),
+      max_concurrent_compiles_(
+          options.max_concurrent_compiles > 0
+              ? options.max_concurrent_compiles
+              : std::max<int64_t>(1, std::thread::hardware_concurrency())),
+      cache_results_(options.cache_results),
+      cache_directory_(std::move(options.cache_directory)),
+      context_digest_(
+          Sha256Digest({kCacheFormatVersion, options.tool_options})) {}
+
+std::string CompileRunner::CacheKey(const CompileRequest& request) const {
+  std::string target_frequency_hz = absl::StrCat(request.target_frequency_hz());
+  return Sha256Digest({context_digest_, request.top_module_name(),
+                       target_frequency_hz, request.module_text()});
+}
+
+std::filesystem::path CompileRunner::EntryPath(std::string_view key) const {
+  return *cache_directory_ / absl::StrCat(key, ".compile_response.pb");
+}
+
+std::optional<CompileResponse> CompileRunner::Lookup(std::string_view key) {
+  if (!cache_directory_.has_value()) {
+    absl::MutexLock lock(&mutex_);
+    auto it = responses_.find(key);
+    if (it == responses_.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  std::filesystem::path path = EntryPath(key);
+  if (!FileExists(path).ok()) {
+    return std::nullopt;
+  }
+  absl::StatusOr<std::string> contents = GetFileContents(path);
+  CompileResponse response;
+  if (!contents.ok() || !response.ParseFromString(*contents)) {
+    XLS_LOG(WARNING) << "Ignoring unreadable cached compile response " << path;
+    return std::nullopt;
+  }
+  XLS_VLOG(2) << "Compile cache hit: " << path;
+  return response;
+}
+
+absl::Status CompileRunner::Insert(std::string_view key,
+                                   const CompileResponse& response) {
+  if (!cache_directory_.has_value()) {
+    absl::MutexLock lock(&mutex_);
+    responses_[std::string(key)] = response;
+    return absl::OkStatus();
+  }
+
+  // Write to a temporary file and rename it so concurrent readers, including
+  // other servers, never observe a partially written entry.
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(*cache_directory_));
+  std::filesystem::path path = EntryPath(key);
+  std::filesystem::path temp_path = path;
+  static std::atomic<int64_t> next_temp_id = 0;
+  temp_path += absl::StrFormat(".tmp.%d.%d", getpid(), next_temp_id++);
+  XLS_RETURN_IF_ERROR(
+      SetFileContents(temp_path, response.SerializeAsString()));
+  std::error_code ec;
+  std::filesystem::rename(temp_path, path, ec);
+  if (ec) {
+    return absl::InternalError(
+        absl::StrFormat("Failed to rename %s to %s: %s", temp_path.string(),
+                        path.string(), ec.message()));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<CompileResponse> CompileRunner::Compile(
+    const CompileRequest& request) {
+  std::string key;
+  if (cache_results_) {
+    key = CacheKey(request);
+    if (std::optional<CompileResponse> cached = Lookup(key)) {
+      cached->set_cache_hit(true);
+      return *std::move(cached);
+    }
+  }
+
+  // Waits for one of the compile slots; the synthesis tools run as
+  // subprocesses, so running too many at once only thrashes the machine.
+  mutex_.LockWhen(absl::Condition(this, &CompileRunner::HasFreeSlot));
+  ++running_;
+  mutex_.Unlock();
+
+  // An identical request may have completed while this one was waiting.
+  std::optional<CompileResponse> cached;
+  if (cache_results_) {
+    cached = Lookup(key);
+  }
+  CompileResponse response;
+  absl::Status status;
+  if (!cached.has_value()) {
+    status = compile_(request, &response);
+  }
+
+  {
+    absl::MutexLock lock(&mutex_);
+    --running_;
+  }
+  if (cached.has_value()) {
+    cached->set_cache_hit(true);
+    return *std::move(cached);
+  }
+  XLS_RETURN_IF_ERROR(status);
+  response.set_cache_hit(false);
+  if (cache_results_) {
+    absl::Status insert_status = Insert(key, response);
+    if (!insert_status.ok()) {
+      XLS_LOG(WARNING) << "Failed to cache compile response: "
+                       << insert_status;
+    }
+  }
+  return response;
+}
+
+BatchCompileResponse CompileRunner::BatchCompile(
+    const BatchCompileRequest& batch) {
+  std::vector<absl::StatusOr<CompileResponse>> responses(
+      batch.requests_size());
+
+  // The workers only pick up requests; Compile bounds how many of them, and
+  // of the requests of other RPCs, run at once.
+  std::atomic<int64_t> next_index = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_index++; i < responses.size(); i = next_index++) {
+      responses[i] = Compile(batch.requests(i));
+    }
+  };
+  if (responses.size() <= 1) {
+    worker();
+  } else {
+    int64_t thread_count =
+        std::min<int64_t>(max_concurrent_compiles_, responses.size());
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t i = 0; i < thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    // Threads are joined on destruction.
+  }
+
+  BatchCompileResponse result;
+  for (absl::StatusOr<CompileResponse>& response : responses) {
+    BatchCompileResult* entry = result.add_results();
+    entry->set_status_code(static_cast<int32_t>(response.status().code()));
+    if (response.ok()) {
+      *entry->mutable_response() = *std::move(response);
+    } else {
+      entry->set_status_message(std::string(response.status().message()));
+    }
+  }
+  return result;
+}
+
+}  // namespace synthesis
+}  // namespace xls
@@ -0,0 +1,110 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SYNTHESIS_COMPILE_RUNNER_H_
+#define XLS_SYNTHESIS_COMPILE_RUNNER_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/synthesis/synthesis.pb.h"
+
+namespace xls {
+namespace synthesis {
+
+// Runs compile requests on behalf of a synthesis service: bounds the number of
+// compiles running at once across all RPCs, caches responses by the content
+// of the request and implements batches of requests in terms of a function
+// which compiles one request.
+class CompileRunner {
+ public:
+  using CompileFn =
+      std::function<absl::Status(const CompileRequest&, CompileResponse*)>;
+
+  struct Options {
+    // The maximum number of compiles running at once. Zero or less means the
+    // number of hardware threads.
+    int64_t max_concurrent_compiles = 0;
+
+    // Whether to return cached responses to repeated requests.
+    bool cache_results = true;
+
+    // Identifies the configuration of the synthesis tools (binaries,
+    // libraries, target, ...), as it determines the response along with the
+    // request.
+    std::string tool_options;
+
+    // If set, responses are cached in files in this directory, which persist
+    // across runs and may be shared by servers. Otherwise responses are
+    // cached in memory.
+    std::optional<std::filesystem::path> cache_directory;
+  };
+
+  CompileRunner(CompileFn compile, Options options);
+
+  // Compiles `request`, or returns the cached response to an identical
+  // earlier request with cache_hit set. Failed compiles are not cached.
+  absl::StatusOr<CompileResponse> Compile(const CompileRequest& request);
+
+  // Compiles the requests of `batch` concurrently. Never fails as a whole;
+  // the outcome of each request is in the corresponding result.
+  BatchCompileResponse BatchCompile(const BatchCompileRequest& batch);
+
+  int64_t max_concurrent_compiles() const { return max_concurrent_compiles_; }
+
+  // The cache key of `request`: a hex SHA-256 digest of the tool options and
+  // the Verilog text, top module name and target frequency of the request.
+  // The signature is not part of the key as the synthesis backends do not
+  // consult it.
+  std::string CacheKey(const CompileRequest& request) const;
+
+ private:
+  std::filesystem::path EntryPath(std::string_view key) const;
+
+  // Returns the cached response for `key`, if any. Unreadable cache entries
+  // are logged and treated as missing.
+  std::optional<CompileResponse> Lookup(std::string_view key);
+  absl::Status Insert(std::string_view key, const CompileResponse& response);
+
+  bool HasFreeSlot() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return running_ < max_concurrent_compiles_;
+  }
+
+  CompileFn compile_;
+  int64_t max_concurrent_compiles_;
+  bool cache_results_;
+  std::optional<std::filesystem::path> cache_directory_;
+  // SHA-256 digest of the cache format version and the tool options.
+  std::string context_digest_;
+
+  absl::Mutex mutex_;
+  int64_t running_ ABSL_GUARDED_BY(mutex_) = 0;
+  // The in-memory cache, used when there is no cache directory.
+  absl::flat_hash_map<std::string, CompileResponse> responses_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace synthesis
+}  // namespace xls
+
+#endif  // XLS_SYNTHESIS_COMPILE_RUNNER_H_
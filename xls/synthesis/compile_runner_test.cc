@@ -0,0 +1,190 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/synthesis/compile_runner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/synthesis/synthesis.pb.h"
+
+namespace xls {
+namespace synthesis {
+namespace {
+
+using status_testing::StatusIs;
+
+CompileRequest MakeRequest(std::string_view module_text,
+                           int64_t target_frequency_hz = 1'000'000'000) {
+  CompileRequest request;
+  request.set_module_text(module_text);
+  request.set_top_module_name("top");
+  request.set_target_frequency_hz(target_frequency_hz);
+  return request;
+}
+
+// A compile function which counts its calls, reports the length of the
+// module text as the area and fails on Verilog containing "error".
+class FakeCompiler {
+ public:
+  CompileRunner::CompileFn AsFunction() {
+    return [this](const CompileRequest& request, CompileResponse* response) {
+      ++calls_;
+      if (request.module_text().find("error") != std::string::npos) {
+        return absl::InternalError("synthesis failed");
+      }
+      response->set_area(request.module_text().size());
+      response->set_max_frequency_hz(request.target_frequency_hz());
+      return absl::OkStatus();
+    };
+  }
+
+  int64_t calls() const { return calls_; }
+
+ private:
+  std::atomic<int64_t> calls_ = 0;
+};
+
+TEST(CompileRunnerTest, CachesInMemory) {
+  FakeCompiler compiler;
+  CompileRunner runner(compiler.AsFunction(), {});
+  XLS_ASSERT_OK_AND_ASSIGN(CompileResponse first,
+                           runner.Compile(MakeRequest("module a")));
+  EXPECT_FALSE(first.cache_hit());
+  EXPECT_EQ(first.area(), 8);
+  XLS_ASSERT_OK_AND_ASSIGN(CompileResponse second,
+                           runner.Compile(MakeRequest("module a")));
+  EXPECT_TRUE(second.cache_hit());
+  EXPECT_EQ(second.area(), 8);
+  EXPECT_EQ(compiler.calls(), 1);
+
+  // The target frequency is part of the key.
+  XLS_ASSERT_OK_AND_ASSIGN(CompileResponse third,
+                           runner.Compile(MakeRequest("module a", 42)));
+  EXPECT_FALSE(third.cache_hit());
+  EXPECT_EQ(third.max_frequency_hz(), 42);
+  EXPECT_EQ(compiler.calls(), 2);
+
+  // Failures are not cached.
+  EXPECT_THAT(runner.Compile(MakeRequest("error")),
+              StatusIs(absl::StatusCode::kInternal));
+  EXPECT_THAT(runner.Compile(MakeRequest("error")),
+              StatusIs(absl::StatusCode::kInternal));
+  EXPECT_EQ(compiler.calls(), 4);
+}
+
+TEST(CompileRunnerTest, CachingDisabled) {
+  FakeCompiler compiler;
+  CompileRunner runner(compiler.AsFunction(), {.cache_results = false});
+  XLS_ASSERT_OK(runner.Compile(MakeRequest("module a")).status());
+  XLS_ASSERT_OK_AND_ASSIGN(CompileResponse response,
+                           runner.Compile(MakeRequest("module a")));
+  EXPECT_FALSE(response.cache_hit());
+  EXPECT_EQ(compiler.calls(), 2);
+}
+
+TEST(CompileRunnerTest, CachesInDirectory) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  FakeCompiler compiler;
+  {
+    CompileRunner runner(compiler.AsFunction(),
+                         {.tool_options = "yosys",
+                          .cache_directory = temp_dir.path()});
+    XLS_ASSERT_OK(runner.Compile(MakeRequest("module a")).status());
+  }
+  // A new runner with the same tool options finds the entry.
+  CompileRunner runner(
+      compiler.AsFunction(),
+      {.tool_options = "yosys", .cache_directory = temp_dir.path()});
+  XLS_ASSERT_OK_AND_ASSIGN(CompileResponse response,
+                           runner.Compile(MakeRequest("module a")));
+  EXPECT_TRUE(response.cache_hit());
+  EXPECT_EQ(response.area(), 8);
+  EXPECT_EQ(compiler.calls(), 1);
+
+  // Other tool options do not share entries.
+  CompileRunner other_runner(
+      compiler.AsFunction(),
+      {.tool_options = "nextpnr", .cache_directory = temp_dir.path()});
+  EXPECT_NE(other_runner.CacheKey(MakeRequest("module a")),
+            runner.CacheKey(MakeRequest("module a")));
+  XLS_ASSERT_OK_AND_ASSIGN(response,
+                           other_runner.Compile(MakeRequest("module a")));
+  EXPECT_FALSE(response.cache_hit());
+  EXPECT_EQ(compiler.calls(), 2);
+}
+
+TEST(CompileRunnerTest, BatchCompile) {
+  FakeCompiler compiler;
+  CompileRunner runner(compiler.AsFunction(), {.max_concurrent_compiles = 3});
+  BatchCompileRequest batch;
+  for (int64_t i = 0; i < 10; ++i) {
+    *batch.add_requests() = MakeRequest(std::string(i + 1, 'x'));
+  }
+  *batch.add_requests() = MakeRequest("error");
+  BatchCompileResponse result = runner.BatchCompile(batch);
+  ASSERT_EQ(result.results_size(), 11);
+  for (int64_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(result.results(i).status_code(), 0);
+    EXPECT_EQ(result.results(i).response().area(), i + 1);
+  }
+  EXPECT_EQ(result.results(10).status_code(),
+            static_cast<int32_t>(absl::StatusCode::kInternal));
+  EXPECT_EQ(result.results(10).status_message(), "synthesis failed");
+  EXPECT_FALSE(result.results(10).has_response());
+
+  // A repeated batch is served from the cache.
+  result = runner.BatchCompile(batch);
+  EXPECT_TRUE(result.results(3).response().cache_hit());
+  EXPECT_EQ(compiler.calls(), 12);
+}
+
+TEST(CompileRunnerTest, BoundsConcurrentCompiles) {
+  std::atomic<int64_t> running = 0;
+  std::atomic<int64_t> max_running = 0;
+  CompileRunner runner(
+      [&](const CompileRequest& request, CompileResponse* response) {
+        int64_t now_running = ++running;
+        int64_t observed = max_running;
+        while (now_running > observed &&
+               !max_running.compare_exchange_weak(observed, now_running)) {
+        }
+        absl::SleepFor(absl::Milliseconds(5));
+        --running;
+        return absl::OkStatus();
+      },
+      {.max_concurrent_compiles = 2, .cache_results = false});
+  EXPECT_EQ(runner.max_concurrent_compiles(), 2);
+  BatchCompileRequest batch;
+  for (int64_t i = 0; i < 8; ++i) {
+    *batch.add_requests() = MakeRequest("module a");
+  }
+  BatchCompileResponse result = runner.BatchCompile(batch);
+  EXPECT_EQ(result.results_size(), 8);
+  EXPECT_LE(max_running, 2);
+}
+
+}  // namespace
+}  // namespace synthesis
+}  // namespace xls
@@ -16,8 +16,11 @@
 #include <cstdlib>
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
@@ -28,6 +31,7 @@
 #include "grpcpp/support/status.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
+#include "xls/synthesis/compile_runner.h"
 #include "xls/synthesis/credentials.h"
 #include "xls/synthesis/synthesis.pb.h"
 #include "xls/synthesis/synthesis_service.grpc.pb.h"
@@ -57,18 +61,43 @@ namespace {
 class FakeSynthesisServiceImpl : public SynthesisService::Service {
  public:
   explicit FakeSynthesisServiceImpl(int64_t max_frequency_hz,
-                                     bool serve_errors)
-      : max_frequency_hz_(max_frequency_hz), serve_errors_(serve_errors) {}
+                                    bool serve_errors)
+      : max_frequency_hz_(max_frequency_hz),
+        serve_errors_(serve_errors),
+        runner_(
+            [this](const CompileRequest& request, CompileResponse* result) {
+              return FakeCompile(request, result);
+            },
+            {.tool_options = absl::StrCat(max_frequency_hz)}) {}
 
   ::grpc::Status Compile(::grpc::ServerContext* server_context,
                          const CompileRequest* request,
                          CompileResponse* result) override {
+    absl::StatusOr<CompileResponse> response = runner_.Compile(*request);
+    if (!response.ok()) {
+      return ::grpc::Status(grpc::StatusCode::INTERNAL,
+                            std::string(response.status().message()));
+    }
+    *result = *std::move(response);
+    return ::grpc::Status::OK;
+  }
+
+  ::grpc::Status BatchCompile(::grpc::ServerContext* server_context,
+                              const BatchCompileRequest* request,
+                              BatchCompileResponse* result) override {
+    *result = runner_.BatchCompile(*request);
+    return ::grpc::Status::OK;
+  }
+
+ private:
+  absl::Status FakeCompile(const CompileRequest& request,
+                           CompileResponse* result) const {
     auto start = absl::Now();
 
     result->set_slack_ps(
-        request->target_frequency_hz() <= max_frequency_hz_
+        request.target_frequency_hz() <= max_frequency_hz_
             ? 0
-            : static_cast<int64_t>(1e12L / request->target_frequency_hz() -
+            : static_cast<int64_t>(1e12L / request.target_frequency_hz() -
                                    1e12L / max_frequency_hz_));
     result->set_power(42);
     result->set_area(123);
@@ -76,15 +105,14 @@ class FakeSynthesisServiceImpl : public SynthesisService::Service {
     result->set_elapsed_runtime_ms(
         absl::ToInt64Milliseconds(absl::Now() - start));
     if (serve_errors_) {
-      return ::grpc::Status(grpc::StatusCode::INTERNAL,
-                            "Fake synthesis server error");
+      return absl::InternalError("Fake synthesis server error");
     }
-    return ::grpc::Status::OK;
+    return absl::OkStatus();
   }
 
- private:
   int64_t max_frequency_hz_;
   bool serve_errors_;
+  CompileRunner runner_;
 };
 
 void RealMain() {
@@ -16,9 +16,13 @@
 
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "grpcpp/support/status.h"
 #include "grpcpp/channel.h"
 #include "grpcpp/client_context.h"
@@ -41,15 +45,19 @@ static absl::Status GrpcToAbslStatus(const grpc::Status& grpc_status) {
 }
 
 // This creates a new channel and stub *each* invocation
-absl::StatusOr<CompileResponse> SynthesizeViaClient(
-    const std::string& server,
-    const CompileRequest& request) {
+static std::unique_ptr<SynthesisService::Stub> NewStub(
+    const std::string& server) {
   // Create a channel, a logical connection an endpoint.
   std::shared_ptr<grpc::ChannelCredentials> creds = GetChannelCredentials();
   std::shared_ptr<grpc::Channel> channel = grpc::CreateChannel(server, creds);
   // Creation of a RPC stub for the channel.
-  std::unique_ptr<SynthesisService::Stub> stub(
-      SynthesisService::NewStub(channel));
+  return SynthesisService::NewStub(channel);
+}
+
+absl::StatusOr<CompileResponse> SynthesizeViaClient(
+    const std::string& server,
+    const CompileRequest& request) {
+  std::unique_ptr<SynthesisService::Stub> stub = NewStub(server);
 
   // Context for the client. It could be used to convey extra information to
   // the server and/or tweak certain RPC behaviors.
@@ -62,5 +70,39 @@ absl::StatusOr<CompileResponse> SynthesizeViaClient(
   return response;
 }
 
+absl::StatusOr<std::vector<absl::StatusOr<CompileResponse>>>
+BatchSynthesizeViaClient(const std::string& server,
+                         absl::Span<const CompileRequest> requests) {
+  std::unique_ptr<SynthesisService::Stub> stub = NewStub(server);
+  grpc::ClientContext context;
+
+  BatchCompileRequest batch;
+  batch.mutable_requests()->Reserve(requests.size());
+  for (const CompileRequest& request : requests) {
+    *batch.add_requests() = request;
+  }
+  BatchCompileResponse batch_response;
+  XLS_RETURN_IF_ERROR(GrpcToAbslStatus(
+      stub->BatchCompile(&context, batch, &batch_response)));
+  if (batch_response.results_size() != static_cast<int>(requests.size())) {
+    return absl::InternalError(absl::StrFormat(
+        "Synthesis server returned %d results for %d requests",
+        batch_response.results_size(), requests.size()));
+  }
+
+  std::vector<absl::StatusOr<CompileResponse>> responses;
+  responses.reserve(requests.size());
+  for (BatchCompileResult& result : *batch_response.mutable_results()) {
+    if (result.status_code() == 0) {
+      responses.push_back(std::move(*result.mutable_response()));
+    } else {
+      responses.push_back(
+          absl::Status(static_cast<absl::StatusCode>(result.status_code()),
+                       result.status_message()));
+    }
+  }
+  return responses;
+}
+
 }  // namespace synthesis
 }  // namespace xls
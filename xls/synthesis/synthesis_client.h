@@ -16,8 +16,10 @@
 #define XLS_SYNTHESIS_CLIENT_H_
 
 #include <string>
+#include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/synthesis/synthesis.pb.h"
 
 namespace xls {
@@ -28,6 +30,13 @@ absl::StatusOr<CompileResponse> SynthesizeViaClient(
     const std::string& server,
     const CompileRequest& request);
 
+// Sends `requests` to the server in one BatchCompile RPC, which the server may
+// run concurrently and answer from its result cache. Returns the outcome of
+// each request in order; fails as a whole only if the RPC does.
+absl::StatusOr<std::vector<absl::StatusOr<CompileResponse>>>
+BatchSynthesizeViaClient(const std::string& server,
+                         absl::Span<const CompileRequest> requests);
+
 }  // namespace synthesis
 }  // namespace xls
 
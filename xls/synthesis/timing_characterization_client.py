@@ -20,7 +20,7 @@ format.
 """
 
 import sys
-from typing import Dict, Sequence, Set, Tuple
+from typing import Dict, List, Sequence, Set, Tuple
 
 from absl import flags
 from absl import logging
@@ -44,6 +44,12 @@ _CHECKPOINT_PATH = flags.DEFINE_string(
     'Checkpoints will not be kept if unspecified.')
 _SAMPLES_PATH = flags.DEFINE_string(
     'samples_path', '', 'Path at which to load samples textproto.')
+_PERIODS_PER_REQUEST = flags.DEFINE_integer(
+    'periods_per_request', 1,
+    'Number of clock periods to try in each round of the search for the '
+    'minimum period. More than one sends the periods in one BatchCompile '
+    'request, which the server may synthesize concurrently, and narrows the '
+    'search faster in exchange for more synthesis runs.')
 
 ENUM2NAME_MAP = dict((op.enum_name, op.name) for op in OPS)
 
@@ -63,82 +69,131 @@ def save_checkpoint(results: delay_model_pb2.DataPoints, checkpoint_path: str):
       f.write(text_format.MessageToString(results))
 
 
+def _compile_at_periods(
+    stub: synthesis_service_pb2_grpc.SynthesisServiceStub,
+    verilog_text: str,
+    top_module_name: str,
+    periods_ps: Sequence[float],
+) -> List[synthesis_pb2.CompileResponse]:
+  """Synthesizes the module for each of the given clock periods."""
+  requests = []
+  for period_ps in periods_ps:
+    request = synthesis_pb2.CompileRequest()
+    request.target_frequency_hz = int(1e12 / period_ps)
+    request.module_text = verilog_text
+    request.top_module_name = top_module_name
+    logging.vlog(3, '--- Request')
+    logging.vlog(3, request)
+    requests.append(request)
+
+  if len(requests) == 1:
+    return [stub.Compile(requests[0])]
+  batch_response = stub.BatchCompile(
+      synthesis_pb2.BatchCompileRequest(requests=requests))
+  responses = []
+  for result in batch_response.results:
+    if result.status_code:
+      raise RuntimeError(
+          f'Synthesis failed with status {result.status_code}: '
+          f'{result.status_message}')
+    responses.append(result.response)
+  return responses
+
+
 def _search_for_fmax_and_synth(
     stub: synthesis_service_pb2_grpc.SynthesisServiceStub,
     verilog_text: str,
     top_module_name: str,
 ) -> synthesis_pb2.CompileResponse:
-  """Bisects the space of frequencies and sends requests to the server."""
+  """Searches the space of frequencies and sends requests to the server.
+
+  Each round tries --periods_per_request evenly spaced periods between the
+  longest known failing and the shortest known passing period; with one period
+  per round this is a bisection.
+
+  Args:
+    stub: The synthesis service.
+    verilog_text: The Verilog module to synthesize.
+    top_module_name: The name of the module.
+
+  Returns:
+    The response for the highest passing frequency found.
+  """
   best_result = synthesis_pb2.CompileResponse()
   low_ps = _MIN_PS.value
   high_ps = _MAX_PS.value
   epsilon_ps = 1.0
+  period_count = max(1, _PERIODS_PER_REQUEST.value)
 
-  while high_ps - low_ps > epsilon_ps:
-    current_ps = (high_ps + low_ps) / 2
-    request = synthesis_pb2.CompileRequest()
-    request.target_frequency_hz = int(1e12 / current_ps)
-    request.module_text = verilog_text
-    request.top_module_name = top_module_name
+  done = False
+  while not done and high_ps - low_ps > epsilon_ps:
+    step_ps = (high_ps - low_ps) / (period_count + 1)
+    periods_ps = [low_ps + step_ps * (i + 1) for i in range(period_count)]
     logging.vlog(3, '--- Debug')
     logging.vlog(3, high_ps)
     logging.vlog(3, low_ps)
     logging.vlog(3, epsilon_ps)
-    logging.vlog(3, current_ps)
-    logging.vlog(3, '--- Request')
-    logging.vlog(3, request)
-    response = stub.Compile(request)
-    logging.vlog(3, '--- response')
-    logging.vlog(3, response.slack_ps)
-    logging.vlog(3, response.max_frequency_hz)
-    logging.vlog(3, response.netlist)
-
-    if response.max_frequency_hz > 0:
-      response_ps = 1e12 / response.max_frequency_hz
-    else:
-      response_ps = 0
-
-    # If synthesis is insensitive to target frequency, we don't need to do
-    # the binary search.  Just use the max_frequency_hz of the first response
-    # (whether it passes or fails).
-    if response.insensitive_to_target_freq and response.max_frequency_hz > 0:
-      logging.info(
-          'USING (@min %2.1fps).', response_ps
-      )
-      best_result = response
-      break
-
-    if response.slack_ps >= 0:
+    logging.vlog(3, periods_ps)
+    responses = _compile_at_periods(stub, verilog_text, top_module_name,
+                                    periods_ps)
+
+    # Walks the periods from the shortest; the first that passes bounds the
+    # search from above, so the longer ones need not be considered.
+    for current_ps, response in zip(periods_ps, responses):
+      logging.vlog(3, '--- response')
+      logging.vlog(3, response.slack_ps)
+      logging.vlog(3, response.max_frequency_hz)
+      logging.vlog(3, response.netlist)
+
       if response.max_frequency_hz > 0:
-        logging.info(
-            'PASS at %.1fps (slack %dps @min %2.1fps)',
-            current_ps, response.slack_ps, response_ps
-        )
+        response_ps = 1e12 / response.max_frequency_hz
       else:
-        logging.error('PASS but no maximum frequency determined.')
-        logging.error('ERROR: this occurs when '
-                      'an operator is optimized to a constant.')
-        logging.error('Source Verilog:\n%s', request.module_text)
-        sys.exit()
-      high_ps = current_ps
-      if response.max_frequency_hz >= best_result.max_frequency_hz:
-        best_result = response
-    else:
-      if response.max_frequency_hz:
+        response_ps = 0
+
+      # If synthesis is insensitive to target frequency, we don't need to do
+      # the search.  Just use the max_frequency_hz of the first response
+      # (whether it passes or fails).
+      if response.insensitive_to_target_freq and response.max_frequency_hz > 0:
         logging.info(
-            'FAIL at %.1fps (slack %dps @min %2.1fps).',
-            current_ps, response.slack_ps, response_ps
+            'USING (@min %2.1fps).', response_ps
         )
+        best_result = response
+        done = True
+        break
+
+      if response.slack_ps >= 0:
+        if response.max_frequency_hz > 0:
+          logging.info(
+              'PASS at %.1fps (slack %dps @min %2.1fps)',
+              current_ps, response.slack_ps, response_ps
+          )
+        else:
+          logging.error('PASS but no maximum frequency determined.')
+          logging.error('ERROR: this occurs when '
+                        'an operator is optimized to a constant.')
+          logging.error('Source Verilog:\n%s', verilog_text)
+          sys.exit()
+        high_ps = current_ps
+        if response.max_frequency_hz >= best_result.max_frequency_hz:
+          best_result = response
+        break
       else:
-        # This shouldn't happen
-        logging.error('FAIL but no maximum frequency provided')
-        sys.exit()
-      # Speed things up if we're way off
-      if current_ps < (response_ps / 2.0):
-        high_ps = response_ps * 1.1
-        low_ps = response_ps * 0.9
-      else:
-        low_ps = current_ps
+        if response.max_frequency_hz:
+          logging.info(
+              'FAIL at %.1fps (slack %dps @min %2.1fps).',
+              current_ps, response.slack_ps, response_ps
+          )
+        else:
+          # This shouldn't happen
+          logging.error('FAIL but no maximum frequency provided')
+          sys.exit()
+        # Speed things up if we're way off
+        if current_ps < (response_ps / 2.0):
+          high_ps = response_ps * 1.1
+          low_ps = response_ps * 0.9
+          break
+        else:
+          low_ps = current_ps
 
   if best_result.max_frequency_hz:
     logging.info(
@@ -15,8 +15,10 @@
 #include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 
 #include "absl/flags/flag.h"
 #include "absl/strings/str_cat.h"
@@ -27,6 +29,7 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
+#include "xls/synthesis/compile_runner.h"
 #include "xls/synthesis/credentials.h"
 #include "xls/synthesis/yosys/yosys_synthesis_service.h"
 
@@ -60,6 +63,15 @@ ABSL_FLAG(std::string, synthesis_libraries, "",
 ABSL_FLAG(
     std::string, sta_libraries, "",
     "The technology library/libraries file to target for STA; *.lib * lib.gz");
+ABSL_FLAG(int64_t, max_concurrent_compiles, 0,
+          "The maximum number of synthesis runs in flight at once, across all "
+          "requests. Zero means the number of hardware threads.");
+ABSL_FLAG(bool, cache_results, true,
+          "Return cached results to requests identical to earlier ones.");
+ABSL_FLAG(std::string, result_cache_dir, "",
+          "If set, cache results in this directory, which persists across "
+          "servers, rather than in memory. The cache is keyed by the tool and "
+          "library paths, not their contents, so clear it when they change.");
 
 namespace xls {
 namespace synthesis {
@@ -104,10 +116,19 @@ void RealMain() {
 
   int port = absl::GetFlag(FLAGS_port);
   std::string server_address = absl::StrCat("0.0.0.0:", port);
+  CompileRunner::Options runner_options;
+  runner_options.max_concurrent_compiles =
+      absl::GetFlag(FLAGS_max_concurrent_compiles);
+  runner_options.cache_results = absl::GetFlag(FLAGS_cache_results);
+  if (std::string cache_dir = absl::GetFlag(FLAGS_result_cache_dir);
+      !cache_dir.empty()) {
+    runner_options.cache_directory = cache_dir;
+  }
   YosysSynthesisServiceImpl service(
       yosys_path, nextpnr_path, synthesis_target, sta_path, synthesis_libraries,
       sta_libraries, absl::GetFlag(FLAGS_save_temps),
-      absl::GetFlag(FLAGS_return_netlist), synthesis_only);
+      absl::GetFlag(FLAGS_return_netlist), synthesis_only,
+      std::move(runner_options));
 
   ::grpc::ServerBuilder builder;
   std::shared_ptr<::grpc::ServerCredentials> creds = GetServerCredentials();
@@ -116,6 +137,8 @@ void RealMain() {
   std::unique_ptr<::grpc::Server> server(builder.BuildAndStart());
   XLS_LOG(INFO) << "Serving on port: " << port;
   XLS_LOG(INFO) << "synthesis_target: " << synthesis_target;
+  XLS_LOG(INFO) << "max_concurrent_compiles: "
+                << service.max_concurrent_compiles();
   server->Wait();
 }
 
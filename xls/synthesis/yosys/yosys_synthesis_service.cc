@@ -48,18 +48,29 @@ namespace synthesis {
 ::grpc::Status YosysSynthesisServiceImpl::Compile(
     ::grpc::ServerContext* server_context, const CompileRequest* request,
     CompileResponse* result) {
-  auto start = absl::Now();
-
-  absl::Status synthesis_status = RunSynthesis(request, result);
-  if (!synthesis_status.ok()) {
+  absl::StatusOr<CompileResponse> response = runner_.Compile(*request);
+  if (!response.ok()) {
     return ::grpc::Status(grpc::StatusCode::INTERNAL,
-                          std::string(synthesis_status.message()));
+                          std::string(response.status().message()));
   }
+  *result = *std::move(response);
+  return ::grpc::Status::OK;
+}
 
+::grpc::Status YosysSynthesisServiceImpl::BatchCompile(
+    ::grpc::ServerContext* server_context, const BatchCompileRequest* request,
+    BatchCompileResponse* result) {
+  *result = runner_.BatchCompile(*request);
+  return ::grpc::Status::OK;
+}
+
+absl::Status YosysSynthesisServiceImpl::RunTimedSynthesis(
+    const CompileRequest& request, CompileResponse* result) const {
+  auto start = absl::Now();
+  XLS_RETURN_IF_ERROR(RunSynthesis(&request, result));
   result->set_elapsed_runtime_ms(
       absl::ToInt64Milliseconds(absl::Now() - start));
-
-  return ::grpc::Status::OK;
+  return absl::OkStatus();
 }
 
 // Run the given arguments as a subprocess with InvokeSubprocess.
@@ -15,17 +15,21 @@
 #ifndef XLS_SYNTHESIS_YOSYS_YOSYS_SYNTHESIS_SERVICE_H_
 #define XLS_SYNTHESIS_YOSYS_YOSYS_SYNTHESIS_SERVICE_H_
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "grpcpp/server.h"
 #include "grpcpp/server_context.h"
 #include "grpcpp/support/status.h"
+#include "xls/synthesis/compile_runner.h"
 #include "xls/synthesis/synthesis.pb.h"
 #include "xls/synthesis/synthesis_service.grpc.pb.h"
 
@@ -38,7 +42,8 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
       std::string_view yosys_path, std::string_view nextpnr_path,
       std::string_view synthesis_target, std::string_view sta_path,
       std::string_view synthesis_libraries, std::string_view sta_libraries,
-      bool save_temps, bool return_netlist, bool synthesis_only)
+      bool save_temps, bool return_netlist, bool synthesis_only,
+      CompileRunner::Options runner_options = {})
       : yosys_path_(yosys_path),
         nextpnr_path_(nextpnr_path),
         synthesis_target_(synthesis_target),
@@ -47,12 +52,27 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
         sta_libraries_(sta_libraries),
         save_temps_(save_temps),
         return_netlist_(return_netlist),
-        synthesis_only_(synthesis_only) {}
+        synthesis_only_(synthesis_only),
+        runner_(
+            [this](const CompileRequest& request, CompileResponse* result) {
+              return RunTimedSynthesis(request, result);
+            },
+            WithToolOptions(std::move(runner_options))) {}
 
+  // Requests are run by a CompileRunner, which bounds the number of yosys
+  // invocations in flight and caches their results.
   ::grpc::Status Compile(::grpc::ServerContext* server_context,
                          const CompileRequest* request,
                          CompileResponse* result) override;
 
+  ::grpc::Status BatchCompile(::grpc::ServerContext* server_context,
+                              const BatchCompileRequest* request,
+                              BatchCompileResponse* result) override;
+
+  int64_t max_concurrent_compiles() const {
+    return runner_.max_concurrent_compiles();
+  }
+
   // Run the given arguments as a subprocess with InvokeSubprocess.
   // InvokeSubprocess is wrapped because the error message can be very large (it
   // includes both stdout and stderr) which breaks propagation of the error via
@@ -85,6 +105,23 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
                       const std::filesystem::path& netlist_path) const;
 
  private:
+  // Runs synthesis and records its runtime in `result`.
+  absl::Status RunTimedSynthesis(const CompileRequest& request,
+                                 CompileResponse* result) const;
+
+  // Returns `options` with the tool options set to the configuration of this
+  // service, which keys the result cache along with the requests.
+  CompileRunner::Options WithToolOptions(CompileRunner::Options options) const {
+    options.tool_options = absl::StrJoin(
+        std::vector<std::string>{
+            yosys_path_, nextpnr_path_, synthesis_target_, sta_path_,
+            synthesis_libraries_, sta_libraries_,
+            return_netlist_ ? "return_netlist" : "",
+            synthesis_only_ ? "synthesis_only" : ""},
+        "\n");
+    return options;
+  }
+
   std::string yosys_path_;
   std::string nextpnr_path_;
   std::string synthesis_target_;
@@ -94,6 +131,7 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
   bool save_temps_;
   bool return_netlist_;
   bool synthesis_only_;
+  CompileRunner runner_;
 };
 
 }  // namespace synthesis
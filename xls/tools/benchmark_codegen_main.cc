@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <iostream>
 #include <optional>
 #include <string>
@@ -21,10 +22,13 @@
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
 #include "absl/time/time.h"
+#include "xls/codegen/block_conversion.h"
 #include "xls/codegen/block_metrics.h"
+#include "xls/codegen/codegen_options.h"
 #include "xls/codegen/xls_metrics.pb.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
@@ -47,11 +51,22 @@ file. Designed to be used with run_benchmarks.py script.
 Usage:
    benchmark_codegen_main --delay_model=DELAY_MODEL \
      OPT_IR_FILE BLOCK_IR_FILE VERILOG_FILE
+
+Time block conversion of the optimized IR at several pipeline depths:
+   benchmark_codegen_main --delay_model=DELAY_MODEL \
+     --block_conversion_stages=1,4,16,64 \
+     OPT_IR_FILE BLOCK_IR_FILE VERILOG_FILE
 )";
 
 ABSL_FLAG(std::string, top, "",
           "Name of top block to use in lieu of the default.");
 ABSL_FLAG(bool, schedule, true, "Enable running the scheduler.");
+ABSL_FLAG(std::vector<std::string>, block_conversion_stages, {},
+          "Comma-separated list of pipeline stage counts. For each count the "
+          "top of the optimized IR is scheduled into that many stages and "
+          "converted into a pipelined block, and the time taken by the "
+          "conversion is printed. Used to track how block conversion scales "
+          "with the number of stages.");
 
 namespace xls {
 namespace {
@@ -75,6 +90,49 @@ absl::Status ScheduleAndPrintStats(Package* package,
   return absl::OkStatus();
 }
 
+// Schedules the top of `package` into each of the --block_conversion_stages
+// stage counts and prints the time taken to convert each schedule into a
+// pipelined block.
+absl::Status ConvertToBlocksAndPrintStats(Package* package,
+                                          const DelayEstimator& delay_estimator,
+                                          const SchedulingOptions& options) {
+  std::optional<FunctionBase*> top = package->GetTop();
+  if (!top.has_value()) {
+    return absl::InternalError(absl::StrFormat(
+        "Top entity not set for package: %s.", package->name()));
+  }
+  for (const std::string& text :
+       absl::GetFlag(FLAGS_block_conversion_stages)) {
+    int64_t stage_count;
+    if (!absl::SimpleAtoi(text, &stage_count) || stage_count <= 0) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Invalid --block_conversion_stages value `%s`; expected a positive "
+          "integer",
+          text));
+    }
+    SchedulingOptions stage_options = options;
+    stage_options.clear_clock_period_ps().pipeline_stages(stage_count);
+    XLS_ASSIGN_OR_RETURN(
+        PipelineSchedule schedule,
+        RunPipelineSchedule(top.value(), delay_estimator, stage_options));
+
+    // Each conversion adds a block to the package so give each a unique name.
+    verilog::CodegenOptions codegen_options;
+    codegen_options.module_name(absl::StrFormat(
+        "%s_%d_stages", top.value()->name(), stage_count));
+    absl::Time start = absl::Now();
+    XLS_RETURN_IF_ERROR(verilog::FunctionBaseToPipelinedBlock(
+                            schedule, codegen_options, top.value())
+                            .status());
+    absl::Duration total_time = absl::Now() - start;
+    std::cout << absl::StreamFormat("Block conversion time (%d stages): %dms\n",
+                                    stage_count,
+                                    total_time / absl::Milliseconds(1));
+  }
+
+  return absl::OkStatus();
+}
+
 absl::StatusOr<Block*> GetTopBlock(Package* package) {
   if (!absl::GetFlag(FLAGS_top).empty()) {
     return package->GetBlock(absl::GetFlag(FLAGS_top));
@@ -120,6 +178,8 @@ absl::Status RealMain(std::string_view opt_ir_path,
 
     XLS_RETURN_IF_ERROR(ScheduleAndPrintStats(
         opt_package.get(), *delay_estimator, scheduling_options));
+    XLS_RETURN_IF_ERROR(ConvertToBlocksAndPrintStats(
+        opt_package.get(), *delay_estimator, scheduling_options));
   }
 
   XLS_ASSIGN_OR_RETURN(Block * top, GetTopBlock(block_package.get()));
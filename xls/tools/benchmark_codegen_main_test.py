@@ -87,6 +87,19 @@ class CodeGenMainTest(test_base.TestCase):
     self.assertIn('Lines of Verilog: 7', output)
     self.assertIn('Scheduling time:', output)
 
+  def test_block_conversion_stages(self):
+    opt_ir_file = self.create_tempfile(content=OPT_IR)
+    block_ir_file = self.create_tempfile(content=BLOCK_IR)
+    verilog_file = self.create_tempfile(content=SIMPLE_VERILOG)
+    output = subprocess.check_output([
+        BENCHMARK_CODEGEN_MAIN_PATH, '--delay_model=unit',
+        '--clock_period_ps=10', '--block_conversion_stages=1,3',
+        opt_ir_file.full_path, block_ir_file.full_path, verilog_file.full_path
+    ]).decode('utf-8')
+
+    self.assertIn('Block conversion time (1 stages):', output)
+    self.assertIn('Block conversion time (3 stages):', output)
+
   def test_simple_block_no_delay_model(self):
     opt_ir_file = self.create_tempfile(content=OPT_IR)
     block_ir_file = self.create_tempfile(content=BLOCK_IR)
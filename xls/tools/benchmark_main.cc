@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <limits>
@@ -25,11 +26,16 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/pipeline_generator.h"
 #include "xls/common/exit_status.h"
@@ -37,6 +43,8 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/math_util.h"
+#include "xls/common/memory_accounting.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/delay_model/analyze_critical_path.h"
 #include "xls/delay_model/delay_estimator.h"
@@ -52,6 +60,8 @@
 #include "xls/passes/optimization_pass_pipeline.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/scheduling_pass_pipeline.h"
+#include "xls/tools/benchmark_recorder.h"
+#include "xls/tools/benchmark_results.pb.h"
 
 const char kUsage[] = R"(
 Prints numerous metrics and other information about an XLS IR file including:
@@ -64,6 +74,11 @@ where:
 
 Example invocation:
   benchmark_main path/to/file.ir
+
+With --output_json or --output_textproto, the measurements are also written
+as a BenchmarkResultsProto (see benchmark_results.proto) for tracking across
+XLS versions; --repetitions reruns the whole benchmark to summarize each
+measurement statistically.
 )";
 
 // LINT.IfChange
@@ -98,6 +113,20 @@ ABSL_FLAG(int64_t, convert_array_index_to_select, -1,
           "into chains of selects. Otherwise, this optimization is skipped, "
           "since it can sometimes reduce output quality.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
+ABSL_FLAG(int64_t, repetitions, 1,
+          "Number of times to run the whole benchmark. The results proto "
+          "holds the min, max, mean, median and standard deviation of each "
+          "measurement over the repetitions.");
+ABSL_FLAG(std::string, output_json, "",
+          "If set, writes the results as a BenchmarkResultsProto in JSON to "
+          "this file.");
+ABSL_FLAG(std::string, output_textproto, "",
+          "If set, writes the results as a BenchmarkResultsProto in text "
+          "format to this file.");
+ABSL_FLAG(std::string, memory_report, "",
+          "If set, accounts the memory used by the major XLS data structures "
+          "and writes a per-subsystem and per-stage report to this file, or "
+          "to stderr if '-'.");
 
 namespace xls {
 namespace {
@@ -109,9 +138,10 @@ std::string KnownBitString(Node* node, const QueryEngine& query_engine) {
   return query_engine.ToString(node);
 }
 
-void PrintNodeBreakdown(FunctionBase* f) {
+void PrintNodeBreakdown(FunctionBase* f, BenchmarkRecorder& recorder) {
   std::cout << absl::StreamFormat("Entry function (%s) node count: %d nodes\n",
                                   f->name(), f->node_count());
+  recorder.Record("node_count", "nodes", f->node_count());
   std::vector<Op> ops;
   absl::flat_hash_map<Op, int64_t> op_count;
   for (Node* node : f->nodes()) {
@@ -136,7 +166,8 @@ int64_t DurationToMs(absl::Duration duration) {
 
 // Run the standard pipeline on the given package and prints stats about the
 // passes and execution time.
-absl::Status RunOptimizationAndPrintStats(Package* package) {
+absl::Status RunOptimizationAndPrintStats(Package* package,
+                                          BenchmarkRecorder& recorder) {
   std::unique_ptr<OptimizationCompoundPass> pipeline =
       CreateOptimizationPassPipeline();
 
@@ -158,6 +189,9 @@ absl::Status RunOptimizationAndPrintStats(Package* package) {
                                   DurationToMs(total_time));
   std::cout << absl::StreamFormat("Dynamic pass count: %d\n",
                                   pass_results.invocations.size());
+  recorder.RecordStage("optimization", total_time);
+  recorder.Record("optimization.dynamic_pass_count", "passes",
+                  pass_results.invocations.size());
 
   // Aggregate run times by the pass name and print a table of the aggregate
   // execution time of each pass in decending order.
@@ -185,6 +219,8 @@ absl::Status RunOptimizationAndPrintStats(Package* package) {
                                     DurationToMs(pass_times.at(name)),
                                     changed_counts.at(name),
                                     pass_counts.at(name));
+    recorder.Record(absl::StrCat("optimization.pass.", name, ".time_ms"), "ms",
+                    absl::ToDoubleMilliseconds(pass_times.at(name)));
   }
   return absl::OkStatus();
 }
@@ -192,7 +228,8 @@ absl::Status RunOptimizationAndPrintStats(Package* package) {
 absl::Status PrintCriticalPath(
     FunctionBase* f, const QueryEngine& query_engine,
     const DelayEstimator& delay_estimator,
-    std::optional<int64_t> effective_clock_period_ps) {
+    std::optional<int64_t> effective_clock_period_ps,
+    BenchmarkRecorder& recorder) {
   XLS_ASSIGN_OR_RETURN(
       std::vector<CriticalPathEntry> critical_path,
       AnalyzeCriticalPath(f, effective_clock_period_ps, delay_estimator));
@@ -200,6 +237,9 @@ absl::Status PrintCriticalPath(
                                critical_path.front().path_delay_ps);
   std::cout << absl::StrFormat("Critical path entry count: %d\n",
                                critical_path.size());
+  recorder.Record("critical_path.delay_ps", "ps",
+                  critical_path.front().path_delay_ps);
+  recorder.Record("critical_path.entry_count", "nodes", critical_path.size());
 
   absl::flat_hash_map<Op, std::pair<int64_t, int64_t>> op_to_sum;
   std::cout << "Critical path:" << std::endl;
@@ -245,7 +285,8 @@ absl::Status PrintCriticalPath(
 }
 
 absl::Status PrintTotalDelay(FunctionBase* f,
-                             const DelayEstimator& delay_estimator) {
+                             const DelayEstimator& delay_estimator,
+                             BenchmarkRecorder& recorder) {
   int64_t total_delay = 0;
   for (Node* node : f->nodes()) {
     XLS_ASSIGN_OR_RETURN(int64_t op_delay,
@@ -253,6 +294,7 @@ absl::Status PrintTotalDelay(FunctionBase* f,
     total_delay += op_delay;
   }
   std::cout << absl::StrFormat("Total delay: %dps\n", total_delay);
+  recorder.Record("total_delay_ps", "ps", total_delay);
   return absl::OkStatus();
 }
 
@@ -283,7 +325,7 @@ absl::StatusOr<PipelineSchedule> ScheduleAndPrintStats(
     Package* package, const DelayEstimator& delay_estimator,
     std::optional<int64_t> clock_period_ps,
     std::optional<int64_t> pipeline_stages,
-    std::optional<int64_t> clock_margin_percent) {
+    std::optional<int64_t> clock_margin_percent, BenchmarkRecorder& recorder) {
   SchedulingPassOptions options;
   options.delay_estimator = &delay_estimator;
   if (clock_period_ps.has_value()) {
@@ -313,12 +355,14 @@ absl::StatusOr<PipelineSchedule> ScheduleAndPrintStats(
   absl::Duration total_time = absl::Now() - start;
   std::cout << absl::StreamFormat("Scheduling time: %dms\n",
                                   total_time / absl::Milliseconds(1));
+  recorder.RecordStage("scheduling", total_time);
 
   return std::move(*scheduling_unit.schedule);
 }
 
 absl::Status PrintCodegenInfo(FunctionBase* f,
-                              const PipelineSchedule& schedule) {
+                              const PipelineSchedule& schedule,
+                              BenchmarkRecorder& recorder) {
   absl::Time start = absl::Now();
   XLS_ASSIGN_OR_RETURN(verilog::ModuleGeneratorResult codegen_result,
                        verilog::ToPipelineModuleText(
@@ -326,13 +370,15 @@ absl::Status PrintCodegenInfo(FunctionBase* f,
   absl::Duration total_time = absl::Now() - start;
   std::cout << absl::StreamFormat("Codegen time: %dms\n",
                                   total_time / absl::Milliseconds(1));
+  recorder.RecordStage("codegen", total_time);
 
   // TODO(meheff): Add an estimate of total number of gates.
-  std::cout << absl::StreamFormat(
-      "Lines of Verilog: %d\n",
+  int64_t verilog_lines =
       std::vector<std::string>(
           absl::StrSplit(codegen_result.verilog_text, '\n'))
-          .size());
+          .size();
+  std::cout << absl::StreamFormat("Lines of Verilog: %d\n", verilog_lines);
+  recorder.Record("codegen.verilog_lines", "lines", verilog_lines);
 
   return absl::OkStatus();
 }
@@ -341,7 +387,8 @@ absl::Status PrintScheduleInfo(FunctionBase* f,
                                const PipelineSchedule& schedule,
                                const BddQueryEngine& bdd_query_engine,
                                const DelayEstimator& delay_estimator,
-                               std::optional<int64_t> clock_period_ps) {
+                               std::optional<int64_t> clock_period_ps,
+                               BenchmarkRecorder& recorder) {
   int64_t total_flops = 0;
   int64_t total_duplicates = 0;
   int64_t total_constants = 0;
@@ -407,6 +454,10 @@ absl::Status PrintScheduleInfo(FunctionBase* f,
   std::cout << absl::StreamFormat(
       "Total pipeline flops: %d (%d dups, %4d constant)\n", total_flops,
       total_duplicates, total_constants);
+  recorder.Record("schedule.stage_count", "stages", schedule.length());
+  recorder.Record("schedule.flops", "flops", total_flops);
+  recorder.Record("schedule.duplicate_flops", "flops", total_duplicates);
+  recorder.Record("schedule.constant_flops", "flops", total_constants);
 
   if (clock_period_ps.has_value()) {
     int64_t min_slack = std::numeric_limits<int64_t>::max();
@@ -414,12 +465,13 @@ absl::Status PrintScheduleInfo(FunctionBase* f,
       min_slack = std::min(min_slack, *clock_period_ps - stage_delay);
     }
     std::cout << absl::StreamFormat("Min stage slack: %d\n", min_slack);
+    recorder.Record("schedule.min_stage_slack_ps", "ps", min_slack);
   }
 
   return absl::OkStatus();
 }
 
-absl::Status PrintProcInfo(Proc* p) {
+absl::Status PrintProcInfo(Proc* p, BenchmarkRecorder& recorder) {
   XLS_RET_CHECK(p != nullptr);
 
   int64_t total_flops = 0;
@@ -428,6 +480,7 @@ absl::Status PrintProcInfo(Proc* p) {
   }
 
   std::cout << absl::StreamFormat("Total state flops: %d\n", total_flops);
+  recorder.Record("proc.state_flops", "flops", total_flops);
 
   return absl::OkStatus();
 }
@@ -457,7 +510,8 @@ absl::StatusOr<float> CountRate(std::function<void()> f, int64_t duration_ms) {
 }
 
 absl::Status RunInterpeterAndJit(FunctionBase* function_base,
-                                 std::string_view description) {
+                                 std::string_view description,
+                                 BenchmarkRecorder& recorder) {
   // Run the interpreter/JIT for a fixed amount of time and measure the rate of
   // calls per second.
   int64_t kRunDurationMs = 500;
@@ -468,9 +522,12 @@ absl::Status RunInterpeterAndJit(FunctionBase* function_base,
     absl::Time start_jit_compile = absl::Now();
     XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
                          FunctionJit::Create(function));
-    std::cout << absl::StreamFormat(
-        "JIT compile time (%s): %dms\n", description,
-        DurationToMs(absl::Now() - start_jit_compile));
+    absl::Duration jit_compile_time = absl::Now() - start_jit_compile;
+    std::cout << absl::StreamFormat("JIT compile time (%s): %dms\n",
+                                    description,
+                                    DurationToMs(jit_compile_time));
+    recorder.RecordStage(absl::StrCat(description, ".jit_compile"),
+                         jit_compile_time);
 
     const int64_t kInputCount = 100;
     std::vector<std::vector<Value>> arg_set(kInputCount);
@@ -517,6 +574,8 @@ absl::Status RunInterpeterAndJit(FunctionBase* function_base,
     std::cout << absl::StreamFormat(
         "JIT run time (%s): %d Kcalls/s\n", description,
         static_cast<int64_t>(kInputCount * jit_run_rate));
+    recorder.Record(absl::StrCat(description, ".jit.calls_per_second"),
+                    "calls/s", kInputCount * kJitRunMultiplier * jit_run_rate);
 
     XLS_ASSIGN_OR_RETURN(
         float interpreter_run_rate,
@@ -531,6 +590,8 @@ absl::Status RunInterpeterAndJit(FunctionBase* function_base,
     std::cout << absl::StreamFormat(
         "Interpreter run time (%s): %d calls/s\n", description,
         static_cast<int64_t>(kInputCount * interpreter_run_rate));
+    recorder.Record(absl::StrCat(description, ".interpreter.calls_per_second"),
+                    "calls/s", kInputCount * interpreter_run_rate);
     return absl::OkStatus();
   }
 
@@ -544,22 +605,30 @@ absl::Status RunInterpeterAndJit(FunctionBase* function_base,
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<ProcJit> jit,
       ProcJit::Create(proc, &queue_manager->runtime(), queue_manager.get()));
-  std::cout << absl::StreamFormat(
-      "JIT compile time (%s): %dms\n", description,
-      DurationToMs(absl::Now() - start_jit_compile));
+  absl::Duration jit_compile_time = absl::Now() - start_jit_compile;
+  std::cout << absl::StreamFormat("JIT compile time (%s): %dms\n", description,
+                                  DurationToMs(jit_compile_time));
+  recorder.RecordStage(absl::StrCat(description, ".jit_compile"),
+                       jit_compile_time);
   // TODO(meheff): 2022/5/16 Run the proc as well.
 
   return absl::OkStatus();
 }
 
-absl::Status RealMain(std::string_view path,
-                      std::optional<int64_t> clock_period_ps,
-                      std::optional<int64_t> pipeline_stages,
-                      std::optional<int64_t> clock_margin_percent) {
+absl::Status RunBenchmark(std::string_view path,
+                          std::optional<int64_t> clock_period_ps,
+                          std::optional<int64_t> pipeline_stages,
+                          std::optional<int64_t> clock_margin_percent,
+                          BenchmarkRecorder& recorder) {
   XLS_VLOG(1) << "Reading contents at path: " << path;
   XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
-                       Parser::ParsePackage(contents));
+  absl::Time start_parse = absl::Now();
+  std::unique_ptr<Package> package;
+  {
+    ScopedMemoryRegion region("parse");
+    XLS_ASSIGN_OR_RETURN(package, Parser::ParsePackage(contents));
+  }
+  recorder.RecordStage("parse", absl::Now() - start_parse);
   if (!absl::GetFlag(FLAGS_top).empty()) {
     XLS_RETURN_IF_ERROR(package->SetTopByName(absl::GetFlag(FLAGS_top)));
   }
@@ -568,15 +637,29 @@ absl::Status RealMain(std::string_view path,
     return absl::InternalError(absl::StrFormat(
         "Top entity not set for package: %s.", package->name()));
   }
-  XLS_RETURN_IF_ERROR(
-      RunInterpeterAndJit(package->GetTop().value(), "unoptimized"));
+  recorder.set_top(package->GetTop().value()->name());
+  recorder.Record("unoptimized.node_count", "nodes",
+                  package->GetTop().value()->node_count());
+  {
+    ScopedMemoryRegion region("unoptimized.jit");
+    XLS_RETURN_IF_ERROR(RunInterpeterAndJit(package->GetTop().value(),
+                                            "unoptimized", recorder));
+  }
 
-  XLS_RETURN_IF_ERROR(RunOptimizationAndPrintStats(package.get()));
+  {
+    ScopedMemoryRegion region("optimization");
+    XLS_RETURN_IF_ERROR(RunOptimizationAndPrintStats(package.get(), recorder));
+  }
 
   FunctionBase* f = package->GetTop().value();
   BddQueryEngine query_engine(BddFunction::kDefaultPathLimit);
-  XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
-  PrintNodeBreakdown(f);
+  absl::Time start_bdd = absl::Now();
+  {
+    ScopedMemoryRegion region("bdd_analysis");
+    XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
+  }
+  recorder.RecordStage("bdd_analysis", absl::Now() - start_bdd);
+  PrintNodeBreakdown(f, recorder);
 
   std::optional<int64_t> effective_clock_period_ps;
   if (clock_period_ps.has_value()) {
@@ -596,33 +679,80 @@ absl::Status RealMain(std::string_view path,
   }
   const auto& delay_estimator = *pdelay_estimator;
   XLS_RETURN_IF_ERROR(PrintCriticalPath(f, query_engine, delay_estimator,
-                                        effective_clock_period_ps));
-  XLS_RETURN_IF_ERROR(PrintTotalDelay(f, delay_estimator));
+                                        effective_clock_period_ps, recorder));
+  XLS_RETURN_IF_ERROR(PrintTotalDelay(f, delay_estimator, recorder));
 
   if (clock_period_ps.has_value() || pipeline_stages.has_value()) {
+    std::optional<ScopedMemoryRegion> scheduling_region(std::in_place,
+                                                        "scheduling");
     XLS_ASSIGN_OR_RETURN(
         PipelineSchedule schedule,
         ScheduleAndPrintStats(package.get(), delay_estimator, clock_period_ps,
-                              pipeline_stages, clock_margin_percent));
+                              pipeline_stages, clock_margin_percent, recorder));
+    scheduling_region.reset();
 
     // Only print codegen info for functions.
     //
     // TODO(tedhong): 2022-09-28 - Support passing additional codegen options
     // to benchmark_main to be able to codegen procs.
     if (f->IsFunction()) {
-      XLS_RETURN_IF_ERROR(PrintCodegenInfo(f, schedule));
+      ScopedMemoryRegion region("codegen");
+      XLS_RETURN_IF_ERROR(PrintCodegenInfo(f, schedule, recorder));
     }
 
     XLS_RETURN_IF_ERROR(PrintScheduleInfo(f, schedule, query_engine,
-                                          delay_estimator, clock_period_ps));
+                                          delay_estimator, clock_period_ps,
+                                          recorder));
 
     // Print out state information for procs.
     if (f->IsProc()) {
-      XLS_RETURN_IF_ERROR(PrintProcInfo(f->AsProcOrDie()));
+      XLS_RETURN_IF_ERROR(PrintProcInfo(f->AsProcOrDie(), recorder));
     }
   }
 
-  XLS_RETURN_IF_ERROR(RunInterpeterAndJit(f, "optimized"));
+  {
+    ScopedMemoryRegion region("optimized.jit");
+    XLS_RETURN_IF_ERROR(RunInterpeterAndJit(f, "optimized", recorder));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RealMain(std::string_view path,
+                      std::optional<int64_t> clock_period_ps,
+                      std::optional<int64_t> pipeline_stages,
+                      std::optional<int64_t> clock_margin_percent) {
+  int64_t repetitions = absl::GetFlag(FLAGS_repetitions);
+  if (repetitions < 1) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "--repetitions must be at least 1, got %d", repetitions));
+  }
+  std::string memory_report = absl::GetFlag(FLAGS_memory_report);
+  if (!memory_report.empty()) {
+    EnableMemoryAccounting();
+  }
+  BenchmarkRecorder recorder;
+  for (int64_t i = 0; i < repetitions; ++i) {
+    if (repetitions > 1) {
+      std::cout << absl::StreamFormat("Repetition %d of %d:\n", i + 1,
+                                      repetitions);
+    }
+    XLS_RETURN_IF_ERROR(RunBenchmark(path, clock_period_ps, pipeline_stages,
+                                     clock_margin_percent, recorder));
+  }
+
+  BenchmarkResultsProto results = recorder.ToProto(path, repetitions);
+  if (!absl::GetFlag(FLAGS_output_json).empty()) {
+    XLS_ASSIGN_OR_RETURN(std::string json, BenchmarkResultsToJson(results));
+    XLS_RETURN_IF_ERROR(
+        SetFileContents(absl::GetFlag(FLAGS_output_json), json));
+  }
+  if (!absl::GetFlag(FLAGS_output_textproto).empty()) {
+    XLS_RETURN_IF_ERROR(
+        SetTextProtoFile(absl::GetFlag(FLAGS_output_textproto), results));
+  }
+  if (!memory_report.empty()) {
+    XLS_RETURN_IF_ERROR(WriteMemoryAccountingReport(memory_report));
+  }
   return absl::OkStatus();
 }
 
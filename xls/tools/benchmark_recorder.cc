@@ -0,0 +1,106 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/benchmark_recorder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "google/protobuf/message.h"
+#include "google/protobuf/util/json_util.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "xls/common/memory_accounting.h"
+#include "xls/common/resource_usage.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/tools/benchmark_results.pb.h"
+
+namespace xls {
+
+void BenchmarkRecorder::Record(std::string_view name, std::string_view unit,
+                               double value) {
+  auto [it, inserted] = metrics_.try_emplace(std::string(name));
+  if (inserted) {
+    names_.push_back(std::string(name));
+    it->second.unit = unit;
+  }
+  it->second.samples.push_back(value);
+}
+
+void BenchmarkRecorder::RecordStage(std::string_view stage,
+                                    absl::Duration duration) {
+  Record(absl::StrCat(stage, ".time_ms"), "ms",
+         absl::ToDoubleMilliseconds(duration));
+  Record(absl::StrCat(stage, ".peak_rss_bytes"), "bytes", PeakRssBytes());
+  if (MemoryAccountingEnabled()) {
+    for (int64_t i = 0; i < kMemoryTagCount; ++i) {
+      MemoryTag tag = static_cast<MemoryTag>(i);
+      Record(absl::StrCat(stage, ".live_bytes.", MemoryTagName(tag)), "bytes",
+             GetMemoryTagStats(tag).live_bytes);
+    }
+  }
+}
+
+BenchmarkResultsProto BenchmarkRecorder::ToProto(std::string_view ir_file,
+                                                 int64_t repetitions) const {
+  BenchmarkResultsProto proto;
+  proto.set_ir_file(std::string(ir_file));
+  proto.set_top(top_);
+  proto.set_repetitions(repetitions);
+  for (const std::string& name : names_) {
+    const Metric& metric = metrics_.at(name);
+    BenchmarkMetricProto* metric_proto = proto.add_metrics();
+    metric_proto->set_name(name);
+    metric_proto->set_unit(metric.unit);
+    std::vector<double> sorted = metric.samples;
+    std::sort(sorted.begin(), sorted.end());
+    int64_t n = sorted.size();
+    double mean = 0.0;
+    for (double sample : metric.samples) {
+      metric_proto->add_samples(sample);
+      mean += sample / n;
+    }
+    double squares = 0.0;
+    for (double sample : metric.samples) {
+      squares += (sample - mean) * (sample - mean);
+    }
+    metric_proto->set_min(sorted.front());
+    metric_proto->set_max(sorted.back());
+    metric_proto->set_mean(mean);
+    metric_proto->set_median(n % 2 == 1
+                                 ? sorted[n / 2]
+                                 : (sorted[n / 2 - 1] + sorted[n / 2]) / 2);
+    metric_proto->set_stddev(n > 1 ? std::sqrt(squares / (n - 1)) : 0.0);
+  }
+  return proto;
+}
+
+absl::StatusOr<std::string> BenchmarkResultsToJson(
+    const google::protobuf::Message& results) {
+  std::string json;
+  google::protobuf::util::JsonPrintOptions print_options;
+  print_options.add_whitespace = true;
+  print_options.preserve_proto_field_names = true;
+  auto json_status = google::protobuf::util::MessageToJsonString(
+      results, &json, print_options);
+  XLS_RET_CHECK(json_status.ok()) << json_status.ToString();
+  return json;
+}
+
+}  // namespace xls
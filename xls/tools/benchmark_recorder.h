@@ -0,0 +1,65 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_TOOLS_BENCHMARK_RECORDER_H_
+#define XLS_TOOLS_BENCHMARK_RECORDER_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "google/protobuf/message.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "xls/tools/benchmark_results.pb.h"
+
+namespace xls {
+
+// Collects the measurements of each repetition of a benchmark, keyed by
+// metric name, and summarizes them as a BenchmarkResultsProto.
+class BenchmarkRecorder {
+ public:
+  void Record(std::string_view name, std::string_view unit, double value);
+
+  // Records the time taken by a stage of the flow and the peak memory use of
+  // the process after it. If memory accounting is enabled, also records the
+  // live bytes of each accounted subsystem after the stage.
+  void RecordStage(std::string_view stage, absl::Duration duration);
+
+  void set_top(std::string_view top) { top_ = top; }
+
+  BenchmarkResultsProto ToProto(std::string_view ir_file,
+                                int64_t repetitions) const;
+
+ private:
+  struct Metric {
+    std::string unit;
+    std::vector<double> samples;
+  };
+
+  std::string top_;
+  std::vector<std::string> names_;
+  absl::flat_hash_map<std::string, Metric> metrics_;
+};
+
+// Returns the JSON form of a benchmark results proto, with the proto field
+// names so the schema matches the .proto definition.
+absl::StatusOr<std::string> BenchmarkResultsToJson(
+    const google::protobuf::Message& results);
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_BENCHMARK_RECORDER_H_
@@ -41,8 +41,8 @@ Example invocation:
 )";
 
 ABSL_FLAG(bool, stream_from_file, false,
-          "Uses a file stream instead of loading into memory (to reduce memory "
-          "usage)");
+          "Memory-maps the file instead of loading a copy into memory (to "
+          "reduce memory usage)");
 
 namespace xls {
 namespace netlist {
@@ -12,8 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <thread>  // NOLINT(build/c++11)
@@ -24,6 +26,7 @@
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
@@ -32,14 +35,17 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/format_preference.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
+#include "xls/ir/value.h"
 #include "xls/passes/dce_pass.h"
 #include "xls/passes/inlining_pass.h"
 #include "xls/passes/map_inlining_pass.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/unroll_pass.h"
+#include "xls/solvers/equivalence_simulation.h"
 #include "xls/solvers/z3_ir_translator.h"
 #include "xls/solvers/z3_utils.h"
 #include "../z3/src/api/z3.h"
@@ -65,6 +71,11 @@ ABSL_FLAG(std::string, top, "",
           "Functions are supported.");
 ABSL_FLAG(absl::Duration, timeout, absl::InfiniteDuration(),
           "How long to wait for any proof to complete.");
+ABSL_FLAG(int64_t, simulation_samples, 4096,
+          "Before invoking the solver, both functions are run through the JIT "
+          "on corner-case inputs and this many random inputs; if any of them "
+          "shows the functions differ the solver is not invoked. A negative "
+          "value disables simulation.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
 
 namespace xls {
@@ -87,7 +98,8 @@ static absl::StatusOr<Z3_ast> CreateComparisonFunction(
 }
 
 static absl::Status RealMain(const std::vector<std::string_view>& ir_paths,
-                             const std::string& entry, absl::Duration timeout) {
+                             const std::string& entry, absl::Duration timeout,
+                             int64_t simulation_samples) {
   std::vector<std::unique_ptr<Package>> packages;
   for (const auto ir_path : ir_paths) {
     XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
@@ -127,6 +139,27 @@ static absl::Status RealMain(const std::vector<std::string_view>& ir_paths,
     functions.push_back(func);
   }
 
+  // Simulation is much cheaper than a proof and finds most inequivalences.
+  if (simulation_samples >= 0) {
+    XLS_ASSIGN_OR_RETURN(
+        std::optional<std::vector<Value>> counterexample,
+        solvers::FindCounterexampleBySimulation(
+            functions[0], functions[1],
+            solvers::EquivalenceSimulationOptions{
+                .random_sample_count = simulation_samples}));
+    if (counterexample.has_value()) {
+      std::cout << "Solver result; satisfiable: true\n\n"
+                << "  Counterexample found by simulation:\n";
+      for (int64_t i = 0; i < counterexample->size(); ++i) {
+        std::cout << absl::StreamFormat(
+            "    %s: %s\n", functions[0]->params()[i]->GetName(),
+            counterexample->at(i).ToString(FormatPreference::kHex));
+      }
+      std::cout << std::flush;
+      return absl::OkStatus();
+    }
+  }
+
   std::vector<std::unique_ptr<IrTranslator>> translators;
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
                        IrTranslator::CreateAndTranslate(functions[0]));
@@ -176,5 +209,6 @@ int main(int argc, char** argv) {
       xls::InitXls(kUsage, argc, argv);
   XLS_QCHECK_EQ(positional_args.size(), 2) << "Two IR files must be specified!";
   return xls::ExitStatus(xls::RealMain(
-      positional_args, absl::GetFlag(FLAGS_top), absl::GetFlag(FLAGS_timeout)));
+      positional_args, absl::GetFlag(FLAGS_top), absl::GetFlag(FLAGS_timeout),
+      absl::GetFlag(FLAGS_simulation_samples)));
 }
@@ -139,6 +139,7 @@ absl::StatusOr<verilog::CodegenOptions> CodegenOptionsFromProto(
 
   options.gate_recvs(p.gate_recvs());
   options.array_index_bounds_checking(p.array_index_bounds_checking());
+  options.codegen_threads(p.codegen_threads());
 
   return options;
 }
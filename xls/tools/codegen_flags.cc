@@ -14,6 +14,7 @@
 
 #include "xls/tools/codegen_flags.h"
 
+#include <cstdint>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -38,6 +39,10 @@ ABSL_FLAG(std::string, output_schedule_ir_path, "",
           "Path to write the scheduled IR.");
 ABSL_FLAG(std::string, output_block_ir_path, "",
           "Path to write the block-level IR.");
+ABSL_FLAG(bool, output_binary_ir, false,
+          "Write --output_schedule_ir_path and --output_block_ir_path in "
+          "the compact binary IR format rather than as IR text. The "
+          "format is smaller than IR text but not faster to load.");
 ABSL_FLAG(
     std::string, output_signature_path, "",
     "Specific output path for the module signature. If not specified then "
@@ -132,6 +137,10 @@ ABSL_FLAG(bool, gate_recvs, true,
 ABSL_FLAG(bool, array_index_bounds_checking, true,
           "If true, emit bounds checking on array-index operations in Verilog. "
           "Otherwise, the bounds checking is not evaluated.");
+ABSL_FLAG(int64_t, codegen_threads, 1,
+          "Number of threads used to generate Verilog for the top block and "
+          "the blocks it instantiates. The output does not depend on the "
+          "number of threads. If zero, one per hardware thread.");
 ABSL_FLAG(std::string, codegen_options_proto, "",
           "Path to a protobuf containing all codegen args.");
 // LINT.ThenChange(
@@ -226,6 +235,7 @@ static absl::StatusOr<bool> SetOptionsFromFlags(CodegenFlagsProto &proto) {
   // Optimizations
   POPULATE_FLAG(gate_recvs);
   POPULATE_FLAG(array_index_bounds_checking);
+  POPULATE_FLAG(codegen_threads);
 #undef POPULATE_FLAG
 #undef POPULATE_REPEATED_FLAG
   return any_flags_set;
@@ -23,6 +23,7 @@ ABSL_DECLARE_FLAG(std::string, output_verilog_path);
 ABSL_DECLARE_FLAG(std::string, output_schedule_path);
 ABSL_DECLARE_FLAG(std::string, output_schedule_ir_path);
 ABSL_DECLARE_FLAG(std::string, output_block_ir_path);
+ABSL_DECLARE_FLAG(bool, output_binary_ir);
 ABSL_DECLARE_FLAG(std::string, output_signature_path);
 ABSL_DECLARE_FLAG(std::string, output_verilog_line_map_path);
 
@@ -22,27 +22,35 @@
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/memory_accounting.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/delay_model/ffi_delay_estimator.h"
+#include "xls/ir/binary_ir.h"
 #include "xls/ir/function_base.h"
-#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
 #include "xls/ir/verifier.h"
 #include "xls/scheduling/pipeline_schedule.pb.h"
+#include "xls/scheduling/schedule_sweep.h"
+#include "xls/scheduling/scheduling_options.h"
 #include "xls/tools/codegen.h"
 #include "xls/tools/codegen_flags.h"
 #include "xls/tools/codegen_flags.pb.h"
 #include "xls/tools/scheduling_options_flags.h"
 
 const char kUsage[] = R"(
-Generates Verilog RTL from a given IR file. Writes a Verilog file and a module
-signature describing the module interface to a specified location. Example
-invocations:
+Generates Verilog RTL from a given IR file, which may be IR text or binary IR.
+Writes a Verilog file and a module signature describing the module interface to
+a specified location. Example invocations:
 
 Emit combinational module:
    codegen_main --generator=combinational --output_verilog_path=DIR IR_FILE
@@ -52,18 +60,91 @@ Emit a feed-forward pipelined module:
        --clock_period_ps=500 \
        --pipeline_stages=7 \
        IR_FILE
+
+Schedule for several design points and print a table of the results instead
+of generating Verilog:
+   codegen_main --schedule_sweep=500:*,400:*,*:4,*:6 \
+       --delay_model=unit IR_FILE
 )";
 
+ABSL_FLAG(std::vector<std::string>, schedule_sweep, {},
+          "Comma-separated list of CLOCK_PERIOD_PS:PIPELINE_STAGES targets, "
+          "either of which may be `*`. If given, the top is scheduled for each "
+          "target (sharing the parsed IR and the delay estimates) and a table "
+          "of stages, pipeline register bits, critical path and slack is "
+          "printed, marking the Pareto-optimal targets; no Verilog is "
+          "generated. --clock_period_ps and --pipeline_stages are ignored.");
+ABSL_FLAG(int64_t, schedule_sweep_threads, 0,
+          "Number of threads used to schedule the --schedule_sweep targets. "
+          "If zero, the --xls_threads default is used.");
+ABSL_FLAG(std::string, memory_report, "",
+          "If specified, attribute the memory allocated by the major XLS data "
+          "structures (IR nodes, BDDs, VAST, ...) to those subsystems and "
+          "write a report of it, split into parsing, scheduling and codegen, "
+          "to this path on completion. Use '-' to write it to stderr.");
+
 namespace xls {
 namespace {
 
+// Serializes the package as binary IR or IR text according to
+// --output_binary_ir.
+absl::StatusOr<std::string> SerializePackage(const Package& package) {
+  if (absl::GetFlag(FLAGS_output_binary_ir)) {
+    return PackageToBinaryIr(package);
+  }
+  return package.DumpIr();
+}
+
+// Schedules the top of `p` for each of the --schedule_sweep targets and prints
+// the results.
+absl::Status RunScheduleSweepMode(Package* p) {
+  std::vector<ScheduleSweepTarget> targets;
+  for (const std::string& text : absl::GetFlag(FLAGS_schedule_sweep)) {
+    XLS_ASSIGN_OR_RETURN(targets.emplace_back(),
+                         ParseScheduleSweepTarget(text));
+  }
+  XLS_ASSIGN_OR_RETURN(SchedulingOptions scheduling_options,
+                       SetUpSchedulingOptions(p));
+  XLS_ASSIGN_OR_RETURN(const DelayEstimator* base_estimator,
+                       SetUpDelayEstimator());
+  const FfiDelayEstimator ffi_estimator(
+      scheduling_options.ffi_fallback_delay_ps());
+  FirstMatchDelayEstimator delay_estimator("combined_estimator",
+                                           {base_estimator, &ffi_estimator});
+
+  int64_t thread_count = absl::GetFlag(FLAGS_schedule_sweep_threads);
+  if (thread_count <= 0) {
+    thread_count = DefaultThreadCount();
+  }
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<ScheduleSweepResult> results,
+      RunScheduleSweep(p->GetTop().value(), delay_estimator,
+                       scheduling_options, targets, thread_count));
+  std::cout << ScheduleSweepTable(results);
+  return absl::OkStatus();
+}
+
+absl::Status WriteMemoryReportIfRequested() {
+  const std::string& memory_report = absl::GetFlag(FLAGS_memory_report);
+  if (memory_report.empty()) {
+    return absl::OkStatus();
+  }
+  return WriteMemoryAccountingReport(memory_report);
+}
+
 absl::Status RealMain(std::string_view ir_path) {
   if (ir_path == "-") {
     ir_path = "/dev/stdin";
   }
-  XLS_ASSIGN_OR_RETURN(std::string ir_contents, GetFileContents(ir_path));
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> p,
-                       Parser::ParsePackage(ir_contents, ir_path));
+  if (!absl::GetFlag(FLAGS_memory_report).empty()) {
+    EnableMemoryAccounting();
+  }
+  std::unique_ptr<Package> p;
+  {
+    ScopedMemoryRegion parse_region("parse");
+    XLS_ASSIGN_OR_RETURN(std::string ir_contents, GetFileContents(ir_path));
+    XLS_ASSIGN_OR_RETURN(p, ParsePackageTextOrBinary(ir_contents, ir_path));
+  }
 
   XLS_ASSIGN_OR_RETURN(CodegenFlagsProto codegen_flags_proto,
                        GetCodegenFlags());
@@ -75,18 +156,30 @@ absl::Status RealMain(std::string_view ir_path) {
       << "Package " << p->name() << " needs a top function/proc.";
   auto main = [&p]() -> FunctionBase* { return p->GetTop().value(); };
 
+  if (!absl::GetFlag(FLAGS_schedule_sweep).empty()) {
+    {
+      ScopedMemoryRegion sweep_region("schedule_sweep");
+      XLS_RETURN_IF_ERROR(RunScheduleSweepMode(p.get()));
+    }
+    return WriteMemoryReportIfRequested();
+  }
+
   XLS_ASSIGN_OR_RETURN(bool delay_model_flag_passed,
                        IsDelayModelSpecifiedViaFlag());
+  std::optional<ScopedMemoryRegion> codegen_region(std::in_place,
+                                                   "schedule_and_codegen");
   XLS_ASSIGN_OR_RETURN(CodegenResult r,
                        ScheduleAndCodegen(p.get(), codegen_flags_proto,
                                           delay_model_flag_passed));
+  codegen_region.reset();
   verilog::ModuleGeneratorResult result = r.module_generator_result;
   std::optional<PipelineScheduleProto> schedule = r.pipeline_schedule_proto;
 
   if (!absl::GetFlag(FLAGS_output_schedule_ir_path).empty()) {
-    XLS_RETURN_IF_ERROR(
-        SetFileContents(absl::GetFlag(FLAGS_output_schedule_ir_path),
-                        main()->package()->DumpIr()));
+    XLS_ASSIGN_OR_RETURN(std::string schedule_ir,
+                         SerializePackage(*main()->package()));
+    XLS_RETURN_IF_ERROR(SetFileContents(
+        absl::GetFlag(FLAGS_output_schedule_ir_path), schedule_ir));
   }
 
   if (!absl::GetFlag(FLAGS_output_schedule_path).empty()) {
@@ -103,8 +196,9 @@ absl::Status RealMain(std::string_view ir_path) {
     XLS_QCHECK_EQ(p->blocks().size(), 1)
         << "There should be exactly one block in the package after generating "
            "module text.";
-    XLS_RETURN_IF_ERROR(SetFileContents(
-        absl::GetFlag(FLAGS_output_block_ir_path), p->DumpIr()));
+    XLS_ASSIGN_OR_RETURN(std::string block_ir, SerializePackage(*p));
+    XLS_RETURN_IF_ERROR(
+        SetFileContents(absl::GetFlag(FLAGS_output_block_ir_path), block_ir));
   }
 
   if (!absl::GetFlag(FLAGS_output_signature_path).empty()) {
@@ -132,7 +226,7 @@ absl::Status RealMain(std::string_view ir_path) {
   } else {
     XLS_RETURN_IF_ERROR(SetFileContents(verilog_path, result.verilog_text));
   }
-  return absl::OkStatus();
+  return WriteMemoryReportIfRequested();
 }
 
 }  // namespace
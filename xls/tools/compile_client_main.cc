@@ -0,0 +1,207 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/flags/declare.h"
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "grpcpp/channel.h"
+#include "grpcpp/client_context.h"
+#include "grpcpp/create_channel.h"
+#include "grpcpp/security/credentials.h"
+#include "grpcpp/support/status.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/synthesis/credentials.h"
+#include "xls/tools/codegen_flags.h"
+#include "xls/tools/codegen_flags.pb.h"
+#include "xls/tools/compile_service.grpc.pb.h"
+#include "xls/tools/compile_service.pb.h"
+
+const char kUsage[] = R"(
+Sends a conversion, optimization or codegen request to a running
+compile_server_main and writes the result to stdout. Takes the same flags as
+ir_converter_main, opt_main and codegen_main respectively; scheduling options
+are those the server was started with.
+
+Invocation:
+
+  compile_client_main --port=10000 --mode=convert --top=main foo.x
+  compile_client_main --port=10000 --mode=opt --top=main foo.ir
+  compile_client_main --port=10000 --mode=codegen --generator=combinational \
+    foo.opt.ir
+)";
+
+ABSL_FLAG(std::string, server, "localhost", "Host of the compile server.");
+ABSL_FLAG(int32_t, port, 10000, "Port of the compile server.");
+ABSL_FLAG(std::string, mode, "convert",
+          "Request to send: one of convert, opt or codegen.");
+// Conversion flags.
+ABSL_FLAG(std::string, package_name, "",
+          "Package name to use for output (required when multiple input .x "
+          "files are given).");
+ABSL_FLAG(std::string, stdlib_path, "",
+          "Path to DSLX standard library files; defaults to the server's.");
+ABSL_FLAG(std::string, dslx_path, "",
+          "Additional paths to search for modules (colon delimited).");
+ABSL_FLAG(bool, emit_fail_as_assert, true,
+          "Feature flag for emitting fail!() in the DSL as an assert IR op.");
+ABSL_FLAG(bool, verify, true,
+          "If true, verifies the generated IR for correctness.");
+ABSL_FLAG(bool, warnings_as_errors, true,
+          "Whether to fail early, as an error, if warnings are detected");
+ABSL_FLAG(std::string, disable_warnings, "",
+          "Comma-delimited list of warnings to disable.");
+// Optimization flags.
+ABSL_FLAG(int64_t, opt_level, 0,
+          "Optimization level; zero selects the default level.");
+ABSL_FLAG(std::vector<std::string>, skip_passes, {},
+          "If specified, passes in this comma-separated list of (short) "
+          "pass names are skipped.");
+ABSL_FLAG(bool, inline_procs, false,
+          "Whether to inline all procs by calling the proc inlining pass.");
+// Codegen flags, as well as --top, come from codegen_flags.cc.
+ABSL_DECLARE_FLAG(std::string, top);
+
+namespace xls {
+namespace {
+
+absl::Status GrpcToAbslStatus(const grpc::Status& grpc_status) {
+  return absl::Status(
+      // this assumes that the status code enums match up
+      static_cast<absl::StatusCode>(static_cast<int>(grpc_status.error_code())),
+      grpc_status.error_message());
+}
+
+absl::Status Convert(CompileService::Stub& stub, std::string_view path) {
+  ConvertDslxToIrRequest request;
+  // The server resolves the path relative to its own working directory.
+  request.set_path(std::filesystem::absolute(path).string());
+  request.set_top(absl::GetFlag(FLAGS_top));
+  request.set_package_name(absl::GetFlag(FLAGS_package_name));
+  request.set_stdlib_path(absl::GetFlag(FLAGS_stdlib_path));
+  for (std::string_view dslx_path :
+       absl::StrSplit(absl::GetFlag(FLAGS_dslx_path), ':',
+                      absl::SkipEmpty())) {
+    request.add_dslx_paths(std::filesystem::absolute(dslx_path).string());
+  }
+  request.set_no_emit_fail_as_assert(
+      !absl::GetFlag(FLAGS_emit_fail_as_assert));
+  request.set_no_verify(!absl::GetFlag(FLAGS_verify));
+  request.set_no_warnings_as_errors(!absl::GetFlag(FLAGS_warnings_as_errors));
+  request.set_disable_warnings(absl::GetFlag(FLAGS_disable_warnings));
+
+  grpc::ClientContext context;
+  ConvertDslxToIrResponse response;
+  XLS_RETURN_IF_ERROR(
+      GrpcToAbslStatus(stub.ConvertDslxToIr(&context, request, &response)));
+  std::cout << response.ir();
+  return absl::OkStatus();
+}
+
+absl::Status Optimize(CompileService::Stub& stub, std::string_view path) {
+  OptimizeIrRequest request;
+  XLS_ASSIGN_OR_RETURN(*request.mutable_ir(), GetFileContents(path));
+  request.set_top(absl::GetFlag(FLAGS_top));
+  request.set_opt_level(absl::GetFlag(FLAGS_opt_level));
+  for (const std::string& pass : absl::GetFlag(FLAGS_skip_passes)) {
+    request.add_skip_passes(pass);
+  }
+  request.set_inline_procs(absl::GetFlag(FLAGS_inline_procs));
+
+  grpc::ClientContext context;
+  OptimizeIrResponse response;
+  XLS_RETURN_IF_ERROR(
+      GrpcToAbslStatus(stub.OptimizeIr(&context, request, &response)));
+  std::cout << response.ir();
+  return absl::OkStatus();
+}
+
+absl::Status Codegen(CompileService::Stub& stub, std::string_view path) {
+  CodegenRequest request;
+  XLS_ASSIGN_OR_RETURN(*request.mutable_ir(), GetFileContents(path));
+  XLS_ASSIGN_OR_RETURN(*request.mutable_codegen_flags(),
+                       GetCodegenFlags());
+
+  grpc::ClientContext context;
+  CodegenResponse response;
+  XLS_RETURN_IF_ERROR(
+      GrpcToAbslStatus(stub.Codegen(&context, request, &response)));
+  if (!absl::GetFlag(FLAGS_output_signature_path).empty()) {
+    XLS_RETURN_IF_ERROR(SetTextProtoFile(
+        absl::GetFlag(FLAGS_output_signature_path), response.signature()));
+  }
+  if (!absl::GetFlag(FLAGS_output_schedule_path).empty() &&
+      response.has_schedule()) {
+    XLS_RETURN_IF_ERROR(SetTextProtoFile(
+        absl::GetFlag(FLAGS_output_schedule_path), response.schedule()));
+  }
+  if (absl::GetFlag(FLAGS_output_verilog_path).empty()) {
+    std::cout << response.verilog_text();
+  } else {
+    XLS_RETURN_IF_ERROR(SetFileContents(
+        absl::GetFlag(FLAGS_output_verilog_path), response.verilog_text()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RealMain(std::string_view path) {
+  std::string server = absl::StrCat(absl::GetFlag(FLAGS_server), ":",
+                                    absl::GetFlag(FLAGS_port));
+  std::shared_ptr<grpc::Channel> channel =
+      grpc::CreateChannel(server, synthesis::GetChannelCredentials());
+  std::unique_ptr<CompileService::Stub> stub(
+      CompileService::NewStub(channel));
+
+  std::string mode = absl::GetFlag(FLAGS_mode);
+  if (mode == "convert") {
+    return Convert(*stub, path);
+  }
+  if (mode == "opt") {
+    return Optimize(*stub, path);
+  }
+  if (mode == "codegen") {
+    return Codegen(*stub, path);
+  }
+  return absl::InvalidArgumentError(
+      absl::StrFormat("Invalid --mode: %s", mode));
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+
+  if (positional_arguments.size() != 1) {
+    XLS_LOG(QFATAL) << absl::StreamFormat("Expected invocation: %s <path>",
+                                          argv[0]);
+  }
+
+  return xls::ExitStatus(xls::RealMain(positional_arguments[0]));
+}
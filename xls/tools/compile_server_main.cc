@@ -0,0 +1,200 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "grpcpp/security/server_credentials.h"
+#include "grpcpp/server.h"
+#include "grpcpp/server_builder.h"
+#include "grpcpp/server_context.h"
+#include "grpcpp/support/status.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/ir_convert/ir_converter.h"
+#include "xls/dslx/warning_kind.h"
+#include "xls/ir/binary_ir.h"
+#include "xls/ir/package.h"
+#include "xls/synthesis/credentials.h"
+#include "xls/tools/codegen.h"
+#include "xls/tools/compile_service.grpc.pb.h"
+#include "xls/tools/compile_service.pb.h"
+#include "xls/tools/opt.h"
+#include "xls/tools/scheduling_options_flags.h"
+#include "grpcpp/support/status_code_enum.h"
+
+const char kUsage[] = R"(
+Launches a long-lived server performing the work of ir_converter_main, opt_main
+and codegen_main (see compile_service.proto), so repeated invocations do not
+each pay for process startup and the initialization of the pass and delay model
+registries. Scheduling options (delay model, clock period, etc.) are given on
+the server's command line with the same flags as codegen_main and apply to
+every codegen request.
+
+Invocation:
+
+  compile_server_main --port=10000 --delay_model=unit --clock_period_ps=500
+)";
+
+ABSL_FLAG(int32_t, port, 10000, "Port to listen on.");
+ABSL_FLAG(std::string, stdlib_path, xls::kDefaultDslxStdlibPath,
+          "Path to DSLX standard library files, used by conversion requests "
+          "which do not specify one.");
+ABSL_FLAG(std::string, opt_cache_dir, "",
+          "If non-empty, a directory holding a cache of optimized IR shared by "
+          "all optimization requests (see xls/tools/opt_cache.h).");
+
+namespace xls {
+namespace {
+
+::grpc::Status AbslToGrpcStatus(const absl::Status& status) {
+  if (status.ok()) {
+    return ::grpc::Status::OK;
+  }
+  return ::grpc::Status(
+      // this assumes that the status code enums match up
+      static_cast<::grpc::StatusCode>(static_cast<int>(status.code())),
+      std::string(status.message()));
+}
+
+absl::Status ConvertDslxToIr(const ConvertDslxToIrRequest& request,
+                             ConvertDslxToIrResponse* response) {
+  XLS_ASSIGN_OR_RETURN(
+      dslx::WarningKindSet enabled_warnings,
+      dslx::WarningKindSetFromDisabledString(request.disable_warnings()));
+  const dslx::ConvertOptions convert_options = {
+      .emit_positions = true,
+      .emit_fail_as_assert = !request.no_emit_fail_as_assert(),
+      .verify_ir = !request.no_verify(),
+      .warnings_as_errors = !request.no_warnings_as_errors(),
+      .enabled_warnings = enabled_warnings,
+  };
+  std::vector<std::filesystem::path> dslx_paths(request.dslx_paths().begin(),
+                                                request.dslx_paths().end());
+  std::string stdlib_path = request.stdlib_path().empty()
+                                ? absl::GetFlag(FLAGS_stdlib_path)
+                                : request.stdlib_path();
+  std::optional<std::string_view> top;
+  if (!request.top().empty()) {
+    top = request.top();
+  }
+  std::optional<std::string_view> package_name;
+  if (!request.package_name().empty()) {
+    package_name = request.package_name();
+  }
+  std::string_view path = request.path();
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<Package> package,
+      dslx::ConvertFilesToPackage({path}, stdlib_path, dslx_paths,
+                                  convert_options, top, package_name));
+  response->set_ir(package->DumpIr());
+  return absl::OkStatus();
+}
+
+absl::Status OptimizeIr(const OptimizeIrRequest& request,
+                        OptimizeIrResponse* response) {
+  tools::OptOptions options;
+  if (request.opt_level() != 0) {
+    options.opt_level = request.opt_level();
+  }
+  options.top = request.top();
+  options.skip_passes.assign(request.skip_passes().begin(),
+                             request.skip_passes().end());
+  options.inline_procs = request.inline_procs();
+  options.cache_dir = absl::GetFlag(FLAGS_opt_cache_dir);
+  XLS_ASSIGN_OR_RETURN(std::string ir,
+                       tools::OptimizeIrForTop(request.ir(), options));
+  response->set_ir(ir);
+  return absl::OkStatus();
+}
+
+absl::Status Codegen(const CodegenRequest& request,
+                     CodegenResponse* response) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> p,
+                       ParsePackageTextOrBinary(request.ir()));
+  XLS_ASSIGN_OR_RETURN(bool delay_model_flag_passed,
+                       IsDelayModelSpecifiedViaFlag());
+  XLS_ASSIGN_OR_RETURN(CodegenResult result,
+                       ScheduleAndCodegen(p.get(), request.codegen_flags(),
+                                          delay_model_flag_passed));
+  response->set_verilog_text(result.module_generator_result.verilog_text);
+  *response->mutable_signature() =
+      result.module_generator_result.signature.proto();
+  if (result.pipeline_schedule_proto.has_value()) {
+    *response->mutable_schedule() = *result.pipeline_schedule_proto;
+  }
+  return absl::OkStatus();
+}
+
+// Service implementation which performs each request from scratch; only
+// process-wide state (registries, the optimized IR cache) is shared between
+// requests. Requests are handled concurrently by gRPC's thread pool.
+class CompileServiceImpl : public CompileService::Service {
+ public:
+  ::grpc::Status ConvertDslxToIr(::grpc::ServerContext* server_context,
+                                 const ConvertDslxToIrRequest* request,
+                                 ConvertDslxToIrResponse* response) override {
+    return AbslToGrpcStatus(xls::ConvertDslxToIr(*request, response));
+  }
+
+  ::grpc::Status OptimizeIr(::grpc::ServerContext* server_context,
+                            const OptimizeIrRequest* request,
+                            OptimizeIrResponse* response) override {
+    return AbslToGrpcStatus(xls::OptimizeIr(*request, response));
+  }
+
+  ::grpc::Status Codegen(::grpc::ServerContext* server_context,
+                         const CodegenRequest* request,
+                         CodegenResponse* response) override {
+    return AbslToGrpcStatus(xls::Codegen(*request, response));
+  }
+};
+
+void RealMain() {
+  int port = absl::GetFlag(FLAGS_port);
+  std::string server_address = absl::StrCat("0.0.0.0:", port);
+  CompileServiceImpl service;
+
+  ::grpc::ServerBuilder builder;
+  std::shared_ptr<::grpc::ServerCredentials> creds =
+      synthesis::GetServerCredentials();
+  builder.AddListeningPort(server_address, creds);
+  builder.RegisterService(&service);
+  std::unique_ptr<::grpc::Server> server(builder.BuildAndStart());
+  XLS_LOG(INFO) << "Serving on port: " << port;
+  server->Wait();
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  xls::InitXls(kUsage, argc, argv);
+
+  xls::RealMain();
+
+  return EXIT_SUCCESS;
+}
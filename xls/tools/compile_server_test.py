@@ -0,0 +1,85 @@
+#
+# Copyright 2023 The XLS Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Tests of the compile service: client and server."""
+
+import subprocess
+import time
+
+import portpicker
+
+from absl.testing import absltest
+from xls.common import runfiles
+
+CLIENT_PATH = runfiles.get_path('xls/tools/compile_client_main')
+SERVER_PATH = runfiles.get_path('xls/tools/compile_server_main')
+
+DSLX = """
+fn main(x: u32, y: u32) -> u32 {
+  let z = x + y;
+  z + u32:0
+}
+"""
+
+
+class CompileServerTest(absltest.TestCase):
+
+  def setUp(self):
+    super().setUp()
+    self.port = portpicker.pick_unused_port()
+    self.server = subprocess.Popen([
+        SERVER_PATH, f'--port={self.port}', '--delay_model=unit',
+        '--clock_period_ps=1000'
+    ])
+    # allow some time for the server to open the port before continuing
+    time.sleep(1)
+
+  def tearDown(self):
+    self.server.terminate()
+    self.server.wait()
+    super().tearDown()
+
+  def _client(self, mode, path, *args):
+    return subprocess.check_output(
+        [CLIENT_PATH, f'--port={self.port}', f'--mode={mode}', path] +
+        list(args)).decode('utf-8')
+
+  def test_convert_opt_and_codegen(self):
+    dslx_file = self.create_tempfile('main.x', content=DSLX)
+    ir = self._client('convert', dslx_file.full_path)
+    self.assertIn('fn __main__main', ir)
+    self.assertIn('add(', ir)
+
+    ir_file = self.create_tempfile('main.ir', content=ir)
+    opt_ir = self._client('opt', ir_file.full_path, '--top=__main__main')
+    self.assertIn('package main', opt_ir)
+    # The addition of zero is optimized away.
+    self.assertEqual(opt_ir.count('add('), 1)
+
+    opt_ir_file = self.create_tempfile('main.opt.ir', content=opt_ir)
+    verilog = self._client('codegen', opt_ir_file.full_path,
+                           '--generator=pipeline', '--module_name=adder')
+    self.assertIn('module adder(', verilog)
+
+  def test_error(self):
+    dslx_file = self.create_tempfile('bad.x', content='fn main() -> u32 {')
+    # pylint: disable=subprocess-run-check
+    comp = subprocess.run(
+        [CLIENT_PATH, f'--port={self.port}', '--mode=convert',
+         dslx_file.full_path])
+    self.assertNotEqual(comp.returncode, 0)
+
+
+if __name__ == '__main__':
+  absltest.main()
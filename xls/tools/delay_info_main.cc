@@ -101,9 +101,10 @@ absl::Status RealMain(std::string_view input_path) {
     XLS_ASSIGN_OR_RETURN(PipelineSchedule schedule,
                          PipelineSchedule::FromProto(top, proto));
     XLS_RETURN_IF_ERROR(schedule.Verify());
+    XLS_ASSIGN_OR_RETURN(std::vector<Function*> stage_functions,
+                         ExtractAllStages(top, schedule));
     for (int64_t i = 0; i < schedule.length(); ++i) {
-      XLS_ASSIGN_OR_RETURN(Function * stage_function,
-                           ExtractStage(top, schedule, i));
+      Function* stage_function = stage_functions[i];
       XLS_ASSIGN_OR_RETURN(
           std::vector<CriticalPathEntry> critical_path,
           AnalyzeCriticalPath(stage_function, /*clock_period_ps=*/std::nullopt,
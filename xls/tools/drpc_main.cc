@@ -18,6 +18,7 @@
 // TODO(leary): 2019-04-07 Probably want a way to select the desired output
 // format; e.g. -hex, -dec, -bin and so on.
 
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <ostream>
@@ -27,11 +28,16 @@
 #include <vector>
 
 #include "absl/flags/flag.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/ir/format_preference.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/tools/device_rpc_strategy.h"
@@ -43,11 +49,53 @@ ABSL_FLAG(int64_t, device_ordinal, 0,
           "Device ordinal within the -target_device category, useful when "
           "multiple are present.");
 ABSL_FLAG(std::string, function_type, "", "Function type being invoked.");
+ABSL_FLAG(int64_t, benchmark_calls, 0,
+          "If positive, rather than printing the result, makes this many calls "
+          "with the given arguments both one at a time and as a single batch, "
+          "and reports the throughput of each.");
 
 namespace xls {
 namespace tools {
 namespace {
 
+void ReportThroughput(std::string_view label, int64_t calls,
+                      absl::Duration elapsed) {
+  std::cout << absl::StreamFormat(
+      "%s: %d calls in %s (%.1f calls/s)\n", label, calls,
+      absl::FormatDuration(elapsed),
+      static_cast<double>(calls) / absl::ToDoubleSeconds(elapsed));
+}
+
+// Makes `calls` calls with `arguments`, first one at a time and then as a
+// single batch, and reports the throughput of each.
+absl::Status RunBenchmark(DeviceRpcStrategy& drpc,
+                          const FunctionType& function_type,
+                          const std::vector<Value>& arguments, int64_t calls) {
+  absl::Time start = absl::Now();
+  XLS_ASSIGN_OR_RETURN(Value expected,
+                       drpc.CallUnnamed(function_type, arguments));
+  for (int64_t i = 1; i < calls; ++i) {
+    XLS_RETURN_IF_ERROR(drpc.CallUnnamed(function_type, arguments).status());
+  }
+  ReportThroughput("sequential", calls, absl::Now() - start);
+
+  std::vector<std::vector<Value>> argument_sets(calls, arguments);
+  start = absl::Now();
+  XLS_ASSIGN_OR_RETURN(std::vector<Value> results,
+                       drpc.CallUnnamedBatch(function_type, argument_sets));
+  ReportThroughput("batched", calls, absl::Now() - start);
+
+  for (int64_t i = 0; i < results.size(); ++i) {
+    if (results[i] != expected) {
+      return absl::InternalError(absl::StrFormat(
+          "Batched call %d returned %s, expected %s", i,
+          results[i].ToString(FormatPreference::kHex),
+          expected.ToString(FormatPreference::kHex)));
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::Status RealMain(absl::Span<const std::string_view> args) {
   std::string target_device = absl::GetFlag(FLAGS_target_device);
   XLS_QCHECK(!target_device.empty()) << "Must provide -target_device";
@@ -77,6 +125,10 @@ absl::Status RealMain(absl::Span<const std::string_view> args) {
   std::unique_ptr<DeviceRpcStrategy> drpc = std::move(drpc_status).value();
   XLS_QCHECK_OK(drpc->Connect(absl::GetFlag(FLAGS_device_ordinal)));
 
+  if (int64_t calls = absl::GetFlag(FLAGS_benchmark_calls); calls > 0) {
+    return RunBenchmark(*drpc, *function_type, arguments, calls);
+  }
+
   absl::StatusOr<Value> rpc_status =
       drpc->CallUnnamed(*function_type, arguments);
   if (rpc_status.ok()) {
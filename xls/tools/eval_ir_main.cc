@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <iostream>
 #include <memory>
@@ -19,21 +22,28 @@
 #include <random>
 #include <string>
 #include <string_view>
+#include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
 #include "xls/dslx/import_data.h"
@@ -47,6 +57,7 @@
 #include "xls/ir/package.h"
 #include "xls/ir/value_helpers.h"
 #include "xls/jit/function_jit.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_pipeline.h"
 
@@ -94,6 +105,10 @@ Evaluate IR after every optimization pass:
 Evaluate IR using the JIT and with the interpreter and compare the results:
 
    eval_ir_main --test_llvm_jit --random_inputs=100  IR_FILE
+
+Same as above, sharding the random inputs across 64 threads:
+
+   eval_ir_main --test_llvm_jit --random_inputs=1000000 --threads=64 IR_FILE
 )";
 
 // LINT.IfChange
@@ -108,6 +123,13 @@ ABSL_FLAG(std::string, input_file, "",
 ABSL_FLAG(int64_t, random_inputs, 0,
           "If non-zero, this is the number of randomly generated inputs to use "
           "in evaluation. Cannot be specified with --input.");
+ABSL_FLAG(int64_t, threads, 1,
+          "Number of threads used to evaluate --random_inputs. Zero uses one "
+          "thread per hardware thread. With more than one thread the inputs "
+          "are generated in fixed-size shards, each from its own "
+          "deterministically seeded engine, so the inputs and the first "
+          "mismatch reported do not depend on the number of threads. Cannot "
+          "be specified with --optimize_ir or --expected_file.");
 ABSL_FLAG(std::string, expected, "",
           "The expected result of the evaluation. A non-zero error code is "
           "returned if the evaluated result does not match.");
@@ -150,6 +172,11 @@ ABSL_FLAG(
     "Test-only flag for injecting the result produced by the JIT. Used to "
     "force mismatches between JIT and interpreter for testing purposed.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
+ABSL_FLAG(std::string, jit_profile, "",
+          "If non-empty, instrument the JIT-compiled function and print a "
+          "profile of where evaluation time is spent to stderr. Valid "
+          "values: `partition` (counters per partition of nodes) or `node` "
+          "(counters per partition and per node).");
 
 namespace xls {
 namespace {
@@ -169,6 +196,40 @@ std::string ArgsToString(absl::Span<const Value> args) {
   return absl::StrJoin(args, "; ", ValueFormatterHex);
 }
 
+// Evaluates the function on the given arguments with `jit` or, if `jit` is
+// null, with the interpreter.
+absl::StatusOr<Value> EvalArgs(Function* f, FunctionJit* jit,
+                               absl::Span<const Value> args) {
+  if (jit != nullptr) {
+    if (absl::GetFlag(FLAGS_test_only_inject_jit_result).empty()) {
+      return DropInterpreterEvents(jit->Run(args));
+    }
+    return Parser::ParseTypedValue(
+        absl::GetFlag(FLAGS_test_only_inject_jit_result));
+  }
+  // TODO(https://github.com/google/xls/issues/506): 2021-10-12 Also compare
+  // resulting events once the JIT fully supports events. Note: This will
+  // require rethinking some of the control flow because event comparison
+  // only makes sense for certain modes (optimize_ir and test_llvm_jit).
+  return DropInterpreterEvents(InterpretFunction(f, args));
+}
+
+// Returns an error if the result of evaluating input number `index` does not
+// match the expected value.
+absl::Status CheckResult(int64_t index, absl::Span<const Value> args,
+                         const Value& result, const Value& expected,
+                         std::string_view actual_src,
+                         std::string_view expected_src) {
+  if (result != expected) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Miscompare for input[%i] \"%s\"\n  %s: %s\n  %s: %s", index,
+        ArgsToString(args), actual_src,
+        result.ToString(FormatPreference::kHex), expected_src,
+        expected.ToString(FormatPreference::kHex)));
+  }
+  return absl::OkStatus();
+}
+
 // Evaluates the function with the given ArgSets. Returns an error if the result
 // does not match expectations (if any). 'actual_src' and 'expected_src' are
 // string descriptions of the sources of the actual results and expected
@@ -177,45 +238,36 @@ absl::StatusOr<std::vector<Value>> Eval(
     Function* f, absl::Span<const ArgSet> arg_sets, bool use_jit,
     std::string_view actual_src = "actual",
     std::string_view expected_src = "expected") {
+  std::unique_ptr<JitProfile> profile;
   std::unique_ptr<FunctionJit> jit;
   if (use_jit) {
+    if (!absl::GetFlag(FLAGS_jit_profile).empty()) {
+      XLS_ASSIGN_OR_RETURN(
+          JitProfileMode mode,
+          JitProfileModeFromString(absl::GetFlag(FLAGS_jit_profile)));
+      profile = std::make_unique<JitProfile>(mode);
+    }
     // No support for procs yet.
     XLS_ASSIGN_OR_RETURN(
-        jit, FunctionJit::Create(f, absl::GetFlag(FLAGS_llvm_opt_level)));
+        jit, FunctionJit::Create(f, absl::GetFlag(FLAGS_llvm_opt_level),
+                                 profile.get()));
   }
 
   std::vector<Value> results;
   for (const ArgSet& arg_set : arg_sets) {
-    Value result;
-    if (use_jit) {
-      if (absl::GetFlag(FLAGS_test_only_inject_jit_result).empty()) {
-        XLS_ASSIGN_OR_RETURN(result,
-                             DropInterpreterEvents(jit->Run(arg_set.args)));
-      } else {
-        XLS_ASSIGN_OR_RETURN(result, Parser::ParseTypedValue(absl::GetFlag(
-                                         FLAGS_test_only_inject_jit_result)));
-      }
-    } else {
-      // TODO(https://github.com/google/xls/issues/506): 2021-10-12 Also compare
-      // resulting events once the JIT fully supports events. Note: This will
-      // require rethinking some of the control flow because event comparison
-      // only makes sense for certain modes (optimize_ir and test_llvm_jit).
-      XLS_ASSIGN_OR_RETURN(
-          result, DropInterpreterEvents(InterpretFunction(f, arg_set.args)));
-    }
+    XLS_ASSIGN_OR_RETURN(Value result, EvalArgs(f, jit.get(), arg_set.args));
     std::cout << result.ToString(FormatPreference::kHex) << std::endl;
 
     if (arg_set.expected.has_value()) {
-      if (result != *arg_set.expected) {
-        return absl::InvalidArgumentError(absl::StrFormat(
-            "Miscompare for input[%i] \"%s\"\n  %s: %s\n  %s: %s",
-            results.size(), ArgsToString(arg_set.args), actual_src,
-            result.ToString(FormatPreference::kHex), expected_src,
-            arg_set.expected->ToString(FormatPreference::kHex)));
-      }
+      XLS_RETURN_IF_ERROR(CheckResult(results.size(), arg_set.args, result,
+                                      *arg_set.expected, actual_src,
+                                      expected_src));
     }
     results.push_back(result);
   }
+  if (profile != nullptr) {
+    std::cerr << profile->ToString();
+  }
   return results;
 }
 
@@ -398,6 +450,126 @@ absl::StatusOr<ArgSet> GenerateArgSet(Function* f, Function* validator,
       "or -input_validator_limit should be increased."));
 }
 
+// Number of random inputs generated from the engine of each shard when
+// --threads is given. Fixed so the inputs do not depend on the thread count.
+constexpr int64_t kRandomInputsPerShard = 256;
+
+// Seed of the sharded random input stream.
+constexpr int64_t kRandomInputsSeed = 0;
+
+// Evaluates `input_count` random inputs on `thread_count` threads. Inputs are
+// generated in shards of kRandomInputsPerShard and the results are printed in
+// input order. With --test_llvm_jit each input is evaluated with both the
+// interpreter and the JIT and the results are compared. Returns the error of
+// the lowest numbered failing input, if any.
+absl::Status RunRandomInputsInParallel(Function* f, Function* validator,
+                                       const std::optional<Value>& expected,
+                                       int64_t input_count,
+                                       int64_t thread_count) {
+  const bool test_jit = absl::GetFlag(FLAGS_test_llvm_jit);
+  const bool use_jit = test_jit || absl::GetFlag(FLAGS_use_llvm_jit);
+  const int64_t shard_count = CeilOfRatio(input_count, kRandomInputsPerShard);
+
+  std::atomic<int64_t> next_shard = 0;
+  absl::Mutex mutex;
+  // The lowest numbered failing input and its error. Shards starting after
+  // the failing input are skipped. JIT compilation failures are recorded as
+  // input -1.
+  int64_t failed_input = input_count;
+  absl::Status failure;
+  // Output of evaluated shards waiting for earlier shards to be printed.
+  absl::flat_hash_map<int64_t, std::string> pending_output;
+  int64_t next_shard_to_print = 0;
+
+  auto record_failure = [&](int64_t input, const absl::Status& status) {
+    absl::MutexLock lock(&mutex);
+    if (input < failed_input) {
+      failed_input = input;
+      failure = status;
+    }
+  };
+
+  auto eval_input = [&](FunctionJit* jit, int64_t index, const ArgSet& arg_set,
+                        std::string* output) -> absl::Status {
+    XLS_ASSIGN_OR_RETURN(Value result, EvalArgs(f, jit, arg_set.args));
+    absl::StrAppend(output, result.ToString(FormatPreference::kHex), "\n");
+    if (test_jit) {
+      XLS_ASSIGN_OR_RETURN(Value interpreter_result,
+                           EvalArgs(f, /*jit=*/nullptr, arg_set.args));
+      return CheckResult(index, arg_set.args, result, interpreter_result,
+                         "JIT", "interpreter");
+    }
+    if (arg_set.expected.has_value()) {
+      return CheckResult(index, arg_set.args, result, *arg_set.expected,
+                         "actual", "expected");
+    }
+    return absl::OkStatus();
+  };
+
+  auto worker = [&]() {
+    // FunctionJit::Run is not thread-safe so each worker compiles its own.
+    std::unique_ptr<FunctionJit> jit;
+    if (use_jit) {
+      absl::StatusOr<std::unique_ptr<FunctionJit>> jit_or =
+          FunctionJit::Create(f, absl::GetFlag(FLAGS_llvm_opt_level));
+      if (!jit_or.ok()) {
+        record_failure(-1, jit_or.status());
+        return;
+      }
+      jit = std::move(jit_or).value();
+    }
+    while (true) {
+      int64_t shard = next_shard.fetch_add(1);
+      int64_t start = shard * kRandomInputsPerShard;
+      if (shard >= shard_count) {
+        return;
+      }
+      {
+        absl::MutexLock lock(&mutex);
+        if (start >= failed_input) {
+          return;
+        }
+      }
+      int64_t end = std::min(start + kRandomInputsPerShard, input_count);
+      std::minstd_rand engine = ShardedRandomEngine(kRandomInputsSeed, shard);
+      std::string output;
+      for (int64_t i = start; i < end; ++i) {
+        absl::StatusOr<ArgSet> arg_set = GenerateArgSet(f, validator, &engine);
+        absl::Status status = arg_set.status();
+        if (status.ok()) {
+          arg_set->expected = expected;
+          status = eval_input(jit.get(), i, *arg_set, &output);
+        }
+        if (!status.ok()) {
+          record_failure(i, status);
+          break;
+        }
+      }
+
+      // Print the output of all shards up to the failing input in order.
+      absl::MutexLock lock(&mutex);
+      pending_output[shard] = std::move(output);
+      while (next_shard_to_print * kRandomInputsPerShard <= failed_input &&
+             pending_output.contains(next_shard_to_print)) {
+        auto it = pending_output.find(next_shard_to_print);
+        std::cout << it->second;
+        pending_output.erase(it);
+        ++next_shard_to_print;
+      }
+    }
+  };
+
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 0; i < std::min(thread_count, shard_count); ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  std::cout << std::flush;
+  return failure;
+}
+
 absl::Status RealMain(std::string_view input_path,
                       std::string_view dslx_stdlib_path) {
   if (input_path == "-") {
@@ -460,6 +632,33 @@ absl::Status RealMain(std::string_view input_path,
       XLS_ASSIGN_OR_RETURN(validator, validator_pkg->GetFunction(mangled_name));
     }
 
+    int64_t thread_count = absl::GetFlag(FLAGS_threads);
+    if (thread_count == 0) {
+      thread_count = std::max<int64_t>(1, std::thread::hardware_concurrency());
+    }
+    if (thread_count > 1) {
+      XLS_QCHECK(!absl::GetFlag(FLAGS_optimize_ir))
+          << "Cannot specify both --threads and --optimize_ir";
+      XLS_QCHECK(absl::GetFlag(FLAGS_expected_file).empty())
+          << "Cannot specify both --threads and --expected_file";
+      XLS_QCHECK(absl::GetFlag(FLAGS_jit_profile).empty())
+          << "Cannot specify both --threads and --jit_profile";
+      std::optional<Value> expected;
+      if (!absl::GetFlag(FLAGS_expected).empty()) {
+        XLS_QCHECK(!absl::GetFlag(FLAGS_test_llvm_jit))
+            << "Cannot specify expected values when using --test_llvm_jit";
+        absl::StatusOr<Value> expected_status =
+            Parser::ParseTypedValue(absl::GetFlag(FLAGS_expected));
+        XLS_QCHECK_OK(expected_status.status())
+            << "Failed to parse expected value: "
+            << absl::GetFlag(FLAGS_expected);
+        expected = expected_status.value();
+      }
+      return RunRandomInputsInParallel(f, validator, expected,
+                                       absl::GetFlag(FLAGS_random_inputs),
+                                       thread_count);
+    }
+
     for (ArgSet& arg_set : arg_sets) {
       XLS_ASSIGN_OR_RETURN(arg_set, GenerateArgSet(f, validator, &rng_engine));
     }
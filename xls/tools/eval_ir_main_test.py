@@ -192,6 +192,31 @@ class EvalMainTest(absltest.TestCase):
     # And with overwhelming probability they should all be different.
     self.assertLen(set(result.decode('utf-8').strip().split('\n')), 42)
 
+  def test_random_inputs_threads(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    outputs = []
+    for threads in (2, 3):
+      result = subprocess.check_output([
+          EVAL_IR_MAIN_PATH, '--random_inputs=1000', '--test_llvm_jit',
+          '--threads={}'.format(threads), ir_file.full_path
+      ])
+      outputs.append(result.decode('utf-8').strip().split('\n'))
+    self.assertLen(outputs[0], 1000)
+    # The inputs, and so the results, do not depend on the number of threads.
+    self.assertEqual(outputs[0], outputs[1])
+
+  def test_random_inputs_threads_mismatch(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    comp = subprocess.run([
+        EVAL_IR_MAIN_PATH, '--random_inputs=1000', '--test_llvm_jit',
+        '--threads=4', '--test_only_inject_jit_result=bits[32]:0x0',
+        ir_file.full_path
+    ],
+                          stderr=subprocess.PIPE,
+                          check=False)
+    self.assertNotEqual(comp.returncode, 0)
+    self.assertIn('Miscompare for input[0]', comp.stderr.decode('utf-8'))
+
   def test_jit_result_injection(self):
     ir_file = self.create_tempfile(content=ADD_IR)
     result = subprocess.check_output([
@@ -16,6 +16,8 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <memory>
 #include <optional>
@@ -29,6 +31,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/flags/flag.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
@@ -37,15 +40,20 @@
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/types/span.h"
+#include "xls/codegen/flattening.h"
 #include "xls/codegen/module_signature.pb.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/file/memory_mapped_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/block_interpreter.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/interpreter_proc_runtime.h"
+#include "xls/interpreter/paged_memory.h"
+#include "xls/interpreter/proc_runtime_profile.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function_builder.h"
@@ -54,7 +62,11 @@
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_helpers.h"
+#include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/jit_proc_runtime.h"
+#include "xls/jit/jit_profile.h"
+#include "xls/jit/jit_trace_buffer.h"
+#include "xls/jit/type_layout.h"
 #include "xls/tools/eval_helpers.h"
 
 constexpr const char* kUsage = R"(
@@ -120,6 +132,24 @@ ABSL_FLAG(
     "For procs, when 'expected_outputs_for_channels' or "
     "'expected_outputs_for_all_channels' are not specified the values of all "
     "the channel are displayed on stdout.");
+ABSL_FLAG(
+    std::vector<std::string>, raw_inputs_for_channels, {},
+    "Comma separated list of channel=filename pairs of binary input files for "
+    "the serial_jit backend. Files hold the values in the JIT's native layout "
+    "back to back, and are memory mapped and fed to the channels as they are "
+    "consumed rather than parsed up front.");
+ABSL_FLAG(
+    std::vector<std::string>, raw_expected_outputs_for_channels, {},
+    "Comma separated list of channel=filename pairs of binary files of "
+    "expected outputs, in the format of --raw_inputs_for_channels. Outputs "
+    "are compared as they are produced, so memory use does not grow with the "
+    "length of the run.");
+ABSL_FLAG(
+    std::vector<std::string>, raw_outputs_for_channels, {},
+    "Comma separated list of channel=filename pairs. Outputs of these "
+    "channels are written to the files as they are produced, in the format "
+    "of --raw_inputs_for_channels. Bytes of the native layout which do not "
+    "hold value bits (padding) are unspecified.");
 ABSL_FLAG(std::string, streaming_channel_data_suffix, "_data",
           "Suffix to data signals for streaming channels.");
 ABSL_FLAG(std::string, streaming_channel_valid_suffix, "_vld",
@@ -143,32 +173,272 @@ ABSL_FLAG(int64_t, random_seed, 42, "Random seed");
 ABSL_FLAG(double, prob_input_valid_assert, 1.0,
           "Single-cycle probability of asserting valid with more input ready.");
 ABSL_FLAG(bool, show_trace, false, "Whether or not to print trace messages.");
+ABSL_FLAG(std::string, jit_profile, "",
+          "If non-empty, instrument the JIT-compiled procs and print a profile "
+          "of where evaluation time is spent to stderr. Only supported by the "
+          "serial_jit backend. Valid values: `partition` (counters per "
+          "partition of nodes) or `node` (counters per partition and per "
+          "node).");
+ABSL_FLAG(int64_t, jit_trace_buffer_bytes, 0,
+          "If positive, record the trace messages of the JIT-compiled procs "
+          "into a ring buffer of this many bytes rather than formatting each "
+          "message as it fires. The most recent messages, with the tick in "
+          "which they fired, are printed to stderr at the end of the run. Only "
+          "supported by the serial_jit backend.");
+ABSL_FLAG(bool, proc_runtime_profile, false,
+          "If true, print to stderr how often each proc ran and blocked on "
+          "receives and sends, and a histogram of the occupancy of each "
+          "channel at the end of each tick. Used to find the procs limiting "
+          "throughput and to size FIFOs. Not supported by the "
+          "block_interpreter backend.");
 ABSL_FLAG(std::vector<std::string>, model_memories, {},
           "Comma separated list of memory=depth/element_type:initial_value "
           "pairs, for example: "
           "mem=32/bits[32]:0");
+ABSL_FLAG(std::string, model_memory_default_fill, "initial_value",
+          "What reads of modeled memory cells which have not been written "
+          "return. Valid values: `initial_value` (the initial value given in "
+          "--model_memories) or `error` (fail the simulation, to catch reads "
+          "of uninitialized memory).");
 
 namespace xls {
 
+// Binary stimulus, expected outputs and outputs of channels in the JIT's
+// native layout, by channel name.
+struct RawChannelFiles {
+  absl::flat_hash_map<std::string, std::string> inputs;
+  absl::flat_hash_map<std::string, std::string> expected_outputs;
+  absl::flat_hash_map<std::string, std::string> outputs;
+
+  bool empty() const {
+    return inputs.empty() && expected_outputs.empty() && outputs.empty();
+  }
+};
+
+// Feeds the values in a memory-mapped file in native layout to a channel a
+// window at a time, so that neither the file nor the queue is held in memory
+// all at once.
+class RawChannelInput {
+ public:
+  // Number of values the queue is topped up to before each tick.
+  static constexpr int64_t kWindow = 1024;
+
+  static absl::StatusOr<RawChannelInput> Open(JitChannelQueue* queue,
+                                              std::string_view path) {
+    XLS_ASSIGN_OR_RETURN(MemoryMappedFile file, MemoryMappedFile::Open(path));
+    if (file.contents().size() % queue->raw_element_size() != 0) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Size of %s (%d bytes) is not a multiple of the %d-byte native "
+          "layout of channel %s",
+          path, file.contents().size(), queue->raw_element_size(),
+          queue->channel()->name()));
+    }
+    return RawChannelInput(queue, std::move(file));
+  }
+
+  void Refill() {
+    std::string_view contents = file_.contents();
+    while (offset_ < contents.size() && queue_->GetSize() < kWindow) {
+      queue_->WriteRaw(
+          reinterpret_cast<const uint8_t*>(contents.data() + offset_));
+      offset_ += queue_->raw_element_size();
+    }
+  }
+
+ private:
+  RawChannelInput(JitChannelQueue* queue, MemoryMappedFile file)
+      : queue_(queue), file_(std::move(file)) {}
+
+  JitChannelQueue* queue_;
+  MemoryMappedFile file_;
+  int64_t offset_ = 0;
+};
+
+// Drains the values a channel produces, comparing them against a
+// memory-mapped file of expected values and/or appending them to a file, in
+// native layout.
+class RawChannelOutput {
+ public:
+  static absl::StatusOr<std::unique_ptr<RawChannelOutput>> Create(
+      JitChannelQueue* queue, JitRuntime& runtime,
+      std::optional<std::string_view> expected_path,
+      std::optional<std::string_view> output_path) {
+    auto output = absl::WrapUnique(new RawChannelOutput(
+        queue, runtime.CreateTypeLayout(queue->channel()->type())));
+    if (expected_path.has_value()) {
+      XLS_ASSIGN_OR_RETURN(MemoryMappedFile file,
+                           MemoryMappedFile::Open(*expected_path));
+      if (file.contents().size() % queue->raw_element_size() != 0) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Size of %s (%d bytes) is not a multiple of the %d-byte native "
+            "layout of channel %s",
+            *expected_path, file.contents().size(), queue->raw_element_size(),
+            queue->channel()->name()));
+      }
+      output->expected_ = std::move(file);
+    }
+    if (output_path.has_value()) {
+      output->output_.open(std::string(*output_path), std::ios::binary);
+      if (!output->output_) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Unable to open %s for writing", *output_path));
+      }
+    }
+    return output;
+  }
+
+  absl::Status Drain() {
+    while (queue_->ReadRaw(buffer_.data())) {
+      if (output_.is_open()) {
+        output_.write(reinterpret_cast<const char*>(buffer_.data()),
+                      buffer_.size());
+      }
+      if (expected_.has_value() && count_ < expected_count()) {
+        const char* expected =
+            expected_->contents().data() + count_ * buffer_.size();
+        // Padding bytes may differ between equal values, so fall back to
+        // comparing Values when the bytes differ.
+        if (std::memcmp(expected, buffer_.data(), buffer_.size()) != 0) {
+          Value expected_value = layout_.NativeLayoutToValue(
+              reinterpret_cast<const uint8_t*>(expected));
+          Value actual_value = layout_.NativeLayoutToValue(buffer_.data());
+          if (expected_value != actual_value) {
+            return absl::InternalError(absl::StrFormat(
+                "Mismatched (channel=%s) after %d outputs (%s != %s)",
+                queue_->channel()->name(), count_, expected_value.ToString(),
+                actual_value.ToString()));
+          }
+        }
+      }
+      ++count_;
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status Finish() {
+    if (output_.is_open()) {
+      output_.close();
+      if (output_.fail()) {
+        return absl::InternalError(
+            absl::StrFormat("Failed to write outputs of channel %s",
+                            queue_->channel()->name()));
+      }
+    }
+    if (expected_.has_value() && count_ < expected_count()) {
+      return absl::UnknownError(absl::StrFormat(
+          "Channel %s didn't consume %d expected values",
+          queue_->channel()->name(), expected_count() - count_));
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  RawChannelOutput(JitChannelQueue* queue, TypeLayout layout)
+      : queue_(queue),
+        layout_(std::move(layout)),
+        buffer_(queue->raw_element_size()) {}
+
+  int64_t expected_count() const {
+    return expected_->contents().size() / buffer_.size();
+  }
+
+  JitChannelQueue* queue_;
+  TypeLayout layout_;
+  std::optional<MemoryMappedFile> expected_;
+  std::ofstream output_;
+  std::vector<uint8_t> buffer_;
+  // Number of values drained so far.
+  int64_t count_ = 0;
+};
+
 static absl::Status EvaluateProcs(
     Package* package, bool use_jit, const std::vector<int64_t>& ticks,
-    const absl::flat_hash_map<std::string, std::vector<Value>>&
-        inputs_for_channels,
+    absl::flat_hash_map<std::string, std::vector<Value>> inputs_for_channels,
     absl::flat_hash_map<std::string, std::vector<Value>>&
-        expected_outputs_for_channels) {
+        expected_outputs_for_channels,
+    const RawChannelFiles& raw_files) {
+  XLS_RET_CHECK(use_jit || raw_files.empty());
+  std::unique_ptr<JitProfile> profile;
+  std::unique_ptr<JitTraceBuffer> trace_buffer;
   std::unique_ptr<SerialProcRuntime> runtime;
   if (use_jit) {
-    XLS_ASSIGN_OR_RETURN(runtime, CreateJitSerialProcRuntime(package));
+    if (!absl::GetFlag(FLAGS_jit_profile).empty()) {
+      XLS_ASSIGN_OR_RETURN(
+          JitProfileMode mode,
+          JitProfileModeFromString(absl::GetFlag(FLAGS_jit_profile)));
+      profile = std::make_unique<JitProfile>(mode);
+    }
+    if (absl::GetFlag(FLAGS_jit_trace_buffer_bytes) > 0) {
+      trace_buffer = std::make_unique<JitTraceBuffer>(
+          absl::GetFlag(FLAGS_jit_trace_buffer_bytes));
+    }
+    XLS_ASSIGN_OR_RETURN(runtime,
+                         CreateJitSerialProcRuntime(package, profile.get(),
+                                                    trace_buffer.get()));
   } else {
     XLS_ASSIGN_OR_RETURN(runtime, CreateInterpreterSerialProcRuntime(package));
   }
+  std::unique_ptr<ProcRuntimeProfile> runtime_profile;
+  if (absl::GetFlag(FLAGS_proc_runtime_profile)) {
+    runtime_profile = std::make_unique<ProcRuntimeProfile>();
+    runtime->SetProfile(runtime_profile.get());
+  }
 
   ChannelQueueManager& queue_manager = runtime->queue_manager();
-  for (const auto& [channel_name, values] : inputs_for_channels) {
+  for (auto& [channel_name, values] : inputs_for_channels) {
     XLS_ASSIGN_OR_RETURN(ChannelQueue * in_queue,
                          queue_manager.GetQueueByName(channel_name));
     for (const Value& value : values) {
-      XLS_RETURN_IF_ERROR(in_queue->Write(value));
+      if (!ValueConformsToType(value, in_queue->channel()->type())) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Channel %s expects values to have type %s, got: %s",
+            channel_name, in_queue->channel()->type()->ToString(),
+            value.ToString()));
+      }
+    }
+    // Feed the stimulus to the queue in batches as it is consumed rather than
+    // converting and copying every value up front.
+    XLS_RETURN_IF_ERROR(in_queue->AttachBatchGenerator(
+        FixedValueBatchGenerator(std::move(values))));
+  }
+
+  std::vector<RawChannelInput> raw_inputs;
+  std::vector<std::unique_ptr<RawChannelOutput>> raw_outputs;
+  absl::flat_hash_set<std::string> raw_output_channels;
+  if (!raw_files.empty()) {
+    auto& jit_queue_manager =
+        dynamic_cast<JitChannelQueueManager&>(queue_manager);
+    for (const auto& [channel_name, path] : raw_files.inputs) {
+      XLS_ASSIGN_OR_RETURN(Channel * channel,
+                           package->GetChannel(channel_name));
+      XLS_ASSIGN_OR_RETURN(
+          RawChannelInput input,
+          RawChannelInput::Open(&jit_queue_manager.GetJitQueue(channel), path));
+      raw_inputs.push_back(std::move(input));
+    }
+    for (const absl::flat_hash_map<std::string, std::string>* paths :
+         {&raw_files.expected_outputs, &raw_files.outputs}) {
+      for (const auto& [channel_name, path] : *paths) {
+        raw_output_channels.insert(channel_name);
+      }
+    }
+    for (const std::string& channel_name : raw_output_channels) {
+      XLS_ASSIGN_OR_RETURN(Channel * channel,
+                           package->GetChannel(channel_name));
+      std::optional<std::string_view> expected_path;
+      if (raw_files.expected_outputs.contains(channel_name)) {
+        expected_path = raw_files.expected_outputs.at(channel_name);
+      }
+      std::optional<std::string_view> output_path;
+      if (raw_files.outputs.contains(channel_name)) {
+        output_path = raw_files.outputs.at(channel_name);
+      }
+      XLS_ASSIGN_OR_RETURN(
+          std::unique_ptr<RawChannelOutput> output,
+          RawChannelOutput::Create(&jit_queue_manager.GetJitQueue(channel),
+                                   jit_queue_manager.runtime(), expected_path,
+                                   output_path));
+      raw_outputs.push_back(std::move(output));
     }
   }
 
@@ -185,7 +455,13 @@ static absl::Status EvaluateProcs(
       }
       // Don't double print events (traces, assertions, etc)
       runtime->ClearInterpreterEvents();
+      for (RawChannelInput& input : raw_inputs) {
+        input.Refill();
+      }
       XLS_RETURN_IF_ERROR(runtime->Tick());
+      for (std::unique_ptr<RawChannelOutput>& output : raw_outputs) {
+        XLS_RETURN_IF_ERROR(output->Drain());
+      }
 
       // Sort the keys for stable print order.
       absl::flat_hash_map<Proc*, std::vector<Value>> states;
@@ -220,6 +496,30 @@ static absl::Status EvaluateProcs(
     }
   }
 
+  if (profile != nullptr) {
+    std::cerr << profile->ToString();
+  }
+  if (trace_buffer != nullptr) {
+    if (trace_buffer->dropped_count() > 0) {
+      std::cerr << absl::StreamFormat(
+          "%d earlier trace messages were dropped from the trace buffer\n",
+          trace_buffer->dropped_count());
+    }
+    trace_buffer->ForEachRecord([](const JitTraceBuffer::Record& record) {
+      std::cerr << absl::StreamFormat(
+          "Tick %d: Proc %s trace: %s\n", record.tick,
+          record.trace->function_base()->name(),
+          JitTraceBuffer::FormatRecord(record));
+    });
+  }
+  if (runtime_profile != nullptr) {
+    std::cerr << runtime_profile->ToString();
+  }
+
+  for (std::unique_ptr<RawChannelOutput>& output : raw_outputs) {
+    XLS_RETURN_IF_ERROR(output->Finish());
+  }
+
   bool checked_any_output = false;
   for (const auto& [channel_name, values] : expected_outputs_for_channels) {
     XLS_ASSIGN_OR_RETURN(ChannelQueue * out_queue,
@@ -248,7 +548,8 @@ static absl::Status EvaluateProcs(
 
   if (expected_outputs_for_channels.empty()) {
     for (const Channel* channel : package->channels()) {
-      if (!channel->CanSend()) {
+      if (!channel->CanSend() ||
+          raw_output_channels.contains(channel->name())) {
         continue;
       }
       XLS_ASSIGN_OR_RETURN(ChannelQueue * out_queue,
@@ -412,23 +713,34 @@ InterpretBlockSignature(
 
 class MemoryModel {
  public:
-  MemoryModel(const std::string& name, size_t size, const Value& initial_value,
-              const Value& read_disabled_value, bool show_trace)
-      : name_(name),
-        read_disabled_value_(read_disabled_value),
-        show_trace_(show_trace) {
-    cells_.resize(size, initial_value);
+  // The cells are held in a PagedMemory, so only the pages written cost
+  // memory and address spaces far larger than the host memory can be
+  // modeled if they are accessed sparsely.
+  static absl::StatusOr<std::unique_ptr<MemoryModel>> Create(
+      const std::string& name, int64_t size, Type* element_type,
+      const Value& initial_value, const Value& read_disabled_value,
+      DefaultFill default_fill, bool show_trace) {
+    if (!initial_value.IsBits() ||
+        initial_value.bits().bit_count() != element_type->GetFlatBitCount()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Memory %s initial value %s does not match the element type %s",
+          name, initial_value.ToString(), element_type->ToString()));
+    }
+    PagedMemory::Options options;
+    options.default_fill = default_fill;
+    XLS_ASSIGN_OR_RETURN(PagedMemory cells,
+                         PagedMemory::CreateForBits(
+                             name, size, initial_value.bits(), options));
+    return absl::WrapUnique(new MemoryModel(name, std::move(cells),
+                                            read_disabled_value, show_trace));
   }
   absl::Status Read(int64_t addr) {
-    if (addr < 0 || addr >= cells_.size()) {
-      return absl::OutOfRangeError(
-          absl::StrFormat("Memory %s read out of range at %i", name_, addr));
-    }
     if (read_this_tick_.has_value()) {
       return absl::FailedPreconditionError(
           absl::StrFormat("Memory %s double read in tick at %i", name_, addr));
     }
-    read_this_tick_ = cells_[addr];
+    XLS_ASSIGN_OR_RETURN(Bits bits, cells_.ReadBits(addr));
+    read_this_tick_ = Value(std::move(bits));
     if (show_trace_) {
       XLS_LOG(INFO) << "Memory Model: Initiated read " << name_ << "[" << addr
                     << "] = " << read_this_tick_.value();
@@ -450,7 +762,7 @@ class MemoryModel {
   }
   bool DidReadLastTick() const { return read_last_tick_.has_value(); }
   absl::Status Write(int64_t addr, const Value& value) {
-    if (addr < 0 || addr >= cells_.size()) {
+    if (addr < 0 || addr >= cells_.element_count()) {
       return absl::OutOfRangeError(
           absl::StrFormat("Memory %s write out of range at %i", name_, addr));
     }
@@ -458,10 +770,11 @@ class MemoryModel {
       return absl::FailedPreconditionError(
           absl::StrFormat("Memory %s double write in tick at %i", name_, addr));
     }
-    if (value.GetFlatBitCount() != cells_[0].GetFlatBitCount()) {
+    if (!value.IsBits() ||
+        value.bits().bit_count() != cells_.element_bit_count()) {
       return absl::FailedPreconditionError(absl::StrFormat(
           "Memory %s write value at %i with wrong bit count %i, expected %i",
-          name_, addr, value.GetFlatBitCount(), cells_[0].GetFlatBitCount()));
+          name_, addr, value.GetFlatBitCount(), cells_.element_bit_count()));
     }
     if (show_trace_) {
       XLS_LOG(INFO) << "Memory Model: Initiated write " << name_ << "[" << addr
@@ -477,7 +790,8 @@ class MemoryModel {
                       << write_this_tick_->first
                       << "] = " << write_this_tick_->second;
       }
-      cells_[write_this_tick_->first] = write_this_tick_->second;
+      XLS_RETURN_IF_ERROR(cells_.WriteBits(write_this_tick_->first,
+                                           write_this_tick_->second.bits()));
       write_this_tick_.reset();
     }
     read_last_tick_ = read_this_tick_;
@@ -486,9 +800,16 @@ class MemoryModel {
   }
 
  private:
+  MemoryModel(const std::string& name, PagedMemory cells,
+              const Value& read_disabled_value, bool show_trace)
+      : name_(name),
+        read_disabled_value_(read_disabled_value),
+        cells_(std::move(cells)),
+        show_trace_(show_trace) {}
+
   const std::string name_;
   const Value read_disabled_value_;
-  std::vector<Value> cells_;
+  PagedMemory cells_;
   std::optional<std::pair<int64_t, Value>> write_this_tick_;
   std::optional<Value> read_this_tick_;
   std::optional<Value> read_last_tick_;
@@ -517,6 +838,7 @@ static absl::Status RunBlockInterpreter(
         expected_outputs_for_channels,
     const absl::flat_hash_map<std::string, std::pair<int64_t, Value>>&
         model_memories_param,
+    DefaultFill memory_default_fill,
     std::string_view streaming_channel_data_suffix,
     std::string_view streaming_channel_ready_suffix,
     std::string_view streaming_channel_valid_suffix,
@@ -575,9 +897,12 @@ static absl::Status RunBlockInterpreter(
   for (const auto& [name, model_pair] : model_memories_param) {
     const std::string rd_data = name + std::string(memory_read_data_suffix);
     XLS_ASSIGN_OR_RETURN(const InputPort* port, block->GetInputPort(rd_data));
-    model_memories[name] = std::make_unique<MemoryModel>(
-        name, model_pair.first, model_pair.second,
-        /*read_disabled_value=*/XsOfType(port->GetType()), show_trace);
+    XLS_ASSIGN_OR_RETURN(
+        model_memories[name],
+        MemoryModel::Create(name, model_pair.first, port->GetType(),
+                            model_pair.second,
+                            /*read_disabled_value=*/XsOfType(port->GetType()),
+                            memory_default_fill, show_trace));
   }
 
   // Initial register state is one for all registers.
@@ -866,6 +1191,10 @@ static absl::Status RealMain(
     const std::vector<std::string>& inputs_for_channels_text,
     const std::vector<std::string>& expected_outputs_for_channels_text,
     const std::vector<std::string>& model_memories_text,
+    std::string_view model_memory_default_fill,
+    const std::vector<std::string>& raw_inputs_for_channels_text,
+    const std::vector<std::string>& raw_expected_outputs_for_channels_text,
+    const std::vector<std::string>& raw_outputs_for_channels_text,
     const std::string& inputs_for_all_channels_text,
     const std::string& expected_outputs_for_all_channels_text,
     std::string_view streaming_channel_data_suffix,
@@ -913,6 +1242,29 @@ static absl::Status RealMain(
     XLS_ASSIGN_OR_RETURN(model_memories,
                          ParseMemoryModels(model_memories_text));
   }
+  DefaultFill memory_default_fill;
+  if (model_memory_default_fill == "initial_value") {
+    memory_default_fill = DefaultFill::kFillElement;
+  } else if (model_memory_default_fill == "error") {
+    memory_default_fill = DefaultFill::kError;
+  } else {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Unknown --model_memory_default_fill value: %s",
+                        model_memory_default_fill));
+  }
+
+  RawChannelFiles raw_files;
+  XLS_ASSIGN_OR_RETURN(raw_files.inputs,
+                       ParseChannelFilenames(raw_inputs_for_channels_text));
+  XLS_ASSIGN_OR_RETURN(
+      raw_files.expected_outputs,
+      ParseChannelFilenames(raw_expected_outputs_for_channels_text));
+  XLS_ASSIGN_OR_RETURN(raw_files.outputs,
+                       ParseChannelFilenames(raw_outputs_for_channels_text));
+  if (backend != "serial_jit" && !raw_files.empty()) {
+    return absl::InvalidArgumentError(
+        "Binary channel files are only supported by the serial_jit backend");
+  }
 
   XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_file));
   XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
@@ -924,18 +1276,20 @@ static absl::Status RealMain(
 
   if (backend == "serial_jit") {
     return EvaluateProcs(package.get(), /*use_jit=*/true, ticks,
-                         inputs_for_channels, expected_outputs_for_channels);
+                         std::move(inputs_for_channels),
+                         expected_outputs_for_channels, raw_files);
   }
   if (backend == "ir_interpreter") {
     return EvaluateProcs(package.get(), /*use_jit=*/false, ticks,
-                         inputs_for_channels, expected_outputs_for_channels);
+                         std::move(inputs_for_channels),
+                         expected_outputs_for_channels, raw_files);
   }
   if (backend == "block_interpreter") {
     verilog::ModuleSignatureProto proto;
     XLS_CHECK_OK(ParseTextProtoFile(block_signature_proto, &proto));
     return RunBlockInterpreter(
         package.get(), ticks, proto, max_cycles_no_output, inputs_for_channels,
-        expected_outputs_for_channels, model_memories,
+        expected_outputs_for_channels, model_memories, memory_default_fill,
         streaming_channel_data_suffix, streaming_channel_ready_suffix,
         streaming_channel_valid_suffix, memory_read_enable_suffix,
         memory_read_address_suffix, memory_read_data_suffix,
@@ -997,6 +1351,10 @@ int main(int argc, char* argv[]) {
       absl::GetFlag(FLAGS_inputs_for_channels),
       absl::GetFlag(FLAGS_expected_outputs_for_channels),
       absl::GetFlag(FLAGS_model_memories),
+      absl::GetFlag(FLAGS_model_memory_default_fill),
+      absl::GetFlag(FLAGS_raw_inputs_for_channels),
+      absl::GetFlag(FLAGS_raw_expected_outputs_for_channels),
+      absl::GetFlag(FLAGS_raw_outputs_for_channels),
       absl::GetFlag(FLAGS_inputs_for_all_channels),
       absl::GetFlag(FLAGS_expected_outputs_for_all_channels),
       absl::GetFlag(FLAGS_streaming_channel_data_suffix),
@@ -13,6 +13,8 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import os
+import struct
 import subprocess
 import textwrap
 
@@ -705,6 +707,43 @@ class EvalProcTest(absltest.TestCase):
         "Memory Model: Initiated read mem[3] = bits[32]:6", output.stderr
     )
 
+  def test_raw_channel_files(self):
+    ir_file = self.create_tempfile(content=PROC_IR)
+    # bits[64] values are 8 little-endian bytes in the native layout.
+    input_file = self.create_tempfile(content=struct.pack("<2Q", 42, 101))
+    input_file_2 = self.create_tempfile(content=struct.pack("<2Q", 10, 6))
+    expected_file = self.create_tempfile(content=struct.pack("<2Q", 62, 127))
+    output_path = os.path.join(self.create_tempdir().full_path, "out_ch_2.bin")
+
+    shared_args = [
+        EVAL_PROC_MAIN_PATH, ir_file.full_path, "--ticks", "2",
+        "--logtostderr", "--backend", "serial_jit",
+        "--raw_inputs_for_channels",
+        "in_ch={},in_ch_2={}".format(input_file.full_path,
+                                     input_file_2.full_path),
+        "--raw_outputs_for_channels", "out_ch_2={}".format(output_path)
+    ]
+    run_command(shared_args + [
+        "--raw_expected_outputs_for_channels",
+        "out_ch={}".format(expected_file.full_path)
+    ])
+    with open(output_path, "rb") as f:
+      self.assertEqual(struct.unpack("<2Q", f.read()), (55, 55))
+
+    mismatched_file = self.create_tempfile(
+        content=struct.pack("<2Q", 62, 128))
+    comp = subprocess.run(
+        shared_args + [
+            "--raw_expected_outputs_for_channels",
+            "out_ch={}".format(mismatched_file.full_path)
+        ],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        encoding="utf-8",
+        check=False)
+    self.assertNotEqual(comp.returncode, 0)
+    self.assertIn("Mismatched (channel=out_ch) after 1 outputs", comp.stderr)
+
 
 if __name__ == "__main__":
   absltest.main()
@@ -13,18 +13,25 @@
 // limitations under the License.
 
 // Simple driver for executing the ExtractStage() routine.
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT
 #include <optional>
 #include <string>
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
 #include "xls/scheduling/extract_stage.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/pipeline_schedule.pb.h"
@@ -39,13 +46,22 @@ ABSL_FLAG(std::string, schedule_path, "",
 ABSL_FLAG(
     int, stage, -1,
     "Pipeline stage to extract, if not specified all stages are extracted.");
+ABSL_FLAG(int64_t, threads, 1,
+          "Number of threads used to extract the stages when all stages are "
+          "extracted. Zero uses one thread per hardware thread.");
+ABSL_FLAG(std::string, output_dir, "",
+          "If set, all stages are extracted and each is written as its own "
+          "package to <output_dir>/<stage function name>.ir instead of "
+          "writing one package to --output_path.");
 
 namespace xls {
 
 static absl::Status RealMain(const std::string& ir_path,
                              std::optional<std::string> function_name,
                              const std::string& schedule_path, int stage,
-                             const std::string& output_path) {
+                             int64_t thread_count,
+                             const std::string& output_path,
+                             const std::string& output_dir) {
   XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
   XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
   FunctionBase* function;
@@ -67,17 +83,16 @@ static absl::Status RealMain(const std::string& ir_path,
                        PipelineSchedule::FromProto(function, proto));
   std::vector<FunctionBase*> funcs = package->GetFunctionBases();
 
+  std::vector<Function*> stages;
   if (stage == -1) {
-    for (int i = 0; i < schedule.length(); ++i) {
-      XLS_ASSIGN_OR_RETURN(Function * stage,
-                           ExtractStage(function, schedule, i));
-      XLS_RETURN_IF_ERROR(package->SetTop(stage));
-    }
+    XLS_ASSIGN_OR_RETURN(stages,
+                         ExtractAllStages(function, schedule, thread_count));
   } else {
-    XLS_ASSIGN_OR_RETURN(Function * stage,
+    XLS_ASSIGN_OR_RETURN(Function * stage_function,
                          ExtractStage(function, schedule, stage));
-    XLS_RETURN_IF_ERROR(package->SetTop(stage));
+    stages.push_back(stage_function);
   }
+  XLS_RETURN_IF_ERROR(package->SetTop(stages.back()));
 
   for (auto& f : funcs) {
     XLS_RETURN_IF_ERROR(package->RemoveFunctionBase(f));
@@ -85,8 +100,20 @@ static absl::Status RealMain(const std::string& ir_path,
   while (!package->channels().empty()) {
     XLS_RETURN_IF_ERROR(package->RemoveChannel(package->channels().front()));
   }
-  XLS_RETURN_IF_ERROR(SetFileContents(output_path, package->DumpIr()));
-
+  if (output_dir.empty()) {
+    return SetFileContents(output_path, package->DumpIr());
+  }
+  for (Function* stage_function : stages) {
+    Package stage_package(package->name());
+    XLS_ASSIGN_OR_RETURN(
+        Function * cloned,
+        stage_function->Clone(stage_function->name(), &stage_package));
+    XLS_RETURN_IF_ERROR(stage_package.SetTop(cloned));
+    XLS_RETURN_IF_ERROR(SetFileContents(
+        std::filesystem::path(output_dir) /
+            absl::StrCat(stage_function->name(), ".ir"),
+        stage_package.DumpIr()));
+  }
   return absl::OkStatus();
 }
 
@@ -108,8 +135,18 @@ int main(int argc, char* argv[]) {
 
   int stage = absl::GetFlag(FLAGS_stage);
 
+  int64_t thread_count = absl::GetFlag(FLAGS_threads);
+  if (thread_count == 0) {
+    thread_count = std::max<int64_t>(1, std::thread::hardware_concurrency());
+  }
+
   std::string output_path = absl::GetFlag(FLAGS_output_path);
-  XLS_QCHECK(!output_path.empty()) << "--output path can't be empty!";
-  return xls::ExitStatus(
-      xls::RealMain(ir_path, function_name, schedule_path, stage, output_path));
+  std::string output_dir = absl::GetFlag(FLAGS_output_dir);
+  XLS_QCHECK(output_path.empty() != output_dir.empty())
+      << "Exactly one of --output_path and --output_dir must be given!";
+  XLS_QCHECK(output_dir.empty() || stage == -1)
+      << "--output_dir extracts all stages and can't be used with --stage!";
+  return xls::ExitStatus(xls::RealMain(ir_path, function_name, schedule_path,
+                                       stage, thread_count, output_path,
+                                       output_dir));
 }
@@ -15,13 +15,21 @@
 """Analyze Yosys and OpenSTA logs and gather metrics info.
 
    Usage: gather_design_stats [--out <name.textproto>] [list of log files]
+          gather_design_stats --per_design [--jobs <n>]
+              [--out <name.textproto>] [list of design directories]
 
    Overall and per-pipeline-stage statistics will be gathered from
    provided Yosys and OpenSTA logfiles, and written to a DesignStats
    textproto at a location specified by the '--out' option.
+
+   With '--per_design' each argument is a directory holding the logs of one
+   design. The designs are scraped by '--jobs' processes and written, in the
+   given order and as each is done, to a DesignStatsList textproto.
 """
 
 import gzip
+import multiprocessing
+import os
 import re
 
 from absl import app
@@ -34,6 +42,18 @@ _OUT_PROTO = flags.DEFINE_string(
     "out", default="metrics.textproto", help="Path to output protobuf."
 )
 _DEBUG = flags.DEFINE_bool("debug", default=False, help="Enable debugging.")
+_PER_DESIGN = flags.DEFINE_bool(
+    "per_design",
+    default=False,
+    help="Treat each argument as a directory holding the logs of one design.",
+)
+_JOBS = flags.DEFINE_integer(
+    "jobs",
+    default=0,
+    help="Number of designs scraped concurrently with --per_design. Zero "
+    "uses the number of CPUs.",
+)
+_LOG_SUFFIXES = (".log", ".log.gz")
 
 
 def save_protobuf(model: design_stats_pb2.DesignStats, path: str):
@@ -137,9 +157,34 @@ def scrape_file(model: design_stats_pb2.DesignStats, path: str):
   scrape(model, file_handle)
 
 
+def scrape_design_dir(path: str) -> bytes:
+  """Returns the serialized DesignStats of the logs in directory 'path'."""
+  model = design_stats_pb2.DesignStats()
+  model.design = os.path.basename(os.path.normpath(path))
+  for name in sorted(os.listdir(path)):
+    if name.endswith(_LOG_SUFFIXES):
+      scrape_file(model, os.path.join(path, name))
+  return model.SerializeToString()
+
+
+def save_design_stats_list(design_dirs, path: str, jobs: int):
+  """Scrapes each design directory into an entry of a DesignStatsList."""
+  with gfile.open(path, "w") as out:
+    with multiprocessing.Pool(jobs or None) as pool:
+      # Entries are written as they complete (in order) rather than held
+      # until all designs are done; concatenated entries form a valid list.
+      for serialized in pool.imap(scrape_design_dir, design_dirs):
+        entry = design_stats_pb2.DesignStatsList()
+        entry.designs.add().ParseFromString(serialized)
+        out.write(text_format.MessageToString(entry))
+
+
 def main(argv):
   if _DEBUG.value:
     print(argv)
+  if _PER_DESIGN.value:
+    save_design_stats_list(argv[1:], _OUT_PROTO.value, _JOBS.value)
+    return
   buf = design_stats_pb2.DesignStats()
   for f in argv[1:]:
     scrape_file(buf, f)
@@ -14,11 +14,15 @@
 # limitations under the License.
 """Tests for xls/tools/gather_design_stats.py."""
 
+import os
+import shutil
 import subprocess
 
 from absl.testing import absltest
+from google.protobuf import text_format
 from xls.common import runfiles
 from xls.common import test_base
+from xls.tools import design_stats_pb2
 
 _GATHER_DESIGN_STATS_PATH = runfiles.get_path('xls/tools/gather_design_stats')
 _STA_LOG_PATH = runfiles.get_path(
@@ -69,6 +73,36 @@ class GatherDesignStatsMainTest(test_base.TestCase):
     ]).decode('utf-8')
     self.assertEmpty(diff_output)
 
+  def test_per_design(self):
+    design_dirs = []
+    for name in ('design_a', 'design_b'):
+      design_dir = self.create_tempdir(name).full_path
+      shutil.copy(_SYN_LOG_PATH, design_dir)
+      shutil.copy(_STA_LOG_PATH, design_dir)
+      design_dirs.append(design_dir)
+    out_textproto_file = self.create_tempfile()
+    subprocess.run(
+        [
+            _GATHER_DESIGN_STATS_PATH,
+            '--per_design',
+            '--jobs=2',
+            '--out',
+            out_textproto_file.full_path,
+        ]
+        + design_dirs,
+        check=True,
+    )
+    stats_list = text_format.Parse(
+        out_textproto_file.read_text(), design_stats_pb2.DesignStatsList()
+    )
+    with open(_EXP_TEXTPROTO_PATH) as f:
+      expected = text_format.Parse(f.read(), design_stats_pb2.DesignStats())
+    self.assertLen(stats_list.designs, 2)
+    for design_dir, stats in zip(design_dirs, stats_list.designs):
+      self.assertEqual(stats.design, os.path.basename(design_dir))
+      stats.ClearField('design')
+      self.assertEqual(stats, expected)
+
 
 if __name__ == '__main__':
   absltest.main()
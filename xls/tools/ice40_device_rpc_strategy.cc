@@ -20,18 +20,23 @@
 #include <termios.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <ios>
 #include <optional>
 #include <string>
 #include <system_error>
+#include <utility>
 #include <vector>
 
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/math_util.h"
@@ -167,6 +172,48 @@ std::string LocalModesToString(tcflag_t local_modes) {
   return absl::StrJoin(pieces, ", ");
 }
 
+// Returns the bytes sent to the device for a call with the given arguments.
+absl::StatusOr<std::vector<uint8_t>> EncodeArguments(
+    absl::Span<const Value> arguments) {
+  BitPushBuffer buffer;
+  for (const Value& arg : arguments) {
+    arg.FlattenTo(&buffer);
+  }
+
+  if (buffer.empty()) {
+    // TODO(leary): 2019-04-07 We probably want this to be possible eventually,
+    // but we'd have to decide whether in this case the device function is
+    // constantly producing output data since there's no input event to trigger
+    // it, so we'd just move on to the read itself.
+    return absl::InvalidArgumentError("Cannot perform an empty-payload RPC.");
+  }
+  return buffer.GetUint8Data();
+}
+
+// Returns the number of bytes the device responds with for each call.
+int64_t ResultByteCount(const FunctionType& function_type) {
+  int64_t output_bits = function_type.return_type()->GetFlatBitCount();
+  return CeilOfRatio(output_bits, int64_t{8});
+}
+
+// Converts the bytes of a device response into the result value.
+absl::StatusOr<Value> DecodeResult(const FunctionType& function_type,
+                                   absl::Span<const uint8_t> result) {
+  if (function_type.return_type()->IsBits() &&
+      function_type.return_type()->AsBitsOrDie()->bit_count() == 8) {
+    return Value(UBits(result[0], 8));
+  }
+
+  if (function_type.return_type()->IsBits() &&
+      function_type.return_type()->AsBitsOrDie()->bit_count() == 32) {
+    uint32_t value;
+    std::memcpy(&value, result.data(), sizeof(value));
+    return Value(UBits(value, 32));
+  }
+
+  return absl::UnimplementedError("NYI: convert result to Value");
+}
+
 }  // namespace
 
 Ice40DeviceRpcStrategy::~Ice40DeviceRpcStrategy() {
@@ -208,6 +255,9 @@ absl::Status Ice40DeviceRpcStrategy::Connect(int64_t device_ordinal) {
   t.c_iflag &= ~(BRKINT | ICRNL | INPCK | ISTRIP | IXON);
   t.c_oflag &= ~OPOST;
   t.c_lflag &= ~(ICANON | ECHO | IEXTEN | ISIG);
+  // The device deasserts clear-to-send while it cannot accept a byte, which is
+  // what lets CallUnnamedBatch queue several calls on the link.
+  t.c_cflag |= CRTSCTS;
   t.c_cc[VINTR] = 0;
   t.c_cc[VQUIT] = 0;
   t.c_cc[VERASE] = 0;
@@ -260,72 +310,119 @@ absl::Status Ice40DeviceRpcStrategy::Connect(int64_t device_ordinal) {
   return absl::OkStatus();
 }
 
-absl::StatusOr<Value> Ice40DeviceRpcStrategy::CallUnnamed(
-    const FunctionType& function_type, absl::Span<const Value> arguments) {
-  BitPushBuffer buffer;
-  for (const Value& arg : arguments) {
-    arg.FlattenTo(&buffer);
-  }
-
-  if (buffer.empty()) {
-    // TODO(leary): 2019-04-07 We probably want this to be possible eventually,
-    // but we'd have to decide whether in this case the device function is
-    // constantly producing output data since there's no input event to trigger
-    // it, so we'd just move on to the read itself.
-    return absl::InvalidArgumentError("Cannot perform an empty-payload RPC.");
-  }
-
-  std::vector<uint8_t> u8_data = buffer.GetUint8Data();
-
+absl::Status Ice40DeviceRpcStrategy::WriteAll(absl::Span<const uint8_t> data) {
   int64_t bytes_written = 0;
-  while (bytes_written < buffer.size_in_bytes()) {
-    int ret = write(tty_fd_.value(), u8_data.data() + bytes_written,
-                    u8_data.size() - bytes_written);
+  while (bytes_written < data.size()) {
+    int ret = write(tty_fd_.value(), data.data() + bytes_written,
+                    data.size() - bytes_written);
     if (ret < 0) {
       return absl::InternalError(
           absl::StrFormat("Could not write partial data of %d remaining bytes "
                           "(originally %d) to ICE40: %s",
-                          buffer.size_in_bytes() - bytes_written,
-                          buffer.size_in_bytes(), Strerror(errno)));
+                          data.size() - bytes_written, data.size(),
+                          Strerror(errno)));
     }
     bytes_written += ret;
   }
+  return absl::OkStatus();
+}
 
-  if (tcflush(tty_fd_.value(), TCOFLUSH) != 0) {
-    return absl::InternalError("Could not flush write(s) to device.");
-  }
-
-  int64_t output_bits = function_type.return_type()->GetFlatBitCount();
-  std::vector<uint8_t> result(CeilOfRatio(output_bits, int64_t{8}));
-
-  XLS_VLOG(3) << "Reading device response; expecting " << result.size()
+absl::Status Ice40DeviceRpcStrategy::ReadAll(absl::Span<uint8_t> data) {
+  XLS_VLOG(3) << "Reading device response; expecting " << data.size()
               << " bytes.";
-
   int64_t bytes_read = 0;
-  while (bytes_read < result.size()) {
-    int ret = read(tty_fd_.value(), result.data() + bytes_read,
-                   result.size() - bytes_read);
+  while (bytes_read < data.size()) {
+    int ret = read(tty_fd_.value(), data.data() + bytes_read,
+                   data.size() - bytes_read);
     if (ret < 0) {
       return absl::InternalError(
           absl::StrFormat("Could not read partial data of %d remaining bytes "
                           "(originally %d) from ICE40: %s",
-                          buffer.size_in_bytes() - bytes_written,
-                          buffer.size_in_bytes(), Strerror(errno)));
+                          data.size() - bytes_read, data.size(),
+                          Strerror(errno)));
     }
     bytes_read += ret;
   }
+  return absl::OkStatus();
+}
 
-  if (function_type.return_type()->IsBits() &&
-      function_type.return_type()->AsBitsOrDie()->bit_count() == 8) {
-    return Value(UBits(result[0], 8));
+absl::StatusOr<Value> Ice40DeviceRpcStrategy::CallUnnamed(
+    const FunctionType& function_type, absl::Span<const Value> arguments) {
+  if (!tty_fd_.has_value()) {
+    return absl::FailedPreconditionError("Not connected to an ICE40 device.");
   }
+  XLS_ASSIGN_OR_RETURN(std::vector<uint8_t> u8_data,
+                       EncodeArguments(arguments));
+  XLS_RETURN_IF_ERROR(WriteAll(u8_data));
 
-  if (function_type.return_type()->IsBits() &&
-      function_type.return_type()->AsBitsOrDie()->bit_count() == 32) {
-    return Value(UBits(*absl::bit_cast<uint32_t*>(result.data()), 32));
+  if (tcflush(tty_fd_.value(), TCOFLUSH) != 0) {
+    return absl::InternalError("Could not flush write(s) to device.");
   }
 
-  return absl::UnimplementedError("NYI: convert result to Value");
+  std::vector<uint8_t> result(ResultByteCount(function_type));
+  XLS_RETURN_IF_ERROR(ReadAll(absl::MakeSpan(result)));
+  return DecodeResult(function_type, result);
+}
+
+absl::StatusOr<std::vector<Value>> Ice40DeviceRpcStrategy::CallUnnamedBatch(
+    const FunctionType& function_type,
+    absl::Span<const std::vector<Value>> argument_sets) {
+  if (!tty_fd_.has_value()) {
+    return absl::FailedPreconditionError("Not connected to an ICE40 device.");
+  }
+  // The device handles one call at a time and holds off the host with the
+  // clear-to-send line while it is busy, so the arguments of later calls can
+  // be queued on the link while earlier calls are running. Calls are sent in
+  // windows, with the next window written before the results of the current
+  // one are read, so the link never idles waiting for the host. Bounding the
+  // window keeps the unread results within the tty input buffer, so the device
+  // is never blocked on a host which is itself blocked writing.
+  const int64_t result_bytes = ResultByteCount(function_type);
+  std::vector<std::vector<uint8_t>> encoded;
+  encoded.reserve(argument_sets.size());
+  int64_t max_argument_bytes = 0;
+  for (const std::vector<Value>& arguments : argument_sets) {
+    XLS_ASSIGN_OR_RETURN(std::vector<uint8_t> bytes,
+                         EncodeArguments(arguments));
+    max_argument_bytes = std::max<int64_t>(max_argument_bytes, bytes.size());
+    encoded.push_back(std::move(bytes));
+  }
+  const int64_t window = std::max<int64_t>(
+      1, kMaxBatchBytesInFlight / std::max(max_argument_bytes, result_bytes));
+
+  auto write_window = [&](int64_t begin) -> absl::Status {
+    std::vector<uint8_t> frame;
+    for (int64_t i = begin;
+         i < std::min<int64_t>(begin + window, encoded.size()); ++i) {
+      frame.insert(frame.end(), encoded[i].begin(), encoded[i].end());
+    }
+    return WriteAll(frame);
+  };
+
+  std::vector<Value> results;
+  results.reserve(argument_sets.size());
+  std::vector<uint8_t> result_data;
+  if (!encoded.empty()) {
+    XLS_RETURN_IF_ERROR(write_window(0));
+  }
+  for (int64_t begin = 0; begin < encoded.size(); begin += window) {
+    if (begin + window < encoded.size()) {
+      XLS_RETURN_IF_ERROR(write_window(begin + window));
+    }
+    const int64_t count =
+        std::min<int64_t>(window, encoded.size() - begin);
+    result_data.resize(count * result_bytes);
+    XLS_RETURN_IF_ERROR(ReadAll(absl::MakeSpan(result_data)));
+    for (int64_t i = 0; i < count; ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          Value result,
+          DecodeResult(function_type,
+                       absl::MakeConstSpan(result_data)
+                           .subspan(i * result_bytes, result_bytes)));
+      results.push_back(std::move(result));
+    }
+  }
+  return results;
 }
 
 }  // namespace xls
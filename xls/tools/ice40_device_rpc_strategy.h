@@ -15,9 +15,12 @@
 #ifndef XLS_TOOLS_ICE40_DEVICE_RPC_STRATEGY_H_
 #define XLS_TOOLS_ICE40_DEVICE_RPC_STRATEGY_H_
 
+#include <cstdint>
 #include <optional>
+#include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/tools/device_rpc_strategy.h"
 
 namespace xls {
@@ -31,7 +34,22 @@ class Ice40DeviceRpcStrategy : public DeviceRpcStrategy {
   absl::StatusOr<Value> CallUnnamed(const FunctionType& function_type,
                                     absl::Span<const Value> arguments) override;
 
+  // Pipelines the calls over the serial link, see the implementation.
+  absl::StatusOr<std::vector<Value>> CallUnnamedBatch(
+      const FunctionType& function_type,
+      absl::Span<const std::vector<Value>> argument_sets) override;
+
  private:
+  // Upper bound on the bytes of arguments, and of results, of the calls in one
+  // window of a batch.
+  static constexpr int64_t kMaxBatchBytesInFlight = 1024;
+
+  // Writes all of "data" to the device, blocking as needed.
+  absl::Status WriteAll(absl::Span<const uint8_t> data);
+
+  // Reads exactly data.size() bytes from the device, blocking as needed.
+  absl::Status ReadAll(absl::Span<uint8_t> data);
+
   std::optional<int> tty_fd_;
 };
 
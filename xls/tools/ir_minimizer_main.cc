@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <iostream>
 #include <iterator>
@@ -31,6 +33,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/types/span.h"
 #include "xls/common/exit_status.h"
@@ -42,6 +45,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/subprocess.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
@@ -159,6 +163,11 @@ ABSL_FLAG(int64_t, simplifications_between_tests, 1,
           "Number of simplifications to do in-between tests. Increasing this "
           "value may speed minimization for large designs, especially when "
           "--test_executable is long-running.");
+ABSL_FLAG(int64_t, parallelism, 1,
+          "Number of simplification candidates to generate from the current "
+          "IR in each round and test concurrently. Of the candidates which "
+          "still fail, the one with the fewest nodes is kept. Values greater "
+          "than one speed up minimization when the test is long-running.");
 ABSL_FLAG(
     bool, verify_ir, true,
     "Verify IR whenever parsing. In most cases, this is a good check that the "
@@ -787,6 +796,176 @@ absl::Status CleanUp(FunctionBase* f, bool can_remove_params) {
   return absl::OkStatus();
 }
 
+// A simplification of the known failing IR, to be tested.
+struct Candidate {
+  std::string ir_text;
+  // Description of the transforms applied.
+  std::string which_transform;
+  int64_t node_count;
+};
+
+// Applies up to `simplification_count` random simplifications to the top of
+// the package in `ir_text` and returns the result, or std::nullopt if nothing
+// was changed. Sets `cannot_change` if the IR cannot be simplified at all.
+absl::StatusOr<std::optional<Candidate>> GenerateCandidate(
+    std::string_view ir_text, const std::optional<std::vector<Value>>& inputs,
+    int64_t simplification_count, bool can_remove_params, std::mt19937* rng,
+    bool* cannot_change) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package, ParsePackage(ir_text));
+  FunctionBase* f = package->GetTop().value();
+  std::vector<std::string> transforms;
+  for (int64_t i = 0; i < simplification_count; ++i) {
+    std::string which_transform;
+    XLS_ASSIGN_OR_RETURN(SimplificationResult simplification,
+                         Simplify(f, inputs, rng, &which_transform));
+    if (simplification == SimplificationResult::kCannotChange) {
+      *cannot_change = transforms.empty();
+      break;
+    }
+    if (simplification == SimplificationResult::kDidNotChange) {
+      continue;
+    }
+    XLS_RETURN_IF_ERROR(CleanUp(f, can_remove_params));
+    transforms.push_back(which_transform);
+  }
+  if (transforms.empty()) {
+    return std::nullopt;
+  }
+  return Candidate{.ir_text = package->DumpIr(),
+                   .which_transform = absl::StrJoin(transforms, "; "),
+                   .node_count = f->node_count()};
+}
+
+// Returns whether each of the candidates still fails, running up to
+// `parallelism` tests concurrently. Results are memoized in `test_cache`.
+absl::StatusOr<std::vector<bool>> StillFailsInParallel(
+    absl::Span<const Candidate> candidates,
+    const std::optional<std::vector<Value>>& inputs, int64_t parallelism,
+    absl::flat_hash_map<std::string, bool>* test_cache) {
+  std::vector<absl::StatusOr<bool>> results(candidates.size(), false);
+  std::vector<int64_t> untested;
+  for (int64_t i = 0; i < candidates.size(); ++i) {
+    auto it = test_cache->find(candidates[i].ir_text);
+    if (it == test_cache->end()) {
+      untested.push_back(i);
+    } else {
+      results[i] = it->second;
+    }
+  }
+
+  std::atomic<int64_t> next_untested = 0;
+  auto run_tests = [&]() {
+    for (int64_t j = next_untested++; j < untested.size();
+         j = next_untested++) {
+      int64_t i = untested[j];
+      results[i] = StillFailsHelper(candidates[i].ir_text, inputs);
+    }
+  };
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    int64_t thread_count =
+        std::min(parallelism, static_cast<int64_t>(untested.size()));
+    for (int64_t t = 0; t < thread_count; ++t) {
+      threads.push_back(std::make_unique<Thread>(run_tests));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+
+  std::vector<bool> still_fails;
+  for (int64_t i = 0; i < candidates.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(bool fails, results[i]);
+    (*test_cache)[candidates[i].ir_text] = fails;
+    still_fails.push_back(fails);
+  }
+  return still_fails;
+}
+
+// Minimizes the known failing IR by repeatedly generating a batch of
+// `parallelism` distinct candidates from it, testing them concurrently and
+// keeping the smallest candidate which still fails. Returns the minimized IR.
+absl::StatusOr<std::string> MinimizeInParallel(
+    std::string knownf_ir_text, const std::optional<std::vector<Value>>& inputs,
+    const int64_t failed_attempt_limit, const int64_t total_attempt_limit,
+    const int64_t simplifications_between_tests, const int64_t parallelism,
+    absl::flat_hash_map<std::string, bool>* test_cache) {
+  const bool can_remove_params = absl::GetFlag(FLAGS_can_remove_params);
+  std::mt19937 rng;  // Default constructor uses deterministic seed.
+
+  int64_t failed_simplification_attempts = 0;
+  int64_t total_attempts = 0;
+  while (true) {
+    if (failed_simplification_attempts >= failed_attempt_limit) {
+      XLS_LOG(INFO) << "Hit failed-simplification-attempt-limit: "
+                    << failed_simplification_attempts;
+      break;
+    }
+    if (total_attempts >= total_attempt_limit) {
+      XLS_LOG(INFO) << "Hit total-attempt-limit: " << total_attempts;
+      break;
+    }
+
+    // Candidates are generated serially so that minimization is deterministic
+    // for a given parallelism; only the tests run concurrently.
+    std::vector<Candidate> candidates;
+    absl::flat_hash_set<std::string> candidate_texts;
+    bool cannot_change = false;
+    for (int64_t i = 0; i < parallelism; ++i) {
+      total_attempts++;
+      XLS_ASSIGN_OR_RETURN(
+          std::optional<Candidate> candidate,
+          GenerateCandidate(knownf_ir_text, inputs,
+                            simplifications_between_tests, can_remove_params,
+                            &rng, &cannot_change));
+      if (cannot_change) {
+        break;
+      }
+      if (!candidate.has_value() ||
+          !candidate_texts.insert(candidate->ir_text).second) {
+        failed_simplification_attempts++;
+        continue;
+      }
+      candidates.push_back(*std::move(candidate));
+    }
+    if (cannot_change) {
+      XLS_LOG(INFO) << "Cannot simplify any further, done!";
+      break;
+    }
+    if (candidates.empty()) {
+      continue;
+    }
+
+    XLS_LOG(INFO) << "Trying " << candidates.size() << " candidates";
+    XLS_ASSIGN_OR_RETURN(
+        std::vector<bool> still_fails,
+        StillFailsInParallel(candidates, inputs, parallelism, test_cache));
+    std::optional<int64_t> best;
+    for (int64_t i = 0; i < candidates.size(); ++i) {
+      if (still_fails[i] &&
+          (!best.has_value() ||
+           candidates[i].node_count < candidates[*best].node_count)) {
+        best = i;
+      }
+    }
+    if (!best.has_value()) {
+      failed_simplification_attempts += candidates.size();
+      XLS_LOG(INFO) << "No candidate still fails.";
+      XLS_LOG(INFO) << "Failed simplification attempts now: "
+                    << failed_simplification_attempts;
+      continue;
+    }
+
+    Candidate& winner = candidates[*best];
+    knownf_ir_text = std::move(winner.ir_text);
+    std::cerr << "---\ntransform: " << winner.which_transform << "\n"
+              << (winner.node_count > 50 ? "" : knownf_ir_text) << "("
+              << winner.node_count << " nodes)\n";
+    failed_simplification_attempts = 0;
+  }
+  return knownf_ir_text;
+}
+
 absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
                       const int64_t total_attempt_limit,
                       const int64_t simplifications_between_tests) {
@@ -832,6 +1011,21 @@ absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
     XLS_LOG(INFO) << "=== Done cleaning up initial garbage";
   }
 
+  const int64_t parallelism = absl::GetFlag(FLAGS_parallelism);
+  if (parallelism > 1) {
+    XLS_ASSIGN_OR_RETURN(
+        knownf_ir_text,
+        MinimizeInParallel(std::move(knownf_ir_text), inputs,
+                           failed_attempt_limit, total_attempt_limit,
+                           simplifications_between_tests, parallelism,
+                           &test_cache));
+    XLS_RETURN_IF_ERROR(VerifyStillFails(knownf_ir_text, inputs,
+                                         "Minimized function does not fail!",
+                                         /*test_cache=*/nullptr));
+    std::cout << knownf_ir_text;
+    return absl::OkStatus();
+  }
+
   // If so, we start simplifying via this seeded RNG.
   std::mt19937 rng;  // Default constructor uses deterministic seed.
 
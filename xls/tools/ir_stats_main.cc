@@ -12,60 +12,226 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-// Prints summary information about an IR file to the terminal.
+// Prints summary information about IR files to the terminal.
 // Output will be added as needs warrant, so feel free to make additions!
+//
+// Any number of IR files may be given (as arguments or listed in
+// --ir_files_list); they are processed by --threads threads and reported in
+// the given order. With --design_stats_out a DesignStatsList
+// (xls/tools/design_stats.proto) with the critical path of the top of each
+// package under --delay_model is written as well, one entry at a time.
 
+#include <cstdint>
+#include <fstream>
 #include <iostream>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+#include "google/protobuf/text_format.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
+#include "xls/delay_model/analyze_critical_path.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/delay_model/delay_estimators.h"
+#include "xls/ir/fingerprint.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/tools/design_stats.pb.h"
 
 ABSL_FLAG(
     std::string, top, "",
     "The name of the top entity. Currently, only functions are supported. "
     "If set, restrict dumping to the given function. "
     "The name should not be mangled with the Package name.");
+ABSL_FLAG(std::string, ir_files_list, "",
+          "File listing IR files to process, one per line, in addition to "
+          "those given as arguments.");
+ABSL_FLAG(int64_t, threads, 1,
+          "Number of IR files processed concurrently. Zero or less uses "
+          "--xls_threads.");
+ABSL_FLAG(std::string, design_stats_out, "",
+          "If set, writes a DesignStatsList text proto with the statistics of "
+          "each IR file to this path.");
+ABSL_FLAG(std::string, delay_model, "unit",
+          "Delay model used for the critical paths in --design_stats_out.");
+ABSL_FLAG(bool, fingerprint, false,
+          "If true, prints the structural fingerprint (see "
+          "xls/ir/fingerprint.h) of each package and function.");
 
 namespace xls {
+namespace {
+
+struct FileStats {
+  std::string summary;
+  DesignStats design_stats;
+};
 
-static absl::Status RealMain(std::string_view ir_path,
-                             std::optional<std::string> restrict_fn) {
+absl::StatusOr<FileStats> GetFileStats(
+    std::string_view ir_path, const std::optional<std::string>& restrict_fn,
+    const DelayEstimator* delay_estimator) {
   XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(ir_path));
   XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(contents));
 
-  std::cout << "Package \"" << package->name() << "\"" << std::endl;
+  FileStats stats;
+  absl::StrAppend(&stats.summary, "Package \"", package->name(), "\"\n");
+  std::optional<PackageFingerprinter> fingerprinter;
+  if (absl::GetFlag(FLAGS_fingerprint)) {
+    fingerprinter.emplace(package.get());
+    absl::StrAppend(&stats.summary, "  Fingerprint: ",
+                    FingerprintToString(fingerprinter->Fingerprint()), "\n");
+  }
   for (const auto& f : package->functions()) {
     if (restrict_fn && restrict_fn.value() != f->name()) {
       continue;
     }
-    std::cout << "  Function: \"" << f->name() << "\"" << std::endl;
-    std::cout << "    Signature: " << f->GetType()->ToString() << std::endl;
-    std::cout << "    Nodes: " << f->node_count() << std::endl;
-    std::cout << std::endl;
+    absl::StrAppend(&stats.summary, "  Function: \"", f->name(), "\"\n");
+    absl::StrAppend(&stats.summary,
+                    "    Signature: ", f->GetType()->ToString(), "\n");
+    absl::StrAppend(&stats.summary, "    Nodes: ", f->node_count(), "\n");
+    if (fingerprinter.has_value()) {
+      absl::StrAppend(&stats.summary, "    Fingerprint: ",
+                      FingerprintToString(
+                          fingerprinter->FunctionBaseFingerprint(f.get())),
+                      "\n");
+    }
+    absl::StrAppend(&stats.summary, "\n");
+  }
+
+  if (delay_estimator == nullptr) {
+    return stats;
+  }
+  stats.design_stats.set_design(std::string(ir_path));
+  std::optional<FunctionBase*> top = package->GetTop();
+  if (restrict_fn) {
+    XLS_ASSIGN_OR_RETURN(top, package->GetFunction(*restrict_fn));
+  }
+  if (!top.has_value()) {
+    return stats;
+  }
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<CriticalPathEntry> critical_path,
+      AnalyzeCriticalPath(*top, /*clock_period_ps=*/std::nullopt,
+                          *delay_estimator));
+  if (critical_path.empty()) {
+    return stats;
+  }
+  // The end of the path is at the front.
+  PpaInfo* overall = stats.design_stats.mutable_overall();
+  overall->set_levels(critical_path.size());
+  overall->set_crit_path_delay_ps(critical_path.front().path_delay_ps);
+  overall->set_crit_path_start(critical_path.back().node->GetName());
+  overall->set_crit_path_end(critical_path.front().node->GetName());
+  return stats;
+}
+
+absl::Status RealMain(const std::vector<std::string>& ir_paths,
+                      const std::optional<std::string>& restrict_fn) {
+  // Delay estimators are created once and shared by all threads, so their
+  // caches carry over from one package to the next.
+  const DelayEstimator* delay_estimator = nullptr;
+  std::ofstream design_stats_out;
+  if (!absl::GetFlag(FLAGS_design_stats_out).empty()) {
+    XLS_ASSIGN_OR_RETURN(delay_estimator,
+                         GetDelayEstimator(absl::GetFlag(FLAGS_delay_model)));
+    design_stats_out.open(absl::GetFlag(FLAGS_design_stats_out));
+    XLS_RET_CHECK(design_stats_out.is_open())
+        << "Unable to open " << absl::GetFlag(FLAGS_design_stats_out);
+  }
+
+  // Results are written in the order of the files as soon as all those
+  // before them are done, so only those finished out of order are held.
+  absl::Mutex mutex;
+  std::vector<std::optional<FileStats>> pending(ir_paths.size());
+  int64_t next_to_write = 0;
+  auto write_ready = [&]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+    while (next_to_write < pending.size() &&
+           pending[next_to_write].has_value()) {
+      FileStats& stats = *pending[next_to_write];
+      std::cout << stats.summary << std::flush;
+      if (delay_estimator != nullptr) {
+        DesignStatsList entry;
+        *entry.add_designs() = std::move(stats.design_stats);
+        std::string text;
+        google::protobuf::TextFormat::PrintToString(entry, &text);
+        design_stats_out << text;
+      }
+      pending[next_to_write].reset();
+      ++next_to_write;
+    }
+  };
+
+  auto process_file = [&](int64_t i) -> absl::Status {
+    absl::StatusOr<FileStats> stats =
+        GetFileStats(ir_paths[i], restrict_fn, delay_estimator);
+    if (!stats.ok()) {
+      return absl::Status(
+          stats.status().code(),
+          absl::StrCat(ir_paths[i], ": ", stats.status().message()));
+    }
+    absl::MutexLock lock(&mutex);
+    pending[i] = *std::move(stats);
+    write_ready();
+    return absl::OkStatus();
+  };
+  if (absl::GetFlag(FLAGS_threads) == 1) {
+    for (int64_t i = 0; i < ir_paths.size(); ++i) {
+      XLS_RETURN_IF_ERROR(process_file(i));
+    }
+  } else {
+    // The calling thread works alongside the pool.
+    ThreadPool pool(absl::GetFlag(FLAGS_threads) > 1
+                        ? absl::GetFlag(FLAGS_threads) - 1
+                        : 0);
+    XLS_RETURN_IF_ERROR(
+        pool.ParallelForWithStatus(0, ir_paths.size(), process_file));
+  }
+
+  if (design_stats_out.is_open()) {
+    design_stats_out.close();
+    XLS_RET_CHECK(design_stats_out.good())
+        << "Failed writing " << absl::GetFlag(FLAGS_design_stats_out);
   }
   return absl::OkStatus();
 }
 
+}  // namespace
 }  // namespace xls
 
 int main(int argc, char** argv) {
   std::vector<std::string_view> positional_args =
       xls::InitXls(argv[0], argc, argv);
-  XLS_QCHECK(positional_args.size() == 1);
+
+  std::vector<std::string> ir_paths(positional_args.begin(),
+                                    positional_args.end());
+  if (!absl::GetFlag(FLAGS_ir_files_list).empty()) {
+    absl::StatusOr<std::string> list =
+        xls::GetFileContents(absl::GetFlag(FLAGS_ir_files_list));
+    XLS_QCHECK_OK(list.status());
+    for (std::string_view path :
+         absl::StrSplit(*list, '\n', absl::SkipWhitespace())) {
+      ir_paths.push_back(std::string(path));
+    }
+  }
+  XLS_QCHECK(!ir_paths.empty())
+      << "Expected IR files as arguments or in --ir_files_list.";
 
   std::optional<std::string> restrict_fn;
   if (!absl::GetFlag(FLAGS_top).empty()) {
     restrict_fn = absl::GetFlag(FLAGS_top);
   }
-  return xls::ExitStatus(xls::RealMain(positional_args[0], restrict_fn));
+  return xls::ExitStatus(xls::RealMain(ir_paths, restrict_fn));
 }
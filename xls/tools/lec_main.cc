@@ -15,8 +15,10 @@
 // Tool to prove or disprove logical equivalence of XLS IR and a netlist.
 
 #include <csignal>
+#include <filesystem>  // NOLINT
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -54,6 +56,11 @@ ABSL_FLAG(std::string, cell_proto_path, "",
           "This is a whole bunch faster than specifying an unprocessed "
           "cell library and should be favored.\n"
           "Either this or --cell_lib_path should be set.");
+ABSL_FLAG(std::string, cell_library_cache_dir, "",
+          "If non-empty, a directory in which the cell library extracted from "
+          "--cell_lib_path is cached, keyed by a hash of its contents. Later "
+          "runs with an unchanged library load it from the cache instead of "
+          "parsing the library.");
 ABSL_FLAG(std::string, constraints_file, "",
           "Optional path to a DSLX file containing a input parameter "
           "constraint function. This function must have the same signature as "
@@ -101,7 +108,8 @@ constexpr const char kIrConverterPath[] =
 // Loads a cell library, either from a raw Liberty file or a preprocessed
 // CellLibraryProto proto.
 absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
-    std::string_view cell_lib_path, std::string_view cell_proto_path) {
+    std::string_view cell_lib_path, std::string_view cell_proto_path,
+    std::string_view cell_library_cache_dir) {
   if (!cell_proto_path.empty()) {
     XLS_ASSIGN_OR_RETURN(std::string cell_proto_text,
                          GetFileContents(cell_proto_path));
@@ -109,11 +117,13 @@ absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
     XLS_RET_CHECK(cell_proto.ParseFromString(cell_proto_text));
     return netlist::CellLibrary::FromProto(cell_proto);
   }
-  XLS_ASSIGN_OR_RETURN(std::string lib_text, GetFileContents(cell_lib_path));
-  XLS_ASSIGN_OR_RETURN(auto stream,
-                       netlist::cell_lib::CharStream::FromText(lib_text));
-  XLS_ASSIGN_OR_RETURN(netlist::CellLibraryProto proto,
-                       netlist::function::ExtractFunctions(&stream));
+  std::optional<std::filesystem::path> cache_dir;
+  if (!cell_library_cache_dir.empty()) {
+    cache_dir = cell_library_cache_dir;
+  }
+  XLS_ASSIGN_OR_RETURN(
+      netlist::CellLibraryProto proto,
+      netlist::function::ExtractFunctionsFromPath(cell_lib_path, cache_dir));
   return netlist::CellLibrary::FromProto(proto);
 }
 
@@ -227,9 +237,10 @@ absl::Status AutoStage(const solvers::z3::LecParams& lec_params,
 static absl::Status RealMain(
     std::string_view ir_path, std::string_view entry_function_name,
     std::string_view netlist_module_name, std::string_view cell_lib_path,
-    std::string_view cell_proto_path, std::string_view netlist_path,
-    std::string_view constraints_file, std::string_view schedule_path,
-    int stage, bool auto_stage, int timeout_sec) {
+    std::string_view cell_proto_path, std::string_view cell_library_cache_dir,
+    std::string_view netlist_path, std::string_view constraints_file,
+    std::string_view schedule_path, int stage, bool auto_stage,
+    int timeout_sec) {
   solvers::z3::LecParams lec_params;
   XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
   XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
@@ -243,7 +254,8 @@ static absl::Status RealMain(
         lec_params.ir_package->GetFunction(entry_function_name));
   }
   XLS_ASSIGN_OR_RETURN(auto cell_library,
-                       GetCellLibrary(cell_lib_path, cell_proto_path));
+                       GetCellLibrary(cell_lib_path, cell_proto_path,
+                                      cell_library_cache_dir));
   XLS_ASSIGN_OR_RETURN(auto netlist, GetNetlist(netlist_path, &cell_library));
   lec_params.netlist = netlist.get();
   lec_params.netlist_module_name = netlist_module_name;
@@ -337,6 +349,7 @@ int main(int argc, char* argv[]) {
   return xls::ExitStatus(xls::RealMain(
       ir_path, absl::GetFlag(FLAGS_entry_function_name),
       absl::GetFlag(FLAGS_netlist_module_name), cell_lib_path, cell_proto_path,
-      netlist_path, absl::GetFlag(FLAGS_constraints_file), schedule_path, stage,
-      auto_stage, absl::GetFlag(FLAGS_timeout_sec)));
+      absl::GetFlag(FLAGS_cell_library_cache_dir), netlist_path,
+      absl::GetFlag(FLAGS_constraints_file), schedule_path, stage, auto_stage,
+      absl::GetFlag(FLAGS_timeout_sec)));
 }
@@ -15,7 +15,10 @@
 // Driver for NetlistInterpreter: loads a netlist from disk, feeds Value input
 // (taken from the command line) into it, and prints the result.
 
+#include <cstdint>
+#include <filesystem>  // NOLINT
 #include <iostream>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -26,6 +29,7 @@
 #include "xls/codegen/flattening.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/file/memory_mapped_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -43,6 +47,11 @@ ABSL_FLAG(std::string, cell_library, "",
           "Cell library to use for interpretation.");
 ABSL_FLAG(std::string, cell_library_proto, "",
           "Preprocessed cell library proto to use for interpretation.");
+ABSL_FLAG(std::string, cell_library_cache_dir, "",
+          "If non-empty, a directory in which the cell library extracted from "
+          "--cell_library is cached, keyed by a hash of its contents. Later "
+          "runs with an unchanged library load it from the cache instead of "
+          "parsing the library.");
 // TODO(rspringer): Eliminate the need for this flag.
 // This one is a hidden temporary flag until we can properly handle cells
 // with state_function attributes (e.g., some latches).
@@ -58,12 +67,21 @@ ABSL_FLAG(std::string, output_type, "",
           "output will be printed as flat uninterpreted bits.");
 ABSL_FLAG(std::string, module_name, "", "Module in the netlist to interpret.");
 ABSL_FLAG(std::string, netlist, "", "Path to the netlist to interpret.");
+ABSL_FLAG(bool, levelized, false,
+          "If true, evaluate the cells in levelized order rather than "
+          "dispatching each cell as its inputs become ready. Faster for large "
+          "netlists.");
+ABSL_FLAG(int64_t, threads, 0,
+          "Number of worker threads used by the interpreter. In levelized mode "
+          "only levels wider than a few hundred cells are evaluated "
+          "concurrently.");
 
 namespace xls {
 
 static absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
     const std::string& cell_library_path,
-    const std::string& cell_library_proto_path) {
+    const std::string& cell_library_proto_path,
+    const std::string& cell_library_cache_dir) {
   if (!cell_library_proto_path.empty()) {
     XLS_ASSIGN_OR_RETURN(std::string proto_text,
                          GetFileContents(cell_library_proto_path));
@@ -71,29 +89,33 @@ static absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
     XLS_RET_CHECK(lib_proto.ParseFromString(proto_text));
     return netlist::CellLibrary::FromProto(lib_proto);
   }
-  XLS_ASSIGN_OR_RETURN(std::string cell_library_text,
-                       GetFileContents(cell_library_path));
-  XLS_ASSIGN_OR_RETURN(
-      auto char_stream,
-      netlist::cell_lib::CharStream::FromText(cell_library_text));
+  std::optional<std::filesystem::path> cache_dir;
+  if (!cell_library_cache_dir.empty()) {
+    cache_dir = cell_library_cache_dir;
+  }
   XLS_ASSIGN_OR_RETURN(netlist::CellLibraryProto lib_proto,
-                       netlist::function::ExtractFunctions(&char_stream));
+                       netlist::function::ExtractFunctionsFromPath(
+                           cell_library_path, cache_dir));
   return netlist::CellLibrary::FromProto(lib_proto);
 }
 
 static absl::Status RealMain(const std::string& netlist_path,
                              const std::string& cell_library_path,
                              const std::string& cell_library_proto_path,
+                             const std::string& cell_library_cache_dir,
                              const std::string& module_name,
                              absl::Span<const std::string> inputs,
                              const std::string& output_type_string,
-                             absl::Span<const std::string> dump_cells) {
+                             absl::Span<const std::string> dump_cells,
+                             bool levelized, int64_t threads) {
   XLS_ASSIGN_OR_RETURN(
       netlist::CellLibrary cell_library,
-      GetCellLibrary(cell_library_path, cell_library_proto_path));
+      GetCellLibrary(cell_library_path, cell_library_proto_path,
+                     cell_library_cache_dir));
 
-  XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
-  netlist::rtl::Scanner scanner(netlist_text);
+  XLS_ASSIGN_OR_RETURN(MemoryMappedFile netlist_file,
+                       MemoryMappedFile::Open(netlist_path));
+  netlist::rtl::Scanner scanner(netlist_file.contents());
   XLS_ASSIGN_OR_RETURN(auto netlist, netlist::rtl::Parser::ParseNetlist(
                                          &cell_library, &scanner));
   XLS_ASSIGN_OR_RETURN(const auto* module, netlist->GetModule(module_name));
@@ -128,9 +150,13 @@ static absl::Status RealMain(const std::string& netlist_path,
     input_nets[in] = input_bits.Get(module->GetInputPortOffset(in->name()));
   }
 
-  netlist::Interpreter interpreter(netlist.get());
-  XLS_ASSIGN_OR_RETURN(auto output_nets, interpreter.InterpretModule(
-                                             module, input_nets, dump_cells));
+  netlist::Interpreter interpreter(netlist.get(), /*zero=*/false,
+                                   /*one=*/true, threads);
+  XLS_ASSIGN_OR_RETURN(
+      auto output_nets,
+      levelized
+          ? interpreter.InterpretModuleLevelized(module, input_nets, dump_cells)
+          : interpreter.InterpretModule(module, input_nets, dump_cells));
 
   BitsRope rope(output_nets.size());
   for (const netlist::rtl::NetRef ref : module->outputs()) {
@@ -180,7 +206,9 @@ int main(int argc, char* argv[]) {
 
   std::string output_type = absl::GetFlag(FLAGS_output_type);
 
-  return xls::ExitStatus(xls::RealMain(netlist_path, cell_library_path,
-                                       cell_library_proto_path, module_name,
-                                       inputs, output_type, dump_cells));
+  return xls::ExitStatus(xls::RealMain(
+      netlist_path, cell_library_path, cell_library_proto_path,
+      absl::GetFlag(FLAGS_cell_library_cache_dir), module_name, inputs,
+      output_type, dump_cells, absl::GetFlag(FLAGS_levelized),
+      absl::GetFlag(FLAGS_threads)));
 }
@@ -14,6 +14,7 @@
 
 #include "xls/tools/opt.h"
 
+#include <iostream>
 #include <memory>
 #include <optional>
 #include <string>
@@ -21,16 +22,174 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/time/time.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dslx/ir_convert/ir_converter.h"
 #include "xls/dslx/parse_and_typecheck.h"
+#include "xls/ir/binary_ir.h"
+#include "xls/ir/call_graph.h"
+#include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
 #include "xls/ir/verifier.h"
+#include "xls/passes/compile_time_budget.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_pipeline.h"
+#include "xls/passes/pass_profile.h"
+#include "xls/passes/pass_profile.pb.h"
+#include "xls/tools/opt_cache.h"
 
 namespace xls::tools {
+namespace {
+
+absl::Status WritePassProfile(const PassResults& results,
+                              const CompileTimeBudget* budget,
+                              const OptOptions& options) {
+  PassProfileProto profile = CreatePassProfile(results, budget);
+  if (options.pass_profile_path == "-") {
+    std::cerr << PassProfileToString(profile);
+  } else if (!options.pass_profile_path.empty()) {
+    XLS_RETURN_IF_ERROR(SetFileContents(options.pass_profile_path,
+                                        PassProfileToString(profile)));
+  }
+  if (!options.pass_profile_json_path.empty()) {
+    XLS_ASSIGN_OR_RETURN(std::string json, PassProfileToJson(profile));
+    XLS_RETURN_IF_ERROR(SetFileContents(options.pass_profile_json_path, json));
+  }
+  return absl::OkStatus();
+}
+
+void AppendPassNames(const OptimizationPass& pass, std::string* out) {
+  absl::StrAppend(out, pass.short_name());
+  if (!pass.IsCompound()) {
+    return;
+  }
+  absl::StrAppend(out, "(");
+  for (const OptimizationPass* nested :
+       static_cast<const OptimizationCompoundPass&>(pass).passes()) {
+    AppendPassNames(*nested, out);
+    absl::StrAppend(out, ",");
+  }
+  absl::StrAppend(out, ")");
+}
+
+// Returns a string identifying the build of opt, the pipeline and the options
+// which affect the optimized IR, for use in optimization cache keys.
+absl::StatusOr<std::string> OptionsFingerprint(
+    const OptimizationCompoundPass& pipeline, const OptOptions& options) {
+  XLS_ASSIGN_OR_RETURN(std::string build, ExecutableFingerprint());
+  std::string fingerprint = absl::StrCat(
+      "build=", build, ";opt_level=", options.opt_level, ";top=", options.top,
+      ";inline_procs=", options.inline_procs ? 1 : 0,
+      ";convert_array_index_to_select=",
+      options.convert_array_index_to_select.value_or(-1), ";run_only_passes=",
+      options.run_only_passes.has_value()
+          ? absl::StrJoin(*options.run_only_passes, ",")
+          : "<all>",
+      ";skip_passes=", absl::StrJoin(options.skip_passes, ","), ";pipeline=");
+  AppendPassNames(pipeline, &fingerprint);
+  return fingerprint;
+}
+
+// Returns `f` optimized as the top of a package containing only it and the
+// functions it calls, from the cache if possible. Results computed here are
+// added to the cache unless they were cut short by `compile_time_budget`, which
+// each run spends on its own.
+absl::StatusOr<std::unique_ptr<Package>> OptimizeFunctionStandalone(
+    Function* f, const OptimizationCompoundPass& pipeline,
+    const OptimizationPassOptions& pass_options,
+    absl::Duration compile_time_budget, const OptCache& cache,
+    std::string_view fingerprint) {
+  std::string key = FunctionCacheKey(f, fingerprint);
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> cached, cache.Lookup(key));
+  if (cached.has_value()) {
+    absl::StatusOr<std::unique_ptr<Package>> package =
+        Parser::ParsePackage(*cached);
+    if (package.ok()) {
+      XLS_VLOG(1) << "Reusing cached optimized function " << f->name();
+      return package;
+    }
+    XLS_LOG(WARNING) << "Ignoring corrupt optimization cache entry " << key
+                     << ": " << package.status();
+  }
+
+  XLS_VLOG(1) << "Optimizing function " << f->name() << " for the cache";
+  auto package = std::make_unique<Package>(f->package()->name());
+  XLS_ASSIGN_OR_RETURN(
+      Function * clone,
+      CloneFunctionAndItsDependencies(f, f->name(), package.get()));
+  XLS_RETURN_IF_ERROR(package->SetTop(clone));
+  OptimizationPassOptions standalone_options = pass_options;
+  standalone_options.ir_dump_path = "";
+  if (compile_time_budget != absl::InfiniteDuration()) {
+    standalone_options.compile_time_budget =
+        std::make_shared<CompileTimeBudget>(compile_time_budget);
+  }
+  PassResults results;
+  XLS_RETURN_IF_ERROR(
+      pipeline.Run(package.get(), standalone_options, &results).status());
+  // As for whole packages, results cut short by the budget are not cached.
+  if (standalone_options.compile_time_budget != nullptr &&
+      !standalone_options.compile_time_budget->skips().empty()) {
+    XLS_LOG(WARNING) << "Not caching optimized function " << f->name() << ": "
+                     << standalone_options.compile_time_budget->ToString();
+    return package;
+  }
+  XLS_RETURN_IF_ERROR(cache.Insert(key, package->DumpIr()));
+  return package;
+}
+
+// Returns a copy of the functions reachable from `top` in which every function
+// other than `top` is replaced by its standalone-optimized version (see
+// OptimizeFunctionStandalone). Functions which are unchanged since a previous
+// run are therefore not reoptimized, and the full pipeline run on the result
+// mostly has to deal with `top` and the functions which changed.
+//
+// Optimized functions which still call other functions (e.g. the bodies of
+// loops which were not unrolled) are not substituted.
+absl::StatusOr<std::unique_ptr<Package>> SubstituteOptimizedCallees(
+    Function* top, const OptimizationCompoundPass& pipeline,
+    const OptimizationPassOptions& pass_options,
+    absl::Duration compile_time_budget, const OptCache& cache,
+    std::string_view fingerprint) {
+  auto result = std::make_unique<Package>(top->package()->name());
+  absl::flat_hash_map<const Function*, Function*> call_remapping;
+  for (FunctionBase* dependent : GetDependentFunctions(top)) {
+    Function* f = dependent->AsFunctionOrDie();
+    Function* clone;
+    if (f == top) {
+      XLS_ASSIGN_OR_RETURN(clone,
+                           f->Clone(f->name(), result.get(), call_remapping));
+      XLS_RETURN_IF_ERROR(result->SetTop(clone));
+    } else {
+      XLS_ASSIGN_OR_RETURN(
+          std::unique_ptr<Package> optimized,
+          OptimizeFunctionStandalone(f, pipeline, pass_options,
+                                     compile_time_budget, cache, fingerprint));
+      std::optional<FunctionBase*> optimized_top = optimized->GetTop();
+      if (optimized_top.has_value() && (*optimized_top)->IsFunction() &&
+          GetDependentFunctions(*optimized_top).size() == 1) {
+        XLS_ASSIGN_OR_RETURN(clone, (*optimized_top)
+                                        ->AsFunctionOrDie()
+                                        ->Clone(f->name(), result.get()));
+      } else {
+        XLS_ASSIGN_OR_RETURN(clone,
+                             f->Clone(f->name(), result.get(), call_remapping));
+      }
+    }
+    call_remapping[f] = clone;
+  }
+  return result;
+}
+
+}  // namespace
 
 absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
                                              const OptOptions& options) {
@@ -42,7 +201,7 @@ absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
   }
 
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
-                       Parser::ParsePackage(ir, options.ir_path));
+                       ParsePackageTextOrBinary(ir, options.ir_path));
   if (!options.top.empty()) {
     XLS_RETURN_IF_ERROR(package->SetTopByName(options.top));
   }
@@ -63,9 +222,83 @@ absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
   pass_options.convert_array_index_to_select =
       options.convert_array_index_to_select;
   pass_options.ram_rewrites = options.ram_rewrites;
+  pass_options.function_parallelism = options.function_parallelism;
+  pass_options.function_pass_history = std::make_shared<FunctionPassHistory>();
   PassResults results;
+  results.collect_profile = !options.pass_profile_path.empty() ||
+                            !options.pass_profile_json_path.empty();
+
+  std::optional<OptCache> cache;
+  std::string fingerprint;
+  std::string package_key;
+  if (!options.cache_dir.empty()) {
+    if (!options.ram_rewrites.empty()) {
+      XLS_LOG(WARNING) << "The optimization cache does not support RAM "
+                          "rewrites; not using it.";
+    } else {
+      cache.emplace(options.cache_dir);
+      XLS_ASSIGN_OR_RETURN(fingerprint, OptionsFingerprint(*pipeline, options));
+      package_key = PackageCacheKey(*package, fingerprint);
+    }
+  }
+  if (cache.has_value()) {
+    XLS_ASSIGN_OR_RETURN(std::optional<std::string> cached,
+                         cache->Lookup(package_key));
+    absl::StatusOr<std::unique_ptr<Package>> cached_package =
+        absl::NotFoundError("Not cached");
+    if (cached.has_value()) {
+      cached_package = Parser::ParsePackage(*cached);
+    }
+    if (cached_package.ok()) {
+      XLS_VLOG(1) << "Reusing cached optimized package " << package_key;
+      if (results.collect_profile) {
+        XLS_RETURN_IF_ERROR(WritePassProfile(results, /*budget=*/nullptr,
+                                             options));
+      }
+      if (options.binary_output) {
+        return PackageToBinaryIr(**cached_package);
+      }
+      return *std::move(cached);
+    }
+    if (cached.has_value()) {
+      XLS_LOG(WARNING) << "Ignoring corrupt optimization cache entry "
+                       << package_key << ": " << cached_package.status();
+    }
+    if (top.value()->IsFunction()) {
+      XLS_ASSIGN_OR_RETURN(
+          package, SubstituteOptimizedCallees(
+                       top.value()->AsFunctionOrDie(), *pipeline, pass_options,
+                       options.compile_time_budget, *cache, fingerprint));
+    }
+  }
+
+  // The clock of the budget starts here, after any standalone optimization of
+  // callees, so that it covers only the run of the pipeline on the package.
+  if (options.compile_time_budget != absl::InfiniteDuration()) {
+    pass_options.compile_time_budget =
+        std::make_shared<CompileTimeBudget>(options.compile_time_budget);
+  }
+
   XLS_RETURN_IF_ERROR(
       pipeline->Run(package.get(), pass_options, &results).status());
+  bool budget_skipped_work =
+      pass_options.compile_time_budget != nullptr &&
+      !pass_options.compile_time_budget->skips().empty();
+  if (budget_skipped_work) {
+    XLS_LOG(WARNING) << pass_options.compile_time_budget->ToString();
+  }
+  // Results which were cut short by the compile-time budget depend on timing,
+  // so only complete results are cached.
+  if (cache.has_value() && !budget_skipped_work) {
+    XLS_RETURN_IF_ERROR(cache->Insert(package_key, package->DumpIr()));
+  }
+  if (results.collect_profile) {
+    XLS_RETURN_IF_ERROR(WritePassProfile(
+        results, pass_options.compile_time_budget.get(), options));
+  }
+  if (options.binary_output) {
+    return PackageToBinaryIr(*package);
+  }
   return package->DumpIr();
 }
 
@@ -75,7 +308,10 @@ absl::StatusOr<std::string> OptimizeIrForTop(
     absl::Span<const std::string> run_only_passes,
     absl::Span<const std::string> skip_passes,
     int64_t convert_array_index_to_select, bool inline_procs,
-    std::string_view ram_rewrites_pb) {
+    std::string_view ram_rewrites_pb, bool binary_output,
+    int64_t function_parallelism, std::string_view pass_profile_path,
+    std::string_view pass_profile_json_path,
+    absl::Duration compile_time_budget, std::string_view cache_dir) {
   XLS_ASSIGN_OR_RETURN(std::string ir, GetFileContents(input_path));
   std::vector<RamRewrite> ram_rewrites;
   if (!ram_rewrites_pb.empty()) {
@@ -101,6 +337,12 @@ absl::StatusOr<std::string> OptimizeIrForTop(
               : std::make_optional(convert_array_index_to_select),
       .inline_procs = inline_procs,
       .ram_rewrites = std::move(ram_rewrites),
+      .binary_output = binary_output,
+      .function_parallelism = function_parallelism,
+      .pass_profile_path = std::string(pass_profile_path),
+      .pass_profile_json_path = std::string(pass_profile_json_path),
+      .compile_time_budget = compile_time_budget,
+      .cache_dir = std::string(cache_dir),
   };
   return OptimizeIrForTop(ir, options);
 }
@@ -24,6 +24,7 @@
 #include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 
 // TODO(meheff): 2021-10-04 Remove this header.
 #include "xls/passes/optimization_pass.h"
@@ -42,11 +43,31 @@ struct OptOptions {
   std::optional<int64_t> convert_array_index_to_select = std::nullopt;
   bool inline_procs;
   std::vector<RamRewrite> ram_rewrites = {};
+  // Whether to return the optimized package in the binary IR format (see
+  // xls/ir/binary_ir.h) rather than as IR text.
+  bool binary_output = false;
+  // Number of threads used to run function-local passes across functions.
+  int64_t function_parallelism = 1;
+  // If non-empty, a per-pass profile (run time, node count change and peak
+  // memory growth) of the pipeline run is written as a text table to this
+  // path, or to stderr if the path is "-".
+  std::string pass_profile_path = "";
+  // If non-empty, the same profile is written to this path as JSON.
+  std::string pass_profile_json_path = "";
+  // Wall-clock time budget of the pipeline. Once it is spent, fixed-point
+  // compound passes stop iterating and expensive passes skip or scale down
+  // their work (see xls/passes/compile_time_budget.h).
+  absl::Duration compile_time_budget = absl::InfiniteDuration();
+  // If non-empty, a directory holding a content-addressed cache of optimized
+  // IR (see xls/tools/opt_cache.h) shared across runs. Unchanged packages are
+  // returned from the cache and, when the top is a function, unchanged callees
+  // are replaced by their cached optimized versions before the pipeline runs.
+  std::string cache_dir = "";
 };
 
 // Helper used in the opt_main tool, optimizes the given IR for a particular
 // top-level entity (e.g., function, proc, etc) at the given opt level and
-// returns the resulting optimized IR.
+// returns the resulting optimized IR. `ir` may be either IR text or binary IR.
 absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
                                              const OptOptions& options);
 
@@ -58,7 +79,11 @@ absl::StatusOr<std::string> OptimizeIrForTop(
     absl::Span<const std::string> run_only_passes,
     absl::Span<const std::string> skip_passes,
     int64_t convert_array_index_to_select, bool inline_procs,
-    std::string_view ram_rewrites_pb);
+    std::string_view ram_rewrites_pb, bool binary_output = false,
+    int64_t function_parallelism = 1, std::string_view pass_profile_path = "",
+    std::string_view pass_profile_json_path = "",
+    absl::Duration compile_time_budget = absl::InfiniteDuration(),
+    std::string_view cache_dir = "");
 
 }  // namespace xls::tools
 
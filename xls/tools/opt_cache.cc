@@ -0,0 +1,55 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/opt_cache.h"
+
+#include <string>
+#include <string_view>
+
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/ir/call_graph.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/package.h"
+
+namespace xls::tools {
+namespace {
+
+// Bumped whenever the format of the cached IR or the composition of the keys
+// changes.
+constexpr std::string_view kCacheFormatVersion = "xls-opt-cache-v1";
+
+}  // namespace
+
+std::string PackageCacheKey(const Package& p,
+                            std::string_view options_fingerprint) {
+  CacheKeyBuilder builder(kCacheFormatVersion);
+  builder.Add("package");
+  builder.Add(options_fingerprint);
+  builder.Add(p.DumpIr());
+  return builder.Finish();
+}
+
+std::string FunctionCacheKey(FunctionBase* f,
+                             std::string_view options_fingerprint) {
+  CacheKeyBuilder builder(kCacheFormatVersion);
+  builder.Add("function");
+  builder.Add(options_fingerprint);
+  builder.Add(f->package()->name());
+  for (FunctionBase* dependent : GetDependentFunctions(f)) {
+    builder.Add(dependent->DumpIr());
+  }
+  return builder.Finish();
+}
+
+}  // namespace xls::tools
@@ -0,0 +1,76 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_TOOLS_OPT_CACHE_H_
+#define XLS_TOOLS_OPT_CACHE_H_
+
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/package.h"
+
+namespace xls::tools {
+
+// A content-addressed on-disk cache of optimized IR, used by opt_main to avoid
+// reoptimizing IR which is unchanged since a previous run. Each entry is a file
+// in the cache directory named after its key and holding optimized package IR
+// text. Keys are hex SHA-256 digests (see PackageCacheKey and
+// FunctionCacheKey), so entries never need to be invalidated; stale entries may
+// simply be deleted.
+class OptCache {
+ public:
+  explicit OptCache(std::filesystem::path directory)
+      : cache_(std::move(directory), ".ir") {}
+
+  const std::filesystem::path& directory() const { return cache_.directory(); }
+
+  // Returns the IR cached under `key`, or std::nullopt if there is none.
+  absl::StatusOr<std::optional<std::string>> Lookup(
+      std::string_view key) const {
+    return cache_.Lookup(key);
+  }
+
+  // Caches `ir` under `key`, replacing any existing entry (see
+  // ContentAddressedCache::Insert).
+  absl::Status Insert(std::string_view key, std::string_view ir) const {
+    return cache_.Insert(key, ir);
+  }
+
+ private:
+  ContentAddressedCache cache_;
+};
+
+// Returns the cache key of the result of optimizing the whole package `p`.
+// `options_fingerprint` must identify the pass pipeline and every option which
+// affects its result.
+std::string PackageCacheKey(const Package& p,
+                            std::string_view options_fingerprint);
+
+// Returns the cache key of the result of optimizing `f` as the top of a package
+// containing only `f` and the functions it transitively calls. The key covers
+// the IR of all of these, so changing a function changes the keys of all of its
+// callers.
+std::string FunctionCacheKey(FunctionBase* f,
+                             std::string_view options_fingerprint);
+
+}  // namespace xls::tools
+
+#endif  // XLS_TOOLS_OPT_CACHE_H_
@@ -0,0 +1,106 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/opt_cache.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+
+namespace xls::tools {
+namespace {
+
+using status_testing::IsOkAndHolds;
+
+constexpr std::string_view kPackage = R"(
+package p
+
+fn leaf(x: bits[32]) -> bits[32] {
+  literal.1: bits[32] = literal(value=0)
+  ret add.2: bits[32] = add(x, literal.1)
+}
+
+fn other(x: bits[32]) -> bits[32] {
+  ret neg.3: bits[32] = neg(x)
+}
+
+top fn main(x: bits[32]) -> bits[32] {
+  invoke.4: bits[32] = invoke(x, to_apply=leaf)
+  ret invoke.5: bits[32] = invoke(invoke.4, to_apply=other)
+}
+)";
+
+// Returns `ir` with the literal in `leaf` replaced by `literal`.
+std::string ReplaceLiteral(std::string_view ir, std::string_view literal) {
+  std::string result(ir);
+  constexpr std::string_view kLiteral = "literal(value=0)";
+  result.replace(result.find(kLiteral), kLiteral.size(), literal);
+  return result;
+}
+
+class OptCacheTest : public IrTestBase {};
+
+TEST_F(OptCacheTest, LookupAndInsert) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  OptCache cache(temp_dir.path() / "cache");
+  EXPECT_THAT(cache.Lookup("abc"), IsOkAndHolds(std::nullopt));
+  XLS_ASSERT_OK(cache.Insert("abc", "package foo\n"));
+  EXPECT_THAT(cache.Lookup("abc"),
+              IsOkAndHolds(std::optional<std::string>("package foo\n")));
+  XLS_ASSERT_OK(cache.Insert("abc", "package bar\n"));
+  EXPECT_THAT(cache.Lookup("abc"),
+              IsOkAndHolds(std::optional<std::string>("package bar\n")));
+  EXPECT_THAT(cache.Lookup("abd"), IsOkAndHolds(std::nullopt));
+}
+
+TEST_F(OptCacheTest, PackageKeyDependsOnIrAndOptions) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p1, ParsePackage(kPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(auto p2, ParsePackage(kPackage));
+  EXPECT_EQ(PackageCacheKey(*p1, "opt_level=3"),
+            PackageCacheKey(*p2, "opt_level=3"));
+  EXPECT_NE(PackageCacheKey(*p1, "opt_level=3"),
+            PackageCacheKey(*p1, "opt_level=1"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto p3, ParsePackage(ReplaceLiteral(kPackage, "literal(value=1)")));
+  EXPECT_NE(PackageCacheKey(*p1, "opt_level=3"),
+            PackageCacheKey(*p3, "opt_level=3"));
+}
+
+TEST_F(OptCacheTest, FunctionKeyCoversCallees) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p1, ParsePackage(kPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto p2, ParsePackage(ReplaceLiteral(kPackage, "literal(value=1)")));
+
+  auto key = [](Package* p, std::string_view name) {
+    return FunctionCacheKey(*p->GetFunction(name), "");
+  };
+  // Changing `leaf` changes its key and that of its caller, but not the key of
+  // the unrelated `other`.
+  EXPECT_NE(key(p1.get(), "leaf"), key(p2.get(), "leaf"));
+  EXPECT_NE(key(p1.get(), "main"), key(p2.get(), "main"));
+  EXPECT_EQ(key(p1.get(), "other"), key(p2.get(), "other"));
+  EXPECT_NE(key(p1.get(), "leaf"), key(p1.get(), "other"));
+}
+
+}  // namespace
+}  // namespace xls::tools
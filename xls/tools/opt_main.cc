@@ -22,10 +22,12 @@
 
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/time.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/memory_accounting.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/ram_rewrite.pb.h"
 #include "xls/passes/optimization_pass.h"
@@ -36,7 +38,8 @@ const char kUsage[] = R"(
 Takes in an IR file and produces an IR file that has been run through the
 standard optimization pipeline.
 
-Successfully optimized IR is printed to stdout.
+Successfully optimized IR is printed to stdout. The input may be IR text or
+binary IR; see --output_binary_ir for the output format.
 
 Expected invocation:
   opt_main <IR file>
@@ -71,7 +74,38 @@ ABSL_FLAG(bool, inline_procs, false,
           "Whether to inline all procs by calling the proc inlining pass.");
 ABSL_FLAG(std::string, ram_rewrites_pb, "",
           "Path to protobuf describing ram rewrites.");
+ABSL_FLAG(bool, output_binary_ir, false,
+          "Emit the optimized package in the compact binary IR format "
+          "rather than as IR text. The format is smaller than IR text but "
+          "not faster to load.");
+ABSL_FLAG(int64_t, function_parallelism, 1,
+          "Number of threads used to run function-local passes concurrently "
+          "across the functions and procs of the package. The result does "
+          "not depend on this value.");
+ABSL_FLAG(std::string, pass_profile, "",
+          "If specified, write a per-pass profile of the optimization "
+          "pipeline (run time, node count change and peak memory growth, "
+          "sorted by total time) as a text table to this path. Use '-' to "
+          "write it to stderr.");
+ABSL_FLAG(std::string, pass_profile_json, "",
+          "If specified, write the per-pass profile of the optimization "
+          "pipeline as JSON to this path.");
+ABSL_FLAG(absl::Duration, compile_time_budget, absl::InfiniteDuration(),
+          "Wall-clock time budget for the optimization pipeline, e.g. '30s'. "
+          "Once it is spent, fixed-point pass groups stop iterating and "
+          "expensive passes skip or scale down their work. The skipped work "
+          "is logged and included in the pass profile.");
+ABSL_FLAG(std::string, opt_cache_dir, "",
+          "If specified, a directory holding a cache of optimized IR shared "
+          "across runs. Unchanged packages are not reoptimized, and functions "
+          "called by the top function are only reoptimized if they or their "
+          "callees changed.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
+ABSL_FLAG(std::string, memory_report, "",
+          "If specified, attribute the memory allocated by the major XLS data "
+          "structures (IR nodes, query engines, BDDs, ...) to those subsystems "
+          "and write a report of it to this path on completion. Use '-' to "
+          "write it to stderr.");
 
 namespace xls::tools {
 namespace {
@@ -90,17 +124,40 @@ absl::Status RealMain(std::string_view input_path) {
       absl::GetFlag(FLAGS_convert_array_index_to_select);
   bool inline_procs = absl::GetFlag(FLAGS_inline_procs);
   std::string ram_rewrites_pb = absl::GetFlag(FLAGS_ram_rewrites_pb);
-  XLS_ASSIGN_OR_RETURN(
-      std::string opt_ir,
-      tools::OptimizeIrForTop(
-          /*input_path=*/input_path, /*opt_level=*/opt_level,
-          /*top=*/top,
-          /*ir_dump_path=*/ir_dump_path,
-          /*run_only_passes=*/run_only_passes,
-          /*skip_passes=*/skip_passes,
-          /*convert_array_index_to_select=*/convert_array_index_to_select,
-          /*inline_procs=*/inline_procs,
-          /*ram_rewrites_pb=*/ram_rewrites_pb));
+  bool output_binary_ir = absl::GetFlag(FLAGS_output_binary_ir);
+  int64_t function_parallelism = absl::GetFlag(FLAGS_function_parallelism);
+  std::string pass_profile = absl::GetFlag(FLAGS_pass_profile);
+  std::string pass_profile_json = absl::GetFlag(FLAGS_pass_profile_json);
+  absl::Duration compile_time_budget = absl::GetFlag(FLAGS_compile_time_budget);
+  std::string opt_cache_dir = absl::GetFlag(FLAGS_opt_cache_dir);
+  std::string memory_report = absl::GetFlag(FLAGS_memory_report);
+  if (!memory_report.empty()) {
+    EnableMemoryAccounting();
+  }
+  std::string opt_ir;
+  {
+    ScopedMemoryRegion opt_region("opt");
+    XLS_ASSIGN_OR_RETURN(
+        opt_ir,
+        tools::OptimizeIrForTop(
+            /*input_path=*/input_path, /*opt_level=*/opt_level,
+            /*top=*/top,
+            /*ir_dump_path=*/ir_dump_path,
+            /*run_only_passes=*/run_only_passes,
+            /*skip_passes=*/skip_passes,
+            /*convert_array_index_to_select=*/convert_array_index_to_select,
+            /*inline_procs=*/inline_procs,
+            /*ram_rewrites_pb=*/ram_rewrites_pb,
+            /*binary_output=*/output_binary_ir,
+            /*function_parallelism=*/function_parallelism,
+            /*pass_profile_path=*/pass_profile,
+            /*pass_profile_json_path=*/pass_profile_json,
+            /*compile_time_budget=*/compile_time_budget,
+            /*cache_dir=*/opt_cache_dir));
+  }
+  if (!memory_report.empty()) {
+    XLS_RETURN_IF_ERROR(WriteMemoryAccountingReport(memory_report));
+  }
   std::cout << opt_ir;
   return absl::OkStatus();
 }
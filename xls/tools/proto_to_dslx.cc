@@ -15,7 +15,9 @@
 #include "xls/tools/proto_to_dslx.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <deque>
+#include <fstream>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -26,11 +28,14 @@
 #include <vector>
 
 #include "absl/container/btree_map.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_replace.h"
 #include "google/protobuf/compiler/importer.h"
 #include "google/protobuf/descriptor.h"
 #include "google/protobuf/dynamic_message.h"
+#include "google/protobuf/io/zero_copy_stream_impl.h"
 #include "google/protobuf/text_format.h"
+#include "google/protobuf/util/delimited_message_util.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/temp_directory.h"
 #include "xls/common/logging/logging.h"
@@ -1048,6 +1053,117 @@ absl::StatusOr<std::unique_ptr<dslx::Module>> ProtoToDslx(
                                        descriptor_pool.get());
 }
 
+namespace {
+
+// The number of array elements whose DSLX is built in one scratch module
+// before the module is discarded, bounding the memory held by their ASTs.
+constexpr int64_t kElementsPerScratchModule = 1024;
+
+// Calls `fn` on each size-delimited binary message in the file at `path`,
+// parsing each one into `message` in turn.
+absl::Status ForEachDelimitedMessage(
+    const std::filesystem::path& path, Message* message,
+    const std::function<absl::Status(const Message&)>& fn) {
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream.is_open()) {
+    return absl::NotFoundError(
+        absl::StrFormat("Unable to open %s.", path.string()));
+  }
+  google::protobuf::io::IstreamInputStream input(&stream);
+  while (true) {
+    bool clean_eof = false;
+    if (!google::protobuf::util::ParseDelimitedFromZeroCopyStream(
+            message, &input, &clean_eof)) {
+      if (clean_eof) {
+        return absl::OkStatus();
+      }
+      return absl::DataLossError(absl::StrFormat(
+          "Malformed or truncated %s message in %s.",
+          message->GetDescriptor()->full_name(), path.string()));
+    }
+    XLS_RETURN_IF_ERROR(fn(*message));
+  }
+}
+
+}  // namespace
+
+absl::Status ProtoToDslxStreaming(
+    const std::filesystem::path& source_root,
+    const std::filesystem::path& proto_schema_path,
+    std::string_view message_name, const std::filesystem::path& messages_path,
+    std::string_view binding_name, const std::filesystem::path& output_path) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<DescriptorPool> descriptor_pool,
+                       ProcessProtoSchema(source_root, proto_schema_path));
+  const Descriptor* descriptor =
+      descriptor_pool->FindMessageTypeByName(ToProtoString(message_name));
+  XLS_RET_CHECK_NE(descriptor, nullptr);
+  google::protobuf::DynamicMessageFactory factory;
+  std::unique_ptr<Message> message(factory.GetPrototype(descriptor)->New());
+  std::string top_package = descriptor->file()->package();
+
+  // First pass: collect the layout of the types and the largest count of each
+  // repeated field.
+  NameToRecord name_to_record;
+  XLS_RETURN_IF_ERROR(
+      CollectMessageLayout(top_package, *descriptor, &name_to_record));
+  int64_t message_count = 0;
+  XLS_RETURN_IF_ERROR(ForEachDelimitedMessage(
+      messages_path, message.get(), [&](const Message& m) {
+        ++message_count;
+        return CollectElementCounts(top_package, m, &name_to_record);
+      }));
+  if (message_count == 0) {
+    // DSLX has no empty array constants.
+    return absl::InvalidArgumentError(
+        absl::StrFormat("No %s messages in %s.", message_name,
+                        messages_path.string()));
+  }
+
+  auto types_module =
+      std::make_unique<dslx::Module>("the_module", /*fs_path=*/std::nullopt);
+  XLS_RETURN_IF_ERROR(EmitTypeDefs(types_module.get(), &name_to_record));
+
+  std::ofstream output(output_path, std::ios::trunc);
+  if (!output.is_open()) {
+    return absl::NotFoundError(absl::StrFormat("Unable to open %s for writing.",
+                                               output_path.string()));
+  }
+  output << types_module->ToString() << "\n";
+  output << absl::StreamFormat("pub const %s = %s[%d]:[\n", binding_name,
+                               GetParentPrefixedName(top_package, descriptor),
+                               message_count);
+
+  // Second pass: emit each element through a short-lived scratch module.
+  std::unique_ptr<dslx::Module> scratch;
+  int64_t index = 0;
+  XLS_RETURN_IF_ERROR(ForEachDelimitedMessage(
+      messages_path, message.get(), [&](const Message& m) -> absl::Status {
+        if (index % kElementsPerScratchModule == 0) {
+          scratch = std::make_unique<dslx::Module>("scratch",
+                                                   /*fs_path=*/std::nullopt);
+        }
+        XLS_ASSIGN_OR_RETURN(
+            dslx::Expr * expr,
+            EmitData(top_package, scratch.get(), m, name_to_record));
+        output << "    " << expr->ToString() << ",\n";
+        ++index;
+        if (!output.good()) {
+          return absl::InternalError(
+              absl::StrFormat("Failed writing %s.", output_path.string()));
+        }
+        return absl::OkStatus();
+      }));
+  // The file may have changed between the passes.
+  XLS_RET_CHECK_EQ(index, message_count);
+  output << "];\n";
+  output.close();
+  if (output.fail()) {
+    return absl::InternalError(
+        absl::StrFormat("Failed writing %s.", output_path.string()));
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::unique_ptr<dslx::Module>> ProtoToDslxViaText(
     std::string_view proto_def, std::string_view message_name,
     std::string_view text_proto, std::string_view binding_name) {
@@ -90,6 +90,29 @@ absl::StatusOr<std::unique_ptr<dslx::Module>> ProtoToDslx(
     std::string_view message_name, std::string_view text_proto,
     std::string_view binding_name);
 
+// Streaming variant of ProtoToDslx for large data sets, e.g. ROM contents with
+// millions of entries: converts a file of binary-format messages into a DSLX
+// array constant, written directly to `output_path` along with the DSLX
+// definitions of the message types.
+//
+// The messages are read one at a time, in two passes over the file (the first
+// sizes the repeated fields of the DSLX structs, the second emits the data),
+// so memory use is bounded by the largest single message rather than by the
+// whole data set.
+// Args:
+//   source_root, proto_schema_path: as above.
+//   message_name: The name of the message type of each entry.
+//   messages_path: File of binary-format `message_name` messages, each
+//       preceded by its size as a varint (as written by
+//       google::protobuf::util::SerializeDelimitedToOstream).
+//   binding_name: The name to assign to the resulting DSLX array constant.
+//   output_path: The DSLX file to write.
+absl::Status ProtoToDslxStreaming(
+    const std::filesystem::path& source_root,
+    const std::filesystem::path& proto_schema_path,
+    std::string_view message_name, const std::filesystem::path& messages_path,
+    std::string_view binding_name, const std::filesystem::path& output_path);
+
 // As above, but doesn't refer directly to the filesystem for resolution.
 //
 // Args:
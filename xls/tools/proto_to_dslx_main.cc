@@ -38,6 +38,11 @@ ABSL_FLAG(std::string, source_root_path, ".",
           "(Needed for locating transitive proto dependencies.)");
 ABSL_FLAG(std::string, textproto_path, "",
           "Path to the textproto to translate into DSLX.");
+ABSL_FLAG(std::string, delimited_binproto_path, "",
+          "Path to a file of size-delimited binary protos to translate into "
+          "a DSLX array, one element per message. The file is streamed, so "
+          "it may be much larger than memory. Mutually exclusive with "
+          "--textproto_path.");
 ABSL_FLAG(std::string, var_name, "",
           "The name of the DSLX variable to instantiate.");
 
@@ -47,8 +52,14 @@ static absl::Status RealMain(const std::string& source_root_path,
                              const std::string& proto_def_path,
                              const std::string& proto_name,
                              const std::string& textproto_path,
+                             const std::string& delimited_binproto_path,
                              const std::string& var_name,
                              const std::string& output_path) {
+  if (!delimited_binproto_path.empty()) {
+    return ProtoToDslxStreaming(source_root_path, proto_def_path, proto_name,
+                                delimited_binproto_path, var_name,
+                                output_path);
+  }
   XLS_ASSIGN_OR_RETURN(std::string textproto, GetFileContents(textproto_path));
   XLS_ASSIGN_OR_RETURN(auto module,
                        ProtoToDslx(source_root_path, proto_def_path, proto_name,
@@ -75,11 +86,16 @@ int main(int argc, char* argv[]) {
   XLS_QCHECK(!proto_name.empty()) << "--proto_name must be specified.";
 
   std::string textproto_path = absl::GetFlag(FLAGS_textproto_path);
-  XLS_QCHECK(!textproto_path.empty()) << "--textproto_path must be specified.";
+  std::string delimited_binproto_path =
+      absl::GetFlag(FLAGS_delimited_binproto_path);
+  XLS_QCHECK(textproto_path.empty() != delimited_binproto_path.empty())
+      << "Exactly one of --textproto_path and --delimited_binproto_path must "
+         "be specified.";
 
   std::string var_name = absl::GetFlag(FLAGS_var_name);
   XLS_QCHECK(!var_name.empty()) << "--var_name must be specified.";
   return xls::ExitStatus(xls::RealMain(source_root_path, proto_def_path,
-                                       proto_name, textproto_path, var_name,
+                                       proto_name, textproto_path,
+                                       delimited_binproto_path, var_name,
                                        output_path));
 }
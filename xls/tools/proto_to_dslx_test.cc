@@ -14,12 +14,16 @@
 
 #include "xls/tools/proto_to_dslx.h"
 
+#include <filesystem>
+#include <fstream>
 #include <optional>
 #include <string>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "google/protobuf/util/delimited_message_util.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/temp_directory.h"
 #include "xls/common/file/temp_file.h"
@@ -29,6 +33,9 @@
 namespace xls {
 namespace {
 
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
 // Shotgun test to cover a bunch of areas for basic functionality.
 TEST(ProtoToDslxTest, Smoke) {
   const std::string kSchema = R"(
@@ -470,5 +477,84 @@ pub const b1 = TypeB { index_b: uN[64]:2 };
 pub const b2 = TypeB { index_b: uN[64]:3 };)");
 }
 
+TEST(ProtoToDslxTest, StreamsDelimitedMessagesToArray) {
+  const std::string kSchema = R"(
+syntax = "proto2";
+
+package xls;
+
+message Entry {
+  repeated int64 values = 1;
+  optional uint32 tag = 2;
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<google::protobuf::DescriptorPool> descriptor_pool,
+      ProcessStringProtoSchema(kSchema));
+  google::protobuf::DynamicMessageFactory factory;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<google::protobuf::Message> entry_0,
+      ConstructProtoViaText("values: 1 values: 2 tag: 3", "xls.Entry",
+                            descriptor_pool.get(), &factory));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<google::protobuf::Message> entry_1,
+      ConstructProtoViaText("tag: 4", "xls.Entry", descriptor_pool.get(),
+                            &factory));
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto tempdir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto schema_file,
+      TempFile::CreateWithContentInDirectory(kSchema, tempdir.path()));
+  std::filesystem::path messages_path = tempdir.path() / "entries.binpb";
+  {
+    std::ofstream messages(messages_path, std::ios::binary);
+    ASSERT_TRUE(google::protobuf::util::SerializeDelimitedToOstream(*entry_0,
+                                                          &messages));
+    ASSERT_TRUE(google::protobuf::util::SerializeDelimitedToOstream(*entry_1,
+                                                          &messages));
+  }
+  std::filesystem::path output_path = tempdir.path() / "rom.x";
+  XLS_ASSERT_OK(ProtoToDslxStreaming(tempdir.path(), schema_file.path(),
+                                     "xls.Entry", messages_path, "rom",
+                                     output_path));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string output, GetFileContents(output_path));
+  EXPECT_EQ(output,
+            R"(pub struct Entry {
+    values: sN[64][2],
+    values_count: u32,
+    tag: uN[32],
+}
+pub const rom = Entry[2]:[
+    Entry { values: [sN[64]:1, sN[64]:2], values_count: u32:2, tag: uN[32]:3 },
+    Entry { values: [sN[64]:0, sN[64]:0], values_count: u32:0, tag: uN[32]:4 },
+];
+)");
+}
+
+TEST(ProtoToDslxTest, StreamingRejectsEmptyInput) {
+  const std::string kSchema = R"(
+syntax = "proto2";
+
+package xls;
+
+message Entry {
+  optional uint32 tag = 1;
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto tempdir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto schema_file,
+      TempFile::CreateWithContentInDirectory(kSchema, tempdir.path()));
+  std::filesystem::path messages_path = tempdir.path() / "entries.binpb";
+  XLS_ASSERT_OK(SetFileContents(messages_path, ""));
+  EXPECT_THAT(ProtoToDslxStreaming(tempdir.path(), schema_file.path(),
+                                   "xls.Entry", messages_path, "rom",
+                                   tempdir.path() / "rom.x"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("No xls.Entry messages")));
+}
+
 }  // namespace
 }  // namespace xls
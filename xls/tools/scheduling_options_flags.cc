@@ -16,7 +16,9 @@
 
 #include <cstdint>
 #include <limits>
+#include <memory>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -105,6 +107,31 @@ ABSL_FLAG(std::string, fdo_yosys_path, "", "Absolute path of Yosys");
 ABSL_FLAG(std::string, fdo_sta_path, "", "Absolute path of OpenSTA");
 ABSL_FLAG(std::string, fdo_synthesis_libraries, "",
           "Synthesis and STA libraries");
+ABSL_FLAG(int64_t, fdo_synthesis_jobs, 0,
+          "The maximum number of synthesis runs launched at once in each FDO "
+          "iteration. If zero, the number of CPUs is used.");
+ABSL_FLAG(std::string, fdo_synthesis_cache_dir, "",
+          "If non-empty, a directory holding a cache of the delays reported "
+          "by the synthesizer, keyed by the synthesized nodes and the "
+          "synthesis libraries. Later FDO iterations and later runs reuse the "
+          "cached delays rather than synthesizing the same nodes again.");
+ABSL_FLAG(std::string, schedule_cache_dir, "",
+          "If non-empty, a directory holding a cache of pipeline schedules "
+          "keyed by the IR, the delay model and the scheduling options. "
+          "Schedules of unchanged functions are validated and reused rather "
+          "than recomputed.");
+ABSL_FLAG(std::string, sdc_solver, "simplex",
+          "The LP solver used by the SDC scheduler: 'simplex' (exact, the "
+          "default) or 'first_order', a first-order method which needs no "
+          "matrix factorization and so scales to much larger functions. "
+          "First-order solutions are rounded and repaired into a feasible "
+          "schedule which may use slightly more registers.");
+ABSL_FLAG(int64_t, schedule_partition_size, 0,
+          "If positive, functions with more nodes than this are partitioned "
+          "into loosely coupled regions of at most this many nodes, which "
+          "are scheduled in parallel and stitched together. Scheduling time "
+          "becomes near-linear in the size of the function, at the cost of "
+          "some pipeline registers. Requires --clock_period_ps.");
 // LINT.ThenChange(
 //   //xls/build_rules/xls_codegen_rules.bzl,
 //   //docs_src/codegen_options.md
@@ -149,6 +176,11 @@ static absl::StatusOr<bool> SetOptionsFromFlags(
   POPULATE_FLAG(fdo_yosys_path);
   POPULATE_FLAG(fdo_sta_path);
   POPULATE_FLAG(fdo_synthesis_libraries);
+  POPULATE_FLAG(fdo_synthesis_jobs);
+  POPULATE_FLAG(fdo_synthesis_cache_dir);
+  POPULATE_FLAG(schedule_cache_dir);
+  POPULATE_FLAG(sdc_solver);
+  POPULATE_FLAG(schedule_partition_size);
 #undef POPULATE_FLAG
 #undef POPULATE_REPEATED_FLAG
   return any_flags_set;
@@ -306,6 +338,24 @@ static absl::StatusOr<SchedulingOptions> OptionsFromFlagProto(
       proto.fdo_path_evaluate_strategy());
 
   scheduling_options.fdo_synthesizer_name(proto.fdo_synthesizer_name());
+  scheduling_options.schedule_cache_dir(proto.schedule_cache_dir());
+
+  if (proto.sdc_solver() == "simplex") {
+    scheduling_options.sdc_solver(SDCSolver::kSimplex);
+  } else if (proto.sdc_solver() == "first_order") {
+    scheduling_options.sdc_solver(SDCSolver::kFirstOrder);
+  } else {
+    return absl::InternalError(
+        "sdc_solver must be 'simplex' or 'first_order'");
+  }
+
+  if (proto.schedule_partition_size() < 0) {
+    return absl::InternalError("schedule_partition_size must be >= 0");
+  }
+  if (proto.schedule_partition_size() > 0) {
+    scheduling_options.schedule_partition_size(
+        proto.schedule_partition_size());
+  }
 
   return scheduling_options;
 }
@@ -337,11 +387,25 @@ absl::StatusOr<synthesis::Synthesizer*> SetUpSynthesizer() {
       return absl::InternalError(
           "yosys_path, sta_path, and synthesis_libraries must not be empty");
     }
-    synthesis::YosysSynthesizer* yosys_synthesizer =
-        new synthesis::YosysSynthesizer(proto.fdo_yosys_path(),
-                                        proto.fdo_sta_path(),
-                                        proto.fdo_synthesis_libraries());
-    return yosys_synthesizer;
+    if (proto.fdo_synthesis_jobs() < 0) {
+      return absl::InternalError("synthesis_jobs must be >= 0");
+    }
+    std::unique_ptr<synthesis::Synthesizer> synthesizer =
+        std::make_unique<synthesis::YosysSynthesizer>(
+            proto.fdo_yosys_path(), proto.fdo_sta_path(),
+            proto.fdo_synthesis_libraries());
+    if (!proto.fdo_synthesis_cache_dir().empty()) {
+      // The delays depend on the cells of the library rather than its path, so
+      // the cached delays are keyed by the contents of the library.
+      XLS_ASSIGN_OR_RETURN(std::string library,
+                           GetFileContents(proto.fdo_synthesis_libraries()));
+      synthesizer = std::make_unique<synthesis::CachingSynthesizer>(
+          std::move(synthesizer), proto.fdo_synthesis_cache_dir(), library);
+    }
+    if (proto.fdo_synthesis_jobs() > 0) {
+      synthesizer->set_max_concurrency(proto.fdo_synthesis_jobs());
+    }
+    return synthesizer.release();
   }
 
   return absl::InternalError("Synthesis service is invalid");
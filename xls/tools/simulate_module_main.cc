@@ -12,7 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -27,6 +30,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "xls/codegen/flattening.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/vast.h"
 #include "xls/common/exit_status.h"
@@ -34,9 +38,14 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/bits.h"
 #include "xls/ir/format_preference.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
 #include "xls/ir/value.h"
+#include "xls/jit/jit_proc_runtime.h"
 #include "xls/simulation/module_simulator.h"
 #include "xls/simulation/verilog_simulators.h"
 #include "xls/tools/eval_helpers.h"
@@ -54,6 +63,13 @@ Simulate a module with a batch of arguments, one argument set per line in
 ARGS_FILE:
   simulate_module_main  --signature_file=SIG_FILE \
       --args_file=ARGS_FILE VERILOG_FILE
+
+Co-simulate a module generated from procs against the JIT-compiled procs,
+stopping at the first output which differs:
+  simulate_module_main --signature_file=SIG_FILE \
+      --channel_values_file=CHANNEL_VALUES_FILE \
+      --output_channel_counts=CHANNEL=COUNT \
+      --reference_ir_file=IR_FILE VERILOG_FILE
 )";
 
 ABSL_FLAG(
@@ -86,6 +102,16 @@ ABSL_FLAG(std::vector<std::string>, output_channel_counts, {},
           "channel name, and 'count' is an integer representing the number of "
           "values expected from the given channel during simulation. Must be "
           "specified with 'channel_values_file'.");
+ABSL_FLAG(std::string, reference_ir_file, "",
+          "Path to an IR file containing the procs from which the module was "
+          "generated. If specified, the module is co-simulated in lockstep "
+          "with the JIT-compiled procs: each output channel value is compared "
+          "against the procs as soon as the Verilog simulation produces it, "
+          "and the simulation is stopped at the first mismatch. Must be "
+          "specified with 'channel_values_file'.");
+ABSL_FLAG(int64_t, max_reference_ticks, 100000,
+          "With --reference_ir_file, the maximum number of ticks the procs "
+          "may take to produce each output value.");
 ABSL_FLAG(std::string, verilog_simulator, "",
           "The Verilog simulator to use. If not specified, the default "
           "simulator is used.");
@@ -120,6 +146,57 @@ absl::Status RunProc(const verilog::ModuleSimulator& simulator,
   return absl::OkStatus();
 }
 
+absl::Status CosimulateProc(const verilog::ModuleSimulator& simulator,
+                            const verilog::ModuleSignature& signature,
+                            const ProcInput& proc_input, Package* package) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> runtime,
+                       CreateJitSerialProcRuntime(package));
+  absl::flat_hash_map<std::string, std::vector<Bits>> channel_inputs;
+  for (const auto& [channel_name, values] : proc_input.channel_inputs) {
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * queue,
+                         runtime->queue_manager().GetQueueByName(channel_name));
+    for (const Value& value : values) {
+      XLS_RETURN_IF_ERROR(queue->Write(value));
+      channel_inputs[channel_name].push_back(
+          FlattenValueToBits(value));
+    }
+  }
+
+  // The procs are ticked only as far as necessary to produce the output the
+  // Verilog simulation is compared against, so both run in lockstep.
+  absl::flat_hash_map<std::string, std::vector<Value>> reference_outputs;
+  const int64_t max_ticks = absl::GetFlag(FLAGS_max_reference_ticks);
+  auto reference = [&](std::string_view channel_name,
+                       int64_t index) -> absl::StatusOr<Bits> {
+    std::vector<Value>& outputs = reference_outputs[channel_name];
+    if (index >= outputs.size()) {
+      XLS_ASSIGN_OR_RETURN(
+          ChannelQueue * queue,
+          runtime->queue_manager().GetQueueByName(channel_name));
+      int64_t needed = index + 1 - static_cast<int64_t>(outputs.size());
+      XLS_RETURN_IF_ERROR(
+          runtime->TickUntilOutput({{queue->channel(), needed}}, max_ticks)
+              .status());
+      while (std::optional<Value> value = queue->Read()) {
+        outputs.push_back(*std::move(value));
+      }
+    }
+    return FlattenValueToBits(outputs.at(index));
+  };
+
+  XLS_ASSIGN_OR_RETURN(
+      std::optional<verilog::CosimulationMismatch> mismatch,
+      simulator.CosimulateInputSeriesProc(
+          channel_inputs, proc_input.output_channel_counts, reference));
+  if (mismatch.has_value()) {
+    return absl::FailedPreconditionError(absl::StrFormat(
+        "Verilog simulation differs from the procs at %s",
+        mismatch->ToString()));
+  }
+  std::cout << "All outputs match the procs." << std::endl;
+  return absl::OkStatus();
+}
+
 absl::Status RunFunction(const verilog::ModuleSimulator& simulator,
                          const verilog::ModuleSignature& signature,
                          FunctionInput function_input) {
@@ -148,13 +225,22 @@ absl::Status RealMain(std::string_view verilog_text,
                       verilog::FileType file_type,
                       const verilog::ModuleSignature& signature,
                       InputType inputs,
-                      const verilog::VerilogSimulator* verilog_simulator) {
+                      const verilog::VerilogSimulator* verilog_simulator,
+                      std::string_view reference_ir_path) {
   verilog::ModuleSimulator simulator(signature, verilog_text, file_type,
                                      verilog_simulator);
 
   if (std::holds_alternative<FunctionInput>(inputs)) {
     return RunFunction(simulator, signature, std::get<FunctionInput>(inputs));
   }
+  if (!reference_ir_path.empty()) {
+    XLS_ASSIGN_OR_RETURN(std::string ir_text,
+                         GetFileContents(reference_ir_path));
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                         Parser::ParsePackage(ir_text));
+    return CosimulateProc(simulator, signature, std::get<ProcInput>(inputs),
+                          package.get());
+  }
   return RunProc(simulator, signature, std::get<ProcInput>(inputs));
 }
 
@@ -218,6 +304,9 @@ int main(int argc, char** argv) {
     XLS_QCHECK(absl::GetFlag(FLAGS_output_channel_counts).empty())
         << "'--output_channel_counts' can only be specified with "
            "'--channel_values_file'.";
+    XLS_QCHECK(absl::GetFlag(FLAGS_reference_ir_file).empty())
+        << "'--reference_ir_file' can only be specified with "
+           "'--channel_values_file'.";
   }
 
   xls::InputType input;
@@ -266,5 +355,6 @@ int main(int argc, char** argv) {
 
   return xls::ExitStatus(xls::RealMain(verilog_text.value(), file_type,
                                        signature_status.value(), input,
-                                       verilog_simulator));
+                                       verilog_simulator,
+                                       absl::GetFlag(FLAGS_reference_ir_file)));
 }
@@ -0,0 +1,494 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/codegen/module_signature.h"
+#include "xls/codegen/vast.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/block_interpreter.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/interpreter_proc_runtime.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/block.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_helpers.h"
+#include "xls/jit/batched_random_values.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_proc_runtime.h"
+#include "xls/simulation/module_testbench.h"
+#include "xls/simulation/verilog_simulator.h"
+#include "xls/simulation/verilog_simulators.h"
+#include "xls/tools/benchmark_recorder.h"
+#include "xls/tools/benchmark_results.pb.h"
+#include "xls/tools/codegen.h"
+#include "xls/tools/codegen_flags.h"
+#include "xls/tools/codegen_flags.pb.h"
+#include "xls/tools/scheduling_options_flags.h"
+
+const char kUsage[] = R"(
+Measures the throughput of the XLS simulators on the top function or proc of
+each of the given IR files. The simulators are selected with --simulators:
+
+  interpreter, jit: evaluations per second of a function with random
+    arguments, or ticks per second of a proc network with random inputs on
+    its input channels.
+  block_interpreter: cycles per second of the block generated from the
+    function or proc. Codegen takes the flags of codegen_main, e.g.
+    --pipeline_stages, --delay_model and --reset.
+  verilog: cycles per second of the generated Verilog in the Verilog
+    simulator. Not run by default.
+
+Each rate is recorded as a metric named "<simulator>.<unit>_per_second", with
+unit evals, ticks or cycles. With --output_json the results of all IR files are
+written as a BenchmarkSuiteResultsProto (see benchmark_results.proto), which is
+the stable format to track simulator performance with.
+
+Example invocation:
+  simulation_benchmark_main --pipeline_stages=2 --delay_model=unit \
+      --output_json=/tmp/results.json a.opt.ir b.opt.ir
+)";
+
+ABSL_FLAG(std::vector<std::string>, simulators,
+          std::vector<std::string>({"interpreter", "jit", "block_interpreter"}),
+          "Comma-separated list of the simulators to measure: interpreter, "
+          "jit, block_interpreter and verilog.");
+ABSL_FLAG(int64_t, min_duration_ms, 1000,
+          "Minimum time to run each simulator for to measure its rate.");
+ABSL_FLAG(int64_t, verilog_cycles, 4000,
+          "Number of cycles of the longer of the two Verilog simulations whose "
+          "difference in run time gives the Verilog simulation rate.");
+ABSL_FLAG(std::string, verilog_simulator, "",
+          "The Verilog simulator to use. If not specified, the default "
+          "simulator is used.");
+ABSL_FLAG(int64_t, repetitions, 1,
+          "Number of times to measure each IR file. The results hold the "
+          "min, max, mean, median and standard deviation of each rate.");
+ABSL_FLAG(std::string, output_json, "",
+          "If set, writes the results as a BenchmarkSuiteResultsProto in JSON "
+          "to this file.");
+
+namespace xls {
+namespace {
+
+constexpr std::string_view kInterpreter = "interpreter";
+constexpr std::string_view kJit = "jit";
+constexpr std::string_view kBlockInterpreter = "block_interpreter";
+constexpr std::string_view kVerilog = "verilog";
+
+// Number of distinct random argument sets (or block input sets) cycled
+// through by the interpreters.
+constexpr int64_t kInputSetCount = 64;
+
+// Calls `run(n)`, which does `n` units of work, with doubling `n` until the
+// calls have taken at least `min_duration` in total, and returns the units of
+// work per second.
+absl::StatusOr<double> MeasureRate(
+    const std::function<absl::Status(int64_t)>& run,
+    absl::Duration min_duration) {
+  int64_t total = 0;
+  absl::Duration elapsed = absl::ZeroDuration();
+  for (int64_t n = 1; elapsed < min_duration; n *= 2) {
+    absl::Time start = absl::Now();
+    XLS_RETURN_IF_ERROR(run(n));
+    elapsed += absl::Now() - start;
+    total += n;
+  }
+  return total / absl::ToDoubleSeconds(elapsed);
+}
+
+absl::Duration MinDuration() {
+  return absl::Milliseconds(absl::GetFlag(FLAGS_min_duration_ms));
+}
+
+void RecordRate(std::string_view simulator, std::string_view unit, double rate,
+                BenchmarkRecorder& recorder) {
+  std::cout << absl::StreamFormat("  %s: %.0f %s/s\n", simulator, rate, unit);
+  recorder.Record(absl::StrFormat("%s.%s_per_second", simulator, unit),
+                  absl::StrCat(unit, "/s"), rate);
+}
+
+absl::Status BenchmarkFunction(
+    Function* f, const absl::flat_hash_set<std::string>& simulators,
+    BenchmarkRecorder& recorder) {
+  if (simulators.contains(kInterpreter)) {
+    std::minstd_rand engine;
+    std::vector<std::vector<Value>> arg_sets(kInputSetCount);
+    for (std::vector<Value>& args : arg_sets) {
+      for (Param* param : f->params()) {
+        args.push_back(RandomValue(param->GetType(), &engine));
+      }
+    }
+    XLS_ASSIGN_OR_RETURN(double rate,
+                         MeasureRate(
+                             [&](int64_t n) -> absl::Status {
+                               for (int64_t i = 0; i < n; ++i) {
+                                 XLS_RETURN_IF_ERROR(
+                                     InterpretFunction(
+                                         f, arg_sets[i % kInputSetCount])
+                                         .status());
+                               }
+                               return absl::OkStatus();
+                             },
+                             MinDuration()));
+    RecordRate(kInterpreter, "evals", rate, recorder);
+  }
+
+  if (simulators.contains(kJit)) {
+    absl::Time start = absl::Now();
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<FunctionJit> jit,
+        FunctionJit::Create(f, /*opt_level=*/3, /*profile=*/nullptr,
+                            /*build_batched_wrapper=*/true));
+    recorder.RecordStage("jit.compile", absl::Now() - start);
+
+    // The arguments are generated in the native layout and run in batches so
+    // the rate is not dominated by Value conversion.
+    constexpr int64_t kBatchSize = 1024;
+    BatchedRandomValueGenerator generator(/*seed=*/0);
+    std::vector<std::vector<uint8_t>> arg_columns(f->params().size());
+    std::vector<const uint8_t*> arg_column_pointers;
+    for (int64_t i = 0; i < f->params().size(); ++i) {
+      const TypeLayout& layout = jit->GetArgTypeLayout(i);
+      arg_columns[i].resize(kBatchSize * layout.size());
+      generator.Fill(layout, kBatchSize, absl::MakeSpan(arg_columns[i]));
+      arg_column_pointers.push_back(arg_columns[i].data());
+    }
+    std::vector<uint8_t> result_column(kBatchSize * jit->GetReturnTypeSize());
+    XLS_ASSIGN_OR_RETURN(
+        double rate,
+        MeasureRate(
+            [&](int64_t n) -> absl::Status {
+              for (int64_t done = 0; done < n; done += kBatchSize) {
+                InterpreterEvents events;
+                XLS_RETURN_IF_ERROR(jit->RunBatch(
+                    arg_column_pointers, absl::MakeSpan(result_column),
+                    std::min(kBatchSize, n - done), &events));
+              }
+              return absl::OkStatus();
+            },
+            MinDuration()));
+    RecordRate(kJit, "evals", rate, recorder);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status BenchmarkProcNetwork(
+    Package* package, const absl::flat_hash_set<std::string>& simulators,
+    BenchmarkRecorder& recorder) {
+  for (std::string_view simulator : {kInterpreter, kJit}) {
+    if (!simulators.contains(simulator)) {
+      continue;
+    }
+    std::minstd_rand engine;
+    std::unique_ptr<SerialProcRuntime> runtime;
+    if (simulator == kJit) {
+      absl::Time start = absl::Now();
+      XLS_ASSIGN_OR_RETURN(runtime, CreateJitSerialProcRuntime(package));
+      recorder.RecordStage("jit.compile", absl::Now() - start);
+    } else {
+      XLS_ASSIGN_OR_RETURN(runtime,
+                           CreateInterpreterSerialProcRuntime(package));
+    }
+
+    // Input channels produce random values whenever they are read, and output
+    // channels are drained so the queues do not grow without bound.
+    std::vector<ChannelQueue*> output_queues;
+    for (Channel* channel : package->channels()) {
+      ChannelQueue& queue = runtime->queue_manager().GetQueue(channel);
+      if (channel->supported_ops() == ChannelOps::kReceiveOnly) {
+        Type* type = channel->type();
+        XLS_RETURN_IF_ERROR(queue.AttachGenerator(
+            [&engine, type]() { return RandomValue(type, &engine); }));
+      } else if (channel->supported_ops() == ChannelOps::kSendOnly) {
+        output_queues.push_back(&queue);
+      }
+    }
+    XLS_ASSIGN_OR_RETURN(double rate,
+                         MeasureRate(
+                             [&](int64_t n) -> absl::Status {
+                               for (int64_t i = 0; i < n; ++i) {
+                                 XLS_RETURN_IF_ERROR(runtime->Tick());
+                               }
+                               for (ChannelQueue* queue : output_queues) {
+                                 while (queue->Read().has_value()) {
+                                 }
+                               }
+                               return absl::OkStatus();
+                             },
+                             MinDuration()));
+    RecordRate(simulator, "ticks", rate, recorder);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status BenchmarkBlockInterpreter(
+    Block* block, const verilog::ModuleSignature& signature,
+    BenchmarkRecorder& recorder) {
+  std::minstd_rand engine;
+  std::vector<absl::flat_hash_map<std::string, Value>> input_sets(
+      kInputSetCount);
+  for (absl::flat_hash_map<std::string, Value>& inputs : input_sets) {
+    for (InputPort* port : block->GetInputPorts()) {
+      inputs[port->name()] = RandomValue(port->GetType(), &engine);
+    }
+    // Hold the block out of reset.
+    if (signature.proto().has_reset()) {
+      const verilog::ResetProto& reset = signature.proto().reset();
+      inputs[reset.name()] = Value(UBits(reset.active_low() ? 1 : 0, 1));
+    }
+  }
+  absl::flat_hash_map<std::string, Value> reg_state;
+  for (Register* reg : block->GetRegisters()) {
+    reg_state[reg->name()] = ZeroOfType(reg->type());
+  }
+
+  IncrementalBlockEvaluator evaluator(block);
+  XLS_ASSIGN_OR_RETURN(
+      double rate,
+      MeasureRate(
+          [&](int64_t n) -> absl::Status {
+            for (int64_t i = 0; i < n; ++i) {
+              XLS_ASSIGN_OR_RETURN(
+                  BlockRunResult result,
+                  evaluator.RunCycle(input_sets[i % kInputSetCount],
+                                     reg_state));
+              reg_state = std::move(result.reg_state);
+            }
+            return absl::OkStatus();
+          },
+          MinDuration()));
+  RecordRate(kBlockInterpreter, "cycles", rate, recorder);
+  return absl::OkStatus();
+}
+
+absl::Status BenchmarkVerilog(std::string_view verilog_text,
+                              verilog::FileType file_type,
+                              const verilog::ModuleSignature& signature,
+                              BenchmarkRecorder& recorder) {
+  if (!signature.proto().has_clock_name()) {
+    return absl::InvalidArgumentError(
+        "Verilog simulation rate requires a module with a clock");
+  }
+  const verilog::VerilogSimulator* simulator;
+  if (absl::GetFlag(FLAGS_verilog_simulator).empty()) {
+    simulator = &verilog::GetDefaultVerilogSimulator();
+  } else {
+    XLS_ASSIGN_OR_RETURN(
+        simulator,
+        verilog::GetVerilogSimulator(absl::GetFlag(FLAGS_verilog_simulator)));
+  }
+
+  // Returns the run time of a simulation of `cycles` cycles with random
+  // inputs held on the data input ports.
+  std::minstd_rand engine;
+  auto simulate = [&](int64_t cycles) -> absl::StatusOr<absl::Duration> {
+    verilog::ModuleTestbench tb(verilog_text, file_type, signature, simulator);
+    XLS_ASSIGN_OR_RETURN(verilog::ModuleTestbenchThread * thread,
+                         tb.CreateThread());
+    for (const verilog::PortProto& port : signature.data_inputs()) {
+      if (port.width() == 0) {
+        continue;
+      }
+      BitsType type(port.width());
+      thread->Set(port.name(), RandomValue(&type, &engine).bits());
+    }
+    thread->AdvanceNCycles(cycles);
+    absl::Time start = absl::Now();
+    XLS_RETURN_IF_ERROR(tb.Run());
+    return absl::Now() - start;
+  };
+
+  // Compiling and starting the simulation take time independent of the
+  // number of cycles, which cancels out in the difference between a long and
+  // a short run.
+  int64_t long_cycles = absl::GetFlag(FLAGS_verilog_cycles);
+  int64_t short_cycles = long_cycles / 2;
+  XLS_RET_CHECK_GT(short_cycles, 0);
+  XLS_ASSIGN_OR_RETURN(absl::Duration short_time, simulate(short_cycles));
+  XLS_ASSIGN_OR_RETURN(absl::Duration long_time, simulate(long_cycles));
+  double rate = long_time > short_time
+                    ? (long_cycles - short_cycles) /
+                          absl::ToDoubleSeconds(long_time - short_time)
+                    : long_cycles / absl::ToDoubleSeconds(long_time);
+  RecordRate(kVerilog, "cycles", rate, recorder);
+  return absl::OkStatus();
+}
+
+// Generates a block from the top of a fresh copy of the package, and measures
+// the block interpreter and Verilog simulation of it.
+absl::Status BenchmarkGeneratedBlock(
+    std::string_view ir_text,
+    const absl::flat_hash_set<std::string>& simulators,
+    BenchmarkRecorder& recorder) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text));
+  XLS_ASSIGN_OR_RETURN(CodegenFlagsProto codegen_flags, GetCodegenFlags());
+  XLS_ASSIGN_OR_RETURN(bool delay_model_flag_passed,
+                       IsDelayModelSpecifiedViaFlag());
+  absl::Time start = absl::Now();
+  XLS_ASSIGN_OR_RETURN(CodegenResult codegen_result,
+                       ScheduleAndCodegen(package.get(), codegen_flags,
+                                          delay_model_flag_passed));
+  recorder.RecordStage("codegen", absl::Now() - start);
+  const verilog::ModuleGeneratorResult& result =
+      codegen_result.module_generator_result;
+
+  if (simulators.contains(kBlockInterpreter)) {
+    XLS_ASSIGN_OR_RETURN(Block * block,
+                         package->GetBlock(result.signature.module_name()));
+    XLS_RETURN_IF_ERROR(
+        BenchmarkBlockInterpreter(block, result.signature, recorder));
+  }
+  if (simulators.contains(kVerilog)) {
+    XLS_RETURN_IF_ERROR(BenchmarkVerilog(
+        result.verilog_text,
+        codegen_flags.use_system_verilog() ? verilog::FileType::kSystemVerilog
+                                           : verilog::FileType::kVerilog,
+        result.signature, recorder));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status BenchmarkIrFile(std::string_view path,
+                             const absl::flat_hash_set<std::string>& simulators,
+                             BenchmarkRecorder& recorder) {
+  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text));
+  std::optional<FunctionBase*> top_or = package->GetTop();
+  if (!top_or.has_value()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("No top function or proc in %s", path));
+  }
+  FunctionBase* top = *top_or;
+  recorder.set_top(top->name());
+  std::cout << absl::StreamFormat("%s (%s):\n", path, top->name());
+
+  if (top->IsFunction()) {
+    XLS_RETURN_IF_ERROR(
+        BenchmarkFunction(top->AsFunctionOrDie(), simulators, recorder));
+  } else if (top->IsProc()) {
+    XLS_RETURN_IF_ERROR(
+        BenchmarkProcNetwork(package.get(), simulators, recorder));
+  } else {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Top of %s must be a function or proc", path));
+  }
+
+  if (simulators.contains(kBlockInterpreter) ||
+      simulators.contains(kVerilog)) {
+    XLS_RETURN_IF_ERROR(BenchmarkGeneratedBlock(ir_text, simulators, recorder));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RealMain(absl::Span<const std::string_view> ir_paths) {
+  absl::flat_hash_set<std::string> simulators;
+  for (const std::string& simulator : absl::GetFlag(FLAGS_simulators)) {
+    if (simulator != kInterpreter && simulator != kJit &&
+        simulator != kBlockInterpreter && simulator != kVerilog) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Unknown simulator `%s`; expected one of: %s", simulator,
+          absl::StrJoin({kInterpreter, kJit, kBlockInterpreter, kVerilog},
+                        ", ")));
+    }
+    simulators.insert(simulator);
+  }
+  int64_t repetitions = absl::GetFlag(FLAGS_repetitions);
+  if (repetitions < 1) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "--repetitions must be at least 1, got %d", repetitions));
+  }
+
+  // A failure on one IR file is recorded in its results rather than stopping
+  // the rest of the suite.
+  BenchmarkSuiteResultsProto suite;
+  int64_t failures = 0;
+  for (std::string_view path : ir_paths) {
+    BenchmarkRecorder recorder;
+    absl::Status status;
+    for (int64_t i = 0; i < repetitions && status.ok(); ++i) {
+      status = BenchmarkIrFile(path, simulators, recorder);
+    }
+    BenchmarkResultsProto* results = suite.add_results();
+    *results = recorder.ToProto(path, repetitions);
+    if (!status.ok()) {
+      std::cerr << absl::StreamFormat("Benchmark of %s failed: %s\n", path,
+                                      status.ToString());
+      results->set_error(status.ToString());
+      ++failures;
+    }
+  }
+
+  if (!absl::GetFlag(FLAGS_output_json).empty()) {
+    XLS_ASSIGN_OR_RETURN(std::string json, BenchmarkResultsToJson(suite));
+    XLS_RETURN_IF_ERROR(
+        SetFileContents(absl::GetFlag(FLAGS_output_json), json));
+  }
+  if (failures > 0) {
+    return absl::InternalError(absl::StrFormat(
+        "Benchmark of %d of %d IR files failed", failures, ir_paths.size()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+
+  if (positional_arguments.empty()) {
+    XLS_LOG(QFATAL) << absl::StreamFormat(
+        "Expected invocation: %s IR_FILE [IR_FILE...]", argv[0]);
+  }
+  return xls::ExitStatus(xls::RealMain(positional_arguments));
+}
@@ -59,6 +59,15 @@ flags.DEFINE_string(
 flags.DEFINE_string(
     'top', None, 'Name of entity (function, proc, etc) to visualize. If not '
     'given then the entity specified as top in the IR file is visualzied.')
+flags.DEFINE_integer(
+    'max_graph_nodes', 5000,
+    'Functions with more nodes than this are sent to the browser as a summary '
+    'of clusters of nodes (pipeline stages or bands of similar depth). Nodes '
+    'are then fetched on demand in neighborhoods of the selected nodes.')
+flags.DEFINE_integer(
+    'neighborhood_radius', 2,
+    'Number of operand/user hops around a node fetched when expanding it in '
+    'a summarized function.')
 flags.mark_flag_as_required('delay_model')
 
 IR_EXAMPLES_FILE_LIST = 'xls/visualization/ir_viz/ir_examples_file_list.txt'
@@ -233,7 +242,8 @@ def graph_handler():
   text = flask.request.form['text']
   try:
     json_text = ir_to_json.ir_to_json(text, FLAGS.delay_model,
-                                      FLAGS.pipeline_stages, FLAGS.top)
+                                      FLAGS.pipeline_stages, FLAGS.top,
+                                      FLAGS.max_graph_nodes)
   except Exception as e:  # pylint: disable=broad-except
     # TODO(meheff): Switch to new pybind11 more-specific exception.
     return flask.jsonify({'error_code': 'error', 'message': str(e)})
@@ -243,6 +253,33 @@ def graph_handler():
   return jsonified
 
 
+@functools.lru_cache(256)
+def neighborhood_to_json(text: str, node_id: str) -> str:
+  """Returns the JSON neighborhood of the given node, caching the result."""
+  return ir_to_json.neighborhood_to_json(
+      text,
+      FLAGS.delay_model,
+      node_id,
+      FLAGS.neighborhood_radius,
+      FLAGS.pipeline_stages,
+      FLAGS.top,
+      FLAGS.max_graph_nodes,
+  )
+
+
+@webapp.route('/neighborhood', methods=['POST'])
+def neighborhood_handler():
+  """Returns the nodes around the posted node id of the posted IR."""
+  text = flask.request.form['text']
+  node_id = flask.request.form['node_id']
+  try:
+    json_text = neighborhood_to_json(text, node_id)
+  except Exception as e:  # pylint: disable=broad-except
+    return flask.jsonify({'error_code': 'error', 'message': str(e)})
+
+  return flask.jsonify({'error_code': 'ok', 'graph': json.loads(json_text)})
+
+
 def main(argv):
   if len(argv) > 1:
     raise app.UsageError('Too many command-line arguments.')
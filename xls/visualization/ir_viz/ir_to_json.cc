@@ -14,28 +14,40 @@
 
 #include "xls/visualization/ir_viz/ir_to_json.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "google/protobuf/message.h"
 #include "google/protobuf/util/json_util.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/delay_model/analyze_critical_path.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/block.h"
 #include "xls/ir/dfs_visitor.h"
+#include "xls/ir/node_iterator.h"
 #include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc.h"
 #include "xls/passes/bdd_query_engine.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
 #include "xls/visualization/ir_viz/visualization.pb.h"
 #include "re2/re2.h"
 
@@ -130,15 +142,13 @@ std::optional<int64_t> MaybeGetStateParamIndex(Node* node) {
 // Returns the attributes of a node (e.g., the index value of a kTupleIndex
 // instruction) as a proto which is to be serialized to JSON.
 absl::StatusOr<viz::NodeAttributes> NodeAttributes(
-    Node* node,
-    const absl::flat_hash_map<Node*, CriticalPathEntry*>& critical_path_map,
+    Node* node, const absl::flat_hash_set<Node*>& critical_path,
     const QueryEngine& query_engine, const PipelineSchedule* schedule,
     const DelayEstimator& delay_estimator) {
   AttributeVisitor visitor;
   XLS_RETURN_IF_ERROR(node->VisitSingleNode(&visitor));
   viz::NodeAttributes attributes = visitor.attributes();
-  auto it = critical_path_map.find(node);
-  if (it != critical_path_map.end()) {
+  if (critical_path.contains(node)) {
     attributes.set_on_critical_path(true);
   }
   if (query_engine.IsTracked(node)) {
@@ -170,69 +180,300 @@ absl::StatusOr<viz::NodeAttributes> NodeAttributes(
   return attributes;
 }
 
-absl::StatusOr<viz::FunctionBase> FunctionBaseToVisualizationProto(
-    FunctionBase* function, const DelayEstimator& delay_estimator,
-    const PipelineSchedule* schedule,
-    const absl::flat_hash_map<FunctionBase*, std::string>& function_ids) {
-  viz::FunctionBase proto;
-  proto.set_name(function->name());
-  if (function->IsFunction()) {
-    proto.set_kind("function");
-  } else if (function->IsProc()) {
-    proto.set_kind("proc");
-  } else {
-    XLS_RET_CHECK(function->IsBlock());
-    proto.set_kind("block");
-  }
-  proto.set_id(function_ids.at(function));
+// Returns the nodes on the critical path of `function`, or no nodes if it
+// cannot be analyzed.
+absl::flat_hash_set<Node*> CriticalPathNodes(
+    FunctionBase* function, const DelayEstimator& delay_estimator) {
   absl::StatusOr<std::vector<CriticalPathEntry>> critical_path =
       AnalyzeCriticalPath(function, /*clock_period_ps=*/std::nullopt,
                           delay_estimator);
-  absl::flat_hash_map<Node*, CriticalPathEntry*> node_to_critical_path_entry;
+  absl::flat_hash_set<Node*> nodes;
   if (critical_path.ok()) {
-    for (CriticalPathEntry& entry : critical_path.value()) {
-      node_to_critical_path_entry[entry.node] = &entry;
+    for (const CriticalPathEntry& entry : critical_path.value()) {
+      nodes.insert(entry.node);
     }
   } else {
     XLS_LOG(WARNING) << "Could not analyze critical path for function: "
                      << critical_path.status();
   }
+  return nodes;
+}
+
+// Returns a query engine populated for `function` to compute known bits.
+// BDD analysis is superlinear in the size of the function, so functions with
+// more than `max_nodes` nodes use ternary analysis.
+absl::StatusOr<std::unique_ptr<QueryEngine>> KnownBitsQueryEngine(
+    FunctionBase* function, int64_t max_nodes) {
+  std::unique_ptr<QueryEngine> query_engine;
+  if (function->node_count() <= max_nodes) {
+    query_engine =
+        std::make_unique<BddQueryEngine>(BddFunction::kDefaultPathLimit);
+  } else {
+    query_engine = std::make_unique<TernaryQueryEngine>();
+  }
+  XLS_RETURN_IF_ERROR(query_engine->Populate(function).status());
+  return std::move(query_engine);
+}
+
+absl::Status AddNode(
+    Node* node, const absl::flat_hash_set<Node*>& critical_path,
+    const QueryEngine& query_engine, const PipelineSchedule* schedule,
+    const DelayEstimator& delay_estimator,
+    const absl::flat_hash_map<FunctionBase*, std::string>& function_ids,
+    viz::FunctionBase* proto) {
+  viz::Node* graph_node = proto->add_nodes();
+  graph_node->set_name(node->GetName());
+  graph_node->set_id(GetNodeUniqueId(node, function_ids));
+  graph_node->set_opcode(OpToString(node->op()));
+  graph_node->set_ir(node->ToStringWithOperandTypes());
+  XLS_ASSIGN_OR_RETURN(*graph_node->mutable_attributes(),
+                       NodeAttributes(node, critical_path, query_engine,
+                                      schedule, delay_estimator));
+  return absl::OkStatus();
+}
 
-  BddQueryEngine query_engine(BddFunction::kDefaultPathLimit);
-  XLS_RETURN_IF_ERROR(query_engine.Populate(function).status());
+void AddEdge(
+    Node* operand, Node* node,
+    const absl::flat_hash_map<FunctionBase*, std::string>& function_ids,
+    viz::FunctionBase* proto) {
+  viz::Edge* graph_edge = proto->add_edges();
+  graph_edge->set_id(GetEdgeUniqueId(operand, node, function_ids));
+  graph_edge->set_source_id(GetNodeUniqueId(operand, function_ids));
+  graph_edge->set_target_id(GetNodeUniqueId(node, function_ids));
+  graph_edge->set_type(operand->GetType()->ToString());
+  graph_edge->set_bit_width(operand->GetType()->GetFlatBitCount());
+}
 
+// Sets the name, kind and id of `function` in `proto`.
+absl::Status SetFunctionHeader(
+    FunctionBase* function,
+    const absl::flat_hash_map<FunctionBase*, std::string>& function_ids,
+    viz::FunctionBase* proto) {
+  proto->set_name(function->name());
+  if (function->IsFunction()) {
+    proto->set_kind("function");
+  } else if (function->IsProc()) {
+    proto->set_kind("proc");
+  } else {
+    XLS_RET_CHECK(function->IsBlock());
+    proto->set_kind("block");
+  }
+  proto->set_id(function_ids.at(function));
+  proto->set_node_count(function->node_count());
+  return absl::OkStatus();
+}
+
+// Summarizes `function` in `proto` as clusters of nodes and the edges between
+// them. The clusters are the pipeline stages if `schedule` is given, and
+// otherwise `max_clusters` bands of nodes of similar depth (longest path from
+// a node without operands).
+void AddClusters(
+    FunctionBase* function, const PipelineSchedule* schedule,
+    int64_t max_clusters, const absl::flat_hash_set<Node*>& critical_path,
+    const absl::flat_hash_map<FunctionBase*, std::string>& function_ids,
+    viz::FunctionBase* proto) {
+  absl::flat_hash_map<Node*, int64_t> cluster_of;
+  int64_t cluster_count;
+  if (schedule != nullptr) {
+    for (Node* node : function->nodes()) {
+      cluster_of[node] = schedule->cycle(node);
+    }
+    cluster_count = schedule->length();
+  } else {
+    absl::flat_hash_map<Node*, int64_t> depth;
+    int64_t max_depth = 0;
+    for (Node* node : TopoSort(function)) {
+      int64_t node_depth = 0;
+      for (Node* operand : node->operands()) {
+        node_depth = std::max(node_depth, depth.at(operand) + 1);
+      }
+      depth[node] = node_depth;
+      max_depth = std::max(max_depth, node_depth);
+    }
+    cluster_count = std::min(std::max<int64_t>(max_clusters, 1), max_depth + 1);
+    for (const auto& [node, node_depth] : depth) {
+      cluster_of[node] = node_depth * cluster_count / (max_depth + 1);
+    }
+  }
+
+  std::vector<int64_t> node_counts(cluster_count);
+  std::vector<int64_t> critical_path_node_counts(cluster_count);
+  // Total bit width of the edges between each pair of clusters.
+  std::map<std::pair<int64_t, int64_t>, int64_t> edge_bit_widths;
   for (Node* node : function->nodes()) {
-    viz::Node* graph_node = proto.add_nodes();
-    graph_node->set_name(node->GetName());
-    graph_node->set_id(GetNodeUniqueId(node, function_ids));
-    graph_node->set_opcode(OpToString(node->op()));
-    graph_node->set_ir(node->ToStringWithOperandTypes());
-    XLS_ASSIGN_OR_RETURN(
-        *graph_node->mutable_attributes(),
-        NodeAttributes(node, node_to_critical_path_entry, query_engine,
-                       schedule, delay_estimator));
+    int64_t cluster = cluster_of.at(node);
+    ++node_counts[cluster];
+    if (critical_path.contains(node)) {
+      ++critical_path_node_counts[cluster];
+    }
+    for (Node* operand : node->operands()) {
+      int64_t operand_cluster = cluster_of.at(operand);
+      if (operand_cluster != cluster) {
+        edge_bit_widths[{operand_cluster, cluster}] +=
+            operand->GetType()->GetFlatBitCount();
+      }
+    }
+  }
+
+  auto cluster_id = [&](int64_t cluster) {
+    return absl::StrFormat("%s_c%d", function_ids.at(function), cluster);
+  };
+  for (int64_t cluster = 0; cluster < cluster_count; ++cluster) {
+    if (node_counts[cluster] == 0) {
+      continue;
+    }
+    viz::Cluster* graph_cluster = proto->add_clusters();
+    graph_cluster->set_id(cluster_id(cluster));
+    if (schedule != nullptr) {
+      graph_cluster->set_name(absl::StrFormat("stage %d", cluster));
+      graph_cluster->set_cycle(cluster);
+    } else {
+      graph_cluster->set_name(absl::StrFormat("depth band %d", cluster));
+    }
+    graph_cluster->set_node_count(node_counts[cluster]);
+    graph_cluster->set_critical_path_node_count(
+        critical_path_node_counts[cluster]);
+  }
+  for (const auto& [clusters, bit_width] : edge_bit_widths) {
+    viz::Edge* graph_edge = proto->add_cluster_edges();
+    graph_edge->set_id(absl::StrFormat("%s_to_%s", cluster_id(clusters.first),
+                                       cluster_id(clusters.second)));
+    graph_edge->set_source_id(cluster_id(clusters.first));
+    graph_edge->set_target_id(cluster_id(clusters.second));
+    graph_edge->set_bit_width(bit_width);
+  }
+}
+
+absl::StatusOr<viz::FunctionBase> FunctionBaseToVisualizationProto(
+    FunctionBase* function, const DelayEstimator& delay_estimator,
+    const PipelineSchedule* schedule,
+    const absl::flat_hash_map<FunctionBase*, std::string>& function_ids,
+    const IrToJsonOptions& options) {
+  viz::FunctionBase proto;
+  XLS_RETURN_IF_ERROR(SetFunctionHeader(function, function_ids, &proto));
+  absl::flat_hash_set<Node*> critical_path =
+      CriticalPathNodes(function, delay_estimator);
+
+  if (function->node_count() > options.max_nodes) {
+    proto.set_truncated(true);
+    AddClusters(function, schedule, options.max_clusters, critical_path,
+                function_ids, &proto);
+    return std::move(proto);
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<QueryEngine> query_engine,
+                       KnownBitsQueryEngine(function, options.max_nodes));
+  for (Node* node : function->nodes()) {
+    XLS_RETURN_IF_ERROR(AddNode(node, critical_path, *query_engine, schedule,
+                                delay_estimator, function_ids, &proto));
   }
 
   for (Node* node : function->nodes()) {
-    for (int64_t i = 0; i < node->operand_count(); ++i) {
-      Node* operand = node->operand(i);
-      viz::Edge* graph_edge = proto.add_edges();
-      graph_edge->set_id(GetEdgeUniqueId(operand, node, function_ids));
-      graph_edge->set_source_id(GetNodeUniqueId(operand, function_ids));
-      graph_edge->set_target_id(GetNodeUniqueId(node, function_ids));
-      graph_edge->set_type(operand->GetType()->ToString());
-      graph_edge->set_bit_width(operand->GetType()->GetFlatBitCount());
+    for (Node* operand : node->operands()) {
+      AddEdge(operand, node, function_ids, &proto);
     }
   }
   return std::move(proto);
 }
 
+absl::StatusOr<std::string> ProtoToJson(
+    const google::protobuf::Message& proto) {
+  return ProtoToJson(proto);
+}
+
+absl::StatusOr<std::string> NeighborhoodToJson(
+    Package* package, std::string_view node_id, int64_t radius,
+    const DelayEstimator& delay_estimator, const PipelineSchedule* schedule,
+    const IrToJsonOptions& options) {
+  absl::flat_hash_map<FunctionBase*, std::string> function_ids =
+      GetFunctionIds(package);
+
+  // Node ids are prefixed with the id of their function.
+  std::string_view function_id = node_id.substr(0, node_id.find('_'));
+  Node* center = nullptr;
+  for (FunctionBase* fb : package->GetFunctionBases()) {
+    if (function_ids.at(fb) != function_id) {
+      continue;
+    }
+    for (Node* node : fb->nodes()) {
+      if (GetNodeUniqueId(node, function_ids) == node_id) {
+        center = node;
+        break;
+      }
+    }
+  }
+  if (center == nullptr) {
+    return absl::NotFoundError(
+        absl::StrFormat("No node with id `%s` in package `%s`", node_id,
+                        package->name()));
+  }
+  FunctionBase* function = center->function_base();
+  if (schedule != nullptr && schedule->function_base() != function) {
+    schedule = nullptr;
+  }
+
+  // Breadth-first search from the center, so the nearest nodes are kept when
+  // the neighborhood has more than max_nodes nodes.
+  std::vector<Node*> included = {center};
+  absl::flat_hash_map<Node*, int64_t> distance = {{center, 0}};
+  for (int64_t i = 0; i < included.size(); ++i) {
+    Node* node = included[i];
+    if (distance.at(node) == radius) {
+      continue;
+    }
+    auto visit = [&](Node* neighbor) {
+      if (included.size() < options.max_nodes &&
+          distance.emplace(neighbor, distance.at(node) + 1).second) {
+        included.push_back(neighbor);
+      }
+    };
+    for (Node* operand : node->operands()) {
+      visit(operand);
+    }
+    for (Node* user : node->users()) {
+      visit(user);
+    }
+  }
+
+  viz::FunctionBase proto;
+  XLS_RETURN_IF_ERROR(SetFunctionHeader(function, function_ids, &proto));
+  absl::flat_hash_set<Node*> critical_path =
+      CriticalPathNodes(function, delay_estimator);
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<QueryEngine> query_engine,
+                       KnownBitsQueryEngine(function, options.max_nodes));
+  for (Node* node : included) {
+    XLS_RETURN_IF_ERROR(AddNode(node, critical_path, *query_engine, schedule,
+                                delay_estimator, function_ids, &proto));
+    bool has_hidden_neighbors = false;
+    for (Node* operand : node->operands()) {
+      AddEdge(operand, node, function_ids, &proto);
+      has_hidden_neighbors |= !distance.contains(operand);
+    }
+    // Edges to included users are added along with the users.
+    for (Node* user : node->users()) {
+      if (distance.contains(user)) {
+        continue;
+      }
+      has_hidden_neighbors = true;
+      for (Node* operand : user->operands()) {
+        if (operand == node) {
+          AddEdge(node, user, function_ids, &proto);
+        }
+      }
+    }
+    proto.mutable_nodes(proto.nodes_size() - 1)
+        ->set_has_hidden_neighbors(has_hidden_neighbors);
+  }
+  return ProtoToJson(proto);
+}
+
 }  // namespace
 
 absl::StatusOr<std::string> IrToJson(
     Package* package, const DelayEstimator& delay_estimator,
     const PipelineSchedule* schedule,
-    std::optional<std::string_view> entry_name) {
+    std::optional<std::string_view> entry_name,
+    const IrToJsonOptions& options) {
   viz::Package proto;
 
   absl::flat_hash_map<FunctionBase*, std::string> function_ids =
@@ -246,7 +487,7 @@ absl::StatusOr<std::string> IrToJson(
             fb, delay_estimator,
             schedule != nullptr && schedule->function_base() == fb ? schedule
                                                                    : nullptr,
-            function_ids));
+            function_ids, options));
     if (entry_name.has_value() && fb->name() == entry_name.value()) {
       entry_function_base = fb;
     }
@@ -263,17 +504,93 @@ absl::StatusOr<std::string> IrToJson(
     }
   }
 
-  std::string serialized_json;
-  google::protobuf::util::JsonPrintOptions print_options;
-  print_options.add_whitespace = true;
-  print_options.preserve_proto_field_names = true;
+  return ProtoToJson(proto);
+}
+
+absl::StatusOr<std::string> NeighborhoodToJson(
+    Package* package, std::string_view node_id, int64_t radius,
+    const DelayEstimator& delay_estimator, const PipelineSchedule* schedule,
+    const IrToJsonOptions& options) {
+  absl::flat_hash_map<FunctionBase*, std::string> function_ids =
+      GetFunctionIds(package);
 
-  auto status =
-      google::protobuf::util::MessageToJsonString(proto, &serialized_json, print_options);
-  if (!status.ok()) {
-    return absl::InternalError(std::string{status.message()});
+  // Node ids are prefixed with the id of their function.
+  std::string_view function_id = node_id.substr(0, node_id.find('_'));
+  Node* center = nullptr;
+  for (FunctionBase* fb : package->GetFunctionBases()) {
+    if (function_ids.at(fb) != function_id) {
+      continue;
+    }
+    for (Node* node : fb->nodes()) {
+      if (GetNodeUniqueId(node, function_ids) == node_id) {
+        center = node;
+        break;
+      }
+    }
+  }
+  if (center == nullptr) {
+    return absl::NotFoundError(
+        absl::StrFormat("No node with id `%s` in package `%s`", node_id,
+                        package->name()));
+  }
+  FunctionBase* function = center->function_base();
+  if (schedule != nullptr && schedule->function_base() != function) {
+    schedule = nullptr;
+  }
+
+  // Breadth-first search from the center, so the nearest nodes are kept when
+  // the neighborhood has more than max_nodes nodes.
+  std::vector<Node*> included = {center};
+  absl::flat_hash_map<Node*, int64_t> distance = {{center, 0}};
+  for (int64_t i = 0; i < included.size(); ++i) {
+    Node* node = included[i];
+    if (distance.at(node) == radius) {
+      continue;
+    }
+    auto visit = [&](Node* neighbor) {
+      if (included.size() < options.max_nodes &&
+          distance.emplace(neighbor, distance.at(node) + 1).second) {
+        included.push_back(neighbor);
+      }
+    };
+    for (Node* operand : node->operands()) {
+      visit(operand);
+    }
+    for (Node* user : node->users()) {
+      visit(user);
+    }
+  }
+
+  viz::FunctionBase proto;
+  XLS_RETURN_IF_ERROR(SetFunctionHeader(function, function_ids, &proto));
+  absl::flat_hash_set<Node*> critical_path =
+      CriticalPathNodes(function, delay_estimator);
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<QueryEngine> query_engine,
+                       KnownBitsQueryEngine(function, options.max_nodes));
+  for (Node* node : included) {
+    XLS_RETURN_IF_ERROR(AddNode(node, critical_path, *query_engine, schedule,
+                                delay_estimator, function_ids, &proto));
+    bool has_hidden_neighbors = false;
+    for (Node* operand : node->operands()) {
+      AddEdge(operand, node, function_ids, &proto);
+      has_hidden_neighbors |= !distance.contains(operand);
+    }
+    // Edges to included users are added along with the users.
+    for (Node* user : node->users()) {
+      if (distance.contains(user)) {
+        continue;
+      }
+      has_hidden_neighbors = true;
+      for (Node* operand : user->operands()) {
+        if (operand == node) {
+          AddEdge(node, user, function_ids, &proto);
+        }
+      }
+    }
+    proto.mutable_nodes(proto.nodes_size() - 1)
+        ->set_has_hidden_neighbors(has_hidden_neighbors);
   }
-  return serialized_json;
+  return ProtoToJson(proto);
 }
 
 // Wraps the given text in a span with the given id, classes, and data. The
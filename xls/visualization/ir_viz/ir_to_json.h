@@ -15,6 +15,8 @@
 #ifndef XLS_IR_VISUALIZATION_IR_TO_JSON_H_
 #define XLS_IR_VISUALIZATION_IR_TO_JSON_H_
 
+#include <cstdint>
+#include <limits>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -24,13 +26,42 @@
 
 namespace xls {
 
+// Options bounding the size of the exported graphs so that the visualizer
+// stays responsive on very large functions.
+struct IrToJsonOptions {
+  // Functions, procs and blocks with more nodes than this are exported as
+  // summaries: their nodes are grouped into clusters, the pipeline stages if
+  // the function is scheduled and otherwise bands of nodes of similar depth,
+  // and only the clusters and the edges between them are exported. Their
+  // nodes can then be fetched incrementally with NeighborhoodToJson. Known
+  // bits of nodes of such functions come from ternary rather than BDD
+  // analysis.
+  int64_t max_nodes = std::numeric_limits<int64_t>::max();
+
+  // The number of depth bands the nodes of an unscheduled function are
+  // clustered into.
+  int64_t max_clusters = 32;
+};
+
 // Returns a JSON representation of the given package for use by the
 // visualizer. The JSON is based on the xls::viz::Package proto (see
 // ir_to_json_test.cc for examples)
 absl::StatusOr<std::string> IrToJson(
     Package* package, const DelayEstimator& delay_estimator,
     const PipelineSchedule* schedule = nullptr,
-    std::optional<std::string_view> entry_name = std::nullopt);
+    std::optional<std::string_view> entry_name = std::nullopt,
+    const IrToJsonOptions& options = IrToJsonOptions());
+
+// Returns a JSON xls::viz::FunctionBase holding the nodes within `radius`
+// operand/user hops of the node with the visualizer id `node_id` (as in the
+// output of IrToJson), nearest first and at most options.max_nodes of them,
+// along with every edge incident to them. Edges may thus lead to nodes which
+// are not included; nodes with such neighbors have has_hidden_neighbors set.
+absl::StatusOr<std::string> NeighborhoodToJson(
+    Package* package, std::string_view node_id, int64_t radius,
+    const DelayEstimator& delay_estimator,
+    const PipelineSchedule* schedule = nullptr,
+    const IrToJsonOptions& options = IrToJsonOptions());
 
 // Return the IR text of the given package with HTML mark up. Various IR
 // constructs are wrapped in spans. This function is exposed only for testing as
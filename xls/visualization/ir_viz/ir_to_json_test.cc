@@ -14,13 +14,20 @@
 
 #include "xls/visualization/ir_viz/ir_to_json.h"
 
+#include <cstdint>
 #include <filesystem>
 #include <memory>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "google/protobuf/util/json_util.h"
 #include "xls/common/golden_files.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/matchers.h"
@@ -30,11 +37,14 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/package.h"
+#include "xls/visualization/ir_viz/visualization.pb.h"
 
 namespace xls {
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
+using ::testing::UnorderedElementsAre;
 
 constexpr char kTestdataPath[] = "xls/visualization/ir_viz/testdata";
 
@@ -178,5 +188,137 @@ top proc the_proc(tkn: token, x: bits[32], y: bits[64], init={0, 42}) {
   ExpectEqualToGoldenFile(GoldenFilePath("htmltext"), html);
 }
 
+// Returns the IR of a function computing a chain of `length` negations of its
+// parameter `x`; the i-th negation is named n<i> and has id i + 1.
+std::string ChainIr(int64_t length) {
+  std::string ir =
+      "package test\n\ntop fn main(x: bits[8] id=1) -> bits[8] {\n";
+  std::string previous = "x";
+  for (int64_t i = 1; i <= length; ++i) {
+    absl::StrAppendFormat(&ir, "  %sn%d: bits[8] = neg(%s, id=%d)\n",
+                          i == length ? "ret " : "", i, previous, i + 1);
+    previous = absl::StrCat("n", i);
+  }
+  absl::StrAppend(&ir, "}\n");
+  return ir;
+}
+
+TEST_F(IrToJsonTest, LargeFunctionIsSummarized) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(ChainIr(15)));
+  XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * delay_estimator,
+                           GetDelayEstimator("unit"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string json,
+      IrToJson(p.get(), *delay_estimator, /*schedule=*/nullptr,
+               /*entry_name=*/"main",
+               IrToJsonOptions{.max_nodes = 10, .max_clusters = 4}));
+  viz::Package package;
+  ASSERT_TRUE(google::protobuf::util::JsonStringToMessage(json, &package).ok());
+  ASSERT_EQ(package.function_bases_size(), 1);
+  const viz::FunctionBase& function = package.function_bases(0);
+  EXPECT_TRUE(function.truncated());
+  EXPECT_EQ(function.node_count(), 16);
+  EXPECT_TRUE(function.nodes().empty());
+  EXPECT_TRUE(function.edges().empty());
+
+  // The 16 nodes of depth 0 to 15 form four bands of four nodes.
+  ASSERT_EQ(function.clusters_size(), 4);
+  EXPECT_EQ(function.clusters(0).id(), "f0_c0");
+  for (const viz::Cluster& cluster : function.clusters()) {
+    EXPECT_EQ(cluster.node_count(), 4);
+  }
+  std::vector<std::string> edges;
+  for (const viz::Edge& edge : function.cluster_edges()) {
+    edges.push_back(absl::StrCat(edge.source_id(), "->", edge.target_id()));
+    EXPECT_EQ(edge.bit_width(), 8);
+  }
+  EXPECT_THAT(edges, ElementsAre("f0_c0->f0_c1", "f0_c1->f0_c2",
+                                 "f0_c2->f0_c3"));
+
+  // Below the limit the function is exported node by node.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      json, IrToJson(p.get(), *delay_estimator, /*schedule=*/nullptr,
+                     /*entry_name=*/"main", IrToJsonOptions{.max_nodes = 16}));
+  package.Clear();
+  ASSERT_TRUE(google::protobuf::util::JsonStringToMessage(json, &package).ok());
+  EXPECT_FALSE(package.function_bases(0).truncated());
+  EXPECT_EQ(package.function_bases(0).nodes_size(), 16);
+}
+
+TEST_F(IrToJsonTest, ScheduledLargeFunctionIsClusteredByStage) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(ChainIr(5)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("main"));
+  ScheduleCycleMap cycle_map;
+  for (Node* node : f->nodes()) {
+    cycle_map[node] = node->id() <= 3 ? 0 : 1;
+  }
+  PipelineSchedule schedule(f, cycle_map);
+  XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * delay_estimator,
+                           GetDelayEstimator("unit"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string json,
+      IrToJson(p.get(), *delay_estimator, &schedule, /*entry_name=*/"main",
+               IrToJsonOptions{.max_nodes = 2}));
+  viz::Package package;
+  ASSERT_TRUE(google::protobuf::util::JsonStringToMessage(json, &package).ok());
+  const viz::FunctionBase& function = package.function_bases(0);
+  ASSERT_EQ(function.clusters_size(), 2);
+  EXPECT_EQ(function.clusters(0).name(), "stage 0");
+  EXPECT_EQ(function.clusters(0).node_count(), 3);
+  EXPECT_EQ(function.clusters(1).cycle(), 1);
+  EXPECT_EQ(function.clusters(1).node_count(), 3);
+  EXPECT_EQ(function.cluster_edges_size(), 1);
+}
+
+TEST_F(IrToJsonTest, Neighborhood) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(ChainIr(15)));
+  XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * delay_estimator,
+                           GetDelayEstimator("unit"));
+  // n5 has id 6.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string json,
+      NeighborhoodToJson(p.get(), "f0_6", /*radius=*/2, *delay_estimator));
+  viz::FunctionBase function;
+  ASSERT_TRUE(
+      google::protobuf::util::JsonStringToMessage(json, &function).ok());
+  EXPECT_EQ(function.id(), "f0");
+  std::vector<std::string> nodes;
+  std::vector<std::string> frontier;
+  for (const viz::Node& node : function.nodes()) {
+    nodes.push_back(node.name());
+    if (node.has_hidden_neighbors()) {
+      frontier.push_back(node.name());
+    }
+  }
+  EXPECT_THAT(nodes, UnorderedElementsAre("n3", "n4", "n5", "n6", "n7"));
+  EXPECT_THAT(frontier, UnorderedElementsAre("n3", "n7"));
+  // The edges into n3 and out of n7 lead to hidden nodes.
+  EXPECT_EQ(function.edges_size(), 6);
+
+  // The size limit keeps the nearest nodes.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      json, NeighborhoodToJson(p.get(), "f0_6", /*radius=*/2, *delay_estimator,
+                               /*schedule=*/nullptr,
+                               IrToJsonOptions{.max_nodes = 3}));
+  function.Clear();
+  ASSERT_TRUE(
+      google::protobuf::util::JsonStringToMessage(json, &function).ok());
+  nodes.clear();
+  for (const viz::Node& node : function.nodes()) {
+    nodes.push_back(node.name());
+  }
+  EXPECT_THAT(nodes, ElementsAre("n5", "n4", "n6"));
+
+  // The parameter has a distinct id.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      json,
+      NeighborhoodToJson(p.get(), "f0_p1", /*radius=*/1, *delay_estimator));
+  EXPECT_THAT(json, HasSubstr(R"("name": "n1")"));
+
+  EXPECT_THAT(NeighborhoodToJson(p.get(), "f0_99", /*radius=*/1,
+                                 *delay_estimator),
+              status_testing::StatusIs(absl::StatusCode::kNotFound));
+}
+
 }  // namespace
 }  // namespace xls
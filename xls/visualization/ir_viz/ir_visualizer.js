@@ -129,6 +129,36 @@ function getCohighlightedNodeIds(nodeId) {
   return Array.from(cohighlightedNodeIds).sort();
 }
 
+/**
+ * Returns a graph in the format of xls.viz.FunctionBase whose nodes are the
+ * clusters summarizing the given truncated function.
+ * @param {!Object} func
+ * @return {!Object}
+ */
+function clusterGraph(func) {
+  let nodes = (func['clusters'] || []).map(cluster => {
+    let attributes = {};
+    if (cluster['cycle'] !== undefined) {
+      attributes['cycle'] = cluster['cycle'];
+    }
+    return {
+      'id': cluster['id'],
+      'name': cluster['name'],
+      'opcode': 'cluster',
+      'ir': `${cluster['name']}: ${cluster['node_count']} nodes, ` +
+          `${cluster['critical_path_node_count'] || 0} on the critical path`,
+      'attributes': attributes,
+    };
+  });
+  return {
+    'id': func['id'],
+    'name': func['name'],
+    'kind': func['kind'],
+    'nodes': nodes,
+    'edges': func['cluster_edges'] || [],
+  };
+}
+
 /**
  * Class for visualizing IR graphs. Manages the text area containing the IR and
  * the element in which the graph is drawn.
@@ -195,6 +225,21 @@ class IrVisualizer {
      */
     this.selectedFunctionId_ = null;
 
+    /**
+     *  For functions too large to export whole (the `truncated` field of
+     *  xls.viz.FunctionBase), the nodes and edges fetched so far from the
+     *  server, keyed by id. Null for functions exported whole.
+     *  @private {?{nodes: !Object<string, !Object>,
+     *              edges: !Object<string, !Object>}}
+     */
+    this.fetched_ = null;
+
+    /**
+     * Whether a neighborhood request is in flight.
+     * @private {boolean}
+     */
+    this.neighborhoodInFlight_ = false;
+
     let self = this;
     this.functionSelector_.addEventListener('change', e => {
       if (e.target.value) {
@@ -259,7 +304,8 @@ class IrVisualizer {
       });
     }
 
-    if (this.irGraph_ && this.nodeMetadataElement_) {
+    if (this.irGraph_ && this.irGraph_.node(nodeId) &&
+        this.nodeMetadataElement_) {
       let text = '<b>node:</b> ' + this.irGraph_.node(nodeId).ir;
       let delay = this.irGraph_.node(nodeId).attributes['delay_ps'];
       if (delay != null) {
@@ -414,6 +460,12 @@ class IrVisualizer {
     if (graph == null) {
       return;
     }
+    this.fetched_ = null;
+    if (graph['truncated']) {
+      // Start from the cluster summary; nodes are fetched on demand.
+      this.fetched_ = {nodes: {}, edges: {}};
+      graph = clusterGraph(graph);
+    }
     this.irGraph_ = new irGraph.IrGraph(graph);
     this.graph_ = new selectableGraph.SelectableGraph(this.irGraph_);
     this.highlightIr_(graph);
@@ -465,7 +517,9 @@ class IrVisualizer {
           return;
         }
         let nodeId = /** @type {string} */ (e.target.dataset.nodeId);
-        if (e.ctrlKey && self.graphView_) {
+        if (self.needsNeighborhood_(nodeId)) {
+          self.fetchNeighborhood_(nodeId);
+        } else if (e.ctrlKey && self.graphView_) {
           // If the control key is down. Zoom in on the node in the graph.
           self.graphView_.focusOnNode(nodeId);
         } else {
@@ -488,6 +542,99 @@ class IrVisualizer {
     });
   }
 
+  /**
+   * Returns whether the node with the given id of a truncated function has not
+   * been fetched yet or has neighbors which have not been fetched.
+   * @param {string} nodeId
+   * @return {boolean}
+   * @private
+   */
+  needsNeighborhood_(nodeId) {
+    if (!this.fetched_) {
+      return false;
+    }
+    let node = this.fetched_.nodes[nodeId];
+    return !node || !!node['has_hidden_neighbors'];
+  }
+
+  /**
+   * Fetches the neighborhood of the node with the given id from the server,
+   * merges it into the nodes fetched so far and redraws the graph with the
+   * node selected.
+   * @param {string} nodeId
+   * @private
+   */
+  fetchNeighborhood_(nodeId) {
+    if (this.neighborhoodInFlight_ || !this.package_) {
+      return;
+    }
+    this.neighborhoodInFlight_ = true;
+    let functionId = this.selectedFunctionId_;
+    let xmr = new XMLHttpRequest();
+    xmr.open('POST', '/neighborhood');
+    let self = this;
+    xmr.addEventListener('load', function() {
+      self.neighborhoodInFlight_ = false;
+      if (xmr.status < 200 || xmr.status >= 400 ||
+          self.selectedFunctionId_ != functionId || !self.fetched_) {
+        return;
+      }
+      let response = /** @type {!Object} */ (JSON.parse(xmr.responseText));
+      if (response['error_code'] != 'ok') {
+        console.log('Neighborhood request failed: ' + response['message']);
+        return;
+      }
+      let neighborhood = response['graph'];
+      for (let node of neighborhood['nodes']) {
+        let known = self.fetched_.nodes[node['id']];
+        if (known) {
+          // A node's neighbors are all known once any fetch included them.
+          node['has_hidden_neighbors'] = !!known['has_hidden_neighbors'] &&
+              !!node['has_hidden_neighbors'];
+        }
+        self.fetched_.nodes[node['id']] = node;
+      }
+      for (let edge of (neighborhood['edges'] || [])) {
+        self.fetched_.edges[edge['id']] = edge;
+      }
+      self.showFetched_();
+      self.selectNode(nodeId, true);
+    });
+    xmr.addEventListener('error', function() {
+      self.neighborhoodInFlight_ = false;
+    });
+    let data = new FormData();
+    data.append('text', this.irElement_.textContent);
+    data.append('node_id', nodeId);
+    xmr.send(data);
+  }
+
+  /**
+   * Rebuilds the graph of the selected (truncated) function from the nodes
+   * fetched so far and redraws it. Edges to nodes which have not been fetched
+   * are omitted.
+   * @private
+   */
+  showFetched_() {
+    let nodes = Object.values(this.fetched_.nodes);
+    let edges = Object.values(this.fetched_.edges)
+                    .filter(
+                        e => e['source_id'] in this.fetched_.nodes &&
+                            e['target_id'] in this.fetched_.nodes);
+    let hadView = !!this.graphView_;
+    let showOnlySelected = hadView &&
+        document.getElementById('only-selected-checkbox').checked;
+    if (this.graphView_) {
+      this.graphView_.destroy();
+      this.graphView_ = null;
+    }
+    this.irGraph_ = new irGraph.IrGraph({'nodes': nodes, 'edges': edges});
+    this.graph_ = new selectableGraph.SelectableGraph(this.irGraph_);
+    if (hadView) {
+      this.draw(showOnlySelected);
+    }
+  }
+
   /**
    * Highlights the IR text source using the JSON graphified IR. This puts the
    * marked up IR from the server into the IR text element.
@@ -615,7 +762,11 @@ class IrVisualizer {
     });
     this.graphView_.setClickCallback((nodeId, ctrlPressed) => {
       if (nodeId) {
-        if (ctrlPressed) {
+        if (this.fetched_ && this.fetched_.nodes[nodeId] &&
+            this.needsNeighborhood_(nodeId)) {
+          // Expand the graph around the node.
+          this.fetchNeighborhood_(nodeId);
+        } else if (ctrlPressed) {
           // Scroll the node into view in the IR text window.
           document.getElementById(`ir-node-def-${nodeId}`).scrollIntoView();
         } else {
@@ -14,10 +14,12 @@
 
 #include "xls/visualization/ir_viz/ir_to_json.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 
 #include "absl/status/statusor.h"
 #include "pybind11/pybind11.h"
@@ -28,6 +30,7 @@
 #include "xls/delay_model/delay_estimators.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/run_pipeline_schedule.h"
 
 namespace py = pybind11;
@@ -53,34 +56,81 @@ absl::StatusOr<FunctionBase*> GetFunctionBaseToView(Package* package) {
 
 }  // namespace
 
-// IR to JSON conversion function which takes strings rather than objects.
-static absl::StatusOr<std::string> IrToJsonWrapper(
+// A parsed package along with the delay estimator and optional schedule to use
+// in visualizing it.
+struct ParsedPackage {
+  std::unique_ptr<Package> package;
+  FunctionBase* func_base;
+  DelayEstimator* delay_estimator;
+  std::optional<PipelineSchedule> schedule;
+};
+
+static absl::StatusOr<ParsedPackage> ParseAndSchedule(
     std::string_view ir_text, std::string_view delay_model_name,
     std::optional<int64_t> pipeline_stages,
     std::optional<std::string_view> entry_name) {
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
-                       Parser::ParsePackage(ir_text));
-  FunctionBase* func_base;
+  ParsedPackage parsed;
+  XLS_ASSIGN_OR_RETURN(parsed.package, Parser::ParsePackage(ir_text));
   if (entry_name.has_value()) {
-    XLS_ASSIGN_OR_RETURN(func_base, package->GetFunction(entry_name.value()));
+    XLS_ASSIGN_OR_RETURN(parsed.func_base,
+                         parsed.package->GetFunction(entry_name.value()));
   } else {
-    XLS_ASSIGN_OR_RETURN(func_base, GetFunctionBaseToView(package.get()));
+    XLS_ASSIGN_OR_RETURN(parsed.func_base,
+                         GetFunctionBaseToView(parsed.package.get()));
   }
-  XLS_ASSIGN_OR_RETURN(DelayEstimator * delay_estimator,
+  XLS_ASSIGN_OR_RETURN(parsed.delay_estimator,
                        GetDelayEstimator(delay_model_name));
   if (pipeline_stages.has_value()) {
     // TODO(meheff): Support scheduled procs.
-    XLS_RET_CHECK(func_base->IsFunction());
+    XLS_RET_CHECK(parsed.func_base->IsFunction());
     XLS_ASSIGN_OR_RETURN(
-        PipelineSchedule schedule,
+        parsed.schedule,
         RunPipelineSchedule(
-            func_base->AsFunctionOrDie(), *delay_estimator,
+            parsed.func_base->AsFunctionOrDie(), *parsed.delay_estimator,
             SchedulingOptions().pipeline_stages(pipeline_stages.value())));
-    return IrToJson(package.get(), *delay_estimator, &schedule,
-                    func_base->name());
   }
-  return IrToJson(package.get(), *delay_estimator, /*schedule=*/nullptr,
-                  func_base->name());
+  return std::move(parsed);
+}
+
+static IrToJsonOptions MakeOptions(std::optional<int64_t> max_nodes) {
+  IrToJsonOptions options;
+  if (max_nodes.has_value()) {
+    options.max_nodes = max_nodes.value();
+  }
+  return options;
+}
+
+// IR to JSON conversion function which takes strings rather than objects.
+static absl::StatusOr<std::string> IrToJsonWrapper(
+    std::string_view ir_text, std::string_view delay_model_name,
+    std::optional<int64_t> pipeline_stages,
+    std::optional<std::string_view> entry_name,
+    std::optional<int64_t> max_nodes) {
+  XLS_ASSIGN_OR_RETURN(
+      ParsedPackage parsed,
+      ParseAndSchedule(ir_text, delay_model_name, pipeline_stages,
+                       entry_name));
+  return IrToJson(
+      parsed.package.get(), *parsed.delay_estimator,
+      parsed.schedule.has_value() ? &parsed.schedule.value() : nullptr,
+      parsed.func_base->name(), MakeOptions(max_nodes));
+}
+
+// Neighborhood export function which takes strings rather than objects.
+static absl::StatusOr<std::string> NeighborhoodToJsonWrapper(
+    std::string_view ir_text, std::string_view delay_model_name,
+    std::string_view node_id, int64_t radius,
+    std::optional<int64_t> pipeline_stages,
+    std::optional<std::string_view> entry_name,
+    std::optional<int64_t> max_nodes) {
+  XLS_ASSIGN_OR_RETURN(
+      ParsedPackage parsed,
+      ParseAndSchedule(ir_text, delay_model_name, pipeline_stages,
+                       entry_name));
+  return NeighborhoodToJson(
+      parsed.package.get(), node_id, radius, *parsed.delay_estimator,
+      parsed.schedule.has_value() ? &parsed.schedule.value() : nullptr,
+      MakeOptions(max_nodes));
 }
 
 PYBIND11_MODULE(ir_to_json, m) {
@@ -88,7 +138,11 @@ PYBIND11_MODULE(ir_to_json, m) {
 
   m.def("ir_to_json", &IrToJsonWrapper, py::arg("ir_text"),
         py::arg("delay_model_name"), py::arg("pipeline_stages") = std::nullopt,
-        py::arg("entry") = std::nullopt);
+        py::arg("entry") = std::nullopt, py::arg("max_nodes") = std::nullopt);
+  m.def("neighborhood_to_json", &NeighborhoodToJsonWrapper, py::arg("ir_text"),
+        py::arg("delay_model_name"), py::arg("node_id"), py::arg("radius"),
+        py::arg("pipeline_stages") = std::nullopt,
+        py::arg("entry") = std::nullopt, py::arg("max_nodes") = std::nullopt);
 }
 
 }  // namespace xls
@@ -70,6 +70,35 @@ top fn main(x: bits[32], y: bits[32]) -> bits[32] {
       elif node['id'] == 'neg_2':
         self.assertEqual(node['attributes']['cycle'], 1)
 
+  def test_ir_to_json_summarizes_large_functions(self):
+    json_str = ir_to_json.ir_to_json(
+        """package test
+
+top fn main(x: bits[32], y: bits[32]) -> bits[32] {
+  add.1: bits[32] = add(x, y)
+  ret neg.2: bits[32] = neg(add.1)
+}""", 'unit', max_nodes=3)
+    function_dict = json.loads(json_str)['function_bases'][0]
+    self.assertTrue(function_dict['truncated'])
+    self.assertEqual(function_dict['node_count'], 4)
+    self.assertNotIn('nodes', function_dict)
+    self.assertLen(function_dict['clusters'], 3)
+    self.assertLen(function_dict['cluster_edges'], 2)
+
+  def test_neighborhood_to_json(self):
+    json_str = ir_to_json.neighborhood_to_json(
+        """package test
+
+top fn main(x: bits[32] id=1, y: bits[32] id=2) -> bits[32] {
+  add.3: bits[32] = add(x, y, id=3)
+  ret neg.4: bits[32] = neg(add.3, id=4)
+}""", 'unit', node_id='f0_4', radius=1)
+    function_dict = json.loads(json_str)
+    self.assertEqual([node['name'] for node in function_dict['nodes']],
+                     ['neg.4', 'add.3'])
+    self.assertTrue(function_dict['nodes'][1]['has_hidden_neighbors'])
+    self.assertLen(function_dict['edges'], 3)
+
 
 if __name__ == '__main__':
   absltest.main()